@@ -15,10 +15,12 @@
 from ml_metadata import proto
 
 # Import metadata_store API.
+from ml_metadata.metadata_store import AsyncMetadataStore
 from ml_metadata.metadata_store import downgrade_schema
 from ml_metadata.metadata_store import ListOptions
 from ml_metadata.metadata_store import MetadataStore
 from ml_metadata.metadata_store import OrderByField
+from ml_metadata.metadata_store import WriteBehindMetadataStore
 
 # Import version string.
 from ml_metadata.version import __version__
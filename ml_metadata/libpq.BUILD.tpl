@@ -0,0 +1,11 @@
+# The libpq client library installed on the host, see postgresql_configure.bzl.
+cc_library(
+    name = "libpq",
+    hdrs = glob(["include/*.h"]),
+    linkopts = [
+        "-L%{LIB_DIR}",
+        "-lpq",
+    ],
+    strip_include_prefix = "include",
+    visibility = ["//visibility:public"],
+)
@@ -0,0 +1,162 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/admission_controller.h"
+
+#include <algorithm>
+#include <string>
+
+#include <glog/logging.h>
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+// The weight of the latest call in the moving average of the latency.
+constexpr double kLatencyAverageWeight = 0.2;
+
+// The factor applied to a limit when a call is slower than the target.
+constexpr double kLimitDecreaseFactor = 0.9;
+
+// Returns the name of `request_class` in the metrics and the errors.
+std::string ClassName(const RequestClass request_class) {
+  switch (request_class) {
+    case RequestClass::kRead:
+      return "read";
+    case RequestClass::kWrite:
+      return "write";
+    case RequestClass::kBulkWrite:
+      return "bulk_write";
+  }
+  return "unknown";
+}
+
+// Counts the calls of `request_class` rejected for `reason`.
+void CountRejection(const RequestClass request_class,
+                    const absl::string_view reason) {
+  MetricsRegistry::Global()
+      ->GetCounter("mlmd_admission_rejected_calls_total",
+                   "The number of calls rejected by the admission control.",
+                   {{"class", ClassName(request_class)},
+                    {"reason", std::string(reason)}})
+      ->Increment();
+}
+
+}  // namespace
+
+void AdmissionController::Permit::Release() {
+  if (controller_ == nullptr) return;
+  controller_->Release(request_class_, absl::Now() - admit_time_);
+  controller_ = nullptr;
+}
+
+AdmissionController::AdmissionController(
+    const AdmissionControlOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.min_concurrent_calls, 0)
+      << "The min_concurrent_calls must be positive.";
+  const int max_limits[] = {options_.max_concurrent_reads,
+                            options_.max_concurrent_writes,
+                            options_.max_concurrent_bulk_writes};
+  for (int i = 0; i < classes_.size(); i++) {
+    if (max_limits[i] <= 0) continue;
+    CHECK_GE(max_limits[i], options_.min_concurrent_calls)
+        << "The limits must not be lower than min_concurrent_calls.";
+    classes_[i].max_limit = max_limits[i];
+    classes_[i].limit = max_limits[i];
+  }
+}
+
+RequestClass AdmissionController::Classify(
+    const bool is_write, const int64 num_written_records) const {
+  if (!is_write) return RequestClass::kRead;
+  return num_written_records >= options_.bulk_write_min_records
+             ? RequestClass::kBulkWrite
+             : RequestClass::kWrite;
+}
+
+tensorflow::Status AdmissionController::Admit(const RequestClass request_class,
+                                              const absl::Time deadline,
+                                              Permit* permit) {
+  CHECK(permit->controller_ == nullptr)
+      << "The permit already holds an admission.";
+  absl::MutexLock lock(&mu_);
+  ClassState& state = classes_[static_cast<int>(request_class)];
+  if (state.max_limit > 0 && !state.HasCapacity()) {
+    if (options_.max_queued_calls > 0 &&
+        state.num_queued >= options_.max_queued_calls) {
+      CountRejection(request_class, "queue_full");
+      return tensorflow::errors::ResourceExhausted(
+          "Too many ", ClassName(request_class),
+          " calls are waiting to be admitted.");
+    }
+    // The calls ahead in the queue are admitted at the pace at which the
+    // running calls complete.
+    const absl::Duration expected_wait =
+        state.average_latency * (state.num_queued + 1) / state.limit;
+    if (absl::Now() + expected_wait > deadline) {
+      CountRejection(request_class, "expected_wait");
+      return tensorflow::errors::ResourceExhausted(
+          "The ", ClassName(request_class),
+          " calls are not expected to be admitted before the deadline.");
+    }
+    state.num_queued++;
+    const bool admitted = mu_.AwaitWithDeadline(
+        absl::Condition(&state, &ClassState::HasCapacity), deadline);
+    state.num_queued--;
+    if (!admitted) {
+      CountRejection(request_class, "deadline");
+      return tensorflow::errors::ResourceExhausted(
+          "The ", ClassName(request_class),
+          " call is not admitted before the deadline.");
+    }
+  }
+  state.num_running++;
+  permit->controller_ = this;
+  permit->request_class_ = request_class;
+  permit->admit_time_ = absl::Now();
+  return tensorflow::Status::OK();
+}
+
+int AdmissionController::limit(const RequestClass request_class) const {
+  absl::MutexLock lock(&mu_);
+  return static_cast<int>(classes_[static_cast<int>(request_class)].limit);
+}
+
+void AdmissionController::Release(const RequestClass request_class,
+                                  const absl::Duration latency) {
+  absl::MutexLock lock(&mu_);
+  ClassState& state = classes_[static_cast<int>(request_class)];
+  state.num_running--;
+  state.average_latency =
+      state.average_latency == absl::ZeroDuration()
+          ? latency
+          : state.average_latency * (1 - kLatencyAverageWeight) +
+                latency * kLatencyAverageWeight;
+  if (state.max_limit == 0 || options_.target_latency <= absl::ZeroDuration()) {
+    return;
+  }
+  // The limit grows by one per limit calls faster than the target, and shrinks
+  // by a tenth on each slower call.
+  state.limit =
+      latency > options_.target_latency
+          ? std::max<double>(options_.min_concurrent_calls,
+                             state.limit * kLimitDecreaseFactor)
+          : std::min<double>(state.max_limit, state.limit + 1 / state.limit);
+}
+
+}  // namespace ml_metadata
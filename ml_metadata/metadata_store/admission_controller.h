@@ -0,0 +1,134 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
+#define ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
+
+#include <array>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The classes of calls whose concurrency is limited separately, so that a
+// burst of one class, e.g., the bulk writes of a backfill, does not starve the
+// others, e.g., the interactive reads.
+enum class RequestClass { kRead = 0, kWrite = 1, kBulkWrite = 2 };
+
+// Options of an AdmissionController.
+struct AdmissionControlOptions {
+  // The max number of concurrent calls of each class. If not positive, the
+  // calls of the class are admitted without limit.
+  int max_concurrent_reads = 0;
+  int max_concurrent_writes = 0;
+  int max_concurrent_bulk_writes = 0;
+  // The writes of at least this number of records are bulk writes.
+  int64 bulk_write_min_records = 100;
+  // The max number of calls of a class waiting to be admitted, beyond which
+  // the calls are rejected at once. If not positive, it is not bounded.
+  int max_queued_calls = 0;
+  // If positive, the limit of each class adapts to the latency of its calls:
+  // it decreases multiplicatively when a call is slower than the target, and
+  // increases additively otherwise, up to its max. The limits start at their
+  // max.
+  absl::Duration target_latency = absl::ZeroDuration();
+  // The lowest limit of a class adapted to the target_latency.
+  int min_concurrent_calls = 1;
+};
+
+// Limits the number of concurrent calls of each RequestClass which run in
+// front of the database, so that the calls beyond the limits wait instead of
+// adding to the load of the database. A call which cannot be admitted before
+// its deadline is rejected with RESOURCE_EXHAUSTED error, and at once if the
+// queue of its class is not expected to drain before its deadline, so that an
+// overloaded server sheds the calls instead of running them after their
+// clients gave up. It is thread-safe.
+class AdmissionController {
+ public:
+  // The admission of a call, which is released once it goes out of scope.
+  class Permit {
+   public:
+    Permit() = default;
+    ~Permit() { Release(); }
+
+    // Disallow copy and assign.
+    Permit(const Permit&) = delete;
+    Permit& operator=(const Permit&) = delete;
+
+    // Releases the admission, if any, and records the latency of the call.
+    void Release();
+
+   private:
+    friend class AdmissionController;
+
+    AdmissionController* controller_ = nullptr;
+    RequestClass request_class_ = RequestClass::kRead;
+    absl::Time admit_time_;
+  };
+
+  // The limits of `options` must not be lower than min_concurrent_calls,
+  // which must be positive, if they are positive.
+  explicit AdmissionController(const AdmissionControlOptions& options);
+
+  // Disallow copy and assign.
+  AdmissionController(const AdmissionController&) = delete;
+  AdmissionController& operator=(const AdmissionController&) = delete;
+
+  // Returns the class of a call, which is a read unless `is_write`, and a
+  // bulk write if it writes at least bulk_write_min_records records.
+  RequestClass Classify(bool is_write, int64 num_written_records) const;
+
+  // Waits until a call of `request_class` is admitted, and sets `permit`,
+  // which must not hold an admission.
+  // Returns RESOURCE_EXHAUSTED error, if the queue of the class is full, or
+  //   is not expected to drain before the `deadline`, or is not drained by
+  //   the `deadline`.
+  tensorflow::Status Admit(RequestClass request_class, absl::Time deadline,
+                           Permit* permit);
+
+  // Returns the current limit of the concurrent calls of `request_class`, or
+  // zero if the class is not limited.
+  int limit(RequestClass request_class) const;
+
+ private:
+  // The admission state of a class of calls.
+  struct ClassState {
+    // The max limit, or zero if the class is not limited.
+    int max_limit = 0;
+    // The current limit, which adapts to the latency.
+    double limit = 0;
+    int num_running = 0;
+    int num_queued = 0;
+    // The moving average of the latency of the calls.
+    absl::Duration average_latency = absl::ZeroDuration();
+
+    bool HasCapacity() const { return num_running < static_cast<int>(limit); }
+  };
+
+  // Releases the admission of a call of `request_class` run for `latency`.
+  void Release(RequestClass request_class, absl::Duration latency);
+
+  const AdmissionControlOptions options_;
+
+  mutable absl::Mutex mu_;
+  std::array<ClassState, 3> classes_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
@@ -0,0 +1,133 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/admission_controller.h"
+
+#include <thread>  // NOLINT
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+TEST(AdmissionControllerTest, ClassifiesCalls) {
+  AdmissionControlOptions options;
+  options.bulk_write_min_records = 10;
+  const AdmissionController controller(options);
+  EXPECT_EQ(controller.Classify(/*is_write=*/false, 0), RequestClass::kRead);
+  EXPECT_EQ(controller.Classify(/*is_write=*/true, 9), RequestClass::kWrite);
+  EXPECT_EQ(controller.Classify(/*is_write=*/true, 10),
+            RequestClass::kBulkWrite);
+}
+
+TEST(AdmissionControllerTest, AdmitsUnlimitedClasses) {
+  AdmissionControlOptions options;
+  options.max_concurrent_bulk_writes = 1;
+  AdmissionController controller(options);
+  AdmissionController::Permit permits[3];
+  for (AdmissionController::Permit& permit : permits) {
+    TF_EXPECT_OK(
+        controller.Admit(RequestClass::kRead, absl::InfinitePast(), &permit));
+  }
+  EXPECT_EQ(controller.limit(RequestClass::kRead), 0);
+}
+
+TEST(AdmissionControllerTest, RejectsCallsNotAdmittedBeforeDeadline) {
+  AdmissionControlOptions options;
+  options.max_concurrent_writes = 1;
+  AdmissionController controller(options);
+  AdmissionController::Permit running;
+  TF_ASSERT_OK(
+      controller.Admit(RequestClass::kWrite, absl::InfiniteFuture(), &running));
+
+  // The limit of a class does not hold back the other classes.
+  AdmissionController::Permit read;
+  TF_EXPECT_OK(
+      controller.Admit(RequestClass::kRead, absl::InfiniteFuture(), &read));
+
+  AdmissionController::Permit queued;
+  EXPECT_EQ(controller
+                .Admit(RequestClass::kWrite,
+                       absl::Now() + absl::Milliseconds(10), &queued)
+                .code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+
+  // The queued call is admitted once the running one is released.
+  std::thread release([&running]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    running.Release();
+  });
+  TF_EXPECT_OK(
+      controller.Admit(RequestClass::kWrite, absl::InfiniteFuture(), &queued));
+  release.join();
+}
+
+TEST(AdmissionControllerTest, RejectsCallsBeyondQueueAtOnce) {
+  AdmissionControlOptions options;
+  options.max_concurrent_bulk_writes = 1;
+  options.max_queued_calls = 1;
+  AdmissionController controller(options);
+  AdmissionController::Permit running;
+  TF_ASSERT_OK(controller.Admit(RequestClass::kBulkWrite,
+                                absl::InfiniteFuture(), &running));
+  std::thread queued_call([&controller]() {
+    AdmissionController::Permit queued;
+    TF_EXPECT_OK(controller.Admit(RequestClass::kBulkWrite,
+                                  absl::InfiniteFuture(), &queued));
+  });
+  absl::SleepFor(absl::Milliseconds(50));
+
+  // The call beyond the queue is rejected without waiting for its deadline.
+  AdmissionController::Permit rejected;
+  const absl::Time start = absl::Now();
+  EXPECT_EQ(controller
+                .Admit(RequestClass::kBulkWrite, absl::InfiniteFuture(),
+                       &rejected)
+                .code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+  EXPECT_LT(absl::Now() - start, absl::Seconds(1));
+  running.Release();
+  queued_call.join();
+}
+
+TEST(AdmissionControllerTest, AdaptsLimitToLatency) {
+  AdmissionControlOptions options;
+  options.max_concurrent_reads = 10;
+  options.min_concurrent_calls = 2;
+  options.target_latency = absl::Milliseconds(5);
+  AdmissionController controller(options);
+
+  // The calls slower than the target decrease the limit down to the min.
+  for (int i = 0; i < 20; i++) {
+    AdmissionController::Permit permit;
+    TF_ASSERT_OK(
+        controller.Admit(RequestClass::kRead, absl::InfiniteFuture(), &permit));
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(controller.limit(RequestClass::kRead), 2);
+
+  // The faster calls increase it again.
+  for (int i = 0; i < 20; i++) {
+    AdmissionController::Permit permit;
+    TF_ASSERT_OK(
+        controller.Admit(RequestClass::kRead, absl::InfiniteFuture(), &permit));
+  }
+  EXPECT_GT(controller.limit(RequestClass::kRead), 2);
+}
+
+}  // namespace
+}  // namespace ml_metadata
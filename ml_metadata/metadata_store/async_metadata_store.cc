@@ -0,0 +1,61 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/async_metadata_store.h"
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+
+AsyncMetadataStore::AsyncMetadataStore(
+    MetadataStorePool* metadata_store_pool,
+    const AsyncMetadataStoreOptions& options)
+    : metadata_store_pool_(metadata_store_pool) {
+  CHECK(metadata_store_pool_ != nullptr)
+      << "The metadata_store_pool must not be null.";
+  CHECK_GT(options.num_threads, 0) << "The num_threads must be positive.";
+  executor_ = absl::make_unique<tensorflow::thread::ThreadPool>(
+      tensorflow::Env::Default(), options.name, options.num_threads);
+}
+
+AsyncMetadataStore::~AsyncMetadataStore() { executor_.reset(); }
+
+void AsyncMetadataStore::Schedule(
+    std::function<tensorflow::Status(MetadataStore*)> call, DoneCallback done,
+    const absl::Time deadline) {
+  executor_->Schedule([this, call = std::move(call), done = std::move(done),
+                       deadline]() {
+    tensorflow::Status status;
+    {
+      // The store is returned to the pool before `done` is called, so that
+      // the callback can schedule the next call without holding a store.
+      MetadataStorePool::ScopedMetadataStore metadata_store;
+      if (absl::Now() > deadline) {
+        status = tensorflow::errors::DeadlineExceeded(
+            "The deadline passed before the call was run.");
+      } else {
+        status = metadata_store_pool_->Acquire(&metadata_store);
+      }
+      if (status.ok()) {
+        metadata_store->SetTransactionDeadline(deadline);
+        status = call(metadata_store.get());
+      }
+    }
+    done(status);
+  });
+}
+
+}  // namespace ml_metadata
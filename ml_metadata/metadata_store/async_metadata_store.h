@@ -0,0 +1,187 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_ASYNC_METADATA_STORE_H_
+#define ML_METADATA_METADATA_STORE_ASYNC_METADATA_STORE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace ml_metadata {
+
+// Options to tune an AsyncMetadataStore.
+struct AsyncMetadataStoreOptions {
+  // The number of threads running the calls, i.e., the max number of calls
+  // using a store at the same time. It must be positive, and should not exceed
+  // the `max_size` of the pool, beyond which the threads wait for the stores.
+  int num_threads = 8;
+  // The name of the threads, e.g., as shown by a profiler.
+  std::string name = "mlmd_async_store";
+};
+
+// Runs the MetadataStore methods asynchronously, on a bounded set of threads
+// with the stores of a MetadataStorePool. A call returns once it is scheduled
+// and reports its status to a callback, so that an embedding service can
+// issue many lookups concurrently and compose their results, without a
+// thread of its own per call. It is thread-safe.
+//
+// Each call runs in its own transaction, like the synchronous method, and
+// the calls in flight at the same time run in any order.
+//
+// Usage example:
+//
+//   AsyncMetadataStore async_store(&pool, AsyncMetadataStoreOptions());
+//   absl::BlockingCounter pending(2);
+//   tensorflow::Status artifacts_status, executions_status;
+//   async_store.GetArtifactsByID(artifacts_request, &artifacts_response,
+//       [&](const tensorflow::Status& status) {
+//         artifacts_status = status;
+//         pending.DecrementCount();
+//       });
+//   async_store.GetExecutionsByID(executions_request, &executions_response,
+//       [&](const tensorflow::Status& status) {
+//         executions_status = status;
+//         pending.DecrementCount();
+//       });
+//   pending.Wait();
+class AsyncMetadataStore {
+ public:
+  // Called once with the status of a call, from the thread which ran it,
+  // after the response has been filled. It should return quickly, e.g., by
+  // handing the result to another executor, as it holds a thread of the
+  // store.
+  using DoneCallback = std::function<void(const tensorflow::Status&)>;
+
+  // `metadata_store_pool` is not owned and must outlive the store.
+  AsyncMetadataStore(MetadataStorePool* metadata_store_pool,
+                     const AsyncMetadataStoreOptions& options);
+
+  // Disallow copy and assign.
+  AsyncMetadataStore(const AsyncMetadataStore&) = delete;
+  AsyncMetadataStore& operator=(const AsyncMetadataStore&) = delete;
+
+  // Waits for the scheduled calls to finish, and their callbacks to return.
+  ~AsyncMetadataStore();
+
+  // Schedules the `method` of a borrowed store with `request` and `response`,
+  // which must stay valid until `done` is called. Once `deadline` has passed,
+  // a call which has not started yet fails with DEADLINE_EXCEEDED, and a
+  // started one is bounded by MetadataStore::SetTransactionDeadline.
+  // `done` is called with the status of the method, or the error of
+  // MetadataStorePool::Acquire if no store can be borrowed.
+  template <typename Request, typename Response>
+  void Call(tensorflow::Status (MetadataStore::*method)(const Request&,
+                                                        Response*),
+            const Request& request, Response* response, DoneCallback done,
+            absl::Time deadline = absl::InfiniteFuture()) {
+    Schedule(
+        [method, &request, response](MetadataStore* store) {
+          return (store->*method)(request, response);
+        },
+        std::move(done), deadline);
+  }
+
+#define ASYNC_METADATA_STORE_DECLARE(method)                                 \
+  void method(const method##Request& request, method##Response* response,    \
+              DoneCallback done,                                             \
+              absl::Time deadline = absl::InfiniteFuture()) {                \
+    Call(&MetadataStore::method, request, response, std::move(done),         \
+         deadline);                                                          \
+  }
+
+  ASYNC_METADATA_STORE_DECLARE(PutArtifacts)
+  ASYNC_METADATA_STORE_DECLARE(PutArtifactType)
+  ASYNC_METADATA_STORE_DECLARE(PutExecutions)
+  ASYNC_METADATA_STORE_DECLARE(PutExecutionType)
+  ASYNC_METADATA_STORE_DECLARE(PutEvents)
+  ASYNC_METADATA_STORE_DECLARE(PutExecution)
+  ASYNC_METADATA_STORE_DECLARE(PutTypes)
+  ASYNC_METADATA_STORE_DECLARE(PutContextType)
+  ASYNC_METADATA_STORE_DECLARE(PutContexts)
+  ASYNC_METADATA_STORE_DECLARE(PutAttributionsAndAssociations)
+  ASYNC_METADATA_STORE_DECLARE(PutParentContexts)
+  ASYNC_METADATA_STORE_DECLARE(DeleteArtifacts)
+  ASYNC_METADATA_STORE_DECLARE(DeleteExecutions)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactType)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactTypesByID)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactTypes)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionType)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionTypesByID)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionTypes)
+  ASYNC_METADATA_STORE_DECLARE(GetContextType)
+  ASYNC_METADATA_STORE_DECLARE(GetContextTypesByID)
+  ASYNC_METADATA_STORE_DECLARE(GetContextTypes)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifacts)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutions)
+  ASYNC_METADATA_STORE_DECLARE(GetContexts)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByID)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionsByID)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByID)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByType)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactByTypeAndName)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionsByType)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionByTypeAndName)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByType)
+  ASYNC_METADATA_STORE_DECLARE(GetContextByTypeAndName)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByTypeAndNames)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionsByTypeAndNames)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByTypeAndNames)
+  ASYNC_METADATA_STORE_DECLARE(CountArtifacts)
+  ASYNC_METADATA_STORE_DECLARE(CountExecutions)
+  ASYNC_METADATA_STORE_DECLARE(CountContexts)
+  ASYNC_METADATA_STORE_DECLARE(AggregateProperty)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByURI)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByURIPrefix)
+  ASYNC_METADATA_STORE_DECLARE(ArtifactsExist)
+  ASYNC_METADATA_STORE_DECLARE(GetEventsByExecutionIDs)
+  ASYNC_METADATA_STORE_DECLARE(GetEventsByArtifactIDs)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByArtifact)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByExecution)
+  ASYNC_METADATA_STORE_DECLARE(GetParentContextsByContext)
+  ASYNC_METADATA_STORE_DECLARE(GetChildrenContextsByContext)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByContext)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionsByContext)
+  ASYNC_METADATA_STORE_DECLARE(GetArtifactsByContexts)
+  ASYNC_METADATA_STORE_DECLARE(GetExecutionsByContexts)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByArtifacts)
+  ASYNC_METADATA_STORE_DECLARE(GetContextsByExecutions)
+  ASYNC_METADATA_STORE_DECLARE(GetLineageGraph)
+  ASYNC_METADATA_STORE_DECLARE(GetLineageClosure)
+
+#undef ASYNC_METADATA_STORE_DECLARE
+
+ private:
+  // Runs `call` on a thread of `executor_` with a borrowed store, and passes
+  // its status to `done`.
+  void Schedule(std::function<tensorflow::Status(MetadataStore*)> call,
+                DoneCallback done, absl::Time deadline);
+
+  MetadataStorePool* const metadata_store_pool_;
+  // Destructed first, which waits for the scheduled calls.
+  std::unique_ptr<tensorflow::thread::ThreadPool> executor_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_ASYNC_METADATA_STORE_H_
@@ -0,0 +1,183 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/async_metadata_store.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+// The pool has a single store, whose in-memory database is seen by all calls.
+class AsyncMetadataStoreTest : public ::testing::Test {
+ protected:
+  AsyncMetadataStoreTest()
+      : metadata_store_pool_(FakeDatabaseConnectionConfig(),
+                             SingleStorePoolOptions()) {}
+
+  static ConnectionConfig FakeDatabaseConnectionConfig() {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    return connection_config;
+  }
+
+  static MetadataStorePoolOptions SingleStorePoolOptions() {
+    MetadataStorePoolOptions options;
+    options.max_size = 1;
+    return options;
+  }
+
+  // Puts an artifact type and returns its id.
+  int64 PutArtifactType(AsyncMetadataStore* async_store) {
+    const PutArtifactTypeRequest request =
+        ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+          all_fields_match: true
+          artifact_type: { name: 'async_type' }
+        )");
+    PutArtifactTypeResponse response;
+    absl::BlockingCounter pending(1);
+    tensorflow::Status status;
+    async_store->PutArtifactType(request, &response,
+                                 [&](const tensorflow::Status& call_status) {
+                                   status = call_status;
+                                   pending.DecrementCount();
+                                 });
+    pending.Wait();
+    TF_EXPECT_OK(status);
+    return response.type_id();
+  }
+
+  MetadataStorePool metadata_store_pool_;
+};
+
+TEST_F(AsyncMetadataStoreTest, ConcurrentCalls) {
+  AsyncMetadataStoreOptions options;
+  options.num_threads = 4;
+  AsyncMetadataStore async_store(&metadata_store_pool_, options);
+  const int64 type_id = PutArtifactType(&async_store);
+
+  constexpr int kNumCalls = 16;
+  std::vector<PutArtifactsRequest> put_requests(kNumCalls);
+  std::vector<PutArtifactsResponse> put_responses(kNumCalls);
+  std::vector<tensorflow::Status> put_statuses(kNumCalls);
+  {
+    absl::BlockingCounter pending(kNumCalls);
+    for (int i = 0; i < kNumCalls; i++) {
+      put_requests[i].add_artifacts()->set_type_id(type_id);
+      async_store.PutArtifacts(put_requests[i], &put_responses[i],
+                               [&, i](const tensorflow::Status& status) {
+                                 put_statuses[i] = status;
+                                 pending.DecrementCount();
+                               });
+    }
+    pending.Wait();
+  }
+  for (const tensorflow::Status& status : put_statuses) {
+    TF_EXPECT_OK(status);
+  }
+
+  std::vector<GetArtifactsByIDRequest> get_requests(kNumCalls);
+  std::vector<GetArtifactsByIDResponse> get_responses(kNumCalls);
+  std::vector<tensorflow::Status> get_statuses(kNumCalls);
+  {
+    absl::BlockingCounter pending(kNumCalls);
+    for (int i = 0; i < kNumCalls; i++) {
+      ASSERT_EQ(put_responses[i].artifact_ids_size(), 1);
+      get_requests[i].add_artifact_ids(put_responses[i].artifact_ids(0));
+      async_store.GetArtifactsByID(get_requests[i], &get_responses[i],
+                                   [&, i](const tensorflow::Status& status) {
+                                     get_statuses[i] = status;
+                                     pending.DecrementCount();
+                                   });
+    }
+    pending.Wait();
+  }
+  for (int i = 0; i < kNumCalls; i++) {
+    TF_EXPECT_OK(get_statuses[i]);
+    ASSERT_EQ(get_responses[i].artifacts_size(), 1);
+    EXPECT_EQ(get_responses[i].artifacts(0).id(),
+              put_responses[i].artifact_ids(0));
+  }
+}
+
+TEST_F(AsyncMetadataStoreTest, ReturnsMethodError) {
+  AsyncMetadataStore async_store(&metadata_store_pool_,
+                                 AsyncMetadataStoreOptions());
+  GetArtifactTypeRequest request;
+  request.set_type_name("unknown_type");
+  GetArtifactTypeResponse response;
+  absl::BlockingCounter pending(1);
+  tensorflow::Status status;
+  async_store.GetArtifactType(request, &response,
+                              [&](const tensorflow::Status& call_status) {
+                                status = call_status;
+                                pending.DecrementCount();
+                              });
+  pending.Wait();
+  EXPECT_TRUE(tensorflow::errors::IsNotFound(status)) << status;
+}
+
+TEST_F(AsyncMetadataStoreTest, ExpiredDeadline) {
+  AsyncMetadataStore async_store(&metadata_store_pool_,
+                                 AsyncMetadataStoreOptions());
+  GetArtifactTypesRequest request;
+  GetArtifactTypesResponse response;
+  absl::BlockingCounter pending(1);
+  tensorflow::Status status;
+  async_store.GetArtifactTypes(
+      request, &response,
+      [&](const tensorflow::Status& call_status) {
+        status = call_status;
+        pending.DecrementCount();
+      },
+      absl::Now() - absl::Seconds(1));
+  pending.Wait();
+  EXPECT_TRUE(tensorflow::errors::IsDeadlineExceeded(status)) << status;
+}
+
+TEST_F(AsyncMetadataStoreTest, DestructionWaitsForScheduledCalls) {
+  constexpr int kNumCalls = 8;
+  std::vector<GetArtifactTypesResponse> responses(kNumCalls);
+  int num_done = 0;
+  const GetArtifactTypesRequest request;
+  {
+    AsyncMetadataStoreOptions options;
+    options.num_threads = 1;
+    AsyncMetadataStore async_store(&metadata_store_pool_, options);
+    for (int i = 0; i < kNumCalls; i++) {
+      // The single thread runs the calls one by one.
+      async_store.GetArtifactTypes(
+          request, &responses[i],
+          [&num_done](const tensorflow::Status&) { num_done++; });
+    }
+  }
+  EXPECT_EQ(num_done, kNumCalls);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,175 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/client_rate_limiter.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+#include "absl/time/clock.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+using ClientLimit =
+    MetadataStoreServerConfig::ClientRateLimitConfig::ClientLimit;
+
+// The number of client states beyond which the idle clients are dropped.
+constexpr int kMaxNumIdleClients = 10000;
+
+// The label of the clients without their own limits in the metrics.
+constexpr char kOtherClientsLabel[] = "other";
+
+// Returns the max number of tokens in the bucket of `limit`.
+double Burst(const ClientLimit& limit) {
+  return limit.burst() > 0 ? limit.burst()
+                           : std::max(1.0, limit.calls_per_second());
+}
+
+// Returns the weight of `limit` in the fair queuing.
+double Weight(const ClientLimit& limit) {
+  return limit.weight() > 0 ? limit.weight() : 1.0;
+}
+
+// Counts a call of the client labeled `client` with `outcome`.
+void CountCall(const std::string& client, const absl::string_view outcome) {
+  MetricsRegistry::Global()
+      ->GetCounter("mlmd_client_calls_total",
+                   "The number of calls of a client, by admission outcome.",
+                   {{"client", client}, {"outcome", std::string(outcome)}})
+      ->Increment();
+}
+
+}  // namespace
+
+void ClientRateLimiter::Permit::Release() {
+  if (limiter_ == nullptr) return;
+  limiter_->Release(client_);
+  limiter_ = nullptr;
+  client_ = nullptr;
+}
+
+ClientRateLimiter::ClientRateLimiter(
+    const MetadataStoreServerConfig::ClientRateLimitConfig& config)
+    : config_(config) {
+  for (const ClientLimit& limit : config_.client_limits()) {
+    CHECK(!limit.client_id().empty())
+        << "The client_limits must have a client_id.";
+    client_limits_[limit.client_id()] = limit;
+  }
+}
+
+bool ClientRateLimiter::QueuedCall::IsNext() const {
+  return limiter->num_running_ < limiter->config_.max_concurrent_calls() &&
+         *limiter->queue_.begin() == key;
+}
+
+ClientRateLimiter::ClientState& ClientRateLimiter::GetClient(
+    const absl::string_view client_id, const absl::Time now) {
+  auto it = clients_.find(client_id);
+  if (it != clients_.end()) return it->second;
+  if (clients_.size() >= kMaxNumIdleClients) DropIdleClients(now);
+  ClientState& client = clients_[std::string(client_id)];
+  const auto limit = client_limits_.find(client_id);
+  if (limit != client_limits_.end()) {
+    client.limit = limit->second;
+    client.metric_label = std::string(client_id);
+  } else {
+    client.limit = config_.default_limit();
+    client.metric_label = kOtherClientsLabel;
+  }
+  client.tokens = Burst(client.limit);
+  client.last_refill_time = now;
+  client.last_finish_tag = virtual_time_;
+  return client;
+}
+
+void ClientRateLimiter::DropIdleClients(const absl::Time now) {
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    const ClientState& client = it->second;
+    const double refilled_tokens =
+        client.tokens + absl::ToDoubleSeconds(now - client.last_refill_time) *
+                            client.limit.calls_per_second();
+    if (client.num_running == 0 && client.num_queued == 0 &&
+        (client.limit.calls_per_second() <= 0 ||
+         refilled_tokens >= Burst(client.limit))) {
+      clients_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+tensorflow::Status ClientRateLimiter::Admit(const absl::string_view client_id,
+                                            const absl::Time deadline,
+                                            Permit* permit) {
+  CHECK(permit->limiter_ == nullptr)
+      << "The permit already holds an admission.";
+  const absl::Time now = absl::Now();
+  absl::MutexLock lock(&mu_);
+  ClientState& client = GetClient(client_id, now);
+  if (client.limit.calls_per_second() > 0) {
+    client.tokens = std::min(
+        Burst(client.limit),
+        client.tokens + absl::ToDoubleSeconds(now - client.last_refill_time) *
+                            client.limit.calls_per_second());
+    client.last_refill_time = now;
+    if (client.tokens < 1) {
+      CountCall(client.metric_label, "rate_limited");
+      return tensorflow::errors::ResourceExhausted(
+          "The client ", client_id, " exceeds its rate of ",
+          client.limit.calls_per_second(), " calls per second.");
+    }
+    client.tokens -= 1;
+  }
+  if (config_.max_concurrent_calls() > 0 &&
+      (num_running_ >= config_.max_concurrent_calls() || !queue_.empty())) {
+    // The call finishes after the previous call of the client, or now if the
+    // client has been idle, after the time of its share of the stores.
+    const double finish_tag =
+        std::max(virtual_time_, client.last_finish_tag) +
+        1 / Weight(client.limit);
+    client.last_finish_tag = finish_tag;
+    const QueuedCall queued_call{this, {finish_tag, next_sequence_number_++}};
+    queue_.insert(queued_call.key);
+    client.num_queued++;
+    const bool admitted = mu_.AwaitWithDeadline(
+        absl::Condition(&queued_call, &QueuedCall::IsNext), deadline);
+    queue_.erase(queued_call.key);
+    client.num_queued--;
+    if (!admitted) {
+      CountCall(client.metric_label, "deadline");
+      return tensorflow::errors::ResourceExhausted(
+          "The call of the client ", client_id,
+          " is not admitted before the deadline.");
+    }
+    virtual_time_ = std::max(virtual_time_, finish_tag);
+  }
+  CountCall(client.metric_label, "admitted");
+  num_running_++;
+  client.num_running++;
+  permit->limiter_ = this;
+  permit->client_ = &client;
+  return tensorflow::Status::OK();
+}
+
+void ClientRateLimiter::Release(ClientState* client) {
+  absl::MutexLock lock(&mu_);
+  num_running_--;
+  client->num_running--;
+}
+
+}  // namespace ml_metadata
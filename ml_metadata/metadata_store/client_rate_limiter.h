@@ -0,0 +1,148 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_CLIENT_RATE_LIMITER_H_
+#define ML_METADATA_METADATA_STORE_CLIENT_RATE_LIMITER_H_
+
+#include <set>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Limits the calls of each client of the server, as configured by a
+// ClientRateLimitConfig. The calls of a client are admitted at the rate of
+// its token bucket, and the others are rejected at once with
+// RESOURCE_EXHAUSTED error. The admitted calls beyond max_concurrent_calls
+// wait in weighted fair queuing: each queued call is tagged with the virtual
+// time at which it would finish, if each client got the share of its weight,
+// and the calls are admitted in the order of their tags. A client sending a
+// burst thus waits behind its own calls, instead of delaying the others.
+// It is thread-safe.
+//
+// The calls are counted per client in the mlmd_client_calls_total metric, in
+// which the clients without their own client_limits are counted as "other",
+// so that the number of series stays bounded.
+class ClientRateLimiter {
+ private:
+  struct ClientState;
+
+ public:
+  // The admission of a call, which is released once it goes out of scope.
+  class Permit {
+   public:
+    Permit() = default;
+    ~Permit() { Release(); }
+
+    // Disallow copy and assign.
+    Permit(const Permit&) = delete;
+    Permit& operator=(const Permit&) = delete;
+
+    // Releases the admission, if any.
+    void Release();
+
+   private:
+    friend class ClientRateLimiter;
+
+    ClientRateLimiter* limiter_ = nullptr;
+    // The state of the client of the call, which is kept while it runs.
+    ClientState* client_ = nullptr;
+  };
+
+  explicit ClientRateLimiter(
+      const MetadataStoreServerConfig::ClientRateLimitConfig& config);
+
+  // Disallow copy and assign.
+  ClientRateLimiter(const ClientRateLimiter&) = delete;
+  ClientRateLimiter& operator=(const ClientRateLimiter&) = delete;
+
+  // The gRPC metadata key identifying the clients, or empty if there is none.
+  const std::string& client_id_metadata_key() const {
+    return config_.client_id_metadata_key();
+  }
+
+  // Admits a call of `client_id`, waiting until the `deadline` in the fair
+  // queue, and sets `permit`, which must not hold an admission.
+  // Returns RESOURCE_EXHAUSTED error, if the client exceeds its rate, or the
+  //   call is not admitted by the `deadline`.
+  tensorflow::Status Admit(absl::string_view client_id, absl::Time deadline,
+                           Permit* permit);
+
+ private:
+  // The bucket and the queued calls of a client.
+  struct ClientState {
+    MetadataStoreServerConfig::ClientRateLimitConfig::ClientLimit limit;
+    // The label of the client in the metrics.
+    std::string metric_label;
+    double tokens = 0;
+    absl::Time last_refill_time;
+    // The finish tag of the last queued call of the client.
+    double last_finish_tag = 0;
+    int num_running = 0;
+    int num_queued = 0;
+  };
+
+  // A call waiting in the fair queue.
+  struct QueuedCall {
+    // Whether the call is the first of the queue and a call can be admitted.
+    // It is evaluated with `mu_` held.
+    bool IsNext() const ABSL_NO_THREAD_SAFETY_ANALYSIS;
+
+    const ClientRateLimiter* limiter;
+    // The (finish tag, arrival sequence number) of the call in the queue.
+    std::pair<double, int64> key;
+  };
+
+  // Returns the state of `client_id`, which is created with a full bucket.
+  ClientState& GetClient(absl::string_view client_id, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Drops the states of the clients without calls, whose buckets are full, so
+  // that the states of the past peers do not accumulate.
+  void DropIdleClients(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Releases a call of `client`.
+  void Release(ClientState* client);
+
+  const MetadataStoreServerConfig::ClientRateLimitConfig config_;
+  // The limits of client_limits by client id.
+  absl::flat_hash_map<std::string,
+                      MetadataStoreServerConfig::ClientRateLimitConfig::
+                          ClientLimit>
+      client_limits_;
+
+  mutable absl::Mutex mu_;
+  // The states of the clients, whose addresses are stable.
+  absl::node_hash_map<std::string, ClientState> clients_ ABSL_GUARDED_BY(mu_);
+  int num_running_ ABSL_GUARDED_BY(mu_) = 0;
+  // The finish tag of the last admitted call.
+  double virtual_time_ ABSL_GUARDED_BY(mu_) = 0;
+  // The keys of the queued calls, in the order in which they are admitted.
+  std::set<std::pair<double, int64>> queue_ ABSL_GUARDED_BY(mu_);
+  int64 next_sequence_number_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_CLIENT_RATE_LIMITER_H_
@@ -0,0 +1,97 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/client_rate_limiter.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(ClientRateLimiterTest, RejectsCallsBeyondRate) {
+  MetadataStoreServerConfig::ClientRateLimitConfig config;
+  auto* limit = config.add_client_limits();
+  limit->set_client_id("a");
+  limit->set_calls_per_second(0.001);
+  limit->set_burst(2);
+  ClientRateLimiter limiter(config);
+  for (int i = 0; i < 2; i++) {
+    ClientRateLimiter::Permit permit;
+    TF_EXPECT_OK(limiter.Admit("a", absl::InfiniteFuture(), &permit));
+  }
+  ClientRateLimiter::Permit rejected;
+  EXPECT_EQ(limiter.Admit("a", absl::InfiniteFuture(), &rejected).code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+
+  // The clients without their own limits get the unlimited default.
+  ClientRateLimiter::Permit other;
+  TF_EXPECT_OK(limiter.Admit("b", absl::InfiniteFuture(), &other));
+}
+
+TEST(ClientRateLimiterTest, RejectsCallsNotAdmittedBeforeDeadline) {
+  MetadataStoreServerConfig::ClientRateLimitConfig config;
+  config.set_max_concurrent_calls(1);
+  ClientRateLimiter limiter(config);
+  ClientRateLimiter::Permit running;
+  TF_ASSERT_OK(limiter.Admit("a", absl::InfiniteFuture(), &running));
+  ClientRateLimiter::Permit queued;
+  EXPECT_EQ(limiter.Admit("b", absl::Now() + absl::Milliseconds(10), &queued)
+                .code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+  running.Release();
+  TF_EXPECT_OK(limiter.Admit("b", absl::InfiniteFuture(), &queued));
+}
+
+TEST(ClientRateLimiterTest, QueuesCallsFairly) {
+  MetadataStoreServerConfig::ClientRateLimitConfig config;
+  config.set_max_concurrent_calls(1);
+  ClientRateLimiter limiter(config);
+  ClientRateLimiter::Permit running;
+  TF_ASSERT_OK(limiter.Admit("holder", absl::InfiniteFuture(), &running));
+
+  absl::Mutex mu;
+  std::vector<std::string> admitted_clients;
+  std::vector<std::thread> calls;
+  // A client sends a burst of calls before another client sends one.
+  for (const std::string client : {"burst", "burst", "burst", "other"}) {
+    calls.emplace_back([&, client]() {
+      ClientRateLimiter::Permit permit;
+      TF_EXPECT_OK(limiter.Admit(client, absl::InfiniteFuture(), &permit));
+      absl::MutexLock lock(&mu);
+      admitted_clients.push_back(client);
+    });
+    absl::SleepFor(absl::Milliseconds(20));
+  }
+  running.Release();
+  for (std::thread& call : calls) call.join();
+
+  // The call of the other client does not wait behind the whole burst.
+  EXPECT_THAT(admitted_clients,
+              ElementsAre("burst", "other", "burst", "burst"));
+}
+
+}  // namespace
+}  // namespace ml_metadata
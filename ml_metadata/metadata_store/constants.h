@@ -21,6 +21,30 @@ namespace ml_metadata {
 // any MetadataSource.
 static constexpr char kMetadataSourceNull[] = "__MLMD_NULL__";
 
+// The max number of prepared statements a MetadataSource caches for one
+// connection. When the cache is full, the cached statements are released.
+static constexpr int kMaxNumPreparedStatements = 128;
+
+// The max number of values bound to one prepared statement. It is below the
+// limits of the backends (e.g., 999 variables in older SQLite builds). A query
+// with more values, e.g., a long list of ids, is run without preparing it.
+static constexpr int kMaxNumPreparedStatementValues = 999;
+
+// The number of nodes read and materialized at a time, when streaming all
+// nodes of a kind.
+static constexpr int kNodeStreamingBatchSize = 1000;
+
+// The max number of ids of the IN(...) list of a query for nodes or events by
+// id. Longer lists are split into several queries, so that the queries stay
+// below the packet size limits of the backends, and keep using the indexes.
+static constexpr int kMaxIdsPerQuery = 512;
+
+// The min number of ids of an IN(...) list loaded into a temporary table, on
+// the backends whose query config has one, instead of being inlined into the
+// query. The query then selects the ids from the table, and the callers do not
+// split such lists.
+static constexpr int kMinIdsForIdListTable = 10000;
+
 // The node type_kind enum values used for internal storage. The enum value
 // should not be modified, in order to be backward compatible with stored types.
 // LINT.IfChange
@@ -0,0 +1,144 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/garbage_collector.h"
+
+#include <glog/logging.h>
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+using GarbageCollectionRule =
+    MetadataStoreServerConfig::GarbageCollectionConfig::Rule;
+
+// The interval between the runs of the rules, if the config does not set it.
+constexpr absl::Duration kDefaultInterval = absl::Hours(1);
+
+// The number of expired idempotency keys deleted in a transaction, if the
+// config does not set max_batch_size.
+constexpr int64 kDefaultIdempotencyKeyBatchSize = 1000;
+
+// Returns the CollectGarbage request of `rule` as of `now`.
+CollectGarbageRequest ToCollectGarbageRequest(const GarbageCollectionRule& rule,
+                                              const absl::Time now,
+                                              const int64 max_batch_size) {
+  CollectGarbageRequest request;
+  request.set_node_kind(rule.node_kind() == GarbageCollectionRule::ARTIFACT
+                            ? CollectGarbageRequest::ARTIFACT
+                            : CollectGarbageRequest::EXECUTION);
+  request.set_type_name(rule.type_name());
+  if (rule.has_type_version()) {
+    request.set_type_version(rule.type_version());
+  }
+  request.set_updated_before_time_since_epoch(
+      absl::ToUnixMillis(now - absl::Seconds(rule.ttl_seconds())));
+  if (max_batch_size > 0) {
+    request.set_max_batch_size(max_batch_size);
+  }
+  return request;
+}
+
+}  // namespace
+
+GarbageCollector::GarbageCollector(
+    MetadataStorePool* metadata_store_pool,
+    const MetadataStoreServerConfig::GarbageCollectionConfig& config)
+    : metadata_store_pool_(metadata_store_pool),
+      config_(config),
+      interval_(config.interval_seconds() > 0
+                    ? absl::Seconds(config.interval_seconds())
+                    : kDefaultInterval) {
+  CHECK(metadata_store_pool_ != nullptr)
+      << "The metadata_store_pool must not be null.";
+  for (const GarbageCollectionRule& rule : config_.rules()) {
+    CHECK(rule.node_kind() == GarbageCollectionRule::ARTIFACT ||
+          rule.node_kind() == GarbageCollectionRule::EXECUTION)
+        << "The node_kind of a rule must be ARTIFACT or EXECUTION: "
+        << rule.ShortDebugString();
+    CHECK(!rule.type_name().empty())
+        << "The type_name of a rule must be given: " << rule.ShortDebugString();
+    CHECK_GT(rule.ttl_seconds(), 0)
+        << "The ttl_seconds of a rule must be positive: "
+        << rule.ShortDebugString();
+  }
+}
+
+GarbageCollector::~GarbageCollector() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopped_ = true;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void GarbageCollector::Start() {
+  CHECK(!thread_.joinable()) << "The garbage collector is already started.";
+  thread_ = std::thread([this]() { Run(); });
+}
+
+tensorflow::Status GarbageCollector::RunOnce(const absl::Time now,
+                                             int64* num_deleted) {
+  *num_deleted = 0;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  TF_RETURN_IF_ERROR(metadata_store_pool_->Acquire(&metadata_store));
+  tensorflow::Status first_error;
+  for (const GarbageCollectionRule& rule : config_.rules()) {
+    // The nodes deleted by a failed rule are counted by its response.
+    CollectGarbageResponse response;
+    const tensorflow::Status status = metadata_store->CollectGarbage(
+        ToCollectGarbageRequest(rule, now, config_.max_batch_size()),
+        &response);
+    *num_deleted += response.num_deleted();
+    if (!status.ok()) {
+      LOG(WARNING) << "Garbage collection failed for "
+                   << rule.ShortDebugString() << ": " << status;
+      first_error.Update(status);
+    }
+  }
+  // The expired idempotency keys of the store, if it records them.
+  int64 num_deleted_keys = 0;
+  const tensorflow::Status status =
+      metadata_store->DeleteExpiredIdempotencyKeys(
+          now,
+          config_.max_batch_size() > 0 ? config_.max_batch_size()
+                                       : kDefaultIdempotencyKeyBatchSize,
+          &num_deleted_keys);
+  if (!status.ok()) {
+    LOG(WARNING) << "Deleting the expired idempotency keys failed: " << status;
+    first_error.Update(status);
+  }
+  return first_error;
+}
+
+void GarbageCollector::Run() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (mu_.AwaitWithTimeout(absl::Condition(&stopped_), interval_)) {
+        return;
+      }
+    }
+    int64 num_deleted = 0;
+    const tensorflow::Status status = RunOnce(absl::Now(), &num_deleted);
+    LOG(INFO) << "Garbage collection deleted " << num_deleted << " nodes"
+              << (status.ok() ? "." : ", with errors.");
+  }
+}
+
+}  // namespace ml_metadata
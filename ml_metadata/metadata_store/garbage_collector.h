@@ -0,0 +1,75 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_GARBAGE_COLLECTOR_H_
+#define ML_METADATA_METADATA_STORE_GARBAGE_COLLECTOR_H_
+
+#include <thread>  // NOLINT
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Deletes the artifacts and executions which are not updated within the
+// retention periods of the rules of a GarbageCollectionConfig, by running
+// MetadataStore::CollectGarbage on a store of a MetadataStorePool. Once
+// started, the rules run on a background thread every interval, until the
+// collector is destructed. It is thread-safe.
+class GarbageCollector {
+ public:
+  // `metadata_store_pool` is not owned and must outlive the collector. Each
+  // rule of `config` must have a node_kind, a type_name and a positive
+  // ttl_seconds.
+  GarbageCollector(
+      MetadataStorePool* metadata_store_pool,
+      const MetadataStoreServerConfig::GarbageCollectionConfig& config);
+
+  // Stops the background thread, after its current run if any.
+  ~GarbageCollector();
+
+  // Disallow copy and assign.
+  GarbageCollector(const GarbageCollector&) = delete;
+  GarbageCollector& operator=(const GarbageCollector&) = delete;
+
+  // Starts the background thread. It must be called at most once.
+  void Start();
+
+  // Runs each rule once as of `now`, and sets `num_deleted` to the number of
+  // deleted nodes. The expired idempotency keys of the store are also deleted,
+  // see ConnectionConfig.idempotency. A failed rule does not stop the other
+  // rules.
+  // Returns the error of the first failed rule, or of acquiring a store.
+  tensorflow::Status RunOnce(absl::Time now, int64* num_deleted);
+
+ private:
+  // Runs the rules every interval until `stopped_` is set.
+  void Run();
+
+  MetadataStorePool* const metadata_store_pool_;
+  const MetadataStoreServerConfig::GarbageCollectionConfig config_;
+  const absl::Duration interval_;
+
+  absl::Mutex mu_;
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+  std::thread thread_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_GARBAGE_COLLECTOR_H_
@@ -0,0 +1,135 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/garbage_collector.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+// The pool has a single store, whose in-memory database is seen by the
+// collector and the test.
+class GarbageCollectorTest : public ::testing::Test {
+ protected:
+  GarbageCollectorTest()
+      : metadata_store_pool_(FakeDatabaseConnectionConfig(),
+                             SingleStorePoolOptions()) {}
+
+  void SetUp() override {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(metadata_store_pool_.Acquire(&store));
+    PutTypesResponse put_types_response;
+    TF_ASSERT_OK(store->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"(
+                                   artifact_types: { name: 'expiring' }
+                                   artifact_types: { name: 'kept' }
+                                   execution_types: { name: 'expiring' }
+                                 )"),
+                                 &put_types_response));
+    PutArtifactsRequest put_artifacts_request;
+    for (const int64 type_id : {put_types_response.artifact_type_ids(0),
+                                put_types_response.artifact_type_ids(0),
+                                put_types_response.artifact_type_ids(1)}) {
+      put_artifacts_request.add_artifacts()->set_type_id(type_id);
+    }
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(
+        store->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+    PutExecutionsRequest put_executions_request;
+    put_executions_request.add_executions()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    PutExecutionsResponse put_executions_response;
+    TF_ASSERT_OK(
+        store->PutExecutions(put_executions_request, &put_executions_response));
+  }
+
+  static ConnectionConfig FakeDatabaseConnectionConfig() {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    return connection_config;
+  }
+
+  static MetadataStorePoolOptions SingleStorePoolOptions() {
+    MetadataStorePoolOptions options;
+    options.max_size = 1;
+    return options;
+  }
+
+  // Returns the number of artifacts and executions left in the store.
+  int NumNodes() {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_CHECK_OK(metadata_store_pool_.Acquire(&store));
+    GetArtifactsResponse get_artifacts_response;
+    TF_CHECK_OK(store->GetArtifacts({}, &get_artifacts_response));
+    GetExecutionsResponse get_executions_response;
+    TF_CHECK_OK(store->GetExecutions({}, &get_executions_response));
+    return get_artifacts_response.artifacts_size() +
+           get_executions_response.executions_size();
+  }
+
+  MetadataStorePool metadata_store_pool_;
+};
+
+TEST_F(GarbageCollectorTest, DeletesTheExpiredNodesOfTheRules) {
+  GarbageCollector garbage_collector(
+      &metadata_store_pool_,
+      ParseTextProtoOrDie<MetadataStoreServerConfig::GarbageCollectionConfig>(
+          R"(
+            rules: { node_kind: ARTIFACT type_name: 'expiring' ttl_seconds: 60 }
+            rules: {
+              node_kind: EXECUTION
+              type_name: 'expiring'
+              ttl_seconds: 60
+            }
+            rules: { node_kind: ARTIFACT type_name: 'unknown' ttl_seconds: 60 }
+            max_batch_size: 1
+          )"));
+
+  // Nothing has expired yet.
+  int64 num_deleted = -1;
+  TF_ASSERT_OK(garbage_collector.RunOnce(absl::Now(), &num_deleted));
+  EXPECT_EQ(num_deleted, 0);
+  EXPECT_EQ(NumNodes(), 4);
+
+  // Only the nodes of the types of the rules are deleted, in batches.
+  TF_ASSERT_OK(
+      garbage_collector.RunOnce(absl::Now() + absl::Hours(1), &num_deleted));
+  EXPECT_EQ(num_deleted, 3);
+  EXPECT_EQ(NumNodes(), 1);
+}
+
+TEST_F(GarbageCollectorTest, StopsOnDestruction) {
+  GarbageCollector garbage_collector(
+      &metadata_store_pool_,
+      ParseTextProtoOrDie<MetadataStoreServerConfig::GarbageCollectionConfig>(
+          R"(
+            rules: { node_kind: ARTIFACT type_name: 'expiring' ttl_seconds: 60 }
+            interval_seconds: 3600
+          )"));
+  garbage_collector.Start();
+  // The first run is an interval after the start.
+  EXPECT_EQ(NumNodes(), 4);
+}
+
+}  // namespace
+}  // namespace ml_metadata
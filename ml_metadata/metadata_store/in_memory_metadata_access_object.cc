@@ -0,0 +1,2743 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/util/message_differencer.h"
+#include <glog/logging.h>
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/list_operation_query_helper.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+
+namespace {
+
+template <typename Type>
+InMemoryDatabase::TypeTable<Type>& GetTypes(InMemoryDatabase& db);
+
+template <>
+InMemoryDatabase::TypeTable<ArtifactType>& GetTypes(InMemoryDatabase& db) {
+  return db.artifact_types;
+}
+
+template <>
+InMemoryDatabase::TypeTable<ExecutionType>& GetTypes(InMemoryDatabase& db) {
+  return db.execution_types;
+}
+
+template <>
+InMemoryDatabase::TypeTable<ContextType>& GetTypes(InMemoryDatabase& db) {
+  return db.context_types;
+}
+
+template <typename Node>
+InMemoryDatabase::NodeTable<Node>& GetNodes(InMemoryDatabase& db);
+
+template <>
+InMemoryDatabase::NodeTable<Artifact>& GetNodes(InMemoryDatabase& db) {
+  return db.artifacts;
+}
+
+template <>
+InMemoryDatabase::NodeTable<Execution>& GetNodes(InMemoryDatabase& db) {
+  return db.executions;
+}
+
+template <>
+InMemoryDatabase::NodeTable<Context>& GetNodes(InMemoryDatabase& db) {
+  return db.contexts;
+}
+
+// Returns the version of a type, which is empty if it is not set.
+template <typename Type>
+std::string GetTypeVersion(const Type& type) {
+  return type.has_version() ? type.version() : "";
+}
+
+// Validates properties in a `Node` with the properties defined in a `Type`.
+// Returns INVALID_ARGUMENT error, if there is unknown or mismatched property
+// w.r.t. its definition.
+template <typename Node, typename Type>
+absl::Status ValidatePropertiesWithType(const Node& node, const Type& type) {
+  const google::protobuf::Map<std::string, PropertyType>& type_properties =
+      type.properties();
+  for (const auto& p : node.properties()) {
+    const std::string& property_name = p.first;
+    const Value& property_value = p.second;
+    if (type_properties.find(property_name) == type_properties.end())
+      return absl::InvalidArgumentError(
+          absl::StrCat("Found unknown property: ", property_name));
+    bool is_type_match = false;
+    switch (type_properties.at(property_name)) {
+      case PropertyType::INT: {
+        is_type_match = property_value.has_int_value();
+        break;
+      }
+      case PropertyType::DOUBLE: {
+        is_type_match = property_value.has_double_value();
+        break;
+      }
+      case PropertyType::STRING: {
+        is_type_match = property_value.has_string_value();
+        break;
+      }
+      case PropertyType::STRUCT: {
+        is_type_match = property_value.has_struct_value();
+        break;
+      }
+      default: {
+        return absl::InternalError(absl::StrCat(
+            "Unknown registered property type: ", type.DebugString()));
+      }
+    }
+    if (!is_type_match)
+      return absl::InvalidArgumentError(
+          absl::StrCat("Found unmatched property type: ", property_name));
+  }
+  return absl::OkStatus();
+}
+
+// Returns true if the two nodes are equal other than their properties and the
+// output only timestamps.
+template <typename Node>
+bool NodeAttributesEqual(const Node& node, const Node& other_node) {
+  google::protobuf::util::MessageDifferencer diff;
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("properties"));
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("custom_properties"));
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("create_time_since_epoch"));
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("last_update_time_since_epoch"));
+  return diff.Compare(node, other_node);
+}
+
+// Returns true if the two property maps have the same values.
+bool PropertiesEqual(
+    const google::protobuf::Map<std::string, Value>& properties,
+    const google::protobuf::Map<std::string, Value>& other_properties) {
+  if (properties.size() != other_properties.size()) return false;
+  for (const auto& p : properties) {
+    const auto it = other_properties.find(p.first);
+    if (it == other_properties.end() ||
+        !google::protobuf::util::MessageDifferencer::Equals(p.second,
+                                                            it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the stored copies of the nodes, which keep the fields stored in the
+// tables of a relational database.
+Artifact ToStoredNode(const Artifact& artifact, const int64 id,
+                      const int64 now) {
+  Artifact stored;
+  stored.set_id(id);
+  stored.set_type_id(artifact.type_id());
+  stored.set_uri(artifact.uri());
+  if (artifact.has_state()) stored.set_state(artifact.state());
+  if (artifact.has_name()) stored.set_name(artifact.name());
+  *stored.mutable_properties() = artifact.properties();
+  *stored.mutable_custom_properties() = artifact.custom_properties();
+  stored.set_create_time_since_epoch(now);
+  stored.set_last_update_time_since_epoch(now);
+  return stored;
+}
+
+Execution ToStoredNode(const Execution& execution, const int64 id,
+                       const int64 now) {
+  Execution stored;
+  stored.set_id(id);
+  stored.set_type_id(execution.type_id());
+  if (execution.has_last_known_state()) {
+    stored.set_last_known_state(execution.last_known_state());
+  }
+  if (execution.has_name()) stored.set_name(execution.name());
+  *stored.mutable_properties() = execution.properties();
+  *stored.mutable_custom_properties() = execution.custom_properties();
+  stored.set_create_time_since_epoch(now);
+  stored.set_last_update_time_since_epoch(now);
+  return stored;
+}
+
+Context ToStoredNode(const Context& context, const int64 id,
+                     const int64 now) {
+  Context stored;
+  stored.set_id(id);
+  stored.set_type_id(context.type_id());
+  stored.set_name(context.name());
+  *stored.mutable_properties() = context.properties();
+  *stored.mutable_custom_properties() = context.custom_properties();
+  stored.set_create_time_since_epoch(now);
+  stored.set_last_update_time_since_epoch(now);
+  return stored;
+}
+
+absl::Status ValidateNewNode(const Artifact& artifact) {
+  return absl::OkStatus();
+}
+
+absl::Status ValidateNewNode(const Execution& execution) {
+  return absl::OkStatus();
+}
+
+absl::Status ValidateNewNode(const Context& context) {
+  if (!context.has_name() || context.name().empty()) {
+    return absl::InvalidArgumentError("Context name should not be empty");
+  }
+  return absl::OkStatus();
+}
+
+// Applies the attributes of an update to a stored node, i.e., the uri and the
+// state of an artifact, the state of an execution and the name of a context.
+void UpdateAttributes(const Artifact& artifact, Artifact& stored) {
+  stored.set_uri(artifact.uri());
+  if (artifact.has_state()) {
+    stored.set_state(artifact.state());
+  } else {
+    stored.clear_state();
+  }
+}
+
+void UpdateAttributes(const Execution& execution, Execution& stored) {
+  if (execution.has_last_known_state()) {
+    stored.set_last_known_state(execution.last_known_state());
+  } else {
+    stored.clear_last_known_state();
+  }
+}
+
+void UpdateAttributes(const Context& context, Context& stored) {
+  stored.set_name(context.name());
+}
+
+// Adds and removes a node to and from the indexes by name and uri.
+template <typename Node>
+void IndexNode(const Node& node, InMemoryDatabase& db) {
+  if (node.has_name()) {
+    GetNodes<Node>(db).ids_by_type_and_name[{node.type_id(), node.name()}] =
+        node.id();
+  }
+}
+
+template <>
+void IndexNode(const Artifact& artifact, InMemoryDatabase& db) {
+  if (artifact.has_name()) {
+    db.artifacts.ids_by_type_and_name[{artifact.type_id(), artifact.name()}] =
+        artifact.id();
+  }
+  db.artifact_ids_by_uri.insert({artifact.uri(), artifact.id()});
+}
+
+template <typename Node>
+void UnindexNode(const Node& node, InMemoryDatabase& db) {
+  if (node.has_name()) {
+    GetNodes<Node>(db).ids_by_type_and_name.erase(
+        std::make_pair(node.type_id(), node.name()));
+  }
+}
+
+template <>
+void UnindexNode(const Artifact& artifact, InMemoryDatabase& db) {
+  if (artifact.has_name()) {
+    db.artifacts.ids_by_type_and_name.erase(
+        std::make_pair(artifact.type_id(), artifact.name()));
+  }
+  db.artifact_ids_by_uri.erase({artifact.uri(), artifact.id()});
+}
+
+// Returns the value of the ordering field of ListOperationOptions.
+template <typename Node>
+int64 GetOrderingValue(const Node& node,
+                       const ListOperationOptions::OrderByField::Field field) {
+  switch (field) {
+    case ListOperationOptions::OrderByField::CREATE_TIME:
+      return node.create_time_since_epoch();
+    case ListOperationOptions::OrderByField::LAST_UPDATE_TIME:
+      return node.last_update_time_since_epoch();
+    default:
+      return node.id();
+  }
+}
+
+// Returns true if the node has the state of ListOperationOptions. Contexts
+// have no state, and are rejected before.
+bool MatchesState(const Artifact& artifact, const int state) {
+  return artifact.has_state() && artifact.state() == state;
+}
+bool MatchesState(const Execution& execution, const int state) {
+  return execution.has_last_known_state() &&
+         execution.last_known_state() == state;
+}
+bool MatchesState(const Context&, const int) { return false; }
+
+// Validates a property filter of ListOperationOptions.
+// Returns INVALID_ARGUMENT error, if the name, the operator or the value is
+// missing.
+absl::Status ValidatePropertyFilter(
+    const ListOperationOptions::PropertyFilter& filter) {
+  if (filter.name().empty()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "PropertyFilter must have a name: ", filter.DebugString()));
+  }
+  switch (filter.op()) {
+    case ListOperationOptions::PropertyFilter::EQ:
+    case ListOperationOptions::PropertyFilter::LT:
+    case ListOperationOptions::PropertyFilter::LE:
+    case ListOperationOptions::PropertyFilter::GT:
+    case ListOperationOptions::PropertyFilter::GE:
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "PropertyFilter must have an operator: ", filter.DebugString()));
+  }
+  switch (filter.value().value_case()) {
+    case Value::kIntValue:
+    case Value::kDoubleValue:
+    case Value::kStringValue:
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("PropertyFilter must have an int, double or string "
+                       "value: ",
+                       filter.DebugString()));
+  }
+  return absl::OkStatus();
+}
+
+// Returns true if `lhs` compares to `rhs` with the operator `op`.
+template <typename T>
+bool Compare(const T& lhs, const T& rhs,
+             const ListOperationOptions::PropertyFilter::Operator op) {
+  switch (op) {
+    case ListOperationOptions::PropertyFilter::EQ:
+      return lhs == rhs;
+    case ListOperationOptions::PropertyFilter::LT:
+      return lhs < rhs;
+    case ListOperationOptions::PropertyFilter::LE:
+      return lhs <= rhs;
+    case ListOperationOptions::PropertyFilter::GT:
+      return lhs > rhs;
+    case ListOperationOptions::PropertyFilter::GE:
+      return lhs >= rhs;
+    default:
+      return false;
+  }
+}
+
+// Returns true if the node has the property of a validated filter, with a
+// value of the same kind that matches it.
+template <typename Node>
+bool MatchesPropertyFilter(
+    const Node& node, const ListOperationOptions::PropertyFilter& filter) {
+  const google::protobuf::Map<std::string, Value>& properties =
+      filter.is_custom_property() ? node.custom_properties()
+                                  : node.properties();
+  const auto it = properties.find(filter.name());
+  if (it == properties.end() ||
+      it->second.value_case() != filter.value().value_case()) {
+    return false;
+  }
+  switch (filter.value().value_case()) {
+    case Value::kIntValue:
+      return Compare(it->second.int_value(), filter.value().int_value(),
+                     filter.op());
+    case Value::kDoubleValue:
+      return Compare(it->second.double_value(), filter.value().double_value(),
+                     filter.op());
+    case Value::kStringValue:
+      return Compare(it->second.string_value(), filter.value().string_value(),
+                     filter.op());
+    default:
+      return false;
+  }
+}
+
+// Returns the ids linked to `id` in `links_by_id` in increasing order.
+std::vector<int64> GetSortedLinkedIds(
+    const absl::flat_hash_map<int64, std::vector<int64>>& links_by_id,
+    const int64 id) {
+  const auto it = links_by_id.find(id);
+  if (it == links_by_id.end()) return {};
+  std::vector<int64> ids = it->second;
+  absl::c_sort(ids);
+  return ids;
+}
+
+// Removes the last value of the vector of `key`, and the vector if it is
+// empty then.
+void PopBack(const int64 key,
+             absl::flat_hash_map<int64, std::vector<int64>>& values_by_key) {
+  auto it = values_by_key.find(key);
+  CHECK(it != values_by_key.end());
+  it->second.pop_back();
+  if (it->second.empty()) values_by_key.erase(it);
+}
+
+// Removes `value` from `values`, and returns its position to restore it.
+size_t EraseValue(const int64 value, std::vector<int64>& values) {
+  const auto it = absl::c_find(values, value);
+  CHECK(it != values.end());
+  const size_t position = it - values.begin();
+  values.erase(it);
+  return position;
+}
+
+// Removes `value` from the vector of `key`, and the vector if it is empty
+// then. Returns the position of the value to restore it with InsertValue.
+size_t EraseValue(
+    const int64 key, const int64 value,
+    absl::flat_hash_map<int64, std::vector<int64>>& values_by_key) {
+  auto it = values_by_key.find(key);
+  CHECK(it != values_by_key.end());
+  const size_t position = EraseValue(value, it->second);
+  if (it->second.empty()) values_by_key.erase(it);
+  return position;
+}
+
+// Inserts `value` back at `position` of the vector of `key`.
+void InsertValue(
+    const int64 key, const int64 value, const size_t position,
+    absl::flat_hash_map<int64, std::vector<int64>>& values_by_key) {
+  std::vector<int64>& values = values_by_key[key];
+  values.insert(values.begin() + position, value);
+}
+
+// Removes the properties and custom properties of `nodes` which are not
+// selected by `property_options`.
+template <typename Node>
+void ApplyPropertyOptions(const PropertyOptions& property_options,
+                          std::vector<Node>& nodes) {
+  if (property_options.skip_properties()) {
+    for (Node& node : nodes) {
+      node.clear_properties();
+      node.clear_custom_properties();
+    }
+    return;
+  }
+  if (property_options.property_names().empty()) return;
+  const absl::flat_hash_set<std::string> names(
+      property_options.property_names().begin(),
+      property_options.property_names().end());
+  for (Node& node : nodes) {
+    for (google::protobuf::Map<std::string, Value>* properties :
+         {node.mutable_properties(), node.mutable_custom_properties()}) {
+      for (auto it = properties->begin(); it != properties->end();) {
+        if (names.contains(it->first)) {
+          ++it;
+        } else {
+          properties->erase(it++);
+        }
+      }
+    }
+  }
+}
+
+// Returns the state of `artifact`, if it has one.
+absl::optional<int> GetNodeState(const Artifact& artifact) {
+  return artifact.has_state() ? absl::make_optional<int>(artifact.state())
+                              : absl::nullopt;
+}
+
+// Returns the last_known_state of `execution`, if it has one.
+absl::optional<int> GetNodeState(const Execution& execution) {
+  return execution.has_last_known_state()
+             ? absl::make_optional<int>(execution.last_known_state())
+             : absl::nullopt;
+}
+
+}  // namespace
+
+void InMemoryMetadataAccessObject::SetSchemaState(
+    const bool has_tables, const bool has_missing_tables,
+    const absl::optional<int64> schema_version) {
+  InMemoryDatabase* const database = &db();
+  metadata_source_->AddUndo(
+      [database, old_has_tables = database->has_tables,
+       old_has_missing_tables = database->has_missing_tables,
+       old_schema_version = database->schema_version]() {
+        database->has_tables = old_has_tables;
+        database->has_missing_tables = old_has_missing_tables;
+        database->schema_version = old_schema_version;
+      });
+  database->has_tables = has_tables;
+  database->has_missing_tables = has_missing_tables;
+  database->schema_version = schema_version;
+}
+
+absl::Status InMemoryMetadataAccessObject::InitMetadataSource() {
+  const InMemoryDatabase& database = db();
+  if (database.schema_version &&
+      *database.schema_version != library_version_) {
+    return absl::DataLossError(absl::StrCat(
+        "The database cannot be initialized with the schema_version in the "
+        "current library. Current library version: ",
+        library_version_,
+        ", the db version on record is: ", *database.schema_version,
+        ". It may result from a data race condition caused by other "
+        "concurrent MLMD's migration procedures."));
+  }
+  SetSchemaState(/*has_tables=*/true, /*has_missing_tables=*/false,
+                 library_version_);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::InitMetadataSourceIfNotExists(
+    const bool enable_upgrade_migration) {
+  int64 db_version = 0;
+  const absl::Status get_schema_version_status = GetSchemaVersion(&db_version);
+  if (absl::IsNotFound(get_schema_version_status)) {
+    db_version = library_version_;
+  } else {
+    MLMD_RETURN_IF_ERROR(get_schema_version_status);
+  }
+  if (db_version > library_version_) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "MLMD database version ", db_version,
+        " is greater than library version ", library_version_,
+        ". Please upgrade the library to use the given database in order to "
+        "prevent potential data loss. If data loss is acceptable, please"
+        " downgrade the database using a newer version of library."));
+  }
+  if (db_version < library_version_) {
+    if (!enable_upgrade_migration) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "MLMD database version ", db_version,
+          " is older than library version ", library_version_,
+          ". Schema migration is disabled. Please upgrade the database then "
+          "use the library version; or switch to a older library version to "
+          "use the current database."));
+    }
+    // The records do not depend on the schema version, so the upgrade only
+    // records the version of the library.
+    SetSchemaState(db().has_tables, db().has_missing_tables, library_version_);
+  }
+  if (!db().has_tables) {
+    return InitMetadataSource();
+  }
+  if (db().has_missing_tables) {
+    return absl::AbortedError(
+        "There are a subset of tables in MLMD instance. This may be due to "
+        "concurrent connection to the empty database. "
+        "Please retry the connection.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DowngradeMetadataSource(
+    const int64 to_schema_version) {
+  if (to_schema_version < 0 || to_schema_version > library_version_) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "MLMD cannot be downgraded to schema_version: ", to_schema_version,
+        ". The target version should be greater or equal to 0, and the current"
+        " library version: ",
+        library_version_, " needs to be greater than the target version."));
+  }
+  int64 db_version = 0;
+  const absl::Status get_schema_version_status = GetSchemaVersion(&db_version);
+  if (absl::IsNotFound(get_schema_version_status)) {
+    return absl::InvalidArgumentError(
+        "Empty database is given. Downgrade operation is not needed.");
+  }
+  MLMD_RETURN_IF_ERROR(get_schema_version_status);
+  if (db_version > library_version_) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("MLMD database version ", db_version,
+                     " is greater than library version ", library_version_,
+                     ". The current library does not know how to downgrade it. "
+                     "Please upgrade the library to downgrade the schema."));
+  }
+  if (db_version > to_schema_version) {
+    SetSchemaState(db().has_tables, db().has_missing_tables,
+                   to_schema_version);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::MigrateSchemaStep(
+    const int64 to_schema_version, const int64 max_num_chunks,
+    SchemaMigrationProgress* progress) {
+  progress->Clear();
+  int64 db_version = 0;
+  MLMD_RETURN_IF_ERROR(GetSchemaVersion(&db_version));
+  if (db_version > to_schema_version) {
+    MLMD_RETURN_IF_ERROR(DowngradeMetadataSource(to_schema_version));
+  } else if (db_version < to_schema_version) {
+    if (to_schema_version > library_version_) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "MLMD cannot be upgraded to schema_version: ", to_schema_version,
+          ", which is newer than the library version: ", library_version_));
+    }
+    // The records do not depend on the schema version, so the migration is
+    // done in one step.
+    SetSchemaState(db().has_tables, db().has_missing_tables,
+                   to_schema_version);
+  }
+  progress->set_schema_version(to_schema_version);
+  progress->set_to_schema_version(to_schema_version);
+  progress->set_done(true);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::GetSchemaVersion(
+    int64* db_version) {
+  const InMemoryDatabase& database = db();
+  if (!database.has_tables) {
+    return absl::NotFoundError("it looks an empty db is given.");
+  }
+  if (!database.schema_version) {
+    return absl::AbortedError(
+        "In the given db, MLMDEnv table exists but no schema_version can be "
+        "found. This may be due to concurrent connection to the empty "
+        "database. Please retry connection.");
+  }
+  *db_version = *database.schema_version;
+  return absl::OkStatus();
+}
+
+int64 InMemoryMetadataAccessObject::GetLibraryVersion() {
+  return library_version_;
+}
+
+absl::Status InMemoryMetadataAccessObject::FindIdempotencyKey(
+    const absl::string_view idempotency_key, int64* request_fingerprint,
+    absl::Time* create_time, std::string* response) {
+  const auto it = db().idempotency_keys.find(idempotency_key);
+  if (it == db().idempotency_keys.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No idempotency key found: ", idempotency_key));
+  }
+  *request_fingerprint = it->second.request_fingerprint;
+  *create_time = it->second.create_time;
+  *response = it->second.response;
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateIdempotencyKey(
+    const absl::string_view idempotency_key, const int64 request_fingerprint,
+    const absl::Time create_time, const absl::string_view response) {
+  InMemoryDatabase* const database = &db();
+  if (!database->idempotency_keys
+           .insert({std::string(idempotency_key),
+                    {request_fingerprint, create_time, std::string(response)}})
+           .second) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "The idempotency key already exists: ", idempotency_key));
+  }
+  metadata_source_->AddUndo([database, key = std::string(idempotency_key)]() {
+    database->idempotency_keys.erase(key);
+  });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindIdempotencyKeysCreatedBefore(
+    const absl::Time create_time, const int64 max_num_keys,
+    std::vector<std::string>* idempotency_keys) {
+  idempotency_keys->clear();
+  for (const auto& key : db().idempotency_keys) {
+    if (idempotency_keys->size() >= max_num_keys) break;
+    if (key.second.create_time < create_time) {
+      idempotency_keys->push_back(key.first);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteIdempotencyKeys(
+    absl::Span<const std::string> idempotency_keys) {
+  InMemoryDatabase* const database = &db();
+  for (const std::string& key : idempotency_keys) {
+    const auto it = database->idempotency_keys.find(key);
+    if (it == database->idempotency_keys.end()) continue;
+    metadata_source_->AddUndo(
+        [database, key, stored_key = std::move(it->second)]() {
+          database->idempotency_keys.insert({key, stored_key});
+        });
+    database->idempotency_keys.erase(it);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateLineageClosureTable(
+    bool* created) {
+  InMemoryDatabase* const database = &db();
+  *created = !database->has_lineage_closure;
+  if (!*created) return absl::OkStatus();
+  database->has_lineage_closure = true;
+  metadata_source_->AddUndo(
+      [database]() { database->has_lineage_closure = false; });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateLineageClosure(
+    const absl::Span<const int64> upstream_artifact_ids,
+    const absl::Span<const int64> downstream_artifact_ids) {
+  InMemoryDatabase* const database = &db();
+  for (const int64 upstream_id : upstream_artifact_ids) {
+    for (const int64 downstream_id : downstream_artifact_ids) {
+      if (upstream_id == downstream_id) continue;
+      if (!database->upstream_artifact_ids[downstream_id]
+               .insert(upstream_id)
+               .second) {
+        continue;
+      }
+      database->downstream_artifact_ids[upstream_id].insert(downstream_id);
+      metadata_source_->AddUndo([database, upstream_id, downstream_id]() {
+        database->upstream_artifact_ids[downstream_id].erase(upstream_id);
+        database->downstream_artifact_ids[upstream_id].erase(downstream_id);
+      });
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindLineageClosure(
+    const absl::Span<const int64> artifact_ids, const bool upstream,
+    std::vector<int64>* related_artifact_ids) {
+  related_artifact_ids->clear();
+  const absl::flat_hash_map<int64, absl::flat_hash_set<int64>>& closure =
+      upstream ? db().upstream_artifact_ids : db().downstream_artifact_ids;
+  absl::flat_hash_set<int64> found_ids;
+  for (const int64 artifact_id : artifact_ids) {
+    const auto it = closure.find(artifact_id);
+    if (it == closure.end()) continue;
+    for (const int64 related_artifact_id : it->second) {
+      if (found_ids.insert(related_artifact_id).second) {
+        related_artifact_ids->push_back(related_artifact_id);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::CreateTypeImpl(const Type& type,
+                                                          int64* type_id) {
+  if (type.name().empty())
+    return absl::InvalidArgumentError("No type name is specified.");
+  for (const auto& property : type.properties()) {
+    if (property.second == PropertyType::UNKNOWN) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Property ", property.first, " is UNKNOWN."));
+    }
+  }
+  InMemoryDatabase* const database = &db();
+  InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(*database);
+  *type_id = ++database->last_type_id;
+  Type stored_type = type;
+  stored_type.set_id(*type_id);
+  if (stored_type.has_version() && stored_type.version().empty()) {
+    stored_type.clear_version();
+  }
+  // The lookups by name and version return the first type created with them.
+  const bool is_indexed =
+      types.ids_by_name_and_version
+          .insert({{type.name(), GetTypeVersion(stored_type)}, *type_id})
+          .second;
+  types.types[*type_id] = std::move(stored_type);
+  types.ids.push_back(*type_id);
+  metadata_source_->AddUndo([database, is_indexed, id = *type_id,
+                             key = std::make_pair(type.name(),
+                                                  GetTypeVersion(type))]() {
+    InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(*database);
+    if (is_indexed) types.ids_by_name_and_version.erase(key);
+    types.types.erase(id);
+    types.ids.pop_back();
+    database->last_type_id--;
+  });
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypeImpl(const int64 type_id,
+                                                        Type* type) {
+  const InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(db());
+  const auto it = types.types.find(type_id);
+  if (it == types.types.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No type found for query, type_id: ", type_id));
+  }
+  *type = it->second;
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypeImpl(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    Type* type) {
+  const InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(db());
+  const auto it = types.ids_by_name_and_version.find(std::make_pair(
+      std::string(name), version ? std::string(*version) : std::string()));
+  if (it == types.ids_by_name_and_version.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No type found for query, name: `", name, "`, version: `",
+                     version ? *version : "nullopt", "`"));
+  }
+  *type = types.types.at(it->second);
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypesByNamesAndVersionsImpl(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<Type>* types) {
+  const InMemoryDatabase::TypeTable<Type>& table = GetTypes<Type>(db());
+  types->clear();
+  absl::flat_hash_set<int64> found_ids;
+  for (const auto& name_and_version : names_and_versions) {
+    const auto it = table.ids_by_name_and_version.find(name_and_version);
+    if (it != table.ids_by_name_and_version.end() &&
+        found_ids.insert(it->second).second) {
+      types->push_back(table.types.at(it->second));
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypesImpl(
+    std::vector<Type>* types) {
+  const InMemoryDatabase::TypeTable<Type>& table = GetTypes<Type>(db());
+  types->reserve(types->size() + table.ids.size());
+  for (const int64 id : table.ids) {
+    types->push_back(table.types.at(id));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::UpdateTypeImpl(const Type& type) {
+  if (!type.has_name()) {
+    return absl::InvalidArgumentError("No type name is specified.");
+  }
+  Type stored_type;
+  MLMD_RETURN_IF_ERROR(FindTypeImpl(
+      type.name(),
+      type.has_version() && !type.version().empty()
+          ? absl::make_optional<absl::string_view>(type.version())
+          : absl::nullopt,
+      &stored_type));
+  if (type.has_id() && type.id() != stored_type.id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Given type id is different from the existing type: ",
+                     stored_type.DebugString()));
+  }
+  Type updated_type = stored_type;
+  for (const auto& p : type.properties()) {
+    const std::string& property_name = p.first;
+    const PropertyType property_type = p.second;
+    if (property_type == PropertyType::UNKNOWN) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Property:", property_name, " type should not be UNKNOWN."));
+    }
+    const auto stored_it = stored_type.properties().find(property_name);
+    if (stored_it != stored_type.properties().end()) {
+      if (stored_it->second != property_type) {
+        return absl::AlreadyExistsError(
+            absl::StrCat("Property:", property_name,
+                         " type is different from the existing type: ",
+                         stored_type.DebugString()));
+      }
+      continue;
+    }
+    (*updated_type.mutable_properties())[property_name] = property_type;
+  }
+  InMemoryDatabase* const database = &db();
+  GetTypes<Type>(*database).types[stored_type.id()] = std::move(updated_type);
+  metadata_source_->AddUndo(
+      [database, stored_type = std::move(stored_type)]() {
+        GetTypes<Type>(*database).types[stored_type.id()] = stored_type;
+      });
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeImpl(
+    const Type& type, const Type& parent_type) {
+  if (!type.has_id() || !parent_type.has_id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Missing id in the given types: ", type.DebugString(),
+                     parent_type.DebugString()));
+  }
+  const int64 type_id = type.id();
+  const int64 parent_type_id = parent_type.id();
+  InMemoryDatabase* const database = &db();
+  InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(*database);
+  // The link introduces a cycle if `type_id` is an ancestor of the parent,
+  // which is found by a DFS from the parent, as the existing links are
+  // acyclic.
+  std::vector<int64> ancestor_ids = {parent_type_id};
+  absl::flat_hash_set<int64> visited_ancestor_ids;
+  while (!ancestor_ids.empty()) {
+    const int64 ancestor_id = ancestor_ids.back();
+    if (ancestor_id == type_id) {
+      return absl::InvalidArgumentError(
+          "There is a cycle detected of the given parent type.");
+    }
+    ancestor_ids.pop_back();
+    if (!visited_ancestor_ids.insert(ancestor_id).second) continue;
+    const auto it = types.parent_ids.find(ancestor_id);
+    if (it != types.parent_ids.end()) {
+      ancestor_ids.insert(ancestor_ids.end(), it->second.begin(),
+                          it->second.end());
+    }
+  }
+  if (!types.parent_links.insert({type_id, parent_type_id}).second) {
+    return absl::AlreadyExistsError("The ParentType already exists.");
+  }
+  types.parent_ids[type_id].push_back(parent_type_id);
+  metadata_source_->AddUndo([database, type_id, parent_type_id]() {
+    InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(*database);
+    types.parent_links.erase({type_id, parent_type_id});
+    PopBack(type_id, types.parent_ids);
+  });
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindParentTypesImpl(
+    const int64 type_id, std::vector<Type>& output_parent_types) {
+  Type type;
+  MLMD_RETURN_IF_ERROR(FindTypeImpl(type_id, &type));
+  const InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(db());
+  for (const int64 parent_id : GetSortedLinkedIds(types.parent_ids, type_id)) {
+    Type parent_type;
+    MLMD_RETURN_IF_ERROR(FindTypeImpl(parent_id, &parent_type));
+    output_parent_types.push_back(std::move(parent_type));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeIdsImpl(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<Type>>& output_parent_types) {
+  const InMemoryDatabase::TypeTable<Type>& types = GetTypes<Type>(db());
+  for (const int64 type_id : type_ids) {
+    if (!types.types.contains(type_id)) continue;
+    const std::vector<int64> parent_ids =
+        GetSortedLinkedIds(types.parent_ids, type_id);
+    if (parent_ids.empty()) continue;
+    std::vector<Type>& parent_types = output_parent_types[type_id];
+    parent_types.clear();
+    for (const int64 parent_id : parent_ids) {
+      parent_types.push_back(types.types.at(parent_id));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ArtifactType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ExecutionType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ContextType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(
+    const ArtifactType& type) {
+  return UpdateTypeImpl(type);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(
+    const ExecutionType& type) {
+  return UpdateTypeImpl(type);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(const ContextType& type) {
+  return UpdateTypeImpl(type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ArtifactType* artifact_type) {
+  return FindTypeImpl(type_id, artifact_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ExecutionType* execution_type) {
+  return FindTypeImpl(type_id, execution_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ContextType* context_type) {
+  return FindTypeImpl(type_id, context_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ArtifactType* artifact_type) {
+  return FindTypeImpl(name, version, artifact_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ExecutionType* execution_type) {
+  return FindTypeImpl(name, version, execution_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ContextType* context_type) {
+  return FindTypeImpl(name, version, context_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ArtifactType>* artifact_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, artifact_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ExecutionType>* execution_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, execution_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ContextType>* context_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, context_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ArtifactType>* artifact_types) {
+  return FindTypesImpl(artifact_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ExecutionType>* execution_types) {
+  return FindTypesImpl(execution_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ContextType>* context_types) {
+  return FindTypesImpl(context_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ArtifactType& type, const ArtifactType& parent_type) {
+  return CreateParentTypeImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ExecutionType& type, const ExecutionType& parent_type) {
+  return CreateParentTypeImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ContextType& type, const ContextType& parent_type) {
+  return CreateParentTypeImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ArtifactType>& output_parent_types) {
+  return FindParentTypesImpl(type_id, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ExecutionType>& output_parent_types) {
+  return FindParentTypesImpl(type_id, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ContextType>& output_parent_types) {
+  return FindParentTypesImpl(type_id, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+        output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+        output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ContextType>>& output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
+template <typename Node>
+void InMemoryMetadataAccessObject::InsertNode(const Node& node) {
+  InMemoryDatabase* const database = &db();
+  InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(*database);
+  table.nodes[node.id()] = node;
+  table.ids.push_back(node.id());
+  table.ids_by_type[node.type_id()].push_back(node.id());
+  IndexNode(node, *database);
+  metadata_source_->AddUndo([database, id = node.id()]() {
+    InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(*database);
+    const auto it = table.nodes.find(id);
+    UnindexNode(it->second, *database);
+    PopBack(it->second.type_id(), table.ids_by_type);
+    table.ids.pop_back();
+    table.nodes.erase(it);
+    table.last_id--;
+  });
+}
+
+template <typename Node>
+void InMemoryMetadataAccessObject::ReplaceNode(const Node& node) {
+  InMemoryDatabase* const database = &db();
+  Node& stored_node = GetNodes<Node>(*database).nodes.at(node.id());
+  UnindexNode(stored_node, *database);
+  Node old_node = std::move(stored_node);
+  stored_node = node;
+  IndexNode(stored_node, *database);
+  metadata_source_->AddUndo([database, old_node = std::move(old_node)]() {
+    Node& stored_node = GetNodes<Node>(*database).nodes.at(old_node.id());
+    UnindexNode(stored_node, *database);
+    stored_node = old_node;
+    IndexNode(stored_node, *database);
+  });
+}
+
+template <typename Node>
+void InMemoryMetadataAccessObject::EraseNode(const int64 id) {
+  InMemoryDatabase* const database = &db();
+  InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(*database);
+  const auto it = table.nodes.find(id);
+  if (it == table.nodes.end()) return;
+  Node node = std::move(it->second);
+  table.nodes.erase(it);
+  UnindexNode(node, *database);
+  const size_t position = EraseValue(id, table.ids);
+  const size_t type_position =
+      EraseValue(node.type_id(), id, table.ids_by_type);
+  metadata_source_->AddUndo(
+      [database, node = std::move(node), position, type_position]() {
+        InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(*database);
+        table.ids.insert(table.ids.begin() + position, node.id());
+        InsertValue(node.type_id(), node.id(), type_position,
+                    table.ids_by_type);
+        IndexNode(node, *database);
+        table.nodes[node.id()] = node;
+      });
+}
+
+void InMemoryMetadataAccessObject::EraseLink(
+    const int64 from_id, const int64 to_id,
+    InMemoryDatabase::LinkTable& links) {
+  links.links.erase({from_id, to_id});
+  const size_t from_position = EraseValue(from_id, to_id, links.ids_by_from_id);
+  const size_t to_position = EraseValue(to_id, from_id, links.ids_by_to_id);
+  InMemoryDatabase::LinkTable* const link_table = &links;
+  metadata_source_->AddUndo(
+      [link_table, from_id, to_id, from_position, to_position]() {
+        link_table->links.insert({from_id, to_id});
+        InsertValue(from_id, to_id, from_position, link_table->ids_by_from_id);
+        InsertValue(to_id, from_id, to_position, link_table->ids_by_to_id);
+      });
+}
+
+void InMemoryMetadataAccessObject::UnlinkEvent(const int64 event_id) {
+  InMemoryDatabase* const database = &db();
+  const Event& event = database->events[event_id - 1];
+  const size_t artifact_position = EraseValue(
+      event.artifact_id(), event_id, database->event_ids_by_artifact);
+  const size_t execution_position = EraseValue(
+      event.execution_id(), event_id, database->event_ids_by_execution);
+  metadata_source_->AddUndo(
+      [database, event_id, artifact_position, execution_position]() {
+        const Event& event = database->events[event_id - 1];
+        InsertValue(event.artifact_id(), event_id, artifact_position,
+                    database->event_ids_by_artifact);
+        InsertValue(event.execution_id(), event_id, execution_position,
+                    database->event_ids_by_execution);
+      });
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::DeleteNodesImpl(
+    const absl::Span<const int64> node_ids,
+    absl::flat_hash_map<int64, std::vector<int64>>& event_ids_by_node,
+    InMemoryDatabase::LinkTable& context_links) {
+  for (const int64 id : node_ids) {
+    if (!GetNodes<Node>(db()).nodes.contains(id)) continue;
+    // the linked ids are copied, as they are erased while visited.
+    for (const int64 event_id : GetSortedLinkedIds(event_ids_by_node, id)) {
+      UnlinkEvent(event_id);
+    }
+    for (const int64 context_id :
+         GetSortedLinkedIds(context_links.ids_by_to_id, id)) {
+      EraseLink(context_id, id, context_links);
+    }
+    EraseNode<Node>(id);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodeIdsUpdatedBeforeImpl(
+    const int64 type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* node_ids) {
+  if (limit <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("limit must be positive: ", limit));
+  }
+  node_ids->clear();
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  const auto it = table.ids_by_type.find(type_id);
+  if (it == table.ids_by_type.end()) return absl::OkStatus();
+  std::vector<std::pair<int64, int64>> updates;
+  for (const int64 id : it->second) {
+    const int64 last_update_time =
+        table.nodes.at(id).last_update_time_since_epoch();
+    if (last_update_time < last_update_time_since_epoch) {
+      updates.push_back({last_update_time, id});
+    }
+  }
+  absl::c_sort(updates);
+  if (static_cast<int64>(updates.size()) > limit) updates.resize(limit);
+  node_ids->reserve(updates.size());
+  for (const std::pair<int64, int64>& update : updates) {
+    node_ids->push_back(update.second);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node, typename NodeType>
+absl::Status InMemoryMetadataAccessObject::CreateNodesImpl(
+    const absl::Span<const Node> nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  // validate all the nodes, including the uniqueness of their names.
+  absl::flat_hash_map<int64, NodeType> types;
+  absl::flat_hash_set<std::pair<int64, std::string>> new_names;
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return absl::InvalidArgumentError("Type id is missing.");
+    auto it = types.find(node.type_id());
+    if (it == types.end()) {
+      NodeType node_type;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          FindTypeImpl(node.type_id(), &node_type), "Cannot find type for ",
+          node.ShortDebugString());
+      it = types.insert({node.type_id(), std::move(node_type)}).first;
+    }
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, it->second),
+        "Cannot validate properties of ", node.ShortDebugString());
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ValidateNewNode(node),
+                                      "Cannot create node for ",
+                                      node.ShortDebugString());
+    if (node.has_name()) {
+      std::pair<int64, std::string> key = {node.type_id(), node.name()};
+      if (table.ids_by_type_and_name.contains(key) ||
+          !new_names.insert(std::move(key)).second) {
+        return absl::AlreadyExistsError(
+            absl::StrCat(nodes.size() == 1 ? "Given node already exists: "
+                                           : "Given nodes already exist: ",
+                         node.DebugString()));
+      }
+    }
+  }
+
+  // insert the nodes, which then have the same creation time.
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  node_ids->reserve(nodes.size());
+  for (const Node& node : nodes) {
+    const int64 node_id = ++table.last_id;
+    InsertNode(ToStoredNode(node, node_id, now));
+    node_ids->push_back(node_id);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodesImpl(
+    const absl::Span<const int64> node_ids, const bool skipped_ids_ok,
+    std::vector<Node>& nodes) {
+  if (node_ids.empty()) {
+    return absl::InvalidArgumentError("ids cannot be empty");
+  }
+  if (!nodes.empty()) {
+    return absl::InvalidArgumentError("nodes parameter is not empty");
+  }
+  std::vector<int64> sorted_ids(node_ids.begin(), node_ids.end());
+  absl::c_sort(sorted_ids);
+  sorted_ids.erase(std::unique(sorted_ids.begin(), sorted_ids.end()),
+                   sorted_ids.end());
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  nodes.reserve(sorted_ids.size());
+  for (const int64 id : sorted_ids) {
+    const auto it = table.nodes.find(id);
+    if (it != table.nodes.end()) {
+      nodes.push_back(it->second);
+    }
+  }
+
+  if (node_ids.size() != nodes.size()) {
+    std::vector<int64> found_ids;
+    absl::c_transform(nodes, std::back_inserter(found_ids),
+                      [](const Node& node) { return node.id(); });
+
+    const std::string message = absl::StrCat(
+        "Results missing for ids: {", absl::StrJoin(node_ids, ","),
+        "}. Found results for {", absl::StrJoin(found_ids, ","), "}");
+
+    if (!skipped_ids_ok) {
+      return absl::InternalError(message);
+    } else {
+      return absl::NotFoundError(message);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindAllNodesImpl(
+    std::vector<Node>* nodes) {
+  const std::vector<int64>& ids = GetNodes<Node>(db()).ids;
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes);
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::StreamNodesImpl(
+    const NodeBatchCallback<Node>& callback) {
+  // The ids are copied, as the callback may write to the database.
+  const std::vector<int64> ids = GetNodes<Node>(db()).ids;
+  const absl::Span<const int64> node_ids = absl::MakeConstSpan(ids);
+  for (size_t begin = 0; begin < node_ids.size();
+       begin += kNodeStreamingBatchSize) {
+    std::vector<Node> nodes;
+    MLMD_RETURN_IF_ERROR(
+        FindNodesImpl(node_ids.subspan(begin, kNodeStreamingBatchSize),
+                      /*skipped_ids_ok=*/false, nodes));
+    MLMD_RETURN_IF_ERROR(callback(nodes));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::StreamNodesUpdatedAfterImpl(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Node>& callback) {
+  const std::pair<int64, int64> watermark(last_update_time_since_epoch, id);
+  // The changes are collected first, as the callback may write to the
+  // database.
+  std::vector<std::pair<int64, int64>> changes;
+  for (const auto& id_and_node : GetNodes<Node>(db()).nodes) {
+    const std::pair<int64, int64> change(
+        id_and_node.second.last_update_time_since_epoch(), id_and_node.first);
+    if (change > watermark) {
+      changes.push_back(change);
+    }
+  }
+  absl::c_sort(changes);
+  std::vector<Node> nodes;
+  for (const std::pair<int64, int64>& change : changes) {
+    const auto& table = GetNodes<Node>(db()).nodes;
+    const auto it = table.find(change.second);
+    if (it == table.end()) {
+      continue;
+    }
+    nodes.push_back(it->second);
+    if (static_cast<int>(nodes.size()) == kNodeStreamingBatchSize) {
+      MLMD_RETURN_IF_ERROR(callback(nodes));
+      nodes.clear();
+    }
+  }
+  if (!nodes.empty()) {
+    MLMD_RETURN_IF_ERROR(callback(nodes));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodesByTypeIdImpl(
+    const int64 type_id, const absl::string_view message,
+    std::vector<Node>* nodes) {
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  const auto it = table.ids_by_type.find(type_id);
+  if (it == table.ids_by_type.end()) {
+    return absl::NotFoundError(absl::StrCat(message, type_id));
+  }
+  return FindNodesImpl(it->second, /*skipped_ids_ok=*/false, *nodes);
+}
+
+template <typename Node>
+int64 InMemoryMetadataAccessObject::CountNodesImpl(
+    const absl::optional<int64> type_id,
+    const std::function<bool(const Node&)>& matches) {
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  int64 count = 0;
+  if (type_id) {
+    const auto it = table.ids_by_type.find(*type_id);
+    if (it == table.ids_by_type.end()) {
+      return 0;
+    }
+    for (const int64 id : it->second) {
+      if (matches(table.nodes.at(id))) {
+        count++;
+      }
+    }
+    return count;
+  }
+  for (const auto& id_and_node : table.nodes) {
+    if (matches(id_and_node.second)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+template <typename Node>
+void InMemoryMetadataAccessObject::AggregateNodePropertyImpl(
+    const int64 type_id, const PropertyAggregationOptions& options,
+    const InMemoryDatabase::LinkTable& context_links,
+    std::vector<PropertyAggregate>* aggregates) {
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  absl::flat_hash_set<int64> context_node_ids;
+  if (options.has_context_id()) {
+    const auto it = context_links.ids_by_from_id.find(options.context_id());
+    if (it != context_links.ids_by_from_id.end()) {
+      context_node_ids.insert(it->second.begin(), it->second.end());
+    }
+  }
+  // The aggregates by state, along with the sums of their values.
+  std::map<absl::optional<int>, std::pair<PropertyAggregate, double>> groups;
+  if (!options.group_by_state()) {
+    groups[absl::nullopt];
+  }
+  const auto ids_it = table.ids_by_type.find(type_id);
+  const std::vector<int64> no_ids;
+  for (const int64 id :
+       ids_it != table.ids_by_type.end() ? ids_it->second : no_ids) {
+    if (options.has_context_id() && !context_node_ids.contains(id)) {
+      continue;
+    }
+    const Node& node = table.nodes.at(id);
+    std::pair<PropertyAggregate, double>& group =
+        groups[options.group_by_state() ? GetNodeState(node) : absl::nullopt];
+    PropertyAggregate& aggregate = group.first;
+    aggregate.set_num_nodes(aggregate.num_nodes() + 1);
+    if (!options.has_property_name()) {
+      continue;
+    }
+    const google::protobuf::Map<std::string, Value>& properties =
+        options.is_custom_property() ? node.custom_properties()
+                                     : node.properties();
+    const auto property_it = properties.find(options.property_name());
+    if (property_it == properties.end()) {
+      continue;
+    }
+    double value;
+    if (property_it->second.has_int_value()) {
+      value = property_it->second.int_value();
+    } else if (property_it->second.has_double_value()) {
+      value = property_it->second.double_value();
+    } else {
+      continue;
+    }
+    if (aggregate.num_values() == 0) {
+      aggregate.set_min_value(value);
+      aggregate.set_max_value(value);
+    } else {
+      aggregate.set_min_value(std::min(aggregate.min_value(), value));
+      aggregate.set_max_value(std::max(aggregate.max_value(), value));
+    }
+    aggregate.set_num_values(aggregate.num_values() + 1);
+    group.second += value;
+  }
+  for (auto& state_and_group : groups) {
+    PropertyAggregate& aggregate = state_and_group.second.first;
+    if (state_and_group.first) {
+      aggregate.set_state(*state_and_group.first);
+    }
+    aggregate.set_num_nodes(aggregate.num_nodes());
+    aggregate.set_num_values(aggregate.num_values());
+    if (aggregate.num_values() > 0) {
+      aggregate.set_avg_value(state_and_group.second.second /
+                              aggregate.num_values());
+    }
+    aggregates->push_back(aggregate);
+  }
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodeByTypeIdAndNameImpl(
+    const int64 type_id, const absl::string_view name,
+    const absl::string_view message, Node* node) {
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  const auto it = table.ids_by_type_and_name.find(
+      std::make_pair(type_id, std::string(name)));
+  if (it == table.ids_by_type_and_name.end()) {
+    return absl::NotFoundError(message);
+  }
+  *node = table.nodes.at(it->second);
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodesByTypeIdAndNamesImpl(
+    const int64 type_id, const absl::Span<const std::string> names,
+    std::vector<Node>* nodes) {
+  nodes->clear();
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  absl::flat_hash_set<std::string> visited_names;
+  for (const std::string& name : names) {
+    if (!visited_names.insert(name).second) continue;
+    const auto it =
+        table.ids_by_type_and_name.find(std::make_pair(type_id, name));
+    if (it != table.ids_by_type_and_name.end()) {
+      nodes->push_back(table.nodes.at(it->second));
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node, typename NodeType>
+absl::Status InMemoryMetadataAccessObject::UpdateNodesImpl(
+    const absl::Span<const Node> nodes, const bool check_last_update_time) {
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  // validate all the nodes before updating any of them.
+  absl::flat_hash_set<int64> unique_node_ids;
+  for (const Node& node : nodes) {
+    if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
+    if (!unique_node_ids.insert(node.id()).second) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("The given id ", node.id(), " is updated twice"));
+    }
+  }
+  absl::flat_hash_map<int64, NodeType> types;
+  std::vector<Node> updated_nodes;
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  for (const Node& node : nodes) {
+    const auto stored_node_it = table.nodes.find(node.id());
+    if (stored_node_it == table.nodes.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Cannot find the given id ", node.id()));
+    }
+    const Node& stored_node = stored_node_it->second;
+    if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Given type_id ", node.type_id(),
+          " is different from the one known before: ", stored_node.type_id()));
+    }
+    if (check_last_update_time &&
+        node.last_update_time_since_epoch() !=
+            stored_node.last_update_time_since_epoch()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The stored node with id = ", node.id(),
+          " has a different last_update_time_since_epoch: ",
+          stored_node.last_update_time_since_epoch(),
+          " from the one in the given node: ",
+          node.last_update_time_since_epoch()));
+    }
+    auto type_it = types.find(stored_node.type_id());
+    if (type_it == types.end()) {
+      NodeType stored_type;
+      MLMD_RETURN_IF_ERROR(FindTypeImpl(stored_node.type_id(), &stored_type));
+      type_it = types.insert({stored_node.type_id(), std::move(stored_type)})
+                    .first;
+    }
+    MLMD_RETURN_IF_ERROR(ValidatePropertiesWithType(node, type_it->second));
+    const bool properties_changed =
+        !PropertiesEqual(node.properties(), stored_node.properties()) ||
+        !PropertiesEqual(node.custom_properties(),
+                         stored_node.custom_properties());
+    if (!check_last_update_time && !properties_changed &&
+        NodeAttributesEqual(node, stored_node)) {
+      continue;
+    }
+    Node updated_node = stored_node;
+    UpdateAttributes(node, updated_node);
+    MLMD_RETURN_IF_ERROR(ValidateNewNode(updated_node));
+    *updated_node.mutable_properties() = node.properties();
+    *updated_node.mutable_custom_properties() = node.custom_properties();
+    updated_node.set_last_update_time_since_epoch(
+        check_last_update_time
+            ? std::max<int64>(now,
+                              stored_node.last_update_time_since_epoch() + 1)
+            : now);
+    if (updated_node.has_name() && updated_node.name() != stored_node.name()) {
+      const auto name_it = table.ids_by_type_and_name.find(
+          std::make_pair(updated_node.type_id(), updated_node.name()));
+      if (name_it != table.ids_by_type_and_name.end() &&
+          name_it->second != updated_node.id()) {
+        return absl::AlreadyExistsError(absl::StrCat(
+            "Given node already exists: ", updated_node.DebugString()));
+      }
+    }
+    updated_nodes.push_back(std::move(updated_node));
+  }
+  for (const Node& updated_node : updated_nodes) {
+    ReplaceNode(updated_node);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::ListNodes(
+    const ListOperationOptions& options,
+    absl::optional<absl::Span<const int64>> candidate_ids,
+    std::vector<Node>* nodes, std::string* next_page_token) {
+  if (options.max_result_size() <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_result_size field value is required to be greater "
+                     "than 0 and less than or equal to 100. Set value:",
+                     options.max_result_size()));
+  }
+  if (!nodes->empty()) {
+    return absl::InvalidArgumentError("nodes argument is not empty");
+  }
+  if (candidate_ids && candidate_ids->empty()) {
+    return absl::OkStatus();
+  }
+  for (const ListOperationOptions::PropertyFilter& filter :
+       options.property_filters()) {
+    MLMD_RETURN_IF_ERROR(ValidatePropertyFilter(filter));
+  }
+  if (options.has_state() && std::is_same<Node, Context>::value) {
+    return absl::InvalidArgumentError(
+        "Contexts cannot be listed with a state.");
+  }
+
+  // The threshold of the ordering field is strict for the ids and inclusive
+  // for the timestamps, whose ties are broken by the ids of the previous page.
+  const ListOperationOptions::OrderByField::Field field =
+      options.order_by_field().field();
+  const bool is_asc = options.order_by_field().is_asc();
+  int64 field_offset = is_asc ? 0 : LLONG_MAX;
+  absl::optional<int64> id_offset;
+  absl::flat_hash_set<int64> listed_ids;
+  if (!options.next_page_token().empty()) {
+    ListOperationNextPageToken token;
+    MLMD_RETURN_IF_ERROR(
+        DecodeListOperationNextPageToken(options.next_page_token(), token));
+    MLMD_RETURN_IF_ERROR(
+        ValidateListOperationOptionsAreIdentical(token.set_options(), options));
+    field_offset = token.field_offset();
+    if (field == ListOperationOptions::OrderByField::CREATE_TIME ||
+        (field == ListOperationOptions::OrderByField::LAST_UPDATE_TIME &&
+         token.has_id_offset())) {
+      id_offset = token.id_offset();
+    } else if (field == ListOperationOptions::OrderByField::LAST_UPDATE_TIME) {
+      if (token.listed_ids().empty()) {
+        return absl::InternalError(
+            "Invalid NextPageToken in List Operation. listed_ids field should "
+            "not be empty.");
+      }
+      listed_ids.insert(token.listed_ids().begin(), token.listed_ids().end());
+    }
+  }
+  switch (field) {
+    case ListOperationOptions::OrderByField::CREATE_TIME:
+    case ListOperationOptions::OrderByField::LAST_UPDATE_TIME:
+    case ListOperationOptions::OrderByField::ID:
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported field: ",
+                       ListOperationOptions::OrderByField::Field_Name(field),
+                       " specified in ListOperationOptions"));
+  }
+  const bool is_id_field = field == ListOperationOptions::OrderByField::ID;
+
+  std::vector<int64> ids;
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  if (candidate_ids) {
+    ids.assign(candidate_ids->begin(), candidate_ids->end());
+    absl::c_sort(ids);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  }
+  const std::vector<int64>& scanned_ids = candidate_ids ? ids : table.ids;
+  std::vector<const Node*> matched_nodes;
+  for (const int64 id : scanned_ids) {
+    const auto it = table.nodes.find(id);
+    if (it == table.nodes.end()) continue;
+    const Node& node = it->second;
+    const int64 value = GetOrderingValue(node, field);
+    if (is_asc ? (is_id_field ? value <= field_offset : value < field_offset)
+               : (is_id_field ? value >= field_offset
+                              : value > field_offset)) {
+      continue;
+    }
+    // The id offset of a last update time only applies to its ties.
+    if (id_offset && (is_asc ? id <= *id_offset : id >= *id_offset) &&
+        (field == ListOperationOptions::OrderByField::CREATE_TIME ||
+         value == field_offset)) {
+      continue;
+    }
+    if (listed_ids.contains(id)) continue;
+    if (options.has_type_id() && node.type_id() != options.type_id()) continue;
+    if (options.has_state() && !MatchesState(node, options.state())) continue;
+    if (!absl::c_all_of(
+            options.property_filters(),
+            [&node](const ListOperationOptions::PropertyFilter& filter) {
+              return MatchesPropertyFilter(node, filter);
+            })) {
+      continue;
+    }
+    matched_nodes.push_back(&node);
+  }
+
+  // Retrieving page of size 1 greater that the page size to detect if this
+  // is the last page.
+  const size_t page_size = GetListOperationPageSize(options);
+  const auto precedes = [field, is_asc](const Node* a, const Node* b) {
+    const int64 a_value = GetOrderingValue(*a, field);
+    const int64 b_value = GetOrderingValue(*b, field);
+    if (a_value != b_value) {
+      return is_asc ? a_value < b_value : a_value > b_value;
+    }
+    return is_asc ? a->id() < b->id() : a->id() > b->id();
+  };
+  const size_t num_nodes = std::min(matched_nodes.size(), page_size + 1);
+  std::partial_sort(matched_nodes.begin(), matched_nodes.begin() + num_nodes,
+                    matched_nodes.end(), precedes);
+  if (num_nodes == 0) {
+    return absl::OkStatus();
+  }
+  nodes->reserve(num_nodes);
+  for (size_t i = 0; i < num_nodes; i++) {
+    nodes->push_back(*matched_nodes[i]);
+  }
+
+  if (nodes->size() > page_size) {
+    // Removing the extra node retrieved for last page detection.
+    nodes->pop_back();
+    MLMD_RETURN_IF_ERROR(BuildListOperationNextPageToken<Node>(
+        *nodes, options, next_page_token));
+  } else {
+    *next_page_token = "";
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateArtifact(
+    const Artifact& artifact, int64* artifact_id) {
+  std::vector<int64> artifact_ids;
+  MLMD_RETURN_IF_ERROR((CreateNodesImpl<Artifact, ArtifactType>(
+      absl::MakeConstSpan(&artifact, 1), &artifact_ids)));
+  *artifact_id = artifact_ids[0];
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts,
+    std::vector<int64>* artifact_ids) {
+  return CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateExecution(
+    const Execution& execution, int64* execution_id) {
+  std::vector<int64> execution_ids;
+  MLMD_RETURN_IF_ERROR((CreateNodesImpl<Execution, ExecutionType>(
+      absl::MakeConstSpan(&execution, 1), &execution_ids)));
+  *execution_id = execution_ids[0];
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* execution_ids) {
+  return CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContext(const Context& context,
+                                                         int64* context_id) {
+  std::vector<int64> context_ids;
+  MLMD_RETURN_IF_ERROR((CreateNodesImpl<Context, ContextType>(
+      absl::MakeConstSpan(&context, 1), &context_ids)));
+  *context_id = context_ids[0];
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContextIfNotExist(
+    const Context& context, int64* context_id, bool* created) {
+  Context existing_context;
+  const absl::Status status = FindContextByTypeIdAndContextName(
+      context.type_id(), context.name(), &existing_context);
+  if (status.ok()) {
+    *context_id = existing_context.id();
+    *created = false;
+    return absl::OkStatus();
+  }
+  if (!absl::IsNotFound(status)) return status;
+  MLMD_RETURN_IF_ERROR(CreateContext(context, context_id));
+  *created = true;
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts, std::vector<int64>* context_ids) {
+  return CreateNodesImpl<Context, ContextType>(contexts, context_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<Artifact>* artifacts) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(artifact_ids, /*skipped_ids_ok=*/true, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts) {
+  const absl::Status status = FindArtifactsById(artifact_ids, artifacts);
+  ApplyPropertyOptions(property_options, *artifacts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Execution>* executions) {
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(execution_ids, /*skipped_ids_ok=*/true, *executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    const PropertyOptions& property_options,
+    std::vector<Execution>* executions) {
+  const absl::Status status = FindExecutionsById(execution_ids, executions);
+  ApplyPropertyOptions(property_options, *executions);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids, std::vector<Context>* contexts) {
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/true, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids,
+    const PropertyOptions& property_options, std::vector<Context>* contexts) {
+  const absl::Status status = FindContextsById(context_ids, contexts);
+  ApplyPropertyOptions(property_options, *contexts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifacts(
+    std::vector<Artifact>* artifacts) {
+  return FindAllNodesImpl(artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifacts(
+    const NodeBatchCallback<Artifact>& callback) {
+  return StreamNodesImpl(callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifacts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Artifact>& callback) {
+  return StreamNodesImpl<Artifact>(
+      [&property_options, &callback](absl::Span<const Artifact> batch) {
+        std::vector<Artifact> nodes(batch.begin(), batch.end());
+        ApplyPropertyOptions(property_options, nodes);
+        return callback(nodes);
+      });
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Artifact>& callback) {
+  return StreamNodesUpdatedAfterImpl(last_update_time_since_epoch, id,
+                                     callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutions(
+    std::vector<Execution>* executions) {
+  return FindAllNodesImpl(executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutions(
+    const NodeBatchCallback<Execution>& callback) {
+  return StreamNodesImpl(callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutions(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Execution>& callback) {
+  return StreamNodesImpl<Execution>(
+      [&property_options, &callback](absl::Span<const Execution> batch) {
+        std::vector<Execution> nodes(batch.begin(), batch.end());
+        ApplyPropertyOptions(property_options, nodes);
+        return callback(nodes);
+      });
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Execution>& callback) {
+  return StreamNodesUpdatedAfterImpl(last_update_time_since_epoch, id,
+                                     callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContexts(
+    std::vector<Context>* contexts) {
+  return FindAllNodesImpl(contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContexts(
+    const NodeBatchCallback<Context>& callback) {
+  return StreamNodesImpl(callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContexts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Context>& callback) {
+  return StreamNodesImpl<Context>(
+      [&property_options, &callback](absl::Span<const Context> batch) {
+        std::vector<Context> nodes(batch.begin(), batch.end());
+        ApplyPropertyOptions(property_options, nodes);
+        return callback(nodes);
+      });
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Context>& callback) {
+  return StreamNodesUpdatedAfterImpl(last_update_time_since_epoch, id,
+                                     callback);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
+  return ListNodes<Artifact>(options, absl::nullopt, artifacts,
+                             next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
+  const absl::Status status =
+      ListArtifacts(options, artifacts, next_page_token);
+  ApplyPropertyOptions(property_options, *artifacts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options, std::vector<Execution>* executions,
+    std::string* next_page_token) {
+  return ListNodes<Execution>(options, absl::nullopt, executions,
+                              next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Execution>* executions,
+    std::string* next_page_token) {
+  const absl::Status status =
+      ListExecutions(options, executions, next_page_token);
+  ApplyPropertyOptions(property_options, *executions);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  const absl::Status status = ListContexts(options, contexts, next_page_token);
+  ApplyPropertyOptions(property_options, *contexts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
+    const int64 type_id, const absl::string_view name, Artifact* artifact) {
+  return FindNodeByTypeIdAndNameImpl(
+      type_id, name,
+      absl::StrCat("No artifacts found for type_id:", type_id, ", name:", name),
+      artifact);
+}
+
+absl::Status
+InMemoryMetadataAccessObject::FindArtifactsByTypeIdAndArtifactNames(
+    const int64 artifact_type_id, const absl::Span<const std::string> names,
+    std::vector<Artifact>* artifacts) {
+  return FindNodesByTypeIdAndNamesImpl(artifact_type_id, names, artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 type_id, std::vector<Artifact>* artifacts) {
+  return FindNodesByTypeIdImpl(type_id, "No artifacts found for type_id:",
+                               artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 type_id, const PropertyOptions& property_options,
+    std::vector<Artifact>* artifacts) {
+  const absl::Status status = FindArtifactsByTypeId(type_id, artifacts);
+  ApplyPropertyOptions(property_options, *artifacts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::CountArtifacts(
+    const absl::optional<int64> artifact_type_id,
+    const absl::optional<Artifact::State> state, int64* count) {
+  *count = CountNodesImpl<Artifact>(
+      artifact_type_id, [&state](const Artifact& artifact) {
+        return !state || (artifact.has_state() && artifact.state() == *state);
+      });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::AggregateArtifactProperty(
+    const int64 artifact_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  AggregateNodePropertyImpl<Artifact>(artifact_type_id, options,
+                                      db().attributions, aggregates);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExistingArtifactIds(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<int64>* existing_artifact_ids) {
+  for (const int64 id : artifact_ids) {
+    if (db().artifacts.nodes.contains(id)) {
+      existing_artifact_ids->push_back(id);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactIdsByTypeId(
+    const int64 artifact_type_id, std::vector<int64>* artifact_ids) {
+  const auto it = db().artifacts.ids_by_type.find(artifact_type_id);
+  if (it != db().artifacts.ids_by_type.end()) {
+    artifact_ids->insert(artifact_ids->end(), it->second.begin(),
+                         it->second.end());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByURI(
+    const absl::string_view uri, std::vector<Artifact>* artifacts) {
+  std::vector<int64> ids;
+  const std::string uri_string(uri);
+  for (auto it = db().artifact_ids_by_uri.lower_bound({uri_string, 0});
+       it != db().artifact_ids_by_uri.end() && it->first == uri_string; ++it) {
+    ids.push_back(it->second);
+  }
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No artifacts found for uri:", uri));
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByURIPrefix(
+    const absl::string_view uri_prefix, std::vector<Artifact>* artifacts) {
+  if (uri_prefix.empty()) {
+    return absl::InvalidArgumentError("The uri_prefix should not be empty.");
+  }
+  std::vector<int64> ids;
+  for (auto it =
+           db().artifact_ids_by_uri.lower_bound({std::string(uri_prefix), 0});
+       it != db().artifact_ids_by_uri.end() &&
+       absl::StartsWith(it->first, uri_prefix);
+       ++it) {
+    ids.push_back(it->second);
+  }
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No artifacts found for uri prefix:", uri_prefix));
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateArtifact(
+    const Artifact& artifact) {
+  return UpdateNodesImpl<Artifact, ArtifactType>(
+      absl::MakeConstSpan(&artifact, 1));
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateArtifacts(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodesImpl<Artifact, ArtifactType>(artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateArtifactsIfUnchanged(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodesImpl<Artifact, ArtifactType>(
+      artifacts, /*check_last_update_time=*/true);
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteArtifactsById(
+    const absl::Span<const int64> artifact_ids) {
+  return DeleteNodesImpl<Artifact>(artifact_ids, db().event_ids_by_artifact,
+                                   db().attributions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactIdsUpdatedBefore(
+    const int64 artifact_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* artifact_ids) {
+  return FindNodeIdsUpdatedBeforeImpl<Artifact>(
+      artifact_type_id, last_update_time_since_epoch, limit, artifact_ids);
+}
+
+absl::Status
+InMemoryMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
+    const int64 type_id, const absl::string_view name, Execution* execution) {
+  return FindNodeByTypeIdAndNameImpl(
+      type_id, name,
+      absl::StrCat("No executions found for type_id:", type_id,
+                   ", name:", name),
+      execution);
+}
+
+absl::Status
+InMemoryMetadataAccessObject::FindExecutionsByTypeIdAndExecutionNames(
+    const int64 execution_type_id, const absl::Span<const std::string> names,
+    std::vector<Execution>* executions) {
+  return FindNodesByTypeIdAndNamesImpl(execution_type_id, names, executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 type_id, std::vector<Execution>* executions) {
+  return FindNodesByTypeIdImpl(type_id, "No executions found for type_id:",
+                               executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 type_id, const PropertyOptions& property_options,
+    std::vector<Execution>* executions) {
+  const absl::Status status = FindExecutionsByTypeId(type_id, executions);
+  ApplyPropertyOptions(property_options, *executions);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::CountExecutions(
+    const absl::optional<int64> execution_type_id,
+    const absl::optional<Execution::State> last_known_state, int64* count) {
+  *count = CountNodesImpl<Execution>(
+      execution_type_id, [&last_known_state](const Execution& execution) {
+        return !last_known_state ||
+               (execution.has_last_known_state() &&
+                execution.last_known_state() == *last_known_state);
+      });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::AggregateExecutionProperty(
+    const int64 execution_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  AggregateNodePropertyImpl<Execution>(execution_type_id, options,
+                                       db().associations, aggregates);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateExecution(
+    const Execution& execution) {
+  return UpdateNodesImpl<Execution, ExecutionType>(
+      absl::MakeConstSpan(&execution, 1));
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateExecutions(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodesImpl<Execution, ExecutionType>(executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateExecutionsIfUnchanged(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodesImpl<Execution, ExecutionType>(
+      executions, /*check_last_update_time=*/true);
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteExecutionsById(
+    const absl::Span<const int64> execution_ids) {
+  return DeleteNodesImpl<Execution>(execution_ids,
+                                    db().event_ids_by_execution,
+                                    db().associations);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionIdsUpdatedBefore(
+    const int64 execution_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* execution_ids) {
+  return FindNodeIdsUpdatedBeforeImpl<Execution>(
+      execution_type_id, last_update_time_since_epoch, limit, execution_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Context>* contexts, std::string* next_page_token) {
+  const InMemoryDatabase::NodeTable<Context>& table = db().contexts;
+  const auto it = table.ids_by_type.find(type_id);
+  if (it == table.ids_by_type.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No contexts found with type_id: ", type_id));
+  }
+  if (list_options) {
+    return ListNodes<Context>(list_options.value(), it->second, contexts,
+                              next_page_token);
+  }
+  return FindNodesImpl(it->second, /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  const absl::Status status =
+      FindContextsByTypeId(type_id, list_options, contexts, next_page_token);
+  ApplyPropertyOptions(property_options, *contexts);
+  return status;
+}
+
+absl::Status InMemoryMetadataAccessObject::CountContexts(
+    const absl::optional<int64> context_type_id, int64* count) {
+  *count = CountNodesImpl<Context>(context_type_id,
+                                   [](const Context&) { return true; });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextByTypeIdAndContextName(
+    const int64 type_id, const absl::string_view name, Context* context) {
+  return FindNodeByTypeIdAndNameImpl(
+      type_id, name,
+      absl::StrCat("No contexts found with type_id: ", type_id,
+                   ", name: ", name),
+      context);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByTypeIdAndContextNames(
+    const int64 context_type_id, const absl::Span<const std::string> names,
+    std::vector<Context>* contexts) {
+  return FindNodesByTypeIdAndNamesImpl(context_type_id, names, contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateContext(
+    const Context& context) {
+  return UpdateNodesImpl<Context, ContextType>(
+      absl::MakeConstSpan(&context, 1));
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateContexts(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodesImpl<Context, ContextType>(contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateContextsIfUnchanged(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodesImpl<Context, ContextType>(
+      contexts, /*check_last_update_time=*/true);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateEvent(const Event& event,
+                                                       int64* event_id) {
+  std::vector<int64> event_ids;
+  MLMD_RETURN_IF_ERROR(
+      CreateEvents(absl::MakeConstSpan(&event, 1), &event_ids));
+  *event_id = event_ids[0];
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  event_ids->clear();
+  InMemoryDatabase* const database = &db();
+  for (const Event& event : events) {
+    if (!event.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified.");
+    if (!event.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified.");
+    if (!event.has_type() || event.type() == Event::UNKNOWN)
+      return absl::InvalidArgumentError("No event type is specified.");
+  }
+  for (const Event& event : events) {
+    if (!database->artifacts.nodes.contains(event.artifact_id())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No artifact with the given id ", event.artifact_id()));
+    }
+    if (!database->executions.nodes.contains(event.execution_id())) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "No execution with the given id ", event.execution_id()));
+    }
+  }
+
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  event_ids->reserve(events.size());
+  for (const Event& event : events) {
+    Event stored_event;
+    stored_event.set_artifact_id(event.artifact_id());
+    stored_event.set_execution_id(event.execution_id());
+    stored_event.set_type(event.type());
+    stored_event.set_milliseconds_since_epoch(
+        event.has_milliseconds_since_epoch() ? event.milliseconds_since_epoch()
+                                             : now);
+    if (event.path().steps_size() > 0) {
+      *stored_event.mutable_path() = event.path();
+    }
+    database->events.push_back(std::move(stored_event));
+    const int64 event_id = database->events.size();
+    database->event_ids_by_artifact[event.artifact_id()].push_back(event_id);
+    database->event_ids_by_execution[event.execution_id()].push_back(event_id);
+    metadata_source_->AddUndo([database]() {
+      const Event& event = database->events.back();
+      PopBack(event.artifact_id(), database->event_ids_by_artifact);
+      PopBack(event.execution_id(), database->event_ids_by_execution);
+      database->events.pop_back();
+    });
+    event_ids->push_back(event_id);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindEventsByArtifacts(
+    const std::vector<int64>& artifact_ids, absl::Span<const Event::Type> types,
+    std::vector<Event>* events) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  std::vector<int64> event_ids;
+  for (const int64 artifact_id :
+       absl::flat_hash_set<int64>(artifact_ids.begin(), artifact_ids.end())) {
+    for (const int64 event_id :
+         GetSortedLinkedIds(db().event_ids_by_artifact, artifact_id)) {
+      if (types.empty() ||
+          absl::c_linear_search(types, db().events[event_id - 1].type())) {
+        event_ids.push_back(event_id);
+      }
+    }
+  }
+  if (event_ids.empty()) {
+    return absl::NotFoundError("Cannot find events by given artifact ids.");
+  }
+  absl::c_sort(event_ids);
+  for (const int64 event_id : event_ids) {
+    events->push_back(db().events[event_id - 1]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindEventsByExecutions(
+    const std::vector<int64>& execution_ids,
+    absl::Span<const Event::Type> types,
+    std::vector<Event>* events) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  std::vector<int64> event_ids;
+  for (const int64 execution_id :
+       absl::flat_hash_set<int64>(execution_ids.begin(), execution_ids.end())) {
+    for (const int64 event_id :
+         GetSortedLinkedIds(db().event_ids_by_execution, execution_id)) {
+      if (types.empty() ||
+          absl::c_linear_search(types, db().events[event_id - 1].type())) {
+        event_ids.push_back(event_id);
+      }
+    }
+  }
+  if (event_ids.empty()) {
+    return absl::NotFoundError("Cannot find events by given execution ids.");
+  }
+  absl::c_sort(event_ids);
+  for (const int64 event_id : event_ids) {
+    events->push_back(db().events[event_id - 1]);
+  }
+  return absl::OkStatus();
+}
+
+bool InMemoryMetadataAccessObject::InsertLink(
+    const int64 from_id, const int64 to_id, InMemoryDatabase::LinkTable& links,
+    int64* link_id) {
+  if (!links.links.insert({from_id, to_id}).second) {
+    return false;
+  }
+  links.ids_by_from_id[from_id].push_back(to_id);
+  links.ids_by_to_id[to_id].push_back(from_id);
+  const int64 id = ++links.last_id;
+  if (link_id != nullptr) *link_id = id;
+  InMemoryDatabase::LinkTable* const link_table = &links;
+  metadata_source_->AddUndo([link_table, from_id, to_id]() {
+    link_table->links.erase({from_id, to_id});
+    PopBack(from_id, link_table->ids_by_from_id);
+    PopBack(to_id, link_table->ids_by_to_id);
+    link_table->last_id--;
+  });
+  return true;
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAssociation(
+    const Association& association, int64* association_id) {
+  InMemoryDatabase& database = db();
+  if (!association.has_context_id())
+    return absl::InvalidArgumentError("No context id is specified.");
+  if (!database.contexts.nodes.contains(association.context_id()))
+    return absl::InvalidArgumentError("Context id not found.");
+  if (!association.has_execution_id())
+    return absl::InvalidArgumentError("No execution id is specified");
+  if (!database.executions.nodes.contains(association.execution_id()))
+    return absl::InvalidArgumentError("Execution id not found.");
+  if (!InsertLink(association.context_id(), association.execution_id(),
+                  database.associations, association_id)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given association already exists: ", association.DebugString()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAssociations(
+    const absl::Span<const Association> associations) {
+  for (const Association& association : associations) {
+    int64 unused_association_id;
+    const absl::Status status =
+        CreateAssociation(association, &unused_association_id);
+    if (!status.ok() && !absl::IsAlreadyExists(status)) return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByExecution(
+    const int64 execution_id, std::vector<Context>* contexts) {
+  const std::vector<int64> context_ids =
+      GetSortedLinkedIds(db().associations.ids_by_to_id, execution_id);
+  if (context_ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No contexts found for execution_id: ", execution_id));
+  }
+  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution) {
+  if (contexts_by_execution == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_execution is NULL.");
+  }
+  return FindLinkedNodesImpl(execution_ids, db().associations.ids_by_to_id,
+                             *contexts_by_execution);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, std::vector<Execution>* executions) {
+  std::string unused_next_page_token;
+  return FindExecutionsByContext(context_id, absl::nullopt, executions,
+                                 &unused_next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Execution>* executions, std::string* next_page_token) {
+  const std::vector<int64> ids =
+      GetSortedLinkedIds(db().associations.ids_by_from_id, context_id);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  if (list_options.has_value()) {
+    return ListNodes<Execution>(list_options.value(), ids, executions,
+                                next_page_token);
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindLinkedNodesImpl(
+    const absl::Span<const int64> key_ids,
+    const absl::flat_hash_map<int64, std::vector<int64>>& linked_ids,
+    absl::flat_hash_map<int64, std::vector<Node>>& nodes_by_key) {
+  nodes_by_key.clear();
+  const InMemoryDatabase::NodeTable<Node>& table = GetNodes<Node>(db());
+  for (const int64 key_id : key_ids) {
+    const auto links_it = linked_ids.find(key_id);
+    if (links_it == linked_ids.end() || links_it->second.empty() ||
+        nodes_by_key.contains(key_id)) {
+      continue;
+    }
+    std::vector<Node>& nodes = nodes_by_key[key_id];
+    nodes.reserve(links_it->second.size());
+    for (const int64 node_id : links_it->second) {
+      const auto node_it = table.nodes.find(node_id);
+      if (node_it == table.nodes.end()) {
+        return absl::InternalError(
+            absl::StrCat("Results missing for ids: {", node_id, "}"));
+      }
+      nodes.push_back(node_it->second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Execution>>* executions_by_context) {
+  if (executions_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given executions_by_context is NULL.");
+  }
+  return FindLinkedNodesImpl(context_ids, db().associations.ids_by_from_id,
+                             *executions_by_context);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAttribution(
+    const Attribution& attribution, int64* attribution_id) {
+  InMemoryDatabase& database = db();
+  if (!attribution.has_context_id())
+    return absl::InvalidArgumentError("No context id is specified.");
+  if (!database.contexts.nodes.contains(attribution.context_id()))
+    return absl::InvalidArgumentError("Context id not found.");
+  if (!attribution.has_artifact_id())
+    return absl::InvalidArgumentError("No artifact id is specified");
+  if (!database.artifacts.nodes.contains(attribution.artifact_id()))
+    return absl::InvalidArgumentError("Artifact id not found.");
+  if (!InsertLink(attribution.context_id(), attribution.artifact_id(),
+                  database.attributions, attribution_id)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given attribution already exists: ", attribution.DebugString()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAttributions(
+    const absl::Span<const Attribution> attributions) {
+  for (const Attribution& attribution : attributions) {
+    int64 unused_attribution_id;
+    const absl::Status status =
+        CreateAttribution(attribution, &unused_attribution_id);
+    if (!status.ok() && !absl::IsAlreadyExists(status)) return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByArtifact(
+    const int64 artifact_id, std::vector<Context>* contexts) {
+  const std::vector<int64> context_ids =
+      GetSortedLinkedIds(db().attributions.ids_by_to_id, artifact_id);
+  if (context_ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No contexts found for artifact_id: ", artifact_id));
+  }
+  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByArtifacts(
+    const absl::Span<const int64> artifact_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact) {
+  if (contexts_by_artifact == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_artifact is NULL.");
+  }
+  return FindLinkedNodesImpl(artifact_ids, db().attributions.ids_by_to_id,
+                             *contexts_by_artifact);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, std::vector<Artifact>* artifacts) {
+  std::string unused_next_page_token;
+  return FindArtifactsByContext(context_id, absl::nullopt, artifacts,
+                                &unused_next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Artifact>* artifacts, std::string* next_page_token) {
+  const std::vector<int64> ids =
+      GetSortedLinkedIds(db().attributions.ids_by_from_id, context_id);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  if (list_options.has_value()) {
+    return ListNodes<Artifact>(list_options.value(), ids, artifacts,
+                               next_page_token);
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context) {
+  if (artifacts_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given artifacts_by_context is NULL.");
+  }
+  return FindLinkedNodesImpl(context_ids, db().attributions.ids_by_from_id,
+                             *artifacts_by_context);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentContext(
+    const ParentContext& parent_context) {
+  if (!parent_context.has_parent_id() || !parent_context.has_child_id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Missing parent / child id in the parent_context: ",
+                     parent_context.DebugString()));
+  }
+  InMemoryDatabase& database = db();
+  if (parent_context.parent_id() == parent_context.child_id() ||
+      !database.contexts.nodes.contains(parent_context.parent_id()) ||
+      !database.contexts.nodes.contains(parent_context.child_id())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Given parent / child id in the parent_context cannot be found: ",
+        parent_context.DebugString()));
+  }
+  if (!InsertLink(parent_context.child_id(), parent_context.parent_id(),
+                  database.parent_contexts, /*link_id=*/nullptr)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Given parent_context already exists: ",
+                     parent_context.DebugString()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentContexts(
+    const absl::Span<const ParentContext> parent_contexts) {
+  for (const ParentContext& parent_context : parent_contexts) {
+    MLMD_RETURN_IF_ERROR(CreateParentContext(parent_context));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  contexts->clear();
+  const std::vector<int64> ids =
+      GetSortedLinkedIds(db().parent_contexts.ids_by_from_id, context_id);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindChildContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  contexts->clear();
+  const std::vector<int64> ids =
+      GetSortedLinkedIds(db().parent_contexts.ids_by_to_id, context_id);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTransitiveLinkedContextsImpl(
+    const int64 context_id, const int64 max_depth, const bool is_parent,
+    std::vector<Context>& output_contexts,
+    std::vector<ParentContext>& output_parent_contexts) {
+  if (max_depth <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_depth must be positive: ", max_depth));
+  }
+  output_contexts.clear();
+  output_parent_contexts.clear();
+  const InMemoryDatabase::LinkTable& links = db().parent_contexts;
+  // Visits the contexts breadth-first, so that each context is expanded at
+  // its minimum depth.
+  absl::flat_hash_set<int64> visited_ids = {context_id};
+  std::vector<int64> frontier = {context_id};
+  std::vector<int64> ids;
+  for (int64 depth = 0; depth < max_depth && !frontier.empty(); depth++) {
+    std::vector<int64> next_frontier;
+    for (const int64 id : frontier) {
+      for (const int64 linked_id : GetSortedLinkedIds(
+               is_parent ? links.ids_by_from_id : links.ids_by_to_id, id)) {
+        ParentContext parent_context;
+        parent_context.set_child_id(is_parent ? id : linked_id);
+        parent_context.set_parent_id(is_parent ? linked_id : id);
+        output_parent_contexts.push_back(parent_context);
+        ids.push_back(linked_id);
+        if (visited_ids.insert(linked_id).second) {
+          next_frontier.push_back(linked_id);
+        }
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  // A context linked to several others in the result is returned once.
+  absl::c_sort(ids);
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, output_contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindAncestorContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (contexts == nullptr || parent_contexts == nullptr) {
+    return absl::InvalidArgumentError(
+        "Given contexts or parent_contexts is NULL.");
+  }
+  return FindTransitiveLinkedContextsImpl(context_id, max_depth,
+                                          /*is_parent=*/true, *contexts,
+                                          *parent_contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindDescendantContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (contexts == nullptr || parent_contexts == nullptr) {
+    return absl::InvalidArgumentError(
+        "Given contexts or parent_contexts is NULL.");
+  }
+  return FindTransitiveLinkedContextsImpl(context_id, max_depth,
+                                          /*is_parent=*/false, *contexts,
+                                          *parent_contexts);
+}
+
+}  // namespace ml_metadata
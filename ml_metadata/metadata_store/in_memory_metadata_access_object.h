@@ -0,0 +1,630 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An implementation of MetadataAccessObject which reads and writes the
+// InMemoryDatabase of an InMemoryMetadataSource directly, without queries.
+// The nodes are looked up in hash maps by id, by type and by type and name,
+// the artifacts in an ordered index by uri, and the links in adjacency lists
+// of the linked nodes. It returns the same results and errors as the
+// RDBMSMetadataAccessObject, e.g., in the conformance tests of
+// metadata_access_object_test.cc.
+//
+// The writes register their undo in the metadata source, so that they are
+// rolled back with the transaction. Like the metadata source, this class is
+// thread-unsafe.
+class InMemoryMetadataAccessObject : public MetadataAccessObject {
+ public:
+  // The `metadata_source` is not owned, and must outlive the object.
+  // `library_version` is the schema version of the library.
+  InMemoryMetadataAccessObject(InMemoryMetadataSource* metadata_source,
+                               int64 library_version)
+      : metadata_source_(metadata_source), library_version_(library_version) {}
+  ~InMemoryMetadataAccessObject() override = default;
+
+  // Disallow copy and assign.
+  InMemoryMetadataAccessObject(const InMemoryMetadataAccessObject&) = delete;
+  InMemoryMetadataAccessObject& operator=(
+      const InMemoryMetadataAccessObject&) = delete;
+
+  // Schema. The versions of the schema are recorded, but there is nothing to
+  // migrate, as the records do not depend on them. The indices of the records
+  // are kept up to date with them, so there are no secondary indices to drop.
+  absl::Status InitMetadataSource() final;
+  absl::Status InitMetadataSourceIfNotExists(
+      bool enable_upgrade_migration = false) final;
+  absl::Status DowngradeMetadataSource(int64 to_schema_version) final;
+  absl::Status MigrateSchemaStep(int64 to_schema_version, int64 max_num_chunks,
+                                 SchemaMigrationProgress* progress) final;
+  absl::Status DropSecondaryIndices() final { return absl::OkStatus(); }
+  absl::Status CreateSecondaryIndices() final { return absl::OkStatus(); }
+  absl::Status MaintainEventPartitions(const EventPartitionOptions& options,
+                                       int64 now_milliseconds,
+                                       bool enable_migration) final {
+    return absl::UnimplementedError(
+        "The in-memory store does not partition the events.");
+  }
+  // The paths are always kept with the events.
+  absl::Status InlineEventPaths(bool enable_migration, int64 max_num_events,
+                                int64* num_moved_events) final {
+    *num_moved_events = 0;
+    return absl::OkStatus();
+  }
+
+  absl::Status InlineNodeProperties(bool enable_migration, int64 max_num_nodes,
+                                    int64* num_filled_nodes) final {
+    *num_filled_nodes = 0;
+    return absl::OkStatus();
+  }
+
+  absl::Status MaintainNodePropertiesBytes() final {
+    return absl::OkStatus();
+  }
+
+  // The idempotency keys are kept with the other records.
+  absl::Status CreateIdempotencyKeyTable() final { return absl::OkStatus(); }
+  absl::Status FindIdempotencyKey(absl::string_view idempotency_key,
+                                  int64* request_fingerprint,
+                                  absl::Time* create_time,
+                                  std::string* response) final;
+  absl::Status CreateIdempotencyKey(absl::string_view idempotency_key,
+                                    int64 request_fingerprint,
+                                    absl::Time create_time,
+                                    absl::string_view response) final;
+  absl::Status FindIdempotencyKeysCreatedBefore(
+      absl::Time create_time, int64 max_num_keys,
+      std::vector<std::string>* idempotency_keys) final;
+  absl::Status DeleteIdempotencyKeys(
+      absl::Span<const std::string> idempotency_keys) final;
+
+  // The lineage closure is kept with the other records.
+  absl::Status CreateLineageClosureTable(bool* created) final;
+  absl::Status CreateLineageClosure(
+      absl::Span<const int64> upstream_artifact_ids,
+      absl::Span<const int64> downstream_artifact_ids) final;
+  absl::Status FindLineageClosure(
+      absl::Span<const int64> artifact_ids, bool upstream,
+      std::vector<int64>* related_artifact_ids) final;
+
+  // Types.
+  absl::Status CreateType(const ArtifactType& type, int64* type_id) final;
+  absl::Status CreateType(const ExecutionType& type, int64* type_id) final;
+  absl::Status CreateType(const ContextType& type, int64* type_id) final;
+
+  absl::Status UpdateType(const ArtifactType& type) final;
+  absl::Status UpdateType(const ExecutionType& type) final;
+  absl::Status UpdateType(const ContextType& type) final;
+
+  absl::Status FindTypeById(int64 type_id, ArtifactType* artifact_type) final;
+  absl::Status FindTypeById(int64 type_id,
+                            ExecutionType* execution_type) final;
+  absl::Status FindTypeById(int64 type_id, ContextType* context_type) final;
+
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ArtifactType* artifact_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ExecutionType* execution_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ContextType* context_type) final;
+
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ContextType>* context_types) final;
+
+  absl::Status FindTypes(std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypes(std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypes(std::vector<ContextType>* context_types) final;
+
+  absl::Status CreateParentTypeInheritanceLink(
+      const ArtifactType& type, const ArtifactType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ExecutionType& type, const ExecutionType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ContextType& type, const ContextType& parent_type) final;
+
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ArtifactType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ExecutionType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ContextType>& output_parent_types) final;
+
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ContextType>>&
+          output_parent_types) final;
+
+  // Artifacts.
+  absl::Status CreateArtifact(const Artifact& artifact,
+                              int64* artifact_id) final;
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 const PropertyOptions& property_options,
+                                 std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifacts(
+      const NodeBatchCallback<Artifact>& callback) final;
+  absl::Status FindArtifacts(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Artifact>& callback) final;
+
+  absl::Status FindArtifactsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Artifact>& callback) final;
+
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             const PropertyOptions& property_options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              const PropertyOptions& property_options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            const PropertyOptions& property_options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+
+  absl::Status FindArtifactByTypeIdAndArtifactName(int64 artifact_type_id,
+                                                   absl::string_view name,
+                                                   Artifact* artifact) final;
+
+  absl::Status FindArtifactsByTypeIdAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     const PropertyOptions& property_options,
+                                     std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByURI(absl::string_view uri,
+                                  std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByURIPrefix(
+      absl::string_view uri_prefix, std::vector<Artifact>* artifacts) final;
+
+  absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                              absl::optional<Artifact::State> state,
+                              int64* count) final;
+
+  absl::Status FindExistingArtifactIds(
+      absl::Span<const int64> artifact_ids,
+      std::vector<int64>* existing_artifact_ids) final;
+
+  absl::Status FindArtifactIdsByTypeId(
+      int64 artifact_type_id, std::vector<int64>* artifact_ids) final;
+
+  absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
+  absl::Status UpdateArtifact(const Artifact& artifact) final;
+  absl::Status UpdateArtifacts(absl::Span<const Artifact> artifacts) final;
+  absl::Status UpdateArtifactsIfUnchanged(
+      absl::Span<const Artifact> artifacts) final;
+
+  absl::Status DeleteArtifactsById(
+      absl::Span<const int64> artifact_ids) final;
+
+  absl::Status FindArtifactIdsUpdatedBefore(
+      int64 artifact_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* artifact_ids) final;
+
+  // Executions.
+  absl::Status CreateExecution(const Execution& execution,
+                               int64* execution_id) final;
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  const PropertyOptions& property_options,
+                                  std::vector<Execution>* executions) final;
+  absl::Status FindExecutions(std::vector<Execution>* executions) final;
+  absl::Status FindExecutions(
+      const NodeBatchCallback<Execution>& callback) final;
+  absl::Status FindExecutions(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Execution>& callback) final;
+
+  absl::Status FindExecutionsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Execution>& callback) final;
+  absl::Status FindExecutionByTypeIdAndExecutionName(
+      int64 execution_type_id, absl::string_view name,
+      Execution* execution) final;
+
+  absl::Status FindExecutionsByTypeIdAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id, const PropertyOptions& property_options,
+      std::vector<Execution>* executions) final;
+
+  absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state, int64* count) final;
+
+  absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
+  absl::Status UpdateExecution(const Execution& execution) final;
+  absl::Status UpdateExecutions(absl::Span<const Execution> executions) final;
+  absl::Status UpdateExecutionsIfUnchanged(
+      absl::Span<const Execution> executions) final;
+
+  absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status FindExecutionIdsUpdatedBefore(
+      int64 execution_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* execution_ids) final;
+
+  // Contexts.
+  absl::Status CreateContext(const Context& context, int64* context_id) final;
+  absl::Status CreateContextIfNotExist(const Context& context,
+                                       int64* context_id,
+                                       bool* created) final;
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                std::vector<Context>* contexts) final;
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                const PropertyOptions& property_options,
+                                std::vector<Context>* contexts) final;
+  absl::Status FindContexts(std::vector<Context>* contexts) final;
+  absl::Status FindContexts(const NodeBatchCallback<Context>& callback) final;
+  absl::Status FindContexts(const PropertyOptions& property_options,
+                            const NodeBatchCallback<Context>& callback) final;
+
+  absl::Status FindContextsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Context>& callback) final;
+
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Context>* contexts, std::string* next_page_token) final;
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      const PropertyOptions& property_options, std::vector<Context>* contexts,
+      std::string* next_page_token) final;
+
+  absl::Status CountContexts(absl::optional<int64> context_type_id,
+                             int64* count) final;
+  absl::Status FindContextByTypeIdAndContextName(int64 type_id,
+                                                 absl::string_view name,
+                                                 Context* context) final;
+
+  absl::Status FindContextsByTypeIdAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      std::vector<Context>* contexts) final;
+
+  absl::Status UpdateContext(const Context& context) final;
+  absl::Status UpdateContexts(absl::Span<const Context> contexts) final;
+  absl::Status UpdateContextsIfUnchanged(
+      absl::Span<const Context> contexts) final;
+
+  // Links.
+  absl::Status CreateEvent(const Event& event, int64* event_id) final;
+  absl::Status CreateEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
+  using MetadataAccessObject::FindEventsByArtifacts;
+  absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
+                                     absl::Span<const Event::Type> types,
+                                     std::vector<Event>* events) final;
+  using MetadataAccessObject::FindEventsByExecutions;
+  absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
+                                      absl::Span<const Event::Type> types,
+                                      std::vector<Event>* events) final;
+
+  absl::Status CreateAssociation(const Association& association,
+                                 int64* association_id) final;
+
+  absl::Status CreateAssociations(
+      absl::Span<const Association> associations) final;
+
+  absl::Status FindContextsByExecution(int64 execution_id,
+                                       std::vector<Context>* contexts) final;
+  absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution)
+      final;
+  absl::Status FindExecutionsByContext(
+      int64 context_id, std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Execution>* executions, std::string* next_page_token) final;
+  absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Execution>>*
+          executions_by_context) final;
+
+  absl::Status CreateAttribution(const Attribution& attribution,
+                                 int64* attribution_id) final;
+
+  absl::Status CreateAttributions(
+      absl::Span<const Attribution> attributions) final;
+
+  absl::Status FindContextsByArtifact(int64 artifact_id,
+                                      std::vector<Context>* contexts) final;
+  absl::Status FindContextsByArtifacts(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact)
+      final;
+  absl::Status FindArtifactsByContext(int64 context_id,
+                                      std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Artifact>* artifacts, std::string* next_page_token) final;
+  absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context)
+      final;
+
+  absl::Status CreateParentContext(const ParentContext& parent_context) final;
+
+  absl::Status CreateParentContexts(
+      absl::Span<const ParentContext> parent_contexts) final;
+
+  absl::Status FindParentContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+  absl::Status FindChildContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+  absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+  absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+
+  absl::Status GetSchemaVersion(int64* db_version) final;
+
+  int64 GetLibraryVersion() final;
+
+ private:
+  InMemoryDatabase& db() { return metadata_source_->database(); }
+
+  template <typename Type>
+  absl::Status CreateTypeImpl(const Type& type, int64* type_id);
+
+  template <typename Type>
+  absl::Status FindTypeImpl(int64 type_id, Type* type);
+
+  template <typename Type>
+  absl::Status FindTypeImpl(absl::string_view name,
+                            absl::optional<absl::string_view> version,
+                            Type* type);
+
+  template <typename Type>
+  absl::Status FindTypesByNamesAndVersionsImpl(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<Type>* types);
+
+  template <typename Type>
+  absl::Status FindTypesImpl(std::vector<Type>* types);
+
+  template <typename Type>
+  absl::Status UpdateTypeImpl(const Type& type);
+
+  // Links `type` to `parent_type`.
+  // Returns INVALID_ARGUMENT error, if the link introduces a cycle.
+  // Returns ALREADY_EXISTS error, if the link exists.
+  template <typename Type>
+  absl::Status CreateParentTypeImpl(const Type& type, const Type& parent_type);
+
+  template <typename Type>
+  absl::Status FindParentTypesImpl(int64 type_id,
+                                   std::vector<Type>& output_parent_types);
+
+  template <typename Type>
+  absl::Status FindParentTypesByTypeIdsImpl(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<Type>>& output_parent_types);
+
+  // Creates the `nodes` after validating all of them, so that either all or
+  // none of them are created.
+  // Returns INVALID_ARGUMENT error, if a node does not align with its type.
+  // Returns ALREADY_EXISTS error, if a node has the name of another node of
+  //   its type.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodesImpl(absl::Span<const Node> nodes,
+                               std::vector<int64>* node_ids);
+
+  // Appends the nodes of `node_ids` to `nodes` in increasing order of id.
+  // Returns INVALID_ARGUMENT error, if `node_ids` is empty.
+  // Returns NOT_FOUND error if `skipped_ids_ok` and otherwise INTERNAL error,
+  //   if some of the ids are not found, with the found nodes in `nodes`.
+  template <typename Node>
+  absl::Status FindNodesImpl(absl::Span<const int64> node_ids,
+                             bool skipped_ids_ok, std::vector<Node>& nodes);
+
+  // Returns all the nodes, or passes them to `callback` in batches.
+  template <typename Node>
+  absl::Status FindAllNodesImpl(std::vector<Node>* nodes);
+  template <typename Node>
+  absl::Status StreamNodesImpl(const NodeBatchCallback<Node>& callback);
+
+  // Passes the nodes changed after the watermark to `callback` in batches,
+  // ordered by (last_update_time_since_epoch, id).
+  template <typename Node>
+  absl::Status StreamNodesUpdatedAfterImpl(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Node>& callback);
+
+  // Returns the nodes of `type_id`, or NOT_FOUND error with `message`.
+  template <typename Node>
+  absl::Status FindNodesByTypeIdImpl(int64 type_id, absl::string_view message,
+                                     std::vector<Node>* nodes);
+
+  // Counts the nodes of `type_id` if it is given, which satisfy `matches`.
+  // Only the ids of the type are visited if `type_id` is given.
+  template <typename Node>
+  int64 CountNodesImpl(absl::optional<int64> type_id,
+                       const std::function<bool(const Node&)>& matches);
+
+  // Aggregates a property over the nodes of `type_id` as specified by
+  // `options`. The nodes of a context are the ones linked to it in
+  // `context_links`.
+  template <typename Node>
+  void AggregateNodePropertyImpl(
+      int64 type_id, const PropertyAggregationOptions& options,
+      const InMemoryDatabase::LinkTable& context_links,
+      std::vector<PropertyAggregate>* aggregates);
+
+  // Finds the node of `type_id` and `name`, or returns NOT_FOUND error with
+  // `message`.
+  template <typename Node>
+  absl::Status FindNodeByTypeIdAndNameImpl(int64 type_id,
+                                           absl::string_view name,
+                                           absl::string_view message,
+                                           Node* node);
+
+  // Finds the nodes of `type_id` by their `names`, skipping the names that
+  // are not found.
+  template <typename Node>
+  absl::Status FindNodesByTypeIdAndNamesImpl(
+      int64 type_id, absl::Span<const std::string> names,
+      std::vector<Node>* nodes);
+
+  // Updates the `nodes` after validating all of them. The last update time of
+  // a node is only updated if it is changed, or if `check_last_update_time`
+  // is set, in which case the given last update time of every node must equal
+  // the stored one and the new one is increased past it.
+  template <typename Node, typename NodeType>
+  absl::Status UpdateNodesImpl(absl::Span<const Node> nodes,
+                               bool check_last_update_time = false);
+
+  // Deletes the nodes of `node_ids` along with their events in
+  // `event_ids_by_node` and their links to the contexts in `context_links`.
+  // The events keep their slots, so that the other event ids are stable.
+  template <typename Node>
+  absl::Status DeleteNodesImpl(
+      absl::Span<const int64> node_ids,
+      absl::flat_hash_map<int64, std::vector<int64>>& event_ids_by_node,
+      InMemoryDatabase::LinkTable& context_links);
+
+  // Sets `node_ids` to at most `limit` ids of the nodes of `type_id` last
+  // updated before `last_update_time_since_epoch`, the least recent first.
+  template <typename Node>
+  absl::Status FindNodeIdsUpdatedBeforeImpl(int64 type_id,
+                                            int64 last_update_time_since_epoch,
+                                            int64 limit,
+                                            std::vector<int64>* node_ids);
+
+  // Lists a page of the nodes, or of the `candidate_ids` if given, which
+  // match the property filters of `options`.
+  template <typename Node>
+  absl::Status ListNodes(const ListOperationOptions& options,
+                         absl::optional<absl::Span<const int64>> candidate_ids,
+                         std::vector<Node>* nodes,
+                         std::string* next_page_token);
+
+  // Returns the nodes linked to `key_ids` by `linked_ids`, e.g., the
+  // ids_by_from_id of a LinkTable for the nodes by context, by key.
+  template <typename Node>
+  absl::Status FindLinkedNodesImpl(
+      absl::Span<const int64> key_ids,
+      const absl::flat_hash_map<int64, std::vector<int64>>& linked_ids,
+      absl::flat_hash_map<int64, std::vector<Node>>& nodes_by_key);
+
+  // Inserts a link between existing nodes, and sets its id.
+  // Returns false, if the link exists.
+  bool InsertLink(int64 from_id, int64 to_id,
+                  InMemoryDatabase::LinkTable& links, int64* link_id);
+
+  // Collects the links of the contexts up to `max_depth` hops from
+  // `context_id`, towards the parents or the children.
+  absl::Status FindTransitiveLinkedContextsImpl(
+      int64 context_id, int64 max_depth, bool is_parent,
+      std::vector<Context>& output_contexts,
+      std::vector<ParentContext>& output_parent_contexts);
+
+  // Inserts or replaces a stored node along with its indexes, and registers
+  // how to undo it.
+  template <typename Node>
+  void InsertNode(const Node& node);
+  template <typename Node>
+  void ReplaceNode(const Node& node);
+
+  // Erases a stored node, a link or the indexes of an event, and registers how
+  // to restore them at their positions.
+  template <typename Node>
+  void EraseNode(int64 id);
+  void EraseLink(int64 from_id, int64 to_id,
+                 InMemoryDatabase::LinkTable& links);
+  void UnlinkEvent(int64 event_id);
+
+  // Sets the schema state of the database, and registers how to undo it.
+  void SetSchemaState(bool has_tables, bool has_missing_tables,
+                      absl::optional<int64> schema_version);
+
+  InMemoryMetadataSource* const metadata_source_;
+  const int64 library_version_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
@@ -0,0 +1,263 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Test suite for an InMemoryMetadataSource based MetadataAccessObject.
+
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/metadata_access_object_test.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+
+namespace ml_metadata {
+namespace testing {
+
+namespace {
+
+// InMemoryMetadataAccessObjectContainer implements
+// MetadataAccessObjectContainer to generate and retrieve a
+// MetadataAccessObject based on an InMemoryMetadataSource. As the records do
+// not depend on the schema version, the migrations only change the version on
+// record, and the previous versions are set up by recording them.
+class InMemoryMetadataAccessObjectContainer
+    : public MetadataAccessObjectContainer {
+ public:
+  InMemoryMetadataAccessObjectContainer() {
+    metadata_source_ = absl::make_unique<InMemoryMetadataSource>();
+    CHECK_EQ(absl::OkStatus(),
+             CreateMetadataAccessObject(
+                 util::GetInMemoryMetadataSourceQueryConfig(),
+                 metadata_source_.get(), &metadata_access_object_));
+  }
+
+  ~InMemoryMetadataAccessObjectContainer() override = default;
+
+  MetadataSource* GetMetadataSource() override {
+    return metadata_source_.get();
+  }
+  MetadataAccessObject* GetMetadataAccessObject() override {
+    return metadata_access_object_.get();
+  }
+
+  bool HasUpgradeVerification(int64 version) override {
+    return version == library_version();
+  }
+
+  bool HasDowngradeVerification(int64 version) override { return false; }
+
+  bool HasParentTypeSupport() override { return true; }
+
+  absl::Status SetupPreviousVersionForDowngrade(int64 version) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status DowngradeVerification(int64 version) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status SetupPreviousVersionForUpgrade(int64 version) override {
+    database().has_tables = true;
+    database().schema_version = version - 1;
+    return absl::OkStatus();
+  }
+
+  absl::Status UpgradeVerification(int64 version) override {
+    if (database().schema_version != version) {
+      return absl::InternalError(
+          absl::StrCat("The database is not upgraded to version ", version));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status DropTypeTable() override {
+    database().has_missing_tables = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status DropArtifactTable() override {
+    database().has_missing_tables = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status DeleteSchemaVersion() override {
+    database().schema_version.reset();
+    return absl::OkStatus();
+  }
+
+  absl::Status SetDatabaseVersionIncompatible() override {
+    database().schema_version = library_version() + 1;
+    return absl::OkStatus();
+  }
+
+  int64 MinimumVersion() override { return 1; }
+
+  bool PerformExtendedTests() override { return true; }
+
+ private:
+  InMemoryDatabase& database() { return metadata_source_->database(); }
+
+  int64 library_version() {
+    return metadata_access_object_->GetLibraryVersion();
+  }
+
+  std::unique_ptr<InMemoryMetadataSource> metadata_source_;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(
+    InMemoryMetadataAccessObjectTest, MetadataAccessObjectTest,
+    ::testing::Values([]() {
+      return absl::make_unique<InMemoryMetadataAccessObjectContainer>();
+    }));
+
+// Checks the rollback of a transaction and of a savepoint undo the writes
+// made after them, along with their indexes.
+TEST(InMemoryMetadataAccessObjectTest, RollbackUndoesWrites) {
+  InMemoryMetadataAccessObjectContainer container;
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  MetadataAccessObject* metadata_access_object =
+      container.GetMetadataAccessObject();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("dataset");
+  int64 type_id = 0;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_uri("gs://bucket/a");
+  artifact.set_name("a");
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  int64 artifact_id = 0;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("SAVEPOINT `a`", &record_set));
+  artifact.set_id(artifact_id);
+  artifact.set_uri("gs://bucket/b");
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->UpdateArtifact(artifact));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->ExecuteQuery(
+                                  "ROLLBACK TO SAVEPOINT `a`", &record_set));
+  std::vector<Artifact> artifacts;
+  EXPECT_TRUE(absl::IsNotFound(
+      metadata_access_object->FindArtifactsByURI("gs://bucket/b", &artifacts)));
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsByURI(
+                                  "gs://bucket/a", &artifacts));
+  EXPECT_EQ(artifacts.size(), 1);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Rollback());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  Artifact found_artifact;
+  EXPECT_TRUE(absl::IsNotFound(
+      metadata_access_object->FindArtifactByTypeIdAndArtifactName(
+          type_id, "a", &found_artifact)));
+  // The name of the rolled back artifact can be used again.
+  artifact.clear_id();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
+// Checks the rollback of a delete restores the nodes and their links, in the
+// order of their indexes.
+TEST(InMemoryMetadataAccessObjectTest, RollbackRestoresDeletes) {
+  InMemoryMetadataAccessObjectContainer container;
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  MetadataAccessObject* metadata_access_object =
+      container.GetMetadataAccessObject();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType artifact_type;
+  artifact_type.set_name("dataset");
+  int64 artifact_type_id = 0;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->CreateType(
+                                  artifact_type, &artifact_type_id));
+  ExecutionType execution_type;
+  execution_type.set_name("trainer");
+  int64 execution_type_id = 0;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->CreateType(
+                                  execution_type, &execution_type_id));
+  std::vector<int64> artifact_ids;
+  for (const char* name : {"a", "b", "c"}) {
+    Artifact artifact;
+    artifact.set_type_id(artifact_type_id);
+    artifact.set_name(name);
+    int64 artifact_id = 0;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->CreateArtifact(artifact, &artifact_id));
+    artifact_ids.push_back(artifact_id);
+  }
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id = 0;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateExecution(execution, &execution_id));
+  for (const int64 artifact_id : artifact_ids) {
+    Event event;
+    event.set_artifact_id(artifact_id);
+    event.set_execution_id(execution_id);
+    event.set_type(Event::OUTPUT);
+    int64 event_id = 0;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->CreateEvent(event, &event_id));
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->DeleteArtifactsById(
+                                  {artifact_ids[1], artifact_ids[0]}));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->DeleteExecutionsById({execution_id}));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Rollback());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindArtifacts(&artifacts));
+  ASSERT_EQ(artifacts.size(), 3);
+  for (int i = 0; i < artifacts.size(); i++) {
+    EXPECT_EQ(artifacts[i].id(), artifact_ids[i]);
+  }
+  Artifact found_artifact;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object->FindArtifactByTypeIdAndArtifactName(
+                artifact_type_id, "a", &found_artifact));
+  std::vector<Event> events;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindEventsByExecutions(
+                                  {execution_id}, &events));
+  ASSERT_EQ(events.size(), 3);
+  for (int i = 0; i < events.size(); i++) {
+    EXPECT_EQ(events[i].artifact_id(), artifact_ids[i]);
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,133 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+
+namespace ml_metadata {
+
+namespace {
+
+constexpr char kSavepoint[] = "SAVEPOINT ";
+constexpr char kRollbackToSavepoint[] = "ROLLBACK TO SAVEPOINT ";
+constexpr char kReleaseSavepoint[] = "RELEASE SAVEPOINT ";
+
+// Returns the savepoint name of a statement, without the quotes around it.
+std::string GetSavepointName(absl::string_view name) {
+  name = absl::StripAsciiWhitespace(name);
+  absl::ConsumeSuffix(&name, ";");
+  absl::ConsumePrefix(&name, "`");
+  absl::ConsumeSuffix(&name, "`");
+  return std::string(name);
+}
+
+}  // namespace
+
+std::string InMemoryMetadataSource::EscapeString(
+    absl::string_view value) const {
+  return std::string(value);
+}
+
+void InMemoryMetadataSource::AddUndo(std::function<void()> undo) {
+  if (in_transaction_) {
+    undo_log_.push_back(std::move(undo));
+  }
+}
+
+absl::Status InMemoryMetadataSource::ConnectImpl() {
+  database_ = InMemoryDatabase();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::CloseImpl() {
+  database_ = InMemoryDatabase();
+  in_transaction_ = false;
+  undo_log_.clear();
+  savepoints_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::ExecuteQueryImpl(const std::string& query,
+                                                      RecordSet* results) {
+  absl::string_view statement = absl::StripAsciiWhitespace(query);
+  const bool is_rollback =
+      absl::ConsumePrefix(&statement, kRollbackToSavepoint);
+  const bool is_release =
+      !is_rollback && absl::ConsumePrefix(&statement, kReleaseSavepoint);
+  if (!is_rollback && !is_release &&
+      !absl::ConsumePrefix(&statement, kSavepoint)) {
+    return absl::UnimplementedError(absl::StrCat(
+        "InMemoryMetadataSource does not run SQL queries: ", query));
+  }
+  const std::string name = GetSavepointName(statement);
+  if (!is_rollback && !is_release) {
+    savepoints_.push_back({name, undo_log_.size()});
+    return absl::OkStatus();
+  }
+  // The most recent savepoint of the name is used, as in SQL.
+  auto it = savepoints_.rbegin();
+  while (it != savepoints_.rend() && it->first != name) {
+    ++it;
+  }
+  if (it == savepoints_.rend()) {
+    return absl::NotFoundError(absl::StrCat("No such savepoint: ", name));
+  }
+  // ROLLBACK TO keeps the savepoint, while RELEASE removes it along with the
+  // ones set after it.
+  const size_t position = savepoints_.size() - 1 - (it - savepoints_.rbegin());
+  if (is_rollback) {
+    UndoUntil(savepoints_[position].second);
+    savepoints_.resize(position + 1);
+  } else {
+    savepoints_.resize(position);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::BeginImpl() {
+  in_transaction_ = true;
+  undo_log_.clear();
+  savepoints_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::CommitImpl() {
+  in_transaction_ = false;
+  undo_log_.clear();
+  savepoints_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::RollbackImpl() {
+  UndoUntil(0);
+  in_transaction_ = false;
+  savepoints_.clear();
+  return absl::OkStatus();
+}
+
+void InMemoryMetadataSource::UndoUntil(const size_t size) {
+  while (undo_log_.size() > size) {
+    undo_log_.back()();
+    undo_log_.pop_back();
+  }
+}
+
+}  // namespace ml_metadata
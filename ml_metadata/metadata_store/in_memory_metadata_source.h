@@ -0,0 +1,184 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The records of an in-memory database, indexed for the lookups of the
+// InMemoryMetadataAccessObject. The vectors of ids are in insertion order,
+// which is the increasing order of the ids.
+struct InMemoryDatabase {
+  // The types of one kind. The ids are shared by all the kinds of types.
+  template <typename Type>
+  struct TypeTable {
+    absl::flat_hash_map<int64, Type> types;
+    std::vector<int64> ids;
+    // The first type of each (name, version). The version of a type without
+    // version is empty.
+    absl::flat_hash_map<std::pair<std::string, std::string>, int64>
+        ids_by_name_and_version;
+    absl::flat_hash_map<int64, std::vector<int64>> parent_ids;
+    absl::flat_hash_set<std::pair<int64, int64>> parent_links;
+  };
+
+  // The nodes of one kind.
+  template <typename Node>
+  struct NodeTable {
+    absl::flat_hash_map<int64, Node> nodes;
+    std::vector<int64> ids;
+    absl::flat_hash_map<int64, std::vector<int64>> ids_by_type;
+    // The nodes with a name, which is unique per type.
+    absl::flat_hash_map<std::pair<int64, std::string>, int64>
+        ids_by_type_and_name;
+    int64 last_id = 0;
+  };
+
+  // The links between the nodes of two kinds, e.g., the associations of the
+  // contexts and the executions.
+  struct LinkTable {
+    absl::flat_hash_map<int64, std::vector<int64>> ids_by_from_id;
+    absl::flat_hash_map<int64, std::vector<int64>> ids_by_to_id;
+    absl::flat_hash_set<std::pair<int64, int64>> links;
+    int64 last_id = 0;
+  };
+
+  // Whether the tables are created, and whether some are dropped since.
+  bool has_tables = false;
+  bool has_missing_tables = false;
+  // The schema version on record, if any.
+  absl::optional<int64> schema_version;
+
+  int64 last_type_id = 0;
+  TypeTable<ArtifactType> artifact_types;
+  TypeTable<ExecutionType> execution_types;
+  TypeTable<ContextType> context_types;
+
+  NodeTable<Artifact> artifacts;
+  NodeTable<Execution> executions;
+  NodeTable<Context> contexts;
+  // The (uri, id) of the artifacts, ordered for the lookups by uri prefix.
+  std::set<std::pair<std::string, int64>> artifact_ids_by_uri;
+
+  // The event of id `i` is at `events[i - 1]`.
+  std::vector<Event> events;
+  absl::flat_hash_map<int64, std::vector<int64>> event_ids_by_artifact;
+  absl::flat_hash_map<int64, std::vector<int64>> event_ids_by_execution;
+
+  // From the contexts to the executions and the artifacts respectively.
+  LinkTable associations;
+  LinkTable attributions;
+  // From the child contexts to their parent contexts.
+  LinkTable parent_contexts;
+
+  // The idempotency keys of the writes and the outcomes recorded with them.
+  struct IdempotencyKey {
+    int64 request_fingerprint;
+    absl::Time create_time;
+    std::string response;
+  };
+  absl::flat_hash_map<std::string, IdempotencyKey> idempotency_keys;
+
+  // The lineage closure, if it is created, from each artifact to the artifacts
+  // upstream and downstream of it respectively.
+  bool has_lineage_closure = false;
+  absl::flat_hash_map<int64, absl::flat_hash_set<int64>> upstream_artifact_ids;
+  absl::flat_hash_map<int64, absl::flat_hash_set<int64>>
+      downstream_artifact_ids;
+};
+
+// A MetadataSource which keeps an InMemoryDatabase in the process, and runs no
+// SQL queries. It destroys the records when it is closed or destructed.
+//
+// The writes of a transaction register how to undo them with AddUndo, so that
+// a rollback undoes them in reverse order. The SAVEPOINT, ROLLBACK TO SAVEPOINT
+// and RELEASE SAVEPOINT statements are the only queries it runs, which undo
+// the writes since a savepoint in the same way.
+//
+// This class is thread-unsafe, and its records are not shared with other
+// objects.
+class InMemoryMetadataSource : public MetadataSource {
+ public:
+  InMemoryMetadataSource() = default;
+  ~InMemoryMetadataSource() override = default;
+
+  // Disallow copy and assign.
+  InMemoryMetadataSource(const InMemoryMetadataSource&) = delete;
+  InMemoryMetadataSource& operator=(const InMemoryMetadataSource&) = delete;
+
+  // Returns the value as is, as the records are not written with queries.
+  std::string EscapeString(absl::string_view value) const final;
+
+  InMemoryDatabase& database() { return database_; }
+
+  // Registers how to undo a write to the database, if a transaction is open;
+  // otherwise the write cannot be undone.
+  void AddUndo(std::function<void()> undo);
+
+ private:
+  // Connects an empty database.
+  absl::Status ConnectImpl() final;
+
+  // Destroys the records of the database.
+  absl::Status CloseImpl() final;
+
+  // Runs the savepoint statements.
+  // Returns UNIMPLEMENTED error, if the query is any other statement.
+  // Returns NOT_FOUND error, if the savepoint of the query is not found.
+  absl::Status ExecuteQueryImpl(const std::string& query,
+                                RecordSet* results) final;
+
+  // Begins a transaction with an empty undo log.
+  absl::Status BeginImpl() final;
+
+  // Drops the undo log.
+  absl::Status CommitImpl() final;
+
+  // Undoes the writes of the transaction.
+  absl::Status RollbackImpl() final;
+
+  // Undoes the writes registered after the first `size` ones.
+  void UndoUntil(size_t size);
+
+  InMemoryDatabase database_;
+
+  // Whether a transaction is open.
+  bool in_transaction_ = false;
+
+  // The undo log of the open transaction.
+  std::vector<std::function<void()>> undo_log_;
+
+  // The open savepoints, with the size of the undo log when they are set.
+  std::vector<std::pair<std::string, size_t>> savepoints_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
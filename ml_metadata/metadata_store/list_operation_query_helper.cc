@@ -92,7 +92,20 @@ std::string ConstructIdOrderCaluse(const ListOperationOptions& options,
       "`id` $0 $1 ", options.order_by_field().is_asc() ? ">" : "<", id_offset);
 }
 
-// Constructs the WHERE clause on the id field for LAST_UPDATE_TIME ordering.
+// Constructs the WHERE clause on the id field for LAST_UPDATE_TIME ordering,
+// which breaks the ties of the last update time with the ids as a keyset
+// comparison of (last_update_time_since_epoch, id). Together with the
+// ordering field clause, it is a range of the last update time index.
+std::string ConstructKeysetIdClause(const ListOperationOptions& options,
+                                    const int64 field_offset,
+                                    const int64 id_offset) {
+  return absl::Substitute(
+      "(`last_update_time_since_epoch` $0 $1 OR `id` $0 $2) ",
+      options.order_by_field().is_asc() ? ">" : "<", field_offset, id_offset);
+}
+
+// Constructs the WHERE clause on the id field for LAST_UPDATE_TIME ordering
+// with the tokens of the earlier versions, which list the ids of the ties.
 absl::Status ConstructIdNotInCaluse(absl::Span<const int64> listed_ids,
                                     std::string& not_in_clause) {
   if (listed_ids.empty()) {
@@ -115,6 +128,12 @@ absl::Status ConstructIdClause(
       id_clause = ConstructIdOrderCaluse(options, next_page_token.id_offset());
       break;
     case ListOperationOptions::OrderByField::LAST_UPDATE_TIME: {
+      if (next_page_token.has_id_offset()) {
+        id_clause = ConstructKeysetIdClause(options,
+                                            next_page_token.field_offset(),
+                                            next_page_token.id_offset());
+        break;
+      }
       std::vector<int64> listed_ids;
       for (auto it = next_page_token.listed_ids().begin();
            it != next_page_token.listed_ids().end(); it++) {
@@ -196,10 +215,18 @@ absl::Status AppendLimitClause(const ListOperationOptions& options,
                      options.max_result_size()));
   }
 
+  const int max_list_result_size =
+      options.bulk_mode() ? GetMaxBulkListOperationResultSize()
+                          : GetDefaultMaxListOperationResultSize();
   const int max_result_size =
-      std::min(options.max_result_size(),
-               GetDefaultMaxListOperationResultSize() + 1);
+      std::min(options.max_result_size(), max_list_result_size + 1);
   absl::SubstituteAndAppend(&sql_query_clause, " LIMIT $0 ", max_result_size);
   return absl::OkStatus();
 }
+
+int GetListOperationPageSize(const ListOperationOptions& options) {
+  return std::min(options.max_result_size(),
+                  options.bulk_mode() ? GetMaxBulkListOperationResultSize()
+                                      : GetDefaultMaxListOperationResultSize());
+}
 }  // namespace ml_metadata
@@ -72,7 +72,8 @@ absl::Status AppendOrderByClause(const ListOperationOptions& options,
 // based on |options|.
 // If |options| does not specify max_result_size a default value of 20 is used
 // and if the max_result_size is greater than 100, the LIMIT clause coerces the
-// value to 100.
+// value to 100. If |options| sets bulk_mode, the value is coerced to
+// GetMaxBulkListOperationResultSize() instead.
 // For example, given a ListOperationOptions message:
 // {
 //    max_result_size: 1,
@@ -90,6 +91,15 @@ inline constexpr int GetDefaultMaxListOperationResultSize() {
   return 100;
 }
 
+// Gets the maximum number of returned resources for List operation in bulk
+// mode.
+inline constexpr int GetMaxBulkListOperationResultSize() { return 10000; }
+
+// Gets the maximum number of returned resources for List operation with the
+// given |options|, i.e., the minimum of max_result_size and the upper-bound of
+// the list mode.
+int GetListOperationPageSize(const ListOperationOptions& options);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_LIST_OPERATION_QUERY_HELPER_H_
@@ -95,6 +95,27 @@ TEST(ListOperationQueryHelperTest, OrderingOnLastUpdateTimeDesc) {
             " `last_update_time_since_epoch` <= 56894 AND `id` NOT IN (6,5) ");
 }
 
+TEST(ListOperationQueryHelperTest, OrderingOnLastUpdateTimeDescWithKeyset) {
+  ListOperationOptions options =
+      testing::ParseTextProtoOrDie<ListOperationOptions>(R"pb(
+        max_result_size: 1,
+        order_by_field: { field: LAST_UPDATE_TIME, is_asc: false }
+      )pb");
+
+  ListOperationNextPageToken next_page_token;
+  next_page_token.set_field_offset(56894);
+  next_page_token.set_id_offset(6);
+  *next_page_token.mutable_set_options() = options;
+  options.set_next_page_token(
+      absl::WebSafeBase64Escape(next_page_token.SerializeAsString()));
+  std::string where_clause;
+  ASSERT_EQ(absl::OkStatus(),
+            AppendOrderingThresholdClause(options, where_clause));
+  EXPECT_EQ(where_clause,
+            " `last_update_time_since_epoch` <= 56894 AND "
+            "(`last_update_time_since_epoch` < 56894 OR `id` < 6) ");
+}
+
 TEST(ListOperationQueryHelperTest, OrderingWhereClauseById) {
   ListOperationOptions options =
       testing::ParseTextProtoOrDie<ListOperationOptions>(R"pb(
@@ -155,6 +176,22 @@ TEST(ListOperationQueryHelperTest, LimitOverMaxClause) {
   EXPECT_EQ(limit_clause, " LIMIT 101 ");
 }
 
+TEST(ListOperationQueryHelperTest, LimitInBulkModeClause) {
+  ListOperationOptions options = BasicListOperationOptionsDesc();
+  options.set_bulk_mode(true);
+  options.set_max_result_size(5000);
+  std::string limit_clause;
+  ASSERT_EQ(absl::OkStatus(), AppendLimitClause(options, limit_clause));
+  EXPECT_EQ(limit_clause, " LIMIT 5000 ");
+  EXPECT_EQ(GetListOperationPageSize(options), 5000);
+
+  options.set_max_result_size(20000);
+  limit_clause.clear();
+  ASSERT_EQ(absl::OkStatus(), AppendLimitClause(options, limit_clause));
+  EXPECT_EQ(limit_clause, " LIMIT 10001 ");
+  EXPECT_EQ(GetListOperationPageSize(options), 10000);
+}
+
 TEST(ListOperationQueryHelperTest, InvalidLimit) {
   ListOperationOptions options = BasicListOperationOptionsDesc();
   options.set_max_result_size(0);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/list_operation_util.h"
 
+#include "google/protobuf/util/message_differencer.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
 
@@ -46,13 +47,38 @@ absl::Status DecodeListOperationNextPageToken(
   return absl::OkStatus();
 }
 
+std::string EncodeListOperationNextPageToken(
+    const ListOperationNextPageToken& list_operation_next_page_token) {
+  return absl::WebSafeBase64Escape(
+      list_operation_next_page_token.SerializeAsString());
+}
+
 absl::Status ValidateListOperationOptionsAreIdentical(
     const ListOperationOptions& previous_options,
     const ListOperationOptions& current_options) {
+  const auto filters_are_identical = [&]() {
+    if (previous_options.property_filters_size() !=
+        current_options.property_filters_size()) {
+      return false;
+    }
+    for (int i = 0; i < current_options.property_filters_size(); i++) {
+      if (!google::protobuf::util::MessageDifferencer::Equals(
+              previous_options.property_filters(i),
+              current_options.property_filters(i))) {
+        return false;
+      }
+    }
+    return true;
+  };
   if (previous_options.order_by_field().is_asc() ==
           current_options.order_by_field().is_asc() &&
       previous_options.order_by_field().field() ==
-          current_options.order_by_field().field()) {
+          current_options.order_by_field().field() &&
+      filters_are_identical() &&
+      previous_options.has_type_id() == current_options.has_type_id() &&
+      previous_options.type_id() == current_options.type_id() &&
+      previous_options.has_state() == current_options.has_state() &&
+      previous_options.state() == current_options.state()) {
     return absl::OkStatus();
   }
 
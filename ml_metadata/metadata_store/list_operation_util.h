@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_ML_METADATA_METADATA_STORE_LIST_OPERATION_UTIL_H_
 #define THIRD_PARTY_ML_METADATA_METADATA_STORE_LIST_OPERATION_UTIL_H_
 
+#include <string>
+
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
 #include "absl/types/span.h"
@@ -33,6 +35,10 @@ absl::Status DecodeListOperationNextPageToken(
     const absl::string_view next_page_token,
     ListOperationNextPageToken& list_operation_next_page_token);
 
+// Encodes `list_operation_next_page_token` as a next page token string.
+std::string EncodeListOperationNextPageToken(
+    const ListOperationNextPageToken& list_operation_next_page_token);
+
 // Generates encoded list operation next page token string.
 template <typename Node>
 absl::Status BuildListOperationNextPageToken(
@@ -48,16 +54,11 @@ absl::Status BuildListOperationNextPageToken(
       break;
     }
     case ListOperationOptions::OrderByField::LAST_UPDATE_TIME: {
-      list_operation_next_page_token.add_listed_ids(last_node.id());
+      // The token is the (last_update_time_since_epoch, id) key of the last
+      // node, so its size does not depend on the number of ties.
       list_operation_next_page_token.set_field_offset(
           last_node.last_update_time_since_epoch());
-      for (auto it = nodes.rbegin(); it != nodes.rend(); it--) {
-        if (it->last_update_time_since_epoch() !=
-            last_node.last_update_time_since_epoch()) {
-          break;
-        }
-        list_operation_next_page_token.add_listed_ids(it->id());
-      }
+      list_operation_next_page_token.set_id_offset(last_node.id());
       break;
     }
     case ListOperationOptions::OrderByField::ID: {
@@ -73,15 +74,15 @@ absl::Status BuildListOperationNextPageToken(
                        " specified in ListOperationOptions"));
   }
   *list_operation_next_page_token.mutable_set_options() = options;
-  *next_page_token = absl::WebSafeBase64Escape(
-      list_operation_next_page_token.SerializeAsString());
+  *next_page_token =
+      EncodeListOperationNextPageToken(list_operation_next_page_token);
   return absl::OkStatus();
 }
 
 // Ensures that ListOperationOptions have not changed between
 // calls. |previous_options| represents options used in the previous call and
 // |current_options| represents options used in the current call.
-// Validation validates order_by_fields and filter_query in
+// Validation validates order_by_field, property_filters, type_id and state in
 // ListOperationOptions.
 absl::Status ValidateListOperationOptionsAreIdentical(
     const ListOperationOptions& previous_options,
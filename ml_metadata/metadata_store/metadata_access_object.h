@@ -15,10 +15,15 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_H_
 #define ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
@@ -27,6 +32,13 @@ limitations under the License.
 
 namespace ml_metadata {
 
+class NodeCache;
+
+// Receives a batch of nodes of a streamed read. Returning an error stops the
+// read, and the error is returned to the caller of the read.
+template <typename Node>
+using NodeBatchCallback = std::function<absl::Status(absl::Span<const Node>)>;
+
 // Data access object (DAO) for the domain entities (Type, Artifact, Execution,
 // Event) defined in metadata_store.proto. It provides a list of query methods
 // to store, update, and read entities. It takes a MetadataSourceQueryConfig
@@ -84,6 +96,137 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status DowngradeMetadataSource(int64 to_schema_version) = 0;
 
+  // Runs a step of the migration of the schema to `to_schema_version`, and
+  // returns its `progress`. A step either starts a migration scheme, which
+  // runs its upgrade_queries, runs at most `max_num_chunks` chunks of its
+  // chunked queries, or finishes it, which runs its downgrade_queries and
+  // sets the schema version. The progress of a scheme with chunked queries is
+  // checkpointed, so that each step can be committed in its own transaction,
+  // and the next step resumes from the checkpoint. The `progress` is done once
+  // the database is at `to_schema_version`.
+  // Returns INVALID_ARGUMENT, if `to_schema_version` is less than 0, or newer
+  //   than the library version.
+  // Returns FAILED_PRECONDITION, if db schema version is newer than the
+  //   library version.
+  // Returns NOT_FOUND error, if the database is empty.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status MigrateSchemaStep(
+      int64 to_schema_version, int64 max_num_chunks,
+      SchemaMigrationProgress* progress) = 0;
+
+  // Drops the secondary indices of the schema, e.g., to speed up a bulk load.
+  // The reads return the same results meanwhile, only slower.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status DropSecondaryIndices() = 0;
+
+  // Creates the secondary indices of the schema if they do not exist, e.g.,
+  // after DropSecondaryIndices.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateSecondaryIndices() = 0;
+
+  // Range-partitions the Event and EventPath tables by the time of the events
+  // with `options`: it creates the partitions up to the num_future_partitions
+  // after the one of `now_milliseconds`, and drops the partitions older than
+  // the retention_seconds. The unpartitioned tables of an existing database
+  // are converted first, if `enable_migration` is set.
+  // Returns FAILED_PRECONDITION error, if the tables are not partitioned and
+  //   `enable_migration` is not set.
+  // Returns UNIMPLEMENTED error, if the source does not partition events.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status MaintainEventPartitions(
+      const EventPartitionOptions& options, int64 now_milliseconds,
+      bool enable_migration) = 0;
+
+  // Stores the paths of the events serialized in the rows of the events,
+  // instead of a row per step in the EventPath table. It moves the paths of at
+  // most `max_num_events` events from the EventPath table, and returns their
+  // number in `num_moved_events`. The paths are read and written inline once
+  // no path is left to move, i.e., `num_moved_events` is 0.
+  // Returns FAILED_PRECONDITION error, if paths are left to move and
+  //   `enable_migration` is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InlineEventPaths(bool enable_migration,
+                                        int64 max_num_events,
+                                        int64* num_moved_events) = 0;
+
+  // Stores a serialized copy of the properties and custom properties of each
+  // node in the row of the node, from which the nodes are read without
+  // querying the property tables. It copies the properties of at most
+  // `max_num_nodes` nodes written before, and returns their number in
+  // `num_filled_nodes`. The properties are written inline, and read from the
+  // nodes, once no node is left to fill, i.e., `num_filled_nodes` is 0.
+  // Returns FAILED_PRECONDITION error, if nodes are left to fill and
+  //   `enable_migration` is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InlineNodeProperties(bool enable_migration,
+                                            int64 max_num_nodes,
+                                            int64* num_filled_nodes) = 0;
+
+  // Keeps the copies of the node properties stored by InlineNodeProperties,
+  // if the database has them, up to date with the property changes made
+  // through this object, so that it can share the database with the ones
+  // reading them, while it reads the property tables itself. It is not needed
+  // once InlineNodeProperties is called.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status MaintainNodePropertiesBytes() = 0;
+
+  // Creates the table of the idempotency keys of the write requests, if it
+  // does not exist, see ConnectionConfig.idempotency.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateIdempotencyKeyTable() = 0;
+
+  // Finds an idempotency key, and returns the fingerprint of its request, its
+  // create time and the serialized response of its request.
+  // Returns NOT_FOUND error, if the key is not found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindIdempotencyKey(absl::string_view idempotency_key,
+                                          int64* request_fingerprint,
+                                          absl::Time* create_time,
+                                          std::string* response) = 0;
+
+  // Creates an idempotency key with the fingerprint of its request and the
+  // serialized response of the request.
+  // Returns ALREADY_EXISTS error, if the key exists.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateIdempotencyKey(absl::string_view idempotency_key,
+                                            int64 request_fingerprint,
+                                            absl::Time create_time,
+                                            absl::string_view response) = 0;
+
+  // Finds at most `max_num_keys` idempotency keys created before
+  // `create_time`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindIdempotencyKeysCreatedBefore(
+      absl::Time create_time, int64 max_num_keys,
+      std::vector<std::string>* idempotency_keys) = 0;
+
+  // Deletes the given idempotency keys. The missing keys are skipped.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status DeleteIdempotencyKeys(
+      absl::Span<const std::string> idempotency_keys) = 0;
+
+  // Creates the table of the lineage closure between the artifacts, if it
+  // does not exist, see ConnectionConfig.enable_lineage_closure, and sets
+  // `created` if it did not exist.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateLineageClosureTable(bool* created) = 0;
+
+  // Records that each of the `upstream_artifact_ids` is upstream of each of the
+  // `downstream_artifact_ids` in the lineage closure. The recorded pairs are
+  // skipped.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateLineageClosure(
+      absl::Span<const int64> upstream_artifact_ids,
+      absl::Span<const int64> downstream_artifact_ids) = 0;
+
+  // Finds the ids of the artifacts upstream of any of the `artifact_ids` if
+  // `upstream`, or else downstream of them, in the lineage closure. Each id is
+  // returned once, in no particular order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindLineageClosure(
+      absl::Span<const int64> artifact_ids, bool upstream,
+      std::vector<int64>* related_artifact_ids) = 0;
+
   // Creates a type, returns the assigned type id. A type is one of
   // {ArtifactType, ExecutionType, ContextType}. The id field of the given type
   // is ignored.
@@ -95,6 +238,27 @@ class MetadataAccessObject {
                                   int64* type_id) = 0;
   virtual absl::Status CreateType(const ContextType& type, int64* type_id) = 0;
 
+  // Creates a type with the given `type_id` instead of an assigned one, e.g.,
+  // to replicate a type on several databases with the same id. By default, it
+  // is not supported.
+  // Returns INVALID_ARGUMENT error, if name field is not given.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns UNIMPLEMENTED error, if the implementation does not support it.
+  // Returns detailed INTERNAL error, if query execution fails, e.g., if
+  //   `type_id` is taken.
+  virtual absl::Status CreateTypeWithId(const ArtifactType& type,
+                                        int64 type_id) {
+    return absl::UnimplementedError("CreateTypeWithId is not supported.");
+  }
+  virtual absl::Status CreateTypeWithId(const ExecutionType& type,
+                                        int64 type_id) {
+    return absl::UnimplementedError("CreateTypeWithId is not supported.");
+  }
+  virtual absl::Status CreateTypeWithId(const ContextType& type,
+                                        int64 type_id) {
+    return absl::UnimplementedError("CreateTypeWithId is not supported.");
+  }
+
   // Updates an existing type. A type is one of {ArtifactType, ExecutionType,
   // ContextType}. The update should be backward compatible, i.e., existing
   // properties should not be modified, only new properties can be added.
@@ -135,6 +299,22 @@ class MetadataAccessObject {
       absl::string_view name, absl::optional<absl::string_view> version,
       ContextType* context_type) = 0;
 
+  // Queries the types of a batch of (name, version) pairs, where an empty
+  // version stands for a type without version, with one query for the types
+  // and one for their properties. A type is one of
+  // {ArtifactType, ExecutionType, ContextType}. The found types are returned
+  // in no particular order, and the pairs which are not found are skipped.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ArtifactType>* artifact_types) = 0;
+  virtual absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ExecutionType>* execution_types) = 0;
+  virtual absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ContextType>* context_types) = 0;
+
   // Returns a list of all known type instances. A type is one of
   // {ArtifactType, ExecutionType, ContextType}
   // Returns NOT_FOUND error, if no types can be found.
@@ -164,6 +344,24 @@ class MetadataAccessObject {
   virtual absl::Status FindParentTypesByTypeId(
       int64 type_id, std::vector<ContextType>& output_parent_types) = 0;
 
+  // Queries the parent types of a batch of type ids, and sets them in
+  // `output_parent_types` keyed by type id. The ids of types without parent
+  // types, or of no type of the kind, are left out. The number of queries
+  // does not depend on the number of types.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+          output_parent_types) = 0;
+  virtual absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+          output_parent_types) = 0;
+  virtual absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ContextType>>&
+          output_parent_types) = 0;
+
   // Creates an artifact, returns the assigned artifact id. The id field of the
   // artifact is ignored.
   // Returns INVALID_ARGUMENT error, if the ArtifactType is not given.
@@ -178,16 +376,55 @@ class MetadataAccessObject {
   virtual absl::Status CreateArtifact(const Artifact& artifact,
                                       int64* artifact_id) = 0;
 
+  // Creates a batch of artifacts, and returns the assigned ids in the order of
+  // the given artifacts. The id fields of the artifacts are ignored. The
+  // artifacts and their properties are written with a few multi-row inserts.
+  // Returns the same errors as CreateArtifact for any artifact in the batch.
+  virtual absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                                       std::vector<int64>* artifact_ids) = 0;
+
   // Retrieves artifacts matching the given 'artifact_ids'.
   // Returns NOT_FOUND error, if any of the given artifact_ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
                                          std::vector<Artifact>* artifact) = 0;
 
+  // Same as above, but the properties of the artifacts are selected with
+  // `property_options`. The property table is not read if skip_properties is
+  // set, and only the rows of the given property_names are read otherwise.
+  virtual absl::Status FindArtifactsById(
+      absl::Span<const int64> artifact_ids,
+      const PropertyOptions& property_options,
+      std::vector<Artifact>* artifacts) = 0;
+
   // Queries artifacts stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifacts(std::vector<Artifact>* artifacts) = 0;
 
+  // Streams artifacts stored in the metadata source to `callback` in batches.
+  // Only one batch of artifacts is materialized at a time, so that large
+  // stores can be read without holding all artifacts in memory.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns the error returned by `callback`, if any.
+  virtual absl::Status FindArtifacts(
+      const NodeBatchCallback<Artifact>& callback) = 0;
+
+  // Same as above, but the properties of the artifacts are selected with
+  // `property_options`.
+  virtual absl::Status FindArtifacts(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Artifact>& callback) = 0;
+
+  // Streams the artifacts changed after the watermark, i.e., the ones whose
+  // (last_update_time_since_epoch, id) is greater than
+  // (`last_update_time_since_epoch`, `id`), to `callback` in batches, ordered
+  // by (last_update_time_since_epoch, id).
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns the error returned by `callback`, if any.
+  virtual absl::Status FindArtifactsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Artifact>& callback) = 0;
+
   // Queries artifacts stored in the metadata source using `options`.
   // `options` is the ListOperationOptions proto message defined
   // in metadata_store.
@@ -206,6 +443,13 @@ class MetadataAccessObject {
                                      std::vector<Artifact>* artifacts,
                                      std::string* next_page_token) = 0;
 
+  // Same as above, but the properties of the artifacts are selected with
+  // `property_options`.
+  virtual absl::Status ListArtifacts(const ListOperationOptions& options,
+                                     const PropertyOptions& property_options,
+                                     std::vector<Artifact>* artifacts,
+                                     std::string* next_page_token) = 0;
+
   // Queries executions stored in the metadata source using `options`.
   // `options` is the ListOperationOptions proto message defined
   // in metadata_store.
@@ -224,6 +468,13 @@ class MetadataAccessObject {
                                       std::vector<Execution>* executions,
                                       std::string* next_page_token) = 0;
 
+  // Same as above, but the properties of the executions are selected with
+  // `property_options`.
+  virtual absl::Status ListExecutions(const ListOperationOptions& options,
+                                      const PropertyOptions& property_options,
+                                      std::vector<Execution>* executions,
+                                      std::string* next_page_token) = 0;
+
   // Queries contexts stored in the metadata source using `options`.
   // `options` is the ListOperationOptions proto message defined
   // in metadata_store.
@@ -242,24 +493,84 @@ class MetadataAccessObject {
                                     std::vector<Context>* contexts,
                                     std::string* next_page_token) = 0;
 
+  // Same as above, but the properties of the contexts are selected with
+  // `property_options`.
+  virtual absl::Status ListContexts(const ListOperationOptions& options,
+                                    const PropertyOptions& property_options,
+                                    std::vector<Context>* contexts,
+                                    std::string* next_page_token) = 0;
+
   // Queries an artifact by its type_id and name.
   // Returns NOT_FOUND error, if no artifact can be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifactByTypeIdAndArtifactName(
       int64 artifact_type_id, absl::string_view name, Artifact* artifact) = 0;
 
+  // Queries the artifacts of a type_id by their names, with one query for the
+  // artifacts and one for their properties. The names that are not found are
+  // skipped, and the artifacts are returned in no particular order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactsByTypeIdAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      std::vector<Artifact>* artifacts) = 0;
+
   // Queries artifacts by a given type_id.
   // Returns NOT_FOUND error, if the given artifact_type_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifactsByTypeId(
       int64 artifact_type_id, std::vector<Artifact>* artifacts) = 0;
 
+  // Same as above, but the properties of the artifacts are selected with
+  // `property_options`.
+  virtual absl::Status FindArtifactsByTypeId(
+      int64 artifact_type_id, const PropertyOptions& property_options,
+      std::vector<Artifact>* artifacts) = 0;
+
   // Queries artifacts by a given uri with exact match.
   // Returns NOT_FOUND error, if the given uri cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifactsByURI(absl::string_view uri,
                                           std::vector<Artifact>* artifacts) = 0;
 
+  // Queries artifacts whose uri starts with `uri_prefix`, e.g., the artifacts
+  // under a directory. The lookup uses the index on uri.
+  // Returns INVALID_ARGUMENT error, if the `uri_prefix` is empty.
+  // Returns NOT_FOUND error, if no uri starts with the given prefix.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactsByURIPrefix(
+      absl::string_view uri_prefix, std::vector<Artifact>* artifacts) = 0;
+
+  // Counts the artifacts without reading them. The count is restricted to the
+  // artifacts of `artifact_type_id` and in `state`, if they are given.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                                      absl::optional<Artifact::State> state,
+                                      int64* count) = 0;
+
+  // Queries which of `artifact_ids` exist, without reading the artifacts.
+  // The existing ids are appended to `existing_artifact_ids`, in no particular
+  // order; the other ids are skipped.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindExistingArtifactIds(
+      absl::Span<const int64> artifact_ids,
+      std::vector<int64>* existing_artifact_ids) = 0;
+
+  // Appends the ids of the artifacts of `artifact_type_id` to `artifact_ids`,
+  // in no particular order, without reading the artifacts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactIdsByTypeId(
+      int64 artifact_type_id, std::vector<int64>* artifact_ids) = 0;
+
+  // Aggregates the values of a property over the artifacts of
+  // `artifact_type_id` as specified by `options`, without reading the
+  // artifacts. The `aggregates` are appended in no particular order. If the
+  // artifacts are not grouped by state, there is a single aggregate, whose
+  // num_nodes is 0 if no artifact matches.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) = 0;
+
   // Updates an artifact.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
   // Returns INVALID_ARGUMENT error, if no artifact is found with the given id.
@@ -270,6 +581,42 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateArtifact(const Artifact& artifact) = 0;
 
+  // Updates a batch of artifacts. The stored artifacts are read with one query
+  // and the property changes are written with a few set-based statements.
+  // Returns INVALID_ARGUMENT error, if an artifact is given more than once.
+  // Returns the same errors as UpdateArtifact for any artifact in the batch.
+  virtual absl::Status UpdateArtifacts(
+      absl::Span<const Artifact> artifacts) = 0;
+
+  // Same as UpdateArtifacts, but it is an optimistic update: the stored
+  // last_update_time_since_epoch of each artifact is compared with the given
+  // one in the WHERE clause of its UPDATE, so no row is read with a lock and
+  // concurrent writers conflict on the first write. The artifacts are written
+  // in the order of their ids, and their last_update_time_since_epoch is
+  // increased even if nothing else is changed.
+  // Returns FAILED_PRECONDITION error, if the stored
+  //   last_update_time_since_epoch of an artifact is different from the given
+  //   one, or is changed concurrently.
+  // Returns the same errors as UpdateArtifacts otherwise.
+  virtual absl::Status UpdateArtifactsIfUnchanged(
+      absl::Span<const Artifact> artifacts) = 0;
+
+  // Deletes the artifacts of `artifact_ids` along with their properties, their
+  // events and event paths, and their attributions. The ids which are not
+  // found are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status DeleteArtifactsById(
+      absl::Span<const int64> artifact_ids) = 0;
+
+  // Sets `artifact_ids` to the ids of at most `limit` artifacts of
+  // `artifact_type_id` which are last updated before
+  // `last_update_time_since_epoch`, the least recently updated first.
+  // Returns INVALID_ARGUMENT error, if `limit` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactIdsUpdatedBefore(
+      int64 artifact_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* artifact_ids) = 0;
+
   // Creates an execution, returns the assigned execution id. The id field of
   // the execution is ignored.
   // Returns INVALID_ARGUMENT error, if the ExecutionType is not given.
@@ -284,6 +631,12 @@ class MetadataAccessObject {
   virtual absl::Status CreateExecution(const Execution& execution,
                                        int64* execution_id) = 0;
 
+  // Creates a batch of executions, and returns the assigned ids in the order
+  // of the given executions. The id fields of the executions are ignored.
+  // Returns the same errors as CreateExecution for any execution in the batch.
+  virtual absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves executions matching the given 'ids'.
   // Returns NOT_FOUND error, if any of the given ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -291,10 +644,35 @@ class MetadataAccessObject {
       absl::Span<const int64> execution_ids,
       std::vector<Execution>* executions) = 0;
 
+  // Same as above, but the properties of the executions are selected with
+  // `property_options`.
+  virtual absl::Status FindExecutionsById(
+      absl::Span<const int64> execution_ids,
+      const PropertyOptions& property_options,
+      std::vector<Execution>* executions) = 0;
+
   // Queries executions stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindExecutions(std::vector<Execution>* executions) = 0;
 
+  // Streams executions stored in the metadata source to `callback` in batches.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns the error returned by `callback`, if any.
+  virtual absl::Status FindExecutions(
+      const NodeBatchCallback<Execution>& callback) = 0;
+
+  // Same as above, but the properties of the executions are selected with
+  // `property_options`.
+  virtual absl::Status FindExecutions(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Execution>& callback) = 0;
+
+  // Streams the executions changed after the watermark to `callback`. See
+  // FindArtifactsUpdatedAfter.
+  virtual absl::Status FindExecutionsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Execution>& callback) = 0;
+
   // Queries an execution by its type_id and name.
   // Returns NOT_FOUND error, if no execution can be found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -302,12 +680,40 @@ class MetadataAccessObject {
       int64 execution_type_id, absl::string_view name,
       Execution* execution) = 0;
 
+  // Queries the executions of a type_id by their names, with one query for the
+  // executions and one for their properties. The names that are not found are
+  // skipped, and the executions are returned in no particular order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindExecutionsByTypeIdAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      std::vector<Execution>* executions) = 0;
+
   // Queries executions by a given type_id.
   // Returns NOT_FOUND error, if the given execution_type_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindExecutionsByTypeId(
       int64 execution_type_id, std::vector<Execution>* executions) = 0;
 
+  // Same as above, but the properties of the executions are selected with
+  // `property_options`.
+  virtual absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id, const PropertyOptions& property_options,
+      std::vector<Execution>* executions) = 0;
+
+  // Counts the executions without reading them. The count is restricted to
+  // the executions of `execution_type_id` and in `last_known_state`, if they
+  // are given.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state, int64* count) = 0;
+
+  // Same as AggregateArtifactProperty, but for the executions of
+  // `execution_type_id`.
+  virtual absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) = 0;
+
   // Updates an execution.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
   // Returns INVALID_ARGUMENT error, if no execution is found with the given id.
@@ -318,6 +724,32 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateExecution(const Execution& execution) = 0;
 
+  // Updates a batch of executions with a few set-based statements.
+  // Returns INVALID_ARGUMENT error, if an execution is given more than once.
+  // Returns the same errors as UpdateExecution for any execution in the batch.
+  virtual absl::Status UpdateExecutions(
+      absl::Span<const Execution> executions) = 0;
+
+  // Same as UpdateArtifactsIfUnchanged, but for executions.
+  virtual absl::Status UpdateExecutionsIfUnchanged(
+      absl::Span<const Execution> executions) = 0;
+
+  // Deletes the executions of `execution_ids` along with their properties,
+  // their events and event paths, and their associations. The ids which are
+  // not found are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) = 0;
+
+  // Sets `execution_ids` to the ids of at most `limit` executions of
+  // `execution_type_id` which are last updated before
+  // `last_update_time_since_epoch`, the least recently updated first.
+  // Returns INVALID_ARGUMENT error, if `limit` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindExecutionIdsUpdatedBefore(
+      int64 execution_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* execution_ids) = 0;
+
   // Creates a context, returns the assigned context id. The id field of the
   // context is ignored. The name field of the context must not be empty and it
   // should be unique in the same ContextType.
@@ -333,16 +765,56 @@ class MetadataAccessObject {
   virtual absl::Status CreateContext(const Context& context,
                                      int64* context_id) = 0;
 
+  // Creates a context as CreateContext does, unless the ContextType already
+  // has a context with the name, which may be created by a concurrent
+  // transaction. Returns the id of the created or the existing context, and
+  // whether the context is created. The existing context is not updated.
+  // Returns the same errors as CreateContext, except ALREADY_EXISTS.
+  virtual absl::Status CreateContextIfNotExist(const Context& context,
+                                               int64* context_id,
+                                               bool* created) = 0;
+
+  // Creates a batch of contexts, and returns the assigned ids in the order of
+  // the given contexts. The id fields of the contexts are ignored.
+  // Returns the same errors as CreateContext for any context in the batch.
+  virtual absl::Status CreateContexts(absl::Span<const Context> contexts,
+                                      std::vector<int64>* context_ids) = 0;
+
   // Retrieves contexts matching a collection of ids.
   // Returns NOT_FOUND if any of the given ids are not found.
   // Returns detailed INTERNAL error if query execution fails.
   virtual absl::Status FindContextsById(absl::Span<const int64> context_ids,
                                         std::vector<Context>* context) = 0;
 
+  // Same as above, but the properties of the contexts are selected with
+  // `property_options`.
+  virtual absl::Status FindContextsById(
+      absl::Span<const int64> context_ids,
+      const PropertyOptions& property_options,
+      std::vector<Context>* contexts) = 0;
+
   // Queries contexts stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindContexts(std::vector<Context>* contexts) = 0;
 
+  // Streams contexts stored in the metadata source to `callback` in batches.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns the error returned by `callback`, if any.
+  virtual absl::Status FindContexts(
+      const NodeBatchCallback<Context>& callback) = 0;
+
+  // Same as above, but the properties of the contexts are selected with
+  // `property_options`.
+  virtual absl::Status FindContexts(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Context>& callback) = 0;
+
+  // Streams the contexts changed after the watermark to `callback`. See
+  // FindArtifactsUpdatedAfter.
+  virtual absl::Status FindContextsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Context>& callback) = 0;
+
   // Queries contexts by a given type_id.
   // Returns NOT_FOUND error, if no context can be found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -350,6 +822,19 @@ class MetadataAccessObject {
       int64 type_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Context>* contexts, std::string* next_page_token) = 0;
 
+  // Same as above, but the properties of the contexts are selected with
+  // `property_options`.
+  virtual absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      const PropertyOptions& property_options, std::vector<Context>* contexts,
+      std::string* next_page_token) = 0;
+
+  // Counts the contexts without reading them. The count is restricted to the
+  // contexts of `context_type_id`, if it is given.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CountContexts(absl::optional<int64> context_type_id,
+                                     int64* count) = 0;
+
   // Queries a context by a type_id and a context name.
   // Returns NOT_FOUND error, if no context can be found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -357,6 +842,14 @@ class MetadataAccessObject {
                                                          absl::string_view name,
                                                          Context* context) = 0;
 
+  // Queries the contexts of a type_id by their names, with one query for the
+  // contexts and one for their properties. The names that are not found are
+  // skipped, and the contexts are returned in no particular order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindContextsByTypeIdAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      std::vector<Context>* contexts) = 0;
+
   // Updates a context.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
   // Returns INVALID_ARGUMENT error, if no context is found with the given id.
@@ -367,6 +860,15 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateContext(const Context& context) = 0;
 
+  // Updates a batch of contexts with a few set-based statements.
+  // Returns INVALID_ARGUMENT error, if a context is given more than once.
+  // Returns the same errors as UpdateContext for any context in the batch.
+  virtual absl::Status UpdateContexts(absl::Span<const Context> contexts) = 0;
+
+  // Same as UpdateArtifactsIfUnchanged, but for contexts.
+  virtual absl::Status UpdateContextsIfUnchanged(
+      absl::Span<const Context> contexts) = 0;
+
   // Creates an event, returns the assigned event id. If the event occurrence
   // time is not given, the insertion time is used.
   // TODO(huimiao) Allow to have a unknown event time.
@@ -375,17 +877,37 @@ class MetadataAccessObject {
   // Returns INVALID_ARGUMENT error, if the type field is UNKNOWN.
   virtual absl::Status CreateEvent(const Event& event, int64* event_id) = 0;
 
-  // Queries the events associated with a collection of artifact_ids.
+  // Creates a batch of events, and returns the assigned ids in the order of
+  // the given events. The events and all their path steps are written with a
+  // few multi-row inserts.
+  // Returns the same errors as CreateEvent for any event in the batch.
+  virtual absl::Status CreateEvents(absl::Span<const Event> events,
+                                    std::vector<int64>* event_ids) = 0;
+
+  // Queries the events associated with a collection of artifact_ids. If
+  // `types` is not empty, only the events of those types are queried.
   // Returns NOT_FOUND error, if no `events` can be found.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
   virtual absl::Status FindEventsByArtifacts(
-      const std::vector<int64>& artifact_ids, std::vector<Event>* events) = 0;
+      const std::vector<int64>& artifact_ids,
+      absl::Span<const Event::Type> types,
+      std::vector<Event>* events) = 0;
+  absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
+                                     std::vector<Event>* events) {
+    return FindEventsByArtifacts(artifact_ids, /*types=*/{}, events);
+  }
 
-  // Queries the events associated with a collection of execution_ids.
+  // Queries the events associated with a collection of execution_ids. If
+  // `types` is not empty, only the events of those types are queried.
   // Returns NOT_FOUND error, if no `events` can be found.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
   virtual absl::Status FindEventsByExecutions(
-      const std::vector<int64>& execution_ids, std::vector<Event>* events) = 0;
+      const std::vector<int64>& execution_ids,
+      absl::Span<const Event::Type> types, std::vector<Event>* events) = 0;
+  absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
+                                      std::vector<Event>* events) {
+    return FindEventsByExecutions(execution_ids, /*types=*/{}, events);
+  }
 
   // Creates an association, returns the assigned association id.
   // Returns INVALID_ARGUMENT error, if no context matches the context_id.
@@ -394,11 +916,30 @@ class MetadataAccessObject {
   virtual absl::Status CreateAssociation(const Association& association,
                                          int64* association_id) = 0;
 
+  // Creates a batch of associations with a few multi-row inserts, which skip
+  // the associations that already exist. The contexts and the executions are
+  // validated with one query each.
+  // Returns INVALID_ARGUMENT error, if a context_id or an execution_id is not
+  //   given, or is not found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateAssociations(
+      absl::Span<const Association> associations) = 0;
+
   // Queries the contexts that an execution_id is associated with.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindContextsByExecution(
       int64 execution_id, std::vector<Context>* contexts) = 0;
 
+  // Queries the contexts that each of the execution_ids is associated with,
+  // with one query for the associations and one fetch of the contexts, which
+  // fetches a context shared by several executions once. The executions
+  // without contexts are not in `contexts_by_execution`.
+  // Returns INVALID_ARGUMENT error, if the `contexts_by_execution` is null.
+  virtual absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>*
+          contexts_by_execution) = 0;
+
   // Queries the executions associated with a context_id.
   // Returns INVALID_ARGUMENT error, if the `executions` is null.
   virtual absl::Status FindExecutionsByContext(
@@ -410,6 +951,15 @@ class MetadataAccessObject {
       int64 context_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Execution>* executions, std::string* next_page_token) = 0;
 
+  // Queries the executions associated with each of the context_ids, with one
+  // query for the associations and one fetch of the executions. The contexts
+  // without executions are not in `executions_by_context`.
+  // Returns INVALID_ARGUMENT error, if the `executions_by_context` is null.
+  virtual absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Execution>>*
+          executions_by_context) = 0;
+
   // Creates an attribution, returns the assigned attribution id.
   // Returns INVALID_ARGUMENT error, if no context matches the context_id.
   // Returns INVALID_ARGUMENT error, if no artifact matches the artifact_id.
@@ -417,11 +967,22 @@ class MetadataAccessObject {
   virtual absl::Status CreateAttribution(const Attribution& attribution,
                                          int64* attribution_id) = 0;
 
+  // Same as CreateAssociations, but for attributions.
+  virtual absl::Status CreateAttributions(
+      absl::Span<const Attribution> attributions) = 0;
+
   // Queries the contexts that an artifact_id is attributed to.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindContextsByArtifact(
       int64 artifact_id, std::vector<Context>* contexts) = 0;
 
+  // Same as FindContextsByExecutions, but for the attributions of artifacts.
+  // Returns INVALID_ARGUMENT error, if the `contexts_by_artifact` is null.
+  virtual absl::Status FindContextsByArtifacts(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>*
+          contexts_by_artifact) = 0;
+
   // Queries the artifacts attributed to a context_id.
   // Returns INVALID_ARGUMENT error, if the `artifacts` is null.
   virtual absl::Status FindArtifactsByContext(
@@ -435,6 +996,15 @@ class MetadataAccessObject {
       int64 context_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Artifact>* artifacts, std::string* next_page_token) = 0;
 
+  // Queries the artifacts attributed to each of the context_ids, with one
+  // query for the attributions and one fetch of the artifacts. The contexts
+  // without artifacts are not in `artifacts_by_context`.
+  // Returns INVALID_ARGUMENT error, if the `artifacts_by_context` is null.
+  virtual absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Artifact>>*
+          artifacts_by_context) = 0;
+
   // Creates a parent context, returns OK if succeeds.
   // Returns INVALID_ARGUMENT error, if no context matches the child_id.
   // Returns INVALID_ARGUMENT error, if no context matches the parent_id.
@@ -444,6 +1014,16 @@ class MetadataAccessObject {
   virtual absl::Status CreateParentContext(
       const ParentContext& parent_context) = 0;
 
+  // Creates a batch of parent contexts with a few multi-row inserts. The
+  // contexts are validated with one query.
+  // Returns INVALID_ARGUMENT error, if a parent / child id is not given, or is
+  //   not found, or if a context is its own parent.
+  // Returns ALREADY_EXISTS error, if a parent context already exists or is
+  //   given more than once.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateParentContexts(
+      absl::Span<const ParentContext> parent_contexts) = 0;
+
   // Queries the parent-contexts of a context_id.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindParentContextsByContextId(
@@ -454,6 +1034,23 @@ class MetadataAccessObject {
   virtual absl::Status FindChildContextsByContextId(
       int64 context_id, std::vector<Context>* contexts) = 0;
 
+  // Queries the ancestor contexts of a context_id within `max_depth` levels,
+  // where the parent-contexts are at depth 1. The `parent_contexts` are the
+  // ParentContext links between the context and the ancestors. Each ancestor
+  // and link is returned once.
+  // Returns INVALID_ARGUMENT error, if the `contexts` or `parent_contexts` is
+  // null, or if the `max_depth` is not positive.
+  virtual absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) = 0;
+
+  // Queries the descendant contexts of a context_id within `max_depth` levels,
+  // where the child-contexts are at depth 1. See
+  // FindAncestorContextsByContextId.
+  virtual absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) = 0;
+
   // Resolves the schema version stored in the metadata source. The `db_version`
   // is set to 0, if it is a 0.13.2 release pre-existing database.
   // Returns DATA_LOSS error, if schema version info table exists but its value
@@ -471,6 +1068,31 @@ class MetadataAccessObject {
   // database if needed.
   virtual int64 GetLibraryVersion() = 0;
 
+  // Hints that the nodes created until ClearPlacementHint belong with
+  // `context`, which exists if it has an id, so that implementations which
+  // partition the nodes keep them and their links, e.g., the events of a
+  // PutExecution, in the partition of `context`. By default, it is ignored.
+  virtual absl::Status SetPlacementHint(const Context& context) {
+    return absl::OkStatus();
+  }
+
+  // Clears the hint set by SetPlacementHint.
+  virtual void ClearPlacementHint() {}
+
+  // Sets whether the reads run in a transaction pinned across calls, see
+  // MetadataStore::BeginPinnedRead. The shared caches are neither consulted
+  // for the nodes, which may be newer than its snapshot, nor filled from it.
+  // By default, it is ignored.
+  virtual void SetPinnedRead(bool pinned_read) {}
+
+  // Returns the node cache whose serialized nodes may be spliced into the
+  // responses of the current transaction, see NodeCache::AppendSerialized,
+  // and sets the `schema_version` its entries are looked up with. Returns
+  // nullptr, if there is no such cache, e.g., once the transaction has changed
+  // nodes. By default, there is none.
+  virtual NodeCache* GetSerializedNodeCache(int64* schema_version) {
+    return nullptr;
+  }
 };
 
 }  // namespace ml_metadata
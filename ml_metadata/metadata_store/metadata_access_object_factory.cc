@@ -18,6 +18,9 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/query_config_executor.h"
 #include "ml_metadata/metadata_store/rdbms_metadata_access_object.h"
 #include "ml_metadata/util/return_utils.h"
@@ -32,6 +35,7 @@ namespace {
 absl::Status CreateRDBMSMetadataAccessObject(
     const MetadataSourceQueryConfig& query_config,
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, NodeCache* node_cache,
     std::unique_ptr<MetadataAccessObject>* result) {
   if (!metadata_source->is_connected())
     MLMD_RETURN_IF_ERROR(metadata_source->Connect());
@@ -41,11 +45,38 @@ absl::Status CreateRDBMSMetadataAccessObject(
                 query_config, metadata_source, *schema_version))
           : absl::WrapUnique(
                 new QueryConfigExecutor(query_config, metadata_source));
-  *result =
-      absl::WrapUnique(new RDBMSMetadataAccessObject(std::move(executor)));
+  *result = absl::WrapUnique(new RDBMSMetadataAccessObject(
+      std::move(executor), metadata_source,
+      schema_version.value_or(query_config.schema_version()), type_cache,
+      node_cache));
   return absl::OkStatus();
 }
 
+// Creates an InMemoryMetadataAccessObject for an InMemoryMetadataSource.
+// Returns INVALID_ARGUMENT error, if the MetadataSource is of another kind, or
+// if another schema_version than the one of the library is given.
+absl::Status CreateInMemoryMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    std::unique_ptr<MetadataAccessObject>* result) {
+  auto* const in_memory_metadata_source =
+      dynamic_cast<InMemoryMetadataSource*>(metadata_source);
+  if (in_memory_metadata_source == nullptr) {
+    return absl::InvalidArgumentError(
+        "An in-memory query config requires an InMemoryMetadataSource.");
+  }
+  if (schema_version && *schema_version != query_config.schema_version()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "An in-memory metadata source only supports the schema_version of "
+        "the library: ",
+        query_config.schema_version(), ", given: ", *schema_version));
+  }
+  if (!metadata_source->is_connected())
+    MLMD_RETURN_IF_ERROR(metadata_source->Connect());
+  *result = absl::make_unique<InMemoryMetadataAccessObject>(
+      in_memory_metadata_source, query_config.schema_version());
+  return absl::OkStatus();
+}
 
 }  // namespace
 
@@ -62,16 +93,44 @@ absl::Status CreateMetadataAccessObject(
     const MetadataSourceQueryConfig& query_config,
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
     std::unique_ptr<MetadataAccessObject>* result) {
+  return CreateMetadataAccessObject(query_config, metadata_source,
+                                    schema_version, /*type_cache=*/nullptr,
+                                    result);
+}
+
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, std::unique_ptr<MetadataAccessObject>* result) {
+  return CreateMetadataAccessObject(query_config, metadata_source,
+                                    schema_version, type_cache,
+                                    /*node_cache=*/nullptr, result);
+}
+
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, NodeCache* node_cache,
+    std::unique_ptr<MetadataAccessObject>* result) {
   switch (query_config.metadata_source_type()) {
     case UNKNOWN_METADATA_SOURCE:
       return absl::InvalidArgumentError(
           "Metadata source type is not specified.");
     case MYSQL_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
-                                             schema_version, result);
+                                             schema_version, type_cache,
+                                             node_cache, result);
     case SQLITE_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
-                                             schema_version, result);
+                                             schema_version, type_cache,
+                                             node_cache, result);
+    case POSTGRESQL_METADATA_SOURCE:
+      return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
+                                             schema_version, type_cache,
+                                             node_cache, result);
+    case IN_MEMORY_METADATA_SOURCE:
+      return CreateInMemoryMetadataAccessObject(query_config, metadata_source,
+                                                schema_version, result);
     default:
       return absl::UnimplementedError("Unknown Metadata source type.");
   }
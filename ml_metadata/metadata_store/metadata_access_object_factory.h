@@ -20,6 +20,8 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/node_cache.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
 namespace ml_metadata {
@@ -44,6 +46,23 @@ absl::Status CreateMetadataAccessObject(
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
     std::unique_ptr<MetadataAccessObject>* result);
 
+// Creates a MetadataAccessObject which looks up types in `type_cache`, if it
+// is not nullptr. The caller owns the cache, which must outlive the result and
+// must only be shared by objects connected to the same database.
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, std::unique_ptr<MetadataAccessObject>* result);
+
+// Creates a MetadataAccessObject which also looks up nodes in `node_cache`, if
+// it is not nullptr, which is owned and shared like `type_cache`. The
+// in-memory MetadataAccessObjects use neither of the caches.
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, NodeCache* node_cache,
+    std::unique_ptr<MetadataAccessObject>* result);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_FACTORY_H_
@@ -19,13 +19,26 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/node_cache.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
 
 namespace ml_metadata {
 namespace {
 
+// A SQLite source whose transactions claim to read from a replica.
+class ReplicaSqliteMetadataSource : public SqliteMetadataSource {
+ public:
+  explicit ReplicaSqliteMetadataSource(const SqliteMetadataSourceConfig& config)
+      : SqliteMetadataSource(config) {}
+
+  bool reads_from_replica() const override { return on_replica; }
+
+  bool on_replica = false;
+};
+
 // Explicitly checks CreateMetadataAccessObject. Tests it with
 // SQLite and replicates InitMetadataSourceCheckSchemaVersion from the
 // MetadataAccessObjectTest.
@@ -50,5 +63,297 @@ TEST(MetadataAccessObjectFactory, CreateMetadataAccessObject) {
   EXPECT_EQ(schema_version, library_version);
 }
 
+TEST(MetadataAccessObjectFactory, CreateMetadataAccessObjectWithTypeCache) {
+  SqliteMetadataSourceConfig config;
+  std::unique_ptr<MetadataSource> metadata_source =
+      absl::make_unique<SqliteMetadataSource>(config);
+  TypeCache type_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(),
+                metadata_source.get(), /*schema_version=*/absl::nullopt,
+                &type_cache, &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("cached_type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  // The transaction creating the type does not use the cache.
+  ArtifactType got_type;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindTypeById(type_id, &got_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(type_cache.num_misses(), 0);
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindTypeById(type_id, &got_type));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindTypeById(type_id, &got_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindTypeByNameAndVersion(
+                                  "cached_type", absl::nullopt, &got_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(type_cache.num_misses(), 1);
+  EXPECT_EQ(type_cache.num_hits(), 2);
+
+  (*type.mutable_properties())["p"] = INT;
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->UpdateType(type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindTypeById(type_id, &got_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(type_cache.num_misses(), 2);
+  EXPECT_EQ(got_type.properties().at("p"), INT);
+}
+
+// A type read by a transaction which began before another store invalidated
+// the cache may be from an older snapshot, and is not cached.
+TEST(MetadataAccessObjectFactory, TypeReadBeforeInvalidationIsNotCached) {
+  SqliteMetadataSourceConfig config;
+  std::unique_ptr<MetadataSource> metadata_source =
+      absl::make_unique<SqliteMetadataSource>(config);
+  TypeCache type_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(),
+                metadata_source.get(), /*schema_version=*/absl::nullopt,
+                &type_cache, &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("cached_type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  type_cache.Invalidate();
+  ArtifactType got_type;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindTypeById(type_id, &got_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(type_cache.num_misses(), 1);
+
+  // The next transaction reads the type again, and caches it.
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->FindTypeById(type_id, &got_type));
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  }
+  EXPECT_EQ(type_cache.num_misses(), 2);
+  EXPECT_EQ(type_cache.num_hits(), 1);
+}
+
+TEST(MetadataAccessObjectFactory, CreateMetadataAccessObjectWithNodeCache) {
+  SqliteMetadataSourceConfig config;
+  std::unique_ptr<MetadataSource> metadata_source =
+      absl::make_unique<SqliteMetadataSource>(config);
+  NodeCache node_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(),
+                metadata_source.get(), /*schema_version=*/absl::nullopt,
+                /*type_cache=*/nullptr, &node_cache, &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_uri("uri");
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  // The transaction creating the artifact does not use the cache.
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                  {artifact_id}, &got_artifacts));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(node_cache.num_misses(), 0);
+
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+    got_artifacts.clear();
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                    {artifact_id}, &got_artifacts));
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  }
+  EXPECT_EQ(node_cache.num_misses(), 1);
+  EXPECT_EQ(node_cache.num_hits(), 1);
+
+  artifact.set_id(artifact_id);
+  artifact.set_uri("updated_uri");
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->UpdateArtifact(artifact));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  got_artifacts.clear();
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                  {artifact_id}, &got_artifacts));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(node_cache.num_misses(), 2);
+  ASSERT_EQ(got_artifacts.size(), 1);
+  EXPECT_EQ(got_artifacts[0].uri(), "updated_uri");
+}
+
+// A node read by a transaction which began before another store invalidated
+// it may be from an older snapshot, and is not cached.
+TEST(MetadataAccessObjectFactory, NodeReadBeforeInvalidationIsNotCached) {
+  SqliteMetadataSourceConfig config;
+  std::unique_ptr<MetadataSource> metadata_source =
+      absl::make_unique<SqliteMetadataSource>(config);
+  NodeCache node_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(),
+                metadata_source.get(), /*schema_version=*/absl::nullopt,
+                /*type_cache=*/nullptr, &node_cache, &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  node_cache.Invalidate<Artifact>({artifact_id});
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                  {artifact_id}, &got_artifacts));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(node_cache.num_misses(), 1);
+
+  // The next transaction reads the node again, and caches it.
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+    got_artifacts.clear();
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                    {artifact_id}, &got_artifacts));
+    ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  }
+  EXPECT_EQ(node_cache.num_misses(), 2);
+  EXPECT_EQ(node_cache.num_hits(), 1);
+}
+
+TEST(MetadataAccessObjectFactory, PinnedReadBypassesTheCaches) {
+  SqliteMetadataSourceConfig config;
+  std::unique_ptr<MetadataSource> metadata_source =
+      absl::make_unique<SqliteMetadataSource>(config);
+  TypeCache type_cache;
+  NodeCache node_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(),
+                metadata_source.get(), /*schema_version=*/absl::nullopt,
+                &type_cache, &node_cache, &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+
+  metadata_access_object->SetPinnedRead(true);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  for (int i = 0; i < 2; i++) {
+    ArtifactType got_type;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->FindTypeById(type_id, &got_type));
+    std::vector<Artifact> got_artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                    {artifact_id}, &got_artifacts));
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  // The types are looked up but not inserted, and the nodes are not looked
+  // up at all.
+  EXPECT_GE(type_cache.num_misses(), 2);
+  EXPECT_EQ(type_cache.num_hits(), 0);
+  EXPECT_EQ(node_cache.num_misses(), 0);
+  EXPECT_EQ(node_cache.num_hits(), 0);
+}
+
+TEST(MetadataAccessObjectFactory, ReplicaReadDoesNotFillTheCaches) {
+  SqliteMetadataSourceConfig config;
+  ReplicaSqliteMetadataSource metadata_source(config);
+  TypeCache type_cache;
+  NodeCache node_cache;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(
+                util::GetSqliteMetadataSourceQueryConfig(), &metadata_source,
+                /*schema_version=*/absl::nullopt, &type_cache, &node_cache,
+                &metadata_access_object));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  ArtifactType type;
+  type.set_name("type");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+
+  // A lagging replica may return stale nodes, which are looked up in the
+  // caches but never inserted.
+  metadata_source.on_replica = true;
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+    ArtifactType got_type;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->FindTypeById(type_id, &got_type));
+    std::vector<Artifact> got_artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                    {artifact_id}, &got_artifacts));
+    ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+  }
+  EXPECT_EQ(type_cache.num_hits(), 0);
+  EXPECT_EQ(node_cache.num_misses(), 2);
+  EXPECT_EQ(node_cache.num_hits(), 0);
+
+  // The reads on the primary fill them.
+  metadata_source.on_replica = false;
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+    std::vector<Artifact> got_artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                    {artifact_id}, &got_artifacts));
+    ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+  }
+  EXPECT_EQ(node_cache.num_misses(), 3);
+  EXPECT_EQ(node_cache.num_hits(), 1);
+}
+
 }  // namespace
 }  // namespace ml_metadata
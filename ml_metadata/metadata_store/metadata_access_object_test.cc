@@ -21,13 +21,16 @@ limitations under the License.
 #include "google/protobuf/repeated_field.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -181,8 +184,10 @@ using ::ml_metadata::testing::ParseTextProtoOrDie;
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 using ::testing::Pointwise;
+using ::testing::Property;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 using ::testing::UnorderedPointwise;
 
 // A utility method creates and stores a type based on the given text proto.
@@ -765,6 +770,63 @@ TEST_P(MetadataAccessObjectTest, FindParentTypesByTypeIdError) {
   }
 }
 
+TEST_P(MetadataAccessObjectTest, FindParentTypesByTypeIds) {
+  if (!metadata_access_object_container_->HasParentTypeSupport()) {
+    return;
+  }
+  ASSERT_EQ(absl::OkStatus(), Init());
+  // ArtifactType:  type1 -> type2
+  //                     \-> type3
+  //                type2 -> type3
+  //                type4
+  // ExecutionType: type5 -> type6
+  const ArtifactType type1 = CreateTypeFromTextProto<ArtifactType>(
+      "name: 't1'", *metadata_access_object_);
+  const ArtifactType type2 = CreateTypeFromTextProto<ArtifactType>(R"(
+          name: 't2'
+          properties { key: 'property_2' value: INT }
+      )", *metadata_access_object_);
+  const ArtifactType type3 = CreateTypeFromTextProto<ArtifactType>(
+      "name: 't3'", *metadata_access_object_);
+  const ArtifactType type4 = CreateTypeFromTextProto<ArtifactType>(
+      "name: 't4'", *metadata_access_object_);
+  const ExecutionType type5 = CreateTypeFromTextProto<ExecutionType>(
+      "name: 't5'", *metadata_access_object_);
+  const ExecutionType type6 = CreateTypeFromTextProto<ExecutionType>(
+      "name: 't6'", *metadata_access_object_);
+  ASSERT_EQ(
+      absl::OkStatus(),
+      metadata_access_object_->CreateParentTypeInheritanceLink(type1, type2));
+  ASSERT_EQ(
+      absl::OkStatus(),
+      metadata_access_object_->CreateParentTypeInheritanceLink(type1, type3));
+  ASSERT_EQ(
+      absl::OkStatus(),
+      metadata_access_object_->CreateParentTypeInheritanceLink(type2, type3));
+  ASSERT_EQ(
+      absl::OkStatus(),
+      metadata_access_object_->CreateParentTypeInheritanceLink(type5, type6));
+
+  // The types without parents, or of another kind, are left out.
+  absl::flat_hash_map<int64, std::vector<ArtifactType>> parent_types;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindParentTypesByTypeIds(
+                {type1.id(), type2.id(), type3.id(), type4.id(), type5.id()},
+                parent_types));
+  ASSERT_THAT(parent_types, SizeIs(2));
+  EXPECT_THAT(parent_types[type1.id()],
+              UnorderedElementsAre(EqualsProto(type2), EqualsProto(type3)));
+  EXPECT_THAT(parent_types[type2.id()], ElementsAre(EqualsProto(type3)));
+
+  absl::flat_hash_map<int64, std::vector<ExecutionType>> parent_execution_types;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindParentTypesByTypeIds(
+                {type5.id(), type6.id()}, parent_execution_types));
+  ASSERT_THAT(parent_execution_types, SizeIs(1));
+  EXPECT_THAT(parent_execution_types[type5.id()],
+              ElementsAre(EqualsProto(type6)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateType) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type1 = ParseTextProtoOrDie<ArtifactType>("name: 'test_type'");
@@ -1208,6 +1270,53 @@ TEST_P(MetadataAccessObjectTest, FindTypeByNameNoSignature) {
           "test_type", /*version=*/absl::nullopt, &context_type)));
 }
 
+TEST_P(MetadataAccessObjectTest, FindTypesByNamesAndVersions) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type_v1 = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    version: 'v1'
+    properties { key: 'property_1' value: INT }
+  )");
+  ArtifactType type_no_version = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: STRING }
+  )");
+  ArtifactType other_type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'other_type'
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type_v1, &type_id));
+  type_v1.set_id(type_id);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type_no_version, &type_id));
+  type_no_version.set_id(type_id);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(other_type, &type_id));
+
+  // Only the given pairs are returned, once each, and the unknown ones are
+  // skipped.
+  std::vector<ArtifactType> got_types;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypesByNamesAndVersions(
+                {{"test_type", "v1"},
+                 {"test_type", ""},
+                 {"test_type", "v1"},
+                 {"test_type", "v2"},
+                 {"unknown_type", ""}},
+                &got_types));
+  EXPECT_THAT(got_types, UnorderedElementsAre(EqualsProto(type_v1),
+                                              EqualsProto(type_no_version)));
+
+  // The pairs are looked up in the kind of the given types.
+  std::vector<ExecutionType> execution_types;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypesByNamesAndVersions(
+                {{"test_type", "v1"}}, &execution_types));
+  EXPECT_THAT(execution_types, IsEmpty());
+}
+
 TEST_P(MetadataAccessObjectTest, FindAllArtifactTypes) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType want_type_1 = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1491,6 +1600,89 @@ TEST_P(MetadataAccessObjectTest, CreateArtifactWithDuplicatedNameError) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateArtifacts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+
+  // More artifacts than fit in one multi-row insert statement.
+  std::vector<Artifact> want_artifacts(300);
+  for (int i = 0; i < want_artifacts.size(); i++) {
+    Artifact& artifact = want_artifacts[i];
+    artifact.set_type_id(type_id);
+    artifact.set_uri(absl::StrCat("testuri://testing/uri", i));
+    (*artifact.mutable_properties())["property_1"].set_int_value(i);
+    if (i % 2 == 0) {
+      artifact.set_name(absl::StrCat("artifact", i));
+      artifact.set_state(Artifact::LIVE);
+      (*artifact.mutable_properties())["property_2"].set_string_value("2");
+    }
+    if (i % 3 == 0) {
+      (*artifact.mutable_custom_properties())["custom"].set_double_value(i);
+    }
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  want_artifacts, &artifact_ids));
+  ASSERT_EQ(artifact_ids.size(), want_artifacts.size());
+
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &got_artifacts));
+  ASSERT_EQ(got_artifacts.size(), want_artifacts.size());
+  absl::node_hash_map<int64, Artifact> got_artifacts_by_id;
+  for (const Artifact& artifact : got_artifacts) {
+    got_artifacts_by_id[artifact.id()] = artifact;
+  }
+  for (int i = 0; i < want_artifacts.size(); i++) {
+    EXPECT_THAT(got_artifacts_by_id[artifact_ids[i]],
+                EqualsProto(want_artifacts[i], /*ignore_fields=*/{
+                                "id", "create_time_since_epoch",
+                                "last_update_time_since_epoch"}));
+  }
+
+  // the batch is validated before any artifact is created
+  Artifact mismatched_artifact;
+  mismatched_artifact.set_type_id(type_id);
+  (*mismatched_artifact.mutable_properties())["property_1"].set_string_value(
+      "3");
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateArtifacts(
+      {want_artifacts[1], mismatched_artifact}, &artifact_ids)));
+  Artifact unknown_type_artifact;
+  unknown_type_artifact.set_type_id(type_id + 1);
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->CreateArtifacts(
+      {unknown_type_artifact}, &artifact_ids)));
+
+  // insert the same named artifact again to check the unique constraint
+  EXPECT_TRUE(absl::IsAlreadyExists(metadata_access_object_->CreateArtifacts(
+      {want_artifacts[0]}, &artifact_ids)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+}
+
+TEST_P(MetadataAccessObjectTest, CreateContextsError) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const int64 type_id = InsertType<ContextType>("test_type");
+  Context context;
+  context.set_type_id(type_id);
+  context.set_name("context");
+  std::vector<int64> context_ids;
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CreateContexts(
+                                  {context}, &context_ids));
+  EXPECT_EQ(context_ids.size(), 1);
+
+  Context unnamed_context;
+  unnamed_context.set_type_id(type_id);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateContexts(
+      {unnamed_context}, &context_ids)));
+}
+
 TEST_P(MetadataAccessObjectTest, FindArtifactById) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1545,6 +1737,51 @@ TEST_P(MetadataAccessObjectTest, FindArtifactById) {
             got_artifact.create_time_since_epoch());
 }
 
+TEST_P(MetadataAccessObjectTest, FindArtifactsByLongIdLists) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  // More ids than a single query holds, and enough ids to be loaded into the
+  // id list table of the backends that have one.
+  for (const int num_artifacts :
+       {3 * kMaxIdsPerQuery + 1, kMinIdsForIdListTable + 1}) {
+    std::vector<Artifact> want_artifacts(num_artifacts);
+    for (int i = 0; i < num_artifacts; ++i) {
+      want_artifacts[i].set_type_id(type_id);
+      want_artifacts[i].set_uri(absl::StrCat("testuri://", num_artifacts, i));
+      (*want_artifacts[i].mutable_properties())["property_1"].set_int_value(i);
+    }
+    std::vector<int64> artifact_ids;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                    want_artifacts, &artifact_ids));
+    for (int i = 0; i < num_artifacts; ++i) {
+      want_artifacts[i].set_id(artifact_ids[i]);
+    }
+
+    std::vector<Artifact> got_artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                    artifact_ids, &got_artifacts));
+    ASSERT_THAT(got_artifacts, SizeIs(num_artifacts));
+    absl::flat_hash_map<int64, Artifact> got_artifacts_by_id;
+    for (const Artifact& artifact : got_artifacts) {
+      got_artifacts_by_id[artifact.id()] = artifact;
+    }
+    for (const Artifact& want_artifact : want_artifacts) {
+      ASSERT_TRUE(got_artifacts_by_id.contains(want_artifact.id()));
+      EXPECT_THAT(got_artifacts_by_id[want_artifact.id()],
+                  EqualsProto(want_artifact,
+                              /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}));
+    }
+  }
+}
+
 TEST_P(MetadataAccessObjectTest, FindArtifacts) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1667,6 +1904,739 @@ TEST_P(MetadataAccessObjectTest, FindArtifacts) {
                         /*ignore_fields=*/{"create_time_since_epoch",
                                            "last_update_time_since_epoch"})));
   }
+  // Test: Stream all artifacts
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindArtifacts(
+                  [&got_artifacts](absl::Span<const Artifact> batch) {
+                    got_artifacts.insert(got_artifacts.end(), batch.begin(),
+                                         batch.end());
+                    return absl::OkStatus();
+                  }));
+    EXPECT_THAT(
+        got_artifacts,
+        UnorderedElementsAre(
+            EqualsProto(want_artifact1,
+                        /*ignore_fields=*/{"create_time_since_epoch",
+                                           "last_update_time_since_epoch"}),
+            EqualsProto(want_artifact2,
+                        /*ignore_fields=*/{"create_time_since_epoch",
+                                           "last_update_time_since_epoch"})));
+  }
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesWithPropertyOptions) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const ArtifactType artifact_type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'artifact_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: STRING }
+  )");
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateType(
+                                  artifact_type, &artifact_type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    state: LIVE
+    properties {
+      key: 'property_1'
+      value: { int_value: 1 }
+    }
+    properties {
+      key: 'property_2'
+      value: { string_value: '2' }
+    }
+    custom_properties {
+      key: 'custom_property_1'
+      value: { string_value: '3' }
+    }
+  )");
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  artifact.set_id(artifact_id);
+
+  const ContextType context_type = ParseTextProtoOrDie<ContextType>(R"(
+    name: 'context_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 context_type_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateType(
+                                  context_type, &context_type_id));
+  Context context = ParseTextProtoOrDie<Context>(R"(
+    name: 'context'
+    properties {
+      key: 'property_1'
+      value: { int_value: 1 }
+    }
+  )");
+  context.set_type_id(context_type_id);
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  context.set_id(context_id);
+
+  const PropertyOptions skip_properties =
+      ParseTextProtoOrDie<PropertyOptions>("skip_properties: true");
+  const PropertyOptions selected_properties =
+      ParseTextProtoOrDie<PropertyOptions>(R"(
+        property_names: 'property_1'
+        property_names: 'custom_property_1'
+        property_names: 'unknown_property'
+      )");
+  Artifact want_artifact_without_properties = artifact;
+  want_artifact_without_properties.clear_properties();
+  want_artifact_without_properties.clear_custom_properties();
+  Artifact want_artifact_with_selected_properties = artifact;
+  want_artifact_with_selected_properties.mutable_properties()->erase(
+      "property_2");
+
+  // Test: the properties are skipped, or only the selected ones are returned.
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindArtifactsById(
+                  {artifact_id}, skip_properties, &got_artifacts));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_without_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindArtifactsById(
+                  {artifact_id}, selected_properties, &got_artifacts));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_with_selected_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindArtifactsByTypeId(
+                  artifact_type_id, selected_properties, &got_artifacts));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_with_selected_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindArtifacts(
+                  skip_properties,
+                  [&got_artifacts](absl::Span<const Artifact> batch) {
+                    got_artifacts.insert(got_artifacts.end(), batch.begin(),
+                                         batch.end());
+                    return absl::OkStatus();
+                  }));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_without_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  {
+    const ListOperationOptions list_options =
+        ParseTextProtoOrDie<ListOperationOptions>(R"(
+          max_result_size: 10,
+          order_by_field: { field: ID is_asc: true }
+        )");
+    std::vector<Artifact> got_artifacts;
+    std::string next_page_token;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->ListArtifacts(
+                  list_options, skip_properties, &got_artifacts,
+                  &next_page_token));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_without_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  {
+    Context want_context = context;
+    want_context.clear_properties();
+    std::vector<Context> got_contexts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindContextsByTypeId(
+                  context_type_id, /*list_options=*/absl::nullopt,
+                  skip_properties, &got_contexts,
+                  /*next_page_token=*/nullptr));
+    EXPECT_THAT(got_contexts,
+                ElementsAre(EqualsProto(
+                    want_context,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  // Test: the found nodes are returned along with NOT_FOUND.
+  {
+    std::vector<Artifact> got_artifacts;
+    EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindArtifactsById(
+        {artifact_id, artifact_id + 1}, selected_properties, &got_artifacts)));
+    EXPECT_THAT(got_artifacts,
+                ElementsAre(EqualsProto(
+                    want_artifact_with_selected_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+}
+
+TEST_P(MetadataAccessObjectTest, CountNodesAndFindExistingArtifactIds) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id, other_artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+                &artifact_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'other_type'"),
+                &other_artifact_type_id));
+  std::vector<int64> artifact_ids;
+  for (const int64 type_id :
+       {artifact_type_id, artifact_type_id, other_artifact_type_id}) {
+    Artifact artifact;
+    artifact.set_type_id(type_id);
+    // The second artifact has no state.
+    if (artifact_ids.size() != 1) {
+      artifact.set_state(Artifact::LIVE);
+    }
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact_ids.push_back(artifact_id);
+  }
+  int64 execution_type_id, context_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+                &execution_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+                &context_type_id));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  execution.set_last_known_state(Execution::COMPLETE);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+
+  // Test: the nodes are counted with and without the filters.
+  int64 count = -1;
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CountArtifacts(
+                                  absl::nullopt, absl::nullopt, &count));
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CountArtifacts(
+                                  artifact_type_id, absl::nullopt, &count));
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CountArtifacts(
+                                  artifact_type_id, Artifact::LIVE, &count));
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CountArtifacts(
+                                  absl::nullopt, Artifact::LIVE, &count));
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->CountArtifacts(
+                                  absl::nullopt, Artifact::DELETED, &count));
+  EXPECT_EQ(count, 0);
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountExecutions(
+                execution_type_id, Execution::COMPLETE, &count));
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountExecutions(
+                absl::nullopt, Execution::RUNNING, &count));
+  EXPECT_EQ(count, 0);
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountContexts(context_type_id, &count));
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountContexts(artifact_type_id, &count));
+  EXPECT_EQ(count, 0);
+
+  // Test: only the existing artifact ids are returned.
+  std::vector<int64> existing_ids;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindExistingArtifactIds(
+                {artifact_ids[2], artifact_ids[2] + 100, artifact_ids[0], -1},
+                &existing_ids));
+  EXPECT_THAT(existing_ids,
+              UnorderedElementsAre(artifact_ids[2], artifact_ids[0]));
+  existing_ids.clear();
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->FindExistingArtifactIds(
+                                  {}, &existing_ids));
+  EXPECT_THAT(existing_ids, IsEmpty());
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesUpdatedAfter) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 execution_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+                &execution_type_id));
+  std::vector<int64> execution_ids;
+  for (int i = 0; i < 3; i++) {
+    Execution execution;
+    execution.set_type_id(execution_type_id);
+    execution.set_last_known_state(Execution::RUNNING);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    execution, &execution_id));
+    execution_ids.push_back(execution_id);
+  }
+  const auto find_executions_updated_after =
+      [this](const int64 last_update_time_since_epoch, const int64 id) {
+        std::vector<Execution> executions;
+        EXPECT_EQ(absl::OkStatus(),
+                  metadata_access_object_->FindExecutionsUpdatedAfter(
+                      last_update_time_since_epoch, id,
+                      [&executions](absl::Span<const Execution> batch) {
+                        executions.insert(executions.end(), batch.begin(),
+                                          batch.end());
+                        return absl::OkStatus();
+                      }));
+        return executions;
+      };
+
+  // Test: all the executions are changed after the initial watermark, and
+  // are ordered by update time and id.
+  const std::vector<Execution> all_executions =
+      find_executions_updated_after(0, 0);
+  ASSERT_THAT(all_executions, SizeIs(3));
+  std::vector<int64> got_ids;
+  for (int i = 0; i < all_executions.size(); i++) {
+    got_ids.push_back(all_executions[i].id());
+    if (i > 0) {
+      const Execution& previous = all_executions[i - 1];
+      const Execution& current = all_executions[i];
+      EXPECT_TRUE(previous.last_update_time_since_epoch() <
+                      current.last_update_time_since_epoch() ||
+                  (previous.last_update_time_since_epoch() ==
+                       current.last_update_time_since_epoch() &&
+                   previous.id() < current.id()));
+    }
+  }
+  EXPECT_THAT(got_ids, UnorderedElementsAreArray(execution_ids));
+
+  // Test: the watermark of a node excludes it and the earlier changes.
+  const Execution& first = all_executions[0];
+  EXPECT_THAT(find_executions_updated_after(
+                  first.last_update_time_since_epoch(), first.id()),
+              SizeIs(2));
+  const Execution& last = all_executions[2];
+  EXPECT_THAT(find_executions_updated_after(
+                  last.last_update_time_since_epoch(), last.id()),
+              IsEmpty());
+
+  // Test: an updated execution is changed after the watermark.
+  Execution updated_execution = first;
+  updated_execution.set_last_known_state(Execution::COMPLETE);
+  Execution stored_execution;
+  UpdateAndReturnNode<Execution>(updated_execution, *metadata_access_object_,
+                                 stored_execution);
+  EXPECT_THAT(find_executions_updated_after(
+                  last.last_update_time_since_epoch(), last.id()),
+              ElementsAre(EqualsProto(stored_execution)));
+
+  // Test: the artifacts and contexts are watched separately.
+  int64 artifact_type_id, context_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+                &artifact_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+                &context_type_id));
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  std::vector<int64> changed_ids;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactsUpdatedAfter(
+                0, 0, [&changed_ids](absl::Span<const Artifact> batch) {
+                  for (const Artifact& artifact : batch) {
+                    changed_ids.push_back(artifact.id());
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindContextsUpdatedAfter(
+                0, 0, [&changed_ids](absl::Span<const Context> batch) {
+                  for (const Context& context : batch) {
+                    changed_ids.push_back(context.id());
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(changed_ids, ElementsAre(artifact_id, context_id));
+}
+
+TEST_P(MetadataAccessObjectTest, DeleteNodesById) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>(R"(
+                  name: 'artifact_type'
+                  properties { key: 'p' value: INT }
+                )"),
+                &artifact_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+                &execution_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+                &context_type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://deleted'
+    properties { key: 'p' value: { int_value: 1 } }
+    custom_properties { key: 'c' value: { string_value: 'v' } }
+  )");
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id_1, artifact_id_2;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id_1));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id_2));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id_1, execution_id_2;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                  execution, &execution_id_1));
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                  execution, &execution_id_2));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  for (const std::pair<int64, int64>& link :
+       {std::make_pair(artifact_id_1, execution_id_1),
+        std::make_pair(artifact_id_2, execution_id_1),
+        std::make_pair(artifact_id_1, execution_id_2)}) {
+    Event event = ParseTextProtoOrDie<Event>(R"(
+      type: INPUT
+      path { steps { key: 'input' } }
+    )");
+    event.set_artifact_id(link.first);
+    event.set_execution_id(link.second);
+    int64 event_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateEvent(event, &event_id));
+  }
+  for (const int64 artifact_id : {artifact_id_1, artifact_id_2}) {
+    Attribution attribution;
+    attribution.set_context_id(context_id);
+    attribution.set_artifact_id(artifact_id);
+    int64 attribution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAttribution(
+                                    attribution, &attribution_id));
+  }
+  for (const int64 execution_id : {execution_id_1, execution_id_2}) {
+    Association association;
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+    int64 association_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                    association, &association_id));
+  }
+
+  // Test: the unknown ids are ignored.
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->DeleteArtifactsById(
+                {artifact_id_1, artifact_id_1 + artifact_id_2 + 100}));
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifacts(&artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(Property(&Artifact::id, artifact_id_2)));
+
+  // Test: the events and the attributions of the artifact are deleted.
+  std::vector<Event> events;
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindEventsByArtifacts(
+      {artifact_id_1}, &events)));
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByExecutions(
+                                  {execution_id_1, execution_id_2}, &events));
+  EXPECT_THAT(events,
+              ElementsAre(Property(&Event::artifact_id, artifact_id_2)));
+  std::vector<Artifact> attributed_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByContext(
+                                  context_id, &attributed_artifacts));
+  EXPECT_THAT(attributed_artifacts,
+              ElementsAre(Property(&Artifact::id, artifact_id_2)));
+
+  // Test: the events and the associations of the executions are deleted.
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->DeleteExecutionsById(
+                                  {execution_id_1}));
+  events.clear();
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindEventsByArtifacts(
+      {artifact_id_2}, &events)));
+  std::vector<Execution> associated_executions;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindExecutionsByContext(
+                                  context_id, &associated_executions));
+  EXPECT_THAT(associated_executions,
+              ElementsAre(Property(&Execution::id, execution_id_2)));
+
+  // Test: a node can be created again after the deletes.
+  int64 artifact_id_3;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id_3));
+  artifacts.clear();
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  {artifact_id_3}, &artifacts));
+  artifact.set_id(artifact_id_3);
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(
+                             artifact, /*ignore_fields=*/{
+                                 "type", "create_time_since_epoch",
+                                 "last_update_time_since_epoch"})));
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodeIdsUpdatedBefore) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id, other_type_id, execution_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+                &artifact_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'other_type'"),
+                &other_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+                &execution_type_id));
+  std::vector<int64> artifact_ids;
+  for (const int64 type_id : {artifact_type_id, artifact_type_id,
+                              artifact_type_id, other_type_id}) {
+    Artifact artifact;
+    artifact.set_type_id(type_id);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact_ids.push_back(artifact_id);
+  }
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                  execution, &execution_id));
+  const int64 later = absl::ToUnixMillis(absl::Now() + absl::Hours(1));
+
+  // Test: no node is updated before its creation.
+  std::vector<int64> found_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactIdsUpdatedBefore(
+                artifact_type_id, 0, 10, &found_ids));
+  EXPECT_THAT(found_ids, IsEmpty());
+
+  // Test: only the nodes of the type are found, up to the limit.
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactIdsUpdatedBefore(
+                artifact_type_id, later, 10, &found_ids));
+  EXPECT_THAT(found_ids, UnorderedElementsAre(artifact_ids[0], artifact_ids[1],
+                                              artifact_ids[2]));
+  const std::vector<int64> least_recent_ids(found_ids.begin(),
+                                            found_ids.begin() + 2);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactIdsUpdatedBefore(
+                artifact_type_id, later, 2, &found_ids));
+  EXPECT_EQ(found_ids, least_recent_ids);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindExecutionIdsUpdatedBefore(
+                execution_type_id, later, 10, &found_ids));
+  EXPECT_THAT(found_ids, ElementsAre(execution_id));
+
+  // Test: the limit must be positive.
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->FindExecutionIdsUpdatedBefore(
+          execution_type_id, later, 0, &found_ids)));
+}
+
+TEST_P(MetadataAccessObjectTest, AggregateNodeProperty) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 execution_type_id, context_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ExecutionType>(R"(
+                  name: 'trainer'
+                  properties { key: 'accuracy' value: DOUBLE }
+                )"),
+                &execution_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+                &context_type_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  // The executions, and whether they are associated with the context.
+  const std::vector<std::pair<std::string, bool>> executions = {
+      {"last_known_state: COMPLETE "
+       "properties { key: 'accuracy' value { double_value: 0.5 } }",
+       true},
+      {"last_known_state: COMPLETE "
+       "properties { key: 'accuracy' value { double_value: 0.9 } }",
+       false},
+      {"last_known_state: FAILED "
+       "properties { key: 'accuracy' value { double_value: 0.2 } }",
+       true},
+      {"", false}};
+  for (const auto& execution_and_in_context : executions) {
+    Execution execution =
+        ParseTextProtoOrDie<Execution>(execution_and_in_context.first);
+    execution.set_type_id(execution_type_id);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    execution, &execution_id));
+    if (execution_and_in_context.second) {
+      Association association;
+      association.set_context_id(context_id);
+      association.set_execution_id(execution_id);
+      int64 association_id;
+      ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                      association, &association_id));
+    }
+  }
+
+  // Test: the values are aggregated over all the executions.
+  {
+    std::vector<PropertyAggregate> aggregates;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->AggregateExecutionProperty(
+                  execution_type_id,
+                  ParseTextProtoOrDie<PropertyAggregationOptions>(
+                      "property_name: 'accuracy'"),
+                  &aggregates));
+    ASSERT_THAT(aggregates, SizeIs(1));
+    EXPECT_FALSE(aggregates[0].has_state());
+    EXPECT_EQ(aggregates[0].num_nodes(), 4);
+    EXPECT_EQ(aggregates[0].num_values(), 3);
+    EXPECT_DOUBLE_EQ(aggregates[0].min_value(), 0.2);
+    EXPECT_DOUBLE_EQ(aggregates[0].max_value(), 0.9);
+    EXPECT_NEAR(aggregates[0].avg_value(), 1.6 / 3, 1e-9);
+  }
+  // Test: the executions are counted by state.
+  {
+    std::vector<PropertyAggregate> aggregates;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->AggregateExecutionProperty(
+                  execution_type_id,
+                  ParseTextProtoOrDie<PropertyAggregationOptions>(
+                      "group_by_state: true"),
+                  &aggregates));
+    PropertyAggregate want_complete = ParseTextProtoOrDie<PropertyAggregate>(
+        "num_nodes: 2 num_values: 0");
+    want_complete.set_state(Execution::COMPLETE);
+    PropertyAggregate want_failed = ParseTextProtoOrDie<PropertyAggregate>(
+        "num_nodes: 1 num_values: 0");
+    want_failed.set_state(Execution::FAILED);
+    EXPECT_THAT(aggregates,
+                UnorderedElementsAre(
+                    EqualsProto(ParseTextProtoOrDie<PropertyAggregate>(
+                        "num_nodes: 1 num_values: 0")),
+                    EqualsProto(want_complete), EqualsProto(want_failed)));
+  }
+  // Test: only the executions of the context are aggregated.
+  {
+    std::vector<PropertyAggregate> aggregates;
+    PropertyAggregationOptions options;
+    options.set_property_name("accuracy");
+    options.set_context_id(context_id);
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->AggregateExecutionProperty(
+                  execution_type_id, options, &aggregates));
+    ASSERT_THAT(aggregates, SizeIs(1));
+    EXPECT_EQ(aggregates[0].num_nodes(), 2);
+    EXPECT_EQ(aggregates[0].num_values(), 2);
+    EXPECT_DOUBLE_EQ(aggregates[0].min_value(), 0.2);
+    EXPECT_DOUBLE_EQ(aggregates[0].max_value(), 0.5);
+  }
+  // Test: a custom property of the same name has no values.
+  {
+    std::vector<PropertyAggregate> aggregates;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->AggregateExecutionProperty(
+                  execution_type_id,
+                  ParseTextProtoOrDie<PropertyAggregationOptions>(
+                      "property_name: 'accuracy' is_custom_property: true"),
+                  &aggregates));
+    EXPECT_THAT(aggregates,
+                ElementsAre(EqualsProto(ParseTextProtoOrDie<PropertyAggregate>(
+                    "num_nodes: 4 num_values: 0"))));
+  }
+}
+
+TEST_P(MetadataAccessObjectTest, AggregateArtifactIntProperty) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+                &artifact_type_id));
+  for (const int size : {1, 4}) {
+    Artifact artifact;
+    artifact.set_type_id(artifact_type_id);
+    (*artifact.mutable_custom_properties())["size"].set_int_value(size);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  }
+  std::vector<PropertyAggregate> aggregates;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->AggregateArtifactProperty(
+                artifact_type_id,
+                ParseTextProtoOrDie<PropertyAggregationOptions>(
+                    "property_name: 'size' is_custom_property: true"),
+                &aggregates));
+  EXPECT_THAT(aggregates,
+              ElementsAre(EqualsProto(ParseTextProtoOrDie<PropertyAggregate>(R"(
+                num_nodes: 2
+                num_values: 2
+                min_value: 1
+                max_value: 4
+                avg_value: 2.5
+              )"))));
+
+  // Test: an unknown type has a single empty aggregate.
+  aggregates.clear();
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->AggregateArtifactProperty(
+                artifact_type_id + 100,
+                ParseTextProtoOrDie<PropertyAggregationOptions>(
+                    "property_name: 'size' is_custom_property: true"),
+                &aggregates));
+  EXPECT_THAT(aggregates,
+              ElementsAre(EqualsProto(ParseTextProtoOrDie<PropertyAggregate>(
+                  "num_nodes: 0 num_values: 0"))));
 }
 
 TEST_P(MetadataAccessObjectTest, ListArtifactsInvalidPageSize) {
@@ -1818,6 +2788,278 @@ TEST_P(MetadataAccessObjectTest, ListArtifactsWithIdFieldOptions) {
   EXPECT_EQ(stored_artifacts_count, seen_artifacts_count);
 }
 
+TEST_P(MetadataAccessObjectTest, ListArtifactsInBulkMode) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>("name: 'test_type'");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  for (int i = 0; i < 150; i++) {
+    int64 unused_artifact_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifact(
+                                    artifact, &unused_artifact_id));
+  }
+
+  ListOperationOptions list_options =
+      ParseTextProtoOrDie<ListOperationOptions>(R"(
+        max_result_size: 120,
+        order_by_field: { field: ID is_asc: true }
+      )");
+  // Without bulk mode, the page size is bounded by 100.
+  {
+    std::vector<Artifact> got_artifacts;
+    std::string next_page_token;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->ListArtifacts(
+                  list_options, &got_artifacts, &next_page_token));
+    EXPECT_THAT(got_artifacts, SizeIs(100));
+    EXPECT_FALSE(next_page_token.empty());
+  }
+
+  list_options.set_bulk_mode(true);
+  std::vector<int> page_sizes;
+  std::string next_page_token;
+  do {
+    std::vector<Artifact> got_artifacts;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->ListArtifacts(
+                  list_options, &got_artifacts, &next_page_token));
+    page_sizes.push_back(got_artifacts.size());
+    list_options.set_next_page_token(next_page_token);
+  } while (!next_page_token.empty());
+  EXPECT_THAT(page_sizes, ElementsAre(120, 30));
+}
+
+TEST_P(MetadataAccessObjectTest, ListArtifactsWithPropertyFilters) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'p_int' value: INT }
+    properties { key: 'p_double' value: DOUBLE }
+    properties { key: 'p_string' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  std::vector<int64> artifact_ids;
+  for (int i = 0; i < 5; i++) {
+    Artifact artifact;
+    artifact.set_type_id(type_id);
+    (*artifact.mutable_properties())["p_int"].set_int_value(i);
+    (*artifact.mutable_properties())["p_double"].set_double_value(i + 0.5);
+    (*artifact.mutable_properties())["p_string"].set_string_value(
+        absl::StrCat("s", i));
+    (*artifact.mutable_custom_properties())["p_int"].set_int_value(-i);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact_ids.push_back(artifact_id);
+  }
+
+  const auto list_artifact_ids =
+      [&](const ListOperationOptions& list_options,
+          std::vector<int64>* got_artifact_ids,
+          std::string* next_page_token) -> absl::Status {
+    std::vector<Artifact> got_artifacts;
+    MLMD_RETURN_IF_ERROR(metadata_access_object_->ListArtifacts(
+        list_options, &got_artifacts, next_page_token));
+    got_artifact_ids->clear();
+    for (const Artifact& artifact : got_artifacts) {
+      got_artifact_ids->push_back(artifact.id());
+    }
+    return absl::OkStatus();
+  };
+
+  std::vector<int64> got_artifact_ids;
+  std::string next_page_token;
+  {
+    ListOperationOptions list_options =
+        ParseTextProtoOrDie<ListOperationOptions>(R"(
+          property_filters {
+            name: 'p_int' op: GE value { int_value: 1 }
+          }
+          property_filters {
+            name: 'p_int' op: LT value { int_value: 3 }
+          }
+        )");
+    ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                  &got_artifact_ids,
+                                                  &next_page_token));
+    EXPECT_THAT(got_artifact_ids,
+                ElementsAre(artifact_ids[1], artifact_ids[2]));
+  }
+  {
+    ListOperationOptions list_options =
+        ParseTextProtoOrDie<ListOperationOptions>(R"(
+          property_filters {
+            name: 'p_string' op: EQ value { string_value: 's3' }
+          }
+        )");
+    ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                  &got_artifact_ids,
+                                                  &next_page_token));
+    EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[3]));
+  }
+  {
+    ListOperationOptions list_options =
+        ParseTextProtoOrDie<ListOperationOptions>(R"(
+          property_filters {
+            name: 'p_double' op: LE value { double_value: 1.5 }
+          }
+          property_filters {
+            name: 'p_int' is_custom_property: true op: GT
+            value { int_value: -1 }
+          }
+        )");
+    ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                  &got_artifact_ids,
+                                                  &next_page_token));
+    EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[0]));
+  }
+  {
+    // A value of another kind than the stored one does not match.
+    ListOperationOptions list_options =
+        ParseTextProtoOrDie<ListOperationOptions>(R"(
+          property_filters {
+            name: 'p_int' op: EQ value { string_value: '1' }
+          }
+        )");
+    ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                  &got_artifact_ids,
+                                                  &next_page_token));
+    EXPECT_THAT(got_artifact_ids, IsEmpty());
+  }
+
+  // The filters are kept when listing the following pages.
+  ListOperationOptions list_options =
+      ParseTextProtoOrDie<ListOperationOptions>(R"(
+        max_result_size: 2
+        order_by_field: { field: ID is_asc: true }
+        property_filters {
+          name: 'p_int' op: GE value { int_value: 1 }
+        }
+      )");
+  ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                &got_artifact_ids,
+                                                &next_page_token));
+  EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[1], artifact_ids[2]));
+  list_options.set_next_page_token(next_page_token);
+  ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                &got_artifact_ids,
+                                                &next_page_token));
+  EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[3], artifact_ids[4]));
+
+  // Changing the filters between the pages is not allowed.
+  list_options.mutable_property_filters(0)->mutable_value()->set_int_value(0);
+  EXPECT_TRUE(absl::IsInvalidArgument(list_artifact_ids(
+      list_options, &got_artifact_ids, &next_page_token)));
+
+  // A filter without an operator is invalid.
+  list_options = ParseTextProtoOrDie<ListOperationOptions>(R"(
+    property_filters { name: 'p_int' value { int_value: 1 } }
+  )");
+  EXPECT_TRUE(absl::IsInvalidArgument(list_artifact_ids(
+      list_options, &got_artifact_ids, &next_page_token)));
+}
+
+TEST_P(MetadataAccessObjectTest, ListNodesOfTypeAndState) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 type_id, other_type_id, context_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'type'"), &type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'other_type'"),
+                &other_type_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(
+                ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+                &context_type_id));
+  const std::vector<std::pair<int64, Artifact::State>> artifact_specs = {
+      {type_id, Artifact::LIVE},
+      {other_type_id, Artifact::LIVE},
+      {type_id, Artifact::DELETED},
+      {type_id, Artifact::LIVE}};
+  std::vector<int64> artifact_ids;
+  for (const auto& artifact_spec : artifact_specs) {
+    Artifact artifact;
+    artifact.set_type_id(artifact_spec.first);
+    artifact.set_state(artifact_spec.second);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact_ids.push_back(artifact_id);
+  }
+
+  const auto list_artifact_ids =
+      [&](const ListOperationOptions& list_options,
+          std::vector<int64>* got_artifact_ids,
+          std::string* next_page_token) -> absl::Status {
+    std::vector<Artifact> got_artifacts;
+    MLMD_RETURN_IF_ERROR(metadata_access_object_->ListArtifacts(
+        list_options, &got_artifacts, next_page_token));
+    got_artifact_ids->clear();
+    for (const Artifact& artifact : got_artifacts) {
+      got_artifact_ids->push_back(artifact.id());
+    }
+    return absl::OkStatus();
+  };
+
+  // The latest artifacts of the type are listed page by page.
+  ListOperationOptions list_options =
+      ParseTextProtoOrDie<ListOperationOptions>(R"(
+        max_result_size: 2
+        order_by_field: { field: CREATE_TIME is_asc: false }
+      )");
+  list_options.set_type_id(type_id);
+  std::vector<int64> got_artifact_ids;
+  std::string next_page_token;
+  ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                &got_artifact_ids,
+                                                &next_page_token));
+  EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[3], artifact_ids[2]));
+  list_options.set_next_page_token(next_page_token);
+  ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                &got_artifact_ids,
+                                                &next_page_token));
+  EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[0]));
+
+  // Changing the type between the pages is not allowed.
+  list_options.set_type_id(other_type_id);
+  EXPECT_TRUE(absl::IsInvalidArgument(list_artifact_ids(
+      list_options, &got_artifact_ids, &next_page_token)));
+
+  list_options.clear_next_page_token();
+  list_options.set_type_id(type_id);
+  list_options.set_state(Artifact::LIVE);
+  ASSERT_EQ(absl::OkStatus(), list_artifact_ids(list_options,
+                                                &got_artifact_ids,
+                                                &next_page_token));
+  EXPECT_THAT(got_artifact_ids, ElementsAre(artifact_ids[3], artifact_ids[0]));
+
+  // Contexts have no state.
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  std::vector<Context> got_contexts;
+  list_options.clear_type_id();
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->ListContexts(
+      list_options, &got_contexts, &next_page_token)));
+  list_options.clear_state();
+  list_options.set_type_id(context_type_id);
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->ListContexts(
+                                  list_options, &got_contexts,
+                                  &next_page_token));
+  ASSERT_THAT(got_contexts, SizeIs(1));
+  EXPECT_EQ(got_contexts[0].id(), context_id);
+}
+
 TEST_P(MetadataAccessObjectTest, ListArtifactsOnLastUpdateTime) {
   if (!metadata_access_object_container_->PerformExtendedTests()) {
     return;
@@ -2540,16 +3782,73 @@ TEST_P(MetadataAccessObjectTest, FindArtifactByTypeIdAndArtifactName) {
 
   Artifact got_artifact;
   EXPECT_EQ(absl::OkStatus(),
-            metadata_access_object_->FindArtifactByTypeIdAndArtifactName(
-                type_id, "artifact1", &got_artifact));
-  EXPECT_THAT(want_artifact, EqualsProto(got_artifact, /*ignore_fields=*/{
-                                             "create_time_since_epoch",
-                                             "last_update_time_since_epoch"}));
-  Artifact got_empty_artifact;
-  EXPECT_TRUE(absl::IsNotFound(
-      metadata_access_object_->FindArtifactByTypeIdAndArtifactName(
-          type_id, "unknown", &got_empty_artifact)));
-  EXPECT_THAT(got_empty_artifact, EqualsProto(Artifact()));
+            metadata_access_object_->FindArtifactByTypeIdAndArtifactName(
+                type_id, "artifact1", &got_artifact));
+  EXPECT_THAT(want_artifact, EqualsProto(got_artifact, /*ignore_fields=*/{
+                                             "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+  Artifact got_empty_artifact;
+  EXPECT_TRUE(absl::IsNotFound(
+      metadata_access_object_->FindArtifactByTypeIdAndArtifactName(
+          type_id, "unknown", &got_empty_artifact)));
+  EXPECT_THAT(got_empty_artifact, EqualsProto(Artifact()));
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesByTypeIdAndNames) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const ArtifactType artifact_type = CreateTypeFromTextProto<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )", *metadata_access_object_);
+  std::vector<Artifact> want_artifacts;
+  for (const char* name : {"artifact1", "artifact2", "artifact3"}) {
+    Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+      uri: 'testuri://testing/uri'
+      properties { key: 'property_1' value: { int_value: 1 } }
+    )");
+    artifact.set_type_id(artifact_type.id());
+    artifact.set_name(name);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact.set_id(artifact_id);
+    want_artifacts.push_back(artifact);
+  }
+
+  std::vector<Artifact> got_artifacts;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactsByTypeIdAndArtifactNames(
+                artifact_type.id(), {"artifact1", "unknown", "artifact3"},
+                &got_artifacts));
+  EXPECT_THAT(got_artifacts,
+              UnorderedElementsAre(
+                  EqualsProto(want_artifacts[0], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(want_artifacts[2], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"})));
+
+  const ContextType context_type = CreateTypeFromTextProto<ContextType>(
+      "name: 'context_type'", *metadata_access_object_);
+  Context context = ParseTextProtoOrDie<Context>("name: 'artifact1'");
+  context.set_type_id(context_type.id());
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  std::vector<Context> got_contexts;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindContextsByTypeIdAndContextNames(
+                context_type.id(), {"artifact1", "artifact2"}, &got_contexts));
+  ASSERT_THAT(got_contexts, SizeIs(1));
+  EXPECT_EQ(got_contexts[0].id(), context_id);
+
+  // A type without nodes of the names gives no nodes.
+  std::vector<Execution> got_executions;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindExecutionsByTypeIdAndExecutionNames(
+                context_type.id(), {"artifact1"}, &got_executions));
+  EXPECT_THAT(got_executions, IsEmpty());
 }
 
 TEST_P(MetadataAccessObjectTest, FindArtifactsByURI) {
@@ -2582,6 +3881,106 @@ TEST_P(MetadataAccessObjectTest, FindArtifactsByURI) {
                                               "last_update_time_since_epoch"}));
 }
 
+TEST_P(MetadataAccessObjectTest, FindArtifactsByURIPrefix) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 type_id = InsertType<ArtifactType>("test_type");
+  absl::flat_hash_map<std::string, int64> artifact_ids;
+  for (const std::string uri :
+       {"gs://bucket/dir/a", "gs://bucket/dir/b", "gs://bucket/dir_c",
+        "gs://bucket/di%/d", "gs://bucket/dir*/e", "gs://bucket2/dir/f"}) {
+    Artifact artifact;
+    artifact.set_type_id(type_id);
+    artifact.set_uri(uri);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact_ids[uri] = artifact_id;
+  }
+
+  const auto find_artifact_ids =
+      [&](absl::string_view uri_prefix,
+          std::vector<int64>* got_artifact_ids) -> absl::Status {
+    std::vector<Artifact> got_artifacts;
+    MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByURIPrefix(
+        uri_prefix, &got_artifacts));
+    got_artifact_ids->clear();
+    for (const Artifact& artifact : got_artifacts) {
+      got_artifact_ids->push_back(artifact.id());
+    }
+    return absl::OkStatus();
+  };
+
+  std::vector<int64> got_artifact_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            find_artifact_ids("gs://bucket/dir/", &got_artifact_ids));
+  EXPECT_THAT(got_artifact_ids,
+              UnorderedElementsAre(artifact_ids["gs://bucket/dir/a"],
+                                   artifact_ids["gs://bucket/dir/b"]));
+  ASSERT_EQ(absl::OkStatus(),
+            find_artifact_ids("gs://bucket/", &got_artifact_ids));
+  EXPECT_THAT(got_artifact_ids, SizeIs(5));
+  // The wildcards in the prefix are matched literally.
+  ASSERT_EQ(absl::OkStatus(),
+            find_artifact_ids("gs://bucket/dir_", &got_artifact_ids));
+  EXPECT_THAT(got_artifact_ids,
+              ElementsAre(artifact_ids["gs://bucket/dir_c"]));
+  ASSERT_EQ(absl::OkStatus(),
+            find_artifact_ids("gs://bucket/di%", &got_artifact_ids));
+  EXPECT_THAT(got_artifact_ids,
+              ElementsAre(artifact_ids["gs://bucket/di%/d"]));
+  ASSERT_EQ(absl::OkStatus(),
+            find_artifact_ids("gs://bucket/dir*", &got_artifact_ids));
+  EXPECT_THAT(got_artifact_ids,
+              ElementsAre(artifact_ids["gs://bucket/dir*/e"]));
+
+  EXPECT_TRUE(absl::IsNotFound(
+      find_artifact_ids("gs://bucket/dir/c", &got_artifact_ids)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(find_artifact_ids("", &got_artifact_ids)));
+}
+
+TEST_P(MetadataAccessObjectTest, DropAndCreateSecondaryIndices) {
+  // The indices of the earlier schema versions differ from the current ones.
+  if (EarlierSchemaEnabled()) { return; }
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 type_id = InsertType<ArtifactType>("test_type");
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_uri("gs://bucket/a");
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+
+  // Both are idempotent, and the reads do not depend on the indices.
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->DropSecondaryIndices());
+  }
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByURI(
+                                  "gs://bucket/a", &got_artifacts));
+  ASSERT_THAT(got_artifacts, SizeIs(1));
+  EXPECT_EQ(got_artifacts[0].id(), artifact_id);
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateSecondaryIndices());
+  }
+  got_artifacts.clear();
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByURI(
+                                  "gs://bucket/a", &got_artifacts));
+  ASSERT_THAT(got_artifacts, SizeIs(1));
+  EXPECT_EQ(got_artifacts[0].id(), artifact_id);
+}
+
+TEST_P(MetadataAccessObjectTest, MaintainEventPartitionsWithoutPartitions) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  // The default schemas of the sources do not partition the events.
+  EXPECT_TRUE(absl::IsUnimplemented(
+      metadata_access_object_->MaintainEventPartitions(
+          EventPartitionOptions(), absl::ToUnixMillis(absl::Now()),
+          /*enable_migration=*/true)));
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateArtifact) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -2667,6 +4066,152 @@ TEST_P(MetadataAccessObjectTest, UpdateArtifact) {
             got_artifact_after_update.last_update_time_since_epoch());
 }
 
+TEST_P(MetadataAccessObjectTest, UpdateArtifacts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'p1' value: INT }
+    properties { key: 'p2' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    properties {
+      key: 'p1'
+      value: { int_value: 1 }
+    }
+    custom_properties {
+      key: 'p1'
+      value: { string_value: 'custom' }
+    }
+    custom_properties {
+      key: 'c1'
+      value: { string_value: '1' }
+    }
+  )");
+  artifact.set_type_id(type_id);
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifacts(
+                {artifact, artifact, artifact}, &artifact_ids));
+  std::vector<Artifact> stored_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &stored_artifacts));
+  ASSERT_THAT(stored_artifacts, SizeIs(3));
+
+  // The first artifact changes a property which shares its name with a custom
+  // property, and the type of a custom property. The second one is unchanged.
+  // The third one changes its uri, adds a property and drops the others.
+  std::vector<Artifact> updated_artifacts = stored_artifacts;
+  (*updated_artifacts[0].mutable_properties())["p1"].set_int_value(2);
+  (*updated_artifacts[0].mutable_custom_properties())["c1"].set_int_value(1);
+  updated_artifacts[2].set_uri("testuri://changed/uri");
+  updated_artifacts[2].clear_properties();
+  updated_artifacts[2].clear_custom_properties();
+  (*updated_artifacts[2].mutable_properties())["p2"].set_string_value("2");
+  // sleep to verify the latest update time is updated.
+  absl::SleepFor(absl::Milliseconds(1));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->UpdateArtifacts(updated_artifacts));
+
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &got_artifacts));
+  EXPECT_THAT(got_artifacts,
+              UnorderedPointwise(EqualsProto<Artifact>(/*ignore_fields=*/{
+                                     "last_update_time_since_epoch"}),
+                                 updated_artifacts));
+  absl::node_hash_map<int64, int64> stored_update_time_by_id;
+  for (const Artifact& stored_artifact : stored_artifacts) {
+    stored_update_time_by_id[stored_artifact.id()] =
+        stored_artifact.last_update_time_since_epoch();
+  }
+  for (const Artifact& got_artifact : got_artifacts) {
+    const int64 stored_update_time =
+        stored_update_time_by_id[got_artifact.id()];
+    if (got_artifact.id() == stored_artifacts[1].id()) {
+      EXPECT_EQ(got_artifact.last_update_time_since_epoch(),
+                stored_update_time);
+    } else {
+      EXPECT_GT(got_artifact.last_update_time_since_epoch(),
+                stored_update_time);
+    }
+  }
+
+  // the batch is validated before any artifact is updated
+  Artifact unknown_artifact = updated_artifacts[1];
+  unknown_artifact.set_id(artifact_ids.back() + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->UpdateArtifacts(
+      {updated_artifacts[2], unknown_artifact})));
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->UpdateArtifacts(
+      {updated_artifacts[1], updated_artifacts[1]})));
+}
+
+TEST_P(MetadataAccessObjectTest, UpdateArtifactsIfUnchanged) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'p1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_uri("testuri://testing/uri");
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  {artifact, artifact}, &artifact_ids));
+  std::vector<Artifact> stored_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &stored_artifacts));
+  ASSERT_THAT(stored_artifacts, SizeIs(2));
+
+  // The first artifact changes a property, and the second one is unchanged.
+  // Both of them are updated after their last update time.
+  std::vector<Artifact> updated_artifacts = stored_artifacts;
+  (*updated_artifacts[0].mutable_properties())["p1"].set_int_value(1);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->UpdateArtifactsIfUnchanged(
+                updated_artifacts));
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &got_artifacts));
+  EXPECT_THAT(got_artifacts,
+              UnorderedPointwise(EqualsProto<Artifact>(/*ignore_fields=*/{
+                                     "last_update_time_since_epoch"}),
+                                 updated_artifacts));
+  absl::node_hash_map<int64, int64> stored_update_time_by_id;
+  for (const Artifact& stored_artifact : stored_artifacts) {
+    stored_update_time_by_id[stored_artifact.id()] =
+        stored_artifact.last_update_time_since_epoch();
+  }
+  for (const Artifact& got_artifact : got_artifacts) {
+    EXPECT_GT(got_artifact.last_update_time_since_epoch(),
+              stored_update_time_by_id[got_artifact.id()]);
+  }
+
+  // A batch with a stale artifact fails, and none of the batch is written.
+  Artifact current_artifact;
+  for (const Artifact& got_artifact : got_artifacts) {
+    if (got_artifact.id() == updated_artifacts[1].id()) {
+      current_artifact = got_artifact;
+    }
+  }
+  current_artifact.set_uri("testuri://changed/uri");
+  (*updated_artifacts[0].mutable_properties())["p1"].set_int_value(2);
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      metadata_access_object_->UpdateArtifactsIfUnchanged(
+          {current_artifact, updated_artifacts[0]})));
+  std::vector<Artifact> artifacts_after_conflict;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &artifacts_after_conflict));
+  EXPECT_THAT(artifacts_after_conflict,
+              UnorderedPointwise(EqualsProto<Artifact>(), got_artifacts));
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateNodeLastUpdateTimeSinceEpoch) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -3378,6 +4923,45 @@ TEST_P(MetadataAccessObjectTest, CreateContextWithDuplicatedNameError) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateContextIfNotExist) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const ContextType type = CreateTypeFromTextProto<ContextType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )", *metadata_access_object_);
+  Context context = ParseTextProtoOrDie<Context>(R"(
+    name: 'test context name'
+    properties { key: 'property_1' value: { int_value: 1 } }
+  )");
+  context.set_type_id(type.id());
+  int64 context_id;
+  bool created;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContextIfNotExist(
+                                  context, &context_id, &created));
+  EXPECT_TRUE(created);
+
+  // The existing context is returned as is.
+  Context other_context = context;
+  (*other_context.mutable_properties())["property_1"].set_int_value(2);
+  int64 existing_context_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContextIfNotExist(
+                                  other_context, &existing_context_id,
+                                  &created));
+  EXPECT_FALSE(created);
+  EXPECT_EQ(existing_context_id, context_id);
+  std::vector<Context> got_contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsById(
+                                  {context_id}, &got_contexts));
+  ASSERT_THAT(got_contexts, SizeIs(1));
+  EXPECT_EQ(got_contexts[0].properties().at("property_1").int_value(), 1);
+
+  Context unnamed_context;
+  unnamed_context.set_type_id(type.id());
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateContextIfNotExist(
+          unnamed_context, &context_id, &created)));
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateContext) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ContextType type = ParseTextProtoOrDie<ContextType>(R"(
@@ -3727,6 +5311,68 @@ TEST_P(MetadataAccessObjectTest, CreateAssociationError2) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateAssociationsAndAttributions) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const int64 artifact_type_id = InsertType<ArtifactType>("artifact_type");
+  const int64 execution_type_id = InsertType<ExecutionType>("execution_type");
+  const int64 context_type_id = InsertType<ContextType>("context_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  Context context = ParseTextProtoOrDie<Context>("name: 'context_instance'");
+  context.set_type_id(context_type_id);
+  int64 artifact_id_1, artifact_id_2, execution_id, context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id_1));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id_2));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+
+  std::vector<Association> associations(2);
+  for (Association& association : associations) {
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+  }
+  std::vector<Attribution> attributions(3);
+  for (Attribution& attribution : attributions) {
+    attribution.set_context_id(context_id);
+    attribution.set_artifact_id(artifact_id_1);
+  }
+  attributions[2].set_artifact_id(artifact_id_2);
+
+  // The duplicated links in a batch and the existing links are skipped.
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateAssociations(associations));
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateAttributions(attributions));
+  }
+
+  std::vector<Execution> got_executions;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindExecutionsByContext(
+                                  context_id, &got_executions));
+  EXPECT_THAT(got_executions, SizeIs(1));
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByContext(
+                                  context_id, &got_artifacts));
+  EXPECT_THAT(got_artifacts, SizeIs(2));
+
+  // The whole batch is rejected if a node cannot be found.
+  attributions[1].set_context_id(context_id + 100);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateAttributions(attributions)));
+  associations[1].set_execution_id(execution_id + 100);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateAssociations(associations)));
+  associations[1].clear_execution_id();
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateAssociations(associations)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateAndUseAttribution) {
   ASSERT_EQ(absl::OkStatus(), Init());
   int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
@@ -3777,6 +5423,185 @@ TEST_P(MetadataAccessObjectTest, CreateAndUseAttribution) {
   EXPECT_EQ(got_executions.size(), 0);
 }
 
+TEST_P(MetadataAccessObjectTest, FindAttributedNodesWithProperties) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 context_type_id = InsertType<ContextType>("test_context_type");
+  std::vector<Context> contexts(2);
+  for (int i = 0; i < contexts.size(); i++) {
+    contexts[i].set_type_id(context_type_id);
+    contexts[i].set_name(absl::StrCat("context_", i));
+    (*contexts[i].mutable_custom_properties())["index"].set_int_value(i);
+    int64 context_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(contexts[i], &context_id));
+    contexts[i].set_id(context_id);
+  }
+  // The artifacts are attributed to the first context, and the last one is
+  // also attributed to the second context.
+  std::vector<Artifact> artifacts(5);
+  for (int i = 0; i < artifacts.size(); i++) {
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_uri(absl::StrCat("uri_", i));
+    (*artifacts[i].mutable_custom_properties())["index"].set_int_value(i);
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifact(
+                                    artifacts[i], &artifact_id));
+    artifacts[i].set_id(artifact_id);
+    Attribution attribution;
+    attribution.set_artifact_id(artifact_id);
+    attribution.set_context_id(contexts[0].id());
+    int64 attribution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAttribution(
+                                    attribution, &attribution_id));
+  }
+  Attribution attribution;
+  attribution.set_artifact_id(artifacts.back().id());
+  attribution.set_context_id(contexts[1].id());
+  int64 attribution_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAttribution(
+                                  attribution, &attribution_id));
+
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByContext(
+                                  contexts[0].id(), &got_artifacts));
+  EXPECT_THAT(got_artifacts,
+              UnorderedElementsAre(
+                  EqualsProto(artifacts[0], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(artifacts[1], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(artifacts[2], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(artifacts[3], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(artifacts[4], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"})));
+
+  std::vector<Context> got_contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsByArtifact(
+                                  artifacts.back().id(), &got_contexts));
+  EXPECT_THAT(got_contexts,
+              UnorderedElementsAre(
+                  EqualsProto(contexts[0], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(contexts[1], /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"})));
+
+  got_contexts.clear();
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsByArtifact(
+                                  artifacts.front().id(), &got_contexts));
+  ASSERT_EQ(got_contexts.size(), 1);
+  EXPECT_EQ(got_contexts[0].id(), contexts[0].id());
+  got_contexts.clear();
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindContextsByArtifact(
+      artifacts.front().id() + 100, &got_contexts)));
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesByContexts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  int64 context_type_id = InsertType<ContextType>("test_context_type");
+  std::vector<int64> context_ids(3);
+  for (int i = 0; i < context_ids.size(); i++) {
+    Context context;
+    context.set_type_id(context_type_id);
+    context.set_name(absl::StrCat("context_", i));
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(context, &context_ids[i]));
+  }
+  std::vector<Artifact> artifacts(2);
+  std::vector<Execution> executions(2);
+  for (int i = 0; i < 2; i++) {
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_uri(absl::StrCat("uri_", i));
+    int64 artifact_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifact(
+                                    artifacts[i], &artifact_id));
+    artifacts[i].set_id(artifact_id);
+    executions[i].set_type_id(execution_type_id);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    executions[i], &execution_id));
+    executions[i].set_id(execution_id);
+  }
+  // The first context has both nodes of each kind, the second context has the
+  // second ones, and the last context has none.
+  const auto link = [&](int context_index, int node_index) {
+    Attribution attribution;
+    attribution.set_context_id(context_ids[context_index]);
+    attribution.set_artifact_id(artifacts[node_index].id());
+    int64 id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateAttribution(attribution, &id));
+    Association association;
+    association.set_context_id(context_ids[context_index]);
+    association.set_execution_id(executions[node_index].id());
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateAssociation(association, &id));
+  };
+  link(0, 0);
+  link(0, 1);
+  link(1, 1);
+
+  const auto node_ids = [](const auto& nodes) {
+    std::vector<int64> ids;
+    for (const auto& node : nodes) ids.push_back(node.id());
+    return ids;
+  };
+  absl::flat_hash_map<int64, std::vector<Artifact>> artifacts_by_context;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByContexts(
+                                  context_ids, &artifacts_by_context));
+  EXPECT_THAT(artifacts_by_context, SizeIs(2));
+  EXPECT_THAT(node_ids(artifacts_by_context[context_ids[0]]),
+              UnorderedElementsAre(artifacts[0].id(), artifacts[1].id()));
+  EXPECT_THAT(node_ids(artifacts_by_context[context_ids[1]]),
+              ElementsAre(artifacts[1].id()));
+  EXPECT_THAT(artifacts_by_context[context_ids[1]],
+              ElementsAre(EqualsProto(artifacts[1], /*ignore_fields=*/{
+                                          "create_time_since_epoch",
+                                          "last_update_time_since_epoch"})));
+
+  absl::flat_hash_map<int64, std::vector<Execution>> executions_by_context;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindExecutionsByContexts(
+                                  {context_ids[1], context_ids[2]},
+                                  &executions_by_context));
+  EXPECT_THAT(executions_by_context, SizeIs(1));
+  EXPECT_THAT(node_ids(executions_by_context[context_ids[1]]),
+              ElementsAre(executions[1].id()));
+
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsByContexts(
+                                  {}, &artifacts_by_context));
+  EXPECT_THAT(artifacts_by_context, IsEmpty());
+
+  // The contexts are found by node the other way around.
+  absl::flat_hash_map<int64, std::vector<Context>> contexts_by_artifact;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindContextsByArtifacts(
+                {artifacts[0].id(), artifacts[1].id()}, &contexts_by_artifact));
+  EXPECT_THAT(contexts_by_artifact, SizeIs(2));
+  EXPECT_THAT(node_ids(contexts_by_artifact[artifacts[0].id()]),
+              ElementsAre(context_ids[0]));
+  EXPECT_THAT(node_ids(contexts_by_artifact[artifacts[1].id()]),
+              UnorderedElementsAre(context_ids[0], context_ids[1]));
+
+  absl::flat_hash_map<int64, std::vector<Context>> contexts_by_execution;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindContextsByExecutions(
+                {executions[1].id()}, &contexts_by_execution));
+  EXPECT_THAT(contexts_by_execution, SizeIs(1));
+  EXPECT_THAT(node_ids(contexts_by_execution[executions[1].id()]),
+              UnorderedElementsAre(context_ids[0], context_ids[1]));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateAndFindEvent) {
   ASSERT_EQ(absl::OkStatus(), Init());
   int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
@@ -3840,6 +5665,104 @@ TEST_P(MetadataAccessObjectTest, CreateAndFindEvent) {
   EXPECT_EQ(events_with_execution.size(), 2);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateAndFindEvents) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+  std::vector<Artifact> artifacts(3);
+  for (Artifact& artifact : artifacts) {
+    artifact.set_type_id(artifact_type_id);
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  artifacts, &artifact_ids));
+
+  // events with index steps, key steps, both or none
+  std::vector<Event> want_events(artifact_ids.size());
+  for (int i = 0; i < want_events.size(); i++) {
+    Event& event = want_events[i];
+    event.set_artifact_id(artifact_ids[i]);
+    event.set_execution_id(execution_id);
+    event.set_type(Event::OUTPUT);
+    event.set_milliseconds_since_epoch(12345 + i);
+  }
+  want_events[0].mutable_path()->add_steps()->set_index(1);
+  want_events[0].mutable_path()->add_steps()->set_key("key");
+  want_events[1].mutable_path()->add_steps()->set_key("key");
+  std::vector<int64> event_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateEvents(want_events, &event_ids));
+  EXPECT_THAT(event_ids, SizeIs(want_events.size()));
+
+  std::vector<Event> got_events;
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByExecutions(
+                                  {execution_id}, &got_events));
+  EXPECT_THAT(got_events, UnorderedElementsAre(EqualsProto(want_events[0]),
+                                               EqualsProto(want_events[1]),
+                                               EqualsProto(want_events[2])));
+
+  // the batch is validated before any event is created
+  Event unknown_execution_event = want_events[2];
+  unknown_execution_event.set_execution_id(execution_id + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateEvents(
+      {want_events[2], unknown_execution_event}, &event_ids)));
+  Event unknown_artifact_event = want_events[2];
+  unknown_artifact_event.set_artifact_id(artifact_ids.back() + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateEvents(
+      {unknown_artifact_event}, &event_ids)));
+  std::vector<Event> got_events_after_errors;
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByExecutions(
+                                  {execution_id}, &got_events_after_errors));
+  EXPECT_THAT(got_events_after_errors, SizeIs(3));
+}
+
+TEST_P(MetadataAccessObjectTest, FindEventsByLongIdLists) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  const int num_nodes = 2 * kMaxIdsPerQuery + 1;
+  std::vector<Artifact> artifacts(num_nodes);
+  for (Artifact& artifact : artifacts) {
+    artifact.set_type_id(artifact_type_id);
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  artifacts, &artifact_ids));
+  std::vector<Execution> executions(num_nodes);
+  for (Execution& execution : executions) {
+    execution.set_type_id(execution_type_id);
+  }
+  std::vector<int64> execution_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecutions(
+                                  executions, &execution_ids));
+  std::vector<Event> want_events(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    want_events[i].set_artifact_id(artifact_ids[i]);
+    want_events[i].set_execution_id(execution_ids[i]);
+    want_events[i].set_type(Event::OUTPUT);
+    want_events[i].set_milliseconds_since_epoch(12345 + i);
+  }
+  std::vector<int64> event_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateEvents(want_events, &event_ids));
+
+  std::vector<Event> got_events;
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByArtifacts(
+                                  artifact_ids, &got_events));
+  EXPECT_THAT(got_events,
+              UnorderedPointwise(EqualsProto<Event>(), want_events));
+  got_events.clear();
+  EXPECT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByExecutions(
+                                  execution_ids, &got_events));
+  EXPECT_THAT(got_events,
+              UnorderedPointwise(EqualsProto<Event>(), want_events));
+}
+
 TEST_P(MetadataAccessObjectTest, FindEventsByArtifactsNotFound) {
   ASSERT_EQ(absl::OkStatus(), Init());
   std::vector<Event> events;
@@ -4014,6 +5937,47 @@ TEST_P(MetadataAccessObjectTest, CreateParentContext) {
   EXPECT_TRUE(absl::IsAlreadyExists(status));
 }
 
+TEST_P(MetadataAccessObjectTest, CreateParentContexts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ContextType context_type;
+  context_type.set_name("context_type_name");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(context_type, &type_id));
+  std::vector<int64> context_ids(3);
+  for (int i = 0; i < 3; i++) {
+    Context context;
+    context.set_name(absl::StrCat("context_", i));
+    context.set_type_id(type_id);
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContext(
+                                    context, &context_ids[i]));
+  }
+
+  std::vector<ParentContext> parent_contexts(2);
+  parent_contexts[0].set_parent_id(context_ids[0]);
+  parent_contexts[0].set_child_id(context_ids[2]);
+  parent_contexts[1].set_parent_id(context_ids[1]);
+  parent_contexts[1].set_child_id(context_ids[2]);
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateParentContexts(parent_contexts));
+  std::vector<Context> got_parents;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindParentContextsByContextId(
+                context_ids[2], &got_parents));
+  EXPECT_THAT(got_parents, SizeIs(2));
+
+  // A missing context is rejected before any insert.
+  std::vector<ParentContext> missing_contexts(1);
+  missing_contexts[0].set_parent_id(context_ids[2]);
+  missing_contexts[0].set_child_id(context_ids[2] + 100);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateParentContexts(missing_contexts)));
+
+  // Recreating the parent contexts returns AlreadyExists.
+  EXPECT_TRUE(absl::IsAlreadyExists(
+      metadata_access_object_->CreateParentContexts(parent_contexts)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateParentContextInvalidArgumentError) {
   // Prepare a stored context.
   ASSERT_EQ(absl::OkStatus(), Init());
@@ -4126,6 +6090,83 @@ TEST_P(MetadataAccessObjectTest, CreateAndFindParentContext) {
   }
 }
 
+TEST_P(MetadataAccessObjectTest, FindAncestorAndDescendantContexts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ContextType context_type;
+  context_type.set_name("context_type_name");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(context_type, &type_id));
+  std::vector<int64> ids(4);
+  for (int i = 0; i < ids.size(); i++) {
+    Context context;
+    context.set_name(absl::StrCat("context", i));
+    context.set_type_id(type_id);
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(context, &ids[i]));
+  }
+  // context0 -> context1 -> context2 -> context3, and context0 -> context2.
+  std::vector<std::pair<int64, int64>> links = {
+      {ids[1], ids[0]}, {ids[2], ids[1]}, {ids[3], ids[2]}, {ids[2], ids[0]}};
+  for (const auto& link : links) {
+    ParentContext parent_context;
+    parent_context.set_child_id(link.first);
+    parent_context.set_parent_id(link.second);
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateParentContext(parent_context));
+  }
+
+  std::vector<Context> got_contexts;
+  std::vector<ParentContext> got_parent_contexts;
+  const auto got_ids = [&]() {
+    std::vector<int64> result;
+    for (const Context& context : got_contexts) result.push_back(context.id());
+    return result;
+  };
+  const auto got_links = [&]() {
+    std::vector<std::pair<int64, int64>> result;
+    for (const ParentContext& parent_context : got_parent_contexts) {
+      result.push_back({parent_context.child_id(), parent_context.parent_id()});
+    }
+    return result;
+  };
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindAncestorContextsByContextId(
+                ids[3], /*max_depth=*/1, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_ids(), ElementsAre(ids[2]));
+  EXPECT_THAT(got_links(), ElementsAre(links[2]));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindAncestorContextsByContextId(
+                ids[3], /*max_depth=*/2, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_ids(), UnorderedElementsAre(ids[0], ids[1], ids[2]));
+  EXPECT_THAT(got_links(), UnorderedElementsAre(links[1], links[2], links[3]));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindAncestorContextsByContextId(
+                ids[3], /*max_depth=*/10, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_ids(), UnorderedElementsAre(ids[0], ids[1], ids[2]));
+  EXPECT_THAT(got_links(), UnorderedElementsAreArray(links));
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindDescendantContextsByContextId(
+                ids[0], /*max_depth=*/1, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_ids(), UnorderedElementsAre(ids[1], ids[2]));
+  EXPECT_THAT(got_links(), UnorderedElementsAre(links[0], links[3]));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindDescendantContextsByContextId(
+                ids[0], /*max_depth=*/10, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_ids(), UnorderedElementsAre(ids[1], ids[2], ids[3]));
+  EXPECT_THAT(got_links(), UnorderedElementsAreArray(links));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindDescendantContextsByContextId(
+                ids[3], /*max_depth=*/10, &got_contexts, &got_parent_contexts));
+  EXPECT_THAT(got_contexts, IsEmpty());
+  EXPECT_THAT(got_parent_contexts, IsEmpty());
+
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->FindAncestorContextsByContextId(
+          ids[3], /*max_depth=*/0, &got_contexts, &got_parent_contexts)));
+}
+
 TEST_P(MetadataAccessObjectTest, MigrateToCurrentLibVersion) {
   // Skip upgrade/downgrade migration tests for earlier schema version.
   if (EarlierSchemaEnabled()) { return; }
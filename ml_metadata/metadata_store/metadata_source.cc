@@ -14,10 +14,42 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_source.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
+namespace {
+
+// Returns a SQL literal of the given prepared statement `value`. The doubles
+// are written with 17 significant digits, so that they read back exactly.
+std::string ToSqlLiteral(const MetadataSource& source,
+                         const PreparedStatementValue& value) {
+  if (absl::holds_alternative<int64>(value)) {
+    return std::to_string(absl::get<int64>(value));
+  } else if (absl::holds_alternative<double>(value)) {
+    return absl::StrFormat("%.17g", absl::get<double>(value));
+  } else if (absl::holds_alternative<std::string>(value)) {
+    return absl::StrCat("'", source.EscapeString(absl::get<std::string>(value)),
+                        "'");
+  } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+    return source.BytesLiteral(absl::get<PreparedStatementBytes>(value).bytes);
+  }
+  return "NULL";
+}
+
+}  // namespace
+
+std::string MetadataSource::BytesLiteral(absl::string_view value) const {
+  return absl::StrCat("X'", absl::BytesToHexString(value), "'");
+}
 
 absl::Status MetadataSource::Connect() {
   if (is_connected_)
@@ -26,6 +58,7 @@ absl::Status MetadataSource::Connect() {
         "Connect() again.");
   MLMD_RETURN_IF_ERROR(ConnectImpl());
   is_connected_ = true;
+  num_connections_++;
   return absl::OkStatus();
 }
 
@@ -47,13 +80,202 @@ absl::Status MetadataSource::ExecuteQuery(const std::string& query,
   return ExecuteQueryImpl(query, results);
 }
 
+absl::Status MetadataSource::ExecutePreparedQuery(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    TypedRecordSet* results) {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  return ExecutePreparedQueryImpl(query, values, results);
+}
+
+absl::Status MetadataSource::ExecutePreparedQuery(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    RecordSet* results) {
+  if (results == nullptr) {
+    return ExecutePreparedQuery(query, values,
+                                static_cast<TypedRecordSet*>(nullptr));
+  }
+  TypedRecordSet typed_results;
+  MLMD_RETURN_IF_ERROR(ExecutePreparedQuery(query, values, &typed_results));
+  typed_results.ToRecordSet(results);
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::InlinePreparedValues(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    std::string* inlined_query) const {
+  inlined_query->clear();
+  inlined_query->reserve(query.size());
+  int next_value = 0;
+  // The quote character of the literal or identifier being copied, if any.
+  char open_quote = 0;
+  for (const char c : query) {
+    if (open_quote != 0) {
+      if (c == open_quote) open_quote = 0;
+      inlined_query->push_back(c);
+    } else if (c == '\'' || c == '"' || c == '`') {
+      open_quote = c;
+      inlined_query->push_back(c);
+    } else if (c == '?') {
+      if (next_value >= values.size()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Prepared query has more placeholders than the ", values.size(),
+            " given values: ", query));
+      }
+      absl::StrAppend(inlined_query, ToSqlLiteral(*this, values[next_value++]));
+    } else {
+      inlined_query->push_back(c);
+    }
+  }
+  if (next_value != values.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Prepared query has ", next_value, " placeholders, but ",
+        values.size(), " values are given: ", query));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    TypedRecordSet* results) {
+  std::string inlined_query;
+  MLMD_RETURN_IF_ERROR(InlinePreparedValues(query, values, &inlined_query));
+  if (results == nullptr) return ExecuteQueryImpl(inlined_query, nullptr);
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQueryImpl(inlined_query, &record_set));
+  *results = TypedRecordSet::FromRecordSet(record_set);
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteStreamingQuery(
+    const std::string& query, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  if (max_batch_size <= 0)
+    return absl::InvalidArgumentError("max_batch_size must be positive.");
+  return ExecuteStreamingQueryImpl(query, max_batch_size, callback);
+}
+
+absl::Status MetadataSource::ExecuteStreamingQueryImpl(
+    const std::string& query, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQueryImpl(query, &record_set));
+  const std::vector<std::string> column_names(
+      record_set.column_names().begin(), record_set.column_names().end());
+  TypedRecordSet batch(column_names);
+  for (const RecordSet::Record& record : record_set.records()) {
+    for (const std::string& value : record.values()) {
+      if (value == kMetadataSourceNull) {
+        batch.AppendNull();
+      } else {
+        batch.AppendString(value);
+      }
+    }
+    if (batch.num_rows() == max_batch_size) {
+      MLMD_RETURN_IF_ERROR(callback(batch));
+      batch.Reset(column_names);
+    }
+  }
+  if (batch.num_rows() > 0) {
+    MLMD_RETURN_IF_ERROR(callback(batch));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecutePipelinedQueries(
+    const absl::Span<const PipelinedQuery> queries,
+    std::vector<TypedRecordSet>* results) {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  return ExecutePipelinedQueriesImpl(queries, results);
+}
+
+absl::Status MetadataSource::ExecutePipelinedQueriesImpl(
+    const absl::Span<const PipelinedQuery> queries,
+    std::vector<TypedRecordSet>* results) {
+  results->clear();
+  results->resize(queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    MLMD_RETURN_IF_ERROR(ExecutePreparedQueryImpl(
+        queries[i].query, queries[i].values, &(*results)[i]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteBulkInsert(
+    const std::string& table, const absl::Span<const std::string> columns,
+    const absl::Span<const PreparedStatementValue> values) {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  if (columns.empty() || values.size() % columns.size() != 0)
+    return absl::InvalidArgumentError(
+        absl::StrCat("Bulk insert into ", table, " has ", values.size(),
+                     " values, which are not rows of ", columns.size(),
+                     " columns."));
+  return ExecuteBulkInsertImpl(table, columns, values);
+}
+
+absl::Status MetadataSource::ExecuteBulkInsertImpl(
+    const std::string& table, const absl::Span<const std::string> columns,
+    const absl::Span<const PreparedStatementValue> values) {
+  return absl::UnimplementedError(
+      absl::StrCat("The metadata source has no bulk insert into ", table));
+}
+
+int64 MetadataSource::AddBeginCallback(std::function<void()> callback) {
+  const int64 handle = next_begin_callback_handle_++;
+  begin_callbacks_.emplace_back(handle, std::move(callback));
+  return handle;
+}
+
+void MetadataSource::RemoveBeginCallback(const int64 handle) {
+  begin_callbacks_.erase(
+      std::remove_if(begin_callbacks_.begin(), begin_callbacks_.end(),
+                     [handle](const std::pair<int64, std::function<void()>>&
+                                  begin_callback) {
+                       return begin_callback.first == handle;
+                     }),
+      begin_callbacks_.end());
+}
+
 absl::Status MetadataSource::Begin() {
+  return Begin(TransactionMode::kReadWrite);
+}
+
+absl::Status MetadataSource::Begin(const TransactionMode mode) {
   if (!is_connected_)
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (transaction_open_)
     return absl::FailedPreconditionError("Transaction already open.");
-  MLMD_RETURN_IF_ERROR(BeginImpl());
+  for (const auto& begin_callback : begin_callbacks_) {
+    begin_callback.second();
+  }
+  switch (mode) {
+    case TransactionMode::kReadWrite:
+      MLMD_RETURN_IF_ERROR(BeginImpl());
+      break;
+    case TransactionMode::kReadOnly:
+      MLMD_RETURN_IF_ERROR(BeginReadOnlyImpl());
+      break;
+    case TransactionMode::kSnapshotRead:
+      MLMD_RETURN_IF_ERROR(BeginSnapshotReadImpl());
+      break;
+    case TransactionMode::kAutocommit:
+      break;
+  }
   transaction_open_ = true;
+  transaction_mode_ = mode;
+  num_transactions_++;
   return absl::OkStatus();
 }
 
@@ -62,7 +284,9 @@ absl::Status MetadataSource::Commit() {
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  MLMD_RETURN_IF_ERROR(CommitImpl());
+  if (transaction_mode_ != TransactionMode::kAutocommit) {
+    MLMD_RETURN_IF_ERROR(CommitImpl());
+  }
   transaction_open_ = false;
   return absl::OkStatus();
 }
@@ -72,7 +296,9 @@ absl::Status MetadataSource::Rollback() {
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  MLMD_RETURN_IF_ERROR(RollbackImpl());
+  if (transaction_mode_ != TransactionMode::kAutocommit) {
+    MLMD_RETURN_IF_ERROR(RollbackImpl());
+  }
   transaction_open_ = false;
   return absl::OkStatus();
 }
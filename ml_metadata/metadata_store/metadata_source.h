@@ -18,13 +18,62 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
 namespace ml_metadata {
 
+// The bytes of a binary value of a prepared statement, e.g., a serialized
+// proto, which are bound as a BLOB instead of a text.
+struct PreparedStatementBytes {
+  std::string bytes;
+};
+
+// A typed value bound to a `?` placeholder of a prepared statement. A
+// absl::monostate value is bound as NULL.
+using PreparedStatementValue =
+    absl::variant<absl::monostate, int64, double, std::string,
+                  PreparedStatementBytes>;
+
+// A query with `?` placeholders and the values bound to them in order, which
+// is run in a batch of pipelined queries.
+struct PipelinedQuery {
+  std::string query;
+  std::vector<PreparedStatementValue> values;
+};
+
+// Receives a batch of consecutive rows of a streamed query. Returning an error
+// stops the query, and the error is returned to the caller of the query.
+using RecordBatchCallback =
+    std::function<absl::Status(const TypedRecordSet& batch)>;
+
+// The kinds of transactions opened by MetadataSource::Begin.
+enum class TransactionMode {
+  // A transaction which reads and writes.
+  kReadWrite,
+  // A transaction which only reads, so that the backend can skip the
+  // bookkeeping of writes, e.g., InnoDB does not allocate a transaction id.
+  // Writes fail in backends enforcing it.
+  kReadOnly,
+  // A read-only transaction whose queries all see the snapshot of the
+  // database taken when it begins, e.g., a REPEATABLE READ transaction with a
+  // consistent snapshot, so that it can span several calls.
+  kSnapshotRead,
+  // No transaction is opened in the backend and each query commits on its
+  // own, which saves the Begin and Commit round trips. The queries may see
+  // different snapshots and are not undone by Rollback, so it only fits
+  // reads which tolerate concurrent writes between their queries.
+  kAutocommit,
+};
+
 // The base class for all metadata data sources. It provides an interface used
 // by MetadataAccessObject. Each concrete MetadataSource provides a physical
 // backend to persist and query metadata. An implementation of MetadataSource
@@ -83,11 +132,83 @@ class MetadataSource {
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(const std::string& query, RecordSet* results);
 
-  // Begins (opens) a transaction.
+  // Runs a query with `?` placeholders as a prepared statement, and binds the
+  // `values` to the placeholders in order. Backends supporting server-side
+  // prepared statements parse the query once per connection and cache the
+  // statement keyed by the query text, so callers should reuse the same query
+  // text for the same statement.
+  //
+  // Results are consist of zero or more rows represented in TypedRecordSet,
+  // whose cells keep the types returned by the backend.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INVALID_ARGUMENT error, if the number of placeholders and values
+  //   do not match.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ExecutePreparedQuery(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values,
+      TypedRecordSet* results);
+
+  // Same as above, but the results are converted to the RecordSet encoding.
+  absl::Status ExecutePreparedQuery(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values, RecordSet* results);
+
+  // Runs a query and passes its rows to `callback` in batches of at most
+  // `max_batch_size` rows as they are read from the backend, so that the
+  // whole result is never buffered in memory. The batch is only valid during
+  // the callback. The callback must not run other queries on this metadata
+  // source.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INVALID_ARGUMENT error, if `max_batch_size` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns the error returned by `callback`, if any.
+  absl::Status ExecuteStreamingQuery(const std::string& query,
+                                     int max_batch_size,
+                                     const RecordBatchCallback& callback);
+
+  // Runs `queries`, whose values and results do not depend on each other, as
+  // prepared queries, and returns the results of `queries[i]` in
+  // `results[i]`. Backends supporting it send all the queries before reading
+  // their results, so that the batch costs a single round trip, e.g., with a
+  // multi-statement query in MySQL or the pipeline mode of libpq in
+  // PostgreSQL. Others run the queries one after the other. The batch stops at
+  // the first failed query, whose error is returned.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INVALID_ARGUMENT error, if the number of placeholders and values
+  //   of a query do not match.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ExecutePipelinedQueries(absl::Span<const PipelinedQuery> queries,
+                                       std::vector<TypedRecordSet>* results);
+
+  // Inserts the rows of `values` into the `columns` of `table`, with the bulk
+  // load path of the backend, e.g., COPY in PostgreSQL. The `values` are the
+  // cells of the rows in row-major order. The names are not quoted.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INVALID_ARGUMENT error, if `columns` is empty or the number of
+  //   values is not a multiple of it.
+  // Returns UNIMPLEMENTED error, if the backend has no bulk load path, in
+  //   which case the caller inserts the rows with INSERT statements.
+  // Returns detailed INTERNAL error, if the insertion fails.
+  absl::Status ExecuteBulkInsert(
+      const std::string& table, absl::Span<const std::string> columns,
+      absl::Span<const PreparedStatementValue> values);
+
+  // Begins (opens) a read-write transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns FAILED_PRECONDITION error, if a transaction has already begun.
   absl::Status Begin();
 
+  // Begins (opens) a transaction of the given `mode`. Commit and Rollback of a
+  // kAutocommit transaction only close it.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has already begun.
+  absl::Status Begin(TransactionMode mode);
+
   // Commits a transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
@@ -106,11 +227,66 @@ class MetadataSource {
   // escaping characters and method depends on the metadata source backend.
   virtual std::string EscapeString(absl::string_view value) const = 0;
 
+  // Returns a SQL literal of the binary `value`, which is used to bind BLOB
+  // parameters for query composition. The default is the X'<hex>' literal of
+  // SQLite and MySQL.
+  virtual std::string BytesLiteral(absl::string_view value) const;
+
+  // Sets the time after which the queries of the source are abandoned, e.g.,
+  // the deadline of the request using it. It is ignored by default, as most
+  // sources cannot interrupt a running query.
+  virtual void SetQueryDeadline(absl::Time deadline) {}
+
+  // Returns true if the open transaction runs on a read replica, whose data
+  // may lag behind the primary, e.g., so that its reads do not fill the caches
+  // shared with the transactions on the primary. It is false by default.
+  virtual bool reads_from_replica() const { return false; }
+
+  // Adds a callback which Begin() runs before the backend opens the
+  // transaction, e.g., to note the generations of the caches which must not be
+  // filled from a snapshot older than their latest invalidation. Several
+  // objects using the source may each add one. Returns the handle with which
+  // RemoveBeginCallback() removes it.
+  int64 AddBeginCallback(std::function<void()> callback);
+
+  // Removes the callback added with `handle`, e.g., before its owner is
+  // destroyed. The other callbacks are kept.
+  void RemoveBeginCallback(int64 handle);
+
   bool is_connected() const { return is_connected_; }
 
+  // Returns the number of times the source has connected to its backend,
+  // including the reconnections after the backend has closed the connection,
+  // e.g., when the server has restarted.
+  int64 num_connections() const { return num_connections_; }
+
+  // Returns the number of transactions begun on the source, which identifies
+  // the currently open transaction.
+  int64 num_transactions() const { return num_transactions_; }
+
+  // Notes that the open transaction has been rolled back to a savepoint, e.g.,
+  // by TransactionExecutor::ExecuteBatch, which undoes the writes since then.
+  void NoteRollbackToSavepoint() { num_savepoint_rollbacks_++; }
+
+  // Returns the number of times the transactions of the source have been
+  // rolled back to a savepoint. Along with num_transactions(), it tells
+  // whether what the open transaction wrote earlier may have been undone.
+  int64 num_savepoint_rollbacks() const { return num_savepoint_rollbacks_; }
+
  protected:
+  // Inlines the `values` into the `?` placeholders of `query` as SQL literals,
+  // and returns the resulting `inlined_query`.
+  // Returns INVALID_ARGUMENT error, if the number of placeholders and values
+  //   do not match.
+  absl::Status InlinePreparedValues(
+      const std::string& query, absl::Span<const PreparedStatementValue> values,
+      std::string* inlined_query) const;
+
   bool transaction_open() const { return transaction_open_; }
 
+  // Counts a reconnection made by the implementation, see num_connections().
+  void NoteReconnection() { num_connections_++; }
+
   void set_transaction_open(bool transaction_open) {
     transaction_open_ = transaction_open;
   }
@@ -126,9 +302,44 @@ class MetadataSource {
   virtual absl::Status ExecuteQueryImpl(const std::string& query,
                                         RecordSet* results) = 0;
 
+  // Implementation of executing prepared statements. By default, the values
+  // are escaped and inlined into the query, which is run by ExecuteQueryImpl,
+  // and the results are string cells.
+  virtual absl::Status ExecutePreparedQueryImpl(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values,
+      TypedRecordSet* results);
+
+  // Implementation of executing streamed queries. By default, the results are
+  // buffered by ExecuteQueryImpl, and then passed to the callback in batches.
+  virtual absl::Status ExecuteStreamingQueryImpl(
+      const std::string& query, int max_batch_size,
+      const RecordBatchCallback& callback);
+
+  // Implementation of executing pipelined queries. By default, the queries are
+  // run one after the other by ExecutePreparedQueryImpl.
+  virtual absl::Status ExecutePipelinedQueriesImpl(
+      absl::Span<const PipelinedQuery> queries,
+      std::vector<TypedRecordSet>* results);
+
+  // Implementation of a bulk insertion. By default, it returns UNIMPLEMENTED
+  // error.
+  virtual absl::Status ExecuteBulkInsertImpl(
+      const std::string& table, absl::Span<const std::string> columns,
+      absl::Span<const PreparedStatementValue> values);
+
   // Implementation of opening a transaction.
   virtual absl::Status BeginImpl() = 0;
 
+  // Implementation of opening a read-only transaction. By default, it opens a
+  // read-write transaction with BeginImpl.
+  virtual absl::Status BeginReadOnlyImpl() { return BeginImpl(); }
+
+  // Implementation of opening a kSnapshotRead transaction. By default, it
+  // opens a read-only transaction with BeginReadOnlyImpl, which fits the
+  // backends whose transactions read a single snapshot.
+  virtual absl::Status BeginSnapshotReadImpl() { return BeginReadOnlyImpl(); }
+
   // Implementation of a transaction commit.
   virtual absl::Status CommitImpl() = 0;
 
@@ -137,6 +348,13 @@ class MetadataSource {
 
   bool is_connected_ = false;
   bool transaction_open_ = false;
+  TransactionMode transaction_mode_ = TransactionMode::kReadWrite;
+  int64 num_transactions_ = 0;
+  int64 num_savepoint_rollbacks_ = 0;
+  int64 num_connections_ = 0;
+  // The callbacks run by Begin(), with their handles.
+  std::vector<std::pair<int64, std::function<void()>>> begin_callbacks_;
+  int64 next_begin_callback_handle_ = 0;
 };
 
 }  // namespace ml_metadata
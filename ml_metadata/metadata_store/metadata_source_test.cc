@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_source.h"
 
+#include <string>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
@@ -83,6 +86,113 @@ TEST(MetadataSourceTest, TestExecuteQueryWithoutBegin) {
   EXPECT_TRUE(absl::IsFailedPrecondition(s));
 }
 
+TEST(MetadataSourceTest, TestExecutePreparedQueryWithoutBegin) {
+  MockMetadataSource mock_metadata_source;
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl).Times(0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  absl::Status s =
+      mock_metadata_source.ExecutePreparedQuery("some query", {}, &result);
+  EXPECT_TRUE(absl::IsFailedPrecondition(s));
+}
+
+TEST(MetadataSourceTest, TestExecutePreparedQueryInlinesValues) {
+  MockMetadataSource mock_metadata_source;
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source, EscapeString(absl::string_view("it's")))
+      .WillOnce(::testing::Return("it''s"));
+  EXPECT_CALL(mock_metadata_source,
+              ExecuteQueryImpl("SELECT '?' FROM t WHERE a = 1 AND b = 'it''s' "
+                               "AND c IS NULL;",
+                               ::testing::_))
+      .Times(1);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_EQ(absl::OkStatus(),
+            mock_metadata_source.ExecutePreparedQuery(
+                "SELECT '?' FROM t WHERE a = ? AND b = ? AND c IS ?;",
+                {int64{1}, std::string("it's"), absl::monostate()}, &result));
+}
+
+TEST(MetadataSourceTest, TestExecutePreparedQueryInlinesDoublesExactly) {
+  MockMetadataSource mock_metadata_source;
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source,
+              ExecuteQueryImpl("SELECT a FROM t WHERE a = "
+                               "9.9999999999999995e-08"
+                               " OR a = 0.10000000000000001"
+                               " OR a = 123456789.5;",
+                               ::testing::_))
+      .Times(1);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_EQ(absl::OkStatus(),
+            mock_metadata_source.ExecutePreparedQuery(
+                "SELECT a FROM t WHERE a = ? OR a = ? OR a = ?;",
+                {1e-7, 0.1, 123456789.5}, &result));
+}
+
+TEST(MetadataSourceTest, TestExecutePreparedQueryWithWrongNumberOfValues) {
+  MockMetadataSource mock_metadata_source;
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl).Times(0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_TRUE(absl::IsInvalidArgument(mock_metadata_source.ExecutePreparedQuery(
+      "SELECT a FROM t WHERE a = ? AND b = ?;", {int64{1}}, &result)));
+  EXPECT_TRUE(absl::IsInvalidArgument(mock_metadata_source.ExecutePreparedQuery(
+      "SELECT a FROM t;", {int64{1}}, &result)));
+}
+
+TEST(MetadataSourceTest, TestExecuteStreamingQueryInBatches) {
+  MockMetadataSource mock_metadata_source;
+  RecordSet results;
+  results.add_column_names("c1");
+  for (const char* value : {"1", "2", "3"}) {
+    results.add_records()->add_values(value);
+  }
+  EXPECT_CALL(mock_metadata_source,
+              ExecuteQueryImpl("some query", ::testing::_))
+      .WillOnce(::testing::DoAll(::testing::SetArgPointee<1>(results),
+                                 ::testing::Return(absl::OkStatus())));
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  std::vector<int> batch_sizes;
+  EXPECT_EQ(absl::OkStatus(),
+            mock_metadata_source.ExecuteStreamingQuery(
+                "some query", /*max_batch_size=*/2,
+                [&batch_sizes](const TypedRecordSet& batch) {
+                  batch_sizes.push_back(batch.num_rows());
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(2, 1));
+}
+
+TEST(MetadataSourceTest, TestExecuteStreamingQueryWithInvalidBatchSize) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl).Times(0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  const absl::Status status = mock_metadata_source.ExecuteStreamingQuery(
+      "some query", /*max_batch_size=*/0,
+      [](const TypedRecordSet& batch) { return absl::OkStatus(); });
+  EXPECT_TRUE(absl::IsInvalidArgument(status));
+}
+
+TEST(MetadataSourceTest, TestExecuteBulkInsert) {
+  MockMetadataSource mock_metadata_source;
+  const std::vector<std::string> columns = {"a", "b"};
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_TRUE(absl::IsFailedPrecondition(mock_metadata_source.ExecuteBulkInsert(
+      "t", columns, {int64{1}, std::string("x")})));
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      mock_metadata_source.ExecuteBulkInsert("t", columns, {int64{1}})));
+  // The sources without a bulk load path leave the insertion to the caller.
+  EXPECT_TRUE(absl::IsUnimplemented(mock_metadata_source.ExecuteBulkInsert(
+      "t", columns, {int64{1}, std::string("x")})));
+}
+
 TEST(MetadataSourceTest, TestBeginAndCommit) {
   MockMetadataSource mock_metadata_source;
   {
@@ -176,4 +286,38 @@ TEST(MetadataSourceTest, TestBeginWithoutConnect) {
   EXPECT_TRUE(absl::IsFailedPrecondition(s));
 }
 
+TEST(MetadataSourceTest, BeginRunsTheCallbacksLeft) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl()).Times(1);
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(2);
+  EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(2);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  int num_first_calls = 0;
+  int num_second_calls = 0;
+  const int64 first_handle = mock_metadata_source.AddBeginCallback(
+      [&num_first_calls]() { num_first_calls++; });
+  mock_metadata_source.AddBeginCallback(
+      [&num_second_calls]() { num_second_calls++; });
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Commit());
+  // Removing a callback keeps the other one.
+  mock_metadata_source.RemoveBeginCallback(first_handle);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Commit());
+  EXPECT_EQ(num_first_calls, 1);
+  EXPECT_EQ(num_second_calls, 2);
+}
+
+TEST(MetadataSourceTest, CountConnections) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl()).Times(2);
+  EXPECT_CALL(mock_metadata_source, CloseImpl()).Times(1);
+  EXPECT_EQ(mock_metadata_source.num_connections(), 0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(mock_metadata_source.num_connections(), 1);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Close());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(mock_metadata_source.num_connections(), 2);
+}
+
 }  // namespace ml_metadata
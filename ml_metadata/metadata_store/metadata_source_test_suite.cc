@@ -15,17 +15,20 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
 
 #include <memory>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 
 namespace ml_metadata {
 namespace testing {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::Not;
@@ -215,6 +218,165 @@ TEST_P(MetadataSourceTestSuite, TestNull) {
   EXPECT_THAT(query_results, EqualsProto(expected_results));
 }
 
+// Test prepared query execution.
+// Initialization: creates an empty table t1 (c1 INT, c2 VARCHAR(255)) with test
+// schema.
+// Execution: Insert rows (1, 'v1') and (2, NULL) with the same prepared insert
+// query, then select them with a prepared select query.
+// Expectation: the retrieved rows are (1, 'v1') and (2, kMetadataSourceNull).
+TEST_P(MetadataSourceTestSuite, TestExecutePreparedQuery) {
+  metadata_source_container_->InitTestSchema();
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  const std::string insert_query = "INSERT INTO t1 VALUES (?, ?)";
+  RecordSet* const no_results = nullptr;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecutePreparedQuery(
+                insert_query, {int64{1}, std::string("v1")}, no_results));
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecutePreparedQuery(
+                insert_query, {int64{2}, absl::monostate()}, no_results));
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_source_->ExecutePreparedQuery(
+      insert_query, {int64{3}}, no_results)));
+  RecordSet expected_results = ParseTextProtoOrDie<RecordSet>(absl::Substitute(
+      R"(column_names: "c1"
+         column_names: "c2"
+         records: { values: "1" values: "v1" }
+         records: { values: "2" values: "$0" })",
+      kMetadataSourceNull));
+
+  RecordSet query_results;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecutePreparedQuery(
+                "SELECT c1, c2 FROM t1 WHERE c1 >= ? ORDER BY c1", {int64{1}},
+                &query_results));
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  EXPECT_THAT(query_results, EqualsProto(expected_results));
+}
+
+// Test: the typed results of a prepared query keep the types of the cells.
+// Execution: Insert rows (1, 'v1') and (2, NULL), then select them to a
+// TypedRecordSet.
+// Expectation: c1 are int64 cells, and c2 are a string cell and a NULL cell.
+TEST_P(MetadataSourceTestSuite, TestExecutePreparedQueryWithTypedResults) {
+  metadata_source_container_->InitTestSchema();
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "INSERT INTO t1 VALUES (1, 'v1'), (2, NULL)", nullptr));
+  TypedRecordSet query_results;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecutePreparedQuery(
+                "SELECT c1, c2 FROM t1 ORDER BY c1", {}, &query_results));
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  ASSERT_EQ(query_results.num_rows(), 2);
+  EXPECT_THAT(query_results.column_names(), ElementsAre("c1", "c2"));
+  EXPECT_EQ(query_results.cell_type(0, 0), TypedRecordSet::CellType::kInt64);
+  int64 c1;
+  EXPECT_TRUE(query_results.GetInt64(1, 0, &c1));
+  EXPECT_EQ(c1, 2);
+  EXPECT_EQ(query_results.GetString(0, 1), "v1");
+  EXPECT_TRUE(query_results.IsNull(1, 1));
+}
+
+// Test: a streaming query returns the rows in batches of at most
+// max_batch_size rows, and stops when the callback returns an error.
+// Execution: Insert three rows, then stream them in batches of two rows.
+// Expectation: the batches have two rows and one row, and an aborted query
+// returns the error of the callback.
+TEST_P(MetadataSourceTestSuite, TestExecuteStreamingQuery) {
+  metadata_source_container_->InitTestSchema();
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "INSERT INTO t1 VALUES (1, 'v1'), (2, 'v2'), (3, NULL)",
+                nullptr));
+  std::vector<int> batch_sizes;
+  std::vector<int64> ids;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteStreamingQuery(
+                "SELECT c1, c2 FROM t1 ORDER BY c1", /*max_batch_size=*/2,
+                [&](const TypedRecordSet& batch) {
+                  EXPECT_THAT(batch.column_names(), ElementsAre("c1", "c2"));
+                  batch_sizes.push_back(batch.num_rows());
+                  for (int row = 0; row < batch.num_rows(); row++) {
+                    int64 id;
+                    EXPECT_TRUE(batch.GetInt64(row, 0, &id));
+                    ids.push_back(id);
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(batch_sizes, ElementsAre(2, 1));
+  EXPECT_THAT(ids, ElementsAre(1, 2, 3));
+
+  int num_batches = 0;
+  EXPECT_TRUE(absl::IsCancelled(metadata_source_->ExecuteStreamingQuery(
+      "SELECT c1 FROM t1", /*max_batch_size=*/1,
+      [&num_batches](const TypedRecordSet& batch) {
+        num_batches++;
+        return absl::CancelledError("stop");
+      })));
+  EXPECT_EQ(num_batches, 1);
+  // The connection can run other queries after an aborted streaming query.
+  RecordSet query_results;
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->ExecuteQuery(
+                                  "SELECT count(*) FROM t1", &query_results));
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  ASSERT_EQ(query_results.records_size(), 1);
+  EXPECT_EQ(query_results.records(0).values(0), "3");
+}
+
+// Test: pipelined queries return the results of each query, and a failed
+// query stops the batch.
+// Execution: Insert three rows, then select them with two pipelined queries,
+// and run a batch whose second query is invalid.
+// Expectation: each query has its own result, and the connection can run
+// other queries after the failed batch.
+TEST_P(MetadataSourceTestSuite, TestExecutePipelinedQueries) {
+  metadata_source_container_->InitTestSchema();
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "INSERT INTO t1 VALUES (1, 'v1'), (2, 'v2'), (3, NULL)",
+                nullptr));
+  std::vector<TypedRecordSet> results;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecutePipelinedQueries(
+                {{"SELECT c1, c2 FROM t1 WHERE c1 <= ? ORDER BY c1",
+                  {int64{2}}},
+                 {"SELECT c1 FROM t1 WHERE c2 IS NULL;", {}},
+                 {"SELECT c1 FROM t1 WHERE c2 = ?", {std::string("v4")}}},
+                &results));
+  ASSERT_EQ(results.size(), 3);
+  ASSERT_EQ(results[0].num_rows(), 2);
+  EXPECT_EQ(results[0].GetString(1, 1), "v2");
+  ASSERT_EQ(results[1].num_rows(), 1);
+  int64 c1;
+  EXPECT_TRUE(results[1].GetInt64(0, 0, &c1));
+  EXPECT_EQ(c1, 3);
+  EXPECT_EQ(results[2].num_rows(), 0);
+
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_source_->ExecutePipelinedQueries(
+      {{"SELECT c1 FROM t1 WHERE c1 = ?", {}}}, &results)));
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  EXPECT_FALSE(metadata_source_
+                   ->ExecutePipelinedQueries({{"SELECT c1 FROM t1", {}},
+                                              {"SELECT c3 FROM t1", {}},
+                                              {"SELECT c2 FROM t1", {}}},
+                                             &results)
+                   .ok());
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  RecordSet query_results;
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->ExecuteQuery(
+                                  "SELECT count(*) FROM t1", &query_results));
+  EXPECT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  ASSERT_EQ(query_results.records_size(), 1);
+  EXPECT_EQ(query_results.records(0).values(0), "3");
+}
+
 }  // namespace
 }  // namespace testing
 }  // namespace ml_metadata
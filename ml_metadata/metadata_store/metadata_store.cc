@@ -15,17 +15,30 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_store.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <utility>
 
+#include <glog/logging.h>
 #include "google/protobuf/descriptor.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "google/protobuf/repeated_field.h"
+#include "google/protobuf/util/json_util.h"
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/list_operation_query_helper.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/sharded_metadata_access_object.h"
 #include "ml_metadata/metadata_store/simple_types_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -35,6 +48,7 @@ limitations under the License.
 #include "ml_metadata/util/status_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace ml_metadata {
 namespace {
@@ -107,48 +121,110 @@ tensorflow::Status CheckFieldsConsistent(const T& stored_type,
   return tensorflow::Status::OK();
 }
 
-// If there is no type having the same name and version, then inserts a new
-// type. If a type with the same name and version already exists
-// (let's call it `old_type`), it checks the consistency of `type` and
-// `old_type` as described in CheckFieldsConsistent according to
-// can_add_fields and can_omit_fields.
+// If there is no type having the same name and version, i.e., `old_type` is
+// null, then inserts a new type. If a type with the same name and version
+// already exists, it checks the consistency of `type` and `old_type` as
+// described in CheckFieldsConsistent according to can_add_fields and
+// can_omit_fields.
 // It returns ALREADY_EXISTS if:
 //  a) any property in `type` has different value from the one in `old_type`
 //  b) can_add_fields = false, `type` has more properties than `old_type`
 //  c) can_omit_fields = false, `type` has less properties than `old_type`
-// If `type` is a valid update, then new fields in `type` are added.
+// If `type` is a valid update, then new fields in `type` are added. The type
+// as stored after the call is returned in `upserted_type`.
 // Returns INVALID_ARGUMENT error, if name field in `type` is not given.
 // Returns INVALID_ARGUMENT error, if any property type in `type` is unknown.
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename T>
-absl::Status UpsertType(const T& type, bool can_add_fields,
-                        bool can_omit_fields,
+absl::Status UpsertType(const T& type, const T* old_type,
+                        bool can_add_fields, bool can_omit_fields,
                         MetadataAccessObject* metadata_access_object,
-                        int64* type_id) {
-  T stored_type;
-  const absl::Status status = metadata_access_object->FindTypeByNameAndVersion(
-      type.name(), type.version(), &stored_type);
-  if (!status.ok() && !absl::IsNotFound(status)) {
-    return status;
-  }
+                        int64* type_id, T* upserted_type) {
   // if not found, then it creates a type. `can_add_fields` is ignored.
-  if (absl::IsNotFound(status)) {
-    return metadata_access_object->CreateType(type, type_id);
+  if (old_type == nullptr) {
+    MLMD_RETURN_IF_ERROR(metadata_access_object->CreateType(type, type_id));
+    *upserted_type = type;
+    upserted_type->set_id(*type_id);
+    return absl::OkStatus();
   }
   // otherwise it updates the type.
-  *type_id = stored_type.id();
-  // all properties in stored_type must match the given type.
+  *type_id = old_type->id();
+  // all properties in old_type must match the given type.
   // if `can_add_fields` is set, then new properties can be added
   // if `can_omit_fields` is set, then existing properties can be missing.
-  T output_type;
   const tensorflow::Status check_status = CheckFieldsConsistent(
-      stored_type, type, can_add_fields, can_omit_fields, output_type);
+      *old_type, type, can_add_fields, can_omit_fields, *upserted_type);
   if (!check_status.ok()) {
     return absl::AlreadyExistsError(
         absl::StrCat("Type already exists with different properties: ",
                      check_status.error_message()));
   }
-  return metadata_access_object->UpdateType(output_type);
+  // the stored type is unchanged, unless there are new properties.
+  if (upserted_type->properties_size() == old_type->properties_size()) {
+    return absl::OkStatus();
+  }
+  return metadata_access_object->UpdateType(*upserted_type);
+}
+
+// Same as above, but it queries the stored type with the same name and version
+// as `type` first.
+template <typename T>
+absl::Status UpsertType(const T& type, bool can_add_fields,
+                        bool can_omit_fields,
+                        MetadataAccessObject* metadata_access_object,
+                        int64* type_id) {
+  T stored_type;
+  const absl::Status status = metadata_access_object->FindTypeByNameAndVersion(
+      type.name(), type.version(), &stored_type);
+  if (!status.ok() && !absl::IsNotFound(status)) {
+    return status;
+  }
+  T upserted_type;
+  return UpsertType(type, status.ok() ? &stored_type : nullptr, can_add_fields,
+                    can_omit_fields, metadata_access_object, type_id,
+                    &upserted_type);
+}
+
+// Inserts or updates a list of types of the same kind. The stored types of
+// all (name, version) pairs are read with one batched lookup before any
+// write, and the upserted types are remembered, so that a later type with
+// the same name and version is checked against the earlier one.
+template <typename T>
+absl::Status UpsertTypesOfKind(
+    const google::protobuf::RepeatedPtrField<T>& types,
+    const bool can_add_fields, const bool can_omit_fields,
+    MetadataAccessObject* metadata_access_object,
+    std::vector<int64>* type_ids) {
+  if (types.empty()) return absl::OkStatus();
+  std::vector<std::pair<std::string, std::string>> names_and_versions;
+  names_and_versions.reserve(types.size());
+  for (const T& type : types) {
+    names_and_versions.emplace_back(type.name(), type.version());
+  }
+  std::vector<T> stored_types;
+  MLMD_RETURN_IF_ERROR(metadata_access_object->FindTypesByNamesAndVersions(
+      names_and_versions, &stored_types));
+  absl::flat_hash_map<std::pair<std::string, std::string>, T>
+      stored_type_by_name_and_version;
+  for (T& stored_type : stored_types) {
+    std::pair<std::string, std::string> key(stored_type.name(),
+                                            stored_type.version());
+    stored_type_by_name_and_version[std::move(key)] = std::move(stored_type);
+  }
+  for (int i = 0; i < types.size(); ++i) {
+    const auto it = stored_type_by_name_and_version.find(names_and_versions[i]);
+    const T* stored_type =
+        it != stored_type_by_name_and_version.end() ? &it->second : nullptr;
+    int64 type_id;
+    T upserted_type;
+    MLMD_RETURN_IF_ERROR(UpsertType(types.Get(i), stored_type, can_add_fields,
+                                    can_omit_fields, metadata_access_object,
+                                    &type_id, &upserted_type));
+    stored_type_by_name_and_version[names_and_versions[i]] =
+        std::move(upserted_type);
+    type_ids->push_back(type_id);
+  }
+  return absl::OkStatus();
 }
 
 // Inserts or updates all the types in the argument list. 'can_add_fields' and
@@ -160,25 +236,28 @@ absl::Status UpsertTypes(
     const google::protobuf::RepeatedPtrField<ContextType>& context_types,
     const bool can_add_fields, const bool can_omit_fields,
     MetadataAccessObject* metadata_access_object, PutTypesResponse* response) {
-  for (const ArtifactType& artifact_type : artifact_types) {
-    int64 artifact_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(artifact_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &artifact_type_id));
+  std::vector<int64> artifact_type_ids;
+  MLMD_RETURN_IF_ERROR(UpsertTypesOfKind(artifact_types, can_add_fields,
+                                         can_omit_fields,
+                                         metadata_access_object,
+                                         &artifact_type_ids));
+  for (const int64 artifact_type_id : artifact_type_ids) {
     response->add_artifact_type_ids(artifact_type_id);
   }
-  for (const ExecutionType& execution_type : execution_types) {
-    int64 execution_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(execution_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &execution_type_id));
+  std::vector<int64> execution_type_ids;
+  MLMD_RETURN_IF_ERROR(UpsertTypesOfKind(execution_types, can_add_fields,
+                                         can_omit_fields,
+                                         metadata_access_object,
+                                         &execution_type_ids));
+  for (const int64 execution_type_id : execution_type_ids) {
     response->add_execution_type_ids(execution_type_id);
   }
-  for (const ContextType& context_type : context_types) {
-    int64 context_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(context_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &context_type_id));
+  std::vector<int64> context_type_ids;
+  MLMD_RETURN_IF_ERROR(UpsertTypesOfKind(context_types, can_add_fields,
+                                         can_omit_fields,
+                                         metadata_access_object,
+                                         &context_type_ids));
+  for (const int64 context_type_id : context_type_ids) {
     response->add_context_type_ids(context_type_id);
   }
   return absl::OkStatus();
@@ -186,15 +265,69 @@ absl::Status UpsertTypes(
 
 // Loads SimpleTypes proto from string and updates or inserts it into database.
 absl::Status UpsertSimpleTypes(MetadataAccessObject* metadata_access_object) {
-  SimpleTypes simple_types;
+  const SimpleTypes* simple_types;
   PutTypesResponse response;
-  MLMD_RETURN_IF_ERROR(LoadSimpleTypes(simple_types));
+  MLMD_RETURN_IF_ERROR(GetSimpleTypes(&simple_types));
   return UpsertTypes(
-      simple_types.artifact_types(), simple_types.execution_types(),
-      simple_types.context_types(), /*can_add_fields=*/true,
+      simple_types->artifact_types(), simple_types->execution_types(),
+      simple_types->context_types(), /*can_add_fields=*/true,
       /*can_omit_fields=*/true, metadata_access_object, &response);
 }
 
+// Sets `stored` to false if any of `types` is not stored with all of its
+// properties, i.e., if upserting them would change the database.
+template <typename T>
+absl::Status AreTypesStored(const google::protobuf::RepeatedPtrField<T>& types,
+                            MetadataAccessObject* metadata_access_object,
+                            bool* stored) {
+  std::vector<std::pair<std::string, std::string>> names_and_versions;
+  names_and_versions.reserve(types.size());
+  for (const T& type : types) {
+    names_and_versions.emplace_back(type.name(), type.version());
+  }
+  std::vector<T> stored_types;
+  MLMD_RETURN_IF_ERROR(metadata_access_object->FindTypesByNamesAndVersions(
+      names_and_versions, &stored_types));
+  absl::flat_hash_map<std::pair<std::string, std::string>, const T*>
+      stored_type_by_name_and_version;
+  for (const T& stored_type : stored_types) {
+    stored_type_by_name_and_version[{stored_type.name(),
+                                     stored_type.version()}] = &stored_type;
+  }
+  for (int i = 0; i < types.size() && *stored; ++i) {
+    const auto it = stored_type_by_name_and_version.find(names_and_versions[i]);
+    if (it == stored_type_by_name_and_version.end()) {
+      *stored = false;
+      break;
+    }
+    const auto& stored_properties = it->second->properties();
+    for (const auto& property : types.Get(i).properties()) {
+      const auto stored_property = stored_properties.find(property.first);
+      if (stored_property == stored_properties.end() ||
+          stored_property->second != property.second) {
+        *stored = false;
+        break;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Sets `stored` to true if the simple types are all stored, so that
+// UpsertSimpleTypes can be skipped.
+absl::Status AreSimpleTypesStored(MetadataAccessObject* metadata_access_object,
+                                  bool* stored) {
+  const SimpleTypes* simple_types;
+  MLMD_RETURN_IF_ERROR(GetSimpleTypes(&simple_types));
+  *stored = true;
+  MLMD_RETURN_IF_ERROR(AreTypesStored(simple_types->artifact_types(),
+                                      metadata_access_object, stored));
+  MLMD_RETURN_IF_ERROR(AreTypesStored(simple_types->execution_types(),
+                                      metadata_access_object, stored));
+  return AreTypesStored(simple_types->context_types(), metadata_access_object,
+                        stored);
+}
+
 // Updates or inserts an artifact. If the artifact.id is given, it updates the
 // stored artifact, otherwise, it creates a new artifact.
 absl::Status UpsertArtifact(const Artifact& artifact,
@@ -243,45 +376,73 @@ absl::Status UpsertContext(const Context& context,
   return absl::OkStatus();
 }
 
-// Inserts an association. If the association already exists it returns OK.
-absl::Status InsertAssociationIfNotExist(
-    int64 context_id, int64 execution_id,
-    MetadataAccessObject* metadata_access_object) {
-  Association association;
-  association.set_execution_id(execution_id);
-  association.set_context_id(context_id);
-  int64 dummy_assocation_id;
-  absl::Status status = metadata_access_object->CreateAssociation(
-      association, &dummy_assocation_id);
-  if (!status.ok() && !absl::IsAlreadyExists(status)) {
-    return status;
-  }
-  return absl::OkStatus();
-}
-
-// Inserts an attribution. If the attribution already exists it returns OK.
-absl::Status InsertAttributionIfNotExist(
-    int64 context_id, int64 artifact_id,
-    MetadataAccessObject* metadata_access_object) {
-  Attribution attribution;
-  attribution.set_artifact_id(artifact_id);
-  attribution.set_context_id(context_id);
-  int64 dummy_attribution_id;
-  absl::Status status = metadata_access_object->CreateAttribution(
-      attribution, &dummy_attribution_id);
-  if (!status.ok() && !absl::IsAlreadyExists(status)) {
-    return status;
+// Updates or inserts `nodes` in order, and appends their ids to `node_ids`.
+// Each run of consecutive nodes without ids is created with a single call of
+// `create_nodes`, and each run of consecutive nodes with distinct ids is
+// updated with a single call of `update_nodes`, which write the batch with a
+// few set-based statements.
+template <typename Node>
+absl::Status UpsertNodes(
+    const google::protobuf::RepeatedPtrField<Node>& nodes,
+    const std::function<absl::Status(absl::Span<const Node>)>& update_nodes,
+    const std::function<absl::Status(absl::Span<const Node>,
+                                     std::vector<int64>*)>& create_nodes,
+    google::protobuf::RepeatedField<google::protobuf::int64>* node_ids) {
+  std::vector<Node> new_nodes;
+  std::vector<int64> new_node_ids;
+  const auto create_new_nodes = [&]() -> absl::Status {
+    if (new_nodes.empty()) {
+      return absl::OkStatus();
+    }
+    MLMD_RETURN_IF_ERROR(create_nodes(new_nodes, &new_node_ids));
+    node_ids->Add(new_node_ids.begin(), new_node_ids.end());
+    new_nodes.clear();
+    return absl::OkStatus();
+  };
+  std::vector<Node> updated_nodes;
+  absl::flat_hash_set<int64> updated_node_ids;
+  const auto update_stored_nodes = [&]() -> absl::Status {
+    if (updated_nodes.empty()) {
+      return absl::OkStatus();
+    }
+    MLMD_RETURN_IF_ERROR(update_nodes(updated_nodes));
+    for (const Node& node : updated_nodes) {
+      node_ids->Add(node.id());
+    }
+    updated_nodes.clear();
+    updated_node_ids.clear();
+    return absl::OkStatus();
+  };
+  for (const Node& node : nodes) {
+    if (!node.has_id()) {
+      MLMD_RETURN_IF_ERROR(update_stored_nodes());
+      new_nodes.push_back(node);
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(create_new_nodes());
+    // A node updated twice is updated by separate batches, so that the second
+    // update applies on top of the first one.
+    if (updated_node_ids.contains(node.id())) {
+      MLMD_RETURN_IF_ERROR(update_stored_nodes());
+    }
+    updated_node_ids.insert(node.id());
+    updated_nodes.push_back(node);
   }
-  return absl::OkStatus();
+  MLMD_RETURN_IF_ERROR(update_stored_nodes());
+  return create_new_nodes();
 }
 
 // Updates or inserts a pair of {Artifact, Event}. If artifact is not given,
-// the event.artifact_id must exist, and it inserts the event, and returns the
-// artifact_id. Otherwise if artifact is given, event.artifact_id is optional,
-// if set, then artifact.id and event.artifact_id must align.
+// the event.artifact_id must exist, and it appends the event to `events`, and
+// returns the artifact_id. Otherwise if artifact is given, event.artifact_id is
+// optional, if set, then artifact.id and event.artifact_id must align. The
+// appended event refers to `execution_id`, and the caller creates the appended
+// events in one batch. The pair is read in place, so that only the event is
+// copied.
 absl::Status UpsertArtifactAndEvent(
     const PutExecutionRequest::ArtifactAndEvent& artifact_and_event,
-    MetadataAccessObject* metadata_access_object, int64* artifact_id) {
+    const int64 execution_id, MetadataAccessObject* metadata_access_object,
+    int64* artifact_id, std::vector<Event>* events) {
   CHECK(artifact_id) << "The output artifact_id pointer should not be null";
   if (!artifact_and_event.has_artifact() && !artifact_and_event.has_event()) {
     return absl::OkStatus();
@@ -320,14 +481,15 @@ absl::Status UpsertArtifactAndEvent(
   if (!artifact_and_event.has_event()) {
     return absl::OkStatus();
   }
-  Event event = artifact_and_event.event();
+  events->push_back(artifact_and_event.event());
+  Event& event = events->back();
+  event.set_execution_id(execution_id);
   if (artifact_and_event.has_artifact()) {
     event.set_artifact_id(*artifact_id);
   } else {
     *artifact_id = event.artifact_id();
   }
-  int64 dummy_event_id = -1;
-  return metadata_access_object->CreateEvent(event, &dummy_event_id);
+  return absl::OkStatus();
 }
 
 // A util to handle type_version in type read/write API requests.
@@ -338,15 +500,660 @@ absl::optional<std::string> GetRequestTypeVersion(const T& type_request) {
              : absl::nullopt;
 }
 
+// Sets `type_id` to the id of the type of `request`, if the request has a
+// type_name, e.g., to count the nodes of the type.
+// Returns NOT_FOUND error, if the type cannot be found.
+template <typename Type, typename Request>
+absl::Status FindOptionalRequestTypeId(
+    const Request& request, MetadataAccessObject* metadata_access_object,
+    absl::optional<int64>* type_id) {
+  if (!request.has_type_name()) {
+    return absl::OkStatus();
+  }
+  Type type;
+  MLMD_RETURN_IF_ERROR(metadata_access_object->FindTypeByNameAndVersion(
+      request.type_name(), GetRequestTypeVersion(request), &type));
+  *type_id = type.id();
+  return absl::OkStatus();
+}
+
+// The maximum number of nodes in a response of the streaming methods, if the
+// request does not set it.
+constexpr int kDefaultMaxStreamChunkSize = 100;
+
+// Passes the nodes streamed by `find_nodes` to `callback` in responses of at
+// most `max_chunk_size` nodes. The nodes are added to the responses with
+// `mutable_nodes`. If `complete_chunk` is given, it is run on each response
+// before it is passed to `callback`.
+template <typename Node, typename Response, typename FindNodes>
+absl::Status StreamNodesInChunks(
+    const int max_chunk_size, const FindNodes& find_nodes,
+    google::protobuf::RepeatedPtrField<Node>* (Response::*mutable_nodes)(),
+    const std::function<tensorflow::Status(const Response&)>& callback,
+    const std::function<void(Response&)>& complete_chunk = nullptr) {
+  const int chunk_size =
+      max_chunk_size > 0 ? max_chunk_size : kDefaultMaxStreamChunkSize;
+  Response response;
+  google::protobuf::RepeatedPtrField<Node>* nodes = (response.*mutable_nodes)();
+  const auto pass_chunk = [&]() -> absl::Status {
+    if (complete_chunk) {
+      complete_chunk(response);
+    }
+    return ToABSLStatus(callback(response));
+  };
+  MLMD_RETURN_IF_ERROR(
+      find_nodes([&](absl::Span<const Node> batch) -> absl::Status {
+        for (const Node& node : batch) {
+          *nodes->Add() = node;
+          if (nodes->size() == chunk_size) {
+            MLMD_RETURN_IF_ERROR(pass_chunk());
+            nodes->Clear();
+          }
+        }
+        return absl::OkStatus();
+      }));
+  if (!nodes->empty()) {
+    MLMD_RETURN_IF_ERROR(pass_chunk());
+  }
+  return absl::OkStatus();
+}
+
+// Sets `watermark` to the position of `node` in the change feed.
+template <typename Node>
+void SetChangeWatermark(const Node& node, ChangeWatermark* watermark) {
+  watermark->set_last_update_time_since_epoch(
+      node.last_update_time_since_epoch());
+  watermark->set_id(node.id());
+}
+
+// Sets the watermark of a WatchChanges `response` to the one of its last node.
+void SetChangeWatermark(WatchChangesResponse& response) {
+  if (response.artifacts_size() > 0) {
+    SetChangeWatermark(response.artifacts(response.artifacts_size() - 1),
+                       response.mutable_watermark());
+  } else if (response.executions_size() > 0) {
+    SetChangeWatermark(response.executions(response.executions_size() - 1),
+                       response.mutable_watermark());
+  } else if (response.contexts_size() > 0) {
+    SetChangeWatermark(response.contexts(response.contexts_size() - 1),
+                       response.mutable_watermark());
+  }
+}
+
+// Appends the columns of a chunk of nodes to a StreamNodeColumns response,
+// one node at a time. The property columns are created as the properties are
+// first seen in the chunk, and are padded for the nodes added before.
+class NodeColumnsBuilder {
+ public:
+  explicit NodeColumnsBuilder(StreamNodeColumnsResponse* response)
+      : response_(response) {}
+
+  int num_rows() const { return num_rows_; }
+
+  void Add(const Artifact& artifact) {
+    AddNodeFields(artifact);
+    response_->add_uris(artifact.uri());
+    response_->add_states(artifact.state());
+    AddProperties(artifact);
+  }
+
+  void Add(const Execution& execution) {
+    AddNodeFields(execution);
+    response_->add_states(execution.last_known_state());
+    AddProperties(execution);
+  }
+
+  void Add(const Context& context) {
+    AddNodeFields(context);
+    AddProperties(context);
+  }
+
+  // Clears the response and the columns, for the next chunk.
+  void Clear() {
+    response_->Clear();
+    column_indices_.clear();
+    num_rows_ = 0;
+  }
+
+ private:
+  template <typename Node>
+  void AddNodeFields(const Node& node) {
+    response_->add_ids(node.id());
+    response_->add_type_ids(node.type_id());
+    response_->add_names(node.name());
+    response_->add_create_times_since_epoch(node.create_time_since_epoch());
+    response_->add_last_update_times_since_epoch(
+        node.last_update_time_since_epoch());
+  }
+
+  template <typename Node>
+  void AddProperties(const Node& node) {
+    for (const auto& name_and_value : node.properties()) {
+      AddValue(name_and_value.first, /*is_custom_property=*/false,
+               name_and_value.second);
+    }
+    for (const auto& name_and_value : node.custom_properties()) {
+      AddValue(name_and_value.first, /*is_custom_property=*/true,
+               name_and_value.second);
+    }
+    ++num_rows_;
+    for (PropertyColumn& column : *response_->mutable_properties()) {
+      PadColumn(num_rows_, &column);
+    }
+  }
+
+  // Sets the `value` of the current node in its column.
+  void AddValue(const std::string& name, const bool is_custom_property,
+                const Value& value) {
+    PropertyType data_type;
+    switch (value.value_case()) {
+      case Value::kIntValue:
+        data_type = PropertyType::INT;
+        break;
+      case Value::kDoubleValue:
+        data_type = PropertyType::DOUBLE;
+        break;
+      case Value::kStringValue:
+        data_type = PropertyType::STRING;
+        break;
+      case Value::kStructValue:
+        data_type = PropertyType::STRUCT;
+        break;
+      default:
+        return;
+    }
+    const std::string key = absl::StrCat(
+        is_custom_property, ":", static_cast<int>(data_type), ":", name);
+    auto it = column_indices_.find(key);
+    if (it == column_indices_.end()) {
+      it = column_indices_.insert({key, response_->properties_size()}).first;
+      PropertyColumn* column = response_->add_properties();
+      column->set_name(name);
+      column->set_is_custom_property(is_custom_property);
+      column->set_data_type(data_type);
+      PadColumn(num_rows_, column);
+    }
+    PropertyColumn* column = response_->mutable_properties(it->second);
+    column->add_is_set(true);
+    switch (data_type) {
+      case PropertyType::INT:
+        column->add_int_values(value.int_value());
+        break;
+      case PropertyType::DOUBLE:
+        column->add_double_values(value.double_value());
+        break;
+      case PropertyType::STRING:
+        column->add_string_values(value.string_value());
+        break;
+      default: {
+        std::string* json = column->add_string_values();
+        if (!google::protobuf::util::MessageToJsonString(value.struct_value(),
+                                                         json)
+                 .ok()) {
+          json->clear();
+        }
+        break;
+      }
+    }
+  }
+
+  // Appends unset entries to `column`, until it has `num_rows` entries.
+  static void PadColumn(const int num_rows, PropertyColumn* column) {
+    while (column->is_set_size() < num_rows) {
+      column->add_is_set(false);
+      switch (column->data_type()) {
+        case PropertyType::INT:
+          column->add_int_values(0);
+          break;
+        case PropertyType::DOUBLE:
+          column->add_double_values(0);
+          break;
+        default:
+          column->add_string_values();
+          break;
+      }
+    }
+  }
+
+  StreamNodeColumnsResponse* const response_;
+  // The indices of the property columns keyed by their property and kind.
+  absl::flat_hash_map<std::string, int> column_indices_;
+  int num_rows_ = 0;
+};
+
+// Passes the nodes streamed by `find_nodes` to `callback` as the columns of
+// responses of at most `max_chunk_size` nodes.
+template <typename Node, typename FindNodes>
+absl::Status StreamNodeColumnsInChunks(
+    const int max_chunk_size, const FindNodes& find_nodes,
+    const std::function<tensorflow::Status(const StreamNodeColumnsResponse&)>&
+        callback) {
+  const int chunk_size =
+      max_chunk_size > 0 ? max_chunk_size : kDefaultMaxStreamChunkSize;
+  StreamNodeColumnsResponse response;
+  NodeColumnsBuilder builder(&response);
+  MLMD_RETURN_IF_ERROR(
+      find_nodes([&](absl::Span<const Node> batch) -> absl::Status {
+        for (const Node& node : batch) {
+          builder.Add(node);
+          if (builder.num_rows() == chunk_size) {
+            MLMD_RETURN_IF_ERROR(ToABSLStatus(callback(response)));
+            builder.Clear();
+          }
+        }
+        return absl::OkStatus();
+      }));
+  if (builder.num_rows() > 0) {
+    MLMD_RETURN_IF_ERROR(ToABSLStatus(callback(response)));
+  }
+  return absl::OkStatus();
+}
+
+// The maximum number of nodes in a lineage subgraph, if the request does not
+// set it.
+constexpr int kDefaultMaxLineageGraphNodes = 1000;
+
+// The maximum number of nodes deleted in a transaction, if the request does
+// not set it.
+constexpr int kDefaultMaxDeleteBatchSize = 100;
+
+// Returns the maximum number of nodes deleted in a transaction of `request`.
+template <typename Request>
+int64 GetMaxDeleteBatchSize(const Request& request) {
+  return request.max_batch_size() > 0 ? request.max_batch_size()
+                                      : kDefaultMaxDeleteBatchSize;
+}
+
+// Runs `delete_nodes` on the `ids` in batches of at most `max_batch_size`,
+// each in a separate transaction, so that a large delete does not hold the
+// locks of one long transaction.
+absl::Status DeleteInBatches(
+    const absl::Span<const int64> ids, const int64 max_batch_size,
+    const std::function<absl::Status(absl::Span<const int64>)>& delete_nodes,
+    TransactionExecutor* transaction_executor) {
+  for (size_t begin = 0; begin < ids.size(); begin += max_batch_size) {
+    const absl::Span<const int64> batch = ids.subspan(begin, max_batch_size);
+    MLMD_RETURN_IF_ERROR(transaction_executor->Execute(
+        [&delete_nodes, batch]() { return delete_nodes(batch); }));
+  }
+  return absl::OkStatus();
+}
+
+// Runs `delete_nodes` on the ids of at most `max_batch_size` nodes found by
+// `find_ids` in separate transactions, until fewer nodes are found, and adds
+// the number of deleted nodes to `num_deleted`.
+absl::Status DeleteFoundInBatches(
+    const int64 max_batch_size,
+    const std::function<absl::Status(int64, std::vector<int64>*)>& find_ids,
+    const std::function<absl::Status(absl::Span<const int64>)>& delete_nodes,
+    TransactionExecutor* transaction_executor, int64* num_deleted) {
+  while (true) {
+    std::vector<int64> ids;
+    MLMD_RETURN_IF_ERROR(transaction_executor->Execute([&]() {
+      MLMD_RETURN_IF_ERROR(find_ids(max_batch_size, &ids));
+      return delete_nodes(ids);
+    }));
+    *num_deleted += ids.size();
+    if (ids.size() < max_batch_size) {
+      return absl::OkStatus();
+    }
+  }
+}
+
+bool IsInputEvent(const Event& event) {
+  return event.type() == Event::INPUT ||
+         event.type() == Event::DECLARED_INPUT ||
+         event.type() == Event::INTERNAL_INPUT;
+}
+
+bool IsOutputEvent(const Event& event) {
+  return event.type() == Event::OUTPUT ||
+         event.type() == Event::DECLARED_OUTPUT ||
+         event.type() == Event::INTERNAL_OUTPUT;
+}
+
+// Returns true if the traversal in `direction` follows `event` from its
+// artifact, or from its execution if `from_artifact` is false.
+bool FollowsEvent(const GetLineageGraphRequest::Direction direction,
+                  const bool from_artifact, const Event& event) {
+  switch (direction) {
+    case GetLineageGraphRequest::UPSTREAM:
+      return from_artifact ? IsOutputEvent(event) : IsInputEvent(event);
+    case GetLineageGraphRequest::DOWNSTREAM:
+      return from_artifact ? IsInputEvent(event) : IsOutputEvent(event);
+    default:
+      return true;
+  }
+}
+
+// Expands the lineage subgraph of `request` breadth-first from its seed
+// artifacts, and adds the reached artifacts, executions and events to
+// `subgraph`. Each hop looks up the events of all the frontier nodes at once.
+absl::Status TraverseLineageGraph(const GetLineageGraphRequest& request,
+                                  MetadataAccessObject* metadata_access_object,
+                                  LineageGraph* subgraph) {
+  if (request.max_num_hops() < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "max_num_hops must not be negative: ", request.max_num_hops()));
+  }
+  const int max_num_nodes = request.max_num_nodes() > 0
+                                ? request.max_num_nodes()
+                                : kDefaultMaxLineageGraphNodes;
+  const GetLineageGraphRequest::Direction direction = request.direction();
+  absl::flat_hash_set<int64> artifact_ids;
+  absl::flat_hash_set<int64> execution_ids;
+  std::vector<int64> frontier;
+  for (const int64 artifact_id : request.artifact_ids()) {
+    if (artifact_ids.size() >= max_num_nodes) break;
+    if (artifact_ids.insert(artifact_id).second) {
+      frontier.push_back(artifact_id);
+    }
+  }
+  // The nodes whose events have been looked up. When all the events are
+  // followed, an event between two expanded nodes has already been added.
+  absl::flat_hash_set<int64> expanded_artifact_ids;
+  absl::flat_hash_set<int64> expanded_execution_ids;
+  bool from_artifacts = true;
+  for (int hop = 0; hop < request.max_num_hops() && !frontier.empty(); hop++) {
+    std::vector<Event> events;
+    const absl::Status status =
+        from_artifacts
+            ? metadata_access_object->FindEventsByArtifacts(frontier, &events)
+            : metadata_access_object->FindEventsByExecutions(frontier, &events);
+    if (!status.ok() && !absl::IsNotFound(status)) {
+      return status;
+    }
+    (from_artifacts ? expanded_artifact_ids : expanded_execution_ids)
+        .insert(frontier.begin(), frontier.end());
+    const absl::flat_hash_set<int64>& expanded_neighbor_ids =
+        from_artifacts ? expanded_execution_ids : expanded_artifact_ids;
+    absl::flat_hash_set<int64>& neighbor_ids =
+        from_artifacts ? execution_ids : artifact_ids;
+    std::vector<int64> next_frontier;
+    for (Event& event : events) {
+      if (!FollowsEvent(direction, from_artifacts, event)) continue;
+      const int64 neighbor_id =
+          from_artifacts ? event.execution_id() : event.artifact_id();
+      if (direction == GetLineageGraphRequest::BOTH &&
+          expanded_neighbor_ids.contains(neighbor_id)) {
+        continue;
+      }
+      if (!neighbor_ids.contains(neighbor_id)) {
+        if (artifact_ids.size() + execution_ids.size() >= max_num_nodes) {
+          continue;
+        }
+        neighbor_ids.insert(neighbor_id);
+        next_frontier.push_back(neighbor_id);
+      }
+      *subgraph->add_events() = std::move(event);
+    }
+    frontier = std::move(next_frontier);
+    from_artifacts = !from_artifacts;
+  }
+
+  std::vector<int64> ids(artifact_ids.begin(), artifact_ids.end());
+  absl::c_sort(ids);
+  std::vector<Artifact> artifacts;
+  // The seed artifacts which do not exist are skipped.
+  absl::Status status =
+      metadata_access_object->FindArtifactsById(ids, &artifacts);
+  if (!status.ok() && !absl::IsNotFound(status)) {
+    return status;
+  }
+  ids.assign(execution_ids.begin(), execution_ids.end());
+  absl::c_sort(ids);
+  std::vector<Execution> executions;
+  status = metadata_access_object->FindExecutionsById(ids, &executions);
+  if (!status.ok() && !absl::IsNotFound(status)) {
+    return status;
+  }
+  absl::c_move(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
+                              subgraph->mutable_artifacts()));
+  absl::c_move(executions, google::protobuf::RepeatedPtrFieldBackInserter(
+                               subgraph->mutable_executions()));
+  return absl::OkStatus();
+}
+
+// Returns `ids` followed by `more_ids`, without duplicates.
+std::vector<int64> UnionOfIds(const std::vector<int64>& ids,
+                              const std::vector<int64>& more_ids) {
+  absl::flat_hash_set<int64> seen_ids;
+  std::vector<int64> result;
+  for (const std::vector<int64>* id_list : {&ids, &more_ids}) {
+    for (const int64 id : *id_list) {
+      if (seen_ids.insert(id).second) result.push_back(id);
+    }
+  }
+  return result;
+}
+
+// Adds the pairs of artifacts connected through the `execution_ids` to the
+// lineage closure: the inputs of an execution and their upstream artifacts are
+// each upstream of the outputs of the execution and their downstream
+// artifacts. The events of each execution are all read again, so that the
+// events written in separate requests are each paired with the others.
+absl::Status UpdateLineageClosure(
+    absl::Span<const int64> execution_ids,
+    MetadataAccessObject* metadata_access_object) {
+  if (execution_ids.empty()) return absl::OkStatus();
+  std::vector<Event> events;
+  const absl::Status status =
+      metadata_access_object->FindEventsByExecutions(execution_ids, &events);
+  if (absl::IsNotFound(status)) return absl::OkStatus();
+  MLMD_RETURN_IF_ERROR(status);
+  absl::flat_hash_map<int64, std::vector<int64>> inputs_by_execution;
+  absl::flat_hash_map<int64, std::vector<int64>> outputs_by_execution;
+  for (const Event& event : events) {
+    if (IsInputEvent(event)) {
+      inputs_by_execution[event.execution_id()].push_back(event.artifact_id());
+    } else if (IsOutputEvent(event)) {
+      outputs_by_execution[event.execution_id()].push_back(
+          event.artifact_id());
+    }
+  }
+  for (const auto& execution_and_inputs : inputs_by_execution) {
+    const auto outputs_it =
+        outputs_by_execution.find(execution_and_inputs.first);
+    if (outputs_it == outputs_by_execution.end()) continue;
+    std::vector<int64> upstream_ids;
+    MLMD_RETURN_IF_ERROR(metadata_access_object->FindLineageClosure(
+        execution_and_inputs.second, /*upstream=*/true, &upstream_ids));
+    std::vector<int64> downstream_ids;
+    MLMD_RETURN_IF_ERROR(metadata_access_object->FindLineageClosure(
+        outputs_it->second, /*upstream=*/false, &downstream_ids));
+    MLMD_RETURN_IF_ERROR(metadata_access_object->CreateLineageClosure(
+        UnionOfIds(execution_and_inputs.second, upstream_ids),
+        UnionOfIds(outputs_it->second, downstream_ids)));
+  }
+  return absl::OkStatus();
+}
+
+// Migrates the schema of the database of `metadata_access_object` to
+// `to_schema_version` with online migration `options`, with a transaction per
+// step of the migration.
+absl::Status MigrateSchemaOnline(
+    const int64 to_schema_version, const OnlineMigrationOptions& options,
+    const MetadataStore::MigrationProgressCallback& progress_callback,
+    MetadataAccessObject* metadata_access_object,
+    TransactionExecutor* transaction_executor) {
+  const int64 max_num_chunks =
+      std::max<int64>(options.max_chunks_per_transaction(), 1);
+  SchemaMigrationProgress progress;
+  do {
+    MLMD_RETURN_IF_ERROR(transaction_executor->Execute([&]() -> absl::Status {
+      return metadata_access_object->MigrateSchemaStep(
+          to_schema_version, max_num_chunks, &progress);
+    }));
+    LOG(INFO) << "Migrating the schema from version "
+              << progress.schema_version() << " to "
+              << progress.to_schema_version() << ": chunked query "
+              << progress.chunked_query_index() << " of "
+              << progress.num_chunked_queries() << ", next id "
+              << progress.next_id() << " of " << progress.max_id()
+              << (progress.done() ? ", done." : ".");
+    if (progress_callback) {
+      MLMD_RETURN_IF_ERROR(ToABSLStatus(progress_callback(progress)));
+    }
+    if (!progress.done() && options.pause_millis() > 0) {
+      absl::SleepFor(absl::Milliseconds(options.pause_millis()));
+    }
+  } while (!progress.done());
+  return absl::OkStatus();
+}
+
+// The idempotency keys are kept for a day, if the options do not set it.
+constexpr absl::Duration kDefaultIdempotencyKeyTtl = absl::Hours(24);
+
+// The longest idempotency key, as stored in the MLMDIdempotencyKey table.
+constexpr int kMaxIdempotencyKeyLength = 255;
+
+// Returns the fingerprint of the deterministic serialization of `request`, so
+// that the retries of a request have the same fingerprint.
+int64 FingerprintRequest(const google::protobuf::Message& request) {
+  std::string serialized_request;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized_request);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    request.SerializeToCodedStream(&coded_stream);
+  }
+  return static_cast<int64>(tensorflow::Fingerprint64(serialized_request));
+}
+
+// Appends the nodes of `node_ids` to `serialized_response` as the field
+// `field_number` of a response listing them. The nodes kept serialized by the
+// node cache are spliced in, and the others are found by `find_nodes` and
+// serialized. Only the nodes with all their properties are cached.
+template <typename Node, typename FindNodes>
+absl::Status AppendSerializedNodesById(
+    MetadataAccessObject& metadata_access_object,
+    const std::vector<int64>& node_ids,
+    const PropertyOptions& property_options, const int field_number,
+    const FindNodes& find_nodes, std::string* serialized_response) {
+  int64 schema_version = 0;
+  NodeCache* const node_cache =
+      !property_options.skip_properties() &&
+              property_options.property_names().empty()
+          ? metadata_access_object.GetSerializedNodeCache(&schema_version)
+          : nullptr;
+  std::vector<int64> uncached_ids;
+  if (node_cache == nullptr) {
+    uncached_ids = node_ids;
+  } else {
+    absl::flat_hash_set<int64> looked_up_ids;
+    for (const int64 node_id : node_ids) {
+      if (!looked_up_ids.insert(node_id).second) continue;
+      if (!node_cache->AppendSerialized<Node>(schema_version, node_id,
+                                              field_number,
+                                              serialized_response)) {
+        uncached_ids.push_back(node_id);
+      }
+    }
+  }
+  if (uncached_ids.empty()) return absl::OkStatus();
+  std::vector<Node> nodes;
+  const absl::Status status = find_nodes(uncached_ids, &nodes);
+  if (!status.ok() && !absl::IsNotFound(status)) {
+    return status;
+  }
+  for (const Node& node : nodes) {
+    AppendLengthDelimitedField(field_number, node.SerializeAsString(),
+                               serialized_response);
+  }
+  return absl::OkStatus();
+}
+
+// Returns the event types of a request filtering the events by their types.
+std::vector<Event::Type> GetEventTypes(
+    const google::protobuf::RepeatedField<int>& types) {
+  std::vector<Event::Type> event_types;
+  event_types.reserve(types.size());
+  for (const int type : types) {
+    event_types.push_back(static_cast<Event::Type>(type));
+  }
+  return event_types;
+}
+
+// Lists a page of nodes with `options`, and sets the token of the next page.
+template <typename Node>
+using ListNodesPage = std::function<absl::Status(
+    const ListOperationOptions& options, std::vector<Node>* nodes,
+    std::string* next_page_token)>;
+
+// Appends the nodes listed by `list_page` to `response_nodes` page by page,
+// until the serialized nodes exceed `max_response_bytes`, and sets
+// `next_page_token` to continue after the last appended node. The first node
+// is appended whatever its size, so that each response makes progress. The
+// `request_options` of a paged request are read in their one page, which is
+// cut at the budget; a request without options is read in pages of the
+// default upper-bound ordered by id, until all its nodes are appended.
+template <typename Node>
+absl::Status ListNodesWithinBudget(
+    const absl::optional<ListOperationOptions>& request_options,
+    const int64 max_response_bytes, const ListNodesPage<Node>& list_page,
+    google::protobuf::RepeatedPtrField<Node>* response_nodes,
+    std::string* next_page_token) {
+  ListOperationOptions options;
+  if (request_options) {
+    options = *request_options;
+  } else {
+    options.set_max_result_size(GetDefaultMaxListOperationResultSize());
+  }
+  int64 response_bytes = 0;
+  while (true) {
+    std::vector<Node> nodes;
+    std::string page_token;
+    MLMD_RETURN_IF_ERROR(list_page(options, &nodes, &page_token));
+    for (Node& node : nodes) {
+      response_bytes += node.ByteSizeLong();
+      if (response_bytes > max_response_bytes && !response_nodes->empty()) {
+        // The token continues after the last appended node, with the
+        // options of the first page.
+        ListOperationOptions token_options = options;
+        token_options.clear_next_page_token();
+        const Node& last_node = response_nodes->Get(response_nodes->size() - 1);
+        return BuildListOperationNextPageToken<Node>(
+            absl::MakeConstSpan(&last_node, 1), token_options,
+            next_page_token);
+      }
+      *response_nodes->Add() = std::move(node);
+    }
+    if (request_options || page_token.empty()) {
+      *next_page_token = page_token;
+      return absl::OkStatus();
+    }
+    options.set_next_page_token(page_token);
+  }
+}
+
 }  // namespace
 
+tensorflow::Status MetadataStore::UpgradeSchemaOnline(
+    const OnlineMigrationOptions& options,
+    const MigrationProgressCallback& progress_callback) {
+  int64 db_version = 0;
+  const absl::Status status =
+      transaction_executor_->ExecuteRead([this, &db_version]() -> absl::Status {
+        return metadata_access_object_->GetSchemaVersion(&db_version);
+      });
+  if (absl::IsNotFound(status)) return tensorflow::Status::OK();
+  TF_RETURN_IF_ERROR(FromABSLStatus(status));
+  const int64 lib_version = metadata_access_object_->GetLibraryVersion();
+  if (db_version >= lib_version) return tensorflow::Status::OK();
+  return FromABSLStatus(MigrateSchemaOnline(
+      lib_version, options, progress_callback, metadata_access_object_.get(),
+      transaction_executor_.get()));
+}
+
 tensorflow::Status MetadataStore::InitMetadataStore() {
-  TF_RETURN_IF_ERROR(
-      FromABSLStatus(transaction_executor_->Execute([this]() -> absl::Status {
+  // The ids of the nodes are reused once the database is initialized again.
+  ForgetKnownEdges();
+  TF_RETURN_IF_ERROR(FromABSLStatus(
+      ExecuteTypeChangingTransaction([this]() -> absl::Status {
         return metadata_access_object_->InitMetadataSource();
       })));
   return FromABSLStatus(
-      transaction_executor_->Execute([this]() -> absl::Status {
+      ExecuteTypeChangingTransaction([this]() -> absl::Status {
         return UpsertSimpleTypes(metadata_access_object_.get());
       }));
 }
@@ -360,18 +1167,260 @@ tensorflow::Status MetadataStore::InitMetadataStoreIfNotExists(
         return metadata_access_object_->InitMetadataSourceIfNotExists(
             enable_upgrade_migration);
       })));
+  // The simple types of an existing database are usually stored already, and
+  // checking them in a read transaction saves the write transaction and the
+  // type cache invalidation of the upsert.
+  bool simple_types_stored = false;
+  TF_RETURN_IF_ERROR(FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &simple_types_stored]() -> absl::Status {
+        return AreSimpleTypesStored(metadata_access_object_.get(),
+                                    &simple_types_stored);
+      })));
+  if (simple_types_stored) return tensorflow::Status::OK();
   return FromABSLStatus(
-      transaction_executor_->Execute([this]() -> absl::Status {
+      ExecuteTypeChangingTransaction([this]() -> absl::Status {
         return UpsertSimpleTypes(metadata_access_object_.get());
       }));
 }
 
+tensorflow::Status MetadataStore::CheckHealth() {
+  return FromABSLStatus(
+      transaction_executor_->Execute([this]() -> absl::Status {
+        int64 db_version = 0;
+        return metadata_access_object_->GetSchemaVersion(&db_version);
+      }));
+}
+
+bool MetadataStore::connection_failed() const {
+  return transaction_executor_->connection_failed() ||
+         (unpinned_transaction_executor_ != nullptr &&
+          unpinned_transaction_executor_->connection_failed());
+}
+
+tensorflow::Status MetadataStore::BeginPinnedRead() {
+  if (unpinned_transaction_executor_ != nullptr) {
+    return tensorflow::errors::FailedPrecondition(
+        "A pinned read is already begun.");
+  }
+  for (int i = 0; i < metadata_sources_.size(); ++i) {
+    absl::Status status =
+        metadata_sources_[i]->Begin(TransactionMode::kSnapshotRead);
+    if (!status.ok()) {
+      for (int j = 0; j < i; ++j) {
+        status.Update(metadata_sources_[j]->Rollback());
+      }
+      return FromABSLStatus(status);
+    }
+  }
+  unpinned_transaction_executor_ = std::move(transaction_executor_);
+  transaction_executor_ = absl::make_unique<PinnedReadTransactionExecutor>();
+  metadata_access_object_->SetPinnedRead(true);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::EndPinnedRead() {
+  if (unpinned_transaction_executor_ == nullptr) {
+    return tensorflow::errors::FailedPrecondition("No pinned read is begun.");
+  }
+  transaction_executor_ = std::move(unpinned_transaction_executor_);
+  metadata_access_object_->SetPinnedRead(false);
+  absl::Status status = absl::OkStatus();
+  for (const std::unique_ptr<MetadataSource>& source : metadata_sources_) {
+    status.Update(source->Rollback());
+  }
+  return FromABSLStatus(status);
+}
+
+tensorflow::Status MetadataStore::DropSecondaryIndices() {
+  return FromABSLStatus(
+      transaction_executor_->Execute([this]() -> absl::Status {
+        return metadata_access_object_->DropSecondaryIndices();
+      }));
+}
+
+tensorflow::Status MetadataStore::CreateSecondaryIndices() {
+  return FromABSLStatus(
+      transaction_executor_->Execute([this]() -> absl::Status {
+        return metadata_access_object_->CreateSecondaryIndices();
+      }));
+}
+
+tensorflow::Status MetadataStore::MaintainEventPartitions(
+    const EventPartitionOptions& options, const bool enable_migration) {
+  const int64 now_milliseconds = absl::ToUnixMillis(absl::Now());
+  return FromABSLStatus(
+      transaction_executor_->Execute([&]() -> absl::Status {
+        return metadata_access_object_->MaintainEventPartitions(
+            options, now_milliseconds, enable_migration);
+      }));
+}
+
+tensorflow::Status MetadataStore::InlineEventPaths(const bool enable_migration) {
+  // A batch small enough to keep the transactions of a live database short.
+  constexpr int64 kMaxNumEventsPerBatch = 1000;
+  int64 num_moved_events;
+  do {
+    TF_RETURN_IF_ERROR(FromABSLStatus(
+        transaction_executor_->Execute([&]() -> absl::Status {
+          return metadata_access_object_->InlineEventPaths(
+              enable_migration, kMaxNumEventsPerBatch, &num_moved_events);
+        })));
+  } while (num_moved_events > 0);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::InlineNodeProperties(
+    const bool enable_migration) {
+  // A batch small enough to keep the transactions of a live database short.
+  constexpr int64 kMaxNumNodesPerBatch = 1000;
+  int64 num_filled_nodes;
+  do {
+    TF_RETURN_IF_ERROR(FromABSLStatus(
+        transaction_executor_->Execute([&]() -> absl::Status {
+          return metadata_access_object_->InlineNodeProperties(
+              enable_migration, kMaxNumNodesPerBatch, &num_filled_nodes);
+        })));
+  } while (num_filled_nodes > 0);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::MaintainNodePropertiesBytes() {
+  // It only checks the columns, so it runs as a read.
+  return FromABSLStatus(
+      transaction_executor_->ExecuteRead([this]() -> absl::Status {
+        return metadata_access_object_->MaintainNodePropertiesBytes();
+      }));
+}
+
+tensorflow::Status MetadataStore::EnableIdempotencyKeys(
+    const ConnectionConfig::IdempotencyOptions& options) {
+  TF_RETURN_IF_ERROR(FromABSLStatus(transaction_executor_->Execute(
+      [this]() -> absl::Status {
+        return metadata_access_object_->CreateIdempotencyKeyTable();
+      })));
+  idempotency_key_ttl_ = options.ttl_seconds() > 0
+                             ? absl::Seconds(options.ttl_seconds())
+                             : kDefaultIdempotencyKeyTtl;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::EnableLineageClosure() {
+  TF_RETURN_IF_ERROR(FromABSLStatus(transaction_executor_->Execute(
+      [this]() -> absl::Status {
+        bool created = false;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CreateLineageClosureTable(&created));
+        if (!created) return absl::OkStatus();
+        // The closure of the existing events is filled in the transaction
+        // creating the table, so that a table is never left partially filled.
+        std::vector<int64> execution_ids;
+        PropertyOptions property_options;
+        property_options.set_skip_properties(true);
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExecutions(
+            property_options,
+            [&execution_ids](absl::Span<const Execution> executions) {
+              for (const Execution& execution : executions) {
+                execution_ids.push_back(execution.id());
+              }
+              return absl::OkStatus();
+            }));
+        // The executions are added in the order of their ids, so that the
+        // closure of the upstream executions is mostly recorded first.
+        absl::c_sort(execution_ids);
+        constexpr int64 kMaxNumExecutionsPerBatch = 1000;
+        for (int64 i = 0; i < static_cast<int64>(execution_ids.size());
+             i += kMaxNumExecutionsPerBatch) {
+          MLMD_RETURN_IF_ERROR(UpdateLineageClosure(
+              absl::MakeConstSpan(execution_ids)
+                  .subspan(i, kMaxNumExecutionsPerBatch),
+              metadata_access_object_.get()));
+        }
+        return absl::OkStatus();
+      })));
+  lineage_closure_enabled_ = true;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::DeleteExpiredIdempotencyKeys(
+    const absl::Time now, const int64 max_batch_size, int64* num_deleted) {
+  *num_deleted = 0;
+  if (!idempotency_key_ttl_) return tensorflow::Status::OK();
+  std::vector<std::string> expired_keys;
+  do {
+    TF_RETURN_IF_ERROR(FromABSLStatus(
+        transaction_executor_->Execute([&]() -> absl::Status {
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->FindIdempotencyKeysCreatedBefore(
+                  now - *idempotency_key_ttl_, max_batch_size, &expired_keys));
+          if (expired_keys.empty()) return absl::OkStatus();
+          return metadata_access_object_->DeleteIdempotencyKeys(expired_keys);
+        })));
+    *num_deleted += expired_keys.size();
+  } while (static_cast<int64>(expired_keys.size()) >= max_batch_size);
+  return tensorflow::Status::OK();
+}
+
+absl::Status MetadataStore::RunIdempotently(
+    const google::protobuf::Message& request,
+    const absl::string_view idempotency_key,
+    google::protobuf::Message* response,
+    const std::function<absl::Status()>& txn_body) {
+  if (!idempotency_key_ttl_ || idempotency_key.empty()) return txn_body();
+  if (idempotency_key.size() > kMaxIdempotencyKeyLength) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The idempotency key is longer than ",
+                     kMaxIdempotencyKeyLength, " characters."));
+  }
+  const int64 request_fingerprint = FingerprintRequest(request);
+  int64 recorded_fingerprint;
+  absl::Time create_time;
+  std::string recorded_response;
+  const absl::Status status = metadata_access_object_->FindIdempotencyKey(
+      idempotency_key, &recorded_fingerprint, &create_time,
+      &recorded_response);
+  if (status.ok()) {
+    if (create_time + *idempotency_key_ttl_ > absl::Now()) {
+      if (recorded_fingerprint != request_fingerprint) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("The idempotency key is reused by a different "
+                         "request: ",
+                         idempotency_key));
+      }
+      if (!response->ParseFromString(recorded_response)) {
+        return absl::InternalError(absl::StrCat(
+            "Failed to parse the response recorded with the idempotency key: ",
+            idempotency_key));
+      }
+      return absl::OkStatus();
+    }
+    // The expired key is recorded again with the new response.
+    MLMD_RETURN_IF_ERROR(metadata_access_object_->DeleteIdempotencyKeys(
+        {std::string(idempotency_key)}));
+  } else if (!absl::IsNotFound(status)) {
+    return status;
+  }
+  MLMD_RETURN_IF_ERROR(txn_body());
+  std::string serialized_response;
+  response->SerializeToString(&serialized_response);
+  const absl::Status create_status =
+      metadata_access_object_->CreateIdempotencyKey(
+          idempotency_key, request_fingerprint, absl::Now(),
+          serialized_response);
+  // The retry of the request returns the response of the concurrent one.
+  if (absl::IsAlreadyExists(create_status)) {
+    return absl::AbortedError(absl::StrCat(
+        "The idempotency key is recorded by a concurrent request: ",
+        idempotency_key));
+  }
+  return create_status;
+}
+
 tensorflow::Status MetadataStore::PutTypes(const PutTypesRequest& request,
                                            PutTypesResponse* response) {
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(ExecuteTypeChangingTransaction(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         return UpsertTypes(request.artifact_types(), request.execution_types(),
@@ -386,7 +1435,7 @@ tensorflow::Status MetadataStore::PutArtifactType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(ExecuteTypeChangingTransaction(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -405,7 +1454,7 @@ tensorflow::Status MetadataStore::PutExecutionType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(ExecuteTypeChangingTransaction(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -423,7 +1472,7 @@ tensorflow::Status MetadataStore::PutContextType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(ExecuteTypeChangingTransaction(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -438,7 +1487,7 @@ tensorflow::Status MetadataStore::PutContextType(
 
 tensorflow::Status MetadataStore::GetArtifactType(
     const GetArtifactTypeRequest& request, GetArtifactTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         return metadata_access_object_->FindTypeByNameAndVersion(
@@ -450,7 +1499,7 @@ tensorflow::Status MetadataStore::GetArtifactType(
 tensorflow::Status MetadataStore::GetExecutionType(
     const GetExecutionTypeRequest& request,
     GetExecutionTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         return metadata_access_object_->FindTypeByNameAndVersion(
@@ -461,7 +1510,7 @@ tensorflow::Status MetadataStore::GetExecutionType(
 
 tensorflow::Status MetadataStore::GetContextType(
     const GetContextTypeRequest& request, GetContextTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         return metadata_access_object_->FindTypeByNameAndVersion(
@@ -473,7 +1522,7 @@ tensorflow::Status MetadataStore::GetContextType(
 tensorflow::Status MetadataStore::GetArtifactTypesByID(
     const GetArtifactTypesByIDRequest& request,
     GetArtifactTypesByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         for (const int64 type_id : request.type_ids()) {
@@ -481,7 +1530,8 @@ tensorflow::Status MetadataStore::GetArtifactTypesByID(
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &artifact_type);
           if (status.ok()) {
-            *response->mutable_artifact_types()->Add() = artifact_type;
+            *response->mutable_artifact_types()->Add() =
+                std::move(artifact_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -493,7 +1543,7 @@ tensorflow::Status MetadataStore::GetArtifactTypesByID(
 tensorflow::Status MetadataStore::GetExecutionTypesByID(
     const GetExecutionTypesByIDRequest& request,
     GetExecutionTypesByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         for (const int64 type_id : request.type_ids()) {
@@ -501,7 +1551,8 @@ tensorflow::Status MetadataStore::GetExecutionTypesByID(
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &execution_type);
           if (status.ok()) {
-            *response->mutable_execution_types()->Add() = execution_type;
+            *response->mutable_execution_types()->Add() =
+                std::move(execution_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -513,7 +1564,7 @@ tensorflow::Status MetadataStore::GetExecutionTypesByID(
 tensorflow::Status MetadataStore::GetContextTypesByID(
     const GetContextTypesByIDRequest& request,
     GetContextTypesByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         for (const int64 type_id : request.type_ids()) {
@@ -521,7 +1572,7 @@ tensorflow::Status MetadataStore::GetContextTypesByID(
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &context_type);
           if (status.ok()) {
-            *response->mutable_context_types()->Add() = context_type;
+            *response->mutable_context_types()->Add() = std::move(context_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -533,136 +1584,205 @@ tensorflow::Status MetadataStore::GetContextTypesByID(
 tensorflow::Status MetadataStore::GetArtifactsByID(
     const GetArtifactsByIDRequest& request,
     GetArtifactsByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
         const std::vector<int64> ids(request.artifact_ids().begin(),
                                      request.artifact_ids().end());
         const absl::Status status =
-            metadata_access_object_->FindArtifactsById(ids, &artifacts);
+            metadata_access_object_->FindArtifactsById(
+                ids, request.property_options(), &artifacts);
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
+        absl::c_move(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
                                     response->mutable_artifacts()));
         return absl::OkStatus();
       }));
 }
 
+tensorflow::Status MetadataStore::GetSerializedArtifactsByID(
+    const GetArtifactsByIDRequest& request, std::string* serialized_response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &serialized_response]() -> absl::Status {
+        serialized_response->clear();
+        return AppendSerializedNodesById<Artifact>(
+            *metadata_access_object_,
+            std::vector<int64>(request.artifact_ids().begin(),
+                               request.artifact_ids().end()),
+            request.property_options(),
+            GetArtifactsByIDResponse::kArtifactsFieldNumber,
+            [this, &request](const std::vector<int64>& ids,
+                             std::vector<Artifact>* artifacts) {
+              return metadata_access_object_->FindArtifactsById(
+                  ids, request.property_options(), artifacts);
+            },
+            serialized_response);
+      }));
+}
+
 tensorflow::Status MetadataStore::GetExecutionsByID(
     const GetExecutionsByIDRequest& request,
     GetExecutionsByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
         const std::vector<int64> ids(request.execution_ids().begin(),
                                      request.execution_ids().end());
         const absl::Status status =
-            metadata_access_object_->FindExecutionsById(ids, &executions);
+            metadata_access_object_->FindExecutionsById(
+                ids, request.property_options(), &executions);
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(executions, google::protobuf::RepeatedPtrFieldBackInserter(
+        absl::c_move(executions, google::protobuf::RepeatedPtrFieldBackInserter(
                                      response->mutable_executions()));
         return absl::OkStatus();
       }));
 }
 
+tensorflow::Status MetadataStore::GetSerializedExecutionsByID(
+    const GetExecutionsByIDRequest& request,
+    std::string* serialized_response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &serialized_response]() -> absl::Status {
+        serialized_response->clear();
+        return AppendSerializedNodesById<Execution>(
+            *metadata_access_object_,
+            std::vector<int64>(request.execution_ids().begin(),
+                               request.execution_ids().end()),
+            request.property_options(),
+            GetExecutionsByIDResponse::kExecutionsFieldNumber,
+            [this, &request](const std::vector<int64>& ids,
+                             std::vector<Execution>* executions) {
+              return metadata_access_object_->FindExecutionsById(
+                  ids, request.property_options(), executions);
+            },
+            serialized_response);
+      }));
+}
+
 tensorflow::Status MetadataStore::GetContextsByID(
     const GetContextsByIDRequest& request, GetContextsByIDResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
         const std::vector<int64> ids(request.context_ids().begin(),
                                      request.context_ids().end());
         const absl::Status status =
-            metadata_access_object_->FindContextsById(ids, &contexts);
+            metadata_access_object_->FindContextsById(
+                ids, request.property_options(), &contexts);
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(contexts, google::protobuf::RepeatedFieldBackInserter(
+        absl::c_move(contexts, google::protobuf::RepeatedPtrFieldBackInserter(
                                    response->mutable_contexts()));
         return absl::OkStatus();
       }));
 }
 
+tensorflow::Status MetadataStore::GetSerializedContextsByID(
+    const GetContextsByIDRequest& request, std::string* serialized_response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &serialized_response]() -> absl::Status {
+        serialized_response->clear();
+        return AppendSerializedNodesById<Context>(
+            *metadata_access_object_,
+            std::vector<int64>(request.context_ids().begin(),
+                               request.context_ids().end()),
+            request.property_options(),
+            GetContextsByIDResponse::kContextsFieldNumber,
+            [this, &request](const std::vector<int64>& ids,
+                             std::vector<Context>* contexts) {
+              return metadata_access_object_->FindContextsById(
+                  ids, request.property_options(), contexts);
+            },
+            serialized_response);
+      }));
+}
+
 tensorflow::Status MetadataStore::PutArtifacts(
     const PutArtifactsRequest& request, PutArtifactsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute([this, &request,
-                                                        &response]()
-                                                           -> absl::Status {
+  const auto put_artifacts = [this, &request, &response]() -> absl::Status {
     response->Clear();
-    for (const Artifact& artifact : request.artifacts()) {
-      int64 artifact_id = -1;
-      // Verify the latest_updated_time before upserting the artifact.
-      if (artifact.has_id() &&
-          request.options().abort_if_latest_updated_time_changed()) {
-        Artifact existing_artifact;
-        absl::Status status;
-        {
-          std::vector<Artifact> artifacts;
-          status = metadata_access_object_->FindArtifactsById({artifact.id()},
-                                                              &artifacts);
-          if (status.ok()) {
-            existing_artifact = artifacts.at(0);
-          }
-        }
-        if (!absl::IsNotFound(status)) {
-          MLMD_RETURN_IF_ERROR(status);
-          if (artifact.last_update_time_since_epoch() !=
-              existing_artifact.last_update_time_since_epoch()) {
-            return absl::FailedPreconditionError(absl::StrCat(
-                "`abort_if_latest_updated_time_changed` is set, and the stored "
-                "artifact with id = ",
-                artifact.id(),
-                " has a different last_update_time_since_epoch: ",
-                existing_artifact.last_update_time_since_epoch(),
-                " from the one in the given artifact: ",
-                artifact.last_update_time_since_epoch()));
-          }
-          // If set the option and all check succeeds, we make sure the
-          // timestamp after the update increases.
-          absl::SleepFor(absl::Milliseconds(1));
-        }
+    const auto update_artifacts =
+        [&](absl::Span<const Artifact> artifacts) -> absl::Status {
+      // The latest_updated_time is verified by the UPDATE of each artifact.
+      if (request.options().abort_if_latest_updated_time_changed()) {
+        return metadata_access_object_->UpdateArtifactsIfUnchanged(artifacts);
       }
-      MLMD_RETURN_IF_ERROR(UpsertArtifact(
-          artifact, metadata_access_object_.get(), &artifact_id));
-      response->add_artifact_ids(artifact_id);
-    }
-    return absl::OkStatus();
-  }));
+      return metadata_access_object_->UpdateArtifacts(artifacts);
+    };
+    return UpsertNodes<Artifact>(
+        request.artifacts(), update_artifacts,
+        [this](absl::Span<const Artifact> artifacts,
+               std::vector<int64>* artifact_ids) {
+          return metadata_access_object_->CreateArtifacts(artifacts,
+                                                          artifact_ids);
+        },
+        response->mutable_artifact_ids());
+  };
+  return FromABSLStatus(ExecuteNodeChangingTransaction(
+      [this, &request, &response, &put_artifacts]() -> absl::Status {
+        return RunIdempotently(request, request.idempotency_key(), response,
+                               put_artifacts);
+      }));
 }
 
 tensorflow::Status MetadataStore::PutExecutions(
     const PutExecutionsRequest& request, PutExecutionsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
-        response->Clear();
-        for (const Execution& execution : request.executions()) {
-          int64 execution_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertExecution(
-              execution, metadata_access_object_.get(), &execution_id));
-          response->add_execution_ids(execution_id);
-        }
-        return absl::OkStatus();
+  const auto put_executions = [this, &request, &response]() -> absl::Status {
+    response->Clear();
+    return UpsertNodes<Execution>(
+        request.executions(),
+        [this, &request](absl::Span<const Execution> executions) {
+          if (request.options().abort_if_latest_updated_time_changed()) {
+            return metadata_access_object_->UpdateExecutionsIfUnchanged(
+                executions);
+          }
+          return metadata_access_object_->UpdateExecutions(executions);
+        },
+        [this](absl::Span<const Execution> executions,
+               std::vector<int64>* execution_ids) {
+          return metadata_access_object_->CreateExecutions(executions,
+                                                           execution_ids);
+        },
+        response->mutable_execution_ids());
+  };
+  return FromABSLStatus(ExecuteNodeChangingTransaction(
+      [this, &request, &response, &put_executions]() -> absl::Status {
+        return RunIdempotently(request, request.idempotency_key(), response,
+                               put_executions);
       }));
 }
 
 tensorflow::Status MetadataStore::PutContexts(const PutContextsRequest& request,
                                               PutContextsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
-        response->Clear();
-        for (const Context& context : request.contexts()) {
-          int64 context_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertContext(
-              context, metadata_access_object_.get(), &context_id));
-          response->add_context_ids(context_id);
-        }
-        return absl::OkStatus();
+  const auto put_contexts = [this, &request, &response]() -> absl::Status {
+    response->Clear();
+    return UpsertNodes<Context>(
+        request.contexts(),
+        [this, &request](absl::Span<const Context> contexts) {
+          if (request.options().abort_if_latest_updated_time_changed()) {
+            return metadata_access_object_->UpdateContextsIfUnchanged(
+                contexts);
+          }
+          return metadata_access_object_->UpdateContexts(contexts);
+        },
+        [this](absl::Span<const Context> contexts,
+               std::vector<int64>* context_ids) {
+          return metadata_access_object_->CreateContexts(contexts,
+                                                         context_ids);
+        },
+        response->mutable_context_ids());
+  };
+  return FromABSLStatus(ExecuteNodeChangingTransaction(
+      [this, &request, &response, &put_contexts]() -> absl::Status {
+        return RunIdempotently(request, request.idempotency_key(), response,
+                               put_contexts);
       }));
 }
 
@@ -672,16 +1792,97 @@ tensorflow::Status MetadataStore::Create(
     unique_ptr<MetadataSource> metadata_source,
     unique_ptr<TransactionExecutor> transaction_executor,
     unique_ptr<MetadataStore>* result) {
+  return Create(query_config, migration_options, std::move(metadata_source),
+                std::move(transaction_executor), /*type_cache=*/nullptr,
+                result);
+}
+
+tensorflow::Status MetadataStore::Create(
+    const MetadataSourceQueryConfig& query_config,
+    const MigrationOptions& migration_options,
+    unique_ptr<MetadataSource> metadata_source,
+    unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, unique_ptr<MetadataStore>* result) {
+  return Create(query_config, migration_options, std::move(metadata_source),
+                std::move(transaction_executor), type_cache,
+                /*node_cache=*/nullptr, result);
+}
+
+tensorflow::Status MetadataStore::Create(
+    const MetadataSourceQueryConfig& query_config,
+    const MigrationOptions& migration_options,
+    unique_ptr<MetadataSource> metadata_source,
+    unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, NodeCache* node_cache,
+    unique_ptr<MetadataStore>* result) {
   unique_ptr<MetadataAccessObject> metadata_access_object;
   TF_RETURN_IF_ERROR(FromABSLStatus(CreateMetadataAccessObject(
-      query_config, metadata_source.get(), &metadata_access_object)));
+      query_config, metadata_source.get(), /*schema_version=*/absl::nullopt,
+      type_cache, node_cache, &metadata_access_object)));
+  std::vector<unique_ptr<MetadataSource>> metadata_sources;
+  metadata_sources.push_back(std::move(metadata_source));
+  return Create(migration_options, std::move(metadata_sources),
+                std::move(metadata_access_object),
+                std::move(transaction_executor), type_cache, node_cache,
+                result);
+}
+
+tensorflow::Status MetadataStore::CreateSharded(
+    const MetadataSourceQueryConfig& query_config,
+    const MigrationOptions& migration_options,
+    std::vector<unique_ptr<MetadataSource>> shard_sources,
+    unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, unique_ptr<MetadataStore>* result) {
+  if (shard_sources.empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "A sharded store needs at least one shard.");
+  }
+  std::vector<unique_ptr<MetadataAccessObject>> shards;
+  for (int i = 0; i < shard_sources.size(); i++) {
+    unique_ptr<MetadataAccessObject> shard;
+    // The types are read from the first shard only, so only it uses the
+    // cache.
+    TF_RETURN_IF_ERROR(FromABSLStatus(CreateMetadataAccessObject(
+        query_config, shard_sources[i].get(), /*schema_version=*/absl::nullopt,
+        i == 0 ? type_cache : nullptr, &shard)));
+    shards.push_back(std::move(shard));
+  }
+  return Create(migration_options, std::move(shard_sources),
+                absl::make_unique<ShardedMetadataAccessObject>(
+                    std::move(shards)),
+                std::move(transaction_executor), type_cache,
+                /*node_cache=*/nullptr, result);
+}
+
+tensorflow::Status MetadataStore::Create(
+    const MigrationOptions& migration_options,
+    std::vector<unique_ptr<MetadataSource>> metadata_sources,
+    unique_ptr<MetadataAccessObject> metadata_access_object,
+    unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, NodeCache* node_cache,
+    unique_ptr<MetadataStore>* result) {
   // if downgrade migration is specified
   if (migration_options.downgrade_to_schema_version() >= 0) {
-    TF_RETURN_IF_ERROR(FromABSLStatus(transaction_executor->Execute(
-        [&migration_options, &metadata_access_object]() -> absl::Status {
-          return metadata_access_object->DowngradeMetadataSource(
-              migration_options.downgrade_to_schema_version());
-        })));
+    if (migration_options.has_online_migration()) {
+      const absl::Status status = MigrateSchemaOnline(
+          migration_options.downgrade_to_schema_version(),
+          migration_options.online_migration(),
+          /*progress_callback=*/nullptr, metadata_access_object.get(),
+          transaction_executor.get());
+      if (absl::IsNotFound(status)) {
+        return tensorflow::errors::InvalidArgument(
+            "Empty database is given. Downgrade operation is not needed.");
+      }
+      TF_RETURN_IF_ERROR(FromABSLStatus(status));
+    } else {
+      TF_RETURN_IF_ERROR(FromABSLStatus(transaction_executor->Execute(
+          [&migration_options, &metadata_access_object]() -> absl::Status {
+            return metadata_access_object->DowngradeMetadataSource(
+                migration_options.downgrade_to_schema_version());
+          })));
+    }
+    if (type_cache != nullptr) type_cache->Invalidate();
+    if (node_cache != nullptr) node_cache->Clear();
     return tensorflow::errors::Cancelled(
         "Downgrade migration was performed. Connection to the downgraded "
         "database is Cancelled. Now the database is at schema version ",
@@ -690,107 +1891,178 @@ tensorflow::Status MetadataStore::Create(
         "library to connect to the metadata store.");
   }
   *result = absl::WrapUnique(new MetadataStore(
-      std::move(metadata_source), std::move(metadata_access_object),
-      std::move(transaction_executor)));
+      std::move(metadata_sources), std::move(metadata_access_object),
+      std::move(transaction_executor), type_cache, node_cache));
   return tensorflow::Status::OK();
 }
 
+absl::Status MetadataStore::PutEventsInTransaction(
+    const PutEventsRequest& request, PutEventsResponse* response) {
+  return RunIdempotently(
+      request, request.idempotency_key(), response,
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        const std::vector<Event> events(request.events().begin(),
+                                        request.events().end());
+        std::vector<int64> dummy_event_ids;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CreateEvents(events, &dummy_event_ids));
+        if (!lineage_closure_enabled_) return absl::OkStatus();
+        absl::flat_hash_set<int64> execution_ids;
+        for (const Event& event : events) {
+          execution_ids.insert(event.execution_id());
+        }
+        return UpdateLineageClosure(std::vector<int64>(execution_ids.begin(),
+                                                       execution_ids.end()),
+                                    metadata_access_object_.get());
+      });
+}
+
 tensorflow::Status MetadataStore::PutEvents(const PutEventsRequest& request,
                                             PutEventsResponse* response) {
   return FromABSLStatus(transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
-        response->Clear();
-        for (const Event& event : request.events()) {
-          int64 dummy_event_id = -1;
-          MLMD_RETURN_IF_ERROR(
-              metadata_access_object_->CreateEvent(event, &dummy_event_id));
-        }
-        return absl::OkStatus();
+        return PutEventsInTransaction(request, response);
       }));
 }
 
-tensorflow::Status MetadataStore::PutExecution(
+absl::Status MetadataStore::PutExecutionInTransaction(
     const PutExecutionRequest& request, PutExecutionResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute([this, &request,
-                                                        &response]()
-                                                           -> absl::Status {
-    response->Clear();
-    if (!request.has_execution()) {
-      return absl::InvalidArgumentError(
-          absl::StrCat("No execution is found: ", request.DebugString()));
-    }
-    // 1. Upsert Execution
-    const Execution& execution = request.execution();
-    int64 execution_id = -1;
-    MLMD_RETURN_IF_ERROR(UpsertExecution(
-        execution, metadata_access_object_.get(), &execution_id));
-    response->set_execution_id(execution_id);
-    // 2. Upsert Artifacts and insert events
-    for (PutExecutionRequest::ArtifactAndEvent artifact_and_event :
-         request.artifact_event_pairs()) {
-      // validate execution and event if given
-      if (artifact_and_event.has_event()) {
-        Event* event = artifact_and_event.mutable_event();
-        if (event->has_execution_id() &&
-            (!execution.has_id() || execution.id() != event->execution_id())) {
-          return absl::InvalidArgumentError(absl::StrCat(
-              "Request's event.execution_id does not match with the given "
-              "execution: ",
-              request.DebugString()));
-        }
-        event->set_execution_id(execution_id);
-      }
-      int64 artifact_id = -1;
-      MLMD_RETURN_IF_ERROR(UpsertArtifactAndEvent(
-          artifact_and_event, metadata_access_object_.get(), &artifact_id));
-      response->add_artifact_ids(artifact_id);
-    }
-    // 3. Upsert contexts and insert associations and attributions.
-    for (const Context& context : request.contexts()) {
-      int64 context_id = -1;
-      // Try to reuse existing context if the options is set.
-      if (request.options().reuse_context_if_already_exist() &&
-          !context.has_id()) {
-        Context existing_context;
-        const absl::Status status =
-            metadata_access_object_->FindContextByTypeIdAndContextName(
-                context.type_id(), context.name(), &existing_context);
-        if (!absl::IsNotFound(status)) {
-          MLMD_RETURN_IF_ERROR(status);
-          context_id = existing_context.id();
+  return RunIdempotently(
+      request, request.idempotency_key(), response,
+      [this, &request, &response]() -> absl::Status {
+        // The new nodes are placed with the first context, e.g., on the shard
+        // of the pipeline, so that the events and links of the execution stay
+        // together.
+        if (!request.contexts().empty()) {
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->SetPlacementHint(request.contexts(0)));
         }
-      }
-      if (context_id == -1) {
         const absl::Status status =
-            UpsertContext(context, metadata_access_object_.get(), &context_id);
-        // When `reuse_context_if_already_exist`, there are concurrent timelines
-        // to create the same new context. If use the option, let client side
-        // to retry the failed transaction safely.
-        if (request.options().reuse_context_if_already_exist() &&
-            absl::IsAlreadyExists(status)) {
-          return absl::AbortedError(absl::StrCat(
-              "Concurrent creation of the same context at the first time. "
-              "Retry the transaction to reuse the context: ",
-              context.DebugString()));
-        }
-        MLMD_RETURN_IF_ERROR(status);
-      }
-      response->add_context_ids(context_id);
-      MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-          context_id, response->execution_id(), metadata_access_object_.get()));
-      for (const int64 artifact_id : response->artifact_ids()) {
-        MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-            context_id, artifact_id, metadata_access_object_.get()));
+            PutExecutionNodesInTransaction(request, response);
+        metadata_access_object_->ClearPlacementHint();
+        return status;
+      });
+}
+
+absl::Status MetadataStore::PutExecutionNodesInTransaction(
+    const PutExecutionRequest& request, PutExecutionResponse* response) {
+  response->Clear();
+  if (!request.has_execution()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("No execution is found: ", request.DebugString()));
+  }
+  // 1. Upsert Execution
+  const Execution& execution = request.execution();
+  int64 execution_id = -1;
+  MLMD_RETURN_IF_ERROR(UpsertExecution(
+      execution, metadata_access_object_.get(), &execution_id));
+  response->set_execution_id(execution_id);
+  // 2. Upsert Artifacts and insert events
+  std::vector<Event> events;
+  events.reserve(request.artifact_event_pairs_size());
+  for (const PutExecutionRequest::ArtifactAndEvent& artifact_and_event :
+       request.artifact_event_pairs()) {
+    // validate execution and event if given
+    if (artifact_and_event.has_event()) {
+      const Event& event = artifact_and_event.event();
+      if (event.has_execution_id() &&
+          (!execution.has_id() || execution.id() != event.execution_id())) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Request's event.execution_id does not match with the given "
+            "execution: ",
+            request.DebugString()));
       }
     }
-    return absl::OkStatus();
-  }));
+    int64 artifact_id = -1;
+    MLMD_RETURN_IF_ERROR(UpsertArtifactAndEvent(
+        artifact_and_event, execution_id, metadata_access_object_.get(),
+        &artifact_id, &events));
+    response->add_artifact_ids(artifact_id);
+  }
+  std::vector<int64> dummy_event_ids;
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object_->CreateEvents(events, &dummy_event_ids));
+  if (lineage_closure_enabled_ && !events.empty()) {
+    MLMD_RETURN_IF_ERROR(
+        UpdateLineageClosure({execution_id}, metadata_access_object_.get()));
+  }
+  // 3. Upsert contexts and insert associations and attributions.
+  std::vector<Association> associations;
+  std::vector<Attribution> attributions;
+  for (const Context& context : request.contexts()) {
+    int64 context_id = -1;
+    // Reuse the existing context if the option is set. The context is created
+    // atomically, so that concurrent writers of the same new context reuse it
+    // instead of failing their transactions.
+    if (request.options().reuse_context_if_already_exist() &&
+        !context.has_id()) {
+      bool unused_created;
+      MLMD_RETURN_IF_ERROR(metadata_access_object_->CreateContextIfNotExist(
+          context, &context_id, &unused_created));
+    } else {
+      MLMD_RETURN_IF_ERROR(
+          UpsertContext(context, metadata_access_object_.get(), &context_id));
+    }
+    response->add_context_ids(context_id);
+    Association association;
+    association.set_context_id(context_id);
+    association.set_execution_id(response->execution_id());
+    associations.push_back(association);
+    for (const int64 artifact_id : response->artifact_ids()) {
+      Attribution attribution;
+      attribution.set_context_id(context_id);
+      attribution.set_artifact_id(artifact_id);
+      attributions.push_back(attribution);
+    }
+  }
+  // The links are created in bulk, and the existing ones are skipped.
+  return CreateEdgesInTransaction(attributions, associations);
+}
+
+tensorflow::Status MetadataStore::PutExecution(
+    const PutExecutionRequest& request, PutExecutionResponse* response) {
+  return FromABSLStatus(ExecuteNodeChangingTransaction(
+      [this, &request, &response]() -> absl::Status {
+        return PutExecutionInTransaction(request, response);
+      }));
+}
+
+tensorflow::Status MetadataStore::PutInBatch(std::vector<BatchedPut>* batch) {
+  std::vector<std::function<absl::Status()>> txn_bodies;
+  txn_bodies.reserve(batch->size());
+  for (const BatchedPut& put : *batch) {
+    if (put.put_execution_request != nullptr) {
+      txn_bodies.push_back([this, &put]() -> absl::Status {
+        return PutExecutionInTransaction(*put.put_execution_request,
+                                         put.put_execution_response);
+      });
+    } else {
+      txn_bodies.push_back([this, &put]() -> absl::Status {
+        return PutEventsInTransaction(*put.put_events_request,
+                                      put.put_events_response);
+      });
+    }
+  }
+  std::vector<absl::Status> txn_body_statuses;
+  const absl::Status status = RunNodeChangingTransactions([&]() {
+    return transaction_executor_->ExecuteBatch(txn_bodies, &txn_body_statuses);
+  });
+  // The edges of the batch are not known, as each of its puts may have been
+  // rolled back on its own.
+  pending_attributions_.clear();
+  pending_associations_.clear();
+  TF_RETURN_IF_ERROR(FromABSLStatus(status));
+  for (int i = 0; i < batch->size(); i++) {
+    (*batch)[i].status = FromABSLStatus(txn_body_statuses[i]);
+  }
+  return tensorflow::Status::OK();
 }
 
 tensorflow::Status MetadataStore::GetEventsByExecutionIDs(
     const GetEventsByExecutionIDsRequest& request,
     GetEventsByExecutionIDsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Event> events;
@@ -798,14 +2070,14 @@ tensorflow::Status MetadataStore::GetEventsByExecutionIDs(
             metadata_access_object_->FindEventsByExecutions(
                 std::vector<int64>(request.execution_ids().begin(),
                                    request.execution_ids().end()),
-                &events);
+                GetEventTypes(request.types()), &events);
         if (absl::IsNotFound(status)) {
           return absl::OkStatus();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Event& event : events) {
-          *response->mutable_events()->Add() = event;
+        for (Event& event : events) {
+          *response->mutable_events()->Add() = std::move(event);
         }
         return absl::OkStatus();
       }));
@@ -814,7 +2086,7 @@ tensorflow::Status MetadataStore::GetEventsByExecutionIDs(
 tensorflow::Status MetadataStore::GetEventsByArtifactIDs(
     const GetEventsByArtifactIDsRequest& request,
     GetEventsByArtifactIDsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Event> events;
@@ -822,14 +2094,14 @@ tensorflow::Status MetadataStore::GetEventsByArtifactIDs(
             metadata_access_object_->FindEventsByArtifacts(
                 std::vector<int64>(request.artifact_ids().begin(),
                                    request.artifact_ids().end()),
-                &events);
+                GetEventTypes(request.types()), &events);
         if (absl::IsNotFound(status)) {
           return absl::OkStatus();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Event& event : events) {
-          *response->mutable_events()->Add() = event;
+        for (Event& event : events) {
+          *response->mutable_events()->Add() = std::move(event);
         }
         return absl::OkStatus();
       }));
@@ -837,7 +2109,7 @@ tensorflow::Status MetadataStore::GetEventsByArtifactIDs(
 
 tensorflow::Status MetadataStore::GetExecutions(
     const GetExecutionsRequest& request, GetExecutionsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
@@ -845,9 +2117,19 @@ tensorflow::Status MetadataStore::GetExecutions(
         std::string next_page_token;
         if (request.has_options()) {
           status = metadata_access_object_->ListExecutions(
-              request.options(), &executions, &next_page_token);
+              request.options(), request.property_options(), &executions,
+              &next_page_token);
         } else {
-          status = metadata_access_object_->FindExecutions(&executions);
+          // Appends the executions batch by batch, so that they are not
+          // buffered besides the response.
+          status = metadata_access_object_->FindExecutions(
+              request.property_options(),
+              [response](absl::Span<const Execution> batch) {
+                for (const Execution& execution : batch) {
+                  *response->add_executions() = execution;
+                }
+                return absl::OkStatus();
+              });
         }
 
         if (absl::IsNotFound(status)) {
@@ -856,8 +2138,8 @@ tensorflow::Status MetadataStore::GetExecutions(
           return status;
         }
 
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
 
         if (!next_page_token.empty()) {
@@ -869,7 +2151,7 @@ tensorflow::Status MetadataStore::GetExecutions(
 
 tensorflow::Status MetadataStore::GetArtifacts(
     const GetArtifactsRequest& request, GetArtifactsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
@@ -877,9 +2159,19 @@ tensorflow::Status MetadataStore::GetArtifacts(
         std::string next_page_token;
         if (request.has_options()) {
           status = metadata_access_object_->ListArtifacts(
-              request.options(), &artifacts, &next_page_token);
+              request.options(), request.property_options(), &artifacts,
+              &next_page_token);
         } else {
-          status = metadata_access_object_->FindArtifacts(&artifacts);
+          // Appends the artifacts batch by batch, so that they are not
+          // buffered besides the response.
+          status = metadata_access_object_->FindArtifacts(
+              request.property_options(),
+              [response](absl::Span<const Artifact> batch) {
+                for (const Artifact& artifact : batch) {
+                  *response->add_artifacts() = artifact;
+                }
+                return absl::OkStatus();
+              });
         }
 
         if (absl::IsNotFound(status)) {
@@ -888,8 +2180,8 @@ tensorflow::Status MetadataStore::GetArtifacts(
           return status;
         }
 
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
 
         if (!next_page_token.empty()) {
@@ -902,7 +2194,7 @@ tensorflow::Status MetadataStore::GetArtifacts(
 
 tensorflow::Status MetadataStore::GetContexts(const GetContextsRequest& request,
                                               GetContextsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
@@ -910,9 +2202,19 @@ tensorflow::Status MetadataStore::GetContexts(const GetContextsRequest& request,
         std::string next_page_token;
         if (request.has_options()) {
           status = metadata_access_object_->ListContexts(
-              request.options(), &contexts, &next_page_token);
+              request.options(), request.property_options(), &contexts,
+              &next_page_token);
         } else {
-          status = metadata_access_object_->FindContexts(&contexts);
+          // Appends the contexts batch by batch, so that they are not
+          // buffered besides the response.
+          status = metadata_access_object_->FindContexts(
+              request.property_options(),
+              [response](absl::Span<const Context> batch) {
+                for (const Context& context : batch) {
+                  *response->add_contexts() = context;
+                }
+                return absl::OkStatus();
+              });
         }
 
         if (absl::IsNotFound(status)) {
@@ -921,8 +2223,8 @@ tensorflow::Status MetadataStore::GetContexts(const GetContextsRequest& request,
           return status;
         }
 
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
 
         if (!next_page_token.empty()) {
@@ -933,11 +2235,149 @@ tensorflow::Status MetadataStore::GetContexts(const GetContextsRequest& request,
       }));
 }
 
+tensorflow::Status MetadataStore::StreamArtifacts(
+    const StreamArtifactsRequest& request,
+    const std::function<tensorflow::Status(const StreamArtifactsResponse&)>&
+        callback) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &callback]() -> absl::Status {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [this](const NodeBatchCallback<Artifact>& batch_callback) {
+              return metadata_access_object_->FindArtifacts(batch_callback);
+            },
+            &StreamArtifactsResponse::mutable_artifacts, callback);
+      }));
+}
+
+tensorflow::Status MetadataStore::StreamExecutions(
+    const StreamExecutionsRequest& request,
+    const std::function<tensorflow::Status(const StreamExecutionsResponse&)>&
+        callback) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &callback]() -> absl::Status {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [this](const NodeBatchCallback<Execution>& batch_callback) {
+              return metadata_access_object_->FindExecutions(batch_callback);
+            },
+            &StreamExecutionsResponse::mutable_executions, callback);
+      }));
+}
+
+tensorflow::Status MetadataStore::StreamContexts(
+    const StreamContextsRequest& request,
+    const std::function<tensorflow::Status(const StreamContextsResponse&)>&
+        callback) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &callback]() -> absl::Status {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [this](const NodeBatchCallback<Context>& batch_callback) {
+              return metadata_access_object_->FindContexts(batch_callback);
+            },
+            &StreamContextsResponse::mutable_contexts, callback);
+      }));
+}
+
+tensorflow::Status MetadataStore::StreamNodeColumns(
+    const StreamNodeColumnsRequest& request,
+    const std::function<tensorflow::Status(const StreamNodeColumnsResponse&)>&
+        callback) {
+  const PropertyOptions& property_options = request.property_options();
+  switch (request.node_kind()) {
+    case WatchChangesRequest::ARTIFACT:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodeColumnsInChunks<Artifact>(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Artifact>& batch_callback) {
+              return metadata_access_object_->FindArtifacts(property_options,
+                                                            batch_callback);
+            },
+            callback);
+      }));
+    case WatchChangesRequest::EXECUTION:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodeColumnsInChunks<Execution>(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Execution>& batch_callback) {
+              return metadata_access_object_->FindExecutions(property_options,
+                                                             batch_callback);
+            },
+            callback);
+      }));
+    case WatchChangesRequest::CONTEXT:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodeColumnsInChunks<Context>(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Context>& batch_callback) {
+              return metadata_access_object_->FindContexts(property_options,
+                                                           batch_callback);
+            },
+            callback);
+      }));
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "node_kind must be ARTIFACT, EXECUTION or CONTEXT: ",
+          request.DebugString());
+  }
+}
+
+tensorflow::Status MetadataStore::WatchChanges(
+    const WatchChangesRequest& request,
+    const std::function<tensorflow::Status(const WatchChangesResponse&)>&
+        callback) {
+  const int64 last_update_time_since_epoch =
+      request.watermark().last_update_time_since_epoch();
+  const int64 id = request.watermark().id();
+  const std::function<void(WatchChangesResponse&)> complete_chunk =
+      [](WatchChangesResponse& response) { SetChangeWatermark(response); };
+  switch (request.node_kind()) {
+    case WatchChangesRequest::ARTIFACT:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Artifact>& batch_callback) {
+              return metadata_access_object_->FindArtifactsUpdatedAfter(
+                  last_update_time_since_epoch, id, batch_callback);
+            },
+            &WatchChangesResponse::mutable_artifacts, callback,
+            complete_chunk);
+      }));
+    case WatchChangesRequest::EXECUTION:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Execution>& batch_callback) {
+              return metadata_access_object_->FindExecutionsUpdatedAfter(
+                  last_update_time_since_epoch, id, batch_callback);
+            },
+            &WatchChangesResponse::mutable_executions, callback,
+            complete_chunk);
+      }));
+    case WatchChangesRequest::CONTEXT:
+      return FromABSLStatus(transaction_executor_->ExecuteRead([&]() {
+        return StreamNodesInChunks(
+            request.max_chunk_size(),
+            [&](const NodeBatchCallback<Context>& batch_callback) {
+              return metadata_access_object_->FindContextsUpdatedAfter(
+                  last_update_time_since_epoch, id, batch_callback);
+            },
+            &WatchChangesResponse::mutable_contexts, callback,
+            complete_chunk);
+      }));
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "node_kind must be ARTIFACT, EXECUTION or CONTEXT: ",
+          request.DebugString());
+  }
+}
+
 tensorflow::Status MetadataStore::GetArtifactTypes(
     const GetArtifactTypesRequest& request,
     GetArtifactTypesResponse* response) {
   return FromABSLStatus(
-      transaction_executor_->Execute([this, &response]() -> absl::Status {
+      transaction_executor_->ExecuteRead([this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ArtifactType> artifact_types;
         const absl::Status status =
@@ -947,14 +2387,15 @@ tensorflow::Status MetadataStore::GetArtifactTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ArtifactType& artifact_type : artifact_types) {
+        for (ArtifactType& artifact_type : artifact_types) {
           // Simple types will not be returned by Get*Types APIs because they
           // are invisible to users.
           const bool is_simple_type =
               std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
                         artifact_type.name()) != kSimpleTypeNames.end();
           if (!is_simple_type) {
-            *response->mutable_artifact_types()->Add() = artifact_type;
+            *response->mutable_artifact_types()->Add() =
+                std::move(artifact_type);
           }
         }
         return absl::OkStatus();
@@ -965,7 +2406,7 @@ tensorflow::Status MetadataStore::GetExecutionTypes(
     const GetExecutionTypesRequest& request,
     GetExecutionTypesResponse* response) {
   return FromABSLStatus(
-      transaction_executor_->Execute([this, &response]() -> absl::Status {
+      transaction_executor_->ExecuteRead([this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ExecutionType> execution_types;
         const absl::Status status =
@@ -975,14 +2416,15 @@ tensorflow::Status MetadataStore::GetExecutionTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ExecutionType& execution_type : execution_types) {
+        for (ExecutionType& execution_type : execution_types) {
           // Simple types will not be returned by Get*Types APIs because they
           // are invisible to users.
           const bool is_simple_type =
               std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
                         execution_type.name()) != kSimpleTypeNames.end();
           if (!is_simple_type) {
-            *response->mutable_execution_types()->Add() = execution_type;
+            *response->mutable_execution_types()->Add() =
+                std::move(execution_type);
           }
         }
         return absl::OkStatus();
@@ -992,7 +2434,7 @@ tensorflow::Status MetadataStore::GetExecutionTypes(
 tensorflow::Status MetadataStore::GetContextTypes(
     const GetContextTypesRequest& request, GetContextTypesResponse* response) {
   return FromABSLStatus(
-      transaction_executor_->Execute([this, &response]() -> absl::Status {
+      transaction_executor_->ExecuteRead([this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ContextType> context_types;
         const absl::Status status =
@@ -1002,8 +2444,8 @@ tensorflow::Status MetadataStore::GetContextTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ContextType& context_type : context_types) {
-          *response->mutable_context_types()->Add() = context_type;
+        for (ContextType& context_type : context_types) {
+          *response->mutable_context_types()->Add() = std::move(context_type);
         }
         return absl::OkStatus();
       }));
@@ -1024,23 +2466,62 @@ tensorflow::Status MetadataStore::GetArtifactsByURI(
           request.DebugString());
     }
   }
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::flat_hash_set<std::string> uris(request.uris().begin(),
+                                              request.uris().end());
+        for (const std::string& uri : uris) {
+          std::vector<Artifact> artifacts;
+          const absl::Status status =
+              metadata_access_object_->FindArtifactsByURI(uri, &artifacts);
+          if (!status.ok() && !absl::IsNotFound(status)) {
+            // If any none NotFound error returned, we do early stopping as
+            // the query execution has internal db errors.
+            return status;
+          }
+          for (Artifact& artifact : artifacts) {
+            *response->mutable_artifacts()->Add() = std::move(artifact);
+          }
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetArtifactsByURIPrefix(
+    const GetArtifactsByURIPrefixRequest& request,
+    GetArtifactsByURIPrefixResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<Artifact> artifacts;
+        const absl::Status status =
+            metadata_access_object_->FindArtifactsByURIPrefix(
+                request.uri_prefix(), &artifacts);
+        if (!status.ok() && !absl::IsNotFound(status)) {
+          return status;
+        }
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::ArtifactsExist(
+    const ArtifactsExistRequest& request, ArtifactsExistResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        absl::flat_hash_set<std::string> uris(request.uris().begin(),
-                                              request.uris().end());
-        for (const std::string& uri : uris) {
-          std::vector<Artifact> artifacts;
-          const absl::Status status =
-              metadata_access_object_->FindArtifactsByURI(uri, &artifacts);
-          if (!status.ok() && !absl::IsNotFound(status)) {
-            // If any none NotFound error returned, we do early stopping as
-            // the query execution has internal db errors.
-            return status;
-          }
-          for (const Artifact& artifact : artifacts) {
-            *response->mutable_artifacts()->Add() = artifact;
-          }
+        const std::vector<int64> ids(request.artifact_ids().begin(),
+                                     request.artifact_ids().end());
+        std::vector<int64> existing_ids;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExistingArtifactIds(
+            ids, &existing_ids));
+        const absl::flat_hash_set<int64> existing_id_set(existing_ids.begin(),
+                                                         existing_ids.end());
+        for (const int64 artifact_id : request.artifact_ids()) {
+          response->add_exists(existing_id_set.contains(artifact_id));
         }
         return absl::OkStatus();
       }));
@@ -1049,7 +2530,7 @@ tensorflow::Status MetadataStore::GetArtifactsByURI(
 tensorflow::Status MetadataStore::GetArtifactsByType(
     const GetArtifactsByTypeRequest& request,
     GetArtifactsByTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ArtifactType artifact_type;
@@ -1063,23 +2544,45 @@ tensorflow::Status MetadataStore::GetArtifactsByType(
         }
         std::vector<Artifact> artifacts;
         status = metadata_access_object_->FindArtifactsByTypeId(
-            artifact_type.id(), &artifacts);
+            artifact_type.id(), request.property_options(), &artifacts);
         if (absl::IsNotFound(status)) {
           return absl::OkStatus();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
         return absl::OkStatus();
       }));
 }
 
+tensorflow::Status MetadataStore::GetArtifactIdsByType(
+    const GetArtifactsByTypeRequest& request,
+    std::vector<int64>* artifact_ids) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, artifact_ids]() -> absl::Status {
+        artifact_ids->clear();
+        ArtifactType artifact_type;
+        absl::Status status = metadata_access_object_->FindTypeByNameAndVersion(
+            request.type_name(), GetRequestTypeVersion(request),
+            &artifact_type);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactIdsByTypeId(
+            artifact_type.id(), artifact_ids));
+        std::sort(artifact_ids->begin(), artifact_ids->end());
+        return absl::OkStatus();
+      }));
+}
+
 tensorflow::Status MetadataStore::GetArtifactByTypeAndName(
     const GetArtifactByTypeAndNameRequest& request,
     GetArtifactByTypeAndNameResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ArtifactType artifact_type;
@@ -1104,10 +2607,38 @@ tensorflow::Status MetadataStore::GetArtifactByTypeAndName(
       }));
 }
 
+tensorflow::Status MetadataStore::GetArtifactsByTypeAndNames(
+    const GetArtifactsByTypeAndNamesRequest& request,
+    GetArtifactsByTypeAndNamesResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        ArtifactType artifact_type;
+        const absl::Status status =
+            metadata_access_object_->FindTypeByNameAndVersion(
+                request.type_name(), GetRequestTypeVersion(request),
+                &artifact_type);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        const std::vector<std::string> names(
+            request.artifact_names().begin(), request.artifact_names().end());
+        std::vector<Artifact> artifacts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->FindArtifactsByTypeIdAndArtifactNames(
+                artifact_type.id(), names, &artifacts));
+        absl::c_move(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
+                                    response->mutable_artifacts()));
+        return absl::OkStatus();
+      }));
+}
+
 tensorflow::Status MetadataStore::GetExecutionsByType(
     const GetExecutionsByTypeRequest& request,
     GetExecutionsByTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ExecutionType execution_type;
@@ -1121,14 +2652,14 @@ tensorflow::Status MetadataStore::GetExecutionsByType(
         }
         std::vector<Execution> executions;
         status = metadata_access_object_->FindExecutionsByTypeId(
-            execution_type.id(), &executions);
+            execution_type.id(), request.property_options(), &executions);
         if (absl::IsNotFound(status)) {
           return absl::OkStatus();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
         return absl::OkStatus();
       }));
@@ -1137,7 +2668,7 @@ tensorflow::Status MetadataStore::GetExecutionsByType(
 tensorflow::Status MetadataStore::GetExecutionByTypeAndName(
     const GetExecutionByTypeAndNameRequest& request,
     GetExecutionByTypeAndNameResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ExecutionType execution_type;
@@ -1162,10 +2693,38 @@ tensorflow::Status MetadataStore::GetExecutionByTypeAndName(
       }));
 }
 
+tensorflow::Status MetadataStore::GetExecutionsByTypeAndNames(
+    const GetExecutionsByTypeAndNamesRequest& request,
+    GetExecutionsByTypeAndNamesResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        ExecutionType execution_type;
+        const absl::Status status =
+            metadata_access_object_->FindTypeByNameAndVersion(
+                request.type_name(), GetRequestTypeVersion(request),
+                &execution_type);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        const std::vector<std::string> names(
+            request.execution_names().begin(), request.execution_names().end());
+        std::vector<Execution> executions;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->FindExecutionsByTypeIdAndExecutionNames(
+                execution_type.id(), names, &executions));
+        absl::c_move(executions, google::protobuf::RepeatedPtrFieldBackInserter(
+                                     response->mutable_executions()));
+        return absl::OkStatus();
+      }));
+}
+
 tensorflow::Status MetadataStore::GetContextsByType(
     const GetContextsByTypeRequest& request,
     GetContextsByTypeResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ContextType context_type;
@@ -1188,15 +2747,15 @@ tensorflow::Status MetadataStore::GetContextsByType(
               context_type.id(),
               (request.has_options() ? absl::make_optional(request.options())
                                      : absl::nullopt),
-              &contexts, &next_page_token);
+              request.property_options(), &contexts, &next_page_token);
           if (absl::IsNotFound(status)) {
             return absl::OkStatus();
           } else if (!status.ok()) {
             return status;
           }
         }
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
         if (request.has_options()) {
           response->set_next_page_token(next_page_token);
@@ -1205,10 +2764,132 @@ tensorflow::Status MetadataStore::GetContextsByType(
       }));
 }
 
+tensorflow::Status MetadataStore::CountArtifacts(
+    const CountArtifactsRequest& request, CountArtifactsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::optional<int64> type_id;
+        const absl::Status status = FindOptionalRequestTypeId<ArtifactType>(
+            request, metadata_access_object_.get(), &type_id);
+        if (absl::IsNotFound(status)) {
+          response->set_count(0);
+          return absl::OkStatus();
+        }
+        MLMD_RETURN_IF_ERROR(status);
+        int64 count = 0;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->CountArtifacts(
+            type_id,
+            request.has_state() ? absl::make_optional(request.state())
+                                : absl::nullopt,
+            &count));
+        response->set_count(count);
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::CountExecutions(
+    const CountExecutionsRequest& request, CountExecutionsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::optional<int64> type_id;
+        const absl::Status status = FindOptionalRequestTypeId<ExecutionType>(
+            request, metadata_access_object_.get(), &type_id);
+        if (absl::IsNotFound(status)) {
+          response->set_count(0);
+          return absl::OkStatus();
+        }
+        MLMD_RETURN_IF_ERROR(status);
+        int64 count = 0;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->CountExecutions(
+            type_id,
+            request.has_last_known_state()
+                ? absl::make_optional(request.last_known_state())
+                : absl::nullopt,
+            &count));
+        response->set_count(count);
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::CountContexts(
+    const CountContextsRequest& request, CountContextsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::optional<int64> type_id;
+        const absl::Status status = FindOptionalRequestTypeId<ContextType>(
+            request, metadata_access_object_.get(), &type_id);
+        if (absl::IsNotFound(status)) {
+          response->set_count(0);
+          return absl::OkStatus();
+        }
+        MLMD_RETURN_IF_ERROR(status);
+        int64 count = 0;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CountContexts(type_id, &count));
+        response->set_count(count);
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::AggregateProperty(
+    const AggregatePropertyRequest& request,
+    AggregatePropertyResponse* response) {
+  if (request.node_kind() != AggregatePropertyRequest::ARTIFACT &&
+      request.node_kind() != AggregatePropertyRequest::EXECUTION) {
+    return tensorflow::errors::InvalidArgument(
+        "The node_kind should be either ARTIFACT or EXECUTION: ",
+        request.DebugString());
+  }
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<PropertyAggregate> aggregates;
+        if (request.node_kind() == AggregatePropertyRequest::ARTIFACT) {
+          ArtifactType artifact_type;
+          const absl::Status status =
+              metadata_access_object_->FindTypeByNameAndVersion(
+                  request.type_name(), GetRequestTypeVersion(request),
+                  &artifact_type);
+          if (absl::IsNotFound(status)) {
+            return absl::OkStatus();
+          }
+          MLMD_RETURN_IF_ERROR(status);
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->AggregateArtifactProperty(
+                  artifact_type.id(), request.options(), &aggregates));
+        } else {
+          ExecutionType execution_type;
+          const absl::Status status =
+              metadata_access_object_->FindTypeByNameAndVersion(
+                  request.type_name(), GetRequestTypeVersion(request),
+                  &execution_type);
+          if (absl::IsNotFound(status)) {
+            return absl::OkStatus();
+          }
+          MLMD_RETURN_IF_ERROR(status);
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->AggregateExecutionProperty(
+                  execution_type.id(), request.options(), &aggregates));
+        }
+        absl::c_sort(aggregates, [](const PropertyAggregate& a,
+                                    const PropertyAggregate& b) {
+          return std::make_pair(a.has_state(), a.state()) <
+                 std::make_pair(b.has_state(), b.state());
+        });
+        absl::c_move(aggregates,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_aggregates()));
+        return absl::OkStatus();
+      }));
+}
+
 tensorflow::Status MetadataStore::GetContextByTypeAndName(
     const GetContextByTypeAndNameRequest& request,
     GetContextByTypeAndNameResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         ContextType context_type;
@@ -1232,23 +2913,45 @@ tensorflow::Status MetadataStore::GetContextByTypeAndName(
       }));
 }
 
+tensorflow::Status MetadataStore::GetContextsByTypeAndNames(
+    const GetContextsByTypeAndNamesRequest& request,
+    GetContextsByTypeAndNamesResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        ContextType context_type;
+        const absl::Status status =
+            metadata_access_object_->FindTypeByNameAndVersion(
+                request.type_name(), GetRequestTypeVersion(request),
+                &context_type);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        const std::vector<std::string> names(
+            request.context_names().begin(), request.context_names().end());
+        std::vector<Context> contexts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->FindContextsByTypeIdAndContextNames(
+                context_type.id(), names, &contexts));
+        absl::c_move(contexts, google::protobuf::RepeatedPtrFieldBackInserter(
+                                   response->mutable_contexts()));
+        return absl::OkStatus();
+      }));
+}
+
 tensorflow::Status MetadataStore::PutAttributionsAndAssociations(
     const PutAttributionsAndAssociationsRequest& request,
     PutAttributionsAndAssociationsResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(ExecuteEdgeCreatingTransaction(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Attribution& attribution : request.attributions()) {
-          MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-              attribution.context_id(), attribution.artifact_id(),
-              metadata_access_object_.get()));
-        }
-        for (const Association& association : request.associations()) {
-          MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-              association.context_id(), association.execution_id(),
-              metadata_access_object_.get()));
-        }
-        return absl::OkStatus();
+        const std::vector<Attribution> attributions(
+            request.attributions().begin(), request.attributions().end());
+        const std::vector<Association> associations(
+            request.associations().begin(), request.associations().end());
+        return CreateEdgesInTransaction(attributions, associations);
       }));
 }
 
@@ -1258,25 +2961,108 @@ tensorflow::Status MetadataStore::PutParentContexts(
   return FromABSLStatus(transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const ParentContext& parent_context : request.parent_contexts()) {
-          MLMD_RETURN_IF_ERROR(
-              metadata_access_object_->CreateParentContext(parent_context));
-        }
-        return absl::OkStatus();
+        const std::vector<ParentContext> parent_contexts(
+            request.parent_contexts().begin(),
+            request.parent_contexts().end());
+        return metadata_access_object_->CreateParentContexts(parent_contexts);
       }));
 }
 
+tensorflow::Status MetadataStore::DeleteArtifacts(
+    const DeleteArtifactsRequest& request, DeleteArtifactsResponse* response) {
+  response->Clear();
+  const std::vector<int64> ids(request.artifact_ids().begin(),
+                               request.artifact_ids().end());
+  ForgetKnownEdges();
+  return FromABSLStatus(RunNodeChangingTransactions([&]() {
+    return DeleteInBatches(
+        ids, GetMaxDeleteBatchSize(request),
+        [this](absl::Span<const int64> artifact_ids) {
+          return metadata_access_object_->DeleteArtifactsById(artifact_ids);
+        },
+        transaction_executor_.get());
+  }));
+}
+
+tensorflow::Status MetadataStore::DeleteExecutions(
+    const DeleteExecutionsRequest& request,
+    DeleteExecutionsResponse* response) {
+  response->Clear();
+  const std::vector<int64> ids(request.execution_ids().begin(),
+                               request.execution_ids().end());
+  ForgetKnownEdges();
+  return FromABSLStatus(RunNodeChangingTransactions([&]() {
+    return DeleteInBatches(
+        ids, GetMaxDeleteBatchSize(request),
+        [this](absl::Span<const int64> execution_ids) {
+          return metadata_access_object_->DeleteExecutionsById(execution_ids);
+        },
+        transaction_executor_.get());
+  }));
+}
+
+tensorflow::Status MetadataStore::CollectGarbage(
+    const CollectGarbageRequest& request, CollectGarbageResponse* response) {
+  response->Clear();
+  const bool is_artifact =
+      request.node_kind() == CollectGarbageRequest::ARTIFACT;
+  if (!is_artifact && request.node_kind() != CollectGarbageRequest::EXECUTION) {
+    return tensorflow::errors::InvalidArgument(
+        "node_kind must be ARTIFACT or EXECUTION: ", request.DebugString());
+  }
+  if (!request.has_type_name()) {
+    return tensorflow::errors::InvalidArgument("type_name is required: ",
+                                               request.DebugString());
+  }
+  absl::optional<int64> type_id;
+  const absl::Status status = transaction_executor_->ExecuteRead([&]() {
+    return is_artifact ? FindOptionalRequestTypeId<ArtifactType>(
+                             request, metadata_access_object_.get(), &type_id)
+                       : FindOptionalRequestTypeId<ExecutionType>(
+                             request, metadata_access_object_.get(), &type_id);
+  });
+  if (absl::IsNotFound(status)) {
+    response->set_num_deleted(0);
+    return tensorflow::Status::OK();
+  }
+  if (!status.ok()) {
+    return FromABSLStatus(status);
+  }
+  const int64 updated_before = request.updated_before_time_since_epoch();
+  int64 num_deleted = 0;
+  ForgetKnownEdges();
+  const absl::Status delete_status = RunNodeChangingTransactions([&]() {
+    return DeleteFoundInBatches(
+        GetMaxDeleteBatchSize(request),
+        [&](int64 limit, std::vector<int64>* ids) {
+          return is_artifact
+                     ? metadata_access_object_->FindArtifactIdsUpdatedBefore(
+                           *type_id, updated_before, limit, ids)
+                     : metadata_access_object_->FindExecutionIdsUpdatedBefore(
+                           *type_id, updated_before, limit, ids);
+        },
+        [&](absl::Span<const int64> ids) {
+          return is_artifact
+                     ? metadata_access_object_->DeleteArtifactsById(ids)
+                     : metadata_access_object_->DeleteExecutionsById(ids);
+        },
+        transaction_executor_.get(), &num_deleted);
+  });
+  response->set_num_deleted(num_deleted);
+  return FromABSLStatus(delete_status);
+}
+
 tensorflow::Status MetadataStore::GetContextsByArtifact(
     const GetContextsByArtifactRequest& request,
     GetContextsByArtifactResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByArtifact(
             request.artifact_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
         return absl::OkStatus();
       }));
@@ -1285,14 +3071,14 @@ tensorflow::Status MetadataStore::GetContextsByArtifact(
 tensorflow::Status MetadataStore::GetContextsByExecution(
     const GetContextsByExecutionRequest& request,
     GetContextsByExecutionResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByExecution(
             request.execution_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
         return absl::OkStatus();
       }));
@@ -1301,7 +3087,7 @@ tensorflow::Status MetadataStore::GetContextsByExecution(
 tensorflow::Status MetadataStore::GetArtifactsByContext(
     const GetArtifactsByContextRequest& request,
     GetArtifactsByContextResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
@@ -1309,11 +3095,24 @@ tensorflow::Status MetadataStore::GetArtifactsByContext(
         auto list_options = request.has_options()
                                 ? absl::make_optional(request.options())
                                 : absl::nullopt;
-        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContext(
-            request.context_id(), list_options, &artifacts, &next_page_token));
+        if (max_response_bytes_ > 0) {
+          MLMD_RETURN_IF_ERROR(ListNodesWithinBudget<Artifact>(
+              list_options, max_response_bytes_,
+              [this, &request](const ListOperationOptions& options,
+                               std::vector<Artifact>* page,
+                               std::string* page_token) {
+                return metadata_access_object_->FindArtifactsByContext(
+                    request.context_id(), options, page, page_token);
+              },
+              response->mutable_artifacts(), &next_page_token));
+        } else {
+          MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContext(
+              request.context_id(), list_options, &artifacts,
+              &next_page_token));
+        }
 
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
 
         if (!next_page_token.empty()) {
@@ -1327,7 +3126,7 @@ tensorflow::Status MetadataStore::GetArtifactsByContext(
 tensorflow::Status MetadataStore::GetExecutionsByContext(
     const GetExecutionsByContextRequest& request,
     GetExecutionsByContextResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
@@ -1336,11 +3135,25 @@ tensorflow::Status MetadataStore::GetExecutionsByContext(
                                 ? absl::make_optional(request.options())
                                 : absl::nullopt;
 
-        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExecutionsByContext(
-            request.context_id(), list_options, &executions, &next_page_token));
+        if (max_response_bytes_ > 0) {
+          MLMD_RETURN_IF_ERROR(ListNodesWithinBudget<Execution>(
+              list_options, max_response_bytes_,
+              [this, &request](const ListOperationOptions& options,
+                               std::vector<Execution>* page,
+                               std::string* page_token) {
+                return metadata_access_object_->FindExecutionsByContext(
+                    request.context_id(), options, page, page_token);
+              },
+              response->mutable_executions(), &next_page_token));
+        } else {
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->FindExecutionsByContext(
+                  request.context_id(), list_options, &executions,
+                  &next_page_token));
+        }
 
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
 
         if (!next_page_token.empty()) {
@@ -1354,18 +3167,32 @@ tensorflow::Status MetadataStore::GetExecutionsByContext(
 tensorflow::Status MetadataStore::GetParentContextsByContext(
     const GetParentContextsByContextRequest& request,
     GetParentContextsByContextResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> parent_contexts;
+        if (request.max_depth() > 1) {
+          std::vector<ParentContext> links;
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->FindAncestorContextsByContextId(
+                  request.context_id(), request.max_depth(), &parent_contexts,
+                  &links));
+          absl::c_move(parent_contexts,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           response->mutable_contexts()));
+          absl::c_move(links, google::protobuf::RepeatedPtrFieldBackInserter(
+                                  response->mutable_parent_contexts()));
+          return absl::OkStatus();
+        }
         const absl::Status status =
             metadata_access_object_->FindParentContextsByContextId(
                 request.context_id(), &parent_contexts);
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(parent_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
-                                          response->mutable_contexts()));
+        absl::c_move(parent_contexts,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_contexts()));
         return absl::OkStatus();
       }));
 }
@@ -1373,29 +3200,300 @@ tensorflow::Status MetadataStore::GetParentContextsByContext(
 tensorflow::Status MetadataStore::GetChildrenContextsByContext(
     const GetChildrenContextsByContextRequest& request,
     GetChildrenContextsByContextResponse* response) {
-  return FromABSLStatus(transaction_executor_->Execute(
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> child_contexts;
+        if (request.max_depth() > 1) {
+          std::vector<ParentContext> links;
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->FindDescendantContextsByContextId(
+                  request.context_id(), request.max_depth(), &child_contexts,
+                  &links));
+          absl::c_move(child_contexts,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           response->mutable_contexts()));
+          absl::c_move(links, google::protobuf::RepeatedPtrFieldBackInserter(
+                                  response->mutable_parent_contexts()));
+          return absl::OkStatus();
+        }
         const absl::Status status =
             metadata_access_object_->FindChildContextsByContextId(
                 request.context_id(), &child_contexts);
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(child_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
-                                         response->mutable_contexts()));
+        absl::c_move(child_contexts,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_contexts()));
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetArtifactsByContexts(
+    const GetArtifactsByContextsRequest& request,
+    GetArtifactsByContextsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::flat_hash_map<int64, std::vector<Artifact>> artifacts_by_context;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContexts(
+            std::vector<int64>(request.context_ids().begin(),
+                               request.context_ids().end()),
+            &artifacts_by_context));
+        for (auto& context_and_artifacts : artifacts_by_context) {
+          absl::c_move(context_and_artifacts.second,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           (*response->mutable_artifacts_by_context())
+                               [context_and_artifacts.first]
+                                   .mutable_artifacts()));
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetExecutionsByContexts(
+    const GetExecutionsByContextsRequest& request,
+    GetExecutionsByContextsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::flat_hash_map<int64, std::vector<Execution>>
+            executions_by_context;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExecutionsByContexts(
+            std::vector<int64>(request.context_ids().begin(),
+                               request.context_ids().end()),
+            &executions_by_context));
+        for (auto& context_and_executions : executions_by_context) {
+          absl::c_move(context_and_executions.second,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           (*response->mutable_executions_by_context())
+                               [context_and_executions.first]
+                                   .mutable_executions()));
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetContextsByArtifacts(
+    const GetContextsByArtifactsRequest& request,
+    GetContextsByArtifactsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::flat_hash_map<int64, std::vector<Context>> contexts_by_artifact;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByArtifacts(
+            std::vector<int64>(request.artifact_ids().begin(),
+                               request.artifact_ids().end()),
+            &contexts_by_artifact));
+        for (auto& artifact_and_contexts : contexts_by_artifact) {
+          absl::c_move(artifact_and_contexts.second,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           (*response->mutable_contexts_by_artifact())
+                               [artifact_and_contexts.first]
+                                   .mutable_contexts()));
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetContextsByExecutions(
+    const GetContextsByExecutionsRequest& request,
+    GetContextsByExecutionsResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        absl::flat_hash_map<int64, std::vector<Context>> contexts_by_execution;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByExecutions(
+            std::vector<int64>(request.execution_ids().begin(),
+                               request.execution_ids().end()),
+            &contexts_by_execution));
+        for (auto& execution_and_contexts : contexts_by_execution) {
+          absl::c_move(execution_and_contexts.second,
+                       google::protobuf::RepeatedPtrFieldBackInserter(
+                           (*response->mutable_contexts_by_execution())
+                               [execution_and_contexts.first]
+                                   .mutable_contexts()));
+        }
+        return absl::OkStatus();
+      }));
+}
+
+tensorflow::Status MetadataStore::GetLineageGraph(
+    const GetLineageGraphRequest& request, GetLineageGraphResponse* response) {
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        return TraverseLineageGraph(request, metadata_access_object_.get(),
+                                    response->mutable_subgraph());
+      }));
+}
+
+tensorflow::Status MetadataStore::GetLineageClosure(
+    const GetLineageClosureRequest& request,
+    GetLineageClosureResponse* response) {
+  if (!lineage_closure_enabled_) {
+    return tensorflow::errors::FailedPrecondition(
+        "The lineage closure is not enabled, see "
+        "ConnectionConfig.enable_lineage_closure.");
+  }
+  return FromABSLStatus(transaction_executor_->ExecuteRead(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        const std::vector<int64> artifact_ids(request.artifact_ids().begin(),
+                                              request.artifact_ids().end());
+        absl::flat_hash_set<int64> related_ids;
+        for (const bool upstream : {true, false}) {
+          if (request.direction() == (upstream
+                                          ? GetLineageGraphRequest::DOWNSTREAM
+                                          : GetLineageGraphRequest::UPSTREAM)) {
+            continue;
+          }
+          std::vector<int64> ids;
+          MLMD_RETURN_IF_ERROR(metadata_access_object_->FindLineageClosure(
+              artifact_ids, upstream, &ids));
+          related_ids.insert(ids.begin(), ids.end());
+        }
+        for (const int64 artifact_id : artifact_ids) {
+          related_ids.erase(artifact_id);
+        }
+        std::vector<int64> ids(related_ids.begin(), related_ids.end());
+        absl::c_sort(ids);
+        std::vector<Artifact> artifacts;
+        // The deleted artifacts are skipped.
+        const absl::Status status =
+            metadata_access_object_->FindArtifactsById(ids, &artifacts);
+        if (!status.ok() && !absl::IsNotFound(status)) {
+          return status;
+        }
+        absl::c_sort(artifacts, [](const Artifact& a, const Artifact& b) {
+          return a.id() < b.id();
+        });
+        absl::c_move(artifacts,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_artifacts()));
         return absl::OkStatus();
       }));
 }
 
 
 MetadataStore::MetadataStore(
-    std::unique_ptr<MetadataSource> metadata_source,
+    std::vector<std::unique_ptr<MetadataSource>> metadata_sources,
     std::unique_ptr<MetadataAccessObject> metadata_access_object,
-    std::unique_ptr<TransactionExecutor> transaction_executor)
-    : metadata_source_(std::move(metadata_source)),
+    std::unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, NodeCache* node_cache)
+    : metadata_sources_(std::move(metadata_sources)),
       metadata_access_object_(std::move(metadata_access_object)),
-      transaction_executor_(std::move(transaction_executor)) {}
+      transaction_executor_(std::move(transaction_executor)),
+      type_cache_(type_cache),
+      node_cache_(node_cache) {}
+
+absl::Status MetadataStore::ExecuteTypeChangingTransaction(
+    const std::function<absl::Status()>& txn_body) {
+  if (type_cache_ == nullptr) return transaction_executor_->Execute(txn_body);
+  const int64 cache_generation = type_cache_->generation();
+  const absl::Status status = transaction_executor_->Execute(txn_body);
+  if (type_cache_->generation() != cache_generation) {
+    type_cache_->Invalidate();
+  }
+  return status;
+}
+
+absl::Status MetadataStore::RunNodeChangingTransactions(
+    const std::function<absl::Status()>& run_transactions) {
+  if (node_cache_ == nullptr) return run_transactions();
+  const int64 cache_generation = node_cache_->generation();
+  const absl::Status status = run_transactions();
+  if (node_cache_->generation() != cache_generation) {
+    node_cache_->InvalidateSince(cache_generation);
+  }
+  return status;
+}
+
+absl::Status MetadataStore::ExecuteNodeChangingTransaction(
+    const std::function<absl::Status()>& txn_body) {
+  return RunNodeChangingTransactions(
+      [this, &txn_body]() { return ExecuteEdgeCreatingTransaction(txn_body); });
+}
+
+absl::Status MetadataStore::ExecuteEdgeCreatingTransaction(
+    const std::function<absl::Status()>& txn_body) {
+  const absl::Status status =
+      transaction_executor_->Execute([this, &txn_body]() {
+        // An attempt may be rolled back and retried.
+        pending_attributions_.clear();
+        pending_associations_.clear();
+        return txn_body();
+      });
+  if (status.ok()) {
+    // The sets are bounded by forgetting all the edges once they are full.
+    constexpr int kMaxNumKnownEdges = 1 << 20;
+    if (known_attributions_.size() + pending_attributions_.size() >
+            kMaxNumKnownEdges ||
+        known_associations_.size() + pending_associations_.size() >
+            kMaxNumKnownEdges) {
+      ForgetKnownEdges();
+    }
+    known_attributions_.insert(pending_attributions_.begin(),
+                               pending_attributions_.end());
+    known_associations_.insert(pending_associations_.begin(),
+                               pending_associations_.end());
+  }
+  pending_attributions_.clear();
+  pending_associations_.clear();
+  return status;
+}
+
+absl::Status MetadataStore::CreateEdgesInTransaction(
+    const absl::Span<const Attribution> attributions,
+    const absl::Span<const Association> associations) {
+  // The transaction runs on the current connections, so that the edges known
+  // from earlier ones are dropped.
+  const int64 num_connections = NumConnections();
+  if (num_connections != known_edges_num_connections_) {
+    ForgetKnownEdges();
+    known_edges_num_connections_ = num_connections;
+  }
+  std::vector<Association> new_associations;
+  for (const Association& association : associations) {
+    if (!known_associations_.contains(
+            {association.context_id(), association.execution_id()})) {
+      new_associations.push_back(association);
+    }
+  }
+  std::vector<Attribution> new_attributions;
+  for (const Attribution& attribution : attributions) {
+    if (!known_attributions_.contains(
+            {attribution.context_id(), attribution.artifact_id()})) {
+      new_attributions.push_back(attribution);
+    }
+  }
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object_->CreateAssociations(new_associations));
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object_->CreateAttributions(new_attributions));
+  for (const Association& association : new_associations) {
+    pending_associations_.emplace_back(association.context_id(),
+                                       association.execution_id());
+  }
+  for (const Attribution& attribution : new_attributions) {
+    pending_attributions_.emplace_back(attribution.context_id(),
+                                       attribution.artifact_id());
+  }
+  return absl::OkStatus();
+}
+
+void MetadataStore::ForgetKnownEdges() {
+  known_attributions_.clear();
+  known_associations_.clear();
+}
+
+int64 MetadataStore::NumConnections() const {
+  int64 num_connections = 0;
+  for (const std::unique_ptr<MetadataSource>& source : metadata_sources_) {
+    num_connections += source->num_connections();
+  }
+  return num_connections;
+}
 
 }  // namespace ml_metadata
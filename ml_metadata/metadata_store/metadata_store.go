@@ -33,6 +33,12 @@ import (
 // memory leak allocated in cc library.
 type Store struct {
 	ptr wrap.Ml_metadata_MetadataStore
+	// The status and buffers reused by the PutInBatch calls, so that they do
+	// not allocate them per call.
+	batchStatus   wrap.Status
+	batchBuffer   wrap.MetadataStoreBatchBuffer
+	batchRequests []byte
+	batchResults  []byte
 }
 
 // NewStore creates Store instance given a connection config.
@@ -49,7 +55,11 @@ func NewStore(config *mdpb.ConnectionConfig) (*Store, error) {
 	if !status.Ok() {
 		return nil, errors.New(status.Error_message())
 	}
-	return &Store{s}, nil
+	return &Store{
+		ptr:         s,
+		batchStatus: wrap.NewStatus(),
+		batchBuffer: wrap.NewBatchBuffer(),
+	}, nil
 }
 
 // Close frees allocated memory in cc library of the Store instance.
@@ -58,6 +68,14 @@ func (store *Store) Close() {
 		wrap.DestroyMetadataStore(store.ptr)
 		store.ptr = nil
 	}
+	if store.batchStatus != nil {
+		wrap.DeleteStatus(store.batchStatus)
+		store.batchStatus = nil
+	}
+	if store.batchBuffer != nil {
+		wrap.DeleteBatchBuffer(store.batchBuffer)
+		store.batchBuffer = nil
+	}
 }
 
 // ArtifactTypeID refers the id space of ArtifactType
@@ -484,6 +502,93 @@ func (store *Store) PutExecution(e *mdpb.Execution, aep []*ArtifactAndEvent, ctx
 	return ExecutionID(resp.GetExecutionId()), aids, cids, err
 }
 
+// BatchedPut is a PutExecution or PutEvents call run by PutInBatch. Exactly one
+// of PutExecutionRequest and PutEventsRequest must be set.
+type BatchedPut struct {
+	PutExecutionRequest *apipb.PutExecutionRequest
+	PutEventsRequest    *apipb.PutEventsRequest
+	// The response of the call, which is set by PutInBatch if the call succeeds.
+	PutExecutionResponse *apipb.PutExecutionResponse
+	PutEventsResponse    *apipb.PutEventsResponse
+	// The error of the call, which is set by PutInBatch if the call fails.
+	Err error
+}
+
+// PutInBatch runs the PutExecution and PutEvents calls of `puts` in a single
+// call of the cc library and a single transaction, so that they share one
+// commit. The response or error of each call is set in `puts`, and a failed
+// call does not prevent the others from being committed. The request and
+// result buffers are kept by the Store and reused by the next batches.
+//
+// It returns an error if the batch fails, in which case none of the calls is
+// committed.
+func (store *Store) PutInBatch(puts []*BatchedPut) error {
+	b := proto.NewBuffer(store.batchRequests[:0])
+	for _, put := range puts {
+		var err error
+		switch {
+		case put.PutExecutionRequest != nil:
+			if err = b.EncodeStringBytes("PutExecution"); err == nil {
+				err = b.EncodeMessage(put.PutExecutionRequest)
+			}
+		case put.PutEventsRequest != nil:
+			if err = b.EncodeStringBytes("PutEvents"); err == nil {
+				err = b.EncodeMessage(put.PutEventsRequest)
+			}
+		default:
+			err = errors.New("a BatchedPut must set PutExecutionRequest or PutEventsRequest")
+		}
+		if err != nil {
+			return err
+		}
+	}
+	store.batchRequests = b.Bytes()
+
+	size := wrap.PutInBatch(store.ptr, store.batchBuffer, store.batchRequests,
+		store.batchResults[:cap(store.batchResults)], store.batchStatus)
+	if !store.batchStatus.Ok() {
+		return errors.New(store.batchStatus.Error_message())
+	}
+	if size > int64(cap(store.batchResults)) {
+		// The results did not fit, they are copied to a larger buffer.
+		store.batchResults = make([]byte, size)
+		wrap.CopyBatchResults(store.batchBuffer, store.batchResults)
+	}
+	return decodeBatchedPutResults(store.batchResults[:size], puts)
+}
+
+// decodeBatchedPutResults sets the results of `puts` encoded by the cc library,
+// each as the status code followed by the error message and the response.
+func decodeBatchedPutResults(results []byte, puts []*BatchedPut) error {
+	b := proto.NewBuffer(results)
+	for _, put := range puts {
+		code, err := b.DecodeVarint()
+		if err != nil {
+			return err
+		}
+		message, err := b.DecodeStringBytes()
+		if err != nil {
+			return err
+		}
+		resp, err := b.DecodeRawBytes(false)
+		if err != nil {
+			return err
+		}
+		if code != 0 {
+			put.Err = errors.New(message)
+			continue
+		}
+		if put.PutExecutionRequest != nil {
+			put.PutExecutionResponse = &apipb.PutExecutionResponse{}
+			put.Err = proto.Unmarshal(resp, put.PutExecutionResponse)
+		} else {
+			put.PutEventsResponse = &apipb.PutEventsResponse{}
+			put.Err = proto.Unmarshal(resp, put.PutEventsResponse)
+		}
+	}
+	return nil
+}
+
 // GetEventsByArtifactIDs gets all events with matching artifact ids.
 // It returns an error if the query execution fails.
 func (store *Store) GetEventsByArtifactIDs(aids []ArtifactID) ([]*mdpb.Event, error) {
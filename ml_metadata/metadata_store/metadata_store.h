@@ -15,12 +15,22 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 
+#include <functional>
 #include <memory>
-
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/node_cache.h"
 #include "ml_metadata/metadata_store/transaction_executor.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -47,6 +57,39 @@ class MetadataStore : public MetadataStoreServiceInterface {
       std::unique_ptr<TransactionExecutor> transaction_executor,
       std::unique_ptr<MetadataStore>* result);
 
+  // Creates a MetadataStore which looks up types in `type_cache`, if it is not
+  // nullptr. The cache is not owned, and it must outlive the result and only
+  // be shared by the stores connected to the same database.
+  static tensorflow::Status Create(
+      const MetadataSourceQueryConfig& query_config,
+      const MigrationOptions& migration_options,
+      std::unique_ptr<MetadataSource> metadata_source,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, std::unique_ptr<MetadataStore>* result);
+
+  // Creates a MetadataStore which also looks up nodes in `node_cache`, if it is
+  // not nullptr, which is shared like `type_cache`.
+  static tensorflow::Status Create(
+      const MetadataSourceQueryConfig& query_config,
+      const MigrationOptions& migration_options,
+      std::unique_ptr<MetadataSource> metadata_source,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, NodeCache* node_cache,
+      std::unique_ptr<MetadataStore>* result);
+
+  // Creates a MetadataStore whose nodes are partitioned across the databases
+  // of `shard_sources`, see ShardedMetadataAccessObject. The order of the
+  // shards must not change, and `transaction_executor` must run the
+  // transactions on all of them. The `type_cache` is used like in Create,
+  // while nodes are not cached, as the shards assign the same ids.
+  // Returns INVALID_ARGUMENT error, if `shard_sources` is empty.
+  static tensorflow::Status CreateSharded(
+      const MetadataSourceQueryConfig& query_config,
+      const MigrationOptions& migration_options,
+      std::vector<std::unique_ptr<MetadataSource>> shard_sources,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, std::unique_ptr<MetadataStore>* result);
+
   // Initializes the metadata source and creates schema. Any existing data in
   // the metadata is dropped.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -62,6 +105,135 @@ class MetadataStore : public MetadataStoreServiceInterface {
   tensorflow::Status InitMetadataStoreIfNotExists(
       bool enable_upgrade_migration = false);
 
+  // Checks whether the underlying metadata source is still usable by running a
+  // lightweight read of the schema version in a transaction.
+  // Returns detailed INTERNAL error, if the connection is broken.
+  tensorflow::Status CheckHealth();
+
+  // Returns true if a call has failed with an error which may have broken the
+  // connections of the store, e.g., INTERNAL or UNAVAILABLE, so that it should
+  // be closed instead of being reused.
+  bool connection_failed() const;
+
+  // Begins a kSnapshotRead transaction on the metadata sources, which the reads
+  // of the store run in until EndPinnedRead, so that they see one snapshot of
+  // the database, e.g., the pages of a list. The writes fail meanwhile. The
+  // shared node cache is bypassed, and neither the types nor the nodes read
+  // are cached, so that the snapshot is kept.
+  // Returns FAILED_PRECONDITION error, if a pinned read is already begun.
+  // Returns detailed INTERNAL error, if the transaction cannot be begun.
+  tensorflow::Status BeginPinnedRead();
+
+  // Ends the transaction begun by BeginPinnedRead by rolling it back, and
+  // runs the later calls in their own transactions again.
+  // Returns FAILED_PRECONDITION error, if no pinned read is begun.
+  // Returns detailed INTERNAL error, if the rollback fails.
+  tensorflow::Status EndPinnedRead();
+
+  // Drops the secondary indices of the database, e.g., before importing a
+  // snapshot, so that the inserts do not update them row by row. The reads
+  // are slower until CreateSecondaryIndices rebuilds them.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DropSecondaryIndices();
+
+  // Creates the secondary indices of the database if they do not exist.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CreateSecondaryIndices();
+
+  // Creates and drops the time partitions of the Event and EventPath tables
+  // as of now with `options`, and converts the unpartitioned tables first if
+  // `enable_migration` is set.
+  // Returns FAILED_PRECONDITION error, if the tables are not partitioned and
+  //   `enable_migration` is not set.
+  // Returns UNIMPLEMENTED error, if the store does not partition events.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status MaintainEventPartitions(
+      const EventPartitionOptions& options, bool enable_migration);
+
+  // Stores the paths of the events serialized in the rows of the events, see
+  // ConnectionConfig.inline_event_paths. The paths left in the EventPath table
+  // are moved first, if `enable_migration` is set, in batches which are each
+  // committed in their own transaction.
+  // Returns FAILED_PRECONDITION error, if paths are left in the EventPath
+  //   table and `enable_migration` is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status InlineEventPaths(bool enable_migration);
+
+  // Stores a serialized copy of the properties of each node in the row of the
+  // node, see ConnectionConfig.inline_node_properties. The nodes written
+  // before are filled first, if `enable_migration` is set, in batches which
+  // are each committed in their own transaction.
+  // Returns FAILED_PRECONDITION error, if nodes are left to fill and
+  //   `enable_migration` is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status InlineNodeProperties(bool enable_migration);
+
+  // Keeps the serialized copies of the node properties stored by the stores
+  // with ConnectionConfig.inline_node_properties up to date with the property
+  // changes of this store, if the database has them.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status MaintainNodePropertiesBytes();
+
+  // Records the idempotency keys of the write requests with their responses,
+  // see ConnectionConfig.idempotency. The MLMDIdempotencyKey table is created,
+  // if it does not exist.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status EnableIdempotencyKeys(
+      const ConnectionConfig::IdempotencyOptions& options);
+
+  // Keeps the lineage closure of the artifacts, see
+  // ConnectionConfig.enable_lineage_closure. If the MLMDLineageClosure table
+  // does not exist, it is created and filled with the closure of the existing
+  // events in the same transaction.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status EnableLineageClosure();
+
+  // Cuts the responses of GetArtifactsByContext and GetExecutionsByContext
+  // once their nodes exceed `max_response_bytes`, and continues them with a
+  // next_page_token, see ConnectionConfig.max_response_bytes. A budget of
+  // zero or less reads the whole context.
+  void SetMaxResponseBytes(int64 max_response_bytes) {
+    max_response_bytes_ = max_response_bytes;
+  }
+
+  // Deletes the idempotency keys which are expired as of `now`, in batches of
+  // at most `max_batch_size` keys which are each committed in their own
+  // transaction, and sets `num_deleted` to the number of deleted keys. Does
+  // nothing if the idempotency keys are not enabled.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteExpiredIdempotencyKeys(absl::Time now,
+                                                  int64 max_batch_size,
+                                                  int64* num_deleted);
+
+  // Called with the progress of an online schema migration after each of its
+  // committed transactions. It may block to throttle the migration, e.g.,
+  // until the replicas of the database catch up, or return an error to stop
+  // it; a stopped migration resumes with the next migrating store.
+  using MigrationProgressCallback =
+      std::function<tensorflow::Status(const SchemaMigrationProgress&)>;
+
+  // Upgrades the schema of the database to the library version online, see
+  // MigrationOptions.online_migration. The chunked queries of the migration
+  // schemes are committed in transactions of at most
+  // max_chunks_per_transaction chunks, and the progress is logged and passed
+  // to the `progress_callback`, if given. An empty database, or one which is
+  // not older than the library, is left to InitMetadataStoreIfNotExists.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status UpgradeSchemaOnline(
+      const OnlineMigrationOptions& options,
+      const MigrationProgressCallback& progress_callback = nullptr);
+
+  // Sets the time after which the aborted transactions of the store are not
+  // retried anymore, e.g., the deadline of the request using the store. The
+  // queries still running at the deadline are also abandoned, if the metadata
+  // source supports it.
+  void SetTransactionDeadline(absl::Time deadline) {
+    transaction_executor_->SetRetryDeadline(deadline);
+    for (const std::unique_ptr<MetadataSource>& source : metadata_sources_) {
+      source->SetQueryDeadline(deadline);
+    }
+  }
+
   // Inserts or updates a ArtifactType/ExecutionType/ContextType.
   //
   // A type has a set of strong typed properties describing the schema of any
@@ -204,6 +376,9 @@ class MetadataStore : public MetadataStoreServiceInterface {
   // the one stored.
   // Returns INVALID_ARGUMENT error, if given property names and types do not
   // align with the ExecutionType on file.
+  // Returns FAILED_PRECONDITION error, if the request set
+  // options.abort_if_latest_updated_time_changed, and the stored execution has
+  // different latest_updated_time.
   // Returns ALREADY_EXISTS error, if the name exists in the artifact_type.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status PutExecutions(const PutExecutionsRequest& request,
@@ -221,6 +396,9 @@ class MetadataStore : public MetadataStoreServiceInterface {
   // Returns INVALID_ARGUMENT error, if name is empty.
   // Returns INVALID_ARGUMENT error, if given property names and types do not
   // align with the ContextType on file.
+  // Returns FAILED_PRECONDITION error, if the request set
+  // options.abort_if_latest_updated_time_changed, and the stored context has
+  // different latest_updated_time.
   // Returns ALREADY_EXISTS error, if the name exists in the context_type.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status PutContexts(const PutContextsRequest& request,
@@ -259,6 +437,28 @@ class MetadataStore : public MetadataStoreServiceInterface {
   tensorflow::Status PutExecution(const PutExecutionRequest& request,
                                   PutExecutionResponse* response) override;
 
+  // A PutExecution or PutEvents call of a batch, see PutInBatch(). Exactly one
+  // of the request and response pairs is set. The requests and responses are
+  // not owned.
+  struct BatchedPut {
+    const PutExecutionRequest* put_execution_request = nullptr;
+    PutExecutionResponse* put_execution_response = nullptr;
+    const PutEventsRequest* put_events_request = nullptr;
+    PutEventsResponse* put_events_response = nullptr;
+    // The status of the call, which is set by PutInBatch().
+    tensorflow::Status status;
+  };
+
+  // Runs the PutExecution and PutEvents calls of `batch` in a single
+  // transaction, so that they share one commit, e.g., one fsync of the MySQL
+  // redo log. The status of each call is set in the batch. A failed call is
+  // rolled back to a savepoint without affecting the other calls.
+  // Returns UNIMPLEMENTED error, if the transaction executor does not support
+  //   batches.
+  // Returns detailed error, if the transaction fails, in which case none of
+  //   the calls is committed.
+  tensorflow::Status PutInBatch(std::vector<BatchedPut>* batch);
+
   // Gets all events with matching execution ids.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetEventsByExecutionIDs(
@@ -279,6 +479,12 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetArtifactsByIDRequest& request,
       GetArtifactsByIDResponse* response) override;
 
+  // Same as GetArtifactsByID, but sets `serialized_response` to the wire form
+  // of the response. The artifacts kept serialized by the node cache are
+  // spliced in as they are, so they are neither decoded nor encoded again.
+  tensorflow::Status GetSerializedArtifactsByID(
+      const GetArtifactsByIDRequest& request, std::string* serialized_response);
+
   // Retrieve artifacts using list options.
   // If option is not set in the request, then all Artifacts are returned.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -292,6 +498,15 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetArtifactsByTypeRequest& request,
       GetArtifactsByTypeResponse* response) override;
 
+  // Sets `artifact_ids` to the sorted ids of the artifacts of the type of
+  // `request`, without reading the artifacts, e.g., to split a large
+  // GetArtifactsByType into GetArtifactsByID calls. If the type is not found,
+  // it returns OK and no ids.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetArtifactIdsByType(
+      const GetArtifactsByTypeRequest& request,
+      std::vector<int64>* artifact_ids);
+
   // Gets the artifact of a given type and name. If no artifact found, it
   // returns OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -299,6 +514,13 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetArtifactByTypeAndNameRequest& request,
       GetArtifactByTypeAndNameResponse* response) override;
 
+  // Gets the artifacts of a given type by their names. The names not found are
+  // skipped. If the type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetArtifactsByTypeAndNames(
+      const GetArtifactsByTypeAndNamesRequest& request,
+      GetArtifactsByTypeAndNamesResponse* response) override;
+
   // Gets all the artifacts matching the given URIs. If no artifacts found, it
   // returns OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -306,6 +528,20 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetArtifactsByURIRequest& request,
       GetArtifactsByURIResponse* response) override;
 
+  // Gets all the artifacts whose uri starts with the given prefix. If no
+  // artifacts found, it returns OK and empty response.
+  // Returns INVALID_ARGUMENT error, if the uri_prefix is empty.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetArtifactsByURIPrefix(
+      const GetArtifactsByURIPrefixRequest& request,
+      GetArtifactsByURIPrefixResponse* response) override;
+
+  // Checks which of the given artifact ids exist, without reading the
+  // artifacts. The response has a flag for each id of the request.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status ArtifactsExist(const ArtifactsExistRequest& request,
+                                    ArtifactsExistResponse* response) override;
+
   // Gets a list of executions by ID.
   // If no execution with an ID exists, the execution is skipped.
   // Sets the error field if any other internal errors are returned.
@@ -314,6 +550,11 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetExecutionsByIDRequest& request,
       GetExecutionsByIDResponse* response) override;
 
+  // Same as GetSerializedArtifactsByID, but for GetExecutionsByID.
+  tensorflow::Status GetSerializedExecutionsByID(
+      const GetExecutionsByIDRequest& request,
+      std::string* serialized_response);
+
   // Retrieve Executions using list options.
   // If option is not set in the request, then all Executions are returned.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -334,6 +575,13 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetExecutionByTypeAndNameRequest& request,
       GetExecutionByTypeAndNameResponse* response) override;
 
+  // Gets the executions of a given type by their names. The names not found are
+  // skipped. If the type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetExecutionsByTypeAndNames(
+      const GetExecutionsByTypeAndNamesRequest& request,
+      GetExecutionsByTypeAndNamesResponse* response) override;
+
   // Gets a list of contexts by ID.
   // If no context with an ID exists, the context is skipped.
   // Sets the error field if any other internal errors are returned.
@@ -342,12 +590,58 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetContextsByIDRequest& request,
       GetContextsByIDResponse* response) override;
 
+  // Same as GetSerializedArtifactsByID, but for GetContextsByID.
+  tensorflow::Status GetSerializedContextsByID(
+      const GetContextsByIDRequest& request, std::string* serialized_response);
+
   // Retrieve Contexts using list options.
   // If option is not set in the request, then all Contexts are returned.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetContexts(const GetContextsRequest& request,
                                  GetContextsResponse* response) override;
 
+  // Streams all artifacts in chunks of at most `request.max_chunk_size`
+  // artifacts. Each chunk is passed to `callback` as it is read, and a non-OK
+  // status returned by `callback` aborts the stream.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status StreamArtifacts(
+      const StreamArtifactsRequest& request,
+      const std::function<tensorflow::Status(const StreamArtifactsResponse&)>&
+          callback) override;
+
+  // Streams all executions in chunks. See StreamArtifacts.
+  tensorflow::Status StreamExecutions(
+      const StreamExecutionsRequest& request,
+      const std::function<tensorflow::Status(const StreamExecutionsResponse&)>&
+          callback) override;
+
+  // Streams all contexts in chunks. See StreamArtifacts.
+  tensorflow::Status StreamContexts(
+      const StreamContextsRequest& request,
+      const std::function<tensorflow::Status(const StreamContextsResponse&)>&
+          callback) override;
+
+  // Streams all the nodes of `request.node_kind` in chunks of columns, with
+  // the properties selected by `request.property_options`. See
+  // StreamArtifacts.
+  // Returns INVALID_ARGUMENT error, if node_kind is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status StreamNodeColumns(
+      const StreamNodeColumnsRequest& request,
+      const std::function<tensorflow::Status(
+          const StreamNodeColumnsResponse&)>& callback) override;
+
+  // Streams the nodes of `request.node_kind` changed after
+  // `request.watermark` in chunks, ordered by (last_update_time_since_epoch,
+  // id). Each chunk carries the watermark of its last node, from which a
+  // later watch resumes.
+  // Returns INVALID_ARGUMENT error, if node_kind is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status WatchChanges(
+      const WatchChangesRequest& request,
+      const std::function<tensorflow::Status(const WatchChangesResponse&)>&
+          callback) override;
+
   // Gets all the contexts of a given type. If no contexts found, it returns
   // OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -355,6 +649,34 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetContextsByTypeRequest& request,
       GetContextsByTypeResponse* response) override;
 
+  // Counts the artifacts, of the given type and in the given state if they are
+  // set, without reading them. If the type is not found, the count is 0.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountArtifacts(const CountArtifactsRequest& request,
+                                    CountArtifactsResponse* response) override;
+
+  // Counts the executions, of the given type and in the given state if they
+  // are set, without reading them. If the type is not found, the count is 0.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountExecutions(
+      const CountExecutionsRequest& request,
+      CountExecutionsResponse* response) override;
+
+  // Counts the contexts, of the given type if it is set, without reading them.
+  // If the type is not found, the count is 0.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountContexts(const CountContextsRequest& request,
+                                   CountContextsResponse* response) override;
+
+  // Aggregates the values of a property over the artifacts or the executions
+  // of a given type in the database, optionally in a context and grouped by
+  // state. If the type is not found, it returns OK and empty response.
+  // Returns INVALID_ARGUMENT error, if the node_kind is not set.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status AggregateProperty(
+      const AggregatePropertyRequest& request,
+      AggregatePropertyResponse* response) override;
+
   // Gets the context of a given type and name. If no context found, it returns
   // OK and empty response. If more than one contexts matchs the type and name,
   // the query execution fails.
@@ -362,6 +684,13 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetContextByTypeAndNameRequest& request,
       GetContextByTypeAndNameResponse* response) override;
 
+  // Gets the contexts of a given type by their names. The names not found are
+  // skipped. If the type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetContextsByTypeAndNames(
+      const GetContextsByTypeAndNamesRequest& request,
+      GetContextsByTypeAndNamesResponse* response) override;
+
   // Inserts attribution and association relationships in the database.
   // The context_id, artifact_id, and execution_id must already exist.
   // If the relationship exists, this call does nothing. Once added, the
@@ -382,6 +711,30 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const PutParentContextsRequest& request,
       PutParentContextsResponse* response) override;
 
+  // Deletes the artifacts along with their properties, events and
+  // attributions, in batches of separate transactions. The ids which are not
+  // found are ignored. If a batch fails, the earlier batches stay deleted.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteArtifacts(
+      const DeleteArtifactsRequest& request,
+      DeleteArtifactsResponse* response) override;
+
+  // Deletes the executions along with their properties, events and
+  // associations, in batches of separate transactions. See DeleteArtifacts.
+  tensorflow::Status DeleteExecutions(
+      const DeleteExecutionsRequest& request,
+      DeleteExecutionsResponse* response) override;
+
+  // Deletes the artifacts or executions of the type of the request which are
+  // last updated before its time, in batches of separate transactions, and
+  // sets the number of deleted nodes. The number is 0, if the type is not
+  // found.
+  // Returns INVALID_ARGUMENT error, if the node_kind or the type_name is not
+  //   given.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CollectGarbage(const CollectGarbageRequest& request,
+                                    CollectGarbageResponse* response) override;
+
   // Gets all context that an artifact is attributed to.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetContextsByArtifact(
@@ -408,28 +761,176 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetExecutionsByContextRequest& request,
       GetExecutionsByContextResponse* response) override;
 
-  // Gets all parent contexts of a context.
+  // Gets the artifacts attributed to each of the request.context_ids, with
+  // one query for all the contexts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetArtifactsByContexts(
+      const GetArtifactsByContextsRequest& request,
+      GetArtifactsByContextsResponse* response) override;
+
+  // Gets the executions associated with each of the request.context_ids, with
+  // one query for all the contexts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetExecutionsByContexts(
+      const GetExecutionsByContextsRequest& request,
+      GetExecutionsByContextsResponse* response) override;
+
+  // Gets the contexts that each of the request.artifact_ids is attributed
+  // to, with one query for all the artifacts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetContextsByArtifacts(
+      const GetContextsByArtifactsRequest& request,
+      GetContextsByArtifactsResponse* response) override;
+
+  // Gets the contexts that each of the request.execution_ids is associated
+  // with, with one query for all the executions.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetContextsByExecutions(
+      const GetContextsByExecutionsRequest& request,
+      GetContextsByExecutionsResponse* response) override;
+
+  // Gets all parent contexts of a context. If request.max_depth is more than
+  // 1, gets the ancestors within max_depth levels and the links to them.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetParentContextsByContext(
       const GetParentContextsByContextRequest& request,
       GetParentContextsByContextResponse* response) override;
 
-  // Gets all children contexts of a context.
+  // Gets all children contexts of a context. If request.max_depth is more than
+  // 1, gets the descendants within max_depth levels and the links to them.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetChildrenContextsByContext(
       const GetChildrenContextsByContextRequest& request,
       GetChildrenContextsByContextResponse* response) override;
 
+  // Gets the lineage subgraph within request.max_num_hops of the seed
+  // artifacts, following the events in request.direction. The subgraph is
+  // expanded breadth-first in a single transaction, with one event lookup per
+  // hop, and has at most request.max_num_nodes artifacts and executions.
+  // Returns INVALID_ARGUMENT error, if max_num_hops is negative.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetLineageGraph(
+      const GetLineageGraphRequest& request,
+      GetLineageGraphResponse* response) override;
+
+  // Gets the artifacts upstream and/or downstream of the request.artifact_ids
+  // in request.direction, from the lineage closure with one lookup per
+  // direction. The requested artifacts are excluded.
+  // Returns FAILED_PRECONDITION error, if the lineage closure is not enabled.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetLineageClosure(
+      const GetLineageClosureRequest& request,
+      GetLineageClosureResponse* response) override;
 
  private:
   // To construct the object, see Create(...).
-  MetadataStore(std::unique_ptr<MetadataSource> metadata_source,
-                std::unique_ptr<MetadataAccessObject> metadata_access_object,
-                std::unique_ptr<TransactionExecutor> transaction_executor);
+  MetadataStore(
+      std::vector<std::unique_ptr<MetadataSource>> metadata_sources,
+      std::unique_ptr<MetadataAccessObject> metadata_access_object,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, NodeCache* node_cache);
+
+  // Creates the store once its `metadata_access_object` is created, after
+  // running the downgrade migration, if any, see Create.
+  static tensorflow::Status Create(
+      const MigrationOptions& migration_options,
+      std::vector<std::unique_ptr<MetadataSource>> metadata_sources,
+      std::unique_ptr<MetadataAccessObject> metadata_access_object,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, NodeCache* node_cache,
+      std::unique_ptr<MetadataStore>* result);
 
-  std::unique_ptr<MetadataSource> metadata_source_;
+  // Runs a transaction which may change types. If any type has been changed
+  // meanwhile, the type cache is invalidated again once the transaction is
+  // committed or rolled back, as other stores may have cached the types read
+  // before then.
+  absl::Status ExecuteTypeChangingTransaction(
+      const std::function<absl::Status()>& txn_body);
+
+  // Runs `run_transactions`, which runs one or more transactions that may
+  // change nodes. If any node has been invalidated meanwhile, the invalidated
+  // nodes are dropped again from the node cache once the transactions are
+  // over, as other stores may have cached the nodes read before then.
+  absl::Status RunNodeChangingTransactions(
+      const std::function<absl::Status()>& run_transactions);
+
+  // Runs a transaction which may change nodes, see
+  // RunNodeChangingTransactions.
+  absl::Status ExecuteNodeChangingTransaction(
+      const std::function<absl::Status()>& txn_body);
+
+  // Runs a transaction which may create attributions and associations with
+  // CreateEdgesInTransaction. The created edges are known to exist once the
+  // transaction is committed; the ones of a rolled back attempt are not.
+  absl::Status ExecuteEdgeCreatingTransaction(
+      const std::function<absl::Status()>& txn_body);
+
+  // Creates the `attributions` and `associations` in an open transaction, and
+  // skips the ones known to exist without looking them up. See
+  // MetadataAccessObject::CreateAttributions.
+  absl::Status CreateEdgesInTransaction(
+      absl::Span<const Attribution> attributions,
+      absl::Span<const Association> associations);
+
+  // Forgets the known edges, e.g., once nodes are deleted.
+  void ForgetKnownEdges();
+
+  // Returns the total number of connections of the sources, see
+  // MetadataSource::num_connections.
+  int64 NumConnections() const;
+
+  // The bodies of PutExecution and PutEvents, run in an open transaction.
+  absl::Status PutExecutionInTransaction(const PutExecutionRequest& request,
+                                         PutExecutionResponse* response);
+  absl::Status PutEventsInTransaction(const PutEventsRequest& request,
+                                      PutEventsResponse* response);
+
+  // Upserts the nodes and links of a PutExecution, under its placement hint.
+  absl::Status PutExecutionNodesInTransaction(
+      const PutExecutionRequest& request, PutExecutionResponse* response);
+
+  // Runs `txn_body`, which writes the `response` of `request` in an open
+  // transaction, and records the response with the `idempotency_key` of the
+  // request, if any. If the key is recorded and not expired, the recorded
+  // response is returned instead, without running `txn_body`.
+  // Returns INVALID_ARGUMENT error, if the key is recorded for a different
+  //   request, or is longer than 255 characters.
+  // Returns ABORTED error, if the key is recorded by a concurrent transaction.
+  absl::Status RunIdempotently(const google::protobuf::Message& request,
+                               absl::string_view idempotency_key,
+                               google::protobuf::Message* response,
+                               const std::function<absl::Status()>& txn_body);
+
+  // The sources used by `metadata_access_object_`, e.g., one per shard.
+  std::vector<std::unique_ptr<MetadataSource>> metadata_sources_;
   std::unique_ptr<MetadataAccessObject> metadata_access_object_;
   std::unique_ptr<TransactionExecutor> transaction_executor_;
+  // The executor replaced by BeginPinnedRead, or null if no read is pinned.
+  std::unique_ptr<TransactionExecutor> unpinned_transaction_executor_;
+  TypeCache* const type_cache_;
+  NodeCache* const node_cache_;
+  // How long the idempotency keys are kept, if they are recorded.
+  absl::optional<absl::Duration> idempotency_key_ttl_;
+  // Whether the lineage closure is kept with the events.
+  bool lineage_closure_enabled_ = false;
+  // The bytes of the nodes after which the by-context reads are cut, or zero
+  // if they are not.
+  int64 max_response_bytes_ = 0;
+  // The (context_id, artifact_id) attributions and (context_id,
+  // execution_id) associations known to exist, as they have been created by
+  // the committed transactions of the store. The edges deleted through other
+  // stores are not observed, as the ids of the deleted nodes are not reused
+  // while the server runs. They are forgotten once a source reconnects, as
+  // MySQL 5.7 resets AUTO_INCREMENT to max(id) + 1 when it restarts, which
+  // reuses the ids of the newest deleted nodes.
+  absl::flat_hash_set<std::pair<int64, int64>> known_attributions_;
+  absl::flat_hash_set<std::pair<int64, int64>> known_associations_;
+  // The total num_connections() of the sources when the edges were known.
+  int64 known_edges_num_connections_ = 0;
+  // The edges created by the open transaction, see
+  // ExecuteEdgeCreatingTransaction.
+  std::vector<std::pair<int64, int64>> pending_attributions_;
+  std::vector<std::pair<int64, int64>> pending_associations_;
 };
 
 }  // namespace ml_metadata
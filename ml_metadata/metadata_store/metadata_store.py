@@ -17,8 +17,12 @@ Provides access to a SQLite3 or a MySQL backend. Artifact types and execution
 types can be created on the fly.
 """
 
+import asyncio
 import enum
+import itertools
+import queue
 import random
+import threading
 import time
 from typing import Iterable, List, Optional, Sequence, Text, Tuple, Union
 
@@ -112,10 +116,26 @@ class MetadataStore(object):
     channel = self._get_channel(config)
     self._metadata_store_stub = (metadata_store_service_pb2_grpc.
                                  MetadataStoreServiceStub(channel))
+    self._hedge_stubs = []
+    if config.HasField('hedging_config'):
+      hedging_config = config.hedging_config
+      # A hedge channel has connections of its own, even to the same target.
+      self._hedge_stubs = [
+          metadata_store_service_pb2_grpc.MetadataStoreServiceStub(
+              self._get_channel(config, target, use_local_subchannel_pool=True))
+          for target in (hedging_config.targets or [None])
+      ]
+      self._hedge_stub_indexes = itertools.count()
+      self._hedge_delay_sec = hedging_config.delay_sec
+      self._hedge_budget = _HedgeBudget(hedging_config.max_hedge_ratio,
+                                        hedging_config.max_burst)
     logging.log(logging.INFO, 'MetadataStore with gRPC connection initialized')
     logging.log(logging.DEBUG, 'ConnectionConfig: %s', config)
 
-  def _get_channel(self, config: proto.MetadataStoreClientConfig):
+  def _get_channel(self,
+                   config: proto.MetadataStoreClientConfig,
+                   target: Optional[Text] = None,
+                   use_local_subchannel_pool: bool = False):
     """Configures the channel, which could be secure or insecure.
 
     It returns a channel that can be specified to be secure or insecure,
@@ -123,20 +143,27 @@ class MetadataStore(object):
 
     Args:
       config: proto.MetadataStoreClientConfig.
+      target: the "host:port" to connect to, instead of the server of the
+        config.
+      use_local_subchannel_pool: if set to True, the channel does not share
+        its connections with the other channels to the same target.
 
     Returns:
       an initialized gRPC channel.
     """
-    target = ':'.join([config.host, str(config.port)])
+    target = target or ':'.join([config.host, str(config.port)])
 
     if config.HasField('client_timeout_sec'):
       self._grpc_timeout_sec = config.client_timeout_sec
 
-    options = None
+    options = []
     if (config.HasField('channel_arguments') and
         config.channel_arguments.HasField('max_receive_message_length')):
-      options = [('grpc.max_receive_message_length',
-                  config.channel_arguments.max_receive_message_length)]
+      options.append(('grpc.max_receive_message_length',
+                      config.channel_arguments.max_receive_message_length))
+    if use_local_subchannel_pool:
+      options.append(('grpc.use_local_subchannel_pool', 1))
+    options = options or None
 
     if not config.HasField('ssl_config'):
       return grpc.insecure_channel(target, options=options)
@@ -167,11 +194,16 @@ class MetadataStore(object):
     Returns:
       Detailed errors if the method is failed.
     """
+    return self._retry_if_aborted(
+        method_name, lambda: self._call_method(method_name, request, response))
+
+  def _retry_if_aborted(self, method_name, call):
+    """Calls `call` with retry when Aborted error is raised."""
     num_retries = self._max_num_retries
     avg_delay_sec = 2
     while True:
       try:
-        return self._call_method(method_name, request, response)
+        return call()
       except errors.AbortedError:
         num_retries -= 1
         if num_retries == 0:
@@ -196,13 +228,55 @@ class MetadataStore(object):
     else:
       grpc_method = getattr(self._metadata_store_stub, method_name)
       try:
-        response.CopyFrom(grpc_method(request, timeout=self._grpc_timeout_sec))
+        if self._hedge_stubs and method_name.startswith('Get'):
+          response.CopyFrom(self._hedged_grpc_call(method_name, request))
+        else:
+          response.CopyFrom(
+              grpc_method(request, timeout=self._grpc_timeout_sec))
       except grpc.RpcError as e:
         # RpcError code uses a tuple to specify error code and short
         # description.
         # https://grpc.github.io/grpc/python/_modules/grpc.html#StatusCode
         raise _make_exception(e.details(), e.code().value[0])  # pytype: disable=attribute-error
 
+  def _hedged_grpc_call(self, method_name, request):
+    """Sends a read to the server, and to a hedge server if it is slow.
+
+    Args:
+      method_name: the gRPC method of the read.
+      request: the request protobuf message.
+
+    Returns:
+      the first response of the calls.
+
+    Raises:
+      grpc.RpcError: the error of the call to the server, if both calls fail.
+    """
+    self._hedge_budget.earn()
+    call = getattr(self._metadata_store_stub, method_name).future(
+        request, timeout=self._grpc_timeout_sec)
+    try:
+      return call.result(timeout=self._hedge_delay_sec)
+    except grpc.FutureTimeoutError:
+      pass
+    if not self._hedge_budget.try_spend():
+      return call.result()
+    hedge_stub = self._hedge_stubs[
+        next(self._hedge_stub_indexes) % len(self._hedge_stubs)]
+    hedged_call = getattr(hedge_stub, method_name).future(
+        request, timeout=self._grpc_timeout_sec)
+    done_calls = queue.Queue()
+    call.add_done_callback(done_calls.put)
+    hedged_call.add_done_callback(done_calls.put)
+    for _ in range(2):
+      done_call = done_calls.get()
+      if done_call.exception() is None:
+        # The slower call is not needed anymore.
+        call.cancel()
+        hedged_call.cancel()
+        return done_call.result()
+    return call.result()
+
   def _pywrap_cc_call(self, method, request, response) -> None:
     """Calls method, serializing and deserializing inputs and outputs.
 
@@ -226,6 +300,48 @@ class MetadataStore(object):
       raise _make_exception(error_message.decode('utf-8'), status_code)
     response.ParseFromString(response_str)
 
+  def _call_in_batch(self, requests, responses) -> bool:
+    """Calls the methods of `requests` in one transaction of the DB connection.
+
+    Args:
+      requests: a list of (method name, request) pairs of PutExecution and
+        PutEvents calls.
+      responses: the protobuf messages filled from the results of the calls.
+
+    Returns:
+      False if the backend does not support batches, and nothing is called.
+
+    Raises:
+      Error: the error of the transaction, which is retried when Aborted, or
+        else the error of the first failed call.
+    """
+    serialized_requests = [(method_name, request.SerializeToString())
+                           for method_name, request in requests]
+
+    def call_batch():
+      [results, error_message, status_code] = (
+          metadata_store_serialized.PutInBatch(self._metadata_store,
+                                               serialized_requests))
+      if status_code != 0:
+        raise _make_exception(error_message.decode('utf-8'), status_code)
+      return results
+
+    try:
+      results = self._retry_if_aborted('PutInBatch', call_batch)
+    except errors.UnimplementedError:
+      return False
+    first_error = None
+    for [response_str, error_message, status_code], response in zip(
+        results, responses):
+      if status_code != 0:
+        first_error = first_error or _make_exception(
+            error_message.decode('utf-8'), status_code)
+        continue
+      response.ParseFromString(response_str)
+    if first_error:
+      raise first_error
+    return True
+
   def put_artifacts(self, artifacts: Sequence[proto.Artifact]) -> List[int]:
     """Inserts or updates artifacts in the database.
 
@@ -563,22 +679,58 @@ class MetadataStore(object):
       errors.AlreadyExistsError: If the new nodes to be created is already
         exists. Please refer to AlreadyExists errors in other put methods.
     """
-    request = metadata_store_service_pb2.PutExecutionRequest(
-        execution=execution,
-        contexts=(context for context in contexts),
-        options=metadata_store_service_pb2.PutExecutionRequest.Options(
-            reuse_context_if_already_exist=reuse_context_if_already_exist))
-    # Add artifact_and_event pairs to the request.
-    for pair in artifact_and_events:
-      if pair:
-        request.artifact_event_pairs.add(
-            artifact=pair[0], event=pair[1] if len(pair) == 2 else None)
+    request = _make_put_execution_request(execution, artifact_and_events,
+                                          contexts,
+                                          reuse_context_if_already_exist)
     response = metadata_store_service_pb2.PutExecutionResponse()
     self._call('PutExecution', request, response)
     artifact_ids = [x for x in response.artifact_ids]
     context_ids = [x for x in response.context_ids]
     return response.execution_id, artifact_ids, context_ids
 
+  def put_executions_in_batch(
+      self,
+      executions: Sequence[Tuple[proto.Execution,
+                                 Sequence[Tuple[proto.Artifact,
+                                                Optional[proto.Event]]],
+                                 Optional[Sequence[proto.Context]]]],
+      reuse_context_if_already_exist: bool = False
+  ) -> List[Tuple[int, List[int], List[int]]]:
+    """Runs several put_execution calls in one transaction.
+
+    With a DB connection, the calls share one commit, which saves the commit
+    latency of all but one of them. Each call is still applied atomically on
+    its own: a failed call does not prevent the others from being committed.
+    With a gRPC connection, or if the backend does not support batches, the
+    calls run one after another.
+
+    Args:
+      executions: a list of (execution, artifact_and_events, contexts) tuples,
+        each given as the arguments of put_execution.
+      reuse_context_if_already_exist: see put_execution.
+
+    Returns:
+      the result of put_execution for each of the `executions`.
+
+    Raises:
+      Error: the error of the first failed call, after the other calls are
+        committed.
+    """
+    requests = [
+        _make_put_execution_request(execution, artifact_and_events, contexts,
+                                    reuse_context_if_already_exist)
+        for execution, artifact_and_events, contexts in executions
+    ]
+    responses = [
+        metadata_store_service_pb2.PutExecutionResponse() for _ in requests
+    ]
+    if not self._using_db_connection or not self._call_in_batch(
+        [('PutExecution', request) for request in requests], responses):
+      for request, response in zip(requests, responses):
+        self._call('PutExecution', request, response)
+    return [(response.execution_id, list(response.artifact_ids),
+             list(response.context_ids)) for response in responses]
+
   def get_artifacts_by_type(
       self,
       type_name: Text,
@@ -1456,6 +1608,417 @@ class MetadataStore(object):
     return result
 
 
+class _HedgeBudget(object):
+  """The hedges of the reads of a MetadataStore, shared by its threads.
+
+  Each read earns a fraction of a hedge, so that the hedged reads are at most
+  the given ratio of the reads, besides a burst of hedges earned earlier.
+  """
+
+  def __init__(self, max_hedge_ratio: float, max_burst: float):
+    self._lock = threading.Lock()
+    self._max_hedge_ratio = max_hedge_ratio
+    self._max_burst = max_burst
+    self._hedges = 0.0
+
+  def earn(self) -> None:
+    """Earns the hedges of a read."""
+    with self._lock:
+      self._hedges = min(self._max_burst,
+                         self._hedges + self._max_hedge_ratio)
+
+  def try_spend(self) -> bool:
+    """Spends a hedge if one is earned, and returns whether it was."""
+    with self._lock:
+      if self._hedges < 1:
+        return False
+      self._hedges -= 1
+      return True
+
+
+class AsyncMetadataStore(object):
+  """An asyncio API to the metadata store with a DB connection.
+
+  The calls run on a pool of native threads, each with its own connection to
+  the database, and resolve asyncio futures once they finish, so that many
+  concurrent calls do not need as many python threads. The methods are async
+  versions of the ones of MetadataStore with the same names.
+
+  Usage example:
+
+    store = AsyncMetadataStore(connection_config)
+    artifacts, executions = await asyncio.gather(
+        store.get_artifacts_by_id(artifact_ids),
+        store.get_executions_by_id(execution_ids))
+  """
+
+  def __init__(self,
+               config: proto.ConnectionConfig,
+               num_threads: int = 16,
+               enable_upgrade_migration: bool = False):
+    """Initialize the AsyncMetadataStore.
+
+    Args:
+      config: `proto.ConnectionConfig`. Configuration to connect to the
+        database.
+      num_threads: the max number of calls running at once, each holding a
+        connection to the database. The calls with an in-memory database run
+        one at a time on a single connection, as each connection has its own
+        database.
+      enable_upgrade_migration: if set to True, the library upgrades the db
+        schema and migrates all data if it connects to an old version backend.
+    """
+    if not isinstance(config, proto.ConnectionConfig):
+      raise ValueError('AsyncMetadataStore is expecting proto.ConnectionConfig')
+    self._max_num_retries = 5
+    if config.HasField('retry_options'):
+      self._max_num_retries = config.retry_options.max_num_retries
+    migration_options = metadata_store_pb2.MigrationOptions()
+    migration_options.enable_upgrade_migration = enable_upgrade_migration
+    self._metadata_store_pool = (
+        metadata_store_serialized.CreateMetadataStorePool(
+            config.SerializeToString(), migration_options.SerializeToString(),
+            num_threads))
+    logging.log(logging.INFO,
+                'AsyncMetadataStore with DB connection initialized')
+    logging.log(logging.DEBUG, 'ConnectionConfig: %s', config)
+
+  async def _call(self, method_name, request, response) -> None:
+    """Calls method with retry when Aborted error is returned."""
+    num_retries = self._max_num_retries
+    avg_delay_sec = 2
+    while True:
+      try:
+        return await self._call_async(method_name, request, response)
+      except errors.AbortedError:
+        num_retries -= 1
+        if num_retries == 0:
+          logging.log(logging.ERROR, '%s failed after retrying %d times.',
+                      method_name, self._max_num_retries)
+          raise
+        wait_seconds = random.expovariate(1.0 / avg_delay_sec)
+        logging.log(logging.INFO, 'mlmd client retry in %f secs', wait_seconds)
+        await asyncio.sleep(wait_seconds)
+
+  async def _call_async(self, method_name, request, response) -> None:
+    """Calls method on the native threads and waits for the result.
+
+    Args:
+      method_name: the method to call in wrapped C++ library.
+      request: a protobuf message, serialized and sent to the method.
+      response: a protobuf message, filled from the return value of the method.
+
+    Raises:
+      Error: ml_metadata error returned by the method.
+    """
+    loop = asyncio.get_event_loop()
+    future = loop.create_future()
+
+    def set_result(result):
+      # The caller may have stopped waiting, e.g., as it is cancelled.
+      if not future.done():
+        future.set_result(result)
+
+    def on_done(response_str, error_message, status_code):
+      # Runs on a native thread, which hands the result to the event loop.
+      try:
+        loop.call_soon_threadsafe(set_result,
+                                  (response_str, error_message, status_code))
+      except RuntimeError:
+        # The event loop is closed, nobody waits for the result.
+        pass
+
+    metadata_store_serialized.CallAsync(self._metadata_store_pool, method_name,
+                                        request.SerializeToString(), on_done)
+    [response_str, error_message, status_code] = await future
+    if status_code != 0:
+      raise _make_exception(error_message.decode('utf-8'), status_code)
+    response.ParseFromString(response_str)
+
+  async def put_artifacts(self,
+                          artifacts: Sequence[proto.Artifact]) -> List[int]:
+    """See MetadataStore.put_artifacts."""
+    request = metadata_store_service_pb2.PutArtifactsRequest()
+    for x in artifacts:
+      request.artifacts.add().CopyFrom(x)
+    response = metadata_store_service_pb2.PutArtifactsResponse()
+    await self._call('PutArtifacts', request, response)
+    return list(response.artifact_ids)
+
+  async def put_executions(self,
+                           executions: Sequence[proto.Execution]) -> List[int]:
+    """See MetadataStore.put_executions."""
+    request = metadata_store_service_pb2.PutExecutionsRequest()
+    for x in executions:
+      request.executions.add().CopyFrom(x)
+    response = metadata_store_service_pb2.PutExecutionsResponse()
+    await self._call('PutExecutions', request, response)
+    return list(response.execution_ids)
+
+  async def put_contexts(self, contexts: Sequence[proto.Context]) -> List[int]:
+    """See MetadataStore.put_contexts."""
+    request = metadata_store_service_pb2.PutContextsRequest()
+    for x in contexts:
+      request.contexts.add().CopyFrom(x)
+    response = metadata_store_service_pb2.PutContextsResponse()
+    await self._call('PutContexts', request, response)
+    return list(response.context_ids)
+
+  async def put_events(self, events: Sequence[proto.Event]) -> None:
+    """See MetadataStore.put_events."""
+    request = metadata_store_service_pb2.PutEventsRequest()
+    for x in events:
+      request.events.add().CopyFrom(x)
+    response = metadata_store_service_pb2.PutEventsResponse()
+    await self._call('PutEvents', request, response)
+
+  async def put_execution(
+      self,
+      execution: proto.Execution,
+      artifact_and_events: Sequence[Tuple[proto.Artifact,
+                                          Optional[proto.Event]]],
+      contexts: Optional[Sequence[proto.Context]],
+      reuse_context_if_already_exist: bool = False
+  ) -> Tuple[int, List[int], List[int]]:
+    """See MetadataStore.put_execution."""
+    request = _make_put_execution_request(execution, artifact_and_events,
+                                          contexts,
+                                          reuse_context_if_already_exist)
+    response = metadata_store_service_pb2.PutExecutionResponse()
+    await self._call('PutExecution', request, response)
+    return (response.execution_id, list(response.artifact_ids),
+            list(response.context_ids))
+
+  async def get_artifact_type(
+      self,
+      type_name: Text,
+      type_version: Optional[Text] = None) -> proto.ArtifactType:
+    """See MetadataStore.get_artifact_type."""
+    request = metadata_store_service_pb2.GetArtifactTypeRequest()
+    request.type_name = type_name
+    if type_version:
+      request.type_version = type_version
+    response = metadata_store_service_pb2.GetArtifactTypeResponse()
+    await self._call('GetArtifactType', request, response)
+    return response.artifact_type
+
+  async def get_execution_type(
+      self,
+      type_name: Text,
+      type_version: Optional[Text] = None) -> proto.ExecutionType:
+    """See MetadataStore.get_execution_type."""
+    request = metadata_store_service_pb2.GetExecutionTypeRequest()
+    request.type_name = type_name
+    if type_version:
+      request.type_version = type_version
+    response = metadata_store_service_pb2.GetExecutionTypeResponse()
+    await self._call('GetExecutionType', request, response)
+    return response.execution_type
+
+  async def get_context_type(
+      self,
+      type_name: Text,
+      type_version: Optional[Text] = None) -> proto.ContextType:
+    """See MetadataStore.get_context_type."""
+    request = metadata_store_service_pb2.GetContextTypeRequest()
+    request.type_name = type_name
+    if type_version:
+      request.type_version = type_version
+    response = metadata_store_service_pb2.GetContextTypeResponse()
+    await self._call('GetContextType', request, response)
+    return response.context_type
+
+  async def get_artifacts_by_id(
+      self, artifact_ids: Iterable[int]) -> List[proto.Artifact]:
+    """See MetadataStore.get_artifacts_by_id."""
+    request = metadata_store_service_pb2.GetArtifactsByIDRequest()
+    request.artifact_ids.extend(artifact_ids)
+    response = metadata_store_service_pb2.GetArtifactsByIDResponse()
+    await self._call('GetArtifactsByID', request, response)
+    return list(response.artifacts)
+
+  async def get_executions_by_id(
+      self, execution_ids: Iterable[int]) -> List[proto.Execution]:
+    """See MetadataStore.get_executions_by_id."""
+    request = metadata_store_service_pb2.GetExecutionsByIDRequest()
+    request.execution_ids.extend(execution_ids)
+    response = metadata_store_service_pb2.GetExecutionsByIDResponse()
+    await self._call('GetExecutionsByID', request, response)
+    return list(response.executions)
+
+  async def get_contexts_by_id(
+      self, context_ids: Iterable[int]) -> List[proto.Context]:
+    """See MetadataStore.get_contexts_by_id."""
+    request = metadata_store_service_pb2.GetContextsByIDRequest()
+    request.context_ids.extend(context_ids)
+    response = metadata_store_service_pb2.GetContextsByIDResponse()
+    await self._call('GetContextsByID', request, response)
+    return list(response.contexts)
+
+  async def get_contexts_by_artifact(
+      self, artifact_id: int) -> List[proto.Context]:
+    """See MetadataStore.get_contexts_by_artifact."""
+    request = metadata_store_service_pb2.GetContextsByArtifactRequest()
+    request.artifact_id = artifact_id
+    response = metadata_store_service_pb2.GetContextsByArtifactResponse()
+    await self._call('GetContextsByArtifact', request, response)
+    return list(response.contexts)
+
+  async def get_contexts_by_execution(
+      self, execution_id: int) -> List[proto.Context]:
+    """See MetadataStore.get_contexts_by_execution."""
+    request = metadata_store_service_pb2.GetContextsByExecutionRequest()
+    request.execution_id = execution_id
+    response = metadata_store_service_pb2.GetContextsByExecutionResponse()
+    await self._call('GetContextsByExecution', request, response)
+    return list(response.contexts)
+
+  async def get_events_by_execution_ids(
+      self, execution_ids: Iterable[int]) -> List[proto.Event]:
+    """See MetadataStore.get_events_by_execution_ids."""
+    request = metadata_store_service_pb2.GetEventsByExecutionIDsRequest()
+    request.execution_ids.extend(execution_ids)
+    response = metadata_store_service_pb2.GetEventsByExecutionIDsResponse()
+    await self._call('GetEventsByExecutionIDs', request, response)
+    return list(response.events)
+
+  async def get_events_by_artifact_ids(
+      self, artifact_ids: Iterable[int]) -> List[proto.Event]:
+    """See MetadataStore.get_events_by_artifact_ids."""
+    request = metadata_store_service_pb2.GetEventsByArtifactIDsRequest()
+    request.artifact_ids.extend(artifact_ids)
+    response = metadata_store_service_pb2.GetEventsByArtifactIDsResponse()
+    await self._call('GetEventsByArtifactIDs', request, response)
+    return list(response.events)
+
+
+class WriteBehindMetadataStore(object):
+  """Writes the executions and events behind the caller with a DB connection.
+
+  The put_execution and put_events calls return once their requests are
+  logged in a local directory, and a native thread writes the logged requests
+  in batches, in the order they were queued. The requests left in the
+  directory, e.g., when the process was killed, are written by the next queue
+  of the directory. As the calls do not wait for the writes, they return no
+  ids, and a call which fails later is logged and dropped, so the queue fits
+  the writes which are not critical to the caller, e.g., the metadata of the
+  steps of a training loop.
+
+  Usage example:
+
+    store = WriteBehindMetadataStore(connection_config, '/tmp/mlmd_queue')
+    store.put_execution(execution, artifact_and_events, contexts)
+    ...
+    store.flush()
+  """
+
+  def __init__(self,
+               config: proto.ConnectionConfig,
+               directory: Text,
+               max_batch_size: int = 64,
+               max_latency_sec: float = 0.05,
+               sync_on_enqueue: bool = True,
+               enable_upgrade_migration: bool = False):
+    """Initialize the WriteBehindMetadataStore.
+
+    Args:
+      config: `proto.ConnectionConfig`. Configuration to connect to the
+        database.
+      directory: the directory of the log of the queued requests, which must
+        not be shared by queues running at the same time.
+      max_batch_size: the max number of requests written in one transaction.
+      max_latency_sec: the max time a request waits for more requests to be
+        written with.
+      sync_on_enqueue: if set to True, a request is synced to disk before the
+        call returns, so that it survives a crash of the host.
+      enable_upgrade_migration: if set to True, the library upgrades the db
+        schema and migrates all data if it connects to an old version backend.
+    """
+    if not isinstance(config, proto.ConnectionConfig):
+      raise ValueError(
+          'WriteBehindMetadataStore is expecting proto.ConnectionConfig')
+    migration_options = metadata_store_pb2.MigrationOptions()
+    migration_options.enable_upgrade_migration = enable_upgrade_migration
+    self._write_behind_queue = (
+        metadata_store_serialized.CreateWriteBehindQueue(
+            config.SerializeToString(), migration_options.SerializeToString(),
+            directory, max_batch_size, max_latency_sec, sync_on_enqueue))
+    logging.log(logging.INFO,
+                'WriteBehindMetadataStore with DB connection initialized')
+    logging.log(logging.DEBUG, 'ConnectionConfig: %s', config)
+
+  def _write_behind(self, method_name, request) -> None:
+    [error_message, status_code] = metadata_store_serialized.WriteBehind(
+        self._write_behind_queue, method_name, request.SerializeToString())
+    if status_code != 0:
+      raise _make_exception(error_message.decode('utf-8'), status_code)
+
+  def put_events(self, events: Sequence[proto.Event]) -> None:
+    """Queues the events to be inserted in the database.
+
+    The execution_id and artifact_id must exist once the events are written.
+
+    Args:
+      events: A list of events to insert.
+
+    Raises:
+      Error: if the request cannot be logged.
+    """
+    request = metadata_store_service_pb2.PutEventsRequest()
+    for x in events:
+      request.events.add().CopyFrom(x)
+    self._write_behind('PutEvents', request)
+
+  def put_execution(
+      self,
+      execution: proto.Execution,
+      artifact_and_events: Sequence[Tuple[proto.Artifact,
+                                          Optional[proto.Event]]],
+      contexts: Optional[Sequence[proto.Context]],
+      reuse_context_if_already_exist: bool = False) -> None:
+    """Queues an Execution with artifacts, events and contexts to be written.
+
+    The arguments are the ones of MetadataStore.put_execution, whose ids are
+    not returned, as the execution is written after the call returns.
+
+    Args:
+      execution: The execution to be created or updated.
+      artifact_and_events: a pair of Artifact and Event that the execution uses
+        or generates.
+      contexts: The Contexts that the execution should be associated with and
+        the artifacts should be attributed to.
+      reuse_context_if_already_exist: if set to True, the writes reuse the
+        stored context of the same name, instead of failing.
+
+    Raises:
+      Error: if the request cannot be logged.
+    """
+    request = _make_put_execution_request(execution, artifact_and_events,
+                                          contexts,
+                                          reuse_context_if_already_exist)
+    self._write_behind('PutExecution', request)
+
+  def flush(self, timeout_sec: float = 60.0) -> None:
+    """Waits until the calls queued before are written, or have failed.
+
+    Args:
+      timeout_sec: the max time to wait.
+
+    Raises:
+      errors.DeadlineExceededError: if the calls are not written in time.
+    """
+    [error_message, status_code] = (
+        metadata_store_serialized.FlushWriteBehindQueue(
+            self._write_behind_queue, timeout_sec))
+    if status_code != 0:
+      raise _make_exception(error_message.decode('utf-8'), status_code)
+
+  def get_stats(self) -> Tuple[int, int, int]:
+    """Returns the numbers of the pending, written and failed calls."""
+    return metadata_store_serialized.GetWriteBehindQueueStats(
+        self._write_behind_queue)
+
+
 def downgrade_schema(config: proto.ConnectionConfig,
                      downgrade_to_schema_version: int) -> None:
   """Downgrades the db specified in the connection config to a schema version.
@@ -1497,6 +2060,26 @@ def downgrade_schema(config: proto.ConnectionConfig,
     logging.log(logging.INFO, str(e))
 
 
+def _make_put_execution_request(
+    execution: proto.Execution,
+    artifact_and_events: Sequence[Tuple[proto.Artifact, Optional[proto.Event]]],
+    contexts: Optional[Sequence[proto.Context]],
+    reuse_context_if_already_exist: bool
+) -> metadata_store_service_pb2.PutExecutionRequest:
+  """Makes the request of a put_execution call with the given arguments."""
+  request = metadata_store_service_pb2.PutExecutionRequest(
+      execution=execution,
+      contexts=(context for context in contexts),
+      options=metadata_store_service_pb2.PutExecutionRequest.Options(
+          reuse_context_if_already_exist=reuse_context_if_already_exist))
+  # Add artifact_and_event pairs to the request.
+  for pair in artifact_and_events:
+    if pair:
+      request.artifact_event_pairs.add(
+          artifact=pair[0], event=pair[1] if len(pair) == 2 else None)
+  return request
+
+
 def _make_exception(msg, error_code):
   """Makes an exception with MLMD error code.
 
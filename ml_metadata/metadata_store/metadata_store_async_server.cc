@@ -0,0 +1,384 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
+
+#include <chrono>  // NOLINT
+#include <functional>
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "grpcpp/completion_queue.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/async_stream.h"
+#include "grpcpp/support/async_unary_call.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+using AsyncService = MetadataStoreAsyncServer::AsyncService;
+
+// The state shared by the calls of a completion queue.
+struct CallEnvironment {
+  AsyncService* async_service;
+  ::grpc::ServerCompletionQueue* completion_queue;
+  tensorflow::thread::ThreadPool* executor;
+  MetadataStoreServiceImpl* service_impl;
+};
+
+// A call of a method, which is the tag of its operations on the completion
+// queue. A call first waits to be received, then runs on the executor and
+// finally deletes itself once its response is sent.
+class Call {
+ public:
+  virtual ~Call() = default;
+
+  // Called by the polling thread when an operation of the call completes.
+  // `ok` is false if the operation failed, e.g., when the server is shutting
+  // down or the client is gone.
+  virtual void Proceed(bool ok) = 0;
+};
+
+// Returns DEADLINE_EXCEEDED if the deadline of a call has passed while it was
+// queued for the executor, so that an expired call does not use the database.
+::grpc::Status CheckDeadline(const ::grpc::ServerContext& context) {
+  if (context.deadline() < std::chrono::system_clock::now()) {
+    return ::grpc::Status(::grpc::StatusCode::DEADLINE_EXCEEDED,
+                          "The deadline passed before the call was run.");
+  }
+  return ::grpc::Status::OK;
+}
+
+// A call of a unary method.
+template <typename Request, typename Response>
+class UnaryCall final : public Call {
+ public:
+  // Requests the next call of the method from the service.
+  using RequestMethod = void (AsyncService::*)(
+      ::grpc::ServerContext*, Request*,
+      ::grpc::ServerAsyncResponseWriter<Response>*, ::grpc::CompletionQueue*,
+      ::grpc::ServerCompletionQueue*, void*);
+  // Handles a received call.
+  using HandleMethod = ::grpc::Status (MetadataStoreServiceImpl::*)(
+      ::grpc::ServerContext*, const Request*, Response*);
+
+  // Waits for a call of the method. The call deletes itself.
+  static void Await(const CallEnvironment& environment,
+                    const RequestMethod request_method,
+                    const HandleMethod handle_method) {
+    new UnaryCall(environment, request_method, handle_method);
+  }
+
+  void Proceed(const bool ok) override {
+    if (!ok || is_finished_) {
+      delete this;
+      return;
+    }
+    // Waits for the next call of the method before running this one.
+    Await(environment_, request_method_, handle_method_);
+    environment_.executor->Schedule([this]() {
+      ::grpc::Status status = CheckDeadline(context_);
+      if (status.ok()) {
+        status = (environment_.service_impl->*handle_method_)(
+            &context_, &request_, &response_);
+      }
+      is_finished_ = true;
+      responder_.Finish(response_, status, this);
+    });
+  }
+
+ private:
+  UnaryCall(const CallEnvironment& environment,
+            const RequestMethod request_method,
+            const HandleMethod handle_method)
+      : environment_(environment),
+        request_method_(request_method),
+        handle_method_(handle_method),
+        responder_(&context_) {
+    (environment_.async_service->*request_method_)(
+        &context_, &request_, &responder_, environment_.completion_queue,
+        environment_.completion_queue, this);
+  }
+
+  const CallEnvironment environment_;
+  const RequestMethod request_method_;
+  const HandleMethod handle_method_;
+  ::grpc::ServerContext context_;
+  Request request_;
+  Response response_;
+  ::grpc::ServerAsyncResponseWriter<Response> responder_;
+  bool is_finished_ = false;
+};
+
+// A call of a server streaming method. The executor thread running the call
+// waits for each Write to complete before reading the next response, so that
+// the responses are read at the pace at which the client consumes them.
+template <typename Request, typename Response>
+class StreamingCall final : public Call {
+ public:
+  // Requests the next call of the method from the service.
+  using RequestMethod = void (AsyncService::*)(
+      ::grpc::ServerContext*, Request*, ::grpc::ServerAsyncWriter<Response>*,
+      ::grpc::CompletionQueue*, ::grpc::ServerCompletionQueue*, void*);
+  // Handles a received call by writing its responses with a write function.
+  using HandleMethod = ::grpc::Status (MetadataStoreServiceImpl::*)(
+      const Request&, const std::function<bool(const Response&)>&);
+
+  // Waits for a call of the method. The call deletes itself.
+  static void Await(const CallEnvironment& environment,
+                    const RequestMethod request_method,
+                    const HandleMethod handle_method) {
+    new StreamingCall(environment, request_method, handle_method);
+  }
+
+  void Proceed(const bool ok) override {
+    switch (state_) {
+      case State::kReceiving:
+        if (!ok) {
+          delete this;
+          return;
+        }
+        // Waits for the next call of the method before running this one.
+        Await(environment_, request_method_, handle_method_);
+        state_ = State::kWriting;
+        environment_.executor->Schedule([this]() { Run(); });
+        return;
+      case State::kWriting: {
+        absl::MutexLock lock(&mu_);
+        is_write_ok_ = ok;
+        is_write_done_ = true;
+        return;
+      }
+      case State::kFinishing:
+        delete this;
+        return;
+    }
+  }
+
+ private:
+  enum class State { kReceiving, kWriting, kFinishing };
+
+  StreamingCall(const CallEnvironment& environment,
+                const RequestMethod request_method,
+                const HandleMethod handle_method)
+      : environment_(environment),
+        request_method_(request_method),
+        handle_method_(handle_method),
+        writer_(&context_) {
+    (environment_.async_service->*request_method_)(
+        &context_, &request_, &writer_, environment_.completion_queue,
+        environment_.completion_queue, this);
+  }
+
+  // Runs the call on the executor.
+  void Run() {
+    ::grpc::Status status = CheckDeadline(context_);
+    if (status.ok()) {
+      status = (environment_.service_impl->*handle_method_)(
+          request_,
+          [this](const Response& response) { return Write(response); });
+    }
+    state_ = State::kFinishing;
+    writer_.Finish(status, this);
+  }
+
+  // Writes a response and waits for the write to complete. Returns false if
+  // the client closed the stream.
+  bool Write(const Response& response) {
+    absl::MutexLock lock(&mu_);
+    is_write_done_ = false;
+    writer_.Write(response, this);
+    mu_.Await(absl::Condition(&is_write_done_));
+    return is_write_ok_;
+  }
+
+  const CallEnvironment environment_;
+  const RequestMethod request_method_;
+  const HandleMethod handle_method_;
+  ::grpc::ServerContext context_;
+  Request request_;
+  ::grpc::ServerAsyncWriter<Response> writer_;
+  State state_ = State::kReceiving;
+
+  absl::Mutex mu_;
+  bool is_write_done_ ABSL_GUARDED_BY(mu_) = false;
+  bool is_write_ok_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+// Waits for the calls of every method of the service on a completion queue.
+void AwaitCalls(const CallEnvironment& environment) {
+#define MLMD_AWAIT_UNARY_CALL(method)                 \
+  UnaryCall<method##Request, method##Response>::Await( \
+      environment, &AsyncService::Request##method,     \
+      &MetadataStoreServiceImpl::method);
+
+#define MLMD_AWAIT_RAW_UNARY_CALL(method)                   \
+  UnaryCall<::grpc::ByteBuffer, ::grpc::ByteBuffer>::Await( \
+      environment, &AsyncService::Request##method,          \
+      &MetadataStoreServiceImpl::method);
+
+#define MLMD_AWAIT_STREAMING_CALL(method)                 \
+  StreamingCall<method##Request, method##Response>::Await( \
+      environment, &AsyncService::Request##method,         \
+      &MetadataStoreServiceImpl::method);
+
+  MLMD_AWAIT_UNARY_CALL(PutArtifactType)
+  MLMD_AWAIT_UNARY_CALL(PutExecutionType)
+  MLMD_AWAIT_UNARY_CALL(PutContextType)
+  MLMD_AWAIT_UNARY_CALL(PutTypes)
+  MLMD_AWAIT_UNARY_CALL(PutArtifacts)
+  MLMD_AWAIT_UNARY_CALL(PutExecutions)
+  MLMD_AWAIT_UNARY_CALL(PutEvents)
+  MLMD_AWAIT_UNARY_CALL(PutExecution)
+  MLMD_AWAIT_UNARY_CALL(PutContexts)
+  MLMD_AWAIT_UNARY_CALL(PutAttributionsAndAssociations)
+  MLMD_AWAIT_UNARY_CALL(PutParentContexts)
+  MLMD_AWAIT_UNARY_CALL(DeleteArtifacts)
+  MLMD_AWAIT_UNARY_CALL(DeleteExecutions)
+  MLMD_AWAIT_UNARY_CALL(CollectGarbage)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactType)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactTypesByID)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactTypes)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionType)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionTypesByID)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionTypes)
+  MLMD_AWAIT_UNARY_CALL(GetContextType)
+  MLMD_AWAIT_UNARY_CALL(GetContextTypesByID)
+  MLMD_AWAIT_UNARY_CALL(GetContextTypes)
+  MLMD_AWAIT_UNARY_CALL(GetArtifacts)
+  MLMD_AWAIT_UNARY_CALL(GetExecutions)
+  MLMD_AWAIT_UNARY_CALL(GetContexts)
+  MLMD_AWAIT_STREAMING_CALL(StreamArtifacts)
+  MLMD_AWAIT_STREAMING_CALL(StreamExecutions)
+  MLMD_AWAIT_STREAMING_CALL(StreamContexts)
+  MLMD_AWAIT_STREAMING_CALL(StreamNodeColumns)
+  MLMD_AWAIT_STREAMING_CALL(WatchChanges)
+  MLMD_AWAIT_RAW_UNARY_CALL(GetArtifactsByID)
+  MLMD_AWAIT_RAW_UNARY_CALL(GetExecutionsByID)
+  MLMD_AWAIT_RAW_UNARY_CALL(GetContextsByID)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByType)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionsByType)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByType)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactByTypeAndName)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionByTypeAndName)
+  MLMD_AWAIT_UNARY_CALL(GetContextByTypeAndName)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByTypeAndNames)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionsByTypeAndNames)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByTypeAndNames)
+  MLMD_AWAIT_UNARY_CALL(CountArtifacts)
+  MLMD_AWAIT_UNARY_CALL(CountExecutions)
+  MLMD_AWAIT_UNARY_CALL(CountContexts)
+  MLMD_AWAIT_UNARY_CALL(AggregateProperty)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByURI)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByURIPrefix)
+  MLMD_AWAIT_UNARY_CALL(ArtifactsExist)
+  MLMD_AWAIT_UNARY_CALL(GetEventsByExecutionIDs)
+  MLMD_AWAIT_UNARY_CALL(GetEventsByArtifactIDs)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByArtifact)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByExecution)
+  MLMD_AWAIT_UNARY_CALL(GetParentContextsByContext)
+  MLMD_AWAIT_UNARY_CALL(GetChildrenContextsByContext)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByContext)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionsByContext)
+  MLMD_AWAIT_UNARY_CALL(GetArtifactsByContexts)
+  MLMD_AWAIT_UNARY_CALL(GetExecutionsByContexts)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByArtifacts)
+  MLMD_AWAIT_UNARY_CALL(GetContextsByExecutions)
+  MLMD_AWAIT_UNARY_CALL(GetLineageGraph)
+  MLMD_AWAIT_UNARY_CALL(GetLineageClosure)
+  MLMD_AWAIT_UNARY_CALL(BeginReadSession)
+  MLMD_AWAIT_UNARY_CALL(EndReadSession)
+
+#undef MLMD_AWAIT_UNARY_CALL
+#undef MLMD_AWAIT_RAW_UNARY_CALL
+#undef MLMD_AWAIT_STREAMING_CALL
+}
+
+}  // namespace
+
+MetadataStoreAsyncServer::MetadataStoreAsyncServer(
+    MetadataStoreServiceImpl* service_impl,
+    const MetadataStoreAsyncServerOptions& options)
+    : service_impl_(service_impl), options_(options) {
+  CHECK(service_impl_ != nullptr) << "The service_impl must not be null.";
+  CHECK_GT(options_.num_completion_queues, 0)
+      << "The num_completion_queues must be positive.";
+  CHECK_GT(options_.num_executor_threads, 0)
+      << "The num_executor_threads must be positive.";
+}
+
+MetadataStoreAsyncServer::~MetadataStoreAsyncServer() { Shutdown(); }
+
+tensorflow::Status MetadataStoreAsyncServer::Start(
+    ::grpc::ServerBuilder* builder) {
+  CHECK(server_ == nullptr) << "The server can only be started once.";
+  builder->RegisterService(&async_service_);
+  for (int i = 0; i < options_.num_completion_queues; i++) {
+    completion_queues_.push_back(builder->AddCompletionQueue());
+  }
+  server_ = builder->BuildAndStart();
+  if (server_ == nullptr) {
+    return tensorflow::errors::Internal("Failed to start the gRPC server.");
+  }
+  executor_ = absl::make_unique<tensorflow::thread::ThreadPool>(
+      tensorflow::Env::Default(), "mlmd_async_server",
+      options_.num_executor_threads);
+  for (const auto& completion_queue : completion_queues_) {
+    AwaitCalls({&async_service_, completion_queue.get(), executor_.get(),
+                service_impl_});
+    polling_threads_.emplace_back(
+        &MetadataStoreAsyncServer::PollCompletionQueue, this,
+        completion_queue.get());
+  }
+  return tensorflow::Status::OK();
+}
+
+void MetadataStoreAsyncServer::Wait() {
+  if (server_ != nullptr) {
+    server_->Wait();
+  }
+}
+
+void MetadataStoreAsyncServer::Shutdown() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (is_shut_down_ || server_ == nullptr) return;
+    is_shut_down_ = true;
+  }
+  // The calls waiting to be received are cancelled, while the polling threads
+  // and the executor keep running the received ones until they finish.
+  server_->Shutdown();
+  // Waits for the calls queued on the executor.
+  executor_.reset();
+  for (const auto& completion_queue : completion_queues_) {
+    completion_queue->Shutdown();
+  }
+  for (std::thread& polling_thread : polling_threads_) {
+    polling_thread.join();
+  }
+}
+
+void MetadataStoreAsyncServer::PollCompletionQueue(
+    ::grpc::ServerCompletionQueue* completion_queue) {
+  void* tag;
+  bool ok;
+  while (completion_queue->Next(&tag, &ok)) {
+    static_cast<Call*>(tag)->Proceed(ok);
+  }
+}
+
+}  // namespace ml_metadata
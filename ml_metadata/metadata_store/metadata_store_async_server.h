@@ -0,0 +1,114 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace ml_metadata {
+
+// Options to tune a MetadataStoreAsyncServer.
+struct MetadataStoreAsyncServerOptions {
+  // The number of completion queues receiving the calls, each of which is
+  // polled by one thread. It must be positive.
+  int num_completion_queues = 1;
+  // The number of threads running the calls, i.e., the max number of calls
+  // using the database at the same time. It should be the max_size of the
+  // store pool of the service, so that a running call does not wait for a
+  // connection. It must be positive.
+  int num_executor_threads = 16;
+};
+
+// A gRPC server of MetadataStoreService using the asynchronous (completion
+// queue) API. Unlike a synchronous server, which holds a gRPC thread for each
+// call in flight while the call waits for the database, the received calls are
+// queued and run by a bounded executor, which decouples the number of
+// concurrent clients from the number of concurrent database transactions.
+// The calls are handled by the methods of a MetadataStoreServiceImpl.
+//
+// Usage example:
+//
+//   MetadataStoreServiceImpl service(connection_config, pool_options);
+//   MetadataStoreAsyncServer server(&service, async_server_options);
+//   ::grpc::ServerBuilder builder;
+//   builder.AddListeningPort(server_address, credentials);
+//   TF_CHECK_OK(server.Start(&builder));
+//   server.Wait();
+class MetadataStoreAsyncServer {
+ public:
+  // The service receiving the calls. The GetArtifactsByID, GetExecutionsByID
+  // and GetContextsByID methods are raw, so that their responses are sent as
+  // serialized by MetadataStoreServiceImpl.
+  using AsyncService = MetadataStoreService::WithRawMethod_GetArtifactsByID<
+      MetadataStoreService::WithRawMethod_GetExecutionsByID<
+          MetadataStoreService::WithRawMethod_GetContextsByID<
+              MetadataStoreService::AsyncService>>>;
+
+  // `service_impl` is not owned and must outlive the server.
+  MetadataStoreAsyncServer(MetadataStoreServiceImpl* service_impl,
+                           const MetadataStoreAsyncServerOptions& options);
+
+  // Disallow copy and assign.
+  MetadataStoreAsyncServer(const MetadataStoreAsyncServer&) = delete;
+  MetadataStoreAsyncServer& operator=(const MetadataStoreAsyncServer&) =
+      delete;
+
+  // Shuts down the server if it is running.
+  ~MetadataStoreAsyncServer();
+
+  // Registers the service and the completion queues to `builder`, then builds
+  // and starts the server. It can only be called once.
+  // Returns INTERNAL error, if the server cannot be started, e.g., when the
+  //   listening port is in use.
+  tensorflow::Status Start(::grpc::ServerBuilder* builder);
+
+  // Blocks until the server is shut down.
+  void Wait();
+
+  // Stops receiving calls, waits for the calls in flight to finish and stops
+  // the threads of the server.
+  void Shutdown();
+
+ private:
+  // Receives and runs the calls of `completion_queue` until it is shut down.
+  void PollCompletionQueue(::grpc::ServerCompletionQueue* completion_queue);
+
+  MetadataStoreServiceImpl* const service_impl_;
+  const MetadataStoreAsyncServerOptions options_;
+  AsyncService async_service_;
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>>
+      completion_queues_;
+  std::unique_ptr<::grpc::Server> server_;
+  std::unique_ptr<tensorflow::thread::ThreadPool> executor_;
+  std::vector<std::thread> polling_threads_;
+
+  absl::Mutex mu_;
+  bool is_shut_down_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
@@ -0,0 +1,267 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+// Runs a MetadataStoreAsyncServer with an in-memory database on a local port.
+// The store pool has a single store, so that all calls see the same database.
+class MetadataStoreAsyncServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    MetadataStorePoolOptions pool_options;
+    pool_options.max_size = 1;
+    service_impl_ = absl::make_unique<MetadataStoreServiceImpl>(
+        connection_config, pool_options);
+    MetadataStoreAsyncServerOptions server_options;
+    server_options.num_completion_queues = 2;
+    server_options.num_executor_threads = pool_options.max_size;
+    server_ = absl::make_unique<MetadataStoreAsyncServer>(service_impl_.get(),
+                                                          server_options);
+    ::grpc::ServerBuilder builder;
+    int port = 0;
+    builder.AddListeningPort("localhost:0",
+                             ::grpc::InsecureServerCredentials(), &port);
+    TF_ASSERT_OK(server_->Start(&builder));
+    stub_ = MetadataStoreService::NewStub(
+        ::grpc::CreateChannel(absl::StrCat("localhost:", port),
+                              ::grpc::InsecureChannelCredentials()));
+  }
+
+  void TearDown() override { server_->Shutdown(); }
+
+  // Puts an artifact type and returns its id.
+  int64 PutArtifactType() {
+    PutArtifactTypeRequest request;
+    request.mutable_artifact_type()->set_name("async_type");
+    PutArtifactTypeResponse response;
+    ::grpc::ClientContext context;
+    EXPECT_TRUE(stub_->PutArtifactType(&context, request, &response).ok());
+    return response.type_id();
+  }
+
+  std::unique_ptr<MetadataStoreServiceImpl> service_impl_;
+  std::unique_ptr<MetadataStoreAsyncServer> server_;
+  std::unique_ptr<MetadataStoreService::Stub> stub_;
+};
+
+TEST_F(MetadataStoreAsyncServerTest, PutAndGetArtifactType) {
+  const PutArtifactTypeRequest put_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        all_fields_match: true
+        artifact_type: { name: 'async_type' properties { key: 'p' value: INT } }
+      )");
+  PutArtifactTypeResponse put_response;
+  {
+    ::grpc::ClientContext context;
+    ASSERT_TRUE(
+        stub_->PutArtifactType(&context, put_request, &put_response).ok());
+  }
+
+  GetArtifactTypeRequest get_request;
+  get_request.set_type_name("async_type");
+  GetArtifactTypeResponse get_response;
+  ::grpc::ClientContext context;
+  ASSERT_TRUE(
+      stub_->GetArtifactType(&context, get_request, &get_response).ok());
+  EXPECT_EQ(get_response.artifact_type().id(), put_response.type_id());
+}
+
+TEST_F(MetadataStoreAsyncServerTest, ReturnStoreErrors) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("unknown_type");
+  GetArtifactTypeResponse response;
+  ::grpc::ClientContext context;
+  EXPECT_EQ(stub_->GetArtifactType(&context, request, &response).error_code(),
+            ::grpc::StatusCode::NOT_FOUND);
+}
+
+// The concurrent calls exceed the number of executor threads, so they are
+// queued until a thread is free.
+TEST_F(MetadataStoreAsyncServerTest, QueueConcurrentCalls) {
+  constexpr int kNumCalls = 32;
+  const int64 type_id = PutArtifactType();
+  std::vector<int> call_ok(kNumCalls, 0);
+  std::vector<std::thread> calls;
+  for (int i = 0; i < kNumCalls; i++) {
+    calls.emplace_back([this, i, type_id, &call_ok]() {
+      PutArtifactsRequest request;
+      Artifact* artifact = request.add_artifacts();
+      artifact->set_type_id(type_id);
+      artifact->set_uri(absl::StrCat("uri_", i));
+      PutArtifactsResponse response;
+      ::grpc::ClientContext context;
+      call_ok[i] = stub_->PutArtifacts(&context, request, &response).ok();
+    });
+  }
+  for (std::thread& call : calls) {
+    call.join();
+  }
+  for (int i = 0; i < kNumCalls; i++) {
+    EXPECT_TRUE(call_ok[i]) << "call " << i;
+  }
+
+  GetArtifactsRequest request;
+  GetArtifactsResponse response;
+  ::grpc::ClientContext context;
+  ASSERT_TRUE(stub_->GetArtifacts(&context, request, &response).ok());
+  EXPECT_THAT(response.artifacts(), SizeIs(kNumCalls));
+}
+
+TEST_F(MetadataStoreAsyncServerTest, StreamArtifacts) {
+  const int64 type_id = PutArtifactType();
+  PutArtifactsRequest put_request;
+  for (int i = 0; i < 5; i++) {
+    put_request.add_artifacts()->set_type_id(type_id);
+  }
+  PutArtifactsResponse put_response;
+  {
+    ::grpc::ClientContext context;
+    ASSERT_TRUE(stub_->PutArtifacts(&context, put_request, &put_response).ok());
+  }
+
+  StreamArtifactsRequest stream_request;
+  stream_request.set_max_chunk_size(2);
+  ::grpc::ClientContext context;
+  std::unique_ptr<::grpc::ClientReader<StreamArtifactsResponse>> reader =
+      stub_->StreamArtifacts(&context, stream_request);
+  StreamArtifactsResponse stream_response;
+  std::vector<int> chunk_sizes;
+  while (reader->Read(&stream_response)) {
+    chunk_sizes.push_back(stream_response.artifacts_size());
+  }
+  ASSERT_TRUE(reader->Finish().ok());
+  EXPECT_THAT(chunk_sizes, ElementsAre(2, 2, 1));
+}
+
+// GetArtifactsByID is served by a raw method, which sends the serialized
+// response assembled by the service.
+TEST_F(MetadataStoreAsyncServerTest, GetArtifactsByID) {
+  const int64 type_id = PutArtifactType();
+  PutArtifactsRequest put_request;
+  put_request.add_artifacts()->set_type_id(type_id);
+  put_request.add_artifacts()->set_type_id(type_id);
+  PutArtifactsResponse put_response;
+  {
+    ::grpc::ClientContext context;
+    ASSERT_TRUE(stub_->PutArtifacts(&context, put_request, &put_response).ok());
+  }
+
+  GetArtifactsByIDRequest get_request;
+  get_request.add_artifact_ids(put_response.artifact_ids(1));
+  get_request.add_artifact_ids(put_response.artifact_ids(1) + 100);
+  GetArtifactsByIDResponse get_response;
+  ::grpc::ClientContext context;
+  ASSERT_TRUE(
+      stub_->GetArtifactsByID(&context, get_request, &get_response).ok());
+  ASSERT_THAT(get_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_response.artifacts(0).id(), put_response.artifact_ids(1));
+  EXPECT_EQ(get_response.artifacts(0).type_id(), type_id);
+}
+
+// The calls of each tenant are routed to its own database.
+TEST(MetadataStoreAsyncServerTenantTest, RouteCallsByTenant) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  MetadataStorePoolOptions pool_options;
+  pool_options.max_size = 1;
+  const auto tenant_routing_config =
+      ParseTextProtoOrDie<MetadataStoreServerConfig::TenantRoutingConfig>(R"(
+        tenant_id_metadata_key: 'mlmd-tenant'
+        tenants { tenant_id: 'team_a' connection_config { fake_database {} } }
+      )");
+  MetadataStoreServiceImpl service_impl(
+      connection_config, pool_options, /*max_bulk_list_result_size=*/100,
+      /*put_coalescer_options=*/absl::nullopt, QueryAccountingOptions(),
+      ResponseCompressionOptions(), /*admission_control_options=*/absl::nullopt,
+      /*client_rate_limit_config=*/absl::nullopt, tenant_routing_config);
+  MetadataStoreAsyncServer server(&service_impl,
+                                  MetadataStoreAsyncServerOptions());
+  ::grpc::ServerBuilder builder;
+  int port = 0;
+  builder.AddListeningPort("localhost:0", ::grpc::InsecureServerCredentials(),
+                           &port);
+  TF_ASSERT_OK(server.Start(&builder));
+  const std::unique_ptr<MetadataStoreService::Stub> stub =
+      MetadataStoreService::NewStub(
+          ::grpc::CreateChannel(absl::StrCat("localhost:", port),
+                                ::grpc::InsecureChannelCredentials()));
+
+  PutArtifactTypeRequest put_request;
+  put_request.mutable_artifact_type()->set_name("tenant_type");
+  PutArtifactTypeResponse put_response;
+  {
+    ::grpc::ClientContext context;
+    context.AddMetadata("mlmd-tenant", "team_a");
+    ASSERT_TRUE(
+        stub->PutArtifactType(&context, put_request, &put_response).ok());
+  }
+
+  GetArtifactTypeRequest get_request;
+  get_request.set_type_name("tenant_type");
+  {
+    GetArtifactTypeResponse get_response;
+    ::grpc::ClientContext context;
+    context.AddMetadata("mlmd-tenant", "team_a");
+    EXPECT_TRUE(
+        stub->GetArtifactType(&context, get_request, &get_response).ok());
+  }
+  {
+    // The calls without a tenant use the database of the server.
+    GetArtifactTypeResponse get_response;
+    ::grpc::ClientContext context;
+    EXPECT_EQ(stub->GetArtifactType(&context, get_request, &get_response)
+                  .error_code(),
+              ::grpc::StatusCode::NOT_FOUND);
+  }
+  {
+    PutArtifactTypeResponse response;
+    ::grpc::ClientContext context;
+    context.AddMetadata("mlmd-tenant", "team_b");
+    EXPECT_EQ(
+        stub->PutArtifactType(&context, put_request, &response).error_code(),
+        ::grpc::StatusCode::NOT_FOUND);
+  }
+  server.Shutdown();
+}
+
+}  // namespace
+}  // namespace ml_metadata
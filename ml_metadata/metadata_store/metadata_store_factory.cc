@@ -14,11 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/transaction_executor.h"
 #ifndef _WIN32
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/postgresql_metadata_source.h"
 #endif
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
@@ -28,50 +38,292 @@ namespace ml_metadata {
 
 namespace {
 
+// The databases whose schema has been verified by the stores of this process,
+// keyed by their serialized ConnectionConfig, with the time of the check.
+class VerifiedSchemas {
+ public:
+  static VerifiedSchemas& Get() {
+    static VerifiedSchemas* verified_schemas = new VerifiedSchemas();
+    return *verified_schemas;
+  }
+
+  // Returns true if the schema of the database has been verified within the
+  // last `interval`.
+  bool IsVerified(const std::string& key, const absl::Duration interval) {
+    absl::MutexLock lock(&mu_);
+    const auto it = verified_at_.find(key);
+    return it != verified_at_.end() && absl::Now() - it->second < interval;
+  }
+
+  void SetVerified(const std::string& key) {
+    absl::MutexLock lock(&mu_);
+    verified_at_[key] = absl::Now();
+  }
+
+  void Forget(const std::string& key) {
+    absl::MutexLock lock(&mu_);
+    verified_at_.erase(key);
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, absl::Time> verified_at_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// Returns true if the database of `config` outlives its stores, so that the
+// schema verified by one of them holds for the others. The fake, in-memory
+// and sharded databases are always checked.
+bool IsSchemaCheckCacheable(const ConnectionConfig& config) {
+  switch (config.config_case()) {
+    case ConnectionConfig::kMysql:
+    case ConnectionConfig::kPostgresql:
+      return true;
+    case ConnectionConfig::kSqlite:
+      return !config.sqlite().filename_uri().empty() &&
+             config.sqlite().filename_uri() != ":memory:";
+    default:
+      return false;
+  }
+}
+
+// Initializes the database of a created store if it does not exist, and
+// otherwise checks its schema, unless `verify_schema` is false. An out of date
+// schema is first upgraded online, if the migration options enable it.
+tensorflow::Status InitMetadataStoreIfNotExists(
+    const MigrationOptions& migration_options, const bool verify_schema,
+    MetadataStore* store) {
+  if (!verify_schema) return tensorflow::Status::OK();
+  if (migration_options.enable_upgrade_migration() &&
+      migration_options.has_online_migration()) {
+    TF_RETURN_IF_ERROR(
+        store->UpgradeSchemaOnline(migration_options.online_migration()));
+  }
+  return store->InitMetadataStoreIfNotExists(
+      migration_options.enable_upgrade_migration());
+}
+
 #ifndef _WIN32
+// Returns the query config of a MySQL database, whose events are partitioned
+// by time if the `config` has event_partition_options.
+const MetadataSourceQueryConfig& GetMySqlQueryConfig(
+    const MySQLDatabaseConfig& config) {
+  return config.has_event_partition_options()
+             ? util::GetMySqlPartitionedEventsMetadataSourceQueryConfig()
+             : util::GetMySqlMetadataSourceQueryConfig();
+}
+
 tensorflow::Status CreateMySQLMetadataStore(
     const MySQLDatabaseConfig& config,
-    const MigrationOptions& migration_options,
-    std::unique_ptr<MetadataStore>* result) {
+    const MigrationOptions& migration_options, const bool verify_schema,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
   auto metadata_source = absl::make_unique<MySqlMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), read_transaction_mode, retry_options);
   TF_RETURN_IF_ERROR(MetadataStore::Create(
-      util::GetMySqlMetadataSourceQueryConfig(), migration_options,
-      std::move(metadata_source), std::move(transaction_executor), result));
-  return (*result)->InitMetadataStoreIfNotExists(
+      GetMySqlQueryConfig(config), migration_options,
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      node_cache, result));
+  TF_RETURN_IF_ERROR(InitMetadataStoreIfNotExists(
+      migration_options, verify_schema, result->get()));
+  if (!config.has_event_partition_options()) {
+    return tensorflow::Status::OK();
+  }
+  return (*result)->MaintainEventPartitions(
+      config.event_partition_options(),
       migration_options.enable_upgrade_migration());
 }
+
+tensorflow::Status CreatePostgreSQLMetadataStore(
+    const PostgreSQLDatabaseConfig& config,
+    const MigrationOptions& migration_options, const bool verify_schema,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
+  auto metadata_source = absl::make_unique<PostgreSQLMetadataSource>(config);
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), read_transaction_mode, retry_options);
+  TF_RETURN_IF_ERROR(MetadataStore::Create(
+      util::GetPostgreSQLMetadataSourceQueryConfig(), migration_options,
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      node_cache, result));
+  return InitMetadataStoreIfNotExists(migration_options, verify_schema,
+                                      result->get());
+}
 #else
 tensorflow::Status CreateMySQLMetadataStore(
     const MySQLDatabaseConfig& config,
-    const MigrationOptions& migration_options,
-    std::unique_ptr<MetadataStore>* result) {
+    const MigrationOptions& migration_options, const bool verify_schema,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
   return tensorflow::errors::Unimplemented(
              "MySQL is not supported in Windows yet");
 }
+
+tensorflow::Status CreatePostgreSQLMetadataStore(
+    const PostgreSQLDatabaseConfig& config,
+    const MigrationOptions& migration_options, const bool verify_schema,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
+  return tensorflow::errors::Unimplemented(
+      "PostgreSQL is not supported in Windows yet");
+}
 #endif
 
 tensorflow::Status CreateSqliteMetadataStore(
     const SqliteMetadataSourceConfig& config,
-    const MigrationOptions& migration_options,
-    std::unique_ptr<MetadataStore>* result) {
+    const MigrationOptions& migration_options, const bool verify_schema,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
   auto metadata_source = absl::make_unique<SqliteMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), read_transaction_mode, retry_options);
   TF_RETURN_IF_ERROR(MetadataStore::Create(
       util::GetSqliteMetadataSourceQueryConfig(), migration_options,
-      std::move(metadata_source), std::move(transaction_executor), result));
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      node_cache, result));
+  return InitMetadataStoreIfNotExists(migration_options, verify_schema,
+                                      result->get());
+}
+
+tensorflow::Status CreateInMemoryMetadataStore(
+    const MigrationOptions& migration_options,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
+  auto metadata_source = absl::make_unique<InMemoryMetadataSource>();
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), read_transaction_mode, retry_options);
+  TF_RETURN_IF_ERROR(MetadataStore::Create(
+      util::GetInMemoryMetadataSourceQueryConfig(), migration_options,
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      node_cache, result));
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
 
+// Creates the source of a shard of a ShardedDatabaseConfig, or of a single
+// database, and sets `query_config` to those of its kind.
+tensorflow::Status CreateShardSource(
+    const ConnectionConfig& config, MetadataSourceQueryConfig* query_config,
+    std::unique_ptr<MetadataSource>* result) {
+  switch (config.config_case()) {
+    case ConnectionConfig::kFakeDatabase:
+      *query_config = util::GetSqliteMetadataSourceQueryConfig();
+      *result =
+          absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig());
+      return tensorflow::Status::OK();
+#ifndef _WIN32
+    case ConnectionConfig::kMysql:
+      *query_config = GetMySqlQueryConfig(config.mysql());
+      *result = absl::make_unique<MySqlMetadataSource>(config.mysql());
+      return tensorflow::Status::OK();
+    case ConnectionConfig::kPostgresql:
+      *query_config = util::GetPostgreSQLMetadataSourceQueryConfig();
+      *result =
+          absl::make_unique<PostgreSQLMetadataSource>(config.postgresql());
+      return tensorflow::Status::OK();
+#endif
+    case ConnectionConfig::kSqlite:
+      *query_config = util::GetSqliteMetadataSourceQueryConfig();
+      *result = absl::make_unique<SqliteMetadataSource>(config.sqlite());
+      return tensorflow::Status::OK();
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "The config must have a fake_database, mysql, postgresql or sqlite "
+          "database: ",
+          config.DebugString());
+  }
+}
+
+tensorflow::Status CreateShardedMetadataStore(
+    const ShardedDatabaseConfig& config,
+    const MigrationOptions& migration_options,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    std::unique_ptr<MetadataStore>* result) {
+  if (config.shards().empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "A sharded config must have at least one shard.");
+  }
+  MetadataSourceQueryConfig query_config;
+  std::vector<std::unique_ptr<MetadataSource>> shard_sources;
+  std::vector<MetadataSource*> shard_source_ptrs;
+  for (const ConnectionConfig& shard_config : config.shards()) {
+    if (shard_config.config_case() != config.shards(0).config_case()) {
+      return tensorflow::errors::InvalidArgument(
+          "The shards must all be databases of the same kind.");
+    }
+    std::unique_ptr<MetadataSource> shard_source;
+    TF_RETURN_IF_ERROR(
+        CreateShardSource(shard_config, &query_config, &shard_source));
+    shard_source_ptrs.push_back(shard_source.get());
+    shard_sources.push_back(std::move(shard_source));
+  }
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      shard_source_ptrs, read_transaction_mode, retry_options);
+  TF_RETURN_IF_ERROR(MetadataStore::CreateSharded(
+      query_config, migration_options, std::move(shard_sources),
+      std::move(transaction_executor), type_cache, result));
+  TF_RETURN_IF_ERROR((*result)->InitMetadataStoreIfNotExists(
+      migration_options.enable_upgrade_migration()));
+  // The shards share the partitioning of the events of the last one, as they
+  // share its query config.
+  const ConnectionConfig& last_shard_config =
+      config.shards(config.shards_size() - 1);
+  if (!last_shard_config.has_mysql() ||
+      !last_shard_config.mysql().has_event_partition_options()) {
+    return tensorflow::Status::OK();
+  }
+  return (*result)->MaintainEventPartitions(
+      last_shard_config.mysql().event_partition_options(),
+      migration_options.enable_upgrade_migration());
+}
+
+TransactionMode GetReadTransactionMode(const ConnectionConfig& config) {
+  switch (config.read_transaction_mode()) {
+    case ConnectionConfig::READ_WRITE:
+      return TransactionMode::kReadWrite;
+    case ConnectionConfig::AUTOCOMMIT:
+      return TransactionMode::kAutocommit;
+    default:
+      return TransactionMode::kReadOnly;
+  }
+}
 
-}  // namespace
+TransactionRetryOptions GetTransactionRetryOptions(
+    const ConnectionConfig& config) {
+  TransactionRetryOptions retry_options;
+  const RetryOptions& config_options = config.retry_options();
+  if (config_options.has_max_num_retries()) {
+    retry_options.max_num_retries = config_options.max_num_retries();
+  }
+  if (config_options.has_initial_backoff_millis()) {
+    retry_options.initial_backoff =
+        absl::Milliseconds(config_options.initial_backoff_millis());
+  }
+  if (config_options.has_max_backoff_millis()) {
+    retry_options.max_backoff =
+        absl::Milliseconds(config_options.max_backoff_millis());
+  }
+  if (config_options.has_backoff_multiplier()) {
+    retry_options.backoff_multiplier = config_options.backoff_multiplier();
+  }
+  return retry_options;
+}
 
-tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
-                                       const MigrationOptions& options,
-                                       std::unique_ptr<MetadataStore>* result) {
+// Creates a store of the database of `config`, whose schema is not checked
+// if `verify_schema` is false.
+tensorflow::Status CreateMetadataStoreForConfig(
+    const ConnectionConfig& config, const MigrationOptions& options,
+    const bool verify_schema, const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options, TypeCache* type_cache,
+    NodeCache* node_cache, std::unique_ptr<MetadataStore>* result) {
   switch (config.config_case()) {
     case ConnectionConfig::CONFIG_NOT_SET:
       // TODO(b/123345695): make this longer when that bug is resolved.
@@ -80,16 +332,113 @@ tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
     case ConnectionConfig::kFakeDatabase:
       // Creates an in-memory SQLite database for testing.
       return CreateSqliteMetadataStore(SqliteMetadataSourceConfig(), options,
-                                       result);
+                                       /*verify_schema=*/true,
+                                       read_transaction_mode, retry_options,
+                                       type_cache, node_cache, result);
     case ConnectionConfig::kMysql:
-      return CreateMySQLMetadataStore(config.mysql(), options, result);
+      return CreateMySQLMetadataStore(config.mysql(), options, verify_schema,
+                                      read_transaction_mode, retry_options,
+                                      type_cache, node_cache, result);
+    case ConnectionConfig::kPostgresql:
+      return CreatePostgreSQLMetadataStore(
+          config.postgresql(), options, verify_schema, read_transaction_mode,
+          retry_options, type_cache, node_cache, result);
     case ConnectionConfig::kSqlite:
-      return CreateSqliteMetadataStore(config.sqlite(), options, result);
+      return CreateSqliteMetadataStore(config.sqlite(), options, verify_schema,
+                                       read_transaction_mode, retry_options,
+                                       type_cache, node_cache, result);
+    case ConnectionConfig::kSharded:
+      return CreateShardedMetadataStore(config.sharded(), options,
+                                        read_transaction_mode, retry_options,
+                                        type_cache, result);
+    case ConnectionConfig::kInMemory:
+      return CreateInMemoryMetadataStore(options, read_transaction_mode,
+                                         retry_options, type_cache, node_cache,
+                                         result);
     default:
       return tensorflow::errors::Unimplemented("Unknown database type.");
   }
 }
 
+}  // namespace
+
+tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
+                                       const MigrationOptions& options,
+                                       TypeCache* type_cache,
+                                       NodeCache* node_cache,
+                                       std::unique_ptr<MetadataStore>* result) {
+  const TransactionMode read_transaction_mode = GetReadTransactionMode(config);
+  const TransactionRetryOptions retry_options =
+      GetTransactionRetryOptions(config);
+  if (retry_options.max_num_retries < 0 ||
+      retry_options.backoff_multiplier < 1.0) {
+    return tensorflow::errors::InvalidArgument(
+        "retry_options must have a non-negative max_num_retries and a "
+        "backoff_multiplier of at least 1.");
+  }
+  // The schema checks of a database are skipped while it was verified by
+  // another store of this process within the schema_check_interval_seconds.
+  // The migrations always check the schema.
+  std::string schema_key;
+  bool verify_schema = true;
+  if (config.schema_check_interval_seconds() > 0 &&
+      IsSchemaCheckCacheable(config)) {
+    schema_key = config.SerializeAsString();
+    if (options.enable_upgrade_migration() ||
+        options.downgrade_to_schema_version() >= 0) {
+      VerifiedSchemas::Get().Forget(schema_key);
+    } else {
+      verify_schema = !VerifiedSchemas::Get().IsVerified(
+          schema_key, absl::Seconds(config.schema_check_interval_seconds()));
+    }
+  }
+  tensorflow::Status status = CreateMetadataStoreForConfig(
+      config, options, verify_schema, read_transaction_mode, retry_options,
+      type_cache, node_cache, result);
+  if (status.ok() && config.inline_event_paths()) {
+    status = (*result)->InlineEventPaths(options.enable_upgrade_migration());
+  }
+  if (status.ok() && config.inline_node_properties()) {
+    status =
+        (*result)->InlineNodeProperties(options.enable_upgrade_migration());
+  } else if (status.ok()) {
+    status = (*result)->MaintainNodePropertiesBytes();
+  }
+  if (status.ok() && config.has_idempotency()) {
+    status = (*result)->EnableIdempotencyKeys(config.idempotency());
+  }
+  if (status.ok() && config.enable_lineage_closure()) {
+    status = (*result)->EnableLineageClosure();
+  }
+  if (status.ok()) {
+    (*result)->SetMaxResponseBytes(config.max_response_bytes());
+  }
+  if (status.ok() && verify_schema && !schema_key.empty()) {
+    VerifiedSchemas::Get().SetVerified(schema_key);
+  }
+  return status;
+}
+
+tensorflow::Status CreateMetadataSource(
+    const ConnectionConfig& config, std::unique_ptr<MetadataSource>* result) {
+  MetadataSourceQueryConfig query_config;
+  return CreateShardSource(config, &query_config, result);
+}
+
+tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
+                                       const MigrationOptions& options,
+                                       std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStore(config, options, /*type_cache=*/nullptr, result);
+}
+
+tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
+                                       const MigrationOptions& options,
+                                       TypeCache* type_cache,
+                                       std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStore(config, options, type_cache,
+                             /*node_cache=*/nullptr, result);
+}
+
 tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
                                        std::unique_ptr<MetadataStore>* result) {
   return CreateMetadataStore(config, {}, result);
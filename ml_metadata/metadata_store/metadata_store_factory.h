@@ -17,7 +17,10 @@ limitations under the License.
 
 #include <memory>
 
+#include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/node_cache.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -32,6 +35,31 @@ tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
                                        const MigrationOptions& options,
                                        std::unique_ptr<MetadataStore>* result);
 
+// Creates a MetadataStore which looks up types in `type_cache`, if it is not
+// nullptr. The cache must outlive the result, and must only be shared by the
+// stores created with the same ConnectionConfig.
+tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
+                                       const MigrationOptions& options,
+                                       TypeCache* type_cache,
+                                       std::unique_ptr<MetadataStore>* result);
+
+// Creates a MetadataStore which also looks up nodes in `node_cache`, if it is
+// not nullptr, which is shared like `type_cache`. The nodes of a sharded
+// database are not cached.
+tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
+                                       const MigrationOptions& options,
+                                       TypeCache* type_cache,
+                                       NodeCache* node_cache,
+                                       std::unique_ptr<MetadataStore>* result);
+
+// Creates a MetadataSource of the database of `config`, which is not connected
+// yet, e.g., to copy the rows of its tables as they are. The schema is neither
+// created nor checked.
+// Returns INVALID_ARGUMENT error, if `config` is not a fake_database, mysql,
+//   postgresql or sqlite config.
+tensorflow::Status CreateMetadataSource(
+    const ConnectionConfig& config, std::unique_ptr<MetadataSource>* result);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_METADATA_STORE_FACTORY_H_
@@ -14,16 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 
 
@@ -71,5 +77,345 @@ TEST(MetadataStoreFactoryTest, CreateSQLiteMetadataStore) {
   TestPutAndGetArtifactType(connection_config);
 }
 
+TEST(MetadataStoreFactoryTest, CreateInMemoryMetadataStore) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_in_memory();
+  TestPutAndGetArtifactType(connection_config);
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(
+          "execution_type: { name: 'trainer' }");
+  PutExecutionTypeResponse put_execution_type_response;
+  TF_ASSERT_OK(store->PutExecutionType(put_execution_type_request,
+                                       &put_execution_type_response));
+  // The execution is created before the context of an unknown type fails the
+  // transaction, which then drops the execution.
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_execution_type_response.type_id());
+  Context* context = put_execution_request.add_contexts();
+  context->set_type_id(put_execution_type_response.type_id() + 100);
+  context->set_name("pipeline_1");
+  PutExecutionResponse put_execution_response;
+  EXPECT_FALSE(
+      store->PutExecution(put_execution_request, &put_execution_response).ok());
+
+  GetExecutionsRequest get_request;
+  GetExecutionsResponse get_response;
+  TF_ASSERT_OK(store->GetExecutions(get_request, &get_response));
+  EXPECT_EQ(get_response.executions_size(), 0);
+}
+
+TEST(MetadataStoreFactoryTest, CreateShardedMetadataStore) {
+  const ConnectionConfig connection_config =
+      ParseTextProtoOrDie<ConnectionConfig>(R"(
+        sharded {
+          shards { fake_database {} }
+          shards { fake_database {} }
+        }
+      )");
+  TestPutAndGetArtifactType(connection_config);
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(
+          "execution_type: { name: 'trainer' }");
+  PutExecutionTypeResponse put_execution_type_response;
+  TF_ASSERT_OK(store->PutExecutionType(put_execution_type_request,
+                                       &put_execution_type_response));
+  PutContextTypeRequest put_context_type_request =
+      ParseTextProtoOrDie<PutContextTypeRequest>(
+          "context_type: { name: 'pipeline' }");
+  PutContextTypeResponse put_context_type_response;
+  TF_ASSERT_OK(store->PutContextType(put_context_type_request,
+                                     &put_context_type_response));
+  // The execution and its context are stored on one shard.
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_execution_type_response.type_id());
+  Context* context = put_execution_request.add_contexts();
+  context->set_type_id(put_context_type_response.type_id());
+  context->set_name("pipeline_1");
+  PutExecutionResponse put_execution_response;
+  TF_ASSERT_OK(
+      store->PutExecution(put_execution_request, &put_execution_response));
+
+  GetExecutionsByContextRequest get_request;
+  get_request.set_context_id(put_execution_response.context_ids(0));
+  GetExecutionsByContextResponse get_response;
+  TF_ASSERT_OK(store->GetExecutionsByContext(get_request, &get_response));
+  ASSERT_EQ(get_response.executions_size(), 1);
+  EXPECT_EQ(get_response.executions(0).id(),
+            put_execution_response.execution_id());
+}
+
+TEST(MetadataStoreFactoryTest, CreateShardedMetadataStoreWithoutShards) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_sharded();
+  std::unique_ptr<MetadataStore> store;
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(
+      CreateMetadataStore(connection_config, &store)));
+}
+
+TEST(MetadataStoreFactoryTest, SkipVerifiedSchemaChecks) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "verified_schema.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  connection_config.set_schema_check_interval_seconds(3600);
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  store.reset();
+
+  // The schema of the recreated database is not checked again, so its tables
+  // are not created.
+  ASSERT_EQ(std::remove(filename_uri.c_str()), 0);
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  GetArtifactTypesResponse response;
+  EXPECT_FALSE(store->GetArtifactTypes({}, &response).ok());
+
+  // An upgrade migration checks the schema, which creates the tables.
+  MigrationOptions migration_options;
+  migration_options.set_enable_upgrade_migration(true);
+  TF_ASSERT_OK(
+      CreateMetadataStore(connection_config, migration_options, &store));
+  TF_EXPECT_OK(store->GetArtifactTypes({}, &response));
+}
+
+// Puts an execution with an output artifact, whose event has a path of
+// `path_key`.
+void PutExecutionWithEventPath(const std::string& path_key,
+                               MetadataStore* store) {
+  PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        all_fields_match: true
+        artifact_types: { name: 'path_artifact_type' }
+        execution_types: { name: 'path_execution_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(store->PutTypes(put_types_request, &put_types_response));
+  PutExecutionRequest request;
+  request.mutable_execution()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+      request.add_artifact_event_pairs();
+  artifact_and_event->mutable_artifact()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  Event* event = artifact_and_event->mutable_event();
+  event->set_type(Event::OUTPUT);
+  event->mutable_path()->add_steps()->set_key(path_key);
+  event->mutable_path()->add_steps()->set_index(1);
+  PutExecutionResponse response;
+  TF_ASSERT_OK(store->PutExecution(request, &response));
+}
+
+// Returns the path keys of the events of all executions.
+std::vector<std::string> GetEventPathKeys(MetadataStore* store) {
+  GetExecutionsResponse executions_response;
+  TF_CHECK_OK(store->GetExecutions({}, &executions_response));
+  GetEventsByExecutionIDsRequest request;
+  for (const Execution& execution : executions_response.executions()) {
+    request.add_execution_ids(execution.id());
+  }
+  GetEventsByExecutionIDsResponse response;
+  TF_CHECK_OK(store->GetEventsByExecutionIDs(request, &response));
+  std::vector<std::string> path_keys;
+  for (const Event& event : response.events()) {
+    CHECK_EQ(event.path().steps_size(), 2);
+    CHECK_EQ(event.path().steps(1).index(), 1);
+    path_keys.push_back(event.path().steps(0).key());
+  }
+  std::sort(path_keys.begin(), path_keys.end());
+  return path_keys;
+}
+
+TEST(MetadataStoreFactoryTest, InlineEventPaths) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "inline_event_paths.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  PutExecutionWithEventPath("stored_in_event_path", store.get());
+
+  // The paths stored in the EventPath table are only moved by a migration.
+  connection_config.set_inline_event_paths(true);
+  EXPECT_TRUE(tensorflow::errors::IsFailedPrecondition(
+      CreateMetadataStore(connection_config, &store)));
+  MigrationOptions migration_options;
+  migration_options.set_enable_upgrade_migration(true);
+  TF_ASSERT_OK(
+      CreateMetadataStore(connection_config, migration_options, &store));
+  PutExecutionWithEventPath("stored_inline", store.get());
+  EXPECT_THAT(GetEventPathKeys(store.get()),
+              ::testing::ElementsAre("stored_in_event_path", "stored_inline"));
+
+  // The next stores find no path left to move.
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  EXPECT_THAT(GetEventPathKeys(store.get()),
+              ::testing::ElementsAre("stored_in_event_path", "stored_inline"));
+  store.reset();
+  ASSERT_EQ(std::remove(filename_uri.c_str()), 0);
+}
+
+TEST(MetadataStoreFactoryTest, InlineEventPathsOfNewDatabase) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  connection_config.set_inline_event_paths(true);
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  PutExecutionWithEventPath("stored_inline", store.get());
+  EXPECT_THAT(GetEventPathKeys(store.get()),
+              ::testing::ElementsAre("stored_inline"));
+}
+
+// Puts an artifact with an int property of `value` and a custom property.
+int64 PutArtifactWithProperties(const int64 value, MetadataStore* store) {
+  PutArtifactTypeRequest put_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        all_fields_match: true
+        artifact_type: {
+          name: 'property_artifact_type'
+          properties { key: 'p' value: INT }
+        }
+      )");
+  PutArtifactTypeResponse put_type_response;
+  TF_CHECK_OK(store->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest request;
+  Artifact* artifact = request.add_artifacts();
+  artifact->set_type_id(put_type_response.type_id());
+  (*artifact->mutable_properties())["p"].set_int_value(value);
+  (*artifact->mutable_custom_properties())["c"].set_string_value("custom");
+  PutArtifactsResponse response;
+  TF_CHECK_OK(store->PutArtifacts(request, &response));
+  return response.artifact_ids(0);
+}
+
+TEST(MetadataStoreFactoryTest, InlineNodeProperties) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "inline_node_properties.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  const int64 stored_id = PutArtifactWithProperties(1, store.get());
+
+  // The nodes written before are only filled by a migration.
+  connection_config.set_inline_node_properties(true);
+  EXPECT_TRUE(tensorflow::errors::IsFailedPrecondition(
+      CreateMetadataStore(connection_config, &store)));
+  MigrationOptions migration_options;
+  migration_options.set_enable_upgrade_migration(true);
+  TF_ASSERT_OK(
+      CreateMetadataStore(connection_config, migration_options, &store));
+  const int64 inline_id = PutArtifactWithProperties(2, store.get());
+
+  // An updated property is written to both the property table and the node.
+  GetArtifactsByIDRequest get_request;
+  get_request.add_artifact_ids(stored_id);
+  get_request.add_artifact_ids(inline_id);
+  GetArtifactsByIDResponse get_response;
+  TF_ASSERT_OK(store->GetArtifactsByID(get_request, &get_response));
+  ASSERT_EQ(get_response.artifacts_size(), 2);
+  PutArtifactsRequest put_request;
+  *put_request.add_artifacts() = get_response.artifacts(1);
+  (*put_request.mutable_artifacts(0)->mutable_properties())["p"]
+      .set_int_value(3);
+  put_request.mutable_artifacts(0)->clear_custom_properties();
+  PutArtifactsResponse put_response;
+  TF_ASSERT_OK(store->PutArtifacts(put_request, &put_response));
+
+  // The next stores find no node left to fill, and read the properties from
+  // the nodes.
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  TF_ASSERT_OK(store->GetArtifactsByID(get_request, &get_response));
+  ASSERT_EQ(get_response.artifacts_size(), 2);
+  for (const Artifact& artifact : get_response.artifacts()) {
+    if (artifact.id() == stored_id) {
+      EXPECT_EQ(artifact.properties().at("p").int_value(), 1);
+      EXPECT_EQ(artifact.custom_properties().at("c").string_value(), "custom");
+    } else {
+      EXPECT_EQ(artifact.properties().at("p").int_value(), 3);
+      EXPECT_TRUE(artifact.custom_properties().empty());
+    }
+  }
+
+  // The filters still query the property tables.
+  GetArtifactsRequest filter_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"(
+        options {
+          property_filters {
+            name: 'p'
+            op: EQ
+            value { int_value: 3 }
+          }
+        }
+      )");
+  GetArtifactsResponse filter_response;
+  TF_ASSERT_OK(store->GetArtifacts(filter_request, &filter_response));
+  ASSERT_EQ(filter_response.artifacts_size(), 1);
+  EXPECT_EQ(filter_response.artifacts(0).id(), inline_id);
+  store.reset();
+  ASSERT_EQ(std::remove(filename_uri.c_str()), 0);
+}
+
+// Returns the int property `p` of the artifact `artifact_id`.
+int64 GetIntProperty(const int64 artifact_id, MetadataStore* store) {
+  GetArtifactsByIDRequest request;
+  request.add_artifact_ids(artifact_id);
+  GetArtifactsByIDResponse response;
+  TF_CHECK_OK(store->GetArtifactsByID(request, &response));
+  CHECK_EQ(response.artifacts_size(), 1);
+  return response.artifacts(0).properties().at("p").int_value();
+}
+
+TEST(MetadataStoreFactoryTest, InlineNodePropertiesWithOtherStores) {
+  const std::string filename_uri = absl::StrCat(
+      ::testing::TempDir(), "inline_node_properties_with_other_stores.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> earlier_store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &earlier_store));
+  ConnectionConfig inline_connection_config = connection_config;
+  inline_connection_config.set_inline_node_properties(true);
+  std::unique_ptr<MetadataStore> inline_store;
+  TF_ASSERT_OK(CreateMetadataStore(inline_connection_config, &inline_store));
+
+  // The store which connected before the columns were added does not fill
+  // them, and its nodes are read from the property tables.
+  const int64 earlier_id = PutArtifactWithProperties(1, earlier_store.get());
+  EXPECT_EQ(GetIntProperty(earlier_id, inline_store.get()), 1);
+
+  // A store connecting without the option keeps the columns up to date.
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+  const int64 inline_id = PutArtifactWithProperties(2, inline_store.get());
+  const int64 stored_id = PutArtifactWithProperties(3, store.get());
+  GetArtifactsByIDRequest get_request;
+  get_request.add_artifact_ids(inline_id);
+  GetArtifactsByIDResponse get_response;
+  TF_ASSERT_OK(store->GetArtifactsByID(get_request, &get_response));
+  ASSERT_EQ(get_response.artifacts_size(), 1);
+  PutArtifactsRequest put_request;
+  *put_request.add_artifacts() = get_response.artifacts(0);
+  (*put_request.mutable_artifacts(0)->mutable_properties())["p"]
+      .set_int_value(4);
+  PutArtifactsResponse put_response;
+  TF_ASSERT_OK(store->PutArtifacts(put_request, &put_response));
+  EXPECT_EQ(GetIntProperty(inline_id, inline_store.get()), 4);
+  EXPECT_EQ(GetIntProperty(stored_id, inline_store.get()), 3);
+  earlier_store.reset();
+  inline_store.reset();
+  store.reset();
+  ASSERT_EQ(std::remove(filename_uri.c_str()), 0);
+}
+
 }  // namespace
 }  // namespace ml_metadata
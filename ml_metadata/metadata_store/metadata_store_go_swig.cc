@@ -299,8 +299,16 @@ static void* Swig_malloc(int c) {
 #include <string>
 
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 template <typename ProtoType>
@@ -630,6 +638,166 @@ string GetExecutionsByContext(ml_metadata::MetadataStore *metadata_store,
       request, status);
 }
 
+// The serialized results of the last batch of a Store, which are kept for
+// CopyBatchResults when they do not fit the buffer given to PutInBatch. The
+// buffer is reused by the batches of the Store to avoid allocating it per call.
+struct MetadataStoreBatchBuffer {
+  string results;
+};
+
+MetadataStoreBatchBuffer* NewBatchBuffer() {
+  return new MetadataStoreBatchBuffer();
+}
+
+void DeleteBatchBuffer(MetadataStoreBatchBuffer* batch_buffer) {
+  if (batch_buffer != nullptr) {
+    delete batch_buffer;
+  }
+}
+
+// Appends `value` as a protobuf varint to `output`.
+void AppendVarint(uint64_t value, string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+// Appends `bytes` with its varint length prefix to `output`.
+void AppendBytes(absl::string_view bytes, string* output) {
+  AppendVarint(bytes.size(), output);
+  output->append(bytes.data(), bytes.size());
+}
+
+// Parses the batched calls encoded by the Go Store.PutInBatch, each as the
+// length-prefixed method name followed by the length-prefixed request.
+// Returns INVALID_ARGUMENT, if a call is not a PutExecution or PutEvents call,
+//   or cannot be parsed.
+tensorflow::Status ParseBatchedPuts(
+    absl::string_view requests,
+    std::vector<ml_metadata::PutExecutionRequest>* put_execution_requests,
+    std::vector<ml_metadata::PutEventsRequest>* put_events_requests,
+    std::vector<string>* methods) {
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t*>(requests.data()), requests.size());
+  while (!input.ExpectAtEnd()) {
+    uint32_t method_size, request_size;
+    string method;
+    if (!input.ReadVarint32(&method_size) ||
+        !input.ReadString(&method, method_size) ||
+        !input.ReadVarint32(&request_size)) {
+      return tensorflow::errors::InvalidArgument("Could not parse the batch");
+    }
+    // The request is parsed in place, an empty one may end the batch.
+    const void* request = nullptr;
+    int buffer_size = 0;
+    if (request_size > 0 &&
+        (!input.GetDirectBufferPointer(&request, &buffer_size) ||
+         buffer_size < static_cast<int64_t>(request_size))) {
+      return tensorflow::errors::InvalidArgument("Could not parse the batch");
+    }
+    bool parsed = false;
+    if (method == "PutExecution") {
+      put_execution_requests->emplace_back();
+      parsed = put_execution_requests->back().ParseFromArray(request,
+                                                             request_size);
+    } else if (method == "PutEvents") {
+      put_events_requests->emplace_back();
+      parsed =
+          put_events_requests->back().ParseFromArray(request, request_size);
+    } else {
+      return tensorflow::errors::InvalidArgument(
+          "Only PutExecution and PutEvents can run in a batch, got: ", method);
+    }
+    if (!parsed) {
+      return tensorflow::errors::InvalidArgument("Could not parse proto");
+    }
+    input.Skip(request_size);
+    methods->push_back(std::move(method));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Runs the PutExecution and PutEvents calls encoded in `requests` in one
+// transaction, see MetadataStore::PutInBatch, or one after another if the
+// store does not support batches. The result of each call is encoded in the
+// `batch_buffer` as the varint status code, followed by the length-prefixed
+// error message and serialized response. The results are copied to `output`,
+// if they fit, and their size is returned. If the batch fails, `status` is
+// set and none of the calls is committed.
+int64_t PutInBatch(ml_metadata::MetadataStore* metadata_store,
+                   MetadataStoreBatchBuffer* batch_buffer,
+                   absl::string_view requests, char* output,
+                   int64_t output_size, tensorflow::Status* status) {
+  std::vector<ml_metadata::PutExecutionRequest> put_execution_requests;
+  std::vector<ml_metadata::PutEventsRequest> put_events_requests;
+  std::vector<string> methods;
+  *status = ParseBatchedPuts(requests, &put_execution_requests,
+                             &put_events_requests, &methods);
+  if (!status->ok()) return 0;
+
+  // The requests and responses are not moved once the batch points to them.
+  std::vector<ml_metadata::PutExecutionResponse> put_execution_responses(
+      put_execution_requests.size());
+  std::vector<ml_metadata::PutEventsResponse> put_events_responses(
+      put_events_requests.size());
+  std::vector<ml_metadata::MetadataStore::BatchedPut> batch(methods.size());
+  for (int i = 0, execution_index = 0, events_index = 0; i < methods.size();
+       i++) {
+    if (methods[i] == "PutExecution") {
+      batch[i].put_execution_request = &put_execution_requests[execution_index];
+      batch[i].put_execution_response =
+          &put_execution_responses[execution_index++];
+    } else {
+      batch[i].put_events_request = &put_events_requests[events_index];
+      batch[i].put_events_response = &put_events_responses[events_index++];
+    }
+  }
+  *status = metadata_store->PutInBatch(&batch);
+  if (tensorflow::errors::IsUnimplemented(*status)) {
+    for (ml_metadata::MetadataStore::BatchedPut& put : batch) {
+      put.status =
+          put.put_execution_request != nullptr
+              ? metadata_store->PutExecution(*put.put_execution_request,
+                                             put.put_execution_response)
+              : metadata_store->PutEvents(*put.put_events_request,
+                                          put.put_events_response);
+    }
+    *status = tensorflow::Status::OK();
+  }
+  if (!status->ok()) return 0;
+
+  string& results = batch_buffer->results;
+  results.clear();
+  string response;
+  for (const ml_metadata::MetadataStore::BatchedPut& put : batch) {
+    response.clear();
+    if (put.status.ok()) {
+      if (put.put_execution_response != nullptr) {
+        put.put_execution_response->AppendToString(&response);
+      } else {
+        put.put_events_response->AppendToString(&response);
+      }
+    }
+    AppendVarint(put.status.code(), &results);
+    AppendBytes(put.status.error_message(), &results);
+    AppendBytes(response, &results);
+  }
+  if (!results.empty() && results.size() <= output_size) {
+    memcpy(output, results.data(), results.size());
+  }
+  return results.size();
+}
+
+// Copies the results of the last PutInBatch of `batch_buffer` to `output`,
+// which must be large enough to hold them.
+void CopyBatchResults(MetadataStoreBatchBuffer* batch_buffer, char* output,
+                      int64_t output_size) {
+  memcpy(output, batch_buffer->results.data(),
+         std::min<int64_t>(batch_buffer->results.size(), output_size));
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -684,6 +852,59 @@ void _wrap_DestroyMetadataStore_metadata_store_go_wrap_5df522163b916b31(
   DestroyMetadataStore(arg1);
 }
 
+MetadataStoreBatchBuffer *
+_wrap_NewBatchBuffer_metadata_store_go_wrap_5df522163b916b31() {
+  MetadataStoreBatchBuffer *result = 0;
+  MetadataStoreBatchBuffer *_swig_go_result;
+
+  result = (MetadataStoreBatchBuffer *)NewBatchBuffer();
+  *(MetadataStoreBatchBuffer **)&_swig_go_result =
+      (MetadataStoreBatchBuffer *)result;
+  return _swig_go_result;
+}
+
+void _wrap_DeleteBatchBuffer_metadata_store_go_wrap_5df522163b916b31(
+    MetadataStoreBatchBuffer *_swig_go_0) {
+  MetadataStoreBatchBuffer *arg1 = (MetadataStoreBatchBuffer *)0;
+
+  arg1 = *(MetadataStoreBatchBuffer **)&_swig_go_0;
+
+  DeleteBatchBuffer(arg1);
+}
+
+long long _wrap_PutInBatch_metadata_store_go_wrap_5df522163b916b31(
+    ml_metadata::MetadataStore *_swig_go_0,
+    MetadataStoreBatchBuffer *_swig_go_1, _goslice_ _swig_go_2,
+    _goslice_ _swig_go_3, tensorflow::Status *_swig_go_4) {
+  ml_metadata::MetadataStore *arg1 = (ml_metadata::MetadataStore *)0;
+  MetadataStoreBatchBuffer *arg2 = (MetadataStoreBatchBuffer *)0;
+  tensorflow::Status *arg5 = (tensorflow::Status *)0;
+  int64_t result;
+  long long _swig_go_result;
+
+  arg1 = *(ml_metadata::MetadataStore **)&_swig_go_0;
+  arg2 = *(MetadataStoreBatchBuffer **)&_swig_go_1;
+
+  // The go slices are only accessed during the call.
+  absl::string_view arg3((const char *)_swig_go_2.array, _swig_go_2.len);
+
+  arg5 = *(tensorflow::Status **)&_swig_go_4;
+
+  result = PutInBatch(arg1, arg2, arg3, (char *)_swig_go_3.array,
+                      _swig_go_3.len, arg5);
+  _swig_go_result = result;
+  return _swig_go_result;
+}
+
+void _wrap_CopyBatchResults_metadata_store_go_wrap_5df522163b916b31(
+    MetadataStoreBatchBuffer *_swig_go_0, _goslice_ _swig_go_1) {
+  MetadataStoreBatchBuffer *arg1 = (MetadataStoreBatchBuffer *)0;
+
+  arg1 = *(MetadataStoreBatchBuffer **)&_swig_go_0;
+
+  CopyBatchResults(arg1, (char *)_swig_go_1.array, _swig_go_1.len);
+}
+
 _gostring_ _wrap_PutArtifactType_metadata_store_go_wrap_5df522163b916b31(
     ml_metadata::MetadataStore *_swig_go_0, _gostring_ _swig_go_1,
     tensorflow::Status *_swig_go_2) {
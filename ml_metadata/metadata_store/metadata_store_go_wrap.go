@@ -119,10 +119,17 @@ typedef _gostring_ swig_type_73;
 typedef _gostring_ swig_type_74;
 typedef _gostring_ swig_type_75;
 typedef _gostring_ swig_type_76;
+typedef _goslice_ swig_type_77;
+typedef _goslice_ swig_type_78;
+typedef _goslice_ swig_type_79;
 extern void _wrap_Swig_free_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1);
 extern uintptr_t _wrap_Swig_malloc_metadata_store_go_wrap_5df522163b916b31(swig_intgo arg1);
 extern uintptr_t _wrap_CreateMetadataStore_metadata_store_go_wrap_5df522163b916b31(swig_type_1 arg1, uintptr_t arg2);
 extern void _wrap_DestroyMetadataStore_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1);
+extern uintptr_t _wrap_NewBatchBuffer_metadata_store_go_wrap_5df522163b916b31(void);
+extern void _wrap_DeleteBatchBuffer_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1);
+extern long long _wrap_PutInBatch_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1, uintptr_t arg2, swig_type_77 arg3, swig_type_78 arg4, uintptr_t arg5);
+extern void _wrap_CopyBatchResults_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1, swig_type_79 arg2);
 extern swig_type_2 _wrap_PutArtifactType_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1, swig_type_3 arg2, uintptr_t arg3);
 extern swig_type_4 _wrap_GetArtifactType_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1, swig_type_5 arg2, uintptr_t arg3);
 extern swig_type_6 _wrap_GetArtifactTypes_metadata_store_go_wrap_5df522163b916b31(uintptr_t arg1, swig_type_7 arg2, uintptr_t arg3);
@@ -227,6 +234,43 @@ func DestroyMetadataStore(arg1 Ml_metadata_MetadataStore) {
 	C._wrap_DestroyMetadataStore_metadata_store_go_wrap_5df522163b916b31(C.uintptr_t(_swig_i_0))
 }
 
+func NewBatchBuffer() (_swig_ret MetadataStoreBatchBuffer) {
+	var swig_r MetadataStoreBatchBuffer
+	swig_r = (MetadataStoreBatchBuffer)(SwigcptrMetadataStoreBatchBuffer(C._wrap_NewBatchBuffer_metadata_store_go_wrap_5df522163b916b31()))
+	return swig_r
+}
+
+func DeleteBatchBuffer(arg1 MetadataStoreBatchBuffer) {
+	_swig_i_0 := arg1.Swigcptr()
+	C._wrap_DeleteBatchBuffer_metadata_store_go_wrap_5df522163b916b31(C.uintptr_t(_swig_i_0))
+}
+
+func PutInBatch(arg1 Ml_metadata_MetadataStore, arg2 MetadataStoreBatchBuffer, arg3 []byte, arg4 []byte, arg5 Status) (_swig_ret int64) {
+	var swig_r int64
+	_swig_i_0 := arg1.Swigcptr()
+	_swig_i_1 := arg2.Swigcptr()
+	_swig_i_2 := arg3
+	_swig_i_3 := arg4
+	_swig_i_4 := arg5.Swigcptr()
+	swig_r = (int64)(C._wrap_PutInBatch_metadata_store_go_wrap_5df522163b916b31(C.uintptr_t(_swig_i_0), C.uintptr_t(_swig_i_1), *(*C.swig_type_77)(unsafe.Pointer(&_swig_i_2)), *(*C.swig_type_78)(unsafe.Pointer(&_swig_i_3)), C.uintptr_t(_swig_i_4)))
+	if Swig_escape_always_false {
+		Swig_escape_val = arg3
+	}
+	if Swig_escape_always_false {
+		Swig_escape_val = arg4
+	}
+	return swig_r
+}
+
+func CopyBatchResults(arg1 MetadataStoreBatchBuffer, arg2 []byte) {
+	_swig_i_0 := arg1.Swigcptr()
+	_swig_i_1 := arg2
+	C._wrap_CopyBatchResults_metadata_store_go_wrap_5df522163b916b31(C.uintptr_t(_swig_i_0), *(*C.swig_type_79)(unsafe.Pointer(&_swig_i_1)))
+	if Swig_escape_always_false {
+		Swig_escape_val = arg2
+	}
+}
+
 func PutArtifactType(arg1 Ml_metadata_MetadataStore, arg2 string, arg3 Status) (_swig_ret string) {
 	var swig_r string
 	_swig_i_0 := arg1.Swigcptr()
@@ -881,6 +925,15 @@ func (p SwigcptrMl_metadata_MetadataStore) Swigcptr() uintptr {
 	return uintptr(p)
 }
 
+type SwigcptrMetadataStoreBatchBuffer uintptr
+type MetadataStoreBatchBuffer interface {
+	Swigcptr() uintptr
+}
+
+func (p SwigcptrMetadataStoreBatchBuffer) Swigcptr() uintptr {
+	return uintptr(p)
+}
+
 type SwigcptrTensorflow_StringPiece uintptr
 type Tensorflow_StringPiece interface {
 	Swigcptr() uintptr
@@ -0,0 +1,389 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace ml_metadata {
+
+MetadataStorePool::ScopedMetadataStore::~ScopedMetadataStore() { Reset(); }
+
+MetadataStorePool::ScopedMetadataStore::ScopedMetadataStore(
+    ScopedMetadataStore&& other)
+    : pool_(other.pool_),
+      store_(std::move(other.store_)),
+      release_(std::move(other.release_)) {
+  other.pool_ = nullptr;
+  other.release_ = nullptr;
+}
+
+MetadataStorePool::ScopedMetadataStore&
+MetadataStorePool::ScopedMetadataStore::operator=(ScopedMetadataStore&& other) {
+  if (this != &other) {
+    Reset();
+    pool_ = other.pool_;
+    store_ = std::move(other.store_);
+    release_ = std::move(other.release_);
+    other.pool_ = nullptr;
+    other.release_ = nullptr;
+  }
+  return *this;
+}
+
+void MetadataStorePool::ScopedMetadataStore::Reset() {
+  if (release_ != nullptr && store_ != nullptr) {
+    const std::function<void(ScopedMetadataStore)> release =
+        std::move(release_);
+    release_ = nullptr;
+    ScopedMetadataStore released;
+    released.pool_ = pool_;
+    released.store_ = std::move(store_);
+    pool_ = nullptr;
+    release(std::move(released));
+    return;
+  }
+  if (pool_ != nullptr && store_ != nullptr) {
+    pool_->Release(std::move(store_));
+  }
+  pool_ = nullptr;
+  store_.reset();
+  release_ = nullptr;
+}
+
+void MetadataStorePool::ScopedMetadataStore::Discard() {
+  if (pool_ != nullptr && store_ != nullptr) {
+    store_.reset();
+    pool_->Drop();
+  }
+  pool_ = nullptr;
+  store_.reset();
+  release_ = nullptr;
+}
+
+MetadataStorePool::MetadataStorePool(const ConnectionConfig& connection_config,
+                                     const MetadataStorePoolOptions& options)
+    : connection_config_(connection_config),
+      options_(options),
+      type_cache_(options.enable_type_cache &&
+                          !connection_config.has_fake_database()
+                      ? absl::make_unique<TypeCache>()
+                      : nullptr),
+      node_cache_(options.enable_node_cache &&
+                          !connection_config.has_fake_database() &&
+                          !connection_config.has_sharded()
+                      ? absl::make_unique<NodeCache>(
+                            options.node_cache_max_bytes, /*num_shards=*/16,
+                            options.node_cache_retains_serialized_nodes)
+                      : nullptr),
+      acquire_latency_(MetricsRegistry::Global()->GetHistogram(
+          "mlmd_pool_acquire_latency_seconds",
+          "The latency of borrowing a connected store from a pool, including "
+          "the wait for a free one and connecting a new one.",
+          {{"pool", options.name}})),
+      num_created_stores_(MetricsRegistry::Global()->GetCounter(
+          "mlmd_pool_created_stores_total",
+          "The number of stores connected by a pool.",
+          {{"pool", options.name}})) {
+  CHECK_GT(options_.max_size, 0) << "The pool max_size must be positive.";
+  MetricsRegistry* registry = MetricsRegistry::Global();
+  const MetricLabels labels = {{"pool", options_.name}};
+  gauge_ids_.push_back(registry->AddGauge(
+      "mlmd_pool_size",
+      "The number of stores owned by a pool, either idle or borrowed.",
+      labels, [this] { return size(); }));
+  gauge_ids_.push_back(registry->AddGauge(
+      "mlmd_pool_idle_stores", "The number of idle stores kept in a pool.",
+      labels, [this] { return num_idle(); }));
+  gauge_ids_.push_back(registry->AddGauge(
+      "mlmd_pool_max_size", "The max number of stores owned by a pool.",
+      labels, [this] { return options_.max_size; }));
+}
+
+MetadataStorePool::~MetadataStorePool() {
+  for (const int64_t gauge_id : gauge_ids_) {
+    MetricsRegistry::Global()->RemoveGauge(gauge_id);
+  }
+  absl::MutexLock lock(&mu_);
+  CHECK_EQ(num_in_use_, 0)
+      << "All borrowed stores must be returned before destructing the pool.";
+}
+
+bool MetadataStorePool::HasCapacityLocked() const {
+  return !idle_stores_.empty() || num_in_use_ < options_.max_size;
+}
+
+void MetadataStorePool::EvictExpiredStoresLocked(
+    const absl::Time now,
+    std::vector<std::unique_ptr<MetadataStore>>* evicted) {
+  while (!idle_stores_.empty() &&
+         now - idle_stores_.front().last_used_time > options_.max_idle_time) {
+    evicted->push_back(std::move(idle_stores_.front().store));
+    idle_stores_.pop_front();
+  }
+}
+
+tensorflow::Status MetadataStorePool::Acquire(ScopedMetadataStore* result) {
+  return AcquireWithTimeout(result, options_.acquire_timeout);
+}
+
+tensorflow::Status MetadataStorePool::AcquireWithTimeout(
+    ScopedMetadataStore* result, const absl::Duration timeout) {
+  if (result == nullptr) {
+    return tensorflow::errors::InvalidArgument("result is null");
+  }
+  result->Reset();
+  const ScopedLatencyRecorder latency_recorder(acquire_latency_);
+  std::unique_ptr<MetadataStore> store;
+  absl::Time last_used_time;
+  // Closing a store may take a network round-trip, so the evicted stores are
+  // destructed after releasing the lock.
+  std::vector<std::unique_ptr<MetadataStore>> evicted;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!mu_.AwaitWithTimeout(
+            absl::Condition(this, &MetadataStorePool::HasCapacityLocked),
+            timeout)) {
+      return tensorflow::errors::ResourceExhausted(
+          "All ", options_.max_size,
+          " metadata stores in the pool are in use.");
+    }
+    EvictExpiredStoresLocked(absl::Now(), &evicted);
+    // Reuses the most recently returned store, so that rarely used ones expire.
+    if (!idle_stores_.empty()) {
+      store = std::move(idle_stores_.back().store);
+      last_used_time = idle_stores_.back().last_used_time;
+      idle_stores_.pop_back();
+    }
+    num_in_use_++;
+  }
+  evicted.clear();
+
+  if (store != nullptr &&
+      absl::Now() - last_used_time > options_.health_check_interval) {
+    const tensorflow::Status health_status = store->CheckHealth();
+    if (!health_status.ok()) {
+      LOG(WARNING) << "Closing an unhealthy metadata store: " << health_status;
+      store.reset();
+    }
+  }
+  if (store == nullptr) {
+    const tensorflow::Status status =
+        CreateMetadataStore(connection_config_, MigrationOptions(),
+                            type_cache_.get(), node_cache_.get(), &store);
+    if (!status.ok()) {
+      Drop();
+      return status;
+    }
+    num_created_stores_->Increment();
+  }
+  result->pool_ = this;
+  result->store_ = std::move(store);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStorePool::GetArtifactsByType(
+    const GetArtifactsByTypeRequest& request,
+    const ParallelReadOptions& options, const absl::Time deadline,
+    GetArtifactsByTypeResponse* response) {
+  if (options.max_parallelism <= 0 || options.min_nodes_per_part <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "max_parallelism and min_nodes_per_part must be positive.");
+  }
+  std::vector<ScopedMetadataStore> stores(1);
+  TF_RETURN_IF_ERROR(Acquire(&stores[0]));
+  stores[0]->SetTransactionDeadline(deadline);
+  std::vector<int64> ids;
+  TF_RETURN_IF_ERROR(stores[0]->GetArtifactIdsByType(request, &ids));
+  const int64 max_parts = std::min<int64>(
+      options.max_parallelism,
+      static_cast<int64>(ids.size()) / options.min_nodes_per_part);
+  // Each store of a fake_database connects to its own in-memory database.
+  if (max_parts < 2 || connection_config_.has_fake_database()) {
+    return stores[0]->GetArtifactsByType(request, response);
+  }
+  // The extra stores are borrowed without waiting, so that a large request
+  // does not starve the other callers of the pool.
+  while (stores.size() < max_parts) {
+    ScopedMetadataStore store;
+    const tensorflow::Status status =
+        AcquireWithTimeout(&store, absl::ZeroDuration());
+    if (tensorflow::errors::IsResourceExhausted(status)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(status);
+    store->SetTransactionDeadline(deadline);
+    stores.push_back(std::move(store));
+  }
+
+  // Part i reads the ids in [bounds[i], bounds[i + 1]).
+  const int num_parts = stores.size();
+  std::vector<size_t> bounds(num_parts + 1);
+  for (int i = 0; i <= num_parts; i++) {
+    bounds[i] = ids.size() * i / num_parts;
+  }
+  std::vector<GetArtifactsByIDResponse> part_responses(num_parts);
+  std::vector<tensorflow::Status> part_statuses(num_parts);
+  const auto read_part = [&](const int i) {
+    GetArtifactsByIDRequest part_request;
+    part_request.mutable_artifact_ids()->Add(ids.begin() + bounds[i],
+                                             ids.begin() + bounds[i + 1]);
+    *part_request.mutable_property_options() = request.property_options();
+    part_statuses[i] =
+        stores[i]->GetArtifactsByID(part_request, &part_responses[i]);
+    google::protobuf::RepeatedPtrField<Artifact>& artifacts =
+        *part_responses[i].mutable_artifacts();
+    std::sort(artifacts.begin(), artifacts.end(),
+              [](const Artifact& a, const Artifact& b) {
+                return a.id() < b.id();
+              });
+  };
+  absl::BlockingCounter pending_parts(num_parts - 1);
+  tensorflow::thread::ThreadPool* const threads = ParallelReadThreads();
+  for (int i = 1; i < num_parts; i++) {
+    threads->Schedule([&read_part, &pending_parts, i]() {
+      read_part(i);
+      pending_parts.DecrementCount();
+    });
+  }
+  read_part(0);
+  pending_parts.Wait();
+  for (const tensorflow::Status& status : part_statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  response->Clear();
+  response->mutable_artifacts()->Reserve(ids.size());
+  for (GetArtifactsByIDResponse& part_response : part_responses) {
+    for (Artifact& artifact : *part_response.mutable_artifacts()) {
+      *response->add_artifacts() = std::move(artifact);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::thread::ThreadPool* MetadataStorePool::ParallelReadThreads() {
+  absl::call_once(parallel_read_threads_once_, [this]() {
+    parallel_read_threads_ = absl::make_unique<tensorflow::thread::ThreadPool>(
+        tensorflow::Env::Default(), "mlmd_parallel_read", options_.max_size);
+  });
+  return parallel_read_threads_.get();
+}
+
+tensorflow::Status MetadataStorePool::WarmUp(
+    const PoolWarmUpOptions& options) {
+  if (options.num_stores <= 0 || options.num_recent_contexts < 0) {
+    return tensorflow::errors::InvalidArgument(
+        "num_stores must be positive and num_recent_contexts must not be "
+        "negative.");
+  }
+  // The stores are held until all of them are connected, so that each one is
+  // a new connection instead of a reused idle store.
+  const int num_stores = std::min(options.num_stores, options_.max_size);
+  std::vector<ScopedMetadataStore> stores(num_stores);
+  std::vector<tensorflow::Status> statuses(num_stores);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "mlmd_pool_warm_up", num_stores);
+    for (int i = 0; i < num_stores; i++) {
+      pool.Schedule([&, i]() { statuses[i] = Acquire(&stores[i]); });
+    }
+  }
+  for (const tensorflow::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  MetadataStore* store = stores[0].get();
+  if (options.preload_types) {
+    GetArtifactTypesResponse artifact_types;
+    TF_RETURN_IF_ERROR(
+        store->GetArtifactTypes(GetArtifactTypesRequest(), &artifact_types));
+    GetExecutionTypesResponse execution_types;
+    TF_RETURN_IF_ERROR(store->GetExecutionTypes(GetExecutionTypesRequest(),
+                                                &execution_types));
+    GetContextTypesResponse context_types;
+    TF_RETURN_IF_ERROR(
+        store->GetContextTypes(GetContextTypesRequest(), &context_types));
+  }
+  int num_contexts = 0;
+  GetContextsRequest contexts_request;
+  ListOperationOptions& list_options = *contexts_request.mutable_options();
+  list_options.set_bulk_mode(true);
+  list_options.mutable_order_by_field()->set_field(
+      ListOperationOptions::OrderByField::LAST_UPDATE_TIME);
+  list_options.mutable_order_by_field()->set_is_asc(false);
+  while (num_contexts < options.num_recent_contexts) {
+    list_options.set_max_result_size(options.num_recent_contexts -
+                                     num_contexts);
+    GetContextsResponse contexts_response;
+    TF_RETURN_IF_ERROR(
+        store->GetContexts(contexts_request, &contexts_response));
+    num_contexts += contexts_response.contexts_size();
+    if (contexts_response.next_page_token().empty() ||
+        contexts_response.contexts_size() == 0) {
+      break;
+    }
+    list_options.set_next_page_token(contexts_response.next_page_token());
+  }
+  LOG(INFO) << "Warmed up the " << options_.name << " metadata store pool with "
+            << num_stores << " stores and " << num_contexts << " contexts.";
+  return tensorflow::Status::OK();
+}
+
+void MetadataStorePool::Release(std::unique_ptr<MetadataStore> store) {
+  // The connections of a store are not handed to the next borrower, once a
+  // call has failed with an error they may cause.
+  if (store->connection_failed()) {
+    LOG(WARNING) << "Closing a metadata store whose connection has failed.";
+    store.reset();
+    Drop();
+    return;
+  }
+  // The deadline set by the borrower does not apply to the next one.
+  store->SetTransactionDeadline(absl::InfiniteFuture());
+  std::vector<std::unique_ptr<MetadataStore>> evicted;
+  {
+    absl::MutexLock lock(&mu_);
+    const absl::Time now = absl::Now();
+    idle_stores_.push_back({std::move(store), now});
+    num_in_use_--;
+    EvictExpiredStoresLocked(now, &evicted);
+  }
+}
+
+void MetadataStorePool::Drop() {
+  absl::MutexLock lock(&mu_);
+  num_in_use_--;
+}
+
+int MetadataStorePool::size() const {
+  absl::MutexLock lock(&mu_);
+  return num_in_use_ + idle_stores_.size();
+}
+
+int MetadataStorePool::num_idle() const {
+  absl::MutexLock lock(&mu_);
+  return idle_stores_.size();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,271 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/node_cache.h"
+#include "ml_metadata/metadata_store/type_cache.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace ml_metadata {
+
+// Options of the reads which are split across the stores of a
+// MetadataStorePool.
+struct ParallelReadOptions {
+  // The max number of stores used by one request. It must be positive. Fewer
+  // stores are used if the pool has no spare capacity.
+  int max_parallelism = 4;
+  // The min number of nodes read by each store. A request with fewer than
+  // twice as many nodes is read by a single store.
+  int64 min_nodes_per_part = 10000;
+};
+
+// Options to tune a MetadataStorePool.
+struct MetadataStorePoolOptions {
+  // The max number of connected stores owned by the pool, including the ones
+  // currently borrowed by callers. It must be positive.
+  int max_size = 16;
+  // An idle store older than this duration is closed instead of being reused.
+  absl::Duration max_idle_time = absl::Minutes(5);
+  // An idle store is health checked before being handed out again, if it has
+  // not been used for longer than this duration.
+  absl::Duration health_check_interval = absl::Seconds(30);
+  // The max duration Acquire waits for a store when the pool is exhausted.
+  absl::Duration acquire_timeout = absl::Seconds(30);
+  // If true, the stores share the types they read through a TypeCache owned by
+  // the pool. It is ignored for a fake_database, as each store connects to its
+  // own in-memory database.
+  bool enable_type_cache = false;
+  // If true, the stores share the artifacts, executions and contexts they read
+  // through a NodeCache owned by the pool, which holds at most
+  // `node_cache_max_bytes` of nodes. It is ignored for a fake_database like
+  // the type cache, and for a sharded database.
+  bool enable_node_cache = false;
+  int64 node_cache_max_bytes = 256 << 20;
+  // If true, the node cache also keeps the wire form of its nodes, which the
+  // raw GetArtifactsByID, GetExecutionsByID and GetContextsByID methods of
+  // MetadataStoreServiceImpl splice into their responses.
+  bool node_cache_retains_serialized_nodes = false;
+  // The `pool` label of the metrics exported for the pool, e.g., its
+  // occupancy. The metrics of the pools with the same name are merged.
+  std::string name = "default";
+  // If set, the GetArtifactsByType calls of MetadataStoreServiceImpl outside
+  // of read sessions split the large types across the stores of the pool,
+  // see MetadataStorePool::GetArtifactsByType. It is ignored for a
+  // fake_database like the caches.
+  absl::optional<ParallelReadOptions> parallel_read;
+};
+
+struct PoolWarmUpOptions {
+  // The number of stores connected ahead of the calls, in parallel. It is
+  // capped by the pool max_size.
+  int num_stores = 1;
+  // If true, all the types are read once, which fills the type cache of the
+  // pool, if enabled.
+  bool preload_types = true;
+  // The number of the most recently updated contexts read once, which fills
+  // the node cache of the pool, if enabled. 0 reads none.
+  int num_recent_contexts = 0;
+};
+
+// A bounded pool of connected MetadataStores created with the same
+// ConnectionConfig. It amortizes the cost of connecting to the metadata source
+// (e.g., the MySQL handshake) across requests. It is thread-safe, while each
+// borrowed store is used by one caller at a time.
+//
+// Usage example:
+//
+//   MetadataStorePool pool(connection_config, MetadataStorePoolOptions());
+//   MetadataStorePool::ScopedMetadataStore store;
+//   TF_RETURN_IF_ERROR(pool.Acquire(&store));
+//   TF_RETURN_IF_ERROR(store->GetArtifactType(request, &response));
+//   // the store is returned to `pool` when `store` goes out of scope.
+class MetadataStorePool {
+ public:
+  // A handle of a store borrowed from a pool. The store is returned to the
+  // pool when the handle is destructed or reassigned.
+  class ScopedMetadataStore {
+   public:
+    ScopedMetadataStore() = default;
+    ~ScopedMetadataStore();
+
+    ScopedMetadataStore(ScopedMetadataStore&& other);
+    ScopedMetadataStore& operator=(ScopedMetadataStore&& other);
+
+    // Disallow copy and assign.
+    ScopedMetadataStore(const ScopedMetadataStore&) = delete;
+    ScopedMetadataStore& operator=(const ScopedMetadataStore&) = delete;
+
+    MetadataStore* get() const { return store_.get(); }
+    MetadataStore* operator->() const { return store_.get(); }
+    MetadataStore& operator*() const { return *store_; }
+
+    // Returns the store to the pool, the handle becomes empty.
+    void Reset();
+
+    // Closes the store instead of returning it to the pool, e.g., when the
+    // caller observes the connection is broken. The handle becomes empty.
+    void Discard();
+
+    // Passes the store to `release` instead of returning it to the pool once
+    // the handle is reset, e.g., to keep it for the later calls of a read
+    // session. The handle given to `release` returns the store to the pool.
+    // It is not called if the store is discarded.
+    void SetRelease(std::function<void(ScopedMetadataStore)> release) {
+      release_ = std::move(release);
+    }
+
+   private:
+    friend class MetadataStorePool;
+
+    MetadataStorePool* pool_ = nullptr;
+    std::unique_ptr<MetadataStore> store_;
+    std::function<void(ScopedMetadataStore)> release_;
+  };
+
+  MetadataStorePool(const ConnectionConfig& connection_config,
+                    const MetadataStorePoolOptions& options);
+
+  // Disallow copy and assign.
+  MetadataStorePool(const MetadataStorePool&) = delete;
+  MetadataStorePool& operator=(const MetadataStorePool&) = delete;
+
+  // All borrowed stores must have been returned before destruction.
+  ~MetadataStorePool();
+
+  // Borrows a connected store. Idle stores are reused first and health checked
+  // if they have not been used recently; a new store is created only if no
+  // healthy idle store exists. The created store does not handle migration.
+  // Returns RESOURCE_EXHAUSTED error, if `max_size` stores are in use for
+  //   longer than `acquire_timeout`.
+  // Returns detailed error, if a new store cannot be created.
+  tensorflow::Status Acquire(ScopedMetadataStore* result);
+
+  // Gets the artifacts of a type like MetadataStore::GetArtifactsByType, but
+  // splits a large type into contiguous id ranges, which are read and decoded
+  // in parallel by up to `options.max_parallelism` stores of the pool. The
+  // stores beyond the first one are only borrowed if the pool has idle or
+  // spare capacity. The artifacts are returned in ascending order of ids.
+  // Unlike GetArtifactsByType, the id ranges are read in separate
+  // transactions, so the artifacts updated concurrently may be read at
+  // different points in time. The caller reads one range, and the others are
+  // read on worker threads shared by all the calls of the pool. The aborted
+  // transactions are retried until `deadline`.
+  // Returns INVALID_ARGUMENT error, if `options` are invalid.
+  // Returns the same errors as Acquire and GetArtifactsByType otherwise.
+  tensorflow::Status GetArtifactsByType(
+      const GetArtifactsByTypeRequest& request,
+      const ParallelReadOptions& options, absl::Time deadline,
+      GetArtifactsByTypeResponse* response);
+
+  // Prepares the pool for the first calls, e.g., at the startup of a server,
+  // by connecting `options.num_stores` stores and returning them idle, and by
+  // filling its caches as configured by `options`.
+  // Returns INVALID_ARGUMENT error, if `options` are invalid.
+  // Returns the same errors as Acquire and the reads of the stores otherwise.
+  tensorflow::Status WarmUp(const PoolWarmUpOptions& options);
+
+  // Returns the number of stores owned by the pool, i.e., the number of idle
+  // stores plus the ones currently borrowed.
+  int size() const;
+
+  // Returns the number of idle stores kept in the pool.
+  int num_idle() const;
+
+  const MetadataStorePoolOptions& options() const { return options_; }
+
+  // Returns the type cache shared by the stores, or nullptr if it is disabled.
+  const TypeCache* type_cache() const { return type_cache_.get(); }
+
+  // Returns the node cache shared by the stores, or nullptr if it is disabled.
+  const NodeCache* node_cache() const { return node_cache_.get(); }
+
+ private:
+  // A store kept in the pool with the time when it was last returned.
+  struct IdleStore {
+    std::unique_ptr<MetadataStore> store;
+    absl::Time last_used_time;
+  };
+
+  // Borrows a store like Acquire, waiting at most `timeout` when the pool is
+  // exhausted.
+  tensorflow::Status AcquireWithTimeout(ScopedMetadataStore* result,
+                                        absl::Duration timeout);
+
+  // Returns true if an idle store can be reused or a new one can be created.
+  bool HasCapacityLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Puts a borrowed store back to the idle list, or closes it if a call has
+  // failed its connection, see MetadataStore::connection_failed.
+  void Release(std::unique_ptr<MetadataStore> store);
+
+  // Gives up a borrowed store. The store is closed by the caller.
+  void Drop();
+
+  // Returns the worker threads of the parallel reads, which are started by
+  // the first one.
+  tensorflow::thread::ThreadPool* ParallelReadThreads();
+
+  // Removes idle stores that exceeded `max_idle_time`, starting from the
+  // oldest ones. The evicted stores are moved to `evicted`, so that they can
+  // be closed without holding the lock.
+  void EvictExpiredStoresLocked(
+      absl::Time now, std::vector<std::unique_ptr<MetadataStore>>* evicted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const ConnectionConfig connection_config_;
+  const MetadataStorePoolOptions options_;
+  // It outlives the stores, which are destructed before it.
+  const std::unique_ptr<TypeCache> type_cache_;
+  const std::unique_ptr<NodeCache> node_cache_;
+
+  // The latency of Acquire, and the number of stores it created.
+  Histogram* const acquire_latency_;
+  Counter* const num_created_stores_;
+  // The ids of the exported occupancy gauges, which read the pool.
+  std::vector<int64_t> gauge_ids_;
+
+  // The worker threads of the parallel reads. There are max_size of them, as
+  // each range being read holds a store of the pool.
+  absl::once_flag parallel_read_threads_once_;
+  std::unique_ptr<tensorflow::thread::ThreadPool> parallel_read_threads_;
+
+  mutable absl::Mutex mu_;
+  // The idle stores ordered by last_used_time, the most recent at the back.
+  std::deque<IdleStore> idle_stores_ ABSL_GUARDED_BY(mu_);
+  // The number of stores which are borrowed or being created.
+  int num_in_use_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
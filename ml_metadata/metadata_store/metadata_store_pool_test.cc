@@ -0,0 +1,318 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::Pointwise;
+
+// Each store in the pool connects to its own in-memory database, which lets
+// the tests tell whether the same store is reused.
+ConnectionConfig FakeDatabaseConnectionConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+void PutArtifactType(MetadataStore* store) {
+  const PutArtifactTypeRequest request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        all_fields_match: true
+        artifact_type: { name: 'pooled_type' }
+      )");
+  PutArtifactTypeResponse response;
+  TF_ASSERT_OK(store->PutArtifactType(request, &response));
+}
+
+tensorflow::Status GetArtifactType(MetadataStore* store) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("pooled_type");
+  GetArtifactTypeResponse response;
+  return store->GetArtifactType(request, &response);
+}
+
+TEST(MetadataStorePoolTest, ReuseReturnedStore) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(pool.Acquire(&store));
+    EXPECT_EQ(pool.size(), 1);
+    EXPECT_EQ(pool.num_idle(), 0);
+    PutArtifactType(store.get());
+  }
+  EXPECT_EQ(pool.num_idle(), 1);
+
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  EXPECT_EQ(pool.size(), 1);
+  TF_EXPECT_OK(GetArtifactType(store.get()));
+}
+
+TEST(MetadataStorePoolTest, ExportMetrics) {
+  MetadataStorePoolOptions options;
+  options.name = "export_metrics";
+  {
+    MetadataStorePool pool(FakeDatabaseConnectionConfig(), options);
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(pool.Acquire(&store));
+    PutArtifactType(store.get());
+
+    const std::string text =
+        MetricsRegistry::Global()->ExportPrometheusText();
+    EXPECT_THAT(text, HasSubstr("mlmd_pool_size{pool=\"export_metrics\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("mlmd_pool_idle_stores{pool=\""
+                                "export_metrics\"} 0\n"));
+    EXPECT_THAT(text, HasSubstr("mlmd_pool_created_stores_total{pool=\""
+                                "export_metrics\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("mlmd_query_latency_seconds_count{template=\""
+                                "insert_artifact_type\"}"));
+  }
+  // The gauges of a destructed pool are removed.
+  EXPECT_THAT(MetricsRegistry::Global()->ExportPrometheusText(),
+              Not(HasSubstr("mlmd_pool_size{pool=\"export_metrics\"}")));
+}
+
+TEST(MetadataStorePoolTest, AcquireExhaustedPool) {
+  MetadataStorePoolOptions options;
+  options.max_size = 2;
+  options.acquire_timeout = absl::Milliseconds(10);
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(), options);
+  MetadataStorePool::ScopedMetadataStore store1, store2, store3;
+  TF_ASSERT_OK(pool.Acquire(&store1));
+  TF_ASSERT_OK(pool.Acquire(&store2));
+  EXPECT_TRUE(tensorflow::errors::IsResourceExhausted(pool.Acquire(&store3)));
+
+  store1.Reset();
+  TF_EXPECT_OK(pool.Acquire(&store3));
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(MetadataStorePoolTest, EvictIdleStore) {
+  MetadataStorePoolOptions options;
+  options.max_idle_time = absl::ZeroDuration();
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(), options);
+  {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(pool.Acquire(&store));
+    PutArtifactType(store.get());
+  }
+  absl::SleepFor(absl::Milliseconds(1));
+
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  EXPECT_EQ(pool.size(), 1);
+  EXPECT_TRUE(tensorflow::errors::IsNotFound(GetArtifactType(store.get())));
+}
+
+TEST(MetadataStorePoolTest, DiscardStore) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  PutArtifactType(store.get());
+  store.Discard();
+  EXPECT_EQ(pool.size(), 0);
+
+  TF_ASSERT_OK(pool.Acquire(&store));
+  EXPECT_TRUE(tensorflow::errors::IsNotFound(GetArtifactType(store.get())));
+}
+
+TEST(MetadataStorePoolTest, PassStoreToRelease) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  MetadataStorePool::ScopedMetadataStore kept;
+  {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(pool.Acquire(&store));
+    PutArtifactType(store.get());
+    store.SetRelease([&kept](MetadataStorePool::ScopedMetadataStore released) {
+      kept = std::move(released);
+    });
+  }
+  // The store is kept by `release` instead of being returned to the pool.
+  ASSERT_NE(kept.get(), nullptr);
+  EXPECT_EQ(pool.num_idle(), 0);
+  TF_EXPECT_OK(GetArtifactType(kept.get()));
+
+  // The released handle returns the store to the pool.
+  kept.Reset();
+  EXPECT_EQ(pool.num_idle(), 1);
+}
+
+TEST(MetadataStorePoolTest, NoCachesForFakeDatabase) {
+  MetadataStorePoolOptions options;
+  options.enable_type_cache = true;
+  options.enable_node_cache = true;
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(), options);
+  EXPECT_EQ(pool.type_cache(), nullptr);
+  EXPECT_EQ(pool.node_cache(), nullptr);
+}
+
+TEST(MetadataStorePoolTest, GetArtifactsByTypeInParallel) {
+  // The stores share a SQLite file, unlike the in-memory fake databases.
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "metadata_store_pool_test.db"));
+  MetadataStorePool pool(connection_config, MetadataStorePoolOptions());
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  PutArtifactTypeRequest put_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        all_fields_match: true
+        artifact_type: {
+          name: 'parallel_type'
+          properties { key: 'property' value: INT }
+        }
+      )");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(store->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 100; i++) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_type_response.type_id());
+    artifact->set_uri(absl::StrCat("uri_", i));
+    (*artifact->mutable_properties())["property"].set_int_value(i);
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(
+      store->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+  GetArtifactsByTypeRequest request;
+  request.set_type_name("parallel_type");
+  GetArtifactsByTypeResponse want_response;
+  TF_ASSERT_OK(store->GetArtifactsByType(request, &want_response));
+  std::sort(want_response.mutable_artifacts()->begin(),
+            want_response.mutable_artifacts()->end(),
+            [](const Artifact& a, const Artifact& b) {
+              return a.id() < b.id();
+            });
+  store.Reset();
+
+  ParallelReadOptions options;
+  options.max_parallelism = 3;
+  options.min_nodes_per_part = 10;
+  GetArtifactsByTypeResponse response;
+  TF_ASSERT_OK(pool.GetArtifactsByType(request, options,
+                                       absl::InfiniteFuture(), &response));
+  EXPECT_THAT(response.artifacts(),
+              Pointwise(EqualsProto<Artifact>(), want_response.artifacts()));
+  EXPECT_EQ(pool.size(), 3);
+
+  // A type with too few artifacts to split is read by a single store.
+  options.min_nodes_per_part = 100;
+  TF_ASSERT_OK(pool.GetArtifactsByType(request, options,
+                                       absl::InfiniteFuture(), &response));
+  EXPECT_THAT(response.artifacts(),
+              Pointwise(EqualsProto<Artifact>(), want_response.artifacts()));
+
+  options.max_parallelism = 0;
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(
+      pool.GetArtifactsByType(request, options, absl::InfiniteFuture(),
+                              &response)));
+}
+
+TEST(MetadataStorePoolTest, WarmUpConnectsStoresAndFillsCaches) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "metadata_store_pool_warm_up.db");
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  int64 context_type_id = 0;
+  std::vector<int64> context_ids;
+  {
+    MetadataStorePool pool(connection_config, MetadataStorePoolOptions());
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(pool.Acquire(&store));
+    PutContextTypeRequest put_type_request =
+        ParseTextProtoOrDie<PutContextTypeRequest>(R"(
+          all_fields_match: true
+          context_type: { name: 'warm_up_type' }
+        )");
+    PutContextTypeResponse put_type_response;
+    TF_ASSERT_OK(store->PutContextType(put_type_request, &put_type_response));
+    context_type_id = put_type_response.type_id();
+    PutContextsRequest put_contexts_request;
+    for (int i = 0; i < 3; i++) {
+      Context* context = put_contexts_request.add_contexts();
+      context->set_type_id(put_type_response.type_id());
+      context->set_name(absl::StrCat("context_", i));
+    }
+    PutContextsResponse put_contexts_response;
+    TF_ASSERT_OK(
+        store->PutContexts(put_contexts_request, &put_contexts_response));
+    context_ids.assign(put_contexts_response.context_ids().begin(),
+                       put_contexts_response.context_ids().end());
+  }
+
+  MetadataStorePoolOptions options;
+  options.max_size = 3;
+  options.enable_type_cache = true;
+  options.enable_node_cache = true;
+  MetadataStorePool pool(connection_config, options);
+  PoolWarmUpOptions warm_up_options;
+  warm_up_options.num_stores = 5;
+  warm_up_options.num_recent_contexts = 3;
+  TF_ASSERT_OK(pool.WarmUp(warm_up_options));
+  EXPECT_EQ(pool.size(), 3);
+  EXPECT_EQ(pool.num_idle(), 3);
+
+  // The type and the recently updated contexts are read from the caches.
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  const int64 type_cache_hits = pool.type_cache()->num_hits();
+  GetContextTypesByIDRequest get_type_request;
+  get_type_request.add_type_ids(context_type_id);
+  GetContextTypesByIDResponse get_type_response;
+  TF_ASSERT_OK(
+      store->GetContextTypesByID(get_type_request, &get_type_response));
+  EXPECT_EQ(pool.type_cache()->num_hits(), type_cache_hits + 1);
+  const int64 node_cache_hits = pool.node_cache()->num_hits();
+  GetContextsByIDRequest get_contexts_request;
+  get_contexts_request.mutable_context_ids()->Add(context_ids.begin(),
+                                                  context_ids.end());
+  GetContextsByIDResponse get_contexts_response;
+  TF_ASSERT_OK(
+      store->GetContextsByID(get_contexts_request, &get_contexts_response));
+  EXPECT_EQ(pool.node_cache()->num_hits(), node_cache_hits + 3);
+  store.Reset();
+
+  warm_up_options.num_stores = 0;
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(
+      pool.WarmUp(warm_up_options)));
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -19,15 +19,32 @@ limitations under the License.
 #include <vector>
 
 #include "gflags/gflags.h"
+#include "grpc/grpc.h"
+#include "grpcpp/health_check_service_interface.h"
+#include "grpcpp/resource_quota.h"
 #include "grpcpp/security/server_credentials.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/admission_controller.h"
+#include "ml_metadata/metadata_store/garbage_collector.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/metadata_store/metrics_http_server.h"
+#include "ml_metadata/metadata_store/pinned_read_registry.h"
+#include "ml_metadata/metadata_store/put_coalescer.h"
+#include "ml_metadata/metadata_store/query_accounting.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metrics.h"
+#include "ml_metadata/util/tracing.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -77,6 +94,157 @@ void AddGrpcChannelArgs(const string& channel_arguments_str,
   }
 }
 
+// Returns the gRPC server options given by the flags, overridden by the fields
+// set in `server_config`. The flags that are not positive or empty are
+// ignored.
+ml_metadata::MetadataStoreServerConfig::GrpcServerOptions
+GetGrpcServerOptions(
+    const int sync_server_min_pollers, const int sync_server_max_pollers,
+    const int num_completion_queues, const int max_concurrent_streams,
+    const int64 resource_quota_bytes, const int max_threads,
+    const std::string& response_compression_algorithm,
+    const int64 response_compression_min_bytes,
+    const ml_metadata::MetadataStoreServerConfig& server_config) {
+  ml_metadata::MetadataStoreServerConfig::GrpcServerOptions options;
+  if (sync_server_min_pollers > 0) {
+    options.set_sync_server_min_pollers(sync_server_min_pollers);
+  }
+  if (sync_server_max_pollers > 0) {
+    options.set_sync_server_max_pollers(sync_server_max_pollers);
+  }
+  if (num_completion_queues > 0) {
+    options.set_num_completion_queues(num_completion_queues);
+  }
+  if (max_concurrent_streams > 0) {
+    options.set_max_concurrent_streams(max_concurrent_streams);
+  }
+  if (resource_quota_bytes > 0) {
+    options.set_resource_quota_bytes(resource_quota_bytes);
+  }
+  if (max_threads > 0) {
+    options.set_max_threads(max_threads);
+  }
+  if (!response_compression_algorithm.empty()) {
+    options.set_response_compression_algorithm(response_compression_algorithm);
+  }
+  if (response_compression_min_bytes > 0) {
+    options.set_response_compression_min_bytes(response_compression_min_bytes);
+  }
+  options.MergeFrom(server_config.grpc_server_options());
+  return options;
+}
+
+// Dies if the given gRPC server options are not positive, or if the min
+// number of pollers is larger than the max.
+void CheckGrpcServerOptionsOrDie(
+    const ml_metadata::MetadataStoreServerConfig::GrpcServerOptions& options) {
+  CHECK(!options.has_sync_server_min_pollers() ||
+        options.sync_server_min_pollers() > 0)
+      << "sync_server_min_pollers must be positive.";
+  CHECK(!options.has_sync_server_max_pollers() ||
+        options.sync_server_max_pollers() > 0)
+      << "sync_server_max_pollers must be positive.";
+  CHECK(!options.has_sync_server_min_pollers() ||
+        !options.has_sync_server_max_pollers() ||
+        options.sync_server_min_pollers() <= options.sync_server_max_pollers())
+      << "sync_server_min_pollers cannot be larger than "
+         "sync_server_max_pollers.";
+  CHECK(!options.has_num_completion_queues() ||
+        options.num_completion_queues() > 0)
+      << "num_completion_queues must be positive.";
+  CHECK(!options.has_max_concurrent_streams() ||
+        options.max_concurrent_streams() > 0)
+      << "max_concurrent_streams must be positive.";
+  CHECK(!options.has_resource_quota_bytes() ||
+        options.resource_quota_bytes() > 0)
+      << "resource_quota_bytes must be positive.";
+  CHECK(!options.has_max_threads() || options.max_threads() > 0)
+      << "max_threads must be positive.";
+  CHECK(!options.has_response_compression_algorithm() ||
+        options.response_compression_algorithm() == "gzip" ||
+        options.response_compression_algorithm() == "deflate")
+      << "response_compression_algorithm must be gzip or deflate.";
+  CHECK(!options.has_response_compression_min_bytes() ||
+        options.response_compression_min_bytes() >= 0)
+      << "response_compression_min_bytes cannot be negative.";
+}
+
+// Returns how the service compresses its responses with the gRPC server
+// options, which are checked by CheckGrpcServerOptionsOrDie.
+ml_metadata::ResponseCompressionOptions GetResponseCompressionOptions(
+    const ml_metadata::MetadataStoreServerConfig::GrpcServerOptions& options) {
+  ml_metadata::ResponseCompressionOptions compression_options;
+  if (options.response_compression_algorithm() == "gzip") {
+    compression_options.algorithm = GRPC_COMPRESS_GZIP;
+  } else if (options.response_compression_algorithm() == "deflate") {
+    compression_options.algorithm = GRPC_COMPRESS_DEFLATE;
+  }
+  if (options.has_response_compression_min_bytes()) {
+    compression_options.min_response_bytes =
+        options.response_compression_min_bytes();
+  }
+  return compression_options;
+}
+
+// Applies the gRPC server options to `builder`. The number of completion
+// queues of the asynchronous server is set by MetadataStoreAsyncServerOptions.
+void ConfigureGrpcServer(
+    const ml_metadata::MetadataStoreServerConfig::GrpcServerOptions& options,
+    ::grpc::ServerBuilder* builder) {
+  if (options.has_sync_server_min_pollers()) {
+    builder->SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::MIN_POLLERS,
+        options.sync_server_min_pollers());
+  }
+  if (options.has_sync_server_max_pollers()) {
+    builder->SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::MAX_POLLERS,
+        options.sync_server_max_pollers());
+  }
+  if (options.has_num_completion_queues()) {
+    builder->SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::NUM_CQS,
+        options.num_completion_queues());
+  }
+  if (options.has_max_concurrent_streams()) {
+    builder->AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS,
+                                options.max_concurrent_streams());
+  }
+  if (options.has_resource_quota_bytes() || options.has_max_threads()) {
+    ::grpc::ResourceQuota resource_quota("mlmd_server");
+    if (options.has_resource_quota_bytes()) {
+      resource_quota.Resize(options.resource_quota_bytes());
+    }
+    if (options.has_max_threads()) {
+      resource_quota.SetMaxThreads(options.max_threads());
+    }
+    builder->SetResourceQuota(resource_quota);
+  }
+}
+
+// Creates a store of `connection_config` to init its schema, or migrate it
+// as set in `migration_options`, retrying up to `num_retries` times while the
+// connection is aborted, and dies if it fails.
+void InitMetadataStoreSchemaOrDie(
+    const ml_metadata::ConnectionConfig& connection_config,
+    const ml_metadata::MigrationOptions& migration_options,
+    const int num_retries) {
+  std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
+  tensorflow::Status status = ml_metadata::CreateMetadataStore(
+      connection_config, migration_options, &metadata_store);
+  for (int i = 0; i < num_retries; i++) {
+    if (status.ok() || !tensorflow::errors::IsAborted(status)) {
+      break;
+    }
+    LOG(WARNING) << "Connection Aborted with error: " << status;
+    LOG(INFO) << "Retry attempt " << i;
+    status = ml_metadata::CreateMetadataStore(
+        connection_config, migration_options, &metadata_store);
+  }
+  TF_CHECK_OK(status)
+      << "MetadataStore cannot be created with the given connection config.";
+}
+
 // Parses config file if provided and returns true if it is successful in
 // populating service_config.
 bool ParseMetadataStoreServerConfigOrDie(
@@ -136,6 +304,22 @@ bool ParseMySQLFlagsBasedServerConfigOrDie(
 
   return true;
 }
+
+// Warms up the store pool of `service` with `warm_up_options`, before the
+// server is started, so that the first calls routed to it once its health
+// check service reports it as serving do not pay for the connections and the
+// cache misses. A failed warm-up is logged, as the calls can still connect and
+// fill the caches themselves.
+void WarmUp(const ml_metadata::PoolWarmUpOptions& warm_up_options,
+            ml_metadata::MetadataStoreServiceImpl* service) {
+  const absl::Time start_time = absl::Now();
+  const tensorflow::Status status = service->WarmUp(warm_up_options);
+  if (!status.ok()) {
+    LOG(WARNING) << "The metadata store pool failed to warm up: " << status;
+    return;
+  }
+  LOG(INFO) << "Warmed up in " << absl::Now() - start_time;
+}
 }  // namespace
 
 // gRPC server options
@@ -143,17 +327,213 @@ DEFINE_int32(grpc_port, 8080, "Port to listen on for gRPC API. (default 8080)");
 DEFINE_string(grpc_channel_arguments, "",
               "A comma separated list of arguments to be passed to the grpc "
               "server. (e.g. grpc.max_connection_age_ms=2000)");
+DEFINE_int32(grpc_sync_server_min_pollers, 0,
+             "If positive, the min number of threads polling for the calls of "
+             "the synchronous server. (default: the gRPC default)");
+DEFINE_int32(grpc_sync_server_max_pollers, 0,
+             "If positive, the max number of threads polling for the calls of "
+             "the synchronous server, which bounds the number of calls it runs "
+             "at the same time. (default: the gRPC default)");
+DEFINE_int32(grpc_num_completion_queues, 0,
+             "If positive, the number of completion queues receiving the "
+             "calls. (default: the gRPC default for the synchronous server, 1 "
+             "for the asynchronous server)");
+DEFINE_int32(grpc_max_concurrent_streams, 0,
+             "If positive, the max number of concurrent calls on a single "
+             "client connection. (default: the gRPC default)");
+DEFINE_int64(grpc_resource_quota_bytes, 0,
+             "If positive, the max memory in bytes used by the server for its "
+             "calls. (default: unlimited)");
+DEFINE_int32(grpc_max_threads, 0,
+             "If positive, the max number of threads created by the server for "
+             "its calls. (default: unlimited)");
+DEFINE_bool(grpc_async_server, false,
+            "If true, serves with the asynchronous gRPC API, which queues the "
+            "received calls for a pool of --metadata_store_pool_max_size "
+            "threads instead of holding a gRPC thread per call in flight. "
+            "(default false)");
+DEFINE_string(grpc_response_compression, "",
+              "If non-empty, the algorithm compressing the responses of the "
+              "unary calls, one of gzip and deflate. (default: uncompressed)");
+DEFINE_int64(grpc_response_compression_min_bytes, 0,
+             "If positive, the responses smaller than this size in bytes are "
+             "sent uncompressed, if --grpc_response_compression. "
+             "(default 1024)");
 
 // metadata store server options
 DEFINE_string(metadata_store_server_config_file, "",
               "If non-empty, read an ascii MetadataStoreServerConfig protobuf "
               "from the file name to connect to the specified metadata source "
               "and set up a secure gRPC channel. If provided overrides the "
-              "--mysql* configuration");
+              "--mysql* configuration, and its grpc_server_options override "
+              "the --grpc* server options");
 DEFINE_int32(
     metadata_store_connection_retries, 5,
     "The max number of retries when connecting to the given metadata source");
 
+// metadata store connection pool options
+DEFINE_int32(metadata_store_pool_max_size, 16,
+             "The max number of connected metadata stores kept by the server "
+             "and reused across requests. (default 16)");
+DEFINE_int32(metadata_store_pool_max_idle_seconds, 300,
+             "An idle connection in the pool is closed after this number of "
+             "seconds. (default 300)");
+DEFINE_int32(metadata_store_pool_health_check_interval_seconds, 30,
+             "An idle connection in the pool is health checked before reuse, "
+             "if it has not been used for this number of seconds. (default "
+             "30)");
+DEFINE_int32(metadata_store_pool_acquire_timeout_seconds, 30,
+             "The max number of seconds a request waits for a connection when "
+             "all connections in the pool are in use. (default 30)");
+DEFINE_bool(metadata_store_pool_enable_type_cache, false,
+            "If true, the connections in the pool share the types read from "
+            "the metadata source through an in-process cache. It should only "
+            "be enabled if this server is the only one changing types in the "
+            "metadata source. (default false)");
+DEFINE_bool(metadata_store_pool_enable_node_cache, false,
+            "If true, the connections in the pool share the artifacts, "
+            "executions and contexts read from the metadata source through an "
+            "in-process LRU cache. It should only be enabled if this server "
+            "is the only one changing nodes in the metadata source. (default "
+            "false)");
+DEFINE_int64(metadata_store_pool_node_cache_max_bytes, 256 << 20,
+             "The max number of bytes of the nodes kept in the node cache. "
+             "(default 256MiB)");
+DEFINE_bool(metadata_store_pool_node_cache_retain_serialized_nodes, false,
+            "If true, the node cache also keeps the serialized nodes, which "
+            "the async server splices into the responses of GetArtifactsByID, "
+            "GetExecutionsByID and GetContextsByID. (default false)");
+DEFINE_int32(parallel_read_max_parallelism, 0,
+             "If positive, GetArtifactsByType splits a large type across up "
+             "to this many stores of the pool, which read it in parallel. 0 "
+             "disables the parallel reads. (default 0)");
+DEFINE_int64(parallel_read_min_nodes_per_part, 10000,
+             "The min number of artifacts read by each store of a parallel "
+             "GetArtifactsByType. (default 10000)");
+
+// warm-up options
+DEFINE_bool(warm_up_on_start, false,
+            "If true, all the connections of the pool are opened and the types "
+            "are read into the type cache, if enabled, at startup, before the "
+            "gRPC health service reports the server as serving. (default "
+            "false)");
+DEFINE_int32(warm_up_num_recent_contexts, 0,
+             "The number of the most recently updated contexts read into the "
+             "node cache, if enabled, at startup, if --warm_up_on_start. "
+             "(default 0)");
+
+// list operation options
+DEFINE_int32(max_bulk_list_result_size, 10000,
+             "The max number of nodes returned in a page by the list requests "
+             "in bulk mode. Values above 10000 are bounded to 10000. (default "
+             "10000)");
+DEFINE_int64(max_response_bytes, 0,
+             "If positive, the GetArtifactsByContext and "
+             "GetExecutionsByContext responses are cut once their nodes "
+             "exceed this many bytes, and "
+             "are continued with their next_page_token. Overrides the "
+             "max_response_bytes of the connection_config. (default 0)");
+DEFINE_bool(coalesce_puts, false,
+            "If true, merges concurrent PutExecution and PutEvents calls into "
+            "shared transactions, which pay a single commit. The merged calls "
+            "must not depend on each other. (default false)");
+DEFINE_int32(coalesce_puts_max_batch_size, 64,
+             "The max number of calls merged into one transaction, if "
+             "--coalesce_puts. (default 64)");
+DEFINE_int32(coalesce_puts_max_latency_micros, 2000,
+             "The max number of microseconds a call waits for other calls to "
+             "merge with, if --coalesce_puts. (default 2000)");
+
+// admission control options
+DEFINE_int32(admission_max_concurrent_reads, 0,
+             "If positive, the max number of concurrent read calls running "
+             "against the database; the other calls wait to be admitted. "
+             "(default 0, i.e., unlimited)");
+DEFINE_int32(admission_max_concurrent_writes, 0,
+             "Same as --admission_max_concurrent_reads for the write calls "
+             "smaller than --admission_bulk_write_min_records. (default 0)");
+DEFINE_int32(admission_max_concurrent_bulk_writes, 0,
+             "Same as --admission_max_concurrent_reads for the write calls of "
+             "at least --admission_bulk_write_min_records records, e.g., of "
+             "backfills. (default 0)");
+DEFINE_int64(admission_bulk_write_min_records, 100,
+             "The number of written records from which a call is a bulk "
+             "write. (default 100)");
+DEFINE_int32(admission_max_queued_calls, 0,
+             "If positive, the max number of calls of a class waiting to be "
+             "admitted, beyond which calls fail with RESOURCE_EXHAUSTED at "
+             "once. (default 0, i.e., unbounded)");
+DEFINE_int64(admission_target_latency_millis, 0,
+             "If positive, the concurrency limits adapt to keep the latency of "
+             "the calls under this number of milliseconds. (default 0)");
+
+// list cursor options
+DEFINE_int32(list_cursor_max_num_cursors, 0,
+             "If positive, the max number of open server-side cursors of the "
+             "lists asking for a snapshot_cursor, each holding a pooled "
+             "connection in a read-only transaction between its pages. "
+             "(default 0, i.e., the lists are paged without cursors)");
+DEFINE_int64(list_cursor_ttl_seconds, 60,
+             "The number of seconds after which a list cursor which is not "
+             "resumed is closed. (default 60)");
+
+// read session options
+DEFINE_int32(read_session_max_num_sessions, 0,
+             "If positive, the max number of open read sessions begun by "
+             "BeginReadSession, each holding a pooled connection in a "
+             "REPEATABLE READ read-only transaction between its calls. "
+             "(default 0, i.e., the read sessions are disabled)");
+DEFINE_int64(read_session_ttl_seconds, 30,
+             "The number of seconds after which a read session which is not "
+             "used is ended. (default 30)");
+
+// metrics options
+DEFINE_int32(metrics_port, 0,
+             "Port to serve the Prometheus metrics on over HTTP at /metrics, "
+             "e.g., the latencies of the calls and queries, the transaction "
+             "retries and the store pool occupancy. 0 disables the metrics "
+             "endpoint. (default 0)");
+
+// tracing options
+DEFINE_double(tracing_sampling_probability, 0,
+              "The probability that a call is traced, unless its trace context "
+              "is followed. The spans of the call, its connection, "
+              "transactions and queries are logged. (default 0)");
+DEFINE_bool(tracing_follow_remote_parent, false,
+            "If true, a call with a W3C trace context in its `traceparent` "
+            "metadata is traced if and only if the caller sampled it. "
+            "(default false)");
+
+// query accounting options
+DEFINE_int64(query_budget_max_queries, 0,
+             "The max number of queries of a call, above which the call is "
+             "logged with the templates it ran most often, e.g., to catch the "
+             "loops of small queries. 0 is unlimited. (default 0)");
+DEFINE_int64(query_budget_max_rows, 0,
+             "The max number of rows read by the queries of a call, above "
+             "which the call is logged. 0 is unlimited. (default 0)");
+DEFINE_int64(query_budget_max_bytes, 0,
+             "The max number of bytes read by the queries of a call, above "
+             "which the call is logged. 0 is unlimited. (default 0)");
+DEFINE_int64(query_budget_max_queries_per_template, 0,
+             "The max number of queries of a call from a single query "
+             "template, above which the call is logged. 0 is unlimited. "
+             "(default 0)");
+DEFINE_bool(return_query_stats, false,
+            "If true, the number of queries, rows and bytes of a call are "
+            "returned in its `mlmd-query-count`, `mlmd-query-rows` and "
+            "`mlmd-query-bytes` trailing metadata. (default false)");
+
+// slow query log options
+DEFINE_int64(slow_query_log_threshold_millis, 0,
+             "If positive, the queries which take at least as many "
+             "milliseconds are logged with their template, redacted "
+             "parameters, duration and number of rows. (default 0)");
+DEFINE_bool(slow_query_log_explain, false,
+            "If true, the plan of the first slow query of each template is "
+            "also logged, from an EXPLAIN run in the transaction of the query, "
+            "if --slow_query_log_threshold_millis. (default false)");
+
 // MySQL config command line options
 DEFINE_string(mysql_config_host, "",
               "The mysql hostname to use. If non-empty, works in conjunction "
@@ -188,6 +568,54 @@ int main(int argc, char** argv) {
     return -1;
   }
 
+  if ((FLAGS_metrics_port) < 0) {
+    LOG(ERROR) << "metrics_port is invalid: " << (FLAGS_metrics_port);
+    return -1;
+  }
+
+  if ((FLAGS_tracing_sampling_probability) < 0 ||
+      (FLAGS_tracing_sampling_probability) > 1) {
+    LOG(ERROR) << "tracing_sampling_probability is invalid: "
+               << (FLAGS_tracing_sampling_probability);
+    return -1;
+  }
+
+  if ((FLAGS_slow_query_log_threshold_millis) < 0) {
+    LOG(ERROR) << "slow_query_log_threshold_millis is invalid: "
+               << (FLAGS_slow_query_log_threshold_millis);
+    return -1;
+  }
+
+  if ((FLAGS_max_bulk_list_result_size) <= 0) {
+    LOG(ERROR) << "max_bulk_list_result_size is invalid: "
+               << (FLAGS_max_bulk_list_result_size);
+    return -1;
+  }
+  if ((FLAGS_max_response_bytes) < 0) {
+    LOG(ERROR) << "max_response_bytes is invalid: "
+               << (FLAGS_max_response_bytes);
+    return -1;
+  }
+  if ((FLAGS_metadata_store_pool_max_size) <= 0) {
+    LOG(ERROR) << "metadata_store_pool_max_size is invalid: "
+               << (FLAGS_metadata_store_pool_max_size);
+    return -1;
+  }
+  if ((FLAGS_parallel_read_max_parallelism) < 0 ||
+      (FLAGS_parallel_read_min_nodes_per_part) <= 0) {
+    LOG(ERROR) << "parallel_read_max_parallelism or "
+                  "parallel_read_min_nodes_per_part is invalid: "
+               << (FLAGS_parallel_read_max_parallelism) << ", "
+               << (FLAGS_parallel_read_min_nodes_per_part);
+    return -1;
+  }
+
+  if ((FLAGS_warm_up_num_recent_contexts) < 0) {
+    LOG(ERROR) << "warm_up_num_recent_contexts is invalid: "
+               << (FLAGS_warm_up_num_recent_contexts);
+    return -1;
+  }
+
   ml_metadata::MetadataStoreServerConfig server_config;
   ml_metadata::ConnectionConfig connection_config;
 
@@ -208,31 +636,197 @@ int main(int argc, char** argv) {
   } else {
     connection_config = server_config.connection_config();
   }
+  if ((FLAGS_max_response_bytes) > 0) {
+    connection_config.set_max_response_bytes((FLAGS_max_response_bytes));
+  }
 
-  // Creates a metadata_store in the main thread and init schema if necessary.
-  std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
-  tensorflow::Status status = ml_metadata::CreateMetadataStore(
-      connection_config, server_config.migration_options(), &metadata_store);
-  for (int i = 0; i < (FLAGS_metadata_store_connection_retries);
-       i++) {
-    if (status.ok() || !tensorflow::errors::IsAborted(status)) {
-      break;
-    }
-    LOG(WARNING) << "Connection Aborted with error: " << status;
-    LOG(INFO) << "Retry attempt " << i;
-    status = ml_metadata::CreateMetadataStore(
-        connection_config, server_config.migration_options(), &metadata_store);
+  // Creates a metadata_store in the main thread and init schema if necessary,
+  // for the server and each of its tenants.
+  InitMetadataStoreSchemaOrDie(connection_config,
+                               server_config.migration_options(),
+                               (FLAGS_metadata_store_connection_retries));
+  for (const auto& tenant : server_config.tenant_routing_config().tenants()) {
+    InitMetadataStoreSchemaOrDie(tenant.connection_config(),
+                                 server_config.migration_options(),
+                                 (FLAGS_metadata_store_connection_retries));
   }
-  TF_CHECK_OK(status)
-      << "MetadataStore cannot be created with the given connection config.";
   // At this point, schema initialization and migration are done.
-  metadata_store.reset();
 
+  ml_metadata::MetadataStorePoolOptions pool_options;
+  pool_options.max_size = (FLAGS_metadata_store_pool_max_size);
+  pool_options.max_idle_time =
+      absl::Seconds((FLAGS_metadata_store_pool_max_idle_seconds));
+  pool_options.health_check_interval =
+      absl::Seconds((FLAGS_metadata_store_pool_health_check_interval_seconds));
+  pool_options.acquire_timeout =
+      absl::Seconds((FLAGS_metadata_store_pool_acquire_timeout_seconds));
+  pool_options.enable_type_cache =
+      (FLAGS_metadata_store_pool_enable_type_cache);
+  pool_options.enable_node_cache =
+      (FLAGS_metadata_store_pool_enable_node_cache);
+  pool_options.node_cache_max_bytes =
+      (FLAGS_metadata_store_pool_node_cache_max_bytes);
+  pool_options.node_cache_retains_serialized_nodes =
+      (FLAGS_metadata_store_pool_node_cache_retain_serialized_nodes);
+  if ((FLAGS_parallel_read_max_parallelism) > 0) {
+    pool_options.parallel_read.emplace();
+    pool_options.parallel_read->max_parallelism =
+        (FLAGS_parallel_read_max_parallelism);
+    pool_options.parallel_read->min_nodes_per_part =
+        (FLAGS_parallel_read_min_nodes_per_part);
+  }
+  absl::optional<ml_metadata::PutCoalescerOptions> put_coalescer_options;
+  if (FLAGS_coalesce_puts) {
+    put_coalescer_options.emplace();
+    put_coalescer_options->max_batch_size =
+        (FLAGS_coalesce_puts_max_batch_size);
+    put_coalescer_options->max_latency =
+        absl::Microseconds((FLAGS_coalesce_puts_max_latency_micros));
+  }
+  absl::optional<ml_metadata::AdmissionControlOptions>
+      admission_control_options;
+  if (FLAGS_admission_max_concurrent_reads > 0 ||
+      FLAGS_admission_max_concurrent_writes > 0 ||
+      FLAGS_admission_max_concurrent_bulk_writes > 0) {
+    admission_control_options.emplace();
+    admission_control_options->max_concurrent_reads =
+        (FLAGS_admission_max_concurrent_reads);
+    admission_control_options->max_concurrent_writes =
+        (FLAGS_admission_max_concurrent_writes);
+    admission_control_options->max_concurrent_bulk_writes =
+        (FLAGS_admission_max_concurrent_bulk_writes);
+    admission_control_options->bulk_write_min_records =
+        (FLAGS_admission_bulk_write_min_records);
+    admission_control_options->max_queued_calls =
+        (FLAGS_admission_max_queued_calls);
+    admission_control_options->target_latency =
+        absl::Milliseconds((FLAGS_admission_target_latency_millis));
+  }
+  absl::optional<ml_metadata::PinnedReadOptions> list_cursor_options;
+  if (FLAGS_list_cursor_max_num_cursors > 0) {
+    list_cursor_options.emplace();
+    list_cursor_options->max_num_pinned_reads =
+        (FLAGS_list_cursor_max_num_cursors);
+    list_cursor_options->ttl = absl::Seconds((FLAGS_list_cursor_ttl_seconds));
+  }
+  absl::optional<ml_metadata::PinnedReadOptions> read_session_options;
+  if (FLAGS_read_session_max_num_sessions > 0) {
+    read_session_options.emplace();
+    read_session_options->max_num_pinned_reads =
+        (FLAGS_read_session_max_num_sessions);
+    read_session_options->ttl =
+        absl::Seconds((FLAGS_read_session_ttl_seconds));
+  }
+  ml_metadata::QueryAccountingOptions query_accounting_options;
+  query_accounting_options.budget.max_num_queries =
+      (FLAGS_query_budget_max_queries);
+  query_accounting_options.budget.max_num_rows = (FLAGS_query_budget_max_rows);
+  query_accounting_options.budget.max_num_bytes =
+      (FLAGS_query_budget_max_bytes);
+  query_accounting_options.budget.max_num_queries_per_template =
+      (FLAGS_query_budget_max_queries_per_template);
+  query_accounting_options.return_in_trailing_metadata =
+      (FLAGS_return_query_stats);
+  const ml_metadata::MetadataStoreServerConfig::GrpcServerOptions
+      grpc_server_options = GetGrpcServerOptions(
+          (FLAGS_grpc_sync_server_min_pollers),
+          (FLAGS_grpc_sync_server_max_pollers),
+          (FLAGS_grpc_num_completion_queues),
+          (FLAGS_grpc_max_concurrent_streams),
+          (FLAGS_grpc_resource_quota_bytes), (FLAGS_grpc_max_threads),
+          (FLAGS_grpc_response_compression),
+          (FLAGS_grpc_response_compression_min_bytes), server_config);
+  CheckGrpcServerOptionsOrDie(grpc_server_options);
   ml_metadata::MetadataStoreServiceImpl metadata_store_service(
-      connection_config);
+      connection_config, pool_options, (FLAGS_max_bulk_list_result_size),
+      put_coalescer_options, query_accounting_options,
+      GetResponseCompressionOptions(grpc_server_options),
+      admission_control_options,
+      server_config.has_client_rate_limit_config()
+          ? absl::make_optional(server_config.client_rate_limit_config())
+          : absl::nullopt,
+      server_config.has_tenant_routing_config()
+          ? absl::make_optional(server_config.tenant_routing_config())
+          : absl::nullopt,
+      list_cursor_options, read_session_options);
+  if (FLAGS_warm_up_on_start) {
+    ml_metadata::PoolWarmUpOptions warm_up_options;
+    warm_up_options.num_stores = pool_options.max_size;
+    warm_up_options.preload_types = pool_options.enable_type_cache;
+    warm_up_options.num_recent_contexts =
+        pool_options.enable_node_cache ? (FLAGS_warm_up_num_recent_contexts)
+                                       : 0;
+    WarmUp(warm_up_options, &metadata_store_service);
+  }
+
+  // The garbage collection has a store of its own, so that it does not take
+  // one from the calls while it runs. It also deletes the expired idempotency
+  // keys, if any. Each tenant is collected separately.
+  std::vector<std::unique_ptr<ml_metadata::MetadataStorePool>>
+      garbage_collection_pools;
+  std::vector<std::unique_ptr<ml_metadata::GarbageCollector>>
+      garbage_collectors;
+  const auto start_garbage_collection =
+      [&](const ml_metadata::ConnectionConfig& config,
+          const std::string& pool_name) {
+        if (!server_config.has_garbage_collection_config() &&
+            !config.has_idempotency()) {
+          return;
+        }
+        ml_metadata::MetadataStorePoolOptions garbage_collection_pool_options =
+            pool_options;
+        garbage_collection_pool_options.max_size = 1;
+        garbage_collection_pool_options.name = pool_name;
+        garbage_collection_pools.push_back(
+            absl::make_unique<ml_metadata::MetadataStorePool>(
+                config, garbage_collection_pool_options));
+        garbage_collectors.push_back(
+            absl::make_unique<ml_metadata::GarbageCollector>(
+                garbage_collection_pools.back().get(),
+                server_config.garbage_collection_config()));
+        garbage_collectors.back()->Start();
+      };
+  start_garbage_collection(connection_config, "garbage_collection");
+  for (const auto& tenant : server_config.tenant_routing_config().tenants()) {
+    start_garbage_collection(
+        tenant.connection_config(),
+        absl::StrCat("garbage_collection_", tenant.tenant_id()));
+  }
+
+  if (FLAGS_tracing_sampling_probability > 0 ||
+      FLAGS_tracing_follow_remote_parent) {
+    ml_metadata::TracingOptions tracing_options;
+    tracing_options.sampling_probability =
+        (FLAGS_tracing_sampling_probability);
+    tracing_options.follow_remote_parent =
+        (FLAGS_tracing_follow_remote_parent);
+    ml_metadata::EnableTracing(
+        tracing_options, absl::make_unique<ml_metadata::LoggingSpanExporter>());
+  }
+
+  if (FLAGS_slow_query_log_threshold_millis > 0) {
+    ml_metadata::SlowQueryLogOptions slow_query_log_options;
+    slow_query_log_options.threshold =
+        absl::Milliseconds((FLAGS_slow_query_log_threshold_millis));
+    slow_query_log_options.explain_first_occurrence =
+        (FLAGS_slow_query_log_explain);
+    ml_metadata::SlowQueryLog::Enable(slow_query_log_options);
+  }
+
+  std::unique_ptr<ml_metadata::MetricsHttpServer> metrics_server;
+  if (FLAGS_metrics_port > 0) {
+    metrics_server = absl::make_unique<ml_metadata::MetricsHttpServer>(
+        ml_metadata::MetricsRegistry::Global());
+    TF_CHECK_OK(metrics_server->Start((FLAGS_metrics_port)));
+    LOG(INFO) << "Metrics served on port " << metrics_server->port()
+              << " at /metrics";
+  }
 
   const string server_address =
       absl::StrCat("0.0.0.0:", (FLAGS_grpc_port));
+  // The server reports that it is serving through the standard
+  // grpc.health.v1.Health service once it is started, i.e., after the warm-up.
+  ::grpc::EnableDefaultHealthCheckService(true);
   ::grpc::ServerBuilder builder;
 
   std::shared_ptr<::grpc::ServerCredentials> credentials =
@@ -243,6 +837,23 @@ int main(int argc, char** argv) {
 
   builder.AddListeningPort(server_address, credentials);
   AddGrpcChannelArgs((FLAGS_grpc_channel_arguments), &builder);
+  ConfigureGrpcServer(grpc_server_options, &builder);
+  if (FLAGS_grpc_async_server) {
+    // The executor is sized to the store pool, so that a running call does
+    // not wait for a connection.
+    ml_metadata::MetadataStoreAsyncServerOptions async_server_options;
+    async_server_options.num_executor_threads = pool_options.max_size;
+    if (grpc_server_options.has_num_completion_queues()) {
+      async_server_options.num_completion_queues =
+          grpc_server_options.num_completion_queues();
+    }
+    ml_metadata::MetadataStoreAsyncServer async_server(&metadata_store_service,
+                                                       async_server_options);
+    TF_CHECK_OK(async_server.Start(&builder));
+    LOG(INFO) << "Async server listening on " << server_address;
+    async_server.Wait();
+    return 0;
+  }
   builder.RegisterService(&metadata_store_service);
   std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
   LOG(INFO) << "Server listening on " << server_address;
@@ -14,14 +14,41 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "grpcpp/security/auth_context.h"
+#include "grpcpp/support/slice.h"
 #include "grpcpp/support/status_code_enum.h"
+#include "ml_metadata/metadata_store/list_operation_query_helper.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
-#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/query_accounting.h"
+#include "ml_metadata/util/metrics.h"
+#include "ml_metadata/util/tracing.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace ml_metadata {
 namespace {
 
+// The metadata key of the W3C trace context of a call.
+constexpr char kTraceParentMetadataKey[] = "traceparent";
+
+// The trailing metadata keys of the query stats of a call.
+constexpr char kQueryCountMetadataKey[] = "mlmd-query-count";
+constexpr char kQueryRowsMetadataKey[] = "mlmd-query-rows";
+constexpr char kQueryBytesMetadataKey[] = "mlmd-query-bytes";
+
 // Converts from tensorflow Status to GRPC Status.
 ::grpc::Status ToGRPCStatus(const ::tensorflow::Status& status) {
   // Note: the tensorflow and grpc status codes align with each other.
@@ -29,25 +56,667 @@ namespace {
                         status.error_message());
 }
 
-// Creates a store on demand. The store created does not handle migration.
+// Returns the latency histogram of the calls of the RPC `method`.
+Histogram* RpcLatency(const absl::string_view method) {
+  return MetricsRegistry::Global()->GetHistogram(
+      "mlmd_rpc_latency_seconds",
+      "The latency of the calls of a MetadataStoreService method.",
+      {{"method", std::string(method)}});
+}
+
+// Returns the trace context sent by the client in the `traceparent` metadata,
+// which is not valid if there is none.
+SpanContext RemoteSpanContext(const ::grpc::ServerContext* context) {
+  SpanContext span_context;
+  const auto& client_metadata = context->client_metadata();
+  const auto it = client_metadata.find(kTraceParentMetadataKey);
+  if (it != client_metadata.end()) {
+    ParseTraceParent(absl::string_view(it->second.data(), it->second.size()),
+                     &span_context);
+  }
+  return span_context;
+}
+
+// Records a call of the RPC `method` in its latency histogram and in a tracing
+// span. The remote parent of the span is the trace context sent by the client,
+// if the call `context` is given. If `query_accounting_options` are enabled,
+// the queries of the call are also accounted, logged if they exceed the
+// budget, and returned in the trailing metadata of the `context`, if any.
+// The `response` of a unary call is compressed as configured by
+// `response_compression_options`, once the call fills it.
+class ScopedRpcRecorder {
+ public:
+  ScopedRpcRecorder(
+      ::grpc::ServerContext* context, const absl::string_view method,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const google::protobuf::Message* response)
+      : context_(context),
+        method_(method),
+        query_accounting_options_(query_accounting_options),
+        response_compression_options_(response_compression_options),
+        response_(response),
+        latency_recorder_(RpcLatency(method)),
+        span_(absl::StrCat("MetadataStoreService/", method),
+              context != nullptr ? RemoteSpanContext(context) : SpanContext()) {
+    if (query_accounting_options_.enabled()) {
+      query_accounting_.emplace(&query_stats_);
+    }
+  }
+
+  // Same as above, but for a unary call sending the wire form of its
+  // `response`.
+  ScopedRpcRecorder(
+      ::grpc::ServerContext* context, const absl::string_view method,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const ::grpc::ByteBuffer* response)
+      : ScopedRpcRecorder(context, method, query_accounting_options,
+                          response_compression_options,
+                          static_cast<const google::protobuf::Message*>(
+                              nullptr)) {
+    response_buffer_ = response;
+  }
+
+  ~ScopedRpcRecorder() {
+    const int64 response_bytes =
+        response_ != nullptr
+            ? response_->ByteSizeLong()
+            : response_buffer_ != nullptr ? response_buffer_->Length() : -1;
+    if (context_ != nullptr && response_bytes >= 0 &&
+        response_compression_options_.algorithm != GRPC_COMPRESS_NONE &&
+        response_bytes >= response_compression_options_.min_response_bytes) {
+      context_->set_compression_algorithm(
+          response_compression_options_.algorithm);
+    }
+    if (!query_accounting_) return;
+    const std::string exceeded_budget =
+        CheckQueryBudget(query_stats_, query_accounting_options_.budget);
+    if (!exceeded_budget.empty()) {
+      LOG(WARNING) << method_ << " exceeded the query budget: "
+                   << exceeded_budget;
+    }
+    if (context_ != nullptr &&
+        query_accounting_options_.return_in_trailing_metadata) {
+      context_->AddTrailingMetadata(kQueryCountMetadataKey,
+                                    absl::StrCat(query_stats_.num_queries));
+      context_->AddTrailingMetadata(kQueryRowsMetadataKey,
+                                    absl::StrCat(query_stats_.num_rows));
+      context_->AddTrailingMetadata(kQueryBytesMetadataKey,
+                                    absl::StrCat(query_stats_.num_bytes));
+    }
+  }
+
+ private:
+  ::grpc::ServerContext* const context_;
+  const absl::string_view method_;
+  const QueryAccountingOptions& query_accounting_options_;
+  const ResponseCompressionOptions& response_compression_options_;
+  const google::protobuf::Message* const response_;
+  const ::grpc::ByteBuffer* response_buffer_ = nullptr;
+  const ScopedLatencyRecorder latency_recorder_;
+  const ScopedSpan span_;
+  QueryStats query_stats_;
+  absl::optional<ScopedQueryAccounting> query_accounting_;
+};
+
+// Parses the `request` of a raw call from its wire form.
+// Returns INVALID_ARGUMENT error, if `buffer` is not a serialized request.
+::grpc::Status ParseRequest(const ::grpc::ByteBuffer& buffer,
+                            google::protobuf::Message* request) {
+  std::vector<::grpc::Slice> slices;
+  const ::grpc::Status dump_status = buffer.Dump(&slices);
+  if (!dump_status.ok()) return dump_status;
+  std::string serialized_request;
+  serialized_request.reserve(buffer.Length());
+  for (const ::grpc::Slice& slice : slices) {
+    serialized_request.append(reinterpret_cast<const char*>(slice.begin()),
+                              slice.size());
+  }
+  if (!request->ParseFromString(serialized_request)) {
+    return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT,
+                          "Cannot parse the request.");
+  }
+  return ::grpc::Status::OK;
+}
+
+// Returns a buffer sending the `serialized_response` of a raw call, which
+// takes over the string instead of copying it.
+::grpc::ByteBuffer ToByteBuffer(std::string serialized_response) {
+  auto* const owned_response = new std::string(std::move(serialized_response));
+  ::grpc::Slice slice(
+      &(*owned_response)[0], owned_response->size(),
+      [](void* response) { delete static_cast<std::string*>(response); },
+      owned_response);
+  return ::grpc::ByteBuffer(&slice, 1);
+}
+
+// Borrows a connected store from the pool. The store is returned to the pool
+// when `metadata_store` goes out of scope.
 ::grpc::Status ConnectMetadataStore(
-    const ConnectionConfig& connection_config,
-    std::unique_ptr<MetadataStore>* metadata_store) {
-  return ToGRPCStatus(CreateMetadataStore(connection_config, metadata_store));
+    MetadataStorePool* metadata_store_pool,
+    MetadataStorePool::ScopedMetadataStore* metadata_store) {
+  const ScopedSpan span("Connect");
+  return ToGRPCStatus(metadata_store_pool->Acquire(metadata_store));
+}
+
+// Same as above, but the aborted transactions of the store are only retried
+// until the deadline of the call `context`.
+::grpc::Status ConnectMetadataStore(
+    MetadataStorePool* metadata_store_pool,
+    const ::grpc::ServerContext* context,
+    MetadataStorePool::ScopedMetadataStore* metadata_store) {
+  const ::grpc::Status status =
+      ConnectMetadataStore(metadata_store_pool, metadata_store);
+  if (status.ok()) {
+    (*metadata_store)->SetTransactionDeadline(
+        absl::FromChrono(context->deadline()));
+  }
+  return status;
+}
+
+// The gRPC metadata key of the token of the read session of a call.
+constexpr char kReadSessionMetadataKey[] = "mlmd-read-session";
+
+// Returns the token of the read session of the call `context`, or an empty
+// string if it is not in a session, or if `context` is nullptr.
+std::string ReadSessionToken(const ::grpc::ServerContext* context) {
+  if (context == nullptr) return "";
+  const auto& client_metadata = context->client_metadata();
+  const auto it = client_metadata.find(kReadSessionMetadataKey);
+  if (it == client_metadata.end()) return "";
+  return std::string(it->second.data(), it->second.size());
+}
+
+// Returns the id of the client of a call, which is the value of the
+// `metadata_key` sent by the client, if any, or else its authenticated peer
+// identity, or else its peer address without the port.
+std::string ClientId(const ::grpc::ServerContext& context,
+                     const std::string& metadata_key) {
+  if (!metadata_key.empty()) {
+    const auto& client_metadata = context.client_metadata();
+    const auto it = client_metadata.find(metadata_key);
+    if (it != client_metadata.end()) {
+      return std::string(it->second.data(), it->second.size());
+    }
+  }
+  const std::shared_ptr<const ::grpc::AuthContext> auth_context =
+      context.auth_context();
+  if (auth_context != nullptr) {
+    const std::vector<::grpc::string_ref> peer_identity =
+        auth_context->GetPeerIdentity();
+    if (!peer_identity.empty()) {
+      return std::string(peer_identity.front().data(),
+                         peer_identity.front().size());
+    }
+  }
+  // The peer is, e.g., "ipv4:10.0.0.1:53412", whose port differs per
+  // connection of the client.
+  const std::string peer = context.peer();
+  return peer.substr(0, peer.rfind(':'));
+}
+
+// Returns the number of records written by a call of `request`, or -1 if the
+// call is a read, which classifies the call for the admission control.
+template <typename Request>
+int64 NumWrittenRecords(const Request& request) {
+  return -1;
+}
+
+int64 NumWrittenRecords(const PutArtifactTypeRequest& request) { return 1; }
+
+int64 NumWrittenRecords(const PutExecutionTypeRequest& request) { return 1; }
+
+int64 NumWrittenRecords(const PutContextTypeRequest& request) { return 1; }
+
+int64 NumWrittenRecords(const PutArtifactsRequest& request) {
+  return request.artifacts_size();
+}
+
+int64 NumWrittenRecords(const PutExecutionsRequest& request) {
+  return request.executions_size();
+}
+
+int64 NumWrittenRecords(const PutContextsRequest& request) {
+  return request.contexts_size();
+}
+
+int64 NumWrittenRecords(const PutEventsRequest& request) {
+  return request.events_size();
+}
+
+int64 NumWrittenRecords(const PutExecutionRequest& request) {
+  return 1 + request.artifact_event_pairs_size() + request.contexts_size();
+}
+
+int64 NumWrittenRecords(const PutAttributionsAndAssociationsRequest& request) {
+  return request.attributions_size() + request.associations_size();
+}
+
+int64 NumWrittenRecords(const PutParentContextsRequest& request) {
+  return request.parent_contexts_size();
+}
+
+int64 NumWrittenRecords(const DeleteArtifactsRequest& request) {
+  return request.artifact_ids_size();
+}
+
+int64 NumWrittenRecords(const DeleteExecutionsRequest& request) {
+  return request.execution_ids_size();
+}
+
+// The garbage collection deletes an unknown number of nodes.
+int64 NumWrittenRecords(const CollectGarbageRequest& request) {
+  return std::numeric_limits<int64>::max();
+}
+
+// Returns a copy of a list `request`, whose max_result_size is bounded by
+// `max_bulk_list_result_size` if the request lists in bulk mode.
+template <typename Request>
+Request CapBulkListResultSize(const Request& request,
+                              const int max_bulk_list_result_size) {
+  Request capped_request = request;
+  if (request.options().bulk_mode() &&
+      request.options().max_result_size() > max_bulk_list_result_size) {
+    capped_request.mutable_options()->set_max_result_size(
+        max_bulk_list_result_size);
+  }
+  return capped_request;
+}
+
+// Writes the responses of the streaming `method` of a store borrowed from
+// `metadata_store_pool` with `write`, which returns false once the client
+// closed the stream. `write` blocks until the flow control of the client
+// admits the message, so the nodes are read at the pace at which the client
+// consumes them.
+template <typename Request, typename Response>
+::grpc::Status StreamResponses(
+    MetadataStorePool* metadata_store_pool, const Request& request,
+    const std::function<bool(const Response&)>& write,
+    tensorflow::Status (MetadataStore::*method)(
+        const Request&,
+        const std::function<tensorflow::Status(const Response&)>&),
+    absl::string_view method_name) {
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status =
+      ConnectMetadataStore(metadata_store_pool, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus((metadata_store.get()->*method)(
+          request,
+          [&write](const Response& response) -> tensorflow::Status {
+            if (!write(response)) {
+              return tensorflow::errors::Cancelled(
+                  "The client closed the stream.");
+            }
+            return tensorflow::Status::OK();
+          }));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << method_name
+                 << " failed: " << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+// Returns a write function of StreamResponses, which writes to the `writer`
+// of a synchronous streaming call.
+template <typename Response>
+std::function<bool(const Response&)> WriteTo(
+    ::grpc::ServerContext* context, ::grpc::ServerWriter<Response>* writer) {
+  return [context, writer](const Response& response) {
+    return !context->IsCancelled() && writer->Write(response);
+  };
 }
 
 }  // namespace
 
 MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     const ConnectionConfig& connection_config)
-    : connection_config_(connection_config) {}
+    : MetadataStoreServiceImpl(connection_config, MetadataStorePoolOptions()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options)
+    : MetadataStoreServiceImpl(connection_config, pool_options,
+                               GetMaxBulkListOperationResultSize()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size)
+    : MetadataStoreServiceImpl(connection_config, pool_options,
+                               max_bulk_list_result_size, absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options)
+    : MetadataStoreServiceImpl(connection_config, pool_options,
+                               max_bulk_list_result_size, put_coalescer_options,
+                               QueryAccountingOptions()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options)
+    : MetadataStoreServiceImpl(connection_config, pool_options,
+                               max_bulk_list_result_size, put_coalescer_options,
+                               query_accounting_options,
+                               ResponseCompressionOptions()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options)
+    : MetadataStoreServiceImpl(connection_config, pool_options,
+                               max_bulk_list_result_size, put_coalescer_options,
+                               query_accounting_options,
+                               response_compression_options, absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options,
+    const absl::optional<AdmissionControlOptions>& admission_control_options)
+    : MetadataStoreServiceImpl(
+          connection_config, pool_options, max_bulk_list_result_size,
+          put_coalescer_options, query_accounting_options,
+          response_compression_options, admission_control_options,
+          absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options,
+    const absl::optional<AdmissionControlOptions>& admission_control_options,
+    const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+        client_rate_limit_config)
+    : MetadataStoreServiceImpl(
+          connection_config, pool_options, max_bulk_list_result_size,
+          put_coalescer_options, query_accounting_options,
+          response_compression_options, admission_control_options,
+          client_rate_limit_config, absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options,
+    const absl::optional<AdmissionControlOptions>& admission_control_options,
+    const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+        client_rate_limit_config,
+    const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+        tenant_routing_config)
+    : MetadataStoreServiceImpl(
+          connection_config, pool_options, max_bulk_list_result_size,
+          put_coalescer_options, query_accounting_options,
+          response_compression_options, admission_control_options,
+          client_rate_limit_config, tenant_routing_config, absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options,
+    const absl::optional<AdmissionControlOptions>& admission_control_options,
+    const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+        client_rate_limit_config,
+    const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+        tenant_routing_config,
+    const absl::optional<PinnedReadOptions>& list_cursor_options)
+    : MetadataStoreServiceImpl(
+          connection_config, pool_options, max_bulk_list_result_size,
+          put_coalescer_options, query_accounting_options,
+          response_compression_options, admission_control_options,
+          client_rate_limit_config, tenant_routing_config, list_cursor_options,
+          absl::nullopt) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const int max_bulk_list_result_size,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+    const QueryAccountingOptions& query_accounting_options,
+    const ResponseCompressionOptions& response_compression_options,
+    const absl::optional<AdmissionControlOptions>& admission_control_options,
+    const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+        client_rate_limit_config,
+    const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+        tenant_routing_config,
+    const absl::optional<PinnedReadOptions>& list_cursor_options,
+    const absl::optional<PinnedReadOptions>& read_session_options)
+    : default_tenant_(connection_config, pool_options, put_coalescer_options),
+      max_bulk_list_result_size_(max_bulk_list_result_size),
+      query_accounting_options_(query_accounting_options),
+      response_compression_options_(response_compression_options) {
+  CHECK_GT(max_bulk_list_result_size_, 0)
+      << "The max_bulk_list_result_size must be positive.";
+  if (tenant_routing_config) {
+    CHECK(!tenant_routing_config->tenant_id_metadata_key().empty())
+        << "The tenant_id_metadata_key must be given.";
+    tenant_id_metadata_key_ = tenant_routing_config->tenant_id_metadata_key();
+    for (const MetadataStoreServerConfig::TenantRoutingConfig::Tenant& tenant :
+         tenant_routing_config->tenants()) {
+      CHECK(!tenant.tenant_id().empty())
+          << "The tenants must have a tenant_id.";
+      // The metrics of the pool of each tenant are labeled by its id.
+      MetadataStorePoolOptions tenant_pool_options = pool_options;
+      tenant_pool_options.name = tenant.tenant_id();
+      if (tenant.pool_max_size() > 0) {
+        tenant_pool_options.max_size = tenant.pool_max_size();
+      }
+      const bool inserted =
+          tenants_
+              .emplace(tenant.tenant_id(),
+                       absl::make_unique<Tenant>(tenant.connection_config(),
+                                                 tenant_pool_options,
+                                                 put_coalescer_options))
+              .second;
+      CHECK(inserted) << "The tenant " << tenant.tenant_id()
+                      << " is given more than once.";
+    }
+  }
+  if (admission_control_options) {
+    admission_controller_ =
+        absl::make_unique<AdmissionController>(*admission_control_options);
+  }
+  if (client_rate_limit_config) {
+    client_rate_limiter_ =
+        absl::make_unique<ClientRateLimiter>(*client_rate_limit_config);
+  }
+  if (list_cursor_options) {
+    list_cursor_registry_ =
+        absl::make_unique<PinnedReadRegistry>(*list_cursor_options);
+  }
+  if (read_session_options) {
+    read_session_registry_ =
+        absl::make_unique<PinnedReadRegistry>(*read_session_options);
+  }
+}
+
+MetadataStoreServiceImpl::Tenant::Tenant(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePoolOptions& pool_options,
+    const absl::optional<PutCoalescerOptions>& put_coalescer_options)
+    : pool(connection_config, pool_options) {
+  if (put_coalescer_options) {
+    put_coalescer =
+        absl::make_unique<PutCoalescer>(&pool, *put_coalescer_options);
+  }
+}
+
+tensorflow::Status MetadataStoreServiceImpl::WarmUp(
+    const PoolWarmUpOptions& options) {
+  TF_RETURN_IF_ERROR(default_tenant_.pool.WarmUp(options));
+  for (const auto& tenant : tenants_) {
+    TF_RETURN_IF_ERROR(tenant.second->pool.WarmUp(options));
+  }
+  return tensorflow::Status::OK();
+}
+
+::grpc::Status MetadataStoreServiceImpl::FindTenant(
+    const ::grpc::ServerContext* context, Tenant** tenant) {
+  *tenant = &default_tenant_;
+  if (context == nullptr || tenant_id_metadata_key_.empty()) {
+    return ::grpc::Status::OK;
+  }
+  const auto& client_metadata = context->client_metadata();
+  const auto it = client_metadata.find(tenant_id_metadata_key_);
+  if (it == client_metadata.end()) return ::grpc::Status::OK;
+  const std::string tenant_id(it->second.data(), it->second.size());
+  const auto tenant_it = tenants_.find(tenant_id);
+  if (tenant_it == tenants_.end()) {
+    return ToGRPCStatus(tensorflow::errors::NotFound(
+        "The tenant ", tenant_id, " is not served by the server."));
+  }
+  *tenant = tenant_it->second.get();
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status MetadataStoreServiceImpl::Connect(
+    const ::grpc::ServerContext* context,
+    MetadataStorePool::ScopedMetadataStore* metadata_store) {
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  const std::string session_token = ReadSessionToken(context);
+  if (read_session_registry_ == nullptr || session_token.empty()) {
+    return ConnectMetadataStore(&tenant->pool, context, metadata_store);
+  }
+  const ::grpc::Status session_status = ToGRPCStatus(
+      read_session_registry_->Take(session_token, &tenant->pool,
+                                   metadata_store));
+  if (!session_status.ok()) return session_status;
+  (*metadata_store)
+      ->SetTransactionDeadline(absl::FromChrono(context->deadline()));
+  const MetadataStorePool* pool = &tenant->pool;
+  PinnedReadRegistry* registry = read_session_registry_.get();
+  metadata_store->SetRelease(
+      [registry, session_token,
+       pool](MetadataStorePool::ScopedMetadataStore released) {
+        registry->Return(session_token, pool, std::move(released));
+      });
+  return ::grpc::Status::OK;
+}
+
+template <typename Request>
+::grpc::Status MetadataStoreServiceImpl::ConnectListCursor(
+    const ::grpc::ServerContext* context, Request* request,
+    MetadataStorePool::ScopedMetadataStore* metadata_store,
+    ListCursor* cursor) {
+  // The pages listed in a read session already read its snapshot.
+  if (list_cursor_registry_ == nullptr ||
+      !request->options().snapshot_cursor() ||
+      !ReadSessionToken(context).empty()) {
+    return Connect(context, metadata_store);
+  }
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  ListOperationOptions* options = request->mutable_options();
+  if (!options->next_page_token().empty()) {
+    ListOperationNextPageToken token;
+    // An invalid token is left to the store to reject.
+    if (!DecodeListOperationNextPageToken(options->next_page_token(), token)
+             .ok() ||
+        !token.has_cursor_id()) {
+      return ConnectMetadataStore(&tenant->pool, context, metadata_store);
+    }
+    const std::string cursor_id = token.cursor_id();
+    token.clear_cursor_id();
+    options->set_next_page_token(EncodeListOperationNextPageToken(token));
+    if (!list_cursor_registry_->Take(cursor_id, &tenant->pool, metadata_store)
+             .ok()) {
+      // The cursor has expired, so the list goes on without its snapshot.
+      return ConnectMetadataStore(&tenant->pool, context, metadata_store);
+    }
+    (*metadata_store)
+        ->SetTransactionDeadline(absl::FromChrono(context->deadline()));
+    cursor->id = cursor_id;
+    cursor->pool = &tenant->pool;
+    return ::grpc::Status::OK;
+  }
+  const ::grpc::Status connection_status =
+      ConnectMetadataStore(&tenant->pool, context, metadata_store);
+  if (!connection_status.ok()) return connection_status;
+  if (list_cursor_registry_->Open(metadata_store, &cursor->id).ok()) {
+    cursor->pool = &tenant->pool;
+  } else {
+    cursor->id.clear();
+  }
+  return ::grpc::Status::OK;
+}
+
+void MetadataStoreServiceImpl::ReleaseListCursor(
+    const ::grpc::Status& list_status, const ListCursor& cursor,
+    MetadataStorePool::ScopedMetadataStore metadata_store,
+    std::string* next_page_token) {
+  if (cursor.id.empty()) return;
+  ListOperationNextPageToken token;
+  if (!list_status.ok() || next_page_token->empty() ||
+      !DecodeListOperationNextPageToken(*next_page_token, token).ok()) {
+    list_cursor_registry_->Close(std::move(metadata_store));
+    return;
+  }
+  token.set_cursor_id(cursor.id);
+  *next_page_token = EncodeListOperationNextPageToken(token);
+  list_cursor_registry_->Return(cursor.id, cursor.pool,
+                                std::move(metadata_store));
+}
+
+::grpc::Status MetadataStoreServiceImpl::Admit(
+    const ::grpc::ServerContext* context, const int64 num_written_records,
+    Admission* admission) {
+  if (client_rate_limiter_ == nullptr && admission_controller_ == nullptr) {
+    return ::grpc::Status::OK;
+  }
+  const ScopedSpan span("Admit");
+  const absl::Time deadline = absl::FromChrono(context->deadline());
+  if (client_rate_limiter_ != nullptr) {
+    const ::grpc::Status status = ToGRPCStatus(client_rate_limiter_->Admit(
+        ClientId(*context, client_rate_limiter_->client_id_metadata_key()),
+        deadline, &admission->client_permit));
+    if (!status.ok()) return status;
+  }
+  if (admission_controller_ == nullptr) return ::grpc::Status::OK;
+  return ToGRPCStatus(admission_controller_->Admit(
+      admission_controller_->Classify(num_written_records >= 0,
+                                      num_written_records),
+      deadline, &admission->permit));
+}
 
 ::grpc::Status MetadataStoreServiceImpl::PutArtifactType(
     ::grpc::ServerContext* context, const PutArtifactTypeRequest* request,
     PutArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutArtifactType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -65,9 +734,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactType(
     ::grpc::ServerContext* context, const GetArtifactTypeRequest* request,
     GetArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -85,9 +760,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypesByID(
     ::grpc::ServerContext* context, const GetArtifactTypesByIDRequest* request,
     GetArtifactTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactTypesByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -105,9 +786,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypes(
     ::grpc::ServerContext* context, const GetArtifactTypesRequest* request,
     GetArtifactTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactTypes", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -125,9 +812,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecutionType(
     ::grpc::ServerContext* context, const PutExecutionTypeRequest* request,
     PutExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutExecutionType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -145,9 +838,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionType(
     ::grpc::ServerContext* context, const GetExecutionTypeRequest* request,
     GetExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -165,9 +864,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypesByID(
     ::grpc::ServerContext* context, const GetExecutionTypesByIDRequest* request,
     GetExecutionTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionTypesByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -185,9 +890,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypes(
     ::grpc::ServerContext* context, const GetExecutionTypesRequest* request,
     GetExecutionTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionTypes", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -205,9 +916,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutContextType(
     ::grpc::ServerContext* context, const PutContextTypeRequest* request,
     PutContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutContextType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -225,9 +942,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextType(
     ::grpc::ServerContext* context, const GetContextTypeRequest* request,
     GetContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -245,9 +968,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypesByID(
     ::grpc::ServerContext* context, const GetContextTypesByIDRequest* request,
     GetContextTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextTypesByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -265,9 +994,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypes(
     ::grpc::ServerContext* context, const GetContextTypesRequest* request,
     GetContextTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextTypes", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -285,9 +1020,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutArtifacts(
     ::grpc::ServerContext* context, const PutArtifactsRequest* request,
     PutArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutArtifacts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -305,9 +1046,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecutions(
     ::grpc::ServerContext* context, const PutExecutionsRequest* request,
     PutExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutExecutions", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -325,9 +1072,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByID(
     ::grpc::ServerContext* context, const GetArtifactsByIDRequest* request,
     GetArtifactsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -345,9 +1098,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByID(
     ::grpc::ServerContext* context, const GetExecutionsByIDRequest* request,
     GetExecutionsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionsByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -365,9 +1124,27 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutEvents(
     ::grpc::ServerContext* context, const PutEventsRequest* request,
     PutEventsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutEvents", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  if (tenant->put_coalescer != nullptr) {
+    const ::grpc::Status status =
+        ToGRPCStatus(tenant->put_coalescer->PutEvents(*request, response));
+    if (!status.ok()) {
+      LOG(WARNING) << "PutEvents failed: " << status.error_message();
+    }
+    return status;
+  }
+  MetadataStorePool::ScopedMetadataStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ConnectMetadataStore(&tenant->pool, context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -384,9 +1161,27 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecution(
     ::grpc::ServerContext* context, const PutExecutionRequest* request,
     PutExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutExecution", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  if (tenant->put_coalescer != nullptr) {
+    const ::grpc::Status status =
+        ToGRPCStatus(tenant->put_coalescer->PutExecution(*request, response));
+    if (!status.ok()) {
+      LOG(WARNING) << "PutExecution failed: " << status.error_message();
+    }
+    return status;
+  }
+  MetadataStorePool::ScopedMetadataStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ConnectMetadataStore(&tenant->pool, context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -405,9 +1200,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetEventsByArtifactIDsRequest* request,
     GetEventsByArtifactIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetEventsByArtifactIDs", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -426,9 +1227,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetEventsByExecutionIDsRequest* request,
     GetEventsByExecutionIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetEventsByExecutionIDs", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -446,29 +1253,66 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifacts(
     ::grpc::ServerContext* context, const GetArtifactsRequest* request,
     GetArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifacts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  GetArtifactsRequest capped_request =
+      CapBulkListResultSize(*request, max_bulk_list_result_size_);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  ListCursor cursor;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ConnectListCursor(context, &capped_request, &metadata_store, &cursor);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifacts(*request, response));
+      ToGRPCStatus(metadata_store->GetArtifacts(capped_request, response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetArtifacts failed: "
                  << transaction_status.error_message();
   }
+  ReleaseListCursor(transaction_status, cursor, std::move(metadata_store),
+                    response->mutable_next_page_token());
   return transaction_status;
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByType(
     ::grpc::ServerContext* context, const GetArtifactsByTypeRequest* request,
     GetArtifactsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  // The large types are split across the stores of the pool, unless the call
+  // is in a read session, which reads them from its own snapshot.
+  if (ReadSessionToken(context).empty()) {
+    Tenant* tenant;
+    const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+    if (!tenant_status.ok()) return tenant_status;
+    const absl::optional<ParallelReadOptions>& parallel_read =
+        tenant->pool.options().parallel_read;
+    if (parallel_read.has_value()) {
+      const ::grpc::Status status =
+          ToGRPCStatus(tenant->pool.GetArtifactsByType(
+              *request, *parallel_read, absl::FromChrono(context->deadline()),
+              response));
+      if (!status.ok()) {
+        LOG(WARNING) << "GetArtifactsByType failed: " << status.error_message();
+      }
+      return status;
+    }
+  }
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -487,9 +1331,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetArtifactByTypeAndNameRequest* request,
     GetArtifactByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactByTypeAndName", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -504,12 +1354,45 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const GetArtifactsByTypeAndNamesRequest* request,
+    GetArtifactsByTypeAndNamesResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByTypeAndNames", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      metadata_store->GetArtifactsByTypeAndNames(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetArtifactsByTypeAndNames failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByURI(
     ::grpc::ServerContext* context, const GetArtifactsByURIRequest* request,
     GetArtifactsByURIResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByURI", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -524,32 +1407,103 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByURIPrefix(
+    ::grpc::ServerContext* context,
+    const GetArtifactsByURIPrefixRequest* request,
+    GetArtifactsByURIPrefixResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByURIPrefix", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      metadata_store->GetArtifactsByURIPrefix(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetArtifactsByURIPrefix failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::ArtifactsExist(
+    ::grpc::ServerContext* context, const ArtifactsExistRequest* request,
+    ArtifactsExistResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "ArtifactsExist", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->ArtifactsExist(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "ArtifactsExist failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetExecutions(
     ::grpc::ServerContext* context, const GetExecutionsRequest* request,
     GetExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutions", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  GetExecutionsRequest capped_request =
+      CapBulkListResultSize(*request, max_bulk_list_result_size_);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  ListCursor cursor;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ConnectListCursor(context, &capped_request, &metadata_store, &cursor);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutions(*request, response));
+      ToGRPCStatus(metadata_store->GetExecutions(capped_request, response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetExecutions failed: "
                  << transaction_status.error_message();
   }
+  ReleaseListCursor(transaction_status, cursor, std::move(metadata_store),
+                    response->mutable_next_page_token());
   return transaction_status;
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByType(
     ::grpc::ServerContext* context, const GetExecutionsByTypeRequest* request,
     GetExecutionsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionsByType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -568,9 +1522,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetExecutionByTypeAndNameRequest* request,
     GetExecutionByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionByTypeAndName", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -585,12 +1545,45 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const GetExecutionsByTypeAndNamesRequest* request,
+    GetExecutionsByTypeAndNamesResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionsByTypeAndNames", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      metadata_store->GetExecutionsByTypeAndNames(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetExecutionsByTypeAndNames failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::PutContexts(
     ::grpc::ServerContext* context, const PutContextsRequest* request,
     PutContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -608,9 +1601,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByID(
     ::grpc::ServerContext* context, const GetContextsByIDRequest* request,
     GetContextsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByID", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -625,39 +1624,120 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+template <typename Request>
+::grpc::Status MetadataStoreServiceImpl::GetSerializedNodesByID(
+    ::grpc::ServerContext* context, const absl::string_view method,
+    const ::grpc::ByteBuffer& request,
+    tensorflow::Status (MetadataStore::*get_serialized_nodes)(const Request&,
+                                                              std::string*),
+    ::grpc::ByteBuffer* response) {
+  const ScopedRpcRecorder rpc_recorder(context, method,
+                                       query_accounting_options_,
+                                       response_compression_options_, response);
+  Request parsed_request;
+  const ::grpc::Status parse_status = ParseRequest(request, &parsed_request);
+  if (!parse_status.ok()) return parse_status;
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(parsed_request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  std::string serialized_response;
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      ((*metadata_store).*get_serialized_nodes)(parsed_request,
+                                                &serialized_response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << method
+                 << " failed: " << transaction_status.error_message();
+    return transaction_status;
+  }
+  *response = ToByteBuffer(std::move(serialized_response));
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByID(
+    ::grpc::ServerContext* context, const ::grpc::ByteBuffer* request,
+    ::grpc::ByteBuffer* response) {
+  return GetSerializedNodesByID<GetArtifactsByIDRequest>(
+      context, "GetArtifactsByID", *request,
+      &MetadataStore::GetSerializedArtifactsByID, response);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByID(
+    ::grpc::ServerContext* context, const ::grpc::ByteBuffer* request,
+    ::grpc::ByteBuffer* response) {
+  return GetSerializedNodesByID<GetExecutionsByIDRequest>(
+      context, "GetExecutionsByID", *request,
+      &MetadataStore::GetSerializedExecutionsByID, response);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContextsByID(
+    ::grpc::ServerContext* context, const ::grpc::ByteBuffer* request,
+    ::grpc::ByteBuffer* response) {
+  return GetSerializedNodesByID<GetContextsByIDRequest>(
+      context, "GetContextsByID", *request,
+      &MetadataStore::GetSerializedContextsByID, response);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetContexts(
     ::grpc::ServerContext* context, const GetContextsRequest* request,
     GetContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  GetContextsRequest capped_request =
+      CapBulkListResultSize(*request, max_bulk_list_result_size_);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  ListCursor cursor;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ConnectListCursor(context, &capped_request, &metadata_store, &cursor);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContexts(*request, response));
+      ToGRPCStatus(metadata_store->GetContexts(capped_request, response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetContexts failed: "
                  << transaction_status.error_message();
   }
+  ReleaseListCursor(transaction_status, cursor, std::move(metadata_store),
+                    response->mutable_next_page_token());
   return transaction_status;
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByType(
     ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
     GetContextsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByType", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByType(*request, response));
+      ToGRPCStatus(metadata_store->GetContextsByType(
+          CapBulkListResultSize(*request, max_bulk_list_result_size_),
+          response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetContextsByType failed: "
                  << transaction_status.error_message();
@@ -665,13 +1745,123 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::CountArtifacts(
+    ::grpc::ServerContext* context, const CountArtifactsRequest* request,
+    CountArtifactsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "CountArtifacts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountArtifacts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CountArtifacts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountExecutions(
+    ::grpc::ServerContext* context, const CountExecutionsRequest* request,
+    CountExecutionsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "CountExecutions", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountExecutions(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CountExecutions failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountContexts(
+    ::grpc::ServerContext* context, const CountContextsRequest* request,
+    CountContextsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "CountContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountContexts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CountContexts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::AggregateProperty(
+    ::grpc::ServerContext* context, const AggregatePropertyRequest* request,
+    AggregatePropertyResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "AggregateProperty", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->AggregateProperty(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "AggregateProperty failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetContextByTypeAndName(
     ::grpc::ServerContext* context,
     const GetContextByTypeAndNameRequest* request,
     GetContextByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextByTypeAndName", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -686,13 +1876,46 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetContextsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const GetContextsByTypeAndNamesRequest* request,
+    GetContextsByTypeAndNamesResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByTypeAndNames", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      metadata_store->GetContextsByTypeAndNames(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetContextsByTypeAndNames failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::PutAttributionsAndAssociations(
     ::grpc::ServerContext* context,
     const PutAttributionsAndAssociationsRequest* request,
     PutAttributionsAndAssociationsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutAttributionsAndAssociations", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -710,9 +1933,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutParentContexts(
     ::grpc::ServerContext* context, const PutParentContextsRequest* request,
     PutParentContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "PutParentContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -727,12 +1956,96 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::DeleteArtifacts(
+    ::grpc::ServerContext* context, const DeleteArtifactsRequest* request,
+    DeleteArtifactsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "DeleteArtifacts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->DeleteArtifacts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "DeleteArtifacts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::DeleteExecutions(
+    ::grpc::ServerContext* context, const DeleteExecutionsRequest* request,
+    DeleteExecutionsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "DeleteExecutions", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->DeleteExecutions(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "DeleteExecutions failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CollectGarbage(
+    ::grpc::ServerContext* context, const CollectGarbageRequest* request,
+    CollectGarbageResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "CollectGarbage", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CollectGarbage(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CollectGarbage failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByArtifact(
     ::grpc::ServerContext* context, const GetContextsByArtifactRequest* request,
     GetContextsByArtifactResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByArtifact", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -751,9 +2064,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetContextsByExecutionRequest* request,
     GetContextsByExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByExecution", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -771,16 +2090,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByContext(
     ::grpc::ServerContext* context, const GetArtifactsByContextRequest* request,
     GetArtifactsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByContext", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByContext(*request, response));
+      ToGRPCStatus(metadata_store->GetArtifactsByContext(
+          CapBulkListResultSize(*request, max_bulk_list_result_size_),
+          response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetArtifactsByContext failed: "
                  << transaction_status.error_message();
@@ -792,16 +2119,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetExecutionsByContextRequest* request,
     GetExecutionsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionsByContext", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByContext(*request, response));
+      ToGRPCStatus(metadata_store->GetExecutionsByContext(
+          CapBulkListResultSize(*request, max_bulk_list_result_size_),
+          response));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "GetExecutionsByContext failed: "
                  << transaction_status.error_message();
@@ -809,13 +2144,127 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByContexts(
+    ::grpc::ServerContext* context,
+    const GetArtifactsByContextsRequest* request,
+    GetArtifactsByContextsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetArtifactsByContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetArtifactsByContexts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetArtifactsByContexts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByContexts(
+    ::grpc::ServerContext* context,
+    const GetExecutionsByContextsRequest* request,
+    GetExecutionsByContextsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetExecutionsByContexts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetExecutionsByContexts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetExecutionsByContexts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContextsByArtifacts(
+    ::grpc::ServerContext* context,
+    const GetContextsByArtifactsRequest* request,
+    GetContextsByArtifactsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByArtifacts", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetContextsByArtifacts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetContextsByArtifacts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContextsByExecutions(
+    ::grpc::ServerContext* context,
+    const GetContextsByExecutionsRequest* request,
+    GetContextsByExecutionsResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetContextsByExecutions", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetContextsByExecutions(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetContextsByExecutions failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetParentContextsByContext(
     ::grpc::ServerContext* context,
     const GetParentContextsByContextRequest* request,
     GetParentContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetParentContextsByContext", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -834,9 +2283,15 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetChildrenContextsByContextRequest* request,
     GetChildrenContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetChildrenContextsByContext", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -851,4 +2306,240 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetLineageGraph(
+    ::grpc::ServerContext* context, const GetLineageGraphRequest* request,
+    GetLineageGraphResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetLineageGraph", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetLineageGraph(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetLineageGraph failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetLineageClosure(
+    ::grpc::ServerContext* context, const GetLineageClosureRequest* request,
+    GetLineageClosureResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "GetLineageClosure", query_accounting_options_,
+      response_compression_options_, response);
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = Connect(context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetLineageClosure(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetLineageClosure failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::BeginReadSession(
+    ::grpc::ServerContext* context, const BeginReadSessionRequest* request,
+    BeginReadSessionResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "BeginReadSession", query_accounting_options_,
+      response_compression_options_, response);
+  if (read_session_registry_ == nullptr) {
+    return ToGRPCStatus(tensorflow::errors::Unimplemented(
+        "The read sessions are not enabled by the server."));
+  }
+  Admission admission;
+  const ::grpc::Status admission_status =
+      Admit(context, NumWrittenRecords(*request), &admission);
+  if (!admission_status.ok()) return admission_status;
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status =
+      ConnectMetadataStore(&tenant->pool, context, &metadata_store);
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  std::string session_token;
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      read_session_registry_->Open(&metadata_store, &session_token));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "BeginReadSession failed: "
+                 << transaction_status.error_message();
+    return transaction_status;
+  }
+  response->set_session_token(session_token);
+  read_session_registry_->Return(session_token, &tenant->pool,
+                                 std::move(metadata_store));
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status MetadataStoreServiceImpl::EndReadSession(
+    ::grpc::ServerContext* context, const EndReadSessionRequest* request,
+    EndReadSessionResponse* response) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "EndReadSession", query_accounting_options_,
+      response_compression_options_, response);
+  if (read_session_registry_ == nullptr) {
+    return ToGRPCStatus(tensorflow::errors::Unimplemented(
+        "The read sessions are not enabled by the server."));
+  }
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  // A session which is not idle has expired, or is ended by its running call.
+  if (read_session_registry_
+          ->Take(request->session_token(), &tenant->pool, &metadata_store)
+          .ok()) {
+    read_session_registry_->Close(std::move(metadata_store));
+  }
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamArtifacts(
+    ::grpc::ServerContext* context, const StreamArtifactsRequest* request,
+    ::grpc::ServerWriter<StreamArtifactsResponse>* writer) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "StreamArtifacts", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  return StreamResponses(&tenant->pool, *request,
+                         WriteTo(context, writer),
+                         &MetadataStore::StreamArtifacts, "StreamArtifacts");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamArtifacts(
+    const StreamArtifactsRequest& request,
+    const std::function<bool(const StreamArtifactsResponse&)>& write) {
+  const ScopedRpcRecorder rpc_recorder(
+      /*context=*/nullptr, "StreamArtifacts", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  return StreamResponses(&default_tenant_.pool, request, write,
+                         &MetadataStore::StreamArtifacts, "StreamArtifacts");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamExecutions(
+    ::grpc::ServerContext* context, const StreamExecutionsRequest* request,
+    ::grpc::ServerWriter<StreamExecutionsResponse>* writer) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "StreamExecutions", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  return StreamResponses(&tenant->pool, *request,
+                         WriteTo(context, writer),
+                         &MetadataStore::StreamExecutions, "StreamExecutions");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamExecutions(
+    const StreamExecutionsRequest& request,
+    const std::function<bool(const StreamExecutionsResponse&)>& write) {
+  const ScopedRpcRecorder rpc_recorder(
+      /*context=*/nullptr, "StreamExecutions", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  return StreamResponses(&default_tenant_.pool, request, write,
+                         &MetadataStore::StreamExecutions, "StreamExecutions");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamContexts(
+    ::grpc::ServerContext* context, const StreamContextsRequest* request,
+    ::grpc::ServerWriter<StreamContextsResponse>* writer) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "StreamContexts", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  return StreamResponses(&tenant->pool, *request,
+                         WriteTo(context, writer),
+                         &MetadataStore::StreamContexts, "StreamContexts");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamContexts(
+    const StreamContextsRequest& request,
+    const std::function<bool(const StreamContextsResponse&)>& write) {
+  const ScopedRpcRecorder rpc_recorder(
+      /*context=*/nullptr, "StreamContexts", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  return StreamResponses(&default_tenant_.pool, request, write,
+                         &MetadataStore::StreamContexts, "StreamContexts");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamNodeColumns(
+    ::grpc::ServerContext* context, const StreamNodeColumnsRequest* request,
+    ::grpc::ServerWriter<StreamNodeColumnsResponse>* writer) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "StreamNodeColumns", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  return StreamResponses(&tenant->pool, *request,
+                         WriteTo(context, writer),
+                         &MetadataStore::StreamNodeColumns,
+                         "StreamNodeColumns");
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamNodeColumns(
+    const StreamNodeColumnsRequest& request,
+    const std::function<bool(const StreamNodeColumnsResponse&)>& write) {
+  const ScopedRpcRecorder rpc_recorder(
+      /*context=*/nullptr, "StreamNodeColumns", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  return StreamResponses(&default_tenant_.pool, request, write,
+                         &MetadataStore::StreamNodeColumns,
+                         "StreamNodeColumns");
+}
+
+::grpc::Status MetadataStoreServiceImpl::WatchChanges(
+    ::grpc::ServerContext* context, const WatchChangesRequest* request,
+    ::grpc::ServerWriter<WatchChangesResponse>* writer) {
+  const ScopedRpcRecorder rpc_recorder(
+      context, "WatchChanges", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  Tenant* tenant;
+  const ::grpc::Status tenant_status = FindTenant(context, &tenant);
+  if (!tenant_status.ok()) return tenant_status;
+  return StreamResponses(&tenant->pool, *request,
+                         WriteTo(context, writer),
+                         &MetadataStore::WatchChanges, "WatchChanges");
+}
+
+::grpc::Status MetadataStoreServiceImpl::WatchChanges(
+    const WatchChangesRequest& request,
+    const std::function<bool(const WatchChangesResponse&)>& write) {
+  const ScopedRpcRecorder rpc_recorder(
+      /*context=*/nullptr, "WatchChanges", query_accounting_options_,
+      response_compression_options_, /*response=*/nullptr);
+  return StreamResponses(&default_tenant_.pool, request, write,
+                         &MetadataStore::WatchChanges, "WatchChanges");
+}
+
 }  // namespace ml_metadata
@@ -15,26 +15,174 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "grpc/compression.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "ml_metadata/metadata_store/admission_controller.h"
+#include "ml_metadata/metadata_store/client_rate_limiter.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/pinned_read_registry.h"
+#include "ml_metadata/metadata_store/put_coalescer.h"
+#include "ml_metadata/metadata_store/query_accounting.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
 
 namespace ml_metadata {
 
+// Options of the compression of the responses of the unary calls.
+struct ResponseCompressionOptions {
+  // The algorithm compressing the responses. If it is GRPC_COMPRESS_NONE, the
+  // responses are sent uncompressed. A response is also sent uncompressed if
+  // the client does not accept the algorithm.
+  grpc_compression_algorithm algorithm = GRPC_COMPRESS_NONE;
+  // The responses smaller than this size in bytes are sent uncompressed, as
+  // compressing them costs more CPU than it saves bandwidth.
+  int64 min_response_bytes = 0;
+};
+
 // A metadata store gRPC server that implements MetadataStoreService defined in
 // proto/metadata_store_service.proto. It is thread-safe.
-// Note, concurrent call to methods in different threads are sequential.
-// TODO(b/123039345) Add a connection pool in metadata_store or grpc service.
+// Connected stores are kept in a bounded MetadataStorePool and reused across
+// calls, so that the requests do not pay the cost of connecting the database.
 class MetadataStoreServiceImpl final
     : public MetadataStoreService::Service {
  public:
   explicit MetadataStoreServiceImpl(const ConnectionConfig& connection_config);
 
+  // Creates the service with a store pool configured by `pool_options`.
+  MetadataStoreServiceImpl(const ConnectionConfig& connection_config,
+                           const MetadataStorePoolOptions& pool_options);
+
+  // Creates the service, which bounds the page size of the list requests in
+  // bulk mode by `max_bulk_list_result_size`.
+  MetadataStoreServiceImpl(const ConnectionConfig& connection_config,
+                           const MetadataStorePoolOptions& pool_options,
+                           int max_bulk_list_result_size);
+
+  // Creates the service, which also merges concurrent PutExecution and
+  // PutEvents calls into shared transactions, if `put_coalescer_options` is
+  // given.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options);
+
+  // Creates the service, which also accounts the queries of each call as
+  // configured by `query_accounting_options`.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options);
+
+  // Creates the service, which also compresses the responses as configured by
+  // `response_compression_options`.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options);
+
+  // Creates the service, which also limits the concurrent calls running in
+  // front of the database, if `admission_control_options` is given. The calls
+  // of each RequestClass beyond its limit wait to be admitted, or fail with
+  // RESOURCE_EXHAUSTED error, see AdmissionController. The streaming calls are
+  // not limited, as they last as long as their clients read.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const absl::optional<AdmissionControlOptions>& admission_control_options);
+
+  // Creates the service, which also limits the calls of each client, if
+  // `client_rate_limit_config` is given, see ClientRateLimiter. The clients
+  // are limited before the admission control of the calls.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const absl::optional<AdmissionControlOptions>& admission_control_options,
+      const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+          client_rate_limit_config);
+
+  // Creates the service, which also serves the tenants of
+  // `tenant_routing_config`, if given, each with a store pool of its own
+  // created with `pool_options`. The calls without a tenant use the
+  // `connection_config`.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const absl::optional<AdmissionControlOptions>& admission_control_options,
+      const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+          client_rate_limit_config,
+      const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+          tenant_routing_config);
+
+  // Creates the service, which also holds the cursors of the lists asking for
+  // a ListOperationOptions.snapshot_cursor, if `list_cursor_options` are
+  // given, see PinnedReadRegistry. Each open cursor holds a store of its pool.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const absl::optional<AdmissionControlOptions>& admission_control_options,
+      const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+          client_rate_limit_config,
+      const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+          tenant_routing_config,
+      const absl::optional<PinnedReadOptions>& list_cursor_options);
+
+  // Creates the service, which also holds the read sessions begun by
+  // BeginReadSession, if `read_session_options` are given. The unary calls
+  // sending a session token in their `mlmd-read-session` metadata run on the
+  // store of the session. Each open session holds a store of its pool.
+  MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePoolOptions& pool_options,
+      int max_bulk_list_result_size,
+      const absl::optional<PutCoalescerOptions>& put_coalescer_options,
+      const QueryAccountingOptions& query_accounting_options,
+      const ResponseCompressionOptions& response_compression_options,
+      const absl::optional<AdmissionControlOptions>& admission_control_options,
+      const absl::optional<MetadataStoreServerConfig::ClientRateLimitConfig>&
+          client_rate_limit_config,
+      const absl::optional<MetadataStoreServerConfig::TenantRoutingConfig>&
+          tenant_routing_config,
+      const absl::optional<PinnedReadOptions>& list_cursor_options,
+      const absl::optional<PinnedReadOptions>& read_session_options);
+
   // default & copy constructors are disallowed.
   MetadataStoreServiceImpl() = delete;
   MetadataStoreServiceImpl(const MetadataStoreServiceImpl&) = delete;
   MetadataStoreServiceImpl& operator=(const MetadataStoreServiceImpl&) = delete;
 
+  // Warms up the store pools of the service and its tenants before it serves
+  // calls, see MetadataStorePool::WarmUp.
+  tensorflow::Status WarmUp(const PoolWarmUpOptions& options);
+
   ::grpc::Status PutArtifactType(::grpc::ServerContext* context,
                                  const PutArtifactTypeRequest* request,
                                  PutArtifactTypeResponse* response) override;
@@ -132,10 +280,24 @@ class MetadataStoreServiceImpl final
       const GetArtifactByTypeAndNameRequest* request,
       GetArtifactByTypeAndNameResponse* response) override;
 
+  ::grpc::Status GetArtifactsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const GetArtifactsByTypeAndNamesRequest* request,
+      GetArtifactsByTypeAndNamesResponse* response) override;
+
   ::grpc::Status GetArtifactsByURI(
       ::grpc::ServerContext* context, const GetArtifactsByURIRequest* request,
       GetArtifactsByURIResponse* response) override;
 
+  ::grpc::Status GetArtifactsByURIPrefix(
+      ::grpc::ServerContext* context,
+      const GetArtifactsByURIPrefixRequest* request,
+      GetArtifactsByURIPrefixResponse* response) override;
+
+  ::grpc::Status ArtifactsExist(::grpc::ServerContext* context,
+                                const ArtifactsExistRequest* request,
+                                ArtifactsExistResponse* response) override;
+
   ::grpc::Status GetExecutions(::grpc::ServerContext* context,
                                const GetExecutionsRequest* request,
                                GetExecutionsResponse* response) override;
@@ -149,6 +311,11 @@ class MetadataStoreServiceImpl final
       const GetExecutionByTypeAndNameRequest* request,
       GetExecutionByTypeAndNameResponse* response) override;
 
+  ::grpc::Status GetExecutionsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const GetExecutionsByTypeAndNamesRequest* request,
+      GetExecutionsByTypeAndNamesResponse* response) override;
+
   ::grpc::Status PutContexts(::grpc::ServerContext* context,
                              const PutContextsRequest* request,
                              PutContextsResponse* response) override;
@@ -165,11 +332,32 @@ class MetadataStoreServiceImpl final
       ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
       GetContextsByTypeResponse* response) override;
 
+  ::grpc::Status CountArtifacts(::grpc::ServerContext* context,
+                                const CountArtifactsRequest* request,
+                                CountArtifactsResponse* response) override;
+
+  ::grpc::Status CountExecutions(::grpc::ServerContext* context,
+                                 const CountExecutionsRequest* request,
+                                 CountExecutionsResponse* response) override;
+
+  ::grpc::Status CountContexts(::grpc::ServerContext* context,
+                               const CountContextsRequest* request,
+                               CountContextsResponse* response) override;
+
+  ::grpc::Status AggregateProperty(
+      ::grpc::ServerContext* context, const AggregatePropertyRequest* request,
+      AggregatePropertyResponse* response) override;
+
   ::grpc::Status GetContextByTypeAndName(
       ::grpc::ServerContext* context,
       const GetContextByTypeAndNameRequest* request,
       GetContextByTypeAndNameResponse* response) override;
 
+  ::grpc::Status GetContextsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const GetContextsByTypeAndNamesRequest* request,
+      GetContextsByTypeAndNamesResponse* response) override;
+
   ::grpc::Status PutAttributionsAndAssociations(
       ::grpc::ServerContext* context,
       const PutAttributionsAndAssociationsRequest* request,
@@ -179,6 +367,18 @@ class MetadataStoreServiceImpl final
       ::grpc::ServerContext* context, const PutParentContextsRequest* request,
       PutParentContextsResponse* response) override;
 
+  ::grpc::Status DeleteArtifacts(::grpc::ServerContext* context,
+                                 const DeleteArtifactsRequest* request,
+                                 DeleteArtifactsResponse* response) override;
+
+  ::grpc::Status DeleteExecutions(::grpc::ServerContext* context,
+                                  const DeleteExecutionsRequest* request,
+                                  DeleteExecutionsResponse* response) override;
+
+  ::grpc::Status CollectGarbage(::grpc::ServerContext* context,
+                                const CollectGarbageRequest* request,
+                                CollectGarbageResponse* response) override;
+
   ::grpc::Status GetContextsByArtifact(
       ::grpc::ServerContext* context,
       const GetContextsByArtifactRequest* request,
@@ -199,6 +399,26 @@ class MetadataStoreServiceImpl final
       const GetExecutionsByContextRequest* request,
       GetExecutionsByContextResponse* response) override;
 
+  ::grpc::Status GetArtifactsByContexts(
+      ::grpc::ServerContext* context,
+      const GetArtifactsByContextsRequest* request,
+      GetArtifactsByContextsResponse* response) override;
+
+  ::grpc::Status GetExecutionsByContexts(
+      ::grpc::ServerContext* context,
+      const GetExecutionsByContextsRequest* request,
+      GetExecutionsByContextsResponse* response) override;
+
+  ::grpc::Status GetContextsByArtifacts(
+      ::grpc::ServerContext* context,
+      const GetContextsByArtifactsRequest* request,
+      GetContextsByArtifactsResponse* response) override;
+
+  ::grpc::Status GetContextsByExecutions(
+      ::grpc::ServerContext* context,
+      const GetContextsByExecutionsRequest* request,
+      GetContextsByExecutionsResponse* response) override;
+
   ::grpc::Status GetParentContextsByContext(
       ::grpc::ServerContext* context,
       const GetParentContextsByContextRequest* request,
@@ -209,8 +429,187 @@ class MetadataStoreServiceImpl final
       const GetChildrenContextsByContextRequest* request,
       GetChildrenContextsByContextResponse* response) override;
 
+  ::grpc::Status GetLineageGraph(::grpc::ServerContext* context,
+                                 const GetLineageGraphRequest* request,
+                                 GetLineageGraphResponse* response) override;
+
+  ::grpc::Status GetLineageClosure(
+      ::grpc::ServerContext* context, const GetLineageClosureRequest* request,
+      GetLineageClosureResponse* response) override;
+
+  ::grpc::Status BeginReadSession(::grpc::ServerContext* context,
+                                  const BeginReadSessionRequest* request,
+                                  BeginReadSessionResponse* response) override;
+
+  ::grpc::Status EndReadSession(::grpc::ServerContext* context,
+                                const EndReadSessionRequest* request,
+                                EndReadSessionResponse* response) override;
+
+  ::grpc::Status StreamArtifacts(
+      ::grpc::ServerContext* context, const StreamArtifactsRequest* request,
+      ::grpc::ServerWriter<StreamArtifactsResponse>* writer) override;
+
+  ::grpc::Status StreamExecutions(
+      ::grpc::ServerContext* context, const StreamExecutionsRequest* request,
+      ::grpc::ServerWriter<StreamExecutionsResponse>* writer) override;
+
+  ::grpc::Status StreamContexts(
+      ::grpc::ServerContext* context, const StreamContextsRequest* request,
+      ::grpc::ServerWriter<StreamContextsResponse>* writer) override;
+
+  ::grpc::Status StreamNodeColumns(
+      ::grpc::ServerContext* context, const StreamNodeColumnsRequest* request,
+      ::grpc::ServerWriter<StreamNodeColumnsResponse>* writer) override;
+
+  ::grpc::Status WatchChanges(
+      ::grpc::ServerContext* context, const WatchChangesRequest* request,
+      ::grpc::ServerWriter<WatchChangesResponse>* writer) override;
+
+  // The streaming methods above, which write the responses with `write`
+  // instead of a ServerWriter, e.g., for the MetadataStoreAsyncServer. `write`
+  // returns false once the client closed the stream.
+  ::grpc::Status StreamArtifacts(
+      const StreamArtifactsRequest& request,
+      const std::function<bool(const StreamArtifactsResponse&)>& write);
+
+  ::grpc::Status StreamExecutions(
+      const StreamExecutionsRequest& request,
+      const std::function<bool(const StreamExecutionsResponse&)>& write);
+
+  ::grpc::Status StreamContexts(
+      const StreamContextsRequest& request,
+      const std::function<bool(const StreamContextsResponse&)>& write);
+
+  ::grpc::Status StreamNodeColumns(
+      const StreamNodeColumnsRequest& request,
+      const std::function<bool(const StreamNodeColumnsResponse&)>& write);
+
+  ::grpc::Status WatchChanges(
+      const WatchChangesRequest& request,
+      const std::function<bool(const WatchChangesResponse&)>& write);
+
+  // The GetArtifactsByID, GetExecutionsByID and GetContextsByID methods above
+  // on the wire form of their messages, e.g., for the raw methods of the
+  // MetadataStoreAsyncServer. If the node cache retains the serialized nodes,
+  // see MetadataStorePoolOptions, the cached nodes are spliced into the
+  // responses, so that they are neither decoded nor encoded again.
+  ::grpc::Status GetArtifactsByID(::grpc::ServerContext* context,
+                                  const ::grpc::ByteBuffer* request,
+                                  ::grpc::ByteBuffer* response);
+
+  ::grpc::Status GetExecutionsByID(::grpc::ServerContext* context,
+                                   const ::grpc::ByteBuffer* request,
+                                   ::grpc::ByteBuffer* response);
+
+  ::grpc::Status GetContextsByID(::grpc::ServerContext* context,
+                                 const ::grpc::ByteBuffer* request,
+                                 ::grpc::ByteBuffer* response);
+
  private:
-  const ConnectionConfig connection_config_;
+  // The stores of the calls of a tenant.
+  struct Tenant {
+    Tenant(const ConnectionConfig& connection_config,
+           const MetadataStorePoolOptions& pool_options,
+           const absl::optional<PutCoalescerOptions>& put_coalescer_options);
+
+    MetadataStorePool pool;
+    // Runs PutExecution and PutEvents in batches, or nullptr if disabled.
+    std::unique_ptr<PutCoalescer> put_coalescer;
+  };
+
+  // The admissions of a call, which are released once it is over.
+  struct Admission {
+    ClientRateLimiter::Permit client_permit;
+    AdmissionController::Permit permit;
+  };
+
+  // Admits a call until the deadline of its `context`, which writes
+  // `num_written_records` records, or is a read if it is negative, see
+  // ClientRateLimiter::Admit and AdmissionController::Admit. The calls are all
+  // admitted at once, if neither is enabled.
+  ::grpc::Status Admit(const ::grpc::ServerContext* context,
+                       int64 num_written_records, Admission* admission);
+
+  // Sets the `tenant` selected by the metadata of the call `context`, or the
+  // default tenant if none is selected, or if `context` is nullptr.
+  // Returns NOT_FOUND error, if the selected tenant is not served.
+  ::grpc::Status FindTenant(const ::grpc::ServerContext* context,
+                            Tenant** tenant);
+
+  // Borrows a store of the tenant of the call `context`, see FindTenant. If
+  // the call sends the token of a read session, the store of the session is
+  // taken instead, and kept for the session once `metadata_store` is reset.
+  // Returns NOT_FOUND error, if the session has ended or serves another call.
+  ::grpc::Status Connect(
+      const ::grpc::ServerContext* context,
+      MetadataStorePool::ScopedMetadataStore* metadata_store);
+
+  // Runs a raw call of `method`, which parses its `request` and serializes its
+  // `response` with `get_serialized_nodes`, see the raw methods above.
+  template <typename Request>
+  ::grpc::Status GetSerializedNodesByID(
+      ::grpc::ServerContext* context, absl::string_view method,
+      const ::grpc::ByteBuffer& request,
+      tensorflow::Status (MetadataStore::*get_serialized_nodes)(
+          const Request&, std::string*),
+      ::grpc::ByteBuffer* response);
+
+  // The server-held cursor serving a page of a list, if its id is not empty.
+  struct ListCursor {
+    std::string id;
+    const MetadataStorePool* pool = nullptr;
+  };
+
+  // Borrows a store to list a page of `request` like Connect, unless its
+  // options ask for a snapshot_cursor and the service holds cursors. Then the
+  // first page opens a `cursor` with the store, and a later page resumes the
+  // cursor named by its next_page_token, which is replaced by the inner token.
+  // A page is listed without a cursor, if all cursors are open, or the
+  // cursor of its token has expired.
+  template <typename Request>
+  ::grpc::Status ConnectListCursor(
+      const ::grpc::ServerContext* context, Request* request,
+      MetadataStorePool::ScopedMetadataStore* metadata_store,
+      ListCursor* cursor);
+
+  // Keeps the `cursor` of a page listed with `list_status` idle with its
+  // `metadata_store` and names it in the `next_page_token`, or closes it if
+  // the page failed or is the last one.
+  void ReleaseListCursor(const ::grpc::Status& list_status,
+                         const ListCursor& cursor,
+                         MetadataStorePool::ScopedMetadataStore metadata_store,
+                         std::string* next_page_token);
+
+  // The stores connected with the service's ConnectionConfig.
+  Tenant default_tenant_;
+
+  // The gRPC metadata key selecting the tenant of a call, and the stores of
+  // the tenants by id.
+  std::string tenant_id_metadata_key_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Tenant>> tenants_;
+
+  // The upper-bound of max_result_size of the list requests in bulk mode.
+  const int max_bulk_list_result_size_;
+
+  // How the queries of the calls are accounted.
+  const QueryAccountingOptions query_accounting_options_;
+
+  // How the responses of the unary calls are compressed.
+  const ResponseCompressionOptions response_compression_options_;
+
+  // Limits the concurrent calls, or nullptr if disabled.
+  std::unique_ptr<AdmissionController> admission_controller_;
+
+  // Limits the calls of each client, or nullptr if disabled.
+  std::unique_ptr<ClientRateLimiter> client_rate_limiter_;
+
+  // Holds the list cursors, or nullptr if disabled. It is destructed before
+  // the pools of the cursors.
+  std::unique_ptr<PinnedReadRegistry> list_cursor_registry_;
+
+  // Holds the read sessions, or nullptr if disabled. It is destructed before
+  // the pools of the sessions.
+  std::unique_ptr<PinnedReadRegistry> read_session_registry_;
 };
 
 }  // namespace ml_metadata
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_INTERFACE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_INTERFACE_H_
 
+#include <functional>
+
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -45,6 +47,9 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutContexts)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutAttributionsAndAssociations)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutParentContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(DeleteArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(DeleteExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CollectGarbage)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypesByID)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypes)
@@ -66,7 +71,16 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionByTypeAndName)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextByTypeAndName)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByTypeAndNames)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByTypeAndNames)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByTypeAndNames)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(AggregateProperty)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByURI)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByURIPrefix)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(ArtifactsExist)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetEventsByExecutionIDs)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetEventsByArtifactIDs)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByArtifact)
@@ -75,8 +89,34 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetChildrenContextsByContext)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByContext)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByContext)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetLineageGraph)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetLineageClosure)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(BeginReadSession)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(EndReadSession)
 
 #undef METADATA_STORE_SERVICE_INTERFACE_DECLARE
+
+  // The streaming methods call `callback` with each response of the stream. A
+  // non-OK status returned by the callback aborts the method and is returned.
+#define METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(method)          \
+  virtual tensorflow::Status method(                                        \
+      const method##Request& request,                                       \
+      const std::function<tensorflow::Status(const method##Response&)>&     \
+          callback) {                                                       \
+    return tensorflow::errors::Unimplemented(#method);                      \
+  }
+
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(StreamArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(StreamExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(StreamContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(StreamNodeColumns)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING(WatchChanges)
+
+#undef METADATA_STORE_SERVICE_INTERFACE_DECLARE_STREAMING
 };
 
 }  // namespace ml_metadata
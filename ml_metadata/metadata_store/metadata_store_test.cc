@@ -16,12 +16,16 @@ limitations under the License.
 
 #include <memory>
 
+#include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_store_test_suite.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -31,6 +35,7 @@ namespace ml_metadata {
 namespace testing {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAreArray;
 using ::testing::UnorderedPointwise;
@@ -123,6 +128,362 @@ TEST(MetadataStoreExtendedTest, SpecifyDowngradeMigrationWhenCreate) {
   TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
 }
 
+TEST(MetadataStoreExtendedTest, InitIfNotExistsSkipsStoredSimpleTypes) {
+  auto metadata_source =
+      absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig());
+  auto transaction_executor =
+      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  TypeCache type_cache;
+  std::unique_ptr<MetadataStore> metadata_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      std::move(metadata_source), std::move(transaction_executor),
+      &type_cache, &metadata_store));
+  TF_ASSERT_OK(metadata_store->InitMetadataStoreIfNotExists());
+  const int64 generation = type_cache.generation();
+
+  // The simple types are found, so they are not upserted again, which would
+  // invalidate the type cache.
+  TF_ASSERT_OK(metadata_store->InitMetadataStoreIfNotExists());
+  EXPECT_EQ(type_cache.generation(), generation);
+}
+
+TEST(MetadataStoreExtendedTest, UpgradeSchemaOnlineResumesFromCheckpoint) {
+  const MetadataSourceQueryConfig& query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "test_online_migration.db");
+  SqliteMetadataSourceConfig connection_config;
+  connection_config.set_filename_uri(filename_uri);
+  constexpr int kNumArtifacts = 5;
+  {
+    std::unique_ptr<MetadataStore> metadata_store;
+    auto metadata_source =
+        absl::make_unique<SqliteMetadataSource>(connection_config);
+    auto transaction_executor =
+        absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+    TF_ASSERT_OK(MetadataStore::Create(
+        query_config, {}, std::move(metadata_source),
+        std::move(transaction_executor), &metadata_store));
+    TF_ASSERT_OK(metadata_store->InitMetadataStore());
+    PutArtifactTypeRequest put_type_request;
+    put_type_request.mutable_artifact_type()->set_name("test_type");
+    PutArtifactTypeResponse put_type_response;
+    TF_ASSERT_OK(
+        metadata_store->PutArtifactType(put_type_request, &put_type_response));
+    PutArtifactsRequest put_artifacts_request;
+    for (int i = 0; i < kNumArtifacts; i++) {
+      put_artifacts_request.add_artifacts()->set_type_id(
+          put_type_response.type_id());
+    }
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(metadata_store->PutArtifacts(put_artifacts_request,
+                                              &put_artifacts_response));
+  }
+
+  // A newer library backfills a new column of the artifacts, two ids at a
+  // time.
+  MetadataSourceQueryConfig newer_query_config = query_config;
+  const int64 newer_version = query_config.schema_version() + 1;
+  newer_query_config.set_schema_version(newer_version);
+  MetadataSourceQueryConfig::MigrationScheme& scheme =
+      (*newer_query_config.mutable_migration_schemes())[newer_version];
+  scheme.add_upgrade_queries()->set_query(
+      "ALTER TABLE `Artifact` ADD COLUMN `backfilled` INT;");
+  MetadataSourceQueryConfig::MigrationScheme::ChunkedQuery* chunked_query =
+      scheme.add_chunked_upgrade_queries();
+  chunked_query->mutable_select_max_id()->set_query(
+      "SELECT MAX(`id`) FROM `Artifact`;");
+  chunked_query->mutable_query()->set_query(
+      "UPDATE `Artifact` SET `backfilled` = 1 WHERE `id` >= $0 AND `id` < $1;");
+  chunked_query->mutable_query()->set_parameter_num(2);
+  chunked_query->set_chunk_size(2);
+
+  std::unique_ptr<MetadataStore> metadata_store;
+  auto metadata_source =
+      absl::make_unique<SqliteMetadataSource>(connection_config);
+  SqliteMetadataSource* raw_metadata_source = metadata_source.get();
+  auto transaction_executor =
+      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  TF_ASSERT_OK(MetadataStore::Create(
+      newer_query_config, {}, std::move(metadata_source),
+      std::move(transaction_executor), &metadata_store));
+  const auto query_single_value = [raw_metadata_source](
+                                      const std::string& query) {
+    RecordSet record_set;
+    CHECK_EQ(absl::OkStatus(), raw_metadata_source->Begin());
+    CHECK_EQ(absl::OkStatus(),
+             raw_metadata_source->ExecuteQuery(query, &record_set));
+    CHECK_EQ(absl::OkStatus(), raw_metadata_source->Commit());
+    return record_set.records(0).values(0);
+  };
+
+  // The migration stops after the transaction of the first chunk, with the
+  // ids before 2 backfilled.
+  OnlineMigrationOptions options;
+  options.set_max_chunks_per_transaction(1);
+  int num_transactions = 0;
+  tensorflow::Status status = metadata_store->UpgradeSchemaOnline(
+      options,
+      [&num_transactions](const SchemaMigrationProgress& progress) {
+        EXPECT_FALSE(progress.done());
+        if (++num_transactions == 2) {
+          return tensorflow::errors::Cancelled("stopped");
+        }
+        return tensorflow::Status::OK();
+      });
+  EXPECT_EQ(status.code(), tensorflow::error::CANCELLED);
+  EXPECT_EQ(query_single_value(
+                "SELECT COUNT(*) FROM `Artifact` WHERE `backfilled` = 1;"),
+            "1");
+  EXPECT_EQ(query_single_value("SELECT `schema_version` FROM `MLMDEnv`;"),
+            absl::StrCat(query_config.schema_version()));
+
+  // The next migration resumes from the checkpoint without backfilling the
+  // chunks again.
+  std::vector<SchemaMigrationProgress> progresses;
+  TF_ASSERT_OK(metadata_store->UpgradeSchemaOnline(
+      options, [&progresses](const SchemaMigrationProgress& progress) {
+        progresses.push_back(progress);
+        return tensorflow::Status::OK();
+      }));
+  ASSERT_THAT(progresses, SizeIs(2));
+  EXPECT_EQ(progresses.front().next_id(), 4);
+  EXPECT_TRUE(progresses.back().done());
+  EXPECT_EQ(query_single_value(
+                "SELECT COUNT(*) FROM `Artifact` WHERE `backfilled` = 1;"),
+            absl::StrCat(kNumArtifacts));
+  EXPECT_EQ(query_single_value("SELECT `schema_version` FROM `MLMDEnv`;"),
+            absl::StrCat(newer_version));
+  TF_ASSERT_OK(metadata_store->InitMetadataStoreIfNotExists());
+  metadata_store.reset();
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
+}
+
+TEST(MetadataStoreExtendedTest, RetriedPutWithIdempotencyKeyWritesOnce) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  ConnectionConfig::IdempotencyOptions idempotency_options;
+  idempotency_options.set_ttl_seconds(3600);
+  TF_ASSERT_OK(metadata_store->EnableIdempotencyKeys(idempotency_options));
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store->PutArtifactType(put_type_request, &put_type_response));
+
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_type_response.type_id());
+  put_artifacts_request.set_idempotency_key("request-1");
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store->PutArtifacts(put_artifacts_request,
+                                            &put_artifacts_response));
+  ASSERT_THAT(put_artifacts_response.artifact_ids(), SizeIs(1));
+
+  // The retry returns the recorded response without creating an artifact.
+  PutArtifactsResponse retry_response;
+  TF_ASSERT_OK(
+      metadata_store->PutArtifacts(put_artifacts_request, &retry_response));
+  EXPECT_THAT(retry_response, EqualsProto(put_artifacts_response));
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store->GetArtifacts({}, &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+
+  // The key cannot be reused by a different request.
+  put_artifacts_request.mutable_artifacts(0)->set_uri("other_uri");
+  EXPECT_EQ(
+      metadata_store->PutArtifacts(put_artifacts_request, &retry_response)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+
+  // The expired keys are deleted, after which the key runs the request again.
+  int64 num_deleted = 0;
+  TF_ASSERT_OK(metadata_store->DeleteExpiredIdempotencyKeys(
+      absl::Now() + absl::Hours(2), /*max_batch_size=*/10, &num_deleted));
+  EXPECT_EQ(num_deleted, 1);
+  TF_ASSERT_OK(
+      metadata_store->PutArtifacts(put_artifacts_request, &retry_response));
+  EXPECT_NE(retry_response.artifact_ids(0),
+            put_artifacts_response.artifact_ids(0));
+}
+
+TEST(MetadataStoreExtendedTest, GetLineageClosureOfBackfilledAndNewEvents) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  GetLineageClosureResponse get_closure_response;
+  EXPECT_EQ(
+      metadata_store->GetLineageClosure({}, &get_closure_response).code(),
+      tensorflow::error::FAILED_PRECONDITION);
+  PutTypesRequest put_types_request;
+  put_types_request.add_artifact_types()->set_name("artifact_type");
+  put_types_request.add_execution_types()->set_name("execution_type");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store->PutTypes(put_types_request, &put_types_response));
+  // Puts an execution reading the artifact `input_id`, if it is not -1, and
+  // writing a new artifact, whose id is returned.
+  const auto put_execution = [&](const int64 input_id) {
+    PutExecutionRequest request;
+    request.mutable_execution()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    if (input_id != -1) {
+      PutExecutionRequest::ArtifactAndEvent* input =
+          request.add_artifact_event_pairs();
+      input->mutable_artifact()->set_id(input_id);
+      input->mutable_artifact()->set_type_id(
+          put_types_response.artifact_type_ids(0));
+      input->mutable_event()->set_type(Event::INPUT);
+    }
+    PutExecutionRequest::ArtifactAndEvent* output =
+        request.add_artifact_event_pairs();
+    output->mutable_artifact()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+    output->mutable_event()->set_type(Event::OUTPUT);
+    PutExecutionResponse response;
+    CHECK_EQ(tensorflow::Status::OK(),
+             metadata_store->PutExecution(request, &response));
+    return response.artifact_ids(response.artifact_ids_size() - 1);
+  };
+  const int64 a1 = put_execution(-1);
+  const int64 a2 = put_execution(a1);
+
+  // The closure of the events written before is backfilled, and the closure
+  // of the new events is added with them.
+  TF_ASSERT_OK(metadata_store->EnableLineageClosure());
+  const int64 a3 = put_execution(a2);
+  const auto get_closure_ids =
+      [&](const int64 artifact_id,
+          const GetLineageGraphRequest::Direction direction) {
+        GetLineageClosureRequest request;
+        request.add_artifact_ids(artifact_id);
+        request.set_direction(direction);
+        GetLineageClosureResponse response;
+        CHECK_EQ(tensorflow::Status::OK(),
+                 metadata_store->GetLineageClosure(request, &response));
+        std::vector<int64> ids;
+        for (const Artifact& artifact : response.artifacts()) {
+          ids.push_back(artifact.id());
+        }
+        return ids;
+      };
+  EXPECT_THAT(get_closure_ids(a3, GetLineageGraphRequest::UPSTREAM),
+              ElementsAre(a1, a2));
+  EXPECT_THAT(get_closure_ids(a1, GetLineageGraphRequest::DOWNSTREAM),
+              ElementsAre(a2, a3));
+  EXPECT_THAT(get_closure_ids(a2, GetLineageGraphRequest::BOTH),
+              ElementsAre(a1, a3));
+}
+
+TEST(MetadataStoreExtendedTest, GetExecutionsByContextWithinResponseBudget) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  PutTypesRequest put_types_request;
+  put_types_request.add_execution_types()->set_name("execution_type");
+  put_types_request.add_context_types()->set_name("context_type");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store->PutTypes(put_types_request, &put_types_response));
+  PutContextsRequest put_contexts_request;
+  Context* context = put_contexts_request.add_contexts();
+  context->set_type_id(put_types_response.context_type_ids(0));
+  context->set_name("context");
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store->PutContexts(put_contexts_request,
+                                           &put_contexts_response));
+  PutExecutionsRequest put_executions_request;
+  for (int i = 0; i < 10; i++) {
+    Execution* execution = put_executions_request.add_executions();
+    execution->set_type_id(put_types_response.execution_type_ids(0));
+    (*execution->mutable_custom_properties())["payload"].set_string_value(
+        std::string(100, 'x'));
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store->PutExecutions(put_executions_request,
+                                             &put_executions_response));
+  PutAttributionsAndAssociationsRequest put_associations_request;
+  for (const int64 execution_id : put_executions_response.execution_ids()) {
+    Association* association = put_associations_request.add_associations();
+    association->set_context_id(put_contexts_response.context_ids(0));
+    association->set_execution_id(execution_id);
+  }
+  PutAttributionsAndAssociationsResponse put_associations_response;
+  TF_ASSERT_OK(metadata_store->PutAttributionsAndAssociations(
+      put_associations_request, &put_associations_response));
+
+  // Each response has a few executions, and the next ones are read
+  // with its token until the context is read.
+  metadata_store->SetMaxResponseBytes(350);
+  GetExecutionsByContextRequest request;
+  request.set_context_id(put_contexts_response.context_ids(0));
+  std::vector<int64> execution_ids;
+  int num_responses = 0;
+  while (true) {
+    GetExecutionsByContextResponse response;
+    TF_ASSERT_OK(metadata_store->GetExecutionsByContext(request, &response));
+    ASSERT_FALSE(response.executions().empty());
+    EXPECT_LT(response.executions_size(), 10);
+    num_responses++;
+    for (const Execution& execution : response.executions()) {
+      execution_ids.push_back(execution.id());
+    }
+    if (response.next_page_token().empty()) break;
+    request.mutable_options()->set_next_page_token(response.next_page_token());
+  }
+  EXPECT_GT(num_responses, 1);
+  EXPECT_THAT(execution_ids,
+              ::testing::ElementsAreArray(
+                  put_executions_response.execution_ids()));
+}
+
+TEST(MetadataStoreExtendedTest, RolledBackEdgesAreNotKnown) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  PutTypesRequest put_types_request;
+  put_types_request.add_artifact_types()->set_name("artifact_type");
+  put_types_request.add_context_types()->set_name("context_type");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store->PutArtifacts(put_artifacts_request,
+                                            &put_artifacts_response));
+  PutContextsRequest put_contexts_request;
+  put_contexts_request.add_contexts()->set_type_id(
+      put_types_response.context_type_ids(0));
+  put_contexts_request.mutable_contexts(0)->set_name("context");
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store->PutContexts(put_contexts_request,
+                                           &put_contexts_response));
+
+  // The attribution is rolled back with the association of the missing
+  // execution, so it is created again by the next put.
+  PutAttributionsAndAssociationsRequest put_edges_request;
+  Attribution* attribution = put_edges_request.add_attributions();
+  attribution->set_context_id(put_contexts_response.context_ids(0));
+  attribution->set_artifact_id(put_artifacts_response.artifact_ids(0));
+  Association* association = put_edges_request.add_associations();
+  association->set_context_id(put_contexts_response.context_ids(0));
+  association->set_execution_id(100);
+  PutAttributionsAndAssociationsResponse put_edges_response;
+  EXPECT_EQ(metadata_store
+                ->PutAttributionsAndAssociations(put_edges_request,
+                                                 &put_edges_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  put_edges_request.clear_associations();
+  TF_ASSERT_OK(metadata_store->PutAttributionsAndAssociations(
+      put_edges_request, &put_edges_response));
+  // The known attribution is skipped.
+  TF_ASSERT_OK(metadata_store->PutAttributionsAndAssociations(
+      put_edges_request, &put_edges_response));
+  GetArtifactsByContextRequest get_artifacts_request;
+  get_artifacts_request.set_context_id(put_contexts_response.context_ids(0));
+  GetArtifactsByContextResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store->GetArtifactsByContext(get_artifacts_request,
+                                                     &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+}
+
 
 }  // namespace
 
@@ -22,6 +22,7 @@ import (
 	"github.com/google/go-cmp/cmp"
 	"github.com/golang/protobuf/proto"
 	mdpb "ml_metadata/proto/metadata_store_go_proto"
+	apipb "ml_metadata/proto/metadata_store_service_go_proto"
 )
 
 func createConnectionConfig(textConfig string) *mdpb.ConnectionConfig {
@@ -1219,6 +1220,61 @@ func TestPutExecutionWithoutContext(t *testing.T) {
 	}
 }
 
+func TestPutInBatch(t *testing.T) {
+	store, err := NewStore(fakeDatabaseConfig())
+	if err != nil {
+		t.Fatalf("Cannot create Store: %v", err)
+	}
+	defer store.Close()
+	atid, err := insertArtifactType(store, `name: 'artifact_type_name' `)
+	if err != nil {
+		t.Fatalf("Cannot create artifact type: %v", err)
+	}
+	etid, err := insertExecutionType(store, `name: 'execution_type_name' `)
+	if err != nil {
+		t.Fatalf("Cannot create execution type: %v", err)
+	}
+	oet := mdpb.Event_Type(mdpb.Event_OUTPUT)
+	puts := []*BatchedPut{
+		{
+			PutExecutionRequest: &apipb.PutExecutionRequest{
+				Execution:          &mdpb.Execution{TypeId: &etid},
+				ArtifactEventPairs: []*apipb.PutExecutionRequest_ArtifactAndEvent{
+					{
+						Artifact: &mdpb.Artifact{TypeId: &atid},
+						Event:    &mdpb.Event{Type: &oet},
+					},
+				},
+			},
+		},
+		// The execution has no type, so that the call fails.
+		{PutExecutionRequest: &apipb.PutExecutionRequest{Execution: &mdpb.Execution{}}},
+		{PutEventsRequest: &apipb.PutEventsRequest{}},
+	}
+	// The batches reuse the buffers of the store.
+	for i := 0; i < 2; i++ {
+		if err := store.PutInBatch(puts); err != nil {
+			t.Fatalf("PutInBatch failed: %v", err)
+		}
+		if puts[0].Err != nil || len(puts[0].PutExecutionResponse.GetArtifactIds()) != 1 {
+			t.Errorf("PutInBatch PutExecution result mismatch, got: %v, %v", puts[0].PutExecutionResponse, puts[0].Err)
+		}
+		if puts[1].Err == nil {
+			t.Errorf("PutInBatch PutExecution without a type should fail")
+		}
+		if puts[2].Err != nil || puts[2].PutEventsResponse == nil {
+			t.Errorf("PutInBatch PutEvents result mismatch, got: %v, %v", puts[2].PutEventsResponse, puts[2].Err)
+		}
+	}
+	gotExecutions, err := store.GetExecutions()
+	if err != nil {
+		t.Fatalf("GetExecutions failed: %v", err)
+	}
+	if len(gotExecutions) != 2 {
+		t.Errorf("GetExecutions number of executions mismatch, want: %v, got: %v", 2, len(gotExecutions))
+	}
+}
+
 func TestPutExecutionWithContext(t *testing.T) {
 	store, err := NewStore(fakeDatabaseConfig())
 	if err != nil {
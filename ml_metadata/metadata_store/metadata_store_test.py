@@ -13,6 +13,7 @@
 # limitations under the License.
 """Tests for ml_metadata.MetadataStore."""
 
+import asyncio
 import collections
 import os
 import uuid
@@ -122,6 +123,24 @@ class MetadataStoreTest(parameterized.TestCase):
     store = mlmd.MetadataStore(connection_config)
     self.assertEqual(store._max_num_retries, want_num_retries)
 
+  def test_hedged_reads(self):
+    # Skip the test if it is not using grpc backend.
+    if not FLAGS.use_grpc_backend:
+      return
+    grpc_connection_config = metadata_store_pb2.MetadataStoreClientConfig(
+        host=FLAGS.grpc_host, port=FLAGS.grpc_port)
+    # Each read is hedged to the same server on a second channel.
+    grpc_connection_config.hedging_config.delay_sec = 0
+    grpc_connection_config.hedging_config.max_hedge_ratio = 1
+    store = mlmd.MetadataStore(grpc_connection_config)
+    artifact_type_id = store.put_artifact_type(
+        _create_example_artifact_type(self._get_test_type_name()))
+    for _ in range(3):
+      [artifact_type] = store.get_artifact_types_by_id([artifact_type_id])
+      self.assertEqual(artifact_type.id, artifact_type_id)
+    with self.assertRaises(errors.NotFoundError):
+      store.get_artifact_type(self._get_test_type_name())
+
   def test_connection_config_with_grpc_max_receive_message_length(self):
     # The test is irrelevant when not using grpc connection.
     if not FLAGS.use_grpc_backend:
@@ -1169,6 +1188,92 @@ class MetadataStoreTest(parameterized.TestCase):
     artifacts_by_context = store.get_artifacts_by_context(context_ids[0])
     self.assertLen(artifacts_by_context, 2)
 
+  def test_put_executions_in_batch(self):
+    store = _get_metadata_store()
+    execution_type = metadata_store_pb2.ExecutionType(
+        name=self._get_test_type_name())
+    execution_type_id = store.put_execution_type(execution_type)
+    artifact_type = metadata_store_pb2.ArtifactType(
+        name=self._get_test_type_name())
+    artifact_type_id = store.put_artifact_type(artifact_type)
+    context_type = metadata_store_pb2.ContextType(
+        name=self._get_test_type_name())
+    context_type_id = store.put_context_type(context_type)
+    context = metadata_store_pb2.Context(
+        type_id=context_type_id, name=self._get_test_type_name())
+
+    results = store.put_executions_in_batch(
+        [(metadata_store_pb2.Execution(type_id=execution_type_id),
+          [[metadata_store_pb2.Artifact(type_id=artifact_type_id)]],
+          [context]) for _ in range(3)],
+        reuse_context_if_already_exist=True)
+
+    self.assertLen(results, 3)
+    execution_ids = [execution_id for execution_id, _, _ in results]
+    self.assertLen(set(execution_ids), 3)
+    self.assertLen(store.get_executions_by_id(execution_ids), 3)
+    # The executions share the context reused by the later calls.
+    self.assertLen(set(context_ids[0] for _, _, context_ids in results), 1)
+    self.assertLen(store.get_executions_by_context(results[0][2][0]), 3)
+
+  def test_put_executions_in_batch_raises_first_error(self):
+    store = _get_metadata_store()
+    execution_type = metadata_store_pb2.ExecutionType(
+        name=self._get_test_type_name())
+    execution_type_id = store.put_execution_type(execution_type)
+
+    with self.assertRaises(errors.InvalidArgumentError):
+      store.put_executions_in_batch([
+          (metadata_store_pb2.Execution(type_id=execution_type_id), [], []),
+          (metadata_store_pb2.Execution(), [], []),
+      ])
+    # The call which succeeded is still committed.
+    self.assertLen(store.get_executions_by_type(execution_type.name), 1)
+
+  def test_async_metadata_store(self):
+    if FLAGS.use_grpc_backend:
+      return
+    connection_config = metadata_store_pb2.ConnectionConfig()
+    connection_config.sqlite.SetInParent()
+    store = mlmd.AsyncMetadataStore(connection_config, num_threads=4)
+
+    async def put_and_get():
+      with self.assertRaises(errors.NotFoundError):
+        await store.get_artifact_type(self._get_test_type_name())
+      # The simple types are stored when the schema is initialized.
+      artifact_type = await store.get_artifact_type("mlmd.Dataset")
+      artifact_ids = await store.put_artifacts(
+          [metadata_store_pb2.Artifact(type_id=artifact_type.id)])
+      self.assertLen(artifact_ids, 1)
+      return await asyncio.gather(*(store.get_artifacts_by_id(artifact_ids)
+                                    for _ in range(10)))
+
+    results = asyncio.get_event_loop().run_until_complete(put_and_get())
+    self.assertLen(results, 10)
+    for artifacts in results:
+      self.assertLen(artifacts, 1)
+
+  def test_write_behind_metadata_store(self):
+    if FLAGS.use_grpc_backend:
+      return
+    connection_config = metadata_store_pb2.ConnectionConfig()
+    connection_config.sqlite.filename_uri = os.path.join(
+        absltest.get_default_test_tmpdir(), str(uuid.uuid4()))
+    directory = os.path.join(absltest.get_default_test_tmpdir(),
+                             str(uuid.uuid4()))
+    store = mlmd.MetadataStore(connection_config)
+    execution_type_id = store.put_execution_type(
+        metadata_store_pb2.ExecutionType(name=self._get_test_type_name()))
+    queue = mlmd.WriteBehindMetadataStore(connection_config, directory)
+
+    for _ in range(3):
+      queue.put_execution(
+          metadata_store_pb2.Execution(type_id=execution_type_id), [], [])
+    queue.put_execution(metadata_store_pb2.Execution(), [], [])
+    queue.flush()
+    self.assertEqual(queue.get_stats(), (0, 3, 1))
+    self.assertLen(store.get_executions(), 3)
+
   def test_get_executions_by_context_with_pagination(self):
     store = _get_metadata_store()
     execution_type = metadata_store_pb2.ExecutionType(
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -39,6 +41,7 @@ using ::testing::IsEmpty;
 using ::testing::Pointwise;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 
 // A list of test utils for inserting types and nodes.
 template <typename T>
@@ -1246,6 +1249,242 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsByID) {
   }
 }
 
+TEST_P(MetadataStoreTestSuite, GetArtifactsWithPropertyOptions) {
+  const PutArtifactTypeRequest put_artifact_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(
+          R"(
+            all_fields_match: true
+            artifact_type: {
+              name: 'test_type'
+              properties { key: 'property_1' value: STRING }
+              properties { key: 'property_2' value: STRING }
+            }
+          )");
+  PutArtifactTypeResponse put_artifact_type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(put_artifact_type_request,
+                                                &put_artifact_type_response));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    properties {
+      key: 'property_1'
+      value: { string_value: '1' }
+    }
+    properties {
+      key: 'property_2'
+      value: { string_value: '2' }
+    }
+    custom_properties {
+      key: 'custom_property'
+      value: { string_value: '3' }
+    }
+  )");
+  artifact.set_type_id(put_artifact_type_response.type_id());
+  {
+    PutArtifactsRequest put_artifacts_request;
+    *put_artifacts_request.add_artifacts() = artifact;
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                               &put_artifacts_response));
+    artifact.set_id(put_artifacts_response.artifact_ids(0));
+  }
+  Artifact want_artifact_without_properties = artifact;
+  want_artifact_without_properties.clear_properties();
+  want_artifact_without_properties.clear_custom_properties();
+
+  // Test: the properties are skipped by id.
+  {
+    GetArtifactsByIDRequest request;
+    request.add_artifact_ids(artifact.id());
+    request.mutable_property_options()->set_skip_properties(true);
+    GetArtifactsByIDResponse response;
+    TF_ASSERT_OK(metadata_store_->GetArtifactsByID(request, &response));
+    EXPECT_THAT(response.artifacts(),
+                ElementsAre(EqualsProto(
+                    want_artifact_without_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  // Test: the properties are skipped for all the artifacts.
+  {
+    GetArtifactsRequest request;
+    request.mutable_property_options()->set_skip_properties(true);
+    GetArtifactsResponse response;
+    TF_ASSERT_OK(metadata_store_->GetArtifacts(request, &response));
+    EXPECT_THAT(response.artifacts(),
+                ElementsAre(EqualsProto(
+                    want_artifact_without_properties,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+  // Test: only the selected properties are returned by type.
+  {
+    GetArtifactsByTypeRequest request;
+    request.set_type_name("test_type");
+    request.mutable_property_options()->add_property_names("property_2");
+    GetArtifactsByTypeResponse response;
+    TF_ASSERT_OK(metadata_store_->GetArtifactsByType(request, &response));
+    Artifact want_artifact = want_artifact_without_properties;
+    (*want_artifact.mutable_properties())["property_2"] =
+        artifact.properties().at("property_2");
+    EXPECT_THAT(response.artifacts(),
+                ElementsAre(EqualsProto(
+                    want_artifact,
+                    /*ignore_fields=*/{"create_time_since_epoch",
+                                       "last_update_time_since_epoch"})));
+  }
+}
+
+TEST_P(MetadataStoreTestSuite, CountArtifactsAndArtifactsExist) {
+  const PutArtifactTypeRequest put_artifact_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(
+          R"(
+            all_fields_match: true
+            artifact_type: { name: 'test_type' }
+          )");
+  PutArtifactTypeResponse put_artifact_type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(put_artifact_type_request,
+                                                &put_artifact_type_response));
+  PutArtifactsRequest put_artifacts_request =
+      ParseTextProtoOrDie<PutArtifactsRequest>(R"(
+        artifacts: { uri: 'testuri://testing/uri1' state: LIVE }
+        artifacts: { uri: 'testuri://testing/uri2' state: DELETED }
+      )");
+  for (Artifact& artifact : *put_artifacts_request.mutable_artifacts()) {
+    artifact.set_type_id(put_artifact_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  // Test: the artifacts are counted by type and state.
+  {
+    CountArtifactsRequest request;
+    request.set_type_name("test_type");
+    CountArtifactsResponse response;
+    TF_ASSERT_OK(metadata_store_->CountArtifacts(request, &response));
+    EXPECT_EQ(response.count(), 2);
+    request.set_state(Artifact::LIVE);
+    TF_ASSERT_OK(metadata_store_->CountArtifacts(request, &response));
+    EXPECT_EQ(response.count(), 1);
+  }
+  // Test: the count is 0 for an unknown type.
+  {
+    CountArtifactsRequest request;
+    request.set_type_name("unknown_type");
+    CountArtifactsResponse response;
+    TF_ASSERT_OK(metadata_store_->CountArtifacts(request, &response));
+    EXPECT_TRUE(response.has_count());
+    EXPECT_EQ(response.count(), 0);
+  }
+  // Test: the executions and contexts are counted.
+  {
+    CountExecutionsResponse executions_response;
+    TF_ASSERT_OK(metadata_store_->CountExecutions(CountExecutionsRequest(),
+                                                  &executions_response));
+    EXPECT_EQ(executions_response.count(), 0);
+    CountContextsResponse contexts_response;
+    TF_ASSERT_OK(metadata_store_->CountContexts(CountContextsRequest(),
+                                                &contexts_response));
+    EXPECT_EQ(contexts_response.count(), 0);
+  }
+  // Test: a flag is returned for each of the ids.
+  {
+    ArtifactsExistRequest request;
+    request.add_artifact_ids(put_artifacts_response.artifact_ids(1));
+    request.add_artifact_ids(put_artifacts_response.artifact_ids(1) + 100);
+    request.add_artifact_ids(put_artifacts_response.artifact_ids(0));
+    ArtifactsExistResponse response;
+    TF_ASSERT_OK(metadata_store_->ArtifactsExist(request, &response));
+    EXPECT_THAT(response.exists(), ElementsAre(true, false, true));
+  }
+}
+
+TEST_P(MetadataStoreTestSuite, AggregateProperty) {
+  const PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(
+          R"(
+            all_fields_match: true
+            execution_type: {
+              name: 'trainer'
+              properties { key: 'accuracy' value: DOUBLE }
+            }
+          )");
+  PutExecutionTypeResponse put_execution_type_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutionType(
+      put_execution_type_request, &put_execution_type_response));
+  PutExecutionsRequest put_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: {
+          last_known_state: FAILED
+          properties {
+            key: 'accuracy'
+            value: { double_value: 0.25 }
+          }
+        }
+        executions: {
+          last_known_state: COMPLETE
+          properties {
+            key: 'accuracy'
+            value: { double_value: 0.75 }
+          }
+        }
+      )");
+  for (Execution& execution : *put_executions_request.mutable_executions()) {
+    execution.set_type_id(put_execution_type_response.type_id());
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+
+  // Test: the aggregates are grouped and ordered by state.
+  {
+    AggregatePropertyRequest request =
+        ParseTextProtoOrDie<AggregatePropertyRequest>(R"(
+          node_kind: EXECUTION
+          type_name: 'trainer'
+          options { property_name: 'accuracy' group_by_state: true }
+        )");
+    AggregatePropertyResponse response;
+    TF_ASSERT_OK(metadata_store_->AggregateProperty(request, &response));
+    PropertyAggregate want_complete = ParseTextProtoOrDie<PropertyAggregate>(R"(
+      num_nodes: 1
+      num_values: 1
+      min_value: 0.75
+      max_value: 0.75
+      avg_value: 0.75
+    )");
+    want_complete.set_state(Execution::COMPLETE);
+    PropertyAggregate want_failed = ParseTextProtoOrDie<PropertyAggregate>(R"(
+      num_nodes: 1
+      num_values: 1
+      min_value: 0.25
+      max_value: 0.25
+      avg_value: 0.25
+    )");
+    want_failed.set_state(Execution::FAILED);
+    EXPECT_THAT(response.aggregates(),
+                ElementsAre(EqualsProto(want_complete),
+                            EqualsProto(want_failed)));
+  }
+  // Test: an unknown type returns an empty response.
+  {
+    AggregatePropertyRequest request;
+    request.set_node_kind(AggregatePropertyRequest::EXECUTION);
+    request.set_type_name("unknown_type");
+    AggregatePropertyResponse response;
+    TF_ASSERT_OK(metadata_store_->AggregateProperty(request, &response));
+    EXPECT_THAT(response.aggregates(), IsEmpty());
+  }
+  // Test: the node_kind is required.
+  {
+    AggregatePropertyRequest request;
+    request.set_type_name("trainer");
+    AggregatePropertyResponse response;
+    EXPECT_EQ(metadata_store_->AggregateProperty(request, &response).code(),
+              tensorflow::error::INVALID_ARGUMENT);
+  }
+}
+
 // Test creating an artifact and then updating one of its properties.
 TEST_P(MetadataStoreTestSuite, PutArtifactsUpdateGetArtifactsByID) {
   const PutArtifactTypeRequest put_artifact_type_request =
@@ -1384,6 +1623,385 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsWithListOptions) {
                                              "last_update_time_since_epoch"}));
 }
 
+// Test: StreamArtifacts returns all artifacts in chunks of max_chunk_size.
+// Execution: Put three artifacts, then stream them in chunks of two.
+// Expectation: the chunks have two artifacts and one artifact, and a callback
+// error aborts the stream.
+TEST_P(MetadataStoreTestSuite, PutArtifactsStreamArtifacts) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  StreamArtifactsRequest stream_request;
+  stream_request.set_max_chunk_size(2);
+  std::vector<int> chunk_sizes;
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(metadata_store_->StreamArtifacts(
+      stream_request, [&](const StreamArtifactsResponse& response) {
+        chunk_sizes.push_back(response.artifacts_size());
+        for (const Artifact& artifact : response.artifacts()) {
+          artifact_ids.push_back(artifact.id());
+        }
+        return tensorflow::Status::OK();
+      }));
+  EXPECT_THAT(chunk_sizes, ElementsAre(2, 1));
+  EXPECT_THAT(artifact_ids, UnorderedElementsAreArray(
+                                put_artifacts_response.artifact_ids()));
+
+  int num_chunks = 0;
+  EXPECT_TRUE(tensorflow::errors::IsCancelled(metadata_store_->StreamArtifacts(
+      stream_request, [&num_chunks](const StreamArtifactsResponse& response) {
+        num_chunks++;
+        return tensorflow::errors::Cancelled("stop");
+      })));
+  EXPECT_EQ(num_chunks, 1);
+}
+
+// Test: WatchChanges streams the changed nodes in chunks with watermarks.
+// Execution: Put three executions, watch them in chunks of two, then resume
+// from the watermark of the first chunk.
+// Expectation: each chunk carries the watermark of its last execution, and the
+// resumed watch returns the executions after it.
+TEST_P(MetadataStoreTestSuite, PutExecutionsWatchChanges) {
+  PutExecutionTypeRequest put_type_request;
+  put_type_request.mutable_execution_type()->set_name("test_type");
+  PutExecutionTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutExecutionType(put_type_request, &put_type_response));
+  PutExecutionsRequest put_executions_request;
+  for (int i = 0; i < 3; i++) {
+    put_executions_request.add_executions()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+
+  WatchChangesRequest watch_request;
+  watch_request.set_node_kind(WatchChangesRequest::EXECUTION);
+  watch_request.set_max_chunk_size(2);
+  std::vector<WatchChangesResponse> chunks;
+  TF_ASSERT_OK(metadata_store_->WatchChanges(
+      watch_request, [&chunks](const WatchChangesResponse& response) {
+        chunks.push_back(response);
+        return tensorflow::Status::OK();
+      }));
+  ASSERT_THAT(chunks, SizeIs(2));
+  std::vector<int64> execution_ids;
+  for (const WatchChangesResponse& chunk : chunks) {
+    EXPECT_THAT(chunk.artifacts(), IsEmpty());
+    ASSERT_GT(chunk.executions_size(), 0);
+    const Execution& last = chunk.executions(chunk.executions_size() - 1);
+    EXPECT_EQ(chunk.watermark().last_update_time_since_epoch(),
+              last.last_update_time_since_epoch());
+    EXPECT_EQ(chunk.watermark().id(), last.id());
+    for (const Execution& execution : chunk.executions()) {
+      execution_ids.push_back(execution.id());
+    }
+  }
+  EXPECT_THAT(chunks[0].executions(), SizeIs(2));
+  EXPECT_THAT(execution_ids, UnorderedElementsAreArray(
+                                 put_executions_response.execution_ids()));
+
+  *watch_request.mutable_watermark() = chunks[0].watermark();
+  std::vector<int64> resumed_ids;
+  TF_ASSERT_OK(metadata_store_->WatchChanges(
+      watch_request, [&resumed_ids](const WatchChangesResponse& response) {
+        for (const Execution& execution : response.executions()) {
+          resumed_ids.push_back(execution.id());
+        }
+        return tensorflow::Status::OK();
+      }));
+  EXPECT_THAT(resumed_ids, ElementsAre(execution_ids[2]));
+
+  *watch_request.mutable_watermark() = chunks[1].watermark();
+  int num_chunks = 0;
+  TF_ASSERT_OK(metadata_store_->WatchChanges(
+      watch_request, [&num_chunks](const WatchChangesResponse& response) {
+        num_chunks++;
+        return tensorflow::Status::OK();
+      }));
+  EXPECT_EQ(num_chunks, 0);
+
+  watch_request.clear_node_kind();
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(
+      metadata_store_->WatchChanges(
+          watch_request, [](const WatchChangesResponse& response) {
+            return tensorflow::Status::OK();
+          })));
+}
+
+// Test: StreamNodeColumns streams the artifacts as columns.
+// Execution: Put three artifacts with a property and a custom property of
+// two kinds, and stream their columns in a chunk.
+// Expectation: the chunk has an entry per artifact in each column, and a
+// property column per property and kind of value, unset for the artifacts
+// without the value.
+TEST_P(MetadataStoreTestSuite, PutArtifactsStreamNodeColumns) {
+  PutArtifactTypeRequest put_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        artifact_type: {
+          name: 'test_type'
+          properties { key: 'p' value: INT }
+        }
+      )");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_type_response.type_id());
+    artifact->set_uri(absl::StrCat("uri_", i));
+  }
+  (*put_artifacts_request.mutable_artifacts(0)->mutable_properties())["p"]
+      .set_int_value(1);
+  (*put_artifacts_request.mutable_artifacts(1)
+        ->mutable_custom_properties())["c"]
+      .set_string_value("x");
+  (*put_artifacts_request.mutable_artifacts(2)
+        ->mutable_custom_properties())["c"]
+      .set_int_value(5);
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  StreamNodeColumnsRequest stream_request;
+  stream_request.set_node_kind(WatchChangesRequest::ARTIFACT);
+  std::vector<StreamNodeColumnsResponse> chunks;
+  TF_ASSERT_OK(metadata_store_->StreamNodeColumns(
+      stream_request, [&chunks](const StreamNodeColumnsResponse& response) {
+        chunks.push_back(response);
+        return tensorflow::Status::OK();
+      }));
+  ASSERT_THAT(chunks, SizeIs(1));
+  const StreamNodeColumnsResponse& chunk = chunks[0];
+  EXPECT_THAT(chunk.ids(), UnorderedElementsAreArray(
+                               put_artifacts_response.artifact_ids()));
+  EXPECT_THAT(chunk.uris(), SizeIs(3));
+  EXPECT_THAT(chunk.states(), SizeIs(3));
+  // The row of the i-th artifact put.
+  const auto row = [&](const int i) {
+    return absl::c_find(chunk.ids(), put_artifacts_response.artifact_ids(i)) -
+           chunk.ids().begin();
+  };
+  EXPECT_EQ(chunk.uris(row(1)), "uri_1");
+  ASSERT_THAT(chunk.properties(), SizeIs(3));
+  for (const PropertyColumn& column : chunk.properties()) {
+    ASSERT_THAT(column.is_set(), SizeIs(3));
+    if (column.name() == "p") {
+      EXPECT_FALSE(column.is_custom_property());
+      EXPECT_EQ(column.data_type(), PropertyType::INT);
+      EXPECT_TRUE(column.is_set(row(0)));
+      EXPECT_FALSE(column.is_set(row(1)));
+      EXPECT_EQ(column.int_values(row(0)), 1);
+    } else if (column.data_type() == PropertyType::STRING) {
+      EXPECT_TRUE(column.is_custom_property());
+      EXPECT_TRUE(column.is_set(row(1)));
+      EXPECT_FALSE(column.is_set(row(2)));
+      EXPECT_EQ(column.string_values(row(1)), "x");
+    } else {
+      EXPECT_EQ(column.name(), "c");
+      EXPECT_EQ(column.data_type(), PropertyType::INT);
+      EXPECT_TRUE(column.is_set(row(2)));
+      EXPECT_FALSE(column.is_set(row(0)));
+      EXPECT_EQ(column.int_values(row(2)), 5);
+    }
+  }
+
+  // The properties are skipped with the property options.
+  stream_request.mutable_property_options()->set_skip_properties(true);
+  stream_request.set_max_chunk_size(2);
+  chunks.clear();
+  TF_ASSERT_OK(metadata_store_->StreamNodeColumns(
+      stream_request, [&chunks](const StreamNodeColumnsResponse& response) {
+        chunks.push_back(response);
+        return tensorflow::Status::OK();
+      }));
+  ASSERT_THAT(chunks, SizeIs(2));
+  EXPECT_THAT(chunks[0].ids(), SizeIs(2));
+  EXPECT_THAT(chunks[0].properties(), IsEmpty());
+  EXPECT_THAT(chunks[1].ids(), SizeIs(1));
+}
+
+TEST_P(MetadataStoreTestSuite, PutArtifactsDeleteArtifactsInBatches) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 5; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  DeleteArtifactsRequest delete_request;
+  for (int i = 0; i < 4; i++) {
+    delete_request.add_artifact_ids(put_artifacts_response.artifact_ids(i));
+  }
+  delete_request.set_max_batch_size(3);
+  DeleteArtifactsResponse delete_response;
+  TF_ASSERT_OK(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response));
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(4));
+}
+
+TEST_P(MetadataStoreTestSuite, PutExecutionsCollectGarbage) {
+  PutTypesRequest put_types_request = ParseTextProtoOrDie<PutTypesRequest>(R"(
+    execution_types: { name: 'expiring_type' }
+    execution_types: { name: 'kept_type' }
+  )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutExecutionsRequest put_executions_request;
+  for (const int64 type_id : {put_types_response.execution_type_ids(0),
+                              put_types_response.execution_type_ids(0),
+                              put_types_response.execution_type_ids(0),
+                              put_types_response.execution_type_ids(1)}) {
+    put_executions_request.add_executions()->set_type_id(type_id);
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+
+  CollectGarbageRequest collect_request;
+  collect_request.set_node_kind(CollectGarbageRequest::EXECUTION);
+  collect_request.set_type_name("expiring_type");
+  collect_request.set_max_batch_size(2);
+  CollectGarbageResponse collect_response;
+  // The executions are not updated before their creation.
+  TF_ASSERT_OK(
+      metadata_store_->CollectGarbage(collect_request, &collect_response));
+  EXPECT_EQ(collect_response.num_deleted(), 0);
+
+  collect_request.set_updated_before_time_since_epoch(
+      absl::ToUnixMillis(absl::Now() + absl::Hours(1)));
+  TF_ASSERT_OK(
+      metadata_store_->CollectGarbage(collect_request, &collect_response));
+  EXPECT_EQ(collect_response.num_deleted(), 3);
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(metadata_store_->GetExecutions({}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_response.executions(0).id(),
+            put_executions_response.execution_ids(3));
+
+  // An unknown type has no garbage.
+  collect_request.set_type_name("unknown_type");
+  TF_ASSERT_OK(
+      metadata_store_->CollectGarbage(collect_request, &collect_response));
+  EXPECT_EQ(collect_response.num_deleted(), 0);
+
+  collect_request.clear_node_kind();
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(
+      metadata_store_->CollectGarbage(collect_request, &collect_response)));
+}
+
+TEST_P(MetadataStoreTestSuite, PutArtifactsCreateAndUpdateInOrder) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifactType(put_type_request, &put_type_response));
+  const int64 type_id = put_type_response.type_id();
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(type_id);
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const int64 existing_artifact_id = put_artifacts_response.artifact_ids(0);
+
+  // The new artifacts before and after the updated one are created in batches,
+  // and the ids are returned in the order of the request.
+  put_artifacts_request.Clear();
+  for (const std::string& uri : {"a", "b", "updated", "c"}) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(type_id);
+    artifact->set_uri(uri);
+  }
+  put_artifacts_request.mutable_artifacts(2)->set_id(existing_artifact_id);
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  ASSERT_THAT(put_artifacts_response.artifact_ids(), SizeIs(4));
+  EXPECT_EQ(put_artifacts_response.artifact_ids(2), existing_artifact_id);
+
+  GetArtifactsByIDRequest get_artifacts_request;
+  *get_artifacts_request.mutable_artifact_ids() =
+      put_artifacts_response.artifact_ids();
+  GetArtifactsByIDResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(4));
+  for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+    for (int i = 0; i < 4; i++) {
+      if (put_artifacts_response.artifact_ids(i) == artifact.id()) {
+        EXPECT_EQ(artifact.uri(), put_artifacts_request.artifacts(i).uri());
+      }
+    }
+  }
+}
+
+TEST_P(MetadataStoreTestSuite, PutArtifactsUpdateSameArtifactTwice) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_type_response.type_id());
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const int64 artifact_id = put_artifacts_response.artifact_ids(0);
+
+  // The later update of the same artifact in a request wins.
+  put_artifacts_request.Clear();
+  for (const std::string& uri : {"first", "second"}) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_id(artifact_id);
+    artifact->set_type_id(put_type_response.type_id());
+    artifact->set_uri(uri);
+    (*artifact->mutable_custom_properties())["uri"].set_string_value(uri);
+  }
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  EXPECT_THAT(put_artifacts_response.artifact_ids(),
+              ElementsAre(artifact_id, artifact_id));
+
+  GetArtifactsByIDRequest get_artifacts_request;
+  get_artifacts_request.add_artifact_ids(artifact_id);
+  GetArtifactsByIDResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).uri(), "second");
+  EXPECT_EQ(get_artifacts_response.artifacts(0)
+                .custom_properties()
+                .at("uri")
+                .string_value(),
+            "second");
+}
+
 TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   PutArtifactTypeRequest put_type_request;
   put_type_request.mutable_artifact_type()->set_name("test_type");
@@ -1423,6 +2041,79 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   EXPECT_THAT(update_artifact_response.artifact_ids(), SizeIs(0));
 }
 
+TEST_P(MetadataStoreTestSuite, PutExecutionsWhenLatestUpdatedTimeChanged) {
+  PutExecutionTypeRequest put_type_request;
+  put_type_request.mutable_execution_type()->set_name("test_type");
+  PutExecutionTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutExecutionType(put_type_request, &put_type_response));
+  PutExecutionsRequest put_executions_request;
+  put_executions_request.add_executions()->set_type_id(
+      put_type_response.type_id());
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(metadata_store_->GetExecutions({}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  Execution updated_execution = get_executions_response.executions(0);
+  updated_execution.set_last_known_state(Execution::RUNNING);
+  PutExecutionsRequest update_execution_request;
+  *update_execution_request.add_executions() = updated_execution;
+  update_execution_request.mutable_options()
+      ->set_abort_if_latest_updated_time_changed(true);
+  PutExecutionsResponse update_execution_response;
+  TF_EXPECT_OK(metadata_store_->PutExecutions(update_execution_request,
+                                              &update_execution_response));
+
+  // The stored execution is updated after the `latest_updated_time` in the
+  // request, so the same request fails.
+  tensorflow::Status status = metadata_store_->PutExecutions(
+      update_execution_request, &update_execution_response);
+  EXPECT_EQ(status.code(), tensorflow::error::FAILED_PRECONDITION);
+  EXPECT_THAT(update_execution_response.execution_ids(), SizeIs(0));
+}
+
+TEST_P(MetadataStoreTestSuite, PutContextsWhenLatestUpdatedTimeChanged) {
+  PutContextTypeRequest put_type_request;
+  put_type_request.mutable_context_type()->set_name("test_type");
+  PutContextTypeResponse put_type_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutContextType(put_type_request, &put_type_response));
+  PutContextsRequest put_contexts_request;
+  Context* context = put_contexts_request.add_contexts();
+  context->set_type_id(put_type_response.type_id());
+  context->set_name("context");
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store_->PutContexts(put_contexts_request,
+                                            &put_contexts_response));
+
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  ASSERT_THAT(get_contexts_response.contexts(), SizeIs(1));
+  const Context stored_context = get_contexts_response.contexts(0);
+
+  // An unchanged context is still updated, and its `latest_updated_time`
+  // increases.
+  PutContextsRequest update_context_request;
+  *update_context_request.add_contexts() = stored_context;
+  update_context_request.mutable_options()
+      ->set_abort_if_latest_updated_time_changed(true);
+  PutContextsResponse update_context_response;
+  TF_ASSERT_OK(metadata_store_->PutContexts(update_context_request,
+                                            &update_context_response));
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  ASSERT_THAT(get_contexts_response.contexts(), SizeIs(1));
+  EXPECT_GT(get_contexts_response.contexts(0).last_update_time_since_epoch(),
+            stored_context.last_update_time_since_epoch());
+
+  tensorflow::Status status = metadata_store_->PutContexts(
+      update_context_request, &update_context_response);
+  EXPECT_EQ(status.code(), tensorflow::error::FAILED_PRECONDITION);
+  EXPECT_THAT(update_context_response.context_ids(), SizeIs(0));
+}
+
 // Test creating an execution and then updating one of its properties.
 TEST_P(MetadataStoreTestSuite, PutExecutionsUpdateGetExecutionsByID) {
   const PutExecutionTypeRequest put_execution_type_request =
@@ -1660,6 +2351,66 @@ TEST_P(MetadataStoreTestSuite, GetExecutionTypeMissing) {
       metadata_store_->GetExecutionType(get_request, &get_response).code());
 }
 
+TEST_P(MetadataStoreTestSuite, PutExecutionsGetExecutionsByTypeAndNames) {
+  const PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(R"(
+        all_fields_match: true
+        execution_type: {
+          name: 'test_type'
+          properties { key: 'property' value: STRING }
+        }
+      )");
+  PutExecutionTypeResponse put_execution_type_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutionType(put_execution_type_request,
+                                                 &put_execution_type_response));
+  PutExecutionsRequest put_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: {
+          name: 'execution1'
+          properties {
+            key: 'property'
+            value: { string_value: '1' }
+          }
+        }
+        executions: { name: 'execution2' }
+        executions: { name: 'execution3' }
+      )");
+  for (Execution& execution : *put_executions_request.mutable_executions()) {
+    execution.set_type_id(put_execution_type_response.type_id());
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+  ASSERT_THAT(put_executions_response.execution_ids(), SizeIs(3));
+  Execution execution1 = put_executions_request.executions(0);
+  execution1.set_id(put_executions_response.execution_ids(0));
+  Execution execution3 = put_executions_request.executions(2);
+  execution3.set_id(put_executions_response.execution_ids(2));
+
+  GetExecutionsByTypeAndNamesRequest request =
+      ParseTextProtoOrDie<GetExecutionsByTypeAndNamesRequest>(R"(
+        type_name: 'test_type'
+        execution_names: [ 'execution1', 'execution3', 'unknown' ]
+      )");
+  GetExecutionsByTypeAndNamesResponse response;
+  TF_ASSERT_OK(
+      metadata_store_->GetExecutionsByTypeAndNames(request, &response));
+  EXPECT_THAT(response.executions(),
+              UnorderedElementsAre(
+                  EqualsProto(execution1, /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(execution3, /*ignore_fields=*/{
+                                  "create_time_since_epoch",
+                                  "last_update_time_since_epoch"})));
+
+  // An unknown type gives an empty response.
+  request.set_type_name("unknown_type");
+  TF_ASSERT_OK(
+      metadata_store_->GetExecutionsByTypeAndNames(request, &response));
+  EXPECT_THAT(response.executions(), IsEmpty());
+}
+
 TEST_P(MetadataStoreTestSuite, PutExecutionsGetExecutionByID) {
   const PutExecutionTypeRequest put_execution_type_request =
       ParseTextProtoOrDie<PutExecutionTypeRequest>(
@@ -1936,6 +2687,43 @@ TEST_P(MetadataStoreTestSuite, GetArtifactAndExecutionByTypesWithEmptyType) {
   EXPECT_THAT(get_executions_by_empty_type_response.executions(), SizeIs(0));
 }
 
+TEST_P(MetadataStoreTestSuite, GetArtifactsByURIPrefix) {
+  const PutArtifactTypeRequest put_artifact_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(
+          R"(all_fields_match: true
+             artifact_type: { name: 'artifact_type' })");
+  PutArtifactTypeResponse put_artifact_type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(put_artifact_type_request,
+                                                &put_artifact_type_response));
+  PutArtifactsRequest put_artifacts_request =
+      ParseTextProtoOrDie<PutArtifactsRequest>(R"(
+        artifacts: { uri: 'gs://bucket/dir/a' }
+        artifacts: { uri: 'gs://bucket/dir/b' }
+        artifacts: { uri: 'gs://bucket/other/c' }
+      )");
+  for (int i = 0; i < put_artifacts_request.artifacts_size(); i++) {
+    put_artifacts_request.mutable_artifacts(i)->set_type_id(
+        put_artifact_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  GetArtifactsByURIPrefixRequest request;
+  GetArtifactsByURIPrefixResponse response;
+  request.set_uri_prefix("gs://bucket/dir/");
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByURIPrefix(request, &response));
+  EXPECT_THAT(response.artifacts(), SizeIs(2));
+
+  request.set_uri_prefix("gs://bucket2/");
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByURIPrefix(request, &response));
+  EXPECT_THAT(response.artifacts(), SizeIs(0));
+
+  request.clear_uri_prefix();
+  EXPECT_EQ(metadata_store_->GetArtifactsByURIPrefix(request, &response).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 TEST_P(MetadataStoreTestSuite, GetArtifactByURI) {
   const PutArtifactTypeRequest put_artifact_type_request =
       ParseTextProtoOrDie<PutArtifactTypeRequest>(
@@ -2195,6 +2983,130 @@ TEST_P(MetadataStoreTestSuite, PutEventGetEvents) {
   ASSERT_THAT(get_events_by_execution_ids_response.events(), SizeIs(1));
   EXPECT_EQ(get_events_by_artifact_ids_response.events(0).artifact_id(),
             put_artifacts_response.artifact_ids(0));
+
+  // Only the events of the given types are returned.
+  get_events_by_execution_ids_request.add_types(Event::INPUT);
+  TF_ASSERT_OK(metadata_store_->GetEventsByExecutionIDs(
+      get_events_by_execution_ids_request,
+      &get_events_by_execution_ids_response));
+  EXPECT_THAT(get_events_by_execution_ids_response.events(), IsEmpty());
+  get_events_by_artifact_ids_request.add_types(Event::INPUT);
+  get_events_by_artifact_ids_request.add_types(Event::DECLARED_OUTPUT);
+  TF_ASSERT_OK(metadata_store_->GetEventsByArtifactIDs(
+      get_events_by_artifact_ids_request,
+      &get_events_by_artifact_ids_response));
+  ASSERT_THAT(get_events_by_artifact_ids_response.events(), SizeIs(1));
+  EXPECT_EQ(get_events_by_artifact_ids_response.events(0).type(),
+            Event::DECLARED_OUTPUT);
+}
+
+// Tests GetLineageGraph on the lineage a_0 -> e_0 -> a_1 -> e_1 -> a_2.
+TEST_P(MetadataStoreTestSuite, GetLineageGraph) {
+  PutTypesRequest put_types_request = ParseTextProtoOrDie<PutTypesRequest>(R"(
+    artifact_types: { name: 'artifact_type' }
+    execution_types: { name: 'execution_type' }
+  )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const auto& a = put_artifacts_response.artifact_ids();
+  PutExecutionsRequest put_executions_request;
+  for (int i = 0; i < 2; i++) {
+    put_executions_request.add_executions()->set_type_id(
+        put_types_response.execution_type_ids(0));
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+  const auto& e = put_executions_response.execution_ids();
+  PutEventsRequest put_events_request;
+  const auto add_event = [&](int64 artifact_id, int64 execution_id,
+                             Event::Type type) {
+    Event* event = put_events_request.add_events();
+    event->set_artifact_id(artifact_id);
+    event->set_execution_id(execution_id);
+    event->set_type(type);
+  };
+  add_event(a[0], e[0], Event::INPUT);
+  add_event(a[1], e[0], Event::OUTPUT);
+  add_event(a[1], e[1], Event::DECLARED_INPUT);
+  add_event(a[2], e[1], Event::OUTPUT);
+  PutEventsResponse put_events_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutEvents(put_events_request, &put_events_response));
+
+  const auto get_node_ids = [](const auto& nodes) {
+    std::vector<int64> ids;
+    for (const auto& node : nodes) ids.push_back(node.id());
+    return ids;
+  };
+  GetLineageGraphRequest request;
+  request.add_artifact_ids(a[1]);
+  {
+    request.set_direction(GetLineageGraphRequest::UPSTREAM);
+    GetLineageGraphResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageGraph(request, &response));
+    EXPECT_THAT(get_node_ids(response.subgraph().artifacts()),
+                UnorderedElementsAre(a[0], a[1]));
+    EXPECT_THAT(get_node_ids(response.subgraph().executions()),
+                ElementsAre(e[0]));
+    EXPECT_THAT(response.subgraph().events(), SizeIs(2));
+  }
+  {
+    request.set_direction(GetLineageGraphRequest::DOWNSTREAM);
+    GetLineageGraphResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageGraph(request, &response));
+    EXPECT_THAT(get_node_ids(response.subgraph().artifacts()),
+                UnorderedElementsAre(a[1], a[2]));
+    EXPECT_THAT(get_node_ids(response.subgraph().executions()),
+                ElementsAre(e[1]));
+    EXPECT_THAT(response.subgraph().events(), SizeIs(2));
+  }
+  {
+    // Each event is returned once, although it is reached from both nodes.
+    request.set_direction(GetLineageGraphRequest::BOTH);
+    GetLineageGraphResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageGraph(request, &response));
+    EXPECT_THAT(get_node_ids(response.subgraph().artifacts()),
+                UnorderedElementsAre(a[0], a[1], a[2]));
+    EXPECT_THAT(get_node_ids(response.subgraph().executions()),
+                UnorderedElementsAre(e[0], e[1]));
+    EXPECT_THAT(response.subgraph().events(), SizeIs(4));
+  }
+  {
+    request.set_max_num_hops(1);
+    GetLineageGraphResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageGraph(request, &response));
+    EXPECT_THAT(get_node_ids(response.subgraph().artifacts()),
+                ElementsAre(a[1]));
+    EXPECT_THAT(get_node_ids(response.subgraph().executions()),
+                UnorderedElementsAre(e[0], e[1]));
+    EXPECT_THAT(response.subgraph().events(), SizeIs(2));
+  }
+  {
+    request.clear_max_num_hops();
+    request.set_max_num_nodes(2);
+    GetLineageGraphResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageGraph(request, &response));
+    EXPECT_THAT(response.subgraph().artifacts(), SizeIs(1));
+    EXPECT_THAT(response.subgraph().executions(), SizeIs(1));
+    EXPECT_THAT(response.subgraph().events(), SizeIs(1));
+  }
+  {
+    request.clear_max_num_nodes();
+    request.set_max_num_hops(-1);
+    GetLineageGraphResponse response;
+    EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+              metadata_store_->GetLineageGraph(request, &response).code());
+  }
 }
 
 TEST_P(MetadataStoreTestSuite, PutTypesGetTypes) {
@@ -3444,6 +4356,116 @@ TEST_P(MetadataStoreTestSuite, PutParentContextsInvalidArgumentError) {
                              /*child_id=*/not_exist_context_id);
 }
 
+TEST_P(MetadataStoreTestSuite, GetNodesByContexts) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutContextsRequest put_contexts_request;
+  for (int i = 0; i < 3; i++) {
+    Context* context = put_contexts_request.add_contexts();
+    context->set_type_id(put_types_response.context_type_ids(0));
+    context->set_name(absl::StrCat("context_", i));
+  }
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store_->PutContexts(put_contexts_request,
+                                            &put_contexts_response));
+  const auto& context_ids = put_contexts_response.context_ids();
+  PutArtifactsRequest put_artifacts_request;
+  PutExecutionsRequest put_executions_request;
+  for (int i = 0; i < 2; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+    put_executions_request.add_executions()->set_type_id(
+        put_types_response.execution_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const auto& artifact_ids = put_artifacts_response.artifact_ids();
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+  const auto& execution_ids = put_executions_response.execution_ids();
+
+  // The first context has both nodes of each kind, the second context has the
+  // second ones, and the last context has none.
+  PutAttributionsAndAssociationsRequest put_links_request;
+  const auto add_links = [&](int context_index, int node_index) {
+    Attribution* attribution = put_links_request.add_attributions();
+    attribution->set_context_id(context_ids[context_index]);
+    attribution->set_artifact_id(artifact_ids[node_index]);
+    Association* association = put_links_request.add_associations();
+    association->set_context_id(context_ids[context_index]);
+    association->set_execution_id(execution_ids[node_index]);
+  };
+  add_links(0, 0);
+  add_links(0, 1);
+  add_links(1, 1);
+  PutAttributionsAndAssociationsResponse put_links_response;
+  TF_ASSERT_OK(metadata_store_->PutAttributionsAndAssociations(
+      put_links_request, &put_links_response));
+
+  const auto get_ids = [](const auto& nodes) {
+    std::vector<int64> ids;
+    for (const auto& node : nodes) ids.push_back(node.id());
+    return ids;
+  };
+  GetArtifactsByContextsRequest get_artifacts_request;
+  get_artifacts_request.mutable_context_ids()->CopyFrom(context_ids);
+  GetArtifactsByContextsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByContexts(
+      get_artifacts_request, &get_artifacts_response));
+  const auto& artifacts_by_context =
+      get_artifacts_response.artifacts_by_context();
+  ASSERT_THAT(artifacts_by_context, SizeIs(2));
+  EXPECT_THAT(get_ids(artifacts_by_context.at(context_ids[0]).artifacts()),
+              UnorderedElementsAre(artifact_ids[0], artifact_ids[1]));
+  EXPECT_THAT(get_ids(artifacts_by_context.at(context_ids[1]).artifacts()),
+              ElementsAre(artifact_ids[1]));
+
+  GetExecutionsByContextsRequest get_executions_request;
+  get_executions_request.add_context_ids(context_ids[1]);
+  get_executions_request.add_context_ids(context_ids[2]);
+  GetExecutionsByContextsResponse get_executions_response;
+  TF_ASSERT_OK(metadata_store_->GetExecutionsByContexts(
+      get_executions_request, &get_executions_response));
+  const auto& executions_by_context =
+      get_executions_response.executions_by_context();
+  ASSERT_THAT(executions_by_context, SizeIs(1));
+  EXPECT_THAT(get_ids(executions_by_context.at(context_ids[1]).executions()),
+              ElementsAre(execution_ids[1]));
+
+  GetContextsByArtifactsRequest get_contexts_request;
+  get_contexts_request.mutable_artifact_ids()->CopyFrom(artifact_ids);
+  GetContextsByArtifactsResponse get_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContextsByArtifacts(get_contexts_request,
+                                                       &get_contexts_response));
+  const auto& contexts_by_artifact =
+      get_contexts_response.contexts_by_artifact();
+  ASSERT_THAT(contexts_by_artifact, SizeIs(2));
+  EXPECT_THAT(get_ids(contexts_by_artifact.at(artifact_ids[0]).contexts()),
+              ElementsAre(context_ids[0]));
+  EXPECT_THAT(get_ids(contexts_by_artifact.at(artifact_ids[1]).contexts()),
+              UnorderedElementsAre(context_ids[0], context_ids[1]));
+
+  GetContextsByExecutionsRequest get_execution_contexts_request;
+  get_execution_contexts_request.add_execution_ids(execution_ids[0]);
+  GetContextsByExecutionsResponse get_execution_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContextsByExecutions(
+      get_execution_contexts_request, &get_execution_contexts_response));
+  const auto& contexts_by_execution =
+      get_execution_contexts_response.contexts_by_execution();
+  ASSERT_THAT(contexts_by_execution, SizeIs(1));
+  EXPECT_THAT(get_ids(contexts_by_execution.at(execution_ids[0]).contexts()),
+              ElementsAre(context_ids[0]));
+}
+
 TEST_P(MetadataStoreTestSuite, PutParentContextsAndGetLinkedContextByContext) {
   // Inserts a context type.
   ContextType context_type;
@@ -3527,6 +4549,34 @@ TEST_P(MetadataStoreTestSuite, PutParentContextsAndGetLinkedContextByContext) {
                                        "last_update_time_since_epoch"}),
                                    want_children[i]));
   }
+
+  // Verifies the ancestors and descendants within a number of levels.
+  const auto get_ids = [](const auto& got) {
+    std::vector<int64> ids;
+    for (const Context& context : got) ids.push_back(context.id());
+    return ids;
+  };
+  GetParentContextsByContextRequest get_ancestors_request;
+  get_ancestors_request.set_context_id(contexts[6].id());
+  get_ancestors_request.set_max_depth(2);
+  GetParentContextsByContextResponse get_ancestors_response;
+  TF_ASSERT_OK(metadata_store_->GetParentContextsByContext(
+      get_ancestors_request, &get_ancestors_response));
+  EXPECT_THAT(get_ids(get_ancestors_response.contexts()),
+              UnorderedElementsAre(contexts[0].id(), contexts[1].id(),
+                                   contexts[4].id(), contexts[5].id()));
+  EXPECT_THAT(get_ancestors_response.parent_contexts(), SizeIs(4));
+
+  GetChildrenContextsByContextRequest get_descendants_request;
+  get_descendants_request.set_context_id(contexts[0].id());
+  get_descendants_request.set_max_depth(3);
+  GetChildrenContextsByContextResponse get_descendants_response;
+  TF_ASSERT_OK(metadata_store_->GetChildrenContextsByContext(
+      get_descendants_request, &get_descendants_response));
+  EXPECT_THAT(get_ids(get_descendants_response.contexts()),
+              UnorderedElementsAre(contexts[1].id(), contexts[2].id(),
+                                   contexts[3].id(), contexts[6].id()));
+  EXPECT_THAT(get_descendants_response.parent_contexts(), SizeIs(4));
 }
 
 }  // namespace
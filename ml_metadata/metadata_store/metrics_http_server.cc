@@ -0,0 +1,161 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metrics_http_server.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <glog/logging.h>
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+// The max size of a request header, and the max time to read it.
+constexpr int kMaxRequestBytes = 8 << 10;
+constexpr int kRequestTimeoutSeconds = 5;
+
+// Returns the response with the given status line and text body.
+std::string MakeResponse(const absl::string_view status,
+                         const absl::string_view content_type,
+                         const absl::string_view body) {
+  return absl::StrCat("HTTP/1.1 ", status, "\r\nContent-Type: ", content_type,
+                      "\r\nContent-Length: ", body.size(),
+                      "\r\nConnection: close\r\n\r\n", body);
+}
+
+// Writes all of `data` to `connection`. Returns false if it fails.
+bool WriteAll(const int connection, absl::string_view data) {
+  while (!data.empty()) {
+    const ssize_t written =
+        send(connection, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+MetricsHttpServer::MetricsHttpServer(const MetricsRegistry* registry)
+    : registry_(registry) {
+  CHECK(registry_ != nullptr) << "The registry must not be null.";
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+  stopped_ = true;
+  if (listen_socket_ >= 0) {
+    // Wakes up the accept() of the background thread.
+    shutdown(listen_socket_, SHUT_RDWR);
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (listen_socket_ >= 0) {
+    close(listen_socket_);
+  }
+}
+
+tensorflow::Status MetricsHttpServer::Start(const int port) {
+  CHECK(!thread_.joinable()) << "The metrics server is already started.";
+  listen_socket_ = socket(AF_INET6, SOCK_STREAM, 0);
+  if (listen_socket_ < 0) {
+    return tensorflow::errors::Unavailable("Cannot create a socket: ",
+                                           std::strerror(errno));
+  }
+  const int enabled = 1;
+  setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, &enabled,
+             sizeof(enabled));
+  // Accepts the IPv4 connections as well.
+  const int disabled = 0;
+  setsockopt(listen_socket_, IPPROTO_IPV6, IPV6_V6ONLY, &disabled,
+             sizeof(disabled));
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  address.sin6_port = htons(port);
+  if (bind(listen_socket_, reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listen_socket_, /*backlog=*/16) != 0) {
+    return tensorflow::errors::Unavailable("Cannot listen on port ", port,
+                                           ": ", std::strerror(errno));
+  }
+  socklen_t address_size = sizeof(address);
+  getsockname(listen_socket_, reinterpret_cast<sockaddr*>(&address),
+              &address_size);
+  port_ = ntohs(address.sin6_port);
+  thread_ = std::thread([this]() { Run(); });
+  return tensorflow::Status::OK();
+}
+
+void MetricsHttpServer::Run() {
+  while (!stopped_) {
+    const int connection = accept(listen_socket_, nullptr, nullptr);
+    if (connection < 0) {
+      if (!stopped_ && errno != EINTR) {
+        LOG(WARNING) << "Failed to accept a metrics request: "
+                     << std::strerror(errno);
+      }
+      continue;
+    }
+    Serve(connection);
+    close(connection);
+  }
+}
+
+void MetricsHttpServer::Serve(const int connection) {
+  timeval timeout = {};
+  timeout.tv_sec = kRequestTimeoutSeconds;
+  setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  // Only the request line matters, the rest of the header is not parsed.
+  std::string request;
+  char buffer[1024];
+  while (!absl::StrContains(request, "\r\n\r\n") &&
+         request.size() < kMaxRequestBytes) {
+    const ssize_t num_read = recv(connection, buffer, sizeof(buffer), 0);
+    if (num_read < 0 && errno == EINTR) continue;
+    if (num_read <= 0) return;
+    request.append(buffer, num_read);
+  }
+  const absl::string_view request_line =
+      absl::string_view(request).substr(0, request.find("\r\n"));
+  std::string response;
+  if (absl::StartsWith(request_line, "GET /metrics ") ||
+      absl::StartsWith(request_line, "GET /metrics?")) {
+    response = MakeResponse("200 OK", "text/plain; version=0.0.4",
+                            registry_->ExportPrometheusText());
+  } else if (absl::StartsWith(request_line, "GET ")) {
+    response = MakeResponse("404 Not Found", "text/plain", "Not found.\n");
+  } else {
+    response = MakeResponse("405 Method Not Allowed", "text/plain",
+                            "Only GET is supported.\n");
+  }
+  if (!WriteAll(connection, response)) {
+    LOG(WARNING) << "Failed to write a metrics response: "
+                 << std::strerror(errno);
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,67 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METRICS_HTTP_SERVER_H_
+#define ML_METADATA_METADATA_STORE_METRICS_HTTP_SERVER_H_
+
+#include <atomic>
+#include <thread>  // NOLINT
+
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A minimal HTTP/1.1 server, which answers `GET /metrics` with the metrics of
+// a MetricsRegistry in the Prometheus text exposition format, e.g., for the
+// metadata store server to be scraped. The requests are served one at a time
+// on a background thread, and each connection is closed after its response,
+// as the scrapes are infrequent.
+class MetricsHttpServer {
+ public:
+  // `registry` is not owned and must outlive the server.
+  explicit MetricsHttpServer(const MetricsRegistry* registry);
+
+  // Stops the background thread, after its current request if any.
+  ~MetricsHttpServer();
+
+  // Disallow copy and assign.
+  MetricsHttpServer(const MetricsHttpServer&) = delete;
+  MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+  // Listens on `port` of all interfaces, or on a free port if it is 0, and
+  // starts the background thread. It must be called at most once.
+  // Returns detailed UNAVAILABLE error, if the port cannot be listened on.
+  tensorflow::Status Start(int port);
+
+  // Returns the port listened on, once started.
+  int port() const { return port_; }
+
+ private:
+  // Accepts and serves the connections until the server is stopped.
+  void Run();
+
+  // Reads a request from `connection` and writes its response.
+  void Serve(int connection);
+
+  const MetricsRegistry* const registry_;
+  int listen_socket_ = -1;
+  int port_ = 0;
+  std::atomic<bool> stopped_{false};
+  std::thread thread_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METRICS_HTTP_SERVER_H_
@@ -0,0 +1,87 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metrics_http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/string_view.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+// Sends `request` to the local `port` and returns the whole response.
+std::string SendRequest(const int port, const absl::string_view request) {
+  const int connection = socket(AF_INET, SOCK_STREAM, 0);
+  EXPECT_GE(connection, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  EXPECT_EQ(connect(connection, reinterpret_cast<const sockaddr*>(&address),
+                    sizeof(address)),
+            0);
+  EXPECT_EQ(send(connection, request.data(), request.size(), 0),
+            request.size());
+  std::string response;
+  char buffer[1024];
+  ssize_t num_read;
+  while ((num_read = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, num_read);
+  }
+  close(connection);
+  return response;
+}
+
+TEST(MetricsHttpServerTest, ServesMetrics) {
+  MetricsRegistry registry;
+  registry.GetCounter("rows_total", "Rows.", {{"template", "a"}})
+      ->Increment(2);
+  MetricsHttpServer server(&registry);
+  TF_ASSERT_OK(server.Start(/*port=*/0));
+  ASSERT_GT(server.port(), 0);
+
+  const std::string response =
+      SendRequest(server.port(), "GET /metrics HTTP/1.1\r\nHost: a\r\n\r\n");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("\r\n\r\n# HELP rows_total Rows.\n"
+                                  "# TYPE rows_total counter\n"
+                                  "rows_total{template=\"a\"} 2\n"));
+}
+
+TEST(MetricsHttpServerTest, RejectsOtherRequests) {
+  MetricsRegistry registry;
+  MetricsHttpServer server(&registry);
+  TF_ASSERT_OK(server.Start(/*port=*/0));
+
+  EXPECT_THAT(SendRequest(server.port(), "GET / HTTP/1.1\r\n\r\n"),
+              StartsWith("HTTP/1.1 404 Not Found\r\n"));
+  EXPECT_THAT(SendRequest(server.port(), "POST /metrics HTTP/1.1\r\n\r\n"),
+              StartsWith("HTTP/1.1 405 Method Not Allowed\r\n"));
+}
+
+}  // namespace
+}  // namespace ml_metadata
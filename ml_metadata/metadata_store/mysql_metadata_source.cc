@@ -14,14 +14,30 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <glog/logging.h>
+#include "absl/random/random.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/return_utils.h"
@@ -34,8 +50,22 @@ namespace {
 using absl::Status;
 
 constexpr char kBeginTransaction[] = "START TRANSACTION";
+constexpr char kBeginReadOnlyTransaction[] = "START TRANSACTION READ ONLY";
+constexpr char kSetRepeatableRead[] =
+    "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ";
+constexpr char kBeginSnapshotReadTransaction[] =
+    "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY";
 constexpr char kCommitTransaction[] = "COMMIT";
 constexpr char kRollbackTransaction[] = "ROLLBACK";
+constexpr char kShowReplicaStatus[] = "SHOW SLAVE STATUS";
+constexpr char kSecondsBehindMaster[] = "Seconds_Behind_Master";
+
+// The lag of a connected replica is read again after this interval.
+constexpr absl::Duration kReplicaLagCheckInterval = absl::Seconds(1);
+// A replica is connected again after this interval, if connecting failed.
+constexpr absl::Duration kReplicaReconnectInterval = absl::Seconds(10);
+// The max replica lag, if the config does not set it.
+constexpr absl::Duration kDefaultMaxReplicaLag = absl::Seconds(1);
 
 // A class that invokes mysql_thread_init() when constructed, and
 // mysql_thread_end() when destructed.  It can be used as a
@@ -78,6 +108,276 @@ Status ThreadInitAccess() {
   return absl::OkStatus();
 }
 
+// The initial size of the buffer that receives a string column of a prepared
+// statement. Larger values are fetched again with a resized buffer.
+constexpr int kInitialColumnBufferSize = 256;
+
+// Returns an error for the last failed call on the prepared statement `stmt`.
+// Deadlocks and lock wait timeouts are returned as Aborted, so that the
+// client side can retry.
+Status PreparedStatementError(MYSQL_STMT* stmt, absl::string_view action) {
+  const int64 error_number = mysql_stmt_errno(stmt);
+  if (error_number == 1213 || error_number == 1205) {
+    return absl::AbortedError(absl::StrCat(action, " aborted: errno: ",
+                                           error_number, ", error: ",
+                                           mysql_stmt_error(stmt)));
+  }
+  return absl::InternalError(absl::StrCat(action, " failed: errno: ",
+                                          error_number, ", error: ",
+                                          mysql_stmt_error(stmt)));
+}
+
+// Returns the type of the cells to which the values of a result column of
+// type `field_type` are fetched with the binary protocol. Integers and
+// doubles are fetched in binary form; other types, e.g., DECIMAL, text and
+// blobs, are fetched as strings.
+TypedRecordSet::CellType GetResultCellType(const enum_field_types field_type) {
+  switch (field_type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_YEAR:
+      return TypedRecordSet::CellType::kInt64;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+      return TypedRecordSet::CellType::kDouble;
+    default:
+      return TypedRecordSet::CellType::kString;
+  }
+}
+
+// The buffer receiving the value of a result column of a prepared statement.
+struct ResultColumnBuffer {
+  TypedRecordSet::CellType cell_type;
+  int64 int64_value;
+  double double_value;
+  std::string string_value;
+  unsigned long length;
+  my_bool is_null;
+};
+
+// Fetches the rows of an executed prepared statement `stmt` to `record_set`.
+// The integer and double columns are received in the binary protocol, so that
+// they are not formatted to text by the server and parsed again by the caller.
+Status FetchPreparedStatementResults(MYSQL_STMT* stmt, MYSQL_RES* metadata,
+                                     TypedRecordSet* record_set) {
+  const uint32 num_cols = mysql_num_fields(metadata);
+  const MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+  std::vector<MYSQL_BIND> columns(num_cols);
+  std::vector<ResultColumnBuffer> buffers(num_cols);
+  std::vector<std::string> column_names;
+  column_names.reserve(num_cols);
+  for (uint32 col = 0; col < num_cols; ++col) {
+    column_names.push_back(fields[col].org_name);
+    ResultColumnBuffer& buffer = buffers[col];
+    MYSQL_BIND& column = columns[col];
+    buffer.cell_type = GetResultCellType(fields[col].type);
+    switch (buffer.cell_type) {
+      case TypedRecordSet::CellType::kInt64:
+        column.buffer_type = MYSQL_TYPE_LONGLONG;
+        column.buffer = &buffer.int64_value;
+        break;
+      case TypedRecordSet::CellType::kDouble:
+        column.buffer_type = MYSQL_TYPE_DOUBLE;
+        column.buffer = &buffer.double_value;
+        break;
+      default:
+        buffer.string_value.resize(kInitialColumnBufferSize);
+        column.buffer_type = MYSQL_TYPE_STRING;
+        column.buffer = &buffer.string_value[0];
+        column.buffer_length = buffer.string_value.size();
+    }
+    column.length = &buffer.length;
+    column.is_null = &buffer.is_null;
+  }
+  record_set->Reset(std::move(column_names));
+  if (mysql_stmt_bind_result(stmt, columns.data())) {
+    return PreparedStatementError(stmt, "mysql_stmt_bind_result");
+  }
+  while (true) {
+    const int fetch_status = mysql_stmt_fetch(stmt);
+    if (fetch_status == MYSQL_NO_DATA) break;
+    if (fetch_status == 1) {
+      return PreparedStatementError(stmt, "mysql_stmt_fetch");
+    }
+    bool buffers_resized = false;
+    for (uint32 col = 0; col < num_cols; ++col) {
+      ResultColumnBuffer& buffer = buffers[col];
+      if (buffer.is_null) {
+        record_set->AppendNull();
+        continue;
+      }
+      if (buffer.cell_type == TypedRecordSet::CellType::kInt64) {
+        record_set->AppendInt64(buffer.int64_value);
+        continue;
+      }
+      if (buffer.cell_type == TypedRecordSet::CellType::kDouble) {
+        record_set->AppendDouble(buffer.double_value);
+        continue;
+      }
+      // MYSQL_DATA_TRUNCATED: fetches the full value with a larger buffer.
+      if (buffer.length > buffer.string_value.size()) {
+        buffer.string_value.resize(buffer.length);
+        columns[col].buffer = &buffer.string_value[0];
+        columns[col].buffer_length = buffer.string_value.size();
+        if (mysql_stmt_fetch_column(stmt, &columns[col], col, /*offset=*/0)) {
+          return PreparedStatementError(stmt, "mysql_stmt_fetch_column");
+        }
+        buffers_resized = true;
+      }
+      record_set->AppendString(
+          absl::string_view(buffer.string_value.data(), buffer.length));
+    }
+    if (buffers_resized && mysql_stmt_bind_result(stmt, columns.data())) {
+      return PreparedStatementError(stmt, "mysql_stmt_bind_result");
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Binds `values` to the placeholders of `stmt` and executes it with
+// `execute`. If the statement returns rows, they are fetched to `results` if it
+// is not null.
+Status RunPreparedStatement(MYSQL_STMT* stmt,
+                            absl::Span<const PreparedStatementValue> values,
+                            const std::function<Status()>& execute,
+                            TypedRecordSet* results) {
+  if (mysql_stmt_param_count(stmt) != values.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Prepared query has ", mysql_stmt_param_count(stmt),
+                     " placeholders, but ", values.size(),
+                     " values are given"));
+  }
+  // The bound buffers are owned by `values`, which are only read by the client
+  // library during mysql_stmt_execute.
+  std::vector<MYSQL_BIND> params(values.size());
+  for (int i = 0; i < values.size(); ++i) {
+    const PreparedStatementValue& value = values[i];
+    MYSQL_BIND& param = params[i];
+    if (absl::holds_alternative<int64>(value)) {
+      param.buffer_type = MYSQL_TYPE_LONGLONG;
+      param.buffer = const_cast<int64*>(&absl::get<int64>(value));
+    } else if (absl::holds_alternative<double>(value)) {
+      param.buffer_type = MYSQL_TYPE_DOUBLE;
+      param.buffer = const_cast<double*>(&absl::get<double>(value));
+    } else if (absl::holds_alternative<std::string>(value)) {
+      const std::string& text = absl::get<std::string>(value);
+      param.buffer_type = MYSQL_TYPE_STRING;
+      param.buffer = const_cast<char*>(text.data());
+      param.buffer_length = text.size();
+    } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+      const std::string& bytes = absl::get<PreparedStatementBytes>(value).bytes;
+      param.buffer_type = MYSQL_TYPE_BLOB;
+      param.buffer = const_cast<char*>(bytes.data());
+      param.buffer_length = bytes.size();
+    } else {
+      param.buffer_type = MYSQL_TYPE_NULL;
+    }
+  }
+  if (!params.empty() && mysql_stmt_bind_param(stmt, params.data())) {
+    return PreparedStatementError(stmt, "mysql_stmt_bind_param");
+  }
+  MLMD_RETURN_IF_ERROR(execute());
+  MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt);
+  if (metadata == nullptr) {
+    // The statement does not produce a result set, e.g., insert or update.
+    if (mysql_stmt_errno(stmt) != 0) {
+      return PreparedStatementError(stmt, "mysql_stmt_result_metadata");
+    }
+    return absl::OkStatus();
+  }
+  TypedRecordSet record_set;
+  const Status status =
+      FetchPreparedStatementResults(stmt, metadata, &record_set);
+  mysql_free_result(metadata);
+  MLMD_RETURN_IF_ERROR(status);
+  if (results != nullptr) {
+    *results = std::move(record_set);
+  }
+  return absl::OkStatus();
+}
+
+// Reads the rows of a `result_set` returned by mysql_use_result, and passes
+// them to `callback` in batches of at most `max_batch_size` rows. Integer and
+// double columns are converted once when the row is read.
+Status StreamResultSet(MYSQL* db, MYSQL_RES* result_set,
+                       const int max_batch_size,
+                       const RecordBatchCallback& callback) {
+  const uint32 num_cols = mysql_num_fields(result_set);
+  const MYSQL_FIELD* fields = mysql_fetch_fields(result_set);
+  std::vector<std::string> column_names;
+  std::vector<TypedRecordSet::CellType> cell_types;
+  column_names.reserve(num_cols);
+  cell_types.reserve(num_cols);
+  for (uint32 col = 0; col < num_cols; ++col) {
+    column_names.push_back(fields[col].org_name);
+    cell_types.push_back(GetResultCellType(fields[col].type));
+  }
+  TypedRecordSet batch(column_names);
+  MYSQL_ROW row;
+  while ((row = mysql_fetch_row(result_set)) != nullptr) {
+    const unsigned long* lengths = mysql_fetch_lengths(result_set);
+    for (uint32 col = 0; col < num_cols; ++col) {
+      if (row[col] == nullptr) {
+        batch.AppendNull();
+        continue;
+      }
+      const absl::string_view text(row[col], lengths[col]);
+      int64 int64_value;
+      double double_value;
+      if (cell_types[col] == TypedRecordSet::CellType::kInt64 &&
+          ParseDecimalInt64(text, &int64_value)) {
+        batch.AppendInt64(int64_value);
+      } else if (cell_types[col] == TypedRecordSet::CellType::kDouble &&
+                 absl::SimpleAtod(text, &double_value)) {
+        batch.AppendDouble(double_value);
+      } else {
+        batch.AppendString(text);
+      }
+    }
+    if (batch.num_rows() == max_batch_size) {
+      MLMD_RETURN_IF_ERROR(callback(batch));
+      batch.Reset(column_names);
+    }
+  }
+  // mysql_fetch_row returns NULL at the end of the rows and on errors.
+  if (mysql_errno(db) != 0) {
+    return absl::InternalError(
+        absl::StrCat("mysql_fetch_row failed: errno: ", mysql_errno(db),
+                     ", error: ", mysql_error(db)));
+  }
+  if (batch.num_rows() > 0) {
+    MLMD_RETURN_IF_ERROR(callback(batch));
+  }
+  return absl::OkStatus();
+}
+
+// Sets `name` to the name of the isolation `level` in the SQL syntax of MySQL.
+// Returns INVALID_ARGUMENT error, if the level has no name, e.g., it is
+//   unspecified.
+Status IsolationLevelName(const MySQLDatabaseConfig::IsolationLevel level,
+                          std::string* name) {
+  switch (level) {
+    case MySQLDatabaseConfig::ISOLATION_LEVEL_READ_UNCOMMITTED:
+      *name = "READ UNCOMMITTED";
+      return absl::OkStatus();
+    case MySQLDatabaseConfig::ISOLATION_LEVEL_READ_COMMITTED:
+      *name = "READ COMMITTED";
+      return absl::OkStatus();
+    case MySQLDatabaseConfig::ISOLATION_LEVEL_REPEATABLE_READ:
+      *name = "REPEATABLE READ";
+      return absl::OkStatus();
+    case MySQLDatabaseConfig::ISOLATION_LEVEL_SERIALIZABLE:
+      *name = "SERIALIZABLE";
+      return absl::OkStatus();
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown isolation level: ", level));
+  }
+}
+
 // Checks if config is valid.
 Status CheckConfig(const MySQLDatabaseConfig& config) {
   std::vector<std::string> config_errors;
@@ -87,6 +387,13 @@ Status CheckConfig(const MySQLDatabaseConfig& config) {
   if (config.database().empty()) {
     config_errors.push_back("database must not be empty");
   }
+  for (const MySQLDatabaseConfig::ReplicaConfig& replica : config.replicas()) {
+    if (replica.host().empty() == replica.socket().empty()) {
+      config_errors.push_back(
+          "exactly one of host or socket must be specified for each replica");
+      break;
+    }
+  }
 
   if (!config_errors.empty()) {
     return absl::InvalidArgumentError(absl::StrJoin(config_errors, ";"));
@@ -97,8 +404,20 @@ Status CheckConfig(const MySQLDatabaseConfig& config) {
 }  // namespace
 
 MySqlMetadataSource::MySqlMetadataSource(const MySQLDatabaseConfig& config)
-    : MetadataSource(), config_(config) {
+    : MetadataSource(),
+      config_(config),
+      max_replica_lag_(config.max_replica_lag_seconds() > 0
+                           ? absl::Seconds(config.max_replica_lag_seconds())
+                           : kDefaultMaxReplicaLag),
+      read_isolation_level_(config.has_read_isolation_level()
+                                ? config.read_isolation_level()
+                                : config.isolation_level()) {
   CHECK_EQ(absl::OkStatus(), CheckConfig(config));
+  // The sources start from random replicas, so that they spread over them.
+  absl::BitGen bit_gen;
+  replica_index_ = config_.replicas().empty()
+                       ? 0
+                       : absl::Uniform(bit_gen, 0, config_.replicas_size());
 }
 
 MySqlMetadataSource::~MySqlMetadataSource() {
@@ -106,6 +425,38 @@ MySqlMetadataSource::~MySqlMetadataSource() {
 }
 
 Status MySqlMetadataSource::ConnectImpl() {
+  MLMD_RETURN_IF_ERROR(
+      OpenConnection(config_.host(), config_.port(), config_.socket()));
+
+  // Return an error if the default storage engine doesn't support transactions.
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      CheckTransactionSupport(),
+      "checking transaction support of default storage engine");
+
+  // Create the database if not already present and skip_db_creation is false.
+  if (!config_.skip_db_creation()) {
+    const std::string create_database_cmd =
+        absl::StrCat("CREATE DATABASE IF NOT EXISTS ", config_.database());
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(RunQuery(create_database_cmd),
+                                      "Creating database ", config_.database(),
+                                      " in ConnectImpl");
+  }
+  // Switch to the database.
+  const std::string use_database_cmd = absl::StrCat("USE ", config_.database());
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(RunQuery(use_database_cmd),
+                                    "Changing to database ", config_.database(),
+                                    " in ConnectImpl");
+  // The connection to the primary mostly runs the writes.
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      SetSessionIsolationLevel(config_.isolation_level()),
+      "Setting the isolation level in ConnectImpl");
+
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::OpenConnection(const std::string& host,
+                                           const uint32 port,
+                                           const std::string& socket) {
   // Initialize the MYSQL object.
   db_ = mysql_init(nullptr);
   if (!db_) {
@@ -133,52 +484,162 @@ Status MySqlMetadataSource::ConnectImpl() {
     my_bool verify_server_cert = ssl.verify_server_cert() ? 1 : 0;
     mysql_options(db_, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_server_cert);
   }
+  if (config_.enable_compression()) {
+    mysql_options(db_, MYSQL_OPT_COMPRESS, nullptr);
+  }
+  // The connection is opened with blocking calls, which can be mixed with the
+  // non-blocking ones.
+  if (config_.enable_nonblocking_io()) {
+    mysql_options(db_, MYSQL_OPT_NONBLOCK, 0);
+  }
 
   // Connect to the MYSQL server.
   db_ = mysql_real_connect(
-          db_, config_.host().empty() ? nullptr : config_.host().c_str(),
+          db_, host.empty() ? nullptr : host.c_str(),
           config_.user().empty() ? nullptr : config_.user().c_str(),
           config_.password().empty() ? nullptr : config_.password().c_str(),
-          /*db=*/nullptr, config_.port(),
-          config_.socket().empty() ? nullptr : config_.socket().c_str(),
-          /*clientflag=*/0UL);
+          /*db=*/nullptr, port, socket.empty() ? nullptr : socket.c_str(),
+          // The pipelined queries are sent as one multi-statement query.
+          /*clientflag=*/CLIENT_MULTI_STATEMENTS);
 
   if (!db_) {
     return absl::InternalError(
         absl::StrCat("mysql_real_connect failed: errno: ", mysql_errno(db_),
                      ", error: ", mysql_error(db_)));
   }
+  return absl::OkStatus();
+}
 
-  // Return an error if the default storage engine doesn't support transactions.
-  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
-      CheckTransactionSupport(),
-      "checking transaction support of default storage engine");
-
-  // Create the database if not already present and skip_db_creation is false.
-  if (!config_.skip_db_creation()) {
-    const std::string create_database_cmd =
-        absl::StrCat("CREATE DATABASE IF NOT EXISTS ", config_.database());
-    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(RunQuery(create_database_cmd),
-                                      "Creating database ", config_.database(),
-                                      " in ConnectImpl");
+Status MySqlMetadataSource::CloseImpl() {
+  if (db_ != nullptr || replica_db_ != nullptr) {
+    MLMD_RETURN_IF_ERROR(ThreadInitAccess());
+    CloseConnection();
+    SwitchConnection();
+    CloseConnection();
+    on_replica_ = false;
+    replica_lag_ok_ = false;
+    replica_lag_check_time_ = absl::InfinitePast();
   }
-  // Switch to the database.
-  const std::string use_database_cmd = absl::StrCat("USE ", config_.database());
-  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(RunQuery(use_database_cmd),
-                                    "Changing to database ", config_.database(),
-                                    " in ConnectImpl");
-
   return absl::OkStatus();
 }
 
-Status MySqlMetadataSource::CloseImpl() {
+void MySqlMetadataSource::CloseConnection() {
   if (db_ != nullptr) {
-    MLMD_RETURN_IF_ERROR(ThreadInitAccess());
     DiscardResultSet();
+    ClosePreparedStatements();
     mysql_close(db_);
     db_ = nullptr;
+    session_isolation_level_ = MySQLDatabaseConfig::ISOLATION_LEVEL_UNSPECIFIED;
   }
-  return absl::OkStatus();
+}
+
+void MySqlMetadataSource::SwitchConnection() {
+  DiscardResultSet();
+  std::swap(db_, replica_db_);
+  prepared_statements_.swap(replica_prepared_statements_);
+  std::swap(session_isolation_level_, replica_session_isolation_level_);
+  on_replica_ = !on_replica_;
+}
+
+void MySqlMetadataSource::CloseReplica() {
+  SwitchConnection();
+  CloseConnection();
+  SwitchConnection();
+  replica_lag_ok_ = false;
+  replica_lag_check_time_ = absl::InfinitePast();
+}
+
+Status MySqlMetadataSource::ConnectReplica() {
+  replica_index_ = (replica_index_ + 1) % config_.replicas_size();
+  const MySQLDatabaseConfig::ReplicaConfig& replica =
+      config_.replicas(replica_index_);
+  SwitchConnection();
+  Status status =
+      OpenConnection(replica.host(), replica.port(), replica.socket());
+  if (status.ok()) {
+    // The database is created by the replication of the primary.
+    status = RunQuery(absl::StrCat("USE ", config_.database()));
+  }
+  if (status.ok()) {
+    // The replica only runs the reads.
+    status = SetSessionIsolationLevel(read_isolation_level_);
+  }
+  if (!status.ok()) {
+    CloseConnection();
+  }
+  SwitchConnection();
+  return status;
+}
+
+Status MySqlMetadataSource::CheckReplicaLag() {
+  SwitchConnection();
+  Status status = RunQuery(kShowReplicaStatus);
+  if (status.ok()) {
+    // A server which is not a replica returns no row.
+    status = absl::FailedPreconditionError("The replica is not replicating.");
+    const MYSQL_ROW row =
+        result_set_ != nullptr ? mysql_fetch_row(result_set_) : nullptr;
+    const uint32 num_cols = row != nullptr ? mysql_num_fields(result_set_) : 0;
+    for (uint32 col = 0; col < num_cols; ++col) {
+      const MYSQL_FIELD* field = mysql_fetch_field_direct(result_set_, col);
+      if (field == nullptr ||
+          absl::string_view(field->name) != kSecondsBehindMaster) {
+        continue;
+      }
+      // The lag is NULL while the replication is stopped.
+      int64 lag_seconds;
+      if (row[col] == nullptr || !absl::SimpleAtoi(row[col], &lag_seconds)) {
+        status = absl::FailedPreconditionError(
+            "The replication of the replica is stopped.");
+      } else if (absl::Seconds(lag_seconds) > max_replica_lag_) {
+        status = absl::FailedPreconditionError(absl::StrCat(
+            "The replica lags behind by ", lag_seconds, " seconds."));
+      } else {
+        status = absl::OkStatus();
+      }
+      break;
+    }
+  }
+  SwitchConnection();
+  return status;
+}
+
+bool MySqlMetadataSource::ShouldReadFromReplica() {
+  if (config_.replicas().empty()) {
+    return false;
+  }
+  const absl::Time now = absl::Now();
+  // The replica may not have applied the writes of this connection yet.
+  if (now - last_write_time_ <= max_replica_lag_) {
+    return false;
+  }
+  if (replica_db_ == nullptr) {
+    if (now < next_replica_connect_time_) {
+      return false;
+    }
+    const Status status = ConnectReplica();
+    if (!status.ok()) {
+      LOG(WARNING) << "Reading from the primary, as the replica "
+                   << replica_index_ << " cannot be connected: " << status;
+      next_replica_connect_time_ = now + kReplicaReconnectInterval;
+      return false;
+    }
+  }
+  if (now - replica_lag_check_time_ >= kReplicaLagCheckInterval) {
+    const Status status = CheckReplicaLag();
+    replica_lag_ok_ = status.ok();
+    replica_lag_check_time_ = now;
+    if (!status.ok()) {
+      LOG(WARNING) << "Reading from the primary, as the replica "
+                   << replica_index_ << " is not usable: " << status;
+      // Other errors are from the connection, which is opened again later.
+      if (!absl::IsFailedPrecondition(status)) {
+        CloseReplica();
+        next_replica_connect_time_ = now + kReplicaReconnectInterval;
+      }
+    }
+  }
+  return replica_lag_ok_;
 }
 
 Status MySqlMetadataSource::ExecuteQueryImpl(const std::string& query,
@@ -196,24 +657,258 @@ Status MySqlMetadataSource::ExecuteQueryImpl(const std::string& query,
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    TypedRecordSet* results) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecutePreparedQueryImpl");
+  // The connection cannot serve a statement while a result set is pending.
+  DiscardResultSet();
+  MYSQL_STMT* stmt = nullptr;
+  MLMD_RETURN_IF_ERROR(GetOrPrepareStatement(query, &stmt));
+  const Status status = RunPreparedStatement(
+      stmt, values,
+      [this, stmt]() -> Status {
+        int execute_status = 0;
+        MLMD_RETURN_IF_ERROR(ExecuteStatement(stmt, &execute_status));
+        if (execute_status) {
+          return PreparedStatementError(stmt, "mysql_stmt_execute");
+        }
+        return absl::OkStatus();
+      },
+      results);
+  // Releases any unread rows, so that the statement can be executed again. The
+  // statement is already closed if the connection was abandoned.
+  if (db_ != nullptr) {
+    mysql_stmt_free_result(stmt);
+  }
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(status, "Prepared query ", query, ": ");
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::ExecuteStreamingQueryImpl(
+    const std::string& query, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecuteStreamingQueryImpl");
+  MLMD_RETURN_IF_ERROR(RunQuery(query, /*stream_results=*/true));
+  if (result_set_ == nullptr) {
+    // The query does not produce a result set, e.g., insert or update.
+    return absl::OkStatus();
+  }
+  const Status status =
+      StreamResultSet(db_, result_set_, max_batch_size, callback);
+  // Fetches the unread rows, so that the connection can serve other queries.
+  DiscardResultSet();
+  return status;
+}
+
+Status MySqlMetadataSource::ExecutePipelinedQueriesImpl(
+    const absl::Span<const PipelinedQuery> queries,
+    std::vector<TypedRecordSet>* results) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecutePipelinedQueriesImpl");
+  std::vector<std::string> statements(queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    MLMD_RETURN_IF_ERROR(InlinePreparedValues(
+        queries[i].query, queries[i].values, &statements[i]));
+    // The statements are joined with semicolons.
+    absl::string_view statement =
+        absl::StripTrailingAsciiWhitespace(statements[i]);
+    absl::ConsumeSuffix(&statement, ";");
+    statements[i] = std::string(statement);
+  }
+  const std::string multi_statement_query = absl::StrJoin(statements, "; ");
+  MLMD_RETURN_IF_ERROR(RunQuery(multi_statement_query));
+
+  // RunQuery stores the result set of the first statement, and each of the
+  // next ones is read from the connection after the previous one is freed.
+  results->clear();
+  results->resize(queries.size());
+  Status status;
+  for (int i = 0; i < queries.size(); ++i) {
+    if (i > 0) {
+      DiscardResultSet();
+      int next_result = 0;
+      status = NextResult(&next_result);
+      if (!status.ok()) break;
+      if (next_result != 0) {
+        status = absl::InternalError(absl::StrCat(
+            "mysql_next_result failed for statement ", i,
+            ": errno: ", mysql_errno(db_), ", error: ", mysql_error(db_)));
+        if (mysql_errno(db_) == 1213 || mysql_errno(db_) == 1205) {
+          status = absl::AbortedError(status.message());
+        }
+        break;
+      }
+      status = StoreResult(&result_set_);
+      if (!status.ok()) break;
+      if (result_set_ == nullptr && mysql_field_count(db_) != 0) {
+        status = absl::InternalError(absl::StrCat(
+            "mysql_store_result failed for statement ", i,
+            ": errno: ", mysql_errno(db_), ", error: ", mysql_error(db_)));
+        break;
+      }
+    }
+    if (result_set_ == nullptr) continue;
+    TypedRecordSet& record_set = (*results)[i];
+    status = StreamResultSet(
+        db_, result_set_, std::numeric_limits<int>::max(),
+        [&record_set](const TypedRecordSet& batch) {
+          record_set = batch;
+          return absl::OkStatus();
+        });
+    if (!status.ok()) break;
+  }
+  DiscardResultSet();
+  // Reads the results of the statements left after a failure, so that the
+  // connection can serve other queries.
+  int next_result = 0;
+  while (db_ != nullptr && mysql_more_results(db_) &&
+         NextResult(&next_result).ok() && next_result == 0) {
+    MYSQL_RES* result_set = nullptr;
+    if (!StoreResult(&result_set).ok()) break;
+    if (result_set != nullptr) mysql_free_result(result_set);
+  }
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(status, "Pipelined queries ",
+                                    multi_statement_query, ": ");
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::GetOrPrepareStatement(const std::string& query,
+                                                  MYSQL_STMT** stmt) {
+  const auto it = prepared_statements_.find(query);
+  if (it != prepared_statements_.end()) {
+    *stmt = it->second;
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(CheckConnected());
+  if (prepared_statements_.size() >= kMaxNumPreparedStatements) {
+    ClosePreparedStatements();
+  }
+  MYSQL_STMT* new_stmt = mysql_stmt_init(db_);
+  if (new_stmt == nullptr) {
+    return absl::InternalError(
+        absl::StrCat("mysql_stmt_init failed: errno: ", mysql_errno(db_),
+                     ", error: ", mysql_error(db_)));
+  }
+  int prepare_status = 0;
+  const Status await_status =
+      PrepareStatement(new_stmt, query, &prepare_status);
+  if (!await_status.ok()) {
+    // The statement is not cached yet, so it is freed here.
+    mysql_stmt_close(new_stmt);
+    return await_status;
+  }
+  if (prepare_status) {
+    const Status status = PreparedStatementError(
+        new_stmt, absl::StrCat("mysql_stmt_prepare of ", query));
+    mysql_stmt_close(new_stmt);
+    return status;
+  }
+  prepared_statements_[query] = new_stmt;
+  *stmt = new_stmt;
+  return absl::OkStatus();
+}
+
+void MySqlMetadataSource::ClosePreparedStatements() {
+  for (const auto& query_and_stmt : prepared_statements_) {
+    mysql_stmt_close(query_and_stmt.second);
+  }
+  prepared_statements_.clear();
+}
+
 Status MySqlMetadataSource::CommitImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at CommitImpl");
-  return RunQuery(kCommitTransaction);
+  // If the commit fails, the transaction is closed by RollbackImpl.
+  MLMD_RETURN_IF_ERROR(RunQuery(kCommitTransaction));
+  if (write_transaction_open_) {
+    last_write_time_ = absl::Now();
+    write_transaction_open_ = false;
+  }
+  if (on_replica_) {
+    SwitchConnection();
+  }
+  return absl::OkStatus();
 }
 
 Status MySqlMetadataSource::RollbackImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at RollbackImpl");
 
-  return RunQuery(kRollbackTransaction);
+  // The transaction was rolled back by the server, if the connection was
+  // abandoned.
+  const Status status =
+      db_ != nullptr ? RunQuery(kRollbackTransaction) : absl::OkStatus();
+  write_transaction_open_ = false;
+  if (on_replica_) {
+    SwitchConnection();
+  }
+  return status;
 }
 
 Status MySqlMetadataSource::BeginImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at BeginImpl");
 
-  return RunQuery(kBeginTransaction);
+  MLMD_RETURN_IF_ERROR(SetSessionIsolationLevel(config_.isolation_level()));
+  MLMD_RETURN_IF_ERROR(RunQuery(kBeginTransaction));
+  write_transaction_open_ = true;
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::BeginReadOnlyImpl() {
+  return BeginReadOnly({kBeginReadOnlyTransaction});
+}
+
+Status MySqlMetadataSource::BeginSnapshotReadImpl() {
+  return BeginReadOnly({kSetRepeatableRead, kBeginSnapshotReadTransaction});
+}
+
+Status MySqlMetadataSource::BeginReadOnly(
+    const std::vector<std::string>& begin_queries) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at BeginReadOnlyImpl");
+
+  const auto run_begin_queries = [&]() -> Status {
+    MLMD_RETURN_IF_ERROR(SetSessionIsolationLevel(read_isolation_level_));
+    for (const std::string& query : begin_queries) {
+      MLMD_RETURN_IF_ERROR(RunQuery(query));
+    }
+    return absl::OkStatus();
+  };
+  if (ShouldReadFromReplica()) {
+    SwitchConnection();
+    const Status status = run_begin_queries();
+    if (status.ok()) {
+      return absl::OkStatus();
+    }
+    LOG(WARNING) << "Reading from the primary, as the replica "
+                 << replica_index_ << " failed: " << status;
+    SwitchConnection();
+    CloseReplica();
+    next_replica_connect_time_ = absl::Now() + kReplicaReconnectInterval;
+  }
+  return run_begin_queries();
+}
+
+Status MySqlMetadataSource::SetSessionIsolationLevel(
+    const MySQLDatabaseConfig::IsolationLevel level) {
+  // An unspecified level keeps the one of the session.
+  if (level == MySQLDatabaseConfig::ISOLATION_LEVEL_UNSPECIFIED ||
+      level == session_isolation_level_ || db_ == nullptr) {
+    return absl::OkStatus();
+  }
+  std::string level_name;
+  MLMD_RETURN_IF_ERROR(IsolationLevelName(level, &level_name));
+  MLMD_RETURN_IF_ERROR(RunQuery(
+      absl::StrCat("SET SESSION TRANSACTION ISOLATION LEVEL ", level_name)));
+  session_isolation_level_ = level;
+  return absl::OkStatus();
 }
 
 Status MySqlMetadataSource::CheckTransactionSupport() {
@@ -241,20 +936,35 @@ Status MySqlMetadataSource::CheckTransactionSupport() {
   return absl::OkStatus();
 }
 
-Status MySqlMetadataSource::RunQuery(const std::string& query) {
+Status MySqlMetadataSource::RunQuery(const std::string& query,
+                                     const bool stream_results) {
   DiscardResultSet();
 
-  int query_status = mysql_query(db_, query.c_str());
+  // A connection abandoned at a deadline is opened again by the next
+  // transaction, as after the error 2006 below.
+  if (db_ == nullptr && !on_replica_ &&
+      (query == kBeginTransaction || query == kBeginReadOnlyTransaction)) {
+    MLMD_RETURN_IF_ERROR(CloseImpl());
+    MLMD_RETURN_IF_ERROR(ConnectImpl());
+    NoteReconnection();
+  }
+  MLMD_RETURN_IF_ERROR(CheckConnected());
+
+  int query_status = 0;
+  MLMD_RETURN_IF_ERROR(RealQuery(query, &query_status));
   if (query_status) {
     int64 error_number = mysql_errno(db_);
     // 2006: sever closes the connection due to inactive client;
     // client reports server has gone away, we reconnect the server for the
-    // client if the query is begin transaction.
-    if (error_number == 2006 && query == kBeginTransaction) {
+    // client if the query is begin transaction. A lost replica is not
+    // reconnected here, so that the read falls back to the primary.
+    if (error_number == 2006 && !on_replica_ &&
+        (query == kBeginTransaction || query == kBeginReadOnlyTransaction)) {
       MLMD_RETURN_IF_ERROR(CloseImpl());
       MLMD_RETURN_IF_ERROR(ConnectImpl());
+      NoteReconnection();
 
-      return RunQuery(query);
+      return RunQuery(query, stream_results);
     }
     // 1213: inno db aborts deadlock when running concurrent transactions.
     // returns Aborted for client side to retry.
@@ -268,7 +978,11 @@ Status MySqlMetadataSource::RunQuery(const std::string& query) {
                      ", error: ", mysql_error(db_)));
   }
 
-  result_set_ = mysql_store_result(db_);
+  if (stream_results) {
+    result_set_ = mysql_use_result(db_);
+  } else {
+    MLMD_RETURN_IF_ERROR(StoreResult(&result_set_));
+  }
   if (!result_set_ && mysql_field_count(db_) != 0) {
     return absl::InternalError(absl::StrCat(
         "mysql_query ", query,
@@ -279,13 +993,145 @@ Status MySqlMetadataSource::RunQuery(const std::string& query) {
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::CheckConnected() const {
+  if (db_ == nullptr) {
+    return absl::FailedPreconditionError(
+        "The MYSQL connection was abandoned at the query deadline, and its "
+        "transaction is rolled back.");
+  }
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::AwaitCall(int status,
+                                      const std::function<int(int)>& cont) {
+  while (status != 0) {
+    absl::Time wake_up_time = query_deadline_;
+    if (status & MYSQL_WAIT_TIMEOUT) {
+      wake_up_time =
+          std::min(wake_up_time, absl::Now() + absl::Milliseconds(
+                                     mysql_get_timeout_value_ms(db_)));
+    }
+    int timeout_ms = -1;
+    if (wake_up_time != absl::InfiniteFuture()) {
+      // Rounds up, so that the poll does not return before the time.
+      const int64 wait_ms = absl::ToInt64Milliseconds(
+          wake_up_time - absl::Now() + absl::Milliseconds(1));
+      timeout_ms = static_cast<int>(std::min<int64>(
+          std::max<int64>(wait_ms, 0), std::numeric_limits<int>::max()));
+    }
+    struct pollfd poll_fd;
+    poll_fd.fd = mysql_get_socket(db_);
+    poll_fd.events = ((status & MYSQL_WAIT_READ) ? POLLIN : 0) |
+                     ((status & MYSQL_WAIT_WRITE) ? POLLOUT : 0) |
+                     ((status & MYSQL_WAIT_EXCEPT) ? POLLPRI : 0);
+    poll_fd.revents = 0;
+    const int num_ready = poll(&poll_fd, 1, timeout_ms);
+    if (num_ready < 0) {
+      if (errno == EINTR) continue;
+      const int poll_errno = errno;
+      AbandonConnection();
+      return absl::InternalError(
+          absl::StrCat("poll of the MYSQL connection failed: errno: ",
+                       poll_errno));
+    }
+    int events = 0;
+    if (num_ready == 0) {
+      if (absl::Now() >= query_deadline_) {
+        AbandonConnection();
+        return absl::DeadlineExceededError(
+            "The MYSQL query did not complete before the query deadline.");
+      }
+      if (!(status & MYSQL_WAIT_TIMEOUT)) continue;
+      events = MYSQL_WAIT_TIMEOUT;
+    } else {
+      if (poll_fd.revents & POLLIN) events |= MYSQL_WAIT_READ;
+      if (poll_fd.revents & POLLOUT) events |= MYSQL_WAIT_WRITE;
+      if (poll_fd.revents & POLLPRI) events |= MYSQL_WAIT_EXCEPT;
+      // The call reads the error of a closed socket from the awaited event.
+      if (poll_fd.revents & (POLLHUP | POLLERR)) {
+        events |= status & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE);
+      }
+    }
+    status = cont(events);
+  }
+  return absl::OkStatus();
+}
+
+void MySqlMetadataSource::AbandonConnection() {
+  // No result set is pending while a call waits for the server.
+  DiscardResultSet();
+  mysql_close(db_);
+  db_ = nullptr;
+  // The statements are detached from the closed connection by mysql_close.
+  ClosePreparedStatements();
+  session_isolation_level_ = MySQLDatabaseConfig::ISOLATION_LEVEL_UNSPECIFIED;
+  write_transaction_open_ = false;
+}
+
+Status MySqlMetadataSource::RealQuery(const std::string& query, int* ret) {
+  if (!config_.enable_nonblocking_io()) {
+    *ret = mysql_real_query(db_, query.data(), query.size());
+    return absl::OkStatus();
+  }
+  return AwaitCall(
+      mysql_real_query_start(ret, db_, query.data(), query.size()),
+      [this, ret](int events) {
+        return mysql_real_query_cont(ret, db_, events);
+      });
+}
+
+Status MySqlMetadataSource::StoreResult(MYSQL_RES** ret) {
+  if (!config_.enable_nonblocking_io()) {
+    *ret = mysql_store_result(db_);
+    return absl::OkStatus();
+  }
+  return AwaitCall(mysql_store_result_start(ret, db_),
+                   [this, ret](int events) {
+                     return mysql_store_result_cont(ret, db_, events);
+                   });
+}
+
+Status MySqlMetadataSource::NextResult(int* ret) {
+  if (!config_.enable_nonblocking_io()) {
+    *ret = mysql_next_result(db_);
+    return absl::OkStatus();
+  }
+  return AwaitCall(mysql_next_result_start(ret, db_),
+                   [this, ret](int events) {
+                     return mysql_next_result_cont(ret, db_, events);
+                   });
+}
+
+Status MySqlMetadataSource::PrepareStatement(MYSQL_STMT* stmt,
+                                             const std::string& query,
+                                             int* ret) {
+  if (!config_.enable_nonblocking_io()) {
+    *ret = mysql_stmt_prepare(stmt, query.data(), query.size());
+    return absl::OkStatus();
+  }
+  return AwaitCall(
+      mysql_stmt_prepare_start(ret, stmt, query.data(), query.size()),
+      [stmt, ret](int events) {
+        return mysql_stmt_prepare_cont(ret, stmt, events);
+      });
+}
+
+Status MySqlMetadataSource::ExecuteStatement(MYSQL_STMT* stmt, int* ret) {
+  if (!config_.enable_nonblocking_io()) {
+    *ret = mysql_stmt_execute(stmt);
+    return absl::OkStatus();
+  }
+  return AwaitCall(mysql_stmt_execute_start(ret, stmt),
+                   [stmt, ret](int events) {
+                     return mysql_stmt_execute_cont(ret, stmt, events);
+                   });
+}
+
 void MySqlMetadataSource::DiscardResultSet() {
   if (result_set_ != nullptr) {
-    // Fetch any leftover rows (MySQL requires this).
-    // Note: Since we always store the query result locally in RunQuery(),
-    // we might not need to explicitly fetch the row here. But fetching rows
-    // here won't hurt and will be a bit more robust in case we decide to lazily
-    // fetch the rows from the server.
+    // Fetch any leftover rows (MySQL requires this). The rows of a streamed
+    // query are read lazily from the server, so a query stopped by its
+    // callback still has rows pending on the connection.
     while (mysql_fetch_row(result_set_)) {
     }
     mysql_free_result(result_set_);
@@ -339,14 +1185,19 @@ Status MySqlMetadataSource::ConvertMySqlRowSetToRecordSet(
 
 std::string MySqlMetadataSource::EscapeString(absl::string_view value) const {
   CHECK(db_ != nullptr);
+  // Most strings, e.g., names and uris, have no byte to escape, and are copied
+  // as is.
+  if (FindMySqlSpecialByte(value) == absl::string_view::npos) {
+    return std::string(value);
+  }
   // in the worst case, each character needs to be escaped by backslash, and the
   // string is appended an additional terminating null character.
-  char* buffer = new char[value.length() * 2 + 1];
-  CHECK(mysql_real_escape_string(db_, buffer, value.data(), value.length()) !=
-        -1UL)
+  std::string result(value.length() * 2 + 1, '\0');
+  const unsigned long length =  // NOLINT
+      mysql_real_escape_string(db_, &result[0], value.data(), value.length());
+  CHECK(length != -1UL)
       << "NO_BACKSLASH_ESCAPES SQL mode should not be enabled.";
-  std::string result(buffer);
-  delete[] buffer;
+  result.resize(length);
   return result;
 }
 
@@ -15,10 +15,16 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_MYSQL_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_MYSQL_METADATA_SOURCE_H_
 
+#include <functional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "mysql.h"
@@ -26,6 +32,8 @@ limitations under the License.
 namespace ml_metadata {
 
 // A MetadataSource based on a MYSQL backend.
+// If the config has replicas, the read-only transactions are routed to a
+// connection to one of them, see MySQLDatabaseConfig.replicas.
 // This class is thread-unsafe.
 class MySqlMetadataSource : public MetadataSource {
  public:
@@ -44,38 +52,138 @@ class MySqlMetadataSource : public MetadataSource {
   // the metadata source is not connected.
   std::string EscapeString(absl::string_view value) const final;
 
+  // The deadline is only enforced with enable_nonblocking_io.
+  void SetQueryDeadline(absl::Time deadline) final {
+    query_deadline_ = deadline;
+  }
+
+  bool reads_from_replica() const final { return on_replica_; }
+
  private:
   // Connects to the MYSQL backend specified in options_.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
   absl::Status ConnectImpl() final;
 
-  // Closes the existing open connection to the MYSQL backend.
-  // Any existing MYSQL_RES in `result_set_` is also cleaned up.
+  // Closes the existing open connections to the MYSQL backend, including the
+  // one to a replica.
+  // Any existing MYSQL_RES in `result_set_` and the prepared statements are
+  // also cleaned up.
   absl::Status CloseImpl() final;
 
   // Opens a transaction.
   absl::Status BeginImpl() final;
 
+  // Opens a transaction with START TRANSACTION READ ONLY, on a replica if one
+  // can serve it, otherwise on the primary.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Opens a REPEATABLE READ read-only transaction WITH CONSISTENT SNAPSHOT,
+  // so that the snapshot is taken at once, like BeginReadOnlyImpl.
+  absl::Status BeginSnapshotReadImpl() final;
+
   // Executes a SQL statement and returns the rows if any.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
   absl::Status ExecuteQueryImpl(const std::string& query,
                                 RecordSet* results) final;
 
+  // Executes a query with `?` placeholders using a cached MYSQL_STMT, which
+  // is sent to the server with the binary protocol.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status ExecutePreparedQueryImpl(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values,
+      TypedRecordSet* results) final;
+
+  // Executes a query with mysql_use_result, and fetches its rows in batches.
+  absl::Status ExecuteStreamingQueryImpl(
+      const std::string& query, int max_batch_size,
+      const RecordBatchCallback& callback) final;
+
+  // Executes the queries as one multi-statement query with the values inlined,
+  // and reads the result set of each statement with mysql_next_result.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status ExecutePipelinedQueriesImpl(
+      absl::Span<const PipelinedQuery> queries,
+      std::vector<TypedRecordSet>* results) final;
+
   // Commits the currently open transaction.
   absl::Status CommitImpl() final;
 
   // Rollbacks the currently open transaction.
   absl::Status RollbackImpl() final;
 
+  // Opens a connection to the server at `host`, `port` or `socket` in `db_`.
+  absl::Status OpenConnection(const std::string& host, uint32 port,
+                              const std::string& socket);
+
+  // Closes the connection in `db_` with its result set and prepared
+  // statements.
+  void CloseConnection();
+
+  // Swaps the connection in `db_`, its prepared statements and isolation
+  // level with the replica ones, so that the queries run on the other server.
+  void SwitchConnection();
+
+  // Returns true if the next read-only transaction can run on the replica,
+  // which is connected if needed and whose lag is checked periodically.
+  bool ShouldReadFromReplica();
+
+  // Connects to the next replica of the config.
+  absl::Status ConnectReplica();
+
+  // Closes the connection to the replica, if any.
+  void CloseReplica();
+
+  // Returns an error if the replication of the replica is stopped, or it lags
+  // behind by more than `max_replica_lag_`.
+  absl::Status CheckReplicaLag();
+
   // Returns an error if the default storage engine doesn't support transaction
   // or OK otherwise.
   absl::Status CheckTransactionSupport();
 
+  // Sets the session isolation level of the connection in `db_` to `level`,
+  // unless it is already set. An abandoned connection is left as is: it is
+  // opened again by the next transaction.
+  absl::Status SetSessionIsolationLevel(
+      MySQLDatabaseConfig::IsolationLevel level);
+
+  // Opens a read-only transaction with `begin_queries`, on a replica if one
+  // can serve it, otherwise on the primary. The connection is set to
+  // `read_isolation_level_` first.
+  absl::Status BeginReadOnly(const std::vector<std::string>& begin_queries);
+
   // Runs the given query and stores the MYSQL_RES in result_set_.
   // Any existing MYSQL_RES in `result_set_` is cleaned up prior to issuing
-  // the given query.
+  // the given query. If `stream_results` is true, the rows are not stored
+  // client side, and are read from the server as they are fetched.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
-  absl::Status RunQuery(const std::string& query);
+  absl::Status RunQuery(const std::string& query, bool stream_results = false);
+
+  // Returns an error if the connection was abandoned, and not opened again.
+  absl::Status CheckConnected() const;
+
+  // Continues a call of the non-blocking API of the client library on `db_`
+  // that returned the wait `status`: it polls the socket for the events the
+  // call waits for, and passes them to `cont`, until the call completes.
+  // Returns DEADLINE_EXCEEDED error, if the call still waits at
+  // `query_deadline_`. The connection is then abandoned, as the call cannot
+  // be completed anymore.
+  absl::Status AwaitCall(int status, const std::function<int(int)>& cont);
+
+  // Closes `db_` without reading from it, e.g., after a call is abandoned
+  // midway. The prepared statements are only freed.
+  void AbandonConnection();
+
+  // The calls of the client library which wait for the server. They set the
+  // result of the call in `ret`. With enable_nonblocking_io, they wait with
+  // AwaitCall and return its errors; otherwise they block.
+  absl::Status RealQuery(const std::string& query, int* ret);
+  absl::Status StoreResult(MYSQL_RES** ret);
+  absl::Status NextResult(int* ret);
+  absl::Status PrepareStatement(MYSQL_STMT* stmt, const std::string& query,
+                                int* ret);
+  absl::Status ExecuteStatement(MYSQL_STMT* stmt, int* ret);
 
   // Discards any existing MYSQL_RES in `result_set_`.
   void DiscardResultSet();
@@ -83,15 +191,59 @@ class MySqlMetadataSource : public MetadataSource {
   // Converts the MYSQL_RES in `result_set_` to `record_set_out`.
   absl::Status ConvertMySqlRowSetToRecordSet(RecordSet* record_set_out);
 
+  // Returns the cached MYSQL_STMT of the `query`, and prepares it if it is not
+  // cached yet.
+  // Returns an INTERNAL error, if the query cannot be prepared.
+  absl::Status GetOrPrepareStatement(const std::string& query,
+                                     MYSQL_STMT** stmt);
+
+  // Closes all cached prepared statements.
+  void ClosePreparedStatements();
+
   // The handler for the connection to the MYSQL backend.
   // Initialized in ConnectImpl().
   MYSQL* db_ = nullptr;
+  // The session isolation level of `db_`. It is unspecified until set, as a
+  // new connection starts at the server default.
+  MySQLDatabaseConfig::IsolationLevel session_isolation_level_ =
+      MySQLDatabaseConfig::ISOLATION_LEVEL_UNSPECIFIED;
 
   // The ResultSet from the previously executed query in RunQuery.
   MYSQL_RES* result_set_ = nullptr;
 
+  // The prepared statements of the current connection keyed by query text.
+  // They are closed together with the connection.
+  absl::flat_hash_map<std::string, MYSQL_STMT*> prepared_statements_;
+
   // Config to connect to the MYSQL backend.
   const MySQLDatabaseConfig config_;
+
+  // The connection to a replica and its prepared statements, which are
+  // swapped with `db_` and `prepared_statements_` while a transaction runs on
+  // the replica. It is nullptr if no replica is connected.
+  MYSQL* replica_db_ = nullptr;
+  absl::flat_hash_map<std::string, MYSQL_STMT*> replica_prepared_statements_;
+  MySQLDatabaseConfig::IsolationLevel replica_session_isolation_level_ =
+      MySQLDatabaseConfig::ISOLATION_LEVEL_UNSPECIFIED;
+  // True if the connection in `db_` is the one to the replica.
+  bool on_replica_ = false;
+  // The index in config_.replicas() of the last connected replica.
+  int replica_index_;
+  const absl::Duration max_replica_lag_;
+  // The isolation level of the read-only transactions.
+  const MySQLDatabaseConfig::IsolationLevel read_isolation_level_;
+  // A replica is not connected again before this time, after a failure.
+  absl::Time next_replica_connect_time_ = absl::InfinitePast();
+  // The last time the replica lag was checked, and whether it was acceptable.
+  absl::Time replica_lag_check_time_ = absl::InfinitePast();
+  bool replica_lag_ok_ = false;
+  // True while a read-write transaction is open on the primary.
+  bool write_transaction_open_ = false;
+  // The commit time of the last read-write transaction.
+  absl::Time last_write_time_ = absl::InfinitePast();
+  // The calls still waiting for the server at this time are abandoned, with
+  // enable_nonblocking_io.
+  absl::Time query_deadline_ = absl::InfiniteFuture();
 };
 
 }  // namespace ml_metadata
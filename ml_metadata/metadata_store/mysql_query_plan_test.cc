@@ -0,0 +1,171 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Checks the query plans of the templates of the MySQL query config.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/query_plan_test_suite.h"
+#include "ml_metadata/metadata_store/test_mysql_metadata_source_initializer.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+// Returns the index of `column_name` in the columns of `record_set`, or -1.
+int GetColumnIndex(const RecordSet& record_set,
+                   const std::string& column_name) {
+  for (int i = 0; i < record_set.column_names_size(); i++) {
+    if (record_set.column_names(i) == column_name) return i;
+  }
+  return -1;
+}
+
+// MySqlQueryPlanContainer explains the queries with EXPLAIN on a
+// MySqlMetadataSource of a test server.
+class MySqlQueryPlanContainer : public QueryPlanContainer {
+ public:
+  MySqlQueryPlanContainer() {
+    metadata_source_initializer_ = GetTestMySqlMetadataSourceInitializer();
+    metadata_source_ = metadata_source_initializer_->Init(
+        TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  }
+
+  ~MySqlQueryPlanContainer() override {
+    metadata_source_initializer_->Cleanup();
+  }
+
+  MetadataSource* GetMetadataSource() override { return metadata_source_; }
+
+  const MetadataSourceQueryConfig& GetQueryConfig() override {
+    return util::GetMySqlMetadataSourceQueryConfig();
+  }
+
+  absl::Status AnalyzeTables() override {
+    return metadata_source_->ExecuteQuery(
+        "ANALYZE TABLE `Type`, `TypeProperty`, `ParentType`, `Artifact`, "
+        "`ArtifactProperty`, `Execution`, `ExecutionProperty`, `Context`, "
+        "`ContextProperty`, `ParentContext`, `Event`, `EventPath`, "
+        "`Association`, `Attribution`;",
+        nullptr);
+  }
+
+  // A row of EXPLAIN reads `table` in full if its access `type` is ALL, or
+  // index, i.e., all the entries of `key`.
+  absl::Status ExplainQuery(const std::string& query,
+                            QueryPlan* plan) override {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(metadata_source_->ExecuteQuery(
+        absl::StrCat("EXPLAIN ", query), &record_set));
+    const int table = GetColumnIndex(record_set, "table");
+    const int type = GetColumnIndex(record_set, "type");
+    const int key = GetColumnIndex(record_set, "key");
+    if (table < 0 || type < 0 || key < 0) {
+      return absl::InternalError(
+          absl::StrCat("Unexpected columns of EXPLAIN: ",
+                       record_set.DebugString()));
+    }
+    for (const RecordSet::Record& record : record_set.records()) {
+      if (record.values(type) == "ALL" || record.values(type) == "index") {
+        plan->full_scans.push_back(record.values(table));
+      }
+      if (record.values(key) != kMetadataSourceNull) {
+        plan->indices.push_back(record.values(key));
+      }
+      absl::StrAppend(&plan->description, record.values(table), " ",
+                      record.values(type), " ", record.values(key), "; ");
+    }
+    return absl::OkStatus();
+  }
+
+  std::map<std::string, QueryPlanExpectation> GetExpectedPlans() override {
+    return {
+        // The listing queries, and the ones of the small tables.
+        {"select_all_types", {{"Type"}, {}}},
+        {"update_schema_version", {{"MLMDEnv"}, {}}},
+        {"select_migration_checkpoint", {{"MLMDEnvMigration"}, {}}},
+        {"select_id_list", {{"IdList"}, {}}},
+        // The background jobs, which read the tables in chunks.
+        {"select_idempotency_keys_created_before",
+         {{"MLMDIdempotencyKey"}, {}}},
+        {"select_event_ids_with_path_steps", {{"EventPath"}, {}}},
+        {"select_artifact_ids_without_properties_bytes", {{"Artifact"}, {}}},
+        {"select_execution_ids_without_properties_bytes", {{"Execution"}, {}}},
+        {"select_context_ids_without_properties_bytes", {{"Context"}, {}}},
+        // The recursive queries scan their derived tables.
+        {"select_ancestor_contexts_by_context_id",
+         {{"A", "Ancestor", "<derived2>"}, {}}},
+        {"select_descendant_contexts_by_context_id",
+         {{"D", "Descendant", "<derived2>"},
+          {"idx_parentcontext_parent_context_id"}}},
+        // The unique keys of Attribution and Association lead with the
+        // context, and there is no index of the artifacts and executions yet.
+        {"delete_attributions_by_artifacts_id", {{"Attribution"}, {}}},
+        {"select_attribution_by_artifact_id", {{"Attribution"}, {}}},
+        {"select_attributions_by_artifact_ids", {{"Attribution"}, {}}},
+        {"select_contexts_by_artifact_id", {{"C", "Attribution"}, {}}},
+        {"select_context_property_by_artifact_id",
+         {{"P", "Attribution"}, {}}},
+        {"delete_associations_by_executions_id", {{"Association"}, {}}},
+        {"select_association_by_execution_id", {{"Association"}, {}}},
+        {"select_associations_by_execution_ids", {{"Association"}, {}}},
+        // The lookups which have a secondary index of their own.
+        {"select_type_by_name", {{}, {"idx_type_name"}}},
+        {"select_artifacts_by_uri", {{}, {"idx_artifact_uri"}}},
+        {"select_artifacts_by_uri_prefix", {{}, {"idx_artifact_uri"}}},
+        {"select_artifact_ids_by_type_id_updated_before",
+         {{}, {"idx_artifact_type_id_last_update_time"}}},
+        {"select_execution_ids_by_type_id_updated_before",
+         {{}, {"idx_execution_type_id_last_update_time"}}},
+        {"select_event_by_artifact_ids",
+         {{}, {"idx_event_artifact_id_covering"}}},
+        {"select_event_by_execution_ids",
+         {{}, {"idx_event_execution_id_covering"}}},
+        {"select_event_path_by_event_ids", {{}, {"idx_eventpath_event_id"}}},
+        {"select_parent_context_by_parent_context_id",
+         {{}, {"idx_parentcontext_parent_context_id"}}},
+    };
+  }
+
+ private:
+  // An unowned TestMySqlMetadataSourceInitializer from a call to
+  // GetTestMySqlMetadataSourceInitializer().
+  std::unique_ptr<TestMySqlMetadataSourceInitializer>
+      metadata_source_initializer_;
+  // An unowned MySqlMetadataSource from a call to
+  // metadata_source_initializer->Init().
+  MySqlMetadataSource* metadata_source_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(MySqlQueryPlanTest, QueryPlanTestSuite,
+                         ::testing::Values([]() {
+                           return absl::make_unique<MySqlQueryPlanContainer>();
+                         }));
+
+}  // namespace testing
+}  // namespace ml_metadata
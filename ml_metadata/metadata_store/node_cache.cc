@@ -0,0 +1,110 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_cache.h"
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/wire_format_lite.h"
+
+namespace ml_metadata {
+namespace {
+
+template <typename Shard>
+void CreateShards(const int num_shards,
+                  std::vector<std::unique_ptr<Shard>>* shards) {
+  for (int i = 0; i < num_shards; i++) {
+    shards->push_back(absl::make_unique<Shard>());
+  }
+}
+
+template <typename Shards>
+int64 CountBytes(const Shards& shards) {
+  int64 num_bytes = 0;
+  for (const auto& shard : shards) {
+    absl::MutexLock lock(&shard->mu);
+    num_bytes += shard->num_bytes;
+  }
+  return num_bytes;
+}
+
+}  // namespace
+
+void AppendLengthDelimitedField(const int field_number,
+                                const absl::string_view value,
+                                std::string* output) {
+  google::protobuf::io::StringOutputStream stream(output);
+  google::protobuf::io::CodedOutputStream coded_stream(&stream);
+  coded_stream.WriteTag(google::protobuf::internal::WireFormatLite::MakeTag(
+      field_number,
+      google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  coded_stream.WriteVarint32(value.size());
+  coded_stream.WriteRaw(value.data(), value.size());
+}
+
+NodeCache::NodeCache(const int64 max_num_bytes, const int num_shards,
+                     const bool retain_serialized_nodes)
+    : max_num_bytes_per_shard_(max_num_bytes / 3 / std::max(num_shards, 1)),
+      retain_serialized_nodes_(retain_serialized_nodes) {
+  CHECK_GT(num_shards, 0) << "The num_shards must be positive.";
+  CHECK_GT(max_num_bytes_per_shard_, 0)
+      << "The max_num_bytes must be positive.";
+  CreateShards(num_shards, &entries<Artifact>().shards);
+  CreateShards(num_shards, &entries<Execution>().shards);
+  CreateShards(num_shards, &entries<Context>().shards);
+}
+
+void NodeCache::InvalidateSince(const int64 generation) {
+  std::vector<int64> artifact_ids;
+  std::vector<int64> execution_ids;
+  std::vector<int64> context_ids;
+  bool complete = true;
+  {
+    absl::MutexLock lock(&invalidation_mu_);
+    ++generation_;
+    complete &= InvalidatedIdsSinceLocked<Artifact>(generation, &artifact_ids);
+    complete &=
+        InvalidatedIdsSinceLocked<Execution>(generation, &execution_ids);
+    complete &= InvalidatedIdsSinceLocked<Context>(generation, &context_ids);
+  }
+  if (!complete) {
+    EraseAll<Artifact>();
+    EraseAll<Execution>();
+    EraseAll<Context>();
+    return;
+  }
+  Erase<Artifact>(artifact_ids);
+  Erase<Execution>(execution_ids);
+  Erase<Context>(context_ids);
+}
+
+void NodeCache::Clear() {
+  {
+    absl::MutexLock lock(&invalidation_mu_);
+    ++generation_;
+  }
+  EraseAll<Artifact>();
+  EraseAll<Execution>();
+  EraseAll<Context>();
+}
+
+int64 NodeCache::num_bytes() const {
+  return CountBytes(std::get<Entries<Artifact>>(entries_).shards) +
+         CountBytes(std::get<Entries<Execution>>(entries_).shards) +
+         CountBytes(std::get<Entries<Context>>(entries_).shards);
+}
+
+}  // namespace ml_metadata
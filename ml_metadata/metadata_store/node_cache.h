@@ -0,0 +1,322 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_NODE_CACHE_H_
+#define ML_METADATA_METADATA_STORE_NODE_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Appends `value` to `output` as the length-delimited field `field_number` of
+// a serialized message, i.e., its tag and length followed by its bytes.
+void AppendLengthDelimitedField(int field_number, absl::string_view value,
+                                std::string* output);
+
+// A thread-safe LRU cache of the Artifacts, Executions and Contexts stored in
+// one database, keyed by node id. It lets the MetadataAccessObjects connected
+// to the same database, e.g., the ones of a MetadataStorePool, share the
+// nodes they have read, as the nodes read repeatedly, e.g., by UIs, are mostly
+// finished ones which no longer change.
+//
+// The entries of each kind are split into shards with their own lock and LRU
+// order, and the least recently used entries of a shard are evicted once its
+// share of `max_num_bytes` is used. An entry is only returned to connections
+// with the schema version it was read with.
+//
+// A node must be invalidated by Invalidate() before it is changed or deleted,
+// which also moves the cache to the next generation. A node read when the
+// cache was at an earlier generation is not inserted, as it may be stale. As
+// a node read by another transaction before the change is committed is stale
+// as well, the transaction calls InvalidateSince() once it is committed or
+// rolled back, which invalidates again the nodes invalidated meanwhile.
+//
+// The changes of nodes made by other processes are not observed, so a cache
+// should only be used if all node changes go through the stores sharing it.
+//
+// If `retain_serialized_nodes` is set, each entry also keeps the wire form of
+// its node, which AppendSerialized() splices into serialized responses, so
+// that a hot node is neither decoded from rows nor encoded again when it is
+// returned. The serialized nodes count towards `max_num_bytes` as well.
+class NodeCache {
+ public:
+  // The cached nodes of each kind use at most a third of `max_num_bytes`, as
+  // counted by their ByteSizeLong(), which is split evenly into `num_shards`.
+  explicit NodeCache(int64 max_num_bytes = 256 << 20, int num_shards = 16,
+                     bool retain_serialized_nodes = false);
+
+  // Disallow copy and assign.
+  NodeCache(const NodeCache&) = delete;
+  NodeCache& operator=(const NodeCache&) = delete;
+
+  // Returns the current generation, which should be read before reading nodes
+  // from the database and passed to Insert().
+  int64 generation() const { return generation_.load(); }
+
+  // Finds a cached node by its id. `Node` is one of {Artifact, Execution,
+  // Context}.
+  // Returns false, if the node is not cached for `schema_version`.
+  template <typename Node>
+  bool Find(int64 schema_version, int64 node_id, Node* node);
+
+  // Appends the wire form of a cached node to `output` as the length-delimited
+  // field `field_number` of a message, e.g., of a response listing the nodes
+  // of its kind, without copying the node.
+  // Returns false, if the node is not cached for `schema_version`, or if the
+  // serialized nodes are not retained.
+  template <typename Node>
+  bool AppendSerialized(int64 schema_version, int64 node_id, int field_number,
+                        std::string* output);
+
+  // Whether the entries keep the wire form of their nodes.
+  bool retains_serialized_nodes() const { return retain_serialized_nodes_; }
+
+  // Caches a node read from the database when the cache was at `generation`.
+  // Does nothing if the cache has been invalidated since then, or if the node
+  // is larger than a shard.
+  template <typename Node>
+  void Insert(int64 schema_version, int64 generation, const Node& node);
+
+  // Drops the nodes with the given ids and moves to the next generation.
+  template <typename Node>
+  void Invalidate(absl::Span<const int64> node_ids);
+
+  // Drops again the nodes invalidated after `generation`, and moves to the
+  // next generation. All nodes are dropped, if the invalidated ids are no
+  // longer known.
+  void InvalidateSince(int64 generation);
+
+  // Drops all entries and moves to the next generation.
+  void Clear();
+
+  // The number of lookups that found or did not find a cached node.
+  int64 num_hits() const { return num_hits_.load(); }
+  int64 num_misses() const { return num_misses_.load(); }
+
+  // The number of bytes used by the cached nodes of all kinds.
+  int64 num_bytes() const;
+
+ private:
+  // The number of invalidated ids of a kind kept for InvalidateSince().
+  static constexpr int kMaxNumInvalidatedIds = 1 << 16;
+
+  template <typename Node>
+  struct Shard {
+    struct Entry {
+      int64 node_id;
+      int64 schema_version;
+      int64 num_bytes;
+      Node node;
+      // The wire form of `node`, if the serialized nodes are retained.
+      std::string serialized_node;
+    };
+    mutable absl::Mutex mu;
+    // The entries, from the most to the least recently used.
+    std::list<Entry> entries ABSL_GUARDED_BY(mu);
+    absl::flat_hash_map<int64, typename std::list<Entry>::iterator> index
+        ABSL_GUARDED_BY(mu);
+    int64 num_bytes ABSL_GUARDED_BY(mu) = 0;
+
+    void EraseLocked(typename std::list<Entry>::iterator it)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      num_bytes -= it->num_bytes;
+      index.erase(it->node_id);
+      entries.erase(it);
+    }
+  };
+
+  template <typename Node>
+  struct Entries {
+    std::vector<std::unique_ptr<Shard<Node>>> shards;
+    // The invalidated ids with the generation they were invalidated at, from
+    // the oldest to the newest.
+    std::deque<std::pair<int64, int64>> invalidated_ids;
+  };
+
+  template <typename Node>
+  Entries<Node>& entries() {
+    return std::get<Entries<Node>>(entries_);
+  }
+
+  template <typename Node>
+  Shard<Node>& shard(const int64 node_id) {
+    const auto& shards = entries<Node>().shards;
+    return *shards[absl::Hash<int64>()(node_id) % shards.size()];
+  }
+
+  // Drops the given nodes from the shards.
+  template <typename Node>
+  void Erase(absl::Span<const int64> node_ids);
+
+  // Drops all nodes of a kind from the shards.
+  template <typename Node>
+  void EraseAll();
+
+  // Returns the ids of a kind invalidated after `generation`, or false if some
+  // of them have been forgotten.
+  template <typename Node>
+  bool InvalidatedIdsSinceLocked(int64 generation, std::vector<int64>* ids)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(invalidation_mu_);
+
+  const int64 max_num_bytes_per_shard_;
+  const bool retain_serialized_nodes_;
+  std::tuple<Entries<Artifact>, Entries<Execution>, Entries<Context>> entries_;
+
+  // Orders the generations and guards the invalidated ids of all kinds.
+  absl::Mutex invalidation_mu_;
+  std::atomic<int64> generation_{0};
+  // The newest generation whose invalidated ids have been forgotten.
+  int64 forgotten_generation_ ABSL_GUARDED_BY(invalidation_mu_) = -1;
+
+  std::atomic<int64> num_hits_{0};
+  std::atomic<int64> num_misses_{0};
+};
+
+template <typename Node>
+bool NodeCache::Find(const int64 schema_version, const int64 node_id,
+                     Node* node) {
+  Shard<Node>& node_shard = shard<Node>(node_id);
+  absl::MutexLock lock(&node_shard.mu);
+  const auto it = node_shard.index.find(node_id);
+  if (it == node_shard.index.end() ||
+      it->second->schema_version != schema_version) {
+    num_misses_++;
+    return false;
+  }
+  node_shard.entries.splice(node_shard.entries.begin(), node_shard.entries,
+                            it->second);
+  num_hits_++;
+  *node = it->second->node;
+  return true;
+}
+
+template <typename Node>
+bool NodeCache::AppendSerialized(const int64 schema_version,
+                                 const int64 node_id, const int field_number,
+                                 std::string* output) {
+  if (!retain_serialized_nodes_) return false;
+  Shard<Node>& node_shard = shard<Node>(node_id);
+  absl::MutexLock lock(&node_shard.mu);
+  const auto it = node_shard.index.find(node_id);
+  // A miss is counted by the Find() of the read which then finds the node.
+  if (it == node_shard.index.end() ||
+      it->second->schema_version != schema_version) {
+    return false;
+  }
+  node_shard.entries.splice(node_shard.entries.begin(), node_shard.entries,
+                            it->second);
+  num_hits_++;
+  AppendLengthDelimitedField(field_number, it->second->serialized_node,
+                             output);
+  return true;
+}
+
+template <typename Node>
+void NodeCache::Insert(const int64 schema_version, const int64 generation,
+                       const Node& node) {
+  std::string serialized_node;
+  if (retain_serialized_nodes_) serialized_node = node.SerializeAsString();
+  const int64 num_bytes =
+      node.ByteSizeLong() + sizeof(node) + serialized_node.size();
+  if (num_bytes > max_num_bytes_per_shard_) return;
+  Shard<Node>& node_shard = shard<Node>(node.id());
+  absl::MutexLock lock(&node_shard.mu);
+  // Invalidate() moves to the next generation before taking the shard lock,
+  // so a node read before then is either refused here or erased by it.
+  if (generation != generation_.load()) return;
+  const auto it = node_shard.index.find(node.id());
+  if (it != node_shard.index.end()) node_shard.EraseLocked(it->second);
+  node_shard.entries.push_front({node.id(), schema_version, num_bytes, node,
+                                 std::move(serialized_node)});
+  node_shard.index[node.id()] = node_shard.entries.begin();
+  node_shard.num_bytes += num_bytes;
+  while (node_shard.num_bytes > max_num_bytes_per_shard_) {
+    node_shard.EraseLocked(std::prev(node_shard.entries.end()));
+  }
+}
+
+template <typename Node>
+void NodeCache::Invalidate(const absl::Span<const int64> node_ids) {
+  if (node_ids.empty()) return;
+  {
+    absl::MutexLock lock(&invalidation_mu_);
+    const int64 generation = ++generation_;
+    auto& invalidated_ids = entries<Node>().invalidated_ids;
+    for (const int64 node_id : node_ids) {
+      invalidated_ids.push_back({generation, node_id});
+    }
+    while (invalidated_ids.size() > kMaxNumInvalidatedIds) {
+      forgotten_generation_ =
+          std::max(forgotten_generation_, invalidated_ids.front().first);
+      invalidated_ids.pop_front();
+    }
+  }
+  Erase<Node>(node_ids);
+}
+
+template <typename Node>
+void NodeCache::Erase(const absl::Span<const int64> node_ids) {
+  for (const int64 node_id : node_ids) {
+    Shard<Node>& node_shard = shard<Node>(node_id);
+    absl::MutexLock lock(&node_shard.mu);
+    const auto it = node_shard.index.find(node_id);
+    if (it != node_shard.index.end()) node_shard.EraseLocked(it->second);
+  }
+}
+
+template <typename Node>
+void NodeCache::EraseAll() {
+  for (const auto& node_shard : entries<Node>().shards) {
+    absl::MutexLock lock(&node_shard->mu);
+    node_shard->entries.clear();
+    node_shard->index.clear();
+    node_shard->num_bytes = 0;
+  }
+}
+
+template <typename Node>
+bool NodeCache::InvalidatedIdsSinceLocked(const int64 generation,
+                                          std::vector<int64>* ids) {
+  const auto& invalidated_ids = entries<Node>().invalidated_ids;
+  const auto begin = std::partition_point(
+      invalidated_ids.begin(), invalidated_ids.end(),
+      [generation](const std::pair<int64, int64>& invalidated_id) {
+        return invalidated_id.first <= generation;
+      });
+  for (auto it = begin; it != invalidated_ids.end(); ++it) {
+    ids->push_back(it->second);
+  }
+  return forgotten_generation_ <= generation;
+}
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_NODE_CACHE_H_
@@ -0,0 +1,155 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+
+constexpr int64 kSchemaVersion = 7;
+
+TEST(NodeCacheTest, FindInsertedNodes) {
+  NodeCache cache;
+  const Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    id: 1 type_id: 2 uri: 'a' properties { key: 'p' value { int_value: 3 } }
+  )");
+  cache.Insert(kSchemaVersion, cache.generation(), artifact);
+
+  Artifact got_artifact;
+  ASSERT_TRUE(cache.Find(kSchemaVersion, 1, &got_artifact));
+  EXPECT_THAT(got_artifact, EqualsProto(artifact));
+  // The nodes of the other kinds and schema versions are not shared.
+  Execution execution;
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 1, &execution));
+  EXPECT_FALSE(cache.Find(kSchemaVersion - 1, 1, &got_artifact));
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 2);
+  EXPECT_GT(cache.num_bytes(), 0);
+}
+
+TEST(NodeCacheTest, InvalidateDropsNodesAndStaleInserts) {
+  NodeCache cache;
+  const int64 generation = cache.generation();
+  cache.Insert(kSchemaVersion, generation,
+               ParseTextProtoOrDie<Context>("id: 1 name: 'a'"));
+  cache.Insert(kSchemaVersion, generation,
+               ParseTextProtoOrDie<Context>("id: 2 name: 'b'"));
+  cache.Invalidate<Context>({1});
+  EXPECT_NE(cache.generation(), generation);
+
+  Context context;
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 1, &context));
+  EXPECT_TRUE(cache.Find(kSchemaVersion, 2, &context));
+  // A node read before the invalidation is not cached.
+  cache.Insert(kSchemaVersion, generation,
+               ParseTextProtoOrDie<Context>("id: 3 name: 'c'"));
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 3, &context));
+}
+
+TEST(NodeCacheTest, InvalidateSinceDropsNodesCachedMeanwhile) {
+  NodeCache cache;
+  const int64 writer_generation = cache.generation();
+  cache.Invalidate<Execution>({1});
+  // Another reader caches the node before the writer commits.
+  cache.Insert(kSchemaVersion, cache.generation(),
+               ParseTextProtoOrDie<Execution>("id: 1 type_id: 2"));
+  cache.Insert(kSchemaVersion, cache.generation(),
+               ParseTextProtoOrDie<Execution>("id: 2 type_id: 2"));
+  cache.InvalidateSince(writer_generation);
+
+  Execution execution;
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 1, &execution));
+  EXPECT_TRUE(cache.Find(kSchemaVersion, 2, &execution));
+}
+
+TEST(NodeCacheTest, EvictLeastRecentlyUsedNodes) {
+  const Artifact artifact =
+      ParseTextProtoOrDie<Artifact>("id: 1 type_id: 2 uri: 'a'");
+  // Each kind holds about two such nodes in its single shard.
+  NodeCache cache(/*max_num_bytes=*/3 * 5 *
+                      (artifact.ByteSizeLong() + sizeof(artifact)) / 2,
+                  /*num_shards=*/1);
+  for (int64 id = 1; id <= 3; id++) {
+    Artifact node = artifact;
+    node.set_id(id);
+    cache.Insert(kSchemaVersion, cache.generation(), node);
+    if (id == 2) {
+      Artifact got_artifact;
+      ASSERT_TRUE(cache.Find(kSchemaVersion, 1, &got_artifact));
+    }
+  }
+
+  Artifact got_artifact;
+  EXPECT_TRUE(cache.Find(kSchemaVersion, 1, &got_artifact));
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 2, &got_artifact));
+  EXPECT_TRUE(cache.Find(kSchemaVersion, 3, &got_artifact));
+}
+
+TEST(NodeCacheTest, AppendSerializedNodes) {
+  NodeCache cache(/*max_num_bytes=*/256 << 20, /*num_shards=*/16,
+                  /*retain_serialized_nodes=*/true);
+  const Artifact artifact_1 =
+      ParseTextProtoOrDie<Artifact>("id: 1 type_id: 2 uri: 'a'");
+  const Artifact artifact_2 =
+      ParseTextProtoOrDie<Artifact>("id: 2 type_id: 2 uri: 'b'");
+  cache.Insert(kSchemaVersion, cache.generation(), artifact_1);
+  cache.Insert(kSchemaVersion, cache.generation(), artifact_2);
+
+  // The spliced nodes form a serialized response listing them.
+  std::string serialized_response;
+  ASSERT_TRUE(cache.AppendSerialized<Artifact>(
+      kSchemaVersion, 2, GetArtifactsByIDResponse::kArtifactsFieldNumber,
+      &serialized_response));
+  ASSERT_TRUE(cache.AppendSerialized<Artifact>(
+      kSchemaVersion, 1, GetArtifactsByIDResponse::kArtifactsFieldNumber,
+      &serialized_response));
+  EXPECT_FALSE(cache.AppendSerialized<Artifact>(
+      kSchemaVersion, 3, GetArtifactsByIDResponse::kArtifactsFieldNumber,
+      &serialized_response));
+  GetArtifactsByIDResponse response;
+  ASSERT_TRUE(response.ParseFromString(serialized_response));
+  EXPECT_THAT(response.artifacts(),
+              ElementsAre(EqualsProto(artifact_2), EqualsProto(artifact_1)));
+
+  // The serialized nodes are only kept if the cache retains them.
+  NodeCache decoded_cache;
+  decoded_cache.Insert(kSchemaVersion, decoded_cache.generation(), artifact_1);
+  EXPECT_FALSE(decoded_cache.AppendSerialized<Artifact>(
+      kSchemaVersion, 1, GetArtifactsByIDResponse::kArtifactsFieldNumber,
+      &serialized_response));
+}
+
+TEST(NodeCacheTest, ClearDropsAllNodes) {
+  NodeCache cache;
+  cache.Insert(kSchemaVersion, cache.generation(),
+               ParseTextProtoOrDie<Artifact>("id: 1 type_id: 2"));
+  cache.Clear();
+
+  Artifact artifact;
+  EXPECT_FALSE(cache.Find(kSchemaVersion, 1, &artifact));
+  EXPECT_EQ(cache.num_bytes(), 0);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,156 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/pinned_read_registry.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "ml_metadata/util/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+// Counts the pinned reads closed as they are not resumed within their ttl.
+void CountExpiredRead() {
+  MetricsRegistry::Global()
+      ->GetCounter("mlmd_pinned_reads_expired_total",
+                   "The number of pinned reads closed as they expired.")
+      ->Increment();
+}
+
+}  // namespace
+
+PinnedReadRegistry::PinnedReadRegistry(const PinnedReadOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.max_num_pinned_reads, 0)
+      << "The max_num_pinned_reads must be positive.";
+  CHECK_GT(options_.reap_interval, absl::ZeroDuration())
+      << "The reap_interval must be positive.";
+  reaper_ = std::thread([this]() { RunReaper(); });
+}
+
+PinnedReadRegistry::~PinnedReadRegistry() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopped_ = true;
+  }
+  reaper_.join();
+  CloseExpired(absl::InfiniteFuture());
+}
+
+tensorflow::Status PinnedReadRegistry::Open(
+    MetadataStorePool::ScopedMetadataStore* store, std::string* id) {
+  CloseExpired(absl::Now());
+  {
+    absl::MutexLock lock(&mu_);
+    if (num_open_ >= options_.max_num_pinned_reads) {
+      return tensorflow::errors::ResourceExhausted(
+          "All the ", options_.max_num_pinned_reads, " pinned reads are open.");
+    }
+    num_open_++;
+    *id = absl::StrCat(
+        absl::Hex(absl::Uniform<uint64>(bit_gen_), absl::kZeroPad16),
+        absl::Hex(absl::Uniform<uint64>(bit_gen_), absl::kZeroPad16));
+  }
+  const tensorflow::Status status = (*store)->BeginPinnedRead();
+  if (!status.ok()) {
+    absl::MutexLock lock(&mu_);
+    num_open_--;
+  }
+  return status;
+}
+
+tensorflow::Status PinnedReadRegistry::Take(
+    const absl::string_view id, const MetadataStorePool* pool,
+    MetadataStorePool::ScopedMetadataStore* store) {
+  CloseExpired(absl::Now());
+  absl::MutexLock lock(&mu_);
+  const auto it = idle_reads_.find(id);
+  if (it == idle_reads_.end() || it->second.pool != pool) {
+    return tensorflow::errors::NotFound("No idle pinned read ", id,
+                                        " is open.");
+  }
+  *store = std::move(it->second.store);
+  idle_reads_.erase(it);
+  return tensorflow::Status::OK();
+}
+
+void PinnedReadRegistry::Return(const absl::string_view id,
+                                const MetadataStorePool* pool,
+                                MetadataStorePool::ScopedMetadataStore store) {
+  absl::MutexLock lock(&mu_);
+  idle_reads_[std::string(id)] =
+      IdleRead{pool, std::move(store), absl::Now() + options_.ttl};
+}
+
+void PinnedReadRegistry::Close(MetadataStorePool::ScopedMetadataStore store) {
+  // The deadline of the last call of the pinned read may have passed.
+  store->SetTransactionDeadline(absl::InfiniteFuture());
+  const tensorflow::Status status = store->EndPinnedRead();
+  if (status.ok()) {
+    store.Reset();
+  } else {
+    LOG(WARNING) << "Discarding the store of a pinned read: " << status;
+    store.Discard();
+  }
+  absl::MutexLock lock(&mu_);
+  num_open_--;
+}
+
+int PinnedReadRegistry::num_open() const {
+  absl::MutexLock lock(&mu_);
+  return num_open_;
+}
+
+void PinnedReadRegistry::CloseExpired(const absl::Time now) {
+  // The stores are closed outside of the lock, as ending their reads queries
+  // the databases.
+  std::vector<MetadataStorePool::ScopedMetadataStore> expired;
+  {
+    absl::MutexLock lock(&mu_);
+    for (auto it = idle_reads_.begin(); it != idle_reads_.end();) {
+      if (it->second.expiry_time > now) {
+        ++it;
+        continue;
+      }
+      expired.push_back(std::move(it->second.store));
+      idle_reads_.erase(it++);
+    }
+  }
+  for (MetadataStorePool::ScopedMetadataStore& store : expired) {
+    Close(std::move(store));
+    CountExpiredRead();
+  }
+}
+
+void PinnedReadRegistry::RunReaper() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (mu_.AwaitWithTimeout(absl::Condition(&stopped_),
+                               options_.reap_interval)) {
+        return;
+      }
+    }
+    CloseExpired(absl::Now());
+  }
+}
+
+}  // namespace ml_metadata
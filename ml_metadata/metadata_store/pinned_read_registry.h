@@ -0,0 +1,129 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_PINNED_READ_REGISTRY_H_
+#define ML_METADATA_METADATA_STORE_PINNED_READ_REGISTRY_H_
+
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/random/random.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Options of a PinnedReadRegistry.
+struct PinnedReadOptions {
+  // An open pinned read which is not resumed within this duration is closed.
+  absl::Duration ttl = absl::Minutes(1);
+  // The max number of open pinned reads. It must be positive. Each one holds
+  // a store of its pool, so it should be well below the pool max_size.
+  int max_num_pinned_reads = 8;
+  // The interval at which a background thread closes the expired idle
+  // pinned reads, so that they do not keep their snapshots open until the
+  // next call. It must be positive.
+  absl::Duration reap_interval = absl::Seconds(1);
+};
+
+// Holds the stores with a pinned read, see MetadataStore::BeginPinnedRead,
+// which serve several calls from one snapshot of the database, e.g., the
+// cursors of the lists paged with ListOperationOptions.snapshot_cursor, or the
+// read sessions. Each pinned read is named by a random id. Between the calls,
+// an idle pinned read is kept in the registry until it is resumed or expires.
+// The expired ones are closed by a background thread every reap_interval.
+// It is thread-safe.
+//
+// Example usage:
+//   std::string id;
+//   TF_RETURN_IF_ERROR(registry.Open(&store, &id));
+//   ... read the first page with `store` ...
+//   registry.Return(id, &pool, std::move(store));
+//   ... on the next call ...
+//   TF_RETURN_IF_ERROR(registry.Take(id, &pool, &store));
+//   ... read the last page with `store` ...
+//   registry.Close(std::move(store));
+class PinnedReadRegistry {
+ public:
+  explicit PinnedReadRegistry(const PinnedReadOptions& options);
+
+  // Disallow copy and assign.
+  PinnedReadRegistry(const PinnedReadRegistry&) = delete;
+  PinnedReadRegistry& operator=(const PinnedReadRegistry&) = delete;
+
+  // Stops the background thread and closes the idle pinned reads. The taken
+  // ones must have been returned or closed, and the pools of the stores must
+  // outlive the registry.
+  ~PinnedReadRegistry();
+
+  // Opens a pinned read with a borrowed `store` by beginning it, and sets its
+  // new `id`. The caller keeps the store until it returns or closes it.
+  // Returns RESOURCE_EXHAUSTED error, if max_num_pinned_reads are open.
+  // Returns the errors of MetadataStore::BeginPinnedRead otherwise.
+  tensorflow::Status Open(MetadataStorePool::ScopedMetadataStore* store,
+                          std::string* id);
+
+  // Takes the idle pinned read `id` of a store of `pool` out of the registry,
+  // and sets `store` to its store, until the caller returns or closes it.
+  // Returns NOT_FOUND error, if no such pinned read is idle, e.g., it has
+  //   expired, or it is taken by a concurrent call.
+  tensorflow::Status Take(absl::string_view id, const MetadataStorePool* pool,
+                          MetadataStorePool::ScopedMetadataStore* store);
+
+  // Keeps the opened or taken pinned read `id` of `pool` with its `store`
+  // idle in the registry for another ttl.
+  void Return(absl::string_view id, const MetadataStorePool* pool,
+              MetadataStorePool::ScopedMetadataStore store);
+
+  // Closes an opened or taken pinned read by ending it on its `store`, which
+  // is then returned to its pool, or discarded if the read cannot be ended.
+  void Close(MetadataStorePool::ScopedMetadataStore store);
+
+  // Returns the number of open pinned reads, either idle or taken.
+  int num_open() const;
+
+ private:
+  // A pinned read kept in the registry between the calls.
+  struct IdleRead {
+    const MetadataStorePool* pool;
+    MetadataStorePool::ScopedMetadataStore store;
+    absl::Time expiry_time;
+  };
+
+  // Closes the idle pinned reads which have expired as of `now`.
+  void CloseExpired(absl::Time now) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Closes the expired pinned reads every reap_interval until `stopped_` is
+  // set.
+  void RunReaper() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const PinnedReadOptions options_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, IdleRead> idle_reads_ ABSL_GUARDED_BY(mu_);
+  int num_open_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::BitGen bit_gen_ ABSL_GUARDED_BY(mu_);
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+  std::thread reaper_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_PINNED_READ_REGISTRY_H_
@@ -0,0 +1,151 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/pinned_read_registry.h"
+
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+ConnectionConfig FakeDatabaseConnectionConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+tensorflow::Status PutArtifactType(MetadataStore* store) {
+  const PutArtifactTypeRequest request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        all_fields_match: true
+        artifact_type: { name: 'pinned_type' }
+      )");
+  PutArtifactTypeResponse response;
+  return store->PutArtifactType(request, &response);
+}
+
+TEST(PinnedReadRegistryTest, ResumesAndClosesPinnedRead) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  PinnedReadRegistry registry((PinnedReadOptions()));
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  std::string read_id;
+  TF_ASSERT_OK(registry.Open(&store, &read_id));
+  EXPECT_FALSE(read_id.empty());
+  EXPECT_EQ(registry.num_open(), 1);
+
+  // The reads of a pinned read run in its read-only transaction.
+  GetArtifactsRequest request;
+  GetArtifactsResponse response;
+  TF_EXPECT_OK(store->GetArtifacts(request, &response));
+  EXPECT_EQ(PutArtifactType(store.get()).code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  registry.Return(read_id, &pool, std::move(store));
+  EXPECT_EQ(registry.num_open(), 1);
+
+  // An idle pinned read is only resumed through its own pool, and only once.
+  MetadataStorePool other_pool(FakeDatabaseConnectionConfig(),
+                               MetadataStorePoolOptions());
+  EXPECT_EQ(registry.Take(read_id, &other_pool, &store).code(),
+            tensorflow::error::NOT_FOUND);
+  TF_ASSERT_OK(registry.Take(read_id, &pool, &store));
+  MetadataStorePool::ScopedMetadataStore concurrent_store;
+  EXPECT_EQ(registry.Take(read_id, &pool, &concurrent_store).code(),
+            tensorflow::error::NOT_FOUND);
+  TF_EXPECT_OK(store->GetArtifacts(request, &response));
+
+  // A closed pinned read returns its store to the pool, where it writes again.
+  registry.Close(std::move(store));
+  EXPECT_EQ(registry.num_open(), 0);
+  EXPECT_EQ(pool.num_idle(), 1);
+  TF_ASSERT_OK(pool.Acquire(&store));
+  TF_EXPECT_OK(PutArtifactType(store.get()));
+}
+
+TEST(PinnedReadRegistryTest, LimitsOpenPinnedReads) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  PinnedReadOptions options;
+  options.max_num_pinned_reads = 1;
+  PinnedReadRegistry registry(options);
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  std::string read_id;
+  TF_ASSERT_OK(registry.Open(&store, &read_id));
+  registry.Return(read_id, &pool, std::move(store));
+
+  MetadataStorePool::ScopedMetadataStore other_store;
+  TF_ASSERT_OK(pool.Acquire(&other_store));
+  std::string other_read_id;
+  EXPECT_EQ(registry.Open(&other_store, &other_read_id).code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+  // The store of a rejected pinned read is left unpinned.
+  TF_EXPECT_OK(PutArtifactType(other_store.get()));
+}
+
+TEST(PinnedReadRegistryTest, ClosesExpiredPinnedReads) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  PinnedReadOptions options;
+  options.ttl = absl::Milliseconds(10);
+  PinnedReadRegistry registry(options);
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  std::string read_id;
+  TF_ASSERT_OK(registry.Open(&store, &read_id));
+  registry.Return(read_id, &pool, std::move(store));
+
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(registry.Take(read_id, &pool, &store).code(),
+            tensorflow::error::NOT_FOUND);
+  EXPECT_EQ(registry.num_open(), 0);
+  EXPECT_EQ(pool.num_idle(), 1);
+}
+
+TEST(PinnedReadRegistryTest, ReapsExpiredPinnedReadsWithoutCalls) {
+  MetadataStorePool pool(FakeDatabaseConnectionConfig(),
+                         MetadataStorePoolOptions());
+  PinnedReadOptions options;
+  options.ttl = absl::Milliseconds(10);
+  options.reap_interval = absl::Milliseconds(10);
+  PinnedReadRegistry registry(options);
+  MetadataStorePool::ScopedMetadataStore store;
+  TF_ASSERT_OK(pool.Acquire(&store));
+  std::string read_id;
+  TF_ASSERT_OK(registry.Open(&store, &read_id));
+  registry.Return(read_id, &pool, std::move(store));
+
+  // The idle store is returned to the pool by the reaper alone.
+  const absl::Time deadline = absl::Now() + absl::Seconds(10);
+  while (registry.num_open() > 0 && absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(registry.num_open(), 0);
+  EXPECT_EQ(pool.num_idle(), 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,824 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/postgresql_metadata_source.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "libpq-fe.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+
+namespace {
+
+using absl::Status;
+
+constexpr char kBeginTransaction[] = "BEGIN";
+constexpr char kBeginReadOnlyTransaction[] = "BEGIN READ ONLY";
+constexpr char kBeginSnapshotReadTransaction[] =
+    "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY";
+constexpr char kCommitTransaction[] = "COMMIT";
+constexpr char kRollbackTransaction[] = "ROLLBACK";
+constexpr char kDeallocatePreparedStatements[] = "DEALLOCATE ALL";
+
+// The savepoint isolating each statement of a transaction.
+constexpr char kStatementSavepoint[] = "SAVEPOINT mlmd_statement";
+constexpr char kReleaseStatementSavepoint[] =
+    "RELEASE SAVEPOINT mlmd_statement";
+constexpr char kRollbackStatementSavepoint[] =
+    "ROLLBACK TO SAVEPOINT mlmd_statement; RELEASE SAVEPOINT mlmd_statement";
+
+// The database to which a connection is opened to create the database of the
+// config.
+constexpr char kMaintenanceDatabase[] = "postgres";
+
+// The rows of a COPY are sent to the server in chunks of about this size.
+constexpr int kCopyChunkSize = 64 * 1024;
+
+// The type oids of the result columns read as int64, double, bool and bytes,
+// see pg_type.dat of the PostgreSQL server.
+constexpr Oid kBoolOid = 16;
+constexpr Oid kByteaOid = 17;
+constexpr Oid kInt8Oid = 20;
+constexpr Oid kInt2Oid = 21;
+constexpr Oid kInt4Oid = 23;
+constexpr Oid kFloat4Oid = 700;
+constexpr Oid kFloat8Oid = 701;
+
+// Returns an error for a failed result. Serialization failures and deadlocks
+// are returned as Aborted, so that the client side can retry.
+Status ResultError(const PGresult* result) {
+  const char* sqlstate = PQresultErrorField(result, PG_DIAG_SQLSTATE);
+  const absl::string_view code = sqlstate != nullptr ? sqlstate : "";
+  const absl::string_view message =
+      absl::StripTrailingAsciiWhitespace(PQresultErrorMessage(result));
+  if (code == "40001" || code == "40P01") {
+    return absl::AbortedError(absl::StrCat(
+        "PostgreSQL query aborted: sqlstate: ", code, ", error: ", message));
+  }
+  return absl::InternalError(absl::StrCat(
+      "PostgreSQL query failed: sqlstate: ", code, ", error: ", message));
+}
+
+// Returns an error for the last failed call on the connection.
+Status ConnectionError(PGconn* conn, absl::string_view action) {
+  return absl::InternalError(absl::StrCat(
+      action, " failed: ",
+      absl::StripTrailingAsciiWhitespace(PQerrorMessage(conn))));
+}
+
+// Returns an error if `result` is null or reports a failure.
+Status CheckResult(PGconn* conn, const PGresult* result) {
+  if (result == nullptr) {
+    return ConnectionError(conn, "PostgreSQL query");
+  }
+  switch (PQresultStatus(result)) {
+    case PGRES_COMMAND_OK:
+    case PGRES_TUPLES_OK:
+    case PGRES_SINGLE_TUPLE:
+    case PGRES_COPY_IN:
+    case PGRES_PIPELINE_SYNC:
+      return absl::OkStatus();
+    default:
+      return ResultError(result);
+  }
+}
+
+// Returns true if `query` is a savepoint statement of the caller, which does
+// not run within the savepoint of the statements.
+bool IsSavepointStatement(absl::string_view query) {
+  query = absl::StripLeadingAsciiWhitespace(query);
+  return absl::StartsWithIgnoreCase(query, "SAVEPOINT ") ||
+         absl::StartsWithIgnoreCase(query, "ROLLBACK TO ") ||
+         absl::StartsWithIgnoreCase(query, "RELEASE ");
+}
+
+// Translates a query of the query config to PostgreSQL. The identifiers quoted
+// with backticks are quoted with double quotes, and if `num_placeholders` is
+// not null, the `?` placeholders are numbered as $1, $2, ..., and counted.
+// The string literals are copied as is.
+std::string TranslateQuery(absl::string_view query, int* num_placeholders) {
+  std::string translated;
+  translated.reserve(query.size());
+  // The quote character of the literal or identifier being copied, if any.
+  char open_quote = 0;
+  for (const char c : query) {
+    if (open_quote != 0) {
+      if (c == open_quote) open_quote = 0;
+      translated.push_back(c == '`' ? '"' : c);
+    } else if (c == '\'' || c == '"' || c == '`') {
+      open_quote = c;
+      translated.push_back(c == '`' ? '"' : c);
+    } else if (c == '?' && num_placeholders != nullptr) {
+      absl::StrAppend(&translated, "$", ++*num_placeholders);
+    } else {
+      translated.push_back(c);
+    }
+  }
+  return translated;
+}
+
+// Returns `name` quoted as an identifier.
+std::string QuoteIdentifier(absl::string_view name) {
+  return absl::StrCat("\"", absl::StrReplaceAll(name, {{"\"", "\"\""}}),
+                      "\"");
+}
+
+// Returns the text format of a non-NULL value, which is used both for the
+// parameters of the statements and the rows of COPY. The doubles are printed
+// with enough digits to be read back exactly.
+std::string FormatValue(const PreparedStatementValue& value) {
+  if (absl::holds_alternative<int64>(value)) {
+    return absl::StrCat(absl::get<int64>(value));
+  } else if (absl::holds_alternative<double>(value)) {
+    return absl::StrFormat("%.17g", absl::get<double>(value));
+  } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+    // The hex format of the bytea input.
+    return absl::StrCat(
+        "\\x",
+        absl::BytesToHexString(absl::get<PreparedStatementBytes>(value).bytes));
+  }
+  return absl::get<std::string>(value);
+}
+
+// Appends a value to a row of COPY in text format, in which NULL is \N and
+// the backslashes and the delimiters in the text are escaped.
+void AppendCopyValue(const PreparedStatementValue& value, std::string* row) {
+  if (absl::holds_alternative<absl::monostate>(value)) {
+    absl::StrAppend(row, "\\N");
+  } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+    // The backslash of the hex format is escaped as well.
+    absl::StrAppend(row, "\\", FormatValue(value));
+  } else if (absl::holds_alternative<std::string>(value)) {
+    absl::StrAppend(row, absl::StrReplaceAll(absl::get<std::string>(value),
+                                             {{"\\", "\\\\"},
+                                              {"\t", "\\t"},
+                                              {"\n", "\\n"},
+                                              {"\r", "\\r"}}));
+  } else {
+    absl::StrAppend(row, FormatValue(value));
+  }
+}
+
+// Converts the rows of `result` to `record_set`. The integer and floating
+// point columns are typed, and the booleans are read as 1 and 0 as in the
+// other backends.
+void AppendResultRows(const PGresult* result, TypedRecordSet* record_set) {
+  const int num_cols = PQnfields(result);
+  const int num_rows = PQntuples(result);
+  for (int row = 0; row < num_rows; ++row) {
+    for (int col = 0; col < num_cols; ++col) {
+      if (PQgetisnull(result, row, col)) {
+        record_set->AppendNull();
+        continue;
+      }
+      absl::string_view text(PQgetvalue(result, row, col),
+                             PQgetlength(result, row, col));
+      int64 int64_value;
+      double double_value;
+      switch (PQftype(result, col)) {
+        case kBoolOid:
+          record_set->AppendInt64(text == "t" ? 1 : 0);
+          continue;
+        case kInt2Oid:
+        case kInt4Oid:
+        case kInt8Oid:
+          if (ParseDecimalInt64(text, &int64_value)) {
+            record_set->AppendInt64(int64_value);
+            continue;
+          }
+          break;
+        case kFloat4Oid:
+        case kFloat8Oid:
+          if (absl::SimpleAtod(text, &double_value)) {
+            record_set->AppendDouble(double_value);
+            continue;
+          }
+          break;
+        case kByteaOid:
+          // The bytes are returned in the hex format, i.e., \x<hex>.
+          if (absl::ConsumePrefix(&text, "\\x")) {
+            record_set->AppendString(absl::HexStringToBytes(text));
+            continue;
+          }
+          break;
+        default:
+          break;
+      }
+      record_set->AppendString(text);
+    }
+  }
+}
+
+// Returns the column names of `result`.
+std::vector<std::string> GetColumnNames(const PGresult* result) {
+  std::vector<std::string> column_names;
+  const int num_cols = PQnfields(result);
+  column_names.reserve(num_cols);
+  for (int col = 0; col < num_cols; ++col) {
+    column_names.push_back(PQfname(result, col));
+  }
+  return column_names;
+}
+
+// Converts `result` to `record_set`.
+void ConvertResult(const PGresult* result, TypedRecordSet* record_set) {
+  record_set->Reset(GetColumnNames(result));
+  AppendResultRows(result, record_set);
+}
+
+// Checks if config is valid.
+Status CheckConfig(const PostgreSQLDatabaseConfig& config) {
+  if (config.dbname().empty()) {
+    return absl::InvalidArgumentError("dbname must not be empty");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+PostgreSQLMetadataSource::PostgreSQLMetadataSource(
+    const PostgreSQLDatabaseConfig& config)
+    : MetadataSource(), config_(config) {
+  CHECK_EQ(absl::OkStatus(), CheckConfig(config));
+}
+
+PostgreSQLMetadataSource::~PostgreSQLMetadataSource() {
+  CHECK_EQ(absl::OkStatus(), CloseImpl());
+}
+
+Status PostgreSQLMetadataSource::ConnectImpl() {
+  if (!config_.skip_db_creation()) {
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateDatabaseIfNotExists(),
+                                      "Creating database ", config_.dbname(),
+                                      " in ConnectImpl");
+  }
+  return OpenConnection(config_.dbname(), &conn_);
+}
+
+Status PostgreSQLMetadataSource::OpenConnection(const std::string& dbname,
+                                                PGconn** conn) const {
+  std::vector<const char*> keywords;
+  std::vector<const char*> values;
+  const auto add_parameter = [&](const char* keyword,
+                                 const std::string& value) {
+    if (!value.empty()) {
+      keywords.push_back(keyword);
+      values.push_back(value.c_str());
+    }
+  };
+  const std::string port =
+      config_.has_port() ? absl::StrCat(config_.port()) : "";
+  add_parameter("host", config_.host());
+  add_parameter("port", port);
+  add_parameter("dbname", dbname);
+  add_parameter("user", config_.user());
+  add_parameter("password", config_.password());
+  if (config_.has_ssl_options()) {
+    const PostgreSQLDatabaseConfig::SSLOptions& ssl = config_.ssl_options();
+    add_parameter("sslmode", ssl.sslmode());
+    add_parameter("sslkey", ssl.sslkey());
+    add_parameter("sslcert", ssl.sslcert());
+    add_parameter("sslrootcert", ssl.sslrootcert());
+  }
+  keywords.push_back("client_encoding");
+  values.push_back("UTF8");
+  keywords.push_back(nullptr);
+  values.push_back(nullptr);
+
+  *conn = PQconnectdbParams(keywords.data(), values.data(),
+                            /*expand_dbname=*/0);
+  if (*conn == nullptr) {
+    return absl::InternalError("PQconnectdbParams failed: out of memory");
+  }
+  if (PQstatus(*conn) != CONNECTION_OK) {
+    const Status status = ConnectionError(*conn, "PQconnectdbParams");
+    PQfinish(*conn);
+    *conn = nullptr;
+    return status;
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::CreateDatabaseIfNotExists() const {
+  PGconn* conn = nullptr;
+  MLMD_RETURN_IF_ERROR(OpenConnection(kMaintenanceDatabase, &conn));
+  const char* const params[] = {config_.dbname().c_str()};
+  ResultPtr exists(PQexecParams(
+      conn, "SELECT 1 FROM pg_database WHERE datname = $1", /*nParams=*/1,
+      /*paramTypes=*/nullptr, params, /*paramLengths=*/nullptr,
+      /*paramFormats=*/nullptr, /*resultFormat=*/0));
+  Status status = CheckResult(conn, exists.get());
+  if (status.ok() && PQntuples(exists.get()) == 0) {
+    const std::string create_database =
+        absl::StrCat("CREATE DATABASE ", QuoteIdentifier(config_.dbname()));
+    ResultPtr created(PQexec(conn, create_database.c_str()));
+    status = CheckResult(conn, created.get());
+    // The database may be created concurrently by another client.
+    const char* sqlstate =
+        created != nullptr
+            ? PQresultErrorField(created.get(), PG_DIAG_SQLSTATE)
+            : nullptr;
+    if (sqlstate != nullptr && absl::string_view(sqlstate) == "42P04") {
+      status = absl::OkStatus();
+    }
+  }
+  PQfinish(conn);
+  return status;
+}
+
+Status PostgreSQLMetadataSource::CloseImpl() {
+  if (conn_ != nullptr) {
+    PQfinish(conn_);
+    conn_ = nullptr;
+  }
+  in_transaction_ = false;
+  prepared_statements_.clear();
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::RunCommand(const std::string& statement,
+                                            ResultPtr* result) {
+  ResultPtr command_result(PQexec(conn_, statement.c_str()));
+  MLMD_RETURN_IF_ERROR(CheckResult(conn_, command_result.get()));
+  if (result != nullptr) {
+    *result = std::move(command_result);
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::RunStatement(
+    const std::string& statement, const absl::Span<const char* const> params,
+    const std::string& prepared_query, ResultPtr* result) {
+  std::vector<ResultPtr> results;
+  MLMD_RETURN_IF_ERROR(RunStatements(
+      {PipelinedStatement{statement, {params.begin(), params.end()},
+                          prepared_query}},
+      result != nullptr ? &results : nullptr));
+  if (result != nullptr) {
+    *result = std::move(results[0]);
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::RunStatements(
+    const absl::Span<const PipelinedStatement> statements,
+    std::vector<ResultPtr>* results) {
+  // The names of the prepared statements of `statements`, and whether they are
+  // prepared in the pipeline.
+  std::vector<std::string> statement_names(statements.size());
+  std::vector<bool> prepare(statements.size(), false);
+  int num_unprepared = 0;
+  for (const PipelinedStatement& statement : statements) {
+    if (!statement.prepared_query.empty() &&
+        !prepared_statements_.contains(statement.prepared_query)) {
+      num_unprepared++;
+    }
+  }
+  if (num_unprepared > 0 && prepared_statements_.size() + num_unprepared >
+                                kMaxNumPreparedStatements) {
+    MLMD_RETURN_IF_ERROR(RunCommand(kDeallocatePreparedStatements));
+    prepared_statements_.clear();
+  }
+  // The statements named in the pipeline, keyed by query text.
+  absl::flat_hash_map<std::string, std::string> named_statements;
+  for (int i = 0; i < statements.size(); ++i) {
+    const std::string& prepared_query = statements[i].prepared_query;
+    if (prepared_query.empty()) continue;
+    const auto it = prepared_statements_.find(prepared_query);
+    if (it != prepared_statements_.end()) {
+      statement_names[i] = it->second;
+      continue;
+    }
+    const auto named_it = named_statements.find(prepared_query);
+    if (named_it != named_statements.end()) {
+      statement_names[i] = named_it->second;
+      continue;
+    }
+    statement_names[i] =
+        absl::StrCat("mlmd_stmt_", ++num_prepared_statements_);
+    named_statements[prepared_query] = statement_names[i];
+    prepare[i] = true;
+  }
+
+  // Sends the commands of the pipeline, and stops at the first one which
+  // cannot be sent. The commands sent are still synced and read.
+  const bool use_savepoint = in_transaction_;
+  if (PQenterPipelineMode(conn_) != 1) {
+    return ConnectionError(conn_, "PQenterPipelineMode");
+  }
+  int num_commands = 0;
+  // The commands of the statements and of their preparations, or -1 if they
+  // are not sent.
+  std::vector<int> statement_index(statements.size(), -1);
+  std::vector<int> prepare_index(statements.size(), -1);
+  bool sent = true;
+  const auto send_command = [&](const char* command) {
+    sent = sent && PQsendQueryParams(conn_, command, /*nParams=*/0,
+                                     /*paramTypes=*/nullptr,
+                                     /*paramValues=*/nullptr,
+                                     /*paramLengths=*/nullptr,
+                                     /*paramFormats=*/nullptr,
+                                     /*resultFormat=*/0) == 1;
+    if (sent) num_commands++;
+  };
+  if (use_savepoint) {
+    send_command(kStatementSavepoint);
+  }
+  for (int i = 0; i < statements.size(); ++i) {
+    const PipelinedStatement& statement = statements[i];
+    const std::string& statement_name = statement_names[i];
+    if (prepare[i]) {
+      sent = sent && PQsendPrepare(conn_, statement_name.c_str(),
+                                   statement.statement.c_str(),
+                                   statement.params.size(),
+                                   /*paramTypes=*/nullptr) == 1;
+      if (sent) prepare_index[i] = num_commands++;
+    }
+    if (statement_name.empty()) {
+      sent = sent &&
+             PQsendQueryParams(conn_, statement.statement.c_str(),
+                               statement.params.size(),
+                               /*paramTypes=*/nullptr, statement.params.data(),
+                               /*paramLengths=*/nullptr,
+                               /*paramFormats=*/nullptr,
+                               /*resultFormat=*/0) == 1;
+    } else {
+      sent = sent && PQsendQueryPrepared(conn_, statement_name.c_str(),
+                                         statement.params.size(),
+                                         statement.params.data(),
+                                         /*paramLengths=*/nullptr,
+                                         /*paramFormats=*/nullptr,
+                                         /*resultFormat=*/0) == 1;
+    }
+    if (sent) statement_index[i] = num_commands++;
+  }
+  if (use_savepoint) {
+    send_command(kReleaseStatementSavepoint);
+  }
+  Status status = sent ? absl::OkStatus()
+                       : ConnectionError(conn_, "Sending PostgreSQL query");
+  if (PQpipelineSync(conn_) != 1) {
+    const Status sync_status = ConnectionError(conn_, "PQpipelineSync");
+    PQexitPipelineMode(conn_);
+    return sync_status;
+  }
+
+  // Each command returns one result followed by a null one. Once a command
+  // fails, the server skips the next ones, whose result is
+  // PGRES_PIPELINE_ABORTED.
+  std::vector<ResultPtr> command_results(num_commands);
+  int failed_index = -1;
+  for (int i = 0; i < num_commands; ++i) {
+    ResultPtr command_result(PQgetResult(conn_));
+    const Status command_status = CheckResult(conn_, command_result.get());
+    if (command_result == nullptr) {
+      status.Update(command_status);
+      break;
+    }
+    if (failed_index < 0 &&
+        PQresultStatus(command_result.get()) != PGRES_PIPELINE_ABORTED &&
+        !command_status.ok()) {
+      failed_index = i;
+      status.Update(command_status);
+    }
+    command_results[i] = std::move(command_result);
+    ResultPtr end_of_command(PQgetResult(conn_));
+  }
+  ResultPtr sync_result(PQgetResult(conn_));
+  if (PQexitPipelineMode(conn_) != 1) {
+    status.Update(ConnectionError(conn_, "PQexitPipelineMode"));
+  }
+  for (int i = 0; i < statements.size(); ++i) {
+    if (prepare_index[i] >= 0 && command_results[prepare_index[i]] != nullptr &&
+        CheckResult(conn_, command_results[prepare_index[i]].get()).ok()) {
+      prepared_statements_[statements[i].prepared_query] = statement_names[i];
+    }
+  }
+  // The transaction is usable again once the savepoint is rolled back.
+  if (use_savepoint && failed_index > 0) {
+    const Status rollback_status = RunCommand(kRollbackStatementSavepoint);
+    if (!rollback_status.ok()) {
+      LOG(WARNING) << "Rolling back the failed PostgreSQL statement failed: "
+                   << rollback_status;
+    }
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  if (results != nullptr) {
+    results->clear();
+    for (const int index : statement_index) {
+      results->push_back(std::move(command_results[index]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::EndStatementSavepoint(const Status& status) {
+  if (status.ok()) {
+    return RunCommand(kReleaseStatementSavepoint);
+  }
+  const Status rollback_status = RunCommand(kRollbackStatementSavepoint);
+  if (!rollback_status.ok()) {
+    LOG(WARNING) << "Rolling back the failed PostgreSQL statement failed: "
+                 << rollback_status;
+  }
+  return status;
+}
+
+Status PostgreSQLMetadataSource::ExecuteQueryImpl(const std::string& query,
+                                                  RecordSet* results) {
+  const std::string statement =
+      TranslateQuery(query, /*num_placeholders=*/nullptr);
+  ResultPtr result;
+  if (!in_transaction_ || IsSavepointStatement(query)) {
+    MLMD_RETURN_IF_ERROR(RunCommand(statement, &result));
+  } else {
+    MLMD_RETURN_IF_ERROR(RunStatement(statement, /*params=*/{},
+                                      /*prepared_query=*/"", &result));
+  }
+  if (results != nullptr) {
+    TypedRecordSet record_set;
+    ConvertResult(result.get(), &record_set);
+    record_set.ToRecordSet(results);
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    TypedRecordSet* results) {
+  int num_placeholders = 0;
+  const std::string statement = TranslateQuery(query, &num_placeholders);
+  if (num_placeholders != values.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Prepared query has ", num_placeholders,
+                     " placeholders, but ", values.size(),
+                     " values are given: ", query));
+  }
+  // The texts are owned by `texts` while the statement runs.
+  std::vector<std::string> texts(values.size());
+  std::vector<const char*> params(values.size(), nullptr);
+  for (int i = 0; i < values.size(); ++i) {
+    if (!absl::holds_alternative<absl::monostate>(values[i])) {
+      texts[i] = FormatValue(values[i]);
+      params[i] = texts[i].c_str();
+    }
+  }
+  ResultPtr result;
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      RunStatement(statement, params, query, &result), "Prepared query ",
+      query, ": ");
+  if (results != nullptr) {
+    ConvertResult(result.get(), results);
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ExecutePipelinedQueriesImpl(
+    const absl::Span<const PipelinedQuery> queries,
+    std::vector<TypedRecordSet>* results) {
+  std::vector<PipelinedStatement> statements(queries.size());
+  // The texts are owned by `texts` while the statements run.
+  std::vector<std::vector<std::string>> texts(queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    const PipelinedQuery& query = queries[i];
+    int num_placeholders = 0;
+    statements[i].statement = TranslateQuery(query.query, &num_placeholders);
+    statements[i].prepared_query = query.query;
+    if (num_placeholders != query.values.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Prepared query has ", num_placeholders,
+                       " placeholders, but ", query.values.size(),
+                       " values are given: ", query.query));
+    }
+    texts[i].resize(query.values.size());
+    statements[i].params.resize(query.values.size(), nullptr);
+    for (int j = 0; j < query.values.size(); ++j) {
+      if (!absl::holds_alternative<absl::monostate>(query.values[j])) {
+        texts[i][j] = FormatValue(query.values[j]);
+        statements[i].params[j] = texts[i][j].c_str();
+      }
+    }
+  }
+  std::vector<ResultPtr> statement_results;
+  MLMD_RETURN_IF_ERROR(RunStatements(statements, &statement_results));
+  results->clear();
+  results->resize(queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    ConvertResult(statement_results[i].get(), &(*results)[i]);
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ExecuteStreamingQueryImpl(
+    const std::string& query, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  const std::string statement =
+      TranslateQuery(query, /*num_placeholders=*/nullptr);
+  if (!in_transaction_) {
+    return StreamStatement(statement, max_batch_size, callback);
+  }
+  MLMD_RETURN_IF_ERROR(RunCommand(kStatementSavepoint));
+  return EndStatementSavepoint(
+      StreamStatement(statement, max_batch_size, callback));
+}
+
+Status PostgreSQLMetadataSource::StreamStatement(
+    const std::string& statement, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  if (PQsendQueryParams(conn_, statement.c_str(), /*nParams=*/0,
+                        /*paramTypes=*/nullptr, /*paramValues=*/nullptr,
+                        /*paramLengths=*/nullptr, /*paramFormats=*/nullptr,
+                        /*resultFormat=*/0) != 1) {
+    return ConnectionError(conn_, "PQsendQueryParams");
+  }
+  Status status = absl::OkStatus();
+  if (PQsetSingleRowMode(conn_) != 1) {
+    status = ConnectionError(conn_, "PQsetSingleRowMode");
+  }
+  std::vector<std::string> column_names;
+  TypedRecordSet batch;
+  bool has_columns = false;
+  // The results are read to the end even after an error, so that the
+  // connection can serve other queries.
+  while (PGresult* raw_result = PQgetResult(conn_)) {
+    ResultPtr result(raw_result);
+    if (!status.ok()) continue;
+    status = CheckResult(conn_, result.get());
+    if (!status.ok() || PQresultStatus(result.get()) == PGRES_COMMAND_OK) {
+      continue;
+    }
+    if (!has_columns) {
+      column_names = GetColumnNames(result.get());
+      batch.Reset(column_names);
+      has_columns = true;
+    }
+    AppendResultRows(result.get(), &batch);
+    if (batch.num_rows() >= max_batch_size) {
+      status = callback(batch);
+      batch.Reset(column_names);
+    }
+  }
+  if (status.ok() && batch.num_rows() > 0) {
+    status = callback(batch);
+  }
+  return status;
+}
+
+Status PostgreSQLMetadataSource::ExecuteBulkInsertImpl(
+    const std::string& table, const absl::Span<const std::string> columns,
+    const absl::Span<const PreparedStatementValue> values) {
+  if (!in_transaction_) {
+    return CopyRows(table, columns, values);
+  }
+  MLMD_RETURN_IF_ERROR(RunCommand(kStatementSavepoint));
+  return EndStatementSavepoint(CopyRows(table, columns, values));
+}
+
+Status PostgreSQLMetadataSource::CopyRows(
+    const std::string& table, const absl::Span<const std::string> columns,
+    const absl::Span<const PreparedStatementValue> values) {
+  std::vector<std::string> quoted_columns;
+  quoted_columns.reserve(columns.size());
+  for (const std::string& column : columns) {
+    quoted_columns.push_back(QuoteIdentifier(column));
+  }
+  const std::string copy = absl::StrCat(
+      "COPY ", QuoteIdentifier(table), " (",
+      absl::StrJoin(quoted_columns, ", "), ") FROM STDIN");
+  ResultPtr copy_result;
+  MLMD_RETURN_IF_ERROR(RunCommand(copy, &copy_result));
+  if (PQresultStatus(copy_result.get()) != PGRES_COPY_IN) {
+    return absl::InternalError(
+        absl::StrCat("COPY did not start: ", PQresStatus(PQresultStatus(
+                                                 copy_result.get()))));
+  }
+
+  Status status = absl::OkStatus();
+  std::string chunk;
+  chunk.reserve(kCopyChunkSize);
+  for (int i = 0; i < values.size() && status.ok(); ++i) {
+    AppendCopyValue(values[i], &chunk);
+    chunk.push_back((i + 1) % columns.size() == 0 ? '\n' : '\t');
+    if (chunk.size() >= kCopyChunkSize || i + 1 == values.size()) {
+      if (PQputCopyData(conn_, chunk.data(), chunk.size()) != 1) {
+        status = ConnectionError(conn_, "PQputCopyData");
+      }
+      chunk.clear();
+    }
+  }
+  // A failed COPY is ended with an error message, so that the server discards
+  // the rows.
+  if (PQputCopyEnd(conn_, status.ok() ? nullptr : "MLMD bulk insert failed") !=
+      1) {
+    status.Update(ConnectionError(conn_, "PQputCopyEnd"));
+  }
+  while (PGresult* raw_result = PQgetResult(conn_)) {
+    ResultPtr result(raw_result);
+    status.Update(CheckResult(conn_, result.get()));
+  }
+  return status;
+}
+
+Status PostgreSQLMetadataSource::ResetConnectionIfBroken() {
+  if (PQstatus(conn_) != CONNECTION_BAD) {
+    return absl::OkStatus();
+  }
+  PQreset(conn_);
+  prepared_statements_.clear();
+  if (PQstatus(conn_) != CONNECTION_OK) {
+    return ConnectionError(conn_, "PQreset");
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::BeginImpl() {
+  MLMD_RETURN_IF_ERROR(ResetConnectionIfBroken());
+  MLMD_RETURN_IF_ERROR(RunCommand(kBeginTransaction));
+  in_transaction_ = true;
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::BeginReadOnlyImpl() {
+  MLMD_RETURN_IF_ERROR(ResetConnectionIfBroken());
+  MLMD_RETURN_IF_ERROR(RunCommand(kBeginReadOnlyTransaction));
+  in_transaction_ = true;
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::BeginSnapshotReadImpl() {
+  MLMD_RETURN_IF_ERROR(ResetConnectionIfBroken());
+  MLMD_RETURN_IF_ERROR(RunCommand(kBeginSnapshotReadTransaction));
+  in_transaction_ = true;
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::CommitImpl() {
+  // If the commit fails, the transaction is closed by RollbackImpl.
+  ResultPtr result;
+  MLMD_RETURN_IF_ERROR(RunCommand(kCommitTransaction, &result));
+  in_transaction_ = false;
+  // The server rolls back a transaction which failed, and reports it as the
+  // status of the commit.
+  if (absl::string_view(PQcmdStatus(result.get())) == kRollbackTransaction) {
+    return absl::AbortedError(
+        "PostgreSQL transaction was rolled back at commit");
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::RollbackImpl() {
+  in_transaction_ = false;
+  return RunCommand(kRollbackTransaction);
+}
+
+std::string PostgreSQLMetadataSource::BytesLiteral(
+    absl::string_view value) const {
+  return absl::StrCat("decode('", absl::BytesToHexString(value), "', 'hex')");
+}
+
+std::string PostgreSQLMetadataSource::EscapeString(
+    absl::string_view value) const {
+  CHECK(conn_ != nullptr);
+  // In the worst case, each character is doubled, and the string is appended
+  // a terminating null character.
+  std::string buffer(value.length() * 2 + 1, '\0');
+  int error = 0;
+  const size_t length = PQescapeStringConn(conn_, &buffer[0], value.data(),
+                                           value.length(), &error);
+  CHECK(error == 0) << "PQescapeStringConn failed: " << PQerrorMessage(conn_);
+  buffer.resize(length);
+  return buffer;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,214 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
+#define ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "libpq-fe.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A MetadataSource based on a PostgreSQL backend, which runs the queries of
+// the query config with their backtick quoted identifiers quoted with double
+// quotes instead.
+//
+// An error aborts the whole transaction in PostgreSQL, while the callers
+// expect a failed query to leave the transaction usable, e.g., to probe the
+// tables when initializing the store. So each query of a transaction runs
+// within a savepoint, which is rolled back if the query fails. The SAVEPOINT,
+// the query and the RELEASE are sent in libpq pipeline mode, so that they
+// take one round trip to the server. The savepoint statements of the callers
+// themselves, i.e., SAVEPOINT, ROLLBACK TO and RELEASE, run as is. A query of
+// a transaction must be a single statement.
+//
+// The bulk inserts run with COPY ... FROM STDIN, which streams the rows to
+// the server in the text format of COPY instead of parsing an INSERT.
+//
+// This class is thread-unsafe.
+class PostgreSQLMetadataSource : public MetadataSource {
+ public:
+  // Initializes the PostgreSQLMetadataSource with given config.
+  // Check-fails if config is invalid.
+  explicit PostgreSQLMetadataSource(const PostgreSQLDatabaseConfig& config);
+
+  // Disallow copy and assign.
+  PostgreSQLMetadataSource(const PostgreSQLMetadataSource&) = delete;
+  PostgreSQLMetadataSource& operator=(const PostgreSQLMetadataSource&) =
+      delete;
+
+  ~PostgreSQLMetadataSource() override;
+
+  // Escapes the quotes of a string literal with PQescapeStringConn, for the
+  // standard_conforming_strings of the server. It aborts if the metadata
+  // source is not connected.
+  std::string EscapeString(absl::string_view value) const final;
+
+  // Returns the bytes as a decode('<hex>', 'hex') expression, as PostgreSQL
+  // has no X'<hex>' bytea literal.
+  std::string BytesLiteral(absl::string_view value) const final;
+
+ private:
+  // Clears a PGresult when it goes out of scope.
+  struct ResultDeleter {
+    void operator()(PGresult* result) const { PQclear(result); }
+  };
+  using ResultPtr = std::unique_ptr<PGresult, ResultDeleter>;
+
+  // Connects to the database specified in config_, and creates it first
+  // unless skip_db_creation is set.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ConnectImpl() final;
+
+  // Closes the connection, which drops its prepared statements.
+  absl::Status CloseImpl() final;
+
+  // Opens a transaction. A broken connection is reset first.
+  absl::Status BeginImpl() final;
+
+  // Opens a transaction with BEGIN READ ONLY, as BeginImpl.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Opens a REPEATABLE READ read-only transaction, which reads the snapshot
+  // taken by its first query, as BeginImpl.
+  absl::Status BeginSnapshotReadImpl() final;
+
+  // Executes a SQL statement and returns the rows if any.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  // Returns an ABORTED error, if the transaction fails to serialize or
+  //   deadlocks.
+  absl::Status ExecuteQueryImpl(const std::string& query,
+                                RecordSet* results) final;
+
+  // Executes a query with `?` placeholders as a named prepared statement,
+  // which is cached per connection and parsed in the same round trip as its
+  // first execution. The values are sent in text format, and the integer and
+  // floating point columns of the results are typed.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecutePreparedQueryImpl(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values,
+      TypedRecordSet* results) final;
+
+  // Executes a query in single-row mode, and passes its rows in batches. If
+  // the query or the callback fails, the savepoint of the query is rolled
+  // back, which undoes its writes if any.
+  absl::Status ExecuteStreamingQueryImpl(
+      const std::string& query, int max_batch_size,
+      const RecordBatchCallback& callback) final;
+
+  // Executes the queries as named prepared statements, see
+  // ExecutePreparedQueryImpl, which are sent in one pipeline.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecutePipelinedQueriesImpl(
+      absl::Span<const PipelinedQuery> queries,
+      std::vector<TypedRecordSet>* results) final;
+
+  // Inserts the rows with COPY ... FROM STDIN.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecuteBulkInsertImpl(
+      const std::string& table, absl::Span<const std::string> columns,
+      absl::Span<const PreparedStatementValue> values) final;
+
+  // Commits the currently open transaction.
+  // Returns an ABORTED error, if the transaction is rolled back instead.
+  absl::Status CommitImpl() final;
+
+  // Rollbacks the currently open transaction.
+  absl::Status RollbackImpl() final;
+
+  // Opens a connection to `dbname` with the other parameters of config_.
+  absl::Status OpenConnection(const std::string& dbname, PGconn** conn) const;
+
+  // Creates config_.dbname() if it does not exist, through a connection to
+  // the maintenance database.
+  absl::Status CreateDatabaseIfNotExists() const;
+
+  // Resets the connection if it is broken, e.g., closed by the server while
+  // idle. The prepared statements are lost with it.
+  absl::Status ResetConnectionIfBroken();
+
+  // Runs `statement` with PQexec, which accepts several statements, and
+  // returns its result if `result` is not null.
+  absl::Status RunCommand(const std::string& statement,
+                          ResultPtr* result = nullptr);
+
+  // Runs a single `statement` with the `params` bound to its $n placeholders,
+  // within the savepoint of the statements if a transaction is open. If
+  // `prepared_query` is not empty, the statement runs as the prepared statement
+  // of that query, and is prepared first if it is not cached yet.
+  absl::Status RunStatement(const std::string& statement,
+                            absl::Span<const char* const> params,
+                            const std::string& prepared_query,
+                            ResultPtr* result);
+
+  // A statement run by RunStatements, see RunStatement.
+  struct PipelinedStatement {
+    std::string statement;
+    std::vector<const char*> params;
+    std::string prepared_query;
+  };
+
+  // Runs the `statements` as RunStatement does, within one savepoint, and
+  // sends them in one pipeline. The statements after a failed one are
+  // skipped. Returns the result of `statements[i]` in `results[i]`, if
+  // `results` is not null.
+  absl::Status RunStatements(absl::Span<const PipelinedStatement> statements,
+                             std::vector<ResultPtr>* results);
+
+  // Runs `statement` and passes its rows to `callback` in batches.
+  absl::Status StreamStatement(const std::string& statement,
+                               int max_batch_size,
+                               const RecordBatchCallback& callback);
+
+  // Streams the `values` to the server with COPY.
+  absl::Status CopyRows(const std::string& table,
+                        absl::Span<const std::string> columns,
+                        absl::Span<const PreparedStatementValue> values);
+
+  // Releases the savepoint of the statements if `status` is OK, and rolls it
+  // back otherwise. Returns `status`, or the error of the release.
+  absl::Status EndStatementSavepoint(const absl::Status& status);
+
+  // The connection to the PostgreSQL backend. Initialized in ConnectImpl().
+  PGconn* conn_ = nullptr;
+
+  // Config to connect to the PostgreSQL backend.
+  const PostgreSQLDatabaseConfig config_;
+
+  // True while a transaction is open in the backend, i.e., not in the
+  // autocommit mode, in which no savepoint is needed.
+  bool in_transaction_ = false;
+
+  // The names of the prepared statements of the connection keyed by query
+  // text.
+  absl::flat_hash_map<std::string, std::string> prepared_statements_;
+  // The number of statements prepared on the connection, which numbers the
+  // statement names.
+  int64 num_prepared_statements_ = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/put_coalescer.h"
+
+#include <glog/logging.h>
+
+namespace ml_metadata {
+
+PutCoalescer::PutCoalescer(MetadataStorePool* metadata_store_pool,
+                           const PutCoalescerOptions& options)
+    : metadata_store_pool_(metadata_store_pool), options_(options) {
+  CHECK(metadata_store_pool_ != nullptr)
+      << "The metadata_store_pool must not be null.";
+  CHECK_GT(options_.max_batch_size, 0)
+      << "The max_batch_size must be positive.";
+}
+
+tensorflow::Status PutCoalescer::PutExecution(
+    const PutExecutionRequest& request, PutExecutionResponse* response) {
+  MetadataStore::BatchedPut put;
+  put.put_execution_request = &request;
+  put.put_execution_response = response;
+  return Put(put);
+}
+
+tensorflow::Status PutCoalescer::PutEvents(const PutEventsRequest& request,
+                                           PutEventsResponse* response) {
+  MetadataStore::BatchedPut put;
+  put.put_events_request = &request;
+  put.put_events_response = response;
+  return Put(put);
+}
+
+int64 PutCoalescer::num_batches() const {
+  absl::MutexLock lock(&mu_);
+  return num_batches_;
+}
+
+tensorflow::Status PutCoalescer::Put(const MetadataStore::BatchedPut& put) {
+  std::shared_ptr<Batch> batch;
+  int index;
+  {
+    absl::MutexLock lock(&mu_);
+    const bool is_first = open_batch_ == nullptr;
+    if (is_first) {
+      open_batch_ = std::make_shared<Batch>();
+    }
+    batch = open_batch_;
+    index = batch->puts.size();
+    batch->puts.push_back(put);
+    if (batch->puts.size() >= options_.max_batch_size) {
+      // The next call opens another batch.
+      batch->is_full = true;
+      open_batch_.reset();
+    }
+    if (!is_first) {
+      mu_.Await(absl::Condition(&batch->is_done));
+      return batch->puts[index].status;
+    }
+    mu_.AwaitWithTimeout(absl::Condition(&batch->is_full),
+                         options_.max_latency);
+    if (open_batch_ == batch) {
+      open_batch_.reset();
+    }
+    num_batches_++;
+  }
+  // No call joins the batch once it is closed, so it is run without the lock.
+  RunBatch(batch.get());
+  absl::MutexLock lock(&mu_);
+  batch->is_done = true;
+  return batch->puts[index].status;
+}
+
+void PutCoalescer::RunBatch(Batch* batch) {
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  tensorflow::Status status = metadata_store_pool_->Acquire(&metadata_store);
+  if (status.ok()) {
+    status = metadata_store->PutInBatch(&batch->puts);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "A batch of " << batch->puts.size()
+                 << " puts failed: " << status;
+    for (MetadataStore::BatchedPut& put : batch->puts) {
+      put.status = status;
+    }
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,106 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_PUT_COALESCER_H_
+#define ML_METADATA_METADATA_STORE_PUT_COALESCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Options to tune a PutCoalescer.
+struct PutCoalescerOptions {
+  // The max number of calls merged into one transaction. It must be positive.
+  int max_batch_size = 64;
+  // The max duration the first call of a batch waits for more calls before
+  // the batch is run, i.e., the latency added to a call.
+  absl::Duration max_latency = absl::Milliseconds(2);
+};
+
+// Merges concurrent PutExecution and PutEvents calls into shared transactions
+// run on the stores of a MetadataStorePool (group commit). The commit of a
+// small write is dominated by the flush of the database log, e.g., the fsync
+// of InnoDB, which one batch pays once for all its calls. Each call runs under
+// its own savepoint, so a failed call does not fail the others. It is
+// thread-safe.
+//
+// The first call of a batch runs the batch, once `max_batch_size` calls have
+// joined it or `max_latency` has passed. The calls arriving meanwhile start the
+// next batch.
+//
+// Note that the calls of a batch are independent: a call should not depend on
+// the effects of another call that is still in flight.
+class PutCoalescer {
+ public:
+  // `metadata_store_pool` is not owned and must outlive the coalescer.
+  PutCoalescer(MetadataStorePool* metadata_store_pool,
+               const PutCoalescerOptions& options);
+
+  // Disallow copy and assign.
+  PutCoalescer(const PutCoalescer&) = delete;
+  PutCoalescer& operator=(const PutCoalescer&) = delete;
+
+  // Runs MetadataStore::PutExecution in a batch, and returns its status.
+  // Returns detailed error, if no store can be acquired or the batch cannot
+  //   be committed.
+  tensorflow::Status PutExecution(const PutExecutionRequest& request,
+                                  PutExecutionResponse* response);
+
+  // Runs MetadataStore::PutEvents in a batch, and returns its status.
+  // Returns detailed error, if no store can be acquired or the batch cannot
+  //   be committed.
+  tensorflow::Status PutEvents(const PutEventsRequest& request,
+                               PutEventsResponse* response);
+
+  // Returns the number of batches that have been run.
+  int64 num_batches() const;
+
+ private:
+  // The calls joining the same transaction.
+  struct Batch {
+    std::vector<MetadataStore::BatchedPut> puts;
+    // Set once `max_batch_size` calls have joined the batch.
+    bool is_full = false;
+    // Set once the statuses of `puts` are final.
+    bool is_done = false;
+  };
+
+  // Adds `put` to the open batch, or opens one, and waits for the batch to be
+  // run. Returns the status of `put`.
+  tensorflow::Status Put(const MetadataStore::BatchedPut& put);
+
+  // Runs the puts of a batch in one transaction and sets their statuses.
+  void RunBatch(Batch* batch);
+
+  MetadataStorePool* const metadata_store_pool_;
+  const PutCoalescerOptions options_;
+
+  mutable absl::Mutex mu_;
+  // The batch new calls join, or nullptr if there is none.
+  std::shared_ptr<Batch> open_batch_ ABSL_GUARDED_BY(mu_);
+  int64 num_batches_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_PUT_COALESCER_H_
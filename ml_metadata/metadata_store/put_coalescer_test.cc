@@ -0,0 +1,149 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/put_coalescer.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+// The pool has a single store, whose in-memory database is seen by all calls.
+class PutCoalescerTest : public ::testing::Test {
+ protected:
+  PutCoalescerTest()
+      : metadata_store_pool_(FakeDatabaseConnectionConfig(),
+                             SingleStorePoolOptions()) {}
+
+  void SetUp() override {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_ASSERT_OK(metadata_store_pool_.Acquire(&store));
+    const PutExecutionTypeRequest request =
+        ParseTextProtoOrDie<PutExecutionTypeRequest>(R"(
+          all_fields_match: true
+          execution_type: { name: 'coalesced_type' }
+        )");
+    PutExecutionTypeResponse response;
+    TF_ASSERT_OK(store->PutExecutionType(request, &response));
+    type_id_ = response.type_id();
+  }
+
+  static ConnectionConfig FakeDatabaseConnectionConfig() {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    return connection_config;
+  }
+
+  static MetadataStorePoolOptions SingleStorePoolOptions() {
+    MetadataStorePoolOptions options;
+    options.max_size = 1;
+    return options;
+  }
+
+  // Runs the PutExecution `requests` concurrently and returns their statuses.
+  std::vector<tensorflow::Status> PutExecutionsConcurrently(
+      const std::vector<PutExecutionRequest>& requests,
+      PutCoalescer* coalescer) {
+    std::vector<tensorflow::Status> statuses(requests.size());
+    std::vector<std::thread> calls;
+    for (int i = 0; i < requests.size(); i++) {
+      calls.emplace_back([&requests, coalescer, &statuses, i]() {
+        PutExecutionResponse response;
+        statuses[i] = coalescer->PutExecution(requests[i], &response);
+      });
+    }
+    for (std::thread& call : calls) {
+      call.join();
+    }
+    return statuses;
+  }
+
+  PutExecutionRequest ValidRequest() const {
+    PutExecutionRequest request;
+    request.mutable_execution()->set_type_id(type_id_);
+    return request;
+  }
+
+  int GetNumExecutions() {
+    MetadataStorePool::ScopedMetadataStore store;
+    TF_CHECK_OK(metadata_store_pool_.Acquire(&store));
+    GetExecutionsResponse response;
+    TF_CHECK_OK(store->GetExecutions(GetExecutionsRequest(), &response));
+    return response.executions_size();
+  }
+
+  MetadataStorePool metadata_store_pool_;
+  int64 type_id_;
+};
+
+TEST_F(PutCoalescerTest, RunFullBatchInOneTransaction) {
+  PutCoalescerOptions options;
+  options.max_batch_size = 4;
+  // Only a full batch is run.
+  options.max_latency = absl::InfiniteDuration();
+  PutCoalescer coalescer(&metadata_store_pool_, options);
+
+  const std::vector<tensorflow::Status> statuses = PutExecutionsConcurrently(
+      std::vector<PutExecutionRequest>(4, ValidRequest()), &coalescer);
+  for (const tensorflow::Status& status : statuses) {
+    TF_EXPECT_OK(status);
+  }
+  EXPECT_EQ(coalescer.num_batches(), 1);
+  EXPECT_EQ(GetNumExecutions(), 4);
+}
+
+TEST_F(PutCoalescerTest, FailedPutDoesNotFailBatch) {
+  PutCoalescerOptions options;
+  options.max_batch_size = 3;
+  options.max_latency = absl::InfiniteDuration();
+  PutCoalescer coalescer(&metadata_store_pool_, options);
+
+  // The request without execution fails.
+  const std::vector<tensorflow::Status> statuses = PutExecutionsConcurrently(
+      {ValidRequest(), PutExecutionRequest(), ValidRequest()}, &coalescer);
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(statuses[1]));
+  TF_EXPECT_OK(statuses[2]);
+  EXPECT_EQ(coalescer.num_batches(), 1);
+  EXPECT_EQ(GetNumExecutions(), 2);
+}
+
+TEST_F(PutCoalescerTest, RunBatchAfterMaxLatency) {
+  PutCoalescerOptions options;
+  options.max_batch_size = 100;
+  options.max_latency = absl::Milliseconds(1);
+  PutCoalescer coalescer(&metadata_store_pool_, options);
+
+  PutExecutionResponse response;
+  TF_ASSERT_OK(coalescer.PutExecution(ValidRequest(), &response));
+  EXPECT_GT(response.execution_id(), 0);
+  EXPECT_EQ(coalescer.num_batches(), 1);
+  EXPECT_EQ(GetNumExecutions(), 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -13,38 +13,188 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/write_behind_queue.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "include/pybind11/pybind11.h"
+#include "include/pybind11/stl.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace {
 namespace py = pybind11;
 
+// A MetadataStore of the python module. Its calls release the GIL, so that
+// the other python threads run meanwhile, and are serialized by `mu`, as the
+// store is not thread-safe.
+struct PyMetadataStore {
+  std::unique_ptr<ml_metadata::MetadataStore> store;
+  absl::Mutex mu;
+};
+
+// A pool of MetadataStores of the python module for the async calls. The
+// calls run on the threads of `executor`, each with a store borrowed from
+// `pool`, and pass their results to python callbacks, so that many concurrent
+// calls do not need as many python threads.
+struct PyMetadataStorePool {
+  std::unique_ptr<ml_metadata::MetadataStorePool> pool;
+  std::unique_ptr<tensorflow::thread::ThreadPool> executor;
+
+  ~PyMetadataStorePool() {
+    // Waits for the scheduled calls, whose callbacks need the GIL.
+    py::gil_scoped_release release_gil;
+    executor.reset();
+  }
+};
+
+// A WriteBehindQueue of the python module, which is thread-safe.
+struct PyWriteBehindQueue {
+  std::unique_ptr<ml_metadata::WriteBehindQueue> queue;
+
+  ~PyWriteBehindQueue() {
+    // Waits for the batch being flushed.
+    py::gil_scoped_release release_gil;
+    queue.reset();
+  }
+};
+
+// Parses the serialized options of CreateMetadataStore and
+// CreateMetadataStorePool. Returns python RuntimeError if any fails to parse.
+void ParseCreationOptions(
+    const std::string& connection_config, const std::string& migration_options,
+    ml_metadata::ConnectionConfig* proto_connection_config,
+    ml_metadata::MigrationOptions* proto_migration_options) {
+  if (!proto_connection_config->ParseFromString(connection_config)) {
+    throw std::runtime_error("Could not parse proto.");
+  }
+  if (!proto_migration_options->ParseFromString(migration_options)) {
+    throw std::runtime_error("Could not parse proto.");
+  }
+}
+
 // Creates a MetadataStore object and returns as a unique pointer.
 // Returns python RuntimeError if any error occur during creation.
-std::unique_ptr<ml_metadata::MetadataStore> CreateMetadataStore(
+std::unique_ptr<PyMetadataStore> CreateMetadataStore(
     const std::string& connection_config,
     const std::string& migration_options) {
   ml_metadata::ConnectionConfig proto_connection_config;
-  if (!proto_connection_config.ParseFromString(connection_config)) {
-    throw std::runtime_error("Could not parse proto.");
-  }
   ml_metadata::MigrationOptions proto_migration_options;
-  if (!proto_migration_options.ParseFromString(migration_options)) {
-    throw std::runtime_error("Could not parse proto.");
+  ParseCreationOptions(connection_config, migration_options,
+                       &proto_connection_config, &proto_migration_options);
+  auto metadata_store = absl::make_unique<PyMetadataStore>();
+  tensorflow::Status creation_status;
+  {
+    py::gil_scoped_release release_gil;
+    creation_status = ml_metadata::CreateMetadataStore(
+        proto_connection_config, proto_migration_options,
+        &metadata_store->store);
   }
-  std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
-  tensorflow::Status creation_status = ml_metadata::CreateMetadataStore(
-      proto_connection_config, proto_migration_options, &metadata_store);
   if (!creation_status.ok()) {
     throw std::runtime_error(creation_status.error_message());
   }
   return metadata_store;
 }
 
+// Returns true if each store of `config` connects to its own in-memory
+// database.
+bool IsPerStoreDatabase(const ml_metadata::ConnectionConfig& config) {
+  return config.has_fake_database() ||
+         (config.has_sqlite() &&
+          (config.sqlite().filename_uri().empty() ||
+           config.sqlite().filename_uri() == ":memory:"));
+}
+
+// Creates a pool of at most `num_threads` MetadataStores, whose calls run on
+// as many threads. The schema is initialized or migrated by a store created
+// first, as the stores of the pool do not handle migration. An in-memory
+// database is served by a single store kept forever, as each store connects to
+// its own database.
+// Returns python RuntimeError if any error occur during creation.
+std::unique_ptr<PyMetadataStorePool> CreateMetadataStorePool(
+    const std::string& connection_config, const std::string& migration_options,
+    const int num_threads) {
+  if (num_threads <= 0) {
+    throw std::invalid_argument("The num_threads must be positive.");
+  }
+  ml_metadata::ConnectionConfig proto_connection_config;
+  ml_metadata::MigrationOptions proto_migration_options;
+  ParseCreationOptions(connection_config, migration_options,
+                       &proto_connection_config, &proto_migration_options);
+  ml_metadata::MetadataStorePoolOptions pool_options;
+  pool_options.max_size = num_threads;
+  if (IsPerStoreDatabase(proto_connection_config)) {
+    pool_options.max_size = 1;
+    pool_options.max_idle_time = absl::InfiniteDuration();
+  }
+  auto store_pool = absl::make_unique<PyMetadataStorePool>();
+  tensorflow::Status creation_status;
+  {
+    py::gil_scoped_release release_gil;
+    std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
+    creation_status = ml_metadata::CreateMetadataStore(
+        proto_connection_config, proto_migration_options, &metadata_store);
+    if (creation_status.ok()) {
+      store_pool->pool = absl::make_unique<ml_metadata::MetadataStorePool>(
+          proto_connection_config, pool_options);
+      store_pool->executor = absl::make_unique<tensorflow::thread::ThreadPool>(
+          tensorflow::Env::Default(), "mlmd_python_async", num_threads);
+    }
+  }
+  if (!creation_status.ok()) {
+    throw std::runtime_error(creation_status.error_message());
+  }
+  return store_pool;
+}
+
+// Creates a WriteBehindQueue, which writes with a MetadataStore of its own
+// and logs the queued requests in `directory`.
+// Returns python RuntimeError if any error occur during creation.
+std::unique_ptr<PyWriteBehindQueue> CreateWriteBehindQueue(
+    const std::string& connection_config, const std::string& migration_options,
+    const std::string& directory, const int max_batch_size,
+    const double max_latency_sec, const bool sync_on_enqueue) {
+  ml_metadata::ConnectionConfig proto_connection_config;
+  ml_metadata::MigrationOptions proto_migration_options;
+  ParseCreationOptions(connection_config, migration_options,
+                       &proto_connection_config, &proto_migration_options);
+  ml_metadata::WriteBehindQueueOptions queue_options;
+  queue_options.directory = directory;
+  queue_options.max_batch_size = max_batch_size;
+  queue_options.max_latency = absl::Seconds(max_latency_sec);
+  queue_options.sync_on_enqueue = sync_on_enqueue;
+  auto write_behind_queue = absl::make_unique<PyWriteBehindQueue>();
+  tensorflow::Status creation_status;
+  {
+    py::gil_scoped_release release_gil;
+    std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
+    creation_status = ml_metadata::CreateMetadataStore(
+        proto_connection_config, proto_migration_options, &metadata_store);
+    if (creation_status.ok()) {
+      creation_status = ml_metadata::WriteBehindQueue::Create(
+          std::move(metadata_store), queue_options,
+          &write_behind_queue->queue);
+    }
+  }
+  if (!creation_status.ok()) {
+    throw std::runtime_error(creation_status.error_message());
+  }
+  return write_behind_queue;
+}
+
 // A MetadataStore method returns a tuple to the python metadata_store.py.
 // The tuple is consist of serialized method response, and a strong typed
 // error with error_message and canonical error code.
@@ -56,32 +206,287 @@ py::tuple ConvertAccessMetadataStoreResultToPyTuple(
                         py::int_((int)status.code()));
 }
 
-// Utility method to dispatch python method calls. The `request` is parsed and
-// passed to the `method` of MetadataStore. It returns the `response` and
-// strong typed errors if any.
+// Parses the serialized `request`, passes it to the `method` of the
+// `metadata_store` and serializes the response to `response`, without the GIL.
+// `mu` serializes the calls of the store, if given.
 template <typename InputProto, typename OutputProto>
-py::tuple AccessMetadataStore(
-    ml_metadata::MetadataStore* metadata_store, const std::string& request,
+tensorflow::Status CallMetadataStore(
+    ml_metadata::MetadataStore* metadata_store, absl::Mutex* mu,
     tensorflow::Status (ml_metadata::MetadataStore::*method)(const InputProto&,
-                                                             OutputProto*)) {
+                                                             OutputProto*),
+    const std::string& request, std::string* response) {
   InputProto proto_request;
   if (!proto_request.ParseFromString(request)) {
-    return ConvertAccessMetadataStoreResultToPyTuple(
-        /*serialized_proto_message=*/"",
-        tensorflow::errors::InvalidArgument("Could not parse proto"));
+    return tensorflow::errors::InvalidArgument("Could not parse proto");
   }
   OutputProto proto_response;
-  tensorflow::Status call_status =
-      ((*metadata_store).*method)(proto_request, &proto_response);
+  tensorflow::Status call_status;
+  {
+    absl::MutexLockMaybe lock(mu);
+    call_status = (metadata_store->*method)(proto_request, &proto_response);
+  }
+  proto_response.SerializeToString(response);
+  return call_status;
+}
+
+// Utility method to dispatch python method calls. The `request` is parsed and
+// passed to the `method` of MetadataStore. It returns the `response` and
+// strong typed errors if any. The GIL is released until the response is
+// serialized.
+template <typename InputProto, typename OutputProto>
+py::tuple AccessMetadataStore(
+    PyMetadataStore* metadata_store, const std::string& request,
+    tensorflow::Status (ml_metadata::MetadataStore::*method)(const InputProto&,
+                                                             OutputProto*)) {
   std::string response;
-  proto_response.SerializeToString(&response);
+  tensorflow::Status call_status;
+  {
+    py::gil_scoped_release release_gil;
+    call_status = CallMetadataStore(metadata_store->store.get(),
+                                    &metadata_store->mu, method, request,
+                                    &response);
+  }
   return ConvertAccessMetadataStoreResultToPyTuple(response, call_status);
 }
 
+// The MetadataStore methods exposed to python.
+#define METADATA_STORE_METHODS(X)           \
+  X(PutArtifactType)                        \
+  X(PutArtifacts)                           \
+  X(PutExecutions)                          \
+  X(PutExecutionType)                       \
+  X(PutEvents)                              \
+  X(PutExecution)                           \
+  X(PutTypes)                               \
+  X(PutContextType)                         \
+  X(PutContexts)                            \
+  X(PutAttributionsAndAssociations)         \
+  X(PutParentContexts)                      \
+  X(GetArtifactType)                        \
+  X(GetArtifactTypesByID)                   \
+  X(GetArtifactTypes)                       \
+  X(GetExecutionType)                       \
+  X(GetExecutionTypesByID)                  \
+  X(GetExecutionTypes)                      \
+  X(GetContextType)                         \
+  X(GetContextTypesByID)                    \
+  X(GetContextTypes)                        \
+  X(GetArtifacts)                           \
+  X(GetExecutions)                          \
+  X(GetContexts)                            \
+  X(GetArtifactsByID)                       \
+  X(GetExecutionsByID)                      \
+  X(GetContextsByID)                        \
+  X(GetArtifactsByType)                     \
+  X(GetArtifactByTypeAndName)               \
+  X(GetExecutionsByType)                    \
+  X(GetExecutionByTypeAndName)              \
+  X(GetContextsByType)                      \
+  X(GetContextByTypeAndName)                \
+  X(GetArtifactsByURI)                      \
+  X(GetEventsByExecutionIDs)                \
+  X(GetEventsByArtifactIDs)                 \
+  X(GetContextsByArtifact)                  \
+  X(GetContextsByExecution)                 \
+  X(GetArtifactsByContext)                  \
+  X(GetExecutionsByContext)                 \
+  X(GetParentContextsByContext)             \
+  X(GetChildrenContextsByContext)
+
+// A MetadataStore method called by name, see CallMetadataStore.
+using MetadataStoreCall = std::function<tensorflow::Status(
+    ml_metadata::MetadataStore*, const std::string&, std::string*)>;
+
+#define METADATA_STORE_CALL_ENTRY(method)                              \
+  {#method,                                                            \
+   [](ml_metadata::MetadataStore* metadata_store,                      \
+      const std::string& request, std::string* response) {             \
+     return CallMetadataStore(metadata_store, /*mu=*/nullptr,          \
+                              &ml_metadata::MetadataStore::method,     \
+                              request, response);                      \
+   }},
+
+// Returns the METADATA_STORE_METHODS keyed by their names.
+const absl::flat_hash_map<std::string, MetadataStoreCall>&
+GetMetadataStoreCalls() {
+  static const auto* calls =
+      new absl::flat_hash_map<std::string, MetadataStoreCall>(
+          {METADATA_STORE_METHODS(METADATA_STORE_CALL_ENTRY)});
+  return *calls;
+}
+
+// Schedules the `method` call of `request` on the threads of the
+// `store_pool`, and returns without waiting for it. Once the call finishes,
+// `callback` is called from the thread of the call with the result, like the
+// one of AccessMetadataStore, as the arguments. The callback should return
+// quickly, e.g., by passing the result to an event loop, as it holds the GIL.
+// Returns python ValueError if the method is unknown.
+void CallAsync(PyMetadataStorePool* store_pool, const std::string& method,
+               std::string request, py::function callback) {
+  const auto& calls = GetMetadataStoreCalls();
+  const auto it = calls.find(method);
+  if (it == calls.end()) {
+    throw std::invalid_argument("Unknown MetadataStore method: " + method);
+  }
+  // The callback is only copied and released with the GIL held.
+  auto* py_callback = new py::function(std::move(callback));
+  store_pool->executor->Schedule([pool = store_pool->pool.get(),
+                                  call = &it->second,
+                                  request = std::move(request), py_callback]() {
+    std::string response;
+    tensorflow::Status call_status;
+    {
+      ml_metadata::MetadataStorePool::ScopedMetadataStore metadata_store;
+      call_status = pool->Acquire(&metadata_store);
+      if (call_status.ok()) {
+        call_status = (*call)(metadata_store.get(), request, &response);
+      }
+    }
+    py::gil_scoped_acquire acquire_gil;
+    try {
+      (*py_callback)(py::bytes(response),
+                     py::bytes(call_status.error_message()),
+                     py::int_((int)call_status.code()));
+    } catch (py::error_already_set& e) {
+      // The error cannot be raised to the caller, which has not waited.
+      e.restore();
+      PyErr_WriteUnraisable(py_callback->ptr());
+    }
+    delete py_callback;
+  });
+}
+
+// Runs the PutExecution and PutEvents calls of `requests`, given as pairs of
+// the method name and the serialized request, in one transaction, see
+// MetadataStore::PutInBatch. It returns a tuple of the list of the results of
+// the calls, each like the result of AccessMetadataStore, and the error of
+// the transaction, if any. The GIL is released until the responses are
+// serialized.
+py::tuple PutInBatch(
+    PyMetadataStore* metadata_store,
+    const std::vector<std::pair<std::string, std::string>>& requests) {
+  std::vector<ml_metadata::PutExecutionRequest> put_execution_requests;
+  std::vector<ml_metadata::PutEventsRequest> put_events_requests;
+  std::vector<ml_metadata::PutExecutionResponse> put_execution_responses;
+  std::vector<ml_metadata::PutEventsResponse> put_events_responses;
+  std::vector<ml_metadata::MetadataStore::BatchedPut> batch;
+  std::vector<std::string> responses(requests.size());
+  tensorflow::Status batch_status;
+  {
+    py::gil_scoped_release release_gil;
+    // The requests and responses are not moved once the batch points to them.
+    put_execution_requests.reserve(requests.size());
+    put_events_requests.reserve(requests.size());
+    put_execution_responses.reserve(requests.size());
+    put_events_responses.reserve(requests.size());
+    batch.resize(requests.size());
+    for (int i = 0; i < requests.size() && batch_status.ok(); i++) {
+      bool parsed = false;
+      if (requests[i].first == "PutExecution") {
+        put_execution_requests.emplace_back();
+        put_execution_responses.emplace_back();
+        parsed = put_execution_requests.back().ParseFromString(
+            requests[i].second);
+        batch[i].put_execution_request = &put_execution_requests.back();
+        batch[i].put_execution_response = &put_execution_responses.back();
+      } else if (requests[i].first == "PutEvents") {
+        put_events_requests.emplace_back();
+        put_events_responses.emplace_back();
+        parsed = put_events_requests.back().ParseFromString(requests[i].second);
+        batch[i].put_events_request = &put_events_requests.back();
+        batch[i].put_events_response = &put_events_responses.back();
+      } else {
+        batch_status = tensorflow::errors::InvalidArgument(
+            "Only PutExecution and PutEvents can run in a batch, got: ",
+            requests[i].first);
+      }
+      if (batch_status.ok() && !parsed) {
+        batch_status = tensorflow::errors::InvalidArgument(
+            "Could not parse proto");
+      }
+    }
+    if (batch_status.ok()) {
+      absl::MutexLock lock(&metadata_store->mu);
+      batch_status = metadata_store->store->PutInBatch(&batch);
+    }
+    if (batch_status.ok()) {
+      for (int i = 0; i < batch.size(); i++) {
+        if (batch[i].put_execution_response != nullptr) {
+          batch[i].put_execution_response->SerializeToString(&responses[i]);
+        } else {
+          batch[i].put_events_response->SerializeToString(&responses[i]);
+        }
+      }
+    }
+  }
+  py::list results;
+  if (batch_status.ok()) {
+    for (int i = 0; i < batch.size(); i++) {
+      results.append(
+          ConvertAccessMetadataStoreResultToPyTuple(responses[i],
+                                                    batch[i].status));
+    }
+  }
+  return py::make_tuple(results, py::bytes(batch_status.error_message()),
+                        py::int_((int)batch_status.code()));
+}
+
+// Queues the PutExecution or PutEvents call `method` of the serialized
+// `request`. It returns a tuple of the error message and the code of the
+// error, if the request cannot be logged.
+py::tuple WriteBehind(PyWriteBehindQueue* write_behind_queue,
+                      const std::string& method, const std::string& request) {
+  tensorflow::Status status;
+  {
+    py::gil_scoped_release release_gil;
+    if (method == "PutExecution") {
+      ml_metadata::PutExecutionRequest proto_request;
+      status = proto_request.ParseFromString(request)
+                   ? write_behind_queue->queue->PutExecution(proto_request)
+                   : tensorflow::errors::InvalidArgument(
+                         "Could not parse proto");
+    } else if (method == "PutEvents") {
+      ml_metadata::PutEventsRequest proto_request;
+      status = proto_request.ParseFromString(request)
+                   ? write_behind_queue->queue->PutEvents(proto_request)
+                   : tensorflow::errors::InvalidArgument(
+                         "Could not parse proto");
+    } else {
+      status = tensorflow::errors::InvalidArgument(
+          "Only PutExecution and PutEvents can be written behind, got: ",
+          method);
+    }
+  }
+  return py::make_tuple(py::bytes(status.error_message()),
+                        py::int_((int)status.code()));
+}
+
+// Waits until the requests queued before the call are flushed, see
+// WriteBehindQueue::Flush. It returns a tuple like WriteBehind.
+py::tuple FlushWriteBehindQueue(PyWriteBehindQueue* write_behind_queue,
+                                const double timeout_sec) {
+  tensorflow::Status status;
+  {
+    py::gil_scoped_release release_gil;
+    status = write_behind_queue->queue->Flush(absl::Seconds(timeout_sec));
+  }
+  return py::make_tuple(py::bytes(status.error_message()),
+                        py::int_((int)status.code()));
+}
+
+// Returns a tuple of the numbers of the pending, flushed and failed requests
+// of the queue.
+py::tuple GetWriteBehindQueueStats(PyWriteBehindQueue* write_behind_queue) {
+  const ml_metadata::WriteBehindQueue& queue = *write_behind_queue->queue;
+  return py::make_tuple(queue.num_pending_requests(),
+                        queue.num_flushed_requests(),
+                        queue.num_failed_requests());
+}
+
 // A macro to define pybind module methods.
 #define METADATA_STORE_METHOD_PYBIND11_DECLARE(method)            \
   m.def(#method,                                                  \
-      [](ml_metadata::MetadataStore& metadata_store,              \
+      [](PyMetadataStore& metadata_store,                         \
          const std::string& request) -> py::tuple {               \
         return AccessMetadataStore(                               \
             &metadata_store, request,                             \
@@ -91,49 +496,25 @@ py::tuple AccessMetadataStore(
 PYBIND11_MODULE(metadata_store_extension, main_module) {
   auto m = main_module.def_submodule("metadata_store");
   m.doc() = "MLMD MetadataStore API pybind11 extension module.";
-  py::class_<ml_metadata::MetadataStore>(m, "MetadataStore");
+  py::class_<PyMetadataStore>(m, "MetadataStore");
+  py::class_<PyMetadataStorePool>(m, "MetadataStorePool");
+  py::class_<PyWriteBehindQueue>(m, "WriteBehindQueue");
   m.def("CreateMetadataStore", &CreateMetadataStore, "Create MetadataStore.");
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutArtifactType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutArtifacts)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutExecutions)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutExecutionType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutEvents)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutExecution)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutTypes)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutContextType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutContexts)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutAttributionsAndAssociations)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(PutParentContexts)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactTypesByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactTypes)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionTypesByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionTypes)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextTypesByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextTypes)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifacts)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutions)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContexts)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByID)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactByTypeAndName)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionByTypeAndName)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByType)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextByTypeAndName)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByURI)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetEventsByExecutionIDs)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetEventsByArtifactIDs)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByArtifact)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByExecution)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByContext)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByContext)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetParentContextsByContext)
-  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetChildrenContextsByContext)
+  m.def("CreateMetadataStorePool", &CreateMetadataStorePool,
+        "Create MetadataStorePool for async calls.");
+  m.def("PutInBatch", &PutInBatch,
+        "Run PutExecution and PutEvents calls in one transaction.");
+  m.def("CallAsync", &CallAsync,
+        "Schedule a MetadataStore call, whose result is passed to a callback.");
+  m.def("CreateWriteBehindQueue", &CreateWriteBehindQueue,
+        "Create WriteBehindQueue for PutExecution and PutEvents calls.");
+  m.def("WriteBehind", &WriteBehind,
+        "Queue a PutExecution or PutEvents call to be written behind.");
+  m.def("FlushWriteBehindQueue", &FlushWriteBehindQueue,
+        "Wait until the queued calls are written.");
+  m.def("GetWriteBehindQueueStats", &GetWriteBehindQueueStats,
+        "Get the numbers of pending, flushed and failed queued calls.");
+  METADATA_STORE_METHODS(METADATA_STORE_METHOD_PYBIND11_DECLARE)
 }
 
 }  // namespace
@@ -0,0 +1,105 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/query_accounting.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace ml_metadata {
+namespace {
+
+// The number of templates listed when a budget is exceeded.
+constexpr int kMaxNumListedTemplates = 5;
+
+// The innermost scope of the thread, if any.
+thread_local ScopedQueryAccounting* current_scope = nullptr;
+
+// Appends a description of a limit to `exceeded_limits` if `value` exceeds
+// it.
+void CheckLimit(const absl::string_view name, const int64 value,
+                const int64 limit, std::vector<std::string>* exceeded_limits) {
+  if (limit > 0 && value > limit) {
+    exceeded_limits->push_back(absl::StrCat(name, " ", value, " > ", limit));
+  }
+}
+
+}  // namespace
+
+std::string CheckQueryBudget(const QueryStats& stats,
+                             const QueryBudget& budget) {
+  std::vector<std::string> exceeded_limits;
+  CheckLimit("queries", stats.num_queries, budget.max_num_queries,
+             &exceeded_limits);
+  CheckLimit("rows", stats.num_rows, budget.max_num_rows, &exceeded_limits);
+  CheckLimit("bytes", stats.num_bytes, budget.max_num_bytes,
+             &exceeded_limits);
+  std::vector<std::pair<std::string, int64>> templates(
+      stats.num_queries_by_template.begin(),
+      stats.num_queries_by_template.end());
+  std::sort(templates.begin(), templates.end(),
+            [](const std::pair<std::string, int64>& a,
+               const std::pair<std::string, int64>& b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  for (const auto& name_and_count : templates) {
+    CheckLimit(absl::StrCat("queries of ", name_and_count.first),
+               name_and_count.second, budget.max_num_queries_per_template,
+               &exceeded_limits);
+  }
+  if (exceeded_limits.empty()) return "";
+  templates.resize(std::min<int>(templates.size(), kMaxNumListedTemplates));
+  return absl::StrCat(
+      absl::StrJoin(exceeded_limits, ", "), "; the most run templates: ",
+      absl::StrJoin(templates, ", ",
+                    [](std::string* out,
+                       const std::pair<std::string, int64>& name_and_count) {
+                      absl::StrAppend(out, name_and_count.first, " x",
+                                      name_and_count.second);
+                    }));
+}
+
+ScopedQueryAccounting::ScopedQueryAccounting(QueryStats* stats)
+    : stats_(stats), previous_scope_(current_scope) {
+  CHECK(stats_ != nullptr) << "The stats must not be null.";
+  current_scope = this;
+}
+
+ScopedQueryAccounting::~ScopedQueryAccounting() {
+  DCHECK(current_scope == this) << "The scopes must end in reverse order.";
+  current_scope = previous_scope_;
+}
+
+bool ScopedQueryAccounting::IsActive() { return current_scope != nullptr; }
+
+void ScopedQueryAccounting::RecordQuery(const absl::string_view template_name,
+                                        const int64 num_rows,
+                                        const int64 num_bytes) {
+  for (ScopedQueryAccounting* scope = current_scope; scope != nullptr;
+       scope = scope->previous_scope_) {
+    QueryStats* stats = scope->stats_;
+    stats->num_queries++;
+    stats->num_rows += num_rows;
+    stats->num_bytes += num_bytes;
+    stats->num_queries_by_template[template_name]++;
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,108 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_QUERY_ACCOUNTING_H_
+#define ML_METADATA_METADATA_STORE_QUERY_ACCOUNTING_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// The queries run on behalf of a request, e.g., of a call of the service.
+struct QueryStats {
+  int64 num_queries = 0;
+  int64 num_rows = 0;
+  int64 num_bytes = 0;
+  // The number of queries of each MetadataSourceQueryConfig template. The
+  // queries composed without a template are counted as "other".
+  absl::flat_hash_map<std::string, int64> num_queries_by_template;
+};
+
+// The limits of the queries of a request, above which the request is logged,
+// e.g., to catch the loops of small queries of a template, which grow with the
+// size of the request. A limit which is not positive is ignored.
+struct QueryBudget {
+  int64 max_num_queries = 0;
+  int64 max_num_rows = 0;
+  int64 max_num_bytes = 0;
+  int64 max_num_queries_per_template = 0;
+
+  // Returns true if any limit is set.
+  bool has_limits() const {
+    return max_num_queries > 0 || max_num_rows > 0 || max_num_bytes > 0 ||
+           max_num_queries_per_template > 0;
+  }
+};
+
+// Options of the accounting of the queries of each call of a service.
+struct QueryAccountingOptions {
+  // The budget of a call, above which the call is logged.
+  QueryBudget budget;
+  // If true, the number of queries, rows and bytes of a call are returned in
+  // its trailing metadata, e.g., for the tests of the clients to catch the
+  // regressions of the query fan-out.
+  bool return_in_trailing_metadata = false;
+
+  // Returns true if the queries of the calls need to be accounted.
+  bool enabled() const {
+    return budget.has_limits() || return_in_trailing_metadata;
+  }
+};
+
+// Returns a description of the limits of `budget` exceeded by `stats`, which
+// lists the templates run most often, or an empty string if `stats` is within
+// the budget.
+std::string CheckQueryBudget(const QueryStats& stats,
+                             const QueryBudget& budget);
+
+// Accounts the queries run by the QueryConfigExecutors of the thread in
+// `stats`, from its construction until its destruction, e.g., while the
+// thread handles a request. The scopes of a thread can be nested, and a query
+// is accounted in all of them. A scope must be destructed by the thread which
+// constructed it, in the reverse order of construction.
+//
+// The queries run by other threads on behalf of the request are not
+// accounted, e.g., the ones of calls merged by a PutCoalescer are accounted to
+// the call which runs the shared transaction.
+class ScopedQueryAccounting {
+ public:
+  // `stats` is not owned and must outlive the scope.
+  explicit ScopedQueryAccounting(QueryStats* stats);
+  ~ScopedQueryAccounting();
+
+  // Disallow copy and assign.
+  ScopedQueryAccounting(const ScopedQueryAccounting&) = delete;
+  ScopedQueryAccounting& operator=(const ScopedQueryAccounting&) = delete;
+
+  // Returns true if the thread accounts its queries, so that their bytes need
+  // to be counted.
+  static bool IsActive();
+
+  // Accounts a query in the scopes of the thread, if any.
+  static void RecordQuery(absl::string_view template_name, int64 num_rows,
+                          int64 num_bytes);
+
+ private:
+  QueryStats* const stats_;
+  // The innermost scope of the thread before this one was constructed.
+  ScopedQueryAccounting* const previous_scope_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_QUERY_ACCOUNTING_H_
@@ -0,0 +1,119 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/query_accounting.h"
+
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::Contains;
+using ::testing::Gt;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Key;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(QueryAccountingTest, AccountQueriesInNestedScopes) {
+  QueryStats outer_stats;
+  QueryStats inner_stats;
+  EXPECT_FALSE(ScopedQueryAccounting::IsActive());
+  ScopedQueryAccounting::RecordQuery("select_type_by_name", 1, 10);
+  {
+    ScopedQueryAccounting outer_scope(&outer_stats);
+    ScopedQueryAccounting::RecordQuery("select_type_by_name", 1, 10);
+    {
+      ScopedQueryAccounting inner_scope(&inner_stats);
+      EXPECT_TRUE(ScopedQueryAccounting::IsActive());
+      ScopedQueryAccounting::RecordQuery("insert_artifact_type", 0, 0);
+    }
+  }
+  EXPECT_FALSE(ScopedQueryAccounting::IsActive());
+
+  EXPECT_EQ(outer_stats.num_queries, 2);
+  EXPECT_EQ(outer_stats.num_rows, 1);
+  EXPECT_EQ(outer_stats.num_bytes, 10);
+  EXPECT_THAT(outer_stats.num_queries_by_template,
+              UnorderedElementsAre(Pair("select_type_by_name", 1),
+                                   Pair("insert_artifact_type", 1)));
+  EXPECT_EQ(inner_stats.num_queries, 1);
+  EXPECT_EQ(inner_stats.num_rows, 0);
+}
+
+TEST(QueryAccountingTest, CheckQueryBudget) {
+  QueryStats stats;
+  stats.num_queries = 12;
+  stats.num_rows = 3;
+  stats.num_bytes = 100;
+  stats.num_queries_by_template = {{"insert_artifact_property", 10},
+                                   {"insert_artifact", 2}};
+  EXPECT_THAT(CheckQueryBudget(stats, QueryBudget()), IsEmpty());
+
+  QueryBudget budget;
+  budget.max_num_queries = 12;
+  budget.max_num_rows = 3;
+  budget.max_num_bytes = 100;
+  EXPECT_THAT(CheckQueryBudget(stats, budget), IsEmpty());
+
+  budget.max_num_queries_per_template = 5;
+  EXPECT_EQ(CheckQueryBudget(stats, budget),
+            "queries of insert_artifact_property 10 > 5; the most run "
+            "templates: insert_artifact_property x10, insert_artifact x2");
+
+  budget.max_num_queries = 10;
+  EXPECT_THAT(CheckQueryBudget(stats, budget),
+              HasSubstr("queries 12 > 10, queries of"));
+}
+
+TEST(QueryAccountingTest, AccountQueriesOfMetadataStore) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(connection_config, &store));
+
+  QueryStats stats;
+  {
+    ScopedQueryAccounting scope(&stats);
+    const PutArtifactTypeRequest request =
+        ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+          all_fields_match: true
+          artifact_type: {
+            name: 'accounted_type'
+            properties { key: 'p1' value: STRING }
+          }
+        )");
+    PutArtifactTypeResponse response;
+    TF_ASSERT_OK(store->PutArtifactType(request, &response));
+  }
+  EXPECT_THAT(stats.num_queries, Gt(0));
+  EXPECT_THAT(stats.num_queries_by_template,
+              Contains(Key("insert_artifact_type")));
+  EXPECT_THAT(stats.num_queries_by_template,
+              Contains(Key("insert_type_property")));
+}
+
+}  // namespace
+}  // namespace ml_metadata
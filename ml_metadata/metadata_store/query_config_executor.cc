@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/query_config_executor.h"
 
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -21,22 +24,32 @@ limitations under the License.
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/json_util.h"
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/list_operation_query_helper.h"
 #include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/query_accounting.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metrics.h"
 #include "ml_metadata/util/return_utils.h"
 #include "ml_metadata/util/struct_utils.h"
+#include "ml_metadata/util/tracing.h"
 
 namespace ml_metadata {
 
@@ -53,6 +66,111 @@ absl::Status GetTemplateQueryOrDie(
   return absl::OkStatus();
 }
 
+// Returns the number of values a bound list of `size` values is padded to, so
+// that the lists of similar sizes share a prepared statement. The small lists
+// are padded to a power of two, and the lists above 256 values to a multiple
+// of 64, so that at most a fifth of their values are repeated. The lists of
+// more than kMaxNumPreparedStatementValues values are inlined, and are not
+// padded.
+size_t GetPaddedListSize(const size_t size) {
+  constexpr size_t kMaxPowerOfTwoListSize = 256;
+  constexpr size_t kListSizeStep = 64;
+  if (size > kMaxNumPreparedStatementValues) return size;
+  if (size > kMaxPowerOfTwoListSize) {
+    return std::min<size_t>(
+        (size + kListSizeStep - 1) / kListSizeStep * kListSizeStep,
+        kMaxNumPreparedStatementValues);
+  }
+  size_t padded_size = 1;
+  while (padded_size < size) padded_size <<= 1;
+  return padded_size;
+}
+
+// Returns the number of the next rows to write with one multi-row statement.
+// The statements have a power of two number of rows, so that the statements
+// of any number of rows share a few cached prepared statements.
+int GetMultiRowBatchSize(const int num_remaining_rows,
+                         const int max_batch_size) {
+  int batch_size = 1;
+  while (batch_size * 2 <= max_batch_size &&
+         batch_size * 2 <= num_remaining_rows) {
+    batch_size *= 2;
+  }
+  return batch_size;
+}
+
+// Returns the name quoted with backticks in `quoted`, e.g., `Artifact`.
+// Returns false, if `quoted` is not a quoted name.
+bool UnquoteName(absl::string_view quoted, std::string* name) {
+  quoted = absl::StripAsciiWhitespace(quoted);
+  if (quoted.size() < 3 || !absl::ConsumePrefix(&quoted, "`") ||
+      !absl::ConsumeSuffix(&quoted, "`") ||
+      quoted.find('`') != absl::string_view::npos) {
+    return false;
+  }
+  *name = std::string(quoted);
+  return true;
+}
+
+// Parses the table and the columns of an expanded `INSERT INTO `t`(`a`, ...)
+// VALUES` clause.
+// Returns false, if the clause is not of this form.
+bool ParseInsertClause(absl::string_view clause, std::string* table,
+                       std::vector<std::string>* columns) {
+  clause = absl::StripAsciiWhitespace(clause);
+  if (!absl::ConsumePrefix(&clause, "INSERT INTO") ||
+      !absl::ConsumeSuffix(&clause, "VALUES")) {
+    return false;
+  }
+  const size_t open_pos = clause.find('(');
+  const size_t close_pos = clause.rfind(')');
+  if (open_pos == absl::string_view::npos ||
+      close_pos == absl::string_view::npos || close_pos < open_pos ||
+      !absl::StripAsciiWhitespace(clause.substr(close_pos + 1)).empty() ||
+      !UnquoteName(clause.substr(0, open_pos), table)) {
+    return false;
+  }
+  columns->clear();
+  for (const absl::string_view column : absl::StrSplit(
+           clause.substr(open_pos + 1, close_pos - open_pos - 1), ',')) {
+    std::string name;
+    if (!UnquoteName(column, &name)) {
+      return false;
+    }
+    columns->push_back(std::move(name));
+  }
+  return true;
+}
+
+// Returns the redacted parameters of a template query.
+std::string DescribeParameters(const absl::Span<const std::string> parameters) {
+  return absl::StrCat("parameters: [",
+                      RedactStringLiterals(absl::StrJoin(parameters, ", ")),
+                      "]");
+}
+
+// Returns the redacted values of a prepared statement.
+std::string DescribeValues(
+    const absl::Span<const PreparedStatementValue> values) {
+  return absl::StrCat(
+      "parameters: [",
+      absl::StrJoin(values, ", ",
+                    [](std::string* out, const PreparedStatementValue& value) {
+                      absl::StrAppend(out, RedactPreparedStatementValue(value));
+                    }),
+      "]");
+}
+
+// Returns the properties and custom properties of `node` serialized as a node
+// which has no other field.
+template <typename Node>
+std::string SerializeNodeProperties(const Node& node) {
+  Node properties;
+  *properties.mutable_properties() = node.properties();
+  *properties.mutable_custom_properties() = node.custom_properties();
+  return properties.SerializeAsString();
+}
+
 }  // namespace
 
 QueryConfigExecutor::QueryConfigExecutor(
@@ -60,7 +178,154 @@ QueryConfigExecutor::QueryConfigExecutor(
     int64 query_version)
     : QueryExecutor(query_version),
       query_config_(query_config),
-      metadata_source_(source) {}
+      metadata_source_(source) {
+  InitQueryMetrics();
+}
+
+QueryConfigExecutor::QueryMetrics QueryConfigExecutor::GetQueryMetrics(
+    const absl::string_view template_name) {
+  MetricsRegistry* registry = MetricsRegistry::Global();
+  const MetricLabels labels = {{"template", std::string(template_name)}};
+  return {std::string(template_name),
+          registry->GetHistogram(
+              "mlmd_query_latency_seconds",
+              "The latency of the queries of a MetadataSourceQueryConfig "
+              "template.",
+              labels),
+          registry->GetCounter("mlmd_query_rows_total",
+                               "The number of rows returned by the queries "
+                               "of a MetadataSourceQueryConfig template.",
+                               labels)};
+}
+
+void QueryConfigExecutor::InitQueryMetrics() {
+  const google::protobuf::Descriptor* descriptor =
+      query_config_.GetDescriptor();
+  const google::protobuf::Reflection* reflection =
+      query_config_.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    // The unset fields share the default instance, and have no query.
+    if (field->is_repeated() ||
+        field->message_type() !=
+            MetadataSourceQueryConfig::TemplateQuery::descriptor() ||
+        !reflection->HasField(query_config_, field)) {
+      continue;
+    }
+    query_metrics_[static_cast<const MetadataSourceQueryConfig::TemplateQuery*>(
+        &reflection->GetMessage(query_config_, field))] =
+        GetQueryMetrics(field->name());
+  }
+  other_query_metrics_ = GetQueryMetrics("other");
+}
+
+// The span of a query is a child of the span of its transaction, and is
+// tagged with the template name, and with the rows and bytes it returned once
+// it succeeds.
+class QueryConfigExecutor::ScopedQueryRecorder {
+ public:
+  explicit ScopedQueryRecorder(const QueryMetrics& metrics)
+      : metrics_(metrics),
+        latency_recorder_(metrics.latency),
+        span_("Query"),
+        start_time_(absl::Now()) {
+    span_.SetAttribute("template", metrics.template_name);
+  }
+
+  // Records the result of a successful query, which has no rows if it is
+  // null.
+  void RecordResult(const RecordSet* record_set) {
+    if (record_set == nullptr) {
+      ScopedQueryAccounting::RecordQuery(metrics_.template_name,
+                                         /*num_rows=*/0, /*num_bytes=*/0);
+      RecordDuration(/*num_rows=*/0);
+      return;
+    }
+    const int64 num_rows = record_set->records_size();
+    RecordDuration(num_rows);
+    metrics_.rows->Increment(num_rows);
+    // The size of the result is only computed if it is used.
+    const bool record_bytes =
+        span_.is_recording() || ScopedQueryAccounting::IsActive();
+    const int64 num_bytes = record_bytes ? record_set->ByteSizeLong() : 0;
+    ScopedQueryAccounting::RecordQuery(metrics_.template_name, num_rows,
+                                       num_bytes);
+    if (span_.is_recording()) {
+      span_.SetAttribute("rows", num_rows);
+      span_.SetAttribute("bytes", num_bytes);
+    }
+  }
+
+  void RecordResult(const TypedRecordSet& record_set) {
+    RecordDuration(record_set.num_rows());
+    metrics_.rows->Increment(record_set.num_rows());
+    ScopedQueryAccounting::RecordQuery(metrics_.template_name,
+                                       record_set.num_rows(),
+                                       record_set.num_bytes());
+    span_.SetAttribute("rows", record_set.num_rows());
+    span_.SetAttribute("bytes", record_set.num_bytes());
+  }
+
+  // Returns true if the recorded query is logged by the slow query log.
+  bool IsSlow() const { return is_slow_; }
+
+  const std::string& template_name() const { return metrics_.template_name; }
+  absl::Duration duration() const { return duration_; }
+  int64 num_rows() const { return num_rows_; }
+
+ private:
+  // Keeps the duration of the query if the slow query log is enabled.
+  void RecordDuration(const int64 num_rows) {
+    const SlowQueryLog* slow_query_log = SlowQueryLog::Get();
+    if (slow_query_log == nullptr) return;
+    duration_ = absl::Now() - start_time_;
+    num_rows_ = num_rows;
+    is_slow_ = slow_query_log->IsSlow(duration_);
+  }
+
+  const QueryMetrics& metrics_;
+  const ScopedLatencyRecorder latency_recorder_;
+  ScopedSpan span_;
+  const absl::Time start_time_;
+  bool is_slow_ = false;
+  absl::Duration duration_;
+  int64 num_rows_ = 0;
+};
+
+const QueryConfigExecutor::QueryMetrics& QueryConfigExecutor::FindQueryMetrics(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query) const {
+  const auto it = query_metrics_.find(&template_query);
+  return it == query_metrics_.end() ? other_query_metrics_ : it->second;
+}
+
+void QueryConfigExecutor::LogSlowQuery(
+    const ScopedQueryRecorder& recorder, const std::string& query,
+    const absl::Span<const PreparedStatementValue> values,
+    const absl::string_view description) {
+  SlowQueryLog* slow_query_log = SlowQueryLog::Get();
+  if (slow_query_log == nullptr) return;
+  RecordSet plan;
+  bool explained = false;
+  std::string explain_query;
+  if (GetExplainQuery(query_config_.metadata_source_type(), query,
+                      &explain_query) &&
+      slow_query_log->ShouldExplain(recorder.template_name())) {
+    const absl::Status status =
+        values.empty()
+            ? metadata_source_->ExecuteQuery(explain_query, &plan)
+            : metadata_source_->ExecutePreparedQuery(explain_query, values,
+                                                     &plan);
+    if (status.ok()) {
+      explained = true;
+    } else {
+      LOG(WARNING) << "Failed to explain the slow query "
+                   << recorder.template_name() << ": " << status;
+    }
+  }
+  slow_query_log->Log(recorder.template_name(), description,
+                      recorder.duration(), recorder.num_rows(),
+                      explained ? &plan : nullptr);
+}
 
 absl::Status QueryConfigExecutor::CheckParentTypeTable() {
   return ExecuteQuery(query_config_.check_parent_type_table());
@@ -97,6 +362,94 @@ absl::Status QueryConfigExecutor::InsertEventPath(
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::InsertEvents(
+    const absl::Span<const Event> events,
+    const int64 default_event_time_milliseconds,
+    std::vector<int64>* event_ids) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(events.size());
+  for (const Event& event : events) {
+    rows.push_back({BindPrepared(event.artifact_id()),
+                    BindPrepared(event.execution_id()),
+                    BindPrepared(int64{event.type()}),
+                    BindPrepared(event.has_milliseconds_since_epoch()
+                                     ? event.milliseconds_since_epoch()
+                                     : default_event_time_milliseconds)});
+    if (inline_event_paths_) {
+      rows.back().push_back(
+          {absl::nullopt,
+           {PreparedStatementBytes{event.path().SerializeAsString()}}});
+    }
+  }
+  return ExecutePreparedMultiRowInsert(
+      inline_event_paths_ ? query_config_.insert_event_with_path()
+                          : query_config_.insert_event(),
+      rows, event_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertAssociationsIfNotExist(
+    const absl::Span<const Association> associations) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(associations.size());
+  for (const Association& association : associations) {
+    rows.push_back({BindPrepared(association.context_id()),
+                    BindPrepared(association.execution_id())});
+  }
+  return ExecutePreparedMultiRowInsert(
+      query_config_.insert_or_ignore_association(), rows,
+      /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertAttributionsIfNotExist(
+    const absl::Span<const Attribution> attributions) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(attributions.size());
+  for (const Attribution& attribution : attributions) {
+    rows.push_back({BindPrepared(attribution.context_id()),
+                    BindPrepared(attribution.artifact_id())});
+  }
+  return ExecutePreparedMultiRowInsert(
+      query_config_.insert_or_ignore_attribution(), rows,
+      /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertEventPaths(
+    const absl::Span<const int64> event_ids,
+    const absl::Span<const Event> events) {
+  if (event_ids.size() != events.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The number of event ids ", event_ids.size(),
+                     " does not match the number of events ", events.size()));
+  }
+  // The paths have been stored with the events by InsertEvents.
+  if (inline_event_paths_) {
+    return absl::OkStatus();
+  }
+  // The step value column is part of the statement, so the index steps and the
+  // key steps are inserted with separate statements.
+  std::vector<std::vector<PreparedParameter>> index_step_rows;
+  std::vector<std::vector<PreparedParameter>> key_step_rows;
+  for (int i = 0; i < events.size(); i++) {
+    for (const Event::Path::Step& step : events[i].path().steps()) {
+      if (step.has_index()) {
+        index_step_rows.push_back(
+            {BindPrepared(event_ids[i]), {"step_index", {}}, BindPrepared(true),
+             BindPrepared(step.index())});
+      } else if (step.has_key()) {
+        key_step_rows.push_back({BindPrepared(event_ids[i]),
+                                 {"step_key", {}}, BindPrepared(false),
+                                 BindPrepared(step.key())});
+      }
+    }
+  }
+  MLMD_RETURN_IF_ERROR(ExecutePreparedMultiRowInsert(
+      query_config_.insert_event_path(), index_step_rows,
+      /*inserted_ids=*/nullptr));
+  return ExecutePreparedMultiRowInsert(query_config_.insert_event_path(),
+                                       key_step_rows,
+                                       /*inserted_ids=*/nullptr);
+}
+
 absl::Status QueryConfigExecutor::CheckParentContextTable() {
   return ExecuteQuery(query_config_.check_parent_context_table());
 }
@@ -107,6 +460,18 @@ absl::Status QueryConfigExecutor::InsertParentContext(int64 parent_id,
                       {Bind(child_id), Bind(parent_id)});
 }
 
+absl::Status QueryConfigExecutor::InsertParentContexts(
+    const absl::Span<const ParentContext> parent_contexts) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(parent_contexts.size());
+  for (const ParentContext& parent_context : parent_contexts) {
+    rows.push_back({BindPrepared(parent_context.child_id()),
+                    BindPrepared(parent_context.parent_id())});
+  }
+  return ExecutePreparedMultiRowInsert(query_config_.insert_parent_context(),
+                                       rows, /*inserted_ids=*/nullptr);
+}
+
 absl::Status QueryConfigExecutor::SelectParentContextsByContextID(
     int64 context_id, RecordSet* record_set) {
   return ExecuteQuery(query_config_.select_parent_context_by_context_id(),
@@ -187,24 +552,13 @@ absl::Status QueryConfigExecutor::UpgradeMetadataSourceIfOutOfDate(
         " https://github.com/google/ml-metadata/blob/master/g3doc/get_started.md#upgrade-the-database-schema"));
   }
 
-  // migrate db_version to lib version
-  const auto& migration_schemes = query_config_.migration_schemes();
-  while (db_version < lib_version) {
-    const int64 to_version = db_version + 1;
-    if (migration_schemes.find(to_version) == migration_schemes.end()) {
-      return absl::InternalError(absl::StrCat(
-          "Cannot find migration_schemes to version ", to_version));
-    }
-    for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
-         migration_schemes.at(to_version).upgrade_queries()) {
-      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
-          ExecuteQuery(upgrade_query.query()),
-          absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
-    }
-    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(UpdateSchemaVersion(to_version),
-                                      "Failed to update schema.");
-    db_version = to_version;
-  }
+  // migrate db_version to lib version, with all the chunks of the chunked
+  // queries in this transaction.
+  SchemaMigrationProgress progress;
+  do {
+    MLMD_RETURN_IF_ERROR(MigrateSchemaStep(
+        lib_version, std::numeric_limits<int64>::max(), &progress));
+  } while (!progress.done());
   return absl::OkStatus();
 }
 
@@ -225,6 +579,28 @@ absl::Status QueryConfigExecutor::SelectLastInsertID(int64* last_insert_id) {
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::ExecuteConditionalUpdate(
+    const MetadataSourceQueryConfig::TemplateQuery& query,
+    const absl::Span<const std::string> arguments, bool* updated) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query, arguments, &record_set));
+  if (record_set.records_size() == 0) {
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_num_changed_rows(),
+                                      {}, &record_set));
+  }
+  if (record_set.records_size() == 0 ||
+      record_set.records(0).values_size() == 0) {
+    return absl::InternalError("Could not find the number of changed rows");
+  }
+  int64 num_changed_rows;
+  if (!absl::SimpleAtoi(record_set.records(0).values(0), &num_changed_rows)) {
+    return absl::InternalError(
+        "Could not parse the number of changed rows as string");
+  }
+  *updated = num_changed_rows > 0;
+  return absl::OkStatus();
+}
+
 absl::Status ml_metadata::QueryConfigExecutor::CheckTablesIn_V0_13_2() {
   return ExecuteQuery(query_config_.check_tables_in_v0_13_2());
 }
@@ -254,28 +630,176 @@ absl::Status QueryConfigExecutor::DowngradeMetadataSource(
                      ". The current library does not know how to downgrade it. "
                      "Please upgrade the library to downgrade the schema."));
   }
-  // perform downgrade
+  if (db_version <= to_schema_version) return absl::OkStatus();
+  // perform downgrade, with all the chunks of the chunked queries in this
+  // transaction.
+  SchemaMigrationProgress progress;
+  do {
+    MLMD_RETURN_IF_ERROR(MigrateSchemaStep(
+        to_schema_version, std::numeric_limits<int64>::max(), &progress));
+  } while (!progress.done());
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::MigrateSchemaStep(
+    const int64 to_schema_version, const int64 max_num_chunks,
+    SchemaMigrationProgress* progress) {
+  progress->Clear();
+  const int64 lib_version = query_config_.schema_version();
+  if (to_schema_version < 0 || to_schema_version > lib_version) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "MLMD cannot be migrated to schema_version: ", to_schema_version,
+        ". The target version should be greater or equal to 0, and not newer "
+        "than the current library version: ",
+        lib_version));
+  }
+  int64 db_version = 0;
+  MLMD_RETURN_IF_ERROR(GetSchemaVersion(&db_version));
+  if (db_version > lib_version) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("MLMD database version ", db_version,
+                     " is greater than library version ", lib_version,
+                     ". The current library does not know how to migrate it. "
+                     "Please upgrade the library to migrate the schema."));
+  }
+  progress->set_schema_version(db_version);
+  if (db_version == to_schema_version) {
+    progress->set_to_schema_version(db_version);
+    progress->set_done(true);
+    return absl::OkStatus();
+  }
+
+  // The checkpoint of a migration scheme with chunked queries, if one was
+  // started.
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_migration_checkpoint_table()));
+  RecordSet checkpoint;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_migration_checkpoint(),
+                                    {}, &checkpoint));
+  const bool has_checkpoint = checkpoint.records_size() > 0;
+  int64 to_version = 0;
+  int64 chunked_query_index = 0;
+  int64 next_id = 0;
+  if (has_checkpoint) {
+    CHECK(absl::SimpleAtoi(checkpoint.records(0).values(0), &to_version));
+    CHECK(absl::SimpleAtoi(checkpoint.records(0).values(1),
+                           &chunked_query_index));
+    CHECK(absl::SimpleAtoi(checkpoint.records(0).values(2), &next_id));
+  } else {
+    to_version = db_version < to_schema_version ? db_version + 1
+                                                : db_version - 1;
+  }
+  const bool is_upgrade = to_version > db_version;
   const auto& migration_schemes = query_config_.migration_schemes();
-  while (db_version > to_schema_version) {
-    const int64 to_version = db_version - 1;
-    if (migration_schemes.find(to_version) == migration_schemes.end()) {
+  if (migration_schemes.find(to_version) == migration_schemes.end()) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot find migration_schemes to version ", to_version));
+  }
+  const MetadataSourceQueryConfig::MigrationScheme& migration_scheme =
+      migration_schemes.at(to_version);
+  const auto& chunked_queries =
+      is_upgrade ? migration_scheme.chunked_upgrade_queries()
+                 : migration_scheme.chunked_downgrade_queries();
+  progress->set_to_schema_version(to_version);
+  progress->set_num_chunked_queries(chunked_queries.size());
+
+  if (!has_checkpoint) {
+    if (is_upgrade) {
+      for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
+           migration_scheme.upgrade_queries()) {
+        MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+            ExecuteQuery(upgrade_query.query()),
+            absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
+      }
+    }
+    if (chunked_queries.empty()) {
+      MLMD_RETURN_IF_ERROR(FinishMigrationScheme(
+          db_version, to_version, migration_scheme,
+          /*has_chunked_queries=*/false));
+      progress->set_schema_version(to_version);
+      progress->set_done(to_version == to_schema_version);
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(query_config_.insert_migration_checkpoint(),
+                        {Bind(to_version), Bind(chunked_query_index),
+                         Bind(next_id)});
+  }
+
+  // Runs the chunks from the checkpoint, each over the ids in
+  // [next_id, next_id + chunk_size).
+  int64 num_chunks = 0;
+  while (chunked_query_index < chunked_queries.size() &&
+         num_chunks < max_num_chunks) {
+    const MetadataSourceQueryConfig::MigrationScheme::ChunkedQuery&
+        chunked_query = chunked_queries[chunked_query_index];
+    if (chunked_query.chunk_size() <= 0) {
       return absl::InternalError(absl::StrCat(
-          "Cannot find migration_schemes to version ", to_version));
+          "The chunked query ", chunked_query_index, " to version ",
+          to_version, " has no positive chunk_size"));
     }
+    RecordSet max_id_record_set;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(chunked_query.select_max_id(), {},
+                                      &max_id_record_set));
+    int64 max_id = 0;
+    if (max_id_record_set.records_size() > 0 &&
+        max_id_record_set.records(0).values(0) != kMetadataSourceNull) {
+      CHECK(absl::SimpleAtoi(max_id_record_set.records(0).values(0),
+                             &max_id));
+    }
+    progress->set_max_id(max_id);
+    while (next_id <= max_id && num_chunks < max_num_chunks) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          ExecuteQuery(chunked_query.query(),
+                       {Bind(next_id),
+                        Bind(next_id + chunked_query.chunk_size())}),
+          absl::StrCat("Chunked migration query failed: ",
+                       chunked_query.query().query()));
+      next_id += chunked_query.chunk_size();
+      ++num_chunks;
+    }
+    if (next_id <= max_id) break;
+    ++chunked_query_index;
+    next_id = 0;
+  }
+  progress->set_chunked_query_index(chunked_query_index);
+  progress->set_next_id(next_id);
+  if (chunked_query_index < chunked_queries.size()) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_migration_checkpoint()));
+    return ExecuteQuery(query_config_.insert_migration_checkpoint(),
+                        {Bind(to_version), Bind(chunked_query_index),
+                         Bind(next_id)});
+  }
+  MLMD_RETURN_IF_ERROR(FinishMigrationScheme(db_version, to_version,
+                                             migration_scheme,
+                                             /*has_chunked_queries=*/true));
+  progress->set_schema_version(to_version);
+  progress->set_done(to_version == to_schema_version);
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::FinishMigrationScheme(
+    const int64 db_version, const int64 to_version,
+    const MetadataSourceQueryConfig::MigrationScheme& migration_scheme,
+    const bool has_chunked_queries) {
+  if (to_version < db_version) {
     for (const MetadataSourceQueryConfig::TemplateQuery& downgrade_query :
-         migration_schemes.at(to_version).downgrade_queries()) {
+         migration_scheme.downgrade_queries()) {
       MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ExecuteQuery(downgrade_query),
                                         "Failed to migrate existing db; the "
                                         "migration transaction rolls back.");
     }
-    // at version 0, v0.13.2, there is no schema version information.
-    if (to_version > 0) {
-      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
-          UpdateSchemaVersion(to_version),
-          "Failed to migrate existing db; the migration transaction rolls "
-          "back.");
-    }
-    db_version = to_version;
+  }
+  if (has_chunked_queries) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_migration_checkpoint()));
+  }
+  // at version 0, v0.13.2, there is no schema version information.
+  if (to_version > 0) {
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        UpdateSchemaVersion(to_version),
+        "Failed to migrate existing db; the migration transaction rolls "
+        "back.");
   }
   return absl::OkStatus();
 }
@@ -337,7 +861,8 @@ std::string QueryConfigExecutor::BindValue(const Value& value) {
     case PropertyType::STRING:
       return Bind(value.string_value());
     case PropertyType::STRUCT:
-      return Bind(StructToString(value.struct_value()));
+      return metadata_source_->BytesLiteral(
+          StructToBytes(value.struct_value()));
     default:
       LOG(FATAL) << "Unknown registered property type: " << value.value_case()
                  << "This is an internal error: properties should have been "
@@ -356,11 +881,14 @@ std::string QueryConfigExecutor::BindDataType(const Value& value) {
       return "double_value";
       break;
     }
-    case PropertyType::STRING:
-    case PropertyType::STRUCT: {
+    case PropertyType::STRING: {
       return "string_value";
       break;
     }
+    case PropertyType::STRUCT: {
+      return "byte_value";
+      break;
+    }
     default: {
       LOG(FATAL) << "Unexpected oneof: " << value.DebugString();
     }
@@ -385,19 +913,143 @@ string QueryConfigExecutor::Bind(
 }
 #endif
 
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    absl::string_view value) {
+  return {absl::nullopt, {std::string(value)}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    int64 value) {
+  return {absl::nullopt, {value}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    bool value) {
+  return {absl::nullopt, {int64{value ? 1 : 0}}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    double value) {
+  return {absl::nullopt, {value}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    Artifact::State value) {
+  return {absl::nullopt, {int64{value}}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    Execution::State value) {
+  return {absl::nullopt, {int64{value}}};
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    const absl::Span<const int64> value) {
+  PreparedParameter parameter;
+  if (value.empty()) {
+    // IN (NULL) matches no rows, while an empty IN () is invalid in MySQL.
+    parameter.values.push_back(absl::monostate());
+    return parameter;
+  }
+  parameter.is_id_list = true;
+  const size_t padded_size = GetPaddedListSize(value.size());
+  parameter.values.reserve(padded_size);
+  for (const int64 id : value) parameter.values.push_back(id);
+  while (parameter.values.size() < padded_size) {
+    parameter.values.push_back(value.back());
+  }
+  return parameter;
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    const absl::Span<const std::string> value) {
+  PreparedParameter parameter;
+  if (value.empty()) {
+    parameter.values.push_back(absl::monostate());
+    return parameter;
+  }
+  const size_t padded_size = GetPaddedListSize(value.size());
+  parameter.values.reserve(padded_size);
+  for (const std::string& name : value) parameter.values.push_back(name);
+  while (parameter.values.size() < padded_size) {
+    parameter.values.push_back(value.back());
+  }
+  return parameter;
+}
+
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPreparedValue(
+    const Value& value) {
+  switch (value.value_case()) {
+    case PropertyType::INT:
+      return BindPrepared(value.int_value());
+    case PropertyType::DOUBLE:
+      return BindPrepared(value.double_value());
+    case PropertyType::STRING:
+      return BindPrepared(value.string_value());
+    case PropertyType::STRUCT:
+      return {absl::nullopt,
+              {PreparedStatementBytes{StructToBytes(value.struct_value())}}};
+    default:
+      LOG(FATAL) << "Unknown registered property type: " << value.value_case()
+                 << "This is an internal error: properties should have been "
+                    "checked before"
+                    " they got here";
+  }
+}
+
+QueryConfigExecutor::PreparedParameter
+QueryConfigExecutor::BindPreparedDataType(const Value& value) {
+  return {BindDataType(value), {}};
+}
+
+QueryConfigExecutor::PreparedParameter
+QueryConfigExecutor::BindPreparedByteValueColumn() {
+  return {"`byte_value`", {}};
+}
+
+#if (!defined(__APPLE__) && !defined(_WIN32))
+QueryConfigExecutor::PreparedParameter QueryConfigExecutor::BindPrepared(
+    const google::protobuf::int64 value) {
+  return {absl::nullopt, {int64{value}}};
+}
+#endif
+
 absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query) {
   RecordSet record_set;
-  return metadata_source_->ExecuteQuery(query, &record_set);
+  return ExecuteQuery(query, &record_set);
 }
 
 absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query,
                                                RecordSet* record_set) {
-  return metadata_source_->ExecuteQuery(query, record_set);
+  ScopedQueryRecorder query_recorder(other_query_metrics_);
+  MLMD_RETURN_IF_ERROR(metadata_source_->ExecuteQuery(query, record_set));
+  query_recorder.RecordResult(record_set);
+  if (query_recorder.IsSlow()) {
+    LogSlowQuery(query_recorder, query, /*values=*/{},
+                 absl::StrCat("query: ", RedactStringLiterals(query)));
+  }
+  return absl::OkStatus();
 }
 
 absl::Status QueryConfigExecutor::ExecuteQuery(
     const MetadataSourceQueryConfig::TemplateQuery& template_query,
     const absl::Span<const std::string> parameters, RecordSet* record_set) {
+  std::string query;
+  MLMD_RETURN_IF_ERROR(
+      ComposeParameterizedQuery(template_query, parameters, &query));
+  ScopedQueryRecorder query_recorder(FindQueryMetrics(template_query));
+  MLMD_RETURN_IF_ERROR(metadata_source_->ExecuteQuery(query, record_set));
+  query_recorder.RecordResult(record_set);
+  if (query_recorder.IsSlow()) {
+    LogSlowQuery(query_recorder, query, /*values=*/{},
+                 DescribeParameters(parameters));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ComposeParameterizedQuery(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const std::string> parameters, std::string* query) {
   if (parameters.size() > 10) {
     return absl::InvalidArgumentError(
         "Template query has too many parameters (at most 10 is supported).");
@@ -412,8 +1064,794 @@ absl::Status QueryConfigExecutor::ExecuteQuery(
   for (int i = 0; i < parameters.size(); i++) {
     replacements.push_back({absl::StrCat("$", i), parameters[i]});
   }
-  return metadata_source_->ExecuteQuery(
-      absl::StrReplaceAll(template_query.query(), replacements), record_set);
+  *query = absl::StrReplaceAll(template_query.query(), replacements);
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::BuildPreparedStatement(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const PreparedParameter> parameters,
+    std::string* statement, std::vector<PreparedStatementValue>* values) {
+  if (parameters.size() > 10) {
+    return absl::InvalidArgumentError(
+        "Template query has too many parameters (at most 10 is supported).");
+  }
+  if (template_query.parameter_num() != parameters.size()) {
+    LOG(FATAL) << "Template query parameter_num does not match with given "
+               << "parameters size (" << parameters.size()
+               << "): " << template_query.DebugString();
+  }
+  const std::string& query = template_query.query();
+  statement->clear();
+  statement->reserve(query.size());
+  values->clear();
+  for (int i = 0; i < query.size(); i++) {
+    if (query[i] != '$' || i + 1 == query.size() ||
+        !absl::ascii_isdigit(query[i + 1])) {
+      statement->push_back(query[i]);
+      continue;
+    }
+    const PreparedParameter& parameter = parameters[query[++i] - '0'];
+    if (parameter.sql_fragment) {
+      absl::StrAppend(statement, *parameter.sql_fragment);
+      continue;
+    }
+    for (int j = 0; j < parameter.values.size(); j++) {
+      absl::StrAppend(statement, j == 0 ? "?" : ", ?");
+      values->push_back(parameter.values[j]);
+    }
+  }
+  // The prepared statement APIs expect a single statement without the
+  // terminating semicolon.
+  absl::string_view trimmed_statement =
+      absl::StripTrailingAsciiWhitespace(*statement);
+  absl::ConsumeSuffix(&trimmed_statement, ";");
+  statement->resize(trimmed_statement.size());
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::LoadIdListTable(
+    absl::Span<const PreparedParameter>& parameters,
+    std::vector<PreparedParameter>& loaded_parameters) {
+  if (!HasIdListTable()) {
+    return absl::OkStatus();
+  }
+  const auto id_list = absl::c_find_if(
+      parameters, [](const PreparedParameter& parameter) {
+        return parameter.is_id_list &&
+               parameter.values.size() >= kMinIdsForIdListTable;
+      });
+  if (id_list == parameters.end()) {
+    return absl::OkStatus();
+  }
+  std::vector<int64> ids;
+  ids.reserve(id_list->values.size());
+  for (const PreparedStatementValue& value : id_list->values) {
+    ids.push_back(absl::get<int64>(value));
+  }
+  // The ids are the primary key of the table.
+  absl::c_sort(ids);
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  if (id_list_transaction_ != metadata_source_->num_transactions() ||
+      id_list_savepoint_rollbacks_ !=
+          metadata_source_->num_savepoint_rollbacks() ||
+      id_list_ != ids) {
+    id_list_transaction_ = -1;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_id_list_table()));
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.clear_id_list_table()));
+    std::vector<std::vector<PreparedParameter>> rows;
+    rows.reserve(ids.size());
+    for (const int64 id : ids) {
+      rows.push_back({BindPrepared(id)});
+    }
+    MLMD_RETURN_IF_ERROR(ExecutePreparedMultiRowInsert(
+        query_config_.insert_id_list(), rows, /*inserted_ids=*/nullptr));
+    id_list_ = std::move(ids);
+    id_list_transaction_ = metadata_source_->num_transactions();
+    id_list_savepoint_rollbacks_ = metadata_source_->num_savepoint_rollbacks();
+  }
+  loaded_parameters.assign(parameters.begin(), parameters.end());
+  PreparedParameter& loaded_id_list =
+      loaded_parameters[id_list - parameters.begin()];
+  loaded_id_list.sql_fragment = query_config_.select_id_list().query();
+  loaded_id_list.values.clear();
+  loaded_id_list.is_id_list = false;
+  parameters = loaded_parameters;
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ExecutePreparedQuery(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const PreparedParameter> parameters,
+    RecordSet* record_set) {
+  std::vector<PreparedParameter> loaded_parameters;
+  absl::Span<const PreparedParameter> bound_parameters = parameters;
+  MLMD_RETURN_IF_ERROR(LoadIdListTable(bound_parameters, loaded_parameters));
+  std::string statement;
+  std::vector<PreparedStatementValue> values;
+  MLMD_RETURN_IF_ERROR(BuildPreparedStatement(template_query, bound_parameters,
+                                              &statement, &values));
+  if (values.size() > kMaxNumPreparedStatementValues) {
+    return ExecuteQuery(template_query,
+                        InlinePreparedParameters(bound_parameters), record_set);
+  }
+  ScopedQueryRecorder query_recorder(FindQueryMetrics(template_query));
+  MLMD_RETURN_IF_ERROR(
+      metadata_source_->ExecutePreparedQuery(statement, values, record_set));
+  query_recorder.RecordResult(record_set);
+  if (query_recorder.IsSlow()) {
+    LogSlowQuery(query_recorder, statement, values, DescribeValues(values));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ExecutePreparedQuery(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const PreparedParameter> parameters,
+    TypedRecordSet* record_set) {
+  std::vector<PreparedParameter> loaded_parameters;
+  absl::Span<const PreparedParameter> bound_parameters = parameters;
+  MLMD_RETURN_IF_ERROR(LoadIdListTable(bound_parameters, loaded_parameters));
+  std::string statement;
+  std::vector<PreparedStatementValue> values;
+  MLMD_RETURN_IF_ERROR(BuildPreparedStatement(template_query, bound_parameters,
+                                              &statement, &values));
+  ScopedQueryRecorder query_recorder(FindQueryMetrics(template_query));
+  // The query with the inlined values, if there are too many to bind them.
+  std::string query;
+  if (values.size() > kMaxNumPreparedStatementValues) {
+    // The inlined query is streamed, as the metadata sources return the typed
+    // and binary cells of a streamed query unchanged.
+    MLMD_RETURN_IF_ERROR(ComposeParameterizedQuery(
+        template_query, InlinePreparedParameters(bound_parameters), &query));
+    *record_set = TypedRecordSet();
+    MLMD_RETURN_IF_ERROR(metadata_source_->ExecuteStreamingQuery(
+        query, kMaxNumPreparedStatementValues,
+        [record_set](const TypedRecordSet& batch) {
+          if (record_set->num_columns() == 0) {
+            record_set->Reset(batch.column_names());
+          }
+          record_set->AppendRows(batch);
+          return absl::OkStatus();
+        }));
+  } else {
+    MLMD_RETURN_IF_ERROR(
+        metadata_source_->ExecutePreparedQuery(statement, values, record_set));
+  }
+  query_recorder.RecordResult(*record_set);
+  if (query_recorder.IsSlow()) {
+    if (query.empty()) {
+      LogSlowQuery(query_recorder, statement, values, DescribeValues(values));
+    } else {
+      LogSlowQuery(query_recorder, query, /*values=*/{},
+                   DescribeValues(values));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ExecutePipelinedQueries(
+    const absl::Span<const PipelinedTemplateQuery> queries,
+    const absl::Span<TypedRecordSet* const> record_sets) {
+  CHECK_EQ(queries.size(), record_sets.size());
+  std::vector<std::vector<PreparedParameter>> loaded_parameters(
+      queries.size());
+  std::vector<PipelinedQuery> pipelined_queries(queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    absl::Span<const PreparedParameter> bound_parameters =
+        queries[i].parameters;
+    MLMD_RETURN_IF_ERROR(
+        LoadIdListTable(bound_parameters, loaded_parameters[i]));
+    MLMD_RETURN_IF_ERROR(BuildPreparedStatement(
+        queries[i].template_query, bound_parameters,
+        &pipelined_queries[i].query, &pipelined_queries[i].values));
+    if (pipelined_queries[i].values.size() > kMaxNumPreparedStatementValues) {
+      for (int j = 0; j < queries.size(); ++j) {
+        MLMD_RETURN_IF_ERROR(ExecutePreparedQuery(
+            queries[j].template_query, queries[j].parameters, record_sets[j]));
+      }
+      return absl::OkStatus();
+    }
+  }
+  std::vector<std::unique_ptr<ScopedQueryRecorder>> query_recorders;
+  query_recorders.reserve(queries.size());
+  for (const PipelinedTemplateQuery& query : queries) {
+    query_recorders.push_back(absl::make_unique<ScopedQueryRecorder>(
+        FindQueryMetrics(query.template_query)));
+  }
+  std::vector<TypedRecordSet> results;
+  MLMD_RETURN_IF_ERROR(
+      metadata_source_->ExecutePipelinedQueries(pipelined_queries, &results));
+  for (int i = 0; i < queries.size(); ++i) {
+    *record_sets[i] = std::move(results[i]);
+    query_recorders[i]->RecordResult(*record_sets[i]);
+    if (query_recorders[i]->IsSlow()) {
+      LogSlowQuery(*query_recorders[i], pipelined_queries[i].query,
+                   pipelined_queries[i].values,
+                   DescribeValues(pipelined_queries[i].values));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectNodesWithPropertiesByID(
+    const MetadataSourceQueryConfig::TemplateQuery& select_nodes,
+    const MetadataSourceQueryConfig::TemplateQuery&
+        select_nodes_with_properties_bytes,
+    const MetadataSourceQueryConfig::TemplateQuery& select_properties,
+    const MetadataSourceQueryConfig::TemplateQuery& select_properties_by_name,
+    const absl::Span<const int64> ids,
+    const absl::Span<const std::string> property_names,
+    TypedRecordSet* record_set, TypedRecordSet* property_record_set) {
+  if (inline_node_properties_ && property_names.empty()) {
+    MLMD_RETURN_IF_ERROR(ExecutePreparedQuery(
+        select_nodes_with_properties_bytes, {BindPrepared(ids)}, record_set));
+    // The nodes written by an older store, which did not maintain the column,
+    // have no inline properties, and are read from the property tables.
+    const std::vector<std::string>& column_names = record_set->column_names();
+    const int id_column =
+        absl::c_find(column_names, "id") - column_names.begin();
+    const int properties_bytes_column =
+        absl::c_find(column_names, "properties_bytes") - column_names.begin();
+    std::vector<int64> ids_without_properties_bytes;
+    for (int row = 0; row < record_set->num_rows(); row++) {
+      int64 id;
+      if (record_set->IsNull(row, properties_bytes_column) &&
+          record_set->GetInt64(row, id_column, &id)) {
+        ids_without_properties_bytes.push_back(id);
+      }
+    }
+    if (ids_without_properties_bytes.empty()) {
+      property_record_set->Reset({});
+      return absl::OkStatus();
+    }
+    return ExecutePreparedQuery(
+        select_properties,
+        {BindPrepared(absl::MakeConstSpan(ids_without_properties_bytes)),
+         BindPreparedByteValueColumn()},
+        property_record_set);
+  }
+  if (property_names.empty()) {
+    return ExecutePipelinedQueries(
+        {{select_nodes, {BindPrepared(ids)}},
+         {select_properties,
+          {BindPrepared(ids), BindPreparedByteValueColumn()}}},
+        {record_set, property_record_set});
+  }
+  return ExecutePipelinedQueries(
+      {{select_nodes, {BindPrepared(ids)}},
+       {select_properties_by_name,
+        {BindPrepared(ids), BindPreparedByteValueColumn(),
+         BindPrepared(property_names)}}},
+      {record_set, property_record_set});
+}
+
+std::vector<QueryConfigExecutor::PreparedParameter>
+QueryConfigExecutor::BindEventQuery(
+    const absl::Span<const int64> ids,
+    const absl::Span<const Event::Type> event_types) {
+  std::vector<PreparedParameter> parameters = {BindPrepared(ids)};
+  if (!event_types.empty()) {
+    const std::vector<int64> types(event_types.begin(), event_types.end());
+    parameters.push_back(BindPrepared(absl::MakeConstSpan(types)));
+  }
+  return parameters;
+}
+
+absl::Status QueryConfigExecutor::SelectEventsWithPaths(
+    const MetadataSourceQueryConfig::TemplateQuery& select_events,
+    const MetadataSourceQueryConfig::TemplateQuery& select_paths,
+    const absl::Span<const int64> ids,
+    const absl::Span<const Event::Type> event_types,
+    RecordSet* event_record_set, RecordSet* path_record_set) {
+  TypedRecordSet typed_event_record_set;
+  TypedRecordSet typed_path_record_set;
+  MLMD_RETURN_IF_ERROR(ExecutePipelinedQueries(
+      {{select_events, BindEventQuery(ids, event_types)},
+       {select_paths, BindEventQuery(ids, event_types)}},
+      {&typed_event_record_set, &typed_path_record_set}));
+  typed_event_record_set.ToRecordSet(event_record_set);
+  typed_path_record_set.ToRecordSet(path_record_set);
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectEventsWithInlinePaths(
+    const MetadataSourceQueryConfig::TemplateQuery& select_events,
+    const absl::Span<const int64> ids,
+    const absl::Span<const Event::Type> event_types,
+    RecordSet* event_record_set, RecordSet* path_record_set) {
+  // The serialized paths are binary cells, which are only returned unchanged
+  // by the prepared or streamed queries of a typed record set.
+  TypedRecordSet typed_event_record_set;
+  MLMD_RETURN_IF_ERROR(ExecutePreparedQuery(select_events,
+                                            BindEventQuery(ids, event_types),
+                                            &typed_event_record_set));
+  typed_event_record_set.ToRecordSet(event_record_set);
+  path_record_set->Clear();
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::AddEventPathBytesColumn() {
+  const absl::Status status =
+      ExecuteQuery(query_config_.add_event_path_bytes_column());
+  // The column may have been added by a concurrent store meanwhile.
+  if (!status.ok() &&
+      absl::StrContains(absl::AsciiStrToLower(status.message()),
+                        "duplicate column name")) {
+    return absl::OkStatus();
+  }
+  return status;
+}
+
+absl::Status QueryConfigExecutor::UpdateEventPathBytes(
+    const int64 event_id, const Event::Path& path) {
+  return ExecutePreparedQuery(
+      query_config_.update_event_path_bytes(),
+      {BindPrepared(event_id),
+       {absl::nullopt, {PreparedStatementBytes{path.SerializeAsString()}}}});
+}
+
+absl::Status QueryConfigExecutor::AddNodePropertiesBytesColumns() {
+  for (const MetadataSourceQueryConfig::TemplateQuery* add_column :
+       {&query_config_.add_artifact_properties_bytes_column(),
+        &query_config_.add_execution_properties_bytes_column(),
+        &query_config_.add_context_properties_bytes_column()}) {
+    const absl::Status status = ExecuteQuery(*add_column);
+    // The column may have been added by a concurrent store meanwhile, or by
+    // an earlier store which was interrupted before adding the others.
+    if (!status.ok() &&
+        !absl::StrContains(absl::AsciiStrToLower(status.message()),
+                           "duplicate column name")) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::UpdateArtifactPropertiesBytes(
+    const int64 artifact_id, const Artifact& artifact) {
+  return ExecutePreparedQuery(
+      query_config_.update_artifact_properties_bytes(),
+      {BindPrepared(artifact_id),
+       {absl::nullopt,
+        {PreparedStatementBytes{SerializeNodeProperties(artifact)}}}});
+}
+
+absl::Status QueryConfigExecutor::UpdateExecutionPropertiesBytes(
+    const int64 execution_id, const Execution& execution) {
+  return ExecutePreparedQuery(
+      query_config_.update_execution_properties_bytes(),
+      {BindPrepared(execution_id),
+       {absl::nullopt,
+        {PreparedStatementBytes{SerializeNodeProperties(execution)}}}});
+}
+
+absl::Status QueryConfigExecutor::UpdateContextPropertiesBytes(
+    const int64 context_id, const Context& context) {
+  return ExecutePreparedQuery(
+      query_config_.update_context_properties_bytes(),
+      {BindPrepared(context_id),
+       {absl::nullopt,
+        {PreparedStatementBytes{SerializeNodeProperties(context)}}}});
+}
+
+absl::Status QueryConfigExecutor::SelectIdempotencyKey(
+    const absl::string_view idempotency_key, RecordSet* record_set) {
+  // The serialized responses are binary cells, which are only returned
+  // unchanged by the prepared queries of a typed record set.
+  TypedRecordSet typed_record_set;
+  MLMD_RETURN_IF_ERROR(
+      ExecutePreparedQuery(query_config_.select_idempotency_key(),
+                           {BindPrepared(idempotency_key)}, &typed_record_set));
+  typed_record_set.ToRecordSet(record_set);
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::InsertIdempotencyKey(
+    const absl::string_view idempotency_key, const int64 request_fingerprint,
+    const absl::Time create_time, const absl::string_view response) {
+  return ExecutePreparedQuery(
+      query_config_.insert_idempotency_key(),
+      {BindPrepared(idempotency_key), BindPrepared(request_fingerprint),
+       BindPrepared(absl::ToUnixMillis(create_time)),
+       {absl::nullopt, {PreparedStatementBytes{std::string(response)}}}});
+}
+
+absl::Status QueryConfigExecutor::InsertLineageClosureIfNotExist(
+    const absl::Span<const std::array<int64, 3>> rows) {
+  std::vector<std::vector<PreparedParameter>> prepared_rows;
+  prepared_rows.reserve(rows.size());
+  for (const std::array<int64, 3>& row : rows) {
+    prepared_rows.push_back(
+        {BindPrepared(row[0]), BindPrepared(row[1]), BindPrepared(row[2])});
+  }
+  return ExecutePreparedMultiRowInsert(
+      query_config_.insert_or_ignore_lineage_closure(), prepared_rows,
+      /*inserted_ids=*/nullptr);
+}
+
+std::vector<std::string> QueryConfigExecutor::InlinePreparedParameters(
+    const absl::Span<const PreparedParameter> parameters) {
+  std::vector<std::string> inlined_parameters;
+  inlined_parameters.reserve(parameters.size());
+  for (const PreparedParameter& parameter : parameters) {
+    if (parameter.sql_fragment) {
+      inlined_parameters.push_back(*parameter.sql_fragment);
+      continue;
+    }
+    std::vector<std::string> literals;
+    literals.reserve(parameter.values.size());
+    for (const PreparedStatementValue& value : parameter.values) {
+      if (absl::holds_alternative<int64>(value)) {
+        literals.push_back(Bind(absl::get<int64>(value)));
+      } else if (absl::holds_alternative<double>(value)) {
+        literals.push_back(Bind(absl::get<double>(value)));
+      } else if (absl::holds_alternative<std::string>(value)) {
+        literals.push_back(
+            Bind(absl::string_view(absl::get<std::string>(value))));
+      } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+        literals.push_back(metadata_source_->BytesLiteral(
+            absl::get<PreparedStatementBytes>(value).bytes));
+      } else {
+        literals.push_back("NULL");
+      }
+    }
+    inlined_parameters.push_back(absl::StrJoin(literals, ", "));
+  }
+  return inlined_parameters;
+}
+
+absl::Status QueryConfigExecutor::ExecutePreparedMultiRowInsert(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const std::vector<PreparedParameter>> rows,
+    std::vector<int64>* inserted_ids) {
+  if (inserted_ids != nullptr) {
+    inserted_ids->clear();
+    inserted_ids->reserve(rows.size());
+  }
+  if (rows.empty()) {
+    return absl::OkStatus();
+  }
+  // Splits the template query into the INSERT clause and the row of values,
+  // which is repeated for each inserted row.
+  constexpr absl::string_view kValuesKeyword = "VALUES";
+  const std::string& query = template_query.query();
+  const size_t values_pos = query.rfind(std::string(kValuesKeyword));
+  if (values_pos == std::string::npos) {
+    return absl::InternalError(
+        absl::StrCat("Not an INSERT ... VALUES template query: ", query));
+  }
+  MetadataSourceQueryConfig::TemplateQuery insert_clause = template_query;
+  insert_clause.set_query(query.substr(0, values_pos + kValuesKeyword.size()));
+  MetadataSourceQueryConfig::TemplateQuery values_clause = template_query;
+  values_clause.set_query(query.substr(values_pos + kValuesKeyword.size()));
+  // A trailing conflict clause applies to the whole statement, so it is
+  // appended once after the rows.
+  constexpr absl::string_view kConflictKeyword = " ON CONFLICT ";
+  std::string conflict_clause;
+  const size_t conflict_pos =
+      values_clause.query().find(std::string(kConflictKeyword));
+  if (conflict_pos != std::string::npos) {
+    absl::string_view trimmed_clause = absl::StripTrailingAsciiWhitespace(
+        absl::string_view(values_clause.query()).substr(conflict_pos));
+    absl::ConsumeSuffix(&trimmed_clause, ";");
+    conflict_clause = std::string(trimmed_clause);
+    values_clause.set_query(values_clause.query().substr(0, conflict_pos));
+  }
+
+  const bool is_postgresql =
+      query_config_.metadata_source_type() == POSTGRESQL_METADATA_SOURCE;
+  if (is_postgresql && inserted_ids == nullptr && conflict_clause.empty()) {
+    const absl::Status status =
+        ExecuteBulkInsert(insert_clause, values_clause, rows);
+    if (!absl::IsUnimplemented(status)) {
+      return status;
+    }
+  }
+
+  std::string row_statement;
+  std::vector<PreparedStatementValue> row_values;
+  MLMD_RETURN_IF_ERROR(BuildPreparedStatement(values_clause, rows[0],
+                                              &row_statement, &row_values));
+  int max_batch_size = std::max<int>(
+      1, kMaxNumPreparedStatementValues / std::max<int>(1, row_values.size()));
+  // The ids of the rows of a statement are only derived from the last insert
+  // id if they are evenly spaced, otherwise each row is inserted alone.
+  int64 inserted_id_step = 1;
+  if (!is_postgresql && inserted_ids != nullptr) {
+    MLMD_RETURN_IF_ERROR(GetInsertedIdStep(&inserted_id_step));
+    if (inserted_id_step == 0) {
+      max_batch_size = 1;
+    }
+  }
+  RecordSet* const no_results = nullptr;
+  for (int begin = 0; begin < rows.size();) {
+    const int batch_size =
+        GetMultiRowBatchSize(rows.size() - begin, max_batch_size);
+    std::string statement;
+    std::vector<PreparedStatementValue> values;
+    MLMD_RETURN_IF_ERROR(BuildPreparedStatement(insert_clause, rows[begin],
+                                                &statement, &values));
+    for (int i = begin; i < begin + batch_size; i++) {
+      MLMD_RETURN_IF_ERROR(BuildPreparedStatement(values_clause, rows[i],
+                                                  &row_statement, &row_values));
+      absl::StrAppend(&statement, i == begin ? "" : ",", row_statement);
+      values.insert(values.end(), row_values.begin(), row_values.end());
+    }
+    absl::StrAppend(&statement, conflict_clause);
+    if (is_postgresql && inserted_ids != nullptr) {
+      // The ids of a sequence are not consecutive when other sessions insert
+      // concurrently, so the statement returns them. They increase in the
+      // order of the rows.
+      absl::StrAppend(&statement, " RETURNING `id`");
+      TypedRecordSet returned_ids;
+      MLMD_RETURN_IF_ERROR(metadata_source_->ExecutePreparedQuery(
+          statement, values, &returned_ids));
+      std::vector<int64> batch_ids(returned_ids.num_rows());
+      for (int i = 0; i < returned_ids.num_rows(); i++) {
+        if (!returned_ids.GetInt64(i, 0, &batch_ids[i])) {
+          return absl::InternalError(
+              absl::StrCat("Invalid id returned by: ", statement));
+        }
+      }
+      if (batch_ids.size() != batch_size) {
+        return absl::InternalError(absl::StrCat(
+            "Expected ", batch_size, " ids returned by: ", statement));
+      }
+      std::sort(batch_ids.begin(), batch_ids.end());
+      inserted_ids->insert(inserted_ids->end(), batch_ids.begin(),
+                           batch_ids.end());
+      begin += batch_size;
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(
+        metadata_source_->ExecutePreparedQuery(statement, values, no_results));
+    if (inserted_ids != nullptr) {
+      // The rows inserted by one statement have evenly spaced ids. MySQL
+      // returns the id of the first row inserted by the statement, and SQLite
+      // returns the id of the last one.
+      int64 last_insert_id;
+      MLMD_RETURN_IF_ERROR(SelectLastInsertID(&last_insert_id));
+      const int64 first_id =
+          query_config_.metadata_source_type() == MYSQL_METADATA_SOURCE
+              ? last_insert_id
+              : last_insert_id - (batch_size - 1) * inserted_id_step;
+      for (int i = 0; i < batch_size; i++) {
+        inserted_ids->push_back(first_id + i * inserted_id_step);
+      }
+    }
+    begin += batch_size;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::GetInsertedIdStep(int64* step) {
+  if (!inserted_id_step_.has_value()) {
+    if (!query_config_.has_select_auto_increment_settings()) {
+      inserted_id_step_ = 1;
+    } else {
+      RecordSet record_set;
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.select_auto_increment_settings(), {}, &record_set));
+      if (record_set.records_size() == 0 ||
+          record_set.records(0).values_size() < 2) {
+        return absl::InternalError(
+            "Could not find the auto-increment settings: missing value");
+      }
+      const RecordSet::Record& record = record_set.records(0);
+      int64 lock_mode;
+      int64 increment;
+      if (!absl::SimpleAtoi(record.values(0), &lock_mode) ||
+          !absl::SimpleAtoi(record.values(1), &increment)) {
+        return absl::InternalError(
+            "Could not parse the auto-increment settings as integers");
+      }
+      // The interleaved lock mode lets concurrent statements take the ids in
+      // between the ones of a statement.
+      inserted_id_step_ = lock_mode == 2 ? 0 : increment;
+    }
+  }
+  *step = *inserted_id_step_;
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ExecuteBulkInsert(
+    const MetadataSourceQueryConfig::TemplateQuery& insert_clause,
+    const MetadataSourceQueryConfig::TemplateQuery& values_clause,
+    const absl::Span<const std::vector<PreparedParameter>> rows) {
+  std::string statement;
+  std::vector<PreparedStatementValue> clause_values;
+  MLMD_RETURN_IF_ERROR(BuildPreparedStatement(insert_clause, rows[0],
+                                              &statement, &clause_values));
+  std::string table;
+  std::vector<std::string> columns;
+  if (!clause_values.empty() ||
+      !ParseInsertClause(statement, &table, &columns)) {
+    return absl::UnimplementedError(
+        absl::StrCat("Not a bulk insert clause: ", statement));
+  }
+  // Each row must bind a value to each column, in order.
+  const std::string expected_row_statement = absl::StrCat(
+      "(", absl::StrJoin(std::vector<std::string>(columns.size(), "?"), ","),
+      ")");
+  std::vector<PreparedStatementValue> values;
+  values.reserve(rows.size() * columns.size());
+  std::string row_statement;
+  std::vector<PreparedStatementValue> row_values;
+  for (const std::vector<PreparedParameter>& row : rows) {
+    MLMD_RETURN_IF_ERROR(BuildPreparedStatement(values_clause, row,
+                                                &row_statement, &row_values));
+    if (row_values.size() != columns.size() ||
+        absl::StrReplaceAll(row_statement, {{" ", ""}}) !=
+            expected_row_statement) {
+      return absl::UnimplementedError(
+          absl::StrCat("Not a bulk insert row: ", row_statement));
+    }
+    values.insert(values.end(), row_values.begin(), row_values.end());
+  }
+  return metadata_source_->ExecuteBulkInsert(table, columns, values);
+}
+
+absl::Status QueryConfigExecutor::ExecutePreparedMultiRowDelete(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const std::vector<PreparedParameter>> rows) {
+  if (rows.empty()) {
+    return absl::OkStatus();
+  }
+  // Splits the template query into the DELETE clause and the condition of a
+  // row, which is repeated for each deleted row.
+  constexpr absl::string_view kWhereKeyword = "WHERE";
+  const std::string& query = template_query.query();
+  const size_t where_pos = query.rfind(std::string(kWhereKeyword));
+  if (where_pos == std::string::npos) {
+    return absl::InternalError(
+        absl::StrCat("Not a DELETE ... WHERE template query: ", query));
+  }
+  MetadataSourceQueryConfig::TemplateQuery delete_clause = template_query;
+  delete_clause.set_query(query.substr(0, where_pos + kWhereKeyword.size()));
+  MetadataSourceQueryConfig::TemplateQuery condition_clause = template_query;
+  condition_clause.set_query(query.substr(where_pos + kWhereKeyword.size()));
+
+  std::string row_condition;
+  std::vector<PreparedStatementValue> row_values;
+  MLMD_RETURN_IF_ERROR(BuildPreparedStatement(condition_clause, rows[0],
+                                              &row_condition, &row_values));
+  const int max_batch_size = std::max<int>(
+      1, kMaxNumPreparedStatementValues / std::max<int>(1, row_values.size()));
+  RecordSet* const no_results = nullptr;
+  for (int begin = 0; begin < rows.size();) {
+    const int batch_size =
+        GetMultiRowBatchSize(rows.size() - begin, max_batch_size);
+    std::string statement;
+    std::vector<PreparedStatementValue> values;
+    MLMD_RETURN_IF_ERROR(BuildPreparedStatement(delete_clause, rows[begin],
+                                                &statement, &values));
+    for (int i = begin; i < begin + batch_size; i++) {
+      MLMD_RETURN_IF_ERROR(BuildPreparedStatement(
+          condition_clause, rows[i], &row_condition, &row_values));
+      absl::StrAppend(&statement, i == begin ? " (" : " OR (", row_condition,
+                      ")");
+      values.insert(values.end(), row_values.begin(), row_values.end());
+    }
+    MLMD_RETURN_IF_ERROR(
+        metadata_source_->ExecutePreparedQuery(statement, values, no_results));
+    begin += batch_size;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::DeleteNodeProperties(
+    const MetadataSourceQueryConfig::TemplateQuery& delete_property,
+    const absl::Span<const NodePropertyName> property_names) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(property_names.size());
+  for (const NodePropertyName& property_name : property_names) {
+    rows.push_back({BindPrepared(property_name.node_id),
+                    BindPrepared(property_name.name)});
+  }
+  return ExecutePreparedMultiRowDelete(delete_property, rows);
+}
+
+absl::Status QueryConfigExecutor::InsertNodeProperties(
+    const MetadataSourceQueryConfig::TemplateQuery& insert_property,
+    const absl::Span<const NodeProperty> properties) {
+  // The data type of a property is the column name of its value, so the
+  // properties of each data type are inserted with separate statements.
+  std::map<std::string, std::vector<std::vector<PreparedParameter>>>
+      rows_by_data_type;
+  for (const NodeProperty& property : properties) {
+    rows_by_data_type[BindDataType(*property.value)].push_back(
+        {BindPreparedDataType(*property.value), BindPrepared(property.node_id),
+         BindPrepared(property.name), BindPrepared(property.is_custom_property),
+         BindPreparedValue(*property.value)});
+  }
+  for (const auto& data_type_and_rows : rows_by_data_type) {
+    MLMD_RETURN_IF_ERROR(ExecutePreparedMultiRowInsert(
+        insert_property, data_type_and_rows.second,
+        /*inserted_ids=*/nullptr));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::InsertArtifacts(
+    const absl::Span<const Artifact> artifacts, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* artifact_ids) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(artifacts.size());
+  for (const Artifact& artifact : artifacts) {
+    rows.push_back(
+        {BindPrepared(artifact.type_id()), BindPrepared(artifact.uri()),
+         BindPrepared(artifact.has_state()
+                          ? absl::make_optional(artifact.state())
+                          : absl::nullopt),
+         BindPrepared(artifact.has_name() ? absl::make_optional(artifact.name())
+                                          : absl::nullopt),
+         BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(absl::ToUnixMillis(update_time))});
+  }
+  return ExecutePreparedMultiRowInsert(query_config_.insert_artifact(), rows,
+                                       artifact_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertExecutions(
+    const absl::Span<const Execution> executions, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* execution_ids) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(executions.size());
+  for (const Execution& execution : executions) {
+    rows.push_back(
+        {BindPrepared(execution.type_id()),
+         BindPrepared(execution.has_last_known_state()
+                          ? absl::make_optional(execution.last_known_state())
+                          : absl::nullopt),
+         BindPrepared(execution.has_name()
+                          ? absl::make_optional(execution.name())
+                          : absl::nullopt),
+         BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(absl::ToUnixMillis(update_time))});
+  }
+  return ExecutePreparedMultiRowInsert(query_config_.insert_execution(), rows,
+                                       execution_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertContexts(
+    const absl::Span<const Context> contexts, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* context_ids) {
+  std::vector<std::vector<PreparedParameter>> rows;
+  rows.reserve(contexts.size());
+  for (const Context& context : contexts) {
+    rows.push_back({BindPrepared(context.type_id()),
+                    BindPrepared(context.name()),
+                    BindPrepared(absl::ToUnixMillis(create_time)),
+                    BindPrepared(absl::ToUnixMillis(update_time))});
+  }
+  return ExecutePreparedMultiRowInsert(query_config_.insert_context(), rows,
+                                       context_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertContextIfNotExist(
+    const int64 type_id, const std::string& name, const absl::Time create_time,
+    const absl::Time update_time, int64* context_id, bool* inserted) {
+  MLMD_RETURN_IF_ERROR(ExecuteConditionalUpdate(
+      query_config_.insert_context_if_not_exist(),
+      {Bind(type_id), Bind(name), Bind(absl::ToUnixMillis(create_time)),
+       Bind(absl::ToUnixMillis(update_time))},
+      inserted));
+  if (*inserted) return SelectLastInsertID(context_id);
+  // The existing context may be committed by a concurrent transaction after
+  // this one began, so its id is read by a query that sees the latest row.
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_existing_context_id(),
+                                    {Bind(type_id), Bind(name)}, &record_set));
+  if (record_set.records_size() == 0 ||
+      record_set.records(0).values_size() == 0) {
+    return absl::InternalError(
+        absl::StrCat("Could not find the existing context: ", name));
+  }
+  if (!absl::SimpleAtoi(record_set.records(0).values(0), context_id)) {
+    return absl::InternalError("Could not parse the context id as string");
+  }
+  return absl::OkStatus();
 }
 
 absl::Status QueryConfigExecutor::IsCompatible(int64 db_version,
@@ -446,17 +1884,7 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
       ExecuteQuery(query_config_.create_parent_context_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_association_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_attribution_table()));
-  for (const MetadataSourceQueryConfig::TemplateQuery& index_query :
-       query_config_.secondary_indices()) {
-    const absl::Status status = ExecuteQuery(index_query);
-    // For databases (e.g., MySQL), idempotency of indexing creation is not
-    // supported well. We handle it here and covered by the `InitForReset` test.
-    if (!status.ok() && absl::StrContains(std::string(status.message()),
-                                          "Duplicate key name")) {
-      continue;
-    }
-    MLMD_RETURN_IF_ERROR(status);
-  }
+  MLMD_RETURN_IF_ERROR(CreateSecondaryIndices());
 
   int64 library_version = GetLibraryVersion();
   absl::Status insert_schema_version_status =
@@ -476,6 +1904,103 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::DropSecondaryIndices() {
+  for (const MetadataSourceQueryConfig::TemplateQuery& drop_query :
+       query_config_.drop_secondary_indices()) {
+    const absl::Status status = ExecuteQuery(drop_query);
+    // MySQL does not support DROP INDEX IF EXISTS, so the indices which do not
+    // exist are skipped here.
+    if (!status.ok() && absl::StrContains(std::string(status.message()),
+                                          "check that column/key exists")) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::CreateSecondaryIndices() {
+  for (const MetadataSourceQueryConfig::TemplateQuery& index_query :
+       query_config_.secondary_indices()) {
+    const absl::Status status = ExecuteQuery(index_query);
+    // For databases (e.g., MySQL), idempotency of indexing creation is not
+    // supported well. We handle it here and covered by the `InitForReset` test.
+    if (!status.ok() && absl::StrContains(std::string(status.message()),
+                                          "Duplicate key name")) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectEventPartitionBounds(
+    RecordSet* record_set) {
+  if (!query_config_.has_select_event_partition_bounds()) {
+    return absl::UnimplementedError(
+        "The metadata source does not partition the events.");
+  }
+  return ExecuteQuery(query_config_.select_event_partition_bounds(), {},
+                      record_set);
+}
+
+absl::Status QueryConfigExecutor::PartitionEventTables() {
+  if (query_config_.partition_event_tables().empty()) {
+    return absl::UnimplementedError(
+        "The metadata source does not partition the events.");
+  }
+  for (const MetadataSourceQueryConfig::TemplateQuery& partition_query :
+       query_config_.partition_event_tables()) {
+    const absl::Status status = ExecuteQuery(partition_query);
+    // The column added by an earlier attempt which failed later is kept.
+    if (!status.ok() && absl::StrContains(std::string(status.message()),
+                                          "Duplicate column name")) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::AddEventPartition(const int64 upper_bound) {
+  if (!query_config_.has_add_event_partition()) {
+    return absl::UnimplementedError(
+        "The metadata source does not partition the events.");
+  }
+  for (const MetadataSourceQueryConfig::TemplateQuery* add_query :
+       {&query_config_.add_event_partition(),
+        &query_config_.add_event_path_partition()}) {
+    const absl::Status status = ExecuteQuery(*add_query, {Bind(upper_bound)});
+    // The partitions may be added concurrently by the other stores.
+    if (!status.ok() && absl::StrContains(std::string(status.message()),
+                                          "Duplicate partition name")) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::DropEventPartition(const int64 upper_bound) {
+  if (!query_config_.has_drop_event_partition()) {
+    return absl::UnimplementedError(
+        "The metadata source does not partition the events.");
+  }
+  for (const MetadataSourceQueryConfig::TemplateQuery* drop_query :
+       {&query_config_.drop_event_partition(),
+        &query_config_.drop_event_path_partition()}) {
+    const absl::Status status = ExecuteQuery(*drop_query, {Bind(upper_bound)});
+    // MySQL does not support DROP PARTITION IF EXISTS, so the partitions which
+    // are already dropped are skipped here.
+    if (!status.ok() && absl::StrContains(std::string(status.message()),
+                                          "Error in list of partitions")) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
     const bool enable_upgrade_migration) {
   // If |query_schema_version_| is given, then the query executor is expected to
@@ -565,6 +2090,18 @@ absl::Status QueryConfigExecutor::InsertContextType(
       {Bind(name), Bind(version), Bind(description)}, type_id);
 }
 
+absl::Status QueryConfigExecutor::InsertTypeWithID(
+    const int64 type_id, const TypeKind type_kind, const std::string& name,
+    absl::optional<absl::string_view> version,
+    absl::optional<absl::string_view> description,
+    const ArtifactStructType* input_type,
+    const ArtifactStructType* output_type) {
+  return ExecuteQuery(query_config_.insert_type_with_id(),
+                      {Bind(type_id), Bind(type_kind), Bind(name),
+                       Bind(version), Bind(description), Bind(input_type),
+                       Bind(output_type)});
+}
+
 absl::Status QueryConfigExecutor::SelectTypeByID(int64 type_id,
                                                  TypeKind type_kind,
                                                  RecordSet* record_set) {
@@ -591,6 +2128,168 @@ absl::Status QueryConfigExecutor::SelectAllTypes(TypeKind type_kind,
                       record_set);
 }
 
+absl::Status QueryConfigExecutor::SelectTypesByNames(
+    const absl::Span<const std::string> type_names, const TypeKind type_kind,
+    RecordSet* record_set) {
+  return ExecutePreparedQuery(
+      query_config_.select_types_by_names(),
+      {BindPrepared(type_names), BindPrepared(static_cast<int64>(type_kind))},
+      record_set);
+}
+
+absl::Status QueryConfigExecutor::SelectTypesByIDs(
+    const absl::Span<const int64> type_ids, const TypeKind type_kind,
+    RecordSet* record_set) {
+  return ExecutePreparedQuery(
+      query_config_.select_types_by_ids(),
+      {BindPrepared(type_ids), BindPrepared(static_cast<int64>(type_kind))},
+      record_set);
+}
+
+absl::Status QueryConfigExecutor::SelectArtifactsByURIPrefix(
+    const absl::string_view uri_prefix, RecordSet* record_set) {
+  // The wildcards in the prefix are escaped, so that the pattern matches the
+  // prefix literally. SQLite only uses the index for GLOB, as it is case
+  // sensitive as the index, while MySQL and PostgreSQL use it for LIKE.
+  std::string pattern;
+  if (query_config_.metadata_source_type() == MYSQL_METADATA_SOURCE ||
+      query_config_.metadata_source_type() == POSTGRESQL_METADATA_SOURCE) {
+    pattern = absl::StrCat(
+        absl::StrReplaceAll(uri_prefix,
+                            {{"\\", "\\\\"}, {"%", "\\%"}, {"_", "\\_"}}),
+        "%");
+  } else {
+    pattern = absl::StrCat(
+        absl::StrReplaceAll(uri_prefix,
+                            {{"*", "[*]"}, {"?", "[?]"}, {"[", "[[]"}}),
+        "*");
+  }
+  return ExecuteQuery(query_config_.select_artifacts_by_uri_prefix(),
+                      {Bind(pattern)}, record_set);
+}
+
+absl::Status QueryConfigExecutor::CountArtifacts(
+    const absl::optional<int64> artifact_type_id,
+    const absl::optional<Artifact::State> state, RecordSet* record_set) {
+  std::vector<std::string> conditions;
+  if (artifact_type_id) {
+    conditions.push_back(absl::StrCat("`type_id` = ", Bind(*artifact_type_id)));
+  }
+  if (state) {
+    conditions.push_back(absl::StrCat("`state` = ", Bind(*state)));
+  }
+  return CountRows("Artifact", conditions, record_set);
+}
+
+absl::Status QueryConfigExecutor::CountExecutions(
+    const absl::optional<int64> execution_type_id,
+    const absl::optional<Execution::State> last_known_state,
+    RecordSet* record_set) {
+  std::vector<std::string> conditions;
+  if (execution_type_id) {
+    conditions.push_back(
+        absl::StrCat("`type_id` = ", Bind(*execution_type_id)));
+  }
+  if (last_known_state) {
+    conditions.push_back(
+        absl::StrCat("`last_known_state` = ", Bind(*last_known_state)));
+  }
+  return CountRows("Execution", conditions, record_set);
+}
+
+absl::Status QueryConfigExecutor::CountContexts(
+    const absl::optional<int64> context_type_id, RecordSet* record_set) {
+  std::vector<std::string> conditions;
+  if (context_type_id) {
+    conditions.push_back(absl::StrCat("`type_id` = ", Bind(*context_type_id)));
+  }
+  return CountRows("Context", conditions, record_set);
+}
+
+absl::Status QueryConfigExecutor::CountRows(
+    const absl::string_view table,
+    const absl::Span<const std::string> conditions, RecordSet* record_set) {
+  std::string sql_query = absl::Substitute("SELECT COUNT(*) FROM `$0`", table);
+  if (!conditions.empty()) {
+    absl::StrAppend(&sql_query, " WHERE ", absl::StrJoin(conditions, " AND "));
+  }
+  absl::StrAppend(&sql_query, ";");
+  return ExecuteQuery(sql_query, record_set);
+}
+
+absl::Status QueryConfigExecutor::AggregateArtifactProperty(
+    const int64 artifact_type_id, const PropertyAggregationOptions& options,
+    RecordSet* record_set) {
+  return AggregateNodeProperty("Artifact", "ArtifactProperty", "Attribution",
+                               "artifact_id", "state", artifact_type_id,
+                               options, record_set);
+}
+
+absl::Status QueryConfigExecutor::AggregateExecutionProperty(
+    const int64 execution_type_id, const PropertyAggregationOptions& options,
+    RecordSet* record_set) {
+  return AggregateNodeProperty("Execution", "ExecutionProperty", "Association",
+                               "execution_id", "last_known_state",
+                               execution_type_id, options, record_set);
+}
+
+absl::Status QueryConfigExecutor::AggregateNodeProperty(
+    const absl::string_view node_table, const absl::string_view property_table,
+    const absl::string_view link_table, const absl::string_view node_id_column,
+    const absl::string_view state_column, const int64 type_id,
+    const PropertyAggregationOptions& options, RecordSet* record_set) {
+  std::vector<std::string> columns;
+  if (options.group_by_state()) {
+    columns.push_back(absl::Substitute("`$0`.`$1`", node_table, state_column));
+  }
+  columns.push_back("COUNT(*)");
+  if (options.has_property_name()) {
+    const std::string value = absl::Substitute(
+        "COALESCE(`$0`.`int_value`, `$0`.`double_value`)", property_table);
+    for (const absl::string_view function : {"COUNT", "MIN", "MAX", "AVG"}) {
+      columns.push_back(absl::StrCat(function, "(", value, ")"));
+    }
+  }
+  std::string sql_query =
+      absl::Substitute("SELECT $0 FROM `$1`", absl::StrJoin(columns, ", "),
+                       node_table);
+  if (options.has_context_id()) {
+    absl::SubstituteAndAppend(
+        &sql_query,
+        " JOIN `$0` ON `$0`.`$1` = `$2`.`id` AND `$0`.`context_id` = $3",
+        link_table, node_id_column, node_table, Bind(options.context_id()));
+  }
+  if (options.has_property_name()) {
+    absl::SubstituteAndAppend(
+        &sql_query,
+        " LEFT JOIN `$0` ON `$0`.`$1` = `$2`.`id` AND `$0`.`name` = $3 AND "
+        "`$0`.`is_custom_property` = $4",
+        property_table, node_id_column, node_table,
+        Bind(options.property_name()), Bind(options.is_custom_property()));
+  }
+  absl::SubstituteAndAppend(&sql_query, " WHERE `$0`.`type_id` = $1",
+                            node_table, Bind(type_id));
+  if (options.group_by_state()) {
+    absl::SubstituteAndAppend(&sql_query, " GROUP BY `$0`.`$1`", node_table,
+                              state_column);
+  }
+  absl::StrAppend(&sql_query, ";");
+  return ExecuteQuery(sql_query, record_set);
+}
+
+absl::Status QueryConfigExecutor::SelectNodeIDsUpdatedAfter(
+    const absl::string_view table, const int64 last_update_time_since_epoch,
+    const int64 id, const RecordBatchCallback& callback) {
+  const std::string sql_query = absl::Substitute(
+      "SELECT `id` FROM `$0` "
+      "WHERE `last_update_time_since_epoch` >= $1 AND "
+      "(`last_update_time_since_epoch` > $1 OR `id` > $2) "
+      "ORDER BY `last_update_time_since_epoch`, `id`;",
+      table, Bind(last_update_time_since_epoch), Bind(id));
+  return metadata_source_->ExecuteStreamingQuery(
+      sql_query, kNodeStreamingBatchSize, callback);
+}
+
 template <typename Node>
 absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
     const ListOperationOptions& options,
@@ -601,12 +2300,23 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
     return absl::OkStatus();
   }
   std::string sql_query;
+  absl::string_view property_table;
+  absl::string_view node_id_column;
+  absl::string_view state_column;
   if (std::is_same<Node, Artifact>::value) {
     sql_query = "SELECT `id` FROM `Artifact` WHERE";
+    property_table = "ArtifactProperty";
+    node_id_column = "artifact_id";
+    state_column = "state";
   } else if (std::is_same<Node, Execution>::value) {
     sql_query = "SELECT `id` FROM `Execution` WHERE";
+    property_table = "ExecutionProperty";
+    node_id_column = "execution_id";
+    state_column = "last_known_state";
   } else if (std::is_same<Node, Context>::value) {
     sql_query = "SELECT `id` FROM `Context` WHERE";
+    property_table = "ContextProperty";
+    node_id_column = "context_id";
   } else {
     return absl::InvalidArgumentError(
         "Invalid Node passed to ListNodeIDsUsingOptions");
@@ -616,6 +2326,25 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
     absl::SubstituteAndAppend(&sql_query, " `id` IN ($0) AND ",
                               Bind(*candidate_ids));
   }
+  // The type comes before the ordering threshold, so that the composite
+  // indices on the type and the ordering field serve both.
+  if (options.has_type_id()) {
+    absl::SubstituteAndAppend(&sql_query, " `type_id` = $0 AND ",
+                              Bind(options.type_id()));
+  }
+  if (options.has_state()) {
+    if (state_column.empty()) {
+      return absl::InvalidArgumentError(
+          "Contexts cannot be listed with a state.");
+    }
+    absl::SubstituteAndAppend(&sql_query, " `$0` = $1 AND ", state_column,
+                              Bind(int64{options.state()}));
+  }
+  for (const ListOperationOptions::PropertyFilter& filter :
+       options.property_filters()) {
+    MLMD_RETURN_IF_ERROR(AppendPropertyFilterClause(filter, property_table,
+                                                    node_id_column, sql_query));
+  }
 
   MLMD_RETURN_IF_ERROR(AppendOrderingThresholdClause(options, sql_query));
   MLMD_RETURN_IF_ERROR(AppendOrderByClause(options, sql_query));
@@ -623,6 +2352,56 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
   return ExecuteQuery(sql_query, record_set);
 }
 
+absl::Status QueryConfigExecutor::AppendPropertyFilterClause(
+    const ListOperationOptions::PropertyFilter& filter,
+    const absl::string_view property_table,
+    const absl::string_view node_id_column, std::string& sql_query) {
+  if (filter.name().empty()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "PropertyFilter must have a name: ", filter.DebugString()));
+  }
+  absl::string_view op;
+  switch (filter.op()) {
+    case ListOperationOptions::PropertyFilter::EQ:
+      op = "=";
+      break;
+    case ListOperationOptions::PropertyFilter::LT:
+      op = "<";
+      break;
+    case ListOperationOptions::PropertyFilter::LE:
+      op = "<=";
+      break;
+    case ListOperationOptions::PropertyFilter::GT:
+      op = ">";
+      break;
+    case ListOperationOptions::PropertyFilter::GE:
+      op = ">=";
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "PropertyFilter must have an operator: ", filter.DebugString()));
+  }
+  switch (filter.value().value_case()) {
+    case PropertyType::INT:
+    case PropertyType::DOUBLE:
+    case PropertyType::STRING:
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("PropertyFilter must have an int, double or string "
+                       "value: ",
+                       filter.DebugString()));
+  }
+  absl::SubstituteAndAppend(
+      &sql_query,
+      " `id` IN (SELECT `$0` FROM `$1` WHERE `name` = $2 AND "
+      "`is_custom_property` = $3 AND `$4` $5 $6) AND ",
+      node_id_column, property_table, Bind(filter.name()),
+      Bind(filter.is_custom_property()), BindDataType(filter.value()), op,
+      BindValue(filter.value()));
+  return absl::OkStatus();
+}
+
 absl::Status QueryConfigExecutor::ListArtifactIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
@@ -15,15 +15,21 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_QUERY_CONFIG_EXECUTOR_H_
 #define ML_METADATA_METADATA_STORE_QUERY_CONFIG_EXECUTOR_H_
 
+#include <array>
 #include <memory>
 #include <vector>
 
 #include <glog/logging.h>
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/query_executor.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metrics.h"
 #include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
@@ -46,7 +52,9 @@ class QueryConfigExecutor : public QueryExecutor {
   // The MetadataSource is not owned by this object, and must outlast it.
   QueryConfigExecutor(const MetadataSourceQueryConfig& query_config,
                       MetadataSource* source)
-      : query_config_(query_config), metadata_source_(source) {}
+      : query_config_(query_config), metadata_source_(source) {
+    InitQueryMetrics();
+  }
 
   // A `query_version` can be passed to the QueryConfigExecutor to work with
   // an existing db with an earlier schema version.
@@ -87,6 +95,13 @@ class QueryConfigExecutor : public QueryExecutor {
                                  absl::optional<absl::string_view> description,
                                  int64* type_id) final;
 
+  absl::Status InsertTypeWithID(int64 type_id, TypeKind type_kind,
+                                const std::string& name,
+                                absl::optional<absl::string_view> version,
+                                absl::optional<absl::string_view> description,
+                                const ArtifactStructType* input_type,
+                                const ArtifactStructType* output_type) final;
+
   absl::Status SelectTypeByID(int64 type_id, TypeKind type_kind,
                               RecordSet* record_set) final;
 
@@ -97,6 +112,14 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status SelectAllTypes(TypeKind type_kind, RecordSet* record_set) final;
 
+  absl::Status SelectTypesByNames(absl::Span<const std::string> type_names,
+                                  TypeKind type_kind,
+                                  RecordSet* record_set) final;
+
+  absl::Status SelectTypesByIDs(absl::Span<const int64> type_ids,
+                                TypeKind type_kind,
+                                RecordSet* record_set) final;
+
   absl::Status CheckTypePropertyTable() final {
     return ExecuteQuery(query_config_.check_type_property_table());
   }
@@ -115,6 +138,12 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(type_id)}, record_set);
   }
 
+  absl::Status SelectPropertiesByTypeIDs(absl::Span<const int64> type_ids,
+                                         RecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_properties_by_type_ids(),
+                                {BindPrepared(type_ids)}, record_set);
+  }
+
   absl::Status CheckParentTypeTable() final;
 
   absl::Status InsertParentType(int64 type_id, int64 parent_type_id) final;
@@ -122,6 +151,12 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status SelectParentTypesByTypeID(int64 type_id,
                                          RecordSet* record_set) final;
 
+  absl::Status SelectParentTypesByTypeIDs(absl::Span<const int64> type_ids,
+                                          RecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_parent_types_by_type_ids(),
+                                {BindPrepared(type_ids)}, record_set);
+  }
+
   // Queries the last inserted id.
   absl::Status SelectLastInsertID(int64* id);
 
@@ -135,18 +170,29 @@ class QueryConfigExecutor : public QueryExecutor {
                               const absl::Time create_time,
                               const absl::Time update_time,
                               int64* artifact_id) final {
-    return ExecuteQuerySelectLastInsertID(
+    return ExecutePreparedQuerySelectLastInsertID(
         query_config_.insert_artifact(),
-        {Bind(type_id), Bind(artifact_uri), Bind(state), Bind(name),
-         Bind(absl::ToUnixMillis(create_time)),
-         Bind(absl::ToUnixMillis(update_time))},
+        {BindPrepared(type_id), BindPrepared(artifact_uri),
+         BindPrepared(state), BindPrepared(name),
+         BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(absl::ToUnixMillis(update_time))},
         artifact_id);
   }
 
+  absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                               absl::Time create_time, absl::Time update_time,
+                               std::vector<int64>* artifact_ids) final;
+
   absl::Status SelectArtifactsByID(const absl::Span<const int64> artifact_ids,
                                    RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_artifact_by_id(),
-                        {Bind(artifact_ids)}, record_set);
+    return ExecutePreparedQuery(query_config_.select_artifact_by_id(),
+                                {BindPrepared(artifact_ids)}, record_set);
+  }
+
+  absl::Status SelectArtifactsByID(const absl::Span<const int64> artifact_ids,
+                                   TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_artifact_by_id(),
+                                {BindPrepared(artifact_ids)}, record_set);
   }
 
   absl::Status SelectArtifactByTypeIDAndArtifactName(
@@ -156,6 +202,14 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(artifact_type_id), Bind(name)}, record_set);
   }
 
+  absl::Status SelectArtifactsByTypeIDAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifacts_by_type_id_and_names(),
+        {BindPrepared(artifact_type_id), BindPrepared(names)}, record_set);
+  }
+
   absl::Status SelectArtifactsByTypeID(int64 artifact_type_id,
                                        RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifacts_by_type_id(),
@@ -168,6 +222,23 @@ class QueryConfigExecutor : public QueryExecutor {
                         record_set);
   }
 
+  absl::Status SelectArtifactsByURIPrefix(absl::string_view uri_prefix,
+                                          RecordSet* record_set) final;
+
+  absl::Status SelectArtifactIDsByID(const absl::Span<const int64> artifact_ids,
+                                     RecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_artifact_ids_by_id(),
+                                {BindPrepared(artifact_ids)}, record_set);
+  }
+
+  absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                              absl::optional<Artifact::State> state,
+                              RecordSet* record_set) final;
+
+  absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      RecordSet* record_set) final;
+
   absl::Status UpdateArtifactDirect(
       int64 artifact_id, int64 type_id, const std::string& uri,
       const absl::optional<Artifact::State>& state,
@@ -177,6 +248,18 @@ class QueryConfigExecutor : public QueryExecutor {
                          Bind(state), Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateArtifactDirectIfUnchanged(
+      int64 artifact_id, int64 type_id, const std::string& uri,
+      const absl::optional<Artifact::State>& state,
+      const absl::Time update_time, int64 expected_update_time,
+      bool* updated) final {
+    return ExecuteConditionalUpdate(
+        query_config_.update_artifact_if_unchanged(),
+        {Bind(artifact_id), Bind(type_id), Bind(uri), Bind(state),
+         Bind(absl::ToUnixMillis(update_time)), Bind(expected_update_time)},
+        updated);
+  }
+
   absl::Status CheckArtifactPropertyTable() final {
     return ExecuteQuery(query_config_.check_artifact_property_table());
   }
@@ -185,31 +268,123 @@ class QueryConfigExecutor : public QueryExecutor {
                                       absl::string_view artifact_property_name,
                                       bool is_custom_property,
                                       const Value& property_value) final {
-    return ExecuteQuery(query_config_.insert_artifact_property(),
-                        {BindDataType(property_value), Bind(artifact_id),
-                         Bind(artifact_property_name), Bind(is_custom_property),
-                         BindValue(property_value)});
+    return ExecutePreparedQuery(
+        query_config_.insert_artifact_property(),
+        {BindPreparedDataType(property_value), BindPrepared(artifact_id),
+         BindPrepared(artifact_property_name),
+         BindPrepared(is_custom_property), BindPreparedValue(property_value)});
+  }
+
+  absl::Status InsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) final {
+    return InsertNodeProperties(query_config_.insert_artifact_property(),
+                                properties);
   }
 
   absl::Status SelectArtifactPropertyByArtifactID(
       const absl::Span<const int64> artifact_ids, RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_artifact_property_by_artifact_id(),
-                        {Bind(artifact_ids)}, record_set);
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_property_by_artifact_id(),
+        {BindPrepared(artifact_ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectArtifactPropertyByArtifactID(
+      const absl::Span<const int64> artifact_ids,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_property_by_artifact_id(),
+        {BindPrepared(artifact_ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectArtifactPropertyByArtifactIDAndName(
+      const absl::Span<const int64> artifact_ids,
+      const absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_property_by_artifact_id_and_name(),
+        {BindPrepared(artifact_ids), BindPreparedByteValueColumn(),
+         BindPrepared(names)},
+        record_set);
+  }
+
+  absl::Status SelectArtifactsWithPropertiesByID(
+      const absl::Span<const int64> artifact_ids,
+      const absl::Span<const std::string> property_names,
+      TypedRecordSet* record_set, TypedRecordSet* property_record_set) final {
+    return SelectNodesWithPropertiesByID(
+        query_config_.select_artifact_by_id(),
+        query_config_.select_artifact_with_properties_bytes_by_id(),
+        query_config_.select_artifact_property_by_artifact_id(),
+        query_config_.select_artifact_property_by_artifact_id_and_name(),
+        artifact_ids, property_names, record_set, property_record_set);
   }
 
   absl::Status UpdateArtifactProperty(int64 artifact_id,
                                       const absl::string_view property_name,
                                       const Value& property_value) final {
-    return ExecuteQuery(
+    return ExecutePreparedQuery(
         query_config_.update_artifact_property(),
-        {BindDataType(property_value), BindValue(property_value),
-         Bind(artifact_id), Bind(property_name)});
+        {BindPreparedDataType(property_value),
+         BindPreparedValue(property_value),
+         BindPrepared(artifact_id), BindPrepared(property_name)});
   }
 
   absl::Status DeleteArtifactProperty(
       int64 artifact_id, const absl::string_view property_name) final {
-    return ExecuteQuery(query_config_.delete_artifact_property(),
-                        {Bind(artifact_id), Bind(property_name)});
+    return ExecutePreparedQuery(
+        query_config_.delete_artifact_property(),
+        {BindPrepared(artifact_id), BindPrepared(property_name)});
+  }
+
+  absl::Status DeleteArtifactProperties(
+      absl::Span<const NodePropertyName> property_names) final {
+    return DeleteNodeProperties(query_config_.delete_artifact_property(),
+                                property_names);
+  }
+
+  absl::Status SelectArtifactIDsByTypeIDUpdatedBefore(
+      const int64 artifact_type_id, const int64 last_update_time_since_epoch,
+      const int64 limit, RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_ids_by_type_id_updated_before(),
+        {BindPrepared(artifact_type_id),
+         BindPrepared(last_update_time_since_epoch), BindPrepared(limit)},
+        record_set);
+  }
+
+  absl::Status DeleteArtifactsById(
+      const absl::Span<const int64> artifact_ids) final {
+    return ExecutePreparedQuery(query_config_.delete_artifacts_by_id(),
+                                {BindPrepared(artifact_ids)});
+  }
+
+  absl::Status DeleteArtifactsPropertiesByArtifactsId(
+      const absl::Span<const int64> artifact_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_artifacts_properties_by_artifacts_id(),
+        {BindPrepared(artifact_ids)});
+  }
+
+  absl::Status DeleteEventsByArtifactsId(
+      const absl::Span<const int64> artifact_ids) final {
+    return ExecutePreparedQuery(query_config_.delete_events_by_artifacts_id(),
+                                {BindPrepared(artifact_ids)});
+  }
+
+  absl::Status DeleteEventPathsByArtifactsId(
+      const absl::Span<const int64> artifact_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_event_paths_by_artifacts_id(),
+        {BindPrepared(artifact_ids)});
+  }
+
+  absl::Status DeleteAttributionsByArtifactsId(
+      const absl::Span<const int64> artifact_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_attributions_by_artifacts_id(),
+        {BindPrepared(artifact_ids)});
   }
 
   absl::Status CheckExecutionTable() final {
@@ -220,18 +395,28 @@ class QueryConfigExecutor : public QueryExecutor {
       int64 type_id, const absl::optional<Execution::State>& last_known_state,
       const absl::optional<std::string>& name, const absl::Time create_time,
       const absl::Time update_time, int64* execution_id) final {
-    return ExecuteQuerySelectLastInsertID(
+    return ExecutePreparedQuerySelectLastInsertID(
         query_config_.insert_execution(),
-        {Bind(type_id), Bind(last_known_state), Bind(name),
-         Bind(absl::ToUnixMillis(create_time)),
-         Bind(absl::ToUnixMillis(update_time))},
+        {BindPrepared(type_id), BindPrepared(last_known_state),
+         BindPrepared(name), BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(absl::ToUnixMillis(update_time))},
         execution_id);
   }
 
+  absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                absl::Time create_time, absl::Time update_time,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status SelectExecutionsByID(const absl::Span<const int64> ids,
                                     RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_execution_by_id(), {Bind(ids)},
-                        record_set);
+    return ExecutePreparedQuery(query_config_.select_execution_by_id(),
+                                {BindPrepared(ids)}, record_set);
+  }
+
+  absl::Status SelectExecutionsByID(const absl::Span<const int64> ids,
+                                    TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_execution_by_id(),
+                                {BindPrepared(ids)}, record_set);
   }
 
   absl::Status SelectExecutionByTypeIDAndExecutionName(
@@ -241,12 +426,29 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(execution_type_id), Bind(name)}, record_set);
   }
 
+  absl::Status SelectExecutionsByTypeIDAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_executions_by_type_id_and_names(),
+        {BindPrepared(execution_type_id), BindPrepared(names)}, record_set);
+  }
+
   absl::Status SelectExecutionsByTypeID(int64 execution_type_id,
                                         RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_executions_by_type_id(),
                         {Bind(execution_type_id)}, record_set);
   }
 
+  absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state,
+      RecordSet* record_set) final;
+
+  absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      RecordSet* record_set) final;
+
   absl::Status UpdateExecutionDirect(
       int64 execution_id, int64 type_id,
       const absl::optional<Execution::State>& last_known_state,
@@ -257,6 +459,18 @@ class QueryConfigExecutor : public QueryExecutor {
          Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateExecutionDirectIfUnchanged(
+      int64 execution_id, int64 type_id,
+      const absl::optional<Execution::State>& last_known_state,
+      const absl::Time update_time, int64 expected_update_time,
+      bool* updated) final {
+    return ExecuteConditionalUpdate(
+        query_config_.update_execution_if_unchanged(),
+        {Bind(execution_id), Bind(type_id), Bind(last_known_state),
+         Bind(absl::ToUnixMillis(update_time)), Bind(expected_update_time)},
+        updated);
+  }
+
   absl::Status CheckExecutionPropertyTable() final {
     return ExecuteQuery(query_config_.check_execution_property_table());
   }
@@ -265,30 +479,121 @@ class QueryConfigExecutor : public QueryExecutor {
                                        const absl::string_view name,
                                        bool is_custom_property,
                                        const Value& value) final {
-    return ExecuteQuery(query_config_.insert_execution_property(),
-                        {BindDataType(value), Bind(execution_id), Bind(name),
-                         Bind(is_custom_property), BindValue(value)});
+    return ExecutePreparedQuery(
+        query_config_.insert_execution_property(),
+        {BindPreparedDataType(value), BindPrepared(execution_id),
+         BindPrepared(name), BindPrepared(is_custom_property),
+         BindPreparedValue(value)});
+  }
+
+  absl::Status InsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) final {
+    return InsertNodeProperties(query_config_.insert_execution_property(),
+                                properties);
   }
 
   absl::Status SelectExecutionPropertyByExecutionID(
       const absl::Span<const int64> ids, RecordSet* record_set) final {
-    return ExecuteQuery(
-        query_config_.select_execution_property_by_execution_id(), {Bind(ids)},
+    return ExecutePreparedQuery(
+        query_config_.select_execution_property_by_execution_id(),
+        {BindPrepared(ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectExecutionPropertyByExecutionID(
+      const absl::Span<const int64> ids, TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_execution_property_by_execution_id(),
+        {BindPrepared(ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectExecutionPropertyByExecutionIDAndName(
+      const absl::Span<const int64> ids,
+      const absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_execution_property_by_execution_id_and_name(),
+        {BindPrepared(ids), BindPreparedByteValueColumn(),
+         BindPrepared(names)},
         record_set);
   }
 
+  absl::Status SelectExecutionsWithPropertiesByID(
+      const absl::Span<const int64> execution_ids,
+      const absl::Span<const std::string> property_names,
+      TypedRecordSet* record_set, TypedRecordSet* property_record_set) final {
+    return SelectNodesWithPropertiesByID(
+        query_config_.select_execution_by_id(),
+        query_config_.select_execution_with_properties_bytes_by_id(),
+        query_config_.select_execution_property_by_execution_id(),
+        query_config_.select_execution_property_by_execution_id_and_name(),
+        execution_ids, property_names, record_set, property_record_set);
+  }
+
   absl::Status UpdateExecutionProperty(int64 execution_id,
                                        const absl::string_view name,
                                        const Value& value) final {
-    return ExecuteQuery(query_config_.update_execution_property(),
-                        {BindDataType(value), BindValue(value),
-                         Bind(execution_id), Bind(name)});
+    return ExecutePreparedQuery(
+        query_config_.update_execution_property(),
+        {BindPreparedDataType(value), BindPreparedValue(value),
+         BindPrepared(execution_id), BindPrepared(name)});
   }
 
   absl::Status DeleteExecutionProperty(int64 execution_id,
                                        const absl::string_view name) final {
-    return ExecuteQuery(query_config_.delete_execution_property(),
-                        {Bind(execution_id), Bind(name)});
+    return ExecutePreparedQuery(
+        query_config_.delete_execution_property(),
+        {BindPrepared(execution_id), BindPrepared(name)});
+  }
+
+  absl::Status DeleteExecutionProperties(
+      absl::Span<const NodePropertyName> property_names) final {
+    return DeleteNodeProperties(query_config_.delete_execution_property(),
+                                property_names);
+  }
+
+  absl::Status SelectExecutionIDsByTypeIDUpdatedBefore(
+      const int64 execution_type_id, const int64 last_update_time_since_epoch,
+      const int64 limit, RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_execution_ids_by_type_id_updated_before(),
+        {BindPrepared(execution_type_id),
+         BindPrepared(last_update_time_since_epoch), BindPrepared(limit)},
+        record_set);
+  }
+
+  absl::Status DeleteExecutionsById(
+      const absl::Span<const int64> execution_ids) final {
+    return ExecutePreparedQuery(query_config_.delete_executions_by_id(),
+                                {BindPrepared(execution_ids)});
+  }
+
+  absl::Status DeleteExecutionsPropertiesByExecutionsId(
+      const absl::Span<const int64> execution_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_executions_properties_by_executions_id(),
+        {BindPrepared(execution_ids)});
+  }
+
+  absl::Status DeleteEventsByExecutionsId(
+      const absl::Span<const int64> execution_ids) final {
+    return ExecutePreparedQuery(query_config_.delete_events_by_executions_id(),
+                                {BindPrepared(execution_ids)});
+  }
+
+  absl::Status DeleteEventPathsByExecutionsId(
+      const absl::Span<const int64> execution_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_event_paths_by_executions_id(),
+        {BindPrepared(execution_ids)});
+  }
+
+  absl::Status DeleteAssociationsByExecutionsId(
+      const absl::Span<const int64> execution_ids) final {
+    return ExecutePreparedQuery(
+        query_config_.delete_associations_by_executions_id(),
+        {BindPrepared(execution_ids)});
   }
 
   absl::Status CheckContextTable() final {
@@ -299,17 +604,34 @@ class QueryConfigExecutor : public QueryExecutor {
                              const absl::Time create_time,
                              const absl::Time update_time,
                              int64* context_id) final {
-    return ExecuteQuerySelectLastInsertID(
+    return ExecutePreparedQuerySelectLastInsertID(
         query_config_.insert_context(),
-        {Bind(type_id), Bind(name), Bind(absl::ToUnixMillis(create_time)),
-         Bind(absl::ToUnixMillis(update_time))},
+        {BindPrepared(type_id), BindPrepared(name),
+         BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(absl::ToUnixMillis(update_time))},
         context_id);
   }
 
+  absl::Status InsertContexts(absl::Span<const Context> contexts,
+                              absl::Time create_time, absl::Time update_time,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status InsertContextIfNotExist(int64 type_id, const std::string& name,
+                                       absl::Time create_time,
+                                       absl::Time update_time,
+                                       int64* context_id,
+                                       bool* inserted) final;
+
   absl::Status SelectContextsByID(const absl::Span<const int64> context_ids,
                                   RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_context_by_id(),
-                        {Bind(context_ids)}, record_set);
+    return ExecutePreparedQuery(query_config_.select_context_by_id(),
+                                {BindPrepared(context_ids)}, record_set);
+  }
+
+  absl::Status SelectContextsByID(const absl::Span<const int64> context_ids,
+                                  TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_context_by_id(),
+                                {BindPrepared(context_ids)}, record_set);
   }
 
   absl::Status SelectContextsByTypeID(int64 context_type_id,
@@ -318,6 +640,9 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(context_type_id)}, record_set);
   }
 
+  absl::Status CountContexts(absl::optional<int64> context_type_id,
+                             RecordSet* record_set) final;
+
   absl::Status SelectContextByTypeIDAndContextName(
       int64 context_type_id, const absl::string_view name,
       RecordSet* record_set) final {
@@ -325,6 +650,14 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(context_type_id), Bind(name)}, record_set);
   }
 
+  absl::Status SelectContextsByTypeIDAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_contexts_by_type_id_and_names(),
+        {BindPrepared(context_type_id), BindPrepared(names)}, record_set);
+  }
+
   absl::Status UpdateContextDirect(int64 existing_context_id, int64 type_id,
                                    const std::string& context_name,
                                    const absl::Time update_time) final {
@@ -334,6 +667,17 @@ class QueryConfigExecutor : public QueryExecutor {
          Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateContextDirectIfUnchanged(
+      int64 existing_context_id, int64 type_id,
+      const std::string& context_name, const absl::Time update_time,
+      int64 expected_update_time, bool* updated) final {
+    return ExecuteConditionalUpdate(
+        query_config_.update_context_if_unchanged(),
+        {Bind(existing_context_id), Bind(type_id), Bind(context_name),
+         Bind(absl::ToUnixMillis(update_time)), Bind(expected_update_time)},
+        updated);
+  }
+
   absl::Status CheckContextPropertyTable() final {
     return ExecuteQuery(query_config_.check_context_property_table());
   }
@@ -342,30 +686,80 @@ class QueryConfigExecutor : public QueryExecutor {
                                      const absl::string_view name,
                                      bool custom_property,
                                      const Value& value) final {
-    return ExecuteQuery(query_config_.insert_context_property(),
-                        {BindDataType(value), Bind(context_id), Bind(name),
-                         Bind(custom_property), BindValue(value)});
+    return ExecutePreparedQuery(
+        query_config_.insert_context_property(),
+        {BindPreparedDataType(value), BindPrepared(context_id),
+         BindPrepared(name), BindPrepared(custom_property),
+         BindPreparedValue(value)});
+  }
+
+  absl::Status InsertContextProperties(
+      absl::Span<const NodeProperty> properties) final {
+    return InsertNodeProperties(query_config_.insert_context_property(),
+                                properties);
   }
 
   absl::Status SelectContextPropertyByContextID(
       const absl::Span<const int64> context_ids, RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_context_property_by_context_id(),
-                        {Bind(context_ids)}, record_set);
+    return ExecutePreparedQuery(
+        query_config_.select_context_property_by_context_id(),
+        {BindPrepared(context_ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectContextPropertyByContextID(
+      const absl::Span<const int64> context_ids,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_context_property_by_context_id(),
+        {BindPrepared(context_ids), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectContextPropertyByContextIDAndName(
+      const absl::Span<const int64> context_ids,
+      const absl::Span<const std::string> names,
+      TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_context_property_by_context_id_and_name(),
+        {BindPrepared(context_ids), BindPreparedByteValueColumn(),
+         BindPrepared(names)},
+        record_set);
+  }
+
+  absl::Status SelectContextsWithPropertiesByID(
+      const absl::Span<const int64> context_ids,
+      const absl::Span<const std::string> property_names,
+      TypedRecordSet* record_set, TypedRecordSet* property_record_set) final {
+    return SelectNodesWithPropertiesByID(
+        query_config_.select_context_by_id(),
+        query_config_.select_context_with_properties_bytes_by_id(),
+        query_config_.select_context_property_by_context_id(),
+        query_config_.select_context_property_by_context_id_and_name(),
+        context_ids, property_names, record_set, property_record_set);
   }
 
   absl::Status UpdateContextProperty(int64 context_id,
                                      const absl::string_view property_name,
                                      const Value& property_value) final {
-    return ExecuteQuery(
+    return ExecutePreparedQuery(
         query_config_.update_context_property(),
-        {BindDataType(property_value), BindValue(property_value),
-         Bind(context_id), Bind(property_name)});
+        {BindPreparedDataType(property_value),
+         BindPreparedValue(property_value),
+         BindPrepared(context_id), BindPrepared(property_name)});
   }
 
   absl::Status DeleteContextProperty(
       const int64 context_id, const absl::string_view property_name) final {
-    return ExecuteQuery(query_config_.delete_context_property(),
-                        {Bind(context_id), Bind(property_name)});
+    return ExecutePreparedQuery(
+        query_config_.delete_context_property(),
+        {BindPrepared(context_id), BindPrepared(property_name)});
+  }
+
+  absl::Status DeleteContextProperties(
+      absl::Span<const NodePropertyName> property_names) final {
+    return DeleteNodeProperties(query_config_.delete_context_property(),
+                                property_names);
   }
 
   absl::Status CheckEventTable() final {
@@ -375,25 +769,31 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status InsertEvent(int64 artifact_id, int64 execution_id,
                            int event_type, int64 event_time_milliseconds,
                            int64* event_id) final {
-    return ExecuteQuerySelectLastInsertID(
+    return ExecutePreparedQuerySelectLastInsertID(
         query_config_.insert_event(),
-        {Bind(artifact_id), Bind(execution_id), Bind(event_type),
-         Bind(event_time_milliseconds)},
+        {BindPrepared(artifact_id), BindPrepared(execution_id),
+         BindPrepared(int64{event_type}),
+         BindPrepared(event_time_milliseconds)},
         event_id);
   }
 
+  absl::Status InsertEvents(absl::Span<const Event> events,
+                            int64 default_event_time_milliseconds,
+                            std::vector<int64>* event_ids) final;
+
   absl::Status SelectEventByArtifactIDs(
       const absl::Span<const int64> artifact_ids,
       RecordSet* event_record_set) final {
-    return ExecuteQuery(query_config_.select_event_by_artifact_ids(),
-                        {Bind(artifact_ids)}, event_record_set);
+    return ExecutePreparedQuery(query_config_.select_event_by_artifact_ids(),
+                                {BindPrepared(artifact_ids)}, event_record_set);
   }
 
   absl::Status SelectEventByExecutionIDs(
       const absl::Span<const int64> execution_ids,
       RecordSet* event_record_set) final {
-    return ExecuteQuery(query_config_.select_event_by_execution_ids(),
-                        {Bind(execution_ids)}, event_record_set);
+    return ExecutePreparedQuery(
+        query_config_.select_event_by_execution_ids(),
+        {BindPrepared(execution_ids)}, event_record_set);
   }
 
   absl::Status CheckEventPathTable() final {
@@ -403,10 +803,192 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status InsertEventPath(int64 event_id,
                                const Event::Path::Step& step) final;
 
+  absl::Status InsertEventPaths(absl::Span<const int64> event_ids,
+                                absl::Span<const Event> events) final;
+
   absl::Status SelectEventPathByEventIDs(
       const absl::Span<const int64> event_ids, RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_event_path_by_event_ids(),
-                        {Bind(event_ids)}, record_set);
+    return ExecutePreparedQuery(query_config_.select_event_path_by_event_ids(),
+                                {BindPrepared(event_ids)}, record_set);
+  }
+
+  absl::Status SelectEventsWithPathsByArtifactIDs(
+      const absl::Span<const int64> artifact_ids,
+      const absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set, RecordSet* path_record_set) final {
+    if (inline_event_paths_) {
+      return SelectEventsWithInlinePaths(
+          event_types.empty()
+              ? query_config_.select_event_with_path_by_artifact_ids()
+              : query_config_
+                    .select_event_with_path_by_artifact_ids_and_types(),
+          artifact_ids, event_types, event_record_set, path_record_set);
+    }
+    if (event_types.empty()) {
+      return SelectEventsWithPaths(
+          query_config_.select_event_by_artifact_ids(),
+          query_config_.select_event_path_by_artifact_ids(), artifact_ids,
+          event_types, event_record_set, path_record_set);
+    }
+    return SelectEventsWithPaths(
+        query_config_.select_event_by_artifact_ids_and_types(),
+        query_config_.select_event_path_by_artifact_ids_and_types(),
+        artifact_ids, event_types, event_record_set, path_record_set);
+  }
+
+  absl::Status SelectEventsWithPathsByExecutionIDs(
+      const absl::Span<const int64> execution_ids,
+      const absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set, RecordSet* path_record_set) final {
+    if (inline_event_paths_) {
+      return SelectEventsWithInlinePaths(
+          event_types.empty()
+              ? query_config_.select_event_with_path_by_execution_ids()
+              : query_config_
+                    .select_event_with_path_by_execution_ids_and_types(),
+          execution_ids, event_types, event_record_set, path_record_set);
+    }
+    if (event_types.empty()) {
+      return SelectEventsWithPaths(
+          query_config_.select_event_by_execution_ids(),
+          query_config_.select_event_path_by_execution_ids(), execution_ids,
+          event_types, event_record_set, path_record_set);
+    }
+    return SelectEventsWithPaths(
+        query_config_.select_event_by_execution_ids_and_types(),
+        query_config_.select_event_path_by_execution_ids_and_types(),
+        execution_ids, event_types, event_record_set, path_record_set);
+  }
+
+  absl::Status CheckEventPathBytesColumn() final {
+    return ExecuteQuery(query_config_.check_event_path_bytes_column());
+  }
+
+  absl::Status AddEventPathBytesColumn() final;
+
+  void SetInlineEventPaths(const bool inline_event_paths) final {
+    inline_event_paths_ = inline_event_paths;
+  }
+
+  bool InlinesEventPaths() const final { return inline_event_paths_; }
+
+  absl::Status SelectEventIDsWithPathSteps(const int64 max_num_events,
+                                           RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_event_ids_with_path_steps(),
+        {BindPrepared(max_num_events)}, record_set);
+  }
+
+  absl::Status UpdateEventPathBytes(int64 event_id,
+                                    const Event::Path& path) final;
+
+  absl::Status DeleteEventPathsByEventIDs(
+      const absl::Span<const int64> event_ids) final {
+    return ExecutePreparedQuery(query_config_.delete_event_paths_by_event_ids(),
+                                {BindPrepared(event_ids)});
+  }
+
+  absl::Status CheckNodePropertiesBytesColumns() final {
+    return ExecuteQuery(query_config_.check_node_properties_bytes_columns());
+  }
+
+  absl::Status AddNodePropertiesBytesColumns() final;
+
+  void SetInlineNodeProperties(const bool inline_node_properties) final {
+    inline_node_properties_ = inline_node_properties;
+  }
+
+  bool InlinesNodeProperties() const final { return inline_node_properties_; }
+
+  void SetWriteNodePropertiesBytes(
+      const bool write_node_properties_bytes) final {
+    write_node_properties_bytes_ = write_node_properties_bytes;
+  }
+
+  bool WritesNodePropertiesBytes() const final {
+    return write_node_properties_bytes_;
+  }
+
+  absl::Status SelectArtifactIDsWithoutPropertiesBytes(
+      const int64 max_num_nodes, RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_ids_without_properties_bytes(),
+        {BindPrepared(max_num_nodes)}, record_set);
+  }
+
+  absl::Status SelectExecutionIDsWithoutPropertiesBytes(
+      const int64 max_num_nodes, RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_execution_ids_without_properties_bytes(),
+        {BindPrepared(max_num_nodes)}, record_set);
+  }
+
+  absl::Status SelectContextIDsWithoutPropertiesBytes(
+      const int64 max_num_nodes, RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_context_ids_without_properties_bytes(),
+        {BindPrepared(max_num_nodes)}, record_set);
+  }
+
+  absl::Status UpdateArtifactPropertiesBytes(int64 artifact_id,
+                                             const Artifact& artifact) final;
+
+  absl::Status UpdateExecutionPropertiesBytes(
+      int64 execution_id, const Execution& execution) final;
+
+  absl::Status UpdateContextPropertiesBytes(int64 context_id,
+                                            const Context& context) final;
+
+  absl::Status CheckIdempotencyKeyTable() final {
+    return ExecuteQuery(query_config_.check_idempotency_key_table());
+  }
+
+  absl::Status CreateIdempotencyKeyTable() final {
+    return ExecuteQuery(query_config_.create_idempotency_key_table());
+  }
+
+  absl::Status SelectIdempotencyKey(absl::string_view idempotency_key,
+                                    RecordSet* record_set) final;
+
+  absl::Status InsertIdempotencyKey(absl::string_view idempotency_key,
+                                    int64 request_fingerprint,
+                                    absl::Time create_time,
+                                    absl::string_view response) final;
+
+  absl::Status SelectIdempotencyKeysCreatedBefore(
+      const absl::Time create_time, const int64 max_num_keys,
+      RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_idempotency_keys_created_before(),
+        {BindPrepared(absl::ToUnixMillis(create_time)),
+         BindPrepared(max_num_keys)},
+        record_set);
+  }
+
+  absl::Status DeleteIdempotencyKeys(
+      const absl::Span<const std::string> idempotency_keys) final {
+    return ExecutePreparedQuery(query_config_.delete_idempotency_keys(),
+                                {BindPrepared(idempotency_keys)});
+  }
+
+  absl::Status CheckLineageClosureTable() final {
+    return ExecuteQuery(query_config_.check_lineage_closure_table());
+  }
+
+  absl::Status CreateLineageClosureTable() final {
+    return ExecuteQuery(query_config_.create_lineage_closure_table());
+  }
+
+  absl::Status InsertLineageClosureIfNotExist(
+      absl::Span<const std::array<int64, 3>> rows) final;
+
+  absl::Status SelectLineageClosure(const absl::Span<const int64> artifact_ids,
+                                    const int64 direction,
+                                    RecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_lineage_closure(),
+                                {BindPrepared(artifact_ids),
+                                 BindPrepared(direction)},
+                                record_set);
   }
 
   absl::Status CheckAssociationTable() final {
@@ -415,56 +997,139 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status InsertAssociation(int64 context_id, int64 execution_id,
                                  int64* association_id) final {
-    return ExecuteQuerySelectLastInsertID(
+    return ExecutePreparedQuerySelectLastInsertID(
         query_config_.insert_association(),
-        {Bind(context_id), Bind(execution_id)}, association_id);
+        {BindPrepared(context_id), BindPrepared(execution_id)}, association_id);
   }
 
+  absl::Status InsertAssociationsIfNotExist(
+      absl::Span<const Association> associations) final;
+
   absl::Status SelectAssociationByContextID(int64 context_id,
                                             RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_context_id(),
                         {Bind(context_id)}, record_set);
   }
 
+  absl::Status SelectAssociationsByContextIDs(
+      const absl::Span<const int64> context_ids,
+      RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_associations_by_context_ids(),
+        {BindPrepared(context_ids)}, record_set);
+  }
+
   absl::Status SelectAssociationByExecutionID(int64 execution_id,
                                               RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_execution_id(),
                         {Bind(execution_id)}, record_set);
   }
 
+  absl::Status SelectAssociationsByExecutionIDs(
+      const absl::Span<const int64> execution_ids,
+      RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_associations_by_execution_ids(),
+        {BindPrepared(execution_ids)}, record_set);
+  }
+
   absl::Status CheckAttributionTable() final {
     return ExecuteQuery(query_config_.check_attribution_table());
   }
 
   absl::Status InsertAttributionDirect(int64 context_id, int64 artifact_id,
                                        int64* attribution_id) final {
-    return ExecuteQuerySelectLastInsertID(query_config_.insert_attribution(),
-                                          {Bind(context_id), Bind(artifact_id)},
-                                          attribution_id);
+    return ExecutePreparedQuerySelectLastInsertID(
+        query_config_.insert_attribution(),
+        {BindPrepared(context_id), BindPrepared(artifact_id)}, attribution_id);
   }
 
+  absl::Status InsertAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) final;
+
   absl::Status SelectAttributionByContextID(int64 context_id,
                                             RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_attribution_by_context_id(),
                         {Bind(context_id)}, record_set);
   }
 
+  absl::Status SelectAttributionsByContextIDs(
+      const absl::Span<const int64> context_ids,
+      RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_attributions_by_context_ids(),
+        {BindPrepared(context_ids)}, record_set);
+  }
+
   absl::Status SelectAttributionByArtifactID(int64 artifact_id,
                                              RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_attribution_by_artifact_id(),
                         {Bind(artifact_id)}, record_set);
   }
 
+  absl::Status SelectAttributionsByArtifactIDs(
+      const absl::Span<const int64> artifact_ids,
+      RecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_attributions_by_artifact_ids(),
+        {BindPrepared(artifact_ids)}, record_set);
+  }
+
+  absl::Status SelectArtifactsByContextID(int64 context_id,
+                                          TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_artifacts_by_context_id(),
+                                {BindPrepared(context_id)}, record_set);
+  }
+
+  absl::Status SelectArtifactPropertyByContextID(
+      int64 context_id, TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_artifact_property_by_context_id(),
+        {BindPrepared(context_id), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
+  absl::Status SelectContextsByArtifactID(int64 artifact_id,
+                                          TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(query_config_.select_contexts_by_artifact_id(),
+                                {BindPrepared(artifact_id)}, record_set);
+  }
+
+  absl::Status SelectContextPropertyByArtifactID(
+      int64 artifact_id, TypedRecordSet* record_set) final {
+    return ExecutePreparedQuery(
+        query_config_.select_context_property_by_artifact_id(),
+        {BindPrepared(artifact_id), BindPreparedByteValueColumn()},
+        record_set);
+  }
+
   absl::Status CheckParentContextTable() final;
 
   absl::Status InsertParentContext(int64 parent_id, int64 child_id) final;
 
+  absl::Status InsertParentContexts(
+      absl::Span<const ParentContext> parent_contexts) final;
+
   absl::Status SelectParentContextsByContextID(int64 context_id,
                                                RecordSet* record_set) final;
 
   absl::Status SelectChildContextsByContextID(int64 context_id,
                                               RecordSet* record_set) final;
 
+  absl::Status SelectAncestorContextsByContextID(int64 context_id,
+                                                 int64 max_level,
+                                                 RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_ancestor_contexts_by_context_id(),
+                        {Bind(context_id), Bind(max_level)}, record_set);
+  }
+
+  absl::Status SelectDescendantContextsByContextID(
+      int64 context_id, int64 max_level, RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_descendant_contexts_by_context_id(),
+        {Bind(context_id), Bind(max_level)}, record_set);
+  }
+
   absl::Status CheckMLMDEnvTable() final {
     return ExecuteQuery(query_config_.check_mlmd_env_table());
   }
@@ -495,13 +1160,69 @@ class QueryConfigExecutor : public QueryExecutor {
     return ExecuteQuery("select `id` from `Context`;", set);
   }
 
+  absl::Status SelectAllArtifactIDs(const RecordBatchCallback& callback) final {
+    return metadata_source_->ExecuteStreamingQuery(
+        "select `id` from `Artifact`;", kNodeStreamingBatchSize, callback);
+  }
+
+  absl::Status SelectAllExecutionIDs(
+      const RecordBatchCallback& callback) final {
+    return metadata_source_->ExecuteStreamingQuery(
+        "select `id` from `Execution`;", kNodeStreamingBatchSize, callback);
+  }
+
+  absl::Status SelectAllContextIDs(const RecordBatchCallback& callback) final {
+    return metadata_source_->ExecuteStreamingQuery(
+        "select `id` from `Context`;", kNodeStreamingBatchSize, callback);
+  }
+
+  absl::Status SelectArtifactIDsUpdatedAfter(
+      const int64 last_update_time_since_epoch, const int64 id,
+      const RecordBatchCallback& callback) final {
+    return SelectNodeIDsUpdatedAfter("Artifact", last_update_time_since_epoch,
+                                     id, callback);
+  }
+
+  absl::Status SelectExecutionIDsUpdatedAfter(
+      const int64 last_update_time_since_epoch, const int64 id,
+      const RecordBatchCallback& callback) final {
+    return SelectNodeIDsUpdatedAfter("Execution", last_update_time_since_epoch,
+                                     id, callback);
+  }
+
+  absl::Status SelectContextIDsUpdatedAfter(
+      const int64 last_update_time_since_epoch, const int64 id,
+      const RecordBatchCallback& callback) final {
+    return SelectNodeIDsUpdatedAfter("Context", last_update_time_since_epoch,
+                                     id, callback);
+  }
+
   int64 GetLibraryVersion() final {
     CHECK_GT(query_config_.schema_version(), 0);
     return query_config_.schema_version();
   }
 
+  bool HasIdListTable() const final {
+    return query_config_.has_create_id_list_table();
+  }
+
   absl::Status DowngradeMetadataSource(const int64 to_schema_version) final;
 
+  absl::Status MigrateSchemaStep(int64 to_schema_version, int64 max_num_chunks,
+                                 SchemaMigrationProgress* progress) final;
+
+  absl::Status DropSecondaryIndices() final;
+
+  absl::Status CreateSecondaryIndices() final;
+
+  absl::Status SelectEventPartitionBounds(RecordSet* record_set) final;
+
+  absl::Status PartitionEventTables() final;
+
+  absl::Status AddEventPartition(int64 upper_bound) final;
+
+  absl::Status DropEventPartition(int64 upper_bound) final;
+
   absl::Status ListArtifactIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
@@ -572,6 +1293,51 @@ class QueryConfigExecutor : public QueryExecutor {
   std::string Bind(const google::protobuf::int64 value);
   #endif
 
+  // A parameter of a template query executed as a prepared statement. Its
+  // `values` are bound to comma separated `?` placeholders at the position of
+  // the parameter, unless it is a `sql_fragment` (e.g., a column name) which is
+  // inlined to the statement text. The `values` of an `is_id_list` parameter
+  // are the ids of an IN(...) list, which may be loaded into the IdList table.
+  struct PreparedParameter {
+    absl::optional<std::string> sql_fragment;
+    std::vector<PreparedStatementValue> values;
+    bool is_id_list = false;
+  };
+
+  // Utility methods to bind values to a prepared statement.
+  template <typename T>
+  PreparedParameter BindPrepared(const absl::optional<T>& v) {
+    return v ? BindPrepared(v.value())
+             : PreparedParameter{absl::nullopt, {absl::monostate()}};
+  }
+  PreparedParameter BindPrepared(absl::string_view value);
+  PreparedParameter BindPrepared(int64 value);
+  PreparedParameter BindPrepared(bool value);
+  PreparedParameter BindPrepared(double value);
+  PreparedParameter BindPrepared(Artifact::State value);
+  PreparedParameter BindPrepared(Execution::State value);
+  PreparedParameter BindPreparedValue(const Value& value);
+  PreparedParameter BindPreparedDataType(const Value& value);
+
+  // Binds the `byte_value` column of the property tables to the selected
+  // columns of a property query.
+  PreparedParameter BindPreparedByteValueColumn();
+
+  // Utility method to bind an int64 vector to the placeholders of a SQL
+  // IN(...) clause. The list is padded by repeating its last id, to a power of
+  // two size up to 256 ids and to a multiple of 64 ids above, so that a query
+  // only has a few distinct prepared statements.
+  // A list of at least kMinIdsForIdListTable ids is loaded into the IdList
+  // table when the query is executed, if the query config has one.
+  PreparedParameter BindPrepared(absl::Span<const int64> value);
+
+  // Same as above, but binds a list of strings, e.g., property names.
+  PreparedParameter BindPrepared(absl::Span<const std::string> value);
+
+  #if (!defined(__APPLE__) && !defined(_WIN32))
+  PreparedParameter BindPrepared(const google::protobuf::int64 value);
+  #endif
+
   // Execute a template query. All strings in parameters should already be
   // in a format appropriate for the SQL variant being used (at this point,
   // they are just inserted).
@@ -605,6 +1371,186 @@ class QueryConfigExecutor : public QueryExecutor {
     return ExecuteQuery(query, {});
   }
 
+  // Execute a template query as a prepared statement. The `$i` in the query
+  // are replaced with the placeholders or fragments of `parameters[i]`. The
+  // metadata source caches the statement for the connection.
+  // Results consist of zero or more rows represented in RecordSet, which can
+  // be nullptr if the results are not needed.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::Status ExecutePreparedQuery(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const PreparedParameter> parameters,
+      RecordSet* record_set = nullptr);
+
+  // Same as above, but the results are represented in TypedRecordSet.
+  absl::Status ExecutePreparedQuery(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const PreparedParameter> parameters,
+      TypedRecordSet* record_set);
+
+  // A template query and its parameters, see ExecutePipelinedQueries.
+  struct PipelinedTemplateQuery {
+    const MetadataSourceQueryConfig::TemplateQuery& template_query;
+    std::vector<PreparedParameter> parameters;
+  };
+
+  // Executes template queries as prepared statements, which are pipelined by
+  // the metadata source, see MetadataSource::ExecutePipelinedQueries, and
+  // returns the results of `queries[i]` in `record_sets[i]`. The queries bind
+  // the same id lists, as the IdList table holds one of them at a time. If
+  // a query has too many values to bind them, the queries are run one after
+  // the other by ExecutePreparedQuery. Each query is recorded with the
+  // latency of the whole pipeline.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::Status ExecutePipelinedQueries(
+      absl::Span<const PipelinedTemplateQuery> queries,
+      absl::Span<TypedRecordSet* const> record_sets);
+
+  // Selects the nodes of `ids` with `select_nodes`, and their properties with
+  // `select_properties`, or with `select_properties_by_name` if
+  // `property_names` is not empty, in one pipeline. If the properties are
+  // inlined and all of them are selected, the nodes are selected with their
+  // `properties_bytes` column by `select_nodes_with_properties_bytes` instead,
+  // and `property_record_set` only has the properties of the nodes whose
+  // column is NULL.
+  absl::Status SelectNodesWithPropertiesByID(
+      const MetadataSourceQueryConfig::TemplateQuery& select_nodes,
+      const MetadataSourceQueryConfig::TemplateQuery&
+          select_nodes_with_properties_bytes,
+      const MetadataSourceQueryConfig::TemplateQuery& select_properties,
+      const MetadataSourceQueryConfig::TemplateQuery& select_properties_by_name,
+      absl::Span<const int64> ids, absl::Span<const std::string> property_names,
+      TypedRecordSet* record_set, TypedRecordSet* property_record_set);
+
+  // Returns the parameters of the event queries of `ids`, which also bind the
+  // `event_types` if they are not empty.
+  std::vector<PreparedParameter> BindEventQuery(
+      absl::Span<const int64> ids, absl::Span<const Event::Type> event_types);
+
+  // Selects the events of `ids` with `select_events`, and their paths with
+  // `select_paths`, in one pipeline. If `event_types` is not empty, the
+  // queries take them as their second parameter.
+  absl::Status SelectEventsWithPaths(
+      const MetadataSourceQueryConfig::TemplateQuery& select_events,
+      const MetadataSourceQueryConfig::TemplateQuery& select_paths,
+      absl::Span<const int64> ids, absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set, RecordSet* path_record_set);
+
+  // Selects the events of `ids` with their `path_bytes` column with
+  // `select_events`, and clears the `path_record_set`. If `event_types` is
+  // not empty, the query takes them as its second parameter.
+  absl::Status SelectEventsWithInlinePaths(
+      const MetadataSourceQueryConfig::TemplateQuery& select_events,
+      absl::Span<const int64> ids, absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set, RecordSet* path_record_set);
+
+  // Returns the parameters of a template query run without preparing it, in
+  // which the values are inlined as SQL literals.
+  std::vector<std::string> InlinePreparedParameters(
+      absl::Span<const PreparedParameter> parameters);
+
+  // Expands a template query to a `query`, in which the `$i` are replaced
+  // with `parameters[i]`.
+  // Returns INVALID_ARGUMENT error, if there are too many parameters.
+  absl::Status ComposeParameterizedQuery(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const std::string> parameters, std::string* query);
+
+  // Expands a template query to a prepared `statement`, and collects the
+  // `values` bound to its placeholders in order.
+  // Returns INVALID_ARGUMENT error, if there are too many parameters.
+  absl::Status BuildPreparedStatement(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const PreparedParameter> parameters, std::string* statement,
+      std::vector<PreparedStatementValue>* values);
+
+  // Executes an `INSERT ... VALUES(...)` template query for each of `rows`,
+  // with multi-row statements of at most kMaxNumPreparedStatementValues
+  // values. The SQL fragments of the parameters must be the same for all the
+  // rows. If `inserted_ids` is not null, returns the ids of the inserted rows
+  // in the order of `rows`. In PostgreSQL, the ids are returned by the
+  // statements, and the rows without ids are inserted with COPY, unless the
+  // template ends with an ON CONFLICT clause, which is kept once at the end
+  // of each statement. Otherwise they are derived from the last insert id,
+  // and the rows are inserted one by one if the ids of a statement may not
+  // be evenly spaced, see GetInsertedIdStep.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::Status ExecutePreparedMultiRowInsert(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const std::vector<PreparedParameter>> rows,
+      std::vector<int64>* inserted_ids);
+
+  // Sets `step` to the step between the ids of the rows inserted by one
+  // multi-row statement, or to 0 if they may not be evenly spaced, e.g., with
+  // innodb_autoinc_lock_mode = 2 in MySQL. The settings are queried once.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetInsertedIdStep(int64* step);
+
+  // Inserts `rows` with MetadataSource::ExecuteBulkInsert, for the
+  // `insert_clause` and `values_clause` of an `INSERT ... VALUES(...)`
+  // template query, see ExecutePreparedMultiRowInsert.
+  // Returns UNIMPLEMENTED error, if the clauses are not a plain insertion of
+  //   a value into each column, or the metadata source has no bulk insert.
+  absl::Status ExecuteBulkInsert(
+      const MetadataSourceQueryConfig::TemplateQuery& insert_clause,
+      const MetadataSourceQueryConfig::TemplateQuery& values_clause,
+      absl::Span<const std::vector<PreparedParameter>> rows);
+
+  // Inserts `properties` with an insert property template query, which takes
+  // the data type column, the node id, the name, is_custom_property and the
+  // value as parameters.
+  absl::Status InsertNodeProperties(
+      const MetadataSourceQueryConfig::TemplateQuery& insert_property,
+      absl::Span<const NodeProperty> properties);
+
+  // Executes a `DELETE ... WHERE ...` template query for each of `rows`, with
+  // statements whose WHERE clause is the disjunction of the conditions of at
+  // most kMaxNumPreparedStatementValues values.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::Status ExecutePreparedMultiRowDelete(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const std::vector<PreparedParameter>> rows);
+
+  // Deletes the properties of `property_names` with a delete property template
+  // query, which takes the node id and the name as parameters.
+  absl::Status DeleteNodeProperties(
+      const MetadataSourceQueryConfig::TemplateQuery& delete_property,
+      absl::Span<const NodePropertyName> property_names);
+
+  // Loads the ids of the first id list of `parameters` into the IdList table,
+  // if the query config has one and the list has at least
+  // kMinIdsForIdListTable ids. The parameters are then copied to
+  // `loaded_parameters`, where the list is replaced with the selection of the
+  // ids of the table, and `parameters` points to them. The table is not
+  // loaded again if it holds the same ids, and was loaded in the current
+  // transaction, as the rollback of a transaction also rolls back the table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status LoadIdListTable(
+      absl::Span<const PreparedParameter>& parameters,
+      std::vector<PreparedParameter>& loaded_parameters);
+
+  // Execute a template query as a prepared statement and returns the id of
+  // the inserted row.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INTERNAL error, if it cannot find the last insert ID.
+  absl::Status ExecutePreparedQuerySelectLastInsertID(
+      const MetadataSourceQueryConfig::TemplateQuery& query,
+      const absl::Span<const PreparedParameter> parameters,
+      int64* last_insert_id) {
+    MLMD_RETURN_IF_ERROR(ExecutePreparedQuery(query, parameters));
+    return SelectLastInsertID(last_insert_id);
+  }
+
   // Execute a template query without arguments and ignore the result.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -617,6 +1563,15 @@ class QueryConfigExecutor : public QueryExecutor {
     return SelectLastInsertID(last_insert_id);
   }
 
+  // Executes a conditional UPDATE template query and sets `updated` to whether
+  // it changed a row. The count is read from the query result, if the query
+  // returns one, and from select_num_changed_rows otherwise.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns INTERNAL error, if it cannot find the number of changed rows.
+  absl::Status ExecuteConditionalUpdate(
+      const MetadataSourceQueryConfig::TemplateQuery& query,
+      const absl::Span<const std::string> arguments, bool* updated);
+
   // Execute a query without arguments.
   // Results consist of zero or more rows represented in RecordSet.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
@@ -655,6 +1610,14 @@ class QueryConfigExecutor : public QueryExecutor {
   // TODO(martinz): consider promoting to MetadataAccessObject.
   absl::Status UpgradeMetadataSourceIfOutOfDate(bool enable_migration);
 
+  // Finishes the migration scheme of `to_version` from `db_version`: it runs
+  // the downgrade_queries of a downgrade, sets the schema version, and
+  // deletes the checkpoint of the chunked queries if `has_chunked_queries`.
+  absl::Status FinishMigrationScheme(
+      int64 db_version, int64 to_version,
+      const MetadataSourceQueryConfig::MigrationScheme& migration_scheme,
+      bool has_chunked_queries);
+
   // List Node IDs using `options` and `candidate_ids`. Template parameter
   // `Node` specifies the table to use for listing. If `candidate_ids` is not
   // empty then result set is constructed using only ids specified in
@@ -666,10 +1629,114 @@ class QueryConfigExecutor : public QueryExecutor {
       absl::optional<absl::Span<const int64>> candidate_ids,
       RecordSet* record_set);
 
+  // Counts the rows of `table` matching all the `conditions`, e.g.,
+  // "`type_id` = 1". If a condition is on an indexed column, e.g., the type_id
+  // which prefixes the unique (type_id, name) index, the count is computed
+  // from the index.
+  absl::Status CountRows(absl::string_view table,
+                         absl::Span<const std::string> conditions,
+                         RecordSet* record_set);
+
+  // Streams the ids of the rows of the node `table` updated after the
+  // watermark. The range condition is on last_update_time_since_epoch alone,
+  // so that it is a range of its index, which the SQLite and InnoDB indices
+  // order by the primary key within a time, and the id is a filter of the
+  // range.
+  absl::Status SelectNodeIDsUpdatedAfter(absl::string_view table,
+                                         int64 last_update_time_since_epoch,
+                                         int64 id,
+                                         const RecordBatchCallback& callback);
+
+  // Aggregates a property over the nodes of `type_id` of `node_table`, whose
+  // properties are in `property_table` and whose links to the contexts are in
+  // `link_table`, with the `node_id_column`, and whose state is in
+  // `state_column`. The nodes are joined with their property on its primary
+  // key, so each node is counted once.
+  absl::Status AggregateNodeProperty(
+      absl::string_view node_table, absl::string_view property_table,
+      absl::string_view link_table, absl::string_view node_id_column,
+      absl::string_view state_column, int64 type_id,
+      const PropertyAggregationOptions& options, RecordSet* record_set);
+
+  // Appends a clause to `sql_query` which restricts the listed nodes to the
+  // ones matching `filter`, e.g., " `id` IN (SELECT `artifact_id` FROM
+  // `ArtifactProperty` WHERE `name` = 'p' AND `is_custom_property` = 0 AND
+  // `int_value` >= 1) AND ". `property_table` and `node_id_column` identify
+  // the property table of the listed nodes.
+  // Returns INVALID_ARGUMENT error, if the `filter` has no name or operator,
+  // or if its value is not an int, double or string.
+  absl::Status AppendPropertyFilterClause(
+      const ListOperationOptions::PropertyFilter& filter,
+      absl::string_view property_table, absl::string_view node_id_column,
+      std::string& sql_query);
+
+  // The metrics exported for the queries of a template, i.e., their latency
+  // and the number of rows they returned.
+  struct QueryMetrics {
+    std::string template_name;
+    Histogram* latency = nullptr;
+    Counter* rows = nullptr;
+  };
+
+  // Records a query in the metrics of its template and in a tracing span.
+  class ScopedQueryRecorder;
+
+  // Returns the metrics of the template with the given name.
+  static QueryMetrics GetQueryMetrics(absl::string_view template_name);
+
+  // Indexes the metrics of the template queries of `query_config_` by their
+  // addresses, so that the template of a query is found without comparing
+  // its text.
+  void InitQueryMetrics();
+
+  // Returns the metrics of `template_query`, which are the ones shared by the
+  // queries of no template of `query_config_` if it is not one of them.
+  const QueryMetrics& FindQueryMetrics(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query) const;
+
+  // Logs the slow query recorded by `recorder` in the slow query log, with the
+  // plan of the first slow query of its template if enabled. The `query` ran
+  // with the prepared statement `values`, if any, and is described by the
+  // redacted `description`.
+  void LogSlowQuery(const ScopedQueryRecorder& recorder,
+                    const std::string& query,
+                    absl::Span<const PreparedStatementValue> values,
+                    absl::string_view description);
+
   MetadataSourceQueryConfig query_config_;
 
   // This object does not own the MetadataSource.
   MetadataSource* metadata_source_;
+
+  // The metrics of the template queries of `query_config_`, and of the other
+  // queries, e.g., the composed list queries.
+  absl::flat_hash_map<const MetadataSourceQueryConfig::TemplateQuery*,
+                      QueryMetrics>
+      query_metrics_;
+  QueryMetrics other_query_metrics_;
+
+  // The sorted ids loaded into the IdList table, and the transaction of the
+  // metadata source in which they were loaded. They are loaded again after a
+  // rollback to a savepoint, which may have undone the load.
+  std::vector<int64> id_list_;
+  int64 id_list_transaction_ = -1;
+  int64 id_list_savepoint_rollbacks_ = 0;
+
+  // The step between the ids of the rows of a multi-row insert, once queried,
+  // see GetInsertedIdStep.
+  absl::optional<int64> inserted_id_step_;
+
+  // Whether the paths of the events are stored in the `path_bytes` column of
+  // the Event table, see SetInlineEventPaths.
+  bool inline_event_paths_ = false;
+
+  // Whether the properties of the nodes are read from the `properties_bytes`
+  // columns, see SetInlineNodeProperties.
+  bool inline_node_properties_ = false;
+
+  // Whether the `properties_bytes` columns are written on the property
+  // changes, see SetWriteNodePropertiesBytes.
+  bool write_node_properties_bytes_ = false;
 };
 
 }  // namespace ml_metadata
@@ -24,7 +24,7 @@ namespace ml_metadata {
 // The kSupportedEarlierQueryVersion can be the same with the current library
 // schema version or one schema version before hand. The latter is for
 // supporting migration for MLMD online services.
-static constexpr int64 kSupportedEarlierQueryVersion = 6;
+static constexpr int64 kSupportedEarlierQueryVersion = 9;
 
 QueryExecutor::QueryExecutor(absl::optional<int64> query_schema_version)
     : query_schema_version_(query_schema_version) {
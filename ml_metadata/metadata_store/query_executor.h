@@ -15,20 +15,40 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_QUERY_EXECUTOR_H_
 #define ML_METADATA_METADATA_STORE_QUERY_EXECUTOR_H_
 
+#include <array>
 #include <memory>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace ml_metadata {
 
+// A property of a node inserted in bulk, i.e., a row of the ArtifactProperty,
+// ExecutionProperty or ContextProperty table. The name and value are not
+// owned, and must outlive the insertion.
+struct NodeProperty {
+  int64 node_id;
+  absl::string_view name;
+  bool is_custom_property;
+  const Value* value;
+};
+
+// The key of a node property deleted in bulk. The name is not owned, and must
+// outlive the deletion.
+struct NodePropertyName {
+  int64 node_id;
+  absl::string_view name;
+};
+
 // A class wrapping a low-level interface to a database.
 // This contains both the queries and the method for executing them.
 // Most methods correspond to one or two queries, with a few exceptions
@@ -106,6 +126,55 @@ class QueryExecutor {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status DowngradeMetadataSource(int64 to_schema_version) = 0;
 
+  // Runs a step of the migration of the schema to `to_schema_version`, and
+  // returns its `progress`. A step either starts a migration scheme, which
+  // runs its upgrade_queries, runs at most `max_num_chunks` chunks of its
+  // chunked queries, or finishes it, which runs its downgrade_queries and
+  // sets the schema version. The progress of a scheme with chunked queries is
+  // checkpointed, so that each step can be committed in its own transaction,
+  // and the next step resumes from the checkpoint. The `progress` is done once
+  // the database is at `to_schema_version`.
+  // Returns INVALID_ARGUMENT, if `to_schema_version` is less than 0, or newer
+  //   than the library version.
+  // Returns FAILED_PRECONDITION, if db schema version is newer than the
+  //   library version.
+  // Returns NOT_FOUND error, if the database is empty.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status MigrateSchemaStep(
+      int64 to_schema_version, int64 max_num_chunks,
+      SchemaMigrationProgress* progress) = 0;
+
+  // Drops the secondary indices of the schema, e.g., to speed up a bulk load.
+  // The reads return the same results meanwhile, only slower.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status DropSecondaryIndices() = 0;
+
+  // Creates the secondary indices of the schema if they do not exist, e.g.,
+  // after DropSecondaryIndices.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateSecondaryIndices() = 0;
+
+  // Queries the upper bounds of the partitions of the Event table, as MAXVALUE
+  // for the last partition, which has no bound. There is no record, if the
+  // table is not partitioned.
+  // Returns UNIMPLEMENTED error, if the source does not partition events.
+  virtual absl::Status SelectEventPartitionBounds(RecordSet* record_set) = 0;
+
+  // Converts the Event and EventPath tables in place to partitioned tables,
+  // with a single partition of no bound.
+  // Returns UNIMPLEMENTED error, if the source does not partition events.
+  virtual absl::Status PartitionEventTables() = 0;
+
+  // Splits the partitions of `upper_bound` off the last partitions of the
+  // Event and EventPath tables. The existing partitions are skipped.
+  // Returns UNIMPLEMENTED error, if the source does not partition events.
+  virtual absl::Status AddEventPartition(int64 upper_bound) = 0;
+
+  // Drops the partitions of `upper_bound` of the Event and EventPath tables,
+  // along with their rows. The missing partitions are skipped.
+  // Returns UNIMPLEMENTED error, if the source does not partition events.
+  virtual absl::Status DropEventPartition(int64 upper_bound) = 0;
+
   // Resolves the schema version stored in the metadata source. The `db_version`
   // is set to 0, if it is a 0.13.2 release pre-existing database.
   // Returns DATA_LOSS error, if schema version info table exists but there is
@@ -125,6 +194,11 @@ class QueryExecutor {
   // needed.
   virtual int64 GetLibraryVersion() = 0;
 
+  // Returns true if the IN(...) lists of at least kMinIdsForIdListTable ids
+  // are loaded into a temporary table instead of being inlined into the
+  // queries, so that the callers do not need to split them.
+  virtual bool HasIdListTable() const { return false; }
+
   // Each of the following methods roughly corresponds to a query (or two).
   virtual absl::Status CheckTypeTable() = 0;
 
@@ -172,6 +246,18 @@ class QueryExecutor {
       const std::string& name, absl::optional<absl::string_view> version,
       absl::optional<absl::string_view> description, int64* type_id) = 0;
 
+  // Inserts a type of `type_kind` with the given `type_id`, instead of one
+  // assigned by the database. The other fields are as in the inserts above;
+  // `input_type` and `output_type` are null except for an ExecutionType.
+  // Returns detailed INTERNAL error, if query execution fails, e.g., if
+  //   `type_id` is taken.
+  virtual absl::Status InsertTypeWithID(
+      int64 type_id, TypeKind type_kind, const std::string& name,
+      absl::optional<absl::string_view> version,
+      absl::optional<absl::string_view> description,
+      const ArtifactStructType* input_type,
+      const ArtifactStructType* output_type) = 0;
+
   // Queries a type by its type id.
   // Returns a message that can be converted to an ArtifactType,
   // ContextType, or ExecutionType.
@@ -196,6 +282,21 @@ class QueryExecutor {
   virtual absl::Status SelectAllTypes(TypeKind type_kind,
                                       RecordSet* record_set) = 0;
 
+  // Queries the types of `type_kind` whose names are among `type_names`, of
+  // any version.
+  // Returns a message that can be converted to an ArtifactType,
+  // ContextType, or ExecutionType.
+  virtual absl::Status SelectTypesByNames(
+      absl::Span<const std::string> type_names, TypeKind type_kind,
+      RecordSet* record_set) = 0;
+
+  // Queries the types of `type_kind` whose ids are among `type_ids`.
+  // Returns a message that can be converted to an ArtifactType,
+  // ContextType, or ExecutionType.
+  virtual absl::Status SelectTypesByIDs(absl::Span<const int64> type_ids,
+                                        TypeKind type_kind,
+                                        RecordSet* record_set) = 0;
+
   // Checks the existence of the TypeProperty table.
   virtual absl::Status CheckTypePropertyTable() = 0;
 
@@ -209,6 +310,11 @@ class QueryExecutor {
   virtual absl::Status SelectPropertyByTypeID(int64 type_id,
                                               RecordSet* record_set) = 0;
 
+  // Queries the properties of the types of `type_ids` from the database.
+  // Returns a list of properties (type_id, name, data_type).
+  virtual absl::Status SelectPropertiesByTypeIDs(
+      absl::Span<const int64> type_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the ParentType table.
   virtual absl::Status CheckParentTypeTable() = 0;
 
@@ -224,6 +330,11 @@ class QueryExecutor {
   virtual absl::Status SelectParentTypesByTypeID(int64 type_id,
                                                  RecordSet* record_set) = 0;
 
+  // Returns the parent types of the types of `type_ids`, with the same
+  // columns as SelectParentTypesByTypeID.
+  virtual absl::Status SelectParentTypesByTypeIDs(
+      absl::Span<const int64> type_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the Artifact table.
   virtual absl::Status CheckArtifactTable() = 0;
 
@@ -234,6 +345,14 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* artifact_id) = 0;
 
+  // Inserts artifacts into the database with multi-row statements, and returns
+  // the ids of the inserted artifacts in the order of `artifacts`. The ids and
+  // properties of `artifacts` are ignored.
+  virtual absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                                       absl::Time create_time,
+                                       absl::Time update_time,
+                                       std::vector<int64>* artifact_ids) = 0;
+
   // Retrieves artifacts from the database by their ids. Not found ids are
   // skipped. For each matched artifact, returns a row that contains the
   // following columns (order not important):
@@ -246,12 +365,22 @@ class QueryExecutor {
   // - int: last update time (since epoch)
   virtual absl::Status SelectArtifactsByID(absl::Span<const int64> ids,
                                            RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectArtifactsByID(absl::Span<const int64> ids,
+                                           TypedRecordSet* record_set) = 0;
+
   // Queries an artifact from the Artifact table by its type_id and name.
   // Returns the artifact ID.
   virtual absl::Status SelectArtifactByTypeIDAndArtifactName(
       int64 artifact_type_id, const absl::string_view name,
       RecordSet* record_set) = 0;
 
+  // Queries the artifacts of `artifact_type_id` by their names. The rows have
+  // the same columns as the ones of SelectArtifactsByID.
+  virtual absl::Status SelectArtifactsByTypeIDAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) = 0;
+
   // Queries artifacts from the Artifact table by their type_id.
   // Returns a list of artifact IDs.
   virtual absl::Status SelectArtifactsByTypeID(int64 artifact_type_id,
@@ -262,11 +391,46 @@ class QueryExecutor {
   virtual absl::Status SelectArtifactsByURI(const absl::string_view uri,
                                             RecordSet* record_set) = 0;
 
+  // Queries the artifacts from the database whose uri starts with
+  // `uri_prefix`.
+  // Returns a list of artifact IDs.
+  virtual absl::Status SelectArtifactsByURIPrefix(
+      absl::string_view uri_prefix, RecordSet* record_set) = 0;
+
+  // Queries the ids of `artifact_ids` which are in the Artifact table, using
+  // the primary key only.
+  // Returns a list of artifact IDs.
+  virtual absl::Status SelectArtifactIDsByID(
+      absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
+
+  // Counts the artifacts in the Artifact table, restricted to the ones of
+  // `artifact_type_id` and in `state` if they are given.
+  // Returns a single row with the count.
+  virtual absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                                      absl::optional<Artifact::State> state,
+                                      RecordSet* record_set) = 0;
+
+  // Aggregates the values of a property over the artifacts of
+  // `artifact_type_id` as specified by `options`.
+  // Returns a row per group of the state if the artifacts are grouped by state
+  // and the count of the artifacts, followed by the count, min, max and
+  // average of the values if `options` has a property_name.
+  virtual absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      RecordSet* record_set) = 0;
+
   // Updates an artifact in the database.
   virtual absl::Status UpdateArtifactDirect(
       int64 artifact_id, int64 type_id, const std::string& uri,
       const absl::optional<Artifact::State>& state, absl::Time update_time) = 0;
 
+  // Updates an artifact in the database only if its last update time is still
+  // `expected_update_time`. Sets `updated` to false if no row is changed.
+  virtual absl::Status UpdateArtifactDirectIfUnchanged(
+      int64 artifact_id, int64 type_id, const std::string& uri,
+      const absl::optional<Artifact::State>& state, absl::Time update_time,
+      int64 expected_update_time, bool* updated) = 0;
+
   // Checks the existence of the ArtifactProperty table.
   virtual absl::Status CheckArtifactPropertyTable() = 0;
 
@@ -275,11 +439,33 @@ class QueryExecutor {
       int64 artifact_id, absl::string_view artifact_property_name,
       bool is_custom_property, const Value& property_value) = 0;
 
+  // Inserts properties of artifacts into the database with multi-row
+  // statements.
+  virtual absl::Status InsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of an artifact from the database by the
   // artifact id. Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectArtifactPropertyByArtifactID(
       absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectArtifactPropertyByArtifactID(
+      absl::Span<const int64> artifact_ids, TypedRecordSet* record_set) = 0;
+  // Same as above, but only the properties with the given `names` are
+  // returned.
+  virtual absl::Status SelectArtifactPropertyByArtifactIDAndName(
+      absl::Span<const int64> artifact_ids, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) = 0;
+
+  // Selects the artifacts of `artifact_ids` with their properties, as
+  // SelectArtifactsByID and SelectArtifactPropertyByArtifactID do, or only the
+  // properties of `property_names` if it is not empty. The two queries are sent
+  // in one round trip if the metadata source pipelines them.
+  virtual absl::Status SelectArtifactsWithPropertiesByID(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const std::string> property_names, TypedRecordSet* record_set,
+      TypedRecordSet* property_record_set) = 0;
 
   // Updates a property of an artifact in the database.
   virtual absl::Status UpdateArtifactProperty(
@@ -290,6 +476,41 @@ class QueryExecutor {
   virtual absl::Status DeleteArtifactProperty(
       int64 artifact_id, const absl::string_view property_name) = 0;
 
+  // Deletes a batch of artifact properties of the given names. As with
+  // DeleteArtifactProperty, both the property and the custom property of
+  // a name are deleted.
+  virtual absl::Status DeleteArtifactProperties(
+      absl::Span<const NodePropertyName> property_names) = 0;
+
+  // Queries the ids of at most `limit` artifacts of `artifact_type_id` whose
+  // last_update_time_since_epoch is less than `last_update_time_since_epoch`,
+  // the least recently updated first.
+  // Returns a list of artifact IDs.
+  virtual absl::Status SelectArtifactIDsByTypeIDUpdatedBefore(
+      int64 artifact_type_id, int64 last_update_time_since_epoch, int64 limit,
+      RecordSet* record_set) = 0;
+
+  // Deletes the artifacts of `artifact_ids`.
+  virtual absl::Status DeleteArtifactsById(
+      absl::Span<const int64> artifact_ids) = 0;
+
+  // Deletes the properties of the artifacts of `artifact_ids`.
+  virtual absl::Status DeleteArtifactsPropertiesByArtifactsId(
+      absl::Span<const int64> artifact_ids) = 0;
+
+  // Deletes the events of the artifacts of `artifact_ids`.
+  virtual absl::Status DeleteEventsByArtifactsId(
+      absl::Span<const int64> artifact_ids) = 0;
+
+  // Deletes the paths of the events of the artifacts of `artifact_ids`. It is
+  // run before the events are deleted.
+  virtual absl::Status DeleteEventPathsByArtifactsId(
+      absl::Span<const int64> artifact_ids) = 0;
+
+  // Deletes the attributions of the artifacts of `artifact_ids`.
+  virtual absl::Status DeleteAttributionsByArtifactsId(
+      absl::Span<const int64> artifact_ids) = 0;
+
   // Checks the existence of the Execution table.
   virtual absl::Status CheckExecutionTable() = 0;
 
@@ -299,6 +520,14 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* execution_id) = 0;
 
+  // Inserts executions into the database with multi-row statements, and
+  // returns the ids of the inserted executions in the order of `executions`.
+  // The ids and properties of `executions` are ignored.
+  virtual absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                        absl::Time create_time,
+                                        absl::Time update_time,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves Executions based on the given ids. Not found ids are skipped.
   // For each matched execution, returns a row that contains the following
   // columns (order not important):
@@ -310,22 +539,52 @@ class QueryExecutor {
   // - last_update_time_since_epoch
   virtual absl::Status SelectExecutionsByID(
       absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectExecutionsByID(
+      absl::Span<const int64> execution_ids, TypedRecordSet* record_set) = 0;
 
   // Queries an execution from the database by its type_id and name.
   virtual absl::Status SelectExecutionByTypeIDAndExecutionName(
       int64 execution_type_id, const absl::string_view name,
       RecordSet* record_set) = 0;
 
+  // Queries the executions of `execution_type_id` by their names. The rows
+  // have the same columns as the ones of SelectExecutionsByID.
+  virtual absl::Status SelectExecutionsByTypeIDAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) = 0;
+
   // Queries an execution from the database by its type_id.
   virtual absl::Status SelectExecutionsByTypeID(int64 execution_type_id,
                                                 RecordSet* record_set) = 0;
 
+  // Counts the executions in the Execution table, restricted to the ones of
+  // `execution_type_id` and in `last_known_state` if they are given.
+  // Returns a single row with the count.
+  virtual absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state,
+      RecordSet* record_set) = 0;
+
+  // Same as AggregateArtifactProperty, but for the executions of
+  // `execution_type_id`. The state is the last_known_state.
+  virtual absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      RecordSet* record_set) = 0;
+
   // Updates an execution in the database.
   virtual absl::Status UpdateExecutionDirect(
       int64 execution_id, int64 type_id,
       const absl::optional<Execution::State>& last_known_state,
       absl::Time update_time) = 0;
 
+  // Updates an execution in the database only if its last update time is
+  // still `expected_update_time`. Sets `updated` to false if no row is changed.
+  virtual absl::Status UpdateExecutionDirectIfUnchanged(
+      int64 execution_id, int64 type_id,
+      const absl::optional<Execution::State>& last_known_state,
+      absl::Time update_time, int64 expected_update_time, bool* updated) = 0;
+
   // Checks the existence of the ExecutionProperty table.
   virtual absl::Status CheckExecutionPropertyTable() = 0;
 
@@ -335,11 +594,33 @@ class QueryExecutor {
                                                bool is_custom_property,
                                                const Value& value) = 0;
 
+  // Inserts properties of executions into the database with multi-row
+  // statements.
+  virtual absl::Status InsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of executions matching the given 'ids'.
   // Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectExecutionPropertyByExecutionID(
       absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectExecutionPropertyByExecutionID(
+      absl::Span<const int64> execution_ids, TypedRecordSet* record_set) = 0;
+  // Same as above, but only the properties with the given `names` are
+  // returned.
+  virtual absl::Status SelectExecutionPropertyByExecutionIDAndName(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const std::string> names, TypedRecordSet* record_set) = 0;
+
+  // Selects the executions of `execution_ids` with their properties, as
+  // SelectExecutionsByID and SelectExecutionPropertyByExecutionID do, or only
+  // the properties of `property_names` if it is not empty. The two queries are
+  // sent in one round trip if the metadata source pipelines them.
+  virtual absl::Status SelectExecutionsWithPropertiesByID(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const std::string> property_names, TypedRecordSet* record_set,
+      TypedRecordSet* property_record_set) = 0;
 
   // Updates a property of an execution from the database.
   virtual absl::Status UpdateExecutionProperty(int64 execution_id,
@@ -350,6 +631,41 @@ class QueryExecutor {
   virtual absl::Status DeleteExecutionProperty(
       int64 execution_id, const absl::string_view name) = 0;
 
+  // Deletes a batch of execution properties of the given names. As with
+  // DeleteExecutionProperty, both the property and the custom property of
+  // a name are deleted.
+  virtual absl::Status DeleteExecutionProperties(
+      absl::Span<const NodePropertyName> property_names) = 0;
+
+  // Queries the ids of at most `limit` executions of `execution_type_id` whose
+  // last_update_time_since_epoch is less than `last_update_time_since_epoch`,
+  // the least recently updated first.
+  // Returns a list of execution IDs.
+  virtual absl::Status SelectExecutionIDsByTypeIDUpdatedBefore(
+      int64 execution_type_id, int64 last_update_time_since_epoch, int64 limit,
+      RecordSet* record_set) = 0;
+
+  // Deletes the executions of `execution_ids`.
+  virtual absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) = 0;
+
+  // Deletes the properties of the executions of `execution_ids`.
+  virtual absl::Status DeleteExecutionsPropertiesByExecutionsId(
+      absl::Span<const int64> execution_ids) = 0;
+
+  // Deletes the events of the executions of `execution_ids`.
+  virtual absl::Status DeleteEventsByExecutionsId(
+      absl::Span<const int64> execution_ids) = 0;
+
+  // Deletes the paths of the events of the executions of `execution_ids`. It
+  // is run before the events are deleted.
+  virtual absl::Status DeleteEventPathsByExecutionsId(
+      absl::Span<const int64> execution_ids) = 0;
+
+  // Deletes the associations of the executions of `execution_ids`.
+  virtual absl::Status DeleteAssociationsByExecutionsId(
+      absl::Span<const int64> execution_ids) = 0;
+
   // Checks the existence of the Context table.
   virtual absl::Status CheckContextTable() = 0;
 
@@ -359,6 +675,26 @@ class QueryExecutor {
                                      const absl::Time update_time,
                                      int64* context_id) = 0;
 
+  // Inserts contexts into the database with multi-row statements, and returns
+  // the ids of the inserted contexts in the order of `contexts`. The ids and
+  // properties of `contexts` are ignored.
+  virtual absl::Status InsertContexts(absl::Span<const Context> contexts,
+                                      absl::Time create_time,
+                                      absl::Time update_time,
+                                      std::vector<int64>* context_ids) = 0;
+
+  // Inserts a context into the database, unless a context of the same
+  // `type_id` and `name` exists, which may be committed concurrently. Returns
+  // the id of the inserted or the existing context, and whether it is
+  // inserted.
+  // Returns INTERNAL error, if the id of the existing context is not found.
+  virtual absl::Status InsertContextIfNotExist(int64 type_id,
+                                               const std::string& name,
+                                               absl::Time create_time,
+                                               absl::Time update_time,
+                                               int64* context_id,
+                                               bool* inserted) = 0;
+
   // Retrieves contexts from the database by their ids. For each context,
   // returns a row that contains the following columns (order not important):
   // - int: id
@@ -368,22 +704,44 @@ class QueryExecutor {
   // - int: last update time (since epoch)
   virtual absl::Status SelectContextsByID(absl::Span<const int64> context_ids,
                                           RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectContextsByID(absl::Span<const int64> context_ids,
+                                          TypedRecordSet* record_set) = 0;
 
   // Returns ids of contexts matching the given context_type_id.
   virtual absl::Status SelectContextsByTypeID(int64 context_type_id,
                                               RecordSet* record_set) = 0;
 
+  // Counts the contexts in the Context table, restricted to the ones of
+  // `context_type_id` if it is given.
+  // Returns a single row with the count.
+  virtual absl::Status CountContexts(absl::optional<int64> context_type_id,
+                                     RecordSet* record_set) = 0;
+
   // Returns ids of contexts matching the given context_type_id and name.
   virtual absl::Status SelectContextByTypeIDAndContextName(
       int64 context_type_id, const absl::string_view name,
       RecordSet* record_set) = 0;
 
+  // Queries the contexts of `context_type_id` by their names. The rows have
+  // the same columns as the ones of SelectContextsByID.
+  virtual absl::Status SelectContextsByTypeIDAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) = 0;
+
   // Updates a context in the Context table.
   virtual absl::Status UpdateContextDirect(int64 existing_context_id,
                                            int64 type_id,
                                            const std::string& context_name,
                                            const absl::Time update_time) = 0;
 
+  // Updates a context in the Context table only if its last update time is
+  // still `expected_update_time`. Sets `updated` to false if no row is changed.
+  virtual absl::Status UpdateContextDirectIfUnchanged(
+      int64 existing_context_id, int64 type_id,
+      const std::string& context_name, absl::Time update_time,
+      int64 expected_update_time, bool* updated) = 0;
+
   // Checks the existence of the ContextProperty table.
   virtual absl::Status CheckContextPropertyTable() = 0;
 
@@ -393,10 +751,32 @@ class QueryExecutor {
                                              bool custom_property,
                                              const Value& value) = 0;
 
+  // Inserts properties of contexts into the database with multi-row
+  // statements.
+  virtual absl::Status InsertContextProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of contexts from the database by the
   // given context ids.
   virtual absl::Status SelectContextPropertyByContextID(
       absl::Span<const int64> context_id, RecordSet* record_set) = 0;
+  // Same as above, but the rows are returned with typed cells.
+  virtual absl::Status SelectContextPropertyByContextID(
+      absl::Span<const int64> context_id, TypedRecordSet* record_set) = 0;
+  // Same as above, but only the properties with the given `names` are
+  // returned.
+  virtual absl::Status SelectContextPropertyByContextIDAndName(
+      absl::Span<const int64> context_ids, absl::Span<const std::string> names,
+      TypedRecordSet* record_set) = 0;
+
+  // Selects the contexts of `context_ids` with their properties, as
+  // SelectContextsByID and SelectContextPropertyByContextID do, or only the
+  // properties of `property_names` if it is not empty. The two queries are sent
+  // in one round trip if the metadata source pipelines them.
+  virtual absl::Status SelectContextsWithPropertiesByID(
+      absl::Span<const int64> context_ids,
+      absl::Span<const std::string> property_names, TypedRecordSet* record_set,
+      TypedRecordSet* property_record_set) = 0;
 
   // Updates a property of a context in the database.
   virtual absl::Status UpdateContextProperty(
@@ -407,6 +787,12 @@ class QueryExecutor {
   virtual absl::Status DeleteContextProperty(
       const int64 context_id, const absl::string_view property_name) = 0;
 
+  // Deletes a batch of context properties of the given names. As with
+  // DeleteContextProperty, both the property and the custom property of
+  // a name are deleted.
+  virtual absl::Status DeleteContextProperties(
+      absl::Span<const NodePropertyName> property_names) = 0;
+
   // Checks the existence of the Event table.
   virtual absl::Status CheckEventTable() = 0;
 
@@ -416,6 +802,13 @@ class QueryExecutor {
                                    int64 event_time_milliseconds,
                                    int64* event_id) = 0;
 
+  // Inserts a batch of events into the database, and returns the assigned ids
+  // in the order of the given events. The events without an occurrence time
+  // get `default_event_time_milliseconds`. The paths are not inserted.
+  virtual absl::Status InsertEvents(absl::Span<const Event> events,
+                                    int64 default_event_time_milliseconds,
+                                    std::vector<int64>* event_ids) = 0;
+
   // Queries events from the Event table by a collection of artifact ids.
   virtual absl::Status SelectEventByArtifactIDs(
       absl::Span<const int64> artifact_ids, RecordSet* event_record_set) = 0;
@@ -431,10 +824,154 @@ class QueryExecutor {
   virtual absl::Status InsertEventPath(int64 event_id,
                                        const Event::Path::Step& step) = 0;
 
+  // Inserts the path steps of a batch of events into the EventPath table.
+  // The `event_ids` are index-aligned with the `events`.
+  virtual absl::Status InsertEventPaths(absl::Span<const int64> event_ids,
+                                        absl::Span<const Event> events) = 0;
+
   // Queries paths from the database by a collection of event ids.
   virtual absl::Status SelectEventPathByEventIDs(
       absl::Span<const int64> event_ids, RecordSet* record_set) = 0;
 
+  // Queries the events of a collection of artifact ids as
+  // SelectEventByArtifactIDs does, together with the paths of those events.
+  // If `event_types` is not empty, only the events of those types are queried.
+  // The two queries are sent in one round trip if the metadata source
+  // pipelines them.
+  virtual absl::Status SelectEventsWithPathsByArtifactIDs(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Event::Type> event_types, RecordSet* event_record_set,
+      RecordSet* path_record_set) = 0;
+
+  // Same as above, but for the events of a collection of execution ids.
+  virtual absl::Status SelectEventsWithPathsByExecutionIDs(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Event::Type> event_types, RecordSet* event_record_set,
+      RecordSet* path_record_set) = 0;
+
+  // Checks the existence of the `path_bytes` column of the Event table, which
+  // stores the serialized path of each event inline.
+  virtual absl::Status CheckEventPathBytesColumn() = 0;
+
+  // Adds the `path_bytes` column to the Event table. An existing column is
+  // skipped.
+  virtual absl::Status AddEventPathBytesColumn() = 0;
+
+  // Sets whether the paths of the events are stored in the `path_bytes`
+  // column. If so, InsertEvents stores the paths with the events and
+  // InsertEventPaths stores nothing, and the events selected with paths carry
+  // their `path_bytes` column, with no path record.
+  virtual void SetInlineEventPaths(bool inline_event_paths) = 0;
+
+  // Returns true if the paths of the events are stored in the `path_bytes`
+  // column, see SetInlineEventPaths.
+  virtual bool InlinesEventPaths() const = 0;
+
+  // Queries the ids of at most `max_num_events` events which have steps in the
+  // EventPath table, in ascending order.
+  virtual absl::Status SelectEventIDsWithPathSteps(int64 max_num_events,
+                                                   RecordSet* record_set) = 0;
+
+  // Stores the serialized `path` in the `path_bytes` column of an event.
+  virtual absl::Status UpdateEventPathBytes(int64 event_id,
+                                            const Event::Path& path) = 0;
+
+  // Deletes the steps of a list of events from the EventPath table.
+  virtual absl::Status DeleteEventPathsByEventIDs(
+      absl::Span<const int64> event_ids) = 0;
+
+  // Checks the existence of the `properties_bytes` columns of the Artifact,
+  // Execution and Context tables, which store a serialized copy of the
+  // properties of each node.
+  virtual absl::Status CheckNodePropertiesBytesColumns() = 0;
+
+  // Adds the `properties_bytes` columns to the Artifact, Execution and Context
+  // tables. An existing column is skipped.
+  virtual absl::Status AddNodePropertiesBytesColumns() = 0;
+
+  // Sets whether the properties of the nodes are read from the
+  // `properties_bytes` columns. If so, the nodes selected with all their
+  // properties carry their `properties_bytes` column, with no property record.
+  virtual void SetInlineNodeProperties(bool inline_node_properties) = 0;
+
+  // Returns true if the properties of the nodes are read from the
+  // `properties_bytes` columns, see SetInlineNodeProperties.
+  virtual bool InlinesNodeProperties() const = 0;
+
+  // Sets whether the `properties_bytes` columns are written whenever the
+  // properties of a node change. Once the columns exist, every store must
+  // write them, including the ones which do not read them, as the stores
+  // inlining the properties would otherwise read stale ones.
+  virtual void SetWriteNodePropertiesBytes(
+      bool write_node_properties_bytes) = 0;
+
+  // Returns true if the `properties_bytes` columns are written on the property
+  // changes, see SetWriteNodePropertiesBytes.
+  virtual bool WritesNodePropertiesBytes() const = 0;
+
+  // Queries the ids of at most `max_num_nodes` nodes whose `properties_bytes`
+  // column is not set, in ascending order.
+  virtual absl::Status SelectArtifactIDsWithoutPropertiesBytes(
+      int64 max_num_nodes, RecordSet* record_set) = 0;
+  virtual absl::Status SelectExecutionIDsWithoutPropertiesBytes(
+      int64 max_num_nodes, RecordSet* record_set) = 0;
+  virtual absl::Status SelectContextIDsWithoutPropertiesBytes(
+      int64 max_num_nodes, RecordSet* record_set) = 0;
+
+  // Stores the serialized properties and custom properties of a node in its
+  // `properties_bytes` column.
+  virtual absl::Status UpdateArtifactPropertiesBytes(
+      int64 artifact_id, const Artifact& artifact) = 0;
+  virtual absl::Status UpdateExecutionPropertiesBytes(
+      int64 execution_id, const Execution& execution) = 0;
+  virtual absl::Status UpdateContextPropertiesBytes(
+      int64 context_id, const Context& context) = 0;
+
+  // Checks the existence of the MLMDIdempotencyKey table.
+  virtual absl::Status CheckIdempotencyKeyTable() = 0;
+
+  // Creates the MLMDIdempotencyKey table if it does not exist.
+  virtual absl::Status CreateIdempotencyKeyTable() = 0;
+
+  // Queries the request fingerprint, the create time in milliseconds since
+  // epoch and the serialized response of an idempotency key. The record set is
+  // empty if the key is not found.
+  virtual absl::Status SelectIdempotencyKey(absl::string_view idempotency_key,
+                                            RecordSet* record_set) = 0;
+
+  // Inserts an idempotency key with the fingerprint of its request and its
+  // serialized response.
+  virtual absl::Status InsertIdempotencyKey(absl::string_view idempotency_key,
+                                            int64 request_fingerprint,
+                                            absl::Time create_time,
+                                            absl::string_view response) = 0;
+
+  // Queries at most `max_num_keys` idempotency keys created before
+  // `create_time`.
+  virtual absl::Status SelectIdempotencyKeysCreatedBefore(
+      absl::Time create_time, int64 max_num_keys, RecordSet* record_set) = 0;
+
+  // Deletes the given idempotency keys.
+  virtual absl::Status DeleteIdempotencyKeys(
+      absl::Span<const std::string> idempotency_keys) = 0;
+
+  // Checks the existence of the MLMDLineageClosure table.
+  virtual absl::Status CheckLineageClosureTable() = 0;
+
+  // Creates the MLMDLineageClosure table if it does not exist.
+  virtual absl::Status CreateLineageClosureTable() = 0;
+
+  // Inserts the rows of the closure, given as (artifact_id, direction,
+  // related_artifact_id), which do not exist yet.
+  virtual absl::Status InsertLineageClosureIfNotExist(
+      absl::Span<const std::array<int64, 3>> rows) = 0;
+
+  // Queries the artifact_id and the related_artifact_id of the rows of the
+  // `artifact_ids` in `direction`.
+  virtual absl::Status SelectLineageClosure(
+      absl::Span<const int64> artifact_ids, int64 direction,
+      RecordSet* record_set) = 0;
+
   // Checks the existence of the Association table.
   virtual absl::Status CheckAssociationTable() = 0;
 
@@ -442,6 +979,11 @@ class QueryExecutor {
   virtual absl::Status InsertAssociation(int64 context_id, int64 execution_id,
                                          int64* association_id) = 0;
 
+  // Inserts the `associations` into the database with multi-row statements,
+  // which skip the associations that already exist.
+  virtual absl::Status InsertAssociationsIfNotExist(
+      absl::Span<const Association> associations) = 0;
+
   // Returns association triplets for the given context id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
@@ -449,6 +991,11 @@ class QueryExecutor {
   virtual absl::Status SelectAssociationByContextID(int64 context_id,
                                                     RecordSet* record_set) = 0;
 
+  // Returns the association triplets for a collection of context ids, with
+  // the columns of SelectAssociationByContextID.
+  virtual absl::Status SelectAssociationsByContextIDs(
+      absl::Span<const int64> context_ids, RecordSet* record_set) = 0;
+
   // Returns association triplets for the given context id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
@@ -456,6 +1003,11 @@ class QueryExecutor {
   virtual absl::Status SelectAssociationByExecutionID(
       int64 execution_id, RecordSet* record_set) = 0;
 
+  // Returns the association triplets for a collection of execution ids, with
+  // the columns of SelectAssociationByExecutionID.
+  virtual absl::Status SelectAssociationsByExecutionIDs(
+      absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the Attribution table.
   virtual absl::Status CheckAttributionTable() = 0;
 
@@ -464,6 +1016,11 @@ class QueryExecutor {
                                                int64 artifact_id,
                                                int64* attribution_id) = 0;
 
+  // Inserts the `attributions` into the database with multi-row statements,
+  // which skip the attributions that already exist.
+  virtual absl::Status InsertAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) = 0;
+
   // Returns attribution triplets for the given context id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
@@ -471,6 +1028,11 @@ class QueryExecutor {
   virtual absl::Status SelectAttributionByContextID(int64 context_id,
                                                     RecordSet* record_set) = 0;
 
+  // Returns the attribution triplets for a collection of context ids, with
+  // the columns of SelectAttributionByContextID.
+  virtual absl::Status SelectAttributionsByContextIDs(
+      absl::Span<const int64> context_ids, RecordSet* record_set) = 0;
+
   // Returns attribution triplets for the given artifact id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
@@ -478,6 +1040,32 @@ class QueryExecutor {
   virtual absl::Status SelectAttributionByArtifactID(int64 artifact_id,
                                                      RecordSet* record_set) = 0;
 
+  // Returns the attribution triplets for a collection of artifact ids, with
+  // the columns of SelectAttributionByArtifactID.
+  virtual absl::Status SelectAttributionsByArtifactIDs(
+      absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
+
+  // Queries the artifacts attributed to the given context id by joining the
+  // Attribution table. Returns the same columns as SelectArtifactsByID.
+  virtual absl::Status SelectArtifactsByContextID(
+      int64 context_id, TypedRecordSet* record_set) = 0;
+
+  // Queries the properties of the artifacts attributed to the given context
+  // id. Returns the same columns as SelectArtifactPropertyByArtifactID.
+  virtual absl::Status SelectArtifactPropertyByContextID(
+      int64 context_id, TypedRecordSet* record_set) = 0;
+
+  // Queries the contexts to which the given artifact id is attributed by
+  // joining the Attribution table. Returns the same columns as
+  // SelectContextsByID.
+  virtual absl::Status SelectContextsByArtifactID(
+      int64 artifact_id, TypedRecordSet* record_set) = 0;
+
+  // Queries the properties of the contexts to which the given artifact id is
+  // attributed. Returns the same columns as SelectContextPropertyByContextID.
+  virtual absl::Status SelectContextPropertyByArtifactID(
+      int64 artifact_id, TypedRecordSet* record_set) = 0;
+
   // Checks the existence of the ParentContext table.
   virtual absl::Status CheckParentContextTable() = 0;
 
@@ -486,6 +1074,11 @@ class QueryExecutor {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status InsertParentContext(int64 parent_id, int64 child_id) = 0;
 
+  // Inserts the `parent_contexts` into the database with multi-row statements.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertParentContexts(
+      absl::Span<const ParentContext> parent_contexts) = 0;
+
   // Returns parent contexts for the given context id. Each record has:
   // Column 0: int: context id (= context_id)
   // Column 1: int: parent context id
@@ -498,6 +1091,22 @@ class QueryExecutor {
   virtual absl::Status SelectChildContextsByContextID(
       int64 context_id, RecordSet* record_set) = 0;
 
+  // Returns the ParentContext links from the given context to its ancestors
+  // within `max_level` levels in a single query. The links to the parents are
+  // at level 1. Each record has:
+  // Column 0: int: context id
+  // Column 1: int: parent context id
+  // Returns detailed INTERNAL error, if query execution fails, e.g., if the
+  // database does not support recursive common table expressions.
+  virtual absl::Status SelectAncestorContextsByContextID(
+      int64 context_id, int64 max_level, RecordSet* record_set) = 0;
+
+  // Returns the ParentContext links from the given context to its descendants
+  // within `max_level` levels in a single query. The columns and errors are
+  // the same as SelectAncestorContextsByContextID.
+  virtual absl::Status SelectDescendantContextsByContextID(
+      int64 context_id, int64 max_level, RecordSet* record_set) = 0;
+
   // Checks the MLMDEnv table and query the schema version.
   // At MLMD release v0.13.2, by default it is v0.
   virtual absl::Status CheckMLMDEnvTable() = 0;
@@ -525,6 +1134,39 @@ class QueryExecutor {
   // Returns a list of IDs.
   virtual absl::Status SelectAllContextIDs(RecordSet* set) = 0;
 
+  // Streams all artifact IDs to `callback` in batches, so that the IDs are not
+  // buffered in a RecordSet. The callback must not run other queries.
+  virtual absl::Status SelectAllArtifactIDs(
+      const RecordBatchCallback& callback) = 0;
+
+  // Streams all execution IDs to `callback` in batches.
+  virtual absl::Status SelectAllExecutionIDs(
+      const RecordBatchCallback& callback) = 0;
+
+  // Streams all context IDs to `callback` in batches.
+  virtual absl::Status SelectAllContextIDs(
+      const RecordBatchCallback& callback) = 0;
+
+  // Streams the IDs of the artifacts whose (last_update_time_since_epoch, id)
+  // is greater than (`last_update_time_since_epoch`, `id`) to `callback` in
+  // batches, ordered by (last_update_time_since_epoch, id). The range is read
+  // from the index on last_update_time_since_epoch.
+  virtual absl::Status SelectArtifactIDsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const RecordBatchCallback& callback) = 0;
+
+  // Streams the IDs of the executions updated after the watermark. See
+  // SelectArtifactIDsUpdatedAfter.
+  virtual absl::Status SelectExecutionIDsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const RecordBatchCallback& callback) = 0;
+
+  // Streams the IDs of the contexts updated after the watermark. See
+  // SelectArtifactIDsUpdatedAfter.
+  virtual absl::Status SelectContextIDsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const RecordBatchCallback& callback) = 0;
+
   // List Artifact IDs using `options`. If `candidate_ids` is provided, then
   // returned result is only built using ids in the `candidate_ids`, when
   // nullopt, all stored artifacts are considered as candidates. On success
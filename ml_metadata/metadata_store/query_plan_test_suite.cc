@@ -0,0 +1,299 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/query_plan_test_suite.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include "google/protobuf/descriptor.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ::testing::Contains;
+
+// The size of the populated tables, which is large enough for the planners
+// to prefer the indices over full scans wherever they fit.
+constexpr int kNumTypesPerKind = 10;
+constexpr int kNumArtifacts = 5000;
+constexpr int kNumExecutions = 2500;
+constexpr int kNumContexts = 500;
+
+// The templates of optional tables and columns, which are created besides
+// the schema of InitMetadataSource, so that their queries are explained too.
+std::vector<const MetadataSourceQueryConfig::TemplateQuery*>
+GetOptionalSchemaQueries(const MetadataSourceQueryConfig& config) {
+  return {&config.create_migration_checkpoint_table(),
+          &config.create_idempotency_key_table(),
+          &config.create_lineage_closure_table(),
+          &config.create_id_list_table(),
+          &config.add_event_path_bytes_column(),
+          &config.add_artifact_properties_bytes_column(),
+          &config.add_execution_properties_bytes_column(),
+          &config.add_context_properties_bytes_column()};
+}
+
+// Returns true if the template `name` reads rows of tables, i.e., it is a
+// SELECT, UPDATE or DELETE. The checks of the schema are skipped, as they
+// read a single row of their table on purpose.
+bool IsExplainable(const std::string& name, absl::string_view query) {
+  if (absl::StartsWith(name, "check_")) return false;
+  query = absl::StripLeadingAsciiWhitespace(query);
+  for (const absl::string_view statement :
+       {"SELECT", "UPDATE", "DELETE", "WITH"}) {
+    if (absl::StartsWithIgnoreCase(query, statement)) return true;
+  }
+  return false;
+}
+
+// Returns the query of `template_query` with values bound to its parameters:
+// a column name for the parameters quoted as identifiers, e.g., the column of
+// a property value, a number for LIMIT and OFFSET, and a string literal for
+// the others, which the backends compare to both numeric and text columns
+// without giving up their indices.
+std::string BindParameters(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query) {
+  std::string query = template_query.query();
+  // The parameters are bound from the last one, so that $1 is not bound in
+  // $10.
+  for (int i = template_query.parameter_num() - 1; i >= 0; --i) {
+    const std::string placeholder = absl::StrCat("$", i);
+    std::string bound_query;
+    size_t begin = 0;
+    for (size_t pos = query.find(placeholder); pos != std::string::npos;
+         pos = query.find(placeholder, begin)) {
+      bound_query.append(query, begin, pos - begin);
+      const absl::string_view before = absl::StripTrailingAsciiWhitespace(
+          absl::string_view(query).substr(0, pos));
+      if (absl::EndsWith(before, "`")) {
+        bound_query.append("int_value");
+      } else if (absl::EndsWithIgnoreCase(before, "LIMIT") ||
+                 absl::EndsWithIgnoreCase(before, "OFFSET")) {
+        bound_query.append("1");
+      } else {
+        bound_query.append("'1'");
+      }
+      begin = pos + placeholder.size();
+    }
+    bound_query.append(query, begin, std::string::npos);
+    query = std::move(bound_query);
+  }
+  return query;
+}
+
+// Populates the tables with kNumTypesPerKind types of each kind, whose nodes
+// are spread evenly, and with the events, attributions, associations and
+// parent contexts of the nodes.
+void PopulateTables(MetadataAccessObject* metadata_access_object) {
+  std::vector<int64> artifact_type_ids, execution_type_ids, context_type_ids;
+  for (int i = 0; i < kNumTypesPerKind; ++i) {
+    ArtifactType artifact_type;
+    artifact_type.set_name(absl::StrCat("artifact_type_", i));
+    (*artifact_type.mutable_properties())["p"] = INT;
+    (*artifact_type.mutable_properties())["q"] = STRING;
+    ExecutionType execution_type;
+    execution_type.set_name(absl::StrCat("execution_type_", i));
+    (*execution_type.mutable_properties())["p"] = INT;
+    ContextType context_type;
+    context_type.set_name(absl::StrCat("context_type_", i));
+    (*context_type.mutable_properties())["p"] = INT;
+    int64 type_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->CreateType(artifact_type, &type_id));
+    artifact_type_ids.push_back(type_id);
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->CreateType(execution_type, &type_id));
+    execution_type_ids.push_back(type_id);
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object->CreateType(context_type, &type_id));
+    context_type_ids.push_back(type_id);
+  }
+
+  std::vector<Artifact> artifacts(kNumArtifacts);
+  for (int i = 0; i < kNumArtifacts; ++i) {
+    artifacts[i].set_type_id(artifact_type_ids[i % kNumTypesPerKind]);
+    artifacts[i].set_name(absl::StrCat("artifact_", i));
+    artifacts[i].set_uri(absl::StrCat("gs://bucket/artifact_", i));
+    artifacts[i].set_state(Artifact::LIVE);
+    (*artifacts[i].mutable_properties())["p"].set_int_value(i);
+    (*artifacts[i].mutable_properties())["q"].set_string_value(
+        absl::StrCat("value_", i));
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifacts(artifacts, &artifact_ids));
+
+  std::vector<Execution> executions(kNumExecutions);
+  for (int i = 0; i < kNumExecutions; ++i) {
+    executions[i].set_type_id(execution_type_ids[i % kNumTypesPerKind]);
+    executions[i].set_name(absl::StrCat("execution_", i));
+    executions[i].set_last_known_state(Execution::COMPLETE);
+    (*executions[i].mutable_properties())["p"].set_int_value(i);
+  }
+  std::vector<int64> execution_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->CreateExecutions(
+                                  executions, &execution_ids));
+
+  std::vector<Context> contexts(kNumContexts);
+  for (int i = 0; i < kNumContexts; ++i) {
+    contexts[i].set_type_id(context_type_ids[i % kNumTypesPerKind]);
+    contexts[i].set_name(absl::StrCat("context_", i));
+    (*contexts[i].mutable_properties())["p"].set_int_value(i);
+  }
+  std::vector<int64> context_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateContexts(contexts, &context_ids));
+
+  // Each execution reads an artifact and writes the next one.
+  std::vector<Event> events;
+  std::vector<Association> associations;
+  for (int i = 0; i < kNumExecutions; ++i) {
+    for (const Event::Type type : {Event::INPUT, Event::OUTPUT}) {
+      Event event;
+      event.set_artifact_id(
+          artifact_ids[(2 * i + (type == Event::OUTPUT)) % kNumArtifacts]);
+      event.set_execution_id(execution_ids[i]);
+      event.set_type(type);
+      event.mutable_path()->add_steps()->set_index(i);
+      events.push_back(event);
+    }
+    Association association;
+    association.set_execution_id(execution_ids[i]);
+    association.set_context_id(context_ids[i % kNumContexts]);
+    associations.push_back(association);
+  }
+  std::vector<int64> event_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateEvents(events, &event_ids));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateAssociations(associations));
+
+  std::vector<Attribution> attributions;
+  for (int i = 0; i < kNumArtifacts; ++i) {
+    Attribution attribution;
+    attribution.set_artifact_id(artifact_ids[i]);
+    attribution.set_context_id(context_ids[i % kNumContexts]);
+    attributions.push_back(attribution);
+  }
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateAttributions(attributions));
+
+  // The contexts form a binary tree.
+  std::vector<ParentContext> parent_contexts;
+  for (int i = 1; i < kNumContexts; ++i) {
+    ParentContext parent_context;
+    parent_context.set_child_id(context_ids[i]);
+    parent_context.set_parent_id(context_ids[(i - 1) / 2]);
+    parent_contexts.push_back(parent_context);
+  }
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateParentContexts(parent_contexts));
+}
+
+}  // namespace
+
+void QueryPlanTestSuite::SetUp() {
+  query_plan_container_ = GetParam()();
+  metadata_source_ = query_plan_container_->GetMetadataSource();
+  const MetadataSourceQueryConfig& query_config =
+      query_plan_container_->GetQueryConfig();
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataAccessObject(query_config, metadata_source_,
+                                       &metadata_access_object_));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->InitMetadataSource());
+  for (const MetadataSourceQueryConfig::TemplateQuery* query :
+       GetOptionalSchemaQueries(query_config)) {
+    if (query->query().empty()) continue;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_source_->ExecuteQuery(query->query(), nullptr));
+  }
+  PopulateTables(metadata_access_object_.get());
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+}
+
+// Explains each template with its parameters bound, and checks that it only
+// reads the tables in full that its expectation allows, and that it looks up
+// rows through the indices its expectation requires.
+TEST_P(QueryPlanTestSuite, TemplatesReadThroughIndices) {
+  const MetadataSourceQueryConfig& query_config =
+      query_plan_container_->GetQueryConfig();
+  const std::map<std::string, QueryPlanExpectation> expected_plans =
+      query_plan_container_->GetExpectedPlans();
+  // The statistics are updated outside of a transaction, as some backends,
+  // e.g., MySQL, commit the open transaction before analyzing a table.
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->Begin(TransactionMode::kAutocommit));
+  ASSERT_EQ(absl::OkStatus(), query_plan_container_->AnalyzeTables());
+
+  absl::flat_hash_set<std::string> explained_templates;
+  const google::protobuf::Descriptor* descriptor = query_config.GetDescriptor();
+  const google::protobuf::Reflection* reflection = query_config.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (field->is_repeated() ||
+        field->message_type() !=
+            MetadataSourceQueryConfig::TemplateQuery::descriptor() ||
+        !reflection->HasField(query_config, field)) {
+      continue;
+    }
+    const auto& template_query =
+        static_cast<const MetadataSourceQueryConfig::TemplateQuery&>(
+            reflection->GetMessage(query_config, field));
+    if (!IsExplainable(field->name(), template_query.query())) continue;
+    explained_templates.insert(field->name());
+
+    QueryPlan plan;
+    const absl::Status status = query_plan_container_->ExplainQuery(
+        BindParameters(template_query), &plan);
+    EXPECT_EQ(absl::OkStatus(), status) << field->name();
+    if (!status.ok()) continue;
+    QueryPlanExpectation expectation;
+    const auto it = expected_plans.find(field->name());
+    if (it != expected_plans.end()) expectation = it->second;
+    for (const std::string& table : plan.full_scans) {
+      EXPECT_THAT(expectation.allowed_full_scans, Contains(table))
+          << field->name() << " reads " << table
+          << " in full: " << plan.description;
+    }
+    for (const std::string& index : expectation.required_indices) {
+      EXPECT_THAT(plan.indices, Contains(index))
+          << field->name() << " does not read through " << index << ": "
+          << plan.description;
+    }
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  // The expectations of the templates which are not explained anymore, e.g.,
+  // as they were renamed, are stale.
+  for (const auto& expected_plan : expected_plans) {
+    EXPECT_TRUE(explained_templates.contains(expected_plan.first))
+        << expected_plan.first << " is not an explained template.";
+  }
+}
+
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,109 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_QUERY_PLAN_TEST_SUITE_H_
+#define ML_METADATA_METADATA_STORE_QUERY_PLAN_TEST_SUITE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+
+// How the backend runs a query, as reported by its EXPLAIN.
+struct QueryPlan {
+  // The tables, or the aliases of the tables in the query, which are read in
+  // full, i.e., all their rows or all the entries of one of their indices.
+  std::vector<std::string> full_scans;
+  // The indices through which the rows of the tables are looked up.
+  std::vector<std::string> indices;
+  // The plan as returned by the backend, which explains the failures.
+  std::string description;
+};
+
+// The expected plan of a query template. A template without one must not read
+// any table in full.
+struct QueryPlanExpectation {
+  // The tables or aliases the template may read in full, e.g., as it lists
+  // all the rows, or as no index fits it yet.
+  std::vector<std::string> allowed_full_scans;
+  // The indices the template must look up rows through.
+  std::vector<std::string> required_indices;
+};
+
+// An interface to create a MetadataSource of a backend, and to explain the
+// queries of its MetadataSourceQueryConfig.
+class QueryPlanContainer {
+ public:
+  virtual ~QueryPlanContainer() = default;
+
+  // MetadataSource is owned by QueryPlanContainer.
+  virtual MetadataSource* GetMetadataSource() = 0;
+
+  // Returns the query config whose templates are explained.
+  virtual const MetadataSourceQueryConfig& GetQueryConfig() = 0;
+
+  // Updates the statistics of the tables, which the planner of the backend
+  // chooses the indices with, once the tables are populated.
+  virtual absl::Status AnalyzeTables() = 0;
+
+  // Explains `query` in the open transaction, and sets `plan`.
+  virtual absl::Status ExplainQuery(const std::string& query,
+                                    QueryPlan* plan) = 0;
+
+  // Returns the expected plans of the templates, keyed by the names of their
+  // fields in MetadataSourceQueryConfig.
+  virtual std::map<std::string, QueryPlanExpectation> GetExpectedPlans() = 0;
+};
+
+// Represents the type of the Gunit Test param for the parameterized
+// QueryPlanTestSuite.
+using QueryPlanContainerFactory =
+    std::function<std::unique_ptr<QueryPlanContainer>()>;
+
+// Explains the SELECT, UPDATE and DELETE templates of the query config of a
+// backend against tables of a few thousand nodes, so that a change of a
+// template or of the indices which makes a lookup read a table in full fails.
+class QueryPlanTestSuite
+    : public ::testing::TestWithParam<QueryPlanContainerFactory> {
+ protected:
+  // Creates the schema, including the optional tables and columns, and
+  // populates it.
+  void SetUp() override;
+
+  void TearDown() override {
+    metadata_access_object_ = nullptr;
+    metadata_source_ = nullptr;
+    query_plan_container_ = nullptr;
+  }
+
+  std::unique_ptr<QueryPlanContainer> query_plan_container_;
+  // metadata_source_ is unowned.
+  MetadataSource* metadata_source_;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object_;
+};
+
+}  // namespace testing
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_QUERY_PLAN_TEST_SUITE_H_
@@ -17,6 +17,8 @@ limitations under the License.
 
 #endif
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 
@@ -45,7 +47,11 @@ limitations under the License.
 #endif
 // clang-format on
 #include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/list_operation_query_helper.h"
 #include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/record_parsing_util.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/simple_types/simple_types_constants.h"
@@ -67,39 +73,42 @@ TypeKind ResolveTypeKind(const ContextType* const type) {
   return TypeKind::CONTEXT_TYPE;
 }
 
-// Populates 'node' properties from the rows in 'record'. The assumption is that
-// properties are encoded using the convention in
-// QueryExecutor::Get{X}PropertyBy{X}Id() where X in {Artifact, Execution,
-// Context}.
-template <typename Node>
-absl::Status PopulateNodeProperties(const RecordSet::Record& record,
-                                    Node& node) {
-  // Populate the property of the node.
-  const std::string& property_name = record.values(1);
-  bool is_custom_property;
-  CHECK(absl::SimpleAtob(record.values(2), &is_custom_property));
-  auto& property_value =
-      (is_custom_property ? (*node.mutable_custom_properties())[property_name]
-                          : (*node.mutable_properties())[property_name]);
-  if (record.values(3) != kMetadataSourceNull) {
-    int64 int_value;
-    CHECK(absl::SimpleAtoi(record.values(3), &int_value));
-    property_value.set_int_value(int_value);
-  } else if (record.values(4) != kMetadataSourceNull) {
-    double double_value;
-    CHECK(absl::SimpleAtod(record.values(4), &double_value));
-    property_value.set_double_value(double_value);
+// The directions of the rows of the lineage closure, which are the values of
+// GetLineageGraphRequest::UPSTREAM and DOWNSTREAM.
+constexpr int64 kLineageClosureUpstream = 1;
+constexpr int64 kLineageClosureDownstream = 2;
+
+// Splits `ids` into the chunks of at most kMaxIdsPerQuery ids which are
+// queried at a time, unless `executor` loads them into its id list table.
+std::vector<absl::Span<const int64>> SplitIdsForQueries(
+    const absl::Span<const int64> ids, const QueryExecutor& executor) {
+  if (ids.size() <= kMaxIdsPerQuery ||
+      (executor.HasIdListTable() && ids.size() >= kMinIdsForIdListTable)) {
+    return {ids};
+  }
+  std::vector<absl::Span<const int64>> chunks;
+  for (size_t begin = 0; begin < ids.size(); begin += kMaxIdsPerQuery) {
+    chunks.push_back(ids.subspan(begin, kMaxIdsPerQuery));
+  }
+  return chunks;
+}
+
+// Appends the `rows` of the query of a chunk of ids to the `record_set` of
+// the previous chunks.
+void AppendChunkRows(TypedRecordSet rows, TypedRecordSet& record_set) {
+  if (record_set.num_columns() == 0) {
+    record_set = std::move(rows);
   } else {
-    const std::string& string_value = record.values(5);
-    if (IsStructSerializedString(string_value)) {
-      MLMD_RETURN_IF_ERROR(
-          StringToStruct(string_value, *property_value.mutable_struct_value()));
-    } else {
-      property_value.set_string_value(string_value);
-    }
+    record_set.AppendRows(rows);
   }
+}
 
-  return absl::OkStatus();
+void AppendChunkRows(RecordSet rows, RecordSet& record_set) {
+  if (record_set.column_names().empty()) {
+    record_set = std::move(rows);
+  } else {
+    record_set.mutable_records()->MergeFrom(rows.records());
+  }
 }
 
 // Converts a record set that contains an id column at position per record to a
@@ -109,12 +118,105 @@ std::vector<int64> ConvertToIds(const RecordSet& record_set, int position = 0) {
   result.reserve(record_set.records().size());
   for (const RecordSet::Record& record : record_set.records()) {
     int64 id;
-    CHECK(absl::SimpleAtoi(record.values(position), &id));
+    CHECK(ParseDecimalInt64(record.values(position), &id));
+    result.push_back(id);
+  }
+  return result;
+}
+
+// Same as above, but for a typed record set.
+std::vector<int64> ConvertToIds(const TypedRecordSet& record_set,
+                                int column = 0) {
+  std::vector<int64> result;
+  result.reserve(record_set.num_rows());
+  for (int row = 0; row < record_set.num_rows(); row++) {
+    int64 id;
+    CHECK(record_set.GetInt64(row, column, &id));
     result.push_back(id);
   }
   return result;
 }
 
+// Extracts the count from the single record of a COUNT(*) query.
+int64 ConvertToCount(const RecordSet& record_set) {
+  CHECK_EQ(record_set.records_size(), 1);
+  int64 count;
+  CHECK(absl::SimpleAtoi(record_set.records(0).values(0), &count));
+  return count;
+}
+
+// Converts the rows of an aggregation of a property with `options` to
+// `aggregates`. The columns are the state if the nodes are grouped by state,
+// the count of the nodes, and the count, min, max and average of the values if
+// a property is aggregated.
+void ConvertToPropertyAggregates(const RecordSet& record_set,
+                                 const PropertyAggregationOptions& options,
+                                 std::vector<PropertyAggregate>* aggregates) {
+  for (const RecordSet::Record& record : record_set.records()) {
+    PropertyAggregate aggregate;
+    int column = 0;
+    if (options.group_by_state()) {
+      int state;
+      if (record.values(column) != kMetadataSourceNull) {
+        CHECK(absl::SimpleAtoi(record.values(column), &state));
+        aggregate.set_state(state);
+      }
+      column++;
+    }
+    int64 num_nodes;
+    CHECK(absl::SimpleAtoi(record.values(column++), &num_nodes));
+    aggregate.set_num_nodes(num_nodes);
+    if (options.has_property_name()) {
+      int64 num_values;
+      CHECK(absl::SimpleAtoi(record.values(column++), &num_values));
+      aggregate.set_num_values(num_values);
+      if (num_values > 0) {
+        double min_value, max_value, avg_value;
+        CHECK(absl::SimpleAtod(record.values(column++), &min_value));
+        CHECK(absl::SimpleAtod(record.values(column++), &max_value));
+        CHECK(absl::SimpleAtod(record.values(column++), &avg_value));
+        aggregate.set_min_value(min_value);
+        aggregate.set_max_value(max_value);
+        aggregate.set_avg_value(avg_value);
+      }
+    } else {
+      aggregate.set_num_values(0);
+    }
+    aggregates->push_back(aggregate);
+  }
+}
+
+// Returns a callback that appends the ids in the first column of the streamed
+// batches to `ids`.
+RecordBatchCallback CollectIds(std::vector<int64>* ids) {
+  return [ids](const TypedRecordSet& batch) {
+    ids->reserve(ids->size() + batch.num_rows());
+    for (int row = 0; row < batch.num_rows(); row++) {
+      int64 id;
+      CHECK(batch.GetInt64(row, 0, &id));
+      ids->push_back(id);
+    }
+    return absl::OkStatus();
+  };
+}
+
+// Returns a callback that passes the streamed batches to `callback` ordered by
+// (last_update_time_since_epoch, id), as the nodes of a batch are read by id.
+template <typename Node>
+NodeBatchCallback<Node> InUpdateOrder(const NodeBatchCallback<Node>& callback) {
+  return [&callback](absl::Span<const Node> batch) {
+    std::vector<Node> nodes(batch.begin(), batch.end());
+    std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) {
+      return a.last_update_time_since_epoch() !=
+                     b.last_update_time_since_epoch()
+                 ? a.last_update_time_since_epoch() <
+                       b.last_update_time_since_epoch()
+                 : a.id() < b.id();
+    });
+    return callback(nodes);
+  };
+}
+
 // Extracts a vector of type ids from the parent_type triplets.
 std::vector<int64> ParentTypesToParentTypeIds(const RecordSet& record_set) {
   return ConvertToIds(record_set, /*position=*/1);
@@ -149,109 +251,6 @@ std::vector<int64> ParentContextsToContextIds(const RecordSet& record_set,
   return ConvertToIds(record_set, position);
 }
 
-// Parses and converts a string value to a specific field in a message.
-// If the given string `value` is NULL (encoded as kMetadataSourceNull), then
-// leave the field unset.
-// The field should be a scalar field. The field type must be one of {string,
-// int64, bool, enum, message}.
-absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_descriptor,
-                               const absl::string_view value,
-                               google::protobuf::Message* message) {
-  if (value == kMetadataSourceNull) {
-    return absl::OkStatus();
-  }
-  const google::protobuf::Reflection* reflection = message->GetReflection();
-  switch (field_descriptor->cpp_type()) {
-    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_STRING: {
-      if (field_descriptor->is_repeated())
-        reflection->AddString(message, field_descriptor, std::string(value));
-      else
-        reflection->SetString(message, field_descriptor, std::string(value));
-      break;
-    }
-    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_INT64: {
-      int64 int64_value;
-      CHECK(absl::SimpleAtoi(value, &int64_value));
-      if (field_descriptor->is_repeated())
-        reflection->AddInt64(message, field_descriptor, int64_value);
-      else
-        reflection->SetInt64(message, field_descriptor, int64_value);
-      break;
-    }
-    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_BOOL: {
-      bool bool_value;
-      CHECK(absl::SimpleAtob(value, &bool_value));
-      if (field_descriptor->is_repeated())
-        reflection->AddBool(message, field_descriptor, bool_value);
-      else
-        reflection->SetBool(message, field_descriptor, bool_value);
-      break;
-    }
-    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_ENUM: {
-      int enum_value;
-      CHECK(absl::SimpleAtoi(value, &enum_value));
-      if (field_descriptor->is_repeated())
-        reflection->AddEnumValue(message, field_descriptor, enum_value);
-      else
-        reflection->SetEnumValue(message, field_descriptor, enum_value);
-      break;
-    }
-    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_MESSAGE: {
-      CHECK(!field_descriptor->is_repeated())
-          << "Cannot handle a repeated message";
-      if (!value.empty()) {
-        ::google::protobuf::Message* sub_message =
-            reflection->MutableMessage(message, field_descriptor);
-        if (!::google::protobuf::util::JsonStringToMessage(
-                 std::string(value.begin(), value.size()), sub_message)
-                 .ok()) {
-          return absl::InternalError(
-              ::absl::StrCat("Failed to parse proto: ", value));
-        }
-      }
-      break;
-    }
-    default: {
-      return absl::InternalError(absl::StrCat("Unsupported field type: ",
-                                              field_descriptor->cpp_type()));
-    }
-  }
-  return absl::OkStatus();
-}
-
-// Converts a RecordSet in the query result to a MessageType. In the record at
-// the `record_index`, its value of each column is assigned to a message field
-// with the same field name as the column name.
-template <typename MessageType>
-absl::Status ParseRecordSetToMessage(const RecordSet& record_set,
-                                     MessageType* message,
-                                     int record_index = 0) {
-  CHECK_LT(record_index, record_set.records_size());
-  const google::protobuf::Descriptor* descriptor = message->descriptor();
-  for (int i = 0; i < record_set.column_names_size(); i++) {
-    const std::string& column_name = record_set.column_names(i);
-    const google::protobuf::FieldDescriptor* field_descriptor =
-        descriptor->FindFieldByName(column_name);
-    if (field_descriptor != nullptr) {
-      const std::string& value = record_set.records(record_index).values(i);
-      MLMD_RETURN_IF_ERROR(ParseValueToField(field_descriptor, value, message));
-    }
-  }
-  return absl::OkStatus();
-}
-
-// Converts a RecordSet in the query result to a MessageType array.
-template <typename MessageType>
-absl::Status ParseRecordSetToMessageArray(const RecordSet& record_set,
-                                          std::vector<MessageType>* messages) {
-  for (int i = 0; i < record_set.records_size(); i++) {
-    messages->push_back(MessageType());
-    MLMD_RETURN_IF_ERROR(
-        ParseRecordSetToMessage(record_set, &messages->back(), i));
-  }
-  return absl::OkStatus();
-}
-
 // Converts a RecordSet containing key-value pairs to a proto Map.
 // The field_name is the map field in the MessageType. The method fills the
 // message's map field with field_name using the rows in the given record_set.
@@ -339,7 +338,82 @@ absl::Status ValidatePropertiesWithType(const Node& node, const Type& type) {
 bool IsUniqueConstraintViolated(const absl::Status status) {
   return absl::IsInternal(status) &&
          (absl::StrContains(std::string(status.message()), "Duplicate") ||
-          absl::StrContains(std::string(status.message()), "UNIQUE"));
+          absl::StrContains(std::string(status.message()), "UNIQUE") ||
+          // unique_violation in PostgreSQL.
+          absl::StrContains(std::string(status.message()),
+                            "sqlstate: 23505"));
+}
+
+// Returns true if the backend rejects the syntax of a query, e.g., the
+// recursive queries on MySQL before 8.0 or SQLite before 3.8.3.
+bool IsSyntaxUnsupported(const absl::Status status) {
+  return absl::IsInternal(status) &&
+         (absl::StrContains(std::string(status.message()), "errno: 1064,") ||
+          absl::StrContains(std::string(status.message()), "syntax error") ||
+          // syntax_error in PostgreSQL.
+          absl::StrContains(std::string(status.message()),
+                            "sqlstate: 42601"));
+}
+
+// Checks that each of the `ids` is found in the first column of `node_records`,
+// which are the rows of the `node_kind` nodes selected by the ids.
+// Returns INVALID_ARGUMENT error, if any of the ids is not found.
+absl::Status CheckNodesExist(const TypedRecordSet& node_records,
+                             const absl::flat_hash_set<int64>& ids,
+                             const absl::string_view node_kind) {
+  absl::flat_hash_set<int64> found_ids;
+  for (int row = 0; row < node_records.num_rows(); row++) {
+    int64 id;
+    if (!node_records.GetInt64(row, /*column=*/0, &id)) {
+      return absl::InternalError(absl::StrCat(
+          "Cannot parse the ", node_kind, " id: ",
+          node_records.FormatCell(row, /*column=*/0)));
+    }
+    found_ids.insert(id);
+  }
+  for (const int64 id : ids) {
+    if (!found_ids.contains(id)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No ", node_kind, " with the given id ", id));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns true if the two nodes are equal other than their properties and the
+// output only timestamps.
+template <typename Node>
+bool NodeAttributesEqual(const Node& node, const Node& other_node) {
+  google::protobuf::util::MessageDifferencer diff;
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("properties"));
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("custom_properties"));
+  // create_time_since_epoch and last_update_time_since_epoch are output only
+  // fields. Two nodes are treated as equal as long as other fields match.
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("create_time_since_epoch"));
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("last_update_time_since_epoch"));
+  return diff.Compare(node, other_node);
+}
+
+// Returns true if the property `value` equals the `stored_value` of the
+// property `name` of the node `node_id`. If the stored value is a struct kept
+// in `serialized_structs`, it is compared with the serialized `value`, which
+// is deterministic, instead of being parsed.
+bool PropertyValueEquals(const Value& value, const Value& stored_value,
+                         const SerializedStructs* serialized_structs,
+                         const int64 node_id, const bool is_custom_property,
+                         const std::string& name) {
+  if (serialized_structs != nullptr && value.has_struct_value() &&
+      stored_value.has_struct_value()) {
+    const auto it =
+        serialized_structs->find({node_id, is_custom_property, name});
+    if (it != serialized_structs->end()) {
+      return StructToBytes(value.struct_value()) == it->second;
+    }
+  }
+  return google::protobuf::util::MessageDifferencer::Equals(value,
+                                                          stored_value);
 }
 
 // A util to handle `version` in ArtifactType/ExecutionType/ContextType protos.
@@ -350,8 +424,310 @@ absl::optional<std::string> GetTypeVersion(const T& type_message) {
              : absl::nullopt;
 }
 
+// The time range of an event partition, if the options do not set it.
+constexpr int64 kDefaultEventPartitionIntervalSeconds = 24 * 60 * 60;
+
+// The number of event partitions created ahead, if the options do not set it.
+constexpr int kDefaultNumFutureEventPartitions = 7;
+
 }  // namespace
 
+absl::Status RDBMSMetadataAccessObject::MaintainEventPartitions(
+    const EventPartitionOptions& options, const int64 now_milliseconds,
+    const bool enable_migration) {
+  const int64 interval_milliseconds =
+      1000 * (options.partition_interval_seconds() > 0
+                  ? options.partition_interval_seconds()
+                  : kDefaultEventPartitionIntervalSeconds);
+  const int num_future_partitions = options.num_future_partitions() > 0
+                                        ? options.num_future_partitions()
+                                        : kDefaultNumFutureEventPartitions;
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectEventPartitionBounds(&record_set));
+  if (record_set.records_size() == 0) {
+    if (!enable_migration) {
+      return absl::FailedPreconditionError(
+          "The Event and EventPath tables are not partitioned. Set "
+          "enable_upgrade_migration to convert them, which rewrites the "
+          "tables.");
+    }
+    MLMD_RETURN_IF_ERROR(executor_->PartitionEventTables());
+  }
+  // The last partition of no bound is the catch-all one.
+  std::vector<int64> upper_bounds;
+  for (const RecordSet::Record& record : record_set.records()) {
+    int64 upper_bound;
+    if (absl::SimpleAtoi(record.values(0), &upper_bound)) {
+      upper_bounds.push_back(upper_bound);
+    }
+  }
+  absl::c_sort(upper_bounds);
+
+  // The partitions are split off the catch-all one in increasing order, and
+  // their bounds are aligned with the interval.
+  const int64 current_begin =
+      now_milliseconds - now_milliseconds % interval_milliseconds;
+  const int64 last_bound = current_begin +
+                           (num_future_partitions + 1) * interval_milliseconds;
+  for (int64 bound = current_begin + interval_milliseconds; bound <= last_bound;
+       bound += interval_milliseconds) {
+    if (upper_bounds.empty() || bound > upper_bounds.back()) {
+      MLMD_RETURN_IF_ERROR(executor_->AddEventPartition(bound));
+    }
+  }
+
+  if (options.retention_seconds() <= 0) {
+    return absl::OkStatus();
+  }
+  // A partition holds the events before its bound, so it is dropped once the
+  // bound is out of the retention period.
+  const int64 retention_begin =
+      now_milliseconds - 1000 * options.retention_seconds();
+  for (const int64 upper_bound : upper_bounds) {
+    if (upper_bound > retention_begin) break;
+    MLMD_RETURN_IF_ERROR(executor_->DropEventPartition(upper_bound));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::InlineEventPaths(
+    const bool enable_migration, const int64 max_num_events,
+    int64* num_moved_events) {
+  *num_moved_events = 0;
+  RecordSet id_record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectEventIDsWithPathSteps(max_num_events, &id_record_set));
+  if (id_record_set.records_size() > 0 && !enable_migration) {
+    return absl::FailedPreconditionError(
+        "The paths of the events are stored in the EventPath table. Set "
+        "enable_upgrade_migration to move them to the Event table.");
+  }
+  if (!executor_->CheckEventPathBytesColumn().ok()) {
+    MLMD_RETURN_IF_ERROR(executor_->AddEventPathBytesColumn());
+  }
+  if (id_record_set.records_size() == 0) {
+    executor_->SetInlineEventPaths(true);
+    return absl::OkStatus();
+  }
+
+  std::vector<int64> event_ids;
+  event_ids.reserve(id_record_set.records_size());
+  for (const RecordSet::Record& record : id_record_set.records()) {
+    int64 event_id;
+    CHECK(absl::SimpleAtoi(record.values(0), &event_id));
+    event_ids.push_back(event_id);
+  }
+  RecordSet path_record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectEventPathByEventIDs(event_ids, &path_record_set));
+  // The steps of an event are kept in the order of their rows.
+  absl::flat_hash_map<int64, Event::Path> paths;
+  for (const RecordSet::Record& record : path_record_set.records()) {
+    int64 event_id;
+    CHECK(absl::SimpleAtoi(record.values(0), &event_id));
+    bool is_index_step;
+    CHECK(absl::SimpleAtob(record.values(1), &is_index_step));
+    if (is_index_step) {
+      int64 step_index;
+      CHECK(absl::SimpleAtoi(record.values(2), &step_index));
+      paths[event_id].add_steps()->set_index(step_index);
+    } else {
+      paths[event_id].add_steps()->set_key(record.values(3));
+    }
+  }
+  for (const int64 event_id : event_ids) {
+    MLMD_RETURN_IF_ERROR(
+        executor_->UpdateEventPathBytes(event_id, paths[event_id]));
+  }
+  MLMD_RETURN_IF_ERROR(executor_->DeleteEventPathsByEventIDs(event_ids));
+  *num_moved_events = event_ids.size();
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::InlineNodeProperties(
+    const bool enable_migration, const int64 max_num_nodes,
+    int64* num_filled_nodes) {
+  *num_filled_nodes = 0;
+  if (!executor_->CheckNodePropertiesBytesColumns().ok()) {
+    MLMD_RETURN_IF_ERROR(executor_->AddNodePropertiesBytesColumns());
+  }
+  // The nodes written from now on are filled as they are written.
+  executor_->SetWriteNodePropertiesBytes(true);
+  // The nodes are filled one kind at a time, each batch with the nodes of one
+  // kind.
+  RecordSet id_record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactIDsWithoutPropertiesBytes(
+      max_num_nodes, &id_record_set));
+  if (id_record_set.records_size() > 0) {
+    if (!enable_migration) {
+      return absl::FailedPreconditionError(
+          "The properties of the artifacts are not stored in the Artifact "
+          "table. Set enable_upgrade_migration to copy them.");
+    }
+    *num_filled_nodes = id_record_set.records_size();
+    return FillPropertiesBytes<Artifact>(ConvertToIds(id_record_set));
+  }
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionIDsWithoutPropertiesBytes(
+      max_num_nodes, &id_record_set));
+  if (id_record_set.records_size() > 0) {
+    if (!enable_migration) {
+      return absl::FailedPreconditionError(
+          "The properties of the executions are not stored in the Execution "
+          "table. Set enable_upgrade_migration to copy them.");
+    }
+    *num_filled_nodes = id_record_set.records_size();
+    return FillPropertiesBytes<Execution>(ConvertToIds(id_record_set));
+  }
+  MLMD_RETURN_IF_ERROR(executor_->SelectContextIDsWithoutPropertiesBytes(
+      max_num_nodes, &id_record_set));
+  if (id_record_set.records_size() > 0) {
+    if (!enable_migration) {
+      return absl::FailedPreconditionError(
+          "The properties of the contexts are not stored in the Context "
+          "table. Set enable_upgrade_migration to copy them.");
+    }
+    *num_filled_nodes = id_record_set.records_size();
+    return FillPropertiesBytes<Context>(ConvertToIds(id_record_set));
+  }
+  executor_->SetInlineNodeProperties(true);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateIdempotencyKeyTable() {
+  if (executor_->CheckIdempotencyKeyTable().ok()) return absl::OkStatus();
+  return executor_->CreateIdempotencyKeyTable();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindIdempotencyKey(
+    const absl::string_view idempotency_key, int64* request_fingerprint,
+    absl::Time* create_time, std::string* response) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectIdempotencyKey(idempotency_key, &record_set));
+  if (record_set.records_size() == 0) {
+    return absl::NotFoundError(
+        absl::StrCat("No idempotency key found: ", idempotency_key));
+  }
+  const RecordSet::Record& record = record_set.records(0);
+  int64 create_time_millis;
+  CHECK(absl::SimpleAtoi(record.values(0), request_fingerprint));
+  CHECK(absl::SimpleAtoi(record.values(1), &create_time_millis));
+  *create_time = absl::FromUnixMillis(create_time_millis);
+  *response = record.values(2) == kMetadataSourceNull ? "" : record.values(2);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateIdempotencyKey(
+    const absl::string_view idempotency_key, const int64 request_fingerprint,
+    const absl::Time create_time, const absl::string_view response) {
+  const absl::Status status = executor_->InsertIdempotencyKey(
+      idempotency_key, request_fingerprint, create_time, response);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "The idempotency key already exists: ", idempotency_key));
+  }
+  return status;
+}
+
+absl::Status RDBMSMetadataAccessObject::FindIdempotencyKeysCreatedBefore(
+    const absl::Time create_time, const int64 max_num_keys,
+    std::vector<std::string>* idempotency_keys) {
+  idempotency_keys->clear();
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectIdempotencyKeysCreatedBefore(
+      create_time, max_num_keys, &record_set));
+  idempotency_keys->reserve(record_set.records_size());
+  for (const RecordSet::Record& record : record_set.records()) {
+    idempotency_keys->push_back(record.values(0));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateLineageClosureTable(
+    bool* created) {
+  *created = !executor_->CheckLineageClosureTable().ok();
+  if (!*created) return absl::OkStatus();
+  return executor_->CreateLineageClosureTable();
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateLineageClosure(
+    const absl::Span<const int64> upstream_artifact_ids,
+    const absl::Span<const int64> downstream_artifact_ids) {
+  // Each pair is recorded in both directions, so that the artifacts in either
+  // direction are read with a prefix of the primary key.
+  std::vector<std::array<int64, 3>> rows;
+  rows.reserve(2 * upstream_artifact_ids.size() *
+               downstream_artifact_ids.size());
+  for (const int64 upstream_id : upstream_artifact_ids) {
+    for (const int64 downstream_id : downstream_artifact_ids) {
+      // An artifact read and written by the same execution is not its own
+      // ancestor.
+      if (upstream_id == downstream_id) continue;
+      rows.push_back({downstream_id, kLineageClosureUpstream, upstream_id});
+      rows.push_back({upstream_id, kLineageClosureDownstream, downstream_id});
+    }
+  }
+  if (rows.empty()) return absl::OkStatus();
+  return executor_->InsertLineageClosureIfNotExist(rows);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindLineageClosure(
+    const absl::Span<const int64> artifact_ids, const bool upstream,
+    std::vector<int64>* related_artifact_ids) {
+  related_artifact_ids->clear();
+  absl::flat_hash_set<int64> found_ids;
+  for (const absl::Span<const int64> chunk_ids :
+       SplitIdsForQueries(artifact_ids, *executor_)) {
+    if (chunk_ids.empty()) continue;
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectLineageClosure(
+        chunk_ids,
+        upstream ? kLineageClosureUpstream : kLineageClosureDownstream,
+        &record_set));
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 related_artifact_id;
+      CHECK(absl::SimpleAtoi(record.values(1), &related_artifact_id));
+      if (found_ids.insert(related_artifact_id).second) {
+        related_artifact_ids->push_back(related_artifact_id);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::MaintainNodePropertiesBytes() {
+  executor_->SetWriteNodePropertiesBytes(
+      executor_->CheckNodePropertiesBytesColumns().ok());
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::FillPropertiesBytes(
+    const absl::Span<const int64> node_ids) {
+  std::vector<Node> nodes;
+  MLMD_RETURN_IF_ERROR(
+      FindNodesImpl(node_ids, /*skipped_ids_ok=*/false, nodes));
+  for (const Node& node : nodes) {
+    MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes(node.id(), node));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdatePropertiesBytes(
+    const int64 node_id, const Artifact& artifact) {
+  return executor_->UpdateArtifactPropertiesBytes(node_id, artifact);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdatePropertiesBytes(
+    const int64 node_id, const Execution& execution) {
+  return executor_->UpdateExecutionPropertiesBytes(node_id, execution);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdatePropertiesBytes(
+    const int64 node_id, const Context& context) {
+  return executor_->UpdateContextPropertiesBytes(node_id, context);
+}
+
 // Creates an Artifact (without properties).
 absl::Status RDBMSMetadataAccessObject::CreateBasicNode(
     const Artifact& artifact, int64* node_id) {
@@ -390,40 +766,115 @@ absl::Status RDBMSMetadataAccessObject::CreateBasicNode(const Context& context,
                                   node_id);
 }
 
+// Creates a batch of Artifacts (without properties).
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Artifact> artifacts, std::vector<int64>* node_ids) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertArtifacts(artifacts, now, now, node_ids);
+}
+
+// Creates a batch of Executions (without properties).
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* node_ids) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertExecutions(executions, now, now, node_ids);
+}
+
+// Creates a batch of Contexts (without properties).
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Context> contexts, std::vector<int64>* node_ids) {
+  for (const Context& context : contexts) {
+    if (!context.has_name() || context.name().empty()) {
+      return absl::InvalidArgumentError("Context name should not be empty");
+    }
+  }
+  const absl::Time now = absl::Now();
+  return executor_->InsertContexts(contexts, now, now, node_ids);
+}
+
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
+    const absl::Span<const int64> ids, TypedRecordSet* header,
+    TypedRecordSet* properties, const PropertyOptions& property_options,
     Context* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectContextPropertyByContextID(ids, properties));
+  if (property_options.skip_properties()) {
+    return executor_->SelectContextsByID(ids, header);
   }
-  return absl::OkStatus();
+  const std::vector<std::string> names(
+      property_options.property_names().begin(),
+      property_options.property_names().end());
+  return executor_->SelectContextsWithPropertiesByID(ids, names, header,
+                                                     properties);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
+    const absl::Span<const int64> ids, TypedRecordSet* header,
+    TypedRecordSet* properties, const PropertyOptions& property_options,
     Artifact* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectArtifactPropertyByArtifactID(ids, properties));
+  if (property_options.skip_properties()) {
+    return executor_->SelectArtifactsByID(ids, header);
   }
-  return absl::OkStatus();
+  const std::vector<std::string> names(
+      property_options.property_names().begin(),
+      property_options.property_names().end());
+  return executor_->SelectArtifactsWithPropertiesByID(ids, names, header,
+                                                      properties);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
+    const absl::Span<const int64> ids, TypedRecordSet* header,
+    TypedRecordSet* properties, const PropertyOptions& property_options,
     Execution* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectExecutionPropertyByExecutionID(ids, properties));
+  if (property_options.skip_properties()) {
+    return executor_->SelectExecutionsByID(ids, header);
   }
-  return absl::OkStatus();
+  const std::vector<std::string> names(
+      property_options.property_names().begin(),
+      property_options.property_names().end());
+  return executor_->SelectExecutionsWithPropertiesByID(ids, names, header,
+                                                       properties);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveNodesByTypeIdAndNames(
+    const int64 type_id, const absl::Span<const std::string> names,
+    TypedRecordSet* header, TypedRecordSet* properties, Context* tag) {
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectContextsByTypeIDAndContextNames(type_id, names, header));
+  if (header->num_rows() == 0) {
+    return absl::OkStatus();
+  }
+  const std::vector<int64> ids = ConvertToIds(*header);
+  return executor_->SelectContextPropertyByContextID(ids, properties);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveNodesByTypeIdAndNames(
+    const int64 type_id, const absl::Span<const std::string> names,
+    TypedRecordSet* header, TypedRecordSet* properties, Artifact* tag) {
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByTypeIDAndArtifactNames(
+      type_id, names, header));
+  if (header->num_rows() == 0) {
+    return absl::OkStatus();
+  }
+  const std::vector<int64> ids = ConvertToIds(*header);
+  return executor_->SelectArtifactPropertyByArtifactID(ids, properties);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveNodesByTypeIdAndNames(
+    const int64 type_id, const absl::Span<const std::string> names,
+    TypedRecordSet* header, TypedRecordSet* properties, Execution* tag) {
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByTypeIDAndExecutionNames(
+      type_id, names, header));
+  if (header->num_rows() == 0) {
+    return absl::OkStatus();
+  }
+  const std::vector<int64> ids = ConvertToIds(*header);
+  return executor_->SelectExecutionPropertyByExecutionID(ids, properties);
 }
 
 // Update an Artifact's type_id, URI and last_update_time.
@@ -456,6 +907,35 @@ absl::Status RDBMSMetadataAccessObject::RunNodeUpdate(const Context& context) {
                                         context.name(), absl::Now());
 }
 
+absl::Status RDBMSMetadataAccessObject::RunConditionalNodeUpdate(
+    const Artifact& artifact, const absl::Time update_time, bool* updated) {
+  return executor_->UpdateArtifactDirectIfUnchanged(
+      artifact.id(), artifact.type_id(), artifact.uri(),
+      artifact.has_state() ? absl::make_optional(artifact.state())
+                           : absl::nullopt,
+      update_time, artifact.last_update_time_since_epoch(), updated);
+}
+
+absl::Status RDBMSMetadataAccessObject::RunConditionalNodeUpdate(
+    const Execution& execution, const absl::Time update_time, bool* updated) {
+  return executor_->UpdateExecutionDirectIfUnchanged(
+      execution.id(), execution.type_id(),
+      execution.has_last_known_state()
+          ? absl::make_optional(execution.last_known_state())
+          : absl::nullopt,
+      update_time, execution.last_update_time_since_epoch(), updated);
+}
+
+absl::Status RDBMSMetadataAccessObject::RunConditionalNodeUpdate(
+    const Context& context, const absl::Time update_time, bool* updated) {
+  if (!context.has_name() || context.name().empty()) {
+    return absl::InvalidArgumentError("Context name should not be empty");
+  }
+  return executor_->UpdateContextDirectIfUnchanged(
+      context.id(), context.type_id(), context.name(), update_time,
+      context.last_update_time_since_epoch(), updated);
+}
+
 // Runs a property insertion query for a NodeType.
 template <typename NodeType>
 absl::Status RDBMSMetadataAccessObject::InsertProperty(
@@ -481,6 +961,25 @@ absl::Status RDBMSMetadataAccessObject::InsertProperty(
   }
 }
 
+// Runs a multi-row property insertion query for a NodeType.
+template <typename NodeType>
+absl::Status RDBMSMetadataAccessObject::InsertProperties(
+    const absl::Span<const NodeProperty> properties) {
+  NodeType node;
+  const TypeKind type_kind = ResolveTypeKind(&node);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->InsertArtifactProperties(properties);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->InsertExecutionProperties(properties);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->InsertContextProperties(properties);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Unsupported TypeKind: ", type_kind));
+  }
+}
+
 // Generates a property update query for a NodeType.
 template <typename NodeType>
 absl::Status RDBMSMetadataAccessObject::UpdateProperty(
@@ -519,6 +1018,24 @@ absl::Status RDBMSMetadataAccessObject::DeleteProperty(
   }
 }
 
+// Runs a multi-row property deletion query for a NodeType.
+template <typename NodeType>
+absl::Status RDBMSMetadataAccessObject::DeleteProperties(
+    const absl::Span<const NodePropertyName> property_names) {
+  NodeType type;
+  const TypeKind type_kind = ResolveTypeKind(&type);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->DeleteArtifactProperties(property_names);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->DeleteExecutionProperties(property_names);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->DeleteContextProperties(property_names);
+    default:
+      return absl::InternalError("Unsupported TypeKind.");
+  }
+}
+
 // Generates a list of queries for the `curr_properties` (C) based on the given
 // `prev_properties` (P). A property definition is a 2-tuple (name, value_type).
 // a) any property in the intersection of C and P, a update query is generated.
@@ -534,7 +1051,8 @@ template <typename NodeType>
 absl::Status RDBMSMetadataAccessObject::ModifyProperties(
     const google::protobuf::Map<std::string, Value>& curr_properties,
     const google::protobuf::Map<std::string, Value>& prev_properties, const int64 node_id,
-    const bool is_custom_property, int& output_num_changed_properties) {
+    const bool is_custom_property, const SerializedStructs* serialized_structs,
+    int& output_num_changed_properties) {
   output_num_changed_properties = 0;
   // generates delete clauses for properties in P \ C
   for (const auto& p : prev_properties) {
@@ -555,8 +1073,9 @@ absl::Status RDBMSMetadataAccessObject::ModifyProperties(
     const auto prev_value_it = prev_properties.find(name);
     if (prev_value_it != prev_properties.end() &&
         prev_value_it->second.value_case() == p.second.value_case()) {
-      if (!google::protobuf::util::MessageDifferencer::Equals(prev_value_it->second,
-                                                    value)) {
+      if (!PropertyValueEquals(value, prev_value_it->second,
+                               serialized_structs, node_id, is_custom_property,
+                               name)) {
         // generates update clauses for properties in the intersection P & C
         MLMD_RETURN_IF_ERROR(UpdateProperty<NodeType>(node_id, name, value));
         output_num_changed_properties++;
@@ -602,14 +1121,46 @@ absl::Status RDBMSMetadataAccessObject::InsertTypeID(const ContextType& type,
       type_id);
 }
 
+// Creates a query to insert an artifact type with a given id.
+absl::Status RDBMSMetadataAccessObject::InsertTypeWithID(
+    const ArtifactType& type, const int64 type_id) {
+  return executor_->InsertTypeWithID(
+      type_id, TypeKind::ARTIFACT_TYPE, type.name(), GetTypeVersion(type),
+      type.has_description() ? absl::make_optional(type.description())
+                             : absl::nullopt,
+      /*input_type=*/nullptr, /*output_type=*/nullptr);
+}
+
+// Creates a query to insert an execution type with a given id.
+absl::Status RDBMSMetadataAccessObject::InsertTypeWithID(
+    const ExecutionType& type, const int64 type_id) {
+  return executor_->InsertTypeWithID(
+      type_id, TypeKind::EXECUTION_TYPE, type.name(), GetTypeVersion(type),
+      type.has_description() ? absl::make_optional(type.description())
+                             : absl::nullopt,
+      type.has_input_type() ? &type.input_type() : nullptr,
+      type.has_output_type() ? &type.output_type() : nullptr);
+}
+
+// Creates a query to insert a context type with a given id.
+absl::Status RDBMSMetadataAccessObject::InsertTypeWithID(
+    const ContextType& type, const int64 type_id) {
+  return executor_->InsertTypeWithID(
+      type_id, TypeKind::CONTEXT_TYPE, type.name(), GetTypeVersion(type),
+      type.has_description() ? absl::make_optional(type.description())
+                             : absl::nullopt,
+      /*input_type=*/nullptr, /*output_type=*/nullptr);
+}
+
 // Creates a `Type` where acceptable ones are in {ArtifactType, ExecutionType,
-// ContextType}.
+// ContextType}, with the `given_type_id` if any.
 // Returns INVALID_ARGUMENT error, if name field is not given.
 // Returns INVALID_ARGUMENT error, if any property type is unknown.
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename Type>
-absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
-                                                       int64* type_id) {
+absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(
+    const Type& type, const absl::optional<int64> given_type_id,
+    int64* type_id) {
   const std::string& type_name = type.name();
   const google::protobuf::Map<std::string, PropertyType>& type_properties =
       type.properties();
@@ -621,7 +1172,13 @@ absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
     LOG(INFO) << "No property is defined for the Type";
 
   // insert a type and get its given id
-  MLMD_RETURN_IF_ERROR(InsertTypeID(type, type_id));
+  InvalidateTypeCache();
+  if (given_type_id) {
+    *type_id = *given_type_id;
+    MLMD_RETURN_IF_ERROR(InsertTypeWithID(type, *type_id));
+  } else {
+    MLMD_RETURN_IF_ERROR(InsertTypeID(type, type_id));
+  }
 
   // insert type properties and commit
   for (const auto& property : type_properties) {
@@ -644,32 +1201,124 @@ absl::Status RDBMSMetadataAccessObject::GenerateFindAllTypeInstancesQuery(
   return executor_->SelectAllTypes(type_kind, record_set);
 }
 
-// FindType takes a result of a query for types, and populates additional
-// information such as properties, and returns it in `types`.
-template <typename MessageType>
-absl::Status RDBMSMetadataAccessObject::FindTypesFromRecordSet(
-    const RecordSet& type_record_set, std::vector<MessageType>* types) {
-  // Query type with the given condition
-  const int num_records = type_record_set.records_size();
-  types->resize(num_records);
-  for (int i = 0; i < num_records; ++i) {
-    MLMD_RETURN_IF_ERROR(
-        ParseRecordSetToMessage(type_record_set, &types->at(i), i));
+// FindType takes a result of a query for types, and populates additional
+// information such as properties, and returns it in `types`.
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypesFromRecordSet(
+    const RecordSet& type_record_set, std::vector<MessageType>* types) {
+  // Query type with the given condition
+  const int num_records = type_record_set.records_size();
+  types->resize(num_records);
+  std::vector<int64> type_ids;
+  type_ids.reserve(num_records);
+  absl::flat_hash_map<int64, MessageType*> type_by_id;
+  const std::vector<const google::protobuf::FieldDescriptor*> column_fields =
+      ResolveColumnFields<MessageType>(type_record_set.column_names());
+  for (int i = 0; i < num_records; ++i) {
+    MLMD_RETURN_IF_ERROR(ParseRecordSetToMessage(type_record_set,
+                                                 column_fields, i,
+                                                 &types->at(i)));
+    type_ids.push_back(types->at(i).id());
+    type_by_id[types->at(i).id()] = &types->at(i);
+  }
+  if (type_ids.empty()) return absl::OkStatus();
+
+  // The properties of all types are read with one query, and grouped by the
+  // type_id in the first column.
+  RecordSet property_record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectPropertiesByTypeIDs(type_ids, &property_record_set));
+  absl::flat_hash_map<int64, RecordSet> property_record_set_by_type_id;
+  for (const RecordSet::Record& record : property_record_set.records()) {
+    int64 type_id;
+    if (record.values_size() != 3 ||
+        !absl::SimpleAtoi(record.values(0), &type_id)) {
+      return absl::InternalError(
+          absl::StrCat("Cannot parse the type property: ",
+                       record.DebugString()));
+    }
+    RecordSet::Record* property_record =
+        property_record_set_by_type_id[type_id].add_records();
+    property_record->add_values(record.values(1));
+    property_record->add_values(record.values(2));
+  }
+  for (const auto& type_properties : property_record_set_by_type_id) {
+    const auto type_it = type_by_id.find(type_properties.first);
+    if (type_it == type_by_id.end()) continue;
+    MLMD_RETURN_IF_ERROR(ParseRecordSetToMapField(
+        type_properties.second, "properties", type_it->second));
+  }
+
+  return absl::OkStatus();
+}
+
+void RDBMSMetadataAccessObject::NoteCacheGenerations() {
+  // The transaction about to begin is the next one of the source.
+  cache_generations_transaction_ = metadata_source_->num_transactions() + 1;
+  if (type_cache_ != nullptr) {
+    type_cache_generation_ = type_cache_->generation();
+  }
+  if (node_cache_ != nullptr) {
+    node_cache_generation_ = node_cache_->generation();
+  }
+}
+
+TypeCache* RDBMSMetadataAccessObject::GetTypeCache() const {
+  if (type_cache_ == nullptr ||
+      metadata_source_->num_transactions() == type_changing_transaction_ ||
+      metadata_source_->num_transactions() != cache_generations_transaction_) {
+    return nullptr;
+  }
+  return type_cache_;
+}
+
+void RDBMSMetadataAccessObject::InvalidateTypeCache() {
+  if (type_cache_ == nullptr) return;
+  type_changing_transaction_ = metadata_source_->num_transactions();
+  type_cache_->Invalidate();
+}
+
+NodeCache* RDBMSMetadataAccessObject::GetNodeCache() const {
+  if (node_cache_ == nullptr || pinned_read_ ||
+      metadata_source_->num_transactions() == node_changing_transaction_ ||
+      metadata_source_->num_transactions() != cache_generations_transaction_) {
+    return nullptr;
+  }
+  return node_cache_;
+}
 
-    RecordSet property_record_set;
-    MLMD_RETURN_IF_ERROR(executor_->SelectPropertyByTypeID(
-        types->at(i).id(), &property_record_set));
+bool RDBMSMetadataAccessObject::FillsCaches() const {
+  return !pinned_read_ && (metadata_source_ == nullptr ||
+                           !metadata_source_->reads_from_replica());
+}
 
-    MLMD_RETURN_IF_ERROR(ParseRecordSetToMapField(property_record_set,
-                                                  "properties", &types->at(i)));
+NodeCache* RDBMSMetadataAccessObject::GetSerializedNodeCache(
+    int64* schema_version) {
+  NodeCache* const node_cache = GetNodeCache();
+  if (node_cache == nullptr || !node_cache->retains_serialized_nodes()) {
+    return nullptr;
   }
+  *schema_version = schema_version_;
+  return node_cache;
+}
 
-  return absl::OkStatus();
+template <typename Node>
+void RDBMSMetadataAccessObject::InvalidateNodeCache(
+    const absl::Span<const int64> node_ids) {
+  if (node_cache_ == nullptr) return;
+  node_changing_transaction_ = metadata_source_->num_transactions();
+  node_cache_->Invalidate<Node>(node_ids);
 }
 
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
                                                      MessageType* type) {
+  TypeCache* const type_cache = GetTypeCache();
+  const int64 cache_generation = type_cache_generation_;
+  if (type_cache != nullptr &&
+      type_cache->FindById(schema_version_, type_id, type)) {
+    return absl::OkStatus();
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
@@ -681,6 +1330,9 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
         absl::StrCat("No type found for query, type_id: ", type_id));
   }
   *type = std::move(types[0]);
+  if (type_cache != nullptr && FillsCaches()) {
+    type_cache->Insert(schema_version_, cache_generation, *type);
+  }
   return absl::OkStatus();
 }
 
@@ -688,6 +1340,12 @@ template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
     absl::string_view name, absl::optional<absl::string_view> version,
     MessageType* type) {
+  TypeCache* const type_cache = GetTypeCache();
+  const int64 cache_generation = type_cache_generation_;
+  if (type_cache != nullptr && type_cache->FindByNameAndVersion(
+                                   schema_version_, name, version, type)) {
+    return absl::OkStatus();
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectTypeByNameAndVersion(
@@ -700,6 +1358,98 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
                      version ? *version : "nullopt", "`"));
   }
   *type = std::move(types[0]);
+  if (type_cache != nullptr && FillsCaches()) {
+    type_cache->Insert(schema_version_, cache_generation, *type);
+  }
+  return absl::OkStatus();
+}
+
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypesByNamesAndVersionsImpl(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<MessageType>* types) {
+  types->clear();
+  TypeCache* const type_cache = GetTypeCache();
+  const int64 cache_generation = type_cache_generation_;
+  absl::flat_hash_set<std::pair<std::string, std::string>> requested;
+  absl::flat_hash_set<std::pair<std::string, std::string>> missing;
+  absl::flat_hash_set<std::string> missing_name_set;
+  std::vector<std::string> missing_names;
+  for (const auto& name_and_version : names_and_versions) {
+    if (!requested.insert(name_and_version).second) continue;
+    MessageType type;
+    if (type_cache != nullptr &&
+        type_cache->FindByNameAndVersion(
+            schema_version_, name_and_version.first,
+            name_and_version.second.empty()
+                ? absl::nullopt
+                : absl::make_optional<absl::string_view>(
+                      name_and_version.second),
+            &type)) {
+      types->push_back(std::move(type));
+      continue;
+    }
+    missing.insert(name_and_version);
+    if (missing_name_set.insert(name_and_version.first).second) {
+      missing_names.push_back(name_and_version.first);
+    }
+  }
+  if (missing_names.empty()) return absl::OkStatus();
+
+  MessageType tag;
+  const TypeKind type_kind = ResolveTypeKind(&tag);
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectTypesByNames(missing_names, type_kind, &record_set));
+  std::vector<MessageType> found_types;
+  MLMD_RETURN_IF_ERROR(FindTypesFromRecordSet(record_set, &found_types));
+  for (MessageType& found_type : found_types) {
+    if (!missing.contains(
+            std::make_pair(found_type.name(), found_type.version()))) {
+      continue;
+    }
+    if (type_cache != nullptr && FillsCaches()) {
+      type_cache->Insert(schema_version_, cache_generation, found_type);
+    }
+    types->push_back(std::move(found_type));
+  }
+  return absl::OkStatus();
+}
+
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypesByIdsImpl(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, MessageType>* types) {
+  TypeCache* const type_cache = GetTypeCache();
+  const int64 cache_generation = type_cache_generation_;
+  std::vector<int64> missing_ids;
+  for (const int64 type_id : type_ids) {
+    if (types->contains(type_id)) continue;
+    MessageType type;
+    if (type_cache != nullptr &&
+        type_cache->FindById(schema_version_, type_id, &type)) {
+      types->insert({type_id, std::move(type)});
+      continue;
+    }
+    missing_ids.push_back(type_id);
+  }
+  if (missing_ids.empty()) return absl::OkStatus();
+
+  MessageType tag;
+  const TypeKind type_kind = ResolveTypeKind(&tag);
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectTypesByIDs(missing_ids, type_kind, &record_set));
+  std::vector<MessageType> found_types;
+  MLMD_RETURN_IF_ERROR(FindTypesFromRecordSet(record_set, &found_types));
+  for (MessageType& found_type : found_types) {
+    if (type_cache != nullptr && FillsCaches()) {
+      type_cache->Insert(schema_version_, cache_generation, found_type);
+    }
+    const int64 type_id = found_type.id();
+    types->insert({type_id, std::move(found_type)});
+  }
   return absl::OkStatus();
 }
 
@@ -708,13 +1458,23 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindAllTypeInstancesImpl(
     std::vector<MessageType>* types) {
+  TypeCache* const type_cache = GetTypeCache();
+  const int64 cache_generation = type_cache_generation_;
   MessageType type;
   const TypeKind type_kind = ResolveTypeKind(&type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       GenerateFindAllTypeInstancesQuery(type_kind, &record_set));
 
-  return FindTypesFromRecordSet(record_set, types);
+  MLMD_RETURN_IF_ERROR(FindTypesFromRecordSet(record_set, types));
+  // The listed types are cached, so that listing them once, e.g., when a
+  // server warms up, serves the later lookups by id or name.
+  if (type_cache != nullptr && FillsCaches()) {
+    for (const MessageType& found_type : *types) {
+      type_cache->Insert(schema_version_, cache_generation, found_type);
+    }
+  }
+  return absl::OkStatus();
 }
 
 // Updates an existing type. A type is one of {ArtifactType, ExecutionType,
@@ -758,6 +1518,7 @@ absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
       }
       continue;
     }
+    InvalidateTypeCache();
     MLMD_RETURN_IF_ERROR(executor_->InsertTypeProperty(
         stored_type.id(), property_name, property_type));
   }
@@ -768,29 +1529,28 @@ template <typename Type>
 absl::Status RDBMSMetadataAccessObject::CreateParentTypeImpl(
     const int64 type_id, const int64 parent_type_id) {
   // Check whether there is a cyclic dependency if we insert the tuple:
-  // (type_id, parent_type_id). We do a DFS traversal from `parent_type_id` as
+  // (type_id, parent_type_id). We do a BFS traversal from `parent_type_id` as
   // the root node and it introduces a cycle if any ancestors is `type_id`. It
-  // assumes that existing parent types inheritance are acyclic.
+  // assumes that existing parent types inheritance are acyclic. Each level of
+  // ancestors is read with one query.
   std::vector<int64> ancestor_ids = {parent_type_id};
-  absl::flat_hash_set<int64> visited_ancestors_ids;
+  absl::flat_hash_set<int64> visited_ancestors_ids = {parent_type_id};
   while (!ancestor_ids.empty()) {
-    const int64 ancestor_id = ancestor_ids.back();
-    if (ancestor_id == type_id) {
+    if (absl::c_linear_search(ancestor_ids, type_id)) {
       return absl::InvalidArgumentError(
           "There is a cycle detected of the given parent type.");
     }
-    ancestor_ids.pop_back();
-    if (visited_ancestors_ids.contains(ancestor_id)) {
-      continue;
-    }
-    visited_ancestors_ids.insert(ancestor_id);
     RecordSet record_set;
     MLMD_RETURN_IF_ERROR(
-        executor_->SelectParentTypesByTypeID(ancestor_id, &record_set));
+        executor_->SelectParentTypesByTypeIDs(ancestor_ids, &record_set));
+    ancestor_ids.clear();
     for (const int64 parent_id : ParentTypesToParentTypeIds(record_set)) {
-      ancestor_ids.push_back(parent_id);
+      if (visited_ancestors_ids.insert(parent_id).second) {
+        ancestor_ids.push_back(parent_id);
+      }
     }
   }
+  InvalidateTypeCache();
   const absl::Status status =
       executor_->InsertParentType(type_id, parent_type_id);
   if (IsUniqueConstraintViolated(status)) {
@@ -805,15 +1565,41 @@ absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIdImpl(
   // check the there's a Type instance with the given type_id
   Type type;
   MLMD_RETURN_IF_ERROR(FindTypeImpl(type_id, &type));
+  absl::flat_hash_map<int64, std::vector<Type>> parent_types;
+  MLMD_RETURN_IF_ERROR(FindParentTypesByTypeIdsImpl({type_id}, parent_types));
+  const auto it = parent_types.find(type_id);
+  if (it != parent_types.end()) {
+    output_parent_types.insert(output_parent_types.end(),
+                               std::make_move_iterator(it->second.begin()),
+                               std::make_move_iterator(it->second.end()));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIdsImpl(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<Type>>& output_parent_types) {
+  if (type_ids.empty()) return absl::OkStatus();
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
-      executor_->SelectParentTypesByTypeID(type_id, &record_set));
-  const std::vector<int64> ids = ParentTypesToParentTypeIds(record_set);
-  const int output_size = output_parent_types.size();
-  output_parent_types.resize(output_size + ids.size());
-  // TODO(b/169075639) Use a single query to retrieve a list of types.
-  for (int i = output_size; i < output_size + ids.size(); i++) {
-    MLMD_RETURN_IF_ERROR(FindTypeImpl(ids[i], &output_parent_types.at(i)));
+      executor_->SelectParentTypesByTypeIDs(type_ids, &record_set));
+  const std::vector<int64> child_ids =
+      ConvertToIds(record_set, /*position=*/0);
+  const std::vector<int64> parent_ids = ParentTypesToParentTypeIds(record_set);
+  absl::flat_hash_map<int64, Type> parent_type_by_id;
+  MLMD_RETURN_IF_ERROR(FindTypesByIdsImpl(parent_ids, &parent_type_by_id));
+  // The links of the types of other kinds have no parent of the kind.
+  absl::flat_hash_map<int64, std::vector<Type>> parent_types;
+  for (int i = 0; i < child_ids.size(); ++i) {
+    const auto it = parent_type_by_id.find(parent_ids[i]);
+    if (it != parent_type_by_id.end()) {
+      parent_types[child_ids[i]].push_back(it->second);
+    }
+  }
+  for (auto& type_parent_types : parent_types) {
+    output_parent_types[type_parent_types.first] =
+        std::move(type_parent_types.second);
   }
   return absl::OkStatus();
 }
@@ -847,61 +1633,137 @@ absl::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateBasicNode(node, node_id),
                                     "Cannot create node for ",
                                     node.ShortDebugString());
+  InvalidateNodeCache<Node>({*node_id});
 
   // insert properties
   const google::protobuf::Map<std::string, Value> prev_properties;
   int num_changed_properties = 0;
   MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
       node.properties(), prev_properties, *node_id,
-      /*is_custom_property=*/false, num_changed_properties));
+      /*is_custom_property=*/false, /*serialized_structs=*/nullptr,
+      num_changed_properties));
   int num_changed_custom_properties = 0;
   MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
       node.custom_properties(), prev_properties, *node_id,
-      /*is_custom_property=*/true, num_changed_custom_properties));
+      /*is_custom_property=*/true, /*serialized_structs=*/nullptr,
+      num_changed_custom_properties));
+  if (executor_->WritesNodePropertiesBytes()) {
+    MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes(*node_id, node));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::CreateNodesImpl(
+    const absl::Span<const Node> nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  // validate the types and properties of all nodes, looking up each type once
+  absl::flat_hash_map<int64, NodeType> types;
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return absl::InvalidArgumentError("Type id is missing.");
+    auto it = types.find(node.type_id());
+    if (it == types.end()) {
+      NodeType node_type;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          FindTypeImpl(node.type_id(), &node_type), "Cannot find type for ",
+          node.ShortDebugString());
+      it = types.insert({node.type_id(), std::move(node_type)}).first;
+    }
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, it->second),
+        "Cannot validate properties of ", node.ShortDebugString());
+  }
+
+  // insert the nodes and get the assigned ids
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateBasicNodes(nodes, node_ids),
+                                    "Cannot create ", nodes.size(), " nodes");
+  if (node_ids->size() != nodes.size()) {
+    return absl::InternalError(
+        absl::StrCat("Created ", node_ids->size(), " ids for ", nodes.size(),
+                     " nodes"));
+  }
+  InvalidateNodeCache<Node>(*node_ids);
+
+  // insert the properties of all nodes
+  std::vector<NodeProperty> properties;
+  for (int i = 0; i < nodes.size(); i++) {
+    for (const auto& property : nodes[i].properties()) {
+      properties.push_back({(*node_ids)[i], property.first,
+                            /*is_custom_property=*/false, &property.second});
+    }
+    for (const auto& property : nodes[i].custom_properties()) {
+      properties.push_back({(*node_ids)[i], property.first,
+                            /*is_custom_property=*/true, &property.second});
+    }
+  }
+  MLMD_RETURN_IF_ERROR(InsertProperties<NodeType>(properties));
+  if (executor_->WritesNodePropertiesBytes()) {
+    for (int i = 0; i < nodes.size(); i++) {
+      MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes((*node_ids)[i], nodes[i]));
+    }
+  }
   return absl::OkStatus();
 }
 
 template <typename Node>
 absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
     const absl::Span<const int64> node_ids, const bool skipped_ids_ok,
-    std::vector<Node>& nodes) {
+    std::vector<Node>& nodes, SerializedStructs* serialized_structs,
+    const PropertyOptions& property_options) {
   if (node_ids.empty()) {
     return absl::InvalidArgumentError("ids cannot be empty");
   }
 
-  if (!nodes.empty()) {
-    return absl::InvalidArgumentError("nodes parameter is not empty");
+  // Only the nodes with all their properties are cached, and the callers
+  // comparing the stored structs always read them from the database.
+  NodeCache* const node_cache =
+      serialized_structs == nullptr && !property_options.skip_properties() &&
+              property_options.property_names().empty()
+          ? GetNodeCache()
+          : nullptr;
+  const int64 cache_generation = node_cache_generation_;
+  std::vector<Node> cached_nodes;
+  std::vector<int64> uncached_ids;
+  if (node_cache != nullptr) {
+    absl::flat_hash_set<int64> looked_up_ids;
+    for (const int64 node_id : node_ids) {
+      if (!looked_up_ids.insert(node_id).second) continue;
+      Node cached_node;
+      if (node_cache->Find(schema_version_, node_id, &cached_node)) {
+        cached_nodes.push_back(std::move(cached_node));
+      } else {
+        uncached_ids.push_back(node_id);
+      }
+    }
   }
 
-  RecordSet node_record_set;
-  RecordSet properties_record_set;
-
-  MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(node_ids, &node_record_set,
-                                               &properties_record_set));
-
-  MLMD_RETURN_IF_ERROR(ParseRecordSetToMessageArray(node_record_set, &nodes));
-
-  // if there are properties associated with the nodes, parse the returned
-  // values.
-  if (!properties_record_set.records().empty()) {
-    // First we build a hash map from node ids to Node messages, to
-    // facilitate lookups.
-    absl::flat_hash_map<int64, typename std::vector<Node>::iterator> node_by_id;
-    for (auto i = nodes.begin(); i != nodes.end(); ++i) {
-      node_by_id.insert({i->id(), i});
+  const absl::Span<const int64> retrieved_ids =
+      node_cache != nullptr ? absl::MakeConstSpan(uncached_ids) : node_ids;
+  if (!retrieved_ids.empty()) {
+    TypedRecordSet node_record_set;
+    TypedRecordSet properties_record_set;
+    for (const absl::Span<const int64> chunk_ids :
+         SplitIdsForQueries(retrieved_ids, *executor_)) {
+      TypedRecordSet chunk_node_record_set;
+      TypedRecordSet chunk_properties_record_set;
+      MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(
+          chunk_ids, &chunk_node_record_set, &chunk_properties_record_set,
+          property_options));
+      AppendChunkRows(std::move(chunk_node_record_set), node_record_set);
+      AppendChunkRows(std::move(chunk_properties_record_set),
+                      properties_record_set);
     }
-
-    CHECK_EQ(properties_record_set.column_names_size(), 6);
-    for (const RecordSet::Record& record : properties_record_set.records()) {
-      // Match the record against a node in the hash map.
-      int64 node_id;
-      CHECK(absl::SimpleAtoi(record.values(0), &node_id));
-      auto iter = node_by_id.find(node_id);
-      CHECK(iter != node_by_id.end());
-      Node& node = *iter->second;
-
-      MLMD_RETURN_IF_ERROR(PopulateNodeProperties(record, node));
+    MLMD_RETURN_IF_ERROR(ParseTypedRecordSetsToNodes(
+        node_record_set, properties_record_set, &nodes, serialized_structs));
+  }
+  if (node_cache != nullptr) {
+    if (FillsCaches()) {
+      for (const Node& node : nodes) {
+        node_cache->Insert(schema_version_, cache_generation, node);
+      }
     }
+    absl::c_move(cached_nodes, std::back_inserter(nodes));
   }
 
   if (node_ids.size() != nodes.size()) {
@@ -922,6 +1784,39 @@ absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
   return absl::OkStatus();
 }
 
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::FindNodesByTypeIdAndNamesImpl(
+    const int64 type_id, const absl::Span<const std::string> names,
+    std::vector<Node>& nodes) {
+  nodes.clear();
+  if (names.empty()) {
+    return absl::OkStatus();
+  }
+  TypedRecordSet node_record_set;
+  TypedRecordSet properties_record_set;
+  MLMD_RETURN_IF_ERROR(RetrieveNodesByTypeIdAndNames<Node>(
+      type_id, names, &node_record_set, &properties_record_set));
+  return ParseTypedRecordSetsToNodes(node_record_set, properties_record_set,
+                                     &nodes);
+}
+
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::StreamNodesImpl(
+    const absl::Span<const int64> node_ids,
+    const NodeBatchCallback<Node>& callback,
+    const PropertyOptions& property_options) {
+  for (size_t begin = 0; begin < node_ids.size();
+       begin += kNodeStreamingBatchSize) {
+    std::vector<Node> nodes;
+    MLMD_RETURN_IF_ERROR(
+        FindNodesImpl(node_ids.subspan(begin, kNodeStreamingBatchSize),
+                      /*skipped_ids_ok=*/false, nodes,
+                      /*serialized_structs=*/nullptr, property_options));
+    MLMD_RETURN_IF_ERROR(callback(nodes));
+  }
+  return absl::OkStatus();
+}
+
 template <typename Node>
 absl::Status RDBMSMetadataAccessObject::FindNodeImpl(const int64 node_id,
                                                      Node* node) {
@@ -941,14 +1836,20 @@ template <typename Node, typename NodeType>
 absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   // validate node
   if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
-
-  Node stored_node;
-  absl::Status status = FindNodeImpl(node.id(), &stored_node);
+  InvalidateNodeCache<Node>({node.id()});
+
+  // The stored struct values are compared with the given ones without
+  // parsing them.
+  std::vector<Node> stored_nodes;
+  SerializedStructs serialized_structs;
+  absl::Status status = FindNodesImpl({node.id()}, /*skipped_ids_ok=*/true,
+                                      stored_nodes, &serialized_structs);
   if (absl::IsNotFound(status)) {
     return absl::InvalidArgumentError(
         absl::StrCat("Cannot find the given id ", node.id()));
   }
   if (!status.ok()) return status;
+  const Node& stored_node = stored_nodes.at(0);
   if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Given type_id ", node.type_id(),
@@ -964,61 +1865,234 @@ absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   int num_changed_properties = 0;
   MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
       node.properties(), stored_node.properties(), node.id(),
-      /*is_custom_property=*/false, num_changed_properties));
+      /*is_custom_property=*/false, &serialized_structs,
+      num_changed_properties));
   int num_changed_custom_properties = 0;
   MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
       node.custom_properties(), stored_node.custom_properties(), node.id(),
-      /*is_custom_property=*/true, num_changed_custom_properties));
+      /*is_custom_property=*/true, &serialized_structs,
+      num_changed_custom_properties));
+  if (executor_->WritesNodePropertiesBytes() &&
+      num_changed_properties + num_changed_custom_properties > 0) {
+    MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes(node.id(), node));
+  }
   // Update node if attributes are different or properties are updated, so that
   // the last_update_time_since_epoch is updated properly.
-  google::protobuf::util::MessageDifferencer diff;
-  diff.IgnoreField(Node::descriptor()->FindFieldByName("properties"));
-  diff.IgnoreField(Node::descriptor()->FindFieldByName("custom_properties"));
-  // create_time_since_epoch and last_update_time_since_epoch are output only
-  // fields. Two nodes are treated as equal as long as other fields match.
-  diff.IgnoreField(
-      Node::descriptor()->FindFieldByName("create_time_since_epoch"));
-  diff.IgnoreField(
-      Node::descriptor()->FindFieldByName("last_update_time_since_epoch"));
-  if (!diff.Compare(node, stored_node) ||
+  if (!NodeAttributesEqual(node, stored_node) ||
       num_changed_properties + num_changed_custom_properties > 0) {
     MLMD_RETURN_IF_ERROR(RunNodeUpdate(node));
   }
   return absl::OkStatus();
 }
 
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::UpdateNodesImpl(
+    const absl::Span<const Node> nodes, const bool check_last_update_time) {
+  if (nodes.empty()) return absl::OkStatus();
+  // validate nodes
+  std::vector<int64> node_ids;
+  node_ids.reserve(nodes.size());
+  absl::flat_hash_set<int64> unique_node_ids;
+  for (const Node& node : nodes) {
+    if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
+    if (!unique_node_ids.insert(node.id()).second) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("The given id ", node.id(), " is updated twice"));
+    }
+    node_ids.push_back(node.id());
+  }
+  InvalidateNodeCache<Node>(node_ids);
+
+  // read all stored nodes with one query
+  std::vector<Node> stored_nodes;
+  SerializedStructs serialized_structs;
+  const absl::Status status = FindNodesImpl(
+      node_ids, /*skipped_ids_ok=*/true, stored_nodes, &serialized_structs);
+  if (!status.ok() && !absl::IsNotFound(status)) return status;
+  absl::flat_hash_map<int64, const Node*> stored_node_by_id;
+  for (const Node& stored_node : stored_nodes) {
+    stored_node_by_id[stored_node.id()] = &stored_node;
+  }
+
+  // Computes the property changes of all nodes. A property which is removed or
+  // changed is deleted, and the changed and new properties are inserted.
+  absl::flat_hash_map<int64, NodeType> types;
+  std::vector<NodePropertyName> deleted_properties;
+  std::vector<NodeProperty> inserted_properties;
+  std::vector<const Node*> updated_nodes;
+  std::vector<const Node*> property_changed_nodes;
+  for (const Node& node : nodes) {
+    const auto stored_node_it = stored_node_by_id.find(node.id());
+    if (stored_node_it == stored_node_by_id.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Cannot find the given id ", node.id()));
+    }
+    const Node& stored_node = *stored_node_it->second;
+    if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Given type_id ", node.type_id(),
+          " is different from the one known before: ", stored_node.type_id()));
+    }
+    if (check_last_update_time &&
+        node.last_update_time_since_epoch() !=
+            stored_node.last_update_time_since_epoch()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The stored node with id = ", node.id(),
+          " has a different last_update_time_since_epoch: ",
+          stored_node.last_update_time_since_epoch(),
+          " from the one in the given node: ",
+          node.last_update_time_since_epoch()));
+    }
+    auto type_it = types.find(stored_node.type_id());
+    if (type_it == types.end()) {
+      NodeType stored_type;
+      MLMD_RETURN_IF_ERROR(FindTypeImpl(stored_node.type_id(), &stored_type));
+      type_it = types.insert({stored_node.type_id(), std::move(stored_type)})
+                    .first;
+    }
+    MLMD_RETURN_IF_ERROR(ValidatePropertiesWithType(node, type_it->second));
+
+    // The delete query removes both the property and the custom property of
+    // a name, so a deleted name is reinserted for both kinds.
+    absl::flat_hash_set<absl::string_view> deleted_names;
+    const auto find_deleted_names =
+        [&](const google::protobuf::Map<std::string, Value>& curr_properties,
+            const google::protobuf::Map<std::string, Value>& prev_properties,
+            const bool is_custom_property) {
+          for (const auto& p : prev_properties) {
+            const auto curr_it = curr_properties.find(p.first);
+            if (curr_it == curr_properties.end() ||
+                !PropertyValueEquals(curr_it->second, p.second,
+                                     &serialized_structs, node.id(),
+                                     is_custom_property, p.first)) {
+              deleted_names.insert(p.first);
+            }
+          }
+        };
+    find_deleted_names(node.properties(), stored_node.properties(),
+                       /*is_custom_property=*/false);
+    find_deleted_names(node.custom_properties(),
+                       stored_node.custom_properties(),
+                       /*is_custom_property=*/true);
+    for (const absl::string_view name : deleted_names) {
+      deleted_properties.push_back({node.id(), name});
+    }
+    bool properties_changed = !deleted_names.empty();
+    const auto find_inserted_properties =
+        [&](const google::protobuf::Map<std::string, Value>& curr_properties,
+            const google::protobuf::Map<std::string, Value>& prev_properties,
+            const bool is_custom_property) {
+          for (const auto& p : curr_properties) {
+            if (deleted_names.contains(p.first) ||
+                prev_properties.find(p.first) == prev_properties.end()) {
+              inserted_properties.push_back(
+                  {node.id(), p.first, is_custom_property, &p.second});
+              properties_changed = true;
+            }
+          }
+        };
+    find_inserted_properties(node.properties(), stored_node.properties(),
+                             /*is_custom_property=*/false);
+    find_inserted_properties(node.custom_properties(),
+                             stored_node.custom_properties(),
+                             /*is_custom_property=*/true);
+    if (properties_changed) property_changed_nodes.push_back(&node);
+    if (check_last_update_time || properties_changed ||
+        !NodeAttributesEqual(node, stored_node)) {
+      updated_nodes.push_back(&node);
+    }
+  }
+
+  // With the check, the rows of the nodes are written first in the order of
+  // the ids, so concurrent writers of the same nodes wait on the first row
+  // instead of deadlocking, and a writer which lost the race fails before
+  // writing any property. The update time is increased past the given one.
+  if (check_last_update_time) {
+    absl::c_sort(updated_nodes, [](const Node* lhs, const Node* rhs) {
+      return lhs->id() < rhs->id();
+    });
+    const absl::Time now = absl::Now();
+    for (const Node* node : updated_nodes) {
+      const absl::Time update_time = std::max(
+          now, absl::FromUnixMillis(node->last_update_time_since_epoch() + 1));
+      bool updated = false;
+      MLMD_RETURN_IF_ERROR(RunConditionalNodeUpdate(*node, update_time,
+                                                    &updated));
+      if (!updated) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "The stored node with id = ", node->id(),
+            " is updated concurrently after last_update_time_since_epoch: ",
+            node->last_update_time_since_epoch()));
+      }
+    }
+    MLMD_RETURN_IF_ERROR(DeleteProperties<NodeType>(deleted_properties));
+    MLMD_RETURN_IF_ERROR(InsertProperties<NodeType>(inserted_properties));
+  } else {
+    // apply the property changes with set-based statements, then update the
+    // changed nodes, so that the last_update_time_since_epoch is updated.
+    MLMD_RETURN_IF_ERROR(DeleteProperties<NodeType>(deleted_properties));
+    MLMD_RETURN_IF_ERROR(InsertProperties<NodeType>(inserted_properties));
+    for (const Node* node : updated_nodes) {
+      MLMD_RETURN_IF_ERROR(RunNodeUpdate(*node));
+    }
+  }
+  if (executor_->WritesNodePropertiesBytes()) {
+    for (const Node* node : property_changed_nodes) {
+      MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes(node->id(), *node));
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Takes a record set that has one record per event, parses them into Event
-// objects, gets the paths for the events from the database using collected
-// event ids, and assign paths to each corresponding event.
+// objects, and assigns the paths of the path record set to each corresponding
+// event.
 // Returns INVALID_ARGUMENT error, if the `events` is null.
 absl::Status RDBMSMetadataAccessObject::FindEventsFromRecordSet(
-    const RecordSet& event_record_set, std::vector<Event>* events) {
+    const RecordSet& event_record_set, const RecordSet& path_record_set,
+    std::vector<Event>* events) {
   if (events == nullptr)
     return absl::InvalidArgumentError("Given events is NULL.");
 
   events->reserve(event_record_set.records_size());
   MLMD_RETURN_IF_ERROR(ParseRecordSetToMessageArray(event_record_set, events));
 
+  // The paths stored inline are parsed from the column of the events.
+  const auto path_bytes_column =
+      absl::c_find(event_record_set.column_names(), "path_bytes");
+  if (path_bytes_column != event_record_set.column_names().end()) {
+    const int column =
+        path_bytes_column - event_record_set.column_names().begin();
+    for (int i = 0; i < events->size(); ++i) {
+      const RecordSet::Record& record = event_record_set.records(i);
+      const std::string& path_bytes = record.values(column);
+      if (path_bytes == kMetadataSourceNull || path_bytes.empty()) continue;
+      if (!(*events)[i].mutable_path()->ParseFromString(path_bytes)) {
+        return absl::InternalError(absl::StrCat(
+            "Failed to parse the path of event ", record.values(0)));
+      }
+    }
+  }
+  if (path_record_set.records_size() == 0) {
+    return absl::OkStatus();
+  }
+
   absl::flat_hash_map<int64, Event*> event_id_to_event_map;
-  std::vector<int64> event_ids;
-  event_ids.reserve(event_record_set.records_size());
   for (int i = 0; i < events->size(); ++i) {
     CHECK_LT(i, event_record_set.records_size());
     const RecordSet::Record& record = event_record_set.records()[i];
     int64 event_id;
     CHECK(absl::SimpleAtoi(record.values(0), &event_id));
     event_id_to_event_map[event_id] = &(*events)[i];
-    event_ids.push_back(event_id);
   }
 
-  RecordSet path_record_set;
-  MLMD_RETURN_IF_ERROR(
-      executor_->SelectEventPathByEventIDs(event_ids, &path_record_set));
   for (const RecordSet::Record& record : path_record_set.records()) {
     int64 event_id;
     CHECK(absl::SimpleAtoi(record.values(0), &event_id));
     auto iter = event_id_to_event_map.find(event_id);
-    CHECK(iter != event_id_to_event_map.end());
+    // The paths are selected by the same ids as the events, but outside of a
+    // transaction they may include the ones of an event inserted since.
+    if (iter == event_id_to_event_map.end()) continue;
     Event* event = iter->second;
     bool is_index_step;
     CHECK(absl::SimpleAtob(record.values(1), &is_index_step));
@@ -1035,17 +2109,35 @@ absl::Status RDBMSMetadataAccessObject::FindEventsFromRecordSet(
 
 absl::Status RDBMSMetadataAccessObject::CreateType(const ArtifactType& type,
                                                    int64* type_id) {
-  return CreateTypeImpl(type, type_id);
+  return CreateTypeImpl(type, /*given_type_id=*/absl::nullopt, type_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateTypeWithId(
+    const ArtifactType& type, const int64 type_id) {
+  int64 created_type_id;
+  return CreateTypeImpl(type, type_id, &created_type_id);
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateType(const ExecutionType& type,
                                                    int64* type_id) {
-  return CreateTypeImpl(type, type_id);
+  return CreateTypeImpl(type, /*given_type_id=*/absl::nullopt, type_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateTypeWithId(
+    const ExecutionType& type, const int64 type_id) {
+  int64 created_type_id;
+  return CreateTypeImpl(type, type_id, &created_type_id);
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateType(const ContextType& type,
                                                    int64* type_id) {
-  return CreateTypeImpl(type, type_id);
+  return CreateTypeImpl(type, /*given_type_id=*/absl::nullopt, type_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateTypeWithId(
+    const ContextType& type, const int64 type_id) {
+  int64 created_type_id;
+  return CreateTypeImpl(type, type_id, &created_type_id);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindTypeById(
@@ -1096,6 +2188,27 @@ absl::Status RDBMSMetadataAccessObject::FindTypeByNameAndVersion(
   return FindTypeImpl(name, version, context_type);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ArtifactType>* artifact_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, artifact_types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ExecutionType>* execution_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, execution_types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ContextType>* context_types) {
+  return FindTypesByNamesAndVersionsImpl(names_and_versions, context_types);
+}
+
 absl::Status RDBMSMetadataAccessObject::UpdateType(const ArtifactType& type) {
   return UpdateTypeImpl(type);
 }
@@ -1153,6 +2266,26 @@ absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeId(
   return FindParentTypesByTypeIdImpl(type_id, output_parent_types);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+        output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+        output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ContextType>>& output_parent_types) {
+  return FindParentTypesByTypeIdsImpl(type_ids, output_parent_types);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateArtifact(const Artifact& artifact,
                                                        int64* artifact_id) {
   const absl::Status& status =
@@ -1165,6 +2298,18 @@ absl::Status RDBMSMetadataAccessObject::CreateArtifact(const Artifact& artifact,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts,
+    std::vector<int64>* artifact_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateExecution(
     const Execution& execution, int64* execution_id) {
   const absl::Status& status =
@@ -1177,6 +2322,18 @@ absl::Status RDBMSMetadataAccessObject::CreateExecution(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* execution_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
                                                       int64* context_id) {
   const absl::Status& status =
@@ -1189,31 +2346,144 @@ absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateContextIfNotExist(
+    const Context& context, int64* context_id, bool* created) {
+  *context_id = 0;
+  *created = false;
+  if (!context.has_type_id())
+    return absl::InvalidArgumentError("Type id is missing.");
+  ContextType context_type;
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      FindTypeImpl(context.type_id(), &context_type), "Cannot find type for ",
+      context.ShortDebugString());
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ValidatePropertiesWithType(context, context_type),
+      "Cannot validate properties of ", context.ShortDebugString());
+  if (!context.has_name() || context.name().empty()) {
+    return absl::InvalidArgumentError("Context name should not be empty");
+  }
+
+  // The insert either creates the context or waits for a concurrent
+  // transaction that creates it, so that neither of them is aborted.
+  const absl::Time now = absl::Now();
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      executor_->InsertContextIfNotExist(context.type_id(), context.name(),
+                                         now, now, context_id, created),
+      "Cannot create node for ", context.ShortDebugString());
+  if (metadata_source_ != nullptr) {
+    if (ensured_contexts_transaction_ != metadata_source_->num_transactions() ||
+        ensured_contexts_savepoint_rollbacks_ !=
+            metadata_source_->num_savepoint_rollbacks()) {
+      ensured_contexts_transaction_ = metadata_source_->num_transactions();
+      ensured_contexts_savepoint_rollbacks_ =
+          metadata_source_->num_savepoint_rollbacks();
+      ensured_context_ids_.clear();
+    }
+    ensured_context_ids_.insert(*context_id);
+  }
+  if (!*created) return absl::OkStatus();
+  InvalidateNodeCache<Context>({*context_id});
+
+  const google::protobuf::Map<std::string, Value> prev_properties;
+  int num_changed_properties = 0;
+  MLMD_RETURN_IF_ERROR(ModifyProperties<ContextType>(
+      context.properties(), prev_properties, *context_id,
+      /*is_custom_property=*/false, /*serialized_structs=*/nullptr,
+      num_changed_properties));
+  int num_changed_custom_properties = 0;
+  MLMD_RETURN_IF_ERROR(ModifyProperties<ContextType>(
+      context.custom_properties(), prev_properties, *context_id,
+      /*is_custom_property=*/true, /*serialized_structs=*/nullptr,
+      num_changed_custom_properties));
+  if (executor_->WritesNodePropertiesBytes()) {
+    MLMD_RETURN_IF_ERROR(UpdatePropertiesBytes(*context_id, context));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CheckContextsExist(
+    const absl::Span<const int64> context_ids) {
+  std::vector<int64> unchecked_context_ids;
+  for (const int64 context_id : context_ids) {
+    if (metadata_source_ == nullptr ||
+        ensured_contexts_transaction_ != metadata_source_->num_transactions() ||
+        ensured_contexts_savepoint_rollbacks_ !=
+            metadata_source_->num_savepoint_rollbacks() ||
+        !ensured_context_ids_.contains(context_id)) {
+      unchecked_context_ids.push_back(context_id);
+    }
+  }
+  if (unchecked_context_ids.empty()) return absl::OkStatus();
+  RecordSet context_id_header;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectContextsByID(unchecked_context_ids, &context_id_header));
+  if (context_id_header.records_size() <
+      static_cast<int>(unchecked_context_ids.size())) {
+    return absl::InvalidArgumentError("Context id not found.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts, std::vector<int64>* context_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Context, ContextType>(contexts, context_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactsById(
     const absl::Span<const int64> artifact_ids,
     std::vector<Artifact>* artifacts) {
+  return FindArtifactsById(artifact_ids, PropertyOptions::default_instance(),
+                           artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts) {
   if (artifact_ids.empty()) {
     return absl::OkStatus();
   }
-  return FindNodesImpl(artifact_ids, /*skipped_ids_ok=*/true, *artifacts);
+  return FindNodesImpl(artifact_ids, /*skipped_ids_ok=*/true, *artifacts,
+                       /*serialized_structs=*/nullptr, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Execution>* executions) {
+  return FindExecutionsById(execution_ids, PropertyOptions::default_instance(),
+                            executions);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindExecutionsById(
     const absl::Span<const int64> execution_ids,
+    const PropertyOptions& property_options,
     std::vector<Execution>* executions) {
   if (execution_ids.empty()) {
     return absl::OkStatus();
   }
-
-  return FindNodesImpl(execution_ids, /*skipped_ids_ok=*/true, *executions);
+  return FindNodesImpl(execution_ids, /*skipped_ids_ok=*/true, *executions,
+                       /*serialized_structs=*/nullptr, property_options);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindContextsById(
     const absl::Span<const int64> context_ids, std::vector<Context>* contexts) {
+  return FindContextsById(context_ids, PropertyOptions::default_instance(),
+                          contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids,
+    const PropertyOptions& property_options, std::vector<Context>* contexts) {
   if (context_ids.empty()) {
     return absl::OkStatus();
   }
-  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/true, *contexts);
+  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/true, *contexts,
+                       /*serialized_structs=*/nullptr, property_options);
 }
 
 absl::Status RDBMSMetadataAccessObject::UpdateArtifact(
@@ -1221,15 +2491,80 @@ absl::Status RDBMSMetadataAccessObject::UpdateArtifact(
   return UpdateNodeImpl<Artifact, ArtifactType>(artifact);
 }
 
+absl::Status RDBMSMetadataAccessObject::UpdateArtifacts(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodesImpl<Artifact, ArtifactType>(artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdateArtifactsIfUnchanged(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodesImpl<Artifact, ArtifactType>(
+      artifacts, /*check_last_update_time=*/true);
+}
+
 absl::Status RDBMSMetadataAccessObject::UpdateExecution(
     const Execution& execution) {
   return UpdateNodeImpl<Execution, ExecutionType>(execution);
 }
 
+absl::Status RDBMSMetadataAccessObject::UpdateExecutions(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodesImpl<Execution, ExecutionType>(executions);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdateExecutionsIfUnchanged(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodesImpl<Execution, ExecutionType>(
+      executions, /*check_last_update_time=*/true);
+}
+
 absl::Status RDBMSMetadataAccessObject::UpdateContext(const Context& context) {
   return UpdateNodeImpl<Context, ContextType>(context);
 }
 
+absl::Status RDBMSMetadataAccessObject::UpdateContexts(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodesImpl<Context, ContextType>(contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdateContextsIfUnchanged(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodesImpl<Context, ContextType>(
+      contexts, /*check_last_update_time=*/true);
+}
+
+absl::Status RDBMSMetadataAccessObject::DeleteArtifactsById(
+    const absl::Span<const int64> artifact_ids) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  InvalidateNodeCache<Artifact>(artifact_ids);
+  // The event paths are selected through the events, so they go first.
+  MLMD_RETURN_IF_ERROR(executor_->DeleteEventPathsByArtifactsId(artifact_ids));
+  MLMD_RETURN_IF_ERROR(executor_->DeleteEventsByArtifactsId(artifact_ids));
+  MLMD_RETURN_IF_ERROR(
+      executor_->DeleteAttributionsByArtifactsId(artifact_ids));
+  MLMD_RETURN_IF_ERROR(
+      executor_->DeleteArtifactsPropertiesByArtifactsId(artifact_ids));
+  return executor_->DeleteArtifactsById(artifact_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::DeleteExecutionsById(
+    const absl::Span<const int64> execution_ids) {
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  InvalidateNodeCache<Execution>(execution_ids);
+  MLMD_RETURN_IF_ERROR(
+      executor_->DeleteEventPathsByExecutionsId(execution_ids));
+  MLMD_RETURN_IF_ERROR(executor_->DeleteEventsByExecutionsId(execution_ids));
+  MLMD_RETURN_IF_ERROR(
+      executor_->DeleteAssociationsByExecutionsId(execution_ids));
+  MLMD_RETURN_IF_ERROR(
+      executor_->DeleteExecutionsPropertiesByExecutionsId(execution_ids));
+  return executor_->DeleteExecutionsById(execution_ids);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
                                                     int64* event_id) {
   // validate the given event
@@ -1258,6 +2593,18 @@ absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
                          ? event.milliseconds_since_epoch()
                          : absl::ToUnixMillis(absl::Now());
 
+  // an inline path is inserted with the event
+  if (executor_->InlinesEventPaths()) {
+    std::vector<int64> event_ids;
+    MLMD_RETURN_IF_ERROR(executor_->InsertEvents(absl::MakeConstSpan(&event, 1),
+                                                 event_time, &event_ids));
+    if (event_ids.size() != 1) {
+      return absl::InternalError(
+          absl::StrCat("Created ", event_ids.size(), " ids for 1 event"));
+    }
+    *event_id = event_ids[0];
+    return absl::OkStatus();
+  }
   MLMD_RETURN_IF_ERROR(
       executor_->InsertEvent(event.artifact_id(), event.execution_id(),
                              event.type(), event_time, event_id));
@@ -1269,51 +2616,111 @@ absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
   return absl::OkStatus();
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  event_ids->clear();
+  // validate the given events
+  absl::flat_hash_set<int64> artifact_ids;
+  absl::flat_hash_set<int64> execution_ids;
+  for (const Event& event : events) {
+    if (!event.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified.");
+    if (!event.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified.");
+    if (!event.has_type() || event.type() == Event::UNKNOWN)
+      return absl::InvalidArgumentError("No event type is specified.");
+    artifact_ids.insert(event.artifact_id());
+    execution_ids.insert(event.execution_id());
+  }
+  if (events.empty()) {
+    return absl::OkStatus();
+  }
+  // check that the referenced nodes exist with one query per node kind
+  {
+    TypedRecordSet artifacts;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
+        std::vector<int64>(artifact_ids.begin(), artifact_ids.end()),
+        &artifacts));
+    MLMD_RETURN_IF_ERROR(CheckNodesExist(artifacts, artifact_ids, "artifact"));
+  }
+  {
+    TypedRecordSet executions;
+    MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
+        std::vector<int64>(execution_ids.begin(), execution_ids.end()),
+        &executions));
+    MLMD_RETURN_IF_ERROR(
+        CheckNodesExist(executions, execution_ids, "execution"));
+  }
+
+  // insert the events and get their given ids, then insert all event paths
+  MLMD_RETURN_IF_ERROR(executor_->InsertEvents(
+      events, absl::ToUnixMillis(absl::Now()), event_ids));
+  if (event_ids->size() != events.size()) {
+    return absl::InternalError(
+        absl::StrCat("Created ", event_ids->size(), " ids for ",
+                     events.size(), " events"));
+  }
+  return executor_->InsertEventPaths(*event_ids, events);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
-    const std::vector<int64>& artifact_ids, std::vector<Event>* events) {
+    const std::vector<int64>& artifact_ids, absl::Span<const Event::Type> types,
+    std::vector<Event>* events) {
   if (events == nullptr) {
     return absl::InvalidArgumentError("Given events is NULL.");
   }
 
   RecordSet event_record_set;
-  if (!artifact_ids.empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectEventByArtifactIDs(artifact_ids, &event_record_set));
+  RecordSet path_record_set;
+  for (const absl::Span<const int64> chunk_ids :
+       SplitIdsForQueries(artifact_ids, *executor_)) {
+    if (chunk_ids.empty()) continue;
+    RecordSet chunk_event_record_set;
+    RecordSet chunk_path_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectEventsWithPathsByArtifactIDs(
+        chunk_ids, types, &chunk_event_record_set, &chunk_path_record_set));
+    AppendChunkRows(std::move(chunk_event_record_set), event_record_set);
+    AppendChunkRows(std::move(chunk_path_record_set), path_record_set);
   }
 
   if (event_record_set.records_size() == 0) {
     return absl::NotFoundError("Cannot find events by given artifact ids.");
   }
-  return FindEventsFromRecordSet(event_record_set, events);
+  return FindEventsFromRecordSet(event_record_set, path_record_set, events);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
-    const std::vector<int64>& execution_ids, std::vector<Event>* events) {
+    const std::vector<int64>& execution_ids,
+    absl::Span<const Event::Type> types,
+    std::vector<Event>* events) {
   if (events == nullptr) {
     return absl::InvalidArgumentError("Given events is NULL.");
   }
 
   RecordSet event_record_set;
-  if (!execution_ids.empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectEventByExecutionIDs(execution_ids, &event_record_set));
+  RecordSet path_record_set;
+  for (const absl::Span<const int64> chunk_ids :
+       SplitIdsForQueries(execution_ids, *executor_)) {
+    if (chunk_ids.empty()) continue;
+    RecordSet chunk_event_record_set;
+    RecordSet chunk_path_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectEventsWithPathsByExecutionIDs(
+        chunk_ids, types, &chunk_event_record_set, &chunk_path_record_set));
+    AppendChunkRows(std::move(chunk_event_record_set), event_record_set);
+    AppendChunkRows(std::move(chunk_path_record_set), path_record_set);
   }
 
   if (event_record_set.records_size() == 0) {
     return absl::NotFoundError("Cannot find events by given execution ids.");
   }
-  return FindEventsFromRecordSet(event_record_set, events);
+  return FindEventsFromRecordSet(event_record_set, path_record_set, events);
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateAssociation(
     const Association& association, int64* association_id) {
   if (!association.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
-  RecordSet context_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({association.context_id()},
-                                                     &context_id_header));
-  if (context_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Context id not found.");
+  MLMD_RETURN_IF_ERROR(CheckContextsExist({association.context_id()}));
 
   if (!association.has_execution_id())
     return absl::InvalidArgumentError("No execution id is specified");
@@ -1334,6 +2741,36 @@ absl::Status RDBMSMetadataAccessObject::CreateAssociation(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateAssociations(
+    const absl::Span<const Association> associations) {
+  if (associations.empty()) return absl::OkStatus();
+  absl::flat_hash_set<int64> context_ids;
+  absl::flat_hash_set<int64> execution_ids;
+  for (const Association& association : associations) {
+    if (!association.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!association.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified");
+    context_ids.insert(association.context_id());
+    execution_ids.insert(association.execution_id());
+  }
+  const std::vector<int64> unique_context_ids(context_ids.begin(),
+                                              context_ids.end());
+  MLMD_RETURN_IF_ERROR(CheckContextsExist(unique_context_ids));
+
+  const std::vector<int64> unique_execution_ids(execution_ids.begin(),
+                                                execution_ids.end());
+  RecordSet execution_id_header;
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(unique_execution_ids,
+                                                       &execution_id_header));
+  if (execution_id_header.records_size() <
+      static_cast<int>(unique_execution_ids.size())) {
+    return absl::InvalidArgumentError("Execution id not found.");
+  }
+
+  return executor_->InsertAssociationsIfNotExist(associations);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextsByExecution(
     int64 execution_id, std::vector<Context>* contexts) {
   RecordSet record_set;
@@ -1347,6 +2784,23 @@ absl::Status RDBMSMetadataAccessObject::FindContextsByExecution(
   return FindNodesImpl(context_ids, /*skipped_ids_ok=*/false, *contexts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindContextsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution) {
+  if (contexts_by_execution == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_execution is NULL.");
+  }
+  contexts_by_execution->clear();
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectAssociationsByExecutionIDs(
+      execution_ids, &record_set));
+  return FindLinkedNodesImpl(record_set, /*key_position=*/2,
+                             /*node_position=*/1, *contexts_by_execution);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
     int64 context_id, std::vector<Execution>* executions) {
   std::string unused_next_page_toke;
@@ -1371,15 +2825,58 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
   return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
 }
 
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::FindLinkedNodesImpl(
+    const RecordSet& record_set, const int key_position,
+    const int node_position,
+    absl::flat_hash_map<int64, std::vector<Node>>& nodes_by_key) {
+  nodes_by_key.clear();
+  const std::vector<int64> key_ids = ConvertToIds(record_set, key_position);
+  const std::vector<int64> node_ids = ConvertToIds(record_set, node_position);
+  if (node_ids.empty()) {
+    return absl::OkStatus();
+  }
+  // A node linked to several keys is fetched once.
+  std::vector<int64> unique_node_ids = node_ids;
+  absl::c_sort(unique_node_ids);
+  unique_node_ids.erase(
+      std::unique(unique_node_ids.begin(), unique_node_ids.end()),
+      unique_node_ids.end());
+  std::vector<Node> nodes;
+  MLMD_RETURN_IF_ERROR(
+      FindNodesImpl(unique_node_ids, /*skipped_ids_ok=*/false, nodes));
+  absl::flat_hash_map<int64, const Node*> nodes_by_id;
+  for (const Node& node : nodes) {
+    nodes_by_id[node.id()] = &node;
+  }
+  for (int i = 0; i < node_ids.size(); i++) {
+    nodes_by_key[key_ids[i]].push_back(*nodes_by_id[node_ids[i]]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Execution>>* executions_by_context) {
+  if (executions_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given executions_by_context is NULL.");
+  }
+  executions_by_context->clear();
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAssociationsByContextIDs(context_ids, &record_set));
+  return FindLinkedNodesImpl(record_set, /*key_position=*/1,
+                             /*node_position=*/2, *executions_by_context);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateAttribution(
     const Attribution& attribution, int64* attribution_id) {
   if (!attribution.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
-  RecordSet context_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({attribution.context_id()},
-                                                     &context_id_header));
-  if (context_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Context id not found.");
+  MLMD_RETURN_IF_ERROR(CheckContextsExist({attribution.context_id()}));
 
   if (!attribution.has_artifact_id())
     return absl::InvalidArgumentError("No artifact id is specified");
@@ -1400,17 +2897,71 @@ absl::Status RDBMSMetadataAccessObject::CreateAttribution(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateAttributions(
+    const absl::Span<const Attribution> attributions) {
+  if (attributions.empty()) return absl::OkStatus();
+  absl::flat_hash_set<int64> context_ids;
+  absl::flat_hash_set<int64> artifact_ids;
+  for (const Attribution& attribution : attributions) {
+    if (!attribution.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!attribution.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified");
+    context_ids.insert(attribution.context_id());
+    artifact_ids.insert(attribution.artifact_id());
+  }
+  const std::vector<int64> unique_context_ids(context_ids.begin(),
+                                              context_ids.end());
+  MLMD_RETURN_IF_ERROR(CheckContextsExist(unique_context_ids));
+
+  // Only the primary key is read for the artifacts, which are usually the
+  // largest batch of ids.
+  const std::vector<int64> unique_artifact_ids(artifact_ids.begin(),
+                                               artifact_ids.end());
+  RecordSet artifact_id_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArtifactIDsByID(unique_artifact_ids, &artifact_id_set));
+  if (artifact_id_set.records_size() <
+      static_cast<int>(unique_artifact_ids.size())) {
+    return absl::InvalidArgumentError("Artifact id not found.");
+  }
+
+  return executor_->InsertAttributionsIfNotExist(attributions);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextsByArtifact(
     int64 artifact_id, std::vector<Context>* contexts) {
-  RecordSet record_set;
+  // The contexts and their properties are selected by joining the Attribution
+  // table, so that the context ids are not sent back to the database.
+  TypedRecordSet context_record_set;
   MLMD_RETURN_IF_ERROR(
-      executor_->SelectAttributionByArtifactID(artifact_id, &record_set));
-  const std::vector<int64> context_ids = AttributionsToContextIds(record_set);
-  if (context_ids.empty()) {
+      executor_->SelectContextsByArtifactID(artifact_id, &context_record_set));
+  if (context_record_set.num_rows() == 0) {
     return absl::NotFoundError(
         absl::StrCat("No contexts found for artifact_id: ", artifact_id));
   }
-  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/false, *contexts);
+  TypedRecordSet properties_record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectContextPropertyByArtifactID(
+      artifact_id, &properties_record_set));
+  return ParseTypedRecordSetsToNodes(context_record_set,
+                                     properties_record_set, contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindContextsByArtifacts(
+    const absl::Span<const int64> artifact_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact) {
+  if (contexts_by_artifact == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_artifact is NULL.");
+  }
+  contexts_by_artifact->clear();
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAttributionsByArtifactIDs(artifact_ids, &record_set));
+  return FindLinkedNodesImpl(record_set, /*key_position=*/2,
+                             /*node_position=*/1, *contexts_by_artifact);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
@@ -1423,6 +2974,22 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
     int64 context_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Artifact>* artifacts, std::string* next_page_token) {
+  if (!list_options.has_value()) {
+    // The artifacts and their properties are selected by joining the
+    // Attribution table, so that the artifact ids are not sent back to the
+    // database.
+    TypedRecordSet artifact_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByContextID(
+        context_id, &artifact_record_set));
+    if (artifact_record_set.num_rows() == 0) {
+      return absl::OkStatus();
+    }
+    TypedRecordSet properties_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArtifactPropertyByContextID(
+        context_id, &properties_record_set));
+    return ParseTypedRecordSetsToNodes(artifact_record_set,
+                                       properties_record_set, artifacts);
+  }
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectAttributionByContextID(context_id, &record_set));
@@ -1430,11 +2997,25 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
   if (ids.empty()) {
     return absl::OkStatus();
   }
-  if (list_options.has_value()) {
-    return ListNodes<Artifact>(list_options.value(), ids, artifacts,
-                               next_page_token);
+  return ListNodes<Artifact>(list_options.value(), ids, artifacts,
+                             next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context) {
+  if (artifacts_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given artifacts_by_context is NULL.");
   }
-  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+  artifacts_by_context->clear();
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAttributionsByContextIDs(context_ids, &record_set));
+  return FindLinkedNodesImpl(record_set, /*key_position=*/1,
+                             /*node_position=*/2, *artifacts_by_context);
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateParentContext(
@@ -1463,6 +3044,42 @@ absl::Status RDBMSMetadataAccessObject::CreateParentContext(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateParentContexts(
+    const absl::Span<const ParentContext> parent_contexts) {
+  if (parent_contexts.empty()) return absl::OkStatus();
+  absl::flat_hash_set<int64> context_ids;
+  for (const ParentContext& parent_context : parent_contexts) {
+    if (!parent_context.has_parent_id() || !parent_context.has_child_id()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Missing parent / child id in the parent_context: ",
+                       parent_context.DebugString()));
+    }
+    if (parent_context.parent_id() == parent_context.child_id()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Given parent / child id in the parent_context cannot be found: ",
+          parent_context.DebugString()));
+    }
+    context_ids.insert(parent_context.parent_id());
+    context_ids.insert(parent_context.child_id());
+  }
+  const std::vector<int64> unique_context_ids(context_ids.begin(),
+                                              context_ids.end());
+  RecordSet context_id_header;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectContextsByID(unique_context_ids, &context_id_header));
+  if (context_id_header.records_size() <
+      static_cast<int>(unique_context_ids.size())) {
+    return absl::InvalidArgumentError(
+        "Given parent / child id in the parent_contexts cannot be found.");
+  }
+  const absl::Status status = executor_->InsertParentContexts(parent_contexts);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given parent_contexts already exist: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::FindLinkedContextsImpl(
     int64 context_id, ParentContextTraverseDirection direction,
     std::vector<Context>& output_contexts) {
@@ -1504,6 +3121,111 @@ absl::Status RDBMSMetadataAccessObject::FindChildContextsByContextId(
       context_id, ParentContextTraverseDirection::kChild, *contexts);
 }
 
+absl::Status RDBMSMetadataAccessObject::SelectTransitiveLinksImpl(
+    const int64 context_id, const int64 max_depth,
+    const ParentContextTraverseDirection direction, RecordSet* record_set) {
+  const bool is_parent = direction == ParentContextTraverseDirection::kParent;
+  if (recursive_link_queries_supported_) {
+    const absl::Status status =
+        is_parent ? executor_->SelectAncestorContextsByContextID(
+                        context_id, max_depth, record_set)
+                  : executor_->SelectDescendantContextsByContextID(
+                        context_id, max_depth, record_set);
+    // The other errors, e.g., an aborted transaction or a lost connection,
+    // would fail the queries of the fallback as well.
+    if (!IsSyntaxUnsupported(status)) {
+      return status;
+    }
+    LOG(WARNING) << "Recursive ParentContext query is not supported, falling "
+                    "back to one query per context: "
+                 << status;
+    recursive_link_queries_supported_ = false;
+  }
+  // Visits the contexts breadth-first, so that each context is expanded at
+  // its minimum depth, as in the recursive query.
+  record_set->Clear();
+  absl::flat_hash_set<int64> visited_ids = {context_id};
+  std::vector<int64> frontier = {context_id};
+  for (int64 depth = 0; depth < max_depth && !frontier.empty(); depth++) {
+    std::vector<int64> next_frontier;
+    for (const int64 id : frontier) {
+      RecordSet links;
+      MLMD_RETURN_IF_ERROR(
+          is_parent ? executor_->SelectParentContextsByContextID(id, &links)
+                    : executor_->SelectChildContextsByContextID(id, &links));
+      for (const int64 linked_id :
+           ParentContextsToContextIds(links, is_parent)) {
+        if (visited_ids.insert(linked_id).second) {
+          next_frontier.push_back(linked_id);
+        }
+      }
+      for (RecordSet::Record& record : *links.mutable_records()) {
+        *record_set->add_records() = std::move(record);
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTransitiveLinkedContextsImpl(
+    const int64 context_id, const int64 max_depth,
+    const ParentContextTraverseDirection direction,
+    std::vector<Context>& output_contexts,
+    std::vector<ParentContext>& output_parent_contexts) {
+  if (max_depth <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_depth must be positive: ", max_depth));
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      SelectTransitiveLinksImpl(context_id, max_depth, direction, &record_set));
+  output_contexts.clear();
+  output_parent_contexts.clear();
+  const std::vector<int64> child_ids = ConvertToIds(record_set, 0);
+  const std::vector<int64> parent_ids = ConvertToIds(record_set, 1);
+  for (int i = 0; i < child_ids.size(); i++) {
+    ParentContext parent_context;
+    parent_context.set_child_id(child_ids[i]);
+    parent_context.set_parent_id(parent_ids[i]);
+    output_parent_contexts.push_back(parent_context);
+  }
+  std::vector<int64> ids =
+      direction == ParentContextTraverseDirection::kParent ? parent_ids
+                                                           : child_ids;
+  // A context linked to several others in the result is returned once.
+  absl::c_sort(ids);
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, output_contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindAncestorContextsByContextId(
+    int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (contexts == nullptr || parent_contexts == nullptr) {
+    return absl::InvalidArgumentError(
+        "Given contexts or parent_contexts is NULL.");
+  }
+  return FindTransitiveLinkedContextsImpl(
+      context_id, max_depth, ParentContextTraverseDirection::kParent,
+      *contexts, *parent_contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindDescendantContextsByContextId(
+    int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (contexts == nullptr || parent_contexts == nullptr) {
+    return absl::InvalidArgumentError(
+        "Given contexts or parent_contexts is NULL.");
+  }
+  return FindTransitiveLinkedContextsImpl(
+      context_id, max_depth, ParentContextTraverseDirection::kChild,
+      *contexts, *parent_contexts);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifacts(
     std::vector<Artifact>* artifacts) {
   RecordSet record_set;
@@ -1546,7 +3268,8 @@ template <typename Node>
 absl::Status RDBMSMetadataAccessObject::ListNodes(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    std::vector<Node>* nodes, std::string* next_page_token) {
+    std::vector<Node>* nodes, std::string* next_page_token,
+    const PropertyOptions& property_options) {
   if (options.max_result_size() <= 0) {
     return absl::InvalidArgumentError(
         absl::StrCat("max_result_size field value is required to be greater "
@@ -1557,10 +3280,12 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
     return absl::InvalidArgumentError("nodes argument is not empty");
   }
 
-  // Retrieving page of size 1 greater that max_result_size to detect if this
-  // is the last page.
+  // Retrieving page of size 1 greater that the page size to detect if this
+  // is the last page. The page size is max_result_size bounded by the
+  // upper-bound of the list mode.
+  const int page_size = GetListOperationPageSize(options);
   ListOperationOptions updated_options = options;
-  updated_options.set_max_result_size(options.max_result_size() + 1);
+  updated_options.set_max_result_size(page_size + 1);
   // Retrieve ids based on the list options
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
@@ -1577,14 +3302,16 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
   }
 
   // Retrieve nodes
-  MLMD_RETURN_IF_ERROR(FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes));
+  MLMD_RETURN_IF_ERROR(FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes,
+                                     /*serialized_structs=*/nullptr,
+                                     property_options));
 
   // Sort nodes in the right order
   absl::c_sort(*nodes, [&](const Node& a, const Node& b) {
     return position_by_id.at(a.id()) < position_by_id.at(b.id());
   });
 
-  if (nodes->size() > options.max_result_size()) {
+  if (nodes->size() > page_size) {
     // Removing the extra node retrieved for last page detection.
     nodes->pop_back();
     MLMD_RETURN_IF_ERROR(BuildListOperationNextPageToken<Node>(
@@ -1598,21 +3325,46 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
 absl::Status RDBMSMetadataAccessObject::ListArtifacts(
     const ListOperationOptions& options, std::vector<Artifact>* artifacts,
     std::string* next_page_token) {
+  return ListArtifacts(options, PropertyOptions::default_instance(), artifacts,
+                       next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
   return ListNodes<Artifact>(options, absl::nullopt, artifacts,
-                             next_page_token);
+                             next_page_token, property_options);
 }
 
 absl::Status RDBMSMetadataAccessObject::ListExecutions(
     const ListOperationOptions& options, std::vector<Execution>* executions,
     std::string* next_page_token) {
+  return ListExecutions(options, PropertyOptions::default_instance(),
+                        executions, next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options,
+    std::vector<Execution>* executions, std::string* next_page_token) {
   return ListNodes<Execution>(options, absl::nullopt, executions,
-                              next_page_token);
+                              next_page_token, property_options);
 }
 
 absl::Status RDBMSMetadataAccessObject::ListContexts(
     const ListOperationOptions& options, std::vector<Context>* contexts,
     std::string* next_page_token) {
-  return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token);
+  return ListContexts(options, PropertyOptions::default_instance(), contexts,
+                      next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token,
+                            property_options);
 }
 
 absl::Status RDBMSMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
@@ -1636,8 +3388,21 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
   return absl::OkStatus();
 }
 
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeIdAndArtifactNames(
+    const int64 artifact_type_id, const absl::Span<const std::string> names,
+    std::vector<Artifact>* artifacts) {
+  return FindNodesByTypeIdAndNamesImpl(artifact_type_id, names, *artifacts);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
     const int64 type_id, std::vector<Artifact>* artifacts) {
+  return FindArtifactsByTypeId(type_id, PropertyOptions::default_instance(),
+                               artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 type_id, const PropertyOptions& property_options,
+    std::vector<Artifact>* artifacts) {
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectArtifactsByTypeID(type_id, &record_set));
@@ -1646,7 +3411,33 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
     return absl::NotFoundError(
         absl::StrCat("No artifacts found for type_id:", type_id));
   }
-  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts,
+                       /*serialized_structs=*/nullptr, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifacts(
+    const NodeBatchCallback<Artifact>& callback) {
+  return FindArtifacts(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifacts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Artifact>& callback) {
+  // The ids are collected before reading the nodes, as the connection cannot
+  // run the node queries while the id scan is being streamed.
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectAllArtifactIDs(CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), callback, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Artifact>& callback) {
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactIDsUpdatedAfter(
+      last_update_time_since_epoch, id, CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), InUpdateOrder(callback),
+                         PropertyOptions::default_instance());
 }
 
 absl::Status RDBMSMetadataAccessObject::FindExecutions(
@@ -1660,6 +3451,29 @@ absl::Status RDBMSMetadataAccessObject::FindExecutions(
   return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindExecutions(
+    const NodeBatchCallback<Execution>& callback) {
+  return FindExecutions(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutions(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Execution>& callback) {
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectAllExecutionIDs(CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), callback, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Execution>& callback) {
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionIDsUpdatedAfter(
+      last_update_time_since_epoch, id, CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), InUpdateOrder(callback),
+                         PropertyOptions::default_instance());
+}
+
 absl::Status RDBMSMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
     const int64 type_id, const absl::string_view name, Execution* execution) {
   RecordSet record_set;
@@ -1682,8 +3496,21 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
   return absl::OkStatus();
 }
 
+absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeIdAndExecutionNames(
+    const int64 execution_type_id, const absl::Span<const std::string> names,
+    std::vector<Execution>* executions) {
+  return FindNodesByTypeIdAndNamesImpl(execution_type_id, names, *executions);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
     const int64 type_id, std::vector<Execution>* executions) {
+  return FindExecutionsByTypeId(type_id, PropertyOptions::default_instance(),
+                                executions);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 type_id, const PropertyOptions& property_options,
+    std::vector<Execution>* executions) {
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectExecutionsByTypeID(type_id, &record_set));
@@ -1692,7 +3519,28 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
     return absl::NotFoundError(
         absl::StrCat("No executions found for type_id:", type_id));
   }
-  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions,
+                       /*serialized_structs=*/nullptr, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::CountExecutions(
+    const absl::optional<int64> execution_type_id,
+    const absl::optional<Execution::State> last_known_state, int64* count) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->CountExecutions(
+      execution_type_id, last_known_state, &record_set));
+  *count = ConvertToCount(record_set);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::AggregateExecutionProperty(
+    const int64 execution_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->AggregateExecutionProperty(
+      execution_type_id, options, &record_set));
+  ConvertToPropertyAggregates(record_set, options, aggregates);
+  return absl::OkStatus();
 }
 
 absl::Status RDBMSMetadataAccessObject::FindContexts(
@@ -1706,9 +3554,41 @@ absl::Status RDBMSMetadataAccessObject::FindContexts(
   return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindContexts(
+    const NodeBatchCallback<Context>& callback) {
+  return FindContexts(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindContexts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Context>& callback) {
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectAllContextIDs(CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), callback, property_options);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindContextsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Context>& callback) {
+  std::vector<int64> ids;
+  MLMD_RETURN_IF_ERROR(executor_->SelectContextIDsUpdatedAfter(
+      last_update_time_since_epoch, id, CollectIds(&ids)));
+  return StreamNodesImpl(absl::MakeConstSpan(ids), InUpdateOrder(callback),
+                         PropertyOptions::default_instance());
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
     const int64 type_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Context>* contexts, std::string* next_page_token) {
+  return FindContextsByTypeId(type_id, list_options,
+                              PropertyOptions::default_instance(), contexts,
+                              next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByTypeID(type_id, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1719,12 +3599,21 @@ absl::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
 
   if (list_options) {
     return ListNodes<Context>(list_options.value(), ids, contexts,
-                              next_page_token);
+                              next_page_token, property_options);
   } else {
-    return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts);
+    return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts,
+                         /*serialized_structs=*/nullptr, property_options);
   }
 }
 
+absl::Status RDBMSMetadataAccessObject::CountContexts(
+    const absl::optional<int64> context_type_id, int64* count) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->CountContexts(context_type_id, &record_set));
+  *count = ConvertToCount(record_set);
+  return absl::OkStatus();
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByURI(
     const absl::string_view uri, std::vector<Artifact>* artifacts) {
   RecordSet record_set;
@@ -1737,6 +3626,95 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByURI(
   return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByURIPrefix(
+    const absl::string_view uri_prefix, std::vector<Artifact>* artifacts) {
+  if (uri_prefix.empty()) {
+    return absl::InvalidArgumentError("The uri_prefix should not be empty.");
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArtifactsByURIPrefix(uri_prefix, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No artifacts found for uri prefix:", uri_prefix));
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::CountArtifacts(
+    const absl::optional<int64> artifact_type_id,
+    const absl::optional<Artifact::State> state, int64* count) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->CountArtifacts(artifact_type_id, state, &record_set));
+  *count = ConvertToCount(record_set);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::AggregateArtifactProperty(
+    const int64 artifact_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->AggregateArtifactProperty(
+      artifact_type_id, options, &record_set));
+  ConvertToPropertyAggregates(record_set, options, aggregates);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExistingArtifactIds(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<int64>* existing_artifact_ids) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArtifactIDsByID(artifact_ids, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  existing_artifact_ids->insert(existing_artifact_ids->end(), ids.begin(),
+                                ids.end());
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactIdsByTypeId(
+    const int64 artifact_type_id, std::vector<int64>* artifact_ids) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArtifactsByTypeID(artifact_type_id, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  artifact_ids->insert(artifact_ids->end(), ids.begin(), ids.end());
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactIdsUpdatedBefore(
+    const int64 artifact_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* artifact_ids) {
+  if (limit <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("limit must be positive: ", limit));
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactIDsByTypeIDUpdatedBefore(
+      artifact_type_id, last_update_time_since_epoch, limit, &record_set));
+  *artifact_ids = ConvertToIds(record_set);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionIdsUpdatedBefore(
+    const int64 execution_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* execution_ids) {
+  if (limit <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("limit must be positive: ", limit));
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionIDsByTypeIDUpdatedBefore(
+      execution_type_id, last_update_time_since_epoch, limit, &record_set));
+  *execution_ids = ConvertToIds(record_set);
+  return absl::OkStatus();
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextByTypeIdAndContextName(
     int64 type_id, absl::string_view name, Context* context) {
   RecordSet record_set;
@@ -1758,5 +3736,11 @@ absl::Status RDBMSMetadataAccessObject::FindContextByTypeIdAndContextName(
   return absl::OkStatus();
 }
 
+absl::Status RDBMSMetadataAccessObject::FindContextsByTypeIdAndContextNames(
+    const int64 context_type_id, const absl::Span<const std::string> names,
+    std::vector<Context>* contexts) {
+  return FindNodesByTypeIdAndNamesImpl(context_type_id, names, *contexts);
+}
+
 
 }  // namespace ml_metadata
@@ -16,13 +16,20 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_RDBMS_METADATA_ACCESS_OBJECT_H_
 
 #include <memory>
+#include <string>
+#include <tuple>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/node_cache.h"
 #include "ml_metadata/metadata_store/query_executor.h"
+#include "ml_metadata/metadata_store/record_parsing_util.h"
+#include "ml_metadata/metadata_store/type_cache.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
@@ -38,12 +45,37 @@ namespace ml_metadata {
 // a new subclass of QueryExecutor should be created.
 class RDBMSMetadataAccessObject : public MetadataAccessObject {
  public:
-  virtual ~RDBMSMetadataAccessObject() = default;
+  virtual ~RDBMSMetadataAccessObject() {
+    if (begin_callback_handle_ >= 0) {
+      metadata_source_->RemoveBeginCallback(begin_callback_handle_);
+    }
+  }
 
   // default & copy constructors are disallowed.
   RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor)
       : executor_(std::move(executor)) {}
 
+  // Types are looked up in and shared through `type_cache`, if it is not
+  // nullptr. The cache is not owned, and it must only be shared by the objects
+  // accessing the same database. The `metadata_source` is the one used by
+  // `executor`, which tells the transactions apart, and `schema_version` is
+  // the one of the queries used by `executor`. Nodes are looked up in and
+  // shared through `node_cache` likewise.
+  RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor,
+                            MetadataSource* metadata_source,
+                            int64 schema_version, TypeCache* type_cache,
+                            NodeCache* node_cache = nullptr)
+      : executor_(std::move(executor)),
+        metadata_source_(metadata_source),
+        schema_version_(schema_version),
+        type_cache_(type_cache),
+        node_cache_(node_cache) {
+    if (type_cache_ != nullptr || node_cache_ != nullptr) {
+      begin_callback_handle_ = metadata_source_->AddBeginCallback(
+          [this]() { NoteCacheGenerations(); });
+    }
+  }
+
   // default & copy constructors are disallowed.
   RDBMSMetadataAccessObject() = delete;
   RDBMSMetadataAccessObject(const RDBMSMetadataAccessObject&) = delete;
@@ -54,6 +86,8 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // the MetadataSource is dropped.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status InitMetadataSource() final {
+    InvalidateTypeCache();
+    if (node_cache_ != nullptr) node_cache_->Clear();
     return executor_->InitMetadataSource();
   }
 
@@ -77,13 +111,88 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   //   library version.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status DowngradeMetadataSource(int64 to_schema_version) final {
+    InvalidateTypeCache();
+    if (node_cache_ != nullptr) node_cache_->Clear();
     return executor_->DowngradeMetadataSource(to_schema_version);
   }
 
+  absl::Status MigrateSchemaStep(int64 to_schema_version, int64 max_num_chunks,
+                                 SchemaMigrationProgress* progress) final {
+    InvalidateTypeCache();
+    if (node_cache_ != nullptr) node_cache_->Clear();
+    return executor_->MigrateSchemaStep(to_schema_version, max_num_chunks,
+                                        progress);
+  }
+
+  // Drops the secondary indices of the schema, e.g., to speed up a bulk load.
+  // The reads return the same results meanwhile, only slower.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status DropSecondaryIndices() final {
+    return executor_->DropSecondaryIndices();
+  }
+
+  // Creates the secondary indices of the schema if they do not exist, e.g.,
+  // after DropSecondaryIndices.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status CreateSecondaryIndices() final {
+    return executor_->CreateSecondaryIndices();
+  }
+
+  absl::Status MaintainEventPartitions(const EventPartitionOptions& options,
+                                       int64 now_milliseconds,
+                                       bool enable_migration) final;
+
+  absl::Status InlineEventPaths(bool enable_migration, int64 max_num_events,
+                                int64* num_moved_events) final;
+
+  absl::Status InlineNodeProperties(bool enable_migration, int64 max_num_nodes,
+                                    int64* num_filled_nodes) final;
+
+  absl::Status MaintainNodePropertiesBytes() final;
+
+  void SetPinnedRead(bool pinned_read) final { pinned_read_ = pinned_read; }
+
+  absl::Status CreateIdempotencyKeyTable() final;
+
+  absl::Status FindIdempotencyKey(absl::string_view idempotency_key,
+                                  int64* request_fingerprint,
+                                  absl::Time* create_time,
+                                  std::string* response) final;
+
+  absl::Status CreateIdempotencyKey(absl::string_view idempotency_key,
+                                    int64 request_fingerprint,
+                                    absl::Time create_time,
+                                    absl::string_view response) final;
+
+  absl::Status FindIdempotencyKeysCreatedBefore(
+      absl::Time create_time, int64 max_num_keys,
+      std::vector<std::string>* idempotency_keys) final;
+
+  absl::Status DeleteIdempotencyKeys(
+      absl::Span<const std::string> idempotency_keys) final {
+    return executor_->DeleteIdempotencyKeys(idempotency_keys);
+  }
+
+  absl::Status CreateLineageClosureTable(bool* created) final;
+
+  absl::Status CreateLineageClosure(
+      absl::Span<const int64> upstream_artifact_ids,
+      absl::Span<const int64> downstream_artifact_ids) final;
+
+  absl::Status FindLineageClosure(
+      absl::Span<const int64> artifact_ids, bool upstream,
+      std::vector<int64>* related_artifact_ids) final;
+
   absl::Status CreateType(const ArtifactType& type, int64* type_id) final;
   absl::Status CreateType(const ExecutionType& type, int64* type_id) final;
   absl::Status CreateType(const ContextType& type, int64* type_id) final;
 
+  absl::Status CreateTypeWithId(const ArtifactType& type,
+                                int64 type_id) final;
+  absl::Status CreateTypeWithId(const ExecutionType& type,
+                                int64 type_id) final;
+  absl::Status CreateTypeWithId(const ContextType& type, int64 type_id) final;
+
   absl::Status UpdateType(const ArtifactType& type) final;
   absl::Status UpdateType(const ExecutionType& type) final;
   absl::Status UpdateType(const ContextType& type) final;
@@ -102,6 +211,16 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
       absl::string_view name, absl::optional<absl::string_view> version,
       ContextType* context_type) final;
 
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ContextType>* context_types) final;
+
   absl::Status FindTypes(std::vector<ArtifactType>* artifact_types) final;
   absl::Status FindTypes(std::vector<ExecutionType>* execution_types) final;
   absl::Status FindTypes(std::vector<ContextType>* context_types) final;
@@ -120,84 +239,263 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status FindParentTypesByTypeId(
       int64 type_id, std::vector<ContextType>& output_parent_types) final;
 
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ContextType>>&
+          output_parent_types) final;
+
   absl::Status CreateArtifact(const Artifact& artifact,
                               int64* artifact_id) final;
 
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 std::vector<Artifact>* artifacts) final;
+
   absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 const PropertyOptions& property_options,
                                  std::vector<Artifact>* artifacts) final;
 
   absl::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
 
+  absl::Status FindArtifacts(const NodeBatchCallback<Artifact>& callback) final;
+
+  absl::Status FindArtifacts(const PropertyOptions& property_options,
+                             const NodeBatchCallback<Artifact>& callback) final;
+
+  absl::Status FindArtifactsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Artifact>& callback) final;
+
   absl::Status ListArtifacts(const ListOperationOptions& options,
                              std::vector<Artifact>* artifacts,
                              std::string* next_page_token) final;
 
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             const PropertyOptions& property_options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+
   absl::Status ListExecutions(const ListOperationOptions& options,
                               std::vector<Execution>* executions,
                               std::string* next_page_token) final;
 
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              const PropertyOptions& property_options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+
   absl::Status ListContexts(const ListOperationOptions& options,
                             std::vector<Context>* contexts,
                             std::string* next_page_token) final;
 
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            const PropertyOptions& property_options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+
+  absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     std::vector<Artifact>* artifacts) final;
+
   absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     const PropertyOptions& property_options,
                                      std::vector<Artifact>* artifacts) final;
 
   absl::Status FindArtifactByTypeIdAndArtifactName(int64 type_id,
                                                    absl::string_view name,
                                                    Artifact* artifact) final;
 
+  absl::Status FindArtifactsByTypeIdAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      std::vector<Artifact>* artifacts) final;
+
   absl::Status FindArtifactsByURI(absl::string_view uri,
                                   std::vector<Artifact>* artifacts) final;
 
+  absl::Status FindArtifactsByURIPrefix(
+      absl::string_view uri_prefix, std::vector<Artifact>* artifacts) final;
+
+  absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                              absl::optional<Artifact::State> state,
+                              int64* count) final;
+
+  absl::Status FindExistingArtifactIds(
+      absl::Span<const int64> artifact_ids,
+      std::vector<int64>* existing_artifact_ids) final;
+
+  absl::Status FindArtifactIdsByTypeId(
+      int64 artifact_type_id, std::vector<int64>* artifact_ids) final;
+
+  absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
   absl::Status UpdateArtifact(const Artifact& artifact) final;
 
+  absl::Status UpdateArtifacts(absl::Span<const Artifact> artifacts) final;
+
+  absl::Status UpdateArtifactsIfUnchanged(
+      absl::Span<const Artifact> artifacts) final;
+
+  absl::Status DeleteArtifactsById(
+      absl::Span<const int64> artifact_ids) final;
+
+  absl::Status FindArtifactIdsUpdatedBefore(
+      int64 artifact_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* artifact_ids) final;
+
   absl::Status CreateExecution(const Execution& execution,
                                int64* execution_id) final;
 
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
                                   std::vector<Execution>* executions) final;
 
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  const PropertyOptions& property_options,
+                                  std::vector<Execution>* executions) final;
+
   absl::Status FindExecutions(std::vector<Execution>* executions) final;
 
+  absl::Status FindExecutions(
+      const NodeBatchCallback<Execution>& callback) final;
+
+  absl::Status FindExecutions(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Execution>& callback) final;
+
+  absl::Status FindExecutionsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Execution>& callback) final;
+
   absl::Status FindExecutionByTypeIdAndExecutionName(
       int64 type_id, absl::string_view name, Execution* execution) final;
 
+  absl::Status FindExecutionsByTypeIdAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      std::vector<Execution>* executions) final;
+
   absl::Status FindExecutionsByTypeId(int64 execution_type_id,
                                       std::vector<Execution>* executions) final;
 
+  absl::Status FindExecutionsByTypeId(int64 execution_type_id,
+                                      const PropertyOptions& property_options,
+                                      std::vector<Execution>* executions) final;
+
+  absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state, int64* count) final;
+
+  absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
   absl::Status UpdateExecution(const Execution& execution) final;
 
+  absl::Status UpdateExecutions(absl::Span<const Execution> executions) final;
+
+  absl::Status UpdateExecutionsIfUnchanged(
+      absl::Span<const Execution> executions) final;
+
+  absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status FindExecutionIdsUpdatedBefore(
+      int64 execution_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* execution_ids) final;
+
   absl::Status CreateContext(const Context& context, int64* context_id) final;
 
+  absl::Status CreateContextIfNotExist(const Context& context,
+                                       int64* context_id,
+                                       bool* created) final;
+
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                std::vector<Context>* contexts) final;
+
   absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                const PropertyOptions& property_options,
                                 std::vector<Context>* contexts) final;
 
   absl::Status FindContexts(std::vector<Context>* contexts) final;
 
+  absl::Status FindContexts(const NodeBatchCallback<Context>& callback) final;
+
+  absl::Status FindContexts(const PropertyOptions& property_options,
+                            const NodeBatchCallback<Context>& callback) final;
+
+  absl::Status FindContextsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Context>& callback) final;
+
   absl::Status FindContextsByTypeId(
       int64 type_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Context>* contexts, std::string* next_page_token) final;
 
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      const PropertyOptions& property_options, std::vector<Context>* contexts,
+      std::string* next_page_token) final;
+
+  absl::Status CountContexts(absl::optional<int64> context_type_id,
+                             int64* count) final;
+
   absl::Status FindContextByTypeIdAndContextName(int64 type_id,
                                                  absl::string_view name,
                                                  Context* context) final;
 
+  absl::Status FindContextsByTypeIdAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      std::vector<Context>* contexts) final;
+
   absl::Status UpdateContext(const Context& context) final;
 
+  absl::Status UpdateContexts(absl::Span<const Context> contexts) final;
+
+  absl::Status UpdateContextsIfUnchanged(
+      absl::Span<const Context> contexts) final;
+
   absl::Status CreateEvent(const Event& event, int64* event_id) final;
 
+  absl::Status CreateEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
+  using MetadataAccessObject::FindEventsByArtifacts;
   absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
+                                     absl::Span<const Event::Type> types,
                                      std::vector<Event>* events) final;
 
+  using MetadataAccessObject::FindEventsByExecutions;
   absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
+                                      absl::Span<const Event::Type> types,
                                       std::vector<Event>* events) final;
 
   absl::Status CreateAssociation(const Association& association,
                                  int64* association_id) final;
 
+  absl::Status CreateAssociations(
+      absl::Span<const Association> associations) final;
+
   absl::Status FindContextsByExecution(int64 execution_id,
                                        std::vector<Context>* contexts) final;
+  absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution)
+      final;
 
   absl::Status FindExecutionsByContext(
       int64 context_id, std::vector<Execution>* executions) final;
@@ -206,11 +504,23 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
       int64 context_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Execution>* executions, std::string* next_page_token) final;
 
+  absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Execution>>*
+          executions_by_context) final;
+
   absl::Status CreateAttribution(const Attribution& attribution,
                                  int64* attribution_id) final;
 
+  absl::Status CreateAttributions(
+      absl::Span<const Attribution> attributions) final;
+
   absl::Status FindContextsByArtifact(int64 artifact_id,
                                       std::vector<Context>* contexts) final;
+  absl::Status FindContextsByArtifacts(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact)
+      final;
 
   absl::Status FindArtifactsByContext(int64 context_id,
                                       std::vector<Artifact>* artifacts) final;
@@ -219,24 +529,77 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
       int64 context_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Artifact>* artifacts, std::string* next_page_token) final;
 
+  absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context)
+      final;
+
   absl::Status CreateParentContext(const ParentContext& parent_context) final;
 
+  absl::Status CreateParentContexts(
+      absl::Span<const ParentContext> parent_contexts) final;
+
   absl::Status FindParentContextsByContextId(
       int64 context_id, std::vector<Context>* contexts) final;
 
   absl::Status FindChildContextsByContextId(
       int64 context_id, std::vector<Context>* contexts) final;
 
+  absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+
+  absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+
   absl::Status GetSchemaVersion(int64* db_version) final {
     return executor_->GetSchemaVersion(db_version);
   }
 
   int64 GetLibraryVersion() final { return executor_->GetLibraryVersion(); }
 
+  NodeCache* GetSerializedNodeCache(int64* schema_version) final;
+
 
  private:
   ///////// These methods are implementations details //////////////////////////
 
+  // Returns the type cache to use in the current transaction, or nullptr if
+  // there is no cache or the transaction has changed any type. The uncommitted
+  // types of a transaction are neither cached, nor shadowed by cached ones.
+  // The types it reads are inserted at the generation noted when it began, so
+  // that they are refused if the cache was invalidated since then, as its
+  // snapshot may predate the invalidating commit. The types read in a pinned
+  // read are not inserted, see SetPinnedRead.
+  TypeCache* GetTypeCache() const;
+
+  // Notes the generations of the caches when a transaction begins, before the
+  // backend takes its snapshot.
+  void NoteCacheGenerations();
+
+  // Invalidates the type cache before changing any type in the current
+  // transaction, and bypasses the cache for the rest of the transaction.
+  void InvalidateTypeCache();
+
+  // Returns the node cache to use in the current transaction, or nullptr if
+  // there is no cache, the transaction has changed any node, or it is a
+  // pinned read. Like the types, the nodes it reads are inserted at the
+  // generation noted when it began.
+  NodeCache* GetNodeCache() const;
+
+  // Returns true if the types and nodes read by the current transaction may
+  // be inserted in the caches, i.e., unless it is a pinned read, whose
+  // snapshot may be older than the caches, or it reads from a lagging replica.
+  bool FillsCaches() const;
+
+  // Invalidates the cached nodes before changing or deleting them, or after
+  // creating them in the current transaction, and bypasses the cache for the
+  // rest of the transaction, so that its uncommitted nodes are not cached.
+  // `Node` is one of {`Artifact`, `Execution`, `Context`}.
+  template <typename Node>
+  void InvalidateNodeCache(absl::Span<const int64> node_ids);
+
   // Creates an Artifact (without properties).
   absl::Status CreateBasicNode(const Artifact& artifact, int64* node_id);
 
@@ -245,17 +608,50 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Creates a Context (without properties).
   absl::Status CreateBasicNode(const Context& context, int64* node_id);
 
+  // Creates a batch of Artifacts (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Artifact> artifacts,
+                                std::vector<int64>* node_ids);
+  // Creates a batch of Executions (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Execution> executions,
+                                std::vector<int64>* node_ids);
+  // Creates a batch of Contexts (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Context> contexts,
+                                std::vector<int64>* node_ids);
+
   // Retrieves nodes (and their properties) based on the provided 'ids'.
   // 'header' contains the non-property information, and 'properties' contains
   // information about properties. The node id is present in both record sets
   // and can be used to join the information. The 'properties' are returned
   // using the same convention as
-  // QueryExecutor::Select{Node}PropertyBy{Node}ID().
+  // QueryExecutor::Select{Node}PropertyBy{Node}ID(). The property query is
+  // skipped, or restricted to the property names, by 'property_options', and
+  // is otherwise pipelined with the node query.
   template <typename T>
   absl::Status RetrieveNodesById(
-      absl::Span<const int64> id, RecordSet* header, RecordSet* properties,
+      absl::Span<const int64> id, TypedRecordSet* header,
+      TypedRecordSet* properties, const PropertyOptions& property_options,
       T* tag = nullptr /* used only for the template */);
 
+  // Same as RetrieveNodesById, but retrieves the nodes of `type_id` by their
+  // `names`. The properties of the found nodes are selected by their ids.
+  template <typename T>
+  absl::Status RetrieveNodesByTypeIdAndNames(
+      int64 type_id, absl::Span<const std::string> names,
+      TypedRecordSet* header, TypedRecordSet* properties,
+      T* tag = nullptr /* used only for the template */);
+
+  // Stores the properties of a node in its `properties_bytes` column, which
+  // is written on every property change once the column exists, see
+  // InlineNodeProperties and MaintainNodePropertiesBytes.
+  absl::Status UpdatePropertiesBytes(int64 node_id, const Artifact& artifact);
+  absl::Status UpdatePropertiesBytes(int64 node_id, const Execution& execution);
+  absl::Status UpdatePropertiesBytes(int64 node_id, const Context& context);
+
+  // Reads the nodes of `node_ids` with their properties from the property
+  // tables, and stores each in its `properties_bytes` column.
+  template <typename Node>
+  absl::Status FillPropertiesBytes(absl::Span<const int64> node_ids);
+
   // Update an Artifact's type_id and URI.
   absl::Status RunNodeUpdate(const Artifact& artifact);
 
@@ -265,12 +661,26 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Update a Context's type id and name.
   absl::Status RunNodeUpdate(const Context& context);
 
+  // Same as RunNodeUpdate, but only updates the node if its stored
+  // last_update_time_since_epoch equals the one of the given node, and sets
+  // `updated` to whether it is updated.
+  absl::Status RunConditionalNodeUpdate(const Artifact& artifact,
+                                        absl::Time update_time, bool* updated);
+  absl::Status RunConditionalNodeUpdate(const Execution& execution,
+                                        absl::Time update_time, bool* updated);
+  absl::Status RunConditionalNodeUpdate(const Context& context,
+                                        absl::Time update_time, bool* updated);
+
   // Runs a property insertion query for a NodeType.
   template <typename NodeType>
   absl::Status InsertProperty(const int64 node_id, const absl::string_view name,
                               const bool is_custom_property,
                               const Value& value);
 
+  // Runs a multi-row property insertion query for a NodeType.
+  template <typename NodeType>
+  absl::Status InsertProperties(absl::Span<const NodeProperty> properties);
+
   // Generates a property update query for a NodeType.
   template <typename NodeType>
   absl::Status UpdateProperty(const int64 node_id, const absl::string_view name,
@@ -281,6 +691,11 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status DeleteProperty(const int64 node_id,
                               const absl::string_view name);
 
+  // Runs a multi-row property deletion query for a NodeType.
+  template <typename NodeType>
+  absl::Status DeleteProperties(
+      absl::Span<const NodePropertyName> property_names);
+
   // Generates a list of queries for the `curr_properties` (C) based on the
   // given `prev_properties` (P). A property definition is a 2-tuple (name,
   // value_type). a) any property in the intersection of C and P, a update query
@@ -291,11 +706,14 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // `is_custom_property` (which indicates the space of the given properties.
   // Returns `output_num_changed_properties` which equals to the number of
   // properties are changed (deleted, updated or inserted).
+  // The struct values of P are compared with their `serialized_structs`, if
+  // given.
   template <typename NodeType>
   absl::Status ModifyProperties(
       const google::protobuf::Map<std::string, Value>& curr_properties,
       const google::protobuf::Map<std::string, Value>& prev_properties,
       const int64 node_id, const bool is_custom_property,
+      const SerializedStructs* serialized_structs,
       int& output_num_changed_properties);
 
   // Creates a query to insert an artifact type.
@@ -307,13 +725,21 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Creates a query to insert a context type.
   absl::Status InsertTypeID(const ContextType& type, int64* type_id);
 
+  // Creates a query to insert a type with the given `type_id`.
+  absl::Status InsertTypeWithID(const ArtifactType& type, int64 type_id);
+  absl::Status InsertTypeWithID(const ExecutionType& type, int64 type_id);
+  absl::Status InsertTypeWithID(const ContextType& type, int64 type_id);
+
   // Creates a `Type` where acceptable ones are in {ArtifactType, ExecutionType,
-  // ContextType}.
+  // ContextType}, with the `given_type_id` if any, otherwise with the id
+  // assigned by the database, and returns its id in `type_id`.
   // Returns INVALID_ARGUMENT error, if name field is not given.
   // Returns INVALID_ARGUMENT error, if any property type is unknown.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename Type>
-  absl::Status CreateTypeImpl(const Type& type, int64* type_id);
+  absl::Status CreateTypeImpl(const Type& type,
+                              absl::optional<int64> given_type_id,
+                              int64* type_id);
 
   // Generates a query to find all type instances.
   absl::Status GenerateFindAllTypeInstancesQuery(const TypeKind type_kind,
@@ -342,6 +768,25 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                             absl::optional<absl::string_view> version,
                             MessageType* type);
 
+  // Finds the types of a batch of (name, version) pairs. The types in the
+  // type cache are not queried, and the others are read with one query for
+  // the types of the names, and one for their properties.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename MessageType>
+  absl::Status FindTypesByNamesAndVersionsImpl(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<MessageType>* types);
+
+  // Finds the types of `type_ids` and sets them in `types` keyed by id. The
+  // types in the type cache are not queried, and the others are read with
+  // one query for the types, and one for their properties. The ids of no
+  // type of the kind are left out.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename MessageType>
+  absl::Status FindTypesByIdsImpl(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, MessageType>* types);
+
   // Finds all type instances of the type `MessageType`.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename MessageType>
@@ -370,6 +815,13 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status FindParentTypesByTypeIdImpl(
       int64 type_id, std::vector<Type>& output_parent_types);
 
+  // Queries the parent types of a batch of type ids, with one query for the
+  // inheritance links and one batched type lookup for the parents.
+  template <typename Type>
+  absl::Status FindParentTypesByTypeIdsImpl(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<Type>>& output_parent_types);
+
   // Creates an `Node`, which is one of {`Artifact`, `Execution`, `Context`},
   // then returns the assigned node id. The node's id field is ignored. The node
   // should have a `NodeType`, which is one of {`ArtifactType`, `ExecutionType`,
@@ -379,6 +831,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   absl::Status CreateNodeImpl(const Node& node, int64* node_id);
 
+  // Creates a batch of `Node`s which are one of {`Artifact`, `Execution`,
+  // `Context`}, and returns the assigned ids in the order of the given nodes.
+  // All nodes are validated before any of them is inserted.
+  // Returns INVALID_ARGUMENT error, if any node does not align with its type.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodesImpl(absl::Span<const Node> nodes,
+                               std::vector<int64>* node_ids);
+
   // Queries a `Node` which is one of {`Artifact`, `Execution`, `Context`} by
   // an id.
   // Returns NOT_FOUND error, if the given id cannot be found.
@@ -394,9 +855,45 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Returns detailed INTERNAL error if query execution fails.
   // If any ids are not found then returns NOT_FOUND if skipped_ids_ok is true,
   // otherwise INTERNAL error.
+  // If `serialized_structs` is given, the struct property values stored as
+  // bytes are not parsed. They are returned in it instead, and are empty
+  // structs in `nodes`.
+  // The properties of the nodes are selected with `property_options`.
+  template <typename Node>
+  absl::Status FindNodesImpl(
+      absl::Span<const int64> node_ids, bool skipped_ids_ok,
+      std::vector<Node>& nodes, SerializedStructs* serialized_structs = nullptr,
+      const PropertyOptions& property_options =
+          PropertyOptions::default_instance());
+
+  // Retrieves the `Node`s of `type_id` by their `names`, with one query for
+  // the nodes and one for their properties. The names not found are skipped.
+  // Returns detailed INTERNAL error if query execution fails.
   template <typename Node>
-  absl::Status FindNodesImpl(absl::Span<const int64> node_ids,
-                             bool skipped_ids_ok, std::vector<Node>& nodes);
+  absl::Status FindNodesByTypeIdAndNamesImpl(
+      int64 type_id, absl::Span<const std::string> names,
+      std::vector<Node>& nodes);
+
+  // Groups the nodes of the attribution or association triplets in
+  // `record_set` by the ids in the column `key_position`, fetching each node
+  // of the column `node_position` once, e.g., the artifacts by context with
+  // the columns 1 and 2, or the contexts by artifact with the columns 2 and 1.
+  // Returns detailed INTERNAL error if query execution fails.
+  template <typename Node>
+  absl::Status FindLinkedNodesImpl(
+      const RecordSet& record_set, int key_position, int node_position,
+      absl::flat_hash_map<int64, std::vector<Node>>& nodes_by_key);
+
+  // Reads the nodes of the given 'node_ids' in batches of
+  // kNodeStreamingBatchSize, and passes each batch to 'callback'. Only one
+  // batch of nodes is materialized at a time.
+  // Returns detailed INTERNAL error, if any node cannot be found.
+  // Returns the error returned by 'callback', if any.
+  template <typename Node>
+  absl::Status StreamNodesImpl(absl::Span<const int64> node_ids,
+                               const NodeBatchCallback<Node>& callback,
+                               const PropertyOptions& property_options =
+                                   PropertyOptions::default_instance());
 
   // Updates a `Node` which is one of {`Artifact`, `Execution`, `Context`}.
   // Returns INVALID_ARGUMENT error, if the node cannot be found
@@ -405,11 +902,30 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   absl::Status UpdateNodeImpl(const Node& node);
 
+  // Updates a batch of `Node`s which are one of {`Artifact`, `Execution`,
+  // `Context`}. The stored nodes are read with one query, the property
+  // changes of all nodes are computed in memory, and applied with a few
+  // set-based statements. All nodes are validated before any of them is
+  // updated.
+  // Returns INVALID_ARGUMENT error, if any node cannot be found, or is given
+  //   more than once.
+  // If `check_last_update_time` is set, every node is first updated with a
+  // conditional UPDATE on its last_update_time_since_epoch in the order of the
+  // ids, before any property is written.
+  // Returns INVALID_ARGUMENT error, if any node does not match with its type
+  // Returns FAILED_PRECONDITION error, if `check_last_update_time` is set and
+  //   the last_update_time_since_epoch of any node is changed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  absl::Status UpdateNodesImpl(absl::Span<const Node> nodes,
+                               bool check_last_update_time = false);
+
   // Takes a record set that has one record per event and for each record:
   //   parses it into an Event object
-  //   gets the path of the event from the database
+  //   assigns the path of the event from the `path_record_set`
   // Returns INVALID_ARGUMENT error, if the `events` is null.
   absl::Status FindEventsFromRecordSet(const RecordSet& event_record_set,
+                                       const RecordSet& path_record_set,
                                        std::vector<Event>* events);
 
   // Retrieves the ids of the nodes based on 'options' and `candidate_ids`.
@@ -444,8 +960,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node>
   absl::Status ListNodes(const ListOperationOptions& options,
                          absl::optional<absl::Span<const int64>> candidate_ids,
-                         std::vector<Node>* nodes,
-                         std::string* next_page_token);
+                         std::vector<Node>* nodes, std::string* next_page_token,
+                         const PropertyOptions& property_options =
+                             PropertyOptions::default_instance());
+
+  // Returns INVALID_ARGUMENT error "Context id not found.", if any of the
+  // `context_ids` does not exist. The ids returned by CreateContextIfNotExist
+  // in the current transaction are not read again, as a plain read of a
+  // REPEATABLE READ snapshot misses a context committed after it began.
+  absl::Status CheckContextsExist(absl::Span<const int64> context_ids);
 
   // Traverse a ParentContext relation to look for parent or child context.
   enum class ParentContextTraverseDirection { kParent, kChild };
@@ -457,8 +980,53 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                                       ParentContextTraverseDirection direction,
                                       std::vector<Context>& output_contexts);
 
+  // Queries the ParentContext links within `max_depth` levels of a context_id
+  // in the direction, into records with the columns of
+  // SelectParentContextsByContextID. It uses a single recursive query, and
+  // falls back to one query per linked context if the backend rejects its
+  // syntax, e.g., on MySQL before 8.0. After such a failure, the recursive
+  // query is not tried again. The other errors of the query are returned.
+  absl::Status SelectTransitiveLinksImpl(
+      int64 context_id, int64 max_depth,
+      ParentContextTraverseDirection direction, RecordSet* record_set);
+
+  // Queries the contexts linked to a context_id within `max_depth` levels,
+  // and the ParentContext links between them.
+  absl::Status FindTransitiveLinkedContextsImpl(
+      int64 context_id, int64 max_depth,
+      ParentContextTraverseDirection direction,
+      std::vector<Context>& output_contexts,
+      std::vector<ParentContext>& output_parent_contexts);
+
 
   std::unique_ptr<QueryExecutor> executor_;
+
+  MetadataSource* const metadata_source_ = nullptr;
+  const int64 schema_version_ = 0;
+  TypeCache* const type_cache_ = nullptr;
+  // The transaction which has changed types, see GetTypeCache().
+  int64 type_changing_transaction_ = -1;
+  // The transaction whose cache generations are noted, and the generations of
+  // the type and node caches when it began.
+  int64 cache_generations_transaction_ = -1;
+  int64 type_cache_generation_ = 0;
+  int64 node_cache_generation_ = 0;
+  // The handle of the callback noting them, or -1 if there is no cache.
+  int64 begin_callback_handle_ = -1;
+  // Whether the reads run in a pinned read, see SetPinnedRead.
+  bool pinned_read_ = false;
+  NodeCache* const node_cache_ = nullptr;
+  // The transaction which has changed nodes, see GetNodeCache().
+  int64 node_changing_transaction_ = -1;
+  // The transaction whose contexts returned by CreateContextIfNotExist are
+  // kept, and their ids, see CheckContextsExist(). They are dropped after a
+  // rollback to a savepoint, which may have undone a created context.
+  int64 ensured_contexts_transaction_ = -1;
+  int64 ensured_contexts_savepoint_rollbacks_ = 0;
+  absl::flat_hash_set<int64> ensured_context_ids_;
+  // Whether the recursive ParentContext queries may be supported, see
+  // SelectTransitiveLinksImpl().
+  bool recursive_link_queries_supported_ = true;
 };
 
 }  // namespace ml_metadata
@@ -0,0 +1,425 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Microbenchmarks of the CPU-heavy helpers of the metadata access objects:
+// the parsing of the query results, the composition of the queries, the
+// escaping of the strings, the serialization of the struct properties and the
+// list operation page tokens. The queries are composed for a metadata source
+// that does not run them, so that the helpers are measured in isolation from
+// the database, e.g.,
+//   bazel run -c opt //ml_metadata/metadata_store:record_parsing_benchmark --
+//     --benchmark_filter=ParseTypedRecordSetsToNodes
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include "benchmark/benchmark.h"
+#include "google/protobuf/struct.pb.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/query_config_executor.h"
+#include "ml_metadata/metadata_store/record_parsing_util.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "ml_metadata/util/struct_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The number of properties of each node, and the number of fields of each
+// struct property.
+constexpr int kNumProperties = 5;
+
+// A MetadataSource that discards its queries, so that the composition of the
+// queries is measured without running them. The strings are escaped as in
+// SQLite.
+class DiscardingMetadataSource : public MetadataSource {
+ public:
+  std::string EscapeString(absl::string_view value) const final {
+    return SqliteEscapeString(value);
+  }
+
+ private:
+  absl::Status ConnectImpl() final { return absl::OkStatus(); }
+  absl::Status CloseImpl() final { return absl::OkStatus(); }
+  absl::Status ExecuteQueryImpl(const std::string& query,
+                                RecordSet* results) final {
+    benchmark::DoNotOptimize(query.data());
+    return absl::OkStatus();
+  }
+  absl::Status BeginImpl() final { return absl::OkStatus(); }
+  absl::Status CommitImpl() final { return absl::OkStatus(); }
+  absl::Status RollbackImpl() final { return absl::OkStatus(); }
+};
+
+// Returns a string of `size` characters with a quote every 16 characters,
+// which need to be escaped.
+std::string GetText(const int size) {
+  std::string text(size, 'a');
+  for (int i = 0; i < size; i += 16) {
+    text[i] = '\'';
+  }
+  return text;
+}
+
+// Returns a struct with `num_fields` string fields of `field_size` characters
+// and a nested list.
+google::protobuf::Struct GetStruct(const int num_fields, const int field_size) {
+  google::protobuf::Struct struct_value;
+  for (int i = 0; i < num_fields; ++i) {
+    (*struct_value.mutable_fields())[absl::StrCat("field_", i)]
+        .set_string_value(std::string(field_size, 'a'));
+  }
+  google::protobuf::ListValue* list =
+      (*struct_value.mutable_fields())["list"].mutable_list_value();
+  for (int i = 0; i < num_fields; ++i) {
+    list->add_values()->set_number_value(i);
+  }
+  return struct_value;
+}
+
+// Returns the artifact rows of a query result in the RecordSet encoding, whose
+// cells are all strings.
+RecordSet GetArtifactRecordSet(const int num_rows) {
+  RecordSet record_set;
+  for (const char* column :
+       {"id", "type_id", "uri", "state", "name", "create_time_since_epoch",
+        "last_update_time_since_epoch"}) {
+    record_set.add_column_names(column);
+  }
+  for (int i = 0; i < num_rows; ++i) {
+    RecordSet::Record* record = record_set.add_records();
+    record->add_values(absl::StrCat(i + 1));
+    record->add_values("1");
+    record->add_values(absl::StrCat("/pipeline/run/output/artifact_", i));
+    record->add_values("2");
+    record->add_values(absl::StrCat("artifact_", i));
+    record->add_values("1612345678901");
+    record->add_values("1612345678901");
+  }
+  return record_set;
+}
+
+// Returns the artifact rows of a query result in a TypedRecordSet.
+TypedRecordSet GetArtifactTypedRecordSet(const int num_rows) {
+  TypedRecordSet record_set(
+      {"id", "type_id", "uri", "state", "name", "create_time_since_epoch",
+       "last_update_time_since_epoch"});
+  for (int i = 0; i < num_rows; ++i) {
+    record_set.AppendInt64(i + 1);
+    record_set.AppendInt64(1);
+    record_set.AppendString(absl::StrCat("/pipeline/run/output/artifact_", i));
+    record_set.AppendInt64(2);
+    record_set.AppendString(absl::StrCat("artifact_", i));
+    record_set.AppendInt64(1612345678901);
+    record_set.AppendInt64(1612345678901);
+  }
+  return record_set;
+}
+
+// Returns the kNumProperties properties of each of the `num_rows` artifacts,
+// in the encoding of QueryExecutor::SelectArtifactPropertyByArtifactID(). The
+// properties cycle through the int, double, string and struct values, whose
+// strings have `value_size` characters.
+TypedRecordSet GetPropertiesTypedRecordSet(const int num_rows,
+                                           const int value_size) {
+  TypedRecordSet record_set({"artifact_id", "name", "is_custom_property",
+                             "int_value", "double_value", "string_value",
+                             "byte_value"});
+  const std::string string_value(value_size, 'a');
+  const std::string byte_value =
+      StructToBytes(GetStruct(kNumProperties, value_size / kNumProperties));
+  for (int i = 0; i < num_rows; ++i) {
+    for (int j = 0; j < kNumProperties; ++j) {
+      record_set.AppendInt64(i + 1);
+      record_set.AppendString(absl::StrCat("property_", j));
+      record_set.AppendInt64(j % 2);
+      switch (j % 4) {
+        case 0:
+          record_set.AppendInt64(j);
+          record_set.AppendNull();
+          record_set.AppendNull();
+          record_set.AppendNull();
+          break;
+        case 1:
+          record_set.AppendNull();
+          record_set.AppendDouble(j + 0.5);
+          record_set.AppendNull();
+          record_set.AppendNull();
+          break;
+        case 2:
+          record_set.AppendNull();
+          record_set.AppendNull();
+          record_set.AppendString(string_value);
+          record_set.AppendNull();
+          break;
+        default:
+          record_set.AppendNull();
+          record_set.AppendNull();
+          record_set.AppendNull();
+          record_set.AppendString(byte_value);
+      }
+    }
+  }
+  return record_set;
+}
+
+// Returns the options of the list operations of the page token benchmarks,
+// which are ordered by the `field` of `state.range(0)`.
+ListOperationOptions GetListOptions(const benchmark::State& state) {
+  ListOperationOptions options;
+  options.mutable_order_by_field()->set_field(
+      static_cast<ListOperationOptions::OrderByField::Field>(state.range(0)));
+  options.set_max_result_size(100);
+  return options;
+}
+
+// Returns a page of artifacts of a list operation.
+std::vector<Artifact> GetListedArtifacts() {
+  std::vector<Artifact> artifacts(100);
+  for (int i = 0; i < artifacts.size(); ++i) {
+    artifacts[i].set_id(i + 1);
+    artifacts[i].set_create_time_since_epoch(1612345678901 + i);
+    artifacts[i].set_last_update_time_since_epoch(1612345678901 + i);
+  }
+  return artifacts;
+}
+
+// The RecordSet rows are parsed to the messages, e.g., the events.
+void BM_ParseRecordSetToMessageArray(benchmark::State& state) {
+  const RecordSet record_set = GetArtifactRecordSet(state.range(0));
+  for (auto _ : state) {
+    std::vector<Artifact> artifacts;
+    CHECK(ParseRecordSetToMessageArray(record_set, &artifacts).ok());
+    benchmark::DoNotOptimize(artifacts.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseRecordSetToMessageArray)->Arg(10)->Arg(100)->Arg(1000);
+
+// The nodes and their properties are parsed as in FindArtifactsById. The
+// arguments are the number of nodes and the size of their string properties.
+void BM_ParseTypedRecordSetsToNodes(benchmark::State& state) {
+  const TypedRecordSet node_record_set =
+      GetArtifactTypedRecordSet(state.range(0));
+  const TypedRecordSet properties_record_set =
+      GetPropertiesTypedRecordSet(state.range(0), state.range(1));
+  for (auto _ : state) {
+    std::vector<Artifact> artifacts;
+    CHECK(ParseTypedRecordSetsToNodes(node_record_set, properties_record_set,
+                                      &artifacts)
+              .ok());
+    benchmark::DoNotOptimize(artifacts.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseTypedRecordSetsToNodes)
+    ->Args({10, 16})
+    ->Args({100, 16})
+    ->Args({1000, 16})
+    ->Args({100, 1024});
+
+// The properties alone are populated, with the struct values kept serialized
+// as in the update paths.
+void BM_PopulateNodeProperties(benchmark::State& state) {
+  const TypedRecordSet properties_record_set =
+      GetPropertiesTypedRecordSet(/*num_rows=*/1, state.range(0));
+  for (auto _ : state) {
+    Artifact artifact;
+    artifact.set_id(1);
+    SerializedStructs serialized_structs;
+    for (int row = 0; row < properties_record_set.num_rows(); ++row) {
+      CHECK(PopulateNodeProperties(properties_record_set, row, artifact,
+                                   &serialized_structs)
+                .ok());
+    }
+    benchmark::DoNotOptimize(artifact.properties().size());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumProperties);
+}
+BENCHMARK(BM_PopulateNodeProperties)->Arg(16)->Arg(1024);
+
+void BM_SqliteEscapeString(benchmark::State& state) {
+  const std::string text = GetText(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SqliteEscapeString(text));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SqliteEscapeString)->Arg(16)->Arg(256)->Arg(4096);
+
+// Most strings, e.g., the uris and the names, have no byte to escape, and are
+// copied as is.
+void BM_SqliteEscapePlainString(benchmark::State& state) {
+  const std::string text(state.range(0), 'a');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SqliteEscapeString(text));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SqliteEscapePlainString)->Arg(16)->Arg(256)->Arg(4096);
+
+// The scan with which MySqlMetadataSource::EscapeString skips the strings
+// without any byte to escape.
+void BM_FindMySqlSpecialByte(benchmark::State& state) {
+  const std::string text(state.range(0), 'a');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindMySqlSpecialByte(text));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindMySqlSpecialByte)->Arg(16)->Arg(256)->Arg(4096);
+
+// The id and time columns of the query results are decoded from their text.
+void BM_ParseDecimalInt64(benchmark::State& state) {
+  const RecordSet record_set = GetArtifactRecordSet(/*num_rows=*/1000);
+  for (auto _ : state) {
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 id, create_time;
+      CHECK(ParseDecimalInt64(record.values(0), &id));
+      CHECK(ParseDecimalInt64(record.values(5), &create_time));
+      benchmark::DoNotOptimize(id + create_time);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * record_set.records_size());
+}
+BENCHMARK(BM_ParseDecimalInt64);
+
+// An artifact update is composed with QueryConfigExecutor::Bind, which
+// escapes its uri.
+void BM_QueryConfigExecutorBindUpdate(benchmark::State& state) {
+  DiscardingMetadataSource source;
+  CHECK(source.Connect().ok());
+  CHECK(source.Begin().ok());
+  QueryConfigExecutor executor(util::GetSqliteMetadataSourceQueryConfig(),
+                               &source);
+  const std::string uri = GetText(state.range(0));
+  const absl::Time update_time = absl::FromUnixMillis(1612345678901);
+  for (auto _ : state) {
+    CHECK(executor
+              .UpdateArtifactDirect(/*artifact_id=*/1, /*type_id=*/1, uri,
+                                    Artifact::LIVE, update_time)
+              .ok());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueryConfigExecutorBindUpdate)->Arg(16)->Arg(256)->Arg(4096);
+
+// A property insertion is composed with the values of the prepared statement
+// inlined into the query, as for the metadata sources without server-side
+// prepared statements.
+void BM_QueryConfigExecutorBindPreparedInsert(benchmark::State& state) {
+  DiscardingMetadataSource source;
+  CHECK(source.Connect().ok());
+  CHECK(source.Begin().ok());
+  QueryConfigExecutor executor(util::GetSqliteMetadataSourceQueryConfig(),
+                               &source);
+  Value value;
+  value.set_string_value(GetText(state.range(0)));
+  for (auto _ : state) {
+    CHECK(executor
+              .InsertArtifactProperty(/*artifact_id=*/1, "property",
+                                      /*is_custom_property=*/false, value)
+              .ok());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueryConfigExecutorBindPreparedInsert)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(4096);
+
+// The arguments of the struct benchmarks are the number of fields and their
+// size.
+void BM_StructToString(benchmark::State& state) {
+  const google::protobuf::Struct struct_value =
+      GetStruct(state.range(0), state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StructToString(struct_value));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StructToString)->Args({5, 16})->Args({50, 16})->Args({5, 1024});
+
+void BM_StringToStruct(benchmark::State& state) {
+  const std::string serialized_value =
+      StructToString(GetStruct(state.range(0), state.range(1)));
+  for (auto _ : state) {
+    google::protobuf::Struct struct_value;
+    CHECK(StringToStruct(serialized_value, struct_value).ok());
+    benchmark::DoNotOptimize(struct_value.fields().size());
+  }
+  state.SetBytesProcessed(state.iterations() * serialized_value.size());
+}
+BENCHMARK(BM_StringToStruct)->Args({5, 16})->Args({50, 16})->Args({5, 1024});
+
+void BM_BytesToStruct(benchmark::State& state) {
+  const std::string serialized_value =
+      StructToBytes(GetStruct(state.range(0), state.range(1)));
+  for (auto _ : state) {
+    google::protobuf::Struct struct_value;
+    CHECK(BytesToStruct(serialized_value, struct_value).ok());
+    benchmark::DoNotOptimize(struct_value.fields().size());
+  }
+  state.SetBytesProcessed(state.iterations() * serialized_value.size());
+}
+BENCHMARK(BM_BytesToStruct)->Args({5, 16})->Args({50, 16})->Args({5, 1024});
+
+void BM_BuildListOperationNextPageToken(benchmark::State& state) {
+  const std::vector<Artifact> artifacts = GetListedArtifacts();
+  const ListOperationOptions options = GetListOptions(state);
+  for (auto _ : state) {
+    std::string next_page_token;
+    CHECK(BuildListOperationNextPageToken(
+              absl::MakeConstSpan(artifacts), options, &next_page_token)
+              .ok());
+    benchmark::DoNotOptimize(next_page_token.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BuildListOperationNextPageToken)
+    ->Arg(ListOperationOptions::OrderByField::ID)
+    ->Arg(ListOperationOptions::OrderByField::CREATE_TIME);
+
+void BM_DecodeListOperationNextPageToken(benchmark::State& state) {
+  std::string next_page_token;
+  CHECK(BuildListOperationNextPageToken(
+            absl::MakeConstSpan(GetListedArtifacts()), GetListOptions(state),
+            &next_page_token)
+            .ok());
+  for (auto _ : state) {
+    ListOperationNextPageToken token;
+    CHECK(DecodeListOperationNextPageToken(next_page_token, token).ok());
+    benchmark::DoNotOptimize(token.id_offset());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeListOperationNextPageToken)
+    ->Arg(ListOperationOptions::OrderByField::ID)
+    ->Arg(ListOperationOptions::OrderByField::CREATE_TIME);
+
+}  // namespace
+}  // namespace ml_metadata
+
+BENCHMARK_MAIN();
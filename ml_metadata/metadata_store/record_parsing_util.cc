@@ -0,0 +1,158 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/record_parsing_util.h"
+
+#include <string>
+
+#include <glog/logging.h>
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/util/json_util.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Parses and converts a string value to a specific field in a message.
+// If the given string `value` is NULL (encoded as kMetadataSourceNull), then
+// leave the field unset.
+// The field should be a scalar field. The field type must be one of {string,
+// int64, bool, enum, message}.
+absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_descriptor,
+                               const absl::string_view value,
+                               google::protobuf::Message* message) {
+  if (value == kMetadataSourceNull) {
+    return absl::OkStatus();
+  }
+  const google::protobuf::Reflection* reflection = message->GetReflection();
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_STRING: {
+      if (field_descriptor->is_repeated())
+        reflection->AddString(message, field_descriptor, std::string(value));
+      else
+        reflection->SetString(message, field_descriptor, std::string(value));
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_INT64: {
+      int64 int64_value;
+      CHECK(ParseDecimalInt64(value, &int64_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddInt64(message, field_descriptor, int64_value);
+      else
+        reflection->SetInt64(message, field_descriptor, int64_value);
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_BOOL: {
+      bool bool_value;
+      CHECK(absl::SimpleAtob(value, &bool_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddBool(message, field_descriptor, bool_value);
+      else
+        reflection->SetBool(message, field_descriptor, bool_value);
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_ENUM: {
+      int enum_value;
+      CHECK(absl::SimpleAtoi(value, &enum_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddEnumValue(message, field_descriptor, enum_value);
+      else
+        reflection->SetEnumValue(message, field_descriptor, enum_value);
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_MESSAGE: {
+      CHECK(!field_descriptor->is_repeated())
+          << "Cannot handle a repeated message";
+      if (!value.empty()) {
+        ::google::protobuf::Message* sub_message =
+            reflection->MutableMessage(message, field_descriptor);
+        if (!::google::protobuf::util::JsonStringToMessage(
+                 std::string(value.begin(), value.size()), sub_message)
+                 .ok()) {
+          return absl::InternalError(
+              ::absl::StrCat("Failed to parse proto: ", value));
+        }
+      }
+      break;
+    }
+    default: {
+      return absl::InternalError(absl::StrCat("Unsupported field type: ",
+                                              field_descriptor->cpp_type()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Sets a field in a message from the cell at (`row`, `column`) of a
+// TypedRecordSet. Integer cells are read without parsing. A NULL cell leaves
+// the field unset. The field type must be one of {string, int64, bool, enum,
+// message}.
+absl::Status ParseCellToField(
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    const TypedRecordSet& record_set, const int row, const int column,
+    google::protobuf::Message* message) {
+  if (record_set.IsNull(row, column)) {
+    return absl::OkStatus();
+  }
+  const google::protobuf::Reflection* reflection = message->GetReflection();
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_INT64: {
+      int64 int64_value;
+      CHECK(record_set.GetInt64(row, column, &int64_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddInt64(message, field_descriptor, int64_value);
+      else
+        reflection->SetInt64(message, field_descriptor, int64_value);
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_BOOL: {
+      bool bool_value;
+      CHECK(record_set.GetBool(row, column, &bool_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddBool(message, field_descriptor, bool_value);
+      else
+        reflection->SetBool(message, field_descriptor, bool_value);
+      break;
+    }
+    case google::protobuf::FieldDescriptor::CppType::CPPTYPE_ENUM: {
+      int64 enum_value;
+      CHECK(record_set.GetInt64(row, column, &enum_value));
+      if (field_descriptor->is_repeated())
+        reflection->AddEnumValue(message, field_descriptor, enum_value);
+      else
+        reflection->SetEnumValue(message, field_descriptor, enum_value);
+      break;
+    }
+    default: {
+      // Strings and messages are parsed from the text of the cell.
+      if (record_set.cell_type(row, column) ==
+          TypedRecordSet::CellType::kString) {
+        return ParseValueToField(field_descriptor,
+                                 record_set.GetString(row, column), message);
+      }
+      return ParseValueToField(field_descriptor,
+                               record_set.FormatCell(row, column), message);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,250 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_RECORD_PARSING_UTIL_H_
+#define ML_METADATA_METADATA_STORE_RECORD_PARSING_UTIL_H_
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <glog/logging.h>
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/return_utils.h"
+#include "ml_metadata/util/struct_utils.h"
+
+namespace ml_metadata {
+
+// The serialized struct property values of the stored nodes read by the update
+// paths, which are compared with the updated values without parsing them. The
+// keys are the node id, whether it is a custom property and the property name.
+using SerializedStructs =
+    absl::flat_hash_map<std::tuple<int64, bool, std::string>, std::string>;
+
+// Parses and converts a string value to a specific field in a message.
+// If the given string `value` is NULL (encoded as kMetadataSourceNull), then
+// leave the field unset.
+// The field should be a scalar field. The field type must be one of {string,
+// int64, bool, enum, message}.
+absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_descriptor,
+                               const absl::string_view value,
+                               google::protobuf::Message* message);
+
+// Resolves the MessageType field with the same name as each of the
+// `column_names` of a query result, or nullptr if there is none, so that the
+// fields are looked up once per result instead of once per cell.
+template <typename MessageType, typename ColumnNames>
+std::vector<const google::protobuf::FieldDescriptor*> ResolveColumnFields(
+    const ColumnNames& column_names) {
+  const google::protobuf::Descriptor* descriptor = MessageType::descriptor();
+  std::vector<const google::protobuf::FieldDescriptor*> column_fields;
+  column_fields.reserve(column_names.size());
+  for (const std::string& column_name : column_names) {
+    column_fields.push_back(descriptor->FindFieldByName(column_name));
+  }
+  return column_fields;
+}
+
+// Converts the record at `record_index` of a RecordSet in the query result to
+// a MessageType. The value of each column is assigned to its field in
+// `column_fields`, see ResolveColumnFields.
+template <typename MessageType>
+absl::Status ParseRecordSetToMessage(
+    const RecordSet& record_set,
+    absl::Span<const google::protobuf::FieldDescriptor* const> column_fields,
+    const int record_index, MessageType* message) {
+  CHECK_LT(record_index, record_set.records_size());
+  const RecordSet::Record& record = record_set.records(record_index);
+  for (int i = 0; i < column_fields.size(); i++) {
+    if (column_fields[i] == nullptr) continue;
+    MLMD_RETURN_IF_ERROR(
+        ParseValueToField(column_fields[i], record.values(i), message));
+  }
+  return absl::OkStatus();
+}
+
+// Converts a RecordSet in the query result to a MessageType array.
+template <typename MessageType>
+absl::Status ParseRecordSetToMessageArray(const RecordSet& record_set,
+                                          std::vector<MessageType>* messages) {
+  const std::vector<const google::protobuf::FieldDescriptor*> column_fields =
+      ResolveColumnFields<MessageType>(record_set.column_names());
+  messages->reserve(messages->size() + record_set.records_size());
+  for (int i = 0; i < record_set.records_size(); i++) {
+    messages->push_back(MessageType());
+    MLMD_RETURN_IF_ERROR(ParseRecordSetToMessage(record_set, column_fields, i,
+                                                 &messages->back()));
+  }
+  return absl::OkStatus();
+}
+
+// Sets a field in a message from the cell at (`row`, `column`) of a
+// TypedRecordSet. Integer cells are read without parsing. A NULL cell leaves
+// the field unset. The field type must be one of {string, int64, bool, enum,
+// message}.
+absl::Status ParseCellToField(
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    const TypedRecordSet& record_set, const int row, const int column,
+    google::protobuf::Message* message);
+
+// Converts a TypedRecordSet in the query result to a MessageType array. The
+// value of each column is assigned to a message field with the same field
+// name as the column name.
+template <typename MessageType>
+absl::Status ParseTypedRecordSetToMessageArray(
+    const TypedRecordSet& record_set, std::vector<MessageType>* messages) {
+  // Resolves the fields once for all rows.
+  const std::vector<const google::protobuf::FieldDescriptor*>
+      field_descriptors =
+          ResolveColumnFields<MessageType>(record_set.column_names());
+  messages->reserve(messages->size() + record_set.num_rows());
+  for (int row = 0; row < record_set.num_rows(); row++) {
+    messages->push_back(MessageType());
+    for (int column = 0; column < record_set.num_columns(); column++) {
+      if (field_descriptors[column] == nullptr) continue;
+      MLMD_RETURN_IF_ERROR(ParseCellToField(field_descriptors[column],
+                                            record_set, row, column,
+                                            &messages->back()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Parses the nodes in `node_record_set` and their properties in
+// `properties_record_set`, and appends them to `nodes`, which must be empty.
+// The properties are encoded using the convention in
+// QueryExecutor::Get{X}PropertyBy{X}Id(), and each of them must belong to one
+// of the nodes.
+template <typename Node>
+absl::Status ParseTypedRecordSetsToNodes(
+    const TypedRecordSet& node_record_set,
+    const TypedRecordSet& properties_record_set, std::vector<Node>* nodes,
+    SerializedStructs* serialized_structs = nullptr) {
+  if (!nodes->empty()) {
+    return absl::InvalidArgumentError("nodes parameter is not empty");
+  }
+  MLMD_RETURN_IF_ERROR(
+      ParseTypedRecordSetToMessageArray(node_record_set, nodes));
+
+  // The properties stored inline are parsed from the column of the nodes. The
+  // nodes whose column is NULL take theirs from `properties_record_set`.
+  const auto properties_bytes_column =
+      absl::c_find(node_record_set.column_names(), "properties_bytes");
+  if (properties_bytes_column != node_record_set.column_names().end()) {
+    const int column =
+        properties_bytes_column - node_record_set.column_names().begin();
+    for (int row = 0; row < node_record_set.num_rows(); row++) {
+      if (node_record_set.IsNull(row, column)) continue;
+      const absl::string_view properties_bytes =
+          node_record_set.GetString(row, column);
+      Node& node = (*nodes)[row];
+      Node properties;
+      if (!properties.ParseFromArray(properties_bytes.data(),
+                                     properties_bytes.size())) {
+        return absl::InternalError(absl::StrCat(
+            "Failed to parse the properties of node ", node.id()));
+      }
+      node.mutable_properties()->swap(*properties.mutable_properties());
+      node.mutable_custom_properties()->swap(
+          *properties.mutable_custom_properties());
+    }
+  }
+
+  // if there are properties associated with the nodes, parse the returned
+  // values.
+  if (properties_record_set.num_rows() > 0) {
+    // First we build a hash map from node ids to Node messages, to
+    // facilitate lookups.
+    absl::flat_hash_map<int64, typename std::vector<Node>::iterator> node_by_id;
+    for (auto i = nodes->begin(); i != nodes->end(); ++i) {
+      node_by_id.insert({i->id(), i});
+    }
+
+    CHECK_EQ(properties_record_set.num_columns(), 7);
+    for (int row = 0; row < properties_record_set.num_rows(); row++) {
+      // Match the record against a node in the hash map.
+      int64 node_id;
+      CHECK(properties_record_set.GetInt64(row, 0, &node_id));
+      auto iter = node_by_id.find(node_id);
+      CHECK(iter != node_by_id.end());
+      Node& node = *iter->second;
+
+      MLMD_RETURN_IF_ERROR(PopulateNodeProperties(properties_record_set, row,
+                                                  node, serialized_structs));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Populates 'node' properties from the row at 'row' in 'record_set'. The
+// assumption is that properties are encoded using the convention in
+// QueryExecutor::Get{X}PropertyBy{X}Id() where X in {Artifact, Execution,
+// Context}. If 'serialized_structs' is given, a struct value stored as bytes is
+// kept in it instead of being parsed, and the property is an empty struct.
+template <typename Node>
+absl::Status PopulateNodeProperties(const TypedRecordSet& record_set,
+                                    const int row, Node& node,
+                                    SerializedStructs* serialized_structs) {
+  // Populate the property of the node.
+  const std::string property_name = record_set.FormatCell(row, 1);
+  bool is_custom_property;
+  CHECK(record_set.GetBool(row, 2, &is_custom_property));
+  auto& property_value =
+      (is_custom_property ? (*node.mutable_custom_properties())[property_name]
+                          : (*node.mutable_properties())[property_name]);
+  if (!record_set.IsNull(row, 3)) {
+    int64 int_value;
+    CHECK(record_set.GetInt64(row, 3, &int_value));
+    property_value.set_int_value(int_value);
+  } else if (!record_set.IsNull(row, 4)) {
+    double double_value;
+    CHECK(record_set.GetDouble(row, 4, &double_value));
+    property_value.set_double_value(double_value);
+  } else if (!record_set.IsNull(row, 6)) {
+    // The struct values are stored as bytes since v9.
+    const absl::string_view byte_value = record_set.GetString(row, 6);
+    if (serialized_structs != nullptr) {
+      property_value.mutable_struct_value();
+      (*serialized_structs)[{node.id(), is_custom_property, property_name}] =
+          std::string(byte_value);
+    } else {
+      MLMD_RETURN_IF_ERROR(
+          BytesToStruct(byte_value, *property_value.mutable_struct_value()));
+    }
+  } else {
+    const std::string string_value = record_set.FormatCell(row, 5);
+    if (IsStructSerializedString(string_value)) {
+      MLMD_RETURN_IF_ERROR(
+          StringToStruct(string_value, *property_value.mutable_struct_value()));
+    } else {
+      property_value.set_string_value(string_value);
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_RECORD_PARSING_UTIL_H_
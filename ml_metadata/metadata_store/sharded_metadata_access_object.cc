@@ -0,0 +1,1895 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sharded_metadata_access_object.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+#include <glog/logging.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the shard of a new context of `type_id` and `name`. The FNV-1a hash
+// is used, as it is stable across processes and releases.
+int ShardOfContextName(const int64 type_id, const absl::string_view name,
+                       const int num_shards) {
+  uint64_t hash = 14695981039346656037ULL;
+  const auto add_byte = [&hash](const unsigned char byte) {
+    hash = (hash ^ byte) * 1099511628211ULL;
+  };
+  for (const char c : name) {
+    add_byte(static_cast<unsigned char>(c));
+  }
+  for (int i = 0; i < 8; i++) {
+    add_byte(static_cast<uint64_t>(type_id) >> (8 * i) & 0xff);
+  }
+  return static_cast<int>(hash % num_shards);
+}
+
+// Merges `other` into `aggregate` of the same state. The average is weighted
+// by the numbers of values.
+void MergePropertyAggregate(const PropertyAggregate& other,
+                            PropertyAggregate& aggregate) {
+  const int64 num_values = aggregate.num_values() + other.num_values();
+  if (other.num_values() > 0 && aggregate.num_values() == 0) {
+    aggregate.set_min_value(other.min_value());
+    aggregate.set_max_value(other.max_value());
+    aggregate.set_avg_value(other.avg_value());
+  } else if (other.num_values() > 0) {
+    aggregate.set_min_value(std::min(aggregate.min_value(), other.min_value()));
+    aggregate.set_max_value(std::max(aggregate.max_value(), other.max_value()));
+    aggregate.set_avg_value(
+        (aggregate.avg_value() * aggregate.num_values() +
+         other.avg_value() * other.num_values()) /
+        num_values);
+  }
+  aggregate.set_num_nodes(aggregate.num_nodes() + other.num_nodes());
+  aggregate.set_num_values(num_values);
+}
+
+}  // namespace
+
+ShardedMetadataAccessObject::ShardedMetadataAccessObject(
+    std::vector<std::unique_ptr<MetadataAccessObject>> shards)
+    : shards_(std::move(shards)) {
+  CHECK(!shards_.empty()) << "There must be at least one shard.";
+}
+
+int ShardedMetadataAccessObject::ShardOf(const int64 id) const {
+  return id > 0 ? static_cast<int>(id % shards_.size()) : 0;
+}
+
+int64 ShardedMetadataAccessObject::ToGlobalId(const int64 local_id,
+                                              const int shard) const {
+  return local_id * static_cast<int64>(shards_.size()) + shard;
+}
+
+int64 ShardedMetadataAccessObject::ToLocalId(const int64 id) const {
+  // The invalid ids are passed on as they are, for the shard to reject them.
+  return id > 0 ? id / static_cast<int64>(shards_.size()) : id;
+}
+
+void ShardedMetadataAccessObject::ToGlobal(const int shard,
+                                           Artifact* artifact) const {
+  if (artifact->has_id()) {
+    artifact->set_id(ToGlobalId(artifact->id(), shard));
+  }
+}
+
+void ShardedMetadataAccessObject::ToGlobal(const int shard,
+                                           Execution* execution) const {
+  if (execution->has_id()) {
+    execution->set_id(ToGlobalId(execution->id(), shard));
+  }
+}
+
+void ShardedMetadataAccessObject::ToGlobal(const int shard,
+                                           Context* context) const {
+  if (context->has_id()) {
+    context->set_id(ToGlobalId(context->id(), shard));
+  }
+}
+
+void ShardedMetadataAccessObject::ToGlobal(const int shard,
+                                           Event* event) const {
+  if (event->has_artifact_id()) {
+    event->set_artifact_id(ToGlobalId(event->artifact_id(), shard));
+  }
+  if (event->has_execution_id()) {
+    event->set_execution_id(ToGlobalId(event->execution_id(), shard));
+  }
+}
+
+void ShardedMetadataAccessObject::ToGlobal(
+    const int shard, ParentContext* parent_context) const {
+  if (parent_context->has_child_id()) {
+    parent_context->set_child_id(
+        ToGlobalId(parent_context->child_id(), shard));
+  }
+  if (parent_context->has_parent_id()) {
+    parent_context->set_parent_id(
+        ToGlobalId(parent_context->parent_id(), shard));
+  }
+}
+
+template <typename T>
+void ShardedMetadataAccessObject::ToGlobal(const int shard,
+                                           std::vector<T>* messages) const {
+  for (T& message : *messages) {
+    ToGlobal(shard, &message);
+  }
+}
+
+template <typename Node>
+Node ShardedMetadataAccessObject::ToLocal(const Node& node) const {
+  Node local_node = node;
+  if (local_node.has_id()) {
+    local_node.set_id(ToLocalId(node.id()));
+  }
+  return local_node;
+}
+
+int ShardedMetadataAccessObject::ShardForNewNode(const int64 type_id) const {
+  if (placement_shard_.has_value()) {
+    return *placement_shard_;
+  }
+  const int64 num_shards = shards_.size();
+  return static_cast<int>((type_id % num_shards + num_shards) % num_shards);
+}
+
+int ShardedMetadataAccessObject::ShardForNewContext(
+    const Context& context) const {
+  if (placement_shard_.has_value()) {
+    return *placement_shard_;
+  }
+  return ShardOfContextName(context.type_id(), context.name(), shards_.size());
+}
+
+absl::Status ShardedMetadataAccessObject::GetShardOfLink(
+    const int64 id, const int64 other_id, int* shard) const {
+  // A missing id is left for the shard to reject.
+  *shard = ShardOf(id > 0 ? id : other_id);
+  if (id > 0 && other_id > 0 && ShardOf(other_id) != *shard) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Cannot link nodes ", id, " and ", other_id,
+                     ", as they are stored on different shards."));
+  }
+  return absl::OkStatus();
+}
+
+std::vector<std::vector<int64>> ShardedMetadataAccessObject::GroupByShard(
+    const absl::Span<const int64> ids) const {
+  std::vector<std::vector<int64>> local_ids(shards_.size());
+  for (const int64 id : ids) {
+    local_ids[ShardOf(id)].push_back(ToLocalId(id));
+  }
+  return local_ids;
+}
+
+template <typename T>
+absl::Status ShardedMetadataAccessObject::Gather(
+    const std::vector<int>& shards,
+    const std::function<absl::Status(int, std::vector<T>*)>& find,
+    std::vector<T>* results) {
+  if (results == nullptr) {
+    return absl::InvalidArgumentError("Given results is NULL.");
+  }
+  absl::Status not_found_status;
+  int num_not_found = 0;
+  for (const int shard : shards) {
+    std::vector<T> shard_results;
+    const absl::Status status = find(shard, &shard_results);
+    if (absl::IsNotFound(status)) {
+      not_found_status = status;
+      num_not_found++;
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(status);
+    ToGlobal(shard, &shard_results);
+    results->insert(results->end(),
+                    std::make_move_iterator(shard_results.begin()),
+                    std::make_move_iterator(shard_results.end()));
+  }
+  if (!shards.empty() && num_not_found == shards.size()) {
+    return not_found_status;
+  }
+  return absl::OkStatus();
+}
+
+template <typename T>
+absl::Status ShardedMetadataAccessObject::ScatterGather(
+    const std::function<absl::Status(int, std::vector<T>*)>& find,
+    std::vector<T>* results) {
+  std::vector<int> shards(shards_.size());
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    shards[shard] = shard;
+  }
+  return Gather(shards, find, results);
+}
+
+absl::Status ShardedMetadataAccessObject::SumCounts(
+    const std::function<absl::Status(int, int64*)>& count, int64* total) {
+  *total = 0;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    int64 shard_count = 0;
+    MLMD_RETURN_IF_ERROR(count(shard, &shard_count));
+    *total += shard_count;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::AggregateOnShards(
+    const PropertyAggregationOptions& options,
+    const std::function<absl::Status(int, const PropertyAggregationOptions&,
+                                     std::vector<PropertyAggregate>*)>&
+        aggregate,
+    std::vector<PropertyAggregate>* aggregates) {
+  // The nodes of a context are on its shard.
+  if (options.has_context_id()) {
+    PropertyAggregationOptions local_options = options;
+    local_options.set_context_id(ToLocalId(options.context_id()));
+    return aggregate(ShardOf(options.context_id()), local_options, aggregates);
+  }
+  std::map<absl::optional<int>, PropertyAggregate> aggregates_by_state;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    std::vector<PropertyAggregate> shard_aggregates;
+    MLMD_RETURN_IF_ERROR(aggregate(shard, options, &shard_aggregates));
+    for (const PropertyAggregate& shard_aggregate : shard_aggregates) {
+      const absl::optional<int> state =
+          shard_aggregate.has_state()
+              ? absl::make_optional<int>(shard_aggregate.state())
+              : absl::nullopt;
+      const auto it = aggregates_by_state.find(state);
+      if (it == aggregates_by_state.end()) {
+        aggregates_by_state.emplace(state, shard_aggregate);
+      } else {
+        MergePropertyAggregate(shard_aggregate, it->second);
+      }
+    }
+  }
+  for (const auto& state_and_aggregate : aggregates_by_state) {
+    aggregates->push_back(state_and_aggregate.second);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::FindNodesById(
+    const absl::Span<const int64> ids,
+    const std::function<absl::Status(int, absl::Span<const int64>,
+                                     std::vector<Node>*)>& find,
+    std::vector<Node>* nodes) {
+  if (ids.empty()) {
+    return find(0, ids, nodes);
+  }
+  if (nodes == nullptr) {
+    return absl::InvalidArgumentError("Given nodes is NULL.");
+  }
+  absl::Status not_found_status;
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    // The nodes found are returned along with NOT_FOUND.
+    std::vector<Node> shard_nodes;
+    const absl::Status status = find(shard, local_ids[shard], &shard_nodes);
+    if (absl::IsNotFound(status)) {
+      not_found_status = status;
+    } else {
+      MLMD_RETURN_IF_ERROR(status);
+    }
+    ToGlobal(shard, &shard_nodes);
+    nodes->insert(nodes->end(), std::make_move_iterator(shard_nodes.begin()),
+                  std::make_move_iterator(shard_nodes.end()));
+  }
+  return not_found_status;
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::FindNodeOnAnyShard(
+    const std::function<absl::Status(int, Node*)>& find, Node* node) {
+  absl::Status status;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    status = find(shard, node);
+    if (status.ok()) {
+      ToGlobal(shard, node);
+      return absl::OkStatus();
+    }
+    if (!absl::IsNotFound(status)) {
+      return status;
+    }
+  }
+  return status;
+}
+
+template <typename T>
+absl::Status ShardedMetadataAccessObject::CreateOnShards(
+    const absl::Span<const T> messages,
+    const std::function<absl::Status(const T&, int*, T*)>& localize,
+    const std::function<absl::Status(int, absl::Span<const T>,
+                                     std::vector<int64>*)>& create,
+    std::vector<int64>* ids) {
+  if (ids == nullptr) {
+    return absl::InvalidArgumentError("Given ids is NULL.");
+  }
+  std::vector<std::vector<T>> local_messages(shards_.size());
+  // The positions in `messages` of the messages of each shard.
+  std::vector<std::vector<int>> positions(shards_.size());
+  for (int i = 0; i < messages.size(); i++) {
+    int shard;
+    T local_message;
+    MLMD_RETURN_IF_ERROR(localize(messages[i], &shard, &local_message));
+    local_messages[shard].push_back(std::move(local_message));
+    positions[shard].push_back(i);
+  }
+  ids->assign(messages.size(), -1);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_messages[shard].empty()) {
+      continue;
+    }
+    std::vector<int64> local_ids;
+    MLMD_RETURN_IF_ERROR(create(shard, local_messages[shard], &local_ids));
+    for (int i = 0; i < local_ids.size(); i++) {
+      (*ids)[positions[shard][i]] = ToGlobalId(local_ids[i], shard);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::UpdateNodes(
+    const absl::Span<const Node> nodes,
+    const std::function<absl::Status(int, absl::Span<const Node>)>& update) {
+  std::vector<std::vector<Node>> local_nodes(shards_.size());
+  for (const Node& node : nodes) {
+    local_nodes[ShardOf(node.id())].push_back(ToLocal(node));
+  }
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (!local_nodes[shard].empty()) {
+      MLMD_RETURN_IF_ERROR(update(shard, local_nodes[shard]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::StreamNodes(
+    const NodeBatchCallback<Node>& callback,
+    const std::function<absl::Status(int, const NodeBatchCallback<Node>&)>&
+        stream) {
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    MLMD_RETURN_IF_ERROR(stream(
+        shard,
+        [this, shard, &callback](absl::Span<const Node> batch) -> absl::Status {
+          std::vector<Node> nodes(batch.begin(), batch.end());
+          ToGlobal(shard, &nodes);
+          return callback(nodes);
+        }));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::StreamNodesUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Node>& callback,
+    const std::function<absl::Status(int, int64,
+                                     const NodeBatchCallback<Node>&)>& stream) {
+  const int64 num_shards = shards_.size();
+  std::vector<Node> nodes;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    // The largest local id whose global id is not greater than `id`.
+    const int64 local_id = id >= shard ? (id - shard) / num_shards : -1;
+    MLMD_RETURN_IF_ERROR(stream(
+        shard, local_id,
+        [this, shard, &nodes](absl::Span<const Node> batch) -> absl::Status {
+          for (const Node& node : batch) {
+            nodes.push_back(node);
+            ToGlobal(shard, &nodes.back());
+          }
+          return absl::OkStatus();
+        }));
+  }
+  std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) {
+    return a.last_update_time_since_epoch() != b.last_update_time_since_epoch()
+               ? a.last_update_time_since_epoch() <
+                     b.last_update_time_since_epoch()
+               : a.id() < b.id();
+  });
+  const absl::Span<const Node> changes = absl::MakeConstSpan(nodes);
+  for (size_t begin = 0; begin < changes.size();
+       begin += kNodeStreamingBatchSize) {
+    MLMD_RETURN_IF_ERROR(
+        callback(changes.subspan(begin, kNodeStreamingBatchSize)));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status ShardedMetadataAccessObject::FindNodeIdsUpdatedBefore(
+    const int64 limit,
+    const std::function<absl::Status(int, std::vector<int64>*)>& find_ids,
+    const std::function<absl::Status(int, absl::Span<const int64>,
+                                     std::vector<Node>*)>& find,
+    std::vector<int64>* ids) {
+  std::vector<std::pair<int64, int64>> updates;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    std::vector<int64> local_ids;
+    MLMD_RETURN_IF_ERROR(find_ids(shard, &local_ids));
+    if (local_ids.empty()) {
+      continue;
+    }
+    std::vector<Node> nodes;
+    MLMD_RETURN_IF_ERROR(find(shard, local_ids, &nodes));
+    for (const Node& node : nodes) {
+      updates.push_back({node.last_update_time_since_epoch(),
+                         ToGlobalId(node.id(), shard)});
+    }
+  }
+  std::sort(updates.begin(), updates.end());
+  if (updates.size() > limit) {
+    updates.resize(limit);
+  }
+  ids->clear();
+  for (const std::pair<int64, int64>& update : updates) {
+    ids->push_back(update.second);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status ShardedMetadataAccessObject::CreateTypeOnShards(const Type& type,
+                                                             int64* type_id) {
+  // The other shards are given the id assigned by shard 0, rather than relying
+  // on their auto-increments, which drift after a failed insert or on a shard
+  // bootstrapped separately.
+  MLMD_RETURN_IF_ERROR(shards_[0]->CreateType(type, type_id));
+  for (int shard = 1; shard < shards_.size(); shard++) {
+    const absl::Status status =
+        shards_[shard]->CreateTypeWithId(type, *type_id);
+    if (!status.ok()) {
+      return absl::InternalError(absl::StrCat(
+          "The type created with id ", *type_id,
+          " on shard 0 cannot be created with the same id on shard ", shard,
+          ": ", status.ToString(), " ", type.DebugString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::WriteOnShards(
+    const std::function<absl::Status(int)>& write) {
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    MLMD_RETURN_IF_ERROR(write(shard));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::InitMetadataSource() {
+  return WriteOnShards([this](int shard) {
+    return shards_[shard]->InitMetadataSource();
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::InitMetadataSourceIfNotExists(
+    const bool enable_upgrade_migration) {
+  return WriteOnShards([this, enable_upgrade_migration](int shard) {
+    return shards_[shard]->InitMetadataSourceIfNotExists(
+        enable_upgrade_migration);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::DowngradeMetadataSource(
+    const int64 to_schema_version) {
+  return WriteOnShards([this, to_schema_version](int shard) {
+    return shards_[shard]->DowngradeMetadataSource(to_schema_version);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::MigrateSchemaStep(
+    const int64 to_schema_version, const int64 max_num_chunks,
+    SchemaMigrationProgress* progress) {
+  // Each shard runs a step of its own migration, and the progress is the one
+  // of the first shard whose migration is not done.
+  progress->Clear();
+  progress->set_done(true);
+  return WriteOnShards([&](int shard) -> absl::Status {
+    SchemaMigrationProgress shard_progress;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->MigrateSchemaStep(
+        to_schema_version, max_num_chunks, &shard_progress));
+    if (progress->done()) *progress = shard_progress;
+    return absl::OkStatus();
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::DropSecondaryIndices() {
+  return WriteOnShards(
+      [this](int shard) { return shards_[shard]->DropSecondaryIndices(); });
+}
+
+absl::Status ShardedMetadataAccessObject::CreateSecondaryIndices() {
+  return WriteOnShards(
+      [this](int shard) { return shards_[shard]->CreateSecondaryIndices(); });
+}
+
+absl::Status ShardedMetadataAccessObject::MaintainEventPartitions(
+    const EventPartitionOptions& options, const int64 now_milliseconds,
+    const bool enable_migration) {
+  return WriteOnShards([&](int shard) {
+    return shards_[shard]->MaintainEventPartitions(options, now_milliseconds,
+                                                   enable_migration);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::InlineEventPaths(
+    const bool enable_migration, const int64 max_num_events,
+    int64* num_moved_events) {
+  *num_moved_events = 0;
+  return WriteOnShards([&](int shard) -> absl::Status {
+    int64 num_shard_moved_events;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->InlineEventPaths(
+        enable_migration, max_num_events, &num_shard_moved_events));
+    *num_moved_events += num_shard_moved_events;
+    return absl::OkStatus();
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::InlineNodeProperties(
+    const bool enable_migration, const int64 max_num_nodes,
+    int64* num_filled_nodes) {
+  *num_filled_nodes = 0;
+  return WriteOnShards([&](int shard) -> absl::Status {
+    int64 num_shard_filled_nodes;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->InlineNodeProperties(
+        enable_migration, max_num_nodes, &num_shard_filled_nodes));
+    *num_filled_nodes += num_shard_filled_nodes;
+    return absl::OkStatus();
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::MaintainNodePropertiesBytes() {
+  return WriteOnShards([this](int shard) {
+    return shards_[shard]->MaintainNodePropertiesBytes();
+  });
+}
+
+void ShardedMetadataAccessObject::SetPinnedRead(const bool pinned_read) {
+  for (const std::unique_ptr<MetadataAccessObject>& shard : shards_) {
+    shard->SetPinnedRead(pinned_read);
+  }
+}
+
+absl::Status ShardedMetadataAccessObject::CreateIdempotencyKeyTable() {
+  return shards_[0]->CreateIdempotencyKeyTable();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateType(const ArtifactType& type,
+                                                     int64* type_id) {
+  return CreateTypeOnShards(type, type_id);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateType(const ExecutionType& type,
+                                                     int64* type_id) {
+  return CreateTypeOnShards(type, type_id);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateType(const ContextType& type,
+                                                     int64* type_id) {
+  return CreateTypeOnShards(type, type_id);
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateType(
+    const ArtifactType& type) {
+  return WriteOnShards(
+      [this, &type](int shard) { return shards_[shard]->UpdateType(type); });
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateType(
+    const ExecutionType& type) {
+  return WriteOnShards(
+      [this, &type](int shard) { return shards_[shard]->UpdateType(type); });
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateType(const ContextType& type) {
+  return WriteOnShards(
+      [this, &type](int shard) { return shards_[shard]->UpdateType(type); });
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeById(
+    const int64 type_id, ArtifactType* artifact_type) {
+  return shards_[0]->FindTypeById(type_id, artifact_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeById(
+    const int64 type_id, ExecutionType* execution_type) {
+  return shards_[0]->FindTypeById(type_id, execution_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeById(
+    const int64 type_id, ContextType* context_type) {
+  return shards_[0]->FindTypeById(type_id, context_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeByNameAndVersion(
+    const absl::string_view name,
+    const absl::optional<absl::string_view> version,
+    ArtifactType* artifact_type) {
+  return shards_[0]->FindTypeByNameAndVersion(name, version, artifact_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeByNameAndVersion(
+    const absl::string_view name,
+    const absl::optional<absl::string_view> version,
+    ExecutionType* execution_type) {
+  return shards_[0]->FindTypeByNameAndVersion(name, version, execution_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypeByNameAndVersion(
+    const absl::string_view name,
+    const absl::optional<absl::string_view> version,
+    ContextType* context_type) {
+  return shards_[0]->FindTypeByNameAndVersion(name, version, context_type);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ArtifactType>* artifact_types) {
+  return shards_[0]->FindTypesByNamesAndVersions(names_and_versions,
+                                                 artifact_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ExecutionType>* execution_types) {
+  return shards_[0]->FindTypesByNamesAndVersions(names_and_versions,
+                                                 execution_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypesByNamesAndVersions(
+    const absl::Span<const std::pair<std::string, std::string>>
+        names_and_versions,
+    std::vector<ContextType>* context_types) {
+  return shards_[0]->FindTypesByNamesAndVersions(names_and_versions,
+                                                 context_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypes(
+    std::vector<ArtifactType>* artifact_types) {
+  return shards_[0]->FindTypes(artifact_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypes(
+    std::vector<ExecutionType>* execution_types) {
+  return shards_[0]->FindTypes(execution_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindTypes(
+    std::vector<ContextType>* context_types) {
+  return shards_[0]->FindTypes(context_types);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ArtifactType& type, const ArtifactType& parent_type) {
+  return WriteOnShards([this, &type, &parent_type](int shard) {
+    return shards_[shard]->CreateParentTypeInheritanceLink(type, parent_type);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ExecutionType& type, const ExecutionType& parent_type) {
+  return WriteOnShards([this, &type, &parent_type](int shard) {
+    return shards_[shard]->CreateParentTypeInheritanceLink(type, parent_type);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ContextType& type, const ContextType& parent_type) {
+  return WriteOnShards([this, &type, &parent_type](int shard) {
+    return shards_[shard]->CreateParentTypeInheritanceLink(type, parent_type);
+  });
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ArtifactType>& output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeId(type_id, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ExecutionType>& output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeId(type_id, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeId(
+    const int64 type_id, std::vector<ContextType>& output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeId(type_id, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+        output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeIds(type_ids, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+        output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeIds(type_ids, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentTypesByTypeIds(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, std::vector<ContextType>>& output_parent_types) {
+  return shards_[0]->FindParentTypesByTypeIds(type_ids, output_parent_types);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateArtifact(
+    const Artifact& artifact, int64* artifact_id) {
+  const int shard = ShardForNewNode(artifact.type_id());
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(
+      shards_[shard]->CreateArtifact(ToLocal(artifact), &local_id));
+  *artifact_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts,
+    std::vector<int64>* artifact_ids) {
+  return CreateOnShards<Artifact>(
+      artifacts,
+      [this](const Artifact& artifact, int* shard, Artifact* local_artifact) {
+        *shard = ShardForNewNode(artifact.type_id());
+        *local_artifact = ToLocal(artifact);
+        return absl::OkStatus();
+      },
+      [this](int shard, absl::Span<const Artifact> local_artifacts,
+             std::vector<int64>* local_ids) {
+        return shards_[shard]->CreateArtifacts(local_artifacts, local_ids);
+      },
+      artifact_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<Artifact>* artifacts) {
+  return FindArtifactsById(artifact_ids, PropertyOptions::default_instance(),
+                           artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts) {
+  return FindNodesById<Artifact>(
+      artifact_ids,
+      [this, &property_options](int shard, absl::Span<const int64> local_ids,
+                                std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsById(local_ids, property_options,
+                                                 shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifacts(
+    std::vector<Artifact>* artifacts) {
+  return ScatterGather<Artifact>(
+      [this](int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifacts(shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifacts(
+    const NodeBatchCallback<Artifact>& callback) {
+  return FindArtifacts(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifacts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Artifact>& callback) {
+  return StreamNodes<Artifact>(
+      callback,
+      [this, &property_options](
+          int shard, const NodeBatchCallback<Artifact>& shard_callback) {
+        return shards_[shard]->FindArtifacts(property_options, shard_callback);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Artifact>& callback) {
+  return StreamNodesUpdatedAfter<Artifact>(
+      last_update_time_since_epoch, id, callback,
+      [this, last_update_time_since_epoch](
+          int shard, int64 local_id,
+          const NodeBatchCallback<Artifact>& shard_callback) {
+        return shards_[shard]->FindArtifactsUpdatedAfter(
+            last_update_time_since_epoch, local_id, shard_callback);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing artifacts by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing artifacts by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options, std::vector<Execution>* executions,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing executions by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Execution>* executions,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing executions by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing contexts by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  return absl::UnimplementedError(
+      "Listing contexts by page is not supported across shards.");
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
+    const int64 artifact_type_id, const absl::string_view name,
+    Artifact* artifact) {
+  return FindNodeOnAnyShard<Artifact>(
+      [this, artifact_type_id, name](int shard, Artifact* shard_artifact) {
+        return shards_[shard]->FindArtifactByTypeIdAndArtifactName(
+            artifact_type_id, name, shard_artifact);
+      },
+      artifact);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByTypeIdAndArtifactNames(
+    const int64 artifact_type_id, const absl::Span<const std::string> names,
+    std::vector<Artifact>* artifacts) {
+  return ScatterGather<Artifact>(
+      [this, artifact_type_id, names](int shard,
+                                  std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByTypeIdAndArtifactNames(
+            artifact_type_id, names, shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 artifact_type_id, std::vector<Artifact>* artifacts) {
+  return FindArtifactsByTypeId(artifact_type_id,
+                               PropertyOptions::default_instance(), artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 artifact_type_id, const PropertyOptions& property_options,
+    std::vector<Artifact>* artifacts) {
+  return ScatterGather<Artifact>(
+      [this, artifact_type_id, &property_options](
+          int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByTypeId(
+            artifact_type_id, property_options, shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByURI(
+    const absl::string_view uri, std::vector<Artifact>* artifacts) {
+  return ScatterGather<Artifact>(
+      [this, uri](int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByURI(uri, shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByURIPrefix(
+    const absl::string_view uri_prefix, std::vector<Artifact>* artifacts) {
+  return ScatterGather<Artifact>(
+      [this, uri_prefix](int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByURIPrefix(uri_prefix,
+                                                        shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::CountArtifacts(
+    const absl::optional<int64> artifact_type_id,
+    const absl::optional<Artifact::State> state, int64* count) {
+  return SumCounts(
+      [this, artifact_type_id, state](int shard, int64* shard_count) {
+        return shards_[shard]->CountArtifacts(artifact_type_id, state,
+                                              shard_count);
+      },
+      count);
+}
+
+absl::Status ShardedMetadataAccessObject::AggregateArtifactProperty(
+    const int64 artifact_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  return AggregateOnShards(
+      options,
+      [this, artifact_type_id](
+          int shard, const PropertyAggregationOptions& shard_options,
+          std::vector<PropertyAggregate>* shard_aggregates) {
+        return shards_[shard]->AggregateArtifactProperty(
+            artifact_type_id, shard_options, shard_aggregates);
+      },
+      aggregates);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExistingArtifactIds(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<int64>* existing_artifact_ids) {
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(artifact_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    std::vector<int64> shard_ids;
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->FindExistingArtifactIds(local_ids[shard], &shard_ids));
+    for (const int64 local_id : shard_ids) {
+      existing_artifact_ids->push_back(ToGlobalId(local_id, shard));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactIdsByTypeId(
+    const int64 artifact_type_id, std::vector<int64>* artifact_ids) {
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    std::vector<int64> shard_ids;
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->FindArtifactIdsByTypeId(artifact_type_id, &shard_ids));
+    for (const int64 local_id : shard_ids) {
+      artifact_ids->push_back(ToGlobalId(local_id, shard));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateArtifact(
+    const Artifact& artifact) {
+  return shards_[ShardOf(artifact.id())]->UpdateArtifact(ToLocal(artifact));
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateArtifacts(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodes<Artifact>(
+      artifacts,
+      [this](int shard, absl::Span<const Artifact> local_artifacts) {
+        return shards_[shard]->UpdateArtifacts(local_artifacts);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateArtifactsIfUnchanged(
+    const absl::Span<const Artifact> artifacts) {
+  return UpdateNodes<Artifact>(
+      artifacts,
+      [this](int shard, absl::Span<const Artifact> local_artifacts) {
+        return shards_[shard]->UpdateArtifactsIfUnchanged(local_artifacts);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::DeleteArtifactsById(
+    const absl::Span<const int64> artifact_ids) {
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(artifact_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(shards_[shard]->DeleteArtifactsById(local_ids[shard]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactIdsUpdatedBefore(
+    const int64 artifact_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* artifact_ids) {
+  PropertyOptions property_options;
+  property_options.set_skip_properties(true);
+  return FindNodeIdsUpdatedBefore<Artifact>(
+      limit,
+      [&](int shard, std::vector<int64>* local_ids) {
+        return shards_[shard]->FindArtifactIdsUpdatedBefore(
+            artifact_type_id, last_update_time_since_epoch, limit, local_ids);
+      },
+      [&](int shard, absl::Span<const int64> local_ids,
+          std::vector<Artifact>* nodes) {
+        return shards_[shard]->FindArtifactsById(local_ids, property_options,
+                                                 nodes);
+      },
+      artifact_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateExecution(
+    const Execution& execution, int64* execution_id) {
+  const int shard = ShardForNewNode(execution.type_id());
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(
+      shards_[shard]->CreateExecution(ToLocal(execution), &local_id));
+  *execution_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* execution_ids) {
+  return CreateOnShards<Execution>(
+      executions,
+      [this](const Execution& execution, int* shard,
+             Execution* local_execution) {
+        *shard = ShardForNewNode(execution.type_id());
+        *local_execution = ToLocal(execution);
+        return absl::OkStatus();
+      },
+      [this](int shard, absl::Span<const Execution> local_executions,
+             std::vector<int64>* local_ids) {
+        return shards_[shard]->CreateExecutions(local_executions, local_ids);
+      },
+      execution_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Execution>* executions) {
+  return FindExecutionsById(execution_ids, PropertyOptions::default_instance(),
+                            executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    const PropertyOptions& property_options,
+    std::vector<Execution>* executions) {
+  return FindNodesById<Execution>(
+      execution_ids,
+      [this, &property_options](int shard, absl::Span<const int64> local_ids,
+                                std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutionsById(local_ids, property_options,
+                                                  shard_executions);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutions(
+    std::vector<Execution>* executions) {
+  return ScatterGather<Execution>(
+      [this](int shard, std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutions(shard_executions);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutions(
+    const NodeBatchCallback<Execution>& callback) {
+  return FindExecutions(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutions(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Execution>& callback) {
+  return StreamNodes<Execution>(
+      callback,
+      [this, &property_options](
+          int shard, const NodeBatchCallback<Execution>& shard_callback) {
+        return shards_[shard]->FindExecutions(property_options, shard_callback);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Execution>& callback) {
+  return StreamNodesUpdatedAfter<Execution>(
+      last_update_time_since_epoch, id, callback,
+      [this, last_update_time_since_epoch](
+          int shard, int64 local_id,
+          const NodeBatchCallback<Execution>& shard_callback) {
+        return shards_[shard]->FindExecutionsUpdatedAfter(
+            last_update_time_since_epoch, local_id, shard_callback);
+      });
+}
+
+absl::Status
+ShardedMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
+    const int64 execution_type_id, const absl::string_view name,
+    Execution* execution) {
+  return FindNodeOnAnyShard<Execution>(
+      [this, execution_type_id, name](int shard, Execution* shard_execution) {
+        return shards_[shard]->FindExecutionByTypeIdAndExecutionName(
+            execution_type_id, name, shard_execution);
+      },
+      execution);
+}
+
+absl::Status
+ShardedMetadataAccessObject::FindExecutionsByTypeIdAndExecutionNames(
+    const int64 execution_type_id, const absl::Span<const std::string> names,
+    std::vector<Execution>* executions) {
+  return ScatterGather<Execution>(
+      [this, execution_type_id, names](int shard,
+                                  std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutionsByTypeIdAndExecutionNames(
+            execution_type_id, names, shard_executions);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 execution_type_id, std::vector<Execution>* executions) {
+  return FindExecutionsByTypeId(execution_type_id,
+                                PropertyOptions::default_instance(),
+                                executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 execution_type_id, const PropertyOptions& property_options,
+    std::vector<Execution>* executions) {
+  return ScatterGather<Execution>(
+      [this, execution_type_id, &property_options](
+          int shard, std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutionsByTypeId(
+            execution_type_id, property_options, shard_executions);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::CountExecutions(
+    const absl::optional<int64> execution_type_id,
+    const absl::optional<Execution::State> last_known_state, int64* count) {
+  return SumCounts(
+      [this, execution_type_id, last_known_state](int shard,
+                                                  int64* shard_count) {
+        return shards_[shard]->CountExecutions(
+            execution_type_id, last_known_state, shard_count);
+      },
+      count);
+}
+
+absl::Status ShardedMetadataAccessObject::AggregateExecutionProperty(
+    const int64 execution_type_id, const PropertyAggregationOptions& options,
+    std::vector<PropertyAggregate>* aggregates) {
+  return AggregateOnShards(
+      options,
+      [this, execution_type_id](
+          int shard, const PropertyAggregationOptions& shard_options,
+          std::vector<PropertyAggregate>* shard_aggregates) {
+        return shards_[shard]->AggregateExecutionProperty(
+            execution_type_id, shard_options, shard_aggregates);
+      },
+      aggregates);
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateExecution(
+    const Execution& execution) {
+  return shards_[ShardOf(execution.id())]->UpdateExecution(
+      ToLocal(execution));
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateExecutions(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodes<Execution>(
+      executions,
+      [this](int shard, absl::Span<const Execution> local_executions) {
+        return shards_[shard]->UpdateExecutions(local_executions);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateExecutionsIfUnchanged(
+    const absl::Span<const Execution> executions) {
+  return UpdateNodes<Execution>(
+      executions,
+      [this](int shard, absl::Span<const Execution> local_executions) {
+        return shards_[shard]->UpdateExecutionsIfUnchanged(local_executions);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::DeleteExecutionsById(
+    const absl::Span<const int64> execution_ids) {
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(execution_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->DeleteExecutionsById(local_ids[shard]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionIdsUpdatedBefore(
+    const int64 execution_type_id, const int64 last_update_time_since_epoch,
+    const int64 limit, std::vector<int64>* execution_ids) {
+  PropertyOptions property_options;
+  property_options.set_skip_properties(true);
+  return FindNodeIdsUpdatedBefore<Execution>(
+      limit,
+      [&](int shard, std::vector<int64>* local_ids) {
+        return shards_[shard]->FindExecutionIdsUpdatedBefore(
+            execution_type_id, last_update_time_since_epoch, limit, local_ids);
+      },
+      [&](int shard, absl::Span<const int64> local_ids,
+          std::vector<Execution>* nodes) {
+        return shards_[shard]->FindExecutionsById(local_ids,
+                                                  property_options, nodes);
+      },
+      execution_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateContext(
+    const Context& context, int64* context_id) {
+  const int shard = ShardForNewContext(context);
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(
+      shards_[shard]->CreateContext(ToLocal(context), &local_id));
+  *context_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateContextIfNotExist(
+    const Context& context, int64* context_id, bool* created) {
+  // Without a placement shard, a context name maps to a single shard, whose
+  // insert is atomic. Otherwise the context may exist on another shard.
+  if (placement_shard_.has_value()) {
+    Context existing_context;
+    const absl::Status status = FindContextByTypeIdAndContextName(
+        context.type_id(), context.name(), &existing_context);
+    if (status.ok()) {
+      *context_id = existing_context.id();
+      *created = false;
+      return absl::OkStatus();
+    }
+    if (!absl::IsNotFound(status)) return status;
+  }
+  const int shard = ShardForNewContext(context);
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(shards_[shard]->CreateContextIfNotExist(
+      ToLocal(context), &local_id, created));
+  *context_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts,
+    std::vector<int64>* context_ids) {
+  return CreateOnShards<Context>(
+      contexts,
+      [this](const Context& context, int* shard, Context* local_context) {
+        *shard = ShardForNewContext(context);
+        *local_context = ToLocal(context);
+        return absl::OkStatus();
+      },
+      [this](int shard, absl::Span<const Context> local_contexts,
+             std::vector<int64>* local_ids) {
+        return shards_[shard]->CreateContexts(local_contexts, local_ids);
+      },
+      context_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids, std::vector<Context>* contexts) {
+  return FindContextsById(context_ids, PropertyOptions::default_instance(),
+                          contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids,
+    const PropertyOptions& property_options, std::vector<Context>* contexts) {
+  return FindNodesById<Context>(
+      context_ids,
+      [this, &property_options](int shard, absl::Span<const int64> local_ids,
+                                std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContextsById(local_ids, property_options,
+                                                shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContexts(
+    std::vector<Context>* contexts) {
+  return ScatterGather<Context>(
+      [this](int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContexts(shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContexts(
+    const NodeBatchCallback<Context>& callback) {
+  return FindContexts(PropertyOptions::default_instance(), callback);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContexts(
+    const PropertyOptions& property_options,
+    const NodeBatchCallback<Context>& callback) {
+  return StreamNodes<Context>(
+      callback,
+      [this, &property_options](
+          int shard, const NodeBatchCallback<Context>& shard_callback) {
+        return shards_[shard]->FindContexts(property_options, shard_callback);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsUpdatedAfter(
+    const int64 last_update_time_since_epoch, const int64 id,
+    const NodeBatchCallback<Context>& callback) {
+  return StreamNodesUpdatedAfter<Context>(
+      last_update_time_since_epoch, id, callback,
+      [this, last_update_time_since_epoch](
+          int shard, int64 local_id,
+          const NodeBatchCallback<Context>& shard_callback) {
+        return shards_[shard]->FindContextsUpdatedAfter(
+            last_update_time_since_epoch, local_id, shard_callback);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id,
+    const absl::optional<ListOperationOptions> list_options,
+    std::vector<Context>* contexts, std::string* next_page_token) {
+  return FindContextsByTypeId(type_id, list_options,
+                              PropertyOptions::default_instance(), contexts,
+                              next_page_token);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id,
+    const absl::optional<ListOperationOptions> list_options,
+    const PropertyOptions& property_options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  if (list_options.has_value()) {
+    return absl::UnimplementedError(
+        "Listing contexts by page is not supported across shards.");
+  }
+  return ScatterGather<Context>(
+      [this, type_id, &property_options](int shard,
+                                         std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContextsByTypeId(
+            type_id, /*list_options=*/absl::nullopt, property_options,
+            shard_contexts, /*next_page_token=*/nullptr);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::CountContexts(
+    const absl::optional<int64> context_type_id, int64* count) {
+  return SumCounts(
+      [this, context_type_id](int shard, int64* shard_count) {
+        return shards_[shard]->CountContexts(context_type_id, shard_count);
+      },
+      count);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextByTypeIdAndContextName(
+    const int64 type_id, const absl::string_view name, Context* context) {
+  return FindNodeOnAnyShard<Context>(
+      [this, type_id, name](int shard, Context* shard_context) {
+        return shards_[shard]->FindContextByTypeIdAndContextName(
+            type_id, name, shard_context);
+      },
+      context);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByTypeIdAndContextNames(
+    const int64 context_type_id, const absl::Span<const std::string> names,
+    std::vector<Context>* contexts) {
+  return ScatterGather<Context>(
+      [this, context_type_id, names](int shard,
+                                  std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContextsByTypeIdAndContextNames(
+            context_type_id, names, shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateContext(
+    const Context& context) {
+  return shards_[ShardOf(context.id())]->UpdateContext(ToLocal(context));
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateContexts(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodes<Context>(
+      contexts, [this](int shard, absl::Span<const Context> local_contexts) {
+        return shards_[shard]->UpdateContexts(local_contexts);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::UpdateContextsIfUnchanged(
+    const absl::Span<const Context> contexts) {
+  return UpdateNodes<Context>(
+      contexts, [this](int shard, absl::Span<const Context> local_contexts) {
+        return shards_[shard]->UpdateContextsIfUnchanged(local_contexts);
+      });
+}
+
+absl::Status ShardedMetadataAccessObject::CreateEvent(const Event& event,
+                                                      int64* event_id) {
+  std::vector<int64> event_ids;
+  MLMD_RETURN_IF_ERROR(CreateEvents({event}, &event_ids));
+  *event_id = event_ids[0];
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  return CreateOnShards<Event>(
+      events,
+      [this](const Event& event, int* shard, Event* local_event) {
+        MLMD_RETURN_IF_ERROR(
+            GetShardOfLink(event.execution_id(), event.artifact_id(), shard));
+        *local_event = event;
+        if (event.has_artifact_id()) {
+          local_event->set_artifact_id(ToLocalId(event.artifact_id()));
+        }
+        if (event.has_execution_id()) {
+          local_event->set_execution_id(ToLocalId(event.execution_id()));
+        }
+        return absl::OkStatus();
+      },
+      [this](int shard, absl::Span<const Event> local_events,
+             std::vector<int64>* local_ids) {
+        return shards_[shard]->CreateEvents(local_events, local_ids);
+      },
+      event_ids);
+}
+
+absl::Status ShardedMetadataAccessObject::FindEventsByArtifacts(
+    const std::vector<int64>& artifact_ids, absl::Span<const Event::Type> types,
+    std::vector<Event>* events) {
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(artifact_ids);
+  std::vector<int> shards;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (!local_ids[shard].empty()) shards.push_back(shard);
+  }
+  if (shards.empty()) {
+    return shards_[0]->FindEventsByArtifacts(artifact_ids, types, events);
+  }
+  return Gather<Event>(
+      shards,
+      [this, &local_ids, types](int shard, std::vector<Event>* shard_events) {
+        return shards_[shard]->FindEventsByArtifacts(local_ids[shard], types,
+                                                     shard_events);
+      },
+      events);
+}
+
+absl::Status ShardedMetadataAccessObject::FindEventsByExecutions(
+    const std::vector<int64>& execution_ids,
+    absl::Span<const Event::Type> types, std::vector<Event>* events) {
+  const std::vector<std::vector<int64>> local_ids =
+      GroupByShard(execution_ids);
+  std::vector<int> shards;
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (!local_ids[shard].empty()) shards.push_back(shard);
+  }
+  if (shards.empty()) {
+    return shards_[0]->FindEventsByExecutions(execution_ids, types, events);
+  }
+  return Gather<Event>(
+      shards,
+      [this, &local_ids, types](int shard, std::vector<Event>* shard_events) {
+        return shards_[shard]->FindEventsByExecutions(local_ids[shard], types,
+                                                      shard_events);
+      },
+      events);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateAssociation(
+    const Association& association, int64* association_id) {
+  int shard;
+  MLMD_RETURN_IF_ERROR(GetShardOfLink(association.context_id(),
+                                      association.execution_id(), &shard));
+  Association local_association = association;
+  local_association.set_context_id(ToLocalId(association.context_id()));
+  local_association.set_execution_id(ToLocalId(association.execution_id()));
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(
+      shards_[shard]->CreateAssociation(local_association, &local_id));
+  *association_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateAssociations(
+    const absl::Span<const Association> associations) {
+  std::vector<std::vector<Association>> local_associations(shards_.size());
+  for (const Association& association : associations) {
+    int shard;
+    MLMD_RETURN_IF_ERROR(GetShardOfLink(association.context_id(),
+                                        association.execution_id(), &shard));
+    local_associations[shard].push_back(association);
+    Association& local_association = local_associations[shard].back();
+    local_association.set_context_id(ToLocalId(association.context_id()));
+    local_association.set_execution_id(ToLocalId(association.execution_id()));
+  }
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_associations[shard].empty()) continue;
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->CreateAssociations(local_associations[shard]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByExecution(
+    const int64 execution_id, std::vector<Context>* contexts) {
+  return Gather<Context>(
+      {ShardOf(execution_id)},
+      [this, execution_id](int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContextsByExecution(ToLocalId(execution_id),
+                                                       shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution) {
+  if (contexts_by_execution == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_execution is NULL.");
+  }
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(execution_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    absl::flat_hash_map<int64, std::vector<Context>> shard_contexts;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->FindContextsByExecutions(
+        local_ids[shard], &shard_contexts));
+    for (auto& execution_and_contexts : shard_contexts) {
+      ToGlobal(shard, &execution_and_contexts.second);
+      (*contexts_by_execution)[ToGlobalId(execution_and_contexts.first,
+                                          shard)] =
+          std::move(execution_and_contexts.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, std::vector<Execution>* executions) {
+  return Gather<Execution>(
+      {ShardOf(context_id)},
+      [this, context_id](int shard, std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutionsByContext(ToLocalId(context_id),
+                                                       shard_executions);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id,
+    const absl::optional<ListOperationOptions> list_options,
+    std::vector<Execution>* executions, std::string* next_page_token) {
+  // The pages of a context are on its shard, so the page token is local.
+  return Gather<Execution>(
+      {ShardOf(context_id)},
+      [this, context_id, &list_options, next_page_token](
+          int shard, std::vector<Execution>* shard_executions) {
+        return shards_[shard]->FindExecutionsByContext(
+            ToLocalId(context_id), list_options, shard_executions,
+            next_page_token);
+      },
+      executions);
+}
+
+absl::Status ShardedMetadataAccessObject::FindExecutionsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Execution>>*
+        executions_by_context) {
+  if (executions_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given executions_by_context is NULL.");
+  }
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(context_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    absl::flat_hash_map<int64, std::vector<Execution>> shard_executions;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->FindExecutionsByContexts(
+        local_ids[shard], &shard_executions));
+    for (auto& context_and_executions : shard_executions) {
+      ToGlobal(shard, &context_and_executions.second);
+      (*executions_by_context)[ToGlobalId(context_and_executions.first,
+                                          shard)] =
+          std::move(context_and_executions.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateAttribution(
+    const Attribution& attribution, int64* attribution_id) {
+  int shard;
+  MLMD_RETURN_IF_ERROR(GetShardOfLink(attribution.context_id(),
+                                      attribution.artifact_id(), &shard));
+  Attribution local_attribution = attribution;
+  local_attribution.set_context_id(ToLocalId(attribution.context_id()));
+  local_attribution.set_artifact_id(ToLocalId(attribution.artifact_id()));
+  int64 local_id;
+  MLMD_RETURN_IF_ERROR(
+      shards_[shard]->CreateAttribution(local_attribution, &local_id));
+  *attribution_id = ToGlobalId(local_id, shard);
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateAttributions(
+    const absl::Span<const Attribution> attributions) {
+  std::vector<std::vector<Attribution>> local_attributions(shards_.size());
+  for (const Attribution& attribution : attributions) {
+    int shard;
+    MLMD_RETURN_IF_ERROR(GetShardOfLink(attribution.context_id(),
+                                        attribution.artifact_id(), &shard));
+    local_attributions[shard].push_back(attribution);
+    Attribution& local_attribution = local_attributions[shard].back();
+    local_attribution.set_context_id(ToLocalId(attribution.context_id()));
+    local_attribution.set_artifact_id(ToLocalId(attribution.artifact_id()));
+  }
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_attributions[shard].empty()) continue;
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->CreateAttributions(local_attributions[shard]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByArtifact(
+    const int64 artifact_id, std::vector<Context>* contexts) {
+  return Gather<Context>(
+      {ShardOf(artifact_id)},
+      [this, artifact_id](int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindContextsByArtifact(ToLocalId(artifact_id),
+                                                      shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindContextsByArtifacts(
+    const absl::Span<const int64> artifact_ids,
+    absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact) {
+  if (contexts_by_artifact == nullptr) {
+    return absl::InvalidArgumentError("Given contexts_by_artifact is NULL.");
+  }
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(artifact_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    absl::flat_hash_map<int64, std::vector<Context>> shard_contexts;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->FindContextsByArtifacts(
+        local_ids[shard], &shard_contexts));
+    for (auto& artifact_and_contexts : shard_contexts) {
+      ToGlobal(shard, &artifact_and_contexts.second);
+      (*contexts_by_artifact)[ToGlobalId(artifact_and_contexts.first, shard)] =
+          std::move(artifact_and_contexts.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, std::vector<Artifact>* artifacts) {
+  return Gather<Artifact>(
+      {ShardOf(context_id)},
+      [this, context_id](int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByContext(ToLocalId(context_id),
+                                                      shard_artifacts);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id,
+    const absl::optional<ListOperationOptions> list_options,
+    std::vector<Artifact>* artifacts, std::string* next_page_token) {
+  return Gather<Artifact>(
+      {ShardOf(context_id)},
+      [this, context_id, &list_options, next_page_token](
+          int shard, std::vector<Artifact>* shard_artifacts) {
+        return shards_[shard]->FindArtifactsByContext(
+            ToLocalId(context_id), list_options, shard_artifacts,
+            next_page_token);
+      },
+      artifacts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindArtifactsByContexts(
+    const absl::Span<const int64> context_ids,
+    absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context) {
+  if (artifacts_by_context == nullptr) {
+    return absl::InvalidArgumentError("Given artifacts_by_context is NULL.");
+  }
+  const std::vector<std::vector<int64>> local_ids = GroupByShard(context_ids);
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_ids[shard].empty()) {
+      continue;
+    }
+    absl::flat_hash_map<int64, std::vector<Artifact>> shard_artifacts;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->FindArtifactsByContexts(
+        local_ids[shard], &shard_artifacts));
+    for (auto& context_and_artifacts : shard_artifacts) {
+      ToGlobal(shard, &context_and_artifacts.second);
+      (*artifacts_by_context)[ToGlobalId(context_and_artifacts.first,
+                                         shard)] =
+          std::move(context_and_artifacts.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::CreateParentContext(
+    const ParentContext& parent_context) {
+  int shard;
+  MLMD_RETURN_IF_ERROR(GetShardOfLink(parent_context.child_id(),
+                                      parent_context.parent_id(), &shard));
+  ParentContext local_parent_context = parent_context;
+  local_parent_context.set_child_id(ToLocalId(parent_context.child_id()));
+  local_parent_context.set_parent_id(ToLocalId(parent_context.parent_id()));
+  return shards_[shard]->CreateParentContext(local_parent_context);
+}
+
+absl::Status ShardedMetadataAccessObject::CreateParentContexts(
+    const absl::Span<const ParentContext> parent_contexts) {
+  std::vector<std::vector<ParentContext>> local_parent_contexts(
+      shards_.size());
+  for (const ParentContext& parent_context : parent_contexts) {
+    int shard;
+    MLMD_RETURN_IF_ERROR(GetShardOfLink(parent_context.child_id(),
+                                        parent_context.parent_id(), &shard));
+    local_parent_contexts[shard].push_back(parent_context);
+    ParentContext& local_parent_context = local_parent_contexts[shard].back();
+    local_parent_context.set_child_id(ToLocalId(parent_context.child_id()));
+    local_parent_context.set_parent_id(ToLocalId(parent_context.parent_id()));
+  }
+  for (int shard = 0; shard < shards_.size(); shard++) {
+    if (local_parent_contexts[shard].empty()) continue;
+    MLMD_RETURN_IF_ERROR(
+        shards_[shard]->CreateParentContexts(local_parent_contexts[shard]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindParentContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  return Gather<Context>(
+      {ShardOf(context_id)},
+      [this, context_id](int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindParentContextsByContextId(
+            ToLocalId(context_id), shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindChildContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  return Gather<Context>(
+      {ShardOf(context_id)},
+      [this, context_id](int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindChildContextsByContextId(
+            ToLocalId(context_id), shard_contexts);
+      },
+      contexts);
+}
+
+absl::Status ShardedMetadataAccessObject::FindAncestorContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (parent_contexts == nullptr) {
+    return absl::InvalidArgumentError("Given parent_contexts is NULL.");
+  }
+  std::vector<ParentContext> shard_parent_contexts;
+  MLMD_RETURN_IF_ERROR(Gather<Context>(
+      {ShardOf(context_id)},
+      [this, context_id, max_depth, &shard_parent_contexts](
+          int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindAncestorContextsByContextId(
+            ToLocalId(context_id), max_depth, shard_contexts,
+            &shard_parent_contexts);
+      },
+      contexts));
+  ToGlobal(ShardOf(context_id), &shard_parent_contexts);
+  parent_contexts->insert(parent_contexts->end(),
+                          shard_parent_contexts.begin(),
+                          shard_parent_contexts.end());
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::FindDescendantContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts,
+    std::vector<ParentContext>* parent_contexts) {
+  if (parent_contexts == nullptr) {
+    return absl::InvalidArgumentError("Given parent_contexts is NULL.");
+  }
+  std::vector<ParentContext> shard_parent_contexts;
+  MLMD_RETURN_IF_ERROR(Gather<Context>(
+      {ShardOf(context_id)},
+      [this, context_id, max_depth, &shard_parent_contexts](
+          int shard, std::vector<Context>* shard_contexts) {
+        return shards_[shard]->FindDescendantContextsByContextId(
+            ToLocalId(context_id), max_depth, shard_contexts,
+            &shard_parent_contexts);
+      },
+      contexts));
+  ToGlobal(ShardOf(context_id), &shard_parent_contexts);
+  parent_contexts->insert(parent_contexts->end(),
+                          shard_parent_contexts.begin(),
+                          shard_parent_contexts.end());
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataAccessObject::GetSchemaVersion(
+    int64* db_version) {
+  MLMD_RETURN_IF_ERROR(shards_[0]->GetSchemaVersion(db_version));
+  for (int shard = 1; shard < shards_.size(); shard++) {
+    int64 shard_db_version;
+    MLMD_RETURN_IF_ERROR(shards_[shard]->GetSchemaVersion(&shard_db_version));
+    if (shard_db_version != *db_version) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Shard ", shard, " is at schema version ", shard_db_version,
+          ", while shard 0 is at schema version ", *db_version));
+    }
+  }
+  return absl::OkStatus();
+}
+
+int64 ShardedMetadataAccessObject::GetLibraryVersion() {
+  return shards_[0]->GetLibraryVersion();
+}
+
+absl::Status ShardedMetadataAccessObject::SetPlacementHint(
+    const Context& context) {
+  placement_shard_ =
+      context.has_id()
+          ? ShardOf(context.id())
+          : ShardOfContextName(context.type_id(), context.name(),
+                               shards_.size());
+  return absl::OkStatus();
+}
+
+void ShardedMetadataAccessObject::ClearPlacementHint() {
+  placement_shard_.reset();
+}
+
+}  // namespace ml_metadata
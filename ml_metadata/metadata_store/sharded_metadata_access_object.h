@@ -0,0 +1,605 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SHARDED_METADATA_ACCESS_OBJECT_H_
+#define ML_METADATA_METADATA_STORE_SHARDED_METADATA_ACCESS_OBJECT_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An implementation of MetadataAccessObject which partitions the nodes across
+// shards, each of which is a MetadataAccessObject of its own database, e.g.,
+// a MySQL instance. The shards are accessed in the same transactions, see
+// RdbmsTransactionExecutor.
+//
+// Ids: a node with id `local_id` on shard `s` of `n` has the global id
+// `local_id * n + s`, so the shard of a node is known from its id alone, and
+// the ids are unique across the shards. The number of shards must not change
+// once nodes are stored.
+//
+// Placement: the types are replicated on all the shards with the ids assigned
+// by shard 0. The nodes created under a placement hint, e.g., by PutExecution,
+// go to the shard of the hinted context, which is the shard of a new context
+// of the same type and name, so the runs of a pipeline share a shard. Other
+// new contexts are placed by type and name, and other new artifacts and
+// executions by type.
+// Events, associations, attributions and parent contexts link nodes of one
+// shard only.
+//
+// Queries: the lookups by id or by a linked node run on the shards of the
+// ids, and the other lookups, e.g., FindArtifactsByTypeId, run on all the
+// shards and merge their results. The paginated List* lookups are not
+// supported across shards. The names of the nodes are unique per shard only.
+class ShardedMetadataAccessObject : public MetadataAccessObject {
+ public:
+  // `shards` must not be empty and their order must not change.
+  explicit ShardedMetadataAccessObject(
+      std::vector<std::unique_ptr<MetadataAccessObject>> shards);
+  ~ShardedMetadataAccessObject() override = default;
+
+  // Schema, on all the shards.
+  absl::Status InitMetadataSource() final;
+  absl::Status InitMetadataSourceIfNotExists(
+      bool enable_upgrade_migration = false) final;
+  absl::Status DowngradeMetadataSource(int64 to_schema_version) final;
+  absl::Status MigrateSchemaStep(int64 to_schema_version, int64 max_num_chunks,
+                                 SchemaMigrationProgress* progress) final;
+  absl::Status DropSecondaryIndices() final;
+  absl::Status CreateSecondaryIndices() final;
+  absl::Status MaintainEventPartitions(const EventPartitionOptions& options,
+                                       int64 now_milliseconds,
+                                       bool enable_migration) final;
+  absl::Status InlineEventPaths(bool enable_migration, int64 max_num_events,
+                                int64* num_moved_events) final;
+
+  absl::Status InlineNodeProperties(bool enable_migration, int64 max_num_nodes,
+                                    int64* num_filled_nodes) final;
+
+  absl::Status MaintainNodePropertiesBytes() final;
+
+  void SetPinnedRead(bool pinned_read) final;
+
+  // Idempotency keys, kept on the first shard.
+  absl::Status CreateIdempotencyKeyTable() final;
+  absl::Status FindIdempotencyKey(absl::string_view idempotency_key,
+                                  int64* request_fingerprint,
+                                  absl::Time* create_time,
+                                  std::string* response) final {
+    return shards_[0]->FindIdempotencyKey(idempotency_key, request_fingerprint,
+                                          create_time, response);
+  }
+  absl::Status CreateIdempotencyKey(absl::string_view idempotency_key,
+                                    int64 request_fingerprint,
+                                    absl::Time create_time,
+                                    absl::string_view response) final {
+    return shards_[0]->CreateIdempotencyKey(
+        idempotency_key, request_fingerprint, create_time, response);
+  }
+  absl::Status FindIdempotencyKeysCreatedBefore(
+      absl::Time create_time, int64 max_num_keys,
+      std::vector<std::string>* idempotency_keys) final {
+    return shards_[0]->FindIdempotencyKeysCreatedBefore(
+        create_time, max_num_keys, idempotency_keys);
+  }
+  absl::Status DeleteIdempotencyKeys(
+      absl::Span<const std::string> idempotency_keys) final {
+    return shards_[0]->DeleteIdempotencyKeys(idempotency_keys);
+  }
+
+  // The lineage closure, kept on the first shard, as the lineage crosses the
+  // shards.
+  absl::Status CreateLineageClosureTable(bool* created) final {
+    return shards_[0]->CreateLineageClosureTable(created);
+  }
+  absl::Status CreateLineageClosure(
+      absl::Span<const int64> upstream_artifact_ids,
+      absl::Span<const int64> downstream_artifact_ids) final {
+    return shards_[0]->CreateLineageClosure(upstream_artifact_ids,
+                                            downstream_artifact_ids);
+  }
+  absl::Status FindLineageClosure(
+      absl::Span<const int64> artifact_ids, bool upstream,
+      std::vector<int64>* related_artifact_ids) final {
+    return shards_[0]->FindLineageClosure(artifact_ids, upstream,
+                                          related_artifact_ids);
+  }
+
+  // Types, written to all the shards and read from the first one.
+  absl::Status CreateType(const ArtifactType& type, int64* type_id) final;
+  absl::Status CreateType(const ExecutionType& type, int64* type_id) final;
+  absl::Status CreateType(const ContextType& type, int64* type_id) final;
+
+  absl::Status UpdateType(const ArtifactType& type) final;
+  absl::Status UpdateType(const ExecutionType& type) final;
+  absl::Status UpdateType(const ContextType& type) final;
+
+  absl::Status FindTypeById(int64 type_id, ArtifactType* artifact_type) final;
+  absl::Status FindTypeById(int64 type_id,
+                            ExecutionType* execution_type) final;
+  absl::Status FindTypeById(int64 type_id, ContextType* context_type) final;
+
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ArtifactType* artifact_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ExecutionType* execution_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ContextType* context_type) final;
+
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypesByNamesAndVersions(
+      absl::Span<const std::pair<std::string, std::string>> names_and_versions,
+      std::vector<ContextType>* context_types) final;
+
+  absl::Status FindTypes(std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypes(std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypes(std::vector<ContextType>* context_types) final;
+
+  absl::Status CreateParentTypeInheritanceLink(
+      const ArtifactType& type, const ArtifactType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ExecutionType& type, const ExecutionType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ContextType& type, const ContextType& parent_type) final;
+
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ArtifactType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ExecutionType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      int64 type_id, std::vector<ContextType>& output_parent_types) final;
+
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ArtifactType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ExecutionType>>&
+          output_parent_types) final;
+  absl::Status FindParentTypesByTypeIds(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, std::vector<ContextType>>&
+          output_parent_types) final;
+
+  // Artifacts.
+  absl::Status CreateArtifact(const Artifact& artifact,
+                              int64* artifact_id) final;
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 const PropertyOptions& property_options,
+                                 std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifacts(
+      const NodeBatchCallback<Artifact>& callback) final;
+  absl::Status FindArtifacts(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Artifact>& callback) final;
+
+  absl::Status FindArtifactsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Artifact>& callback) final;
+
+  // Returns UNIMPLEMENTED error, as the pages are not merged across shards.
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             const PropertyOptions& property_options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              const PropertyOptions& property_options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            const PropertyOptions& property_options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+
+  absl::Status FindArtifactByTypeIdAndArtifactName(int64 artifact_type_id,
+                                                   absl::string_view name,
+                                                   Artifact* artifact) final;
+
+  absl::Status FindArtifactsByTypeIdAndArtifactNames(
+      int64 artifact_type_id, absl::Span<const std::string> names,
+      std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByTypeId(int64 artifact_type_id,
+                                     const PropertyOptions& property_options,
+                                     std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByURI(absl::string_view uri,
+                                  std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByURIPrefix(
+      absl::string_view uri_prefix, std::vector<Artifact>* artifacts) final;
+
+  absl::Status CountArtifacts(absl::optional<int64> artifact_type_id,
+                              absl::optional<Artifact::State> state,
+                              int64* count) final;
+
+  absl::Status FindExistingArtifactIds(
+      absl::Span<const int64> artifact_ids,
+      std::vector<int64>* existing_artifact_ids) final;
+
+  absl::Status FindArtifactIdsByTypeId(
+      int64 artifact_type_id, std::vector<int64>* artifact_ids) final;
+
+  absl::Status AggregateArtifactProperty(
+      int64 artifact_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
+  absl::Status UpdateArtifact(const Artifact& artifact) final;
+  absl::Status UpdateArtifacts(absl::Span<const Artifact> artifacts) final;
+  absl::Status UpdateArtifactsIfUnchanged(
+      absl::Span<const Artifact> artifacts) final;
+
+  absl::Status DeleteArtifactsById(
+      absl::Span<const int64> artifact_ids) final;
+
+  absl::Status FindArtifactIdsUpdatedBefore(
+      int64 artifact_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* artifact_ids) final;
+
+  // Executions.
+  absl::Status CreateExecution(const Execution& execution,
+                               int64* execution_id) final;
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  const PropertyOptions& property_options,
+                                  std::vector<Execution>* executions) final;
+  absl::Status FindExecutions(std::vector<Execution>* executions) final;
+  absl::Status FindExecutions(
+      const NodeBatchCallback<Execution>& callback) final;
+  absl::Status FindExecutions(
+      const PropertyOptions& property_options,
+      const NodeBatchCallback<Execution>& callback) final;
+
+  absl::Status FindExecutionsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Execution>& callback) final;
+  absl::Status FindExecutionByTypeIdAndExecutionName(
+      int64 execution_type_id, absl::string_view name,
+      Execution* execution) final;
+
+  absl::Status FindExecutionsByTypeIdAndExecutionNames(
+      int64 execution_type_id, absl::Span<const std::string> names,
+      std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id, const PropertyOptions& property_options,
+      std::vector<Execution>* executions) final;
+
+  absl::Status CountExecutions(
+      absl::optional<int64> execution_type_id,
+      absl::optional<Execution::State> last_known_state, int64* count) final;
+
+  absl::Status AggregateExecutionProperty(
+      int64 execution_type_id, const PropertyAggregationOptions& options,
+      std::vector<PropertyAggregate>* aggregates) final;
+
+  absl::Status UpdateExecution(const Execution& execution) final;
+  absl::Status UpdateExecutions(absl::Span<const Execution> executions) final;
+  absl::Status UpdateExecutionsIfUnchanged(
+      absl::Span<const Execution> executions) final;
+
+  absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status FindExecutionIdsUpdatedBefore(
+      int64 execution_type_id, int64 last_update_time_since_epoch, int64 limit,
+      std::vector<int64>* execution_ids) final;
+
+  // Contexts.
+  absl::Status CreateContext(const Context& context, int64* context_id) final;
+  absl::Status CreateContextIfNotExist(const Context& context,
+                                       int64* context_id,
+                                       bool* created) final;
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                std::vector<Context>* contexts) final;
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                const PropertyOptions& property_options,
+                                std::vector<Context>* contexts) final;
+  absl::Status FindContexts(std::vector<Context>* contexts) final;
+  absl::Status FindContexts(const NodeBatchCallback<Context>& callback) final;
+  absl::Status FindContexts(const PropertyOptions& property_options,
+                            const NodeBatchCallback<Context>& callback) final;
+
+  absl::Status FindContextsUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Context>& callback) final;
+
+  // Returns UNIMPLEMENTED error, if `list_options` is set.
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Context>* contexts, std::string* next_page_token) final;
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      const PropertyOptions& property_options, std::vector<Context>* contexts,
+      std::string* next_page_token) final;
+
+  absl::Status CountContexts(absl::optional<int64> context_type_id,
+                             int64* count) final;
+  absl::Status FindContextByTypeIdAndContextName(int64 type_id,
+                                                 absl::string_view name,
+                                                 Context* context) final;
+
+  absl::Status FindContextsByTypeIdAndContextNames(
+      int64 context_type_id, absl::Span<const std::string> names,
+      std::vector<Context>* contexts) final;
+
+  absl::Status UpdateContext(const Context& context) final;
+  absl::Status UpdateContexts(absl::Span<const Context> contexts) final;
+  absl::Status UpdateContextsIfUnchanged(
+      absl::Span<const Context> contexts) final;
+
+  // Links, on the shard of their nodes.
+  // Returns FAILED_PRECONDITION error, if the linked nodes are on different
+  //   shards.
+  absl::Status CreateEvent(const Event& event, int64* event_id) final;
+  absl::Status CreateEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
+  using MetadataAccessObject::FindEventsByArtifacts;
+  absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
+                                     absl::Span<const Event::Type> types,
+                                     std::vector<Event>* events) final;
+  using MetadataAccessObject::FindEventsByExecutions;
+  absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
+                                      absl::Span<const Event::Type> types,
+                                      std::vector<Event>* events) final;
+
+  absl::Status CreateAssociation(const Association& association,
+                                 int64* association_id) final;
+
+  absl::Status CreateAssociations(
+      absl::Span<const Association> associations) final;
+
+  absl::Status FindContextsByExecution(int64 execution_id,
+                                       std::vector<Context>* contexts) final;
+  absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_execution)
+      final;
+  absl::Status FindExecutionsByContext(
+      int64 context_id, std::vector<Execution>* executions) final;
+  absl::Status FindExecutionsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Execution>* executions, std::string* next_page_token) final;
+  absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Execution>>*
+          executions_by_context) final;
+
+  absl::Status CreateAttribution(const Attribution& attribution,
+                                 int64* attribution_id) final;
+
+  absl::Status CreateAttributions(
+      absl::Span<const Attribution> attributions) final;
+
+  absl::Status FindContextsByArtifact(int64 artifact_id,
+                                      std::vector<Context>* contexts) final;
+  absl::Status FindContextsByArtifacts(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, std::vector<Context>>* contexts_by_artifact)
+      final;
+  absl::Status FindArtifactsByContext(int64 context_id,
+                                      std::vector<Artifact>* artifacts) final;
+  absl::Status FindArtifactsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Artifact>* artifacts, std::string* next_page_token) final;
+  absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids,
+      absl::flat_hash_map<int64, std::vector<Artifact>>* artifacts_by_context)
+      final;
+
+  absl::Status CreateParentContext(const ParentContext& parent_context) final;
+
+  absl::Status CreateParentContexts(
+      absl::Span<const ParentContext> parent_contexts) final;
+
+  absl::Status FindParentContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+  absl::Status FindChildContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+  absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+  absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts,
+      std::vector<ParentContext>* parent_contexts) final;
+
+  // Returns FAILED_PRECONDITION error, if the shards differ in schema version.
+  absl::Status GetSchemaVersion(int64* db_version) final;
+
+  int64 GetLibraryVersion() final;
+
+  absl::Status SetPlacementHint(const Context& context) final;
+  void ClearPlacementHint() final;
+
+  // Returns the shard storing the node of `id`.
+  int ShardOf(int64 id) const;
+
+ private:
+  // Returns the id of `local_id` on `shard` among all the shards and back.
+  int64 ToGlobalId(int64 local_id, int shard) const;
+  int64 ToLocalId(int64 id) const;
+
+  // Rewrites the node ids of `message` on `shard` into global ids.
+  void ToGlobal(int shard, Artifact* artifact) const;
+  void ToGlobal(int shard, Execution* execution) const;
+  void ToGlobal(int shard, Context* context) const;
+  void ToGlobal(int shard, Event* event) const;
+  void ToGlobal(int shard, ParentContext* parent_context) const;
+  template <typename T>
+  void ToGlobal(int shard, std::vector<T>* messages) const;
+
+  // Returns a copy of `node` whose id is local to its shard.
+  template <typename Node>
+  Node ToLocal(const Node& node) const;
+
+  // Returns the shard for a new node of `type_id`, or for a new `context`.
+  int ShardForNewNode(int64 type_id) const;
+  int ShardForNewContext(const Context& context) const;
+
+  // Returns FAILED_PRECONDITION error, if the linked nodes of `id` and
+  // `other_id` are on different shards, otherwise sets `shard` to theirs.
+  absl::Status GetShardOfLink(int64 id, int64 other_id, int* shard) const;
+
+  // Returns the local ids of `ids` grouped by shard.
+  std::vector<std::vector<int64>> GroupByShard(
+      absl::Span<const int64> ids) const;
+
+  // Runs `find` on each of the `shards` and appends their results, with
+  // global ids, to `results`.
+  // Returns NOT_FOUND error, if each shard returns NOT_FOUND error.
+  template <typename T>
+  absl::Status Gather(
+      const std::vector<int>& shards,
+      const std::function<absl::Status(int, std::vector<T>*)>& find,
+      std::vector<T>* results);
+
+  // Same as Gather, on all the shards.
+  template <typename T>
+  absl::Status ScatterGather(
+      const std::function<absl::Status(int, std::vector<T>*)>& find,
+      std::vector<T>* results);
+
+  // Runs `count` on each shard and sets `total` to the sum of the counts.
+  absl::Status SumCounts(const std::function<absl::Status(int, int64*)>& count,
+                         int64* total);
+
+  // Runs `aggregate` with `options` on the shards and merges the aggregates of
+  // the same state. If `options` has a context, only its shard is aggregated,
+  // with the local id of the context.
+  absl::Status AggregateOnShards(
+      const PropertyAggregationOptions& options,
+      const std::function<absl::Status(int, const PropertyAggregationOptions&,
+                                       std::vector<PropertyAggregate>*)>&
+          aggregate,
+      std::vector<PropertyAggregate>* aggregates);
+
+  // Runs `find` with the local ids of `ids` on their shards.
+  // Returns NOT_FOUND error, if a shard returns NOT_FOUND error, with the
+  //   nodes found on all the shards.
+  template <typename Node>
+  absl::Status FindNodesById(
+      absl::Span<const int64> ids,
+      const std::function<absl::Status(int, absl::Span<const int64>,
+                                       std::vector<Node>*)>& find,
+      std::vector<Node>* nodes);
+
+  // Runs `find` on the shards until one of them finds the `node`.
+  template <typename Node>
+  absl::Status FindNodeOnAnyShard(
+      const std::function<absl::Status(int, Node*)>& find, Node* node);
+
+  // Runs `create` on the shard of each of the `messages`, which `localize`
+  // sets along with a copy with local ids, and sets the global `ids`.
+  template <typename T>
+  absl::Status CreateOnShards(
+      absl::Span<const T> messages,
+      const std::function<absl::Status(const T&, int*, T*)>& localize,
+      const std::function<absl::Status(int, absl::Span<const T>,
+                                       std::vector<int64>*)>& create,
+      std::vector<int64>* ids);
+
+  // Runs `update` with the local copies of `nodes` on their shards.
+  template <typename Node>
+  absl::Status UpdateNodes(
+      absl::Span<const Node> nodes,
+      const std::function<absl::Status(int, absl::Span<const Node>)>& update);
+
+  // Runs `stream` on each shard, passing the batches with global ids to
+  // `callback`.
+  template <typename Node>
+  absl::Status StreamNodes(
+      const NodeBatchCallback<Node>& callback,
+      const std::function<absl::Status(int, const NodeBatchCallback<Node>&)>&
+          stream);
+
+  // Runs `stream` on each shard with the local id of the watermark on the
+  // shard, and passes the changed nodes with global ids to `callback` in
+  // batches, ordered by (last_update_time_since_epoch, id). The changes of the
+  // shards are merged in memory to order them.
+  template <typename Node>
+  absl::Status StreamNodesUpdatedAfter(
+      int64 last_update_time_since_epoch, int64 id,
+      const NodeBatchCallback<Node>& callback,
+      const std::function<absl::Status(int, int64,
+                                       const NodeBatchCallback<Node>&)>&
+          stream);
+
+  // Runs `find_ids` on each shard, which returns at most `limit` local ids,
+  // and sets `ids` to the global ids of the `limit` least recently updated
+  // nodes among them. The update times are read with `find`.
+  template <typename Node>
+  absl::Status FindNodeIdsUpdatedBefore(
+      int64 limit,
+      const std::function<absl::Status(int, std::vector<int64>*)>& find_ids,
+      const std::function<absl::Status(int, absl::Span<const int64>,
+                                       std::vector<Node>*)>& find,
+      std::vector<int64>* ids);
+
+  // Creates `type` on shard 0, and on each other shard with the id assigned
+  // by shard 0. Fails if a shard cannot create it with that id.
+  template <typename Type>
+  absl::Status CreateTypeOnShards(const Type& type, int64* type_id);
+
+  // Runs `write` on each shard.
+  absl::Status WriteOnShards(const std::function<absl::Status(int)>& write);
+
+  std::vector<std::unique_ptr<MetadataAccessObject>> shards_;
+  // The shard of the new nodes, while a placement hint is set.
+  absl::optional<int> placement_shard_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SHARDED_METADATA_ACCESS_OBJECT_H_
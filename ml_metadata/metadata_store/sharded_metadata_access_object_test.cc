@@ -0,0 +1,447 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sharded_metadata_access_object.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+constexpr int kNumShards = 3;
+
+// Each shard is an in-memory SQLite database, and each test runs in one
+// transaction on all of them.
+class ShardedMetadataAccessObjectTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<std::unique_ptr<MetadataAccessObject>> shards;
+    for (int i = 0; i < kNumShards; i++) {
+      metadata_sources_.push_back(absl::make_unique<SqliteMetadataSource>(
+          SqliteMetadataSourceConfig()));
+      std::unique_ptr<MetadataAccessObject> shard;
+      CHECK_EQ(absl::OkStatus(),
+               CreateMetadataAccessObject(
+                   util::GetSqliteMetadataSourceQueryConfig(),
+                   metadata_sources_.back().get(), &shard));
+      shards.push_back(std::move(shard));
+      ASSERT_EQ(absl::OkStatus(), metadata_sources_.back()->Begin());
+    }
+    metadata_access_object_ =
+        absl::make_unique<ShardedMetadataAccessObject>(std::move(shards));
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->InitMetadataSource());
+  }
+
+  void TearDown() override {
+    for (const std::unique_ptr<SqliteMetadataSource>& metadata_source :
+         metadata_sources_) {
+      ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+    }
+  }
+
+  // Creates an artifact, an execution and a context type.
+  void CreateTypes() {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateType(
+                  ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+                  &artifact_type_id_));
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateType(
+                  ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+                  &execution_type_id_));
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateType(
+                  ParseTextProtoOrDie<ContextType>("name: 'pipeline'"),
+                  &context_type_id_));
+  }
+
+  // Creates artifact types until one has its artifacts placed on another shard
+  // than `shard`, and returns its id.
+  int64 CreateArtifactTypeOffShard(const int shard) {
+    while (true) {
+      int64 type_id;
+      CHECK_EQ(absl::OkStatus(),
+               metadata_access_object_->CreateType(
+                   ParseTextProtoOrDie<ArtifactType>(absl::StrCat(
+                       "name: 'artifact_type_", num_extra_types_++, "'")),
+                   &type_id));
+      if (metadata_access_object_->ShardOf(CreateArtifact(type_id)) != shard) {
+        return type_id;
+      }
+    }
+  }
+
+  int64 CreateArtifact(const int64 type_id) {
+    Artifact artifact;
+    artifact.set_type_id(type_id);
+    int64 artifact_id;
+    CHECK_EQ(absl::OkStatus(),
+             metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    return artifact_id;
+  }
+
+  int64 CreateExecution() {
+    Execution execution;
+    execution.set_type_id(execution_type_id_);
+    int64 execution_id;
+    CHECK_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                   execution, &execution_id));
+    return execution_id;
+  }
+
+  std::vector<std::unique_ptr<SqliteMetadataSource>> metadata_sources_;
+  std::unique_ptr<ShardedMetadataAccessObject> metadata_access_object_;
+  int64 artifact_type_id_;
+  int64 execution_type_id_;
+  int64 context_type_id_;
+  int num_extra_types_ = 0;
+};
+
+TEST_F(ShardedMetadataAccessObjectTest, TypesAreReplicated) {
+  CreateTypes();
+  ArtifactType type;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(artifact_type_id_, &type));
+  EXPECT_EQ(type.name(), "artifact_type");
+  // The artifacts of all the types can be created on any shard.
+  const int64 artifact_id = CreateArtifact(artifact_type_id_);
+  const int64 other_type_id =
+      CreateArtifactTypeOffShard(metadata_access_object_->ShardOf(artifact_id));
+  EXPECT_NE(metadata_access_object_->ShardOf(CreateArtifact(other_type_id)),
+            metadata_access_object_->ShardOf(artifact_id));
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, TypesKeepTheIdsOfShardZero) {
+  // A type inserted on shard 1 only moves its auto-increment past the ids
+  // which shard 0 assigns to the first types.
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_sources_[1]->ExecuteQuery(
+                "INSERT INTO `Type`(`id`, `name`, `type_kind`) "
+                "VALUES(4, 'stray', 1);",
+                &record_set));
+  CreateTypes();
+  for (int shard = 0; shard < kNumShards; shard++) {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_sources_[shard]->ExecuteQuery(
+                  "SELECT `id` FROM `Type` WHERE `name` = 'artifact_type';",
+                  &record_set));
+    ASSERT_EQ(record_set.records_size(), 1);
+    EXPECT_EQ(record_set.records(0).values(0),
+              absl::StrCat(artifact_type_id_));
+  }
+
+  // The id which shard 0 assigns next is taken on shard 1.
+  int64 type_id;
+  EXPECT_TRUE(absl::IsInternal(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'conflicting_type'"),
+      &type_id)));
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, ScatterGatherArtifacts) {
+  CreateTypes();
+  const int64 artifact_id_1 = CreateArtifact(artifact_type_id_);
+  const int64 artifact_id_2 = CreateArtifact(artifact_type_id_);
+  const int64 other_type_id = CreateArtifactTypeOffShard(
+      metadata_access_object_->ShardOf(artifact_id_1));
+  const int64 other_artifact_id = CreateArtifact(other_type_id);
+
+  // The shards assign the same local ids, while the global ids differ.
+  EXPECT_NE(artifact_id_1, other_artifact_id);
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  {artifact_id_2, other_artifact_id},
+                                  &artifacts));
+  std::vector<int64> found_ids;
+  for (const Artifact& artifact : artifacts) {
+    found_ids.push_back(artifact.id());
+  }
+  EXPECT_THAT(found_ids,
+              UnorderedElementsAre(artifact_id_2, other_artifact_id));
+
+  artifacts.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifactsByTypeId(artifact_type_id_,
+                                                           &artifacts));
+  EXPECT_THAT(artifacts, SizeIs(2));
+  artifacts.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifacts(&artifacts));
+  // Each type created off shard has an artifact as well.
+  EXPECT_THAT(artifacts, SizeIs(3 + num_extra_types_));
+
+  std::string next_page_token;
+  EXPECT_TRUE(absl::IsUnimplemented(metadata_access_object_->ListArtifacts(
+      ListOperationOptions(), &artifacts, &next_page_token)));
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, FindArtifactsByIdReturnsNotFound) {
+  CreateTypes();
+  const int64 artifact_id = CreateArtifact(artifact_type_id_);
+  std::vector<Artifact> artifacts;
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindArtifactsById(
+      {artifact_id, artifact_id + kNumShards}, &artifacts)));
+  ASSERT_THAT(artifacts, SizeIs(1));
+  EXPECT_EQ(artifacts[0].id(), artifact_id);
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, PlacementHintKeepsNodesTogether) {
+  CreateTypes();
+  Context context;
+  context.set_type_id(context_type_id_);
+  context.set_name("pipeline_1");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->SetPlacementHint(context));
+  const int64 artifact_id = CreateArtifact(artifact_type_id_);
+  const int64 execution_id = CreateExecution();
+  int64 context_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context, &context_id));
+  metadata_access_object_->ClearPlacementHint();
+
+  const int shard = metadata_access_object_->ShardOf(context_id);
+  EXPECT_EQ(metadata_access_object_->ShardOf(artifact_id), shard);
+  EXPECT_EQ(metadata_access_object_->ShardOf(execution_id), shard);
+
+  Event event;
+  event.set_artifact_id(artifact_id);
+  event.set_execution_id(execution_id);
+  event.set_type(Event::OUTPUT);
+  int64 event_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateEvent(event, &event_id));
+  Association association;
+  association.set_context_id(context_id);
+  association.set_execution_id(execution_id);
+  int64 association_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                  association, &association_id));
+
+  std::vector<Event> events;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByArtifacts(
+                                  {artifact_id}, &events));
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].execution_id(), execution_id);
+  std::vector<Context> contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsByExecution(
+                                  execution_id, &contexts));
+  ASSERT_THAT(contexts, SizeIs(1));
+  EXPECT_EQ(contexts[0].id(), context_id);
+
+  // A later run of the pipeline is placed on the shard of its context.
+  Context found_context;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindContextByTypeIdAndContextName(
+                context_type_id_, "pipeline_1", &found_context));
+  EXPECT_EQ(found_context.id(), context_id);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->SetPlacementHint(found_context));
+  EXPECT_EQ(metadata_access_object_->ShardOf(CreateExecution()), shard);
+  metadata_access_object_->ClearPlacementHint();
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, RejectLinkAcrossShards) {
+  CreateTypes();
+  Context context;
+  context.set_type_id(context_type_id_);
+  context.set_name("pipeline_1");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->SetPlacementHint(context));
+  const int64 execution_id = CreateExecution();
+  metadata_access_object_->ClearPlacementHint();
+  const int64 artifact_id = CreateArtifact(CreateArtifactTypeOffShard(
+      metadata_access_object_->ShardOf(execution_id)));
+
+  Event event;
+  event.set_artifact_id(artifact_id);
+  event.set_execution_id(execution_id);
+  event.set_type(Event::INPUT);
+  int64 event_id;
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      metadata_access_object_->CreateEvent(event, &event_id)));
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, FindExecutionsByContexts) {
+  CreateTypes();
+  std::vector<int64> context_ids;
+  std::vector<int64> execution_ids;
+  for (const char* name : {"pipeline_1", "pipeline_2", "pipeline_3"}) {
+    Context context;
+    context.set_type_id(context_type_id_);
+    context.set_name(name);
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->SetPlacementHint(context));
+    int64 context_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(context, &context_id));
+    const int64 execution_id = CreateExecution();
+    metadata_access_object_->ClearPlacementHint();
+    Association association;
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+    int64 association_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                    association, &association_id));
+    context_ids.push_back(context_id);
+    execution_ids.push_back(execution_id);
+  }
+
+  absl::flat_hash_map<int64, std::vector<Execution>> executions_by_context;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindExecutionsByContexts(
+                                  context_ids, &executions_by_context));
+  ASSERT_THAT(executions_by_context, SizeIs(3));
+  for (int i = 0; i < context_ids.size(); i++) {
+    ASSERT_THAT(executions_by_context[context_ids[i]], SizeIs(1));
+    EXPECT_EQ(executions_by_context[context_ids[i]][0].id(), execution_ids[i]);
+  }
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, AggregatesAreMergedAcrossShards) {
+  CreateTypes();
+  // Each execution is placed on the shard of its context.
+  absl::flat_hash_set<int> shards;
+  std::vector<int64> context_ids;
+  for (int i = 0; i < 6; i++) {
+    Context context;
+    context.set_type_id(context_type_id_);
+    context.set_name(absl::StrCat("pipeline_", i));
+    int64 context_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(context, &context_id));
+    context.set_id(context_id);
+    context_ids.push_back(context_id);
+    shards.insert(metadata_access_object_->ShardOf(context_id));
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->SetPlacementHint(context));
+    Execution execution;
+    execution.set_type_id(execution_type_id_);
+    execution.set_last_known_state(i % 2 == 0 ? Execution::COMPLETE
+                                              : Execution::FAILED);
+    (*execution.mutable_custom_properties())["step"].set_int_value(i);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    execution, &execution_id));
+    Association association;
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+    int64 association_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                    association, &association_id));
+    metadata_access_object_->ClearPlacementHint();
+  }
+  ASSERT_THAT(shards, SizeIs(::testing::Gt(1)));
+
+  int64 count;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CountExecutions(
+                                  execution_type_id_, absl::nullopt, &count));
+  EXPECT_EQ(count, 6);
+
+  PropertyAggregationOptions options = ParseTextProtoOrDie<
+      PropertyAggregationOptions>(
+      "property_name: 'step' is_custom_property: true group_by_state: true");
+  std::vector<PropertyAggregate> aggregates;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->AggregateExecutionProperty(
+                execution_type_id_, options, &aggregates));
+  ASSERT_THAT(aggregates, SizeIs(2));
+  for (const PropertyAggregate& aggregate : aggregates) {
+    const bool complete = aggregate.state() == Execution::COMPLETE;
+    EXPECT_EQ(aggregate.num_nodes(), 3);
+    EXPECT_EQ(aggregate.num_values(), 3);
+    EXPECT_EQ(aggregate.min_value(), complete ? 0 : 1);
+    EXPECT_EQ(aggregate.max_value(), complete ? 4 : 5);
+    EXPECT_DOUBLE_EQ(aggregate.avg_value(), complete ? 2 : 3);
+  }
+
+  // Only the shard of a context is aggregated, with its local id.
+  options.set_group_by_state(false);
+  options.set_context_id(context_ids[3]);
+  aggregates.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->AggregateExecutionProperty(
+                execution_type_id_, options, &aggregates));
+  ASSERT_THAT(aggregates, SizeIs(1));
+  EXPECT_EQ(aggregates[0].num_nodes(), 1);
+  EXPECT_EQ(aggregates[0].min_value(), 3);
+}
+
+TEST_F(ShardedMetadataAccessObjectTest, ChangesAreMergedAcrossShards) {
+  CreateTypes();
+  absl::flat_hash_set<int> shards;
+  for (int i = 0; i < 6; i++) {
+    Context context;
+    context.set_type_id(context_type_id_);
+    context.set_name(absl::StrCat("pipeline_", i));
+    int64 context_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateContext(context, &context_id));
+    shards.insert(metadata_access_object_->ShardOf(context_id));
+  }
+  ASSERT_THAT(shards, SizeIs(::testing::Gt(1)));
+  const auto find_contexts_updated_after = [this](const Context* watermark) {
+    std::vector<Context> contexts;
+    EXPECT_EQ(absl::OkStatus(),
+              metadata_access_object_->FindContextsUpdatedAfter(
+                  watermark ? watermark->last_update_time_since_epoch() : 0,
+                  watermark ? watermark->id() : 0,
+                  [&contexts](absl::Span<const Context> batch) {
+                    contexts.insert(contexts.end(), batch.begin(),
+                                    batch.end());
+                    return absl::OkStatus();
+                  }));
+    return contexts;
+  };
+
+  // The changes of all shards are ordered by update time and global id.
+  const std::vector<Context> contexts = find_contexts_updated_after(nullptr);
+  ASSERT_THAT(contexts, SizeIs(6));
+  for (int i = 1; i < contexts.size(); i++) {
+    EXPECT_TRUE(std::make_pair(contexts[i - 1].last_update_time_since_epoch(),
+                               contexts[i - 1].id()) <
+                std::make_pair(contexts[i].last_update_time_since_epoch(),
+                               contexts[i].id()));
+  }
+  // The watermark of a global id is mapped to a local id on each shard.
+  for (int i = 0; i < contexts.size(); i++) {
+    const std::vector<Context> changes =
+        find_contexts_updated_after(&contexts[i]);
+    ASSERT_THAT(changes, SizeIs(contexts.size() - i - 1));
+    for (int j = 0; j < changes.size(); j++) {
+      EXPECT_EQ(changes[j].id(), contexts[i + j + 1].id());
+    }
+  }
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -18,15 +18,34 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "ml_metadata/simple_types/proto/simple_types.pb.h"
 #include "ml_metadata/simple_types/simple_types_constants.h"
+#include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
 
 absl::Status LoadSimpleTypes(SimpleTypes& simple_types) {
-  if (!google::protobuf::TextFormat::ParseFromString(std::string(kSimpleTypes),
-                                           &simple_types)) {
+  const SimpleTypes* parsed_simple_types;
+  MLMD_RETURN_IF_ERROR(GetSimpleTypes(&parsed_simple_types));
+  simple_types = *parsed_simple_types;
+  return absl::OkStatus();
+}
+
+absl::Status GetSimpleTypes(const SimpleTypes** simple_types) {
+  // Parsed on the first call, as the stores are initialized with the simple
+  // types, e.g., per connection.
+  static const SimpleTypes* parsed_simple_types = []() -> SimpleTypes* {
+    auto* parsed_simple_types = new SimpleTypes();
+    if (!google::protobuf::TextFormat::ParseFromString(
+            std::string(kSimpleTypes), parsed_simple_types)) {
+      delete parsed_simple_types;
+      return nullptr;
+    }
+    return parsed_simple_types;
+  }();
+  if (parsed_simple_types == nullptr) {
     return absl::InvalidArgumentError(
         "Failed to parse simple types from string");
   }
+  *simple_types = parsed_simple_types;
   return absl::OkStatus();
 }
 
@@ -23,6 +23,11 @@ namespace ml_metadata {
 // A util to create a SimpleTypes proto from a constant string at runtime.
 absl::Status LoadSimpleTypes(SimpleTypes& simple_types);
 
+// Sets `simple_types` to the SimpleTypes proto, which is parsed from the
+// constant string once per process and is never destroyed.
+// Returns INVALID_ARGUMENT error, if the string cannot be parsed.
+absl::Status GetSimpleTypes(const SimpleTypes** simple_types);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_SIMPLE_TYPES_UTIL_H_
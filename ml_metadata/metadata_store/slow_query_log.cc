@@ -0,0 +1,123 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/slow_query_log.h"
+
+#include <atomic>
+
+#include <glog/logging.h>
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace ml_metadata {
+namespace {
+
+// The slow query log of the process, or nullptr if it is disabled. A replaced
+// log is never deleted, as the queries which started before may still use it.
+std::atomic<SlowQueryLog*> slow_query_log{nullptr};
+
+}  // namespace
+
+void SlowQueryLog::Enable(const SlowQueryLogOptions& options) {
+  slow_query_log = new SlowQueryLog(options);
+}
+
+void SlowQueryLog::Disable() { slow_query_log = nullptr; }
+
+SlowQueryLog* SlowQueryLog::Get() { return slow_query_log.load(); }
+
+bool SlowQueryLog::ShouldExplain(const absl::string_view template_name) {
+  if (!options_.explain_first_occurrence) return false;
+  absl::MutexLock lock(&mu_);
+  return explained_templates_.insert(std::string(template_name)).second;
+}
+
+void SlowQueryLog::Log(const absl::string_view template_name,
+                       const absl::string_view description,
+                       const absl::Duration duration, const int64 num_rows,
+                       const RecordSet* plan) {
+  std::string plan_description;
+  if (plan != nullptr) {
+    absl::StrAppend(
+        &plan_description, "; plan: ",
+        absl::StrJoin(plan->records(), " | ",
+                      [](std::string* out, const RecordSet::Record& record) {
+                        absl::StrAppend(out,
+                                        absl::StrJoin(record.values(), " "));
+                      }));
+  }
+  LOG(WARNING) << "Slow query " << template_name << " took "
+               << absl::FormatDuration(duration) << " and returned "
+               << num_rows << " rows: " << description << plan_description;
+}
+
+std::string RedactStringLiterals(const absl::string_view sql) {
+  std::string redacted;
+  redacted.reserve(sql.size());
+  for (int i = 0; i < sql.size(); ++i) {
+    redacted.push_back(sql[i]);
+    if (sql[i] != '\'') continue;
+    // Skips the literal up to its closing quote. A quote is escaped by a
+    // backslash in MySQL, or by another quote.
+    for (++i; i < sql.size(); ++i) {
+      if (sql[i] == '\\') {
+        ++i;
+      } else if (sql[i] == '\'') {
+        if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+          ++i;
+        } else {
+          break;
+        }
+      }
+    }
+    redacted.append("?'");
+  }
+  return redacted;
+}
+
+std::string RedactPreparedStatementValue(const PreparedStatementValue& value) {
+  if (absl::holds_alternative<int64>(value)) {
+    return absl::StrCat(absl::get<int64>(value));
+  }
+  if (absl::holds_alternative<double>(value)) {
+    return absl::StrCat(absl::get<double>(value));
+  }
+  if (absl::holds_alternative<absl::monostate>(value)) return "NULL";
+  return "?";
+}
+
+bool GetExplainQuery(const MetadataSourceType type,
+                     const absl::string_view query,
+                     std::string* explain_query) {
+  if (!absl::StartsWithIgnoreCase(absl::StripLeadingAsciiWhitespace(query),
+                                  "select")) {
+    return false;
+  }
+  switch (type) {
+    case FAKE_METADATA_SOURCE:
+    case SQLITE_METADATA_SOURCE:
+      *explain_query = absl::StrCat("EXPLAIN QUERY PLAN ", query);
+      return true;
+    case MYSQL_METADATA_SOURCE:
+    case POSTGRESQL_METADATA_SOURCE:
+      *explain_query = absl::StrCat("EXPLAIN ", query);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace ml_metadata
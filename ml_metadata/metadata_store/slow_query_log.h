@@ -0,0 +1,105 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
+#define ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+
+// Options of the slow query log.
+struct SlowQueryLogOptions {
+  // The queries which take at least as long are logged.
+  absl::Duration threshold = absl::Seconds(1);
+  // If true, the plan of the first slow query of each template is also
+  // logged. It is read with an EXPLAIN of the query, which runs in the
+  // transaction of the query.
+  bool explain_first_occurrence = false;
+};
+
+// Logs the queries of the QueryConfigExecutors which are slower than a
+// threshold at WARNING level, with their MetadataSourceQueryConfig template,
+// redacted parameters, duration and number of rows, e.g., to find the
+// templates missing an index without enabling the slow log of the database.
+// It is thread-safe.
+class SlowQueryLog {
+ public:
+  // Enables the slow query log of the process. It should be called once at
+  // startup, before any query runs.
+  static void Enable(const SlowQueryLogOptions& options);
+
+  // Disables the slow query log of the process, e.g., at the end of a test.
+  static void Disable();
+
+  // Returns the slow query log of the process, or nullptr if it is disabled.
+  static SlowQueryLog* Get();
+
+  // Disallow copy and assign.
+  SlowQueryLog(const SlowQueryLog&) = delete;
+  SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+  // Returns true if a query which took `duration` is logged.
+  bool IsSlow(absl::Duration duration) const {
+    return duration >= options_.threshold;
+  }
+
+  // Returns true if a slow query of `template_name` is explained, i.e., if
+  // the plans are logged and it is the first slow query of the template.
+  bool ShouldExplain(absl::string_view template_name);
+
+  // Logs a slow query of `template_name`, whose parameters, or text if it has
+  // no template, are described by the redacted `description`. The `plan` is
+  // the result of its EXPLAIN, if it is not nullptr.
+  void Log(absl::string_view template_name, absl::string_view description,
+           absl::Duration duration, int64 num_rows, const RecordSet* plan);
+
+ private:
+  explicit SlowQueryLog(const SlowQueryLogOptions& options)
+      : options_(options) {}
+
+  const SlowQueryLogOptions options_;
+
+  absl::Mutex mu_;
+  // The templates whose first slow query was explained.
+  absl::flat_hash_set<std::string> explained_templates_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns `sql` with the contents of its single-quoted string literals
+// replaced by `?`, e.g., the names and property values of the nodes, while its
+// numbers, e.g., the ids, are kept.
+std::string RedactStringLiterals(absl::string_view sql);
+
+// Returns the redacted text of a value bound to a prepared statement: the
+// numbers and NULL are kept, while the strings and bytes are replaced by `?`.
+std::string RedactPreparedStatementValue(const PreparedStatementValue& value);
+
+// Sets `explain_query` to the statement which reads the plan of `query` in a
+// metadata source of `type`, e.g., EXPLAIN QUERY PLAN in SQLite. Returns false
+// if `query` is not a SELECT or the metadata source has no EXPLAIN.
+bool GetExplainQuery(MetadataSourceType type, absl::string_view query,
+                     std::string* explain_query);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
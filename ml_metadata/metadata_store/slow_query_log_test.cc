@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/slow_query_log.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+TEST(SlowQueryLogTest, RedactStringLiterals) {
+  EXPECT_EQ(RedactStringLiterals(
+                "SELECT id FROM Artifact WHERE name = 'a''b' AND type_id = 3"),
+            "SELECT id FROM Artifact WHERE name = '?' AND type_id = 3");
+  EXPECT_EQ(RedactStringLiterals(R"(uri = 'a\'b', 2)"), "uri = '?', 2");
+  EXPECT_EQ(RedactStringLiterals("1, 2, 3"), "1, 2, 3");
+}
+
+TEST(SlowQueryLogTest, RedactPreparedStatementValue) {
+  EXPECT_EQ(RedactPreparedStatementValue(int64{7}), "7");
+  EXPECT_EQ(RedactPreparedStatementValue(1.5), "1.5");
+  EXPECT_EQ(RedactPreparedStatementValue(absl::monostate()), "NULL");
+  EXPECT_EQ(RedactPreparedStatementValue(std::string("secret")), "?");
+  EXPECT_EQ(RedactPreparedStatementValue(PreparedStatementBytes{"secret"}),
+            "?");
+}
+
+TEST(SlowQueryLogTest, GetExplainQuery) {
+  std::string explain_query;
+  ASSERT_TRUE(GetExplainQuery(MYSQL_METADATA_SOURCE, "SELECT 1",
+                              &explain_query));
+  EXPECT_EQ(explain_query, "EXPLAIN SELECT 1");
+  ASSERT_TRUE(GetExplainQuery(SQLITE_METADATA_SOURCE, " select 1",
+                              &explain_query));
+  EXPECT_EQ(explain_query, "EXPLAIN QUERY PLAN  select 1");
+  EXPECT_FALSE(GetExplainQuery(MYSQL_METADATA_SOURCE, "DELETE FROM t",
+                               &explain_query));
+  EXPECT_FALSE(GetExplainQuery(IN_MEMORY_METADATA_SOURCE, "SELECT 1",
+                               &explain_query));
+}
+
+TEST(SlowQueryLogTest, ExplainFirstSlowQueryOfTemplate) {
+  SlowQueryLogOptions options;
+  options.threshold = absl::Milliseconds(10);
+  options.explain_first_occurrence = true;
+  SlowQueryLog::Enable(options);
+  SlowQueryLog* slow_query_log = SlowQueryLog::Get();
+  ASSERT_NE(slow_query_log, nullptr);
+  EXPECT_FALSE(slow_query_log->IsSlow(absl::Milliseconds(9)));
+  EXPECT_TRUE(slow_query_log->IsSlow(absl::Milliseconds(10)));
+  EXPECT_TRUE(slow_query_log->ShouldExplain("select_artifact_by_id"));
+  EXPECT_FALSE(slow_query_log->ShouldExplain("select_artifact_by_id"));
+  EXPECT_TRUE(slow_query_log->ShouldExplain("select_execution_by_id"));
+
+  options.explain_first_occurrence = false;
+  SlowQueryLog::Enable(options);
+  EXPECT_FALSE(SlowQueryLog::Get()->ShouldExplain("select_context_by_id"));
+  SlowQueryLog::Disable();
+  EXPECT_EQ(SlowQueryLog::Get(), nullptr);
+}
+
+TEST(SlowQueryLogTest, ExplainInSqlite) {
+  SqliteMetadataSource source((SqliteMetadataSourceConfig()));
+  ASSERT_EQ(source.Connect(), absl::OkStatus());
+  ASSERT_EQ(source.Begin(), absl::OkStatus());
+  ASSERT_EQ(source.ExecuteQuery("CREATE TABLE t1 (c1 INT, c2 VARCHAR(255));",
+                                nullptr),
+            absl::OkStatus());
+  std::string explain_query;
+  ASSERT_TRUE(GetExplainQuery(SQLITE_METADATA_SOURCE,
+                              "SELECT c2 FROM t1 WHERE c1 = 1",
+                              &explain_query));
+  RecordSet plan;
+  ASSERT_EQ(source.ExecuteQuery(explain_query, &plan), absl::OkStatus());
+  EXPECT_THAT(plan.records(), Not(IsEmpty()));
+  ASSERT_EQ(source.Commit(), absl::OkStatus());
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,142 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sql_text_util.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/config.h"
+#include "absl/strings/numbers.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr uint64_t kOnes = 0x0101010101010101ULL;
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+// Loads the 8 bytes at `data`, the first one in the lowest byte.
+uint64_t LoadWord(const char* data) {
+  uint64_t word;
+  std::memcpy(&word, data, sizeof(word));
+#if !defined(ABSL_IS_LITTLE_ENDIAN)
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+// Returns a word whose bytes have their high bit set where the byte of `word`
+// is below `n`, which is at most 128, and possibly past it, as a borrow may
+// flag the bytes above. The bytes from 128 are never flagged by themselves.
+constexpr uint64_t HasByteBelow(const uint64_t word, const uint64_t n) {
+  return (word - kOnes * n) & ~word & kHighBits;
+}
+
+// Returns a word whose bytes have their high bit set where the byte of `word`
+// is `c`, which is below 128, and possibly past it.
+constexpr uint64_t HasByte(const uint64_t word, const unsigned char c) {
+  return HasByteBelow(word ^ (kOnes * c), 1);
+}
+
+// Returns the position of the first byte of `value` for which `is_special`
+// holds, or npos. The words of 8 bytes for which `word_may_be_special` does
+// not hold are skipped, and the others are checked byte by byte, so that
+// `word_may_be_special` may have false positives but no false negatives.
+template <typename WordPredicate, typename BytePredicate>
+size_t FindSpecialByte(const absl::string_view value,
+                       const WordPredicate& word_may_be_special,
+                       const BytePredicate& is_special) {
+  size_t i = 0;
+  for (; i + 8 <= value.size(); i += 8) {
+    if (!word_may_be_special(LoadWord(value.data() + i))) continue;
+    for (size_t j = i; j < i + 8; ++j) {
+      if (is_special(static_cast<unsigned char>(value[j]))) return j;
+    }
+  }
+  for (; i < value.size(); ++i) {
+    if (is_special(static_cast<unsigned char>(value[i]))) return i;
+  }
+  return absl::string_view::npos;
+}
+
+// Parses the 8 decimal digits at `data` into `value`, or returns false if they
+// are not all digits.
+bool ParseEightDigits(const char* data, uint64_t* value) {
+  uint64_t word = LoadWord(data);
+  // Each byte is a digit if its high nibble is 3 and it stays so after adding
+  // 6, i.e., it is in '0'..'9'.
+  if ((word & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+      ((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) !=
+          0x3030303030303030ULL) {
+    return false;
+  }
+  // The digits are combined by pairs, then by quads and by octets.
+  word -= 0x3030303030303030ULL;
+  word = (word * 10) + (word >> 8);
+  word = (((word & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+          (((word >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+         32;
+  *value = word;
+  return true;
+}
+
+}  // namespace
+
+size_t FindSqliteSpecialByte(const absl::string_view value) {
+  return FindSpecialByte(
+      value,
+      [](const uint64_t word) {
+        return (HasByte(word, '\0') | HasByte(word, '\'')) != 0;
+      },
+      [](const unsigned char c) { return c == '\0' || c == '\''; });
+}
+
+size_t FindMySqlSpecialByte(const absl::string_view value) {
+  return FindSpecialByte(
+      value,
+      [](const uint64_t word) {
+        return (HasByteBelow(word, 0x20) | HasByte(word, '"') |
+                HasByte(word, '\'') | HasByte(word, '\\')) != 0;
+      },
+      [](const unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\'' || c == '\\';
+      });
+}
+
+bool ParseDecimalInt64(absl::string_view text, int64* value) {
+  const bool negative = !text.empty() && text[0] == '-';
+  const absl::string_view digits = negative ? text.substr(1) : text;
+  if (digits.empty() || digits.size() > 18) {
+    return absl::SimpleAtoi(text, value);
+  }
+  uint64_t result = 0;
+  size_t i = 0;
+  for (; i + 8 <= digits.size(); i += 8) {
+    uint64_t eight_digits;
+    if (!ParseEightDigits(digits.data() + i, &eight_digits)) {
+      return absl::SimpleAtoi(text, value);
+    }
+    result = result * 100000000 + eight_digits;
+  }
+  for (; i < digits.size(); ++i) {
+    const unsigned char digit = digits[i] - '0';
+    if (digit > 9) return absl::SimpleAtoi(text, value);
+    result = result * 10 + digit;
+  }
+  // At most 18 digits fit in an int64.
+  *value = negative ? -static_cast<int64>(result) : static_cast<int64>(result);
+  return true;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,48 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SQL_TEXT_UTIL_H_
+#define ML_METADATA_METADATA_STORE_SQL_TEXT_UTIL_H_
+
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Scanners and decoders of the text of the queries and of their results. They
+// read the text a word of 8 bytes at a time, so that the common case, e.g., a
+// string without any byte to escape or a plain decimal id, is handled without
+// a branch per byte.
+
+// Returns the position of the first single quote or NUL byte of `value`, i.e.,
+// the first byte which a SQLite string literal does not copy as is, or npos.
+size_t FindSqliteSpecialByte(absl::string_view value);
+
+// Returns the position of the first byte of `value` which a MySQL string
+// literal may escape, i.e., a control character, a double or single quote or
+// a backslash, or npos. The control characters are a superset of the ones
+// escaped by mysql_real_escape_string, so that a string without any is copied
+// as is.
+size_t FindMySqlSpecialByte(absl::string_view value);
+
+// Parses the decimal integer `text` into `value`, as absl::SimpleAtoi. The
+// numbers of at most 18 digits, and an optional minus sign, are parsed 8
+// digits at a time; the others are passed to absl::SimpleAtoi.
+bool ParseDecimalInt64(absl::string_view text, int64* value);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SQL_TEXT_UTIL_H_
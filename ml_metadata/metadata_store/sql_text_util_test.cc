@@ -0,0 +1,142 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sql_text_util.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the position of the first byte of `value` in `special_bytes`, byte
+// by byte.
+size_t FindByteByByte(absl::string_view value,
+                      absl::string_view special_bytes) {
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (special_bytes.find(value[i]) != absl::string_view::npos) return i;
+  }
+  return absl::string_view::npos;
+}
+
+TEST(SqlTextUtilTest, FindSqliteSpecialByte) {
+  const std::string special_bytes("'\0", 2);
+  EXPECT_EQ(FindSqliteSpecialByte(""), absl::string_view::npos);
+  EXPECT_EQ(FindSqliteSpecialByte("a plain uri/of/an/artifact"),
+            absl::string_view::npos);
+  // The special byte is found at each position of the words and of the tail,
+  // and after the non-ASCII bytes.
+  for (const char special : special_bytes) {
+    for (size_t size = 1; size <= 20; ++size) {
+      for (size_t position = 0; position < size; ++position) {
+        std::string value(size, '\xe9');
+        value[position] = special;
+        EXPECT_EQ(FindSqliteSpecialByte(value), position);
+      }
+    }
+  }
+  // The bytes around the special ones, e.g., the ones a borrow may flag, are
+  // not special.
+  std::string all_bytes;
+  for (int c = 255; c >= 0; --c) all_bytes.push_back(static_cast<char>(c));
+  for (size_t start = 0; start < all_bytes.size(); ++start) {
+    const absl::string_view value = absl::string_view(all_bytes).substr(start);
+    EXPECT_EQ(FindSqliteSpecialByte(value),
+              FindByteByByte(value, special_bytes));
+  }
+}
+
+TEST(SqlTextUtilTest, FindMySqlSpecialByte) {
+  const std::string special_bytes = [] {
+    std::string bytes = "\"'\\";
+    for (char c = 0; c < 0x20; ++c) bytes.push_back(c);
+    return bytes;
+  }();
+  EXPECT_EQ(FindMySqlSpecialByte("a plain uri/of/an/artifact"),
+            absl::string_view::npos);
+  for (const char special : special_bytes) {
+    for (size_t size = 1; size <= 20; ++size) {
+      for (size_t position = 0; position < size; ++position) {
+        std::string value(size, ' ');
+        value[position] = special;
+        EXPECT_EQ(FindMySqlSpecialByte(value), position);
+      }
+    }
+  }
+  std::string all_bytes;
+  for (int c = 255; c >= 0; --c) all_bytes.push_back(static_cast<char>(c));
+  for (size_t start = 0; start < all_bytes.size(); ++start) {
+    const absl::string_view value = absl::string_view(all_bytes).substr(start);
+    EXPECT_EQ(FindMySqlSpecialByte(value),
+              FindByteByByte(value, special_bytes));
+  }
+}
+
+TEST(SqlTextUtilTest, ParseDecimalInt64AsSimpleAtoi) {
+  const std::vector<std::string> texts = {
+      "0",
+      "7",
+      "-7",
+      "-0",
+      "12345678",
+      "123456789",
+      "1234567890123456",
+      "999999999999999999",
+      "-999999999999999999",
+      "1000000000000000000",
+      "9223372036854775807",
+      "-9223372036854775808",
+      "9223372036854775808",
+      "00000000000000000000042",
+      "+42",
+      " 42",
+      "42 ",
+      "4a2",
+      "1234567:",
+      "1234567/9",
+      "12345678/",
+      "-",
+      "",
+      "--1",
+      "1.5",
+  };
+  for (const std::string& text : texts) {
+    int64 expected = -1, actual = -1;
+    const bool expected_ok = absl::SimpleAtoi(text, &expected);
+    EXPECT_EQ(ParseDecimalInt64(text, &actual), expected_ok) << text;
+    if (expected_ok) {
+      EXPECT_EQ(actual, expected) << text;
+    }
+  }
+}
+
+TEST(SqlTextUtilTest, SqliteEscapeString) {
+  EXPECT_EQ(SqliteEscapeString(""), "");
+  EXPECT_EQ(SqliteEscapeString("plain"), "plain");
+  EXPECT_EQ(SqliteEscapeString("'"), "''");
+  EXPECT_EQ(SqliteEscapeString("it's a 'quoted' name"),
+            "it''s a ''quoted'' name");
+  // As with the %q of sqlite3_mprintf, the string ends at its first NUL.
+  EXPECT_EQ(SqliteEscapeString(absl::string_view("a'b\0c'd", 7)), "a''b");
+  EXPECT_EQ(SqliteEscapeString(absl::string_view("ab\0c", 4)), "ab");
+}
+
+}  // namespace
+}  // namespace ml_metadata
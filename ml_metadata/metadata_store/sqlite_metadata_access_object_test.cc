@@ -21,12 +21,16 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
 #include "ml_metadata/metadata_store/metadata_access_object_test.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
+#include "ml_metadata/util/struct_utils.h"
 
 namespace ml_metadata {
 namespace testing {
@@ -75,5 +79,94 @@ INSTANTIATE_TEST_SUITE_P(
       return absl::make_unique<SqliteMetadataAccessObjectContainer>();
     }));
 
+// Checks the prefix lookup of uris uses the index on uri, which SQLite only
+// does for the case-sensitive GLOB.
+TEST(SqliteMetadataAccessObjectTest, SelectArtifactsByURIPrefixUsesIndex) {
+  SqliteMetadataAccessObjectContainer container;
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            container.GetMetadataAccessObject()->InitMetadataSource());
+  const std::string query = absl::Substitute(
+      util::GetSqliteMetadataSourceQueryConfig()
+          .select_artifacts_by_uri_prefix()
+          .query(),
+      "'gs://bucket/*'");
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                absl::StrCat("EXPLAIN QUERY PLAN ", query), &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_THAT(record_set.DebugString(),
+              ::testing::HasSubstr("USING COVERING INDEX idx_artifact_uri"));
+}
+
+// Checks the struct properties are stored as bytes, and the ones stored as
+// strings by the earlier schema versions are still read.
+TEST(SqliteMetadataAccessObjectTest, StructPropertiesStoredAsBytes) {
+  SqliteMetadataAccessObjectContainer container;
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  MetadataAccessObject* metadata_access_object =
+      container.GetMetadataAccessObject();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->InitMetadataSource());
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(
+                ParseTextProtoOrDie<ArtifactType>("name: 'test_type'"),
+                &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"pb(
+    custom_properties {
+      key: 'metrics'
+      value { struct_value { fields { key: 'a' value { number_value: 1 } } } }
+    }
+  )pb");
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  artifact.set_id(artifact_id);
+
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                " SELECT count(*) FROM `ArtifactProperty` "
+                " WHERE `string_value` IS NULL AND `byte_value` IS NOT NULL; ",
+                &record_set));
+  EXPECT_EQ(record_set.records(0).values(0), "1");
+
+  // An update with the same struct is a no-op, and a different one replaces
+  // the stored bytes.
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->UpdateArtifact(artifact));
+  (*artifact.mutable_custom_properties())["metrics"]
+      .mutable_struct_value()
+      ->mutable_fields()
+      ->at("a")
+      .set_number_value(2);
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->UpdateArtifact(artifact));
+
+  // A struct stored as a string by an earlier schema version.
+  google::protobuf::Struct legacy_struct;
+  (*legacy_struct.mutable_fields())["b"].set_string_value("c");
+  ASSERT_EQ(
+      absl::OkStatus(),
+      metadata_source->ExecuteQuery(
+          absl::Substitute(" INSERT INTO `ArtifactProperty` (`artifact_id`, "
+                           " `name`, `is_custom_property`, `string_value`) "
+                           " VALUES ($0, 'legacy', 1, '$1'); ",
+                           artifact_id, StructToString(legacy_struct)),
+          &record_set));
+
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object->FindArtifactsById(
+                                  {artifact_id}, &artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_THAT(artifacts[0].custom_properties().at("metrics"),
+              EqualsProto(artifact.custom_properties().at("metrics")));
+  EXPECT_THAT(artifacts[0].custom_properties().at("legacy").struct_value(),
+              EqualsProto(legacy_struct));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
 }  // namespace testing
 }  // namespace ml_metadata
@@ -14,16 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
+#include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
 #include <glog/logging.h>
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
 #include "sqlite3.h"
 
 namespace ml_metadata {
@@ -32,13 +38,63 @@ namespace {
 
 constexpr char kInMemoryConnection[] = ":memory:";
 constexpr char kBeginTransaction[] = "BEGIN;";
+constexpr char kBeginImmediateTransaction[] = "BEGIN IMMEDIATE;";
 constexpr char kCommitTransaction[] = "COMMIT;";
 constexpr char kRollbackTransaction[] = "ROLLBACK;";
 
+// Returns the column names of the results of a prepared statement.
+std::vector<std::string> GetColumnNames(sqlite3_stmt* stmt) {
+  const int column_num = sqlite3_column_count(stmt);
+  std::vector<std::string> column_names;
+  column_names.reserve(column_num);
+  for (int i = 0; i < column_num; i++) {
+    column_names.push_back(sqlite3_column_name(stmt, i));
+  }
+  return column_names;
+}
+
+// Appends the current row of a stepped statement to `results`. The cells keep
+// the storage class of the values, so integers and doubles are not formatted
+// to text.
+void AppendRow(sqlite3_stmt* stmt, TypedRecordSet* results) {
+  for (int i = 0; i < results->num_columns(); i++) {
+    switch (sqlite3_column_type(stmt, i)) {
+      case SQLITE_INTEGER:
+        results->AppendInt64(sqlite3_column_int64(stmt, i));
+        break;
+      case SQLITE_FLOAT:
+        results->AppendDouble(sqlite3_column_double(stmt, i));
+        break;
+      case SQLITE_NULL:
+        results->AppendNull();
+        break;
+      default:
+        results->AppendString(absl::string_view(
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, i)),
+            sqlite3_column_bytes(stmt, i)));
+    }
+  }
+}
+
+// Returns the status of a statement whose last sqlite3_step returned
+// `result_code`, which is not SQLITE_ROW.
+absl::Status StepResultToStatus(sqlite3* db, const int result_code,
+                                const std::string& query) {
+  if (result_code == SQLITE_BUSY || result_code == SQLITE_LOCKED) {
+    return absl::AbortedError(
+        "Concurrent writes aborted after max number of retries.");
+  } else if (result_code != SQLITE_DONE) {
+    return absl::InternalError(absl::StrCat(
+        "Error when executing query: ", sqlite3_errmsg(db), " query: ", query));
+  }
+  return absl::OkStatus();
+}
+
 // Returns a Sqlite3 connection flags based on the SqliteMetadataSourceConfig.
 // (see https://www.sqlite.org/c3ref/open.html for details)
 int GetConnectionFlag(const SqliteMetadataSourceConfig& config) {
   int result = SQLITE_OPEN_URI;
+  if (config.immutable()) return result | SQLITE_OPEN_READONLY;
   switch (config.connection_mode()) {
     case SqliteMetadataSourceConfig::READONLY: {
       result |= SQLITE_OPEN_READONLY;
@@ -58,6 +114,86 @@ int GetConnectionFlag(const SqliteMetadataSourceConfig& config) {
   return result;
 }
 
+// Returns the filename opened for `config`, which is a URI with the
+// `immutable=1` parameter if the config is immutable.
+// (see https://www.sqlite.org/uri.html for details)
+std::string GetConnectionFilename(const SqliteMetadataSourceConfig& config) {
+  std::string filename = config.filename_uri();
+  if (!config.immutable()) return filename;
+  if (!absl::StartsWith(filename, "file:")) {
+    filename = absl::StrCat("file:", filename);
+  }
+  absl::StrAppend(&filename, absl::StrContains(filename, '?') ? "&" : "?",
+                  "immutable=1");
+  return filename;
+}
+
+// Returns the PRAGMA statements setting the pragmas given in `config`.
+std::vector<std::string> GetPragmaStatements(
+    const SqliteMetadataSourceConfig& config) {
+  std::vector<std::string> statements;
+  switch (config.journal_mode()) {
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_DELETE:
+      statements.push_back("PRAGMA journal_mode = DELETE;");
+      break;
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_TRUNCATE:
+      statements.push_back("PRAGMA journal_mode = TRUNCATE;");
+      break;
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_PERSIST:
+      statements.push_back("PRAGMA journal_mode = PERSIST;");
+      break;
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_MEMORY:
+      statements.push_back("PRAGMA journal_mode = MEMORY;");
+      break;
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_WAL:
+      statements.push_back("PRAGMA journal_mode = WAL;");
+      break;
+    case SqliteMetadataSourceConfig::JOURNAL_MODE_OFF:
+      statements.push_back("PRAGMA journal_mode = OFF;");
+      break;
+    default:
+      break;
+  }
+  switch (config.synchronous()) {
+    case SqliteMetadataSourceConfig::SYNCHRONOUS_OFF:
+      statements.push_back("PRAGMA synchronous = OFF;");
+      break;
+    case SqliteMetadataSourceConfig::SYNCHRONOUS_NORMAL:
+      statements.push_back("PRAGMA synchronous = NORMAL;");
+      break;
+    case SqliteMetadataSourceConfig::SYNCHRONOUS_FULL:
+      statements.push_back("PRAGMA synchronous = FULL;");
+      break;
+    case SqliteMetadataSourceConfig::SYNCHRONOUS_EXTRA:
+      statements.push_back("PRAGMA synchronous = EXTRA;");
+      break;
+    default:
+      break;
+  }
+  if (config.has_cache_size()) {
+    statements.push_back(
+        absl::StrCat("PRAGMA cache_size = ", config.cache_size(), ";"));
+  }
+  if (config.has_mmap_size()) {
+    statements.push_back(
+        absl::StrCat("PRAGMA mmap_size = ", config.mmap_size(), ";"));
+  }
+  switch (config.temp_store()) {
+    case SqliteMetadataSourceConfig::TEMP_STORE_DEFAULT:
+      statements.push_back("PRAGMA temp_store = DEFAULT;");
+      break;
+    case SqliteMetadataSourceConfig::TEMP_STORE_FILE:
+      statements.push_back("PRAGMA temp_store = FILE;");
+      break;
+    case SqliteMetadataSourceConfig::TEMP_STORE_MEMORY:
+      statements.push_back("PRAGMA temp_store = MEMORY;");
+      break;
+    default:
+      break;
+  }
+  return statements;
+}
+
 // A set of options when waiting for table locks in a sqlite3_busy_handler.
 // see WaitThenRetry for details.
 struct WaitThenRetryOptions {
@@ -97,6 +233,47 @@ int WaitThenRetry(void* options, int retried_times) {
 
 }  // namespace
 
+// A ticket lock, which grants the turns in the order they are asked for, so
+// that a writer is not starved by the others.
+class SqliteMetadataSource::WriterQueue {
+ public:
+  // Returns the queue of the database at `filename_uri`, which is shared by
+  // all the connections of the process to it.
+  static std::shared_ptr<WriterQueue> Get(const std::string& filename_uri) {
+    static absl::Mutex registry_mu(absl::kConstInit);
+    static auto* registry =
+        new absl::flat_hash_map<std::string, std::weak_ptr<WriterQueue>>();
+    absl::MutexLock lock(&registry_mu);
+    std::weak_ptr<WriterQueue>& entry = (*registry)[filename_uri];
+    std::shared_ptr<WriterQueue> queue = entry.lock();
+    if (queue == nullptr) {
+      queue = std::make_shared<WriterQueue>();
+      entry = queue;
+    }
+    return queue;
+  }
+
+  // Blocks until it is the turn of the caller.
+  void Acquire() {
+    absl::MutexLock lock(&mu_);
+    const int64 ticket = next_ticket_++;
+    while (now_serving_ != ticket) turn_passed_.Wait(&mu_);
+  }
+
+  // Passes the turn to the next caller of Acquire.
+  void Release() {
+    absl::MutexLock lock(&mu_);
+    now_serving_++;
+    turn_passed_.SignalAll();
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::CondVar turn_passed_;
+  int64 next_ticket_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 now_serving_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 SqliteMetadataSource::SqliteMetadataSource(
     const SqliteMetadataSourceConfig& config)
     : config_(config) {
@@ -105,6 +282,12 @@ SqliteMetadataSource::SqliteMetadataSource(
   if (!config_.connection_mode())
     config_.set_connection_mode(
         SqliteMetadataSourceConfig::READWRITE_OPENCREATE);
+  // Each connection to `:memory:` opens its own database, so there is no other
+  // writer to wait for.
+  if (config_.single_writer() &&
+      config_.filename_uri() != kInMemoryConnection) {
+    writer_queue_ = WriterQueue::Get(config_.filename_uri());
+  }
 }
 
 SqliteMetadataSource::~SqliteMetadataSource() {
@@ -112,7 +295,11 @@ SqliteMetadataSource::~SqliteMetadataSource() {
 }
 
 absl::Status SqliteMetadataSource::ConnectImpl() {
-  if (sqlite3_open_v2(config_.filename_uri().c_str(), &db_,
+  if (config_.immutable() && config_.filename_uri() == kInMemoryConnection) {
+    return absl::InvalidArgumentError(
+        "An in-memory sqlite3 database cannot be immutable.");
+  }
+  if (sqlite3_open_v2(GetConnectionFilename(config_).c_str(), &db_,
                       GetConnectionFlag(config_), nullptr) != SQLITE_OK) {
     std::string error_message = sqlite3_errmsg(db_);
     sqlite3_close(db_);
@@ -122,11 +309,24 @@ absl::Status SqliteMetadataSource::ConnectImpl() {
   }
   // required to handle cases when tables are locked when executing queries
   sqlite3_busy_handler(db_, &WaitThenRetry, nullptr);
+  // The pragmas are set outside of transactions, as journal_mode and
+  // synchronous cannot change within one.
+  for (const std::string& statement : GetPragmaStatements(config_)) {
+    const absl::Status status = RunStatement(statement, nullptr);
+    if (!status.ok()) {
+      sqlite3_close(db_);
+      db_ = nullptr;
+      return absl::InternalError(absl::StrCat(
+          "Cannot set the pragmas of sqlite3 database: ", status.message()));
+    }
+  }
   return absl::OkStatus();
 }
 
 absl::Status SqliteMetadataSource::CloseImpl() {
   if (db_ != nullptr) {
+    // sqlite3_close fails with SQLITE_BUSY if any statement is not finalized.
+    FinalizePreparedStatements();
     int error_code = sqlite3_close(db_);
     if (error_code != SQLITE_OK) {
       return absl::InternalError(
@@ -134,6 +334,8 @@ absl::Status SqliteMetadataSource::CloseImpl() {
     }
     db_ = nullptr;
   }
+  // Closing the connection rolls back its open transaction.
+  MaybeReleaseWriterTurn();
   return absl::OkStatus();
 }
 
@@ -159,16 +361,142 @@ absl::Status SqliteMetadataSource::ExecuteQueryImpl(const std::string& query,
   return RunStatement(query, results);
 }
 
+absl::Status SqliteMetadataSource::GetOrPrepareStatement(
+    const std::string& query, sqlite3_stmt** stmt) {
+  const auto it = prepared_statements_.find(query);
+  if (it != prepared_statements_.end()) {
+    *stmt = it->second;
+    return absl::OkStatus();
+  }
+  if (prepared_statements_.size() >= kMaxNumPreparedStatements) {
+    FinalizePreparedStatements();
+  }
+  if (sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, stmt,
+                         nullptr) != SQLITE_OK) {
+    sqlite3_finalize(*stmt);
+    *stmt = nullptr;
+    return absl::InternalError(absl::StrCat("Error when preparing query: ",
+                                            sqlite3_errmsg(db_),
+                                            " query: ", query));
+  }
+  prepared_statements_[query] = *stmt;
+  return absl::OkStatus();
+}
+
+void SqliteMetadataSource::FinalizePreparedStatements() {
+  for (const auto& query_and_stmt : prepared_statements_) {
+    sqlite3_finalize(query_and_stmt.second);
+  }
+  prepared_statements_.clear();
+}
+
+absl::Status SqliteMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const PreparedStatementValue> values,
+    TypedRecordSet* results) {
+  sqlite3_stmt* stmt = nullptr;
+  MLMD_RETURN_IF_ERROR(GetOrPrepareStatement(query, &stmt));
+  if (sqlite3_bind_parameter_count(stmt) != values.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Prepared query has ", sqlite3_bind_parameter_count(stmt),
+        " placeholders, but ", values.size(), " values are given: ", query));
+  }
+  // The bound strings are owned by `values`, which outlive the statement
+  // execution. The bindings are cleared before returning.
+  for (int i = 0; i < values.size(); i++) {
+    const PreparedStatementValue& value = values[i];
+    if (absl::holds_alternative<int64>(value)) {
+      sqlite3_bind_int64(stmt, i + 1, absl::get<int64>(value));
+    } else if (absl::holds_alternative<double>(value)) {
+      sqlite3_bind_double(stmt, i + 1, absl::get<double>(value));
+    } else if (absl::holds_alternative<std::string>(value)) {
+      const std::string& text = absl::get<std::string>(value);
+      sqlite3_bind_text(stmt, i + 1, text.data(), text.size(), SQLITE_STATIC);
+    } else if (absl::holds_alternative<PreparedStatementBytes>(value)) {
+      const std::string& bytes = absl::get<PreparedStatementBytes>(value).bytes;
+      sqlite3_bind_blob(stmt, i + 1, bytes.data(), bytes.size(), SQLITE_STATIC);
+    } else {
+      sqlite3_bind_null(stmt, i + 1);
+    }
+  }
+  if (results != nullptr) results->Reset(GetColumnNames(stmt));
+  int result_code;
+  while ((result_code = sqlite3_step(stmt)) == SQLITE_ROW) {
+    // ignore the results of the query, if the user passes a nullptr.
+    if (results == nullptr) continue;
+    AppendRow(stmt, results);
+  }
+  const absl::Status status = StepResultToStatus(db_, result_code, query);
+  // Resets the statement, so that it can be reused and it releases the locks.
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  return status;
+}
+
+absl::Status SqliteMetadataSource::ExecuteStreamingQueryImpl(
+    const std::string& query, const int max_batch_size,
+    const RecordBatchCallback& callback) {
+  // Streamed queries are usually scans issued once per request, so they are
+  // not kept in the prepared statement cache.
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, &stmt,
+                         nullptr) != SQLITE_OK) {
+    sqlite3_finalize(stmt);
+    return absl::InternalError(absl::StrCat("Error when preparing query: ",
+                                            sqlite3_errmsg(db_),
+                                            " query: ", query));
+  }
+  const std::vector<std::string> column_names = GetColumnNames(stmt);
+  TypedRecordSet batch(column_names);
+  absl::Status status = absl::OkStatus();
+  int result_code;
+  while ((result_code = sqlite3_step(stmt)) == SQLITE_ROW) {
+    AppendRow(stmt, &batch);
+    if (batch.num_rows() == max_batch_size) {
+      status = callback(batch);
+      if (!status.ok()) break;
+      batch.Reset(column_names);
+    }
+  }
+  if (status.ok()) status = StepResultToStatus(db_, result_code, query);
+  if (status.ok() && batch.num_rows() > 0) status = callback(batch);
+  sqlite3_finalize(stmt);
+  return status;
+}
+
 absl::Status SqliteMetadataSource::BeginImpl() {
+  if (writer_queue_ == nullptr) return RunStatement(kBeginTransaction);
+  writer_queue_->Acquire();
+  holds_writer_turn_ = true;
+  // The write lock is taken at the beginning, so that the transaction does not
+  // fail in the middle on a lock held by a reader upgrading to a writer.
+  const absl::Status status = RunStatement(kBeginImmediateTransaction);
+  if (!status.ok()) MaybeReleaseWriterTurn();
+  return status;
+}
+
+absl::Status SqliteMetadataSource::BeginReadOnlyImpl() {
   return RunStatement(kBeginTransaction);
 }
 
+void SqliteMetadataSource::MaybeReleaseWriterTurn() {
+  // A failed COMMIT may keep the transaction open, in which case the turn is
+  // held until it is rolled back.
+  if (!holds_writer_turn_ || (db_ != nullptr && !sqlite3_get_autocommit(db_)))
+    return;
+  holds_writer_turn_ = false;
+  writer_queue_->Release();
+}
+
 absl::Status SqliteMetadataSource::CommitImpl() {
-  return RunStatement(kCommitTransaction);
+  const absl::Status status = RunStatement(kCommitTransaction);
+  MaybeReleaseWriterTurn();
+  return status;
 }
 
 absl::Status SqliteMetadataSource::RollbackImpl() {
-  return RunStatement(kRollbackTransaction);
+  const absl::Status status = RunStatement(kRollbackTransaction);
+  MaybeReleaseWriterTurn();
+  return status;
 }
 
 std::string SqliteMetadataSource::EscapeString(absl::string_view value) const {
@@ -15,8 +15,13 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "sqlite3.h"
 
@@ -27,7 +32,9 @@ namespace ml_metadata {
 // configured via a SqliteMetadataSourceConfig to use physical Sqlite3 and open
 // it in read only, read and write, and create if not exists modes.
 // This class is thread-unsafe. Multiple objects can be created by using the
-// same SqliteMetadataSourceConfig to use the same Sqlite3 database.
+// same SqliteMetadataSourceConfig to use the same Sqlite3 database. If the
+// config sets `single_writer`, the objects of a process using the same database
+// serialize their read-write transactions through a shared queue.
 class SqliteMetadataSource : public MetadataSource {
  public:
   explicit SqliteMetadataSource(const SqliteMetadataSourceConfig& config);
@@ -41,6 +48,10 @@ class SqliteMetadataSource : public MetadataSource {
   std::string EscapeString(absl::string_view value) const final;
 
  private:
+  // The queue of the read-write transactions on one database, shared by the
+  // connections of the process with `single_writer`.
+  class WriterQueue;
+
   // Creates an in memory db.
   // If error happens, Returns INTERNAL error.
   absl::Status ConnectImpl() final;
@@ -52,23 +63,60 @@ class SqliteMetadataSource : public MetadataSource {
   absl::Status ExecuteQueryImpl(const std::string& query,
                                 RecordSet* results) final;
 
+  // Executes a query with `?` placeholders using a cached sqlite3_stmt.
+  absl::Status ExecutePreparedQueryImpl(
+      const std::string& query,
+      absl::Span<const PreparedStatementValue> values,
+      TypedRecordSet* results) final;
+
+  // Executes a query and steps through its rows in batches.
+  absl::Status ExecuteStreamingQueryImpl(
+      const std::string& query, int max_batch_size,
+      const RecordBatchCallback& callback) final;
+
   // Commits a transaction.
   absl::Status CommitImpl() final;
 
   // Rollbacks a transaction
   absl::Status RollbackImpl() final;
 
-  // Begins a transaction
+  // Begins a transaction. With `single_writer`, it waits for the turn of the
+  // connection in the writer queue, and then takes the write lock.
   absl::Status BeginImpl() final;
 
+  // Begins a transaction without waiting in the writer queue.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Passes the turn to the next writer in the queue, if the connection holds
+  // it and its transaction is finished.
+  void MaybeReleaseWriterTurn();
+
   // Util methods to execute query.
   absl::Status RunStatement(const std::string& query, RecordSet* results);
 
+  // Returns the cached sqlite3_stmt of the `query`, and prepares it if it is
+  // not cached yet.
+  // Returns detailed INTERNAL error, if the query cannot be prepared.
+  absl::Status GetOrPrepareStatement(const std::string& query,
+                                     sqlite3_stmt** stmt);
+
+  // Finalizes all cached prepared statements.
+  void FinalizePreparedStatements();
+
   // The sqlite3 handle to a database.
   sqlite3* db_ = nullptr;
 
+  // The prepared statements of the current connection keyed by query text.
+  absl::flat_hash_map<std::string, sqlite3_stmt*> prepared_statements_;
+
   // A config including connection parameters.
   SqliteMetadataSourceConfig config_;
+
+  // The writer queue of the database, if `single_writer` is set.
+  std::shared_ptr<WriterQueue> writer_queue_;
+
+  // Whether the connection holds the turn in `writer_queue_`.
+  bool holds_writer_turn_ = false;
 };
 
 }  // namespace ml_metadata
@@ -14,14 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
+#include <atomic>
+#include <cstdio>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
 #include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
 
 namespace ml_metadata {
 namespace testing {
@@ -86,6 +95,236 @@ TEST(SqliteMetadataSourceExtendedTest, TestEscapeString) {
   EXPECT_EQ(metadata_source->EscapeString("'\"text\"'"), "''\"text\"''");
 }
 
+// Test the bytes are bound as blobs and read back unchanged, including the
+// NUL bytes, from both the prepared statements and the bytes literals.
+TEST(SqliteMetadataSourceExtendedTest, BindAndReadBytes) {
+  SqliteMetadataSourceContainer container;
+  container.InitTestSchema();
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  const std::string bytes("a\0\xff", 3);
+  RecordSet insert_results;
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->ExecutePreparedQuery(
+                                  "INSERT INTO t1 VALUES (1, ?)",
+                                  {PreparedStatementBytes{bytes}},
+                                  &insert_results));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                absl::StrCat("INSERT INTO t1 VALUES (2, ",
+                             metadata_source->BytesLiteral(bytes), ")"),
+                nullptr));
+  TypedRecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecutePreparedQuery(
+                "SELECT c2 FROM t1 ORDER BY c1", {}, &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_EQ(record_set.num_rows(), 2);
+  EXPECT_EQ(record_set.GetString(0, 0), bytes);
+  EXPECT_EQ(record_set.GetString(1, 0), bytes);
+}
+
+// Returns the value of `pragma`, e.g., journal_mode, on `metadata_source`.
+std::string GetPragma(MetadataSource* metadata_source,
+                      const std::string& pragma) {
+  RecordSet record_set;
+  CHECK_EQ(absl::OkStatus(), metadata_source->Begin());
+  CHECK_EQ(absl::OkStatus(),
+           metadata_source->ExecuteQuery(absl::StrCat("PRAGMA ", pragma, ";"),
+                                         &record_set));
+  CHECK_EQ(absl::OkStatus(), metadata_source->Commit());
+  CHECK_EQ(record_set.records_size(), 1);
+  return record_set.records(0).values(0);
+}
+
+TEST(SqliteMetadataSourceExtendedTest, ApplyPragmasAtConnect) {
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(
+      absl::StrCat("file:", ::testing::TempDir(), "/pragmas.db"));
+  config.set_journal_mode(SqliteMetadataSourceConfig::JOURNAL_MODE_WAL);
+  config.set_synchronous(SqliteMetadataSourceConfig::SYNCHRONOUS_NORMAL);
+  config.set_cache_size(-4096);
+  config.set_mmap_size(1 << 20);
+  config.set_temp_store(SqliteMetadataSourceConfig::TEMP_STORE_MEMORY);
+  SqliteMetadataSourceContainer container(config);
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+
+  EXPECT_EQ(GetPragma(metadata_source, "journal_mode"), "wal");
+  // NORMAL is 1 and MEMORY is 2.
+  EXPECT_EQ(GetPragma(metadata_source, "synchronous"), "1");
+  EXPECT_EQ(GetPragma(metadata_source, "cache_size"), "-4096");
+  EXPECT_EQ(GetPragma(metadata_source, "temp_store"), "2");
+}
+
+TEST(SqliteMetadataSourceExtendedTest, KeepDefaultPragmasIfNotGiven) {
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(
+      absl::StrCat("file:", ::testing::TempDir(), "/default_pragmas.db"));
+  SqliteMetadataSourceContainer container(config);
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+
+  EXPECT_EQ(GetPragma(metadata_source, "journal_mode"), "delete");
+}
+
+TEST(SqliteMetadataSourceExtendedTest, ReadImmutableDatabase) {
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "/immutable.db"));
+  std::remove(config.filename_uri().c_str());
+  {
+    SqliteMetadataSourceContainer writer(config);
+    writer.InitTestSchema();
+    MetadataSource* writer_source = writer.GetMetadataSource();
+    ASSERT_EQ(absl::OkStatus(), writer_source->Begin());
+    ASSERT_EQ(absl::OkStatus(),
+              writer_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1');",
+                                          nullptr));
+    ASSERT_EQ(absl::OkStatus(), writer_source->Commit());
+  }
+
+  // The immutable connection reads the file, but cannot write it.
+  config.set_immutable(true);
+  config.set_mmap_size(1 << 20);
+  SqliteMetadataSourceContainer reader(config);
+  MetadataSource* reader_source = reader.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), reader_source->Connect());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->Begin(TransactionMode::kReadOnly));
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->ExecuteQuery("SELECT c1 FROM t1;", &record_set));
+  EXPECT_EQ(record_set.records_size(), 1);
+  EXPECT_NE(absl::OkStatus(),
+            reader_source->ExecuteQuery("INSERT INTO t1 VALUES (2, 'v2');",
+                                        nullptr));
+  ASSERT_EQ(absl::OkStatus(), reader_source->Rollback());
+}
+
+TEST(SqliteMetadataSourceExtendedTest, InMemoryDatabaseCannotBeImmutable) {
+  SqliteMetadataSourceConfig config;
+  config.set_immutable(true);
+  SqliteMetadataSourceContainer container(config);
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(container.GetMetadataSource()->Connect()));
+}
+
+// Returns a config of a new WAL database file `name` whose writers wait in the
+// writer queue.
+SqliteMetadataSourceConfig GetSingleWriterConfig(const std::string& name) {
+  const std::string filename = absl::StrCat(::testing::TempDir(), "/", name);
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::remove(absl::StrCat(filename, suffix).c_str());
+  }
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(absl::StrCat("file:", filename));
+  config.set_journal_mode(SqliteMetadataSourceConfig::JOURNAL_MODE_WAL);
+  config.set_single_writer(true);
+  return config;
+}
+
+TEST(SqliteMetadataSourceExtendedTest, SingleWriterSerializesWriters) {
+  const SqliteMetadataSourceConfig config =
+      GetSingleWriterConfig("single_writer.db");
+  SqliteMetadataSourceContainer first(config);
+  first.InitTestSchema();
+  SqliteMetadataSourceContainer second(config);
+  ASSERT_EQ(absl::OkStatus(), second.GetMetadataSource()->Connect());
+
+  MetadataSource* first_source = first.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), first_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            first_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1');",
+                                       nullptr));
+  std::atomic<bool> second_committed(false);
+  std::thread second_writer([&second, &second_committed]() {
+    MetadataSource* second_source = second.GetMetadataSource();
+    CHECK_EQ(absl::OkStatus(), second_source->Begin());
+    CHECK_EQ(absl::OkStatus(),
+             second_source->ExecuteQuery("INSERT INTO t1 VALUES (2, 'v2');",
+                                         nullptr));
+    CHECK_EQ(absl::OkStatus(), second_source->Commit());
+    second_committed = true;
+  });
+  // The second writer waits for its turn instead of failing with Aborted
+  // after the retries of the busy handler.
+  absl::SleepFor(absl::Milliseconds(200));
+  EXPECT_FALSE(second_committed);
+  ASSERT_EQ(absl::OkStatus(), first_source->Commit());
+  second_writer.join();
+  EXPECT_TRUE(second_committed);
+
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(), first_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            first_source->ExecuteQuery("SELECT c1 FROM t1 ORDER BY c1;",
+                                       &record_set));
+  ASSERT_EQ(absl::OkStatus(), first_source->Commit());
+  ASSERT_EQ(record_set.records_size(), 2);
+  EXPECT_EQ(record_set.records(0).values(0), "1");
+  EXPECT_EQ(record_set.records(1).values(0), "2");
+}
+
+TEST(SqliteMetadataSourceExtendedTest, SingleWriterDoesNotBlockReaders) {
+  const SqliteMetadataSourceConfig config =
+      GetSingleWriterConfig("single_writer_readers.db");
+  SqliteMetadataSourceContainer writer(config);
+  writer.InitTestSchema();
+  SqliteMetadataSourceContainer reader(config);
+  MetadataSource* reader_source = reader.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), reader_source->Connect());
+
+  MetadataSource* writer_source = writer.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), writer_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            writer_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1');",
+                                        nullptr));
+  // The reader sees the last committed state while the writer is open.
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->Begin(TransactionMode::kReadOnly));
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->ExecuteQuery("SELECT c1 FROM t1;", &record_set));
+  ASSERT_EQ(absl::OkStatus(), reader_source->Commit());
+  EXPECT_EQ(record_set.records_size(), 0);
+  ASSERT_EQ(absl::OkStatus(), writer_source->Rollback());
+
+  // The rolled back writer passed its turn to the next one.
+  ASSERT_EQ(absl::OkStatus(), reader_source->Begin());
+  ASSERT_EQ(absl::OkStatus(), reader_source->Commit());
+}
+
+TEST(SqliteMetadataSourceExtendedTest, SnapshotReadDoesNotSeeLaterCommits) {
+  const SqliteMetadataSourceConfig config =
+      GetSingleWriterConfig("snapshot_read.db");
+  SqliteMetadataSourceContainer writer(config);
+  writer.InitTestSchema();
+  SqliteMetadataSourceContainer reader(config);
+  MetadataSource* reader_source = reader.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), reader_source->Connect());
+
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->Begin(TransactionMode::kSnapshotRead));
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->ExecuteQuery("SELECT c1 FROM t1;", &record_set));
+  EXPECT_EQ(record_set.records_size(), 0);
+
+  MetadataSource* writer_source = writer.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), writer_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            writer_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1');",
+                                        nullptr));
+  ASSERT_EQ(absl::OkStatus(), writer_source->Commit());
+
+  // The later queries of the snapshot read keep reading its snapshot.
+  record_set.Clear();
+  ASSERT_EQ(absl::OkStatus(),
+            reader_source->ExecuteQuery("SELECT c1 FROM t1;", &record_set));
+  EXPECT_EQ(record_set.records_size(), 0);
+  ASSERT_EQ(absl::OkStatus(), reader_source->Rollback());
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
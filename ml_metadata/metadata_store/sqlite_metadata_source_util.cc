@@ -16,14 +16,26 @@ limitations under the License.
 
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
 #include "sqlite3.h"
 
 namespace ml_metadata {
 
+// As the %q of sqlite3_mprintf, the single quotes are doubled and the string
+// ends at its first NUL byte. The strings without either are copied as is.
 std::string SqliteEscapeString(absl::string_view value) {
-  char* buffer = sqlite3_mprintf("%q", value.data());  // NOLINT
-  std::string result(buffer);
-  sqlite3_free(buffer);
+  size_t special = FindSqliteSpecialByte(value);
+  if (special == absl::string_view::npos) return std::string(value);
+  std::string result;
+  result.reserve(value.size() + 1);
+  while (special != absl::string_view::npos && value[special] == '\'') {
+    result.append(value.data(), special + 1);
+    result.push_back('\'');
+    value.remove_prefix(special + 1);
+    special = FindSqliteSpecialByte(value);
+  }
+  result.append(value.data(),
+                special == absl::string_view::npos ? value.size() : special);
   return result;
 }
 
@@ -21,7 +21,8 @@ limitations under the License.
 
 namespace ml_metadata {
 
-// Escapes strings having single quotes using built-in printf in Sqlite3 C API.
+// Escapes strings having single quotes as the %q of sqlite3_mprintf, i.e.,
+// doubles them and drops the bytes from the first NUL byte on.
 std::string SqliteEscapeString(absl::string_view value);
 
 // Converts the query results (`column_vals`) if any to a RecordSet (`results`).
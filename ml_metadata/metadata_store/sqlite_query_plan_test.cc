@@ -0,0 +1,163 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Checks the query plans of the templates of the SQLite query config.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/query_plan_test_suite.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+// Adds the table and index of a row of EXPLAIN QUERY PLAN to `plan`, e.g.,
+// "SEARCH Artifact USING INDEX idx_artifact_uri (uri=?)". A SCAN reads the
+// table, or one of its indices, in full, and so does a SEARCH through an
+// automatic index, which SQLite builds with a full scan as no index fits.
+// Older versions of SQLite name the tables "TABLE Artifact".
+void AddPlanDetail(absl::string_view detail, QueryPlan* plan) {
+  const bool is_scan = absl::ConsumePrefix(&detail, "SCAN ");
+  if (!is_scan && !absl::ConsumePrefix(&detail, "SEARCH ")) return;
+  absl::ConsumePrefix(&detail, "TABLE ");
+  const std::string table(detail.substr(0, detail.find(' ')));
+  // The rows of constants and subqueries are not tables.
+  if (table == "CONSTANT" || table == "SUBQUERY" ||
+      absl::StartsWith(table, "(")) {
+    return;
+  }
+  if (is_scan || absl::StrContains(detail, " AUTOMATIC ")) {
+    plan->full_scans.push_back(table);
+    if (!is_scan) return;
+  }
+  if (absl::StrContains(detail, " PRIMARY KEY")) {
+    plan->indices.push_back(absl::StrCat(table, ".PRIMARY"));
+    return;
+  }
+  const size_t index = detail.find("INDEX ");
+  if (index != absl::string_view::npos) {
+    const absl::string_view name = detail.substr(index + 6);
+    plan->indices.push_back(std::string(name.substr(0, name.find(' '))));
+  }
+}
+
+// SqliteQueryPlanContainer explains the queries with EXPLAIN QUERY PLAN on an
+// in-memory SqliteMetadataSource.
+class SqliteQueryPlanContainer : public QueryPlanContainer {
+ public:
+  SqliteQueryPlanContainer()
+      : metadata_source_(absl::make_unique<SqliteMetadataSource>(
+            SqliteMetadataSourceConfig())) {}
+  ~SqliteQueryPlanContainer() override = default;
+
+  MetadataSource* GetMetadataSource() override {
+    return metadata_source_.get();
+  }
+
+  const MetadataSourceQueryConfig& GetQueryConfig() override {
+    return util::GetSqliteMetadataSourceQueryConfig();
+  }
+
+  absl::Status AnalyzeTables() override {
+    return metadata_source_->ExecuteQuery("ANALYZE;", nullptr);
+  }
+
+  absl::Status ExplainQuery(const std::string& query,
+                            QueryPlan* plan) override {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(metadata_source_->ExecuteQuery(
+        absl::StrCat("EXPLAIN QUERY PLAN ", query), &record_set));
+    // The rows are (id, parent, notused, detail).
+    for (const RecordSet::Record& record : record_set.records()) {
+      const std::string& detail = record.values(record.values_size() - 1);
+      AddPlanDetail(detail, plan);
+      absl::StrAppend(&plan->description, detail, "; ");
+    }
+    return absl::OkStatus();
+  }
+
+  std::map<std::string, QueryPlanExpectation> GetExpectedPlans() override {
+    return {
+        // The listing queries, and the ones of the small tables.
+        {"select_all_types", {{"Type"}, {}}},
+        {"update_schema_version", {{"MLMDEnv"}, {}}},
+        {"select_migration_checkpoint", {{"MLMDEnvMigration"}, {}}},
+        {"select_id_list", {{"IdList"}, {}}},
+        // The background jobs, which read the tables in chunks.
+        {"select_idempotency_keys_created_before",
+         {{"MLMDIdempotencyKey"}, {}}},
+        {"select_event_ids_with_path_steps", {{"EventPath"}, {}}},
+        {"select_artifact_ids_without_properties_bytes", {{"Artifact"}, {}}},
+        {"select_execution_ids_without_properties_bytes", {{"Execution"}, {}}},
+        {"select_context_ids_without_properties_bytes", {{"Context"}, {}}},
+        // The recursive queries scan their working tables.
+        {"select_ancestor_contexts_by_context_id",
+         {{"A", "Ancestor"}, {"sqlite_autoindex_ParentContext_1"}}},
+        {"select_descendant_contexts_by_context_id",
+         {{"D", "Descendant"}, {"idx_parentcontext_parent_context_id"}}},
+        // The unique keys of Attribution and Association lead with the
+        // context, and there is no index of the artifacts and executions yet.
+        {"delete_attributions_by_artifacts_id", {{"Attribution"}, {}}},
+        {"select_attribution_by_artifact_id", {{"Attribution"}, {}}},
+        {"select_attributions_by_artifact_ids", {{"Attribution"}, {}}},
+        {"select_contexts_by_artifact_id", {{"C"}, {}}},
+        {"select_context_property_by_artifact_id", {{"P"}, {}}},
+        {"delete_associations_by_executions_id", {{"Association"}, {}}},
+        {"select_association_by_execution_id", {{"Association"}, {}}},
+        {"select_associations_by_execution_ids", {{"Association"}, {}}},
+        // The lookups which have a secondary index of their own.
+        {"select_type_by_name", {{}, {"idx_type_name"}}},
+        {"select_artifacts_by_uri", {{}, {"idx_artifact_uri"}}},
+        {"select_artifacts_by_uri_prefix", {{}, {"idx_artifact_uri"}}},
+        {"select_artifact_ids_by_type_id_updated_before",
+         {{}, {"idx_artifact_type_id_last_update_time"}}},
+        {"select_execution_ids_by_type_id_updated_before",
+         {{}, {"idx_execution_type_id_last_update_time"}}},
+        {"select_event_by_artifact_ids",
+         {{}, {"idx_event_artifact_id_covering"}}},
+        {"select_event_by_execution_ids",
+         {{}, {"idx_event_execution_id_covering"}}},
+        {"select_event_path_by_event_ids", {{}, {"idx_eventpath_event_id"}}},
+        {"select_parent_context_by_parent_context_id",
+         {{}, {"idx_parentcontext_parent_context_id"}}},
+    };
+  }
+
+ private:
+  std::unique_ptr<SqliteMetadataSource> metadata_source_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(SqliteQueryPlanTest, QueryPlanTestSuite,
+                         ::testing::Values([]() {
+                           return absl::make_unique<SqliteQueryPlanContainer>();
+                         }));
+
+}  // namespace testing
+}  // namespace ml_metadata
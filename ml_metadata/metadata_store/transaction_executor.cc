@@ -15,30 +15,247 @@ limitations under the License.
 
 #include "ml_metadata/metadata_store/transaction_executor.h"
 
+#include <algorithm>
+#include <string>
+
+#include <glog/logging.h>
+#include "absl/random/random.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "ml_metadata/util/metrics.h"
 #include "ml_metadata/util/return_utils.h"
+#include "ml_metadata/util/tracing.h"
 
 namespace ml_metadata {
+namespace {
+
+// The savepoint isolating each body of a batch. SAVEPOINT, ROLLBACK TO and
+// RELEASE have the same syntax in SQLite and MySQL.
+constexpr char kBatchSavepointQuery[] = "SAVEPOINT `mlmd_batch`";
+constexpr char kRollbackToBatchSavepointQuery[] =
+    "ROLLBACK TO SAVEPOINT `mlmd_batch`";
+constexpr char kReleaseBatchSavepointQuery[] =
+    "RELEASE SAVEPOINT `mlmd_batch`";
+
+// The metrics of the transactions of all executors of the process.
+Histogram* TransactionLatency() {
+  static Histogram* const histogram = MetricsRegistry::Global()->GetHistogram(
+      "mlmd_transaction_latency_seconds",
+      "The latency of the transactions, including their retries.");
+  return histogram;
+}
+
+Counter* TransactionRetries() {
+  static Counter* const counter = MetricsRegistry::Global()->GetCounter(
+      "mlmd_transaction_retries_total",
+      "The number of times an aborted transaction has been run again.");
+  return counter;
+}
+
+Counter* ExhaustedTransactionRetries() {
+  static Counter* const counter = MetricsRegistry::Global()->GetCounter(
+      "mlmd_transaction_exhausted_retries_total",
+      "The number of aborted transactions whose retries were exhausted.");
+  return counter;
+}
+
+absl::Status CheckConnected(
+    const std::vector<MetadataSource*>& metadata_sources) {
+  for (const MetadataSource* metadata_source : metadata_sources) {
+    if (metadata_source == nullptr || !metadata_source->is_connected()) {
+      return absl::FailedPreconditionError(
+          "To use ExecuteTransaction, the metadata_source should be created "
+          "and connected");
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Runs `query` on each of the `metadata_sources`.
+absl::Status ExecuteQueryOnAll(
+    const std::vector<MetadataSource*>& metadata_sources,
+    const std::string& query) {
+  for (MetadataSource* metadata_source : metadata_sources) {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(metadata_source->ExecuteQuery(query, &record_set));
+  }
+  return absl::OkStatus();
+}
+
+// Runs `txn_body` under the batch savepoint and sets its status to
+// `txn_body_status`. Returns the status of the savepoint queries.
+absl::Status ExecuteUnderSavepoint(
+    const std::function<absl::Status()>& txn_body,
+    const std::vector<MetadataSource*>& metadata_sources,
+    absl::Status* txn_body_status) {
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQueryOnAll(metadata_sources, kBatchSavepointQuery));
+  *txn_body_status = txn_body();
+  if (!txn_body_status->ok()) {
+    // The savepoint is kept by ROLLBACK TO, so it is released afterwards as
+    // well, e.g., SQLite would otherwise nest the savepoints of later bodies.
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQueryOnAll(metadata_sources, kRollbackToBatchSavepointQuery));
+    for (MetadataSource* metadata_source : metadata_sources) {
+      metadata_source->NoteRollbackToSavepoint();
+    }
+  }
+  return ExecuteQueryOnAll(metadata_sources, kReleaseBatchSavepointQuery);
+}
+
+}  // namespace
+
+RdbmsTransactionExecutor::RdbmsTransactionExecutor(
+    std::vector<MetadataSource*> metadata_sources,
+    const TransactionMode read_transaction_mode,
+    const TransactionRetryOptions& retry_options)
+    : metadata_sources_(std::move(metadata_sources)),
+      read_transaction_mode_(read_transaction_mode),
+      retry_options_(retry_options) {
+  CHECK_GE(retry_options_.max_num_retries, 0)
+      << "The max_num_retries must not be negative.";
+  CHECK_GE(retry_options_.backoff_multiplier, 1.0)
+      << "The backoff_multiplier must be at least 1.";
+  CHECK(!metadata_sources_.empty()) << "There must be a metadata_source.";
+}
 
 absl::Status RdbmsTransactionExecutor::Execute(
     const std::function<absl::Status()>& txn_body) const {
-  if (metadata_source_ == nullptr || !metadata_source_->is_connected()) {
-    return absl::FailedPreconditionError(
-        "To use ExecuteTransaction, the metadata_source should be created and "
-        "connected");
-  }
+  return ExecuteInMode(txn_body, TransactionMode::kReadWrite);
+}
 
-  MLMD_RETURN_IF_ERROR(metadata_source_->Begin());
+absl::Status RdbmsTransactionExecutor::ExecuteRead(
+    const std::function<absl::Status()>& txn_body) const {
+  return ExecuteInMode(txn_body, read_transaction_mode_);
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteInMode(
+    const std::function<absl::Status()>& txn_body,
+    const TransactionMode mode) const {
+  MLMD_RETURN_IF_ERROR(CheckConnected(metadata_sources_));
+
+  const absl::Status status =
+      RetryIfAborted([this, &txn_body, mode]() -> absl::Status {
+        MLMD_RETURN_IF_ERROR(Begin(mode));
+        return End(txn_body());
+      });
+  return NoteConnectionFailure(status);
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteBatch(
+    const std::vector<std::function<absl::Status()>>& txn_bodies,
+    std::vector<absl::Status>* txn_body_statuses) const {
+  MLMD_RETURN_IF_ERROR(CheckConnected(metadata_sources_));
 
-  absl::Status transaction_status = txn_body();
+  const absl::Status status =
+      RetryIfAborted([this, &txn_bodies, txn_body_statuses]() -> absl::Status {
+        MLMD_RETURN_IF_ERROR(Begin(TransactionMode::kReadWrite));
+
+        txn_body_statuses->assign(txn_bodies.size(), absl::OkStatus());
+        absl::Status transaction_status;
+        for (int i = 0; i < txn_bodies.size() && transaction_status.ok();
+             i++) {
+          // A savepoint query fails if the backend has aborted the
+          // transaction, e.g., when MySQL rolls back a deadlocked transaction.
+          transaction_status = ExecuteUnderSavepoint(
+              txn_bodies[i], metadata_sources_, &(*txn_body_statuses)[i]);
+        }
+        return End(transaction_status);
+      });
+  return NoteConnectionFailure(status);
+}
+
+absl::Status RdbmsTransactionExecutor::Begin(const TransactionMode mode) const {
+  const ScopedSpan span("Begin");
+  for (int i = 0; i < metadata_sources_.size(); i++) {
+    absl::Status status = metadata_sources_[i]->Begin(mode);
+    if (!status.ok()) {
+      for (int j = 0; j < i; j++) {
+        status.Update(metadata_sources_[j]->Rollback());
+      }
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RdbmsTransactionExecutor::End(
+    absl::Status transaction_status) const {
+  const ScopedSpan span(transaction_status.ok() ? "Commit" : "Rollback");
+  int num_committed = 0;
+  while (transaction_status.ok() &&
+         num_committed < metadata_sources_.size()) {
+    transaction_status = metadata_sources_[num_committed]->Commit();
+    if (transaction_status.ok()) {
+      num_committed++;
+    }
+  }
   if (transaction_status.ok()) {
-    transaction_status.Update(metadata_source_->Commit());
+    return transaction_status;
+  }
+  // Commit may fail as well, if so, we do rollback to allow the caller
+  // retry.
+  for (int i = num_committed; i < metadata_sources_.size(); i++) {
+    transaction_status.Update(metadata_sources_[i]->Rollback());
   }
-  // Commit may fail as well, if so, we do rollback to allow the caller retry.
-  if (!transaction_status.ok()) {
-    transaction_status.Update(metadata_source_->Rollback());
+  if (num_committed > 0) {
+    LOG(ERROR) << "The transaction is committed on " << num_committed
+               << " of " << metadata_sources_.size()
+               << " metadata sources only: " << transaction_status;
+    // The commit status is often ABORTED or UNAVAILABLE, and must not be
+    // retried, as the body would be written again on the committed sources.
+    return absl::DataLossError(absl::StrCat(
+        "The transaction is committed on ", num_committed, " of ",
+        metadata_sources_.size(),
+        " metadata sources only: ", transaction_status.ToString()));
   }
   return transaction_status;
 }
 
+absl::Status RdbmsTransactionExecutor::NoteConnectionFailure(
+    absl::Status status) const {
+  if (absl::IsInternal(status) || absl::IsUnavailable(status) ||
+      absl::IsDataLoss(status)) {
+    connection_failed_ = true;
+  }
+  return status;
+}
+
+absl::Status RdbmsTransactionExecutor::RetryIfAborted(
+    const std::function<absl::Status()>& run_transaction) const {
+  const ScopedLatencyRecorder latency_recorder(TransactionLatency());
+  // The spans of the attempts, e.g., of their queries, are its children.
+  ScopedSpan span("Transaction");
+  absl::Status status = run_transaction();
+  if (!absl::IsAborted(status)) {
+    return status;
+  }
+  absl::BitGen bit_gen;
+  absl::Duration max_backoff = retry_options_.initial_backoff;
+  int num_retries = 0;
+  for (; absl::IsAborted(status); num_retries++) {
+    // Full jitter: any backoff up to the current bound is as likely.
+    const absl::Duration backoff =
+        max_backoff * absl::Uniform(bit_gen, 0.0, 1.0);
+    if (num_retries >= retry_options_.max_num_retries ||
+        absl::Now() + backoff > retry_deadline_) {
+      num_exhausted_retries_++;
+      ExhaustedTransactionRetries()->Increment();
+      span.SetAttribute("retries", num_retries);
+      LOG(WARNING) << "Transaction aborted after " << num_retries
+                   << " retries: " << status;
+      return status;
+    }
+    absl::SleepFor(backoff);
+    max_backoff = std::min(max_backoff * retry_options_.backoff_multiplier,
+                           retry_options_.max_backoff);
+    num_retries_++;
+    TransactionRetries()->Increment();
+    status = run_transaction();
+  }
+  span.SetAttribute("retries", num_retries);
+  return status;
+}
+
 }  // namespace ml_metadata
@@ -16,11 +16,29 @@ limitations under the License.
 #ifndef THIRD_PARTY_ML_METADATA_METADATA_STORE_TRANSACTION_EXECUTOR_H_
 #define THIRD_PARTY_ML_METADATA_METADATA_STORE_TRANSACTION_EXECUTOR_H_
 
+#include <functional>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 
 namespace ml_metadata {
 
+// The policy retrying the transactions which return ABORTED, e.g., when MySQL
+// rolls back a deadlocked transaction.
+struct TransactionRetryOptions {
+  // The max number of retries after the first attempt. 0 disables retries.
+  int max_num_retries = 3;
+  // The backoff before a retry is drawn uniformly from [0, b], where b is
+  // `initial_backoff` for the first retry, and grows by `backoff_multiplier`
+  // with each later retry up to `max_backoff`. The jitter spreads out the
+  // retries of contending transactions, so that they do not collide again.
+  absl::Duration initial_backoff = absl::Milliseconds(10);
+  absl::Duration max_backoff = absl::Seconds(1);
+  double backoff_multiplier = 2.0;
+};
+
 // Pure virtual interface for MetadataStore to execute a transaction.
 //
 // Example usage:
@@ -34,35 +52,184 @@ class TransactionExecutor {
  public:
   virtual ~TransactionExecutor() = default;
 
-  // Runs txn_body and return the transaction status.
+  // Runs txn_body and return the transaction status. The transaction may be
+  // retried, so txn_body may run more than once and should reset its outputs.
   virtual absl::Status Execute(
       const std::function<absl::Status()>& txn_body) const = 0;
+
+  // Runs txn_body, which only reads, and returns the transaction status. By
+  // default, it runs like Execute.
+  virtual absl::Status ExecuteRead(
+      const std::function<absl::Status()>& txn_body) const {
+    return Execute(txn_body);
+  }
+
+  // Runs all `txn_bodies` in one transaction, so that they share a single
+  // commit, and sets the status of each body in `txn_body_statuses`. A failed
+  // body is undone without failing the others or the transaction.
+  // Returns UNIMPLEMENTED error, if the executor does not support batches.
+  // Returns the transaction status; if it is not OK, none of the bodies is
+  //   committed and `txn_body_statuses` is unspecified.
+  virtual absl::Status ExecuteBatch(
+      const std::vector<std::function<absl::Status()>>& txn_bodies,
+      std::vector<absl::Status>* txn_body_statuses) const {
+    return absl::UnimplementedError("ExecuteBatch is not supported.");
+  }
+
+  // Sets the time after which an aborted transaction is not retried anymore,
+  // e.g., the deadline of the request running it. By default, it is ignored.
+  virtual void SetRetryDeadline(absl::Time deadline) {}
+
+  // Returns true if a transaction has failed with an error which may have
+  // broken the connections to the metadata sources, so that they should not be
+  // reused, e.g., by a MetadataStorePool. By default, it is false.
+  virtual bool connection_failed() const { return false; }
 };
 
 // An implementation of TransactionExecutor.
 // It contains a method to execute the transaction body and tries to commit
 // the execution result in the database by using Begin/Commit/Rollback
-// methods in MetadataSource.
+// methods in MetadataSource. The reads run in transactions of
+// `read_transaction_mode`, by default read-only ones. The aborted transactions
+// are retried with `retry_options`.
+//
+// A transaction may span several metadata sources, e.g., the shards of a
+// ShardedMetadataAccessObject, which are committed one after another. There is
+// no two-phase commit, so a sharded commit is not atomic: if a later commit
+// fails, the earlier ones are kept, and the transaction returns DATA_LOSS
+// instead of being retried.
 class RdbmsTransactionExecutor : public TransactionExecutor {
  public:
   explicit RdbmsTransactionExecutor(MetadataSource* metadata_source)
-      : metadata_source_(metadata_source) {}
+      : RdbmsTransactionExecutor(metadata_source, TransactionMode::kReadOnly) {}
+  RdbmsTransactionExecutor(MetadataSource* metadata_source,
+                           TransactionMode read_transaction_mode)
+      : RdbmsTransactionExecutor(metadata_source, read_transaction_mode,
+                                 TransactionRetryOptions()) {}
+  RdbmsTransactionExecutor(MetadataSource* metadata_source,
+                           TransactionMode read_transaction_mode,
+                           const TransactionRetryOptions& retry_options)
+      : RdbmsTransactionExecutor(
+            std::vector<MetadataSource*>({metadata_source}),
+            read_transaction_mode, retry_options) {}
+  // The `metadata_sources` must not be empty and are not owned.
+  RdbmsTransactionExecutor(std::vector<MetadataSource*> metadata_sources,
+                           TransactionMode read_transaction_mode,
+                           const TransactionRetryOptions& retry_options);
   ~RdbmsTransactionExecutor() override = default;
 
   // Tries to commit the execution result of txn_body.
   // When the txn_body returns OK, it calls Commit, otherwise it calls Rollback.
+  // If the transaction is aborted, it is run again after a backoff, unless
+  // the retries are exhausted or the backoff would pass the retry deadline.
   //
   // Returns FAILED_PRECONDITION if metadata_source is null or not connected.
+  // Returns ABORTED error, if the last attempt is aborted.
+  // Returns DATA_LOSS error, if the transaction is committed on some but not
+  //   all of the metadata sources.
   // Returns detailed internal errors of transaction, i.e.
   //   Begin, Rollback and Commit.
   absl::Status Execute(
       const std::function<absl::Status()>& txn_body) const override;
 
+  // Same as Execute, but the transaction is begun in `read_transaction_mode`.
+  absl::Status ExecuteRead(
+      const std::function<absl::Status()>& txn_body) const override;
+
+  // Runs each of the txn_bodies under a savepoint, which is rolled back if
+  // the body fails, then commits the transaction. An aborted batch is retried
+  // as a whole, like in Execute.
+  //
+  // Returns FAILED_PRECONDITION if metadata_source is null or not connected.
+  // Returns detailed internal errors of transaction, i.e. Begin, Rollback,
+  //   Commit and the savepoint queries.
+  absl::Status ExecuteBatch(
+      const std::vector<std::function<absl::Status()>>& txn_bodies,
+      std::vector<absl::Status>* txn_body_statuses) const override;
+
+  void SetRetryDeadline(absl::Time deadline) override {
+    retry_deadline_ = deadline;
+  }
+
+  // The INTERNAL, UNAVAILABLE and DATA_LOSS errors of the transactions, e.g.,
+  // a lost connection or a failed commit, are taken as connection failures.
+  bool connection_failed() const override { return connection_failed_; }
+
+  // Returns the number of times an aborted transaction has been run again.
+  int64 num_retries() const { return num_retries_; }
+
+  // Returns the number of transactions which have returned ABORTED, as their
+  // retries were exhausted or would have passed the retry deadline.
+  int64 num_exhausted_retries() const { return num_exhausted_retries_; }
+
  private:
-  // The MetadataSource which has the connection to a database.
-  // It also supports other database primitves like Commit and Abort.
+  // Runs txn_body in a transaction of the given `mode`.
+  absl::Status ExecuteInMode(const std::function<absl::Status()>& txn_body,
+                             TransactionMode mode) const;
+
+  // Begins a transaction of the given `mode` on each metadata source. If one
+  // cannot be begun, the others are rolled back.
+  absl::Status Begin(TransactionMode mode) const;
+
+  // Commits the transaction on each metadata source if `transaction_status`
+  // is OK, otherwise or if a commit fails, rolls it back where it is not
+  // committed. Returns the transaction status, or DATA_LOSS if a commit fails
+  // after an earlier one has succeeded.
+  absl::Status End(absl::Status transaction_status) const;
+
+  // Calls `run_transaction` until it does not return ABORTED, following the
+  // retry options and deadline. Returns the status of the last call.
+  absl::Status RetryIfAborted(
+      const std::function<absl::Status()>& run_transaction) const;
+
+  // Notes whether `status` is a connection failure, and returns it.
+  absl::Status NoteConnectionFailure(absl::Status status) const;
+
+  // The MetadataSources which have the connections to the databases.
+  // They also support other database primitves like Commit and Abort.
   // Not owned by this class.
-  MetadataSource* metadata_source_;
+  const std::vector<MetadataSource*> metadata_sources_;
+  // The mode of the transactions run by ExecuteRead.
+  const TransactionMode read_transaction_mode_;
+  const TransactionRetryOptions retry_options_;
+  absl::Time retry_deadline_ = absl::InfiniteFuture();
+  // The retry counters. An executor is used by one thread at a time.
+  mutable int64 num_retries_ = 0;
+  mutable int64 num_exhausted_retries_ = 0;
+  // Whether a transaction has failed with a connection failure. It is kept
+  // once set.
+  mutable bool connection_failed_ = false;
+};
+
+// A TransactionExecutor running the reads in a read-only transaction which is
+// already open on the metadata sources, e.g., by
+// MetadataStore::BeginPinnedRead, so that consecutive reads see the same
+// snapshot. It neither begins nor ends transactions, and refuses the writes.
+class PinnedReadTransactionExecutor : public TransactionExecutor {
+ public:
+  PinnedReadTransactionExecutor() = default;
+  ~PinnedReadTransactionExecutor() override = default;
+
+  // Returns FAILED_PRECONDITION error, as the open transaction only reads.
+  absl::Status Execute(
+      const std::function<absl::Status()>& txn_body) const override {
+    return absl::FailedPreconditionError(
+        "Cannot write in a pinned read-only transaction.");
+  }
+
+  // Runs txn_body in the open transaction and returns its status.
+  absl::Status ExecuteRead(
+      const std::function<absl::Status()>& txn_body) const override {
+    return txn_body();
+  }
+
+  // Returns FAILED_PRECONDITION error, as the open transaction only reads.
+  absl::Status ExecuteBatch(
+      const std::vector<std::function<absl::Status()>>& txn_bodies,
+      std::vector<absl::Status>* txn_body_statuses) const override {
+    return absl::FailedPreconditionError(
+        "Cannot write in a pinned read-only transaction.");
+  }
 };
 
 }  // namespace ml_metadata
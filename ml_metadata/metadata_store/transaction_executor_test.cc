@@ -16,21 +16,28 @@ limitations under the License.
 #include "ml_metadata/metadata_store/transaction_executor.h"
 
 #include <functional>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 
 namespace ml_metadata {
 namespace {
 
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::InSequence;
 using ::testing::Return;
 
 class MockMetadataSource : public MetadataSource {
  public:
   MOCK_METHOD(absl::Status, BeginImpl, (), (override));
+  MOCK_METHOD(absl::Status, BeginReadOnlyImpl, (), (override));
   MOCK_METHOD(absl::Status, ConnectImpl, (), (override));
   MOCK_METHOD(absl::Status, CloseImpl, (), (override));
   MOCK_METHOD(absl::Status, RollbackImpl, (), (override));
@@ -61,6 +68,15 @@ const std::function<absl::Status()> kFuncReturnOk = []() -> absl::Status {
 const std::function<absl::Status()> kFuncReturnInternalError =
     []() -> absl::Status { return kTfFuncErrorStatus; };
 
+// Retries without waiting long in the tests.
+TransactionRetryOptions FastRetryOptions(int max_num_retries) {
+  TransactionRetryOptions retry_options;
+  retry_options.max_num_retries = max_num_retries;
+  retry_options.initial_backoff = absl::Milliseconds(1);
+  retry_options.max_backoff = absl::Milliseconds(2);
+  return retry_options;
+}
+
 TEST(TransactionExecutorTest, ReturnOkWhenBothTxnBodyAndCommitOk) {
   MockMetadataSource mock_metadata_source;
   // These calls should be called once and only once.
@@ -163,5 +179,243 @@ TEST(TransactionExecutorTest, ReturnConnectErrorWhenConnectFails) {
                 " created and connected"));
 }
 
+TEST(TransactionExecutorTest, ExecuteBatchRollsBackFailedTxnBodyToSavepoint) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  {
+    InSequence sequence;
+    EXPECT_CALL(mock_metadata_source, BeginImpl())
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT `mlmd_batch`", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT `mlmd_batch`", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT `mlmd_batch`", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("ROLLBACK TO SAVEPOINT `mlmd_batch`", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT `mlmd_batch`", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source, CommitImpl())
+        .WillOnce(Return(absl::OkStatus()));
+  }
+  EXPECT_CALL(mock_metadata_source, RollbackImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+
+  std::vector<absl::Status> txn_body_statuses;
+  EXPECT_EQ(absl::OkStatus(),
+            txn_executor.ExecuteBatch({kFuncReturnOk, kFuncReturnInternalError},
+                                      &txn_body_statuses));
+  EXPECT_THAT(txn_body_statuses,
+              ElementsAre(absl::OkStatus(), kTfFuncErrorStatus));
+  // The rollback is noted, so that the loaded IdList table is not reused.
+  EXPECT_EQ(mock_metadata_source.num_savepoint_rollbacks(), 1);
+}
+
+TEST(TransactionExecutorTest, ExecuteBatchRollsBackWhenSavepointFails) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  const absl::Status aborted_status = absl::AbortedError("Fake deadlock.");
+  EXPECT_CALL(mock_metadata_source,
+              ExecuteQueryImpl("SAVEPOINT `mlmd_batch`", _))
+      .WillOnce(Return(aborted_status));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source,
+                                        TransactionMode::kReadOnly,
+                                        FastRetryOptions(0));
+
+  std::vector<absl::Status> txn_body_statuses;
+  EXPECT_EQ(txn_executor.ExecuteBatch({kFuncReturnOk}, &txn_body_statuses),
+            aborted_status);
+}
+
+TEST(TransactionExecutorTest, ExecuteReadBeginsReadOnlyTransaction) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginReadOnlyImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+
+  EXPECT_EQ(absl::OkStatus(), txn_executor.ExecuteRead(kFuncReturnOk));
+}
+
+TEST(TransactionExecutorTest, ExecuteReadInAutocommitSkipsBeginAndCommit) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl("SELECT 1", _))
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
+  EXPECT_CALL(mock_metadata_source, BeginReadOnlyImpl()).Times(0);
+  EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(0);
+  EXPECT_CALL(mock_metadata_source, RollbackImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source,
+                                        TransactionMode::kAutocommit);
+  const std::function<absl::Status()> select = [&mock_metadata_source]() {
+    RecordSet record_set;
+    return mock_metadata_source.ExecuteQuery("SELECT 1", &record_set);
+  };
+
+  EXPECT_EQ(absl::OkStatus(), txn_executor.ExecuteRead(select));
+  // A failed read only closes the transaction as well.
+  EXPECT_EQ(txn_executor.ExecuteRead([&select]() -> absl::Status {
+    select().IgnoreError();
+    return kTfFuncErrorStatus;
+  }),
+            kTfFuncErrorStatus);
+  // The writes still run in read-write transactions.
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_EQ(absl::OkStatus(), txn_executor.Execute(kFuncReturnOk));
+}
+
+TEST(TransactionExecutorTest, RetryAbortedTransaction) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::AbortedError("Fake deadlock.")))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source,
+                                        TransactionMode::kReadOnly,
+                                        FastRetryOptions(2));
+  int num_runs = 0;
+  EXPECT_EQ(absl::OkStatus(),
+            txn_executor.Execute([&num_runs]() -> absl::Status {
+              num_runs++;
+              return absl::OkStatus();
+            }));
+  EXPECT_EQ(num_runs, 2);
+  EXPECT_EQ(txn_executor.num_retries(), 1);
+  EXPECT_EQ(txn_executor.num_exhausted_retries(), 0);
+}
+
+TEST(TransactionExecutorTest, ReturnAbortedWhenRetriesAreExhausted) {
+  MockMetadataSource mock_metadata_source;
+  const absl::Status aborted_status = absl::AbortedError("Fake deadlock.");
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(0);
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::OkStatus()));
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source,
+                                        TransactionMode::kReadOnly,
+                                        FastRetryOptions(2));
+  EXPECT_EQ(txn_executor.Execute(
+                [&aborted_status]() -> absl::Status { return aborted_status; }),
+            aborted_status);
+  EXPECT_EQ(txn_executor.num_retries(), 2);
+  EXPECT_EQ(txn_executor.num_exhausted_retries(), 1);
+}
+
+TEST(TransactionExecutorTest, DoNotRetryPastDeadline) {
+  MockMetadataSource mock_metadata_source;
+  const absl::Status aborted_status = absl::AbortedError("Fake deadlock.");
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source,
+                                        TransactionMode::kReadOnly,
+                                        FastRetryOptions(2));
+  // Any backoff would pass the deadline.
+  txn_executor.SetRetryDeadline(absl::Now() - absl::Seconds(1));
+  EXPECT_EQ(txn_executor.Execute(
+                [&aborted_status]() -> absl::Status { return aborted_status; }),
+            aborted_status);
+  EXPECT_EQ(txn_executor.num_retries(), 0);
+  EXPECT_EQ(txn_executor.num_exhausted_retries(), 1);
+}
+
+TEST(TransactionExecutorTest, DoNotRetryPartiallyCommittedTransaction) {
+  MockMetadataSource committed_source;
+  MockMetadataSource aborted_source;
+  for (MockMetadataSource* source : {&committed_source, &aborted_source}) {
+    EXPECT_CALL(*source, ConnectImpl()).WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(*source, BeginImpl()).WillOnce(Return(absl::OkStatus()));
+    ASSERT_EQ(absl::OkStatus(), source->Connect());
+  }
+  EXPECT_CALL(committed_source, CommitImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(aborted_source, CommitImpl())
+      .WillOnce(Return(absl::AbortedError("Fake deadlock.")));
+  EXPECT_CALL(aborted_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+
+  RdbmsTransactionExecutor txn_executor({&committed_source, &aborted_source},
+                                        TransactionMode::kReadOnly,
+                                        FastRetryOptions(2));
+  int num_runs = 0;
+  EXPECT_TRUE(absl::IsDataLoss(
+      txn_executor.Execute([&num_runs]() -> absl::Status {
+        num_runs++;
+        return absl::OkStatus();
+      })));
+  EXPECT_EQ(num_runs, 1);
+  EXPECT_EQ(txn_executor.num_retries(), 0);
+}
+
+TEST(TransactionExecutorTest, NoteConnectionFailure) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .WillOnce(Return(absl::OkStatus()))
+      .WillOnce(Return(absl::UnavailableError("Lost connection.")));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+
+  // A failed body does not fail the connection, unless its error may.
+  EXPECT_TRUE(absl::IsNotFound(txn_executor.Execute(
+      []() -> absl::Status { return absl::NotFoundError("Not found."); })));
+  EXPECT_FALSE(txn_executor.connection_failed());
+  EXPECT_TRUE(absl::IsUnavailable(txn_executor.Execute(kFuncReturnOk)));
+  EXPECT_TRUE(txn_executor.connection_failed());
+}
 }  // namespace
 }  // namespace ml_metadata
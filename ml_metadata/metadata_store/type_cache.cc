@@ -0,0 +1,46 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/type_cache.h"
+
+#include <glog/logging.h>
+
+namespace ml_metadata {
+
+TypeCache::TypeCache(const int max_num_types) : max_num_types_(max_num_types) {
+  CHECK_GT(max_num_types_, 0) << "The max_num_types must be positive.";
+}
+
+int64 TypeCache::generation() const {
+  absl::MutexLock lock(&mu_);
+  return generation_;
+}
+
+void TypeCache::Invalidate() {
+  absl::MutexLock lock(&mu_);
+  generation_++;
+  entries_ = {};
+}
+
+int64 TypeCache::num_hits() const {
+  absl::MutexLock lock(&mu_);
+  return num_hits_;
+}
+
+int64 TypeCache::num_misses() const {
+  absl::MutexLock lock(&mu_);
+  return num_misses_;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,176 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+#define ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A thread-safe cache of the ArtifactTypes, ExecutionTypes and ContextTypes
+// stored in one database, keyed by type id and by type name and version. It
+// lets the MetadataAccessObjects connected to the same database, e.g., the
+// ones of a MetadataStorePool, share the types they have read, as types are
+// rarely changed compared to the nodes that reference them.
+//
+// The entries are also keyed by the schema version of the connection, so that
+// connections with different schema versions do not share the types.
+//
+// Every type change must call Invalidate(), which drops all entries and moves
+// the cache to the next generation. A type read when the cache was at an
+// earlier generation is not inserted, as it may be stale.
+//
+// The changes of types made by other processes are not observed, so a cache
+// should only be used if all type changes go through the stores sharing it.
+class TypeCache {
+ public:
+  // Once the number of cached types of a kind reaches `max_num_types`, the
+  // types of that kind are dropped before inserting another one.
+  explicit TypeCache(int max_num_types = 10000);
+
+  // Disallow copy and assign.
+  TypeCache(const TypeCache&) = delete;
+  TypeCache& operator=(const TypeCache&) = delete;
+
+  // Returns the current generation, which should be read before reading a type
+  // from the database and passed to Insert().
+  int64 generation() const;
+
+  // Finds a cached type by its id. `Type` is one of {ArtifactType,
+  // ExecutionType, ContextType}.
+  // Returns false, if the type is not cached.
+  template <typename Type>
+  bool FindById(int64 schema_version, int64 type_id, Type* type);
+
+  // Finds a cached type by its name and version. A missing or empty version
+  // refers to the type without version.
+  // Returns false, if the type is not cached.
+  template <typename Type>
+  bool FindByNameAndVersion(int64 schema_version, absl::string_view name,
+                            absl::optional<absl::string_view> version,
+                            Type* type);
+
+  // Caches a type read from the database when the cache was at `generation`.
+  // Does nothing if the cache has been invalidated since then.
+  template <typename Type>
+  void Insert(int64 schema_version, int64 generation, const Type& type);
+
+  // Drops all entries and moves to the next generation.
+  void Invalidate();
+
+  // The number of lookups that found or did not find a cached type.
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  // (schema_version, type id)
+  using IdKey = std::pair<int64, int64>;
+  // (schema_version, type name, type version or empty)
+  using NameKey = std::tuple<int64, std::string, std::string>;
+
+  template <typename Type>
+  struct Entries {
+    absl::flat_hash_map<IdKey, Type> types_by_id;
+    absl::flat_hash_map<NameKey, int64> ids_by_name;
+  };
+
+  template <typename Type>
+  Entries<Type>& entries() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return std::get<Entries<Type>>(entries_);
+  }
+
+  // Returns the cached type with the id, or nullptr, and counts the lookup.
+  template <typename Type>
+  const Type* FindByIdLocked(IdKey key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int max_num_types_;
+  mutable absl::Mutex mu_;
+  int64 generation_ ABSL_GUARDED_BY(mu_) = 0;
+  std::tuple<Entries<ArtifactType>, Entries<ExecutionType>,
+             Entries<ContextType>>
+      entries_ ABSL_GUARDED_BY(mu_);
+  int64 num_hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 num_misses_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+template <typename Type>
+const Type* TypeCache::FindByIdLocked(const IdKey key) {
+  const auto& types_by_id = entries<Type>().types_by_id;
+  const auto it = types_by_id.find(key);
+  if (it == types_by_id.end()) {
+    num_misses_++;
+    return nullptr;
+  }
+  num_hits_++;
+  return &it->second;
+}
+
+template <typename Type>
+bool TypeCache::FindById(const int64 schema_version, const int64 type_id,
+                         Type* type) {
+  absl::MutexLock lock(&mu_);
+  const Type* cached_type = FindByIdLocked<Type>({schema_version, type_id});
+  if (cached_type == nullptr) return false;
+  *type = *cached_type;
+  return true;
+}
+
+template <typename Type>
+bool TypeCache::FindByNameAndVersion(
+    const int64 schema_version, const absl::string_view name,
+    const absl::optional<absl::string_view> version, Type* type) {
+  absl::MutexLock lock(&mu_);
+  const auto& ids_by_name = entries<Type>().ids_by_name;
+  const auto it = ids_by_name.find(
+      NameKey(schema_version, std::string(name),
+              std::string(version.value_or(absl::string_view()))));
+  if (it == ids_by_name.end()) {
+    num_misses_++;
+    return false;
+  }
+  const Type* cached_type = FindByIdLocked<Type>({schema_version, it->second});
+  if (cached_type == nullptr) return false;
+  *type = *cached_type;
+  return true;
+}
+
+template <typename Type>
+void TypeCache::Insert(const int64 schema_version, const int64 generation,
+                       const Type& type) {
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) return;
+  Entries<Type>& type_entries = entries<Type>();
+  if (type_entries.types_by_id.size() >= max_num_types_) {
+    type_entries.types_by_id.clear();
+    type_entries.ids_by_name.clear();
+  }
+  type_entries.types_by_id[{schema_version, type.id()}] = type;
+  type_entries.ids_by_name[NameKey(schema_version, type.name(),
+                                   type.version())] = type.id();
+}
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
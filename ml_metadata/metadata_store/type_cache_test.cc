@@ -0,0 +1,104 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/type_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+constexpr int64 kSchemaVersion = 7;
+
+TEST(TypeCacheTest, FindByIdAndByNameAndVersion) {
+  TypeCache cache;
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    id: 1 name: 'a' version: 'v1' properties { key: 'p' value: INT }
+  )");
+  const ArtifactType unversioned_type =
+      ParseTextProtoOrDie<ArtifactType>("id: 2 name: 'a'");
+  cache.Insert(kSchemaVersion, cache.generation(), type);
+  cache.Insert(kSchemaVersion, cache.generation(), unversioned_type);
+
+  ArtifactType got_type;
+  ASSERT_TRUE(cache.FindById(kSchemaVersion, 1, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  ASSERT_TRUE(cache.FindByNameAndVersion(kSchemaVersion, "a", "v1", &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  ASSERT_TRUE(cache.FindByNameAndVersion(kSchemaVersion, "a", absl::nullopt,
+                                         &got_type));
+  EXPECT_THAT(got_type, EqualsProto(unversioned_type));
+  ASSERT_TRUE(cache.FindByNameAndVersion(kSchemaVersion, "a", "", &got_type));
+  EXPECT_THAT(got_type, EqualsProto(unversioned_type));
+  EXPECT_EQ(cache.num_hits(), 4);
+  EXPECT_EQ(cache.num_misses(), 0);
+}
+
+TEST(TypeCacheTest, MissOtherKindsAndSchemaVersions) {
+  TypeCache cache;
+  cache.Insert(kSchemaVersion, cache.generation(),
+               ParseTextProtoOrDie<ArtifactType>("id: 1 name: 'a'"));
+
+  ExecutionType execution_type;
+  EXPECT_FALSE(cache.FindById(kSchemaVersion, 1, &execution_type));
+  ArtifactType artifact_type;
+  EXPECT_FALSE(cache.FindById(kSchemaVersion - 1, 1, &artifact_type));
+  EXPECT_FALSE(cache.FindByNameAndVersion(kSchemaVersion, "a", "v1",
+                                          &artifact_type));
+  EXPECT_EQ(cache.num_hits(), 0);
+  EXPECT_EQ(cache.num_misses(), 3);
+}
+
+TEST(TypeCacheTest, InvalidateDropsTypesAndStaleInserts) {
+  TypeCache cache;
+  const int64 generation = cache.generation();
+  cache.Insert(kSchemaVersion, generation,
+               ParseTextProtoOrDie<ContextType>("id: 1 name: 'a'"));
+  cache.Invalidate();
+  EXPECT_NE(cache.generation(), generation);
+
+  ContextType type;
+  EXPECT_FALSE(cache.FindById(kSchemaVersion, 1, &type));
+  // A type read before the invalidation is not cached.
+  cache.Insert(kSchemaVersion, generation,
+               ParseTextProtoOrDie<ContextType>("id: 1 name: 'a'"));
+  EXPECT_FALSE(cache.FindById(kSchemaVersion, 1, &type));
+  cache.Insert(kSchemaVersion, cache.generation(),
+               ParseTextProtoOrDie<ContextType>("id: 1 name: 'b'"));
+  ASSERT_TRUE(cache.FindById(kSchemaVersion, 1, &type));
+  EXPECT_EQ(type.name(), "b");
+}
+
+TEST(TypeCacheTest, DropTypesAtMaxNumTypes) {
+  TypeCache cache(/*max_num_types=*/2);
+  for (int64 id = 1; id <= 3; id++) {
+    ArtifactType type;
+    type.set_id(id);
+    type.set_name(absl::StrCat("type_", id));
+    cache.Insert(kSchemaVersion, cache.generation(), type);
+  }
+  ArtifactType type;
+  EXPECT_FALSE(cache.FindById(kSchemaVersion, 1, &type));
+  EXPECT_TRUE(cache.FindById(kSchemaVersion, 3, &type));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,206 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/typed_record_set.h"
+
+#include <glog/logging.h>
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/sql_text_util.h"
+
+namespace ml_metadata {
+namespace {
+
+// Formats a double with the fewest digits that parse back to the same value.
+std::string FormatDouble(const double value) {
+  std::string text = absl::StrFormat("%.15g", value);
+  double parsed_value;
+  if (!absl::SimpleAtod(text, &parsed_value) || parsed_value != value) {
+    text = absl::StrFormat("%.17g", value);
+  }
+  return text;
+}
+
+}  // namespace
+
+TypedRecordSet::TypedRecordSet(std::vector<std::string> column_names) {
+  Reset(std::move(column_names));
+}
+
+void TypedRecordSet::Reset(std::vector<std::string> column_names) {
+  column_names_ = std::move(column_names);
+  columns_.clear();
+  columns_.resize(column_names_.size());
+  next_column_ = 0;
+  string_arena_.clear();
+}
+
+std::vector<TypedRecordSet::Cell>& TypedRecordSet::NextColumn() {
+  CHECK(!columns_.empty()) << "Cannot append a cell to a record set without "
+                              "columns.";
+  std::vector<Cell>& column = columns_[next_column_];
+  next_column_ = (next_column_ + 1) % columns_.size();
+  return column;
+}
+
+void TypedRecordSet::AppendNull() {
+  Cell cell;
+  cell.type = CellType::kNull;
+  NextColumn().push_back(cell);
+}
+
+void TypedRecordSet::AppendInt64(const int64 value) {
+  Cell cell;
+  cell.type = CellType::kInt64;
+  cell.int64_value = value;
+  NextColumn().push_back(cell);
+}
+
+void TypedRecordSet::AppendDouble(const double value) {
+  Cell cell;
+  cell.type = CellType::kDouble;
+  cell.double_value = value;
+  NextColumn().push_back(cell);
+}
+
+void TypedRecordSet::AppendString(const absl::string_view value) {
+  Cell cell;
+  cell.type = CellType::kString;
+  cell.string_offset = string_arena_.size();
+  cell.string_size = value.size();
+  string_arena_.append(value.data(), value.size());
+  NextColumn().push_back(cell);
+}
+
+void TypedRecordSet::AppendRows(const TypedRecordSet& other) {
+  CHECK_EQ(num_columns(), other.num_columns());
+  CHECK_EQ(next_column_, 0) << "Cannot append rows to an incomplete row.";
+  const size_t string_offset = string_arena_.size();
+  for (int column = 0; column < num_columns(); column++) {
+    for (Cell cell : other.columns_[column]) {
+      if (cell.type == CellType::kString) cell.string_offset += string_offset;
+      columns_[column].push_back(cell);
+    }
+  }
+  string_arena_.append(other.string_arena_);
+}
+
+const TypedRecordSet::Cell& TypedRecordSet::cell(const int row,
+                                                 const int column) const {
+  CHECK_LT(column, columns_.size());
+  CHECK_LT(row, num_rows());
+  return columns_[column][row];
+}
+
+bool TypedRecordSet::GetInt64(const int row, const int column,
+                              int64* value) const {
+  const Cell& c = cell(row, column);
+  switch (c.type) {
+    case CellType::kInt64:
+      *value = c.int64_value;
+      return true;
+    case CellType::kString:
+      return ParseDecimalInt64(GetString(row, column), value);
+    default:
+      return false;
+  }
+}
+
+bool TypedRecordSet::GetDouble(const int row, const int column,
+                               double* value) const {
+  const Cell& c = cell(row, column);
+  switch (c.type) {
+    case CellType::kDouble:
+      *value = c.double_value;
+      return true;
+    case CellType::kInt64:
+      *value = static_cast<double>(c.int64_value);
+      return true;
+    case CellType::kString:
+      return absl::SimpleAtod(GetString(row, column), value);
+    default:
+      return false;
+  }
+}
+
+bool TypedRecordSet::GetBool(const int row, const int column,
+                             bool* value) const {
+  const Cell& c = cell(row, column);
+  switch (c.type) {
+    case CellType::kInt64:
+      *value = c.int64_value != 0;
+      return true;
+    case CellType::kString:
+      return absl::SimpleAtob(GetString(row, column), value);
+    default:
+      return false;
+  }
+}
+
+absl::string_view TypedRecordSet::GetString(const int row,
+                                            const int column) const {
+  const Cell& c = cell(row, column);
+  CHECK(c.type == CellType::kString) << "The cell is not a string cell.";
+  return absl::string_view(string_arena_).substr(c.string_offset,
+                                                 c.string_size);
+}
+
+std::string TypedRecordSet::FormatCell(const int row, const int column) const {
+  const Cell& c = cell(row, column);
+  switch (c.type) {
+    case CellType::kInt64:
+      return absl::StrCat(c.int64_value);
+    case CellType::kDouble:
+      return FormatDouble(c.double_value);
+    case CellType::kString:
+      return std::string(GetString(row, column));
+    default:
+      return kMetadataSourceNull;
+  }
+}
+
+void TypedRecordSet::ToRecordSet(RecordSet* record_set) const {
+  record_set->Clear();
+  for (const std::string& column_name : column_names_) {
+    record_set->add_column_names(column_name);
+  }
+  record_set->mutable_records()->Reserve(num_rows());
+  for (int row = 0; row < num_rows(); row++) {
+    RecordSet::Record* record = record_set->add_records();
+    for (int column = 0; column < num_columns(); column++) {
+      record->add_values(FormatCell(row, column));
+    }
+  }
+}
+
+TypedRecordSet TypedRecordSet::FromRecordSet(const RecordSet& record_set) {
+  TypedRecordSet typed_record_set(
+      std::vector<std::string>(record_set.column_names().begin(),
+                               record_set.column_names().end()));
+  for (const RecordSet::Record& record : record_set.records()) {
+    CHECK_EQ(record.values_size(), typed_record_set.num_columns());
+    for (const std::string& value : record.values()) {
+      if (value == kMetadataSourceNull) {
+        typed_record_set.AppendNull();
+      } else {
+        typed_record_set.AppendString(value);
+      }
+    }
+  }
+  return typed_record_set;
+}
+
+}  // namespace ml_metadata
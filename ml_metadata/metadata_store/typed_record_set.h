@@ -0,0 +1,141 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TYPED_RECORD_SET_H_
+#define ML_METADATA_METADATA_STORE_TYPED_RECORD_SET_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+
+// A columnar container of the rows returned by a query. Unlike RecordSet,
+// which encodes every cell as a string, each cell keeps the type in which the
+// metadata source returned it, so that integers and doubles are read without
+// parsing. The string cells of all columns are stored in one shared arena.
+//
+// Rows are appended cell by cell in column order, e.g.,
+//   TypedRecordSet record_set({"id", "uri"});
+//   record_set.AppendInt64(1);
+//   record_set.AppendString("/a/b");
+class TypedRecordSet {
+ public:
+  // The type of a cell, i.e., the storage class of the returned value.
+  enum class CellType { kNull, kInt64, kDouble, kString };
+
+  TypedRecordSet() = default;
+  explicit TypedRecordSet(std::vector<std::string> column_names);
+
+  // Removes all rows, and sets the columns of the record set.
+  void Reset(std::vector<std::string> column_names);
+
+  // Returns the index-aligned column names.
+  const std::vector<std::string>& column_names() const {
+    return column_names_;
+  }
+
+  int num_columns() const { return column_names_.size(); }
+
+  // Returns the number of complete rows.
+  int num_rows() const {
+    return columns_.empty() ? 0 : columns_.back().size();
+  }
+
+  // Returns the approximate number of bytes of the returned values, i.e., the
+  // text of the string cells and 8 bytes for each cell.
+  int64 num_bytes() const {
+    return string_arena_.size() +
+           static_cast<int64>(sizeof(int64)) * num_rows() * num_columns();
+  }
+
+  // Appends a cell to the row being filled. The row is complete once a cell
+  // is appended to each column.
+  void AppendNull();
+  void AppendInt64(int64 value);
+  void AppendDouble(double value);
+  void AppendString(absl::string_view value);
+
+  // Appends the rows of `other`, which must have as many columns as this
+  // record set. The last row of this record set must be complete.
+  void AppendRows(const TypedRecordSet& other);
+
+  CellType cell_type(int row, int column) const {
+    return cell(row, column).type;
+  }
+
+  bool IsNull(int row, int column) const {
+    return cell_type(row, column) == CellType::kNull;
+  }
+
+  // Reads a cell as an int64. String cells are parsed.
+  // Returns false, if the cell is NULL or cannot be read as an int64.
+  bool GetInt64(int row, int column, int64* value) const;
+
+  // Reads a cell as a double. Int64 cells are converted and string cells are
+  // parsed.
+  // Returns false, if the cell is NULL or cannot be read as a double.
+  bool GetDouble(int row, int column, double* value) const;
+
+  // Reads a cell as a bool. Int64 cells are true if they are not zero, and
+  // string cells are parsed.
+  // Returns false, if the cell is NULL or cannot be read as a bool.
+  bool GetBool(int row, int column, bool* value) const;
+
+  // Returns the text of a string cell. The view is valid until the record set
+  // is modified. The cell must be a string cell.
+  absl::string_view GetString(int row, int column) const;
+
+  // Returns the textual form of any cell in the RecordSet encoding, i.e.,
+  // NULL is kMetadataSourceNull.
+  std::string FormatCell(int row, int column) const;
+
+  // Converts to the RecordSet encoding, in which every cell is a string.
+  void ToRecordSet(RecordSet* record_set) const;
+
+  // Converts from the RecordSet encoding. All non-NULL cells become string
+  // cells, which the getters parse on read.
+  static TypedRecordSet FromRecordSet(const RecordSet& record_set);
+
+ private:
+  struct Cell {
+    CellType type;
+    union {
+      int64 int64_value;
+      double double_value;
+      // The offset of the text in string_arena_.
+      size_t string_offset;
+    };
+    size_t string_size;
+  };
+
+  const Cell& cell(int row, int column) const;
+
+  // Returns the column to which the next cell is appended.
+  std::vector<Cell>& NextColumn();
+
+  std::vector<std::string> column_names_;
+  std::vector<std::vector<Cell>> columns_;
+  // The index of the column to which the next cell is appended.
+  int next_column_ = 0;
+  // The text of all string cells.
+  std::string string_arena_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TYPED_RECORD_SET_H_
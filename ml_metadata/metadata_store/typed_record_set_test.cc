@@ -0,0 +1,124 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/typed_record_set.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/substitute.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+TypedRecordSet CreateTestRecordSet() {
+  TypedRecordSet record_set({"id", "value", "name"});
+  record_set.AppendInt64(1);
+  record_set.AppendDouble(0.1);
+  record_set.AppendString("a");
+  record_set.AppendInt64(2);
+  record_set.AppendNull();
+  record_set.AppendString("");
+  return record_set;
+}
+
+TEST(TypedRecordSetTest, AppendAndGetCells) {
+  const TypedRecordSet record_set = CreateTestRecordSet();
+  EXPECT_EQ(record_set.num_columns(), 3);
+  EXPECT_EQ(record_set.num_rows(), 2);
+  EXPECT_EQ(record_set.cell_type(0, 0), TypedRecordSet::CellType::kInt64);
+  EXPECT_EQ(record_set.cell_type(0, 1), TypedRecordSet::CellType::kDouble);
+  EXPECT_EQ(record_set.cell_type(0, 2), TypedRecordSet::CellType::kString);
+  EXPECT_TRUE(record_set.IsNull(1, 1));
+
+  int64 int64_value;
+  EXPECT_TRUE(record_set.GetInt64(1, 0, &int64_value));
+  EXPECT_EQ(int64_value, 2);
+  EXPECT_FALSE(record_set.GetInt64(1, 1, &int64_value));
+  double double_value;
+  EXPECT_TRUE(record_set.GetDouble(0, 1, &double_value));
+  EXPECT_EQ(double_value, 0.1);
+  EXPECT_TRUE(record_set.GetDouble(0, 0, &double_value));
+  EXPECT_EQ(double_value, 1.0);
+  bool bool_value;
+  EXPECT_TRUE(record_set.GetBool(0, 0, &bool_value));
+  EXPECT_TRUE(bool_value);
+  EXPECT_EQ(record_set.GetString(0, 2), "a");
+  EXPECT_EQ(record_set.GetString(1, 2), "");
+}
+
+TEST(TypedRecordSetTest, ConvertToRecordSet) {
+  RecordSet record_set;
+  CreateTestRecordSet().ToRecordSet(&record_set);
+  EXPECT_THAT(record_set,
+              EqualsProto(ParseTextProtoOrDie<RecordSet>(absl::Substitute(
+                  R"(column_names: "id"
+                     column_names: "value"
+                     column_names: "name"
+                     records: { values: "1" values: "0.1" values: "a" }
+                     records: { values: "2" values: "$0" values: "" })",
+                  kMetadataSourceNull))));
+}
+
+TEST(TypedRecordSetTest, ConvertFromRecordSet) {
+  const TypedRecordSet record_set =
+      TypedRecordSet::FromRecordSet(ParseTextProtoOrDie<RecordSet>(
+          absl::Substitute(R"(column_names: "id"
+                              column_names: "value"
+                              records: { values: "1" values: "0.5" }
+                              records: { values: "true" values: "$0" })",
+                           kMetadataSourceNull)));
+  EXPECT_EQ(record_set.num_rows(), 2);
+  EXPECT_EQ(record_set.cell_type(0, 0), TypedRecordSet::CellType::kString);
+  int64 int64_value;
+  EXPECT_TRUE(record_set.GetInt64(0, 0, &int64_value));
+  EXPECT_EQ(int64_value, 1);
+  double double_value;
+  EXPECT_TRUE(record_set.GetDouble(0, 1, &double_value));
+  EXPECT_EQ(double_value, 0.5);
+  bool bool_value;
+  EXPECT_TRUE(record_set.GetBool(1, 0, &bool_value));
+  EXPECT_TRUE(bool_value);
+  EXPECT_TRUE(record_set.IsNull(1, 1));
+}
+
+TEST(TypedRecordSetTest, AppendRows) {
+  TypedRecordSet record_set = CreateTestRecordSet();
+  record_set.AppendRows(CreateTestRecordSet());
+  EXPECT_EQ(record_set.num_rows(), 4);
+  int64 int64_value;
+  EXPECT_TRUE(record_set.GetInt64(3, 0, &int64_value));
+  EXPECT_EQ(int64_value, 2);
+  EXPECT_TRUE(record_set.IsNull(3, 1));
+  EXPECT_EQ(record_set.GetString(0, 2), "a");
+  EXPECT_EQ(record_set.GetString(2, 2), "a");
+  EXPECT_EQ(record_set.GetString(3, 2), "");
+}
+
+TEST(TypedRecordSetTest, ResetRemovesRows) {
+  TypedRecordSet record_set = CreateTestRecordSet();
+  record_set.Reset({"id"});
+  EXPECT_EQ(record_set.num_columns(), 1);
+  EXPECT_EQ(record_set.num_rows(), 0);
+  record_set.AppendInt64(3);
+  EXPECT_EQ(record_set.num_rows(), 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
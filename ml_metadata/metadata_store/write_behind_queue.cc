@@ -0,0 +1,423 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/write_behind_queue.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+// The log files are named by the prefix and their zero-padded number, so that
+// they are listed in the order they were written.
+constexpr char kLogFilePrefix[] = "log-";
+constexpr char kCheckpointFileName[] = "checkpoint";
+
+// The first byte of a logged record tells the kind of the request which is
+// serialized in the rest of it.
+constexpr char kPutExecutionKind = 'x';
+constexpr char kPutEventsKind = 'e';
+
+// Parses the checkpoint "<log file number> <log index>".
+tensorflow::Status ParseCheckpoint(const std::string& checkpoint,
+                                   int64* log_file_number, int64* log_index) {
+  const std::vector<absl::string_view> fields =
+      absl::StrSplit(checkpoint, ' ', absl::SkipWhitespace());
+  if (fields.size() != 2 || !absl::SimpleAtoi(fields[0], log_file_number) ||
+      !absl::SimpleAtoi(fields[1], log_index)) {
+    return tensorflow::errors::DataLoss("Cannot parse the checkpoint: ",
+                                        checkpoint);
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+tensorflow::Status WriteBehindQueue::Create(
+    std::unique_ptr<MetadataStore> metadata_store,
+    const WriteBehindQueueOptions& options,
+    std::unique_ptr<WriteBehindQueue>* queue) {
+  if (metadata_store == nullptr) {
+    return tensorflow::errors::InvalidArgument(
+        "The metadata_store must not be null.");
+  }
+  if (options.directory.empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "The directory must not be empty.");
+  }
+  if (options.max_batch_size <= 0 || options.max_requests_per_log_file <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The max_batch_size and max_requests_per_log_file must be positive.");
+  }
+  auto new_queue = absl::WrapUnique(
+      new WriteBehindQueue(std::move(metadata_store), options));
+  TF_RETURN_IF_ERROR(new_queue->Recover());
+  WriteBehindQueue* flushed_queue = new_queue.get();
+  new_queue->flusher_ =
+      std::thread([flushed_queue]() { flushed_queue->RunFlusher(); });
+  *queue = std::move(new_queue);
+  return tensorflow::Status::OK();
+}
+
+WriteBehindQueue::WriteBehindQueue(
+    std::unique_ptr<MetadataStore> metadata_store,
+    const WriteBehindQueueOptions& options)
+    : metadata_store_(std::move(metadata_store)), options_(options) {}
+
+WriteBehindQueue::~WriteBehindQueue() {
+  {
+    absl::MutexLock lock(&mu_);
+    is_stopped_ = true;
+  }
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
+  absl::MutexLock lock(&mu_);
+  if (log_writer_ != nullptr) {
+    tensorflow::Status status = log_writer_->Close();
+    if (status.ok()) status = log_file_->Close();
+    if (!status.ok()) {
+      LOG(WARNING) << "Cannot close the log file " << log_file_number_ << ": "
+                   << status;
+    }
+  }
+}
+
+tensorflow::Status WriteBehindQueue::PutExecution(
+    const PutExecutionRequest& request) {
+  Entry entry;
+  entry.put_execution_request = absl::make_unique<PutExecutionRequest>(request);
+  return Enqueue(kPutExecutionKind, request.SerializeAsString(),
+                 std::move(entry));
+}
+
+tensorflow::Status WriteBehindQueue::PutEvents(
+    const PutEventsRequest& request) {
+  Entry entry;
+  entry.put_events_request = absl::make_unique<PutEventsRequest>(request);
+  return Enqueue(kPutEventsKind, request.SerializeAsString(),
+                 std::move(entry));
+}
+
+tensorflow::Status WriteBehindQueue::Flush(absl::Duration timeout) {
+  // The requests queued before the call are flushed once the oldest pending
+  // request is a later one.
+  struct FlushTarget {
+    const WriteBehindQueue* queue;
+    int64 sequence;
+    bool IsFlushed() const ABSL_NO_THREAD_SAFETY_ANALYSIS {
+      return queue->flushed_sequence_ >= sequence;
+    }
+  };
+  absl::MutexLock lock(&mu_);
+  FlushTarget target = {this, next_sequence_};
+  if (!mu_.AwaitWithTimeout(absl::Condition(&target, &FlushTarget::IsFlushed),
+                            timeout)) {
+    return tensorflow::errors::DeadlineExceeded(
+        next_sequence_ - flushed_sequence_,
+        " queued requests are not flushed yet.");
+  }
+  return tensorflow::Status::OK();
+}
+
+int64 WriteBehindQueue::num_pending_requests() const {
+  absl::MutexLock lock(&mu_);
+  return next_sequence_ - flushed_sequence_;
+}
+
+int64 WriteBehindQueue::num_flushed_requests() const {
+  absl::MutexLock lock(&mu_);
+  return num_flushed_requests_;
+}
+
+int64 WriteBehindQueue::num_failed_requests() const {
+  absl::MutexLock lock(&mu_);
+  return num_failed_requests_;
+}
+
+tensorflow::Status WriteBehindQueue::Recover() {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(options_.directory));
+
+  // The requests before the checkpoint are flushed already.
+  int64 checkpoint_file_number = 0;
+  int64 checkpoint_index = 0;
+  if (env->FileExists(CheckpointPath()).ok()) {
+    std::string checkpoint;
+    TF_RETURN_IF_ERROR(
+        tensorflow::ReadFileToString(env, CheckpointPath(), &checkpoint));
+    TF_RETURN_IF_ERROR(ParseCheckpoint(checkpoint, &checkpoint_file_number,
+                                       &checkpoint_index));
+  }
+
+  std::vector<std::string> file_names;
+  TF_RETURN_IF_ERROR(env->GetChildren(options_.directory, &file_names));
+  std::vector<int64> log_file_numbers;
+  for (const std::string& file_name : file_names) {
+    absl::string_view number = file_name;
+    int64 log_file_number;
+    if (absl::ConsumePrefix(&number, kLogFilePrefix) &&
+        absl::SimpleAtoi(number, &log_file_number)) {
+      log_file_numbers.push_back(log_file_number);
+    }
+  }
+  std::sort(log_file_numbers.begin(), log_file_numbers.end());
+
+  absl::MutexLock lock(&mu_);
+  log_file_number_ = checkpoint_file_number;
+  first_log_file_number_ = checkpoint_file_number;
+  for (const int64 log_file_number : log_file_numbers) {
+    log_file_number_ = std::max(log_file_number_, log_file_number);
+    if (log_file_number < checkpoint_file_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(LogFilePath(log_file_number)));
+      continue;
+    }
+    std::unique_ptr<tensorflow::RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(
+        env->NewRandomAccessFile(LogFilePath(log_file_number), &file));
+    tensorflow::io::RecordReader reader(file.get());
+    uint64 offset = 0;
+    std::string record;
+    for (int64 log_index = 0;; log_index++) {
+      const tensorflow::Status status = reader.ReadRecord(&offset, &record);
+      if (tensorflow::errors::IsOutOfRange(status)) break;
+      if (tensorflow::errors::IsDataLoss(status)) {
+        // The tail of the file was torn by a crash, while its last request
+        // was logged, which was not acknowledged then.
+        LOG(WARNING) << "Dropping the torn tail of the log file "
+                     << log_file_number << ": " << status;
+        break;
+      }
+      TF_RETURN_IF_ERROR(status);
+      if (log_file_number == checkpoint_file_number &&
+          log_index < checkpoint_index) {
+        continue;
+      }
+      Entry entry;
+      bool is_parsed = false;
+      if (!record.empty() && record[0] == kPutExecutionKind) {
+        entry.put_execution_request = absl::make_unique<PutExecutionRequest>();
+        is_parsed =
+            entry.put_execution_request->ParseFromArray(record.data() + 1,
+                                                        record.size() - 1);
+      } else if (!record.empty() && record[0] == kPutEventsKind) {
+        entry.put_events_request = absl::make_unique<PutEventsRequest>();
+        is_parsed = entry.put_events_request->ParseFromArray(
+            record.data() + 1, record.size() - 1);
+      }
+      if (!is_parsed) {
+        return tensorflow::errors::DataLoss("Cannot parse the request ",
+                                            log_index, " of the log file ",
+                                            log_file_number);
+      }
+      entry.sequence = next_sequence_++;
+      entry.log_file_number = log_file_number;
+      entry.log_index = log_index;
+      entries_.push_back(std::move(entry));
+    }
+  }
+  if (!entries_.empty()) {
+    LOG(INFO) << "Recovered " << entries_.size()
+              << " queued requests from " << options_.directory;
+  }
+  // The new requests are appended to a new file, as the tail of the last one
+  // may be torn.
+  log_file_number_++;
+  return StartLogFile();
+}
+
+tensorflow::Status WriteBehindQueue::StartLogFile() {
+  if (log_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(log_writer_->Close());
+    TF_RETURN_IF_ERROR(log_file_->Close());
+    log_writer_.reset();
+    log_file_.reset();
+  }
+  TF_RETURN_IF_ERROR(tensorflow::Env::Default()->NewWritableFile(
+      LogFilePath(log_file_number_), &log_file_));
+  log_writer_ = absl::make_unique<tensorflow::io::RecordWriter>(
+      log_file_.get());
+  log_file_size_ = 0;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status WriteBehindQueue::Enqueue(char kind,
+                                             const std::string& request,
+                                             Entry entry) {
+  absl::MutexLock lock(&mu_);
+  if (log_writer_ == nullptr ||
+      log_file_size_ >= options_.max_requests_per_log_file) {
+    log_file_number_++;
+    TF_RETURN_IF_ERROR(StartLogFile());
+  }
+  tensorflow::Status status =
+      log_writer_->WriteRecord(absl::StrCat(std::string(1, kind), request));
+  if (status.ok()) status = log_writer_->Flush();
+  if (status.ok() && options_.sync_on_enqueue) status = log_file_->Sync();
+  if (!status.ok()) {
+    // The file may end with a partial record, after which no request can be
+    // read back, so the next request starts another file.
+    log_writer_.reset();
+    log_file_.reset();
+    return status;
+  }
+  entry.sequence = next_sequence_++;
+  entry.log_file_number = log_file_number_;
+  entry.log_index = log_file_size_++;
+  entries_.push_back(std::move(entry));
+  return tensorflow::Status::OK();
+}
+
+bool WriteBehindQueue::HasEntriesOrIsStoppedLocked() const {
+  return is_stopped_ || !entries_.empty();
+}
+
+bool WriteBehindQueue::HasFullBatchOrIsStoppedLocked() const {
+  return is_stopped_ || entries_.size() >= options_.max_batch_size;
+}
+
+void WriteBehindQueue::RunFlusher() {
+  while (true) {
+    int batch_size;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          this, &WriteBehindQueue::HasEntriesOrIsStoppedLocked));
+      // The first request waits for more requests to share its transaction.
+      mu_.AwaitWithTimeout(
+          absl::Condition(this,
+                          &WriteBehindQueue::HasFullBatchOrIsStoppedLocked),
+          options_.max_latency);
+      if (is_stopped_) return;
+      batch_size = std::min<int>(entries_.size(), options_.max_batch_size);
+    }
+    const tensorflow::Status status = FlushBatch(batch_size);
+    if (!status.ok()) {
+      LOG(WARNING) << "A batch of " << batch_size
+                   << " queued requests failed, and is retried after "
+                   << options_.retry_backoff << ": " << status;
+      absl::MutexLock lock(&mu_);
+      mu_.AwaitWithTimeout(absl::Condition(&is_stopped_),
+                           options_.retry_backoff);
+    }
+  }
+}
+
+tensorflow::Status WriteBehindQueue::FlushBatch(int batch_size) {
+  // The flusher is the only one popping the entries, and the references to
+  // them stay valid while new ones are pushed, so the batch is run without
+  // the lock.
+  std::vector<MetadataStore::BatchedPut> batch(batch_size);
+  std::vector<PutExecutionResponse> put_execution_responses(batch_size);
+  std::vector<PutEventsResponse> put_events_responses(batch_size);
+  {
+    absl::MutexLock lock(&mu_);
+    for (int i = 0; i < batch_size; i++) {
+      batch[i].put_execution_request = entries_[i].put_execution_request.get();
+      batch[i].put_execution_response = &put_execution_responses[i];
+      batch[i].put_events_request = entries_[i].put_events_request.get();
+      batch[i].put_events_response = &put_events_responses[i];
+    }
+  }
+  tensorflow::Status status = metadata_store_->PutInBatch(&batch);
+  if (tensorflow::errors::IsUnimplemented(status)) {
+    // The store cannot share a transaction among the requests, so each one
+    // runs in a transaction of its own.
+    status = tensorflow::Status::OK();
+    for (MetadataStore::BatchedPut& put : batch) {
+      put.status = put.put_execution_request != nullptr
+                       ? metadata_store_->PutExecution(
+                             *put.put_execution_request,
+                             put.put_execution_response)
+                       : metadata_store_->PutEvents(*put.put_events_request,
+                                                    put.put_events_response);
+    }
+  }
+  TF_RETURN_IF_ERROR(status);
+
+  int64 next_log_file_number;
+  int64 next_log_index;
+  {
+    absl::MutexLock lock(&mu_);
+    if (entries_.size() > batch_size) {
+      next_log_file_number = entries_[batch_size].log_file_number;
+      next_log_index = entries_[batch_size].log_index;
+    } else {
+      next_log_file_number = log_file_number_;
+      next_log_index = log_file_size_;
+    }
+  }
+  const tensorflow::Status checkpoint_status =
+      Checkpoint(next_log_file_number, next_log_index);
+  if (!checkpoint_status.ok()) {
+    // The batch is flushed again by the next queue of the directory.
+    LOG(WARNING) << "Cannot checkpoint the flushed requests: "
+                 << checkpoint_status;
+  }
+
+  absl::MutexLock lock(&mu_);
+  for (const MetadataStore::BatchedPut& put : batch) {
+    if (put.status.ok()) {
+      num_flushed_requests_++;
+    } else {
+      LOG(WARNING) << "Dropping a queued request which failed: " << put.status;
+      num_failed_requests_++;
+    }
+    entries_.pop_front();
+    flushed_sequence_++;
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status WriteBehindQueue::Checkpoint(int64 log_file_number,
+                                                int64 log_index) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  // The checkpoint is replaced by a rename, so that a crash leaves either the
+  // old or the new one.
+  const std::string temp_path = absl::StrCat(CheckpointPath(), ".tmp");
+  TF_RETURN_IF_ERROR(tensorflow::WriteStringToFile(
+      env, temp_path, absl::StrCat(log_file_number, " ", log_index)));
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_path, CheckpointPath()));
+  for (; first_log_file_number_ < log_file_number; first_log_file_number_++) {
+    const std::string path = LogFilePath(first_log_file_number_);
+    if (env->FileExists(path).ok()) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(path));
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+std::string WriteBehindQueue::LogFilePath(int64 log_file_number) const {
+  return absl::StrFormat("%s/%s%010d", options_.directory, kLogFilePrefix,
+                         log_file_number);
+}
+
+std::string WriteBehindQueue::CheckpointPath() const {
+  return absl::StrCat(options_.directory, "/", kCheckpointFileName);
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,206 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_WRITE_BEHIND_QUEUE_H_
+#define ML_METADATA_METADATA_STORE_WRITE_BEHIND_QUEUE_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace ml_metadata {
+
+// Options to tune a WriteBehindQueue.
+struct WriteBehindQueueOptions {
+  // The directory of the log of the queued requests, which is created if it
+  // does not exist. It must not be shared by queues running at the same time.
+  std::string directory;
+  // The max number of requests flushed in one transaction. It must be
+  // positive.
+  int max_batch_size = 64;
+  // The max duration the first queued request waits for more requests before
+  // they are flushed, i.e., the delay added to a write.
+  absl::Duration max_latency = absl::Milliseconds(50);
+  // The backoff before a batch whose transaction failed is flushed again.
+  absl::Duration retry_backoff = absl::Seconds(1);
+  // If true, a request is synced to disk before it is acknowledged, so that
+  // it survives a crash of the host, and not only of the process.
+  bool sync_on_enqueue = true;
+  // The number of requests logged in a file of the log, after which the next
+  // file is started. The files whose requests are all flushed are deleted.
+  int max_requests_per_log_file = 1024;
+};
+
+// Queues the PutExecution and PutEvents requests of a client, e.g., of a
+// training loop whose steps should not wait for the metadata to be written,
+// and writes them behind the client with a MetadataStore of its own. A
+// request is acknowledged once it is appended to a log in a local directory,
+// and a thread flushes the logged requests in batches of one transaction
+// each, see MetadataStore::PutInBatch. The requests left in the log, e.g.,
+// when the process was killed, are flushed by the next queue of the
+// directory. It is thread-safe.
+//
+// The requests are flushed in the order they are queued, which orders the
+// writes of each execution. A batch whose transaction fails, e.g., when the
+// database is unavailable, is flushed again after a backoff, and holds back
+// the later requests meanwhile. A request which fails on its own, e.g., as it
+// is invalid, is dropped and counted by num_failed_requests(), as there is no
+// caller left to return the error to.
+//
+// A request is flushed at least once: if the process stops after a batch is
+// committed, but before its position in the log is recorded, the batch is
+// flushed again by the next queue of the directory.
+//
+// As the responses are dropped, a request is only fit for the queue if no
+// later write of the client needs its results, e.g., the ids of the nodes it
+// creates. The writes which resolve ids should be sent to the store directly.
+//
+// Usage example:
+//
+//   WriteBehindQueueOptions options;
+//   options.directory = "/tmp/mlmd_write_behind";
+//   std::unique_ptr<WriteBehindQueue> queue;
+//   TF_CHECK_OK(WriteBehindQueue::Create(std::move(metadata_store), options,
+//                                        &queue));
+//   TF_CHECK_OK(queue->PutEvents(put_events_request));
+//   ...
+//   TF_CHECK_OK(queue->Flush(absl::Minutes(1)));
+class WriteBehindQueue {
+ public:
+  // Creates a queue flushing its requests with `metadata_store`, and queues
+  // the requests left in the log of `options.directory` first.
+  // Returns INVALID_ARGUMENT error, if an option is invalid.
+  // Returns detailed error, if the log cannot be read or created.
+  static tensorflow::Status Create(
+      std::unique_ptr<MetadataStore> metadata_store,
+      const WriteBehindQueueOptions& options,
+      std::unique_ptr<WriteBehindQueue>* queue);
+
+  // Disallow copy and assign.
+  WriteBehindQueue(const WriteBehindQueue&) = delete;
+  WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+  // Stops flushing once the batch being flushed is done. The requests which
+  // are not flushed yet stay in the log for the next queue of the directory.
+  ~WriteBehindQueue();
+
+  // Appends `request` to the log, and returns once it is logged.
+  // Returns detailed error, if the request cannot be logged, in which case it
+  //   is not queued.
+  tensorflow::Status PutExecution(const PutExecutionRequest& request);
+
+  // Appends `request` to the log, and returns once it is logged.
+  // Returns detailed error, if the request cannot be logged, in which case it
+  //   is not queued.
+  tensorflow::Status PutEvents(const PutEventsRequest& request);
+
+  // Waits until the requests queued before the call are flushed, or failed on
+  // their own, e.g., before the client exits.
+  // Returns DEADLINE_EXCEEDED error, if they are not flushed within `timeout`.
+  tensorflow::Status Flush(absl::Duration timeout);
+
+  // The number of queued requests which are not flushed yet.
+  int64 num_pending_requests() const;
+
+  // The number of requests which have been flushed, and which have failed on
+  // their own and were dropped.
+  int64 num_flushed_requests() const;
+  int64 num_failed_requests() const;
+
+ private:
+  // A logged request, which is either a PutExecution or a PutEvents request.
+  struct Entry {
+    // The position of the request in the order of the queue.
+    int64 sequence;
+    // The number of the log file of the request, and its index in the file.
+    int64 log_file_number;
+    int64 log_index;
+    std::unique_ptr<PutExecutionRequest> put_execution_request;
+    std::unique_ptr<PutEventsRequest> put_events_request;
+  };
+
+  WriteBehindQueue(std::unique_ptr<MetadataStore> metadata_store,
+                   const WriteBehindQueueOptions& options);
+
+  // Reads the unflushed requests of the log into `entries_`, and starts the
+  // next log file.
+  tensorflow::Status Recover();
+
+  // Starts the log file `log_file_number_`, which requests are appended to.
+  tensorflow::Status StartLogFile() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Logs the serialized `request` of kind `kind` and queues `entry`.
+  tensorflow::Status Enqueue(char kind, const std::string& request,
+                             Entry entry);
+
+  // Flushes the queued requests in batches until the queue is destroyed.
+  void RunFlusher();
+
+  // Flushes the first `batch_size` entries in one transaction, or one by one
+  // if the store does not support batches. Returns the transaction status.
+  tensorflow::Status FlushBatch(int batch_size);
+
+  // Records that the requests logged before the request `log_index` of the
+  // log file `log_file_number` are flushed, and deletes the log files which
+  // hold flushed requests only.
+  tensorflow::Status Checkpoint(int64 log_file_number, int64 log_index);
+
+  // The conditions the flusher waits for.
+  bool HasEntriesOrIsStoppedLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool HasFullBatchOrIsStoppedLocked() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::string LogFilePath(int64 log_file_number) const;
+  std::string CheckpointPath() const;
+
+  const std::unique_ptr<MetadataStore> metadata_store_;
+  const WriteBehindQueueOptions options_;
+
+  mutable absl::Mutex mu_;
+  // The queued requests, from the oldest to the newest. The flusher only pops
+  // them once they are flushed.
+  std::deque<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  int64 next_sequence_ ABSL_GUARDED_BY(mu_) = 0;
+  // The sequence of the oldest request which is not flushed yet.
+  int64 flushed_sequence_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 num_flushed_requests_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 num_failed_requests_ ABSL_GUARDED_BY(mu_) = 0;
+  bool is_stopped_ ABSL_GUARDED_BY(mu_) = false;
+
+  // The log file the requests are appended to.
+  std::unique_ptr<tensorflow::WritableFile> log_file_ ABSL_GUARDED_BY(mu_);
+  std::unique_ptr<tensorflow::io::RecordWriter> log_writer_
+      ABSL_GUARDED_BY(mu_);
+  int64 log_file_number_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 log_file_size_ ABSL_GUARDED_BY(mu_) = 0;
+  // The number of the oldest log file which is not deleted yet. It is only
+  // used by the flusher, once the queue is created.
+  int64 first_log_file_number_ = 0;
+
+  std::thread flusher_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_WRITE_BEHIND_QUEUE_H_
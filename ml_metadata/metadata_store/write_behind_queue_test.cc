@@ -0,0 +1,213 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/write_behind_queue.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+// The queues and the test read and write the same SQLite database, so that
+// the writes of a queue are seen by the next one.
+class WriteBehindQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const std::string test_name =
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    const std::string filename_uri =
+        absl::StrCat(::testing::TempDir(), test_name, ".db");
+    std::remove(filename_uri.c_str());
+    connection_config_.mutable_sqlite()->set_filename_uri(filename_uri);
+    options_.directory =
+        absl::StrCat(::testing::TempDir(), test_name, "_write_behind");
+    int64 undeleted_files, undeleted_dirs;
+    tensorflow::Env::Default()
+        ->DeleteRecursively(options_.directory, &undeleted_files,
+                            &undeleted_dirs)
+        .IgnoreError();
+    options_.max_latency = absl::Milliseconds(1);
+    options_.retry_backoff = absl::Milliseconds(1);
+
+    TF_ASSERT_OK(CreateMetadataStore(connection_config_, &metadata_store_));
+    const PutExecutionTypeRequest request =
+        ParseTextProtoOrDie<PutExecutionTypeRequest>(R"(
+          all_fields_match: true
+          execution_type: { name: 'queued_type' }
+        )");
+    PutExecutionTypeResponse response;
+    TF_ASSERT_OK(metadata_store_->PutExecutionType(request, &response));
+    type_id_ = response.type_id();
+  }
+
+  tensorflow::Status CreateQueue(std::unique_ptr<WriteBehindQueue>* queue) {
+    std::unique_ptr<MetadataStore> queue_store;
+    TF_RETURN_IF_ERROR(CreateMetadataStore(connection_config_, &queue_store));
+    return WriteBehindQueue::Create(std::move(queue_store), options_, queue);
+  }
+
+  PutExecutionRequest CreatePutExecutionRequest(const std::string& name) {
+    PutExecutionRequest request;
+    request.mutable_execution()->set_type_id(type_id_);
+    request.mutable_execution()->set_name(name);
+    return request;
+  }
+
+  int GetNumExecutions() {
+    GetExecutionsResponse response;
+    TF_CHECK_OK(metadata_store_->GetExecutions({}, &response));
+    return response.executions_size();
+  }
+
+  ConnectionConfig connection_config_;
+  WriteBehindQueueOptions options_;
+  std::unique_ptr<MetadataStore> metadata_store_;
+  int64 type_id_;
+};
+
+TEST_F(WriteBehindQueueTest, FlushQueuedRequests) {
+  std::unique_ptr<WriteBehindQueue> queue;
+  TF_ASSERT_OK(CreateQueue(&queue));
+  for (int i = 0; i < 3; i++) {
+    TF_ASSERT_OK(queue->PutExecution(
+        CreatePutExecutionRequest(absl::StrCat("execution_", i))));
+  }
+  TF_ASSERT_OK(queue->Flush(absl::Minutes(1)));
+  EXPECT_EQ(queue->num_pending_requests(), 0);
+  EXPECT_EQ(queue->num_flushed_requests(), 3);
+  EXPECT_EQ(GetNumExecutions(), 3);
+}
+
+TEST_F(WriteBehindQueueTest, EventsAreFlushedAfterTheirExecution) {
+  PutArtifactTypeRequest type_request;
+  type_request.mutable_artifact_type()->set_name("queued_artifact_type");
+  PutArtifactTypeResponse type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(type_request, &type_response));
+  PutArtifactsRequest artifacts_request;
+  artifacts_request.add_artifacts()->set_type_id(type_response.type_id());
+  PutArtifactsResponse artifacts_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutArtifacts(artifacts_request, &artifacts_response));
+  PutExecutionsRequest executions_request;
+  executions_request.add_executions()->set_type_id(type_id_);
+  PutExecutionsResponse executions_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutExecutions(executions_request, &executions_response));
+
+  // The execution is updated before its event is put, as they were queued.
+  options_.max_batch_size = 1;
+  std::unique_ptr<WriteBehindQueue> queue;
+  TF_ASSERT_OK(CreateQueue(&queue));
+  PutExecutionRequest put_execution_request = CreatePutExecutionRequest("run");
+  put_execution_request.mutable_execution()->set_id(
+      executions_response.execution_ids(0));
+  put_execution_request.mutable_execution()->set_last_known_state(
+      Execution::COMPLETE);
+  TF_ASSERT_OK(queue->PutExecution(put_execution_request));
+  PutEventsRequest put_events_request;
+  Event* event = put_events_request.add_events();
+  event->set_artifact_id(artifacts_response.artifact_ids(0));
+  event->set_execution_id(executions_response.execution_ids(0));
+  event->set_type(Event::OUTPUT);
+  TF_ASSERT_OK(queue->PutEvents(put_events_request));
+  TF_ASSERT_OK(queue->Flush(absl::Minutes(1)));
+  EXPECT_EQ(queue->num_flushed_requests(), 2);
+
+  GetEventsByExecutionIDsRequest events_request;
+  events_request.add_execution_ids(executions_response.execution_ids(0));
+  GetEventsByExecutionIDsResponse events_response;
+  TF_ASSERT_OK(metadata_store_->GetEventsByExecutionIDs(events_request,
+                                                        &events_response));
+  EXPECT_EQ(events_response.events_size(), 1);
+  GetExecutionsByIDRequest get_request;
+  get_request.add_execution_ids(executions_response.execution_ids(0));
+  GetExecutionsByIDResponse get_response;
+  TF_ASSERT_OK(metadata_store_->GetExecutionsByID(get_request, &get_response));
+  ASSERT_EQ(get_response.executions_size(), 1);
+  EXPECT_EQ(get_response.executions(0).last_known_state(), Execution::COMPLETE);
+}
+
+TEST_F(WriteBehindQueueTest, RecoverUnflushedRequests) {
+  // The first queue never fills a batch, so it stops before flushing.
+  options_.max_batch_size = 100;
+  options_.max_latency = absl::InfiniteDuration();
+  options_.max_requests_per_log_file = 2;
+  {
+    std::unique_ptr<WriteBehindQueue> queue;
+    TF_ASSERT_OK(CreateQueue(&queue));
+    for (int i = 0; i < 5; i++) {
+      TF_ASSERT_OK(queue->PutExecution(
+          CreatePutExecutionRequest(absl::StrCat("execution_", i))));
+    }
+    EXPECT_EQ(queue->num_pending_requests(), 5);
+    EXPECT_TRUE(tensorflow::errors::IsDeadlineExceeded(
+        queue->Flush(absl::ZeroDuration())));
+  }
+  EXPECT_EQ(GetNumExecutions(), 0);
+
+  // The next queue of the directory flushes them once.
+  options_.max_latency = absl::Milliseconds(1);
+  {
+    std::unique_ptr<WriteBehindQueue> queue;
+    TF_ASSERT_OK(CreateQueue(&queue));
+    EXPECT_EQ(queue->num_pending_requests(), 5);
+    TF_ASSERT_OK(queue->Flush(absl::Minutes(1)));
+    EXPECT_EQ(queue->num_flushed_requests(), 5);
+  }
+  {
+    std::unique_ptr<WriteBehindQueue> queue;
+    TF_ASSERT_OK(CreateQueue(&queue));
+    EXPECT_EQ(queue->num_pending_requests(), 0);
+  }
+  EXPECT_EQ(GetNumExecutions(), 5);
+}
+
+TEST_F(WriteBehindQueueTest, DropFailedRequests) {
+  std::unique_ptr<WriteBehindQueue> queue;
+  TF_ASSERT_OK(CreateQueue(&queue));
+  PutExecutionRequest invalid_request = CreatePutExecutionRequest("invalid");
+  invalid_request.mutable_execution()->set_type_id(type_id_ + 1);
+  TF_ASSERT_OK(queue->PutExecution(invalid_request));
+  TF_ASSERT_OK(queue->PutExecution(CreatePutExecutionRequest("valid")));
+  TF_ASSERT_OK(queue->Flush(absl::Minutes(1)));
+  EXPECT_EQ(queue->num_failed_requests(), 1);
+  EXPECT_EQ(queue->num_flushed_requests(), 1);
+  EXPECT_EQ(GetNumExecutions(), 1);
+}
+
+TEST_F(WriteBehindQueueTest, CreateWithInvalidOptions) {
+  options_.max_batch_size = 0;
+  std::unique_ptr<WriteBehindQueue> queue;
+  EXPECT_TRUE(tensorflow::errors::IsInvalidArgument(CreateQueue(&queue)));
+}
+
+}  // namespace
+}  // namespace ml_metadata
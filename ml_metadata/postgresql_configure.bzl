@@ -0,0 +1,58 @@
+# Copyright 2021 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Configures the libpq client library installed on the host, e.g., by the
+libpq-dev package, which must be of PostgreSQL 14 or later for pipeline mode.
+
+The headers and the library are found with `pg_config`, unless the
+LIBPQ_INCLUDE_DIR and LIBPQ_LIB_DIR environment variables are set.
+
+Clients can then depend on `@libpq` to use the libpq C API.
+"""
+
+_DEFAULT_INCLUDE_DIR = "/usr/include/postgresql"
+_DEFAULT_LIB_DIR = "/usr/lib"
+
+def _pg_config(repository_ctx, option):
+    pg_config = repository_ctx.which("pg_config")
+    if not pg_config:
+        return ""
+    result = repository_ctx.execute([pg_config, option])
+    if result.return_code != 0:
+        return ""
+    return result.stdout.strip()
+
+def _libpq_repository_impl(repository_ctx):
+    include_dir = (repository_ctx.os.environ.get("LIBPQ_INCLUDE_DIR") or
+                   _pg_config(repository_ctx, "--includedir") or
+                   _DEFAULT_INCLUDE_DIR)
+    lib_dir = (repository_ctx.os.environ.get("LIBPQ_LIB_DIR") or
+               _pg_config(repository_ctx, "--libdir") or
+               _DEFAULT_LIB_DIR)
+    repository_ctx.symlink(include_dir, "include")
+    repository_ctx.template(
+        "BUILD.bazel",
+        Label("//ml_metadata:libpq.BUILD.tpl"),
+        {"%{LIB_DIR}": lib_dir},
+    )
+
+_libpq_repository = repository_rule(
+    implementation = _libpq_repository_impl,
+    environ = ["LIBPQ_INCLUDE_DIR", "LIBPQ_LIB_DIR", "PATH"],
+    local = True,
+)
+
+def postgresql_configure():
+    _libpq_repository(name = "libpq")
@@ -0,0 +1,65 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+namespace {
+
+std::atomic<bool> allocation_counting_enabled{false};
+std::atomic<int64> allocation_count{0};
+
+// Allocates `size` bytes with malloc, and counts the allocation if the
+// counting is enabled.
+void* CountedAllocate(std::size_t size) {
+  if (allocation_counting_enabled.load(std::memory_order_relaxed)) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  // malloc(0) may return nullptr, while operator new must not.
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+}  // namespace
+
+void EnableAllocationCounting() {
+  allocation_counting_enabled.store(true, std::memory_order_relaxed);
+}
+
+int64 GetAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+}  // namespace ml_metadata
+
+// The replaceable global allocation functions. The nothrow and sized variants
+// call these ones by default.
+void* operator new(std::size_t size) {
+  return ml_metadata::CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return ml_metadata::CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
@@ -0,0 +1,32 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_ALLOCATION_COUNTER_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_ALLOCATION_COUNTER_H
+
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Counts the allocations with the global C++ operator new of the process,
+// which is replaced in allocation_counter.cc, while the counting is enabled,
+// so that the threads do not share a counter otherwise.
+void EnableAllocationCounting();
+
+// Returns the number of allocations counted since the counting was enabled.
+int64 GetAllocationCount();
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_ALLOCATION_COUNTER_H
@@ -14,27 +14,41 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/benchmark.h"
 
+#include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/connect_stores_workload.h"
+#include "ml_metadata/tools/mlmd_bench/contend_hot_nodes_workload.h"
 #include "ml_metadata/tools/mlmd_bench/fill_context_edges_workload.h"
 #include "ml_metadata/tools/mlmd_bench/fill_events_workload.h"
 #include "ml_metadata/tools/mlmd_bench/fill_nodes_workload.h"
+#include "ml_metadata/tools/mlmd_bench/fill_pipeline_runs_workload.h"
 #include "ml_metadata/tools/mlmd_bench/fill_types_workload.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
 #include "ml_metadata/tools/mlmd_bench/read_events_workload.h"
+#include "ml_metadata/tools/mlmd_bench/read_lineage_workload.h"
+#include "ml_metadata/tools/mlmd_bench/read_nodes_by_list_workload.h"
 #include "ml_metadata/tools/mlmd_bench/read_nodes_by_properties_workload.h"
 #include "ml_metadata/tools/mlmd_bench/read_nodes_via_context_edges_workload.h"
 #include "ml_metadata/tools/mlmd_bench/read_types_workload.h"
 #include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/host_info.h"
 
 namespace ml_metadata {
 namespace {
 
-// Creates the executable workload given `workload_config`.
+// Creates the executable workload given `workload_config`, which runs against
+// the database of `mlmd_config`.
 std::unique_ptr<WorkloadBase> CreateWorkload(
-    const WorkloadConfig& workload_config) {
+    const WorkloadConfig& workload_config,
+    const ConnectionConfig& mlmd_config) {
   switch (workload_config.workload_config_case()) {
     case WorkloadConfig::kFillTypesConfig: {
       return absl::make_unique<FillTypes>(
@@ -77,18 +91,72 @@ std::unique_ptr<WorkloadBase> CreateWorkload(
           ReadEvents(workload_config.read_events_config(),
                      workload_config.num_operations()));
     }
+    case WorkloadConfig::kConnectStoresConfig: {
+      return absl::make_unique<ConnectStores>(
+          ConnectStores(workload_config.connect_stores_config(), mlmd_config,
+                        workload_config.num_operations()));
+    }
+    case WorkloadConfig::kFillPipelineRunsConfig: {
+      return absl::make_unique<FillPipelineRuns>(
+          FillPipelineRuns(workload_config.fill_pipeline_runs_config(),
+                           workload_config.num_operations()));
+    }
+    case WorkloadConfig::kReadNodesByListConfig: {
+      return absl::make_unique<ReadNodesByList>(
+          ReadNodesByList(workload_config.read_nodes_by_list_config(),
+                          workload_config.num_operations()));
+    }
+    case WorkloadConfig::kReadLineageConfig: {
+      return absl::make_unique<ReadLineage>(
+          ReadLineage(workload_config.read_lineage_config(),
+                      workload_config.num_operations()));
+    }
+    case WorkloadConfig::kContendHotNodesConfig: {
+      return absl::make_unique<ContendHotNodes>(
+          ContendHotNodes(workload_config.contend_hot_nodes_config(),
+                          workload_config.num_operations()));
+    }
     default:
       LOG(FATAL) << "Cannot find corresponding workload!";
   }
 }
 
-// Initializes `mlmd_bench_report` with `mlmd_bench_config`.
-void InitMLMDBenchReport(const MLMDBenchConfig& mlmd_bench_config,
-                         MLMDBenchReport& mlmd_bench_report) {
-  for (auto& workload_config : mlmd_bench_config.workload_configs()) {
-    mlmd_bench_report.add_summaries()->mutable_workload_config()->CopyFrom(
-        workload_config);
+// Returns the kind of database the workloads of `mlmd_bench_config` use,
+// e.g., sqlite.
+std::string GetBackend(const MLMDBenchConfig& mlmd_bench_config) {
+  if (mlmd_bench_config.has_grpc_client_config()) return "grpc";
+  const ConnectionConfig& mlmd_config = mlmd_bench_config.mlmd_config();
+  if (mlmd_config.config_case() == ConnectionConfig::CONFIG_NOT_SET) {
+    return "unknown";
+  }
+  return ConnectionConfig::descriptor()
+      ->FindFieldByNumber(mlmd_config.config_case())
+      ->name();
+}
+
+// Initializes `mlmd_bench_report` with `mlmd_bench_config`, the names of its
+// `workloads` and the environment of the benchmark.
+void InitMLMDBenchReport(
+    const MLMDBenchConfig& mlmd_bench_config,
+    const std::vector<std::unique_ptr<WorkloadBase>>& workloads,
+    MLMDBenchReport& mlmd_bench_report) {
+  for (int i = 0; i < mlmd_bench_config.workload_configs_size(); ++i) {
+    WorkloadConfigResult& summary = *mlmd_bench_report.add_summaries();
+    summary.mutable_workload_config()->CopyFrom(
+        mlmd_bench_config.workload_configs(i));
+    summary.set_workload_name(workloads[i]->GetName());
   }
+  BenchmarkEnvironment& environment = *mlmd_bench_report.mutable_environment();
+  environment.set_backend(GetBackend(mlmd_bench_config));
+  // The query configs of all the backends share the head schema version.
+  environment.set_schema_version(
+      util::GetSqliteMetadataSourceQueryConfig().schema_version());
+  environment.set_num_threads(
+      mlmd_bench_config.thread_env_config().num_threads());
+  environment.set_hostname(tensorflow::port::Hostname());
+  environment.set_num_cpus(tensorflow::port::NumSchedulableCPUs());
+  environment.set_start_time(
+      absl::FormatTime(absl::RFC3339_sec, absl::Now(), absl::UTCTimeZone()));
 }
 
 }  // namespace
@@ -97,10 +165,11 @@ Benchmark::Benchmark(const MLMDBenchConfig& mlmd_bench_config) {
   workloads_.resize(mlmd_bench_config.workload_configs_size());
   // For each `workload_config`, create corresponding workload.
   for (int i = 0; i < mlmd_bench_config.workload_configs_size(); ++i) {
-    workloads_[i] = CreateWorkload(mlmd_bench_config.workload_configs(i));
+    workloads_[i] = CreateWorkload(mlmd_bench_config.workload_configs(i),
+                                   mlmd_bench_config.mlmd_config());
   }
   // Initializes the performance report with given `mlmd_bench_config`.
-  InitMLMDBenchReport(mlmd_bench_config, mlmd_bench_report_);
+  InitMLMDBenchReport(mlmd_bench_config, workloads_, mlmd_bench_report_);
 }
 
 WorkloadBase* Benchmark::workload(const int64 workload_index) {
@@ -319,6 +319,12 @@ TEST(BenchmarkTest, CreatReadNodesByPropertiesWorkloadTest) {
           }
           num_operations: 150
         }
+        workload_configs: {
+          read_nodes_by_properties_config: {
+            specification: ARTIFACTS_BY_URI_PREFIX
+          }
+          num_operations: 100
+        }
       )");
   const std::vector<std::string> workload_names{
       "READ_ARTIFACTS_BY_ID",
@@ -330,7 +336,8 @@ TEST(BenchmarkTest, CreatReadNodesByPropertiesWorkloadTest) {
       "READ_ARTIFACT_BY_TYPE_AND_NAME",
       "READ_EXECUTION_BY_TYPE_AND_NAME",
       "READ_CONTEXT_BY_TYPE_AND_NAME",
-      "READ_ARTIFACTS_BY_URI"};
+      "READ_ARTIFACTS_BY_URI",
+      "READ_ARTIFACTS_BY_URI_PREFIX"};
   Benchmark benchmark(mlmd_bench_config);
   // Checks that all workload configurations have transformed into executable
   // workloads inside benchmark.
@@ -423,5 +430,50 @@ TEST(BenchmarkTest, CreatReadEventsWorkloadTest) {
                "READ_EVENTS_BY_EXECUTION_ID");
 }
 
+// Tests the CreateWorkload() for ConnectStores workload, checks that the
+// ConnectStores workload configuration has transformed into an executable
+// workload inside benchmark.
+TEST(BenchmarkTest, CreateConnectStoresWorkloadTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(
+          R"(
+            mlmd_config: { fake_database: {} }
+            workload_configs: {
+              connect_stores_config: {}
+              num_operations: 100
+            }
+          )");
+
+  Benchmark benchmark(mlmd_bench_config);
+  EXPECT_EQ(benchmark.num_workloads(),
+            mlmd_bench_config.workload_configs_size());
+  EXPECT_STREQ(benchmark.workload(0)->GetName().c_str(), "CONNECT_STORES");
+}
+
+// Tests that the report of the benchmark is initialized with the names of its
+// workloads and the environment of the benchmark.
+TEST(BenchmarkTest, InitReportTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(
+          R"(
+            mlmd_config: { sqlite: { filename_uri: "mlmd-bench.db" } }
+            workload_configs: {
+              read_types_config: { specification: ALL_ARTIFACT_TYPES }
+              num_operations: 120
+            }
+            thread_env_config: { num_threads: 8 }
+          )");
+
+  Benchmark benchmark(mlmd_bench_config);
+  const MLMDBenchReport& report = benchmark.mlmd_bench_report();
+  ASSERT_EQ(1, report.summaries_size());
+  EXPECT_EQ("READ_ALL_ARTIFACT_TYPES", report.summaries(0).workload_name());
+  EXPECT_EQ("sqlite", report.environment().backend());
+  EXPECT_GT(report.environment().schema_version(), 0);
+  EXPECT_EQ(8, report.environment().num_threads());
+  EXPECT_GT(report.environment().num_cpus(), 0);
+  EXPECT_FALSE(report.environment().start_time().empty());
+}
+
 }  // namespace
 }  // namespace ml_metadata
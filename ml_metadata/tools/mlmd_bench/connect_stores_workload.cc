@@ -0,0 +1,65 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/connect_stores_workload.h"
+
+#include <memory>
+
+#include <glog/logging.h>
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+ConnectStores::ConnectStores(const ConnectStoresConfig& connect_stores_config,
+                             const ConnectionConfig& mlmd_config,
+                             const int64 num_operations)
+    : connect_stores_config_(connect_stores_config),
+      mlmd_config_(mlmd_config),
+      num_operations_(num_operations),
+      name_("CONNECT_STORES") {}
+
+tensorflow::Status ConnectStores::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
+  LOG(INFO) << "Setting up ...";
+  // The database has been created by the store set up with, so the stores of
+  // the operations only connect to it and check its schema version. No bytes
+  // of the nodes are transferred.
+  work_items_.reserve(num_operations_);
+  for (int64 i = 0; i < num_operations_; ++i) {
+    work_items_.emplace_back(mlmd_config_, /*transferred_bytes=*/0);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Executions of work items.
+tensorflow::Status ConnectStores::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
+  std::unique_ptr<MetadataStore> connected_store;
+  return CreateMetadataStore(work_items_[work_items_index].first,
+                             &connected_store);
+}
+
+tensorflow::Status ConnectStores::TearDownImpl() {
+  work_items_.clear();
+  return tensorflow::Status::OK();
+}
+
+std::string ConnectStores::GetName() { return name_; }
+
+}  // namespace ml_metadata
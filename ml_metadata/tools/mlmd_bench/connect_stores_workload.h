@@ -0,0 +1,70 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_CONNECT_STORES_WORKLOAD_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_CONNECT_STORES_WORKLOAD_H
+
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A specific workload for creating stores connected to the database of the
+// benchmark, which measures the startup time of a store, e.g., of a server
+// creating a store per request.
+class ConnectStores : public Workload<ConnectionConfig> {
+ public:
+  ConnectStores(const ConnectStoresConfig& connect_stores_config,
+                const ConnectionConfig& mlmd_config, int64 num_operations);
+  ~ConnectStores() override = default;
+
+ protected:
+  // Specific implementation of SetUpImpl() for ConnectStores workload according
+  // to its semantic. A list of work items(ConnectionConfig) with the
+  // `mlmd_config` of the benchmark will be generated.
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of RunOpImpl() for ConnectStores workload according
+  // to its semantic. Creates a new store with the work item, instead of using
+  // `store`. Returns detailed error if the connection or the schema check
+  // failed.
+  tensorflow::Status RunOpImpl(int64 work_items_index,
+                               MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of TearDownImpl() for ConnectStores workload
+  // according to its semantic. Cleans the work items.
+  tensorflow::Status TearDownImpl() final;
+
+  // Gets the current workload's name, which is used in stats report for this
+  // workload.
+  std::string GetName() final;
+
+ private:
+  // Workload configurations specified by the users.
+  const ConnectStoresConfig connect_stores_config_;
+  // The connection configuration of the benchmark.
+  const ConnectionConfig mlmd_config_;
+  // Number of operations for the current workload.
+  const int64 num_operations_;
+  // String for indicating the name of current workload instance.
+  const std::string name_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_CONNECT_STORES_WORKLOAD_H
@@ -0,0 +1,77 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/connect_stores_workload.h"
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/stats.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfOperations = 50;
+
+// Test fixture that connects the ConnectStores workload to a fake in-memory
+// SQLite database.
+class ConnectStoresTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ConnectionConfig mlmd_config;
+    // Uses a fake in-memory SQLite database for testing.
+    mlmd_config.mutable_fake_database();
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store_));
+    connect_stores_ = absl::make_unique<ConnectStores>(ConnectStores(
+        ConnectStoresConfig(), mlmd_config, kNumberOfOperations));
+  }
+
+  std::unique_ptr<ConnectStores> connect_stores_;
+  std::unique_ptr<MetadataStore> store_;
+};
+
+// Tests the SetUpImpl() for ConnectStores. Checks the SetUpImpl() indeed
+// prepares a list of work items whose length is the same as the specified
+// number of operations.
+TEST_F(ConnectStoresTest, SetUpImplTest) {
+  TF_ASSERT_OK(connect_stores_->SetUp(store_.get()));
+  EXPECT_EQ(kNumberOfOperations, connect_stores_->num_operations());
+}
+
+// Tests the RunOpImpl() for ConnectStores. Checks indeed all the work items
+// have been executed without transferring any bytes.
+TEST_F(ConnectStoresTest, RunOpImplTest) {
+  TF_ASSERT_OK(connect_stores_->SetUp(store_.get()));
+
+  int64 total_done = 0;
+  ThreadStats stats;
+  stats.Start();
+  for (int64 i = 0; i < connect_stores_->num_operations(); ++i) {
+    OpStats op_stats;
+    TF_ASSERT_OK(connect_stores_->RunOp(i, store_.get(), op_stats));
+    stats.Update(op_stats, total_done);
+  }
+  stats.Stop();
+  EXPECT_EQ(kNumberOfOperations, stats.done());
+  EXPECT_EQ(0, stats.bytes());
+  TF_ASSERT_OK(connect_stores_->TearDown());
+}
+
+}  // namespace
+}  // namespace ml_metadata
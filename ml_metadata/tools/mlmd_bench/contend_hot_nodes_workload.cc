@@ -0,0 +1,270 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/contend_hot_nodes_workload.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int64 kInt64IdSize = 8;
+constexpr int64 kInt64ValueSize = 8;
+constexpr int64 kNumNodeIdsPerEdge = 2;
+
+constexpr char kArtifactTypeName[] = "mlmd_bench_hot_artifact";
+constexpr char kContextTypeName[] = "mlmd_bench_hot_context";
+// The custom property set by the updates of the hot nodes.
+constexpr char kUpdatedPropertyName[] = "mlmd_bench_update";
+
+// Validates the specification and distributions of
+// `contend_hot_nodes_config`. Returns INVALID_ARGUMENT error if one of them is
+// not correct.
+tensorflow::Status ValidateContendHotNodesConfig(
+    const ContendHotNodesConfig& contend_hot_nodes_config) {
+  if (contend_hot_nodes_config.specification() ==
+      ContendHotNodesConfig::UNKNOWN) {
+    return tensorflow::errors::InvalidArgument(
+        "The specification must be specified.");
+  }
+  if (contend_hot_nodes_config.num_hot_nodes() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_hot_nodes must be positive.");
+  }
+  const UniformDistribution& dist =
+      contend_hot_nodes_config.num_nodes_per_request();
+  if (dist.minimum() <= 0 || dist.minimum() > dist.maximum() ||
+      dist.maximum() > contend_hot_nodes_config.num_hot_nodes()) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_nodes_per_request must be a positive range of at most "
+        "num_hot_nodes.");
+  }
+  return tensorflow::Status::OK();
+}
+
+// Inserts the `num_hot_nodes` hot nodes of `contend_hot_nodes_config` into
+// `hot_nodes`, and for INSERT_ATTRIBUTIONS the `num_new_artifacts` artifacts
+// into `new_artifact_ids`. Returns detailed error if query executions failed.
+tensorflow::Status InsertHotNodes(
+    const ContendHotNodesConfig& contend_hot_nodes_config,
+    const int64 num_new_artifacts, MetadataStoreServiceInterface& store,
+    std::vector<Node>& hot_nodes, std::vector<int64>& new_artifact_ids) {
+  PutTypesRequest put_types_request;
+  put_types_request.add_artifact_types()->set_name(kArtifactTypeName);
+  put_types_request.add_context_types()->set_name(kContextTypeName);
+  PutTypesResponse put_types_response;
+  TF_RETURN_IF_ERROR(store.PutTypes(put_types_request, &put_types_response));
+  const int64 artifact_type_id = put_types_response.artifact_type_ids(0);
+  const int64 context_type_id = put_types_response.context_type_ids(0);
+
+  const std::string nodes_name =
+      absl::StrCat("hot", absl::FormatTime(absl::Now()));
+  if (contend_hot_nodes_config.specification() ==
+      ContendHotNodesConfig::UPDATE_ARTIFACTS) {
+    PutArtifactsRequest request;
+    for (int64 i = 0; i < contend_hot_nodes_config.num_hot_nodes(); ++i) {
+      Artifact& artifact = *request.add_artifacts();
+      artifact.set_type_id(artifact_type_id);
+      artifact.set_name(absl::StrCat(nodes_name, "_artifact_", i));
+    }
+    PutArtifactsResponse response;
+    TF_RETURN_IF_ERROR(store.PutArtifacts(request, &response));
+    for (int64 i = 0; i < request.artifacts_size(); ++i) {
+      Artifact artifact = request.artifacts(i);
+      artifact.set_id(response.artifact_ids(i));
+      hot_nodes.push_back(artifact);
+    }
+    return tensorflow::Status::OK();
+  }
+
+  PutContextsRequest request;
+  for (int64 i = 0; i < contend_hot_nodes_config.num_hot_nodes(); ++i) {
+    Context& context = *request.add_contexts();
+    context.set_type_id(context_type_id);
+    context.set_name(absl::StrCat(nodes_name, "_context_", i));
+  }
+  PutContextsResponse response;
+  TF_RETURN_IF_ERROR(store.PutContexts(request, &response));
+  for (int64 i = 0; i < request.contexts_size(); ++i) {
+    Context context = request.contexts(i);
+    context.set_id(response.context_ids(i));
+    hot_nodes.push_back(context);
+  }
+  if (contend_hot_nodes_config.specification() !=
+          ContendHotNodesConfig::INSERT_ATTRIBUTIONS ||
+      num_new_artifacts == 0) {
+    return tensorflow::Status::OK();
+  }
+  PutArtifactsRequest new_artifacts_request;
+  for (int64 i = 0; i < num_new_artifacts; ++i) {
+    Artifact& artifact = *new_artifacts_request.add_artifacts();
+    artifact.set_type_id(artifact_type_id);
+    artifact.set_name(absl::StrCat(nodes_name, "_new_artifact_", i));
+  }
+  PutArtifactsResponse new_artifacts_response;
+  TF_RETURN_IF_ERROR(
+      store.PutArtifacts(new_artifacts_request, &new_artifacts_response));
+  new_artifact_ids.assign(new_artifacts_response.artifact_ids().begin(),
+                          new_artifacts_response.artifact_ids().end());
+  return tensorflow::Status::OK();
+}
+
+// Sets the updated property of `node` to `value`.
+template <typename T>
+void SetUpdatedProperty(const int64 value, T& node) {
+  (*node.mutable_custom_properties())[kUpdatedPropertyName].set_int_value(
+      value);
+}
+
+}  // namespace
+
+ContendHotNodes::ContendHotNodes(
+    const ContendHotNodesConfig& contend_hot_nodes_config,
+    int64 num_operations)
+    : contend_hot_nodes_config_(contend_hot_nodes_config),
+      num_operations_(num_operations),
+      name_(absl::StrCat("CONTEND_HOT_NODES_",
+                         contend_hot_nodes_config_.Specification_Name(
+                             contend_hot_nodes_config_.specification()))) {
+  TF_CHECK_OK(ValidateContendHotNodesConfig(contend_hot_nodes_config_));
+}
+
+tensorflow::Status ContendHotNodes::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
+  LOG(INFO) << "Setting up ...";
+
+  std::vector<Node> hot_nodes;
+  std::vector<int64> new_artifact_ids;
+  TF_RETURN_IF_ERROR(InsertHotNodes(contend_hot_nodes_config_,
+                                    num_operations_, *store, hot_nodes,
+                                    new_artifact_ids));
+
+  std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  std::discrete_distribution<int64> hot_node_index_dist =
+      GenerateZipfDistributionWithConfigurableSkew(
+          hot_nodes.size(), contend_hot_nodes_config_.hot_node_popularity(),
+          gen);
+  std::uniform_int_distribution<int64> num_nodes_dist{
+      contend_hot_nodes_config_.num_nodes_per_request().minimum(),
+      contend_hot_nodes_config_.num_nodes_per_request().maximum()};
+  for (int64 i = 0; i < num_operations_; ++i) {
+    // Picks distinct hot nodes by rejection sampling, in the random order in
+    // which concurrent writers lock them.
+    const int64 num_nodes = num_nodes_dist(gen);
+    std::vector<int64> hot_node_indices;
+    absl::flat_hash_set<int64> seen_indices;
+    while (hot_node_indices.size() < num_nodes) {
+      const int64 index = hot_node_index_dist(gen);
+      if (seen_indices.insert(index).second) {
+        hot_node_indices.push_back(index);
+      }
+    }
+
+    ContendHotNodesWorkItemType request;
+    int64 curr_bytes = 0;
+    switch (contend_hot_nodes_config_.specification()) {
+      case ContendHotNodesConfig::UPDATE_ARTIFACTS: {
+        PutArtifactsRequest put_artifacts_request;
+        for (const int64 index : hot_node_indices) {
+          Artifact& artifact = *put_artifacts_request.add_artifacts();
+          artifact = absl::get<Artifact>(hot_nodes[index]);
+          SetUpdatedProperty(i, artifact);
+          curr_bytes += kInt64IdSize + kInt64ValueSize;
+        }
+        request = put_artifacts_request;
+        break;
+      }
+      case ContendHotNodesConfig::UPDATE_CONTEXTS: {
+        PutContextsRequest put_contexts_request;
+        for (const int64 index : hot_node_indices) {
+          Context& context = *put_contexts_request.add_contexts();
+          context = absl::get<Context>(hot_nodes[index]);
+          SetUpdatedProperty(i, context);
+          curr_bytes += kInt64IdSize + kInt64ValueSize;
+        }
+        request = put_contexts_request;
+        break;
+      }
+      case ContendHotNodesConfig::INSERT_ATTRIBUTIONS: {
+        PutAttributionsAndAssociationsRequest put_attributions_request;
+        for (const int64 index : hot_node_indices) {
+          Attribution& attribution =
+              *put_attributions_request.add_attributions();
+          attribution.set_artifact_id(new_artifact_ids[i]);
+          attribution.set_context_id(absl::get<Context>(hot_nodes[index]).id());
+          curr_bytes += kInt64IdSize * kNumNodeIdsPerEdge;
+        }
+        request = put_attributions_request;
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unknown ContendHotNodesConfig specification.";
+    }
+    work_items_.emplace_back(request, curr_bytes);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ContendHotNodes::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
+  switch (contend_hot_nodes_config_.specification()) {
+    case ContendHotNodesConfig::UPDATE_ARTIFACTS: {
+      PutArtifactsRequest request = absl::get<PutArtifactsRequest>(
+          work_items_[work_items_index].first);
+      PutArtifactsResponse response;
+      return store->PutArtifacts(request, &response);
+    }
+    case ContendHotNodesConfig::UPDATE_CONTEXTS: {
+      PutContextsRequest request =
+          absl::get<PutContextsRequest>(work_items_[work_items_index].first);
+      PutContextsResponse response;
+      return store->PutContexts(request, &response);
+    }
+    case ContendHotNodesConfig::INSERT_ATTRIBUTIONS: {
+      PutAttributionsAndAssociationsRequest request =
+          absl::get<PutAttributionsAndAssociationsRequest>(
+              work_items_[work_items_index].first);
+      PutAttributionsAndAssociationsResponse response;
+      return store->PutAttributionsAndAssociations(request, &response);
+    }
+    default:
+      return tensorflow::errors::InvalidArgument("Unknown specification!");
+  }
+}
+
+tensorflow::Status ContendHotNodes::TearDownImpl() {
+  work_items_.clear();
+  return tensorflow::Status::OK();
+}
+
+std::string ContendHotNodes::GetName() { return name_; }
+
+}  // namespace ml_metadata
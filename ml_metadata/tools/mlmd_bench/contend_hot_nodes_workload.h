@@ -0,0 +1,79 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_CONTEND_HOT_NODES_WORKLOAD_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_CONTEND_HOT_NODES_WORKLOAD_H
+
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Defines a ContendHotNodesWorkItemType that can be PutArtifactsRequest /
+// PutContextsRequest / PutAttributionsAndAssociationsRequest.
+using ContendHotNodesWorkItemType =
+    absl::variant<PutArtifactsRequest, PutContextsRequest,
+                  PutAttributionsAndAssociationsRequest>;
+
+// A specific workload for concurrent writes to a few hot artifacts or
+// contexts. Its operations conflict with each other when run by several
+// threads, so that the aborted attempts are reported besides the latencies.
+class ContendHotNodes : public Workload<ContendHotNodesWorkItemType> {
+ public:
+  ContendHotNodes(const ContendHotNodesConfig& contend_hot_nodes_config,
+                  int64 num_operations);
+  ~ContendHotNodes() override = default;
+
+ protected:
+  // Specific implementation of SetUpImpl() for ContendHotNodes workload
+  // according to its semantic.
+  // Inserts the `num_hot_nodes` hot artifacts or contexts, and for
+  // INSERT_ATTRIBUTIONS a new artifact per operation. A list of work
+  // items(ContendHotNodesWorkItemType) will be generated, each writing
+  // distinct hot nodes picked w.r.t. their zipf popularity.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of RunOpImpl() for ContendHotNodes workload
+  // according to its semantic. Runs the work items(ContendHotNodesWorkItemType)
+  // on the store. Returns ABORTED error if the transaction conflicted with a
+  // concurrent one, or detailed error if query executions failed.
+  tensorflow::Status RunOpImpl(int64 work_items_index,
+                               MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of TearDownImpl() for ContendHotNodes workload
+  // according to its semantic. Cleans the work items.
+  tensorflow::Status TearDownImpl() final;
+
+  // Gets the current workload's name, which is used in stats report for this
+  // workload.
+  std::string GetName() final;
+
+ private:
+  // Workload configurations specified by the users.
+  const ContendHotNodesConfig contend_hot_nodes_config_;
+  // Number of operations for the current workload.
+  const int64 num_operations_;
+  // String for indicating the name of current workload instance.
+  const std::string name_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_CONTEND_HOT_NODES_WORKLOAD_H
@@ -0,0 +1,157 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/contend_hot_nodes_workload.h"
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfOperations = 50;
+constexpr int kNumberOfHotNodes = 3;
+
+// Enumerates the workload configurations as the test parameters that ensure
+// test coverage.
+std::vector<WorkloadConfig> EnumerateConfigs() {
+  std::vector<WorkloadConfig> configs;
+
+  for (const ContendHotNodesConfig::Specification specification :
+       {ContendHotNodesConfig::UPDATE_ARTIFACTS,
+        ContendHotNodesConfig::UPDATE_CONTEXTS,
+        ContendHotNodesConfig::INSERT_ATTRIBUTIONS}) {
+    WorkloadConfig config;
+    config.set_num_operations(kNumberOfOperations);
+    ContendHotNodesConfig& contend_hot_nodes_config =
+        *config.mutable_contend_hot_nodes_config();
+    contend_hot_nodes_config.set_specification(specification);
+    contend_hot_nodes_config.set_num_hot_nodes(kNumberOfHotNodes);
+    contend_hot_nodes_config.mutable_hot_node_popularity()->set_skew(2.0);
+    contend_hot_nodes_config.mutable_num_nodes_per_request()->set_minimum(1);
+    contend_hot_nodes_config.mutable_num_nodes_per_request()->set_maximum(
+        kNumberOfHotNodes);
+    configs.push_back(config);
+  }
+
+  return configs;
+}
+
+// Test fixture that uses the same data configuration for multiple following
+// parameterized ContendHotNodes tests.
+// The parameter here is the specific Workload configuration that contains
+// the ContendHotNodes configuration and the number of operations.
+class ContendHotNodesParameterizedTestFixture
+    : public ::testing::TestWithParam<WorkloadConfig> {
+ protected:
+  void SetUp() override {
+    ConnectionConfig mlmd_config;
+    // Uses a fake in-memory SQLite database for testing.
+    mlmd_config.mutable_fake_database();
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store_));
+    contend_hot_nodes_ = absl::make_unique<ContendHotNodes>(ContendHotNodes(
+        GetParam().contend_hot_nodes_config(), GetParam().num_operations()));
+  }
+
+  std::unique_ptr<ContendHotNodes> contend_hot_nodes_;
+  std::unique_ptr<MetadataStore> store_;
+};
+
+// Tests the SetUpImpl() for ContendHotNodes. Checks the SetUpImpl() indeed
+// inserts the hot nodes and prepares a list of work items whose length is the
+// same as the specified number of operations.
+TEST_P(ContendHotNodesParameterizedTestFixture, SetUpImplTest) {
+  TF_ASSERT_OK(contend_hot_nodes_->SetUp(store_.get()));
+  EXPECT_EQ(GetParam().num_operations(), contend_hot_nodes_->num_operations());
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(store_->GetArtifacts(/*request=*/{}, &get_artifacts_response));
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(store_->GetContexts(/*request=*/{}, &get_contexts_response));
+  switch (GetParam().contend_hot_nodes_config().specification()) {
+    case ContendHotNodesConfig::UPDATE_ARTIFACTS:
+      EXPECT_EQ(get_artifacts_response.artifacts_size(), kNumberOfHotNodes);
+      EXPECT_EQ(get_contexts_response.contexts_size(), 0);
+      break;
+    case ContendHotNodesConfig::UPDATE_CONTEXTS:
+      EXPECT_EQ(get_artifacts_response.artifacts_size(), 0);
+      EXPECT_EQ(get_contexts_response.contexts_size(), kNumberOfHotNodes);
+      break;
+    default:
+      EXPECT_EQ(get_artifacts_response.artifacts_size(), kNumberOfOperations);
+      EXPECT_EQ(get_contexts_response.contexts_size(), kNumberOfHotNodes);
+  }
+}
+
+// Tests the RunOpImpl() for ContendHotNodes. Checks that after all the
+// operations, the hot nodes are updated or attributed, while no node is
+// inserted for the updates.
+TEST_P(ContendHotNodesParameterizedTestFixture, RunOpImplTest) {
+  TF_ASSERT_OK(contend_hot_nodes_->SetUp(store_.get()));
+  for (int64 i = 0; i < contend_hot_nodes_->num_operations(); ++i) {
+    OpStats op_stats;
+    TF_ASSERT_OK(contend_hot_nodes_->RunOp(i, store_.get(), op_stats));
+    EXPECT_GT(op_stats.transferred_bytes, 0);
+  }
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(store_->GetArtifacts(/*request=*/{}, &get_artifacts_response));
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(store_->GetContexts(/*request=*/{}, &get_contexts_response));
+  switch (GetParam().contend_hot_nodes_config().specification()) {
+    case ContendHotNodesConfig::UPDATE_ARTIFACTS: {
+      ASSERT_EQ(get_artifacts_response.artifacts_size(), kNumberOfHotNodes);
+      int num_updated_artifacts = 0;
+      for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+        num_updated_artifacts += artifact.custom_properties_size();
+      }
+      EXPECT_GT(num_updated_artifacts, 0);
+      break;
+    }
+    case ContendHotNodesConfig::UPDATE_CONTEXTS: {
+      ASSERT_EQ(get_contexts_response.contexts_size(), kNumberOfHotNodes);
+      int num_updated_contexts = 0;
+      for (const Context& context : get_contexts_response.contexts()) {
+        num_updated_contexts += context.custom_properties_size();
+      }
+      EXPECT_GT(num_updated_contexts, 0);
+      break;
+    }
+    default: {
+      // Each new artifact is attributed to at least one hot context.
+      int num_attributions = 0;
+      for (const Context& context : get_contexts_response.contexts()) {
+        GetArtifactsByContextRequest request;
+        request.set_context_id(context.id());
+        GetArtifactsByContextResponse response;
+        TF_ASSERT_OK(store_->GetArtifactsByContext(request, &response));
+        num_attributions += response.artifacts_size();
+      }
+      EXPECT_GE(num_attributions, kNumberOfOperations);
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(ContendHotNodesTest,
+                        ContendHotNodesParameterizedTestFixture,
+                        ::testing::ValuesIn(EnumerateConfigs()));
+
+}  // namespace
+}  // namespace ml_metadata
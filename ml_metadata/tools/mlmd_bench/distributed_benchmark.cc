@@ -0,0 +1,169 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/distributed_benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "ml_metadata/tools/mlmd_bench/grpc_metadata_store_client.h"
+#include "ml_metadata/tools/mlmd_bench/stats.h"
+#include "ml_metadata/tools/mlmd_bench/thread_runner.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+// Converts from tensorflow Status to GRPC Status.
+::grpc::Status ToGRPCStatus(const ::tensorflow::Status& status) {
+  // Note: the tensorflow and grpc status codes align with each other.
+  return ::grpc::Status(static_cast<::grpc::StatusCode>(status.code()),
+                        status.error_message());
+}
+
+// Sends `request` to the worker at `worker_address` and waits for its
+// `response`.
+tensorflow::Status RunBenchmarkOnWorker(const std::string& worker_address,
+                                        const RunBenchmarkRequest& request,
+                                        RunBenchmarkResponse& response) {
+  const std::unique_ptr<MLMDBenchWorkerService::Stub> stub =
+      MLMDBenchWorkerService::NewStub(::grpc::CreateChannel(
+          worker_address, ::grpc::InsecureChannelCredentials()));
+  ::grpc::ClientContext context;
+  const tensorflow::Status status =
+      FromGrpcStatus(stub->RunBenchmark(&context, request, &response));
+  if (!status.ok()) {
+    return tensorflow::Status(
+        status.code(), absl::StrCat("The worker ", worker_address,
+                                    " failed: ", status.error_message()));
+  }
+  if (response.workload_stats_size() !=
+      request.mlmd_bench_config().workload_configs_size()) {
+    return tensorflow::errors::Internal(
+        "The worker ", worker_address, " returned the stats of ",
+        response.workload_stats_size(), " workloads instead of ",
+        request.mlmd_bench_config().workload_configs_size());
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+::grpc::Status MLMDBenchWorker::RunBenchmark(
+    ::grpc::ServerContext* context, const RunBenchmarkRequest* request,
+    RunBenchmarkResponse* response) {
+  absl::MutexLock lock(&mu_);
+  Benchmark benchmark(request->mlmd_bench_config());
+  ThreadRunner runner(request->mlmd_bench_config());
+  const absl::Time start_time =
+      absl::FromUnixMicros(request->start_time_unix_micros());
+  const absl::Time now = absl::Now();
+  if (now > start_time) {
+    LOG(WARNING) << "The benchmark starts " << absl::FormatDuration(
+                                                   now - start_time)
+                 << " late, the start delay may be too short or the clocks "
+                    "of the workers not synchronized.";
+  }
+  absl::SleepFor(start_time - now);
+  std::vector<ThreadStats> workload_stats;
+  const tensorflow::Status status = runner.Run(benchmark, workload_stats);
+  if (!status.ok()) {
+    return ToGRPCStatus(status);
+  }
+  *response->mutable_mlmd_bench_report() = benchmark.mlmd_bench_report();
+  for (const ThreadStats& stats : workload_stats) {
+    stats.ToProto(*response->add_workload_stats());
+  }
+  return ::grpc::Status::OK;
+}
+
+// The workers get the benchmark at the same time and wait for a common start
+// time, as a start on receipt would skew the start of the workers by their
+// network latencies. Their stats are merged as the stats of the threads of a
+// single process, so the latency percentiles are the ones of the operations
+// of all the workers.
+tensorflow::Status RunDistributedBenchmark(
+    const MLMDBenchConfig& mlmd_bench_config, Benchmark& benchmark) {
+  const DistributedConfig& distributed_config =
+      mlmd_bench_config.distributed_config();
+  const int num_workers = distributed_config.worker_addresses_size();
+  if (num_workers == 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The distributed_config must have worker_addresses.");
+  }
+  RunBenchmarkRequest request;
+  *request.mutable_mlmd_bench_config() = mlmd_bench_config;
+  request.mutable_mlmd_bench_config()->clear_distributed_config();
+  request.set_start_time_unix_micros(absl::ToUnixMicros(
+      absl::Now() +
+      absl::Milliseconds(distributed_config.start_delay_milliseconds())));
+
+  std::vector<RunBenchmarkResponse> responses(num_workers);
+  std::vector<tensorflow::Status> statuses(num_workers);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "mlmd_bench_coordinator", num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+      pool.Schedule([&distributed_config, &request, &responses, &statuses,
+                     i]() {
+        statuses[i] =
+            RunBenchmarkOnWorker(distributed_config.worker_addresses(i),
+                                 request, responses[i]);
+      });
+    }
+  }
+  for (const tensorflow::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  MLMDBenchReport& report = benchmark.mlmd_bench_report();
+  std::vector<ThreadStats> workload_stats;
+  for (int w = 0; w < benchmark.num_workloads(); ++w) {
+    ThreadStats stats = ThreadStats::FromProto(responses[0].workload_stats(w));
+    double target_qps = 0;
+    for (int i = 0; i < num_workers; ++i) {
+      if (i > 0) {
+        stats.Merge(ThreadStats::FromProto(responses[i].workload_stats(w)));
+      }
+      target_qps +=
+          responses[i].mlmd_bench_report().summaries(w).target_qps();
+    }
+    WorkloadConfigResult& summary = *report.mutable_summaries(w);
+    if (target_qps > 0) {
+      summary.set_target_qps(target_qps);
+    }
+    stats.Report(benchmark.workload(w)->GetName(), summary);
+    workload_stats.push_back(stats);
+  }
+  if (mlmd_bench_config.thread_env_config().run_workloads_concurrently() &&
+      !workload_stats.empty()) {
+    ThreadStats aggregate_stats = workload_stats[0];
+    for (int w = 1; w < workload_stats.size(); ++w) {
+      aggregate_stats.Merge(workload_stats[w]);
+    }
+    aggregate_stats.Report("aggregate", *report.mutable_aggregate());
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,62 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_DISTRIBUTED_BENCHMARK_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_DISTRIBUTED_BENCHMARK_H
+
+#include "absl/synchronization/mutex.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench_service.grpc.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench_service.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The MLMDBenchWorkerService of an mlmd_bench worker, which runs the
+// benchmarks sent by a coordinator with a ThreadRunner, one at a time.
+class MLMDBenchWorker final : public MLMDBenchWorkerService::Service {
+ public:
+  MLMDBenchWorker() = default;
+
+  // Disallow copy and assign.
+  MLMDBenchWorker(const MLMDBenchWorker&) = delete;
+  MLMDBenchWorker& operator=(const MLMDBenchWorker&) = delete;
+
+  // Waits for the start time of the request, runs its benchmark and returns
+  // the report and workload stats of the worker.
+  ::grpc::Status RunBenchmark(::grpc::ServerContext* context,
+                              const RunBenchmarkRequest* request,
+                              RunBenchmarkResponse* response) override;
+
+ private:
+  // Held while a benchmark runs, so that the benchmarks of several
+  // coordinators do not share the worker.
+  absl::Mutex mu_;
+};
+
+// Runs the benchmark of `mlmd_bench_config` on the workers of its
+// distributed_config, which start at the same time, and reports the stats of
+// the workers merged per workload in `benchmark`, as if its workloads had run
+// in a single process.
+// Returns InvalidArgument error, if the distributed_config has no workers.
+// Returns detailed error, if a worker failed to run the benchmark.
+tensorflow::Status RunDistributedBenchmark(
+    const MLMDBenchConfig& mlmd_bench_config, Benchmark& benchmark);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_DISTRIBUTED_BENCHMARK_H
@@ -0,0 +1,110 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/distributed_benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfWorkers = 2;
+
+// Tests that the workers of a distributed benchmark run its workloads on the
+// shared store, and that their stats are merged in the report.
+TEST(DistributedBenchmarkTest, RunOnWorkersTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 20
+        }
+        thread_env_config: { num_threads: 1 }
+        distributed_config: { start_delay_milliseconds: 100 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-distributed-test.db"));
+
+  std::vector<std::unique_ptr<MLMDBenchWorker>> workers;
+  std::vector<std::unique_ptr<::grpc::Server>> servers;
+  for (int i = 0; i < kNumberOfWorkers; ++i) {
+    workers.push_back(absl::make_unique<MLMDBenchWorker>());
+    ::grpc::ServerBuilder builder;
+    int port = 0;
+    builder.AddListeningPort("localhost:0",
+                             ::grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(workers.back().get());
+    servers.push_back(builder.BuildAndStart());
+    mlmd_bench_config.mutable_distributed_config()->add_worker_addresses(
+        absl::StrCat("localhost:", port));
+  }
+
+  Benchmark benchmark(mlmd_bench_config);
+  TF_ASSERT_OK(RunDistributedBenchmark(mlmd_bench_config, benchmark));
+  for (std::unique_ptr<::grpc::Server>& server : servers) {
+    server->Shutdown();
+  }
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetArtifactTypesResponse get_response;
+  TF_ASSERT_OK(store->GetArtifactTypes(/*request=*/{}, &get_response));
+  EXPECT_EQ(get_response.artifact_types_size(),
+            kNumberOfWorkers * mlmd_bench_config.workload_configs(0)
+                                   .num_operations());
+  const WorkloadConfigResult& summary =
+      benchmark.mlmd_bench_report().summaries(0);
+  EXPECT_GT(summary.microseconds_per_operation(), 0);
+  EXPECT_GT(summary.latency_percentiles().max_microseconds(), 0);
+}
+
+TEST(DistributedBenchmarkTest, NoWorkersTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 20
+        }
+        distributed_config: {}
+      )");
+  Benchmark benchmark(mlmd_bench_config);
+  EXPECT_EQ(RunDistributedBenchmark(mlmd_bench_config, benchmark).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -20,7 +20,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -114,7 +114,7 @@ tensorflow::Status GenerateContextEdges(
     const std::vector<Node>& existing_context_nodes, const int64 num_edges,
     std::discrete_distribution<int64>& non_context_node_index_dist,
     std::discrete_distribution<int64>& context_node_index_dist,
-    std::minstd_rand0& gen, MetadataStore& store,
+    std::minstd_rand0& gen, MetadataStoreServiceInterface& store,
     absl::flat_hash_map<int64, absl::flat_hash_set<int64>>& edges_seen,
     PutAttributionsAndAssociationsRequest& request, int64& curr_bytes) {
   CHECK((std::is_same<T, Attribution>::value ||
@@ -155,7 +155,8 @@ FillContextEdges::FillContextEdges(
                          fill_context_edges_config_.Specification_Name(
                              fill_context_edges_config_.specification()))) {}
 
-tensorflow::Status FillContextEdges::SetUpImpl(MetadataStore* store) {
+tensorflow::Status FillContextEdges::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   int64 curr_bytes = 0;
@@ -210,8 +211,8 @@ tensorflow::Status FillContextEdges::SetUpImpl(MetadataStore* store) {
 }
 
 // Executions of work items.
-tensorflow::Status FillContextEdges::RunOpImpl(const int64 work_items_index,
-                                               MetadataStore* store) {
+tensorflow::Status FillContextEdges::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
   PutAttributionsAndAssociationsRequest put_request =
       work_items_[work_items_index].first;
   PutAttributionsAndAssociationsResponse put_response;
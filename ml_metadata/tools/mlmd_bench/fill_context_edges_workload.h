@@ -17,7 +17,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -49,14 +49,14 @@ class FillContextEdges
   // behavior that also should be included in the performance
   // measurement.
   // Returns detailed error if query executions failed.
-  tensorflow::Status SetUpImpl(MetadataStore* store) final;
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of RunOpImpl() for FillContextEdges workload
   // according to its semantic.
   // Runs the work items(PutAttributionsAndAssociationsRequest) on the store.
   // Returns detailed error if query executions failed.
   tensorflow::Status RunOpImpl(int64 work_items_index,
-                               MetadataStore* store) final;
+                               MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of TearDownImpl() for FillContextEdges workload
   // according to its semantic. Cleans the work items.
@@ -14,13 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/fill_events_workload.h"
 
-#include <algorithm>
-#include <cmath>
 #include <random>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -85,26 +83,6 @@ GenerateCategoricalDistributionWithDirichletPrior(
   return std::discrete_distribution<int64>{weights.begin(), weights.end()};
 }
 
-// Generates and returns a zipf distribution with a configurable `skew`
-// specified by `dist`.
-std::discrete_distribution<int64> GenerateZipfDistributionWithConfigurableSkew(
-    const int64 sample_size, const ZipfDistribution& dist,
-    std::minstd_rand0& gen) {
-  std::vector<double> weights(sample_size);
-  for (int64 i = 0; i < sample_size; ++i) {
-    const int64 rank = i + 1;
-    // Here, we discard the normalize factor since the `discrete_distribution`
-    // will perform the normalization for us.
-    weights[i] = 1 / pow(rank, dist.skew());
-  }
-  // Random shuffles the weight vector.
-  std::shuffle(std::begin(weights), std::end(weights), gen);
-  // Uses these random number generated w.r.t. a zipf distribution with a
-  // configurable `skew` to represent the possibility of being chosen for each
-  // integer within [0, sample_size) in a discrete distribution.
-  return std::discrete_distribution<int64>{weights.begin(), weights.end()};
-}
-
 // Generates and returns the artifact popularity distribution according to the
 // type of event.
 std::discrete_distribution<int64> GeneratePopularityDistributionForArtifacts(
@@ -145,7 +123,7 @@ bool CheckArtifactNotAlreadyBeenOutputtedInSetUpAndRecordItsId(
 // the current artifact has been outputted before. Returns detailed error if
 // query executions failed.
 tensorflow::Status CheckArtifactNotAlreadyBeenOutputtedInDb(
-    const int64 output_artifact_id, MetadataStore& store) {
+    const int64 output_artifact_id, MetadataStoreServiceInterface& store) {
   GetEventsByArtifactIDsRequest request;
   request.add_artifact_ids(output_artifact_id);
   GetEventsByArtifactIDsResponse response;
@@ -211,7 +189,7 @@ tensorflow::Status GenerateEvent(
     const std::vector<Node>& existing_execution_nodes, const int64 num_events,
     std::discrete_distribution<int64>& artifact_index_dist,
     std::discrete_distribution<int64>& execution_index_dist,
-    std::minstd_rand0& gen, MetadataStore& store,
+    std::minstd_rand0& gen, MetadataStoreServiceInterface& store,
     absl::flat_hash_set<int64>& output_artifact_ids, PutEventsRequest& request,
     int64& curr_bytes) {
   int64 i = 0;
@@ -257,7 +235,7 @@ FillEvents::FillEvents(const FillEventsConfig& fill_events_config,
   TF_CHECK_OK(ValidateCorrectArtifactsDistributionType(fill_events_config_));
 }
 
-tensorflow::Status FillEvents::SetUpImpl(MetadataStore* store) {
+tensorflow::Status FillEvents::SetUpImpl(MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   std::uniform_int_distribution<int64> num_events_dist{
@@ -295,7 +273,7 @@ tensorflow::Status FillEvents::SetUpImpl(MetadataStore* store) {
 }
 
 tensorflow::Status FillEvents::RunOpImpl(const int64 work_items_index,
-                                         MetadataStore* store) {
+                                         MetadataStoreServiceInterface* store) {
   PutEventsRequest put_request = work_items_[work_items_index].first;
   PutEventsResponse put_response;
   return store->PutEvents(put_request, &put_response);
@@ -16,7 +16,7 @@ limitations under the License.
 #define ML_METADATA_TOOLS_MLMD_BENCH_FILL_EVENTS_WORKLOAD_H
 
 #include "absl/container/flat_hash_set.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -47,13 +47,13 @@ class FillEvents : public Workload<PutEventsRequest> {
   // each artifact can only be picked once, a rejection sampling will be
   // performed in the process.
   // Returns detailed error if query executions failed.
-  tensorflow::Status SetUpImpl(MetadataStore* store) final;
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of RunOpImpl() for FillEvents workload according to
   // its semantic. Runs the work items(PutEventsRequest) on the store.
   // Returns detailed error if query executions failed.
   tensorflow::Status RunOpImpl(int64 work_items_index,
-                               MetadataStore* store) final;
+                               MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of TearDownImpl() for FillEvents workload according
   // to its semantic. Cleans the work items.
@@ -21,7 +21,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -64,8 +64,8 @@ void InitializePutRequest(const int64 num_nodes,
 // Gets all types inside db. Returns FAILED_PRECONDITION if there is no types
 // inside db for any nodes to insert.
 tensorflow::Status GetAndValidateExistingTypes(
-    const FillNodesConfig& fill_nodes_config, MetadataStore& store,
-    std::vector<Type>& existing_types) {
+    const FillNodesConfig& fill_nodes_config,
+    MetadataStoreServiceInterface& store, std::vector<Type>& existing_types) {
   TF_RETURN_IF_ERROR(
       GetExistingTypes(fill_nodes_config, store, existing_types));
   if (existing_types.empty()) {
@@ -126,7 +126,7 @@ int64 GetTransferredBytesForNodeAttributes(const bool& update, const NT& node) {
 // properties in later SetNodePropertiesGivenType(). Returns detailed error if
 // query executions failed.
 tensorflow::Status SetTypeForUpdateNode(const Artifact& selected_node,
-                                        MetadataStore& store,
+                                        MetadataStoreServiceInterface& store,
                                         ArtifactType& update_type) {
   GetArtifactTypesByIDRequest request;
   request.add_type_ids(selected_node.type_id());
@@ -140,7 +140,7 @@ tensorflow::Status SetTypeForUpdateNode(const Artifact& selected_node,
 // properties in later SetNodePropertiesGivenType(). Returns detailed error if
 // query executions failed.
 tensorflow::Status SetTypeForUpdateNode(const Execution& selected_node,
-                                        MetadataStore& store,
+                                        MetadataStoreServiceInterface& store,
                                         ExecutionType& update_type) {
   GetExecutionTypesByIDRequest request;
   request.add_type_ids(selected_node.type_id());
@@ -154,7 +154,7 @@ tensorflow::Status SetTypeForUpdateNode(const Execution& selected_node,
 // properties in later SetNodePropertiesGivenType(). Returns detailed error if
 // query executions failed.
 tensorflow::Status SetTypeForUpdateNode(const Context& selected_node,
-                                        MetadataStore& store,
+                                        MetadataStoreServiceInterface& store,
                                         ContextType& update_type) {
   GetContextTypesByIDRequest request;
   request.add_type_ids(selected_node.type_id());
@@ -166,8 +166,8 @@ tensorflow::Status SetTypeForUpdateNode(const Context& selected_node,
 
 // Inserts the makeup artifact into db for later update. Returns
 // detailed error if query executions failed.
-tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
-                                                        Artifact& node) {
+tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(
+    MetadataStoreServiceInterface& store, Artifact& node) {
   PutArtifactsRequest request;
   request.add_artifacts()->CopyFrom(node);
   PutArtifactsResponse response;
@@ -179,8 +179,8 @@ tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
 
 // Inserts the makeup execution into db for later update. Returns
 // detailed error if query executions failed.
-tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
-                                                        Execution& node) {
+tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(
+    MetadataStoreServiceInterface& store, Execution& node) {
   PutExecutionsRequest request;
   request.add_executions()->CopyFrom(node);
   PutExecutionsResponse response;
@@ -192,8 +192,8 @@ tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
 
 // Inserts the makeup context into db for later update. Returns
 // detailed error if query executions failed.
-tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
-                                                        Context& node) {
+tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(
+    MetadataStoreServiceInterface& store, Context& node) {
   PutContextsRequest request;
   request.add_contexts()->CopyFrom(node);
   PutContextsResponse response;
@@ -203,16 +203,22 @@ tensorflow::Status PrepareMakeUpNodeInDbAndUpdateNodeId(MetadataStore& store,
   return tensorflow::Status::OK();
 }
 
-// Prepares update node for later update. If there is no left existing nodes in
-// `existing_nodes` to select from, generates a random makeup node under
-// `insert_type` and inserts it into db. Returns detailed error if query
-// executions failed.
+// Prepares update node for later update. If `node_index_dist` is given, picks
+// the node among `existing_nodes` w.r.t. it. Otherwise, if there is no left
+// existing nodes in `existing_nodes` to select from, generates a random makeup
+// node under `insert_type` and inserts it into db. Returns detailed error if
+// query executions failed.
 template <typename T, typename N>
-tensorflow::Status PrepareNodeForUpdate(const T& insert_type, const int64 i,
-                                        MetadataStore& store,
-                                        std::vector<Node>& existing_nodes,
-                                        N& node, T& update_type) {
-  if (!existing_nodes.empty()) {
+tensorflow::Status PrepareNodeForUpdate(
+    const T& insert_type, const int64 i,
+    std::discrete_distribution<int64>* node_index_dist, std::minstd_rand0& gen,
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes,
+    N& node, T& update_type) {
+  if (node_index_dist != nullptr) {
+    // The popular nodes are kept, so that they are updated several times.
+    node = absl::get<N>(existing_nodes[(*node_index_dist)(gen)]);
+    TF_RETURN_IF_ERROR(SetTypeForUpdateNode(node, store, update_type));
+  } else if (!existing_nodes.empty()) {
     Node existing_node = existing_nodes.back();
     node = absl::get<N>(existing_node);
     TF_RETURN_IF_ERROR(SetTypeForUpdateNode(node, store, update_type));
@@ -329,7 +335,11 @@ int64 SetNodePropertiesGivenType(const FillNodesConfig& fill_nodes_config,
 template <typename T, typename N>
 tensorflow::Status GenerateNodes(const FillNodesConfig& fill_nodes_config,
                                  const NodesParam& nodes_param,
-                                 const T& insert_type, MetadataStore& store,
+                                 const T& insert_type,
+                                 std::discrete_distribution<int64>*
+                                     update_node_index_dist,
+                                 std::minstd_rand0& gen,
+                                 MetadataStoreServiceInterface& store,
                                  std::vector<Node>& existing_nodes,
                                  google::protobuf::RepeatedPtrField<N>& nodes,
                                  int64& curr_bytes) {
@@ -347,7 +357,8 @@ tensorflow::Status GenerateNodes(const FillNodesConfig& fill_nodes_config,
       // Update mode.
       T update_type;
       TF_RETURN_IF_ERROR(PrepareNodeForUpdate<T, N>(
-          insert_type, i, store, existing_nodes, nodes[i], update_type));
+          insert_type, i, update_node_index_dist, gen, store, existing_nodes,
+          nodes[i], update_type));
       // Uses `update_type` when calling SetNodePropertiesGivenType() for update
       // mode.
       curr_bytes += SetNodePropertiesGivenType(fill_nodes_config, nodes_param,
@@ -406,7 +417,7 @@ FillNodes::FillNodes(const FillNodesConfig& fill_nodes_config,
         return name;
       }())) {}
 
-tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
+tensorflow::Status FillNodes::SetUpImpl(MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
   int64 curr_bytes = 0;
 
@@ -423,6 +434,20 @@ tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
   TF_RETURN_IF_ERROR(
       GetExistingNodes(fill_nodes_config_, *store, existing_nodes));
   std::shuffle(std::begin(existing_nodes), std::end(existing_nodes), gen);
+  // If the popularity of the updated nodes is given, they are picked w.r.t.
+  // it instead of once each.
+  std::discrete_distribution<int64> update_node_index_dist;
+  const bool pick_update_nodes =
+      fill_nodes_config_.update() &&
+      fill_nodes_config_.has_update_node_popularity() &&
+      !existing_nodes.empty();
+  if (pick_update_nodes) {
+    TF_RETURN_IF_ERROR(
+        ValidateNodePopularity(fill_nodes_config_.update_node_popularity()));
+    update_node_index_dist = GenerateNodePopularityDistribution(
+        existing_nodes.size(), fill_nodes_config_.update_node_popularity(),
+        gen);
+  }
 
   for (int64 i = 0; i < num_operations_; ++i) {
     curr_bytes = 0;
@@ -439,7 +464,8 @@ tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
             absl::get<PutArtifactsRequest>(put_request).mutable_artifacts();
         TF_RETURN_IF_ERROR(GenerateNodes<ArtifactType, Artifact>(
             fill_nodes_config_, nodes_param,
-            absl::get<ArtifactType>(existing_types[type_index]), *store,
+            absl::get<ArtifactType>(existing_types[type_index]),
+            pick_update_nodes ? &update_node_index_dist : nullptr, gen, *store,
             existing_nodes, *nodes, curr_bytes));
         curr_bytes +=
             SetArtifactsAdditionalFields(nodes_param.nodes_name, *nodes);
@@ -451,7 +477,8 @@ tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
             absl::get<PutExecutionsRequest>(put_request).mutable_executions();
         TF_RETURN_IF_ERROR(GenerateNodes<ExecutionType, Execution>(
             fill_nodes_config_, nodes_param,
-            absl::get<ExecutionType>(existing_types[type_index]), *store,
+            absl::get<ExecutionType>(existing_types[type_index]),
+            pick_update_nodes ? &update_node_index_dist : nullptr, gen, *store,
             existing_nodes, *nodes, curr_bytes));
         curr_bytes += SetExecutionsAdditionalFields(*nodes);
         break;
@@ -460,7 +487,8 @@ tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
         InitializePutRequest<PutContextsRequest>(num_nodes, put_request);
         TF_RETURN_IF_ERROR(GenerateNodes<ContextType, Context>(
             fill_nodes_config_, nodes_param,
-            absl::get<ContextType>(existing_types[type_index]), *store,
+            absl::get<ContextType>(existing_types[type_index]),
+            pick_update_nodes ? &update_node_index_dist : nullptr, gen, *store,
             existing_nodes,
             *absl::get<PutContextsRequest>(put_request).mutable_contexts(),
             curr_bytes));
@@ -476,7 +504,7 @@ tensorflow::Status FillNodes::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status FillNodes::RunOpImpl(const int64 work_items_index,
-                                        MetadataStore* store) {
+                                        MetadataStoreServiceInterface* store) {
   switch (fill_nodes_config_.specification()) {
     case FillNodesConfig::ARTIFACT: {
       PutArtifactsRequest put_request =
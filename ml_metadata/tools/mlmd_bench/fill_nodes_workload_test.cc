@@ -451,6 +451,33 @@ TEST_P(FillNodesUpdateParameterizedTestFixture,
                fill_nodes_update_->num_operations());
 }
 
+// Tests the SetUpImpl() and RunOpImpl() for FillNodes update cases with the
+// popularity of the updated nodes. Checks the existing nodes are updated
+// several times instead of making up new nodes, even if there are not enough
+// of them.
+TEST_P(FillNodesUpdateParameterizedTestFixture, UpdatePopularNodesTest) {
+  TF_ASSERT_OK(InsertNodesInDb(
+      /*num_artifact_nodes=*/kNumberOfExistedNodesButNotEnoughForUpdate,
+      /*num_execution_nodes=*/kNumberOfExistedNodesButNotEnoughForUpdate,
+      /*num_context_nodes=*/kNumberOfExistedNodesButNotEnoughForUpdate,
+      *store_));
+  FillNodesConfig fill_nodes_config = GetParam().fill_nodes_config();
+  HotSetDistribution& hot_set =
+      *fill_nodes_config.mutable_update_node_popularity()->mutable_hot_set();
+  hot_set.set_hot_node_fraction(0.1);
+  hot_set.set_hot_operation_fraction(0.9);
+  FillNodes fill_nodes_update(fill_nodes_config, GetParam().num_operations());
+  TF_ASSERT_OK(fill_nodes_update.SetUp(store_.get()));
+  for (int64 i = 0; i < fill_nodes_update.num_operations(); ++i) {
+    OpStats op_stats;
+    TF_ASSERT_OK(fill_nodes_update.RunOp(i, store_.get(), op_stats));
+  }
+
+  std::vector<Node> existing_nodes;
+  TF_ASSERT_OK(GetExistingNodes(fill_nodes_config, *store_, existing_nodes));
+  EXPECT_EQ(existing_nodes.size(), kNumberOfExistedNodesButNotEnoughForUpdate);
+}
+
 INSTANTIATE_TEST_CASE_P(FillNodesInsertTest,
                         FillNodesInsertParameterizedTestFixture,
                         ValuesIn(EnumerateConfigs(/*is_update=*/false)));
@@ -0,0 +1,263 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/fill_pipeline_runs_workload.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int64 kInt64IdSize = 8;
+constexpr int64 kNumNodeIdsPerEdge = 2;
+constexpr int64 kEventTypeSize = 1;
+constexpr int64 kExecutionStateSize = 1;
+
+constexpr char kArtifactTypeName[] = "mlmd_bench_pipeline_artifact";
+constexpr char kExecutionTypeName[] = "mlmd_bench_pipeline_component";
+constexpr char kContextTypeName[] = "mlmd_bench_pipeline_run";
+
+// The ids of the types of the simulated pipelines.
+struct PipelineTypeIds {
+  int64 artifact_type_id;
+  int64 execution_type_id;
+  int64 context_type_id;
+};
+
+// Validates the distributions and probability of `fill_pipeline_runs_config`.
+// Returns INVALID_ARGUMENT error if one of them is not correct.
+tensorflow::Status ValidateFillPipelineRunsConfig(
+    const FillPipelineRunsConfig& fill_pipeline_runs_config) {
+  if (fill_pipeline_runs_config.num_executions_per_pipeline_run() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_executions_per_pipeline_run must be positive.");
+  }
+  for (const UniformDistribution& dist :
+       {fill_pipeline_runs_config.num_input_artifacts(),
+        fill_pipeline_runs_config.num_output_artifacts()}) {
+    if (dist.minimum() < 0 || dist.minimum() > dist.maximum()) {
+      return tensorflow::errors::InvalidArgument(
+          "The number of artifacts must be a non-negative range.");
+    }
+  }
+  if (fill_pipeline_runs_config.failure_probability() < 0 ||
+      fill_pipeline_runs_config.failure_probability() > 1) {
+    return tensorflow::errors::InvalidArgument(
+        "The failure_probability must be within [0, 1].");
+  }
+  return tensorflow::Status::OK();
+}
+
+// Registers the types of the simulated pipelines, or gets the ids of the
+// registered ones, into `type_ids`. Returns detailed error if query executions
+// failed.
+tensorflow::Status PutPipelineTypes(MetadataStoreServiceInterface& store,
+                                    PipelineTypeIds& type_ids) {
+  PutTypesRequest request;
+  request.add_artifact_types()->set_name(kArtifactTypeName);
+  request.add_execution_types()->set_name(kExecutionTypeName);
+  request.add_context_types()->set_name(kContextTypeName);
+  PutTypesResponse response;
+  TF_RETURN_IF_ERROR(store.PutTypes(request, &response));
+  type_ids.artifact_type_id = response.artifact_type_ids(0);
+  type_ids.execution_type_id = response.execution_type_ids(0);
+  type_ids.context_type_id = response.context_type_ids(0);
+  return tensorflow::Status::OK();
+}
+
+// Adds `num_inputs` distinct input artifacts, picked among
+// `existing_artifact_nodes` w.r.t. `artifact_index_dist`, to `request`
+// while recording the transferred bytes for them.
+void AddInputArtifacts(const std::vector<Node>& existing_artifact_nodes,
+                       const int64 num_inputs,
+                       std::discrete_distribution<int64>& artifact_index_dist,
+                       std::minstd_rand0& gen, PutExecutionRequest& request,
+                       int64& curr_bytes) {
+  absl::flat_hash_set<int64> input_artifact_ids;
+  while (input_artifact_ids.size() < num_inputs) {
+    const int64 artifact_id =
+        absl::get<Artifact>(existing_artifact_nodes[artifact_index_dist(gen)])
+            .id();
+    // Rejection sampling, as an execution reads each input once.
+    if (!input_artifact_ids.insert(artifact_id).second) {
+      continue;
+    }
+    Event& event = *request.add_artifact_event_pairs()->mutable_event();
+    event.set_type(Event::INPUT);
+    event.set_artifact_id(artifact_id);
+    curr_bytes += kInt64IdSize * kNumNodeIdsPerEdge + kEventTypeSize;
+  }
+}
+
+// Adds `num_outputs` new output artifacts of `execution_name` to `request`
+// while recording the transferred bytes for them.
+void AddOutputArtifacts(const int64 artifact_type_id,
+                        const std::string& execution_name,
+                        const int64 num_outputs, PutExecutionRequest& request,
+                        int64& curr_bytes) {
+  for (int64 i = 0; i < num_outputs; ++i) {
+    PutExecutionRequest::ArtifactAndEvent& pair =
+        *request.add_artifact_event_pairs();
+    Artifact& artifact = *pair.mutable_artifact();
+    artifact.set_type_id(artifact_type_id);
+    artifact.set_name(absl::StrCat(execution_name, "_output_", i));
+    artifact.set_uri(absl::StrCat(artifact.name(), "_uri"));
+    artifact.set_state(Artifact::LIVE);
+    pair.mutable_event()->set_type(Event::OUTPUT);
+    curr_bytes += artifact.name().size() + artifact.uri().size() +
+                  kInt64IdSize * kNumNodeIdsPerEdge + kEventTypeSize;
+  }
+}
+
+// Sets the execution of `request` in `state` w.r.t. `execution`, within the
+// context of its pipeline run, while recording the transferred bytes for them.
+void SetExecutionAndContext(const Execution& execution,
+                            const Execution::State state,
+                            const Context& context,
+                            PutExecutionRequest& request, int64& curr_bytes) {
+  *request.mutable_execution() = execution;
+  request.mutable_execution()->set_last_known_state(state);
+  *request.add_contexts() = context;
+  // The context is created by the first execution of its pipeline run, and
+  // reused by the following ones.
+  request.mutable_options()->set_reuse_context_if_already_exist(true);
+  curr_bytes += execution.name().size() + kExecutionStateSize +
+                context.name().size();
+}
+
+}  // namespace
+
+FillPipelineRuns::FillPipelineRuns(
+    const FillPipelineRunsConfig& fill_pipeline_runs_config,
+    int64 num_operations)
+    : fill_pipeline_runs_config_(fill_pipeline_runs_config),
+      num_operations_(num_operations),
+      name_("FILL_PIPELINE_RUNS") {
+  TF_CHECK_OK(ValidateFillPipelineRunsConfig(fill_pipeline_runs_config_));
+}
+
+tensorflow::Status FillPipelineRuns::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
+  LOG(INFO) << "Setting up ...";
+
+  PipelineTypeIds type_ids;
+  TF_RETURN_IF_ERROR(PutPipelineTypes(*store, type_ids));
+
+  std::vector<Node> existing_artifact_nodes;
+  FillNodesConfig fill_artifacts_config;
+  fill_artifacts_config.set_specification(FillNodesConfig::ARTIFACT);
+  TF_RETURN_IF_ERROR(GetExistingNodes(fill_artifacts_config, *store,
+                                      existing_artifact_nodes));
+  if (existing_artifact_nodes.empty() &&
+      fill_pipeline_runs_config_.num_input_artifacts().maximum() > 0) {
+    return tensorflow::errors::FailedPrecondition(
+        "There are no existing artifacts for the inputs of the executions.");
+  }
+
+  std::uniform_int_distribution<int64> num_inputs_dist{
+      fill_pipeline_runs_config_.num_input_artifacts().minimum(),
+      fill_pipeline_runs_config_.num_input_artifacts().maximum()};
+  std::uniform_int_distribution<int64> num_outputs_dist{
+      fill_pipeline_runs_config_.num_output_artifacts().minimum(),
+      fill_pipeline_runs_config_.num_output_artifacts().maximum()};
+  std::bernoulli_distribution failed_dist{
+      fill_pipeline_runs_config_.failure_probability()};
+
+  std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  std::discrete_distribution<int64> artifact_index_dist =
+      GenerateZipfDistributionWithConfigurableSkew(
+          existing_artifact_nodes.size(),
+          fill_pipeline_runs_config_.input_artifact_popularity(), gen);
+
+  const std::string nodes_name =
+      absl::StrCat("pipeline_run", absl::FormatTime(absl::Now()));
+  for (int64 i = 0; i < num_operations_; ++i) {
+    int64 curr_bytes = 0;
+    Context context;
+    context.set_type_id(type_ids.context_type_id);
+    context.set_name(absl::StrCat(
+        nodes_name, "_",
+        i / fill_pipeline_runs_config_.num_executions_per_pipeline_run()));
+    Execution execution;
+    execution.set_type_id(type_ids.execution_type_id);
+    execution.set_name(absl::StrCat(nodes_name, "_execution_", i));
+    const Execution::State final_state =
+        failed_dist(gen) ? Execution::FAILED : Execution::COMPLETE;
+
+    // The inputs are published with the first request, and the outputs with
+    // the final one.
+    std::vector<PutExecutionRequest> put_requests(
+        fill_pipeline_runs_config_.publish_running_state() ? 2 : 1);
+    if (put_requests.size() > 1) {
+      SetExecutionAndContext(execution, Execution::RUNNING, context,
+                             put_requests.front(), curr_bytes);
+    }
+    SetExecutionAndContext(execution, final_state, context, put_requests.back(),
+                           curr_bytes);
+    const int64 num_inputs =
+        std::min<int64>(num_inputs_dist(gen), existing_artifact_nodes.size());
+    AddInputArtifacts(existing_artifact_nodes, num_inputs, artifact_index_dist,
+                      gen, put_requests.front(), curr_bytes);
+    if (final_state == Execution::COMPLETE) {
+      AddOutputArtifacts(type_ids.artifact_type_id, execution.name(),
+                         num_outputs_dist(gen), put_requests.back(),
+                         curr_bytes);
+    }
+    work_items_.emplace_back(put_requests, curr_bytes);
+  }
+
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status FillPipelineRuns::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
+  int64 execution_id = -1;
+  for (const PutExecutionRequest& request :
+       work_items_[work_items_index].first) {
+    PutExecutionRequest put_request = request;
+    if (execution_id != -1) {
+      put_request.mutable_execution()->set_id(execution_id);
+    }
+    PutExecutionResponse put_response;
+    TF_RETURN_IF_ERROR(store->PutExecution(put_request, &put_response));
+    execution_id = put_response.execution_id();
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status FillPipelineRuns::TearDownImpl() {
+  work_items_.clear();
+  return tensorflow::Status::OK();
+}
+
+std::string FillPipelineRuns::GetName() { return name_; }
+
+}  // namespace ml_metadata
@@ -0,0 +1,78 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_FILL_PIPELINE_RUNS_WORKLOAD_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_FILL_PIPELINE_RUNS_WORKLOAD_H
+
+#include <vector>
+
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A specific workload for publishing the component runs of pipelines. Each
+// work item is the list of PutExecutionRequests of a component run, which are
+// sent in order.
+class FillPipelineRuns : public Workload<std::vector<PutExecutionRequest>> {
+ public:
+  FillPipelineRuns(const FillPipelineRunsConfig& fill_pipeline_runs_config,
+                   int64 num_operations);
+  ~FillPipelineRuns() override = default;
+
+ protected:
+  // Specific implementation of SetUpImpl() for FillPipelineRuns workload
+  // according to its semantic. The artifact, execution and context types of
+  // the pipelines are registered, and a list of work items is generated.
+  // Each execution is in the context of its pipeline run, which it shares with
+  // `num_executions_per_pipeline_run` consecutive executions. Its inputs are
+  // picked among the existing artifacts w.r.t. a zipf distribution of their
+  // popularity, and its outputs are new artifacts. A FAILED execution has no
+  // outputs.
+  // Returns FailedPrecondition error, if inputs are specified while there are
+  // no artifacts in db.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of RunOpImpl() for FillPipelineRuns workload
+  // according to its semantic. Sends the PutExecutionRequests of the work item
+  // in order, each updating the execution published by the previous one.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status RunOpImpl(int64 work_items_index,
+                               MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of TearDownImpl() for FillPipelineRuns workload
+  // according to its semantic. Cleans the work items.
+  tensorflow::Status TearDownImpl() final;
+
+  // Gets the current workload's name, which is used in stats report for this
+  // workload.
+  std::string GetName() final;
+
+ private:
+  // Workload configurations specified by the users.
+  const FillPipelineRunsConfig fill_pipeline_runs_config_;
+  // Number of operations for the current workload.
+  const int64 num_operations_;
+  // String for indicating the name of current workload instance.
+  const std::string name_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_FILL_PIPELINE_RUNS_WORKLOAD_H
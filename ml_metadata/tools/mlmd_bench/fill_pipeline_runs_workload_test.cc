@@ -0,0 +1,163 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/fill_pipeline_runs_workload.h"
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfOperations = 50;
+constexpr int kNumberOfExecutionsPerPipelineRun = 5;
+constexpr int kNumberOfExistedTypesInDb = 10;
+constexpr int kNumberOfExistedNodesInDb = 100;
+constexpr int kNumberOfInputArtifacts = 3;
+constexpr int kNumberOfOutputArtifacts = 2;
+
+// Enumerates the workload configurations as the test parameters that ensure
+// test coverage.
+std::vector<WorkloadConfig> EnumerateConfigs() {
+  std::vector<WorkloadConfig> configs;
+
+  for (const bool publish_running_state : {false, true}) {
+    WorkloadConfig config = testing::ParseTextProtoOrDie<WorkloadConfig>(R"(
+      fill_pipeline_runs_config: {
+        num_input_artifacts: { minimum: 3 maximum: 3 }
+        input_artifact_popularity: { skew: 1.0 }
+        num_output_artifacts: { minimum: 2 maximum: 2 }
+      }
+    )");
+    config.set_num_operations(kNumberOfOperations);
+    config.mutable_fill_pipeline_runs_config()
+        ->set_num_executions_per_pipeline_run(
+            kNumberOfExecutionsPerPipelineRun);
+    config.mutable_fill_pipeline_runs_config()->set_publish_running_state(
+        publish_running_state);
+    configs.push_back(config);
+  }
+
+  return configs;
+}
+
+// Test fixture that uses the same data configuration for multiple following
+// parameterized FillPipelineRuns tests.
+// The parameter here is the specific Workload configuration that contains
+// the FillPipelineRuns configuration and the number of operations.
+class FillPipelineRunsParameterizedTestFixture
+    : public ::testing::TestWithParam<WorkloadConfig> {
+ protected:
+  void SetUp() override {
+    ConnectionConfig mlmd_config;
+    // Uses a fake in-memory SQLite database for testing.
+    mlmd_config.mutable_fake_database();
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store_));
+    TF_ASSERT_OK(InsertTypesInDb(
+        /*num_artifact_types=*/kNumberOfExistedTypesInDb,
+        /*num_execution_types=*/kNumberOfExistedTypesInDb,
+        /*num_context_types=*/kNumberOfExistedTypesInDb, *store_));
+    TF_ASSERT_OK(InsertNodesInDb(
+        /*num_artifact_nodes=*/kNumberOfExistedNodesInDb,
+        /*num_execution_nodes=*/0,
+        /*num_context_nodes=*/0, *store_));
+  }
+
+  // Runs all the operations of a FillPipelineRuns workload of `config`.
+  void RunWorkload(const WorkloadConfig& config) {
+    FillPipelineRuns fill_pipeline_runs(config.fill_pipeline_runs_config(),
+                                        config.num_operations());
+    TF_ASSERT_OK(fill_pipeline_runs.SetUp(store_.get()));
+    for (int64 i = 0; i < fill_pipeline_runs.num_operations(); ++i) {
+      OpStats op_stats;
+      TF_ASSERT_OK(fill_pipeline_runs.RunOp(i, store_.get(), op_stats));
+      EXPECT_GT(op_stats.transferred_bytes, 0);
+    }
+    TF_ASSERT_OK(fill_pipeline_runs.TearDown());
+  }
+
+  std::unique_ptr<MetadataStore> store_;
+};
+
+// Tests the RunOpImpl() for FillPipelineRuns. Checks that each operation
+// published a COMPLETE execution with its inputs and outputs, and that the
+// consecutive executions of a pipeline run share its context.
+TEST_P(FillPipelineRunsParameterizedTestFixture, InsertPipelineRunsTest) {
+  ASSERT_NO_FATAL_FAILURE(RunWorkload(GetParam()));
+
+  GetExecutionsResponse executions_response;
+  TF_ASSERT_OK(store_->GetExecutions(/*request=*/{}, &executions_response));
+  ASSERT_EQ(executions_response.executions_size(), kNumberOfOperations);
+  GetEventsByExecutionIDsRequest events_request;
+  for (const Execution& execution : executions_response.executions()) {
+    EXPECT_EQ(execution.last_known_state(), Execution::COMPLETE);
+    events_request.add_execution_ids(execution.id());
+  }
+  GetEventsByExecutionIDsResponse events_response;
+  TF_ASSERT_OK(
+      store_->GetEventsByExecutionIDs(events_request, &events_response));
+  EXPECT_EQ(events_response.events_size(),
+            kNumberOfOperations *
+                (kNumberOfInputArtifacts + kNumberOfOutputArtifacts));
+
+  GetArtifactsResponse artifacts_response;
+  TF_ASSERT_OK(store_->GetArtifacts(/*request=*/{}, &artifacts_response));
+  EXPECT_EQ(artifacts_response.artifacts_size(),
+            kNumberOfExistedNodesInDb +
+                kNumberOfOperations * kNumberOfOutputArtifacts);
+
+  GetContextsResponse contexts_response;
+  TF_ASSERT_OK(store_->GetContexts(/*request=*/{}, &contexts_response));
+  ASSERT_EQ(contexts_response.contexts_size(),
+            kNumberOfOperations / kNumberOfExecutionsPerPipelineRun);
+  GetExecutionsByContextRequest by_context_request;
+  by_context_request.set_context_id(contexts_response.contexts(0).id());
+  GetExecutionsByContextResponse by_context_response;
+  TF_ASSERT_OK(
+      store_->GetExecutionsByContext(by_context_request, &by_context_response));
+  EXPECT_EQ(by_context_response.executions_size(),
+            kNumberOfExecutionsPerPipelineRun);
+}
+
+// Tests that the FAILED executions have their inputs but no outputs.
+TEST_P(FillPipelineRunsParameterizedTestFixture, InsertFailedPipelineRunsTest) {
+  WorkloadConfig config = GetParam();
+  config.mutable_fill_pipeline_runs_config()->set_failure_probability(1.0);
+  ASSERT_NO_FATAL_FAILURE(RunWorkload(config));
+
+  GetExecutionsResponse executions_response;
+  TF_ASSERT_OK(store_->GetExecutions(/*request=*/{}, &executions_response));
+  ASSERT_EQ(executions_response.executions_size(), kNumberOfOperations);
+  for (const Execution& execution : executions_response.executions()) {
+    EXPECT_EQ(execution.last_known_state(), Execution::FAILED);
+  }
+  GetArtifactsResponse artifacts_response;
+  TF_ASSERT_OK(store_->GetArtifacts(/*request=*/{}, &artifacts_response));
+  EXPECT_EQ(artifacts_response.artifacts_size(), kNumberOfExistedNodesInDb);
+}
+
+INSTANTIATE_TEST_CASE_P(FillPipelineRunsTest,
+                        FillPipelineRunsParameterizedTestFixture,
+                        ::testing::ValuesIn(EnumerateConfigs()));
+
+}  // namespace
+}  // namespace ml_metadata
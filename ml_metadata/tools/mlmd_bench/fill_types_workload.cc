@@ -21,7 +21,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -72,7 +72,7 @@ tensorflow::Status PrepareTypeForUpdate(const int64 type_index,
                                         const std::string& type_name,
                                         const int64 num_properties,
                                         const std::vector<Type>& existing_types,
-                                        MetadataStore* store,
+                                        MetadataStoreServiceInterface* store,
                                         T& existing_type) {
   if (type_index < existing_types.size()) {
     existing_type = absl::get<T>(existing_types[type_index]);
@@ -130,7 +130,7 @@ tensorflow::Status GenerateType(const FillTypesConfig& fill_types_config,
                                 const std::string& type_name,
                                 const int64 num_properties,
                                 const std::vector<Type>& existing_types,
-                                MetadataStore* store, T& type,
+                                MetadataStoreServiceInterface* store, T& type,
                                 int64& curr_bytes) {
   CHECK((std::is_same<T, ArtifactType>::value ||
          std::is_same<T, ExecutionType>::value ||
@@ -166,7 +166,7 @@ FillTypes::FillTypes(const FillTypesConfig& fill_types_config,
         return name;
       }())) {}
 
-tensorflow::Status FillTypes::SetUpImpl(MetadataStore* store) {
+tensorflow::Status FillTypes::SetUpImpl(MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   int64 curr_bytes = 0;
@@ -233,7 +233,7 @@ tensorflow::Status FillTypes::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status FillTypes::RunOpImpl(const int64 work_items_index,
-                                        MetadataStore* store) {
+                                        MetadataStoreServiceInterface* store) {
   const int64 i = work_items_index;
   switch (fill_types_config_.specification()) {
     case FillTypesConfig::ARTIFACT_TYPE: {
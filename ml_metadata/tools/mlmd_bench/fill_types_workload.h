@@ -16,7 +16,7 @@ limitations under the License.
 #define ML_METADATA_TOOLS_MLMD_BENCH_FILL_TYPES_WORKLOAD_H
 
 #include "absl/types/variant.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -51,13 +51,13 @@ class FillTypes : public Workload<FillTypesWorkItemType> {
   // the existed types. The number of new properties is derived from the
   // uniform distribution.
   // Returns detailed error if query executions failed.
-  tensorflow::Status SetUpImpl(MetadataStore* store) final;
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of RunOpImpl() for FillTypes workload according to
   // its semantic. Runs the work items(FillTypesRequests) on the store. Returns
   // detailed error if query executions failed.
   tensorflow::Status RunOpImpl(int64 work_items_index,
-                               MetadataStore* store) final;
+                               MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of TearDownImpl() for FillTypes workload according
   // to its semantic. Cleans the work_items_.
@@ -0,0 +1,119 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/grpc_metadata_store_client.h"
+
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the credentials of the channels to the server of `client_config`:
+// SSL ones if its ssl_config is set, or insecure ones otherwise.
+std::shared_ptr<::grpc::ChannelCredentials> GetChannelCredentials(
+    const MetadataStoreClientConfig& client_config) {
+  if (!client_config.has_ssl_config()) {
+    return ::grpc::InsecureChannelCredentials();
+  }
+  ::grpc::SslCredentialsOptions ssl_options;
+  ssl_options.pem_root_certs = client_config.ssl_config().custom_ca();
+  ssl_options.pem_private_key = client_config.ssl_config().client_key();
+  ssl_options.pem_cert_chain = client_config.ssl_config().server_cert();
+  return ::grpc::SslCredentials(ssl_options);
+}
+
+}  // namespace
+
+GrpcMetadataStoreChannel::GrpcMetadataStoreChannel(
+    std::shared_ptr<::grpc::Channel> channel, const int max_in_flight_requests,
+    const absl::Duration timeout)
+    : stub_(MetadataStoreService::NewStub(channel)),
+      max_in_flight_requests_(max_in_flight_requests),
+      timeout_(timeout) {}
+
+void GrpcMetadataStoreChannel::StartRequest() {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(
+      absl::Condition(this, &GrpcMetadataStoreChannel::HasCapacityLocked));
+  ++num_in_flight_requests_;
+}
+
+void GrpcMetadataStoreChannel::FinishRequest() {
+  absl::MutexLock lock(&mu_);
+  --num_in_flight_requests_;
+}
+
+bool GrpcMetadataStoreChannel::HasCapacityLocked() const {
+  return max_in_flight_requests_ == 0 ||
+         num_in_flight_requests_ < max_in_flight_requests_;
+}
+
+tensorflow::Status CreateGrpcMetadataStoreChannels(
+    const GrpcClientConfig& grpc_client_config,
+    std::vector<std::unique_ptr<GrpcMetadataStoreChannel>>& channels) {
+  const MetadataStoreClientConfig& client_config =
+      grpc_client_config.client_config();
+  if (!client_config.has_host() || !client_config.has_port()) {
+    return tensorflow::errors::InvalidArgument(
+        "The host and port of the metadata store server must be set.");
+  }
+  if (grpc_client_config.num_channels() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_channels must be positive.");
+  }
+  if (grpc_client_config.max_in_flight_requests_per_channel() < 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The max_in_flight_requests_per_channel must not be negative.");
+  }
+  const std::string target =
+      absl::StrCat(client_config.host(), ":", client_config.port());
+  const std::shared_ptr<::grpc::ChannelCredentials> credentials =
+      GetChannelCredentials(client_config);
+  const absl::Duration timeout =
+      client_config.has_client_timeout_sec()
+          ? absl::Seconds(client_config.client_timeout_sec())
+          : absl::InfiniteDuration();
+  channels.clear();
+  for (int i = 0; i < grpc_client_config.num_channels(); ++i) {
+    ::grpc::ChannelArguments channel_arguments;
+    // The channels with the same arguments would otherwise share their
+    // connections to the server.
+    channel_arguments.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    if (client_config.channel_arguments().has_max_receive_message_length()) {
+      channel_arguments.SetMaxReceiveMessageSize(
+          client_config.channel_arguments().max_receive_message_length());
+    }
+    channels.push_back(absl::make_unique<GrpcMetadataStoreChannel>(
+        ::grpc::CreateCustomChannel(target, credentials, channel_arguments),
+        grpc_client_config.max_in_flight_requests_per_channel(), timeout));
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status FromGrpcStatus(const ::grpc::Status& status) {
+  // Note: the tensorflow and grpc status codes align with each other.
+  return tensorflow::Status(
+      static_cast<tensorflow::error::Code>(status.error_code()),
+      status.error_message());
+}
+
+}  // namespace ml_metadata
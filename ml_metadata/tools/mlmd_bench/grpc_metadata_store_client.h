@@ -0,0 +1,190 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_GRPC_METADATA_STORE_CLIENT_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_GRPC_METADATA_STORE_CLIENT_H
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/support/status.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A gRPC channel to a metadata store server, shared by the clients of
+// several threads. It bounds the number of requests in flight on the channel:
+// a request waits until one of the in-flight requests finishes.
+class GrpcMetadataStoreChannel {
+ public:
+  // Creates a channel on `channel` with at most `max_in_flight_requests`
+  // requests in flight, or no limit if it is 0. A request fails with
+  // DEADLINE_EXCEEDED if it does not finish within `timeout`.
+  GrpcMetadataStoreChannel(std::shared_ptr<::grpc::Channel> channel,
+                           int max_in_flight_requests, absl::Duration timeout);
+
+  // Disallow copy and assign.
+  GrpcMetadataStoreChannel(const GrpcMetadataStoreChannel&) = delete;
+  GrpcMetadataStoreChannel& operator=(const GrpcMetadataStoreChannel&) =
+      delete;
+
+  // Sends `request` with the unary `method` of the stub and waits for its
+  // `response`, once there is room for one more request in flight.
+  template <typename Request, typename Response>
+  tensorflow::Status Call(
+      ::grpc::Status (MetadataStoreService::Stub::*method)(
+          ::grpc::ClientContext*, const Request&, Response*),
+      const Request& request, Response* response);
+
+ private:
+  // Waits until fewer than `max_in_flight_requests_` requests are in flight
+  // and counts one more.
+  void StartRequest();
+
+  // Counts one request less in flight.
+  void FinishRequest();
+
+  // Returns true if one more request can be in flight.
+  bool HasCapacityLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::unique_ptr<MetadataStoreService::Stub> stub_;
+  const int max_in_flight_requests_;
+  const absl::Duration timeout_;
+
+  absl::Mutex mu_;
+  int num_in_flight_requests_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// A MetadataStoreServiceInterface which sends the requests to a metadata
+// store server on a GrpcMetadataStoreChannel, e.g., to measure the server's
+// threading and serialization besides the queries of its MetadataStore. The
+// streaming methods are not supported, as the workloads do not use them.
+class GrpcMetadataStoreClient : public MetadataStoreServiceInterface {
+ public:
+  // Creates a client on `channel`, which must outlive the client.
+  explicit GrpcMetadataStoreClient(GrpcMetadataStoreChannel* channel)
+      : channel_(channel) {}
+
+#define GRPC_METADATA_STORE_CLIENT_METHOD(method)                         \
+  tensorflow::Status method(const method##Request& request,               \
+                            method##Response* response) final {           \
+    return channel_->Call(&MetadataStoreService::Stub::method, request,   \
+                          response);                                      \
+  }
+
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutArtifacts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutArtifactType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutExecutions)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutExecutionType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutEvents)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutExecution)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutTypes)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutContextType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutAttributionsAndAssociations)
+  GRPC_METADATA_STORE_CLIENT_METHOD(PutParentContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(DeleteArtifacts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(DeleteExecutions)
+  GRPC_METADATA_STORE_CLIENT_METHOD(CollectGarbage)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactTypesByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactTypes)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionTypesByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionTypes)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextTypesByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextTypes)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifacts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutions)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionsByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByID)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactByTypeAndName)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionsByType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionByTypeAndName)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByType)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextByTypeAndName)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByTypeAndNames)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionsByTypeAndNames)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByTypeAndNames)
+  GRPC_METADATA_STORE_CLIENT_METHOD(CountArtifacts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(CountExecutions)
+  GRPC_METADATA_STORE_CLIENT_METHOD(CountContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(AggregateProperty)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByURI)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByURIPrefix)
+  GRPC_METADATA_STORE_CLIENT_METHOD(ArtifactsExist)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetEventsByExecutionIDs)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetEventsByArtifactIDs)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByArtifact)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByExecution)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetParentContextsByContext)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetChildrenContextsByContext)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByContext)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionsByContext)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetArtifactsByContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetExecutionsByContexts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByArtifacts)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetContextsByExecutions)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetLineageGraph)
+  GRPC_METADATA_STORE_CLIENT_METHOD(GetLineageClosure)
+
+#undef GRPC_METADATA_STORE_CLIENT_METHOD
+
+ private:
+  GrpcMetadataStoreChannel* const channel_;
+};
+
+// Creates the `num_channels` channels of `grpc_client_config` to its server.
+// Each channel has a connection of its own.
+// Returns InvalidArgument error, if the `grpc_client_config` is invalid.
+tensorflow::Status CreateGrpcMetadataStoreChannels(
+    const GrpcClientConfig& grpc_client_config,
+    std::vector<std::unique_ptr<GrpcMetadataStoreChannel>>& channels);
+
+// Converts from GRPC Status to tensorflow Status.
+tensorflow::Status FromGrpcStatus(const ::grpc::Status& status);
+
+template <typename Request, typename Response>
+tensorflow::Status GrpcMetadataStoreChannel::Call(
+    ::grpc::Status (MetadataStoreService::Stub::*method)(
+        ::grpc::ClientContext*, const Request&, Response*),
+    const Request& request, Response* response) {
+  ::grpc::ClientContext context;
+  if (timeout_ != absl::InfiniteDuration()) {
+    context.set_deadline(absl::ToChronoTime(absl::Now() + timeout_));
+  }
+  StartRequest();
+  const ::grpc::Status status =
+      (stub_.get()->*method)(&context, request, response);
+  FinishRequest();
+  return FromGrpcStatus(status);
+}
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_GRPC_METADATA_STORE_CLIENT_H
@@ -0,0 +1,102 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/grpc_metadata_store_client.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+// Runs a metadata store server with an in-memory database on a local port.
+class GrpcMetadataStoreClientTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    service_impl_ =
+        absl::make_unique<MetadataStoreServiceImpl>(connection_config);
+    ::grpc::ServerBuilder builder;
+    int port = 0;
+    builder.AddListeningPort("localhost:0",
+                             ::grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(service_impl_.get());
+    server_ = builder.BuildAndStart();
+    grpc_client_config_.mutable_client_config()->set_host("localhost");
+    grpc_client_config_.mutable_client_config()->set_port(port);
+  }
+
+  void TearDown() override { server_->Shutdown(); }
+
+  std::unique_ptr<MetadataStoreServiceImpl> service_impl_;
+  std::unique_ptr<::grpc::Server> server_;
+  GrpcClientConfig grpc_client_config_;
+};
+
+TEST_F(GrpcMetadataStoreClientTest, PutAndGetArtifactTypeOnChannels) {
+  grpc_client_config_.set_num_channels(2);
+  grpc_client_config_.set_max_in_flight_requests_per_channel(1);
+  std::vector<std::unique_ptr<GrpcMetadataStoreChannel>> channels;
+  TF_ASSERT_OK(CreateGrpcMetadataStoreChannels(grpc_client_config_, channels));
+  ASSERT_EQ(channels.size(), 2);
+
+  GrpcMetadataStoreClient put_client(channels[0].get());
+  PutArtifactTypeRequest put_request;
+  put_request.mutable_artifact_type()->set_name("grpc_type");
+  PutArtifactTypeResponse put_response;
+  TF_ASSERT_OK(put_client.PutArtifactType(put_request, &put_response));
+
+  GrpcMetadataStoreClient get_client(channels[1].get());
+  GetArtifactTypeRequest get_request;
+  get_request.set_type_name("grpc_type");
+  GetArtifactTypeResponse get_response;
+  TF_ASSERT_OK(get_client.GetArtifactType(get_request, &get_response));
+  EXPECT_EQ(get_response.artifact_type().id(), put_response.type_id());
+
+  // The errors of the server are returned with their code.
+  get_request.set_type_name("unknown_type");
+  EXPECT_EQ(get_client.GetArtifactType(get_request, &get_response).code(),
+            tensorflow::error::NOT_FOUND);
+}
+
+TEST_F(GrpcMetadataStoreClientTest, CreateChannelsWithInvalidConfig) {
+  std::vector<std::unique_ptr<GrpcMetadataStoreChannel>> channels;
+  GrpcClientConfig no_server_config;
+  EXPECT_EQ(CreateGrpcMetadataStoreChannels(no_server_config, channels).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  grpc_client_config_.set_num_channels(0);
+  EXPECT_EQ(
+      CreateGrpcMetadataStoreChannels(grpc_client_config_, channels).code(),
+      tensorflow::error::INVALID_ARGUMENT);
+  grpc_client_config_.set_num_channels(1);
+  grpc_client_config_.set_max_in_flight_requests_per_channel(-1);
+  EXPECT_EQ(
+      CreateGrpcMetadataStoreChannels(grpc_client_config_, channels).code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace ml_metadata
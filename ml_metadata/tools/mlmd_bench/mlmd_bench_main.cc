@@ -14,12 +14,26 @@ limitations under the License.
 ==============================================================================*/
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include <glog/logging.h>
 #include "gflags/gflags.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
 #include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/distributed_benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/prepopulation.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/report_comparison.h"
+#include "ml_metadata/tools/mlmd_bench/report_io.h"
 #include "ml_metadata/tools/mlmd_bench/thread_runner.h"
+#include "ml_metadata/tools/mlmd_bench/thread_sweep.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
@@ -41,13 +55,44 @@ tensorflow::Status InitAndValidateMLMDBenchConfig(
                        &mlmd_bench_config);
 }
 
-// Writes the performance report into a specified file in the output path.
-// Returns detailed error if the execution failed.
-tensorflow::Status WriteProtoResultToDisk(
-    const std::string& output_report_path,
-    const MLMDBenchReport& mlmd_bench_report) {
-  return tensorflow::WriteTextProto(tensorflow::Env::Default(),
-                                    output_report_path, mlmd_bench_report);
+// Compares the report at `candidate_report_path` with the one at
+// `baseline_report_path`, prints the compared metrics and returns the exit
+// status: 0 if no metric regressed beyond `tolerance`, or 1 otherwise.
+int CompareReportFiles(const std::string& baseline_report_path,
+                       const std::string& candidate_report_path,
+                       const double tolerance) {
+  MLMDBenchReport baseline;
+  TF_CHECK_OK(ReadReport(baseline_report_path, baseline));
+  MLMDBenchReport candidate;
+  TF_CHECK_OK(ReadReport(candidate_report_path, candidate));
+  std::vector<MetricComparison> comparisons;
+  TF_CHECK_OK(CompareReports(baseline, candidate, tolerance, comparisons));
+  int num_regressions = 0;
+  for (const MetricComparison& comparison : comparisons) {
+    std::cout << absl::StrFormat(
+        "%-9s %s %s: %.1f -> %.1f (%+.1f%%)\n",
+        comparison.regressed ? "REGRESSED" : "OK", comparison.workload_name,
+        comparison.metric, comparison.baseline, comparison.candidate,
+        100 * comparison.relative_change);
+    if (comparison.regressed) ++num_regressions;
+  }
+  std::cout << num_regressions << " of " << comparisons.size()
+            << " metrics regressed beyond a tolerance of " << 100 * tolerance
+            << "%" << std::endl;
+  return num_regressions > 0 ? 1 : 0;
+}
+
+// Serves the MLMDBenchWorkerService on `port` until the process is killed.
+void RunWorker(const int port) {
+  MLMDBenchWorker worker;
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(absl::StrCat("0.0.0.0:", port),
+                           ::grpc::InsecureServerCredentials());
+  builder.RegisterService(&worker);
+  std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  CHECK(server != nullptr) << "Failed to start the worker on port " << port;
+  LOG(INFO) << "mlmd_bench worker listening on port " << port;
+  server->Wait();
 }
 
 }  // namespace
@@ -58,23 +103,62 @@ DEFINE_string(config_file_path, "",
               "Input mlmd_bench configuration .pb or .pbtxt file path.");
 DEFINE_string(output_report_path, "./mlmd_bench_report.pb.txt",
               "Output mlmd_bench performance report file path.");
+DEFINE_string(output_report_format, "pbtxt",
+              "Output mlmd_bench performance report format: pbtxt, json or "
+              "csv.");
+// mlmd_bench compare subcommand command line options.
+DEFINE_double(regression_tolerance, 0.1,
+              "The relative change of a metric beyond which the compare "
+              "subcommand reports a regression, e.g., 0.1 for 10%.");
+// mlmd_bench distributed mode command line options.
+DEFINE_int32(worker_port, 0,
+             "If positive, runs as a distributed mode worker serving the "
+             "benchmarks of a coordinator on this port, and ignores the "
+             "other options.");
 
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc > 1 && std::string(argv[1]) == "compare") {
+    // mlmd_bench compare <baseline report> <candidate report>
+    CHECK_EQ(argc, 4) << "The compare subcommand takes a baseline and a "
+                         "candidate report path.";
+    return ml_metadata::CompareReportFiles(argv[2], argv[3],
+                                           FLAGS_regression_tolerance);
+  }
+  if (FLAGS_worker_port > 0) {
+    ml_metadata::RunWorker(FLAGS_worker_port);
+    return 0;
+  }
   // Configurations for `mlmd_bench`.
   ml_metadata::MLMDBenchConfig mlmd_bench_config;
   TF_CHECK_OK(ml_metadata::InitAndValidateMLMDBenchConfig(
       (FLAGS_config_file_path), mlmd_bench_config));
+  if (mlmd_bench_config.has_prepopulation_config()) {
+    // Populates, or restores the snapshot of, the database the workloads start
+    // from.
+    TF_CHECK_OK(ml_metadata::Prepopulate(
+        mlmd_bench_config.prepopulation_config(),
+        mlmd_bench_config.mlmd_config()));
+  }
   // Feeds the `mlmd_bench_config` into the benchmark for generating executable
   // workloads.
   ml_metadata::Benchmark benchmark(mlmd_bench_config);
-  // Executes the workloads inside the benchmark with the thread runner.
-  ml_metadata::ThreadRunner runner(
-      mlmd_bench_config.mlmd_config(),
-      mlmd_bench_config.thread_env_config().num_threads());
-  TF_CHECK_OK(runner.Run(benchmark));
+  if (mlmd_bench_config.thread_env_config().has_thread_sweep_config()) {
+    // Executes the workloads at each thread count of the sweep.
+    TF_CHECK_OK(ml_metadata::RunThreadSweep(mlmd_bench_config,
+                                            benchmark.mlmd_bench_report()));
+  } else if (mlmd_bench_config.has_distributed_config()) {
+    // Executes the workloads on the workers of the distributed_config.
+    TF_CHECK_OK(
+        ml_metadata::RunDistributedBenchmark(mlmd_bench_config, benchmark));
+  } else {
+    // Executes the workloads inside the benchmark with the thread runner.
+    ml_metadata::ThreadRunner runner(mlmd_bench_config);
+    TF_CHECK_OK(runner.Run(benchmark));
+  }
 
-  TF_CHECK_OK(ml_metadata::WriteProtoResultToDisk(
-      (FLAGS_output_report_path), benchmark.mlmd_bench_report()));
+  TF_CHECK_OK(ml_metadata::WriteReport(benchmark.mlmd_bench_report(),
+                                       FLAGS_output_report_format,
+                                       FLAGS_output_report_path));
   return 0;
 }
@@ -0,0 +1,375 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/prepopulation.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+// The ids of the pre-populated types of each kind.
+struct PrepopulatedTypeIds {
+  std::vector<int64> artifact_type_ids;
+  std::vector<int64> execution_type_ids;
+  std::vector<int64> context_type_ids;
+};
+
+// Inserts the items within [begin, end) of a batch with `store`. Returns
+// detailed error if query executions failed.
+using PutBatch = std::function<tensorflow::Status(
+    int64 begin, int64 end, MetadataStoreServiceInterface& store)>;
+
+// Validates the sizes of `prepopulation_config`. Returns INVALID_ARGUMENT error
+// if one of them is not correct.
+tensorflow::Status ValidatePrepopulationConfig(
+    const PrepopulationConfig& prepopulation_config) {
+  if (prepopulation_config.num_types() <= 0 ||
+      prepopulation_config.batch_size() <= 0 ||
+      prepopulation_config.num_threads() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_types, batch_size and num_threads must be positive.");
+  }
+  for (const int64 size : {prepopulation_config.num_properties_per_type(),
+                           prepopulation_config.num_artifacts(),
+                           prepopulation_config.num_executions(),
+                           prepopulation_config.num_contexts(),
+                           prepopulation_config.num_events_per_execution()}) {
+    if (size < 0) {
+      return tensorflow::errors::InvalidArgument(
+          "The numbers of properties, nodes and events must be "
+          "non-negative.");
+    }
+  }
+  if (prepopulation_config.num_events_per_execution() > 0 &&
+      prepopulation_config.num_artifacts() == 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The events need artifacts.");
+  }
+  for (const int64 num_edges :
+       {prepopulation_config.num_attributions_per_artifact(),
+        prepopulation_config.num_associations_per_execution()}) {
+    if (num_edges < 0 || num_edges > prepopulation_config.num_contexts()) {
+      return tensorflow::errors::InvalidArgument(
+          "The number of context edges per node must be within [0, "
+          "num_contexts].");
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Sets `path` to the file of the SQLite database of `mlmd_config`. Returns
+// INVALID_ARGUMENT error if `mlmd_config` is not a SQLite database in a file.
+tensorflow::Status GetSqliteFilePath(const ConnectionConfig& mlmd_config,
+                                     std::string& path) {
+  if (!mlmd_config.has_sqlite() ||
+      mlmd_config.sqlite().filename_uri().empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "The snapshot_path is only supported for a SQLite database in a "
+        "file; use the backup tools of the database instead, e.g., "
+        "mysqldump.");
+  }
+  // Strips the scheme and parameters of a URI filename, e.g.,
+  // file:///tmp/mlmd.db?mode=rwc.
+  absl::string_view filename = mlmd_config.sqlite().filename_uri();
+  filename = filename.substr(0, filename.find('?'));
+  if (absl::ConsumePrefix(&filename, "file:")) {
+    absl::ConsumePrefix(&filename, "//");
+  }
+  path = std::string(filename);
+  return tensorflow::Status::OK();
+}
+
+// Registers the types of `prepopulation_config`, or gets the ids of the
+// registered ones, into `type_ids`. Returns detailed error if query executions
+// failed.
+tensorflow::Status PutPrepopulatedTypes(
+    const PrepopulationConfig& prepopulation_config,
+    MetadataStoreServiceInterface& store, PrepopulatedTypeIds& type_ids) {
+  PutTypesRequest request;
+  for (int64 i = 0; i < prepopulation_config.num_types(); ++i) {
+    ArtifactType& artifact_type = *request.add_artifact_types();
+    artifact_type.set_name(absl::StrCat("prepopulated_artifact_type_", i));
+    ExecutionType& execution_type = *request.add_execution_types();
+    execution_type.set_name(absl::StrCat("prepopulated_execution_type_", i));
+    ContextType& context_type = *request.add_context_types();
+    context_type.set_name(absl::StrCat("prepopulated_context_type_", i));
+    for (int64 j = 0; j < prepopulation_config.num_properties_per_type();
+         ++j) {
+      const std::string property_name = absl::StrCat("p", j);
+      (*artifact_type.mutable_properties())[property_name] = INT;
+      (*execution_type.mutable_properties())[property_name] = INT;
+      (*context_type.mutable_properties())[property_name] = INT;
+    }
+  }
+  PutTypesResponse response;
+  TF_RETURN_IF_ERROR(store.PutTypes(request, &response));
+  type_ids.artifact_type_ids.assign(response.artifact_type_ids().begin(),
+                                    response.artifact_type_ids().end());
+  type_ids.execution_type_ids.assign(response.execution_type_ids().begin(),
+                                     response.execution_type_ids().end());
+  type_ids.context_type_ids.assign(response.context_type_ids().begin(),
+                                   response.context_type_ids().end());
+  return tensorflow::Status::OK();
+}
+
+// Sets the `index`-th pre-populated `node` named after `nodes_name`, whose
+// type is picked round-robin among `type_ids`, with all its properties.
+template <typename N>
+void SetPrepopulatedNode(const PrepopulationConfig& prepopulation_config,
+                         const std::vector<int64>& type_ids,
+                         const std::string& nodes_name, const int64 index,
+                         N& node) {
+  node.set_type_id(type_ids[index % type_ids.size()]);
+  node.set_name(absl::StrCat(nodes_name, "_", index));
+  for (int64 j = 0; j < prepopulation_config.num_properties_per_type(); ++j) {
+    (*node.mutable_properties())[absl::StrCat("p", j)].set_int_value(index);
+  }
+}
+
+// Runs `put_batch` on the batches of at most batch_size items among
+// `num_items` items, in the num_threads threads of `prepopulation_config`, each
+// with a store of its own connected with `mlmd_config`. The batches which are
+// ABORTED by conflicts between the threads are retried. Returns detailed error
+// if query executions failed.
+tensorflow::Status RunInBatches(const PrepopulationConfig& prepopulation_config,
+                                const ConnectionConfig& mlmd_config,
+                                const int64 num_items,
+                                const PutBatch& put_batch) {
+  const int num_threads = prepopulation_config.num_threads();
+  const int64 batch_size = prepopulation_config.batch_size();
+  std::vector<tensorflow::Status> statuses(num_threads);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "mlmd_bench_prepopulation",
+                                        num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&mlmd_config, &put_batch, &statuses, num_items,
+                     batch_size, num_threads, t]() {
+        tensorflow::Status& status = statuses[t];
+        std::unique_ptr<MetadataStore> store;
+        status = CreateMetadataStore(mlmd_config, &store);
+        for (int64 begin = t * batch_size; status.ok() && begin < num_items;
+             begin += num_threads * batch_size) {
+          do {
+            status = put_batch(begin, std::min(begin + batch_size, num_items),
+                               *store);
+          } while (status.code() == tensorflow::error::ABORTED);
+        }
+      });
+    }
+  }
+  for (const tensorflow::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Inserts the graph of `prepopulation_config` into the database of
+// `mlmd_config`. Returns detailed error if query executions failed.
+tensorflow::Status PopulateGraph(
+    const PrepopulationConfig& prepopulation_config,
+    const ConnectionConfig& mlmd_config) {
+  PrepopulatedTypeIds type_ids;
+  {
+    std::unique_ptr<MetadataStore> store;
+    TF_RETURN_IF_ERROR(CreateMetadataStore(mlmd_config, &store));
+    TF_RETURN_IF_ERROR(
+        PutPrepopulatedTypes(prepopulation_config, *store, type_ids));
+  }
+  // The names are unique per run, so that a database can be populated twice.
+  const std::string nodes_name =
+      absl::StrCat("prepopulated", absl::FormatTime(absl::Now()));
+
+  std::vector<int64> artifact_ids(prepopulation_config.num_artifacts());
+  TF_RETURN_IF_ERROR(RunInBatches(
+      prepopulation_config, mlmd_config, prepopulation_config.num_artifacts(),
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        PutArtifactsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          Artifact& artifact = *request.add_artifacts();
+          SetPrepopulatedNode(prepopulation_config, type_ids.artifact_type_ids,
+                              absl::StrCat(nodes_name, "_artifact"), i,
+                              artifact);
+          artifact.set_uri(absl::StrCat(artifact.name(), "_uri"));
+        }
+        PutArtifactsResponse response;
+        TF_RETURN_IF_ERROR(store.PutArtifacts(request, &response));
+        std::copy(response.artifact_ids().begin(),
+                  response.artifact_ids().end(), artifact_ids.begin() + begin);
+        return tensorflow::Status::OK();
+      }));
+
+  std::vector<int64> execution_ids(prepopulation_config.num_executions());
+  TF_RETURN_IF_ERROR(RunInBatches(
+      prepopulation_config, mlmd_config, prepopulation_config.num_executions(),
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        PutExecutionsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          SetPrepopulatedNode(prepopulation_config, type_ids.execution_type_ids,
+                              absl::StrCat(nodes_name, "_execution"), i,
+                              *request.add_executions());
+        }
+        PutExecutionsResponse response;
+        TF_RETURN_IF_ERROR(store.PutExecutions(request, &response));
+        std::copy(response.execution_ids().begin(),
+                  response.execution_ids().end(),
+                  execution_ids.begin() + begin);
+        return tensorflow::Status::OK();
+      }));
+
+  std::vector<int64> context_ids(prepopulation_config.num_contexts());
+  TF_RETURN_IF_ERROR(RunInBatches(
+      prepopulation_config, mlmd_config, prepopulation_config.num_contexts(),
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        PutContextsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          SetPrepopulatedNode(prepopulation_config, type_ids.context_type_ids,
+                              absl::StrCat(nodes_name, "_context"), i,
+                              *request.add_contexts());
+        }
+        PutContextsResponse response;
+        TF_RETURN_IF_ERROR(store.PutContexts(request, &response));
+        std::copy(response.context_ids().begin(), response.context_ids().end(),
+                  context_ids.begin() + begin);
+        return tensorflow::Status::OK();
+      }));
+
+  // The events alternate between inputs and outputs of each execution.
+  const int64 num_events_per_execution =
+      prepopulation_config.num_events_per_execution();
+  TF_RETURN_IF_ERROR(RunInBatches(
+      prepopulation_config, mlmd_config,
+      prepopulation_config.num_executions() * num_events_per_execution,
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        // Each batch picks the same artifacts when it is retried.
+        std::minstd_rand0 gen(begin);
+        std::uniform_int_distribution<int64> artifact_index_dist{
+            0, static_cast<int64>(artifact_ids.size()) - 1};
+        PutEventsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          Event& event = *request.add_events();
+          event.set_execution_id(execution_ids[i / num_events_per_execution]);
+          event.set_artifact_id(artifact_ids[artifact_index_dist(gen)]);
+          event.set_type((i % num_events_per_execution) % 2 == 0
+                             ? Event::INPUT
+                             : Event::OUTPUT);
+        }
+        PutEventsResponse response;
+        return store.PutEvents(request, &response);
+      }));
+
+  // The context edges of each node are to consecutive contexts, so that they
+  // are distinct.
+  const int64 num_attributions_per_artifact =
+      prepopulation_config.num_attributions_per_artifact();
+  TF_RETURN_IF_ERROR(RunInBatches(
+      prepopulation_config, mlmd_config,
+      prepopulation_config.num_artifacts() * num_attributions_per_artifact,
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        PutAttributionsAndAssociationsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          const int64 artifact_index = i / num_attributions_per_artifact;
+          Attribution& attribution = *request.add_attributions();
+          attribution.set_artifact_id(artifact_ids[artifact_index]);
+          attribution.set_context_id(
+              context_ids[(artifact_index + i % num_attributions_per_artifact) %
+                          context_ids.size()]);
+        }
+        PutAttributionsAndAssociationsResponse response;
+        return store.PutAttributionsAndAssociations(request, &response);
+      }));
+  const int64 num_associations_per_execution =
+      prepopulation_config.num_associations_per_execution();
+  return RunInBatches(
+      prepopulation_config, mlmd_config,
+      prepopulation_config.num_executions() * num_associations_per_execution,
+      [&](const int64 begin, const int64 end,
+          MetadataStoreServiceInterface& store) -> tensorflow::Status {
+        PutAttributionsAndAssociationsRequest request;
+        for (int64 i = begin; i < end; ++i) {
+          const int64 execution_index = i / num_associations_per_execution;
+          Association& association = *request.add_associations();
+          association.set_execution_id(execution_ids[execution_index]);
+          association.set_context_id(
+              context_ids[(execution_index +
+                           i % num_associations_per_execution) %
+                          context_ids.size()]);
+        }
+        PutAttributionsAndAssociationsResponse response;
+        return store.PutAttributionsAndAssociations(request, &response);
+      });
+}
+
+}  // namespace
+
+tensorflow::Status Prepopulate(const PrepopulationConfig& prepopulation_config,
+                               const ConnectionConfig& mlmd_config) {
+  TF_RETURN_IF_ERROR(ValidatePrepopulationConfig(prepopulation_config));
+  const std::string& snapshot_path = prepopulation_config.snapshot_path();
+  std::string database_path;
+  if (!snapshot_path.empty()) {
+    TF_RETURN_IF_ERROR(GetSqliteFilePath(mlmd_config, database_path));
+    if (tensorflow::Env::Default()->FileExists(snapshot_path).ok()) {
+      LOG(INFO) << "Restoring the pre-populated database from "
+                << snapshot_path;
+      return tensorflow::Env::Default()->CopyFile(snapshot_path,
+                                                 database_path);
+    }
+  }
+
+  LOG(INFO) << "Pre-populating the database ...";
+  const absl::Time start_time = absl::Now();
+  TF_RETURN_IF_ERROR(PopulateGraph(prepopulation_config, mlmd_config));
+  LOG(INFO) << "Pre-populated the database in "
+            << absl::FormatDuration(absl::Now() - start_time);
+
+  if (!snapshot_path.empty()) {
+    LOG(INFO) << "Saving the pre-populated database to " << snapshot_path;
+    TF_RETURN_IF_ERROR(
+        tensorflow::Env::Default()->CopyFile(database_path, snapshot_path));
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
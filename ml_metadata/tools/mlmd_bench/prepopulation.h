@@ -0,0 +1,35 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_PREPOPULATION_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_PREPOPULATION_H
+
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Pre-populates the database of `mlmd_config` with the graph of
+// `prepopulation_config`, or restores it from the snapshot of
+// `prepopulation_config` if it exists.
+// Returns InvalidArgument error, if the `prepopulation_config` is invalid, or
+// has a snapshot_path while `mlmd_config` is not a SQLite database in a file.
+// Returns detailed error, if query executions or file copies failed.
+tensorflow::Status Prepopulate(const PrepopulationConfig& prepopulation_config,
+                               const ConnectionConfig& mlmd_config);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_PREPOPULATION_H
@@ -0,0 +1,177 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/prepopulation.h"
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfNodes = 50;
+constexpr int kNumberOfContexts = 5;
+
+// Returns a small PrepopulationConfig, which inserts its nodes in several
+// batches with several threads.
+PrepopulationConfig GetPrepopulationConfig() {
+  PrepopulationConfig prepopulation_config;
+  prepopulation_config.set_num_types(3);
+  prepopulation_config.set_num_properties_per_type(2);
+  prepopulation_config.set_num_artifacts(kNumberOfNodes);
+  prepopulation_config.set_num_executions(kNumberOfNodes);
+  prepopulation_config.set_num_contexts(kNumberOfContexts);
+  prepopulation_config.set_num_events_per_execution(2);
+  prepopulation_config.set_num_attributions_per_artifact(2);
+  prepopulation_config.set_num_associations_per_execution(1);
+  prepopulation_config.set_batch_size(7);
+  prepopulation_config.set_num_threads(3);
+  return prepopulation_config;
+}
+
+// Returns a ConnectionConfig to a SQLite database in the file `db_name`.
+ConnectionConfig GetSqliteConfig(const std::string& db_name) {
+  ConnectionConfig mlmd_config;
+  mlmd_config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), db_name));
+  return mlmd_config;
+}
+
+// Tests that Prepopulate() inserts the types, nodes and edges of its
+// configuration.
+TEST(PrepopulationTest, PrepopulateGraphTest) {
+  const ConnectionConfig mlmd_config =
+      GetSqliteConfig("mlmd-bench-prepopulation-test.db");
+  TF_ASSERT_OK(Prepopulate(GetPrepopulationConfig(), mlmd_config));
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store));
+  GetArtifactTypesResponse get_artifact_types_response;
+  TF_ASSERT_OK(store->GetArtifactTypes(GetArtifactTypesRequest(),
+                                       &get_artifact_types_response));
+  EXPECT_EQ(3, get_artifact_types_response.artifact_types_size());
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(
+      store->GetArtifacts(GetArtifactsRequest(), &get_artifacts_response));
+  ASSERT_EQ(kNumberOfNodes, get_artifacts_response.artifacts_size());
+  EXPECT_EQ(2, get_artifacts_response.artifacts(0).properties_size());
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(
+      store->GetExecutions(GetExecutionsRequest(), &get_executions_response));
+  EXPECT_EQ(kNumberOfNodes, get_executions_response.executions_size());
+
+  GetEventsByExecutionIDsRequest get_events_request;
+  for (const Execution& execution : get_executions_response.executions()) {
+    get_events_request.add_execution_ids(execution.id());
+  }
+  GetEventsByExecutionIDsResponse get_events_response;
+  TF_ASSERT_OK(
+      store->GetEventsByExecutionIDs(get_events_request, &get_events_response));
+  EXPECT_EQ(2 * kNumberOfNodes, get_events_response.events_size());
+
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(
+      store->GetContexts(GetContextsRequest(), &get_contexts_response));
+  ASSERT_EQ(kNumberOfContexts, get_contexts_response.contexts_size());
+  int64 num_attributions = 0;
+  int64 num_associations = 0;
+  for (const Context& context : get_contexts_response.contexts()) {
+    GetArtifactsByContextRequest get_artifacts_by_context_request;
+    get_artifacts_by_context_request.set_context_id(context.id());
+    GetArtifactsByContextResponse get_artifacts_by_context_response;
+    TF_ASSERT_OK(
+        store->GetArtifactsByContext(get_artifacts_by_context_request,
+                                     &get_artifacts_by_context_response));
+    num_attributions += get_artifacts_by_context_response.artifacts_size();
+    GetExecutionsByContextRequest get_executions_by_context_request;
+    get_executions_by_context_request.set_context_id(context.id());
+    GetExecutionsByContextResponse get_executions_by_context_response;
+    TF_ASSERT_OK(
+        store->GetExecutionsByContext(get_executions_by_context_request,
+                                      &get_executions_by_context_response));
+    num_associations += get_executions_by_context_response.executions_size();
+  }
+  EXPECT_EQ(2 * kNumberOfNodes, num_attributions);
+  EXPECT_EQ(kNumberOfNodes, num_associations);
+}
+
+// Tests that Prepopulate() saves a snapshot of the populated database, and
+// restores it instead of populating the database again.
+TEST(PrepopulationTest, SnapshotTest) {
+  const ConnectionConfig mlmd_config =
+      GetSqliteConfig("mlmd-bench-prepopulation-snapshot-test.db");
+  PrepopulationConfig prepopulation_config = GetPrepopulationConfig();
+  prepopulation_config.set_snapshot_path(absl::StrCat(
+      ::testing::TempDir(), "mlmd-bench-prepopulation-snapshot.db"));
+  TF_ASSERT_OK(Prepopulate(prepopulation_config, mlmd_config));
+
+  {
+    // Changes the database after the snapshot.
+    std::unique_ptr<MetadataStore> store;
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store));
+    GetArtifactsResponse get_artifacts_response;
+    TF_ASSERT_OK(
+        store->GetArtifacts(GetArtifactsRequest(), &get_artifacts_response));
+    PutArtifactsRequest put_artifacts_request;
+    Artifact& artifact = *put_artifacts_request.add_artifacts();
+    artifact.set_type_id(get_artifacts_response.artifacts(0).type_id());
+    artifact.set_uri("after_snapshot");
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(
+        store->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+  }
+
+  TF_ASSERT_OK(Prepopulate(prepopulation_config, mlmd_config));
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store));
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(
+      store->GetArtifacts(GetArtifactsRequest(), &get_artifacts_response));
+  EXPECT_EQ(kNumberOfNodes, get_artifacts_response.artifacts_size());
+}
+
+// Tests that Prepopulate() rejects a snapshot of a database which is not a
+// SQLite file.
+TEST(PrepopulationTest, SnapshotOfFakeDatabaseTest) {
+  ConnectionConfig mlmd_config;
+  mlmd_config.mutable_fake_database();
+  PrepopulationConfig prepopulation_config = GetPrepopulationConfig();
+  prepopulation_config.set_snapshot_path(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-prepopulation-fake.db"));
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            Prepopulate(prepopulation_config, mlmd_config).code());
+}
+
+// Tests that Prepopulate() rejects more context edges per node than contexts.
+TEST(PrepopulationTest, InvalidConfigTest) {
+  ConnectionConfig mlmd_config;
+  mlmd_config.mutable_fake_database();
+  PrepopulationConfig prepopulation_config = GetPrepopulationConfig();
+  prepopulation_config.set_num_attributions_per_artifact(kNumberOfContexts +
+                                                         1);
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            Prepopulate(prepopulation_config, mlmd_config).code());
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -18,7 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/time/clock.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -56,7 +56,7 @@ int64 GetTransferredBytesForEvent(const Event& event) {
 // detailed error if query executions failed.
 tensorflow::Status GetTransferredBytes(
     const ReadEventsConfig& read_events_config,
-    const ReadEventsWorkItemType& request, MetadataStore& store,
+    const ReadEventsWorkItemType& request, MetadataStoreServiceInterface& store,
     int64& curr_bytes) {
   switch (read_events_config.specification()) {
     case ReadEventsConfig::EVENTS_BY_ARTIFACT_ID: {
@@ -92,18 +92,22 @@ ReadEvents::ReadEvents(const ReadEventsConfig& read_events_config,
       name_(absl::StrCat("READ_", read_events_config_.Specification_Name(
                                       read_events_config_.specification()))) {}
 
-tensorflow::Status ReadEvents::SetUpImpl(MetadataStore* store) {
+tensorflow::Status ReadEvents::SetUpImpl(MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   std::vector<Node> existing_nodes;
   TF_RETURN_IF_ERROR(
       GetExistingNodes(read_events_config_, *store, existing_nodes));
-  std::uniform_int_distribution<int64> node_index_dist{
-      0, (int64)(existing_nodes.size() - 1)};
+  TF_RETURN_IF_ERROR(
+      ValidateNodePopularity(read_events_config_.node_popularity()));
   UniformDistribution num_ids_proto_dist = read_events_config_.num_ids();
   std::uniform_int_distribution<int64> num_ids_dist{
       num_ids_proto_dist.minimum(), num_ids_proto_dist.maximum()};
   std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  // Selects existing nodes w.r.t. their popularity, uniformly by default.
+  std::discrete_distribution<int64> node_index_dist =
+      GenerateNodePopularityDistribution(
+          existing_nodes.size(), read_events_config_.node_popularity(), gen);
 
   for (int64 i = 0; i < num_operations_; ++i) {
     int64 curr_bytes = 0;
@@ -138,7 +142,7 @@ tensorflow::Status ReadEvents::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status ReadEvents::RunOpImpl(const int64 work_items_index,
-                                         MetadataStore* store) {
+                                         MetadataStoreServiceInterface* store) {
   switch (read_events_config_.specification()) {
     case ReadEventsConfig::EVENTS_BY_ARTIFACT_ID: {
       auto request = absl::get<GetEventsByArtifactIDsRequest>(
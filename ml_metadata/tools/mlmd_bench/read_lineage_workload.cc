@@ -0,0 +1,284 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/read_lineage_workload.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int64 kInt64IdSize = 8;
+constexpr int64 kNumNodeIdsPerEdge = 2;
+constexpr int64 kEventTypeSize = 1;
+
+constexpr char kArtifactTypeName[] = "mlmd_bench_lineage_artifact";
+constexpr char kExecutionTypeName[] = "mlmd_bench_lineage_execution";
+
+// Validates the walks and DAG of `read_lineage_config`. Returns
+// INVALID_ARGUMENT error if one of them is not correct.
+tensorflow::Status ValidateReadLineageConfig(
+    const ReadLineageConfig& read_lineage_config) {
+  if (read_lineage_config.specification() == ReadLineageConfig::UNKNOWN ||
+      read_lineage_config.traversal() ==
+          ReadLineageConfig::TRAVERSAL_UNSPECIFIED) {
+    return tensorflow::errors::InvalidArgument(
+        "The specification and traversal must be specified.");
+  }
+  if (read_lineage_config.num_hops() <= 0 ||
+      read_lineage_config.dag_depth() <= 0 ||
+      read_lineage_config.dag_width() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_hops, dag_depth and dag_width must be positive.");
+  }
+  if (read_lineage_config.fan_out() <= 0 ||
+      read_lineage_config.fan_out() > read_lineage_config.dag_width()) {
+    return tensorflow::errors::InvalidArgument(
+        "The fan_out must be within [1, dag_width].");
+  }
+  return tensorflow::Status::OK();
+}
+
+// Generates the DAG of `read_lineage_config`, and records the ids of the
+// artifacts of its first and last layers. Returns detailed error if query
+// executions failed.
+tensorflow::Status GenerateDag(const ReadLineageConfig& read_lineage_config,
+                               MetadataStoreServiceInterface& store,
+                               std::vector<int64>& first_layer_artifact_ids,
+                               std::vector<int64>& last_layer_artifact_ids) {
+  PutTypesRequest put_types_request;
+  put_types_request.add_artifact_types()->set_name(kArtifactTypeName);
+  put_types_request.add_execution_types()->set_name(kExecutionTypeName);
+  PutTypesResponse put_types_response;
+  TF_RETURN_IF_ERROR(store.PutTypes(put_types_request, &put_types_response));
+  const int64 artifact_type_id = put_types_response.artifact_type_ids(0);
+  const int64 execution_type_id = put_types_response.execution_type_ids(0);
+
+  const std::string nodes_name =
+      absl::StrCat("lineage", absl::FormatTime(absl::Now()));
+  const int64 width = read_lineage_config.dag_width();
+  PutArtifactsRequest put_artifacts_request;
+  for (int64 j = 0; j < width; ++j) {
+    Artifact& artifact = *put_artifacts_request.add_artifacts();
+    artifact.set_type_id(artifact_type_id);
+    artifact.set_name(absl::StrCat(nodes_name, "_layer_0_artifact_", j));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_RETURN_IF_ERROR(
+      store.PutArtifacts(put_artifacts_request, &put_artifacts_response));
+  first_layer_artifact_ids.assign(
+      put_artifacts_response.artifact_ids().begin(),
+      put_artifacts_response.artifact_ids().end());
+
+  std::vector<int64> layer_artifact_ids = first_layer_artifact_ids;
+  for (int64 layer = 1; layer <= read_lineage_config.dag_depth(); ++layer) {
+    std::vector<int64> next_layer_artifact_ids;
+    for (int64 j = 0; j < width; ++j) {
+      PutExecutionRequest request;
+      request.mutable_execution()->set_type_id(execution_type_id);
+      request.mutable_execution()->set_name(
+          absl::StrCat(nodes_name, "_layer_", layer, "_execution_", j));
+      // Each artifact of the previous layer is read by `fan_out` consecutive
+      // executions.
+      for (int64 k = 0; k < read_lineage_config.fan_out(); ++k) {
+        Event& event = *request.add_artifact_event_pairs()->mutable_event();
+        event.set_type(Event::INPUT);
+        event.set_artifact_id(layer_artifact_ids[(j + k) % width]);
+      }
+      PutExecutionRequest::ArtifactAndEvent& output =
+          *request.add_artifact_event_pairs();
+      output.mutable_artifact()->set_type_id(artifact_type_id);
+      output.mutable_artifact()->set_name(
+          absl::StrCat(nodes_name, "_layer_", layer, "_artifact_", j));
+      output.mutable_event()->set_type(Event::OUTPUT);
+      PutExecutionResponse response;
+      TF_RETURN_IF_ERROR(store.PutExecution(request, &response));
+      next_layer_artifact_ids.push_back(
+          response.artifact_ids(response.artifact_ids_size() - 1));
+    }
+    layer_artifact_ids = std::move(next_layer_artifact_ids);
+  }
+  last_layer_artifact_ids = std::move(layer_artifact_ids);
+  return tensorflow::Status::OK();
+}
+
+// Walks `num_hops` hops of the lineage of `read_lineage_config` from the
+// artifacts of `request`, a hop per request, and counts the followed events
+// in `num_events`. Returns detailed error if query executions failed.
+tensorflow::Status WalkLineagePerHop(
+    const ReadLineageConfig& read_lineage_config,
+    const GetEventsByArtifactIDsRequest& request,
+    MetadataStoreServiceInterface& store, int64& num_events) {
+  const bool upstream =
+      read_lineage_config.specification() == ReadLineageConfig::UPSTREAM;
+  // Upstream, an artifact leads to the execution which outputs it, which
+  // leads to its inputs. Downstream, the other way around.
+  const Event::Type artifact_to_execution_type =
+      upstream ? Event::OUTPUT : Event::INPUT;
+  const Event::Type execution_to_artifact_type =
+      upstream ? Event::INPUT : Event::OUTPUT;
+  absl::flat_hash_set<int64> visited_artifact_ids(
+      request.artifact_ids().begin(), request.artifact_ids().end());
+  absl::flat_hash_set<int64> visited_execution_ids;
+  GetEventsByArtifactIDsRequest artifacts_request = request;
+  GetEventsByExecutionIDsRequest executions_request;
+  num_events = 0;
+  for (int hop = 0; hop < read_lineage_config.num_hops(); ++hop) {
+    if (hop % 2 == 0) {
+      if (artifacts_request.artifact_ids().empty()) break;
+      GetEventsByArtifactIDsResponse response;
+      TF_RETURN_IF_ERROR(
+          store.GetEventsByArtifactIDs(artifacts_request, &response));
+      artifacts_request.clear_artifact_ids();
+      for (const Event& event : response.events()) {
+        if (event.type() != artifact_to_execution_type) continue;
+        num_events++;
+        if (visited_execution_ids.insert(event.execution_id()).second) {
+          executions_request.add_execution_ids(event.execution_id());
+        }
+      }
+    } else {
+      if (executions_request.execution_ids().empty()) break;
+      GetEventsByExecutionIDsResponse response;
+      TF_RETURN_IF_ERROR(
+          store.GetEventsByExecutionIDs(executions_request, &response));
+      executions_request.clear_execution_ids();
+      for (const Event& event : response.events()) {
+        if (event.type() != execution_to_artifact_type) continue;
+        num_events++;
+        if (visited_artifact_ids.insert(event.artifact_id()).second) {
+          artifacts_request.add_artifact_ids(event.artifact_id());
+        }
+      }
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+ReadLineage::ReadLineage(const ReadLineageConfig& read_lineage_config,
+                         int64 num_operations)
+    : read_lineage_config_(read_lineage_config),
+      num_operations_(num_operations),
+      name_(absl::StrCat("READ_",
+                         read_lineage_config_.Specification_Name(
+                             read_lineage_config_.specification()),
+                         "_LINEAGE_BY_",
+                         read_lineage_config_.Traversal_Name(
+                             read_lineage_config_.traversal()))) {
+  TF_CHECK_OK(ValidateReadLineageConfig(read_lineage_config_));
+}
+
+tensorflow::Status ReadLineage::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
+  LOG(INFO) << "Setting up ...";
+
+  std::vector<int64> first_layer_artifact_ids;
+  std::vector<int64> last_layer_artifact_ids;
+  TF_RETURN_IF_ERROR(GenerateDag(read_lineage_config_, *store,
+                                 first_layer_artifact_ids,
+                                 last_layer_artifact_ids));
+  const std::vector<int64>& seed_artifact_ids =
+      read_lineage_config_.specification() == ReadLineageConfig::UPSTREAM
+          ? last_layer_artifact_ids
+          : first_layer_artifact_ids;
+
+  std::uniform_int_distribution<int64> seed_index_dist{
+      0, static_cast<int64>(seed_artifact_ids.size()) - 1};
+  std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  // The transferred bytes of the walk from each seed, which are the same for
+  // both traversals.
+  absl::flat_hash_map<int64, int64> bytes_by_seed;
+  for (int64 i = 0; i < num_operations_; ++i) {
+    const int64 seed_artifact_id = seed_artifact_ids[seed_index_dist(gen)];
+    GetEventsByArtifactIDsRequest walk_request;
+    walk_request.add_artifact_ids(seed_artifact_id);
+    if (!bytes_by_seed.contains(seed_artifact_id)) {
+      int64 num_events = 0;
+      TF_RETURN_IF_ERROR(WalkLineagePerHop(read_lineage_config_, walk_request,
+                                           *store, num_events));
+      bytes_by_seed[seed_artifact_id] =
+          num_events * (kInt64IdSize * kNumNodeIdsPerEdge + kEventTypeSize);
+    }
+    ReadLineageWorkItemType request;
+    switch (read_lineage_config_.traversal()) {
+      case ReadLineageConfig::PER_HOP_EVENTS:
+        request = walk_request;
+        break;
+      case ReadLineageConfig::LINEAGE_GRAPH: {
+        GetLineageGraphRequest lineage_graph_request;
+        lineage_graph_request.add_artifact_ids(seed_artifact_id);
+        lineage_graph_request.set_direction(
+            read_lineage_config_.specification() == ReadLineageConfig::UPSTREAM
+                ? GetLineageGraphRequest::UPSTREAM
+                : GetLineageGraphRequest::DOWNSTREAM);
+        lineage_graph_request.set_max_num_hops(read_lineage_config_.num_hops());
+        request = lineage_graph_request;
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unknown ReadLineageConfig traversal.";
+    }
+    work_items_.emplace_back(request, bytes_by_seed[seed_artifact_id]);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ReadLineage::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
+  switch (read_lineage_config_.traversal()) {
+    case ReadLineageConfig::PER_HOP_EVENTS: {
+      int64 num_events = 0;
+      return WalkLineagePerHop(read_lineage_config_,
+                               absl::get<GetEventsByArtifactIDsRequest>(
+                                   work_items_[work_items_index].first),
+                               *store, num_events);
+    }
+    case ReadLineageConfig::LINEAGE_GRAPH: {
+      GetLineageGraphRequest request = absl::get<GetLineageGraphRequest>(
+          work_items_[work_items_index].first);
+      GetLineageGraphResponse response;
+      return store->GetLineageGraph(request, &response);
+    }
+    default:
+      return tensorflow::errors::InvalidArgument("Unknown traversal!");
+  }
+}
+
+tensorflow::Status ReadLineage::TearDownImpl() {
+  work_items_.clear();
+  return tensorflow::Status::OK();
+}
+
+std::string ReadLineage::GetName() { return name_; }
+
+}  // namespace ml_metadata
@@ -0,0 +1,80 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_READ_LINEAGE_WORKLOAD_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_READ_LINEAGE_WORKLOAD_H
+
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Defines a ReadLineageWorkItemType that can be the first request of a walk
+// hop by hop, or the request of a server-side walk.
+using ReadLineageWorkItemType =
+    absl::variant<GetEventsByArtifactIDsRequest, GetLineageGraphRequest>;
+
+// A specific workload for walking the upstream / downstream lineage of
+// artifacts for several hops.
+class ReadLineage : public Workload<ReadLineageWorkItemType> {
+ public:
+  ReadLineage(const ReadLineageConfig& read_lineage_config,
+              int64 num_operations);
+  ~ReadLineage() override = default;
+
+ protected:
+  // Specific implementation of SetUpImpl() for ReadLineage workload according
+  // to its semantic.
+  // A layered DAG is generated: a first layer of `dag_width` artifacts, then
+  // `dag_depth` layers of `dag_width` executions, each reading `fan_out`
+  // artifacts of the previous layer and outputting an artifact. A list of
+  // work items(ReadLineageWorkItemType) will be generated, each walking from
+  // a seed artifact picked uniformly among the first layer for DOWNSTREAM or
+  // the last layer for UPSTREAM.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of RunOpImpl() for ReadLineage workload according
+  // to its semantic.
+  // Walks `num_hops` hops from the seed of the work item, hop by hop or with a
+  // single request.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status RunOpImpl(int64 work_items_index,
+                               MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of TearDownImpl() for ReadLineage workload
+  // according to its semantic. Cleans the work items.
+  tensorflow::Status TearDownImpl() final;
+
+  // Gets the current workload's name, which is used in stats report for this
+  // workload.
+  std::string GetName() final;
+
+ private:
+  // Workload configurations specified by the users.
+  const ReadLineageConfig read_lineage_config_;
+  // Number of operations for the current workload.
+  const int64 num_operations_;
+  // String for indicating the name of current workload instance.
+  const std::string name_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_READ_LINEAGE_WORKLOAD_H
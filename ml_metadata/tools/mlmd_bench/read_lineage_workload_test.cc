@@ -0,0 +1,125 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/read_lineage_workload.h"
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfOperations = 20;
+constexpr int kDagDepth = 4;
+constexpr int kDagWidth = 5;
+constexpr int kFanOut = 2;
+// The size of an event, i.e., its artifact id, execution id and type.
+constexpr int kEventSize = 17;
+
+// Enumerates the workload configurations as the test parameters that ensure
+// test coverage.
+std::vector<WorkloadConfig> EnumerateConfigs() {
+  std::vector<WorkloadConfig> configs;
+
+  for (const ReadLineageConfig::Specification specification :
+       {ReadLineageConfig::UPSTREAM, ReadLineageConfig::DOWNSTREAM}) {
+    for (const ReadLineageConfig::Traversal traversal :
+         {ReadLineageConfig::PER_HOP_EVENTS,
+          ReadLineageConfig::LINEAGE_GRAPH}) {
+      WorkloadConfig config;
+      config.set_num_operations(kNumberOfOperations);
+      ReadLineageConfig& read_lineage_config =
+          *config.mutable_read_lineage_config();
+      read_lineage_config.set_specification(specification);
+      read_lineage_config.set_traversal(traversal);
+      read_lineage_config.set_num_hops(2);
+      read_lineage_config.set_dag_depth(kDagDepth);
+      read_lineage_config.set_dag_width(kDagWidth);
+      read_lineage_config.set_fan_out(kFanOut);
+      configs.push_back(config);
+    }
+  }
+
+  return configs;
+}
+
+// Test fixture that uses the same data configuration for multiple following
+// parameterized ReadLineage tests.
+// The parameter here is the specific Workload configuration that contains
+// the ReadLineage configuration and the number of operations.
+class ReadLineageParameterizedTestFixture
+    : public ::testing::TestWithParam<WorkloadConfig> {
+ protected:
+  void SetUp() override {
+    ConnectionConfig mlmd_config;
+    // Uses a fake in-memory SQLite database for testing.
+    mlmd_config.mutable_fake_database();
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store_));
+    read_lineage_ = absl::make_unique<ReadLineage>(ReadLineage(
+        GetParam().read_lineage_config(), GetParam().num_operations()));
+  }
+
+  std::unique_ptr<ReadLineage> read_lineage_;
+  std::unique_ptr<MetadataStore> store_;
+};
+
+// Tests the SetUpImpl() for ReadLineage. Checks the SetUpImpl() indeed
+// generates the DAG and prepares a list of work items whose length is the
+// same as the specified number of operations.
+TEST_P(ReadLineageParameterizedTestFixture, SetUpImplTest) {
+  TF_ASSERT_OK(read_lineage_->SetUp(store_.get()));
+  EXPECT_EQ(GetParam().num_operations(), read_lineage_->num_operations());
+
+  GetArtifactsRequest get_artifacts_request;
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(
+      store_->GetArtifacts(get_artifacts_request, &get_artifacts_response));
+  EXPECT_EQ(get_artifacts_response.artifacts_size(),
+            (kDagDepth + 1) * kDagWidth);
+  GetExecutionsRequest get_executions_request;
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(
+      store_->GetExecutions(get_executions_request, &get_executions_response));
+  EXPECT_EQ(get_executions_response.executions_size(), kDagDepth * kDagWidth);
+}
+
+// Tests the RunOpImpl() for ReadLineage. Checks each walk of two hops follows
+// the events of a single layer: upstream, the output of the execution which
+// produced the seed and its `kFanOut` inputs; downstream, the inputs of the
+// `kFanOut` executions which consumed the seed and their outputs.
+TEST_P(ReadLineageParameterizedTestFixture, RunOpImplTest) {
+  TF_ASSERT_OK(read_lineage_->SetUp(store_.get()));
+  const int64 expected_num_events =
+      GetParam().read_lineage_config().specification() ==
+              ReadLineageConfig::UPSTREAM
+          ? 1 + kFanOut
+          : 2 * kFanOut;
+  for (int64 i = 0; i < read_lineage_->num_operations(); ++i) {
+    OpStats op_stats;
+    TF_ASSERT_OK(read_lineage_->RunOp(i, store_.get(), op_stats));
+    EXPECT_EQ(op_stats.transferred_bytes, expected_num_events * kEventSize);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(ReadLineageTest, ReadLineageParameterizedTestFixture,
+                        ::testing::ValuesIn(EnumerateConfigs()));
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,278 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/read_nodes_by_list_workload.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int64 kInt64IdSize = 8;
+constexpr int64 kInt64TypeIdSize = 8;
+constexpr int64 kInt64CreateTimeSize = 8;
+constexpr int64 kInt64LastUpdateTimeSize = 8;
+
+// A page of the listed nodes: the next_page_token which reads it, and the
+// transferred bytes of its nodes.
+struct Page {
+  std::string page_token;
+  int64 bytes;
+};
+
+// Validates the page size and page distribution of
+// `read_nodes_by_list_config`. Returns INVALID_ARGUMENT error if one of them is
+// not correct.
+tensorflow::Status ValidateReadNodesByListConfig(
+    const ReadNodesByListConfig& read_nodes_by_list_config) {
+  if (read_nodes_by_list_config.page_size() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The page_size must be positive.");
+  }
+  const UniformDistribution& page_index =
+      read_nodes_by_list_config.page_index();
+  if (page_index.minimum() < 0 || page_index.minimum() > page_index.maximum()) {
+    return tensorflow::errors::InvalidArgument(
+        "The page_index must be a non-negative range.");
+  }
+  return tensorflow::Status::OK();
+}
+
+// Gets the transferred bytes for certain `properties` and returns their bytes.
+int64 GetTransferredBytesForNodeProperties(
+    const google::protobuf::Map<std::string, Value>& properties) {
+  int64 bytes = 0;
+  for (auto& pair : properties) {
+    // Includes the bytes for properties' name size.
+    bytes += pair.first.size();
+    // Includes the bytes for properties' value size.
+    bytes += pair.second.string_value().size();
+  }
+  return bytes;
+}
+
+// Gets the transferred bytes for certain node: Artifact / Execution / Context.
+template <typename NT>
+int64 GetTransferredBytesForNode(const NT& node) {
+  int64 bytes = kInt64IdSize + kInt64TypeIdSize + kInt64CreateTimeSize +
+                kInt64LastUpdateTimeSize;
+  bytes += node.name().size();
+  bytes += node.type().size();
+  bytes += GetTransferredBytesForNodeProperties(node.properties());
+  bytes += GetTransferredBytesForNodeProperties(node.custom_properties());
+  return bytes;
+}
+
+// Gets the transferred bytes for the nodes of a page.
+int64 GetTransferredBytesForPage(const GetArtifactsResponse& response) {
+  int64 bytes = 0;
+  for (const Artifact& artifact : response.artifacts()) {
+    bytes += GetTransferredBytesForNode(artifact) + artifact.uri().size();
+  }
+  return bytes;
+}
+
+int64 GetTransferredBytesForPage(const GetExecutionsResponse& response) {
+  int64 bytes = 0;
+  for (const Execution& execution : response.executions()) {
+    bytes += GetTransferredBytesForNode(execution);
+  }
+  return bytes;
+}
+
+int64 GetTransferredBytesForPage(const GetContextsResponse& response) {
+  int64 bytes = 0;
+  for (const Context& context : response.contexts()) {
+    bytes += GetTransferredBytesForNode(context);
+  }
+  return bytes;
+}
+
+// Prepares the ListOperationOptions of `request` to read the page of
+// `page_token`.
+template <typename Request>
+void PrepareListRequest(const ReadNodesByListConfig& read_nodes_by_list_config,
+                        const std::string& page_token, Request& request) {
+  ListOperationOptions& options = *request.mutable_options();
+  options.set_max_result_size(read_nodes_by_list_config.page_size());
+  *options.mutable_order_by_field() =
+      read_nodes_by_list_config.order_by_field();
+  if (!page_token.empty()) {
+    options.set_next_page_token(page_token);
+  }
+}
+
+// Lists all the nodes page by page with `list_nodes`, and records the `pages`.
+// Returns detailed error if query executions failed.
+template <typename Request, typename Response>
+tensorflow::Status ListAllPages(
+    const ReadNodesByListConfig& read_nodes_by_list_config,
+    tensorflow::Status (MetadataStoreServiceInterface::*list_nodes)(
+        const Request&, Response*),
+    MetadataStoreServiceInterface& store, std::vector<Page>& pages) {
+  std::string page_token;
+  do {
+    Request request;
+    PrepareListRequest(read_nodes_by_list_config, page_token, request);
+    Response response;
+    TF_RETURN_IF_ERROR((store.*list_nodes)(request, &response));
+    const int64 bytes = GetTransferredBytesForPage(response);
+    // An empty page, e.g., of an empty db, is not read by the work items.
+    if (bytes == 0) {
+      break;
+    }
+    pages.push_back({page_token, bytes});
+    page_token = response.next_page_token();
+  } while (!page_token.empty());
+  return tensorflow::Status::OK();
+}
+
+// Lists all the nodes of the specification of `read_nodes_by_list_config`.
+// Returns FAILED_PRECONDITION if there is no nodes inside db to list.
+// Returns detailed error if query executions failed.
+tensorflow::Status GetAndValidatePages(
+    const ReadNodesByListConfig& read_nodes_by_list_config,
+    MetadataStoreServiceInterface& store, std::vector<Page>& pages) {
+  switch (read_nodes_by_list_config.specification()) {
+    case ReadNodesByListConfig::ARTIFACTS:
+      TF_RETURN_IF_ERROR(
+          ListAllPages(read_nodes_by_list_config,
+                       &MetadataStoreServiceInterface::GetArtifacts, store,
+                       pages));
+      break;
+    case ReadNodesByListConfig::EXECUTIONS:
+      TF_RETURN_IF_ERROR(
+          ListAllPages(read_nodes_by_list_config,
+                       &MetadataStoreServiceInterface::GetExecutions, store,
+                       pages));
+      break;
+    case ReadNodesByListConfig::CONTEXTS:
+      TF_RETURN_IF_ERROR(
+          ListAllPages(read_nodes_by_list_config,
+                       &MetadataStoreServiceInterface::GetContexts, store,
+                       pages));
+      break;
+    default:
+      LOG(FATAL) << "Unknown ReadNodesByListConfig specification.";
+  }
+  if (pages.empty()) {
+    return tensorflow::errors::FailedPrecondition(
+        "There are no nodes inside db to list!");
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+ReadNodesByList::ReadNodesByList(
+    const ReadNodesByListConfig& read_nodes_by_list_config,
+    int64 num_operations)
+    : read_nodes_by_list_config_(read_nodes_by_list_config),
+      num_operations_(num_operations),
+      name_(absl::StrCat("LIST_",
+                         read_nodes_by_list_config_.Specification_Name(
+                             read_nodes_by_list_config_.specification()))) {
+  TF_CHECK_OK(ValidateReadNodesByListConfig(read_nodes_by_list_config_));
+}
+
+tensorflow::Status ReadNodesByList::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
+  LOG(INFO) << "Setting up ...";
+
+  std::vector<Page> pages;
+  TF_RETURN_IF_ERROR(
+      GetAndValidatePages(read_nodes_by_list_config_, *store, pages));
+
+  std::uniform_int_distribution<int64> page_index_dist{
+      read_nodes_by_list_config_.page_index().minimum(),
+      read_nodes_by_list_config_.page_index().maximum()};
+  std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  for (int64 i = 0; i < num_operations_; ++i) {
+    const Page& page =
+        pages[std::min<int64>(page_index_dist(gen), pages.size() - 1)];
+    ReadNodesByListWorkItemType request;
+    switch (read_nodes_by_list_config_.specification()) {
+      case ReadNodesByListConfig::ARTIFACTS:
+        request = GetArtifactsRequest();
+        PrepareListRequest(read_nodes_by_list_config_, page.page_token,
+                           absl::get<GetArtifactsRequest>(request));
+        break;
+      case ReadNodesByListConfig::EXECUTIONS:
+        request = GetExecutionsRequest();
+        PrepareListRequest(read_nodes_by_list_config_, page.page_token,
+                           absl::get<GetExecutionsRequest>(request));
+        break;
+      case ReadNodesByListConfig::CONTEXTS:
+        request = GetContextsRequest();
+        PrepareListRequest(read_nodes_by_list_config_, page.page_token,
+                           absl::get<GetContextsRequest>(request));
+        break;
+      default:
+        LOG(FATAL) << "Unknown ReadNodesByListConfig specification.";
+    }
+    work_items_.emplace_back(request, page.bytes);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ReadNodesByList::RunOpImpl(
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
+  switch (read_nodes_by_list_config_.specification()) {
+    case ReadNodesByListConfig::ARTIFACTS: {
+      GetArtifactsRequest request =
+          absl::get<GetArtifactsRequest>(work_items_[work_items_index].first);
+      GetArtifactsResponse response;
+      return store->GetArtifacts(request, &response);
+    }
+    case ReadNodesByListConfig::EXECUTIONS: {
+      GetExecutionsRequest request =
+          absl::get<GetExecutionsRequest>(work_items_[work_items_index].first);
+      GetExecutionsResponse response;
+      return store->GetExecutions(request, &response);
+    }
+    case ReadNodesByListConfig::CONTEXTS: {
+      GetContextsRequest request =
+          absl::get<GetContextsRequest>(work_items_[work_items_index].first);
+      GetContextsResponse response;
+      return store->GetContexts(request, &response);
+    }
+    default:
+      return tensorflow::errors::InvalidArgument("Unknown specification!");
+  }
+}
+
+tensorflow::Status ReadNodesByList::TearDownImpl() {
+  work_items_.clear();
+  return tensorflow::Status::OK();
+}
+
+std::string ReadNodesByList::GetName() { return name_; }
+
+}  // namespace ml_metadata
@@ -0,0 +1,79 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_READ_NODES_BY_LIST_WORKLOAD_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_READ_NODES_BY_LIST_WORKLOAD_H
+
+#include "absl/types/variant.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/workload.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Defines a ReadNodesByListWorkItemType that can be different requests to
+// list a page of MLMD nodes.
+using ReadNodesByListWorkItemType =
+    absl::variant<GetArtifactsRequest, GetExecutionsRequest,
+                  GetContextsRequest>;
+
+// A specific workload for listing nodes: Artifacts / Executions / Contexts by
+// pages.
+class ReadNodesByList : public Workload<ReadNodesByListWorkItemType> {
+ public:
+  ReadNodesByList(const ReadNodesByListConfig& read_nodes_by_list_config,
+                  int64 num_operations);
+  ~ReadNodesByList() override = default;
+
+ protected:
+  // Specific implementation of SetUpImpl() for ReadNodesByList workload
+  // according to its semantic.
+  // The nodes are listed once, page by page, with the order and page size of
+  // the config, to collect the next_page_token of each page. A list of work
+  // items(ReadNodesByListWorkItemType) will be generated, each reading the
+  // page picked w.r.t. the uniform distribution `page_index`.
+  // Returns FailedPrecondition error, if there are no nodes to list.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of RunOpImpl() for ReadNodesByList workload
+  // according to its semantic.
+  // Runs the work items(ReadNodesByListWorkItemType) on the store.
+  // Returns detailed error if query executions failed.
+  tensorflow::Status RunOpImpl(int64 work_items_index,
+                               MetadataStoreServiceInterface* store) final;
+
+  // Specific implementation of TearDownImpl() for ReadNodesByList workload
+  // according to its semantic. Cleans the work items.
+  tensorflow::Status TearDownImpl() final;
+
+  // Gets the current workload's name, which is used in stats report for this
+  // workload.
+  std::string GetName() final;
+
+ private:
+  // Workload configurations specified by the users.
+  const ReadNodesByListConfig read_nodes_by_list_config_;
+  // Number of operations for the current workload.
+  const int64 num_operations_;
+  // String for indicating the name of current workload instance.
+  const std::string name_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_READ_NODES_BY_LIST_WORKLOAD_H
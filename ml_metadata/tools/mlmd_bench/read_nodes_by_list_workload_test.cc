@@ -0,0 +1,122 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/read_nodes_by_list_workload.h"
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumberOfOperations = 50;
+constexpr int kNumberOfExistedTypesInDb = 10;
+constexpr int kNumberOfExistedNodesInDb = 100;
+constexpr int kPageSize = 7;
+
+// Enumerates the workload configurations as the test parameters that ensure
+// test coverage.
+std::vector<WorkloadConfig> EnumerateConfigs() {
+  std::vector<WorkloadConfig> configs;
+
+  for (const ReadNodesByListConfig::Specification specification :
+       {ReadNodesByListConfig::ARTIFACTS, ReadNodesByListConfig::EXECUTIONS,
+        ReadNodesByListConfig::CONTEXTS}) {
+    for (const ListOperationOptions::OrderByField::Field field :
+         {ListOperationOptions::OrderByField::CREATE_TIME,
+          ListOperationOptions::OrderByField::LAST_UPDATE_TIME,
+          ListOperationOptions::OrderByField::ID}) {
+      WorkloadConfig config;
+      config.set_num_operations(kNumberOfOperations);
+      ReadNodesByListConfig& read_nodes_by_list_config =
+          *config.mutable_read_nodes_by_list_config();
+      read_nodes_by_list_config.set_specification(specification);
+      read_nodes_by_list_config.mutable_order_by_field()->set_field(field);
+      read_nodes_by_list_config.mutable_order_by_field()->set_is_asc(false);
+      read_nodes_by_list_config.set_page_size(kPageSize);
+      // The pages beyond the last one read the last one.
+      read_nodes_by_list_config.mutable_page_index()->set_minimum(0);
+      read_nodes_by_list_config.mutable_page_index()->set_maximum(
+          kNumberOfExistedNodesInDb);
+      configs.push_back(config);
+    }
+  }
+
+  return configs;
+}
+
+// Test fixture that uses the same data configuration for multiple following
+// parameterized ReadNodesByList tests.
+// The parameter here is the specific Workload configuration that contains
+// the ReadNodesByList configuration and the number of operations.
+class ReadNodesByListParameterizedTestFixture
+    : public ::testing::TestWithParam<WorkloadConfig> {
+ protected:
+  void SetUp() override {
+    ConnectionConfig mlmd_config;
+    // Uses a fake in-memory SQLite database for testing.
+    mlmd_config.mutable_fake_database();
+    TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store_));
+    read_nodes_by_list_ = absl::make_unique<ReadNodesByList>(
+        ReadNodesByList(GetParam().read_nodes_by_list_config(),
+                        GetParam().num_operations()));
+  }
+
+  std::unique_ptr<ReadNodesByList> read_nodes_by_list_;
+  std::unique_ptr<MetadataStore> store_;
+};
+
+// Tests the SetUpImpl() for ReadNodesByList when there are no nodes to list.
+TEST_P(ReadNodesByListParameterizedTestFixture, SetUpImplWhenNoNodesTest) {
+  EXPECT_EQ(read_nodes_by_list_->SetUp(store_.get()).code(),
+            tensorflow::error::FAILED_PRECONDITION);
+}
+
+// Tests the SetUpImpl() and RunOpImpl() for ReadNodesByList. Checks the
+// SetUpImpl() indeed prepares a list of work items whose length is the same as
+// the specified number of operations, and that each page is read.
+TEST_P(ReadNodesByListParameterizedTestFixture, ReadPagesTest) {
+  TF_ASSERT_OK(InsertTypesInDb(
+      /*num_artifact_types=*/kNumberOfExistedTypesInDb,
+      /*num_execution_types=*/kNumberOfExistedTypesInDb,
+      /*num_context_types=*/kNumberOfExistedTypesInDb, *store_));
+  TF_ASSERT_OK(InsertNodesInDb(
+      /*num_artifact_nodes=*/kNumberOfExistedNodesInDb,
+      /*num_execution_nodes=*/kNumberOfExistedNodesInDb,
+      /*num_context_nodes=*/kNumberOfExistedNodesInDb, *store_));
+
+  TF_ASSERT_OK(read_nodes_by_list_->SetUp(store_.get()));
+  EXPECT_EQ(GetParam().num_operations(),
+            read_nodes_by_list_->num_operations());
+  for (int64 i = 0; i < read_nodes_by_list_->num_operations(); ++i) {
+    OpStats op_stats;
+    TF_ASSERT_OK(read_nodes_by_list_->RunOp(i, store_.get(), op_stats));
+    EXPECT_GT(op_stats.transferred_bytes, 0);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(ReadNodesByListTest,
+                        ReadNodesByListParameterizedTestFixture,
+                        ::testing::ValuesIn(EnumerateConfigs()));
+
+}  // namespace
+}  // namespace ml_metadata
@@ -17,8 +17,9 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "absl/time/clock.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -40,7 +41,7 @@ constexpr int64 kEnumStateSize = 1;
 // Returns FAILED_PRECONDITION if there is no nodes inside db to read from.
 tensorflow::Status GetAndValidateExistingNodes(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes) {
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes) {
   TF_RETURN_IF_ERROR(
       GetExistingNodes(read_nodes_by_properties_config, store, existing_nodes));
   if (existing_nodes.empty()) {
@@ -119,7 +120,7 @@ int64 GetTransferredBytesForAllNodesUnderAType(
 tensorflow::Status SetUpImplForReadNodesByIds(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
     const std::vector<Node>& existing_nodes,
-    std::uniform_int_distribution<int64>& node_index_dist,
+    std::discrete_distribution<int64>& node_index_dist,
     std::minstd_rand0& gen, ReadNodesByPropertiesWorkItemType& request,
     int64& curr_bytes) {
   UniformDistribution num_ids_proto_dist =
@@ -169,7 +170,7 @@ tensorflow::Status SetUpImplForReadNodesByIds(
 tensorflow::Status SetUpImplForReadArtifactsByURIs(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
     const std::vector<Node>& existing_nodes,
-    std::uniform_int_distribution<int64>& node_index_dist,
+    std::discrete_distribution<int64>& node_index_dist,
     std::minstd_rand0& gen, ReadNodesByPropertiesWorkItemType& request,
     int64& curr_bytes) {
   if (read_nodes_by_properties_config.specification() !=
@@ -195,12 +196,42 @@ tensorflow::Status SetUpImplForReadArtifactsByURIs(
   return tensorflow::Status::OK();
 }
 
+// SetUpImpl() for the specification to read artifacts by a uri prefix in db.
+// The prefix is the uri of an existing artifact without its last `_`-separated
+// part, so that it matches the artifacts with the same name prefix.
+// Returns detailed error if query executions failed.
+tensorflow::Status SetUpImplForReadArtifactsByURIPrefix(
+    const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
+    const std::vector<Node>& existing_nodes,
+    std::discrete_distribution<int64>& node_index_dist,
+    std::minstd_rand0& gen, ReadNodesByPropertiesWorkItemType& request,
+    int64& curr_bytes) {
+  if (read_nodes_by_properties_config.has_num_of_parameters()) {
+    LOG(FATAL) << "ReadArtifactsByURIPrefix specification should not have a "
+                  "`num_of_parameters` field!";
+  }
+  // Selects from existing nodes uniformly to get a uri prefix.
+  const int64 node_index = node_index_dist(gen);
+  const std::string& uri =
+      absl::get<Artifact>(existing_nodes[node_index]).uri();
+  const std::string uri_prefix = uri.substr(0, uri.find_last_of('_'));
+  request = GetArtifactsByURIPrefixRequest();
+  absl::get<GetArtifactsByURIPrefixRequest>(request).set_uri_prefix(
+      uri_prefix);
+  for (const Node& node : existing_nodes) {
+    if (absl::StartsWith(absl::get<Artifact>(node).uri(), uri_prefix)) {
+      curr_bytes += GetTransferredBytes(absl::get<Artifact>(node));
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
 // SetUpImpl() for the specifications to read artifacts by type in db.
 // Returns detailed error if query executions failed.
 tensorflow::Status SetUpImplForReadNodesByType(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
     const std::vector<Node>& existing_nodes,
-    std::uniform_int_distribution<int64>& node_index_dist,
+    std::discrete_distribution<int64>& node_index_dist,
     std::minstd_rand0& gen, ReadNodesByPropertiesWorkItemType& request,
     int64& curr_bytes) {
   if (read_nodes_by_properties_config.has_num_of_parameters()) {
@@ -249,7 +280,7 @@ tensorflow::Status SetUpImplForReadNodesByType(
 tensorflow::Status SetUpImplForReadNodeByTypeAndName(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
     const std::vector<Node>& existing_nodes,
-    std::uniform_int_distribution<int64>& node_index_dist,
+    std::discrete_distribution<int64>& node_index_dist,
     std::minstd_rand0& gen, ReadNodesByPropertiesWorkItemType& request,
     int64& curr_bytes) {
   if (read_nodes_by_properties_config.has_num_of_parameters()) {
@@ -307,7 +338,8 @@ ReadNodesByProperties::ReadNodesByProperties(
           "READ_", read_nodes_by_properties_config_.Specification_Name(
                        read_nodes_by_properties_config_.specification()))) {}
 
-tensorflow::Status ReadNodesByProperties::SetUpImpl(MetadataStore* store) {
+tensorflow::Status ReadNodesByProperties::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   // Gets all the specific nodes in db to choose from when reading nodes.
@@ -315,10 +347,14 @@ tensorflow::Status ReadNodesByProperties::SetUpImpl(MetadataStore* store) {
   std::vector<Node> existing_nodes;
   TF_RETURN_IF_ERROR(GetAndValidateExistingNodes(
       read_nodes_by_properties_config_, *store, existing_nodes));
-  // Uniform distribution to select existing nodes uniformly.
-  std::uniform_int_distribution<int64> node_index_dist{
-      0, (int64)(existing_nodes.size() - 1)};
+  // Selects existing nodes w.r.t. their popularity, uniformly by default.
+  TF_RETURN_IF_ERROR(ValidateNodePopularity(
+      read_nodes_by_properties_config_.node_popularity()));
   std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  std::discrete_distribution<int64> node_index_dist =
+      GenerateNodePopularityDistribution(
+          existing_nodes.size(),
+          read_nodes_by_properties_config_.node_popularity(), gen);
 
   for (int64 i = 0; i < num_operations_; ++i) {
     int64 curr_bytes = 0;
@@ -336,6 +372,11 @@ tensorflow::Status ReadNodesByProperties::SetUpImpl(MetadataStore* store) {
             read_nodes_by_properties_config_, existing_nodes, node_index_dist,
             gen, read_request, curr_bytes));
         break;
+      case ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI_PREFIX:
+        TF_RETURN_IF_ERROR(SetUpImplForReadArtifactsByURIPrefix(
+            read_nodes_by_properties_config_, existing_nodes, node_index_dist,
+            gen, read_request, curr_bytes));
+        break;
       case ReadNodesByPropertiesConfig::ARTIFACTS_BY_TYPE:
       case ReadNodesByPropertiesConfig::EXECUTIONS_BY_TYPE:
       case ReadNodesByPropertiesConfig::CONTEXTS_BY_TYPE:
@@ -360,7 +401,7 @@ tensorflow::Status ReadNodesByProperties::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status ReadNodesByProperties::RunOpImpl(
-    const int64 work_items_index, MetadataStore* store) {
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
   switch (read_nodes_by_properties_config_.specification()) {
     case ReadNodesByPropertiesConfig::ARTIFACTS_BY_ID: {
       auto request = absl::get<GetArtifactsByIDRequest>(
@@ -422,6 +463,12 @@ tensorflow::Status ReadNodesByProperties::RunOpImpl(
       GetArtifactsByURIResponse response;
       return store->GetArtifactsByURI(request, &response);
     }
+    case ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI_PREFIX: {
+      auto request = absl::get<GetArtifactsByURIPrefixRequest>(
+          work_items_[work_items_index].first);
+      GetArtifactsByURIPrefixResponse response;
+      return store->GetArtifactsByURIPrefix(request, &response);
+    }
     default:
       return tensorflow::errors::InvalidArgument("Wrong specification!");
   }
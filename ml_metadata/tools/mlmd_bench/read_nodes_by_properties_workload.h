@@ -16,7 +16,7 @@ limitations under the License.
 #define ML_METADATA_TOOLS_MLMD_BENCH_READ_NODES_BY_PROPERTIES_WORKLOAD_H
 
 #include "absl/types/variant.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -33,7 +33,8 @@ using ReadNodesByPropertiesWorkItemType =
                   GetExecutionsByTypeRequest, GetContextsByTypeRequest,
                   GetArtifactByTypeAndNameRequest,
                   GetExecutionByTypeAndNameRequest,
-                  GetContextByTypeAndNameRequest, GetArtifactsByURIRequest>;
+                  GetContextByTypeAndNameRequest, GetArtifactsByURIRequest,
+                  GetArtifactsByURIPrefixRequest>;
 
 // A specific workload for getting nodes: Artifacts / Executions / Contexts by
 // their properties.
@@ -55,14 +56,14 @@ class ReadNodesByProperties
   // CONTEXTS_BY_ID or ARTIFACTS_BY_URI, the number of ids or uris per request
   // will be generated w.r.t. the uniform distribution `num_of_parameters`.
   // Returns detailed error if query executions failed.
-  tensorflow::Status SetUpImpl(MetadataStore* store) final;
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of RunOpImpl() for ReadNodesByProperties workload
   // according to its semantic.
   // Runs the work items(ReadNodesByPropertiesWorkItemType) on the store.
   // Returns detailed error if query executions failed.
   tensorflow::Status RunOpImpl(int64 work_items_index,
-                               MetadataStore* store) final;
+                               MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of TearDownImpl() for ReadNodesByProperties
   // workload according to its semantic. Cleans the work items.
@@ -47,7 +47,8 @@ std::vector<WorkloadConfig> EnumerateConfigs() {
       ReadNodesByPropertiesConfig::ARTIFACT_BY_TYPE_AND_NAME,
       ReadNodesByPropertiesConfig::EXECUTION_BY_TYPE_AND_NAME,
       ReadNodesByPropertiesConfig::CONTEXT_BY_TYPE_AND_NAME,
-      ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI};
+      ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI,
+      ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI_PREFIX};
 
   for (const ReadNodesByPropertiesConfig::Specification& specification :
        specifications) {
@@ -69,6 +70,24 @@ std::vector<WorkloadConfig> EnumerateConfigs() {
     configs.push_back(config);
   }
 
+  // Reads the nodes w.r.t. skewed popularities.
+  for (const char* node_popularity :
+       {"zipf: { skew: 1.0 }",
+        "hot_set: { hot_node_fraction: 0.1 hot_operation_fraction: 0.9 }"}) {
+    WorkloadConfig config;
+    config.set_num_operations(kNumberOfOperations);
+    ReadNodesByPropertiesConfig& read_nodes_by_properties_config =
+        *config.mutable_read_nodes_by_properties_config();
+    read_nodes_by_properties_config.set_specification(
+        ReadNodesByPropertiesConfig::ARTIFACTS_BY_ID);
+    read_nodes_by_properties_config.mutable_num_of_parameters()->set_minimum(1);
+    read_nodes_by_properties_config.mutable_num_of_parameters()->set_maximum(
+        10);
+    *read_nodes_by_properties_config.mutable_node_popularity() =
+        testing::ParseTextProtoOrDie<NodePopularity>(node_popularity);
+    configs.push_back(config);
+  }
+
   return configs;
 }
 
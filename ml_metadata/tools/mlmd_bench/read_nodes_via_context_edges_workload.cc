@@ -19,7 +19,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/time/clock.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -41,7 +41,7 @@ constexpr int64 kEnumStateSize = 1;
 // Returns FAILED_PRECONDITION if there is no nodes inside db to read from.
 tensorflow::Status GetAndValidateExistingNodes(
     const ReadNodesViaContextEdgesConfig& read_nodes_via_context_edges_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes) {
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes) {
   TF_RETURN_IF_ERROR(GetExistingNodes(read_nodes_via_context_edges_config,
                                       store, existing_nodes));
   if (existing_nodes.empty()) {
@@ -108,8 +108,8 @@ int64 GetTransferredBytesForNode(const Context& node) {
 // detailed error if query executions failed.
 template <typename T>
 tensorflow::Status GetTransferredBytes(
-    const ReadNodesViaContextEdgesWorkItemType& request, MetadataStore& store,
-    int64& curr_bytes) {
+    const ReadNodesViaContextEdgesWorkItemType& request,
+    MetadataStoreServiceInterface& store, int64& curr_bytes) {
   CHECK((std::is_same<T, GetArtifactsByContextRequest>::value ||
          std::is_same<T, GetExecutionsByContextRequest>::value ||
          std::is_same<T, GetContextsByArtifactRequest>::value ||
@@ -160,7 +160,8 @@ ReadNodesViaContextEdges::ReadNodesViaContextEdges(
                        read_nodes_via_context_edges_config_.specification()))) {
 }
 
-tensorflow::Status ReadNodesViaContextEdges::SetUpImpl(MetadataStore* store) {
+tensorflow::Status ReadNodesViaContextEdges::SetUpImpl(
+    MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
 
   // Gets all the specific nodes in db to choose from when reading nodes.
@@ -168,15 +169,19 @@ tensorflow::Status ReadNodesViaContextEdges::SetUpImpl(MetadataStore* store) {
   std::vector<Node> existing_nodes;
   TF_RETURN_IF_ERROR(GetAndValidateExistingNodes(
       read_nodes_via_context_edges_config_, *store, existing_nodes));
-  // Uniform distribution to select existing nodes uniformly.
-  std::uniform_int_distribution<int64> uniform_dist_node_index{
-      0, (int64)(existing_nodes.size() - 1)};
+  // Selects existing nodes w.r.t. their popularity, uniformly by default.
+  TF_RETURN_IF_ERROR(ValidateNodePopularity(
+      read_nodes_via_context_edges_config_.node_popularity()));
   std::minstd_rand0 gen(absl::ToUnixMillis(absl::Now()));
+  std::discrete_distribution<int64> node_index_dist =
+      GenerateNodePopularityDistribution(
+          existing_nodes.size(),
+          read_nodes_via_context_edges_config_.node_popularity(), gen);
 
   for (int64 i = 0; i < num_operations_; ++i) {
     int64 curr_bytes = 0;
     ReadNodesViaContextEdgesWorkItemType read_request;
-    const int64 node_index = uniform_dist_node_index(gen);
+    const int64 node_index = node_index_dist(gen);
     switch (read_nodes_via_context_edges_config_.specification()) {
       case ReadNodesViaContextEdgesConfig::ARTIFACTS_BY_CONTEXT: {
         read_request = GetArtifactsByContextRequest();
@@ -224,7 +229,7 @@ tensorflow::Status ReadNodesViaContextEdges::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status ReadNodesViaContextEdges::RunOpImpl(
-    const int64 work_items_index, MetadataStore* store) {
+    const int64 work_items_index, MetadataStoreServiceInterface* store) {
   switch (read_nodes_via_context_edges_config_.specification()) {
     case ReadNodesViaContextEdgesConfig::ARTIFACTS_BY_CONTEXT: {
       auto request = absl::get<GetArtifactsByContextRequest>(
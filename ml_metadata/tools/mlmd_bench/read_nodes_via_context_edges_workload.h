@@ -16,7 +16,7 @@ limitations under the License.
 #define ML_METADATA_TOOLS_MLMD_BENCH_READ_NODES_VIA_CONTEXT_EDGES_WORKLOAD_H
 
 #include "absl/types/variant.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
@@ -49,14 +49,14 @@ class ReadNodesViaContextEdges
   // Contexts} to the destination node. When generating the querying string,
   // we choose nodes from the source node uniformly. Returns detailed error if
   // query executions failed.
-  tensorflow::Status SetUpImpl(MetadataStore* store) final;
+  tensorflow::Status SetUpImpl(MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of RunOpImpl() for ReadNodesViaContextEdges
   // workload according to its semantic.
   // Runs the work items(ReadNodesViaContextEdgesWorkItemType) on the store.
   // Returns detailed error if query executions failed.
   tensorflow::Status RunOpImpl(int64 work_items_index,
-                               MetadataStore* store) final;
+                               MetadataStoreServiceInterface* store) final;
 
   // Specific implementation of TearDownImpl() for ReadNodesViaContextEdges
   // workload according to its semantic. Cleans the work items.
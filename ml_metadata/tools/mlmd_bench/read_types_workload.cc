@@ -19,7 +19,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -37,8 +37,8 @@ constexpr int64 kPropertyTypeSize = 1;
 // Gets all types inside db. Returns detailed error if query executions failed.
 // Returns FAILED_PRECONDITION if there is no types inside db to read from.
 tensorflow::Status GetAndValidateExistingTypes(
-    const ReadTypesConfig& read_types_config, MetadataStore& store,
-    std::vector<Type>& existing_types) {
+    const ReadTypesConfig& read_types_config,
+    MetadataStoreServiceInterface& store, std::vector<Type>& existing_types) {
   TF_RETURN_IF_ERROR(
       GetExistingTypes(read_types_config, store, existing_types));
   if (existing_types.empty()) {
@@ -204,7 +204,7 @@ ReadTypes::ReadTypes(const ReadTypesConfig& read_types_config,
       name_(absl::StrCat("READ_", read_types_config.Specification_Name(
                                       read_types_config.specification()))) {}
 
-tensorflow::Status ReadTypes::SetUpImpl(MetadataStore* store) {
+tensorflow::Status ReadTypes::SetUpImpl(MetadataStoreServiceInterface* store) {
   LOG(INFO) << "Setting up ...";
   int64 curr_bytes = 0;
 
@@ -252,7 +252,7 @@ tensorflow::Status ReadTypes::SetUpImpl(MetadataStore* store) {
 
 // Executions of work items.
 tensorflow::Status ReadTypes::RunOpImpl(const int64 work_items_index,
-                                        MetadataStore* store) {
+                                        MetadataStoreServiceInterface* store) {
   switch (read_types_config_.specification()) {
     case ReadTypesConfig::ALL_ARTIFACT_TYPES: {
       auto request = absl::get<GetArtifactTypesRequest>(
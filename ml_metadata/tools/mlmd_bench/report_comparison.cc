@@ -0,0 +1,159 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/report_comparison.h"
+
+#include <string>
+#include <vector>
+
+#include "google/protobuf/util/message_differencer.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+namespace {
+
+// Appends the comparison of `metric` of `workload_name` to `comparisons`, if
+// it is set in both summaries. A metric regresses when it is higher than
+// `baseline` by more than `tolerance`, or lower if `higher_is_better`.
+void CompareMetric(const std::string& workload_name, const std::string& metric,
+                   const double baseline, const double candidate,
+                   const bool higher_is_better, const double tolerance,
+                   std::vector<MetricComparison>& comparisons) {
+  if (baseline <= 0 || candidate <= 0) return;
+  MetricComparison comparison;
+  comparison.workload_name = workload_name;
+  comparison.metric = metric;
+  comparison.baseline = baseline;
+  comparison.candidate = candidate;
+  comparison.relative_change = (candidate - baseline) / baseline;
+  comparison.regressed = higher_is_better
+                             ? comparison.relative_change < -tolerance
+                             : comparison.relative_change > tolerance;
+  comparisons.push_back(comparison);
+}
+
+// Appends the comparisons of the metrics of the summaries of `workload_name`
+// to `comparisons`.
+void CompareSummaries(const std::string& workload_name,
+                      const WorkloadConfigResult& baseline,
+                      const WorkloadConfigResult& candidate,
+                      const double tolerance,
+                      std::vector<MetricComparison>& comparisons) {
+  CompareMetric(workload_name, "microseconds_per_operation",
+                baseline.microseconds_per_operation(),
+                candidate.microseconds_per_operation(),
+                /*higher_is_better=*/false, tolerance, comparisons);
+  CompareMetric(workload_name, "p50_microseconds",
+                baseline.latency_percentiles().p50_microseconds(),
+                candidate.latency_percentiles().p50_microseconds(),
+                /*higher_is_better=*/false, tolerance, comparisons);
+  CompareMetric(workload_name, "p90_microseconds",
+                baseline.latency_percentiles().p90_microseconds(),
+                candidate.latency_percentiles().p90_microseconds(),
+                /*higher_is_better=*/false, tolerance, comparisons);
+  CompareMetric(workload_name, "p99_microseconds",
+                baseline.latency_percentiles().p99_microseconds(),
+                candidate.latency_percentiles().p99_microseconds(),
+                /*higher_is_better=*/false, tolerance, comparisons);
+  CompareMetric(workload_name, "achieved_qps", baseline.achieved_qps(),
+                candidate.achieved_qps(), /*higher_is_better=*/true,
+                tolerance, comparisons);
+}
+
+// Appends the comparisons of the metrics of the `candidate_summaries` with
+// the `baseline_summaries` of the same workloads to `comparisons`. The
+// workload names are followed by `name_suffix`. Returns InvalidArgument error
+// if the summaries are not of the same workloads.
+tensorflow::Status CompareSummaryLists(
+    const google::protobuf::RepeatedPtrField<WorkloadConfigResult>&
+        baseline_summaries,
+    const google::protobuf::RepeatedPtrField<WorkloadConfigResult>&
+        candidate_summaries,
+    const std::string& name_suffix, const double tolerance,
+    std::vector<MetricComparison>& comparisons) {
+  if (baseline_summaries.size() != candidate_summaries.size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The reports have different numbers of workloads: ",
+        baseline_summaries.size(), " and ", candidate_summaries.size(), ".");
+  }
+  for (int i = 0; i < baseline_summaries.size(); ++i) {
+    const WorkloadConfigResult& baseline_summary = baseline_summaries.Get(i);
+    const WorkloadConfigResult& candidate_summary = candidate_summaries.Get(i);
+    if (!google::protobuf::util::MessageDifferencer::Equals(
+            baseline_summary.workload_config(),
+            candidate_summary.workload_config())) {
+      return tensorflow::errors::InvalidArgument(
+          "The reports have different configurations for workload ", i, ".");
+    }
+    // The reports written before the workload names were added are compared
+    // by the indexes of their workloads.
+    const std::string workload_name =
+        baseline_summary.workload_name().empty()
+            ? absl::StrCat("WORKLOAD_", i)
+            : baseline_summary.workload_name();
+    CompareSummaries(absl::StrCat(workload_name, name_suffix),
+                     baseline_summary, candidate_summary, tolerance,
+                     comparisons);
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+tensorflow::Status CompareReports(const MLMDBenchReport& baseline,
+                                  const MLMDBenchReport& candidate,
+                                  const double tolerance,
+                                  std::vector<MetricComparison>& comparisons) {
+  if (tolerance < 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The tolerance must be non-negative.");
+  }
+  comparisons.clear();
+  TF_RETURN_IF_ERROR(CompareSummaryLists(baseline.summaries(),
+                                         candidate.summaries(),
+                                         /*name_suffix=*/"", tolerance,
+                                         comparisons));
+  if (baseline.has_aggregate() && candidate.has_aggregate()) {
+    CompareSummaries("AGGREGATE", baseline.aggregate(), candidate.aggregate(),
+                     tolerance, comparisons);
+  }
+  if (baseline.thread_sweep_size() != candidate.thread_sweep_size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The reports have different thread sweeps.");
+  }
+  for (int i = 0; i < baseline.thread_sweep_size(); ++i) {
+    const ThreadSweepPoint& baseline_point = baseline.thread_sweep(i);
+    const ThreadSweepPoint& candidate_point = candidate.thread_sweep(i);
+    if (baseline_point.num_threads() != candidate_point.num_threads()) {
+      return tensorflow::errors::InvalidArgument(
+          "The reports have different thread sweeps.");
+    }
+    const std::string name_suffix =
+        absl::StrCat("@", baseline_point.num_threads(), "_THREADS");
+    TF_RETURN_IF_ERROR(CompareSummaryLists(
+        baseline_point.summaries(), candidate_point.summaries(), name_suffix,
+        tolerance, comparisons));
+    if (baseline_point.has_aggregate() && candidate_point.has_aggregate()) {
+      CompareSummaries(absl::StrCat("AGGREGATE", name_suffix),
+                       baseline_point.aggregate(), candidate_point.aggregate(),
+                       tolerance, comparisons);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,60 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_REPORT_COMPARISON_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_REPORT_COMPARISON_H
+
+#include <string>
+#include <vector>
+
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The comparison of a metric of a workload between two reports.
+struct MetricComparison {
+  // The name of the workload, or AGGREGATE for the aggregate summaries,
+  // followed by the thread count in a thread sweep.
+  std::string workload_name;
+  // The name of the metric, e.g., p99_microseconds.
+  std::string metric;
+  double baseline = 0;
+  double candidate = 0;
+  // The relative change of the candidate from the baseline, e.g., 0.2 for a
+  // value 20% higher.
+  double relative_change = 0;
+  // True if the metric changed for the worse beyond the tolerance.
+  bool regressed = false;
+};
+
+// Compares the summaries of the `candidate` report with the ones of the
+// `baseline` report, e.g., of the same benchmark before an MLMD upgrade. The
+// compared metrics are the microseconds_per_operation, the p50, p90 and p99
+// latencies, which regress when they are higher than the baseline by more
+// than `tolerance`, e.g., 0.1 for 10%, and the achieved_qps, which regresses
+// when it is lower by more than `tolerance`. The metrics which are not set in
+// both reports are skipped. The summaries of a thread sweep are compared at
+// each of its thread counts, e.g., FILL_ARTIFACT_TYPE@8_THREADS. Sets
+// `comparisons` to the compared metrics.
+// Returns InvalidArgument error if the tolerance is negative or the reports do
+// not have the same workloads.
+tensorflow::Status CompareReports(const MLMDBenchReport& baseline,
+                                  const MLMDBenchReport& candidate,
+                                  double tolerance,
+                                  std::vector<MetricComparison>& comparisons);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_REPORT_COMPARISON_H
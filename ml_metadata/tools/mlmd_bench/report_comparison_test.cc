@@ -0,0 +1,118 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/report_comparison.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+MLMDBenchReport GetReport(const double p99_microseconds,
+                          const double achieved_qps) {
+  MLMDBenchReport report = testing::ParseTextProtoOrDie<MLMDBenchReport>(R"(
+    summaries {
+      workload_config {
+        read_types_config { specification: ALL_ARTIFACT_TYPES }
+        num_operations: 100
+      }
+      workload_name: "READ_ALL_ARTIFACT_TYPES"
+      microseconds_per_operation: 250
+    }
+  )");
+  WorkloadConfigResult& summary = *report.mutable_summaries(0);
+  summary.mutable_latency_percentiles()->set_p99_microseconds(
+      p99_microseconds);
+  summary.set_achieved_qps(achieved_qps);
+  return report;
+}
+
+// Tests that CompareReports() flags the metrics which changed for the worse
+// beyond the tolerance only.
+TEST(ReportComparisonTest, CompareReportsTest) {
+  std::vector<MetricComparison> comparisons;
+  TF_ASSERT_OK(CompareReports(GetReport(/*p99_microseconds=*/1000,
+                                        /*achieved_qps=*/4000),
+                              GetReport(/*p99_microseconds=*/1200,
+                                        /*achieved_qps=*/3900),
+                              /*tolerance=*/0.1, comparisons));
+  // The p50 and p90 latencies are not set.
+  ASSERT_EQ(3, comparisons.size());
+  EXPECT_EQ("microseconds_per_operation", comparisons[0].metric);
+  EXPECT_FALSE(comparisons[0].regressed);
+  EXPECT_EQ("READ_ALL_ARTIFACT_TYPES", comparisons[1].workload_name);
+  EXPECT_EQ("p99_microseconds", comparisons[1].metric);
+  EXPECT_NEAR(0.2, comparisons[1].relative_change, 1e-9);
+  EXPECT_TRUE(comparisons[1].regressed);
+  EXPECT_EQ("achieved_qps", comparisons[2].metric);
+  EXPECT_FALSE(comparisons[2].regressed);
+
+  TF_ASSERT_OK(CompareReports(GetReport(/*p99_microseconds=*/1000,
+                                        /*achieved_qps=*/4000),
+                              GetReport(/*p99_microseconds=*/900,
+                                        /*achieved_qps=*/3000),
+                              /*tolerance=*/0.1, comparisons));
+  ASSERT_EQ(3, comparisons.size());
+  EXPECT_FALSE(comparisons[1].regressed);
+  EXPECT_TRUE(comparisons[2].regressed);
+}
+
+// Tests that CompareReports() rejects the reports of different workloads.
+TEST(ReportComparisonTest, DifferentWorkloadsTest) {
+  MLMDBenchReport candidate = GetReport(1000, 4000);
+  candidate.mutable_summaries(0)->mutable_workload_config()->set_num_operations(
+      200);
+  std::vector<MetricComparison> comparisons;
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            CompareReports(GetReport(1000, 4000), candidate, 0.1, comparisons)
+                .code());
+  candidate.add_summaries();
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            CompareReports(GetReport(1000, 4000), candidate, 0.1, comparisons)
+                .code());
+}
+
+// Tests that CompareReports() compares the thread sweeps at each thread count.
+TEST(ReportComparisonTest, CompareThreadSweepsTest) {
+  MLMDBenchReport baseline;
+  MLMDBenchReport candidate;
+  for (const int num_threads : {1, 8}) {
+    ThreadSweepPoint& baseline_point = *baseline.add_thread_sweep();
+    baseline_point.set_num_threads(num_threads);
+    *baseline_point.mutable_summaries() = GetReport(1000, 4000).summaries();
+    ThreadSweepPoint& candidate_point = *candidate.add_thread_sweep();
+    candidate_point.set_num_threads(num_threads);
+    *candidate_point.mutable_summaries() =
+        GetReport(num_threads == 1 ? 1000 : 2000, 4000).summaries();
+  }
+  std::vector<MetricComparison> comparisons;
+  TF_ASSERT_OK(CompareReports(baseline, candidate, 0.1, comparisons));
+  ASSERT_EQ(6, comparisons.size());
+  EXPECT_EQ("READ_ALL_ARTIFACT_TYPES@1_THREADS", comparisons[1].workload_name);
+  EXPECT_FALSE(comparisons[1].regressed);
+  EXPECT_EQ("READ_ALL_ARTIFACT_TYPES@8_THREADS", comparisons[4].workload_name);
+  EXPECT_TRUE(comparisons[4].regressed);
+
+  candidate.mutable_thread_sweep(1)->set_num_threads(4);
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            CompareReports(baseline, candidate, 0.1, comparisons).code());
+}
+
+}  // namespace
+}  // namespace ml_metadata
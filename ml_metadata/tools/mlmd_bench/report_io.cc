@@ -0,0 +1,149 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/report_io.h"
+
+#include <string>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr char kCsvHeader[] =
+    "workload_index,workload_name,num_operations,microseconds_per_operation,"
+    "bytes_per_second,target_qps,achieved_qps,p50_microseconds,"
+    "p90_microseconds,p99_microseconds,p999_microseconds,max_microseconds,"
+    "num_aborts,abort_rate,backend,schema_version,num_threads,hostname,"
+    "num_cpus,start_time";
+
+// Returns `field` quoted for CSV if it has a separator, quote or newline.
+std::string CsvField(const std::string& field) {
+  if (field.find_first_of(",\"\n") == std::string::npos) return field;
+  return absl::StrCat("\"", absl::StrReplaceAll(field, {{"\"", "\"\""}}),
+                      "\"");
+}
+
+// Appends the CSV row of `summary`, identified by `workload_index`, with
+// `environment` to `csv`.
+void AppendCsvRow(const std::string& workload_index,
+                  const WorkloadConfigResult& summary,
+                  const BenchmarkEnvironment& environment, std::string& csv) {
+  const LatencyPercentiles& latencies = summary.latency_percentiles();
+  const std::vector<std::string> fields = {
+      workload_index,
+      CsvField(summary.workload_name()),
+      absl::StrCat(summary.workload_config().num_operations()),
+      absl::StrCat(summary.microseconds_per_operation()),
+      absl::StrCat(summary.bytes_per_second()),
+      absl::StrCat(summary.target_qps()),
+      absl::StrCat(summary.achieved_qps()),
+      absl::StrCat(latencies.p50_microseconds()),
+      absl::StrCat(latencies.p90_microseconds()),
+      absl::StrCat(latencies.p99_microseconds()),
+      absl::StrCat(latencies.p999_microseconds()),
+      absl::StrCat(latencies.max_microseconds()),
+      absl::StrCat(summary.num_aborts()),
+      absl::StrCat(summary.abort_rate()),
+      CsvField(environment.backend()),
+      absl::StrCat(environment.schema_version()),
+      absl::StrCat(environment.num_threads()),
+      CsvField(environment.hostname()),
+      absl::StrCat(environment.num_cpus()),
+      CsvField(environment.start_time())};
+  absl::StrAppend(&csv, absl::StrJoin(fields, ","), "\n");
+}
+
+}  // namespace
+
+std::string ReportToCsv(const MLMDBenchReport& report) {
+  std::string csv = absl::StrCat(kCsvHeader, "\n");
+  for (int i = 0; i < report.summaries_size(); ++i) {
+    AppendCsvRow(absl::StrCat(i), report.summaries(i), report.environment(),
+                 csv);
+  }
+  if (report.has_aggregate()) {
+    AppendCsvRow("aggregate", report.aggregate(), report.environment(), csv);
+  }
+  // The rows of a thread sweep have the thread count of their point.
+  for (const ThreadSweepPoint& point : report.thread_sweep()) {
+    BenchmarkEnvironment environment = report.environment();
+    environment.set_num_threads(point.num_threads());
+    for (int i = 0; i < point.summaries_size(); ++i) {
+      AppendCsvRow(absl::StrCat(i), point.summaries(i), environment, csv);
+    }
+    if (point.has_aggregate()) {
+      AppendCsvRow("aggregate", point.aggregate(), environment, csv);
+    }
+  }
+  return csv;
+}
+
+tensorflow::Status WriteReport(const MLMDBenchReport& report,
+                               const std::string& format,
+                               const std::string& path) {
+  if (format == "pbtxt") {
+    return tensorflow::WriteTextProto(tensorflow::Env::Default(), path,
+                                      report);
+  }
+  if (format == "json") {
+    google::protobuf::util::JsonPrintOptions options;
+    options.add_whitespace = true;
+    options.preserve_proto_field_names = true;
+    std::string json;
+    const auto status =
+        google::protobuf::util::MessageToJsonString(report, &json, options);
+    if (!status.ok()) {
+      return tensorflow::errors::Internal("Cannot convert the report to JSON: ",
+                                          status.ToString());
+    }
+    return tensorflow::WriteStringToFile(tensorflow::Env::Default(), path,
+                                         json);
+  }
+  if (format == "csv") {
+    return tensorflow::WriteStringToFile(tensorflow::Env::Default(), path,
+                                         ReportToCsv(report));
+  }
+  return tensorflow::errors::InvalidArgument(
+      "Unknown report format: ", format, "; it must be pbtxt, json or csv.");
+}
+
+tensorflow::Status ReadReport(const std::string& path,
+                              MLMDBenchReport& report) {
+  if (!absl::EndsWith(path, ".json")) {
+    return tensorflow::ReadTextProto(tensorflow::Env::Default(), path,
+                                     &report);
+  }
+  std::string json;
+  TF_RETURN_IF_ERROR(
+      tensorflow::ReadFileToString(tensorflow::Env::Default(), path, &json));
+  const auto status =
+      google::protobuf::util::JsonStringToMessage(json, &report);
+  if (!status.ok()) {
+    return tensorflow::errors::InvalidArgument(
+        "Cannot parse the JSON report at ", path, ": ", status.ToString());
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,46 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_REPORT_IO_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_REPORT_IO_H
+
+#include <string>
+
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Returns `report` as CSV: a header and a row per summary, followed by a row
+// for the aggregate summary if it is set, and the rows of each point of the
+// thread sweep with its thread count. Each row repeats the environment of the
+// report, so that the rows of several runs can be loaded as one table.
+std::string ReportToCsv(const MLMDBenchReport& report);
+
+// Writes `report` into the file at `path` in `format`: `pbtxt` for a text
+// proto, `json` or `csv`. Returns InvalidArgument error if the format is
+// unknown, or detailed error if the writing failed.
+tensorflow::Status WriteReport(const MLMDBenchReport& report,
+                               const std::string& format,
+                               const std::string& path);
+
+// Reads `report` from the file at `path`, as JSON if its name ends with
+// .json, or as a text proto otherwise. Returns detailed error if the reading
+// failed.
+tensorflow::Status ReadReport(const std::string& path,
+                              MLMDBenchReport& report);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_REPORT_IO_H
@@ -0,0 +1,108 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/report_io.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::testing::StartsWith;
+
+MLMDBenchReport GetReport() {
+  return testing::ParseTextProtoOrDie<MLMDBenchReport>(R"(
+    summaries {
+      workload_config {
+        read_types_config { specification: ALL_ARTIFACT_TYPES }
+        num_operations: 100
+      }
+      workload_name: "READ_ALL_ARTIFACT_TYPES"
+      microseconds_per_operation: 250
+      achieved_qps: 4000
+      latency_percentiles { p50_microseconds: 200 p99_microseconds: 900 }
+    }
+    aggregate { microseconds_per_operation: 250 achieved_qps: 4000 }
+    environment {
+      backend: "sqlite"
+      schema_version: 9
+      num_threads: 1
+      hostname: "host,1"
+      num_cpus: 8
+      start_time: "2021-01-01T00:00:00+00:00"
+    }
+  )");
+}
+
+// Tests that ReportToCsv() writes a row per summary with the environment.
+TEST(ReportIoTest, ReportToCsvTest) {
+  const std::vector<std::string> rows =
+      absl::StrSplit(ReportToCsv(GetReport()), '\n', absl::SkipEmpty());
+  ASSERT_EQ(3, rows.size());
+  EXPECT_THAT(rows[0], StartsWith("workload_index,workload_name,"));
+  EXPECT_EQ(
+      "0,READ_ALL_ARTIFACT_TYPES,100,250,0,0,4000,200,0,900,0,0,0,0,sqlite,9,"
+      "1,\"host,1\",8,2021-01-01T00:00:00+00:00",
+      rows[1]);
+  EXPECT_THAT(rows[2], StartsWith("aggregate,,0,250,"));
+}
+
+// Tests that ReportToCsv() writes the rows of a thread sweep with their thread
+// counts.
+TEST(ReportIoTest, ThreadSweepToCsvTest) {
+  MLMDBenchReport report = GetReport();
+  report.clear_aggregate();
+  ThreadSweepPoint& point = *report.add_thread_sweep();
+  point.set_num_threads(16);
+  *point.mutable_summaries() = report.summaries();
+  report.clear_summaries();
+  const std::vector<std::string> rows =
+      absl::StrSplit(ReportToCsv(report), '\n', absl::SkipEmpty());
+  ASSERT_EQ(2, rows.size());
+  EXPECT_THAT(rows[1], StartsWith("0,READ_ALL_ARTIFACT_TYPES,100,"));
+  EXPECT_THAT(rows[1], ::testing::HasSubstr(",sqlite,9,16,"));
+}
+
+// Tests that the reports written in JSON and text formats are read back.
+TEST(ReportIoTest, WriteAndReadReportTest) {
+  const MLMDBenchReport report = GetReport();
+  for (const std::string format : {"pbtxt", "json"}) {
+    const std::string path =
+        absl::StrCat(::testing::TempDir(), "mlmd-bench-report.", format);
+    TF_ASSERT_OK(WriteReport(report, format, path));
+    MLMDBenchReport read_report;
+    TF_ASSERT_OK(ReadReport(path, read_report));
+    EXPECT_THAT(read_report, EqualsProto(report));
+  }
+}
+
+// Tests that WriteReport() rejects an unknown format.
+TEST(ReportIoTest, UnknownFormatTest) {
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+            WriteReport(GetReport(), "xml",
+                        absl::StrCat(::testing::TempDir(), "report.xml"))
+                .code());
+}
+
+}  // namespace
+}  // namespace ml_metadata
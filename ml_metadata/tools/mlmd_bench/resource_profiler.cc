@@ -0,0 +1,176 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/resource_profiler.h"
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/allocation_counter.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/util/status_utils.h"
+#include "sqlite3.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+namespace {
+
+// The InnoDB status counters, which are cumulative since the MySQL server
+// started.
+constexpr char kMySqlCountersQuery[] =
+    "SHOW GLOBAL STATUS WHERE Variable_name IN ('Innodb_rows_read', "
+    "'Innodb_rows_inserted', 'Innodb_rows_updated', 'Innodb_rows_deleted', "
+    "'Innodb_buffer_pool_read_requests', 'Innodb_buffer_pool_reads', "
+    "'Innodb_row_lock_waits', 'Innodb_row_lock_time');";
+
+// The memory status of the SQLite library of the process with its name.
+struct SqliteStatus {
+  int op;
+  const char* name;
+};
+
+constexpr SqliteStatus kSqliteStatuses[] = {
+    {SQLITE_STATUS_MEMORY_USED, "sqlite_memory_used"},
+    {SQLITE_STATUS_PAGECACHE_USED, "sqlite_pagecache_used"},
+    {SQLITE_STATUS_PAGECACHE_OVERFLOW, "sqlite_pagecache_overflow"},
+    {SQLITE_STATUS_MALLOC_COUNT, "sqlite_malloc_count"},
+};
+
+// Reads the peak values of the SQLite memory status since the previous call,
+// and resets them to the current values.
+void ReadSqlitePeaks(ResourceSnapshot& snapshot) {
+  for (const SqliteStatus& status : kSqliteStatuses) {
+    sqlite3_int64 current = 0;
+    sqlite3_int64 highwater = 0;
+    if (sqlite3_status64(status.op, &current, &highwater,
+                         /*resetFlag=*/1) == SQLITE_OK) {
+      snapshot.database_peaks[status.name] = highwater;
+    }
+  }
+}
+
+absl::Duration ToDuration(const struct timeval& time) {
+  return absl::Seconds(time.tv_sec) + absl::Microseconds(time.tv_usec);
+}
+
+}  // namespace
+
+tensorflow::Status ResourceProfiler::Create(
+    const ResourceProfilingConfig& config, const ConnectionConfig& mlmd_config,
+    const bool in_process, std::unique_ptr<ResourceProfiler>& profiler) {
+  std::unique_ptr<MySqlMetadataSource> mysql_source;
+  if (config.collect_database_stats()) {
+    if (mlmd_config.has_mysql()) {
+      mysql_source =
+          absl::make_unique<MySqlMetadataSource>(mlmd_config.mysql());
+      TF_RETURN_IF_ERROR(FromABSLStatus(mysql_source->Connect()));
+    } else if (!in_process || (!mlmd_config.has_sqlite() &&
+                               !mlmd_config.has_fake_database())) {
+      return tensorflow::errors::InvalidArgument(
+          "The database stats can only be collected for MySQL, or for SQLite "
+          "when the workloads do not use a metadata store server.");
+    }
+  }
+  if (config.collect_process_stats()) {
+    EnableAllocationCounting();
+  }
+  profiler = absl::WrapUnique(
+      new ResourceProfiler(config, std::move(mysql_source)));
+  return tensorflow::Status::OK();
+}
+
+ResourceProfiler::ResourceProfiler(
+    const ResourceProfilingConfig& config,
+    std::unique_ptr<MySqlMetadataSource> mysql_source)
+    : config_(config), mysql_source_(std::move(mysql_source)) {}
+
+tensorflow::Status ResourceProfiler::TakeSnapshot(
+    ResourceSnapshot& snapshot) {
+  snapshot = ResourceSnapshot();
+  if (config_.collect_process_stats()) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return tensorflow::errors::Internal("getrusage failed.");
+    }
+    snapshot.user_cpu_time = ToDuration(usage.ru_utime);
+    snapshot.system_cpu_time = ToDuration(usage.ru_stime);
+    // ru_maxrss is in kilobytes on Linux.
+    snapshot.max_rss_bytes = static_cast<int64>(usage.ru_maxrss) * 1024;
+    snapshot.num_allocations = GetAllocationCount();
+  }
+  if (config_.collect_database_stats()) {
+    if (mysql_source_ != nullptr) {
+      TF_RETURN_IF_ERROR(ReadMySqlCounters(snapshot));
+    } else {
+      ReadSqlitePeaks(snapshot);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ResourceProfiler::ReadMySqlCounters(
+    ResourceSnapshot& snapshot) {
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(FromABSLStatus(mysql_source_->Begin()));
+  TF_RETURN_IF_ERROR(FromABSLStatus(
+      mysql_source_->ExecuteQuery(kMySqlCountersQuery, &record_set)));
+  TF_RETURN_IF_ERROR(FromABSLStatus(mysql_source_->Commit()));
+  for (const RecordSet::Record& record : record_set.records()) {
+    int64 value;
+    if (record.values_size() != 2 ||
+        !absl::SimpleAtoi(record.values(1), &value)) {
+      return tensorflow::errors::Internal(
+          absl::StrCat("Unexpected MySQL status: ", record.DebugString()));
+    }
+    snapshot.database_counters[record.values(0)] = value;
+  }
+  return tensorflow::Status::OK();
+}
+
+void ResourceProfiler::Report(const ResourceSnapshot& before,
+                              const ResourceSnapshot& after,
+                              ResourceUsage& resource_usage) const {
+  if (config_.collect_process_stats()) {
+    resource_usage.set_user_cpu_seconds(absl::ToDoubleSeconds(
+        after.user_cpu_time - before.user_cpu_time));
+    resource_usage.set_system_cpu_seconds(absl::ToDoubleSeconds(
+        after.system_cpu_time - before.system_cpu_time));
+    resource_usage.set_peak_rss_bytes(after.max_rss_bytes);
+    resource_usage.set_num_allocations(after.num_allocations -
+                                       before.num_allocations);
+  }
+  for (const auto& counter : after.database_counters) {
+    const auto it = before.database_counters.find(counter.first);
+    (*resource_usage.mutable_database_counters())[counter.first] =
+        counter.second -
+        (it == before.database_counters.end() ? 0 : it->second);
+  }
+  for (const auto& peak : after.database_peaks) {
+    (*resource_usage.mutable_database_peaks())[peak.first] = peak.second;
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,88 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_RESOURCE_PROFILER_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_RESOURCE_PROFILER_H
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The resource usage of the process and the database at a point in time.
+struct ResourceSnapshot {
+  // The CPU time of the process since it started.
+  absl::Duration user_cpu_time;
+  absl::Duration system_cpu_time;
+  // The peak resident set size of the process since it started.
+  int64 max_rss_bytes = 0;
+  // The number of allocations counted by the allocation counter.
+  int64 num_allocations = 0;
+  // The cumulative counters of the database.
+  absl::flat_hash_map<std::string, int64> database_counters;
+  // The peak values of the gauges of the database since the previous
+  // snapshot.
+  absl::flat_hash_map<std::string, int64> database_peaks;
+};
+
+// Collects the resource usage of the process and of the database of
+// `mlmd_config` with snapshots taken around the runs of the workloads. The
+// database counters are read from the MySQL server with a connection of the
+// profiler, or from the SQLite library of the process.
+// This class is thread-unsafe.
+class ResourceProfiler {
+ public:
+  // Creates a profiler of the resources of `config`. `in_process` is whether
+  // the workloads use a MetadataStore of the process instead of a metadata
+  // store server.
+  // Returns InvalidArgument error, if the database stats are collected and
+  // the database is not MySQL, or SQLite in the process.
+  // Returns detailed error if the connection to the MySQL server failed.
+  static tensorflow::Status Create(const ResourceProfilingConfig& config,
+                                   const ConnectionConfig& mlmd_config,
+                                   bool in_process,
+                                   std::unique_ptr<ResourceProfiler>& profiler);
+
+  // Takes a snapshot of the current resource usage.
+  // Returns detailed error if the query of the database counters failed.
+  tensorflow::Status TakeSnapshot(ResourceSnapshot& snapshot);
+
+  // Reports the resources used between the `before` and `after` snapshots
+  // in `resource_usage`.
+  void Report(const ResourceSnapshot& before, const ResourceSnapshot& after,
+              ResourceUsage& resource_usage) const;
+
+ private:
+  ResourceProfiler(const ResourceProfilingConfig& config,
+                   std::unique_ptr<MySqlMetadataSource> mysql_source);
+
+  // Reads the InnoDB status counters of the MySQL server.
+  tensorflow::Status ReadMySqlCounters(ResourceSnapshot& snapshot);
+
+  const ResourceProfilingConfig config_;
+  // The connection to the MySQL server, if its counters are collected.
+  const std::unique_ptr<MySqlMetadataSource> mysql_source_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_RESOURCE_PROFILER_H
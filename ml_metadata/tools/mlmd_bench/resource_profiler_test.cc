@@ -0,0 +1,128 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/resource_profiler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns a ConnectionConfig to a SQLite database in the file `db_name`.
+ConnectionConfig GetSqliteConfig(const std::string& db_name) {
+  ConnectionConfig mlmd_config;
+  mlmd_config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), db_name));
+  return mlmd_config;
+}
+
+// Tests that the resources used by the puts of some artifacts between two
+// snapshots are reported.
+TEST(ResourceProfilerTest, ReportProcessAndSqliteStatsTest) {
+  const ConnectionConfig mlmd_config =
+      GetSqliteConfig("mlmd_bench_resource_profiler_test.db");
+  ResourceProfilingConfig config;
+  config.set_collect_process_stats(true);
+  config.set_collect_database_stats(true);
+  std::unique_ptr<ResourceProfiler> profiler;
+  TF_ASSERT_OK(ResourceProfiler::Create(config, mlmd_config,
+                                        /*in_process=*/true, profiler));
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_config, &store));
+  PutTypesRequest put_types_request;
+  put_types_request.add_artifact_types()->set_name("artifact_type");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(store->PutTypes(put_types_request, &put_types_response));
+
+  ResourceSnapshot before;
+  TF_ASSERT_OK(profiler->TakeSnapshot(before));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 100; ++i) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(
+      store->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+  ResourceSnapshot after;
+  TF_ASSERT_OK(profiler->TakeSnapshot(after));
+
+  ResourceUsage resource_usage;
+  profiler->Report(before, after, resource_usage);
+  EXPECT_GE(resource_usage.user_cpu_seconds(), 0);
+  EXPECT_GE(resource_usage.system_cpu_seconds(), 0);
+  EXPECT_GT(resource_usage.peak_rss_bytes(), 0);
+  // The request alone allocates its 100 artifacts.
+  EXPECT_GE(resource_usage.num_allocations(), 100);
+  EXPECT_TRUE(resource_usage.database_counters().empty());
+  for (const std::string name :
+       {"sqlite_memory_used", "sqlite_pagecache_used",
+        "sqlite_pagecache_overflow", "sqlite_malloc_count"}) {
+    EXPECT_TRUE(resource_usage.database_peaks().contains(name)) << name;
+  }
+}
+
+// Tests that only the process stats are reported if the database stats are
+// not collected.
+TEST(ResourceProfilerTest, ReportProcessStatsOnlyTest) {
+  ResourceProfilingConfig config;
+  config.set_collect_process_stats(true);
+  std::unique_ptr<ResourceProfiler> profiler;
+  TF_ASSERT_OK(ResourceProfiler::Create(
+      config, GetSqliteConfig("mlmd_bench_resource_profiler_process_test.db"),
+      /*in_process=*/false, profiler));
+  ResourceSnapshot before;
+  TF_ASSERT_OK(profiler->TakeSnapshot(before));
+  std::vector<std::unique_ptr<Artifact>> artifacts;
+  for (int i = 0; i < 10; ++i) {
+    artifacts.push_back(absl::make_unique<Artifact>());
+  }
+  ResourceSnapshot after;
+  TF_ASSERT_OK(profiler->TakeSnapshot(after));
+
+  ResourceUsage resource_usage;
+  profiler->Report(before, after, resource_usage);
+  EXPECT_GE(resource_usage.num_allocations(), 10);
+  EXPECT_TRUE(resource_usage.database_counters().empty());
+  EXPECT_TRUE(resource_usage.database_peaks().empty());
+}
+
+// Tests that the SQLite stats of a metadata store server cannot be
+// collected.
+TEST(ResourceProfilerTest, InvalidDatabaseTest) {
+  ResourceProfilingConfig config;
+  config.set_collect_database_stats(true);
+  std::unique_ptr<ResourceProfiler> profiler;
+  EXPECT_EQ(ResourceProfiler::Create(
+                config,
+                GetSqliteConfig("mlmd_bench_resource_profiler_invalid_test.db"),
+                /*in_process=*/false, profiler)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace ml_metadata
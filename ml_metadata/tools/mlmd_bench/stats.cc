@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/stats.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -30,26 +33,150 @@ constexpr int kReportThresholds[]{1000,   5000,   10000,  50000,
 
 // The threshold of starting console printing the thread status.
 constexpr int kStartConsolePrintThreshold = 100;
+
+// The latencies below kNumLinearBuckets microseconds have a bucket each. Above
+// it, each power of two range is split in kNumSubBuckets buckets.
+constexpr int kNumLinearBuckets = 128;
+constexpr int kNumSubBuckets = kNumLinearBuckets / 2;
+
+// Sets the `percentiles` of the latencies recorded in `latencies`.
+void SetLatencyPercentiles(const LatencyHistogram& latencies,
+                           LatencyPercentiles& percentiles) {
+  const auto to_micros = [](const absl::Duration latency) {
+    return absl::ToDoubleMicroseconds(latency);
+  };
+  percentiles.set_p50_microseconds(to_micros(latencies.Percentile(0.5)));
+  percentiles.set_p90_microseconds(to_micros(latencies.Percentile(0.9)));
+  percentiles.set_p99_microseconds(to_micros(latencies.Percentile(0.99)));
+  percentiles.set_p999_microseconds(to_micros(latencies.Percentile(0.999)));
+  percentiles.set_max_microseconds(to_micros(latencies.max()));
+}
 }  // namespace
 
+int LatencyHistogram::BucketIndex(const int64 micros) {
+  if (micros < kNumLinearBuckets) {
+    return micros;
+  }
+  // Finds the `shift` which maps `micros` to [kNumSubBuckets,
+  // kNumLinearBuckets).
+  int shift = 1;
+  while ((micros >> shift) >= kNumLinearBuckets) {
+    shift++;
+  }
+  return kNumLinearBuckets + (shift - 1) * kNumSubBuckets +
+         ((micros >> shift) - kNumSubBuckets);
+}
+
+int64 LatencyHistogram::BucketUpperBound(const int index) {
+  if (index < kNumLinearBuckets) {
+    return index;
+  }
+  const int shift = (index - kNumLinearBuckets) / kNumSubBuckets + 1;
+  const int64 sub_bucket =
+      (index - kNumLinearBuckets) % kNumSubBuckets + kNumSubBuckets;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(const absl::Duration latency) {
+  const int64 micros = std::max<int64>(0, absl::ToInt64Microseconds(latency));
+  const int index = BucketIndex(micros);
+  if (index >= bucket_counts_.size()) {
+    bucket_counts_.resize(index + 1, 0);
+  }
+  bucket_counts_[index]++;
+  count_++;
+  max_micros_ = std::max(max_micros_, micros);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  if (other.bucket_counts_.size() > bucket_counts_.size()) {
+    bucket_counts_.resize(other.bucket_counts_.size(), 0);
+  }
+  for (int i = 0; i < other.bucket_counts_.size(); ++i) {
+    bucket_counts_[i] += other.bucket_counts_[i];
+  }
+  count_ += other.count_;
+  max_micros_ = std::max(max_micros_, other.max_micros_);
+}
+
+absl::Duration LatencyHistogram::Percentile(const double quantile) const {
+  if (count_ == 0) {
+    return absl::ZeroDuration();
+  }
+  // The rank of the latency of `quantile` among the sorted latencies.
+  const int64 rank =
+      std::max<int64>(1, static_cast<int64>(std::ceil(quantile * count_)));
+  int64 num_latencies_below = 0;
+  for (int i = 0; i < bucket_counts_.size(); ++i) {
+    num_latencies_below += bucket_counts_[i];
+    if (num_latencies_below >= rank) {
+      return absl::Microseconds(std::min(BucketUpperBound(i), max_micros_));
+    }
+  }
+  return max();
+}
+
+void LatencyHistogram::ToProto(LatencyHistogramBuckets& buckets) const {
+  buckets.Clear();
+  for (const int64 bucket_count : bucket_counts_) {
+    buckets.add_bucket_counts(bucket_count);
+  }
+  buckets.set_max_microseconds(max_micros_);
+}
+
+LatencyHistogram LatencyHistogram::FromProto(
+    const LatencyHistogramBuckets& buckets) {
+  LatencyHistogram histogram;
+  histogram.bucket_counts_.assign(buckets.bucket_counts().begin(),
+                                  buckets.bucket_counts().end());
+  for (const int64 bucket_count : histogram.bucket_counts_) {
+    histogram.count_ += bucket_count;
+  }
+  histogram.max_micros_ = buckets.max_microseconds();
+  return histogram;
+}
+
 ThreadStats::ThreadStats()
     : accumulated_elapsed_time_(absl::ZeroDuration()),
       done_(0),
       bytes_(0),
+      aborts_(0),
+      retried_(0),
+      aborted_time_(absl::ZeroDuration()),
+      sample_interval_(absl::ZeroDuration()),
       next_report_(kStartConsolePrintThreshold) {}
 
 void ThreadStats::Start() { start_ = absl::Now(); }
 
-void ThreadStats::Update(const OpStats& op_stats,
-                         const int64 approx_total_done) {
+void ThreadStats::Start(const absl::Duration sample_interval) {
+  sample_interval_ = std::max(sample_interval, absl::ZeroDuration());
+  Start();
+}
+
+void ThreadStats::Update(const OpStats& op_stats, const int64 total_done) {
   bytes_ += op_stats.transferred_bytes;
   accumulated_elapsed_time_ += op_stats.elapsed_time;
+  latencies_.Record(op_stats.elapsed_time);
   done_++;
-  // Reports the current progress with `approx_total_done`.
-  if (approx_total_done < next_report_) {
+  if (op_stats.num_aborts > 0) {
+    aborts_ += op_stats.num_aborts;
+    retried_++;
+    aborted_time_ += op_stats.aborted_time;
+  }
+  if (sample_interval_ > absl::ZeroDuration()) {
+    // The operation is sampled in the interval in which it finished.
+    absl::Duration remainder;
+    IntervalSample& sample = samples_[absl::IDivDuration(
+        absl::Now() - absl::UnixEpoch(), sample_interval_, &remainder)];
+    sample.done++;
+    sample.bytes += op_stats.transferred_bytes;
+    sample.latencies.Record(op_stats.elapsed_time);
+  }
+  // Reports the current progress with `total_done`.
+  if (total_done < next_report_) {
     return;
   }
-  absl::FPrintF(stderr, "... finished %d ops%30s\r", approx_total_done, "");
+  absl::FPrintF(stderr, "... finished %d ops%30s\r", total_done, "");
   std::fflush(stderr);
   // Update next_report_ to the next threshold.
   int threshold_index = 0;
@@ -67,10 +194,76 @@ void ThreadStats::Merge(const ThreadStats& other) {
   done_ += other.done();
   bytes_ += other.bytes();
   accumulated_elapsed_time_ += other.accumulated_elapsed_time();
+  latencies_.Merge(other.latencies());
+  aborts_ += other.aborts();
+  retried_ += other.retried();
+  aborted_time_ += other.aborted_time();
   // Chooses the earliest start time and latest end time of each merged
   // thread stats.
   start_ = std::min(start_, other.start());
   finish_ = std::max(finish_, other.finish());
+  // The intervals are aligned on the Unix epoch, so that the samples of the
+  // same interval are merged.
+  if (sample_interval_ == absl::ZeroDuration()) {
+    sample_interval_ = other.sample_interval_;
+  }
+  for (const auto& index_and_sample : other.samples_) {
+    IntervalSample& sample = samples_[index_and_sample.first];
+    sample.done += index_and_sample.second.done;
+    sample.bytes += index_and_sample.second.bytes;
+    sample.latencies.Merge(index_and_sample.second.latencies);
+  }
+}
+
+void ThreadStats::ToProto(WorkloadStats& workload_stats) const {
+  workload_stats.set_start_time_unix_micros(absl::ToUnixMicros(start_));
+  workload_stats.set_finish_time_unix_micros(absl::ToUnixMicros(finish_));
+  workload_stats.set_accumulated_elapsed_time_microseconds(
+      absl::ToInt64Microseconds(accumulated_elapsed_time_));
+  workload_stats.set_done(done_);
+  workload_stats.set_bytes(bytes_);
+  latencies_.ToProto(*workload_stats.mutable_latencies());
+  workload_stats.set_aborts(aborts_);
+  workload_stats.set_retried(retried_);
+  workload_stats.set_aborted_time_microseconds(
+      absl::ToInt64Microseconds(aborted_time_));
+  workload_stats.set_sample_interval_microseconds(
+      absl::ToInt64Microseconds(sample_interval_));
+  for (const auto& index_and_sample : samples_) {
+    IntervalStats& interval_stats = *workload_stats.add_samples();
+    interval_stats.set_index(index_and_sample.first);
+    interval_stats.set_done(index_and_sample.second.done);
+    interval_stats.set_bytes(index_and_sample.second.bytes);
+    index_and_sample.second.latencies.ToProto(
+        *interval_stats.mutable_latencies());
+  }
+}
+
+ThreadStats ThreadStats::FromProto(const WorkloadStats& workload_stats) {
+  ThreadStats thread_stats;
+  thread_stats.start_ =
+      absl::FromUnixMicros(workload_stats.start_time_unix_micros());
+  thread_stats.finish_ =
+      absl::FromUnixMicros(workload_stats.finish_time_unix_micros());
+  thread_stats.accumulated_elapsed_time_ = absl::Microseconds(
+      workload_stats.accumulated_elapsed_time_microseconds());
+  thread_stats.done_ = workload_stats.done();
+  thread_stats.bytes_ = workload_stats.bytes();
+  thread_stats.latencies_ =
+      LatencyHistogram::FromProto(workload_stats.latencies());
+  thread_stats.aborts_ = workload_stats.aborts();
+  thread_stats.retried_ = workload_stats.retried();
+  thread_stats.aborted_time_ =
+      absl::Microseconds(workload_stats.aborted_time_microseconds());
+  thread_stats.sample_interval_ =
+      absl::Microseconds(workload_stats.sample_interval_microseconds());
+  for (const IntervalStats& interval_stats : workload_stats.samples()) {
+    IntervalSample& sample = thread_stats.samples_[interval_stats.index()];
+    sample.done = interval_stats.done();
+    sample.bytes = interval_stats.bytes();
+    sample.latencies = LatencyHistogram::FromProto(interval_stats.latencies());
+  }
+  return thread_stats;
 }
 
 void ThreadStats::Report(const std::string& specification,
@@ -83,6 +276,17 @@ void ThreadStats::Report(const std::string& specification,
       (accumulated_elapsed_time_ / absl::Microseconds(1)) / done_;
   workload_summary.set_microseconds_per_operation(microseconds_per_operation);
 
+  LatencyPercentiles& percentiles =
+      *workload_summary.mutable_latency_percentiles();
+  SetLatencyPercentiles(latencies_, percentiles);
+
+  // The rate is computed on actual elapsed time as the byte rate below.
+  double achieved_qps = 0;
+  if (finish_ > start_) {
+    achieved_qps = done_ / absl::ToDoubleSeconds(finish_ - start_);
+    workload_summary.set_achieved_qps(achieved_qps);
+  }
+
   std::string maybe_byte_rate;
   // Not all workloads will transfer bytes in the process.
   if (bytes_ > 0) {
@@ -95,8 +299,53 @@ void ThreadStats::Report(const std::string& specification,
     maybe_byte_rate = absl::StrFormat("%6.1f KB/s", bytes_per_second / 1024.0);
   }
 
-  absl::FPrintF(stdout, "%-12s : %11.3f micros/op; %s\n", specification.c_str(),
-                microseconds_per_operation, maybe_byte_rate.c_str());
+  // The aborted attempts are retried, so that each of them is also a retry.
+  std::string maybe_aborts;
+  if (aborts_ > 0) {
+    const double abort_rate = static_cast<double>(aborts_) / (done_ + aborts_);
+    workload_summary.set_num_aborts(aborts_);
+    workload_summary.set_num_retried_operations(retried_);
+    workload_summary.set_abort_rate(abort_rate);
+    workload_summary.set_aborted_microseconds_per_operation(
+        (aborted_time_ / absl::Microseconds(1)) / done_);
+    maybe_aborts = absl::StrFormat("; %d aborts (%.1f%%) in %d retried ops",
+                                   aborts_, abort_rate * 100, retried_);
+  }
+
+  // The rates of a sample are computed on the part of its interval during
+  // which the workload ran.
+  workload_summary.clear_samples();
+  for (const auto& index_and_sample : samples_) {
+    const absl::Time interval_start =
+        absl::UnixEpoch() + sample_interval_ * index_and_sample.first;
+    const absl::Time sample_start = std::max(interval_start, start_);
+    const absl::Time sample_finish =
+        std::min(interval_start + sample_interval_, finish_);
+    const IntervalSample& interval_sample = index_and_sample.second;
+    WorkloadSample& sample = *workload_summary.add_samples();
+    sample.set_start_offset_milliseconds(
+        absl::ToInt64Milliseconds(sample_start - start_));
+    sample.set_operations(interval_sample.done);
+    if (sample_finish > sample_start) {
+      const double seconds =
+          absl::ToDoubleSeconds(sample_finish - sample_start);
+      sample.set_achieved_qps(interval_sample.done / seconds);
+      if (interval_sample.bytes > 0) {
+        sample.set_bytes_per_second(interval_sample.bytes / seconds);
+      }
+    }
+    SetLatencyPercentiles(interval_sample.latencies,
+                          *sample.mutable_latency_percentiles());
+  }
+
+  absl::FPrintF(stdout,
+                "%-12s : %11.3f micros/op; p50 %.0f p90 %.0f p99 %.0f "
+                "p99.9 %.0f max %.0f micros; %.1f ops/s; %s%s\n",
+                specification.c_str(), microseconds_per_operation,
+                percentiles.p50_microseconds(), percentiles.p90_microseconds(),
+                percentiles.p99_microseconds(), percentiles.p999_microseconds(),
+                percentiles.max_microseconds(), achieved_qps,
+                maybe_byte_rate.c_str(), maybe_aborts.c_str());
   std::fflush(stdout);
 }
 
@@ -15,24 +15,76 @@ limitations under the License.
 #ifndef ML_METADATA_TOOLS_MLMD_BENCH_STATS_H
 #define ML_METADATA_TOOLS_MLMD_BENCH_STATS_H
 
+#include <map>
+#include <vector>
+
 #include "absl/time/time.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
 
 namespace ml_metadata {
 
-// OpStats records the statics(elapsed time, transferred bytes) of each
-// operation. It will be used to update the thread stats.
+// OpStats records the statics(elapsed time, transferred bytes, aborted
+// attempts) of each operation. It will be used to update the thread stats.
 struct OpStats {
   absl::Duration elapsed_time;
   int64 transferred_bytes;
+  // The number of attempts of the operation which were ABORTED, e.g., by a
+  // conflict with a concurrent transaction, before the one which succeeded.
+  int64 num_aborts = 0;
+  // The time spent in the aborted attempts, e.g., waiting for locks.
+  absl::Duration aborted_time;
+};
+
+// LatencyHistogram records a distribution of latencies in log-linear buckets,
+// as HDR histograms do: the latencies are kept in microseconds with a relative
+// error of at most 1/64, in a number of buckets which grows with the log of
+// the max latency. Histograms are merged by adding their buckets, so that the
+// percentiles of a workload are the ones of all of its operations.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() = default;
+
+  // Records a latency. The negative latencies are recorded as zero.
+  void Record(absl::Duration latency);
+
+  // Merges the latencies recorded by `other` into the current histogram.
+  void Merge(const LatencyHistogram& other);
+
+  // Returns the latency below which at least a fraction `quantile` in [0, 1]
+  // of the recorded latencies are, or zero if there are none.
+  absl::Duration Percentile(double quantile) const;
+
+  // Gets the number of recorded latencies.
+  int64 count() const { return count_; }
+
+  // Gets the max recorded latency, or zero if there are none.
+  absl::Duration max() const { return absl::Microseconds(max_micros_); }
+
+  // Exports the buckets of the histogram into `buckets`.
+  void ToProto(LatencyHistogramBuckets& buckets) const;
+
+  // Returns the histogram of the exported `buckets`.
+  static LatencyHistogram FromProto(const LatencyHistogramBuckets& buckets);
+
+ private:
+  // Returns the bucket of a latency of `micros` microseconds.
+  static int BucketIndex(int64 micros);
+
+  // Returns the largest latency in microseconds of the bucket `index`.
+  static int64 BucketUpperBound(int index);
+
+  // The numbers of latencies of the buckets, up to the last non-empty one.
+  std::vector<int64> bucket_counts_;
+  int64 count_ = 0;
+  int64 max_micros_ = 0;
 };
 
 // ThreadStats records the statics(start time, end time, elapsed time, total
-// operations done, transferred bytes) of each thread. It will be updated with
-// an Opstats. Every ThreadStats of a particular workload will be merged
-// together after each thread has finished execution to generate a workload
-// stats for reporting the performance of current workload.
+// operations done, transferred bytes, latencies) of each thread. It will be
+// updated with an Opstats. Every ThreadStats of a particular workload will be
+// merged together after each thread has finished execution to generate a
+// workload stats for reporting the performance of current workload.
 class ThreadStats {
  public:
   ThreadStats();
@@ -41,11 +93,15 @@ class ThreadStats {
   // Starts the current thread stats and initializes the member variables.
   void Start();
 
+  // Starts the current thread stats, which also samples the operations
+  // finished in each interval of `sample_interval` if it is positive.
+  void Start(absl::Duration sample_interval);
+
   // Updates the current thread stats with op_stats.
-  // The `approx_total_done` is used for console printing. When using the
-  // ThreadStats with multiple threads, the aggregated total number of finished
-  // tasks are passed in to determine when to print.
-  void Update(const OpStats& op_stats, int64 approx_total_done);
+  // The `total_done` is used for console printing. When using the
+  // ThreadStats with multiple threads, the total number of finished tasks of
+  // all the threads is passed in to determine when to print.
+  void Update(const OpStats& op_stats, int64 total_done);
 
   // Records the end time for each thread after the current thread has finished
   // all the operations.
@@ -55,8 +111,10 @@ class ThreadStats {
   // for report purpose.
   void Merge(const ThreadStats& other);
 
-  // Reports the metrics of interests: microsecond per operation and total bytes
-  // per seconds for the current workload.
+  // Reports the metrics of interests: microsecond per operation, the latency
+  // percentiles, operations per second, total bytes per seconds and the
+  // aborted attempts for the current workload, and the ones of each sample
+  // interval.
   void Report(const std::string& specification,
               WorkloadConfigResult& workload_summary);
 
@@ -77,6 +135,26 @@ class ThreadStats {
   // Gets the total transferred bytes of current thread stats.
   int64 bytes() const { return bytes_; }
 
+  // Gets the latencies of the operations of current thread stats.
+  const LatencyHistogram& latencies() const { return latencies_; }
+
+  // Gets the number of aborted attempts of current thread stats.
+  int64 aborts() const { return aborts_; }
+
+  // Gets the number of operations of current thread stats which were retried
+  // after at least one aborted attempt.
+  int64 retried() const { return retried_; }
+
+  // Gets the time spent in the aborted attempts of current thread stats.
+  absl::Duration aborted_time() const { return aborted_time_; }
+
+  // Exports the current thread stats into `workload_stats`, e.g., to merge
+  // the workload stats of several processes.
+  void ToProto(WorkloadStats& workload_stats) const;
+
+  // Returns the thread stats of the exported `workload_stats`.
+  static ThreadStats FromProto(const WorkloadStats& workload_stats);
+
  private:
   // Records the start time of current thread stats.
   absl::Time start_;
@@ -88,6 +166,26 @@ class ThreadStats {
   int64 done_;
   // Records the total transferred bytes of current thread stats.
   int64 bytes_;
+  // Records the latencies of the operations of current thread stats.
+  LatencyHistogram latencies_;
+  // Records the number of aborted attempts of current thread stats.
+  int64 aborts_;
+  // Records the number of operations retried after an aborted attempt.
+  int64 retried_;
+  // Records the time spent in the aborted attempts of current thread stats.
+  absl::Duration aborted_time_;
+
+  // The stats of the operations finished in a sample interval.
+  struct IntervalSample {
+    int64 done = 0;
+    int64 bytes = 0;
+    LatencyHistogram latencies;
+  };
+  // The length of the sample intervals, or zero if there are no samples.
+  absl::Duration sample_interval_;
+  // The samples of the intervals with finished operations, keyed by the index
+  // of the interval since the Unix epoch.
+  std::map<int64, IntervalSample> samples_;
   // Used for console reporting during processing.
   int64 next_report_;
 };
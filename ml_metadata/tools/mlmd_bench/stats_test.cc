@@ -107,5 +107,170 @@ TEST(ThreadStatsTest, MergeTest) {
   EXPECT_EQ(stats1.finish(), latest_end_time);
 }
 
+// Tests the percentiles of LatencyHistogram class.
+TEST(LatencyHistogramTest, PercentileTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(0.5), absl::ZeroDuration());
+  // Records the latencies 1, 2, ..., 10000 microseconds.
+  for (int64 i = 1; i <= 10000; ++i) {
+    histogram.Record(absl::Microseconds(i));
+  }
+
+  EXPECT_EQ(histogram.count(), 10000);
+  EXPECT_EQ(histogram.max(), absl::Microseconds(10000));
+  // The percentiles are accurate to 1/64 of the latency.
+  EXPECT_NEAR(absl::ToDoubleMicroseconds(histogram.Percentile(0.5)), 5000,
+              5000 / 64.0);
+  EXPECT_NEAR(absl::ToDoubleMicroseconds(histogram.Percentile(0.99)), 9900,
+              9900 / 64.0);
+  EXPECT_EQ(histogram.Percentile(1), absl::Microseconds(10000));
+  // The latencies below 128 microseconds are exact.
+  EXPECT_EQ(histogram.Percentile(0.001), absl::Microseconds(10));
+}
+
+// Tests the Merge() of LatencyHistogram class.
+TEST(LatencyHistogramTest, MergeTest) {
+  LatencyHistogram fast;
+  LatencyHistogram slow;
+  for (int i = 0; i < 99; ++i) {
+    fast.Record(absl::Microseconds(100));
+  }
+  slow.Record(absl::Seconds(1));
+
+  fast.Merge(slow);
+
+  EXPECT_EQ(fast.count(), 100);
+  EXPECT_EQ(fast.Percentile(0.99), absl::Microseconds(100));
+  EXPECT_EQ(fast.Percentile(0.999), absl::Seconds(1));
+  EXPECT_EQ(fast.max(), absl::Seconds(1));
+}
+
+// Tests the latency percentiles reported by the Report() of Stats class.
+TEST(ThreadStatsTest, ReportLatencyPercentilesTest) {
+  ThreadStats stats1;
+  ThreadStats stats2;
+  stats1.Start();
+  stats2.Start();
+  for (int64 i = 0; i < 100; ++i) {
+    OpStats curr_op_stats{absl::Microseconds(i < 99 ? 10 : 1000), 0};
+    (i % 2 == 0 ? stats1 : stats2).Update(curr_op_stats, i);
+  }
+  stats1.Stop();
+  stats2.Stop();
+  stats1.Merge(stats2);
+
+  WorkloadConfigResult workload_summary;
+  stats1.Report("test", workload_summary);
+
+  const LatencyPercentiles& percentiles =
+      workload_summary.latency_percentiles();
+  EXPECT_EQ(percentiles.p50_microseconds(), 10);
+  EXPECT_EQ(percentiles.p99_microseconds(), 10);
+  EXPECT_GT(percentiles.p999_microseconds(), 990);
+  EXPECT_EQ(percentiles.max_microseconds(), 1000);
+}
+
+// Tests that the thread stats exported by ToProto() are merged the same as
+// the original ones.
+TEST(ThreadStatsTest, ToProtoAndFromProtoTest) {
+  ThreadStats stats1;
+  ThreadStats stats2;
+  stats1.Start();
+  stats2.Start();
+  for (int64 i = 0; i < 100; ++i) {
+    OpStats curr_op_stats{absl::Microseconds(i * 100), i};
+    (i % 2 == 0 ? stats1 : stats2).Update(curr_op_stats, i);
+  }
+  stats1.Stop();
+  stats2.Stop();
+  WorkloadStats workload_stats1;
+  WorkloadStats workload_stats2;
+  stats1.ToProto(workload_stats1);
+  stats2.ToProto(workload_stats2);
+  ThreadStats imported_stats = ThreadStats::FromProto(workload_stats1);
+  imported_stats.Merge(ThreadStats::FromProto(workload_stats2));
+  stats1.Merge(stats2);
+
+  EXPECT_EQ(imported_stats.done(), stats1.done());
+  EXPECT_EQ(imported_stats.bytes(), stats1.bytes());
+  EXPECT_EQ(imported_stats.accumulated_elapsed_time(),
+            absl::Trunc(stats1.accumulated_elapsed_time(),
+                        absl::Microseconds(1)));
+  EXPECT_EQ(imported_stats.start(),
+            absl::FromUnixMicros(absl::ToUnixMicros(stats1.start())));
+  EXPECT_EQ(imported_stats.latencies().count(), stats1.latencies().count());
+  EXPECT_EQ(imported_stats.latencies().max(), stats1.latencies().max());
+  EXPECT_EQ(imported_stats.latencies().Percentile(0.9),
+            stats1.latencies().Percentile(0.9));
+}
+
+TEST(ThreadStatsTest, ReportSamplesTest) {
+  ThreadStats stats1;
+  ThreadStats stats2;
+  stats1.Start(absl::Milliseconds(20));
+  stats2.Start(absl::Milliseconds(20));
+  for (int64 i = 0; i < 10; ++i) {
+    OpStats curr_op_stats{absl::Microseconds(100), 10};
+    stats1.Update(curr_op_stats, i);
+    stats2.Update(curr_op_stats, i);
+    absl::SleepFor(absl::Milliseconds(5));
+  }
+  stats1.Stop();
+  stats2.Stop();
+  WorkloadStats workload_stats;
+  stats2.ToProto(workload_stats);
+  stats1.Merge(ThreadStats::FromProto(workload_stats));
+
+  WorkloadConfigResult workload_summary;
+  stats1.Report("samples_test", workload_summary);
+  ASSERT_GE(workload_summary.samples_size(), 2);
+  int64 total_operations = 0;
+  for (int i = 0; i < workload_summary.samples_size(); ++i) {
+    const WorkloadSample& sample = workload_summary.samples(i);
+    if (i > 0) {
+      EXPECT_GE(sample.start_offset_milliseconds(),
+                workload_summary.samples(i - 1).start_offset_milliseconds());
+    }
+    EXPECT_GT(sample.achieved_qps(), 0);
+    EXPECT_GT(sample.bytes_per_second(), 0);
+    EXPECT_EQ(sample.latency_percentiles().max_microseconds(),
+              absl::ToDoubleMicroseconds(stats1.latencies().max()));
+    total_operations += sample.operations();
+  }
+  EXPECT_EQ(total_operations, 20);
+}
+
+// Tests that the aborted attempts of the operations are merged, exported and
+// reported.
+TEST(ThreadStatsTest, ReportAbortsTest) {
+  ThreadStats stats1;
+  ThreadStats stats2;
+  stats1.Start();
+  stats2.Start();
+  for (int64 i = 0; i < 10; ++i) {
+    OpStats curr_op_stats{absl::Microseconds(100), 0};
+    if (i % 5 == 0) {
+      curr_op_stats.num_aborts = 2;
+      curr_op_stats.aborted_time = absl::Microseconds(50);
+    }
+    (i % 2 == 0 ? stats1 : stats2).Update(curr_op_stats, i);
+  }
+  stats1.Stop();
+  stats2.Stop();
+  WorkloadStats workload_stats;
+  stats2.ToProto(workload_stats);
+  stats1.Merge(ThreadStats::FromProto(workload_stats));
+  EXPECT_EQ(stats1.aborts(), 4);
+  EXPECT_EQ(stats1.retried(), 2);
+  EXPECT_EQ(stats1.aborted_time(), absl::Microseconds(100));
+
+  WorkloadConfigResult workload_summary;
+  stats1.Report("aborts_test", workload_summary);
+  EXPECT_EQ(workload_summary.num_aborts(), 4);
+  EXPECT_EQ(workload_summary.num_retried_operations(), 2);
+  EXPECT_DOUBLE_EQ(workload_summary.abort_rate(), 4.0 / 14);
+  EXPECT_DOUBLE_EQ(workload_summary.aborted_microseconds_per_operation(), 10);
+}
+
 }  // namespace
 }  // namespace ml_metadata
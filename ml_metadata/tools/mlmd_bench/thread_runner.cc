@@ -14,14 +14,25 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/thread_runner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/grpc_metadata_store_client.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/resource_profiler.h"
 #include "ml_metadata/tools/mlmd_bench/stats.h"
 #include "ml_metadata/tools/mlmd_bench/workload.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -32,127 +43,551 @@ limitations under the License.
 namespace ml_metadata {
 namespace {
 
+// Creates the MLMD client instances: MetadataStores connected with
+// `mlmd_config`, or gRPC clients on `channels` if there are any.
+class StoreFactory {
+ public:
+  StoreFactory(
+      const ConnectionConfig& mlmd_config,
+      const std::vector<std::unique_ptr<GrpcMetadataStoreChannel>>& channels)
+      : mlmd_config_(mlmd_config), channels_(channels) {}
+
+  // Creates a client instance. The gRPC clients are assigned to the channels
+  // round-robin.
+  tensorflow::Status Create(
+      std::unique_ptr<MetadataStoreServiceInterface>& store) {
+    if (!channels_.empty()) {
+      store = absl::make_unique<GrpcMetadataStoreClient>(
+          channels_[num_clients_++ % channels_.size()].get());
+      return tensorflow::Status::OK();
+    }
+    std::unique_ptr<MetadataStore> metadata_store;
+    TF_RETURN_IF_ERROR(CreateMetadataStore(mlmd_config_, &metadata_store));
+    store = std::move(metadata_store);
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  const ConnectionConfig& mlmd_config_;
+  const std::vector<std::unique_ptr<GrpcMetadataStoreChannel>>& channels_;
+  // The number of gRPC clients created so far.
+  int64 num_clients_ = 0;
+};
+
 // Prepares a list of MLMD client instance(`stores`) for each thread.
 tensorflow::Status PrepareStoresForThreads(
-    const ConnectionConfig mlmd_config, const int64 num_threads,
-    std::vector<std::unique_ptr<MetadataStore>>& stores) {
+    StoreFactory& store_factory, const int64 num_threads,
+    std::vector<std::unique_ptr<MetadataStoreServiceInterface>>& stores) {
   stores.resize(num_threads);
   // Each thread uses a different MLMD client instance to talk to
   // the same back-end.
   for (int64 i = 0; i < num_threads; ++i) {
-    std::unique_ptr<MetadataStore> store;
-    TF_RETURN_IF_ERROR(CreateMetadataStore(mlmd_config, &store));
-    stores[i] = std::move(store);
+    TF_RETURN_IF_ERROR(store_factory.Create(stores[i]));
   }
   return tensorflow::Status::OK();
 }
 
 // Sets up the current workload.
-tensorflow::Status SetUpWorkload(const ConnectionConfig mlmd_config,
+tensorflow::Status SetUpWorkload(StoreFactory& store_factory,
                                  WorkloadBase& workload) {
-  std::unique_ptr<MetadataStore> set_up_store;
-  TF_RETURN_IF_ERROR(CreateMetadataStore(mlmd_config, &set_up_store));
+  std::unique_ptr<MetadataStoreServiceInterface> set_up_store;
+  TF_RETURN_IF_ERROR(store_factory.Create(set_up_store));
   TF_RETURN_IF_ERROR(workload.SetUp(set_up_store.get()));
   return tensorflow::Status::OK();
 }
 
+// The intended start times of the operations of a thread in open loop, which
+// arrive at the thread's share of the target rate of `open_loop_config`.
+class ArrivalSchedule {
+ public:
+  ArrivalSchedule(const OpenLoopConfig& open_loop_config,
+                  const int64 num_threads, const absl::Time start_time,
+                  const unsigned int seed)
+      : arrival_process_(open_loop_config.arrival_process()),
+        mean_interval_(absl::Seconds(num_threads) /
+                       open_loop_config.target_qps()),
+        next_start_time_(start_time),
+        gen_(seed) {}
+
+  // Returns the intended start time of the next operation.
+  absl::Time Next() {
+    if (arrival_process_ == OpenLoopConfig::POISSON) {
+      // The intervals of a Poisson process are exponentially distributed.
+      next_start_time_ += mean_interval_ * exponential_dist_(gen_);
+    } else {
+      next_start_time_ += mean_interval_;
+    }
+    return next_start_time_;
+  }
+
+ private:
+  const OpenLoopConfig::ArrivalProcess arrival_process_;
+  const absl::Duration mean_interval_;
+  absl::Time next_start_time_;
+  std::minstd_rand0 gen_;
+  std::exponential_distribution<double> exponential_dist_{1.0};
+};
+
+// Returns InvalidArgument error, if `open_loop_config` cannot be scheduled.
+tensorflow::Status ValidateOpenLoopConfig(
+    const OpenLoopConfig& open_loop_config) {
+  if (!(open_loop_config.target_qps() > 0)) {
+    return tensorflow::errors::InvalidArgument(
+        "The target_qps of open_loop_config must be positive.");
+  }
+  if (open_loop_config.arrival_process() == OpenLoopConfig::UNKNOWN) {
+    return tensorflow::errors::InvalidArgument(
+        "The arrival_process of open_loop_config must be specified.");
+  }
+  return tensorflow::Status::OK();
+}
+
+// The warm-up and the bounds of the measured operations of the threads of a
+// workload.
+struct RunPhases {
+  // The first `num_warmup_operations` operations taken from the work queue are
+  // not measured, and each thread runs unmeasured operations for at least
+  // `warmup_duration`.
+  int64 num_warmup_operations = 0;
+  absl::Duration warmup_duration;
+  // If positive, the measured operations of each thread run for this long,
+  // instead of until the work items are all taken.
+  absl::Duration duration;
+};
+
+// Returns the RunPhases of the threads of `workload_config` in `phases`.
+// Returns InvalidArgument error, if a warm-up or duration is negative, or the
+// warm-up operations leave no operation to measure.
+tensorflow::Status GetRunPhases(const WorkloadConfig& workload_config,
+                                RunPhases& phases) {
+  if (workload_config.num_warmup_operations() < 0 ||
+      workload_config.warmup_duration_milliseconds() < 0 ||
+      workload_config.duration_milliseconds() < 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The warm-up and duration of a workload must be non-negative.");
+  }
+  if (workload_config.duration_milliseconds() == 0 &&
+      workload_config.num_warmup_operations() > 0 &&
+      workload_config.num_warmup_operations() >=
+          workload_config.num_operations()) {
+    return tensorflow::errors::InvalidArgument(
+        "The num_warmup_operations must be less than the num_operations.");
+  }
+  phases.num_warmup_operations = workload_config.num_warmup_operations();
+  phases.warmup_duration =
+      absl::Milliseconds(workload_config.warmup_duration_milliseconds());
+  phases.duration = absl::Milliseconds(workload_config.duration_milliseconds());
+  return tensorflow::Status::OK();
+}
+
 // Executes the current workload and updates `curr_thread_stats` with `op_stats`
-// along the way.
-tensorflow::Status ExecuteWorkload(const int64 work_items_start_index,
-                                   const int64 op_per_thread,
-                                   MetadataStore& curr_store,
+// along the way. The operations are taken one at a time from the work queue
+// shared by the threads of the workload, whose next position is
+// `next_work_item`, so that a thread slowed down by its operations takes fewer
+// of them instead of finishing last. If `schedule` is given, each operation
+// waits for its intended start time, from which its elapsed time is measured.
+// The operations of the warm-up of `phases` are not measured, and the
+// measurement restarts after them.
+tensorflow::Status ExecuteWorkload(const RunPhases& phases,
+                                   MetadataStoreServiceInterface& curr_store,
                                    WorkloadBase& workload,
-                                   int64& approx_total_done,
+                                   ArrivalSchedule* schedule,
+                                   std::atomic<int64>& next_work_item,
+                                   std::atomic<int64>& total_done,
                                    ThreadStats& curr_thread_stats) {
-  int64 work_items_index = work_items_start_index;
-  while (work_items_index < work_items_start_index + op_per_thread) {
+  const int64 num_operations = workload.num_operations();
+  if (num_operations == 0) {
+    return tensorflow::Status::OK();
+  }
+  const bool run_for_duration = phases.duration > absl::ZeroDuration();
+  bool warming_up = phases.num_warmup_operations > 0 ||
+                    phases.warmup_duration > absl::ZeroDuration();
+  const absl::Time warmup_deadline = absl::Now() + phases.warmup_duration;
+  absl::Time deadline = absl::Now() + phases.duration;
+  // The position in the work queue of the current operation, which is kept
+  // when the operation is retried.
+  absl::optional<int64> work_queue_position;
+  // The intended start time of the current operation, which is kept when the
+  // operation is retried.
+  absl::optional<absl::Time> intended_start_time;
+  // The aborted attempts of the current operation.
+  int64 num_aborts = 0;
+  absl::Duration aborted_time;
+  while (true) {
+    if (!work_queue_position) {
+      work_queue_position = next_work_item.fetch_add(1);
+      if (!run_for_duration && *work_queue_position >= num_operations) {
+        break;
+      }
+    }
+    if (warming_up && *work_queue_position >= phases.num_warmup_operations &&
+        absl::Now() >= warmup_deadline) {
+      warming_up = false;
+      curr_thread_stats.Start();
+      deadline = absl::Now() + phases.duration;
+    }
+    if (run_for_duration && !warming_up && absl::Now() >= deadline) {
+      break;
+    }
+    // The work items are cycled through when the threads run for a duration.
+    const int64 work_items_index = *work_queue_position % num_operations;
+    if (schedule != nullptr && !intended_start_time) {
+      intended_start_time = schedule->Next();
+      absl::SleepFor(*intended_start_time - absl::Now());
+    }
     // Each operation has a op_stats.
     OpStats op_stats;
+    const absl::Time attempt_start_time = absl::Now();
     tensorflow::Status status =
         workload.RunOp(work_items_index, &curr_store, op_stats);
     // If the error is not Abort error, break the current process.
     if (!status.ok() && status.code() != tensorflow::error::ABORTED) {
       TF_RETURN_IF_ERROR(status);
     }
-    // Handles abort issues for concurrent writing to the db.
+    // Handles abort issues for concurrent writing to the db by retrying the
+    // operation, and counts the aborted attempt.
     if (!status.ok()) {
+      num_aborts++;
+      aborted_time += absl::Now() - attempt_start_time;
       continue;
     }
-    work_items_index++;
-    approx_total_done++;
-    // Updates the current thread stats using the `op_stats`.
-    curr_thread_stats.Update(op_stats, approx_total_done);
+    if (intended_start_time) {
+      op_stats.elapsed_time = absl::Now() - *intended_start_time;
+      intended_start_time.reset();
+    }
+    op_stats.num_aborts = num_aborts;
+    op_stats.aborted_time = aborted_time;
+    num_aborts = 0;
+    aborted_time = absl::ZeroDuration();
+    work_queue_position.reset();
+    if (!warming_up) {
+      // Updates the current thread stats using the `op_stats`.
+      curr_thread_stats.Update(op_stats, ++total_done);
+    }
   }
   return tensorflow::Status::OK();
 }
 
+// Reports in `thread_balance` how evenly the measured operations and the run
+// times are spread among the threads of `thread_stats_list`.
+void ReportThreadBalance(const std::vector<ThreadStats>& thread_stats_list,
+                         ThreadBalance& thread_balance) {
+  int64 min_operations = thread_stats_list[0].done();
+  int64 max_operations = min_operations;
+  int64 total_operations = 0;
+  absl::Duration min_run_time = absl::InfiniteDuration();
+  absl::Duration max_run_time;
+  for (const ThreadStats& thread_stats : thread_stats_list) {
+    min_operations = std::min(min_operations, thread_stats.done());
+    max_operations = std::max(max_operations, thread_stats.done());
+    total_operations += thread_stats.done();
+    const absl::Duration run_time =
+        thread_stats.finish() - thread_stats.start();
+    min_run_time = std::min(min_run_time, run_time);
+    max_run_time = std::max(max_run_time, run_time);
+  }
+  thread_balance.set_min_operations_per_thread(min_operations);
+  thread_balance.set_max_operations_per_thread(max_operations);
+  if (total_operations > 0) {
+    thread_balance.set_operations_imbalance(
+        static_cast<double>(max_operations) * thread_stats_list.size() /
+        total_operations);
+  }
+  thread_balance.set_min_thread_seconds(absl::ToDoubleSeconds(min_run_time));
+  thread_balance.set_max_thread_seconds(absl::ToDoubleSeconds(max_run_time));
+}
+
 // Merges all the thread stats inside `thread_stats_list` into a workload stats
 // and reports the workload's performance through command line output. Also,
-// passes `workload_summary` for updating with the performance result.
-void MergeThreadStatsAndReport(const std::string workload_name,
-                               std::vector<ThreadStats>& thread_stats_list,
-                               WorkloadConfigResult& workload_summary) {
+// passes `workload_summary` for updating with the performance result, the
+// balance of the threads, and the target rate of `open_loop_config` if given.
+void MergeThreadStatsAndReport(
+    const std::string workload_name,
+    const absl::optional<OpenLoopConfig>& open_loop_config,
+    std::vector<ThreadStats>& thread_stats_list,
+    WorkloadConfigResult& workload_summary) {
   CHECK_GT(thread_stats_list.size(), 0);
+  ReportThreadBalance(thread_stats_list,
+                      *workload_summary.mutable_thread_balance());
   for (int64 i = 1; i < thread_stats_list.size(); ++i) {
     thread_stats_list[0].Merge(thread_stats_list[i]);
   }
+  if (open_loop_config) {
+    workload_summary.set_target_qps(open_loop_config->target_qps());
+  }
   // Reports the metrics of interests.
   thread_stats_list[0].Report(workload_name, workload_summary);
 }
 
+// The threads of a workload, with a store and stats each, and the work queue
+// they share.
+struct WorkloadRun {
+  WorkloadBase* workload = nullptr;
+  int64 num_threads = 0;
+  RunPhases phases;
+  // The position of the next operation to be taken from the work queue. The
+  // operations at positions past the num_operations of the workload cycle
+  // through its work items.
+  std::atomic<int64> next_work_item{0};
+  std::vector<std::unique_ptr<MetadataStoreServiceInterface>> stores;
+  std::vector<ThreadStats> thread_stats_list;
+  std::vector<tensorflow::Status> thread_status_list;
+};
+
+// Sets up `workload` of `workload_config` and prepares `num_threads` threads
+// to run it in `run`.
+tensorflow::Status PrepareWorkloadRun(StoreFactory& store_factory,
+                                      WorkloadBase* workload,
+                                      const WorkloadConfig& workload_config,
+                                      const int64 num_threads,
+                                      WorkloadRun& run) {
+  TF_RETURN_IF_ERROR(GetRunPhases(workload_config, run.phases));
+  run.workload = workload;
+  run.num_threads = num_threads;
+  run.thread_stats_list.resize(num_threads);
+  run.thread_status_list.resize(num_threads);
+  TF_RETURN_IF_ERROR(SetUpWorkload(store_factory, *workload));
+  return PrepareStoresForThreads(store_factory, num_threads, run.stores);
+}
+
+// Schedules the threads of `run` in `pool`, which share the target rate of
+// `open_loop_config` if given, and sample their operations in intervals of
+// `sample_interval` if it is positive.
+tensorflow::Status ScheduleWorkloadRun(
+    const absl::optional<OpenLoopConfig>& open_loop_config,
+    const absl::Duration sample_interval,
+    tensorflow::thread::ThreadPool& pool, std::atomic<int64>& total_done,
+    WorkloadRun& run) {
+  WorkloadBase* workload = run.workload;
+  const int64 num_threads = run.num_threads;
+  const RunPhases& phases = run.phases;
+  std::atomic<int64>& next_work_item = run.next_work_item;
+  for (int64 t = 0; t < num_threads; ++t) {
+    ThreadStats& curr_thread_stats = run.thread_stats_list[t];
+    MetadataStoreServiceInterface* curr_store = run.stores[t].get();
+    tensorflow::Status& curr_status = run.thread_status_list[t];
+    pool.Schedule([&open_loop_config, sample_interval, num_threads, &phases,
+                   workload, curr_store, t, &curr_thread_stats, &curr_status,
+                   &next_work_item, &total_done]() {
+      curr_thread_stats.Start(sample_interval);
+      absl::optional<ArrivalSchedule> schedule;
+      if (open_loop_config) {
+        schedule.emplace(*open_loop_config, num_threads,
+                         curr_thread_stats.start(),
+                         absl::ToUnixMicros(absl::Now()) + t);
+      }
+      curr_status.Update(ExecuteWorkload(
+          phases, *curr_store, *workload, schedule ? &*schedule : nullptr,
+          next_work_item, total_done, curr_thread_stats));
+      curr_thread_stats.Stop();
+    });
+    TF_RETURN_IF_ERROR(curr_status);
+  }
+  return tensorflow::Status::OK();
+}
+
+// All the workloads are set up before any of them starts, and torn down once
+// all of them finished, so that the measured operations of the workloads
+// overlap. Each workload runs with the number of threads of its config, or
+// `default_num_threads` if it is not set, on a pool shared by all of them. The
+// stats of all the threads are also merged into an aggregate summary, which
+// also holds the resource usage of all the workloads if `profiler` is not
+// null.
+// Returns InvalidArgument error, if the num_threads of a workload is not
+// positive.
+tensorflow::Status RunWorkloadsConcurrently(
+    StoreFactory& store_factory, const int64 default_num_threads,
+    const absl::optional<OpenLoopConfig>& open_loop_config,
+    const absl::Duration sample_interval, ResourceProfiler* profiler,
+    Benchmark& benchmark, std::vector<ThreadStats>& workload_stats) {
+  std::vector<WorkloadRun> runs(benchmark.num_workloads());
+  int64 total_num_threads = 0;
+  for (int i = 0; i < benchmark.num_workloads(); ++i) {
+    const WorkloadConfig& workload_config =
+        benchmark.mlmd_bench_report().summaries(i).workload_config();
+    const int64 num_threads = workload_config.has_num_threads()
+                                  ? workload_config.num_threads()
+                                  : default_num_threads;
+    if (num_threads <= 0) {
+      return tensorflow::errors::InvalidArgument(
+          "The num_threads of a workload must be positive.");
+    }
+    TF_RETURN_IF_ERROR(PrepareWorkloadRun(store_factory, benchmark.workload(i),
+                                          workload_config, num_threads,
+                                          runs[i]));
+    total_num_threads += num_threads;
+  }
+  if (runs.empty()) {
+    return tensorflow::Status::OK();
+  }
+  ResourceSnapshot before_run;
+  if (profiler != nullptr) {
+    TF_RETURN_IF_ERROR(profiler->TakeSnapshot(before_run));
+  }
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "mlmd_bench", total_num_threads);
+    std::atomic<int64> total_done{0};
+    for (WorkloadRun& run : runs) {
+      TF_RETURN_IF_ERROR(ScheduleWorkloadRun(
+          open_loop_config, sample_interval, pool, total_done, run));
+    }
+  }
+  ResourceSnapshot after_run;
+  if (profiler != nullptr) {
+    TF_RETURN_IF_ERROR(profiler->TakeSnapshot(after_run));
+  }
+  for (int i = 0; i < runs.size(); ++i) {
+    TF_RETURN_IF_ERROR(runs[i].workload->TearDown());
+    MergeThreadStatsAndReport(
+        runs[i].workload->GetName(), open_loop_config,
+        runs[i].thread_stats_list,
+        *benchmark.mlmd_bench_report().mutable_summaries(i));
+    workload_stats[i] = runs[i].thread_stats_list[0];
+  }
+  // The first thread stats of each run holds the merged stats of the run.
+  ThreadStats aggregate_stats = runs[0].thread_stats_list[0];
+  for (int i = 1; i < runs.size(); ++i) {
+    aggregate_stats.Merge(runs[i].thread_stats_list[0]);
+  }
+  aggregate_stats.Report("aggregate",
+                         *benchmark.mlmd_bench_report().mutable_aggregate());
+  if (profiler != nullptr) {
+    profiler->Report(before_run, after_run,
+                     *benchmark.mlmd_bench_report()
+                          .mutable_aggregate()
+                          ->mutable_resource_usage());
+  }
+  return tensorflow::Status::OK();
+}
+
 }  // namespace
 
 ThreadRunner::ThreadRunner(const ConnectionConfig& mlmd_config,
                            const int64 num_threads)
-    : mlmd_config_(mlmd_config), num_threads_(num_threads) {}
+    : mlmd_config_(mlmd_config),
+      num_threads_(num_threads),
+      run_workloads_concurrently_(false),
+      sample_interval_(absl::ZeroDuration()) {}
+
+ThreadRunner::ThreadRunner(const ConnectionConfig& mlmd_config,
+                           const ThreadEnvConfig& thread_env_config)
+    : mlmd_config_(mlmd_config),
+      num_threads_(thread_env_config.num_threads()),
+      open_loop_config_(
+          thread_env_config.has_open_loop_config()
+              ? absl::make_optional(thread_env_config.open_loop_config())
+              : absl::nullopt),
+      run_workloads_concurrently_(
+          thread_env_config.run_workloads_concurrently()),
+      sample_interval_(absl::Milliseconds(
+          thread_env_config.sample_interval_milliseconds())) {}
+
+ThreadRunner::ThreadRunner(const MLMDBenchConfig& mlmd_bench_config)
+    : mlmd_config_(mlmd_bench_config.mlmd_config()),
+      num_threads_(mlmd_bench_config.thread_env_config().num_threads()),
+      open_loop_config_(
+          mlmd_bench_config.thread_env_config().has_open_loop_config()
+              ? absl::make_optional(
+                    mlmd_bench_config.thread_env_config().open_loop_config())
+              : absl::nullopt),
+      run_workloads_concurrently_(
+          mlmd_bench_config.thread_env_config().run_workloads_concurrently()),
+      sample_interval_(absl::Milliseconds(
+          mlmd_bench_config.thread_env_config()
+              .sample_interval_milliseconds())),
+      grpc_client_config_(
+          mlmd_bench_config.has_grpc_client_config()
+              ? absl::make_optional(mlmd_bench_config.grpc_client_config())
+              : absl::nullopt),
+      resource_profiling_config_(
+          mlmd_bench_config.has_resource_profiling_config()
+              ? absl::make_optional(
+                    mlmd_bench_config.resource_profiling_config())
+              : absl::nullopt) {}
 
 // The thread runner will first loops over all the executable workloads in
 // benchmark and executes them one by one. Each workload will have a
 // `thread_stats_list` to record the stats of each thread when executing the
 // current workload.
+// The threads of a workload take its operations one at a time from a shared
+// work queue until all of them are taken, so that all the operations run and
+// the threads which run slower operations take fewer of them.
 // During the execution, each operation will has a `op_stats` to record current
 // operation statistic. Each `op_stats` will be used to update the
 // `thread_stats`.
 // After the each thread has finished the execution, the workload stats will be
 // generated by merging all the thread stats inside the `thread_stats_list`. The
 // performance of the workload will be reported according to the workload stats.
+// In open loop, each thread follows its own arrival schedule, so that a slow
+// operation delays the following operations of its thread, whose latencies
+// include the delay.
+// If the resources are profiled, snapshots of the resource usage are taken
+// around the thread pool of each workload, so that the resource usage of a
+// workload includes its operations and warm-up, but not its set up.
 tensorflow::Status ThreadRunner::Run(Benchmark& benchmark) {
+  std::vector<ThreadStats> workload_stats;
+  return Run(benchmark, workload_stats);
+}
+
+tensorflow::Status ThreadRunner::Run(Benchmark& benchmark,
+                                     std::vector<ThreadStats>& workload_stats) {
+  workload_stats.assign(benchmark.num_workloads(), ThreadStats());
+  if (open_loop_config_) {
+    TF_RETURN_IF_ERROR(ValidateOpenLoopConfig(*open_loop_config_));
+  }
+  std::vector<std::unique_ptr<GrpcMetadataStoreChannel>> channels;
+  if (grpc_client_config_) {
+    TF_RETURN_IF_ERROR(
+        CreateGrpcMetadataStoreChannels(*grpc_client_config_, channels));
+  }
+  StoreFactory store_factory(mlmd_config_, channels);
+  std::unique_ptr<ResourceProfiler> profiler;
+  if (resource_profiling_config_) {
+    TF_RETURN_IF_ERROR(ResourceProfiler::Create(
+        *resource_profiling_config_, mlmd_config_,
+        /*in_process=*/!grpc_client_config_, profiler));
+  }
+  if (run_workloads_concurrently_) {
+    return RunWorkloadsConcurrently(store_factory, num_threads_,
+                                    open_loop_config_, sample_interval_,
+                                    profiler.get(), benchmark, workload_stats);
+  }
   for (int i = 0; i < benchmark.num_workloads(); ++i) {
     WorkloadBase* workload = benchmark.workload(i);
-    std::vector<ThreadStats> thread_stats_list(num_threads_);
-    std::vector<tensorflow::Status> thread_status_list(num_threads_);
-    TF_RETURN_IF_ERROR(SetUpWorkload(mlmd_config_, *workload));
-    const int64 op_per_thread = workload->num_operations() / num_threads_;
-    std::vector<std::unique_ptr<MetadataStore>> stores;
-    TF_RETURN_IF_ERROR(
-        PrepareStoresForThreads(mlmd_config_, num_threads_, stores));
+    WorkloadRun run;
+    TF_RETURN_IF_ERROR(PrepareWorkloadRun(
+        store_factory, workload,
+        benchmark.mlmd_bench_report().summaries(i).workload_config(),
+        num_threads_, run));
+    ResourceSnapshot before_run;
+    if (profiler != nullptr) {
+      TF_RETURN_IF_ERROR(profiler->TakeSnapshot(before_run));
+    }
     {
       // Create a thread pool for multi-thread execution.
       tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
                                           "mlmd_bench", num_threads_);
-      // `approx_total_done` is used for reporting progress along the way.
-      int64 approx_total_done = 0;
-      for (int64 t = 0; t < num_threads_; ++t) {
-        const int64 work_items_start_index = op_per_thread * t;
-        ThreadStats& curr_thread_stats = thread_stats_list[t];
-        MetadataStore* curr_store = stores[t].get();
-        tensorflow::Status& curr_status = thread_status_list[t];
-        pool.Schedule([op_per_thread, workload, work_items_start_index,
-                       curr_store, &curr_thread_stats, &curr_status,
-                       &approx_total_done]() {
-          curr_thread_stats.Start();
-          curr_status.Update(ExecuteWorkload(
-              work_items_start_index, op_per_thread, *curr_store, *workload,
-              approx_total_done, curr_thread_stats));
-          curr_thread_stats.Stop();
-        });
-        TF_RETURN_IF_ERROR(curr_status);
-      }
+      // `total_done` is used for reporting progress along the way.
+      std::atomic<int64> total_done{0};
+      TF_RETURN_IF_ERROR(ScheduleWorkloadRun(
+          open_loop_config_, sample_interval_, pool, total_done, run));
+    }
+    ResourceSnapshot after_run;
+    if (profiler != nullptr) {
+      TF_RETURN_IF_ERROR(profiler->TakeSnapshot(after_run));
     }
     TF_RETURN_IF_ERROR(workload->TearDown());
     MergeThreadStatsAndReport(
-        workload->GetName(), thread_stats_list,
+        workload->GetName(), open_loop_config_, run.thread_stats_list,
         *benchmark.mlmd_bench_report().mutable_summaries(i));
+    if (profiler != nullptr) {
+      profiler->Report(before_run, after_run,
+                       *benchmark.mlmd_bench_report()
+                            .mutable_summaries(i)
+                            ->mutable_resource_usage());
+    }
+    workload_stats[i] = run.thread_stats_list[0];
   }
   return tensorflow::Status::OK();
 }
@@ -15,9 +15,14 @@ limitations under the License.
 #ifndef ML_METADATA_TOOLS_MLMD_BENCH_THREAD_RUNNER_H
 #define ML_METADATA_TOOLS_MLMD_BENCH_THREAD_RUNNER_H
 
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/tools/mlmd_bench/benchmark.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/stats.h"
 #include "tensorflow/core/lib/core/status.h"
 
 namespace ml_metadata {
@@ -27,17 +32,53 @@ namespace ml_metadata {
 class ThreadRunner {
  public:
   ThreadRunner(const ConnectionConfig& mlmd_config, int64 num_threads);
+
+  // Creates a thread runner with the number of threads of
+  // `thread_env_config`, which runs the workloads in open loop if its
+  // open_loop_config is set, and at the same time if its
+  // run_workloads_concurrently is set.
+  ThreadRunner(const ConnectionConfig& mlmd_config,
+               const ThreadEnvConfig& thread_env_config);
+
+  // Creates a thread runner with the mlmd_config and thread_env_config of
+  // `mlmd_bench_config`, whose workloads send their requests to a metadata
+  // store server if its grpc_client_config is set, and whose resource usage
+  // is reported if its resource_profiling_config is set.
+  explicit ThreadRunner(const MLMDBenchConfig& mlmd_bench_config);
   ~ThreadRunner() = default;
 
   // Execution unit of `mlmd_bench`.
+  // Returns InvalidArgument error, if the open_loop_config, the
+  // grpc_client_config or the resource_profiling_config is invalid, or the
+  // num_threads of a workload is not positive when the workloads run
+  // concurrently.
   // Returns detailed error if query executions failed.
   tensorflow::Status Run(Benchmark& benchmark);
 
+  // Runs the workloads of `benchmark` as Run(), and returns the merged stats
+  // of the threads of each workload in `workload_stats`, e.g., to merge them
+  // with the ones of other processes.
+  tensorflow::Status Run(Benchmark& benchmark,
+                         std::vector<ThreadStats>& workload_stats);
+
  private:
   // Connection configuration that will be used to create the MetadataStore.
   const ConnectionConfig mlmd_config_;
   // Number of threads for the thread runner.
   const int64 num_threads_;
+  // The arrival rate of the operations, if the workloads run in open loop.
+  const absl::optional<OpenLoopConfig> open_loop_config_;
+  // Whether the workloads run at the same time instead of one by one.
+  const bool run_workloads_concurrently_;
+  // The length of the intervals in which the operations are sampled, or zero
+  // if they are not sampled.
+  const absl::Duration sample_interval_;
+  // The gRPC clients of the threads, if the workloads send their requests to
+  // a metadata store server.
+  const absl::optional<GrpcClientConfig> grpc_client_config_;
+  // The resources collected around the runs of the workloads, if they are
+  // profiled.
+  const absl::optional<ResourceProfilingConfig> resource_profiling_config_;
 };
 
 }  // namespace ml_metadata
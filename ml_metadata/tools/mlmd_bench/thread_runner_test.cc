@@ -15,8 +15,12 @@ limitations under the License.
 #include "ml_metadata/tools/mlmd_bench/thread_runner.h"
 
 #include <gtest/gtest.h>
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "ml_metadata/tools/mlmd_bench/benchmark.h"
@@ -61,6 +65,9 @@ void TestThreadRunner(const int num_thread) {
   ASSERT_THAT(benchmark.mlmd_bench_report().summaries(), ::testing::SizeIs(1));
   WorkloadConfigResult summary = benchmark.mlmd_bench_report().summaries()[0];
   EXPECT_GT(summary.microseconds_per_operation(), 0);
+  EXPECT_GT(summary.latency_percentiles().p50_microseconds(), 0);
+  EXPECT_LE(summary.latency_percentiles().p50_microseconds(),
+            summary.latency_percentiles().max_microseconds());
   EXPECT_GT(summary.bytes_per_second(), 0);
 }
 
@@ -70,5 +77,348 @@ TEST(ThreadRunnerTest, RunInSingleThreadTest) { TestThreadRunner(1); }
 // Tests the Run() of ThreadRunner class in multi-thread mode.
 TEST(ThreadRunnerTest, RunInMultiThreadTest) { TestThreadRunner(10); }
 
+// Runs a FillTypes workload of `num_operations` operations in open loop with
+// `thread_env_config` on the database `db_name` and returns its summary.
+WorkloadConfigResult RunOpenLoop(const ThreadEnvConfig& thread_env_config,
+                                 const int num_operations,
+                                 const std::string& db_name) {
+  MLMDBenchConfig mlmd_bench_config;
+  *mlmd_bench_config.mutable_thread_env_config() = thread_env_config;
+  WorkloadConfig* workload_config = mlmd_bench_config.add_workload_configs();
+  workload_config->CopyFrom(testing::ParseTextProtoOrDie<WorkloadConfig>(R"(
+    fill_types_config: {
+      update: false
+      specification: ARTIFACT_TYPE
+      num_properties: { minimum: 1 maximum: 10 }
+    }
+  )"));
+  workload_config->set_num_operations(num_operations);
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), db_name));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  TF_EXPECT_OK(runner.Run(benchmark));
+  return benchmark.mlmd_bench_report().summaries(0);
+}
+
+// Tests the Run() of ThreadRunner class in open loop, whose achieved rate is
+// bounded by the target rate.
+TEST(ThreadRunnerTest, RunInOpenLoopTest) {
+  for (const auto arrival_process :
+       {OpenLoopConfig::CONSTANT, OpenLoopConfig::POISSON}) {
+    ThreadEnvConfig thread_env_config;
+    thread_env_config.set_num_threads(2);
+    thread_env_config.mutable_open_loop_config()->set_target_qps(200);
+    thread_env_config.mutable_open_loop_config()->set_arrival_process(
+        arrival_process);
+    const WorkloadConfigResult summary =
+        RunOpenLoop(thread_env_config, /*num_operations=*/20,
+                    absl::StrCat("mlmd-bench-open-loop-test_",
+                                 OpenLoopConfig::ArrivalProcess_Name(
+                                     arrival_process),
+                                 ".db"));
+    EXPECT_EQ(summary.target_qps(), 200);
+    EXPECT_GT(summary.achieved_qps(), 0);
+    if (arrival_process == OpenLoopConfig::CONSTANT) {
+      // The last of the 10 operations of a thread starts after 10 intervals of
+      // 10 milliseconds.
+      EXPECT_LE(summary.achieved_qps(), 200);
+    }
+    EXPECT_GT(summary.latency_percentiles().max_microseconds(), 0);
+  }
+}
+
+// Tests that the Run() of ThreadRunner class rejects an invalid open loop.
+TEST(ThreadRunnerTest, RunInOpenLoopWithInvalidConfigTest) {
+  ThreadEnvConfig thread_env_config;
+  thread_env_config.set_num_threads(1);
+  thread_env_config.mutable_open_loop_config()->set_arrival_process(
+      OpenLoopConfig::CONSTANT);
+  MLMDBenchConfig mlmd_bench_config;
+  mlmd_bench_config.mutable_mlmd_config()->mutable_fake_database();
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(), thread_env_config);
+  EXPECT_EQ(runner.Run(benchmark).code(), tensorflow::error::INVALID_ARGUMENT);
+}
+
+// Tests the Run() of ThreadRunner class with the workloads running
+// concurrently, each with threads of its own.
+TEST(ThreadRunnerTest, RunWorkloadsConcurrentlyTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 50
+          num_threads: 1
+        }
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: EXECUTION_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 80
+        }
+        thread_env_config: { num_threads: 4 run_workloads_concurrently: true }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-concurrent-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  TF_ASSERT_OK(runner.Run(benchmark));
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetArtifactTypesResponse get_artifact_types_response;
+  TF_ASSERT_OK(
+      store->GetArtifactTypes(/*request=*/{}, &get_artifact_types_response));
+  EXPECT_EQ(get_artifact_types_response.artifact_types_size(), 50);
+  GetExecutionTypesResponse get_execution_types_response;
+  TF_ASSERT_OK(
+      store->GetExecutionTypes(/*request=*/{}, &get_execution_types_response));
+  EXPECT_EQ(get_execution_types_response.execution_types_size(), 80);
+
+  // Checks for a report of each workload and of all of them.
+  const MLMDBenchReport& report = benchmark.mlmd_bench_report();
+  ASSERT_THAT(report.summaries(), ::testing::SizeIs(2));
+  for (const WorkloadConfigResult& summary : report.summaries()) {
+    EXPECT_GT(summary.microseconds_per_operation(), 0);
+  }
+  EXPECT_FALSE(report.aggregate().has_workload_config());
+  EXPECT_GT(report.aggregate().microseconds_per_operation(), 0);
+  EXPECT_GE(report.aggregate().latency_percentiles().max_microseconds(),
+            report.summaries(0).latency_percentiles().max_microseconds());
+}
+
+// Tests the Run() of ThreadRunner class with a workload whose threads write
+// the same hot contexts. Checks the aborted attempts are retried until every
+// operation is done, and are reported.
+TEST(ThreadRunnerTest, RunContendedWorkloadTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          contend_hot_nodes_config: {
+            specification: INSERT_ATTRIBUTIONS
+            num_hot_nodes: 2
+            hot_node_popularity: { skew: 1.0 }
+            num_nodes_per_request: { minimum: 1 maximum: 1 }
+          }
+          num_operations: 100
+        }
+        thread_env_config: { num_threads: 10 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-contended-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  TF_ASSERT_OK(runner.Run(benchmark));
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(store->GetContexts(/*request=*/{}, &get_contexts_response));
+  int64 num_attributions = 0;
+  for (const Context& context : get_contexts_response.contexts()) {
+    GetArtifactsByContextRequest request;
+    request.set_context_id(context.id());
+    GetArtifactsByContextResponse response;
+    TF_ASSERT_OK(store->GetArtifactsByContext(request, &response));
+    num_attributions += response.artifacts_size();
+  }
+  EXPECT_EQ(num_attributions, 100);
+
+  const WorkloadConfigResult& summary =
+      benchmark.mlmd_bench_report().summaries(0);
+  EXPECT_GE(summary.num_aborts(), summary.num_retried_operations());
+  EXPECT_GE(summary.abort_rate(), 0);
+  EXPECT_LT(summary.abort_rate(), 1);
+}
+
+// Tests the Run() of ThreadRunner class with a warm-up, whose operations are
+// run but not measured.
+TEST(ThreadRunnerTest, RunWithWarmupTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 100
+          num_warmup_operations: 40
+        }
+        thread_env_config: { num_threads: 2 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-warmup-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  std::vector<ThreadStats> workload_stats;
+  TF_ASSERT_OK(runner.Run(benchmark, workload_stats));
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetArtifactTypesResponse get_response;
+  TF_ASSERT_OK(store->GetArtifactTypes(/*request=*/{}, &get_response));
+  EXPECT_EQ(get_response.artifact_types_size(), 100);
+  ASSERT_THAT(workload_stats, ::testing::SizeIs(1));
+  EXPECT_EQ(workload_stats[0].done(), 60);
+}
+
+// Tests the Run() of ThreadRunner class with operations which do not split
+// evenly among the threads, which take them from a shared work queue.
+TEST(ThreadRunnerTest, RunUnevenlySplitOperationsTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: EXECUTION_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 23
+        }
+        thread_env_config: { num_threads: 4 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-uneven-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  std::vector<ThreadStats> workload_stats;
+  TF_ASSERT_OK(runner.Run(benchmark, workload_stats));
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetExecutionTypesResponse get_response;
+  TF_ASSERT_OK(store->GetExecutionTypes(/*request=*/{}, &get_response));
+  EXPECT_EQ(get_response.execution_types_size(), 23);
+  ASSERT_THAT(workload_stats, ::testing::SizeIs(1));
+  EXPECT_EQ(workload_stats[0].done(), 23);
+
+  const ThreadBalance& thread_balance =
+      benchmark.mlmd_bench_report().summaries(0).thread_balance();
+  EXPECT_LE(thread_balance.min_operations_per_thread(),
+            thread_balance.max_operations_per_thread());
+  EXPECT_GE(thread_balance.max_operations_per_thread(), 6);
+  EXPECT_GE(thread_balance.operations_imbalance(), 1);
+  EXPECT_LE(thread_balance.min_thread_seconds(),
+            thread_balance.max_thread_seconds());
+}
+
+// Tests the Run() of ThreadRunner class for a duration, whose threads cycle
+// through their work items until the duration elapsed.
+TEST(ThreadRunnerTest, RunForDurationTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          contend_hot_nodes_config: {
+            specification: UPDATE_ARTIFACTS
+            num_hot_nodes: 5
+            hot_node_popularity: { skew: 0 }
+            num_nodes_per_request: { minimum: 1 maximum: 1 }
+          }
+          num_operations: 10
+          warmup_duration_milliseconds: 100
+          duration_milliseconds: 500
+        }
+        thread_env_config: { num_threads: 2 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-duration-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  std::vector<ThreadStats> workload_stats;
+  TF_ASSERT_OK(runner.Run(benchmark, workload_stats));
+
+  ASSERT_THAT(workload_stats, ::testing::SizeIs(1));
+  EXPECT_GT(workload_stats[0].done(), 0);
+  EXPECT_GE(workload_stats[0].finish() - workload_stats[0].start(),
+            absl::Milliseconds(500));
+}
+
+// Tests the Run() of ThreadRunner class with more warm-up operations than
+// operations.
+TEST(ThreadRunnerTest, RunWithInvalidWarmupTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 10
+          num_warmup_operations: 10
+        }
+        thread_env_config: { num_threads: 1 }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_fake_database();
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config.mlmd_config(),
+                      mlmd_bench_config.thread_env_config());
+  EXPECT_EQ(runner.Run(benchmark).code(), tensorflow::error::INVALID_ARGUMENT);
+}
+
+// Tests the Run() of ThreadRunner class with the workloads sending their
+// requests to a metadata store server.
+TEST(ThreadRunnerTest, RunWithGrpcClientTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: CONTEXT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 40
+        }
+        thread_env_config: { num_threads: 4 }
+        grpc_client_config: {
+          client_config: { host: "localhost" }
+          num_channels: 2
+          max_in_flight_requests_per_channel: 1
+        }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-grpc-test.db"));
+  MetadataStoreServiceImpl service_impl(mlmd_bench_config.mlmd_config());
+  ::grpc::ServerBuilder builder;
+  int port = 0;
+  builder.AddListeningPort("localhost:0", ::grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(&service_impl);
+  std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+  mlmd_bench_config.mutable_grpc_client_config()
+      ->mutable_client_config()
+      ->set_port(port);
+
+  Benchmark benchmark(mlmd_bench_config);
+  ThreadRunner runner(mlmd_bench_config);
+  TF_ASSERT_OK(runner.Run(benchmark));
+  server->Shutdown();
+
+  std::unique_ptr<MetadataStore> store;
+  TF_ASSERT_OK(CreateMetadataStore(mlmd_bench_config.mlmd_config(), &store));
+  GetContextTypesResponse get_response;
+  TF_ASSERT_OK(store->GetContextTypes(/*request=*/{}, &get_response));
+  EXPECT_EQ(get_response.context_types_size(), 40);
+  EXPECT_GT(benchmark.mlmd_bench_report()
+                .summaries(0)
+                .latency_percentiles()
+                .max_microseconds(),
+            0);
+}
+
 }  // namespace
 }  // namespace ml_metadata
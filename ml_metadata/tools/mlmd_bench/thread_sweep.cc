@@ -0,0 +1,130 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/thread_sweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "ml_metadata/tools/mlmd_bench/thread_runner.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+// Logs the achieved_qps and p99 latency of each workload of `mlmd_bench_report`
+// at each thread count of its thread_sweep. The scaling efficiency is the
+// throughput relative to the one at the first thread count scaled linearly
+// with the number of threads, so that its drop shows the knee of the curve.
+void LogThreadSweep(const MLMDBenchReport& mlmd_bench_report) {
+  if (mlmd_bench_report.thread_sweep_size() == 0) return;
+  const ThreadSweepPoint& first_point = mlmd_bench_report.thread_sweep(0);
+  for (int i = 0; i < first_point.summaries_size(); ++i) {
+    LOG(INFO) << "Thread sweep of " << first_point.summaries(i).workload_name()
+              << ":";
+    const double first_qps_per_thread =
+        first_point.summaries(i).achieved_qps() / first_point.num_threads();
+    for (const ThreadSweepPoint& point : mlmd_bench_report.thread_sweep()) {
+      const WorkloadConfigResult& summary = point.summaries(i);
+      const double efficiency =
+          first_qps_per_thread > 0
+              ? summary.achieved_qps() /
+                    (first_qps_per_thread * point.num_threads())
+              : 0;
+      LOG(INFO) << absl::StrFormat(
+          "%5d threads: %10.1f ops/s, p99 %10.0f us, efficiency %5.1f%%",
+          point.num_threads(), summary.achieved_qps(),
+          summary.latency_percentiles().p99_microseconds(), efficiency * 100);
+    }
+  }
+}
+
+}  // namespace
+
+tensorflow::Status GetSweepNumThreads(
+    const ThreadSweepConfig& thread_sweep_config,
+    std::vector<int>& num_threads) {
+  num_threads.clear();
+  if (thread_sweep_config.num_threads_size() > 0) {
+    for (const int n : thread_sweep_config.num_threads()) {
+      if (n <= 0) {
+        return tensorflow::errors::InvalidArgument(
+            "The num_threads of the thread_sweep_config must be positive.");
+      }
+      num_threads.push_back(n);
+    }
+    std::sort(num_threads.begin(), num_threads.end());
+    num_threads.erase(std::unique(num_threads.begin(), num_threads.end()),
+                      num_threads.end());
+    return tensorflow::Status::OK();
+  }
+  const int min_num_threads = thread_sweep_config.min_num_threads();
+  const int max_num_threads = thread_sweep_config.max_num_threads();
+  if (min_num_threads <= 0 || max_num_threads < min_num_threads) {
+    return tensorflow::errors::InvalidArgument(
+        "The thread_sweep_config must have num_threads, or 0 < "
+        "min_num_threads <= max_num_threads.");
+  }
+  if (thread_sweep_config.growth_factor() <= 1) {
+    return tensorflow::errors::InvalidArgument(
+        "The growth_factor of the thread_sweep_config must be above 1.");
+  }
+  for (double n = min_num_threads; n < max_num_threads;
+       n = std::ceil(n * thread_sweep_config.growth_factor())) {
+    num_threads.push_back(static_cast<int>(n));
+  }
+  num_threads.push_back(max_num_threads);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status RunThreadSweep(const MLMDBenchConfig& mlmd_bench_config,
+                                  MLMDBenchReport& mlmd_bench_report) {
+  if (mlmd_bench_config.has_distributed_config()) {
+    return tensorflow::errors::InvalidArgument(
+        "The thread_sweep_config is not supported in distributed mode.");
+  }
+  std::vector<int> sweep_num_threads;
+  TF_RETURN_IF_ERROR(GetSweepNumThreads(
+      mlmd_bench_config.thread_env_config().thread_sweep_config(),
+      sweep_num_threads));
+  mlmd_bench_report.clear_summaries();
+  mlmd_bench_report.clear_aggregate();
+  mlmd_bench_report.mutable_environment()->clear_num_threads();
+  for (const int num_threads : sweep_num_threads) {
+    LOG(INFO) << "Running the workloads with " << num_threads << " threads";
+    MLMDBenchConfig point_config = mlmd_bench_config;
+    point_config.mutable_thread_env_config()->set_num_threads(num_threads);
+    // The workloads prepare their work items in their setup, so that each
+    // thread count needs new ones.
+    Benchmark benchmark(point_config);
+    ThreadRunner runner(point_config);
+    TF_RETURN_IF_ERROR(runner.Run(benchmark));
+    ThreadSweepPoint& point = *mlmd_bench_report.add_thread_sweep();
+    point.set_num_threads(num_threads);
+    *point.mutable_summaries() = benchmark.mlmd_bench_report().summaries();
+    if (benchmark.mlmd_bench_report().has_aggregate()) {
+      *point.mutable_aggregate() = benchmark.mlmd_bench_report().aggregate();
+    }
+  }
+  LogThreadSweep(mlmd_bench_report);
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,48 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_BENCH_THREAD_SWEEP_H
+#define ML_METADATA_TOOLS_MLMD_BENCH_THREAD_SWEEP_H
+
+#include <vector>
+
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Sets `num_threads` to the thread counts of `thread_sweep_config` in
+// increasing order, without duplicates.
+// Returns InvalidArgument error, if a thread count is not positive, or the
+// range has no thread counts or a growth_factor which is not above 1.
+tensorflow::Status GetSweepNumThreads(
+    const ThreadSweepConfig& thread_sweep_config,
+    std::vector<int>& num_threads);
+
+// Runs the workloads of `mlmd_bench_config` at each thread count of the
+// thread_sweep_config of its thread_env_config, each time with a new
+// Benchmark, and adds the summaries at each thread count to the thread_sweep
+// of `mlmd_bench_report`, while its summaries and aggregate are cleared. The
+// database is not reset between the thread counts, e.g., the nodes inserted
+// at a thread count are read at the next ones. Logs the throughput, the p99
+// latency and the scaling efficiency of each workload vs the thread count.
+// Returns InvalidArgument error, if the thread_sweep_config is invalid or the
+// benchmark is distributed.
+// Returns detailed error if query executions failed.
+tensorflow::Status RunThreadSweep(const MLMDBenchConfig& mlmd_bench_config,
+                                  MLMDBenchReport& mlmd_bench_report);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_BENCH_THREAD_SWEEP_H
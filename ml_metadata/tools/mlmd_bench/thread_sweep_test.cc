@@ -0,0 +1,110 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_bench/thread_sweep.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/tools/mlmd_bench/benchmark.h"
+#include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Tests that GetSweepNumThreads() sorts the listed thread counts and drops the
+// duplicates.
+TEST(ThreadSweepTest, GetListedNumThreadsTest) {
+  std::vector<int> num_threads;
+  TF_ASSERT_OK(GetSweepNumThreads(
+      testing::ParseTextProtoOrDie<ThreadSweepConfig>(
+          "num_threads: [ 8, 1, 4, 4 ]"),
+      num_threads));
+  EXPECT_THAT(num_threads, ElementsAre(1, 4, 8));
+}
+
+// Tests that GetSweepNumThreads() grows the thread counts of a range
+// geometrically up to its maximum.
+TEST(ThreadSweepTest, GetRangeNumThreadsTest) {
+  std::vector<int> num_threads;
+  TF_ASSERT_OK(GetSweepNumThreads(
+      testing::ParseTextProtoOrDie<ThreadSweepConfig>(
+          "min_num_threads: 1 max_num_threads: 20"),
+      num_threads));
+  EXPECT_THAT(num_threads, ElementsAre(1, 2, 4, 8, 16, 20));
+  TF_ASSERT_OK(GetSweepNumThreads(
+      testing::ParseTextProtoOrDie<ThreadSweepConfig>(
+          "min_num_threads: 2 max_num_threads: 6 growth_factor: 1.2"),
+      num_threads));
+  EXPECT_THAT(num_threads, ElementsAre(2, 3, 4, 5, 6));
+}
+
+// Tests that GetSweepNumThreads() rejects invalid thread counts.
+TEST(ThreadSweepTest, InvalidConfigTest) {
+  std::vector<int> num_threads;
+  for (const char* config :
+       {"num_threads: [ 2, 0 ]", "max_num_threads: 0",
+        "min_num_threads: 4 max_num_threads: 2",
+        "max_num_threads: 8 growth_factor: 1"}) {
+    EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT,
+              GetSweepNumThreads(
+                  testing::ParseTextProtoOrDie<ThreadSweepConfig>(config),
+                  num_threads)
+                  .code())
+        << config;
+  }
+}
+
+// Tests that RunThreadSweep() reports the summaries of the workloads at each
+// thread count.
+TEST(ThreadSweepTest, RunThreadSweepTest) {
+  MLMDBenchConfig mlmd_bench_config =
+      testing::ParseTextProtoOrDie<MLMDBenchConfig>(R"(
+        workload_configs: {
+          fill_types_config: {
+            update: false
+            specification: ARTIFACT_TYPE
+            num_properties: { minimum: 1 maximum: 10 }
+          }
+          num_operations: 20
+        }
+        thread_env_config: {
+          thread_sweep_config: { num_threads: [ 1, 2 ] }
+        }
+      )");
+  mlmd_bench_config.mutable_mlmd_config()->mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd-bench-thread-sweep-test.db"));
+  Benchmark benchmark(mlmd_bench_config);
+  MLMDBenchReport& report = benchmark.mlmd_bench_report();
+  TF_ASSERT_OK(RunThreadSweep(mlmd_bench_config, report));
+
+  EXPECT_EQ(0, report.summaries_size());
+  ASSERT_EQ(2, report.thread_sweep_size());
+  for (int i = 0; i < report.thread_sweep_size(); ++i) {
+    const ThreadSweepPoint& point = report.thread_sweep(i);
+    EXPECT_EQ(i + 1, point.num_threads());
+    ASSERT_EQ(1, point.summaries_size());
+    EXPECT_EQ("FILL_ARTIFACT_TYPE", point.summaries(0).workload_name());
+    EXPECT_GT(point.summaries(0).achieved_qps(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/util.h"
 
+#include <algorithm>
+#include <cmath>
+#include <random>
 #include <vector>
 
 #include "absl/time/clock.h"
 #include "absl/types/variant.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
@@ -50,7 +53,7 @@ void PrepareNode(const std::string& node_name, const T& node_type, NT& node) {
 // Detailed implementation of multiple GetExistingTypes() overload function.
 // Returns detailed error if query executions failed.
 tensorflow::Status GetExistingTypesImpl(const FetchType& fetch_type,
-                                        MetadataStore& store,
+                                        MetadataStoreServiceInterface& store,
                                         std::vector<Type>& existing_types) {
   switch (fetch_type) {
     case FetchArtifactType: {
@@ -89,7 +92,7 @@ tensorflow::Status GetExistingTypesImpl(const FetchType& fetch_type,
 // Detailed implementation of multiple GetExistingNodes() overload functions.
 // Returns detailed error if query executions failed.
 tensorflow::Status GetExistingNodesImpl(const FetchNode& fetch_node,
-                                        MetadataStore& store,
+                                        MetadataStoreServiceInterface& store,
                                         std::vector<Node>& existing_nodes) {
   switch (fetch_node) {
     case FetchArtifact: {
@@ -124,8 +127,84 @@ tensorflow::Status GetExistingNodesImpl(const FetchNode& fetch_node,
 
 }  // namespace
 
+std::discrete_distribution<int64> GenerateZipfDistributionWithConfigurableSkew(
+    const int64 sample_size, const ZipfDistribution& dist,
+    std::minstd_rand0& gen) {
+  std::vector<double> weights(sample_size);
+  for (int64 i = 0; i < sample_size; ++i) {
+    const int64 rank = i + 1;
+    // Here, we discard the normalize factor since the `discrete_distribution`
+    // will perform the normalization for us.
+    weights[i] = 1 / pow(rank, dist.skew());
+  }
+  // Random shuffles the weight vector.
+  std::shuffle(std::begin(weights), std::end(weights), gen);
+  // Uses these random number generated w.r.t. a zipf distribution with a
+  // configurable `skew` to represent the possibility of being chosen for each
+  // integer within [0, sample_size) in a discrete distribution.
+  return std::discrete_distribution<int64>{weights.begin(), weights.end()};
+}
+
+tensorflow::Status ValidateNodePopularity(const NodePopularity& popularity) {
+  switch (popularity.distribution_case()) {
+    case NodePopularity::kZipf:
+      if (popularity.zipf().skew() < 0) {
+        return tensorflow::errors::InvalidArgument(
+            "The skew of the node popularity must be non-negative.");
+      }
+      break;
+    case NodePopularity::kHotSet: {
+      const HotSetDistribution& hot_set = popularity.hot_set();
+      if (!(hot_set.hot_node_fraction() > 0 &&
+            hot_set.hot_node_fraction() <= 1) ||
+          !(hot_set.hot_operation_fraction() >= 0 &&
+            hot_set.hot_operation_fraction() <= 1)) {
+        return tensorflow::errors::InvalidArgument(
+            "The hot_node_fraction must be within (0, 1] and the "
+            "hot_operation_fraction within [0, 1].");
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return tensorflow::Status::OK();
+}
+
+std::discrete_distribution<int64> GenerateNodePopularityDistribution(
+    const int64 sample_size, const NodePopularity& popularity,
+    std::minstd_rand0& gen) {
+  switch (popularity.distribution_case()) {
+    case NodePopularity::kZipf:
+      return GenerateZipfDistributionWithConfigurableSkew(
+          sample_size, popularity.zipf(), gen);
+    case NodePopularity::kHotSet: {
+      const HotSetDistribution& hot_set = popularity.hot_set();
+      // The hot set has at least one node, so that its picks have a target.
+      // If all the nodes are hot, they are picked uniformly.
+      const int64 num_hot_nodes = std::max<int64>(
+          1, std::llround(hot_set.hot_node_fraction() * sample_size));
+      if (num_hot_nodes >= sample_size) break;
+      std::vector<double> weights(sample_size);
+      for (int64 i = 0; i < sample_size; ++i) {
+        weights[i] =
+            i < num_hot_nodes
+                ? hot_set.hot_operation_fraction() / num_hot_nodes
+                : (1 - hot_set.hot_operation_fraction()) /
+                      (sample_size - num_hot_nodes);
+      }
+      std::shuffle(std::begin(weights), std::end(weights), gen);
+      return std::discrete_distribution<int64>{weights.begin(), weights.end()};
+    }
+    default:
+      break;
+  }
+  const std::vector<double> weights(sample_size, 1.0);
+  return std::discrete_distribution<int64>{weights.begin(), weights.end()};
+}
+
 tensorflow::Status GetExistingTypes(const FillTypesConfig& fill_types_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types) {
   FetchType fetch_type;
   switch (fill_types_config.specification()) {
@@ -148,7 +227,7 @@ tensorflow::Status GetExistingTypes(const FillTypesConfig& fill_types_config,
 }
 
 tensorflow::Status GetExistingTypes(const FillNodesConfig& fill_nodes_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types) {
   FetchType fetch_type;
   switch (fill_nodes_config.specification()) {
@@ -171,7 +250,7 @@ tensorflow::Status GetExistingTypes(const FillNodesConfig& fill_nodes_config,
 }
 
 tensorflow::Status GetExistingTypes(const ReadTypesConfig& read_types_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types) {
   FetchType fetch_type;
   switch (read_types_config.specification()) {
@@ -197,7 +276,7 @@ tensorflow::Status GetExistingTypes(const ReadTypesConfig& read_types_config,
 }
 
 tensorflow::Status GetExistingNodes(const FillNodesConfig& fill_nodes_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Node>& existing_nodes) {
   switch (fill_nodes_config.specification()) {
     case FillNodesConfig::ARTIFACT: {
@@ -217,7 +296,8 @@ tensorflow::Status GetExistingNodes(const FillNodesConfig& fill_nodes_config,
 
 tensorflow::Status GetExistingNodes(
     const FillContextEdgesConfig& fill_context_edges_config,
-    MetadataStore& store, std::vector<Node>& existing_non_context_nodes,
+    MetadataStoreServiceInterface& store,
+    std::vector<Node>& existing_non_context_nodes,
     std::vector<Node>& existing_context_nodes) {
   switch (fill_context_edges_config.specification()) {
     case FillContextEdgesConfig::ATTRIBUTION: {
@@ -237,7 +317,8 @@ tensorflow::Status GetExistingNodes(
 }
 
 tensorflow::Status GetExistingNodes(
-    const FillEventsConfig& fill_events_config, MetadataStore& store,
+    const FillEventsConfig& fill_events_config,
+    MetadataStoreServiceInterface& store,
     std::vector<Node>& existing_artifact_nodes,
     std::vector<Node>& existing_execution_nodes) {
   TF_RETURN_IF_ERROR(
@@ -249,12 +330,13 @@ tensorflow::Status GetExistingNodes(
 
 tensorflow::Status GetExistingNodes(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes) {
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes) {
   switch (read_nodes_by_properties_config.specification()) {
     case ReadNodesByPropertiesConfig::ARTIFACTS_BY_ID:
     case ReadNodesByPropertiesConfig::ARTIFACTS_BY_TYPE:
     case ReadNodesByPropertiesConfig::ARTIFACT_BY_TYPE_AND_NAME:
     case ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI:
+    case ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI_PREFIX:
       return GetExistingNodesImpl(FetchArtifact, store, existing_nodes);
     case ReadNodesByPropertiesConfig::EXECUTIONS_BY_ID:
     case ReadNodesByPropertiesConfig::EXECUTIONS_BY_TYPE:
@@ -272,7 +354,7 @@ tensorflow::Status GetExistingNodes(
 
 tensorflow::Status GetExistingNodes(
     const ReadNodesViaContextEdgesConfig& read_nodes_via_context_edges_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes) {
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes) {
   switch (read_nodes_via_context_edges_config.specification()) {
     case ReadNodesViaContextEdgesConfig::ARTIFACTS_BY_CONTEXT:
     case ReadNodesViaContextEdgesConfig::EXECUTIONS_BY_CONTEXT:
@@ -288,7 +370,7 @@ tensorflow::Status GetExistingNodes(
 }
 
 tensorflow::Status GetExistingNodes(const ReadEventsConfig& read_events_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Node>& existing_nodes) {
   switch (read_events_config.specification()) {
     case ReadEventsConfig::EVENTS_BY_ARTIFACT_ID: {
@@ -306,7 +388,7 @@ tensorflow::Status GetExistingNodes(const ReadEventsConfig& read_events_config,
 tensorflow::Status InsertTypesInDb(const int64 num_artifact_types,
                                    const int64 num_execution_types,
                                    const int64 num_context_types,
-                                   MetadataStore& store) {
+                                   MetadataStoreServiceInterface& store) {
   PutTypesRequest put_request;
   PutTypesResponse put_response;
 
@@ -338,7 +420,7 @@ tensorflow::Status InsertTypesInDb(const int64 num_artifact_types,
 tensorflow::Status InsertNodesInDb(const int64 num_artifact_nodes,
                                    const int64 num_execution_nodes,
                                    const int64 num_context_nodes,
-                                   MetadataStore& store) {
+                                   MetadataStoreServiceInterface& store) {
   FillTypesConfig fill_types_config;
   fill_types_config.set_specification(FillTypesConfig::ARTIFACT_TYPE);
   std::vector<Type> existing_artifact_types;
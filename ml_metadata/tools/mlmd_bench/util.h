@@ -15,10 +15,12 @@ limitations under the License.
 #ifndef ML_METADATA_TOOLS_MLMD_BENCH_UTIL_H
 #define ML_METADATA_TOOLS_MLMD_BENCH_UTIL_H
 
+#include <random>
 #include <vector>
 
 #include "absl/types/variant.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/tools/mlmd_bench/proto/mlmd_bench.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -35,27 +37,27 @@ using Node = ::absl::variant<Artifact, Execution, Context>;
 // `existing_types` given `fill_types_config`. Returns detailed error if query
 // executions failed.
 tensorflow::Status GetExistingTypes(const FillTypesConfig& fill_types_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types);
 
 // Gets all the existing types inside db and store them into
 // `existing_types` given `fill_nodes_config`. Returns detailed error if query
 // executions failed.
 tensorflow::Status GetExistingTypes(const FillNodesConfig& fill_nodes_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types);
 
 // Gets all the existing types inside db and store them into `existing_types`
 // given `read_types_config`. Returns detailed error if query executions failed.
 tensorflow::Status GetExistingTypes(const ReadTypesConfig& read_types_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Type>& existing_types);
 
 // Gets all the existing nodes inside db and store them into `existing_nodes`
 // given `fill_nodes_config`.
 // Returns detailed error if query executions failed.
 tensorflow::Status GetExistingNodes(const FillNodesConfig& fill_nodes_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Node>& existing_nodes);
 
 // Gets all the existing non-context and context nodes inside db and store
@@ -64,7 +66,8 @@ tensorflow::Status GetExistingNodes(const FillNodesConfig& fill_nodes_config,
 // Returns detailed error if query executions failed.
 tensorflow::Status GetExistingNodes(
     const FillContextEdgesConfig& fill_context_edges_config,
-    MetadataStore& store, std::vector<Node>& existing_non_context_nodes,
+    MetadataStoreServiceInterface& store,
+    std::vector<Node>& existing_non_context_nodes,
     std::vector<Node>& existing_context_nodes);
 
 // Gets existing artifacts and executions inside db and store them into
@@ -72,7 +75,8 @@ tensorflow::Status GetExistingNodes(
 // `fill_events_config`. Returns detailed error if query executions
 // failed.
 tensorflow::Status GetExistingNodes(
-    const FillEventsConfig& fill_events_config, MetadataStore& store,
+    const FillEventsConfig& fill_events_config,
+    MetadataStoreServiceInterface& store,
     std::vector<Node>& existing_artifact_nodes,
     std::vector<Node>& existing_execution_nodes);
 
@@ -81,35 +85,54 @@ tensorflow::Status GetExistingNodes(
 // executions failed.
 tensorflow::Status GetExistingNodes(
     const ReadNodesByPropertiesConfig& read_nodes_by_properties_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes);
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes);
 
 // Gets all the existing nodes inside db and store them into `existing_nodes`
 // given `read_nodes_via_context_edges_config`. Returns detailed error if query
 // executions failed.
 tensorflow::Status GetExistingNodes(
     const ReadNodesViaContextEdgesConfig& read_nodes_via_context_edges_config,
-    MetadataStore& store, std::vector<Node>& existing_nodes);
+    MetadataStoreServiceInterface& store, std::vector<Node>& existing_nodes);
 
 // Gets all the existing nodes inside db and store them into `existing_nodes`
 // given `read_events_config`. Returns detailed error if query executions
 // failed.
 tensorflow::Status GetExistingNodes(const ReadEventsConfig& read_events_config,
-                                    MetadataStore& store,
+                                    MetadataStoreServiceInterface& store,
                                     std::vector<Node>& existing_nodes);
 
+// Generates and returns a zipf distribution with a configurable `skew`
+// specified by `dist` over the integers within [0, sample_size), e.g., to
+// model the popularity of heavily used input artifacts. The ranks of the
+// integers are shuffled with `gen`.
+std::discrete_distribution<int64> GenerateZipfDistributionWithConfigurableSkew(
+    int64 sample_size, const ZipfDistribution& dist, std::minstd_rand0& gen);
+
+// Validates the skew or fractions of `popularity`. Returns INVALID_ARGUMENT
+// error if they are out of range.
+tensorflow::Status ValidateNodePopularity(const NodePopularity& popularity);
+
+// Generates and returns the distribution of `popularity` over the integers
+// within [0, sample_size): uniform if it has no distribution, or else zipf or
+// hot set. The ranks of the integers are shuffled with `gen`, e.g., to pick
+// the hot nodes at random.
+std::discrete_distribution<int64> GenerateNodePopularityDistribution(
+    int64 sample_size, const NodePopularity& popularity,
+    std::minstd_rand0& gen);
+
 // Inserts some types into db for setting up in testing. Returns detailed error
 // if query executions failed.
 tensorflow::Status InsertTypesInDb(int64 num_artifact_types,
                                    int64 num_execution_types,
                                    int64 num_context_types,
-                                   MetadataStore& store);
+                                   MetadataStoreServiceInterface& store);
 
 // Inserts some nodes into db for setting up in testing. Returns detailed error
 // if query executions failed.
 tensorflow::Status InsertNodesInDb(int64 num_artifact_nodes,
                                    int64 num_execution_nodes,
                                    int64 num_context_nodes,
-                                   MetadataStore& store);
+                                   MetadataStoreServiceInterface& store);
 
 }  // namespace ml_metadata
 
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/tools/mlmd_bench/util.h"
 
+#include <algorithm>
+#include <random>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -339,6 +341,7 @@ TEST(UtilGetTest, GetNodesWithReadNodesByPropertiesConfigTest) {
       ReadNodesByPropertiesConfig::ARTIFACTS_BY_TYPE,
       ReadNodesByPropertiesConfig::ARTIFACT_BY_TYPE_AND_NAME,
       ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI,
+      ReadNodesByPropertiesConfig::ARTIFACTS_BY_URI_PREFIX,
       ReadNodesByPropertiesConfig::EXECUTIONS_BY_ID,
       ReadNodesByPropertiesConfig::EXECUTIONS_BY_TYPE,
       ReadNodesByPropertiesConfig::EXECUTION_BY_TYPE_AND_NAME,
@@ -349,9 +352,10 @@ TEST(UtilGetTest, GetNodesWithReadNodesByPropertiesConfigTest) {
   std::vector<int> num_nodes{
       kNumberOfInsertedArtifacts,  kNumberOfInsertedArtifacts,
       kNumberOfInsertedArtifacts,  kNumberOfInsertedArtifacts,
+      kNumberOfInsertedArtifacts,  kNumberOfInsertedExecutions,
       kNumberOfInsertedExecutions, kNumberOfInsertedExecutions,
-      kNumberOfInsertedExecutions, kNumberOfInsertedContexts,
-      kNumberOfInsertedContexts,   kNumberOfInsertedContexts};
+      kNumberOfInsertedContexts,   kNumberOfInsertedContexts,
+      kNumberOfInsertedContexts};
 
   for (int i = 0; i < num_nodes.size(); ++i) {
     std::vector<Node> exisiting_nodes;
@@ -434,5 +438,44 @@ TEST(UtilGetTest, GetNodesWithReadEventsConfigTest) {
   }
 }
 
+// Tests GenerateNodePopularityDistribution() with each distribution.
+TEST(UtilPopularityTest, GenerateNodePopularityDistributionTest) {
+  std::minstd_rand0 gen(0);
+  {
+    const std::vector<double> probabilities =
+        GenerateNodePopularityDistribution(4, NodePopularity(), gen)
+            .probabilities();
+    EXPECT_THAT(probabilities, ::testing::Each(0.25));
+  }
+  {
+    NodePopularity popularity;
+    popularity.mutable_zipf()->set_skew(1.0);
+    TF_ASSERT_OK(ValidateNodePopularity(popularity));
+    std::vector<double> probabilities =
+        GenerateNodePopularityDistribution(3, popularity, gen).probabilities();
+    std::sort(probabilities.begin(), probabilities.end());
+    EXPECT_NEAR(probabilities[2], 2 * probabilities[1], 1e-9);
+    EXPECT_NEAR(probabilities[2], 3 * probabilities[0], 1e-9);
+  }
+  {
+    NodePopularity popularity;
+    popularity.mutable_hot_set()->set_hot_node_fraction(0.1);
+    popularity.mutable_hot_set()->set_hot_operation_fraction(0.9);
+    TF_ASSERT_OK(ValidateNodePopularity(popularity));
+    const std::vector<double> probabilities =
+        GenerateNodePopularityDistribution(100, popularity, gen)
+            .probabilities();
+    EXPECT_EQ(std::count_if(probabilities.begin(), probabilities.end(),
+                            [](double p) { return p > 0.05; }),
+              10);
+  }
+  {
+    NodePopularity popularity;
+    popularity.mutable_hot_set()->set_hot_node_fraction(0);
+    EXPECT_EQ(ValidateNodePopularity(popularity).code(),
+              tensorflow::error::INVALID_ARGUMENT);
+  }
+}
+
 }  // namespace
 }  // namespace ml_metadata
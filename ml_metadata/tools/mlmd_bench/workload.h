@@ -17,7 +17,7 @@ limitations under the License.
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
-#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/tools/mlmd_bench/stats.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -36,11 +36,12 @@ class WorkloadBase {
 
   // Prepares a list of work items in memory. It may reads db to prepare the
   // work items.
-  virtual tensorflow::Status SetUp(MetadataStore* store) = 0;
+  virtual tensorflow::Status SetUp(MetadataStoreServiceInterface* store) = 0;
 
   // Runs the operation related to the workload and measures performance for the
   // workload operation on individual work item on MLMD.
-  virtual tensorflow::Status RunOp(int64 i, MetadataStore* store,
+  virtual tensorflow::Status RunOp(int64 i,
+                                   MetadataStoreServiceInterface* store,
                                    OpStats& op_stats) = 0;
 
   // Cleans the list of work items and related resources.
@@ -68,7 +69,7 @@ class Workload : public WorkloadBase {
   // preparation operations with the operations to be measured. The subclass
   // should implement SetUpImpl(). The given store should be not null and
   // connected. Returns detailed error if query executions failed.
-  tensorflow::Status SetUp(MetadataStore* store) final {
+  tensorflow::Status SetUp(MetadataStoreServiceInterface* store) final {
     TF_RETURN_IF_ERROR(SetUpImpl(store));
     // Set the is_setup_ to true for ensuring correct execution sequence.
     is_setup_ = true;
@@ -83,7 +84,8 @@ class Workload : public WorkloadBase {
   // running the operation.
   // Returns InvalidArgument error, if the `work_items_index` is invalid.
   // Returns detailed error if query executions failed.
-  tensorflow::Status RunOp(int64 work_items_index, MetadataStore* store,
+  tensorflow::Status RunOp(int64 work_items_index,
+                           MetadataStoreServiceInterface* store,
                            OpStats& op_stats) final {
     // Checks is_setup to ensure execution sequence.
     if (!is_setup_) {
@@ -123,14 +125,15 @@ class Workload : public WorkloadBase {
   // for preparing the work_item_ for RunOpImpl()'s execution. The detail
   // implementation will depend on each specific workload's semantic. Returns
   // detailed error if query executions failed.
-  virtual tensorflow::Status SetUpImpl(MetadataStore* store) = 0;
+  virtual tensorflow::Status SetUpImpl(
+      MetadataStoreServiceInterface* store) = 0;
 
   // The implementation of the RunOp(). It is called in RunOp() and responsible
   // for executing the work_item_ prepared in SetUpImpl(). The detail
   // implementation will depend on each specific workload's semantic. Returns
   // detailed error if query executions failed.
-  virtual tensorflow::Status RunOpImpl(int64 work_items_index,
-                                       MetadataStore* store) = 0;
+  virtual tensorflow::Status RunOpImpl(
+      int64 work_items_index, MetadataStoreServiceInterface* store) = 0;
 
   // The implementation of the TearDown(). It is called in TearDown() and
   // responsible for cleaning the work_item_ and related resources. The detail
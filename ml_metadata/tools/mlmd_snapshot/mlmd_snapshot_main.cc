@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <iostream>
+
+#include "gflags/gflags.h"
+
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_snapshot/proto/mlmd_snapshot.pb.h"
+#include "ml_metadata/tools/mlmd_snapshot/snapshot.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+// Reads the `connection_config` from the specified .pbtxt file. Returns
+// detailed error if the execution failed.
+tensorflow::Status ReadConnectionConfig(const std::string& config_file_path,
+                                        ConnectionConfig& connection_config) {
+  if (!tensorflow::Env::Default()->FileExists(config_file_path).ok()) {
+    return tensorflow::errors::NotFound(
+        "Could not find the ConnectionConfig .pbtxt file at supplied "
+        "configuration file path: ",
+        config_file_path);
+  }
+  return ReadTextProto(tensorflow::Env::Default(), config_file_path,
+                       &connection_config);
+}
+
+}  // namespace
+}  // namespace ml_metadata
+
+// mlmd_snapshot command line options.
+DEFINE_string(mode, "",
+              "Either export, import, export_tables or export_sqlite.");
+DEFINE_string(config_file_path, "",
+              "Input ConnectionConfig .pbtxt file path of the store.");
+DEFINE_string(snapshot_dir, "",
+              "The directory of the snapshot, or of the exported tables, or "
+              "the path of the SQLite snapshot.");
+DEFINE_int32(num_threads, 8, "The number of threads.");
+DEFINE_int64(id_range_size, 100000,
+             "The number of ids of the nodes of a snapshot file.");
+DEFINE_int32(max_chunk_size, 1000,
+             "The max number of records read or written with one request.");
+DEFINE_bool(keep_secondary_indices, false,
+            "If set, the import does not drop and rebuild the secondary "
+            "indices of the store.");
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  ml_metadata::ConnectionConfig connection_config;
+  TF_CHECK_OK(ml_metadata::ReadConnectionConfig(FLAGS_config_file_path,
+                                                connection_config));
+  ml_metadata::SnapshotOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.id_range_size = FLAGS_id_range_size;
+  options.max_chunk_size = FLAGS_max_chunk_size;
+  options.keep_secondary_indices = FLAGS_keep_secondary_indices;
+
+  ml_metadata::SnapshotManifest manifest;
+  if (FLAGS_mode == "export") {
+    TF_CHECK_OK(ml_metadata::ExportSnapshot(
+        connection_config, FLAGS_snapshot_dir, options, &manifest));
+  } else if (FLAGS_mode == "import") {
+    TF_CHECK_OK(ml_metadata::ImportSnapshot(
+        FLAGS_snapshot_dir, connection_config, options, &manifest));
+  } else if (FLAGS_mode == "export_tables") {
+    ml_metadata::TableManifest table_manifest;
+    TF_CHECK_OK(ml_metadata::ExportTables(
+        connection_config, FLAGS_snapshot_dir, options, &table_manifest));
+    std::cout << table_manifest.DebugString();
+    return 0;
+  } else if (FLAGS_mode == "export_sqlite") {
+    ml_metadata::TableManifest table_manifest;
+    TF_CHECK_OK(ml_metadata::ExportSqliteSnapshot(
+        connection_config, FLAGS_snapshot_dir, options, &table_manifest));
+    std::cout << table_manifest.DebugString();
+    return 0;
+  } else {
+    std::cerr << "--mode must be either export, import, export_tables or "
+                 "export_sqlite."
+              << std::endl;
+    return 1;
+  }
+  std::cout << manifest.DebugString();
+  return 0;
+}
@@ -0,0 +1,1307 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_snapshot/snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/repeated_field.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "google/protobuf/util/json_util.h"
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/typed_record_set.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/return_utils.h"
+#include "ml_metadata/util/status_utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr char kManifestFileName[] = "manifest.pbtxt";
+constexpr char kTypesFileName[] = "types.pb";
+constexpr char kTableManifestFileName[] = "tables.pbtxt";
+
+// The max number of bytes of a SQLite snapshot read through memory-mapped I/O.
+constexpr int64 kSqliteSnapshotMmapSize = int64{1} << 40;
+
+// The kinds of nodes, whose ids are in separate ranges.
+enum class NodeKind { kArtifact, kExecution, kContext };
+
+// Writes the chunks of a snapshot file. The file is only created once the
+// first chunk is written, so that the empty ranges of ids have no files.
+class ChunkFileWriter {
+ public:
+  explicit ChunkFileWriter(const std::string& path) : path_(path) {}
+
+  // Returns true if a chunk has been written.
+  bool written() const { return written_; }
+
+  tensorflow::Status Write(const SnapshotChunk& chunk) {
+    if (!stream_.is_open()) {
+      stream_.open(path_, std::ios::binary | std::ios::trunc);
+      written_ = true;
+    }
+    if (!stream_ ||
+        !google::protobuf::util::SerializeDelimitedToOstream(chunk, &stream_)) {
+      return tensorflow::errors::Internal("Cannot write the snapshot file: ",
+                                          path_);
+    }
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status Close() {
+    if (!stream_.is_open()) {
+      return tensorflow::Status::OK();
+    }
+    stream_.close();
+    if (!stream_) {
+      return tensorflow::errors::Internal("Cannot write the snapshot file: ",
+                                          path_);
+    }
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  const std::string path_;
+  std::ofstream stream_;
+  bool written_ = false;
+};
+
+// Passes the chunks of the snapshot file at `path` to `callback` in order.
+tensorflow::Status ReadChunkFile(
+    const std::string& path,
+    const std::function<tensorflow::Status(const SnapshotChunk&)>& callback) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return tensorflow::errors::DataLoss("Cannot read the snapshot file: ",
+                                        path);
+  }
+  google::protobuf::io::IstreamInputStream input(&stream);
+  while (true) {
+    SnapshotChunk chunk;
+    bool clean_eof = false;
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+            &chunk, &input, &clean_eof)) {
+      if (clean_eof) {
+        return tensorflow::Status::OK();
+      }
+      return tensorflow::errors::DataLoss("Corrupted snapshot file: ", path);
+    }
+    TF_RETURN_IF_ERROR(callback(chunk));
+  }
+}
+
+// Adds the number of records of `chunk` to the counts of `manifest`.
+void AddCounts(const SnapshotChunk& chunk, SnapshotManifest* manifest) {
+  manifest->set_num_artifact_types(manifest->num_artifact_types() +
+                                   chunk.artifact_types_size());
+  manifest->set_num_execution_types(manifest->num_execution_types() +
+                                    chunk.execution_types_size());
+  manifest->set_num_context_types(manifest->num_context_types() +
+                                  chunk.context_types_size());
+  manifest->set_num_artifacts(manifest->num_artifacts() +
+                              chunk.artifacts_size());
+  manifest->set_num_executions(manifest->num_executions() +
+                               chunk.executions_size());
+  manifest->set_num_contexts(manifest->num_contexts() + chunk.contexts_size());
+  manifest->set_num_events(manifest->num_events() + chunk.events_size());
+  manifest->set_num_attributions(manifest->num_attributions() +
+                                 chunk.attributions_size());
+  manifest->set_num_associations(manifest->num_associations() +
+                                 chunk.associations_size());
+  manifest->set_num_parent_contexts(manifest->num_parent_contexts() +
+                                    chunk.parent_contexts_size());
+}
+
+// Runs `num_tasks` tasks on `num_threads` threads, each with its own store of
+// `config`. Once a task fails, the tasks which are not started yet are skipped.
+// Returns the error of the first failed task.
+tensorflow::Status RunInParallel(
+    const ConnectionConfig& config, const int num_threads,
+    const int64 num_tasks,
+    const std::function<tensorflow::Status(int64, MetadataStore*)>& run_task) {
+  if (num_tasks == 0) {
+    return tensorflow::Status::OK();
+  }
+  const int num_workers =
+      static_cast<int>(std::min<int64>(std::max(1, num_threads), num_tasks));
+  std::vector<std::unique_ptr<MetadataStore>> stores(num_workers);
+  for (std::unique_ptr<MetadataStore>& store : stores) {
+    TF_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+  }
+  std::atomic<int64> next_task(0);
+  std::atomic<bool> failed(false);
+  absl::Mutex mutex;
+  tensorflow::Status status;
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "mlmd_snapshot", num_workers);
+    for (std::unique_ptr<MetadataStore>& store : stores) {
+      MetadataStore* worker_store = store.get();
+      pool.Schedule([&, worker_store]() {
+        for (int64 task = next_task++; task < num_tasks && !failed;
+             task = next_task++) {
+          const tensorflow::Status task_status = run_task(task, worker_store);
+          if (!task_status.ok()) {
+            failed = true;
+            absl::MutexLock lock(&mutex);
+            status.Update(task_status);
+          }
+        }
+      });
+    }
+  }
+  return status;
+}
+
+// Returns the largest id of the nodes of `kind` in `max_id`, or 0 if there is
+// none, by listing the first node in descending order of ids.
+tensorflow::Status GetMaxNodeId(const NodeKind kind, MetadataStore* store,
+                                int64* max_id) {
+  ListOperationOptions options;
+  options.set_max_result_size(1);
+  options.mutable_order_by_field()->set_field(
+      ListOperationOptions::OrderByField::ID);
+  options.mutable_order_by_field()->set_is_asc(false);
+  *max_id = 0;
+  switch (kind) {
+    case NodeKind::kArtifact: {
+      GetArtifactsRequest request;
+      *request.mutable_options() = options;
+      GetArtifactsResponse response;
+      TF_RETURN_IF_ERROR(store->GetArtifacts(request, &response));
+      if (!response.artifacts().empty()) {
+        *max_id = response.artifacts(0).id();
+      }
+      break;
+    }
+    case NodeKind::kExecution: {
+      GetExecutionsRequest request;
+      *request.mutable_options() = options;
+      GetExecutionsResponse response;
+      TF_RETURN_IF_ERROR(store->GetExecutions(request, &response));
+      if (!response.executions().empty()) {
+        *max_id = response.executions(0).id();
+      }
+      break;
+    }
+    case NodeKind::kContext: {
+      GetContextsRequest request;
+      *request.mutable_options() = options;
+      GetContextsResponse response;
+      TF_RETURN_IF_ERROR(store->GetContexts(request, &response));
+      if (!response.contexts().empty()) {
+        *max_id = response.contexts(0).id();
+      }
+      break;
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// A range of ids of one kind of node, exported to a node file and an edge
+// file.
+struct ExportTask {
+  NodeKind kind;
+  int64 begin_id;
+  int64 end_id;
+  std::string node_file;
+  std::string edge_file;
+};
+
+// Exports the edges of the contexts of `node_chunk` to `edge_chunk`. The
+// parent contexts are read context by context, as there is no batched call.
+tensorflow::Status ExportContextEdges(const SnapshotChunk& node_chunk,
+                                      MetadataStore* store,
+                                      SnapshotChunk* edge_chunk) {
+  GetArtifactsByContextsRequest artifacts_request;
+  GetExecutionsByContextsRequest executions_request;
+  for (const Context& context : node_chunk.contexts()) {
+    artifacts_request.add_context_ids(context.id());
+    executions_request.add_context_ids(context.id());
+  }
+  GetArtifactsByContextsResponse artifacts_response;
+  TF_RETURN_IF_ERROR(
+      store->GetArtifactsByContexts(artifacts_request, &artifacts_response));
+  for (const auto& context_and_artifacts :
+       artifacts_response.artifacts_by_context()) {
+    for (const Artifact& artifact : context_and_artifacts.second.artifacts()) {
+      Attribution* attribution = edge_chunk->add_attributions();
+      attribution->set_context_id(context_and_artifacts.first);
+      attribution->set_artifact_id(artifact.id());
+    }
+  }
+  GetExecutionsByContextsResponse executions_response;
+  TF_RETURN_IF_ERROR(store->GetExecutionsByContexts(executions_request,
+                                                    &executions_response));
+  for (const auto& context_and_executions :
+       executions_response.executions_by_context()) {
+    for (const Execution& execution :
+         context_and_executions.second.executions()) {
+      Association* association = edge_chunk->add_associations();
+      association->set_context_id(context_and_executions.first);
+      association->set_execution_id(execution.id());
+    }
+  }
+  for (const Context& context : node_chunk.contexts()) {
+    GetParentContextsByContextRequest request;
+    request.set_context_id(context.id());
+    GetParentContextsByContextResponse response;
+    TF_RETURN_IF_ERROR(store->GetParentContextsByContext(request, &response));
+    for (const Context& parent : response.contexts()) {
+      ParentContext* parent_context = edge_chunk->add_parent_contexts();
+      parent_context->set_child_id(context.id());
+      parent_context->set_parent_id(parent.id());
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Exports the nodes of the ids [first_id, end_id) of `kind`, which are read
+// with one call, to `node_chunk`, and their edges to `edge_chunk`.
+tensorflow::Status ExportNodeChunk(const NodeKind kind, const int64 first_id,
+                                   const int64 end_id, MetadataStore* store,
+                                   SnapshotChunk* node_chunk,
+                                   SnapshotChunk* edge_chunk) {
+  switch (kind) {
+    case NodeKind::kArtifact: {
+      GetArtifactsByIDRequest request;
+      for (int64 id = first_id; id < end_id; ++id) {
+        request.add_artifact_ids(id);
+      }
+      GetArtifactsByIDResponse response;
+      TF_RETURN_IF_ERROR(store->GetArtifactsByID(request, &response));
+      node_chunk->mutable_artifacts()->Swap(response.mutable_artifacts());
+      return tensorflow::Status::OK();
+    }
+    case NodeKind::kExecution: {
+      GetExecutionsByIDRequest request;
+      for (int64 id = first_id; id < end_id; ++id) {
+        request.add_execution_ids(id);
+      }
+      GetExecutionsByIDResponse response;
+      TF_RETURN_IF_ERROR(store->GetExecutionsByID(request, &response));
+      node_chunk->mutable_executions()->Swap(response.mutable_executions());
+      if (node_chunk->executions().empty()) {
+        return tensorflow::Status::OK();
+      }
+      GetEventsByExecutionIDsRequest events_request;
+      for (const Execution& execution : node_chunk->executions()) {
+        events_request.add_execution_ids(execution.id());
+      }
+      GetEventsByExecutionIDsResponse events_response;
+      TF_RETURN_IF_ERROR(
+          store->GetEventsByExecutionIDs(events_request, &events_response));
+      edge_chunk->mutable_events()->Swap(events_response.mutable_events());
+      return tensorflow::Status::OK();
+    }
+    case NodeKind::kContext: {
+      GetContextsByIDRequest request;
+      for (int64 id = first_id; id < end_id; ++id) {
+        request.add_context_ids(id);
+      }
+      GetContextsByIDResponse response;
+      TF_RETURN_IF_ERROR(store->GetContextsByID(request, &response));
+      node_chunk->mutable_contexts()->Swap(response.mutable_contexts());
+      if (node_chunk->contexts().empty()) {
+        return tensorflow::Status::OK();
+      }
+      return ExportContextEdges(*node_chunk, store, edge_chunk);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Lists the ranges of ids of the nodes of the store to export, each with its
+// own snapshot files.
+tensorflow::Status ListExportTasks(MetadataStore* store,
+                                   const int64 id_range_size,
+                                   std::vector<ExportTask>* tasks) {
+  for (const auto& kind_and_name :
+       {std::make_pair(NodeKind::kArtifact, "artifacts"),
+        std::make_pair(NodeKind::kExecution, "executions"),
+        std::make_pair(NodeKind::kContext, "contexts")}) {
+    int64 max_id = 0;
+    TF_RETURN_IF_ERROR(GetMaxNodeId(kind_and_name.first, store, &max_id));
+    for (int64 begin_id = 1; begin_id <= max_id; begin_id += id_range_size) {
+      const int64 range = tasks->size();
+      tasks->push_back(
+          {kind_and_name.first, begin_id,
+           std::min(begin_id + id_range_size, max_id + 1),
+           absl::StrFormat("%s-%05d.pb", kind_and_name.second, range),
+           absl::StrFormat("%s-edges-%05d.pb", kind_and_name.second, range)});
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the column names of each table of ExportTables.
+const absl::flat_hash_map<std::string, std::vector<std::string>>&
+TableColumns() {
+  static const auto* const columns =
+      new absl::flat_hash_map<std::string, std::vector<std::string>>{
+          {"types", {"id", "kind", "name", "version", "description"}},
+          {"type_properties", {"type_id", "name", "data_type"}},
+          {"artifacts",
+           {"id", "type_id", "type", "name", "uri", "state",
+            "create_time_since_epoch", "last_update_time_since_epoch"}},
+          {"executions",
+           {"id", "type_id", "type", "name", "last_known_state",
+            "create_time_since_epoch", "last_update_time_since_epoch"}},
+          {"contexts",
+           {"id", "type_id", "type", "name", "create_time_since_epoch",
+            "last_update_time_since_epoch"}},
+          {"properties",
+           {"node_kind", "node_id", "name", "is_custom_property", "int_value",
+            "double_value", "string_value", "struct_value"}},
+          {"events",
+           {"artifact_id", "execution_id", "type", "path",
+            "milliseconds_since_epoch"}},
+          {"attributions", {"context_id", "artifact_id"}},
+          {"associations", {"context_id", "execution_id"}},
+          {"parent_contexts", {"child_id", "parent_id"}},
+      };
+  return *columns;
+}
+
+// Appends `field` to `line` as a CSV field, quoted if it has a separator, a
+// quote or a line break.
+void AppendCsvField(const absl::string_view field, std::string* line) {
+  if (field.find_first_of(",\"\r\n") == absl::string_view::npos) {
+    absl::StrAppend(line, field);
+    return;
+  }
+  line->push_back('"');
+  for (const char c : field) {
+    if (c == '"') line->push_back('"');
+    line->push_back(c);
+  }
+  line->push_back('"');
+}
+
+// Writes the rows of a CSV table file, after a header with the names of its
+// columns. Like the snapshot files, the file is only created once its first
+// row is written.
+class TableFileWriter {
+ public:
+  TableFileWriter(const std::string& path,
+                  const std::vector<std::string>& columns)
+      : path_(path), columns_(columns) {}
+
+  int64 num_rows() const { return num_rows_; }
+
+  tensorflow::Status Write(const std::vector<std::string>& row) {
+    if (!stream_.is_open()) {
+      stream_.open(path_, std::ios::binary | std::ios::trunc);
+      WriteLine(columns_);
+    }
+    WriteLine(row);
+    ++num_rows_;
+    if (!stream_) {
+      return tensorflow::errors::Internal("Cannot write the table file: ",
+                                          path_);
+    }
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status Close() {
+    if (!stream_.is_open()) {
+      return tensorflow::Status::OK();
+    }
+    stream_.close();
+    if (!stream_) {
+      return tensorflow::errors::Internal("Cannot write the table file: ",
+                                          path_);
+    }
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  void WriteLine(const std::vector<std::string>& fields) {
+    line_.clear();
+    for (int i = 0; i < fields.size(); ++i) {
+      if (i > 0) line_.push_back(',');
+      AppendCsvField(fields[i], &line_);
+    }
+    line_.push_back('\n');
+    stream_.write(line_.data(), line_.size());
+  }
+
+  const std::string path_;
+  const std::vector<std::string> columns_;
+  std::ofstream stream_;
+  std::string line_;
+  int64 num_rows_ = 0;
+};
+
+// The table files of the types, or of a range of ids of the nodes, which are
+// named after their table and `file_suffix`.
+class TableWriters {
+ public:
+  TableWriters(const std::string& export_dir, const std::string& file_suffix)
+      : export_dir_(export_dir), file_suffix_(file_suffix) {}
+
+  // Writes `row` to the file of `table`.
+  tensorflow::Status Write(const std::string& table,
+                           const std::vector<std::string>& row) {
+    std::unique_ptr<TableFileWriter>& writer = writers_[table];
+    if (writer == nullptr) {
+      writer = absl::make_unique<TableFileWriter>(
+          absl::StrCat(export_dir_, "/", table, file_suffix_),
+          TableColumns().at(table));
+    }
+    return writer->Write(row);
+  }
+
+  // Closes the written files, and adds them to `files`.
+  tensorflow::Status Close(std::vector<TableFile>* files) {
+    for (auto& table_and_writer : writers_) {
+      TF_RETURN_IF_ERROR(table_and_writer.second->Close());
+      TableFile file;
+      file.set_table(table_and_writer.first);
+      file.set_file(absl::StrCat(table_and_writer.first, file_suffix_));
+      file.set_num_rows(table_and_writer.second->num_rows());
+      files->push_back(std::move(file));
+    }
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  const std::string export_dir_;
+  const std::string file_suffix_;
+  absl::flat_hash_map<std::string, std::unique_ptr<TableFileWriter>> writers_;
+};
+
+// Sets `json` to `message` as JSON, or to an empty string if it is empty.
+tensorflow::Status ToJson(const google::protobuf::Message& message,
+                          std::string* json) {
+  json->clear();
+  if (message.ByteSizeLong() == 0) {
+    return tensorflow::Status::OK();
+  }
+  if (!google::protobuf::util::MessageToJsonString(message, json).ok()) {
+    return tensorflow::errors::Internal("Cannot convert to JSON: ",
+                                        message.ShortDebugString());
+  }
+  return tensorflow::Status::OK();
+}
+
+// Writes the (custom) properties of the node `node_id` of `node_kind` to the
+// properties table, in the order of their names.
+tensorflow::Status WriteProperties(
+    const absl::string_view node_kind, const int64 node_id,
+    const google::protobuf::Map<std::string, Value>& properties,
+    const bool is_custom_property, TableWriters* writers) {
+  std::vector<std::string> names;
+  for (const auto& name_and_value : properties) {
+    names.push_back(name_and_value.first);
+  }
+  std::sort(names.begin(), names.end());
+  for (const std::string& name : names) {
+    const Value& value = properties.at(name);
+    std::string struct_value;
+    if (value.has_struct_value()) {
+      TF_RETURN_IF_ERROR(ToJson(value.struct_value(), &struct_value));
+    }
+    TF_RETURN_IF_ERROR(writers->Write(
+        "properties",
+        {std::string(node_kind), absl::StrCat(node_id), name,
+         is_custom_property ? "true" : "false",
+         value.value_case() == Value::kIntValue
+             ? absl::StrCat(value.int_value())
+             : "",
+         value.value_case() == Value::kDoubleValue
+             ? absl::StrCat(value.double_value())
+             : "",
+         value.string_value(), struct_value}));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Writes the types of `type_kind` to the types and type_properties tables.
+template <typename Type>
+tensorflow::Status WriteTypes(
+    const absl::string_view type_kind,
+    const google::protobuf::RepeatedPtrField<Type>& types,
+    TableWriters* writers) {
+  for (const Type& type : types) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "types", {absl::StrCat(type.id()), std::string(type_kind), type.name(),
+                  type.version(), type.description()}));
+    std::vector<std::string> names;
+    for (const auto& name_and_type : type.properties()) {
+      names.push_back(name_and_type.first);
+    }
+    std::sort(names.begin(), names.end());
+    for (const std::string& name : names) {
+      TF_RETURN_IF_ERROR(writers->Write(
+          "type_properties", {absl::StrCat(type.id()), name,
+                              PropertyType_Name(type.properties().at(name))}));
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the time `value` of a node, or an empty string if it is not set.
+std::string TimeField(const bool has_value, const int64 value) {
+  return has_value ? absl::StrCat(value) : "";
+}
+
+// Writes the records of `chunk` to the rows of their tables.
+tensorflow::Status WriteTableRows(const SnapshotChunk& chunk,
+                                  TableWriters* writers) {
+  TF_RETURN_IF_ERROR(WriteTypes("artifact", chunk.artifact_types(), writers));
+  TF_RETURN_IF_ERROR(
+      WriteTypes("execution", chunk.execution_types(), writers));
+  TF_RETURN_IF_ERROR(WriteTypes("context", chunk.context_types(), writers));
+  for (const Artifact& artifact : chunk.artifacts()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "artifacts",
+        {absl::StrCat(artifact.id()), absl::StrCat(artifact.type_id()),
+         artifact.type(), artifact.name(), artifact.uri(),
+         artifact.has_state() ? Artifact::State_Name(artifact.state()) : "",
+         TimeField(artifact.has_create_time_since_epoch(),
+                   artifact.create_time_since_epoch()),
+         TimeField(artifact.has_last_update_time_since_epoch(),
+                   artifact.last_update_time_since_epoch())}));
+    TF_RETURN_IF_ERROR(WriteProperties("artifact", artifact.id(),
+                                       artifact.properties(),
+                                       /*is_custom_property=*/false, writers));
+    TF_RETURN_IF_ERROR(WriteProperties("artifact", artifact.id(),
+                                       artifact.custom_properties(),
+                                       /*is_custom_property=*/true, writers));
+  }
+  for (const Execution& execution : chunk.executions()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "executions",
+        {absl::StrCat(execution.id()), absl::StrCat(execution.type_id()),
+         execution.type(), execution.name(),
+         execution.has_last_known_state()
+             ? Execution::State_Name(execution.last_known_state())
+             : "",
+         TimeField(execution.has_create_time_since_epoch(),
+                   execution.create_time_since_epoch()),
+         TimeField(execution.has_last_update_time_since_epoch(),
+                   execution.last_update_time_since_epoch())}));
+    TF_RETURN_IF_ERROR(WriteProperties("execution", execution.id(),
+                                       execution.properties(),
+                                       /*is_custom_property=*/false, writers));
+    TF_RETURN_IF_ERROR(WriteProperties("execution", execution.id(),
+                                       execution.custom_properties(),
+                                       /*is_custom_property=*/true, writers));
+  }
+  for (const Context& context : chunk.contexts()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "contexts",
+        {absl::StrCat(context.id()), absl::StrCat(context.type_id()),
+         context.type(), context.name(),
+         TimeField(context.has_create_time_since_epoch(),
+                   context.create_time_since_epoch()),
+         TimeField(context.has_last_update_time_since_epoch(),
+                   context.last_update_time_since_epoch())}));
+    TF_RETURN_IF_ERROR(WriteProperties("context", context.id(),
+                                       context.properties(),
+                                       /*is_custom_property=*/false, writers));
+    TF_RETURN_IF_ERROR(WriteProperties("context", context.id(),
+                                       context.custom_properties(),
+                                       /*is_custom_property=*/true, writers));
+  }
+  for (const Event& event : chunk.events()) {
+    std::string path;
+    TF_RETURN_IF_ERROR(ToJson(event.path(), &path));
+    TF_RETURN_IF_ERROR(writers->Write(
+        "events", {absl::StrCat(event.artifact_id()),
+                   absl::StrCat(event.execution_id()),
+                   Event::Type_Name(event.type()), path,
+                   TimeField(event.has_milliseconds_since_epoch(),
+                             event.milliseconds_since_epoch())}));
+  }
+  for (const Attribution& attribution : chunk.attributions()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "attributions", {absl::StrCat(attribution.context_id()),
+                         absl::StrCat(attribution.artifact_id())}));
+  }
+  for (const Association& association : chunk.associations()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "associations", {absl::StrCat(association.context_id()),
+                         absl::StrCat(association.execution_id())}));
+  }
+  for (const ParentContext& parent_context : chunk.parent_contexts()) {
+    TF_RETURN_IF_ERROR(writers->Write(
+        "parent_contexts", {absl::StrCat(parent_context.child_id()),
+                            absl::StrCat(parent_context.parent_id())}));
+  }
+  return tensorflow::Status::OK();
+}
+
+// The ids of the imported types and nodes keyed by their ids in the snapshot.
+// The node maps are only written while the nodes are imported, and only read
+// afterwards.
+struct IdMaps {
+  absl::flat_hash_map<int64, int64> types;
+  absl::Mutex mutex;
+  absl::flat_hash_map<int64, int64> artifacts;
+  absl::flat_hash_map<int64, int64> executions;
+  absl::flat_hash_map<int64, int64> contexts;
+};
+
+// Sets `mapped_id` to the imported id of `id` in `id_map`.
+// Returns DATA_LOSS error, if the id is not in the map.
+tensorflow::Status MapId(const absl::flat_hash_map<int64, int64>& id_map,
+                         const absl::string_view kind, const int64 id,
+                         int64* mapped_id) {
+  auto it = id_map.find(id);
+  if (it == id_map.end()) {
+    return tensorflow::errors::DataLoss("The snapshot has no ", kind,
+                                        " with id: ", id);
+  }
+  *mapped_id = it->second;
+  return tensorflow::Status::OK();
+}
+
+// Upserts the types of the type files, and maps their ids.
+tensorflow::Status ImportTypes(const std::string& snapshot_dir,
+                               const SnapshotManifest& manifest,
+                               MetadataStore* store, IdMaps* id_maps,
+                               SnapshotManifest* imported) {
+  PutTypesRequest request;
+  request.set_can_add_fields(true);
+  request.set_can_omit_fields(true);
+  for (const std::string& type_file : manifest.type_files()) {
+    TF_RETURN_IF_ERROR(ReadChunkFile(
+        absl::StrCat(snapshot_dir, "/", type_file),
+        [&request](const SnapshotChunk& chunk) -> tensorflow::Status {
+          request.mutable_artifact_types()->MergeFrom(chunk.artifact_types());
+          request.mutable_execution_types()->MergeFrom(
+              chunk.execution_types());
+          request.mutable_context_types()->MergeFrom(chunk.context_types());
+          return tensorflow::Status::OK();
+        }));
+  }
+  std::vector<int64> snapshot_type_ids;
+  for (ArtifactType& type : *request.mutable_artifact_types()) {
+    snapshot_type_ids.push_back(type.id());
+    type.clear_id();
+  }
+  for (ExecutionType& type : *request.mutable_execution_types()) {
+    snapshot_type_ids.push_back(type.id());
+    type.clear_id();
+  }
+  for (ContextType& type : *request.mutable_context_types()) {
+    snapshot_type_ids.push_back(type.id());
+    type.clear_id();
+  }
+  PutTypesResponse response;
+  TF_RETURN_IF_ERROR(store->PutTypes(request, &response));
+  std::vector<int64> type_ids(response.artifact_type_ids().begin(),
+                              response.artifact_type_ids().end());
+  type_ids.insert(type_ids.end(), response.execution_type_ids().begin(),
+                  response.execution_type_ids().end());
+  type_ids.insert(type_ids.end(), response.context_type_ids().begin(),
+                  response.context_type_ids().end());
+  if (type_ids.size() != snapshot_type_ids.size()) {
+    return tensorflow::errors::Internal("Expected ", snapshot_type_ids.size(),
+                                        " type ids, but got ",
+                                        type_ids.size());
+  }
+  for (int i = 0; i < type_ids.size(); ++i) {
+    id_maps->types[snapshot_type_ids[i]] = type_ids[i];
+  }
+  SnapshotChunk types;
+  *types.mutable_artifact_types() = request.artifact_types();
+  *types.mutable_execution_types() = request.execution_types();
+  *types.mutable_context_types() = request.context_types();
+  AddCounts(types, imported);
+  return tensorflow::Status::OK();
+}
+
+// Inserts the nodes of `chunk` with their imported type ids, and maps their
+// ids.
+tensorflow::Status ImportNodeChunk(const SnapshotChunk& chunk,
+                                   MetadataStore* store, IdMaps* id_maps) {
+  int64 mapped_id = 0;
+  std::vector<std::pair<int64, int64>> artifact_ids;
+  if (!chunk.artifacts().empty()) {
+    PutArtifactsRequest request;
+    *request.mutable_artifacts() = chunk.artifacts();
+    for (Artifact& artifact : *request.mutable_artifacts()) {
+      artifact.clear_id();
+      TF_RETURN_IF_ERROR(MapId(id_maps->types, "type",
+                               artifact.type_id(), &mapped_id));
+      artifact.set_type_id(mapped_id);
+    }
+    PutArtifactsResponse response;
+    TF_RETURN_IF_ERROR(store->PutArtifacts(request, &response));
+    for (int i = 0; i < response.artifact_ids_size(); ++i) {
+      artifact_ids.push_back(
+          {chunk.artifacts(i).id(), response.artifact_ids(i)});
+    }
+  }
+  std::vector<std::pair<int64, int64>> execution_ids;
+  if (!chunk.executions().empty()) {
+    PutExecutionsRequest request;
+    *request.mutable_executions() = chunk.executions();
+    for (Execution& execution : *request.mutable_executions()) {
+      execution.clear_id();
+      TF_RETURN_IF_ERROR(MapId(id_maps->types, "type",
+                               execution.type_id(), &mapped_id));
+      execution.set_type_id(mapped_id);
+    }
+    PutExecutionsResponse response;
+    TF_RETURN_IF_ERROR(store->PutExecutions(request, &response));
+    for (int i = 0; i < response.execution_ids_size(); ++i) {
+      execution_ids.push_back(
+          {chunk.executions(i).id(), response.execution_ids(i)});
+    }
+  }
+  std::vector<std::pair<int64, int64>> context_ids;
+  if (!chunk.contexts().empty()) {
+    PutContextsRequest request;
+    *request.mutable_contexts() = chunk.contexts();
+    for (Context& context : *request.mutable_contexts()) {
+      context.clear_id();
+      TF_RETURN_IF_ERROR(MapId(id_maps->types, "type",
+                               context.type_id(), &mapped_id));
+      context.set_type_id(mapped_id);
+    }
+    PutContextsResponse response;
+    TF_RETURN_IF_ERROR(store->PutContexts(request, &response));
+    for (int i = 0; i < response.context_ids_size(); ++i) {
+      context_ids.push_back({chunk.contexts(i).id(), response.context_ids(i)});
+    }
+  }
+  absl::MutexLock lock(&id_maps->mutex);
+  id_maps->artifacts.insert(artifact_ids.begin(), artifact_ids.end());
+  id_maps->executions.insert(execution_ids.begin(), execution_ids.end());
+  id_maps->contexts.insert(context_ids.begin(), context_ids.end());
+  return tensorflow::Status::OK();
+}
+
+// Inserts the edges of `chunk` with the imported ids of their nodes.
+tensorflow::Status ImportEdgeChunk(const SnapshotChunk& chunk,
+                                   MetadataStore* store,
+                                   const IdMaps& id_maps) {
+  int64 mapped_id = 0;
+  if (!chunk.events().empty()) {
+    PutEventsRequest request;
+    *request.mutable_events() = chunk.events();
+    for (Event& event : *request.mutable_events()) {
+      TF_RETURN_IF_ERROR(MapId(id_maps.artifacts, "artifact",
+                               event.artifact_id(), &mapped_id));
+      event.set_artifact_id(mapped_id);
+      TF_RETURN_IF_ERROR(MapId(id_maps.executions, "execution",
+                               event.execution_id(), &mapped_id));
+      event.set_execution_id(mapped_id);
+    }
+    PutEventsResponse response;
+    TF_RETURN_IF_ERROR(store->PutEvents(request, &response));
+  }
+  if (!chunk.attributions().empty() || !chunk.associations().empty()) {
+    PutAttributionsAndAssociationsRequest request;
+    *request.mutable_attributions() = chunk.attributions();
+    *request.mutable_associations() = chunk.associations();
+    for (Attribution& attribution : *request.mutable_attributions()) {
+      TF_RETURN_IF_ERROR(MapId(id_maps.contexts, "context",
+                               attribution.context_id(), &mapped_id));
+      attribution.set_context_id(mapped_id);
+      TF_RETURN_IF_ERROR(MapId(id_maps.artifacts, "artifact",
+                               attribution.artifact_id(), &mapped_id));
+      attribution.set_artifact_id(mapped_id);
+    }
+    for (Association& association : *request.mutable_associations()) {
+      TF_RETURN_IF_ERROR(MapId(id_maps.contexts, "context",
+                               association.context_id(), &mapped_id));
+      association.set_context_id(mapped_id);
+      TF_RETURN_IF_ERROR(MapId(id_maps.executions, "execution",
+                               association.execution_id(), &mapped_id));
+      association.set_execution_id(mapped_id);
+    }
+    PutAttributionsAndAssociationsResponse response;
+    TF_RETURN_IF_ERROR(
+        store->PutAttributionsAndAssociations(request, &response));
+  }
+  if (!chunk.parent_contexts().empty()) {
+    PutParentContextsRequest request;
+    *request.mutable_parent_contexts() = chunk.parent_contexts();
+    for (ParentContext& parent_context : *request.mutable_parent_contexts()) {
+      TF_RETURN_IF_ERROR(MapId(id_maps.contexts, "context",
+                               parent_context.child_id(), &mapped_id));
+      parent_context.set_child_id(mapped_id);
+      TF_RETURN_IF_ERROR(MapId(id_maps.contexts, "context",
+                               parent_context.parent_id(), &mapped_id));
+      parent_context.set_parent_id(mapped_id);
+    }
+    PutParentContextsResponse response;
+    TF_RETURN_IF_ERROR(store->PutParentContexts(request, &response));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Imports the chunks of `files` in parallel with `import_chunk`, and adds
+// their counts to `imported`.
+tensorflow::Status ImportFiles(
+    const std::string& snapshot_dir,
+    const google::protobuf::RepeatedPtrField<std::string>& files,
+    const ConnectionConfig& config, const SnapshotOptions& options,
+    const std::function<tensorflow::Status(const SnapshotChunk&,
+                                           MetadataStore*)>& import_chunk,
+    SnapshotManifest* imported) {
+  absl::Mutex mutex;
+  return RunInParallel(
+      config, options.num_threads, files.size(),
+      [&](const int64 task, MetadataStore* store) -> tensorflow::Status {
+        return ReadChunkFile(
+            absl::StrCat(snapshot_dir, "/", files.Get(task)),
+            [&](const SnapshotChunk& chunk) -> tensorflow::Status {
+              TF_RETURN_IF_ERROR(import_chunk(chunk, store));
+              absl::MutexLock lock(&mutex);
+              AddCounts(chunk, imported);
+              return tensorflow::Status::OK();
+            });
+      });
+}
+
+// A table of a SQLite snapshot and its columns, and whether each column is a
+// BLOB whose cells are bound as bytes.
+struct SqliteTable {
+  std::string name;
+  std::vector<std::string> columns;
+  std::vector<bool> is_blob;
+};
+
+// Lists the tables of the MLMD schema of the SQLite `source`, i.e., all but
+// the internal tables of SQLite.
+tensorflow::Status ListSqliteTables(MetadataSource* source,
+                                    std::vector<SqliteTable>* tables) {
+  RecordSet names;
+  TF_RETURN_IF_ERROR(FromABSLStatus(source->ExecuteQuery(
+      "SELECT `name` FROM `sqlite_master` WHERE `type` = 'table' AND "
+      "`name` NOT LIKE 'sqlite_%' ORDER BY `name`;",
+      &names)));
+  tables->clear();
+  for (const RecordSet::Record& record : names.records()) {
+    SqliteTable table;
+    table.name = record.values(0);
+    RecordSet columns;
+    TF_RETURN_IF_ERROR(FromABSLStatus(source->ExecuteQuery(
+        absl::StrCat("PRAGMA table_info(`", table.name, "`);"), &columns)));
+    // The rows of table_info are (cid, name, type, notnull, dflt_value, pk).
+    for (const RecordSet::Record& column : columns.records()) {
+      table.columns.push_back(column.values(1));
+      table.is_blob.push_back(
+          absl::AsciiStrToUpper(column.values(2)).find("BLOB") !=
+          std::string::npos);
+    }
+    tables->push_back(std::move(table));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Copies the rows of `table` from `source` to `destination`, which has no
+// rows of it anymore, in batches of `max_chunk_size` rows. The rows keep
+// their ids, so that the snapshot reads like the source.
+tensorflow::Status CopyTable(const SqliteTable& table,
+                             const int max_chunk_size, MetadataSource* source,
+                             MetadataSource* destination, int64* num_rows) {
+  TF_RETURN_IF_ERROR(FromABSLStatus(destination->ExecuteQuery(
+      absl::StrCat("DELETE FROM `", table.name, "`;"), nullptr)));
+  const std::string select_query =
+      absl::StrCat("SELECT ", absl::StrJoin(table.columns, ", "), " FROM ",
+                   table.name, ";");
+  const std::string insert_query = absl::StrCat(
+      "INSERT INTO `", table.name, "` (`",
+      absl::StrJoin(table.columns, "`, `"), "`) VALUES (",
+      absl::StrJoin(std::vector<std::string>(table.columns.size(), "?"), ", "),
+      ");");
+  *num_rows = 0;
+  std::vector<PreparedStatementValue> values(table.columns.size());
+  return FromABSLStatus(source->ExecuteStreamingQuery(
+      select_query, max_chunk_size,
+      [&](const TypedRecordSet& batch) -> absl::Status {
+        for (int row = 0; row < batch.num_rows(); ++row) {
+          for (int column = 0; column < batch.num_columns(); ++column) {
+            switch (batch.cell_type(row, column)) {
+              case TypedRecordSet::CellType::kNull:
+                values[column] = absl::monostate();
+                break;
+              case TypedRecordSet::CellType::kInt64: {
+                int64 value;
+                batch.GetInt64(row, column, &value);
+                values[column] = value;
+                break;
+              }
+              case TypedRecordSet::CellType::kDouble: {
+                double value;
+                batch.GetDouble(row, column, &value);
+                values[column] = value;
+                break;
+              }
+              case TypedRecordSet::CellType::kString: {
+                const absl::string_view value = batch.GetString(row, column);
+                if (table.is_blob[column]) {
+                  values[column] = PreparedStatementBytes{std::string(value)};
+                } else {
+                  values[column] = std::string(value);
+                }
+                break;
+              }
+            }
+          }
+          MLMD_RETURN_IF_ERROR(destination->ExecutePreparedQuery(
+              insert_query, values, static_cast<TypedRecordSet*>(nullptr)));
+        }
+        *num_rows += batch.num_rows();
+        return absl::OkStatus();
+      }));
+}
+
+// Copies the tables of the store of `config` to the SQLite database of
+// `build_config`, whose schema has already been created, in one snapshot read
+// of the store.
+tensorflow::Status CopyTables(const ConnectionConfig& config,
+                              const SqliteMetadataSourceConfig& build_config,
+                              const int max_chunk_size,
+                              TableManifest* manifest) {
+  std::unique_ptr<MetadataSource> source;
+  TF_RETURN_IF_ERROR(CreateMetadataSource(config, &source));
+  TF_RETURN_IF_ERROR(FromABSLStatus(source->Connect()));
+  SqliteMetadataSource destination(build_config);
+  TF_RETURN_IF_ERROR(FromABSLStatus(destination.Connect()));
+  TF_RETURN_IF_ERROR(FromABSLStatus(destination.Begin()));
+  tensorflow::Status status =
+      FromABSLStatus(source->Begin(TransactionMode::kSnapshotRead));
+  if (!status.ok()) {
+    destination.Rollback().IgnoreError();
+    return status;
+  }
+  std::vector<SqliteTable> tables;
+  status = ListSqliteTables(&destination, &tables);
+  for (const SqliteTable& table : tables) {
+    if (!status.ok()) break;
+    int64 num_rows;
+    status = CopyTable(table, max_chunk_size, source.get(), &destination,
+                       &num_rows);
+    TableFile* file = manifest->add_files();
+    file->set_table(table.name);
+    file->set_num_rows(num_rows);
+  }
+  source->Rollback().IgnoreError();
+  if (!status.ok()) {
+    destination.Rollback().IgnoreError();
+    return status;
+  }
+  return FromABSLStatus(destination.Commit());
+}
+
+}  // namespace
+
+tensorflow::Status ExportSnapshot(const ConnectionConfig& config,
+                                  const std::string& snapshot_dir,
+                                  const SnapshotOptions& options,
+                                  SnapshotManifest* manifest) {
+  if (options.id_range_size <= 0 || options.max_chunk_size <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "id_range_size and max_chunk_size must be positive.");
+  }
+  manifest->Clear();
+  TF_RETURN_IF_ERROR(
+      tensorflow::Env::Default()->RecursivelyCreateDir(snapshot_dir));
+  std::unique_ptr<MetadataStore> store;
+  TF_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+
+  SnapshotChunk types;
+  GetArtifactTypesResponse artifact_types;
+  TF_RETURN_IF_ERROR(
+      store->GetArtifactTypes(GetArtifactTypesRequest(), &artifact_types));
+  types.mutable_artifact_types()->Swap(
+      artifact_types.mutable_artifact_types());
+  GetExecutionTypesResponse execution_types;
+  TF_RETURN_IF_ERROR(
+      store->GetExecutionTypes(GetExecutionTypesRequest(), &execution_types));
+  types.mutable_execution_types()->Swap(
+      execution_types.mutable_execution_types());
+  GetContextTypesResponse context_types;
+  TF_RETURN_IF_ERROR(
+      store->GetContextTypes(GetContextTypesRequest(), &context_types));
+  types.mutable_context_types()->Swap(context_types.mutable_context_types());
+  ChunkFileWriter types_writer(absl::StrCat(snapshot_dir, "/", kTypesFileName));
+  TF_RETURN_IF_ERROR(types_writer.Write(types));
+  TF_RETURN_IF_ERROR(types_writer.Close());
+  manifest->add_type_files(kTypesFileName);
+  AddCounts(types, manifest);
+
+  std::vector<ExportTask> tasks;
+  TF_RETURN_IF_ERROR(
+      ListExportTasks(store.get(), options.id_range_size, &tasks));
+  store.reset();
+
+  absl::Mutex mutex;
+  std::vector<bool> node_file_written(tasks.size());
+  std::vector<bool> edge_file_written(tasks.size());
+  TF_RETURN_IF_ERROR(RunInParallel(
+      config, options.num_threads, tasks.size(),
+      [&](const int64 index, MetadataStore* worker_store)
+          -> tensorflow::Status {
+        const ExportTask& task = tasks[index];
+        ChunkFileWriter node_writer(
+            absl::StrCat(snapshot_dir, "/", task.node_file));
+        ChunkFileWriter edge_writer(
+            absl::StrCat(snapshot_dir, "/", task.edge_file));
+        for (int64 first_id = task.begin_id; first_id < task.end_id;
+             first_id += options.max_chunk_size) {
+          SnapshotChunk node_chunk;
+          SnapshotChunk edge_chunk;
+          TF_RETURN_IF_ERROR(ExportNodeChunk(
+              task.kind, first_id,
+              std::min(first_id + options.max_chunk_size, task.end_id),
+              worker_store, &node_chunk, &edge_chunk));
+          if (node_chunk.ByteSizeLong() > 0) {
+            TF_RETURN_IF_ERROR(node_writer.Write(node_chunk));
+          }
+          if (edge_chunk.ByteSizeLong() > 0) {
+            TF_RETURN_IF_ERROR(edge_writer.Write(edge_chunk));
+          }
+          absl::MutexLock lock(&mutex);
+          AddCounts(node_chunk, manifest);
+          AddCounts(edge_chunk, manifest);
+        }
+        TF_RETURN_IF_ERROR(node_writer.Close());
+        TF_RETURN_IF_ERROR(edge_writer.Close());
+        absl::MutexLock lock(&mutex);
+        node_file_written[index] = node_writer.written();
+        edge_file_written[index] = edge_writer.written();
+        return tensorflow::Status::OK();
+      }));
+  for (int i = 0; i < tasks.size(); ++i) {
+    if (node_file_written[i]) {
+      manifest->add_node_files(tasks[i].node_file);
+    }
+    if (edge_file_written[i]) {
+      manifest->add_edge_files(tasks[i].edge_file);
+    }
+  }
+  return tensorflow::WriteTextProto(
+      tensorflow::Env::Default(),
+      absl::StrCat(snapshot_dir, "/", kManifestFileName), *manifest);
+}
+
+tensorflow::Status ExportTables(const ConnectionConfig& config,
+                                const std::string& export_dir,
+                                const SnapshotOptions& options,
+                                TableManifest* manifest) {
+  if (options.id_range_size <= 0 || options.max_chunk_size <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "id_range_size and max_chunk_size must be positive.");
+  }
+  manifest->Clear();
+  TF_RETURN_IF_ERROR(
+      tensorflow::Env::Default()->RecursivelyCreateDir(export_dir));
+  std::unique_ptr<MetadataStore> store;
+  TF_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+
+  SnapshotChunk types;
+  GetArtifactTypesResponse artifact_types;
+  TF_RETURN_IF_ERROR(
+      store->GetArtifactTypes(GetArtifactTypesRequest(), &artifact_types));
+  types.mutable_artifact_types()->Swap(
+      artifact_types.mutable_artifact_types());
+  GetExecutionTypesResponse execution_types;
+  TF_RETURN_IF_ERROR(
+      store->GetExecutionTypes(GetExecutionTypesRequest(), &execution_types));
+  types.mutable_execution_types()->Swap(
+      execution_types.mutable_execution_types());
+  GetContextTypesResponse context_types;
+  TF_RETURN_IF_ERROR(
+      store->GetContextTypes(GetContextTypesRequest(), &context_types));
+  types.mutable_context_types()->Swap(context_types.mutable_context_types());
+  std::vector<TableFile> files;
+  TableWriters type_writers(export_dir, ".csv");
+  TF_RETURN_IF_ERROR(WriteTableRows(types, &type_writers));
+  TF_RETURN_IF_ERROR(type_writers.Close(&files));
+
+  std::vector<ExportTask> tasks;
+  TF_RETURN_IF_ERROR(
+      ListExportTasks(store.get(), options.id_range_size, &tasks));
+  store.reset();
+
+  absl::Mutex mutex;
+  TF_RETURN_IF_ERROR(RunInParallel(
+      config, options.num_threads, tasks.size(),
+      [&](const int64 index, MetadataStore* worker_store)
+          -> tensorflow::Status {
+        const ExportTask& task = tasks[index];
+        TableWriters writers(export_dir, absl::StrFormat("-%05d.csv", index));
+        for (int64 first_id = task.begin_id; first_id < task.end_id;
+             first_id += options.max_chunk_size) {
+          SnapshotChunk node_chunk;
+          SnapshotChunk edge_chunk;
+          TF_RETURN_IF_ERROR(ExportNodeChunk(
+              task.kind, first_id,
+              std::min(first_id + options.max_chunk_size, task.end_id),
+              worker_store, &node_chunk, &edge_chunk));
+          TF_RETURN_IF_ERROR(WriteTableRows(node_chunk, &writers));
+          TF_RETURN_IF_ERROR(WriteTableRows(edge_chunk, &writers));
+        }
+        std::vector<TableFile> task_files;
+        TF_RETURN_IF_ERROR(writers.Close(&task_files));
+        absl::MutexLock lock(&mutex);
+        absl::c_move(task_files, std::back_inserter(files));
+        return tensorflow::Status::OK();
+      }));
+  absl::c_sort(files, [](const TableFile& a, const TableFile& b) {
+    return a.file() < b.file();
+  });
+  absl::c_move(files, google::protobuf::RepeatedPtrFieldBackInserter(
+                          manifest->mutable_files()));
+  return tensorflow::WriteTextProto(
+      tensorflow::Env::Default(),
+      absl::StrCat(export_dir, "/", kTableManifestFileName), *manifest);
+}
+
+tensorflow::Status ImportSnapshot(const std::string& snapshot_dir,
+                                  const ConnectionConfig& config,
+                                  const SnapshotOptions& options,
+                                  SnapshotManifest* imported) {
+  const std::string manifest_path =
+      absl::StrCat(snapshot_dir, "/", kManifestFileName);
+  TF_RETURN_IF_ERROR(tensorflow::Env::Default()->FileExists(manifest_path));
+  SnapshotManifest manifest;
+  TF_RETURN_IF_ERROR(tensorflow::ReadTextProto(tensorflow::Env::Default(),
+                                               manifest_path, &manifest));
+  imported->Clear();
+  std::unique_ptr<MetadataStore> store;
+  TF_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+  IdMaps id_maps;
+  TF_RETURN_IF_ERROR(
+      ImportTypes(snapshot_dir, manifest, store.get(), &id_maps, imported));
+
+  if (!options.keep_secondary_indices) {
+    TF_RETURN_IF_ERROR(store->DropSecondaryIndices());
+  }
+  tensorflow::Status status = ImportFiles(
+      snapshot_dir, manifest.node_files(), config, options,
+      [&id_maps](const SnapshotChunk& chunk, MetadataStore* worker_store) {
+        return ImportNodeChunk(chunk, worker_store, &id_maps);
+      },
+      imported);
+  if (status.ok()) {
+    status = ImportFiles(
+        snapshot_dir, manifest.edge_files(), config, options,
+        [&id_maps](const SnapshotChunk& chunk, MetadataStore* worker_store) {
+          return ImportEdgeChunk(chunk, worker_store, id_maps);
+        },
+        imported);
+  }
+  if (!options.keep_secondary_indices) {
+    status.Update(store->CreateSecondaryIndices());
+  }
+  return status;
+}
+
+tensorflow::Status ExportSqliteSnapshot(const ConnectionConfig& config,
+                                        const std::string& sqlite_path,
+                                        const SnapshotOptions& options,
+                                        TableManifest* manifest) {
+  if (options.max_chunk_size <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "max_chunk_size must be positive.");
+  }
+  manifest->Clear();
+  // Checks that the store exists and has the schema of the library.
+  std::unique_ptr<MetadataStore> store;
+  TF_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+  store.reset();
+
+  // The snapshot is built in a temporary file without a journal, since a
+  // failed build is discarded, and moved to `sqlite_path` once it is done.
+  const std::string build_path = absl::StrCat(sqlite_path, ".tmp");
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (env->FileExists(build_path).ok()) {
+    TF_RETURN_IF_ERROR(env->DeleteFile(build_path));
+  }
+  ConnectionConfig build_config;
+  SqliteMetadataSourceConfig* sqlite_config = build_config.mutable_sqlite();
+  sqlite_config->set_filename_uri(build_path);
+  sqlite_config->set_connection_mode(
+      SqliteMetadataSourceConfig::READWRITE_OPENCREATE);
+  sqlite_config->set_journal_mode(
+      SqliteMetadataSourceConfig::JOURNAL_MODE_OFF);
+  sqlite_config->set_synchronous(SqliteMetadataSourceConfig::SYNCHRONOUS_OFF);
+  // The optional tables of the store are created in the snapshot as well.
+  build_config.set_inline_event_paths(config.inline_event_paths());
+  build_config.set_inline_node_properties(config.inline_node_properties());
+  build_config.set_enable_lineage_closure(config.enable_lineage_closure());
+  TF_RETURN_IF_ERROR(CreateMetadataStore(build_config, &store));
+  TF_RETURN_IF_ERROR(store->DropSecondaryIndices());
+  store.reset();
+
+  TF_RETURN_IF_ERROR(
+      CopyTables(config, *sqlite_config, options.max_chunk_size, manifest));
+  TF_RETURN_IF_ERROR(CreateMetadataStore(build_config, &store));
+  TF_RETURN_IF_ERROR(store->CreateSecondaryIndices());
+  store.reset();
+
+  // Gathers the statistics of the query planner, and packs the pages of the
+  // file, so that the workers read them in order.
+  SqliteMetadataSource source(*sqlite_config);
+  TF_RETURN_IF_ERROR(FromABSLStatus(source.Connect()));
+  TF_RETURN_IF_ERROR(
+      FromABSLStatus(source.Begin(TransactionMode::kAutocommit)));
+  TF_RETURN_IF_ERROR(FromABSLStatus(source.ExecuteQuery("ANALYZE;", nullptr)));
+  TF_RETURN_IF_ERROR(FromABSLStatus(source.ExecuteQuery("VACUUM;", nullptr)));
+  TF_RETURN_IF_ERROR(FromABSLStatus(source.Commit()));
+  TF_RETURN_IF_ERROR(FromABSLStatus(source.Close()));
+  for (TableFile& file : *manifest->mutable_files()) {
+    file.set_file(sqlite_path);
+  }
+  return env->RenameFile(build_path, sqlite_path);
+}
+
+ConnectionConfig SqliteSnapshotConnectionConfig(
+    const std::string& sqlite_path) {
+  ConnectionConfig config;
+  SqliteMetadataSourceConfig* sqlite_config = config.mutable_sqlite();
+  sqlite_config->set_filename_uri(sqlite_path);
+  sqlite_config->set_connection_mode(SqliteMetadataSourceConfig::READONLY);
+  sqlite_config->set_immutable(true);
+  sqlite_config->set_mmap_size(kSqliteSnapshotMmapSize);
+  // The file never changes, so the reads need no transaction to agree.
+  config.set_read_transaction_mode(ConnectionConfig::AUTOCOMMIT);
+  return config;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,125 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_TOOLS_MLMD_SNAPSHOT_SNAPSHOT_H_
+#define ML_METADATA_TOOLS_MLMD_SNAPSHOT_SNAPSHOT_H_
+
+#include <string>
+
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/tools/mlmd_snapshot/proto/mlmd_snapshot.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The options of ExportSnapshot and ImportSnapshot.
+struct SnapshotOptions {
+  // The number of threads, each with its own connection to the store.
+  int num_threads = 8;
+
+  // The number of ids of the nodes of a snapshot file. The files are exported
+  // and imported by the threads in parallel.
+  int64 id_range_size = 100000;
+
+  // The max number of records of a chunk of a snapshot file, which are read or
+  // written with one request.
+  int max_chunk_size = 1000;
+
+  // If set, the import keeps the secondary indices of the store, instead of
+  // dropping them and rebuilding them once the records are imported.
+  bool keep_secondary_indices = false;
+};
+
+// Exports the types, nodes and edges of the store of `config` to a snapshot
+// in `snapshot_dir`, which is created if it does not exist. The nodes of each
+// kind are read in ranges of ids by the threads in parallel, along with the
+// events of the executions and the attributions, associations and parent
+// contexts of the contexts. As the ranges are read in separate transactions,
+// the store should not be written meanwhile.
+// If the return value is ok, `manifest` is populated with the files and the
+// number of records of the snapshot, which is also written to the directory.
+// Returns detailed INTERNAL error, if the store cannot be read or the files
+//   cannot be written.
+tensorflow::Status ExportSnapshot(const ConnectionConfig& config,
+                                  const std::string& snapshot_dir,
+                                  const SnapshotOptions& options,
+                                  SnapshotManifest* manifest);
+
+// Imports the snapshot in `snapshot_dir` into the store of `config`, which is
+// initialized if needed. The types are upserted first, then the nodes and then
+// the edges, each with the batched Put* calls of the threads in parallel. The
+// imported nodes get ids of the target store, and their create and update
+// times are the import time. The secondary indices of the store are dropped
+// during the import unless `keep_secondary_indices` is set, and rebuilt even
+// if the import fails.
+// The ids of the snapshot are mapped to the new ids in memory, so the import
+// takes a few tens of bytes per node.
+// If the return value is ok, `imported` is populated with the number of
+// imported records.
+// Returns NOT_FOUND error, if the manifest of the snapshot is not found.
+// Returns DATA_LOSS error, if a file of the snapshot is corrupted, or a record
+//   refers to a type or a node that is not in the snapshot.
+// Returns detailed error, if a Put* call fails, e.g., ALREADY_EXISTS if the
+//   store has a node of the same type and name.
+tensorflow::Status ImportSnapshot(const std::string& snapshot_dir,
+                                  const ConnectionConfig& config,
+                                  const SnapshotOptions& options,
+                                  SnapshotManifest* imported);
+
+// Exports the types, nodes, properties and edges of the store of `config` as
+// CSV tables with a header row, for bulk loads into an analytics warehouse,
+// to `export_dir`, which is created if it does not exist. The nodes are read
+// in ranges of ids by the threads in parallel like ExportSnapshot, and each
+// range is written to its own file of each table as its chunks are read, so
+// that the export only holds a chunk per thread in memory. The columns are
+// flat and typed, e.g., the properties are a table of (node_kind, node_id,
+// name, is_custom_property) with a column per kind of value, and the values
+// which are not set are empty.
+// If the return value is ok, `manifest` is populated with the files and the
+// number of rows of each table, which is also written to the directory.
+// Returns detailed INTERNAL error, if the store cannot be read or the files
+//   cannot be written.
+tensorflow::Status ExportTables(const ConnectionConfig& config,
+                                const std::string& export_dir,
+                                const SnapshotOptions& options,
+                                TableManifest* manifest);
+
+// Exports the store of `config` to a read-only SQLite database at
+// `sqlite_path`, e.g., to ship the metadata to edge workers which only read
+// it. Unlike ExportSnapshot, the rows of the tables of the store are copied as
+// they are in one snapshot read, so that the nodes keep their ids and times.
+// The database is built in `sqlite_path` + ".tmp" with the secondary indices
+// dropped, which are rebuilt once the rows are copied, then analyzed and
+// vacuumed, and moved to `sqlite_path`, so that a worker never sees a partial
+// snapshot. The rows are read in chunks of `max_chunk_size` rows.
+// If the return value is ok, `manifest` is populated with the number of rows
+// of each table of the snapshot.
+// Returns detailed error, if the store cannot be read, e.g.,
+//   FAILED_PRECONDITION if its schema is not the one of the library, or if
+//   the snapshot cannot be written.
+tensorflow::Status ExportSqliteSnapshot(const ConnectionConfig& config,
+                                        const std::string& sqlite_path,
+                                        const SnapshotOptions& options,
+                                        TableManifest* manifest);
+
+// Returns the config of a store reading the SQLite snapshot at `sqlite_path`,
+// which is opened immutable with memory-mapped I/O, so that the reads take no
+// file locks and are served from the page cache of the OS, which is shared by
+// the workers of a host. The snapshot must not be written while it is open.
+ConnectionConfig SqliteSnapshotConnectionConfig(const std::string& sqlite_path);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_TOOLS_MLMD_SNAPSHOT_SNAPSHOT_H_
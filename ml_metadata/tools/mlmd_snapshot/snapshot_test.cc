@@ -0,0 +1,444 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/tools/mlmd_snapshot/snapshot.h"
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+ConnectionConfig SqliteConnectionConfig(const std::string& file_name) {
+  ConnectionConfig config;
+  config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), file_name));
+  return config;
+}
+
+// Returns the number of secondary indices of the SQLite database of `config`.
+int64 GetNumSecondaryIndices(const ConnectionConfig& config) {
+  SqliteMetadataSource metadata_source(config.sqlite());
+  CHECK_EQ(absl::OkStatus(), metadata_source.Connect());
+  CHECK_EQ(absl::OkStatus(), metadata_source.Begin());
+  RecordSet record_set;
+  CHECK_EQ(absl::OkStatus(),
+           metadata_source.ExecuteQuery(
+               "SELECT count(*) FROM `sqlite_master` WHERE `type` = 'index' "
+               "AND `name` LIKE 'idx_%';",
+               &record_set));
+  CHECK_EQ(absl::OkStatus(), metadata_source.Commit());
+  return std::stoll(record_set.records(0).values(0));
+}
+
+// Returns the names of `nodes`.
+template <typename Node>
+std::vector<std::string> GetNames(
+    const google::protobuf::RepeatedPtrField<Node>& nodes) {
+  std::vector<std::string> names;
+  for (const Node& node : nodes) {
+    names.push_back(node.name());
+  }
+  return names;
+}
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    source_config_ = SqliteConnectionConfig("snapshot_source.db");
+    target_config_ = SqliteConnectionConfig("snapshot_target.db");
+    snapshot_dir_ = absl::StrCat(::testing::TempDir(), "snapshot");
+    TF_ASSERT_OK(CreateMetadataStore(source_config_, &source_));
+    TF_ASSERT_OK(CreateMetadataStore(target_config_, &target_));
+  }
+
+  void TearDown() override {
+    source_.reset();
+    target_.reset();
+    std::remove(source_config_.sqlite().filename_uri().c_str());
+    std::remove(target_config_.sqlite().filename_uri().c_str());
+  }
+
+  // Fills the source store with a small lineage graph:
+  // a0, a1 -> e0 -> a2 -> e1 -> a3, and a4 without events. The contexts c0
+  // and c1 have the attributions and associations, and c0 is the parent of
+  // c1.
+  void FillSourceStore() {
+    PutTypesRequest put_types_request = ParseTextProtoOrDie<PutTypesRequest>(
+        R"(
+          artifact_types: {
+            name: 'dataset'
+            properties { key: 'split' value: STRING }
+          }
+          execution_types: { name: 'trainer' }
+          context_types: { name: 'pipeline' }
+        )");
+    PutTypesResponse put_types_response;
+    TF_ASSERT_OK(source_->PutTypes(put_types_request, &put_types_response));
+
+    PutArtifactsRequest put_artifacts_request;
+    for (int i = 0; i < 5; ++i) {
+      Artifact* artifact = put_artifacts_request.add_artifacts();
+      artifact->set_type_id(put_types_response.artifact_type_ids(0));
+      artifact->set_name(absl::StrCat("a", i));
+      artifact->set_uri(absl::StrCat("gs://bucket/a", i));
+      (*artifact->mutable_properties())["split"].set_string_value("train");
+    }
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(
+        source_->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+    const auto& artifact_ids = put_artifacts_response.artifact_ids();
+
+    PutExecutionsRequest put_executions_request;
+    for (int i = 0; i < 3; ++i) {
+      Execution* execution = put_executions_request.add_executions();
+      execution->set_type_id(put_types_response.execution_type_ids(0));
+      execution->set_name(absl::StrCat("e", i));
+    }
+    PutExecutionsResponse put_executions_response;
+    TF_ASSERT_OK(source_->PutExecutions(put_executions_request,
+                                        &put_executions_response));
+    const auto& execution_ids = put_executions_response.execution_ids();
+
+    PutContextsRequest put_contexts_request;
+    for (int i = 0; i < 3; ++i) {
+      Context* context = put_contexts_request.add_contexts();
+      context->set_type_id(put_types_response.context_type_ids(0));
+      context->set_name(absl::StrCat("c", i));
+    }
+    PutContextsResponse put_contexts_response;
+    TF_ASSERT_OK(
+        source_->PutContexts(put_contexts_request, &put_contexts_response));
+    const auto& context_ids = put_contexts_response.context_ids();
+
+    PutEventsRequest put_events_request;
+    const auto add_event = [&](int64 artifact_id, int64 execution_id,
+                               Event::Type type) {
+      Event* event = put_events_request.add_events();
+      event->set_artifact_id(artifact_id);
+      event->set_execution_id(execution_id);
+      event->set_type(type);
+      event->mutable_path()->add_steps()->set_key("examples");
+    };
+    add_event(artifact_ids[0], execution_ids[0], Event::INPUT);
+    add_event(artifact_ids[1], execution_ids[0], Event::INPUT);
+    add_event(artifact_ids[2], execution_ids[0], Event::OUTPUT);
+    add_event(artifact_ids[2], execution_ids[1], Event::INPUT);
+    add_event(artifact_ids[3], execution_ids[1], Event::OUTPUT);
+    PutEventsResponse put_events_response;
+    TF_ASSERT_OK(source_->PutEvents(put_events_request, &put_events_response));
+
+    PutAttributionsAndAssociationsRequest put_edges_request;
+    Attribution* attribution = put_edges_request.add_attributions();
+    attribution->set_context_id(context_ids[0]);
+    attribution->set_artifact_id(artifact_ids[0]);
+    attribution = put_edges_request.add_attributions();
+    attribution->set_context_id(context_ids[1]);
+    attribution->set_artifact_id(artifact_ids[3]);
+    Association* association = put_edges_request.add_associations();
+    association->set_context_id(context_ids[0]);
+    association->set_execution_id(execution_ids[0]);
+    association = put_edges_request.add_associations();
+    association->set_context_id(context_ids[1]);
+    association->set_execution_id(execution_ids[1]);
+    PutAttributionsAndAssociationsResponse put_edges_response;
+    TF_ASSERT_OK(source_->PutAttributionsAndAssociations(put_edges_request,
+                                                         &put_edges_response));
+
+    PutParentContextsRequest put_parent_contexts_request;
+    ParentContext* parent_context =
+        put_parent_contexts_request.add_parent_contexts();
+    parent_context->set_child_id(context_ids[1]);
+    parent_context->set_parent_id(context_ids[0]);
+    PutParentContextsResponse put_parent_contexts_response;
+    TF_ASSERT_OK(source_->PutParentContexts(put_parent_contexts_request,
+                                            &put_parent_contexts_response));
+  }
+
+  // Returns the node of the type `type_name` named `name` in the target store.
+  template <typename Node>
+  Node GetTargetNode(const std::string& type_name, const std::string& name);
+
+  ConnectionConfig source_config_;
+  ConnectionConfig target_config_;
+  std::string snapshot_dir_;
+  std::unique_ptr<MetadataStore> source_;
+  std::unique_ptr<MetadataStore> target_;
+};
+
+template <>
+Artifact SnapshotTest::GetTargetNode<Artifact>(const std::string& type_name,
+                                               const std::string& name) {
+  GetArtifactByTypeAndNameRequest request;
+  request.set_type_name(type_name);
+  request.set_artifact_name(name);
+  GetArtifactByTypeAndNameResponse response;
+  TF_CHECK_OK(target_->GetArtifactByTypeAndName(request, &response));
+  return response.artifact();
+}
+
+template <>
+Execution SnapshotTest::GetTargetNode<Execution>(const std::string& type_name,
+                                                 const std::string& name) {
+  GetExecutionByTypeAndNameRequest request;
+  request.set_type_name(type_name);
+  request.set_execution_name(name);
+  GetExecutionByTypeAndNameResponse response;
+  TF_CHECK_OK(target_->GetExecutionByTypeAndName(request, &response));
+  return response.execution();
+}
+
+template <>
+Context SnapshotTest::GetTargetNode<Context>(const std::string& type_name,
+                                             const std::string& name) {
+  GetContextByTypeAndNameRequest request;
+  request.set_type_name(type_name);
+  request.set_context_name(name);
+  GetContextByTypeAndNameResponse response;
+  TF_CHECK_OK(target_->GetContextByTypeAndName(request, &response));
+  return response.context();
+}
+
+TEST_F(SnapshotTest, ExportAndImport) {
+  FillSourceStore();
+  // The target store has a node already, so the imported nodes get other ids.
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("model");
+  PutArtifactTypeResponse put_type_response;
+  TF_ASSERT_OK(target_->PutArtifactType(put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_type_response.type_id());
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(
+      target_->PutArtifacts(put_artifacts_request, &put_artifacts_response));
+
+  SnapshotOptions options;
+  options.num_threads = 3;
+  options.id_range_size = 2;
+  options.max_chunk_size = 1;
+  SnapshotManifest manifest;
+  TF_ASSERT_OK(ExportSnapshot(source_config_, snapshot_dir_, options,
+                              &manifest));
+  EXPECT_EQ(manifest.num_artifacts(), 5);
+  EXPECT_EQ(manifest.num_executions(), 3);
+  EXPECT_EQ(manifest.num_contexts(), 3);
+  EXPECT_EQ(manifest.num_events(), 5);
+  EXPECT_EQ(manifest.num_attributions(), 2);
+  EXPECT_EQ(manifest.num_associations(), 2);
+  EXPECT_EQ(manifest.num_parent_contexts(), 1);
+  // The files of artifacts 1-2, 3-4 and 5, executions 1-2 and 3, and contexts
+  // 1-2 and 3, of which only executions 1-2 and contexts 1-2 have edges.
+  EXPECT_EQ(manifest.node_files_size(), 7);
+  EXPECT_EQ(manifest.edge_files_size(), 2);
+
+  const int64 num_indices = GetNumSecondaryIndices(target_config_);
+  options.num_threads = 2;
+  SnapshotManifest imported;
+  TF_ASSERT_OK(ImportSnapshot(snapshot_dir_, target_config_, options,
+                              &imported));
+  EXPECT_THAT(imported, EqualsProto(manifest, /*ignore_fields=*/{
+                                                  "type_files", "node_files",
+                                                  "edge_files"}));
+  EXPECT_GT(num_indices, 0);
+  EXPECT_EQ(GetNumSecondaryIndices(target_config_), num_indices);
+
+  const Artifact a2 = GetTargetNode<Artifact>("dataset", "a2");
+  EXPECT_EQ(a2.uri(), "gs://bucket/a2");
+  EXPECT_EQ(a2.properties().at("split").string_value(), "train");
+  const Execution e0 = GetTargetNode<Execution>("trainer", "e0");
+  GetEventsByExecutionIDsRequest events_request;
+  events_request.add_execution_ids(e0.id());
+  GetEventsByExecutionIDsResponse events_response;
+  TF_ASSERT_OK(target_->GetEventsByExecutionIDs(events_request,
+                                                &events_response));
+  std::vector<int64> input_ids;
+  for (const Event& event : events_response.events()) {
+    EXPECT_EQ(event.path().steps(0).key(), "examples");
+    if (event.type() == Event::INPUT) {
+      input_ids.push_back(event.artifact_id());
+    } else {
+      EXPECT_EQ(event.artifact_id(), a2.id());
+    }
+  }
+  EXPECT_THAT(input_ids, UnorderedElementsAre(
+                             GetTargetNode<Artifact>("dataset", "a0").id(),
+                             GetTargetNode<Artifact>("dataset", "a1").id()));
+
+  const Context c1 = GetTargetNode<Context>("pipeline", "c1");
+  GetArtifactsByContextRequest artifacts_request;
+  artifacts_request.set_context_id(c1.id());
+  GetArtifactsByContextResponse artifacts_response;
+  TF_ASSERT_OK(target_->GetArtifactsByContext(artifacts_request,
+                                              &artifacts_response));
+  EXPECT_THAT(GetNames(artifacts_response.artifacts()), ElementsAre("a3"));
+  GetExecutionsByContextRequest executions_request;
+  executions_request.set_context_id(c1.id());
+  GetExecutionsByContextResponse executions_response;
+  TF_ASSERT_OK(target_->GetExecutionsByContext(executions_request,
+                                               &executions_response));
+  EXPECT_THAT(GetNames(executions_response.executions()), ElementsAre("e1"));
+  GetParentContextsByContextRequest parents_request;
+  parents_request.set_context_id(c1.id());
+  GetParentContextsByContextResponse parents_response;
+  TF_ASSERT_OK(target_->GetParentContextsByContext(parents_request,
+                                                   &parents_response));
+  EXPECT_THAT(GetNames(parents_response.contexts()), ElementsAre("c0"));
+}
+
+TEST_F(SnapshotTest, ExportTables) {
+  FillSourceStore();
+  SnapshotOptions options;
+  options.num_threads = 3;
+  options.id_range_size = 2;
+  options.max_chunk_size = 1;
+  TableManifest manifest;
+  TF_ASSERT_OK(ExportTables(source_config_, snapshot_dir_, options,
+                            &manifest));
+  std::map<std::string, int64> num_rows;
+  for (const TableFile& file : manifest.files()) {
+    num_rows[file.table()] += file.num_rows();
+  }
+  EXPECT_THAT(num_rows, ElementsAre(Pair("artifacts", 5),
+                                    Pair("associations", 2),
+                                    Pair("attributions", 2),
+                                    Pair("contexts", 3), Pair("events", 5),
+                                    Pair("executions", 3),
+                                    Pair("parent_contexts", 1),
+                                    Pair("properties", 5),
+                                    Pair("type_properties", 1),
+                                    Pair("types", 3)));
+
+  const auto read_file = [this](const std::string& file) {
+    std::string contents;
+    TF_CHECK_OK(tensorflow::ReadFileToString(
+        tensorflow::Env::Default(), absl::StrCat(snapshot_dir_, "/", file),
+        &contents));
+    return contents;
+  };
+  EXPECT_EQ(read_file("types.csv"),
+            "id,kind,name,version,description\n"
+            "1,artifact,dataset,,\n"
+            "2,execution,trainer,,\n"
+            "3,context,pipeline,,\n");
+  // The artifacts 1-2 are the first range of ids.
+  EXPECT_EQ(read_file("properties-00000.csv"),
+            "node_kind,node_id,name,is_custom_property,int_value,"
+            "double_value,string_value,struct_value\n"
+            "artifact,1,split,false,,,train,\n"
+            "artifact,2,split,false,,,train,\n");
+  // The events of the executions 1-2, the fourth range, have quoted paths.
+  EXPECT_THAT(read_file("events-00003.csv"),
+              HasSubstr("1,1,INPUT,\"{\"\"steps\"\":[{\"\"key\"\":"
+                        "\"\"examples\"\"}]}\","));
+}
+
+TEST_F(SnapshotTest, ExportSqliteSnapshot) {
+  FillSourceStore();
+  const std::string sqlite_path =
+      absl::StrCat(::testing::TempDir(), "snapshot.sqlite");
+  SnapshotOptions options;
+  options.max_chunk_size = 2;
+  TableManifest manifest;
+  TF_ASSERT_OK(
+      ExportSqliteSnapshot(source_config_, sqlite_path, options, &manifest));
+  std::map<std::string, int64> num_rows;
+  for (const TableFile& file : manifest.files()) {
+    num_rows[file.table()] = file.num_rows();
+  }
+  EXPECT_EQ(num_rows["Artifact"], 5);
+  EXPECT_EQ(num_rows["Event"], 5);
+  EXPECT_FALSE(
+      tensorflow::Env::Default()->FileExists(sqlite_path + ".tmp").ok());
+
+  // The snapshot has the same nodes, with the same ids and times.
+  const ConnectionConfig snapshot_config =
+      SqliteSnapshotConnectionConfig(sqlite_path);
+  EXPECT_GT(GetNumSecondaryIndices(snapshot_config), 0);
+  std::unique_ptr<MetadataStore> snapshot;
+  TF_ASSERT_OK(CreateMetadataStore(snapshot_config, &snapshot));
+  GetArtifactsResponse source_artifacts;
+  TF_ASSERT_OK(source_->GetArtifacts({}, &source_artifacts));
+  GetArtifactsResponse snapshot_artifacts;
+  TF_ASSERT_OK(snapshot->GetArtifacts({}, &snapshot_artifacts));
+  EXPECT_THAT(snapshot_artifacts, EqualsProto(source_artifacts));
+  GetEventsByArtifactIDsRequest events_request;
+  events_request.add_artifact_ids(source_artifacts.artifacts(2).id());
+  GetEventsByArtifactIDsResponse source_events;
+  TF_ASSERT_OK(source_->GetEventsByArtifactIDs(events_request, &source_events));
+  GetEventsByArtifactIDsResponse snapshot_events;
+  TF_ASSERT_OK(
+      snapshot->GetEventsByArtifactIDs(events_request, &snapshot_events));
+  EXPECT_THAT(snapshot_events, EqualsProto(source_events));
+
+  // The snapshot is read-only.
+  PutArtifactsRequest put_request;
+  put_request.add_artifacts()->set_type_id(
+      source_artifacts.artifacts(0).type_id());
+  PutArtifactsResponse put_response;
+  EXPECT_FALSE(snapshot->PutArtifacts(put_request, &put_response).ok());
+  snapshot.reset();
+  std::remove(sqlite_path.c_str());
+}
+
+TEST_F(SnapshotTest, ImportTwiceFailsOnDuplicateNames) {
+  FillSourceStore();
+  SnapshotManifest manifest;
+  TF_ASSERT_OK(
+      ExportSnapshot(source_config_, snapshot_dir_, SnapshotOptions(),
+                     &manifest));
+  SnapshotManifest imported;
+  TF_ASSERT_OK(ImportSnapshot(snapshot_dir_, target_config_, SnapshotOptions(),
+                              &imported));
+  const int64 num_indices = GetNumSecondaryIndices(target_config_);
+  EXPECT_EQ(ImportSnapshot(snapshot_dir_, target_config_, SnapshotOptions(),
+                           &imported)
+                .code(),
+            tensorflow::error::ALREADY_EXISTS);
+  // The indices are rebuilt after the failed import.
+  EXPECT_EQ(GetNumSecondaryIndices(target_config_), num_indices);
+}
+
+TEST_F(SnapshotTest, ImportWithoutManifest) {
+  SnapshotManifest imported;
+  EXPECT_EQ(ImportSnapshot(absl::StrCat(::testing::TempDir(), "no_snapshot"),
+                           target_config_, SnapshotOptions(), &imported)
+                .code(),
+            tensorflow::error::NOT_FOUND);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/util/metadata_source_query_config.h"
 
+#include <initializer_list>
+#include <memory>
+#include <string>
+
 #include <glog/logging.h>
 #include "google/protobuf/text_format.h"
 #include "absl/strings/str_cat.h"
@@ -28,7 +32,7 @@ namespace {
 // no-lint to support vc (C2026) 16380 max length for char[].
 const std::string kBaseQueryConfig = absl::StrCat(  // NOLINT
 R"pb(
-  schema_version: 6
+  schema_version: 10
   drop_type_table { query: " DROP TABLE IF EXISTS `Type`; " }
   create_type_table {
     query: " CREATE TABLE IF NOT EXISTS `Type` ( "
@@ -65,6 +69,13 @@ R"pb(
            ") VALUES($0, 2, $1, $2);"
     parameter_num: 3
   }
+  insert_type_with_id {
+    query: " INSERT INTO `Type`( "
+           "   `id`, `type_kind`, `name`, `version`, `description`, "
+           "   `input_type`, `output_type` "
+           ") VALUES($0, $1, $2, $3, $4, $5, $6);"
+    parameter_num: 7
+  }
   select_type_by_id {
     query: " SELECT `id`, `name`, `version`, `description`, "
            "        `input_type`, `output_type` FROM `Type` "
@@ -89,6 +100,18 @@ R"pb(
            " WHERE type_kind = $0; "
     parameter_num: 1
   }
+  select_types_by_names {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE name IN ($0) AND type_kind = $1; "
+    parameter_num: 2
+  }
+  select_types_by_ids {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE id IN ($0) AND type_kind = $1; "
+    parameter_num: 2
+  }
   drop_parent_type_table { query: " DROP TABLE IF EXISTS `ParentType`; " }
   create_parent_type_table {
     query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
@@ -110,6 +133,11 @@ R"pb(
            " FROM `ParentType` WHERE `type_id` = $0; "
     parameter_num: 1
   }
+  select_parent_types_by_type_ids {
+    query: " SELECT `type_id`, `parent_type_id` "
+           " FROM `ParentType` WHERE `type_id` IN ($0); "
+    parameter_num: 1
+  }
   drop_type_property_table { query: " DROP TABLE IF EXISTS `TypeProperty`; " }
   create_type_property_table {
     query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
@@ -134,7 +162,14 @@ R"pb(
            " WHERE `type_id` = $0; "
     parameter_num: 1
   }
+  select_properties_by_type_ids {
+    query: " SELECT `type_id`, `name` as `key`, `data_type` as `value` "
+           " from `TypeProperty` "
+           " WHERE `type_id` IN ($0); "
+    parameter_num: 1
+  }
   select_last_insert_id { query: " SELECT last_insert_rowid(); " }
+  select_num_changed_rows { query: " SELECT changes(); " }
 )pb",
 R"pb(
   drop_artifact_table { query: " DROP TABLE IF EXISTS `Artifact`; " }
@@ -173,6 +208,13 @@ R"pb(
     query: " SELECT `id` from `Artifact` WHERE `type_id` = $0 and `name` = $1; "
     parameter_num: 2
   }
+  select_artifacts_by_type_id_and_names {
+    query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           " from `Artifact` "
+           " WHERE `type_id` = $0 and `name` IN ($1); "
+    parameter_num: 2
+  }
   select_artifacts_by_type_id {
     query: " SELECT `id` from `Artifact` WHERE `type_id` = $0; "
     parameter_num: 1
@@ -181,6 +223,14 @@ R"pb(
     query: " SELECT `id` from `Artifact` WHERE `uri` = $0; "
     parameter_num: 1
   }
+  select_artifacts_by_uri_prefix {
+    query: " SELECT `id` from `Artifact` WHERE `uri` GLOB $0; "
+    parameter_num: 1
+  }
+  select_artifact_ids_by_id {
+    query: " SELECT `id` from `Artifact` WHERE `id` IN ($0); "
+    parameter_num: 1
+  }
   update_artifact {
     query: " UPDATE `Artifact` "
            " SET `type_id` = $1, `uri` = $2, `state` = $3, "
@@ -188,6 +238,13 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 5
   }
+  update_artifact_if_unchanged {
+    query: " UPDATE `Artifact` "
+           " SET `type_id` = $1, `uri` = $2, `state` = $3, "
+           "     `last_update_time_since_epoch` = $4 "
+           " WHERE id = $0 AND `last_update_time_since_epoch` = $5;"
+    parameter_num: 6
+  }
   drop_artifact_property_table {
     query: " DROP TABLE IF EXISTS `ArtifactProperty`; "
   }
@@ -199,11 +256,13 @@ R"pb(
            "   `int_value` INT, "
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
+           "   `byte_value` BLOB, "
            " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
   }
   check_artifact_property_table {
     query: " SELECT `artifact_id`, `name`, `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, "
+           "        `byte_value` "
            " FROM `ArtifactProperty` LIMIT 1; "
   }
   insert_artifact_property {
@@ -215,10 +274,18 @@ R"pb(
   select_artifact_property_by_artifact_id {
     query: " SELECT `artifact_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, $1 "
            " from `ArtifactProperty` "
            " WHERE `artifact_id` IN ($0); "
-    parameter_num: 1
+    parameter_num: 2
+  }
+  select_artifact_property_by_artifact_id_and_name {
+    query: " SELECT `artifact_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, $1 "
+           " from `ArtifactProperty` "
+           " WHERE `artifact_id` IN ($0) AND `name` IN ($2); "
+    parameter_num: 3
   }
   update_artifact_property {
     query: " UPDATE `ArtifactProperty` "
@@ -231,6 +298,33 @@ R"pb(
            " WHERE `artifact_id` = $0 and `name` = $1;"
     parameter_num: 2
   }
+  select_artifact_ids_by_type_id_updated_before {
+    query: " SELECT `id` FROM `Artifact` "
+           " WHERE `type_id` = $0 AND `last_update_time_since_epoch` < $1 "
+           " ORDER BY `last_update_time_since_epoch`, `id` LIMIT $2; "
+    parameter_num: 3
+  }
+  delete_artifacts_by_id {
+    query: " DELETE FROM `Artifact` WHERE `id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_artifacts_properties_by_artifacts_id {
+    query: " DELETE FROM `ArtifactProperty` WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_events_by_artifacts_id {
+    query: " DELETE FROM `Event` WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_event_paths_by_artifacts_id {
+    query: " DELETE FROM `EventPath` WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` WHERE `artifact_id` IN ($0)); "
+    parameter_num: 1
+  }
+  delete_attributions_by_artifacts_id {
+    query: " DELETE FROM `Attribution` WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
 )pb",
 R"pb(
   drop_execution_table { query: " DROP TABLE IF EXISTS `Execution`; " }
@@ -268,6 +362,13 @@ R"pb(
     query: " SELECT `id` from `Execution` WHERE `type_id` = $0 and `name` = $1;"
     parameter_num: 2
   }
+  select_executions_by_type_id_and_names {
+    query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           " from `Execution` "
+           " WHERE `type_id` = $0 and `name` IN ($1); "
+    parameter_num: 2
+  }
   select_executions_by_type_id {
     query: " SELECT `id` from `Execution` WHERE `type_id` = $0; "
     parameter_num: 1
@@ -279,6 +380,13 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 4
   }
+  update_execution_if_unchanged {
+    query: " UPDATE `Execution` "
+           " SET `type_id` = $1, `last_known_state` = $2, "
+           "     `last_update_time_since_epoch` = $3 "
+           " WHERE id = $0 AND `last_update_time_since_epoch` = $4;"
+    parameter_num: 5
+  }
   drop_execution_property_table {
     query: " DROP TABLE IF EXISTS `ExecutionProperty`; "
   }
@@ -290,11 +398,13 @@ R"pb(
            "   `int_value` INT, "
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
+           "   `byte_value` BLOB, "
            " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
   }
   check_execution_property_table {
     query: " SELECT `execution_id`, `name`, `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, "
+           "        `byte_value` "
            " FROM `ExecutionProperty` LIMIT 1; "
   }
   insert_execution_property {
@@ -306,10 +416,18 @@ R"pb(
   select_execution_property_by_execution_id {
     query: " SELECT `execution_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, $1 "
            " from `ExecutionProperty` "
            " WHERE `execution_id` IN ($0); "
-    parameter_num: 1
+    parameter_num: 2
+  }
+  select_execution_property_by_execution_id_and_name {
+    query: " SELECT `execution_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, $1 "
+           " from `ExecutionProperty` "
+           " WHERE `execution_id` IN ($0) AND `name` IN ($2); "
+    parameter_num: 3
   }
   update_execution_property {
     query: " UPDATE `ExecutionProperty` "
@@ -322,6 +440,33 @@ R"pb(
            " WHERE `execution_id` = $0 and `name` = $1;"
     parameter_num: 2
   }
+  select_execution_ids_by_type_id_updated_before {
+    query: " SELECT `id` FROM `Execution` "
+           " WHERE `type_id` = $0 AND `last_update_time_since_epoch` < $1 "
+           " ORDER BY `last_update_time_since_epoch`, `id` LIMIT $2; "
+    parameter_num: 3
+  }
+  delete_executions_by_id {
+    query: " DELETE FROM `Execution` WHERE `id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_executions_properties_by_executions_id {
+    query: " DELETE FROM `ExecutionProperty` WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_events_by_executions_id {
+    query: " DELETE FROM `Event` WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_event_paths_by_executions_id {
+    query: " DELETE FROM `EventPath` WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` WHERE `execution_id` IN ($0)); "
+    parameter_num: 1
+  }
+  delete_associations_by_executions_id {
+    query: " DELETE FROM `Association` WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
 )pb",
 R"pb(
   drop_context_table { query: " DROP TABLE IF EXISTS `Context`; " }
@@ -361,6 +506,23 @@ R"pb(
     query: " SELECT `id` from `Context` WHERE `type_id` = $0 and `name` = $1; "
     parameter_num: 2
   }
+  select_contexts_by_type_id_and_names {
+    query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
+           "        `last_update_time_since_epoch`"
+           " from `Context` WHERE `type_id` = $0 and `name` IN ($1); "
+    parameter_num: 2
+  }
+  insert_context_if_not_exist {
+    query: " INSERT OR IGNORE INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3);"
+    parameter_num: 4
+  }
+  select_existing_context_id {
+    query: " SELECT `id` from `Context` WHERE `type_id` = $0 and `name` = $1; "
+    parameter_num: 2
+  }
   update_context {
     query: " UPDATE `Context` "
            " SET `type_id` = $1, `name` = $2, "
@@ -368,6 +530,13 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 4
   }
+  update_context_if_unchanged {
+    query: " UPDATE `Context` "
+           " SET `type_id` = $1, `name` = $2, "
+           "     `last_update_time_since_epoch` = $3 "
+           " WHERE id = $0 AND `last_update_time_since_epoch` = $4;"
+    parameter_num: 5
+  }
   drop_context_property_table {
     query: " DROP TABLE IF EXISTS `ContextProperty`; "
   }
@@ -379,11 +548,13 @@ R"pb(
            "   `int_value` INT, "
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
+           "   `byte_value` BLOB, "
            " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
   }
   check_context_property_table {
     query: " SELECT `context_id`, `name`, `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, "
+           "        `byte_value` "
            " FROM `ContextProperty` LIMIT 1; "
   }
   insert_context_property {
@@ -395,10 +566,18 @@ R"pb(
   select_context_property_by_context_id {
     query: " SELECT `context_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
-           "        `int_value`, `double_value`, `string_value` "
+           "        `int_value`, `double_value`, `string_value`, $1 "
            " from `ContextProperty` "
            " WHERE `context_id` IN ($0); "
-    parameter_num: 1
+    parameter_num: 2
+  }
+  select_context_property_by_context_id_and_name {
+    query: " SELECT `context_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, $1 "
+           " from `ContextProperty` "
+           " WHERE `context_id` IN ($0) AND `name` IN ($2); "
+    parameter_num: 3
   }
   update_context_property {
     query: " UPDATE `ContextProperty` "
@@ -438,6 +617,37 @@ R"pb(
            " WHERE `parent_context_id` = $0; "
     parameter_num: 1
   }
+  select_ancestor_contexts_by_context_id {
+    query: " WITH RECURSIVE `Ancestor`(`context_id`, `parent_context_id`, "
+           "                           `level`) AS ( "
+           "   SELECT `context_id`, `parent_context_id`, 1 "
+           "   FROM `ParentContext` WHERE `context_id` = $0 "
+           "   UNION "
+           "   SELECT PC.`context_id`, PC.`parent_context_id`, A.`level` + 1 "
+           "   FROM `ParentContext` AS PC "
+           "   JOIN `Ancestor` AS A ON PC.`context_id` = A.`parent_context_id` "
+           "   WHERE A.`level` < $1 "
+           " ) "
+           " SELECT DISTINCT `context_id`, `parent_context_id` "
+           " FROM `Ancestor`; "
+    parameter_num: 2
+  }
+  select_descendant_contexts_by_context_id {
+    query: " WITH RECURSIVE `Descendant`(`context_id`, `parent_context_id`, "
+           "                             `level`) AS ( "
+           "   SELECT `context_id`, `parent_context_id`, 1 "
+           "   FROM `ParentContext` WHERE `parent_context_id` = $0 "
+           "   UNION "
+           "   SELECT PC.`context_id`, PC.`parent_context_id`, D.`level` + 1 "
+           "   FROM `ParentContext` AS PC "
+           "   JOIN `Descendant` AS D "
+           "     ON PC.`parent_context_id` = D.`context_id` "
+           "   WHERE D.`level` < $1 "
+           " ) "
+           " SELECT DISTINCT `context_id`, `parent_context_id` "
+           " FROM `Descendant`; "
+    parameter_num: 2
+  }
 )pb",
 R"pb(
   drop_event_table { query: " DROP TABLE IF EXISTS `Event`; " }
@@ -469,6 +679,13 @@ R"pb(
            " WHERE `artifact_id` IN ($0); "
     parameter_num: 1
   }
+  select_event_by_artifact_ids_and_types {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch` "
+           " from `Event` "
+           " WHERE `artifact_id` IN ($0) AND `type` IN ($1); "
+    parameter_num: 2
+  }
   select_event_by_execution_ids {
     query: " SELECT `id`, `artifact_id`, `execution_id`, "
            "        `type`, `milliseconds_since_epoch` "
@@ -476,6 +693,13 @@ R"pb(
            " WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
+  select_event_by_execution_ids_and_types {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch` "
+           " from `Event` "
+           " WHERE `execution_id` IN ($0) AND `type` IN ($1); "
+    parameter_num: 2
+  }
   drop_event_path_table { query: " DROP TABLE IF EXISTS `EventPath`; " }
   create_event_path_table {
     query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
@@ -501,6 +725,159 @@ R"pb(
            " WHERE `event_id` IN ($0); "
     parameter_num: 1
   }
+  select_event_path_by_artifact_ids {
+    query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
+           " from `EventPath` "
+           " WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` WHERE `artifact_id` IN ($0) "
+           " ); "
+    parameter_num: 1
+  }
+  select_event_path_by_artifact_ids_and_types {
+    query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
+           " from `EventPath` "
+           " WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` "
+           "   WHERE `artifact_id` IN ($0) AND `type` IN ($1) "
+           " ); "
+    parameter_num: 2
+  }
+  select_event_path_by_execution_ids {
+    query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
+           " from `EventPath` "
+           " WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` WHERE `execution_id` IN ($0) "
+           " ); "
+    parameter_num: 1
+  }
+  select_event_path_by_execution_ids_and_types {
+    query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
+           " from `EventPath` "
+           " WHERE `event_id` IN ( "
+           "   SELECT `id` FROM `Event` "
+           "   WHERE `execution_id` IN ($0) AND `type` IN ($1) "
+           " ); "
+    parameter_num: 2
+  }
+  check_event_path_bytes_column {
+    query: " SELECT `path_bytes` FROM `Event` LIMIT 1; "
+  }
+  add_event_path_bytes_column {
+    query: " ALTER TABLE `Event` ADD COLUMN `path_bytes` BLOB; "
+  }
+  insert_event_with_path {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch`, `path_bytes` "
+           ") VALUES($0, $1, $2, $3, $4);"
+    parameter_num: 5
+  }
+  select_event_with_path_by_artifact_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path_bytes` "
+           " from `Event` "
+           " WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_event_with_path_by_artifact_ids_and_types {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path_bytes` "
+           " from `Event` "
+           " WHERE `artifact_id` IN ($0) AND `type` IN ($1); "
+    parameter_num: 2
+  }
+  select_event_with_path_by_execution_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path_bytes` "
+           " from `Event` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_event_with_path_by_execution_ids_and_types {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path_bytes` "
+           " from `Event` "
+           " WHERE `execution_id` IN ($0) AND `type` IN ($1); "
+    parameter_num: 2
+  }
+  select_event_ids_with_path_steps {
+    query: " SELECT DISTINCT `event_id` FROM `EventPath` "
+           " ORDER BY `event_id` LIMIT $0; "
+    parameter_num: 1
+  }
+  update_event_path_bytes {
+    query: " UPDATE `Event` SET `path_bytes` = $1 WHERE `id` = $0; "
+    parameter_num: 2
+  }
+  delete_event_paths_by_event_ids {
+    query: " DELETE FROM `EventPath` WHERE `event_id` IN ($0); "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  check_node_properties_bytes_columns {
+    query: " SELECT (SELECT `properties_bytes` FROM `Artifact` LIMIT 1), "
+           "        (SELECT `properties_bytes` FROM `Execution` LIMIT 1), "
+           "        (SELECT `properties_bytes` FROM `Context` LIMIT 1); "
+  }
+  add_artifact_properties_bytes_column {
+    query: " ALTER TABLE `Artifact` ADD COLUMN `properties_bytes` BLOB; "
+  }
+  add_execution_properties_bytes_column {
+    query: " ALTER TABLE `Execution` ADD COLUMN `properties_bytes` BLOB; "
+  }
+  add_context_properties_bytes_column {
+    query: " ALTER TABLE `Context` ADD COLUMN `properties_bytes` BLOB; "
+  }
+  select_artifact_with_properties_bytes_by_id {
+    query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        `properties_bytes` "
+           " from `Artifact` "
+           " WHERE id IN ($0); "
+    parameter_num: 1
+  }
+  select_execution_with_properties_bytes_by_id {
+    query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        `properties_bytes` "
+           " from `Execution` "
+           " WHERE id IN ($0); "
+    parameter_num: 1
+  }
+  select_context_with_properties_bytes_by_id {
+    query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
+           "        `last_update_time_since_epoch`, `properties_bytes` "
+           " from `Context` WHERE id IN ($0); "
+    parameter_num: 1
+  }
+  update_artifact_properties_bytes {
+    query: " UPDATE `Artifact` SET `properties_bytes` = $1 WHERE `id` = $0; "
+    parameter_num: 2
+  }
+  update_execution_properties_bytes {
+    query: " UPDATE `Execution` SET `properties_bytes` = $1 WHERE `id` = $0; "
+    parameter_num: 2
+  }
+  update_context_properties_bytes {
+    query: " UPDATE `Context` SET `properties_bytes` = $1 WHERE `id` = $0; "
+    parameter_num: 2
+  }
+  select_artifact_ids_without_properties_bytes {
+    query: " SELECT `id` FROM `Artifact` WHERE `properties_bytes` IS NULL "
+           " ORDER BY `id` LIMIT $0; "
+    parameter_num: 1
+  }
+  select_execution_ids_without_properties_bytes {
+    query: " SELECT `id` FROM `Execution` WHERE `properties_bytes` IS NULL "
+           " ORDER BY `id` LIMIT $0; "
+    parameter_num: 1
+  }
+  select_context_ids_without_properties_bytes {
+    query: " SELECT `id` FROM `Context` WHERE `properties_bytes` IS NULL "
+           " ORDER BY `id` LIMIT $0; "
+    parameter_num: 1
+  }
 )pb",
 R"pb(
   drop_association_table { query: " DROP TABLE IF EXISTS `Association`; " }
@@ -522,18 +899,36 @@ R"pb(
            ") VALUES($0, $1);"
     parameter_num: 2
   }
+  insert_or_ignore_association {
+    query: " INSERT OR IGNORE INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
   select_association_by_context_id {
     query: " SELECT `id`, `context_id`, `execution_id` "
            " from `Association` "
            " WHERE `context_id` = $0; "
     parameter_num: 1
   }
+  select_associations_by_context_ids {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
   select_association_by_execution_id {
     query: " SELECT `id`, `context_id`, `execution_id` "
            " from `Association` "
            " WHERE `execution_id` = $0; "
     parameter_num: 1
   }
+  select_associations_by_execution_ids {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
   drop_attribution_table { query: " DROP TABLE IF EXISTS `Attribution`; " }
   create_attribution_table {
     query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
@@ -553,18 +948,72 @@ R"pb(
            ") VALUES($0, $1);"
     parameter_num: 2
   }
+  insert_or_ignore_attribution {
+    query: " INSERT OR IGNORE INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
   select_attribution_by_context_id {
     query: " SELECT `id`, `context_id`, `artifact_id` "
            " from `Attribution` "
            " WHERE `context_id` = $0; "
     parameter_num: 1
   }
+  select_attributions_by_context_ids {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
   select_attribution_by_artifact_id {
     query: " SELECT `id`, `context_id`, `artifact_id` "
            " from `Attribution` "
            " WHERE `artifact_id` = $0; "
     parameter_num: 1
   }
+  select_attributions_by_artifact_ids {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_artifacts_by_context_id {
+    query: " SELECT A.`id`, A.`type_id`, A.`uri`, A.`state`, A.`name`, "
+           "        A.`create_time_since_epoch`, "
+           "        A.`last_update_time_since_epoch` "
+           " from `Artifact` AS A "
+           " JOIN `Attribution` AS AT ON AT.`artifact_id` = A.`id` "
+           " WHERE AT.`context_id` = $0; "
+    parameter_num: 1
+  }
+  select_artifact_property_by_context_id {
+    query: " SELECT P.`artifact_id` as `id`, P.`name` as `key`, "
+           "        P.`is_custom_property`, "
+           "        P.`int_value`, P.`double_value`, P.`string_value`, $1 "
+           " from `ArtifactProperty` AS P "
+           " JOIN `Attribution` AS AT ON AT.`artifact_id` = P.`artifact_id` "
+           " WHERE AT.`context_id` = $0; "
+    parameter_num: 2
+  }
+  select_contexts_by_artifact_id {
+    query: " SELECT C.`id`, C.`type_id`, C.`name`, "
+           "        C.`create_time_since_epoch`, "
+           "        C.`last_update_time_since_epoch` "
+           " from `Context` AS C "
+           " JOIN `Attribution` AS AT ON AT.`context_id` = C.`id` "
+           " WHERE AT.`artifact_id` = $0; "
+    parameter_num: 1
+  }
+  select_context_property_by_artifact_id {
+    query: " SELECT P.`context_id` as `id`, P.`name` as `key`, "
+           "        P.`is_custom_property`, "
+           "        P.`int_value`, P.`double_value`, P.`string_value`, $1 "
+           " from `ContextProperty` AS P "
+           " JOIN `Attribution` AS AT ON AT.`context_id` = P.`context_id` "
+           " WHERE AT.`artifact_id` = $0; "
+    parameter_num: 2
+  }
   drop_mlmd_env_table { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
   create_mlmd_env_table {
     query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
@@ -585,34 +1034,128 @@ R"pb(
            " `Artifact`, `Event`, `Execution`, `Type`, `ArtifactProperty`, "
            " `EventPath`, `ExecutionProperty`, `TypeProperty` LIMIT 1; "
   }
-)pb");
-
-// no-lint to support vc (C2026) 16380 max length for char[].
-const std::string kSQLiteMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
-R"pb(
-  metadata_source_type: SQLITE_METADATA_SOURCE
-  # secondary indices in the current schema.
-  secondary_indices {
-    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_uri` "
-           " ON `Artifact`(`uri`); "
+  create_migration_checkpoint_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDEnvMigration` ( "
+           "   `to_schema_version` INTEGER PRIMARY KEY, "
+           "   `chunked_query_index` INTEGER NOT NULL, "
+           "   `next_id` BIGINT NOT NULL "
+           " ); "
   }
-  secondary_indices {
-    query: " CREATE INDEX IF NOT EXISTS "
-           "   `idx_artifact_create_time_since_epoch` "
-           " ON `Artifact`(`create_time_since_epoch`); "
+  select_migration_checkpoint {
+    query: " SELECT `to_schema_version`, `chunked_query_index`, `next_id` "
+           " FROM `MLMDEnvMigration`; "
   }
-  secondary_indices {
-    query: " CREATE INDEX IF NOT EXISTS "
-           "   `idx_artifact_last_update_time_since_epoch` "
-           " ON `Artifact`(`last_update_time_since_epoch`); "
+  delete_migration_checkpoint { query: " DELETE FROM `MLMDEnvMigration`; " }
+  insert_migration_checkpoint {
+    query: " INSERT INTO `MLMDEnvMigration`( "
+           "   `to_schema_version`, `chunked_query_index`, `next_id` "
+           " ) VALUES($0, $1, $2); "
+    parameter_num: 3
+  }
+  check_idempotency_key_table {
+    query: " SELECT `idempotency_key`, `request_fingerprint`, "
+           "        `create_time_since_epoch`, `response` "
+           " FROM `MLMDIdempotencyKey` LIMIT 1; "
+  }
+  create_idempotency_key_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDIdempotencyKey` ( "
+           "   `idempotency_key` VARCHAR(255) PRIMARY KEY, "
+           "   `request_fingerprint` BIGINT NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL, "
+           "   `response` BLOB "
+           " ); "
+  }
+  select_idempotency_key {
+    query: " SELECT `request_fingerprint`, `create_time_since_epoch`, "
+           "        `response` "
+           " FROM `MLMDIdempotencyKey` WHERE `idempotency_key` = $0; "
+    parameter_num: 1
+  }
+  insert_idempotency_key {
+    query: " INSERT INTO `MLMDIdempotencyKey`( "
+           "   `idempotency_key`, `request_fingerprint`, "
+           "   `create_time_since_epoch`, `response` "
+           " ) VALUES($0, $1, $2, $3); "
+    parameter_num: 4
+  }
+  select_idempotency_keys_created_before {
+    query: " SELECT `idempotency_key` FROM `MLMDIdempotencyKey` "
+           " WHERE `create_time_since_epoch` < $0 LIMIT $1; "
+    parameter_num: 2
+  }
+  delete_idempotency_keys {
+    query: " DELETE FROM `MLMDIdempotencyKey` WHERE `idempotency_key` IN ($0); "
+    parameter_num: 1
+  }
+  check_lineage_closure_table {
+    query: " SELECT `artifact_id`, `direction`, `related_artifact_id` "
+           " FROM `MLMDLineageClosure` LIMIT 1; "
+  }
+  create_lineage_closure_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDLineageClosure` ( "
+           "   `artifact_id` INT NOT NULL, "
+           "   `direction` INT NOT NULL, "
+           "   `related_artifact_id` INT NOT NULL, "
+           "   PRIMARY KEY (`artifact_id`, `direction`, `related_artifact_id`) "
+           " ); "
+  }
+  insert_or_ignore_lineage_closure {
+    query: " INSERT OR IGNORE INTO `MLMDLineageClosure`( "
+           "   `artifact_id`, `direction`, `related_artifact_id` "
+           " ) VALUES($0, $1, $2); "
+    parameter_num: 3
+  }
+  select_lineage_closure {
+    query: " SELECT `artifact_id`, `related_artifact_id` "
+           " FROM `MLMDLineageClosure` "
+           " WHERE `artifact_id` IN ($0) AND `direction` = $1; "
+    parameter_num: 2
+  }
+)pb");
+
+// no-lint to support vc (C2026) 16380 max length for char[].
+const std::string kSQLiteMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: SQLITE_METADATA_SOURCE
+  create_id_list_table {
+    query: " CREATE TEMP TABLE IF NOT EXISTS `IdList` ( "
+           "   `id` INTEGER PRIMARY KEY "
+           " ); "
+  }
+  clear_id_list_table { query: " DELETE FROM `IdList`; " }
+  insert_id_list {
+    query: " INSERT INTO `IdList`(`id`) VALUES($0); "
+    parameter_num: 1
+  }
+  select_id_list { query: " SELECT `id` FROM `IdList` " }
+  # secondary indices in the current schema.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_uri` "
+           " ON `Artifact`(`uri`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_create_time_since_epoch` "
+           " ON `Artifact`(`create_time_since_epoch`); "
   }
   secondary_indices {
-    query: " CREATE INDEX IF NOT EXISTS `idx_event_artifact_id` "
-           " ON `Event`(`artifact_id`); "
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_last_update_time_since_epoch` "
+           " ON `Artifact`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_artifact_id_covering` "
+           " ON `Event`(`artifact_id`, `execution_id`, `type`, "
+           "            `milliseconds_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id_covering` "
+           " ON `Event`(`execution_id`, `artifact_id`, `type`, "
+           "            `milliseconds_since_epoch`); "
   }
   secondary_indices {
-    query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id` "
-           " ON `Event`(`execution_id`); "
+    query: " CREATE INDEX IF NOT EXISTS `idx_eventpath_event_id` "
+           " ON `EventPath`(`event_id`); "
   }
   secondary_indices {
     query: " CREATE INDEX IF NOT EXISTS `idx_parentcontext_parent_context_id` "
@@ -642,6 +1185,146 @@ R"pb(
            "   `idx_context_last_update_time_since_epoch` "
            " ON `Context`(`last_update_time_since_epoch`); "
   }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifactproperty_int_value` "
+           " ON `ArtifactProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifactproperty_string_value` "
+           " ON `ArtifactProperty`(`name`, `string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_executionproperty_int_value` "
+           " ON `ExecutionProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_executionproperty_string_value` "
+           " ON `ExecutionProperty`(`name`, `string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_contextproperty_int_value` "
+           " ON `ContextProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_contextproperty_string_value` "
+           " ON `ContextProperty`(`name`, `string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_create_time` "
+           " ON `Artifact`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_last_update_time` "
+           " ON `Artifact`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_create_time` "
+           " ON `Execution`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_update_time` "
+           " ON `Execution`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_create_time` "
+           " ON `Context`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_last_update_time` "
+           " ON `Context`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  # drops the secondary indices in the current schema.
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_uri`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_event_artifact_id_covering`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_event_execution_id_covering`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_eventpath_event_id`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_parentcontext_parent_context_id`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_type_name`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS "
+           "   `idx_execution_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifactproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifactproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_executionproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_executionproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_contextproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_contextproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_type_id_last_update_time`; "
+  }
 )pb",
 R"pb(
   # downgrade to 0.13.2 (i.e., v0), and drop the MLMDEnv table.
@@ -1455,330 +2138,279 @@ R"pb(
                  "       `name` = 'idx_context_last_update_time_since_epoch';"
         }
       }
-    }
-  }
-)pb");
-
-// Template queries for MySQLMetadataSources.
-// no-lint to support vc (C2026) 16380 max length for char[].
-const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
-R"pb(
-  metadata_source_type: MYSQL_METADATA_SOURCE
-  select_last_insert_id { query: " SELECT last_insert_id(); " }
-  create_type_table {
-    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
-           "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `version` VARCHAR(255), "
-           "   `type_kind` TINYINT(1) NOT NULL, "
-           "   `description` TEXT, "
-           "   `input_type` TEXT, "
-           "   `output_type` TEXT"
-           " ); "
-  }
-  create_artifact_table {
-    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `uri` TEXT, "
-           "   `state` INT, "
-           "   `name` VARCHAR(255), "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_execution_table {
-    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `last_known_state` INT, "
-           "   `name` VARCHAR(255), "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_context_table {
-    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_event_table {
-    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `artifact_id` INT NOT NULL, "
-           "   `execution_id` INT NOT NULL, "
-           "   `type` INT NOT NULL, "
-           "   `milliseconds_since_epoch` BIGINT "
-           " ); "
-  }
-  create_association_table {
-    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `context_id` INT NOT NULL, "
-           "   `execution_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `execution_id`) "
-           " ); "
-  }
-  create_attribution_table {
-    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `context_id` INT NOT NULL, "
-           "   `artifact_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `artifact_id`) "
-           " ); "
-  }
-  # secondary indices in the current schema.
-  secondary_indices {
-    # MySQL does not support arbitrary length string index. Only prefix index
-    # is supported. Max size for 5.6/5.7 is 255 char for utf8 charset.
-    query: " ALTER TABLE `Artifact` "
-          "  ADD INDEX `idx_artifact_uri`(`uri`(255)), "
-          "  ADD INDEX `idx_artifact_create_time_since_epoch` "
-          "             (`create_time_since_epoch`), "
-          "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
-          "             (`last_update_time_since_epoch`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Event` "
-           " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
-           " ADD INDEX `idx_event_execution_id` (`execution_id`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ParentContext` "
-           " ADD INDEX "
-           "   `idx_parentcontext_parent_context_id` (`parent_context_id`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Type` "
-           " ADD INDEX `idx_type_name` (`name`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Execution` "
-          "  ADD INDEX `idx_execution_create_time_since_epoch` "
-          "             (`create_time_since_epoch`), "
-          "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
-          "             (`last_update_time_since_epoch`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Context` "
-          "  ADD INDEX `idx_context_create_time_since_epoch` "
-          "             (`create_time_since_epoch`), "
-          "  ADD INDEX `idx_context_last_update_time_since_epoch` "
-          "             (`last_update_time_since_epoch`); "
-  }
-  # downgrade to 0.13.2 (i.e., v0), and drops the MLMDEnv table.
-  migration_schemes {
-    key: 0
-    value: {
-      # downgrade queries from version 1
-      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
-      # check the tables are deleted properly
+      # downgrade queries from version 7
+      downgrade_queries {
+        query: " DROP INDEX `idx_artifactproperty_int_value`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_artifactproperty_string_value`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_executionproperty_int_value`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_executionproperty_string_value`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_contextproperty_int_value`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_contextproperty_string_value`; "
+      }
+      # verify if the downgrading drops the property value indices
       downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'MLMDEnv'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ArtifactProperty' "
+                 "       AND `name` LIKE 'idx_artifactproperty_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ExecutionProperty' "
+                 "       AND `name` LIKE 'idx_executionproperty_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ContextProperty' "
+                 "       AND `name` LIKE 'idx_contextproperty_%'; "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v7, to support filtering the listed nodes by their property values, we
+  # introduce indices on (`name`, `int_value`) and (`name`, `string_value`) of
+  # the property tables of all nodes.
   migration_schemes {
-    key: 1
+    key: 7
     value: {
       upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
-               "   `schema_version` INTEGER PRIMARY KEY "
-               " ); "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifactproperty_int_value` "
+               " ON `ArtifactProperty`(`name`, `int_value`); "
       }
       upgrade_queries {
-        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifactproperty_string_value` "
+               " ON `ArtifactProperty`(`name`, `string_value`); "
       }
-      # v0.13.2 release
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_executionproperty_int_value` "
+               " ON `ExecutionProperty`(`name`, `int_value`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_executionproperty_string_value` "
+               " ON `ExecutionProperty`(`name`, `string_value`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_contextproperty_int_value` "
+               " ON `ContextProperty`(`name`, `int_value`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_contextproperty_string_value` "
+               " ON `ContextProperty`(`name`, `string_value`); "
+      }
+      # check the expected indices are created properly.
       upgrade_verification {
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
-                 "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
-                 "   `input_type` TEXT, "
-                 "   `output_type` TEXT"
-                 " ); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
-                 "   `type_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `data_type` INT NULL, "
-                 " PRIMARY KEY (`type_id`, `name`)); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL, "
-                 "   `uri` TEXT "
-                 " ); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
-                 "   `artifact_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_custom_property` TINYINT(1) NOT NULL, "
-                 "   `int_value` INT, "
-                 "   `double_value` DOUBLE, "
-                 "   `string_value` TEXT, "
-                 " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ArtifactProperty' "
+                 "       AND `name` = 'idx_artifactproperty_int_value'; "
         }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL "
-                 " ); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ArtifactProperty' "
+                 "       AND `name` = 'idx_artifactproperty_string_value'; "
         }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
-                 "   `execution_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_custom_property` TINYINT(1) NOT NULL, "
-                 "   `int_value` INT, "
-                 "   `double_value` DOUBLE, "
-                 "   `string_value` TEXT, "
-                 " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ExecutionProperty' "
+                 "       AND `name` = 'idx_executionproperty_int_value'; "
         }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Event` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `artifact_id` INT NOT NULL, "
-                 "   `execution_id` INT NOT NULL, "
-                 "   `type` INT NOT NULL, "
-                 "   `milliseconds_since_epoch` BIGINT "
-                 " ); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ExecutionProperty' "
+                 "       AND `name` = 'idx_executionproperty_string_value'; "
         }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
-                 "   `event_id` INT NOT NULL, "
-                 "   `is_index_step` TINYINT(1) NOT NULL, "
-                 "   `step_index` INT, "
-                 "   `step_key` TEXT "
-                 " ); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ContextProperty' "
+                 "       AND `name` = 'idx_contextproperty_int_value'; "
         }
-        # check the new table has 1 row
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'ContextProperty' "
+                 "       AND `name` = 'idx_contextproperty_string_value'; "
         }
       }
-      # downgrade queries from version 2, drop all ContextTypes and rename
-      # the `type_kind` back to `is_artifact_type` column.
-      downgrade_queries { query: " DELETE FROM `Type` WHERE `type_kind` = 2; " }
+      # downgrade queries from version 8
       downgrade_queries {
-        query: " ALTER TABLE `Type` CHANGE COLUMN "
-               " `type_kind` `is_artifact_type` TINYINT(1) NOT NULL; "
+        query: " DROP INDEX `idx_event_artifact_id_covering`; "
       }
-      # check the tables are deleted properly
+      downgrade_queries {
+        query: " DROP INDEX `idx_event_execution_id_covering`; "
+      }
+      downgrade_queries { query: " DROP INDEX `idx_eventpath_event_id`; " }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_artifact_id` "
+               " ON `Event`(`artifact_id`); "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id` "
+               " ON `Event`(`execution_id`); "
+      }
+      # verify if the downgrading restores the Event indices
       downgrade_verification {
-        # populate the `Type` table with context types.
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('execution_type', 0, 'input', 'output'); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('artifact_type', 1, 'input', 'output'); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('context_type', 2, 'input', 'output'); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_artifact_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `Type` "
-                 " WHERE `is_artifact_type` = 2; "
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_execution_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` "
-                 " WHERE `is_artifact_type` = 1 AND `name` = 'artifact_type'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` LIKE 'idx_event_%_covering'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` "
-                 " WHERE `is_artifact_type` = 0 AND `name` = 'execution_type'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'EventPath'; "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v8, to serve the event lookups by artifact and execution ids from the
+  # indices, we replace the Event indices with covering ones, and introduce an
+  # index on EventPath.event_id.
   migration_schemes {
-    key: 2
+    key: 8
     value: {
       upgrade_queries {
-        query: " ALTER TABLE `Type` CHANGE COLUMN "
-               " `is_artifact_type` `type_kind` TINYINT(1) NOT NULL; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_artifact_id_covering` "
+               " ON `Event`(`artifact_id`, `execution_id`, `type`, "
+               "            `milliseconds_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id_covering` "
+               " ON `Event`(`execution_id`, `artifact_id`, `type`, "
+               "            `milliseconds_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_eventpath_event_id` "
+               " ON `EventPath`(`event_id`); "
       }
+      upgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_event_artifact_id`; "
+      }
+      upgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_event_execution_id`; "
+      }
+      # check the expected indices are created properly.
       upgrade_verification {
-        # populate one ArtifactType and one ExecutionType.
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` (`name`, `is_artifact_type`) VALUES "
-                 " ('artifact_type', 1); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `is_artifact_type`, `input_type`, `output_type`) "
-                 " VALUES ('execution_type', 0, 'input', 'output'); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_artifact_id_covering'; "
         }
-        # check after migration, the existing types are the same including id.
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_execution_id_covering'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
-                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'EventPath' "
+                 "       AND `name` = 'idx_eventpath_event_id'; "
         }
-      }
-      # downgrade queries from version 3
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Context`; " }
-      downgrade_queries { query: " DROP TABLE IF EXISTS `ContextProperty`; " }
-      # check the tables are deleted properly
-      downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_artifact_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ContextProperty'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Event' "
+                 "       AND `name` = 'idx_event_execution_id'; "
         }
       }
-    }
-  }
-)pb",
-R"pb(
-  migration_schemes {
-    key: 3
-    value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `type_id` INT NOT NULL, "
+      # downgrade queries from version 9. As SQLite cannot drop a column, the
+      # property tables are rebuilt without `byte_value`, and the struct values
+      # stored as bytes are dropped, since v8 cannot read them.
+      downgrade_queries {
+        query: " CREATE TABLE `ArtifactPropertyTemp` ( "
+               "   `artifact_id` INT NOT NULL, "
                "   `name` VARCHAR(255) NOT NULL, "
-               "   UNIQUE(`type_id`, `name`) "
-               " ); "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
       }
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+      downgrade_queries {
+        query: " INSERT INTO `ArtifactPropertyTemp` "
+               " SELECT `artifact_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value` "
+               " FROM `ArtifactProperty` WHERE `byte_value` IS NULL; "
+      }
+      downgrade_queries { query: " DROP TABLE `ArtifactProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactPropertyTemp` "
+               " RENAME TO `ArtifactProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifactproperty_int_value` "
+               " ON `ArtifactProperty`(`name`, `int_value`); "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifactproperty_string_value` "
+               " ON `ArtifactProperty`(`name`, `string_value`); "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ExecutionPropertyTemp` ( "
+               "   `execution_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ExecutionPropertyTemp` "
+               " SELECT `execution_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value` "
+               " FROM `ExecutionProperty` WHERE `byte_value` IS NULL; "
+      }
+      downgrade_queries { query: " DROP TABLE `ExecutionProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionPropertyTemp` "
+               " RENAME TO `ExecutionProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_executionproperty_int_value` "
+               " ON `ExecutionProperty`(`name`, `int_value`); "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_executionproperty_string_value` "
+               " ON `ExecutionProperty`(`name`, `string_value`); "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ContextPropertyTemp` ( "
                "   `context_id` INT NOT NULL, "
                "   `name` VARCHAR(255) NOT NULL, "
                "   `is_custom_property` TINYINT(1) NOT NULL, "
@@ -1787,548 +2419,2291 @@ R"pb(
                "   `string_value` TEXT, "
                " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
       }
-      upgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `type_id`, `name` FROM `Context` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `context_id`, `name`, `is_custom_property`, "
-                 "          `int_value`, `double_value`, `string_value` "
-                 "    FROM `ContextProperty` "
-                 " ) as T2; "
-        }
-      }
-      # downgrade queries from version 4
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Association`; " }
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Attribution`; " }
-      # check the tables are deleted properly
-      downgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Association'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Attribution'; "
-        }
-      }
-    }
-  }
-)pb",
-R"pb(
-  migration_schemes {
-    key: 4
-    value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Association` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `context_id` INT NOT NULL, "
-               "   `execution_id` INT NOT NULL, "
-               "   UNIQUE(`context_id`, `execution_id`) "
-               " ); "
-      }
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `context_id` INT NOT NULL, "
-               "   `artifact_id` INT NOT NULL, "
-               "   UNIQUE(`context_id`, `artifact_id`) "
-               " ); "
-      }
-      upgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `context_id`, `execution_id` "
-                 "   FROM `Association` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `context_id`, `artifact_id` "
-                 "   FROM `Attribution` "
-                 " ) as T1; "
-        }
-      }
-      # downgrade queries from version 5
-      downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP INDEX UniqueArtifactTypeName; "
-      }
-      downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP COLUMN `state`, "
-               " DROP COLUMN `name`, "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+      downgrade_queries {
+        query: " INSERT INTO `ContextPropertyTemp` "
+               " SELECT `context_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value` "
+               " FROM `ContextProperty` WHERE `byte_value` IS NULL; "
       }
+      downgrade_queries { query: " DROP TABLE `ContextProperty`; " }
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP INDEX UniqueExecutionTypeName; "
+        query: " ALTER TABLE `ContextPropertyTemp` "
+               " RENAME TO `ContextProperty`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP COLUMN `last_known_state`, "
-               " DROP COLUMN `name`, "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_contextproperty_int_value` "
+               " ON `ContextProperty`(`name`, `int_value`); "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Context` "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_contextproperty_string_value` "
+               " ON `ContextProperty`(`name`, `string_value`); "
       }
-      # verify if the downgrading keeps the existing columns
+      # verify if the downgrading keeps the other property values
       downgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`, `state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 'uri1', 1, NULL, 0, 1); "
-        }
         previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`, `state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (2, 3, 'uri2', NULL, 'name2', 1, 0); "
+          query: "DELETE FROM `ArtifactProperty`;"
         }
-        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Execution` "
-                 " (`id`, `type_id`, `last_known_state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 1, NULL, 0, 1); "
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value`) VALUES (1, 'p1', 0, 'v1'); "
         }
-        previous_version_setup_queries { query: "DELETE FROM `Context`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Context` "
-                 " (`id`, `type_id`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 'name1', 1, 0); "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 2 FROM `Artifact`; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Artifact` "
-                 "   WHERE `id` = 1 and `type_id` = 2 and `uri` = 'uri1' "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Artifact` "
-                 "   WHERE `id` = 2 and `type_id` = 3 and `uri` = 'uri2' "
-                 " ) as T1; "
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `byte_value`) VALUES (1, 'p2', 0, X'0a00'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Execution`; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `name` = 'p1' AND "
+                 "       `string_value` = 'v1'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Execution` "
-                 "   WHERE `id` = 1 and `type_id` = 2 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty`; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Context` "
-                 "   WHERE `id` = 1 and `type_id` = 2 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 6 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `name` IN ( "
+                 "   'idx_artifactproperty_int_value', "
+                 "   'idx_artifactproperty_string_value', "
+                 "   'idx_executionproperty_int_value', "
+                 "   'idx_executionproperty_string_value', "
+                 "   'idx_contextproperty_int_value', "
+                 "   'idx_contextproperty_string_value'); "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v9, to store the struct property values as serialized bytes instead of
+  # base64 encoded strings, we introduce a `byte_value` column to the property
+  # tables of all nodes. The struct values stored in `string_value` by the
+  # earlier versions are still read.
   migration_schemes {
-    key: 5
+    key: 9
     value: {
-      # upgrade Artifact table
       upgrade_queries {
-        query: " ALTER TABLE `Artifact` ADD ( "
-               "   `state` INT, "
-               "   `name` VARCHAR(255), "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueArtifactTypeName "
-               " UNIQUE(`type_id`, `name`); "
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `byte_value` BLOB; "
       }
-      # upgrade Execution table
       upgrade_queries {
-        query: " ALTER TABLE `Execution` ADD ( "
-               "   `last_known_state` INT, "
-               "   `name` VARCHAR(255), "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueExecutionTypeName "
-               " UNIQUE(`type_id`, `name`); "
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `byte_value` BLOB; "
       }
-      # upgrade Context table
       upgrade_queries {
-        query: " ALTER TABLE `Context` ADD ( "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ) "
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `byte_value` BLOB; "
       }
-      # check the expected table columns are created properly.
+      # check the existing property values are kept.
       upgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`) VALUES (1, 2, 'uri1'); "
+          query: "DELETE FROM `ArtifactProperty`;"
         }
-        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Execution` "
-                 " (`id`, `type_id`) VALUES (1, 3); "
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value`) VALUES (1, 'p1', 0, 'v1'); "
         }
         previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   UNIQUE(`type_id`, `name`) "
-                 " ); "
+          query: "DELETE FROM `ExecutionProperty`;"
         }
         previous_version_setup_queries {
-          query: " INSERT INTO `Context` "
-                 " (`id`, `type_id`, `name`) VALUES (1, 2, 'name1'); "
+          query: " INSERT INTO `ExecutionProperty` "
+                 " (`execution_id`, `name`, `is_custom_property`, "
+                 "  `int_value`) VALUES (1, 'p1', 0, 1); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `uri`, `state`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Artifact` "
-                 "   WHERE `id` = 1 AND `type_id` = 2 AND `uri` = 'uri1' AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `string_value` = 'v1' AND "
+                 "       `byte_value` IS NULL; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `last_known_state`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Execution` "
-                 "   WHERE `id` = 1 AND `type_id` = 3 AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ExecutionProperty` "
+                 " WHERE `execution_id` = 1 AND `int_value` = 1 AND "
+                 "       `byte_value` IS NULL; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Context` "
-                 "   WHERE `id` = 1 AND `type_id` = 2 AND `name` = 'name1' AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 0 FROM `ContextProperty` "
+                 " WHERE `byte_value` IS NOT NULL; "
         }
       }
-      # downgrade queries from version 6
-      downgrade_queries { query: " DROP TABLE `ParentType`; " }
-      downgrade_queries { query: " DROP TABLE `ParentContext`; " }
+      # downgrade queries from version 10
       downgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " DROP COLUMN `version`, "
-               " DROP COLUMN `description`; "
+        query: " DROP INDEX `idx_artifact_type_id_create_time`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP INDEX `idx_artifact_uri`, "
-               " DROP INDEX `idx_artifact_create_time_since_epoch`, "
-               " DROP INDEX `idx_artifact_last_update_time_since_epoch`; "
+        query: " DROP INDEX `idx_artifact_type_id_last_update_time`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " DROP INDEX `idx_event_artifact_id`, "
-               " DROP INDEX `idx_event_execution_id`; "
+        query: " DROP INDEX `idx_execution_type_id_create_time`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " DROP INDEX `idx_type_name`; "
+        query: " DROP INDEX `idx_execution_type_id_last_update_time`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP INDEX `idx_execution_create_time_since_epoch`, "
-               " DROP INDEX `idx_execution_last_update_time_since_epoch`; "
+        query: " DROP INDEX `idx_context_type_id_create_time`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Context` "
-               " DROP INDEX `idx_context_create_time_since_epoch`, "
-               " DROP INDEX `idx_context_last_update_time_since_epoch`; "
+        query: " DROP INDEX `idx_context_type_id_last_update_time`; "
       }
-      # verify if the downgrading keeps the existing columns
+      # verify if the downgrading drops the type indices
       downgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Type`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`id`, `name`, `version`, `type_kind`, "
-                 "  `description`, `input_type`, `output_type`) "
-                 " VALUES (1, 't1', 'v1', 1, 'desc1', 'input1', 'output1'); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`id`, `name`, `version`, `type_kind`, "
-                 "  `description`, `input_type`, `output_type`) "
-                 " VALUES (2, 't2', 'v2', 2, 'desc2', 'input2', 'output2'); "
-        }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 2 FROM `Type`; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `name` IN ( "
+                 "   'idx_artifact_type_id_create_time', "
+                 "   'idx_artifact_type_id_last_update_time', "
+                 "   'idx_execution_type_id_create_time', "
+                 "   'idx_execution_type_id_last_update_time', "
+                 "   'idx_context_type_id_create_time', "
+                 "   'idx_context_type_id_last_update_time'); "
         }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v10, to list the nodes of a type with a range scan of an index, we
+  # introduce indices on the type and each of the timestamp ordering fields,
+  # with the id as the tie breaker.
+  migration_schemes {
+    key: 10
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_create_time` "
+               " ON `Artifact`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_last_update_time` "
+               " ON `Artifact`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_create_time` "
+               " ON `Execution`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_last_update_time` "
+               " ON `Execution`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_create_time` "
+               " ON `Context`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_last_update_time` "
+               " ON `Context`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
+      }
+      # check the expected indices are created properly.
+      upgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Type` "
-                 "   WHERE `id` = 1 AND `name` = 't1' AND type_kind = 1 "
-                 "   AND `input_type` = 'input1' AND `output_type` = 'output1'"
-                 " ) as T1; "
+          query: " SELECT count(*) = 6 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `name` IN ( "
+                 "   'idx_artifact_type_id_create_time', "
+                 "   'idx_artifact_type_id_last_update_time', "
+                 "   'idx_execution_type_id_create_time', "
+                 "   'idx_execution_type_id_last_update_time', "
+                 "   'idx_context_type_id_create_time', "
+                 "   'idx_context_type_id_last_update_time'); "
         }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentType'; "
+      }
+    }
+  }
+)pb");
+
+// Template queries for MySQLMetadataSources.
+// no-lint to support vc (C2026) 16380 max length for char[].
+const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: MYSQL_METADATA_SOURCE
+  create_id_list_table {
+    query: " CREATE TEMPORARY TABLE IF NOT EXISTS `IdList` ( "
+           "   `id` BIGINT PRIMARY KEY "
+           " ); "
+  }
+  clear_id_list_table { query: " DELETE FROM `IdList`; " }
+  insert_id_list {
+    query: " INSERT INTO `IdList`(`id`) VALUES($0); "
+    parameter_num: 1
+  }
+  select_id_list { query: " SELECT `id` FROM `IdList` " }
+  select_last_insert_id { query: " SELECT last_insert_id(); " }
+  select_auto_increment_settings {
+    query: " SELECT @@innodb_autoinc_lock_mode, @@auto_increment_increment; "
+  }
+  select_num_changed_rows { query: " SELECT row_count(); " }
+  insert_or_ignore_association {
+    query: " INSERT IGNORE INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
+  insert_or_ignore_attribution {
+    query: " INSERT IGNORE INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
+  insert_context_if_not_exist {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3) "
+           " ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`);"
+    parameter_num: 4
+  }
+  select_existing_context_id {
+    query: " SELECT last_insert_id(); "
+    parameter_num: 2
+  }
+  select_artifacts_by_uri_prefix {
+    query: " SELECT `id` from `Artifact` WHERE `uri` LIKE $0; "
+    parameter_num: 1
+  }
+  create_type_table {
+    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+           "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `version` VARCHAR(255), "
+           "   `type_kind` TINYINT(1) NOT NULL, "
+           "   `description` TEXT, "
+           "   `input_type` TEXT, "
+           "   `output_type` TEXT"
+           " ); "
+  }
+  create_artifact_table {
+    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `uri` TEXT, "
+           "   `state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_execution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `last_known_state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_context_table {
+    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_event_table {
+    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT "
+           " ); "
+  }
+  add_event_path_bytes_column {
+    query: " ALTER TABLE `Event` ADD COLUMN `path_bytes` MEDIUMBLOB; "
+  }
+  add_artifact_properties_bytes_column {
+    query: " ALTER TABLE `Artifact` ADD COLUMN `properties_bytes` MEDIUMBLOB; "
+  }
+  add_execution_properties_bytes_column {
+    query: " ALTER TABLE `Execution` ADD COLUMN `properties_bytes` MEDIUMBLOB; "
+  }
+  add_context_properties_bytes_column {
+    query: " ALTER TABLE `Context` ADD COLUMN `properties_bytes` MEDIUMBLOB; "
+  }
+  create_idempotency_key_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDIdempotencyKey` ( "
+           "   `idempotency_key` VARCHAR(255) PRIMARY KEY, "
+           "   `request_fingerprint` BIGINT NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL, "
+           "   `response` MEDIUMBLOB "
+           " ); "
+  }
+  insert_or_ignore_lineage_closure {
+    query: " INSERT IGNORE INTO `MLMDLineageClosure`( "
+           "   `artifact_id`, `direction`, `related_artifact_id` "
+           " ) VALUES($0, $1, $2); "
+    parameter_num: 3
+  }
+  create_association_table {
+    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `execution_id`) "
+           " ); "
+  }
+  create_attribution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `artifact_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `artifact_id`) "
+           " ); "
+  }
+  # secondary indices in the current schema.
+  secondary_indices {
+    # MySQL does not support arbitrary length string index. Only prefix index
+    # is supported. Max size for 5.6/5.7 is 255 char for utf8 charset.
+    query: " ALTER TABLE `Artifact` "
+          "  ADD INDEX `idx_artifact_uri`(`uri`(255)), "
+          "  ADD INDEX `idx_artifact_create_time_since_epoch` "
+          "             (`create_time_since_epoch`), "
+          "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
+          "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Event` "
+           " ADD INDEX `idx_event_artifact_id_covering` "
+           "   (`artifact_id`, `execution_id`, `type`, "
+           "    `milliseconds_since_epoch`), "
+           " ADD INDEX `idx_event_execution_id_covering` "
+           "   (`execution_id`, `artifact_id`, `type`, "
+           "    `milliseconds_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `EventPath` "
+           " ADD INDEX `idx_eventpath_event_id` (`event_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ParentContext` "
+           " ADD INDEX "
+           "   `idx_parentcontext_parent_context_id` (`parent_context_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Type` "
+           " ADD INDEX `idx_type_name` (`name`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Execution` "
+          "  ADD INDEX `idx_execution_create_time_since_epoch` "
+          "             (`create_time_since_epoch`), "
+          "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
+          "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Context` "
+          "  ADD INDEX `idx_context_create_time_since_epoch` "
+          "             (`create_time_since_epoch`), "
+          "  ADD INDEX `idx_context_last_update_time_since_epoch` "
+          "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           " ADD INDEX `idx_artifactproperty_int_value` "
+           "   (`name`, `int_value`), "
+           " ADD INDEX `idx_artifactproperty_string_value` "
+           "   (`name`, `string_value`(255)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           " ADD INDEX `idx_executionproperty_int_value` "
+           "   (`name`, `int_value`), "
+           " ADD INDEX `idx_executionproperty_string_value` "
+           "   (`name`, `string_value`(255)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           " ADD INDEX `idx_contextproperty_int_value` "
+           "   (`name`, `int_value`), "
+           " ADD INDEX `idx_contextproperty_string_value` "
+           "   (`name`, `string_value`(255)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Artifact` "
+           " ADD INDEX `idx_artifact_type_id_create_time` "
+           "   (`type_id`, `create_time_since_epoch`, `id`), "
+           " ADD INDEX `idx_artifact_type_id_last_update_time` "
+           "   (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           " ADD INDEX `idx_execution_type_id_create_time` "
+           "   (`type_id`, `create_time_since_epoch`, `id`), "
+           " ADD INDEX `idx_execution_type_id_last_update_time` "
+           "   (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Context` "
+           " ADD INDEX `idx_context_type_id_create_time` "
+           "   (`type_id`, `create_time_since_epoch`, `id`), "
+           " ADD INDEX `idx_context_type_id_last_update_time` "
+           "   (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  # drops the secondary indices in the current schema.
+  drop_secondary_indices {
+    query: " ALTER TABLE `Artifact` "
+           " DROP INDEX `idx_artifact_uri`, "
+           " DROP INDEX `idx_artifact_create_time_since_epoch`, "
+           " DROP INDEX `idx_artifact_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Event` "
+           " DROP INDEX `idx_event_artifact_id_covering`, "
+           " DROP INDEX `idx_event_execution_id_covering`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `EventPath` "
+           " DROP INDEX `idx_eventpath_event_id`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `ParentContext` "
+           " DROP INDEX `idx_parentcontext_parent_context_id`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Type` "
+           " DROP INDEX `idx_type_name`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           " DROP INDEX `idx_execution_create_time_since_epoch`, "
+           " DROP INDEX `idx_execution_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Context` "
+           " DROP INDEX `idx_context_create_time_since_epoch`, "
+           " DROP INDEX `idx_context_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           " DROP INDEX `idx_artifactproperty_int_value`, "
+           " DROP INDEX `idx_artifactproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           " DROP INDEX `idx_executionproperty_int_value`, "
+           " DROP INDEX `idx_executionproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           " DROP INDEX `idx_contextproperty_int_value`, "
+           " DROP INDEX `idx_contextproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Artifact` "
+           " DROP INDEX `idx_artifact_type_id_create_time`, "
+           " DROP INDEX `idx_artifact_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           " DROP INDEX `idx_execution_type_id_create_time`, "
+           " DROP INDEX `idx_execution_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " ALTER TABLE `Context` "
+           " DROP INDEX `idx_context_type_id_create_time`, "
+           " DROP INDEX `idx_context_type_id_last_update_time`; "
+  }
+  # downgrade to 0.13.2 (i.e., v0), and drops the MLMDEnv table.
+  migration_schemes {
+    key: 0
+    value: {
+      # downgrade queries from version 1
+      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'MLMDEnv'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 1
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
+               "   `schema_version` INTEGER PRIMARY KEY "
+               " ); "
+      }
+      upgrade_queries {
+        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
+      }
+      # v0.13.2 release
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+                 "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
+                 "   `input_type` TEXT, "
+                 "   `output_type` TEXT"
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
+                 "   `type_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `data_type` INT NULL, "
+                 " PRIMARY KEY (`type_id`, `name`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL, "
+                 "   `uri` TEXT "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
+                 "   `artifact_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_custom_property` TINYINT(1) NOT NULL, "
+                 "   `int_value` INT, "
+                 "   `double_value` DOUBLE, "
+                 "   `string_value` TEXT, "
+                 " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
+                 "   `execution_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_custom_property` TINYINT(1) NOT NULL, "
+                 "   `int_value` INT, "
+                 "   `double_value` DOUBLE, "
+                 "   `string_value` TEXT, "
+                 " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `artifact_id` INT NOT NULL, "
+                 "   `execution_id` INT NOT NULL, "
+                 "   `type` INT NOT NULL, "
+                 "   `milliseconds_since_epoch` BIGINT "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
+                 "   `event_id` INT NOT NULL, "
+                 "   `is_index_step` TINYINT(1) NOT NULL, "
+                 "   `step_index` INT, "
+                 "   `step_key` TEXT "
+                 " ); "
+        }
+        # check the new table has 1 row
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+        }
+      }
+      # downgrade queries from version 2, drop all ContextTypes and rename
+      # the `type_kind` back to `is_artifact_type` column.
+      downgrade_queries { query: " DELETE FROM `Type` WHERE `type_kind` = 2; " }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` CHANGE COLUMN "
+               " `type_kind` `is_artifact_type` TINYINT(1) NOT NULL; "
+      }
+      # check the tables are deleted properly
+      downgrade_verification {
+        # populate the `Type` table with context types.
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('execution_type', 0, 'input', 'output'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('artifact_type', 1, 'input', 'output'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('context_type', 2, 'input', 'output'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Type` "
+                 " WHERE `is_artifact_type` = 2; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` "
+                 " WHERE `is_artifact_type` = 1 AND `name` = 'artifact_type'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` "
+                 " WHERE `is_artifact_type` = 0 AND `name` = 'execution_type'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 2
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Type` CHANGE COLUMN "
+               " `is_artifact_type` `type_kind` TINYINT(1) NOT NULL; "
+      }
+      upgrade_verification {
+        # populate one ArtifactType and one ExecutionType.
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` (`name`, `is_artifact_type`) VALUES "
+                 " ('artifact_type', 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `is_artifact_type`, `input_type`, `output_type`) "
+                 " VALUES ('execution_type', 0, 'input', 'output'); "
+        }
+        # check after migration, the existing types are the same including id.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
+                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+        }
+      }
+      # downgrade queries from version 3
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Context`; " }
+      downgrade_queries { query: " DROP TABLE IF EXISTS `ContextProperty`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ContextProperty'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 3
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `type_id`, `name` FROM `Context` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `context_id`, `name`, `is_custom_property`, "
+                 "          `int_value`, `double_value`, `string_value` "
+                 "    FROM `ContextProperty` "
+                 " ) as T2; "
+        }
+      }
+      # downgrade queries from version 4
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Association`; " }
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Attribution`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Association'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Attribution'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 4
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `context_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   UNIQUE(`context_id`, `execution_id`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `context_id` INT NOT NULL, "
+               "   `artifact_id` INT NOT NULL, "
+               "   UNIQUE(`context_id`, `artifact_id`) "
+               " ); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `context_id`, `execution_id` "
+                 "   FROM `Association` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `context_id`, `artifact_id` "
+                 "   FROM `Attribution` "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 5
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX UniqueArtifactTypeName; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP COLUMN `state`, "
+               " DROP COLUMN `name`, "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX UniqueExecutionTypeName; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP COLUMN `last_known_state`, "
+               " DROP COLUMN `name`, "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`, `state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 'uri1', 1, NULL, 0, 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`, `state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (2, 3, 'uri2', NULL, 'name2', 1, 0); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Execution` "
+                 " (`id`, `type_id`, `last_known_state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 1, NULL, 0, 1); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Context`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Context` "
+                 " (`id`, `type_id`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 'name1', 1, 0); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Artifact`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Artifact` "
+                 "   WHERE `id` = 1 and `type_id` = 2 and `uri` = 'uri1' "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Artifact` "
+                 "   WHERE `id` = 2 and `type_id` = 3 and `uri` = 'uri2' "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Execution`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Execution` "
+                 "   WHERE `id` = 1 and `type_id` = 2 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Context` "
+                 "   WHERE `id` = 1 and `type_id` = 2 "
+                 " ) as T1; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 5
+    value: {
+      # upgrade Artifact table
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` ADD ( "
+               "   `state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ), "
+               " ADD CONSTRAINT UniqueArtifactTypeName "
+               " UNIQUE(`type_id`, `name`); "
+      }
+      # upgrade Execution table
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` ADD ( "
+               "   `last_known_state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ), "
+               " ADD CONSTRAINT UniqueExecutionTypeName "
+               " UNIQUE(`type_id`, `name`); "
+      }
+      # upgrade Context table
+      upgrade_queries {
+        query: " ALTER TABLE `Context` ADD ( "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ) "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`) VALUES (1, 2, 'uri1'); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Execution` "
+                 " (`id`, `type_id`) VALUES (1, 3); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   UNIQUE(`type_id`, `name`) "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Context` "
+                 " (`id`, `type_id`, `name`) VALUES (1, 2, 'name1'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Artifact` "
+                 "   WHERE `id` = 1 AND `type_id` = 2 AND `uri` = 'uri1' AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `last_known_state`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Execution` "
+                 "   WHERE `id` = 1 AND `type_id` = 3 AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Context` "
+                 "   WHERE `id` = 1 AND `type_id` = 2 AND `name` = 'name1' AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 6
+      downgrade_queries { query: " DROP TABLE `ParentType`; " }
+      downgrade_queries { query: " DROP TABLE `ParentContext`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " DROP COLUMN `version`, "
+               " DROP COLUMN `description`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX `idx_artifact_uri`, "
+               " DROP INDEX `idx_artifact_create_time_since_epoch`, "
+               " DROP INDEX `idx_artifact_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " DROP INDEX `idx_event_artifact_id`, "
+               " DROP INDEX `idx_event_execution_id`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " DROP INDEX `idx_type_name`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX `idx_execution_create_time_since_epoch`, "
+               " DROP INDEX `idx_execution_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP INDEX `idx_context_create_time_since_epoch`, "
+               " DROP INDEX `idx_context_last_update_time_since_epoch`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Type`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`id`, `name`, `version`, `type_kind`, "
+                 "  `description`, `input_type`, `output_type`) "
+                 " VALUES (1, 't1', 'v1', 1, 'desc1', 'input1', 'output1'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`id`, `name`, `version`, `type_kind`, "
+                 "  `description`, `input_type`, `output_type`) "
+                 " VALUES (2, 't2', 'v2', 2, 'desc2', 'input2', 'output2'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Type`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Type` "
+                 "   WHERE `id` = 1 AND `name` = 't1' AND type_kind = 1 "
+                 "   AND `input_type` = 'input1' AND `output_type` = 'output1'"
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentType'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentContext'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` LIKE 'idx_artifact_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` LIKE 'idx_event_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ParentContext' AND "
+                 "       `index_name` LIKE 'idx_parentcontext_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Type' AND "
+                 "       `index_name` LIKE 'idx_type_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` LIKE 'idx_execution_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` LIKE 'idx_context_%'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v6, to support parental type and parental context, we added two tables
+  # `ParentType` and `ParentContext`. In addition, we added `version` and
+  # `description` in the `Type` table for improving type registrations.
+  # We introduce indices on Type.name, Artifact.uri, Event's artifact_id and
+  # execution_id, and create_time_since_epoch, last_update_time_since_epoch
+  # for all nodes.
+  migration_schemes {
+    key: 6
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
+               "   `type_id` INT NOT NULL, "
+               "   `parent_type_id` INT NOT NULL, "
+               " PRIMARY KEY (`type_id`, `parent_type_id`)); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ParentContext` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `parent_context_id` INT NOT NULL, "
+               " PRIMARY KEY (`context_id`, `parent_context_id`)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Type` ADD ( "
+               "   `version` VARCHAR(255), "
+               "   `description` TEXT "
+               " ); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " ADD INDEX `idx_artifact_uri`(`uri`(255)), "
+              "  ADD INDEX `idx_artifact_create_time_since_epoch` "
+              "             (`create_time_since_epoch`), "
+              "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
+              "             (`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
+               " ADD INDEX `idx_event_execution_id` (`execution_id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ParentContext` "
+               " ADD INDEX "
+               "  `idx_parentcontext_parent_context_id` (`parent_context_id`);"
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " ADD INDEX `idx_type_name` (`name`);"
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+              "  ADD INDEX `idx_execution_create_time_since_epoch` "
+              "             (`create_time_since_epoch`), "
+              "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
+              "             (`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` "
+              "  ADD INDEX `idx_context_create_time_since_epoch` "
+              "             (`create_time_since_epoch`), "
+              "  ADD INDEX `idx_context_last_update_time_since_epoch` "
+              "             (`last_update_time_since_epoch`); "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        # check existing rows in previous Type table are migrated properly.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
+                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `type_id`, `parent_type_id` "
+                 "   FROM `ParentType` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `context_id`, `parent_context_id` "
+                 "   FROM `ParentContext` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
                  " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentContext'; "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` = 'idx_artifact_uri'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` = 'idx_artifact_create_time_since_epoch';"
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Artifact' AND `index_name` = "
+                 "       'idx_artifact_last_update_time_since_epoch';"
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_artifact_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_execution_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentContext' AND "
+                 "       `index_name` = 'idx_parentcontext_parent_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Type' AND "
+                 "       `index_name` = 'idx_type_name'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Execution' AND `index_name` = "
+                 "       'idx_execution_create_time_since_epoch'; "
         }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Execution' AND `index_name` = "
+                 "       'idx_execution_last_update_time_since_epoch'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` = 'idx_context_create_time_since_epoch'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context' AND `index_name` = "
+                 "       'idx_context_last_update_time_since_epoch'; "
+        }
+      }
+      # downgrade queries from version 7
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " DROP INDEX `idx_artifactproperty_int_value`, "
+               " DROP INDEX `idx_artifactproperty_string_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " DROP INDEX `idx_executionproperty_int_value`, "
+               " DROP INDEX `idx_executionproperty_string_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " DROP INDEX `idx_contextproperty_int_value`, "
+               " DROP INDEX `idx_contextproperty_string_value`; "
+      }
+      # verify if the downgrading drops the property value indices
+      downgrade_verification {
         post_migration_verification_queries {
           query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
                  " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` LIKE 'idx_artifact_%'; "
+                 "       `table_name` = 'ArtifactProperty' AND "
+                 "       `index_name` LIKE 'idx_artifactproperty_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ExecutionProperty' AND "
+                 "       `index_name` LIKE 'idx_executionproperty_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ContextProperty' AND "
+                 "       `index_name` LIKE 'idx_contextproperty_%'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v7, to support filtering the listed nodes by their property values, we
+  # introduce indices on (`name`, `int_value`) and (`name`, `string_value`) of
+  # the property tables of all nodes. MySQL only supports a prefix index on the
+  # TEXT `string_value`.
+  migration_schemes {
+    key: 7
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD INDEX `idx_artifactproperty_int_value` "
+               "   (`name`, `int_value`), "
+               " ADD INDEX `idx_artifactproperty_string_value` "
+               "   (`name`, `string_value`(255)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD INDEX `idx_executionproperty_int_value` "
+               "   (`name`, `int_value`), "
+               " ADD INDEX `idx_executionproperty_string_value` "
+               "   (`name`, `string_value`(255)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD INDEX `idx_contextproperty_int_value` "
+               "   (`name`, `int_value`), "
+               " ADD INDEX `idx_contextproperty_string_value` "
+               "   (`name`, `string_value`(255)); "
+      }
+      # check the expected indices are created properly. The statistics
+      # table has a row per column of an index.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 2 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ArtifactProperty' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_artifactproperty_int_value', "
+                 "         'idx_artifactproperty_string_value'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 2 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ExecutionProperty' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_executionproperty_int_value', "
+                 "         'idx_executionproperty_string_value'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 2 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ContextProperty' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_contextproperty_int_value', "
+                 "         'idx_contextproperty_string_value'); "
+        }
+      }
+      # downgrade queries from version 8
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
+               " ADD INDEX `idx_event_execution_id` (`execution_id`), "
+               " DROP INDEX `idx_event_artifact_id_covering`, "
+               " DROP INDEX `idx_event_execution_id_covering`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `EventPath` "
+               " DROP INDEX `idx_eventpath_event_id`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      # verify if the downgrading restores the Event indices
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 2 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_event_artifact_id', "
+                 "         'idx_event_execution_id'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 0 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_event_artifact_id_covering', "
+                 "         'idx_event_execution_id_covering'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'EventPath'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v8, to serve the event lookups by artifact and execution ids from the
+  # indices, we replace the Event indices with covering ones, and introduce an
+  # index on EventPath.event_id. The indices are built in place without
+  # locking the tables, so that the stores can keep reading and writing events
+  # during the migration.
+  migration_schemes {
+    key: 8
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " ADD INDEX `idx_event_artifact_id_covering` "
+               "   (`artifact_id`, `execution_id`, `type`, "
+               "    `milliseconds_since_epoch`), "
+               " ADD INDEX `idx_event_execution_id_covering` "
+               "   (`execution_id`, `artifact_id`, `type`, "
+               "    `milliseconds_since_epoch`), "
+               " DROP INDEX `idx_event_artifact_id`, "
+               " DROP INDEX `idx_event_execution_id`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `EventPath` "
+               " ADD INDEX `idx_eventpath_event_id` (`event_id`), "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      # check the expected indices are created properly. The statistics
+      # table has a row per column of an index.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 2 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_event_artifact_id_covering', "
+                 "         'idx_event_execution_id_covering'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 0 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_event_artifact_id', "
+                 "         'idx_event_execution_id'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 1 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'EventPath' AND "
+                 "       `index_name` IN ( "
+                 "         'idx_eventpath_event_id'); "
+        }
+      }
+      # downgrade queries from version 9. The struct values stored as bytes
+      # are dropped, since v8 cannot read them.
+      downgrade_queries {
+        query: " DELETE FROM `ArtifactProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ExecutionProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ContextProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` DROP COLUMN `byte_value`; "
+      }
+      # verify if the downgrading keeps the other property values
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value`) VALUES (1, 'p1', 0, 'v1'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `byte_value`) VALUES (1, 'p2', 0, X'0a00'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `name` = 'p1' AND "
+                 "       `string_value` = 'v1'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty`; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
                  " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` LIKE 'idx_event_%'; "
+                 "       `column_name` = 'byte_value'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v9, to store the struct property values as serialized bytes instead of
+  # base64 encoded strings, we introduce a `byte_value` column to the property
+  # tables of all nodes. The column is added in place without locking the
+  # tables.
+  migration_schemes {
+    key: 9
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `byte_value` BLOB, ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `byte_value` BLOB, ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `byte_value` BLOB, ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      # check the existing property values are kept.
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value`) VALUES (1, 'p1', 0, 'v1'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'ParentContext' AND "
-                 "       `index_name` LIKE 'idx_parentcontext_%'; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `string_value` = 'v1' AND "
+                 "       `byte_value` IS NULL; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
                  " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Type' AND "
-                 "       `index_name` LIKE 'idx_type_%'; "
+                 "       `column_name` = 'byte_value'; "
         }
+      }
+      # downgrade queries from version 10
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX `idx_artifact_type_id_create_time`, "
+               " DROP INDEX `idx_artifact_type_id_last_update_time`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX `idx_execution_type_id_create_time`, "
+               " DROP INDEX `idx_execution_type_id_last_update_time`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP INDEX `idx_context_type_id_create_time`, "
+               " DROP INDEX `idx_context_type_id_last_update_time`, "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      # verify if the downgrading drops the type indices
+      downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+          query: " SELECT count(DISTINCT `index_name`) = 0 "
+                 " FROM `information_schema`.`statistics` "
                  " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Execution' AND "
-                 "       `index_name` LIKE 'idx_execution_%'; "
+                 "       `index_name` IN ( "
+                 "   'idx_artifact_type_id_create_time', "
+                 "   'idx_artifact_type_id_last_update_time', "
+                 "   'idx_execution_type_id_create_time', "
+                 "   'idx_execution_type_id_last_update_time', "
+                 "   'idx_context_type_id_create_time', "
+                 "   'idx_context_type_id_last_update_time'); "
         }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v10, to list the nodes of a type with a range scan of an index, we
+  # introduce indices on the type and each of the timestamp ordering fields,
+  # with the id as the tie breaker. The indices are built in place without
+  # locking the tables.
+  migration_schemes {
+    key: 10
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " ADD INDEX `idx_artifact_type_id_create_time` "
+               "   (`type_id`, `create_time_since_epoch`, `id`), "
+               " ADD INDEX `idx_artifact_type_id_last_update_time` "
+               "   (`type_id`, `last_update_time_since_epoch`, `id`), "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " ADD INDEX `idx_execution_type_id_create_time` "
+               "   (`type_id`, `create_time_since_epoch`, `id`), "
+               " ADD INDEX `idx_execution_type_id_last_update_time` "
+               "   (`type_id`, `last_update_time_since_epoch`, `id`), "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " ADD INDEX `idx_context_type_id_create_time` "
+               "   (`type_id`, `create_time_since_epoch`, `id`), "
+               " ADD INDEX `idx_context_type_id_last_update_time` "
+               "   (`type_id`, `last_update_time_since_epoch`, `id`), "
+               " ALGORITHM=INPLACE, LOCK=NONE; "
+      }
+      # check the expected indices are created properly.
+      upgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+          query: " SELECT count(DISTINCT `index_name`) = 6 "
+                 " FROM `information_schema`.`statistics` "
                  " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Context' AND "
-                 "       `index_name` LIKE 'idx_context_%'; "
+                 "       `index_name` IN ( "
+                 "   'idx_artifact_type_id_create_time', "
+                 "   'idx_artifact_type_id_last_update_time', "
+                 "   'idx_execution_type_id_create_time', "
+                 "   'idx_execution_type_id_last_update_time', "
+                 "   'idx_context_type_id_create_time', "
+                 "   'idx_context_type_id_last_update_time'); "
         }
       }
     }
   }
+)pb");
+
+// Template queries overriding the MySQL ones to range-partition the Event and
+// EventPath tables by milliseconds_since_epoch. A partition key must be part
+// of each unique key of a table, so the primary key of Event is extended with
+// the time, which is no longer nullable. The EventPath rows copy the time of
+// their events on insert, so that a partition of each table is dropped along
+// with the one of the same bound of the other.
+const std::string kMySQLPartitionedEventsQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  create_event_table {
+    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+           "   `id` INTEGER NOT NULL AUTO_INCREMENT, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   PRIMARY KEY (`id`, `milliseconds_since_epoch`) "
+           " ) PARTITION BY RANGE (`milliseconds_since_epoch`) ( "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+  }
+  create_event_path_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
+           "   `event_id` INT NOT NULL, "
+           "   `is_index_step` TINYINT(1) NOT NULL, "
+           "   `step_index` INT, "
+           "   `step_key` TEXT, "
+           "   `milliseconds_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+           " ) PARTITION BY RANGE (`milliseconds_since_epoch`) ( "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+  }
+  insert_event_path {
+    query: " INSERT INTO `EventPath`( "
+           "   `event_id`, `is_index_step`, `$1`, `milliseconds_since_epoch` "
+           ") VALUES($0, $2, $3, ( "
+           "   SELECT `milliseconds_since_epoch` FROM `Event` "
+           "   WHERE `id` = $0));"
+    parameter_num: 4
+  }
+  partition_event_tables {
+    query: " UPDATE `Event` SET `milliseconds_since_epoch` = 0 "
+           " WHERE `milliseconds_since_epoch` IS NULL; "
+  }
+  partition_event_tables {
+    query: " ALTER TABLE `Event` "
+           " MODIFY `milliseconds_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           " DROP PRIMARY KEY, "
+           " ADD PRIMARY KEY (`id`, `milliseconds_since_epoch`) "
+           " PARTITION BY RANGE (`milliseconds_since_epoch`) ( "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+  }
+  partition_event_tables {
+    query: " ALTER TABLE `EventPath` "
+           " ADD COLUMN `milliseconds_since_epoch` BIGINT NOT NULL DEFAULT 0; "
+  }
+  partition_event_tables {
+    query: " UPDATE `EventPath` JOIN `Event` "
+           "   ON `EventPath`.`event_id` = `Event`.`id` "
+           " SET `EventPath`.`milliseconds_since_epoch` = "
+           "     `Event`.`milliseconds_since_epoch`; "
+  }
+  partition_event_tables {
+    query: " ALTER TABLE `EventPath` "
+           " PARTITION BY RANGE (`milliseconds_since_epoch`) ( "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+  }
+  select_event_partition_bounds {
+    query: " SELECT `partition_description` "
+           " FROM `information_schema`.`partitions` "
+           " WHERE `table_schema` = (SELECT DATABASE()) AND "
+           "       `table_name` = 'Event' AND "
+           "       `partition_name` IS NOT NULL; "
+  }
+  add_event_partition {
+    query: " ALTER TABLE `Event` REORGANIZE PARTITION `p_future` INTO ( "
+           "   PARTITION `p$0` VALUES LESS THAN ($0), "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+    parameter_num: 1
+  }
+  add_event_path_partition {
+    query: " ALTER TABLE `EventPath` REORGANIZE PARTITION `p_future` INTO ( "
+           "   PARTITION `p$0` VALUES LESS THAN ($0), "
+           "   PARTITION `p_future` VALUES LESS THAN MAXVALUE); "
+    parameter_num: 1
+  }
+  drop_event_partition {
+    query: " ALTER TABLE `Event` DROP PARTITION `p$0`; "
+    parameter_num: 1
+  }
+  drop_event_path_partition {
+    query: " ALTER TABLE `EventPath` DROP PARTITION `p$0`; "
+    parameter_num: 1
+  }
+)pb");
+
+// Template queries overriding the base ones for a PostgreSQL based
+// MetadataSource. The identifiers are quoted with backticks as in the other
+// configs, and PostgreSQLMetadataSource quotes them with double quotes. As the
+// source was introduced at schema version 8, it has no migration schemes to
+// the earlier versions.
+const std::string kPostgreSQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: POSTGRESQL_METADATA_SOURCE
+  select_last_insert_id { query: " SELECT lastval(); " }
+  insert_or_ignore_association {
+    query: " INSERT INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES($0, $1) ON CONFLICT DO NOTHING;"
+    parameter_num: 2
+  }
+  insert_or_ignore_attribution {
+    query: " INSERT INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES($0, $1) ON CONFLICT DO NOTHING;"
+    parameter_num: 2
+  }
+  insert_context_if_not_exist {
+    query: " WITH `inserted` AS ( "
+           "   INSERT INTO `Context`( "
+           "     `type_id`, `name`, "
+           "     `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "   ) VALUES($0, $1, $2, $3) ON CONFLICT DO NOTHING "
+           "   RETURNING `id` "
+           " ) SELECT count(*) FROM `inserted`;"
+    parameter_num: 4
+  }
+  update_artifact_if_unchanged {
+    query: " WITH `updated` AS ( "
+           "   UPDATE `Artifact` "
+           "   SET `type_id` = $1, `uri` = $2, `state` = $3, "
+           "       `last_update_time_since_epoch` = $4 "
+           "   WHERE id = $0 AND `last_update_time_since_epoch` = $5 "
+           "   RETURNING `id` "
+           " ) SELECT count(*) FROM `updated`;"
+    parameter_num: 6
+  }
+  update_execution_if_unchanged {
+    query: " WITH `updated` AS ( "
+           "   UPDATE `Execution` "
+           "   SET `type_id` = $1, `last_known_state` = $2, "
+           "       `last_update_time_since_epoch` = $3 "
+           "   WHERE id = $0 AND `last_update_time_since_epoch` = $4 "
+           "   RETURNING `id` "
+           " ) SELECT count(*) FROM `updated`;"
+    parameter_num: 5
+  }
+  update_context_if_unchanged {
+    query: " WITH `updated` AS ( "
+           "   UPDATE `Context` "
+           "   SET `type_id` = $1, `name` = $2, "
+           "       `last_update_time_since_epoch` = $3 "
+           "   WHERE id = $0 AND `last_update_time_since_epoch` = $4 "
+           "   RETURNING `id` "
+           " ) SELECT count(*) FROM `updated`;"
+    parameter_num: 5
+  }
+  select_artifacts_by_uri_prefix {
+    query: " SELECT `id` from `Artifact` WHERE `uri` LIKE $0; "
+    parameter_num: 1
+  }
+  create_type_table {
+    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `version` VARCHAR(255), "
+           "   `type_kind` SMALLINT NOT NULL, "
+           "   `description` TEXT, "
+           "   `input_type` TEXT, "
+           "   `output_type` TEXT"
+           " ); "
+  }
+  create_artifact_table {
+    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `type_id` INT NOT NULL, "
+           "   `uri` TEXT, "
+           "   `state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_artifact_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
+           "   `artifact_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+  }
+  create_execution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `type_id` INT NOT NULL, "
+           "   `last_known_state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_execution_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
+           "   `execution_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+  }
+  create_context_table {
+    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `type_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_context_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+           "   `context_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+  }
+  create_event_table {
+    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT "
+           " ); "
+  }
+  add_event_path_bytes_column {
+    query: " ALTER TABLE `Event` ADD COLUMN IF NOT EXISTS `path_bytes` BYTEA; "
+  }
+  add_artifact_properties_bytes_column {
+    query: " ALTER TABLE `Artifact` "
+           " ADD COLUMN IF NOT EXISTS `properties_bytes` BYTEA; "
+  }
+  add_execution_properties_bytes_column {
+    query: " ALTER TABLE `Execution` "
+           " ADD COLUMN IF NOT EXISTS `properties_bytes` BYTEA; "
+  }
+  add_context_properties_bytes_column {
+    query: " ALTER TABLE `Context` "
+           " ADD COLUMN IF NOT EXISTS `properties_bytes` BYTEA; "
+  }
+  create_idempotency_key_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDIdempotencyKey` ( "
+           "   `idempotency_key` VARCHAR(255) PRIMARY KEY, "
+           "   `request_fingerprint` BIGINT NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL, "
+           "   `response` BYTEA "
+           " ); "
+  }
+  insert_or_ignore_lineage_closure {
+    query: " INSERT INTO `MLMDLineageClosure`( "
+           "   `artifact_id`, `direction`, `related_artifact_id` "
+           " ) VALUES($0, $1, $2) ON CONFLICT DO NOTHING; "
+    parameter_num: 3
+  }
+  create_event_path_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
+           "   `event_id` INT NOT NULL, "
+           "   `is_index_step` SMALLINT NOT NULL, "
+           "   `step_index` INT, "
+           "   `step_key` TEXT "
+           " ); "
+  }
+  create_association_table {
+    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `context_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `execution_id`) "
+           " ); "
+  }
+  create_attribution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+           "   `id` SERIAL PRIMARY KEY, "
+           "   `context_id` INT NOT NULL, "
+           "   `artifact_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `artifact_id`) "
+           " ); "
+  }
+)pb",
+R"pb(
+  # secondary indices in the current schema.
+  secondary_indices {
+    # The pattern operator class lets the LIKE prefix queries use the index
+    # in any collation.
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_uri` "
+           " ON `Artifact`(`uri` text_pattern_ops); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_create_time_since_epoch` "
+           " ON `Artifact`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_last_update_time_since_epoch` "
+           " ON `Artifact`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_artifact_id_covering` "
+           " ON `Event`(`artifact_id`, `execution_id`, `type`, "
+           "            `milliseconds_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id_covering` "
+           " ON `Event`(`execution_id`, `artifact_id`, `type`, "
+           "            `milliseconds_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_eventpath_event_id` "
+           " ON `EventPath`(`event_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_parentcontext_parent_context_id` "
+           " ON `ParentContext`(`parent_context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_type_name` "
+           " ON `Type`(`name`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_create_time_since_epoch` "
+           " ON `Execution`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_last_update_time_since_epoch` "
+           " ON `Execution`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_create_time_since_epoch` "
+           " ON `Context`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_last_update_time_since_epoch` "
+           " ON `Context`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifactproperty_int_value` "
+           " ON `ArtifactProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    # A btree entry is limited to a third of a page, so the unbounded string
+    # values are indexed with a hash index, which serves the equality filters.
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifactproperty_string_value` "
+           " ON `ArtifactProperty` USING HASH (`string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_executionproperty_int_value` "
+           " ON `ExecutionProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_executionproperty_string_value` "
+           " ON `ExecutionProperty` USING HASH (`string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_contextproperty_int_value` "
+           " ON `ContextProperty`(`name`, `int_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_contextproperty_string_value` "
+           " ON `ContextProperty` USING HASH (`string_value`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_create_time` "
+           " ON `Artifact`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_last_update_time` "
+           " ON `Artifact`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_create_time` "
+           " ON `Execution`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_update_time` "
+           " ON `Execution`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_create_time` "
+           " ON `Context`(`type_id`, `create_time_since_epoch`, "
+           "   `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_last_update_time` "
+           " ON `Context`(`type_id`, `last_update_time_since_epoch`, "
+           "   `id`); "
+  }
+  # drops the secondary indices in the current schema.
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_uri`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_event_artifact_id_covering`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_event_execution_id_covering`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_eventpath_event_id`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_parentcontext_parent_context_id`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_type_name`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS "
+           "   `idx_execution_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_create_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_last_update_time_since_epoch`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifactproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifactproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_executionproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_executionproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_contextproperty_int_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_contextproperty_string_value`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_artifact_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_execution_type_id_last_update_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_type_id_create_time`; "
+  }
+  drop_secondary_indices {
+    query: " DROP INDEX IF EXISTS `idx_context_type_id_last_update_time`; "
+  }
 )pb",
 R"pb(
-  # In v6, to support parental type and parental context, we added two tables
-  # `ParentType` and `ParentContext`. In addition, we added `version` and
-  # `description` in the `Type` table for improving type registrations.
-  # We introduce indices on Type.name, Artifact.uri, Event's artifact_id and
-  # execution_id, and create_time_since_epoch, last_update_time_since_epoch
-  # for all nodes.
   migration_schemes {
-    key: 6
+    key: 8
     value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
-               "   `type_id` INT NOT NULL, "
-               "   `parent_type_id` INT NOT NULL, "
-               " PRIMARY KEY (`type_id`, `parent_type_id`)); "
+      # downgrade queries from version 9. The struct values stored as bytes
+      # are dropped, since v8 cannot read them.
+      downgrade_queries {
+        query: " DELETE FROM `ArtifactProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ExecutionProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
       }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ContextProperty` "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` DROP COLUMN `byte_value`; "
+      }
+    }
+  }
+  # In v9, to store the struct property values as serialized bytes, we
+  # introduce a `byte_value` column to the property tables of all nodes.
+  migration_schemes {
+    key: 9
+    value: {
       upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ParentContext` ( "
-               "   `context_id` INT NOT NULL, "
-               "   `parent_context_id` INT NOT NULL, "
-               " PRIMARY KEY (`context_id`, `parent_context_id`)); "
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN IF NOT EXISTS `byte_value` BYTEA; "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Type` ADD ( "
-               "   `version` VARCHAR(255), "
-               "   `description` TEXT "
-               " ); "
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN IF NOT EXISTS `byte_value` BYTEA; "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " ADD INDEX `idx_artifact_uri`(`uri`(255)), "
-              "  ADD INDEX `idx_artifact_create_time_since_epoch` "
-              "             (`create_time_since_epoch`), "
-              "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
-              "             (`last_update_time_since_epoch`); "
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN IF NOT EXISTS `byte_value` BYTEA; "
       }
+      # downgrade queries from version 10
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_artifact_type_id_create_time`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_artifact_type_id_last_update_time`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_execution_type_id_create_time`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS "
+               "   `idx_execution_type_id_last_update_time`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_context_type_id_create_time`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX IF EXISTS `idx_context_type_id_last_update_time`; "
+      }
+    }
+  }
+  # In v10, to list the nodes of a type with a range scan of an index, we
+  # introduce indices on the type and each of the timestamp ordering fields.
+  migration_schemes {
+    key: 10
+    value: {
       upgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
-               " ADD INDEX `idx_event_execution_id` (`execution_id`); "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_create_time` "
+               " ON `Artifact`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `ParentContext` "
-               " ADD INDEX "
-               "  `idx_parentcontext_parent_context_id` (`parent_context_id`);"
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_last_update_time` "
+               " ON `Artifact`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " ADD INDEX `idx_type_name` (`name`);"
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_create_time` "
+               " ON `Execution`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Execution` "
-              "  ADD INDEX `idx_execution_create_time_since_epoch` "
-              "             (`create_time_since_epoch`), "
-              "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
-              "             (`last_update_time_since_epoch`); "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_last_update_time` "
+               " ON `Execution`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Context` "
-              "  ADD INDEX `idx_context_create_time_since_epoch` "
-              "             (`create_time_since_epoch`), "
-              "  ADD INDEX `idx_context_last_update_time_since_epoch` "
-              "             (`last_update_time_since_epoch`); "
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_create_time` "
+               " ON `Context`(`type_id`, `create_time_since_epoch`, "
+               "   `id`); "
       }
-      # check the expected table columns are created properly.
-      upgrade_verification {
-        # check existing rows in previous Type table are migrated properly.
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
-                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `type_id`, `parent_type_id` "
-                 "   FROM `ParentType` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `context_id`, `parent_context_id` "
-                 "   FROM `ParentContext` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` = 'idx_artifact_uri'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` = 'idx_artifact_create_time_since_epoch';"
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND `index_name` = "
-                 "       'idx_artifact_last_update_time_since_epoch';"
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_artifact_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_execution_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentContext' AND "
-                 "       `index_name` = 'idx_parentcontext_parent_context_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Type' AND "
-                 "       `index_name` = 'idx_type_name'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Execution' AND `index_name` = "
-                 "       'idx_execution_create_time_since_epoch'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Execution' AND `index_name` = "
-                 "       'idx_execution_last_update_time_since_epoch'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context' AND "
-                 "       `index_name` = 'idx_context_create_time_since_epoch'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context' AND `index_name` = "
-                 "       'idx_context_last_update_time_since_epoch'; "
-        }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_last_update_time` "
+               " ON `Context`(`type_id`, `last_update_time_since_epoch`, "
+               "   `id`); "
       }
     }
   }
 )pb");
 
-}  // namespace
-
-// The `MetadataSourceQueryConfig` protobuf messages are merged to the query
-// config with `MergeFrom`.
+// Returns the query config parsed from the text protos of `query_configs`,
+// which are merged in order with `MergeFrom`.
 // Note: Singular fields overwrite the `kBaseQueryConfig` message. Repeated
 // fields by default are concatenated to it and should be used with caution.
-MetadataSourceQueryConfig GetMySqlMetadataSourceQueryConfig() {
-  MetadataSourceQueryConfig config;
-  CHECK(google::protobuf::TextFormat::ParseFromString(kBaseQueryConfig, &config));
-  MetadataSourceQueryConfig mysql_config;
-  CHECK(google::protobuf::TextFormat::ParseFromString(kMySQLMetadataSourceQueryConfig,
-                                            &mysql_config));
-  config.MergeFrom(mysql_config);
+// The config is heap allocated and never destroyed, so that it can be shared
+// by the stores of the process until it exits.
+const MetadataSourceQueryConfig* ParseQueryConfig(
+    std::initializer_list<const std::string*> query_configs) {
+  auto* config = new MetadataSourceQueryConfig();
+  for (const std::string* query_config : query_configs) {
+    MetadataSourceQueryConfig source_config;
+    CHECK(google::protobuf::TextFormat::ParseFromString(*query_config,
+                                                        &source_config));
+    config->MergeFrom(source_config);
+  }
   return config;
 }
 
-MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig() {
-  MetadataSourceQueryConfig config;
-  CHECK(google::protobuf::TextFormat::ParseFromString(kBaseQueryConfig, &config));
-  MetadataSourceQueryConfig sqlite_config;
-  CHECK(google::protobuf::TextFormat::ParseFromString(kSQLiteMetadataSourceQueryConfig,
-                                            &sqlite_config));
-  config.MergeFrom(sqlite_config);
-  return config;
+}  // namespace
+
+// The query configs are parsed once per process on their first use, as their
+// text protos are large and the stores may be created per request.
+const MetadataSourceQueryConfig& GetMySqlMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* config = ParseQueryConfig(
+      {&kBaseQueryConfig, &kMySQLMetadataSourceQueryConfig});
+  return *config;
+}
+
+const MetadataSourceQueryConfig&
+GetMySqlPartitionedEventsMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* config =
+      ParseQueryConfig({&kBaseQueryConfig, &kMySQLMetadataSourceQueryConfig,
+                        &kMySQLPartitionedEventsQueryConfig});
+  return *config;
+}
+
+const MetadataSourceQueryConfig& GetSqliteMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* config = ParseQueryConfig(
+      {&kBaseQueryConfig, &kSQLiteMetadataSourceQueryConfig});
+  return *config;
+}
+
+const MetadataSourceQueryConfig& GetPostgreSQLMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* config = ParseQueryConfig(
+      {&kBaseQueryConfig, &kPostgreSQLMetadataSourceQueryConfig});
+  return *config;
 }
 
+const MetadataSourceQueryConfig& GetInMemoryMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* config = [] {
+    const std::unique_ptr<const MetadataSourceQueryConfig> base_config(
+        ParseQueryConfig({&kBaseQueryConfig}));
+    auto* config = new MetadataSourceQueryConfig();
+    config->set_metadata_source_type(IN_MEMORY_METADATA_SOURCE);
+    config->set_schema_version(base_config->schema_version());
+    return config;
+  }();
+  return *config;
+}
 
 }  // namespace util
 }  // namespace ml_metadata
@@ -20,14 +20,29 @@ limitations under the License.
 namespace ml_metadata {
 namespace util {
 
+// The MetadataSourceQueryConfigs below are parsed once per process, on their
+// first use, and the returned references stay valid until the process exits.
+
 // Gets the MetadataSourceQueryConfig for MySQLMetadataSource.
-MetadataSourceQueryConfig GetMySqlMetadataSourceQueryConfig();
+const MetadataSourceQueryConfig& GetMySqlMetadataSourceQueryConfig();
+
+// Gets the MetadataSourceQueryConfig for MySQLMetadataSource, which
+// range-partitions the Event and EventPath tables by time.
+const MetadataSourceQueryConfig&
+GetMySqlPartitionedEventsMetadataSourceQueryConfig();
 
 // Gets the MetadataSourceQueryConfig for SQLiteMetadataSource.
-MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig();
+const MetadataSourceQueryConfig& GetSqliteMetadataSourceQueryConfig();
+
+// Gets the MetadataSourceQueryConfig for PostgreSQLMetadataSource.
+const MetadataSourceQueryConfig& GetPostgreSQLMetadataSourceQueryConfig();
 
 // Gets the MetadataSourceQueryConfig for FakeMetadataSource.
-MetadataSourceQueryConfig GetFakeMetadataSourceQueryConfig();
+const MetadataSourceQueryConfig& GetFakeMetadataSourceQueryConfig();
+
+// Gets the MetadataSourceQueryConfig for InMemoryMetadataSource, which has the
+// schema_version of the library and no queries.
+const MetadataSourceQueryConfig& GetInMemoryMetadataSourceQueryConfig();
 
 
 }  // namespace util
@@ -25,11 +25,49 @@ TEST(MetadataSourceQueryConfig, GetMySqlMetadataSourceQueryConfig) {
   EXPECT_EQ(config.metadata_source_type(), MYSQL_METADATA_SOURCE);
 }
 
+TEST(MetadataSourceQueryConfig,
+     GetMySqlPartitionedEventsMetadataSourceQueryConfig) {
+  const MetadataSourceQueryConfig config =
+      GetMySqlPartitionedEventsMetadataSourceQueryConfig();
+  const MetadataSourceQueryConfig mysql_config =
+      GetMySqlMetadataSourceQueryConfig();
+  EXPECT_EQ(config.metadata_source_type(), MYSQL_METADATA_SOURCE);
+  EXPECT_EQ(config.schema_version(), mysql_config.schema_version());
+  EXPECT_EQ(config.migration_schemes().size(),
+            mysql_config.migration_schemes().size());
+  EXPECT_NE(config.create_event_table().query(),
+            mysql_config.create_event_table().query());
+  EXPECT_TRUE(config.has_select_event_partition_bounds());
+  EXPECT_FALSE(mysql_config.has_select_event_partition_bounds());
+  EXPECT_TRUE(mysql_config.partition_event_tables().empty());
+}
+
 TEST(MetadataSourceQueryConfig, GetSqliteMetadataSourceQueryConfig) {
   const MetadataSourceQueryConfig config = GetSqliteMetadataSourceQueryConfig();
   EXPECT_EQ(config.metadata_source_type(), SQLITE_METADATA_SOURCE);
 }
 
+TEST(MetadataSourceQueryConfig, QueryConfigsAreParsedOnce) {
+  EXPECT_EQ(&GetSqliteMetadataSourceQueryConfig(),
+            &GetSqliteMetadataSourceQueryConfig());
+  EXPECT_EQ(&GetMySqlMetadataSourceQueryConfig(),
+            &GetMySqlMetadataSourceQueryConfig());
+  EXPECT_NE(&GetMySqlMetadataSourceQueryConfig(),
+            &GetMySqlPartitionedEventsMetadataSourceQueryConfig());
+}
+
+TEST(MetadataSourceQueryConfig, GetPostgreSQLMetadataSourceQueryConfig) {
+  const MetadataSourceQueryConfig config =
+      GetPostgreSQLMetadataSourceQueryConfig();
+  EXPECT_EQ(config.metadata_source_type(), POSTGRESQL_METADATA_SOURCE);
+  EXPECT_EQ(config.schema_version(),
+            GetSqliteMetadataSourceQueryConfig().schema_version());
+  // The source was introduced at schema version 8.
+  EXPECT_EQ(config.migration_schemes().size(), config.schema_version() - 7);
+  EXPECT_EQ(config.migration_schemes().count(7), 0);
+  EXPECT_EQ(config.migration_schemes().count(config.schema_version()), 1);
+}
+
 
 }  // namespace
 }  // namespace util
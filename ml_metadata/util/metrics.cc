@@ -0,0 +1,235 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/util/metrics.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the labels formatted as in the exposition format, e.g.,
+// `{method="PutArtifacts"}`, or an empty string if there are none.
+std::string FormatLabels(const MetricLabels& labels) {
+  if (labels.empty()) return "";
+  std::string formatted = "{";
+  for (int i = 0; i < labels.size(); i++) {
+    absl::StrAppend(&formatted, i == 0 ? "" : ",", labels[i].first, "=\"",
+                    absl::StrReplaceAll(labels[i].second, {{"\\", "\\\\"},
+                                                           {"\"", "\\\""},
+                                                           {"\n", "\\n"}}),
+                    "\"");
+  }
+  absl::StrAppend(&formatted, "}");
+  return formatted;
+}
+
+// Returns the formatted `labels` with an additional `le` label of a bucket.
+std::string AddBucketLabel(absl::string_view labels,
+                           absl::string_view bucket_bound) {
+  if (labels.empty()) return absl::StrCat("{le=\"", bucket_bound, "\"}");
+  labels.remove_suffix(1);
+  return absl::StrCat(labels, ",le=\"", bucket_bound, "\"}");
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<double> bucket_bounds)
+    : bucket_bounds_(std::move(bucket_bounds)),
+      bucket_counts_(bucket_bounds_.size() + 1, 0) {
+  CHECK(std::is_sorted(bucket_bounds_.begin(), bucket_bounds_.end()))
+      << "The bucket bounds must be increasing.";
+}
+
+void Histogram::Observe(const double value) {
+  const int bucket = std::lower_bound(bucket_bounds_.begin(),
+                                      bucket_bounds_.end(), value) -
+                     bucket_bounds_.begin();
+  absl::MutexLock lock(&mu_);
+  bucket_counts_[bucket]++;
+  sum_ += value;
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const {
+  Snapshot snapshot;
+  absl::MutexLock lock(&mu_);
+  snapshot.bucket_counts = bucket_counts_;
+  for (const int64_t bucket_count : bucket_counts_) {
+    snapshot.count += bucket_count;
+  }
+  snapshot.sum = sum_;
+  return snapshot;
+}
+
+std::vector<double> ExponentialBuckets(const double start, const double factor,
+                                       const int num_buckets) {
+  CHECK_GT(start, 0) << "The start must be positive.";
+  CHECK_GT(factor, 1) << "The factor must be greater than 1.";
+  std::vector<double> bucket_bounds;
+  bucket_bounds.reserve(num_buckets);
+  double bucket_bound = start;
+  for (int i = 0; i < num_buckets; i++) {
+    bucket_bounds.push_back(bucket_bound);
+    bucket_bound *= factor;
+  }
+  return bucket_bounds;
+}
+
+const std::vector<double>& LatencyBuckets() {
+  static const std::vector<double>* const bucket_bounds =
+      new std::vector<double>(ExponentialBuckets(1e-4, 2, 18));
+  return *bucket_bounds;
+}
+
+MetricsRegistry* MetricsRegistry::Global() {
+  static MetricsRegistry* const registry = new MetricsRegistry();
+  return registry;
+}
+
+MetricsRegistry::Metric* MetricsRegistry::GetOrCreateMetricLocked(
+    const absl::string_view name, const absl::string_view help,
+    const MetricKind kind) {
+  auto it = metrics_.find(name);
+  if (it == metrics_.end()) {
+    it = metrics_.emplace(std::string(name), Metric()).first;
+    it->second.kind = kind;
+    it->second.help = std::string(help);
+  }
+  CHECK(it->second.kind == kind)
+      << "The metric " << name << " has been created as another kind.";
+  return &it->second;
+}
+
+Counter* MetricsRegistry::GetCounter(const absl::string_view name,
+                                     const absl::string_view help,
+                                     const MetricLabels& labels) {
+  const std::string formatted_labels = FormatLabels(labels);
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    const auto it = metrics_.find(name);
+    if (it != metrics_.end() && it->second.kind == MetricKind::kCounter) {
+      const auto series = it->second.counters.find(formatted_labels);
+      if (series != it->second.counters.end()) return series->second.get();
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Counter>& counter =
+      GetOrCreateMetricLocked(name, help, MetricKind::kCounter)
+          ->counters[formatted_labels];
+  if (counter == nullptr) counter = absl::make_unique<Counter>();
+  return counter.get();
+}
+
+Histogram* MetricsRegistry::GetHistogram(
+    const absl::string_view name, const absl::string_view help,
+    const MetricLabels& labels, const std::vector<double>& bucket_bounds) {
+  const std::string formatted_labels = FormatLabels(labels);
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    const auto it = metrics_.find(name);
+    if (it != metrics_.end() && it->second.kind == MetricKind::kHistogram) {
+      const auto series = it->second.histograms.find(formatted_labels);
+      if (series != it->second.histograms.end()) return series->second.get();
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Histogram>& histogram =
+      GetOrCreateMetricLocked(name, help, MetricKind::kHistogram)
+          ->histograms[formatted_labels];
+  if (histogram == nullptr) {
+    histogram = absl::make_unique<Histogram>(bucket_bounds);
+  }
+  return histogram.get();
+}
+
+int64_t MetricsRegistry::AddGauge(const absl::string_view name,
+                                  const absl::string_view help,
+                                  const MetricLabels& labels,
+                                  std::function<double()> value) {
+  absl::MutexLock lock(&mu_);
+  const int64_t gauge_id = next_gauge_id_++;
+  GetOrCreateMetricLocked(name, help, MetricKind::kGauge)->gauges[gauge_id] =
+      {FormatLabels(labels), std::move(value)};
+  gauge_names_[gauge_id] = std::string(name);
+  return gauge_id;
+}
+
+void MetricsRegistry::RemoveGauge(const int64_t gauge_id) {
+  absl::MutexLock lock(&mu_);
+  const auto it = gauge_names_.find(gauge_id);
+  if (it == gauge_names_.end()) return;
+  metrics_.find(it->second)->second.gauges.erase(gauge_id);
+  gauge_names_.erase(it);
+}
+
+std::string MetricsRegistry::ExportPrometheusText() const {
+  std::string text;
+  absl::ReaderMutexLock lock(&mu_);
+  for (const auto& name_and_metric : metrics_) {
+    const std::string& name = name_and_metric.first;
+    const Metric& metric = name_and_metric.second;
+    absl::StrAppend(&text, "# HELP ", name, " ", metric.help, "\n");
+    switch (metric.kind) {
+      case MetricKind::kCounter:
+        absl::StrAppend(&text, "# TYPE ", name, " counter\n");
+        for (const auto& series : metric.counters) {
+          absl::StrAppend(&text, name, series.first, " ",
+                          series.second->value(), "\n");
+        }
+        break;
+      case MetricKind::kHistogram:
+        absl::StrAppend(&text, "# TYPE ", name, " histogram\n");
+        for (const auto& series : metric.histograms) {
+          const std::vector<double>& bucket_bounds =
+              series.second->bucket_bounds();
+          const Histogram::Snapshot snapshot = series.second->GetSnapshot();
+          int64_t cumulative_count = 0;
+          for (int i = 0; i < snapshot.bucket_counts.size(); i++) {
+            cumulative_count += snapshot.bucket_counts[i];
+            const std::string bucket_bound =
+                i < bucket_bounds.size() ? absl::StrCat(bucket_bounds[i])
+                                         : "+Inf";
+            absl::StrAppend(&text, name, "_bucket",
+                            AddBucketLabel(series.first, bucket_bound), " ",
+                            cumulative_count, "\n");
+          }
+          absl::StrAppend(&text, name, "_sum", series.first, " ",
+                          snapshot.sum, "\n");
+          absl::StrAppend(&text, name, "_count", series.first, " ",
+                          snapshot.count, "\n");
+        }
+        break;
+      case MetricKind::kGauge: {
+        absl::StrAppend(&text, "# TYPE ", name, " gauge\n");
+        std::map<std::string, double> values;
+        for (const auto& id_and_gauge : metric.gauges) {
+          values[id_and_gauge.second.labels] += id_and_gauge.second.value();
+        }
+        for (const auto& series : values) {
+          absl::StrAppend(&text, name, series.first, " ", series.second,
+                          "\n");
+        }
+        break;
+      }
+    }
+  }
+  return text;
+}
+
+}  // namespace ml_metadata
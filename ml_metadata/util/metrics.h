@@ -0,0 +1,203 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_ML_METADATA_UTIL_METRICS_H_
+#define THIRD_PARTY_ML_METADATA_UTIL_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+// The labels of a metric series, e.g., {{"method", "PutArtifacts"}}.
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// A monotonically increasing count. It is thread-safe.
+class Counter {
+ public:
+  Counter() = default;
+
+  // Disallow copy and assign.
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Increment(int64_t delta = 1) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// A distribution of observed values, e.g., latencies in seconds, counted in
+// buckets with the given increasing upper bounds. The values above the last
+// bound are counted in an implicit overflow bucket. It is thread-safe.
+class Histogram {
+ public:
+  explicit Histogram(std::vector<double> bucket_bounds);
+
+  // Disallow copy and assign.
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Observe(double value);
+
+  // The observations recorded so far. The `bucket_counts` are not cumulative,
+  // and the last one counts the values above all bucket bounds.
+  struct Snapshot {
+    std::vector<int64_t> bucket_counts;
+    int64_t count = 0;
+    double sum = 0;
+  };
+  Snapshot GetSnapshot() const;
+
+  const std::vector<double>& bucket_bounds() const { return bucket_bounds_; }
+
+ private:
+  const std::vector<double> bucket_bounds_;
+  mutable absl::Mutex mu_;
+  std::vector<int64_t> bucket_counts_ ABSL_GUARDED_BY(mu_);
+  double sum_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Returns `num_buckets` bucket bounds, which start at `start` and grow by
+// `factor`.
+std::vector<double> ExponentialBuckets(double start, double factor,
+                                       int num_buckets);
+
+// Returns the bucket bounds of the latency histograms in seconds, from 100us
+// to about 13s.
+const std::vector<double>& LatencyBuckets();
+
+// Observes the time elapsed between its construction and destruction in
+// `histogram`, in seconds.
+class ScopedLatencyRecorder {
+ public:
+  explicit ScopedLatencyRecorder(Histogram* histogram)
+      : histogram_(histogram), start_(absl::Now()) {}
+  ~ScopedLatencyRecorder() {
+    histogram_->Observe(absl::ToDoubleSeconds(absl::Now() - start_));
+  }
+
+  // Disallow copy and assign.
+  ScopedLatencyRecorder(const ScopedLatencyRecorder&) = delete;
+  ScopedLatencyRecorder& operator=(const ScopedLatencyRecorder&) = delete;
+
+ private:
+  Histogram* const histogram_;
+  const absl::Time start_;
+};
+
+// A registry of named metrics, which are exported in the Prometheus text
+// exposition format, e.g., by the /metrics endpoint of the metadata store
+// server. It is thread-safe.
+//
+// A metric is a family of series with the same name and different labels. The
+// counters and histograms are created on first use and live as long as the
+// registry, so that callers may keep the returned pointers. The gauges are
+// computed by callbacks at export time, e.g., from the state of a pool, and
+// the gauges with the same name and labels are summed.
+//
+// Usage example:
+//
+//   static Counter* const retries = MetricsRegistry::Global()->GetCounter(
+//       "mlmd_transaction_retries_total", "Aborted transactions run again.");
+//   retries->Increment();
+class MetricsRegistry {
+ public:
+  MetricsRegistry() = default;
+
+  // Disallow copy and assign.
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  // Returns the registry shared by the process. It is never destructed.
+  static MetricsRegistry* Global();
+
+  // Returns the counter of the series `name` with `labels`. The `help` of the
+  // first call creating the metric is kept.
+  // The metric must not have been created as another kind.
+  Counter* GetCounter(absl::string_view name, absl::string_view help,
+                      const MetricLabels& labels = {});
+
+  // Returns the histogram of the series `name` with `labels`. The
+  // `bucket_bounds` are only used when the series is created.
+  // The metric must not have been created as another kind.
+  Histogram* GetHistogram(absl::string_view name, absl::string_view help,
+                          const MetricLabels& labels = {},
+                          const std::vector<double>& bucket_bounds =
+                              LatencyBuckets());
+
+  // Adds a gauge of the series `name` with `labels`, whose value is returned
+  // by `value` at export time. `value` must be thread-safe and must not call
+  // the registry. Returns the id to pass to RemoveGauge().
+  // The metric must not have been created as another kind.
+  int64_t AddGauge(absl::string_view name, absl::string_view help,
+                   const MetricLabels& labels, std::function<double()> value);
+
+  // Removes a gauge added by AddGauge(), e.g., before the state it reads is
+  // destructed.
+  void RemoveGauge(int64_t gauge_id);
+
+  // Returns all metrics in the Prometheus text exposition format, ordered by
+  // name and labels.
+  std::string ExportPrometheusText() const;
+
+ private:
+  enum class MetricKind { kCounter, kHistogram, kGauge };
+
+  struct Gauge {
+    std::string labels;
+    std::function<double()> value;
+  };
+
+  // The series of a metric keyed by their formatted labels, e.g.,
+  // `{method="PutArtifacts"}`.
+  struct Metric {
+    MetricKind kind;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<int64_t, Gauge> gauges;
+  };
+
+  // Returns the metric `name`, creating it if it does not exist.
+  Metric* GetOrCreateMetricLocked(absl::string_view name,
+                                  absl::string_view help, MetricKind kind)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable absl::Mutex mu_;
+  std::map<std::string, Metric, std::less<>> metrics_ ABSL_GUARDED_BY(mu_);
+  // The metric names of the added gauges by their ids.
+  std::map<int64_t, std::string> gauge_names_ ABSL_GUARDED_BY(mu_);
+  int64_t next_gauge_id_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // THIRD_PARTY_ML_METADATA_UTIL_METRICS_H_
@@ -0,0 +1,91 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/util/metrics.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(MetricsTest, HistogramCountsValuesInBuckets) {
+  Histogram histogram({1, 2, 4});
+  for (const double value : {0.5, 1.0, 1.5, 3.0, 8.0, 9.0}) {
+    histogram.Observe(value);
+  }
+
+  const Histogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_THAT(snapshot.bucket_counts, ElementsAre(2, 1, 1, 2));
+  EXPECT_EQ(snapshot.count, 6);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 23);
+}
+
+TEST(MetricsTest, ExponentialBuckets) {
+  EXPECT_THAT(ExponentialBuckets(1, 2, 4), ElementsAre(1, 2, 4, 8));
+}
+
+TEST(MetricsTest, RegistryReturnsSameSeriesForSameLabels) {
+  MetricsRegistry registry;
+  Counter* counter =
+      registry.GetCounter("rows_total", "Rows.", {{"template", "a"}});
+  EXPECT_EQ(registry.GetCounter("rows_total", "Rows.", {{"template", "a"}}),
+            counter);
+  EXPECT_NE(registry.GetCounter("rows_total", "Rows.", {{"template", "b"}}),
+            counter);
+}
+
+TEST(MetricsTest, ExportPrometheusText) {
+  MetricsRegistry registry;
+  registry.GetCounter("retries_total", "Retries.")->Increment(3);
+  registry.GetHistogram("latency_seconds", "Latency.", {{"method", "Get"}},
+                        {0.5, 1})
+      ->Observe(0.75);
+  const int64_t gauge_id = registry.AddGauge("pool_size", "Size.",
+                                             {{"pool", "p"}}, [] { return 2; });
+  registry.AddGauge("pool_size", "Size.", {{"pool", "p"}}, [] { return 3; });
+
+  const std::string text = registry.ExportPrometheusText();
+  EXPECT_THAT(text, HasSubstr("# TYPE retries_total counter\n"
+                              "retries_total 3\n"));
+  EXPECT_THAT(text,
+              HasSubstr("# HELP latency_seconds Latency.\n"
+                        "# TYPE latency_seconds histogram\n"
+                        "latency_seconds_bucket{method=\"Get\",le=\"0.5\"} 0\n"
+                        "latency_seconds_bucket{method=\"Get\",le=\"1\"} 1\n"
+                        "latency_seconds_bucket{method=\"Get\",le=\"+Inf\"} 1\n"
+                        "latency_seconds_sum{method=\"Get\"} 0.75\n"
+                        "latency_seconds_count{method=\"Get\"} 1\n"));
+  // The gauges of the same series are summed.
+  EXPECT_THAT(text, HasSubstr("pool_size{pool=\"p\"} 5\n"));
+
+  registry.RemoveGauge(gauge_id);
+  EXPECT_THAT(registry.ExportPrometheusText(),
+              HasSubstr("pool_size{pool=\"p\"} 3\n"));
+}
+
+TEST(MetricsTest, ExportEscapesLabelValues) {
+  MetricsRegistry registry;
+  registry.GetCounter("errors_total", "Errors.", {{"message", "a\"b\\c"}});
+  EXPECT_THAT(registry.ExportPrometheusText(),
+              HasSubstr("errors_total{message=\"a\\\"b\\\\c\"} 0\n"));
+  EXPECT_THAT(registry.ExportPrometheusText(), Not(HasSubstr("a\"b")));
+}
+
+}  // namespace
+}  // namespace ml_metadata
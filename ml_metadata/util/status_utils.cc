@@ -29,4 +29,12 @@ tensorflow::Status FromABSLStatus(const absl::Status& s) {
                             s.message());
 }
 
+absl::Status ToABSLStatus(const tensorflow::Status& s) {
+  if (s.ok()) {
+    return absl::OkStatus();
+  }
+  return absl::Status(static_cast<absl::StatusCode>(s.code()),
+                      s.error_message());
+}
+
 }  // namespace ml_metadata
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/util/struct_utils.h"
 
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "google/protobuf/struct.pb.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
@@ -25,8 +27,8 @@ limitations under the License.
 namespace ml_metadata {
 namespace {
 
-// TODO(b/178235219): Remove this once we migrate to schema v7 and add a column
-// for storing serialized `Struct` values.
+// The `Struct` values written before schema v9 are stored with this prefix in
+// the `string_value` column, and are still read for compatibility.
 constexpr char kSerializedStructPrefix[] = "mlmd-struct::";
 
 }
@@ -65,4 +67,25 @@ absl::Status StringToStruct(absl::string_view serialized_value,
   return absl::OkStatus();
 }
 
+std::string StructToBytes(const google::protobuf::Struct& struct_value) {
+  std::string serialized_value;
+  {
+    google::protobuf::io::StringOutputStream output(&serialized_value);
+    google::protobuf::io::CodedOutputStream coded_output(&output);
+    coded_output.SetSerializationDeterministic(true);
+    struct_value.SerializeToCodedStream(&coded_output);
+  }
+  return serialized_value;
+}
+
+absl::Status BytesToStruct(absl::string_view serialized_value,
+                           google::protobuf::Struct& struct_value) {
+  if (!struct_value.ParseFromArray(serialized_value.data(),
+                                   serialized_value.size())) {
+    return absl::InvalidArgumentError(
+        "Unable to parse serialized `google.protobuf.Struct` bytes.");
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace ml_metadata
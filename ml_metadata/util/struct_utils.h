@@ -38,6 +38,17 @@ std::string StructToString(const google::protobuf::Struct& struct_value);
 absl::Status StringToStruct(absl::string_view serialized_value,
                             google::protobuf::Struct& struct_value);
 
+// Returns the serialized bytes of |struct_value| suitable for storage in the
+// `byte_value` column of MLMD's Property table. The serialization is
+// deterministic, so that equal values have equal bytes.
+std::string StructToBytes(const google::protobuf::Struct& struct_value);
+
+// Returns the corresponding `google.protobuf.Struct` parsed from the bytes
+// |serialized_value| in |struct_value|.
+// Returns INVALID_ARGUMENT if |serialized_value| cannot be parsed.
+absl::Status BytesToStruct(absl::string_view serialized_value,
+                           google::protobuf::Struct& struct_value);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_UTIL_STRUCT_UTILS_H_
@@ -89,5 +89,44 @@ TEST(StructUtils, DeserializeNonStructSerializedString) {
   EXPECT_TRUE(absl::IsInvalidArgument(status));
 }
 
+TEST(StructUtils, SerializeAndDeserializeStructBytesWorks) {
+  const auto struct_value =
+      ml_metadata::testing::ParseTextProtoOrDie<google::protobuf::Struct>(R"pb(
+        fields {
+          key: "json number"
+          value { number_value: 1234 }
+        }
+        fields {
+          key: "json list"
+          value {
+            list_value {
+              values { string_value: "a" }
+              values { bool_value: true }
+            }
+          }
+        }
+      )pb");
+
+  const std::string serialized_value = StructToBytes(struct_value);
+  EXPECT_FALSE(IsStructSerializedString(serialized_value));
+  google::protobuf::Struct got_value;
+  ASSERT_EQ(absl::OkStatus(), BytesToStruct(serialized_value, got_value));
+  EXPECT_THAT(got_value, EqualsProto(struct_value));
+  // Equal values with the fields inserted in a different order have equal
+  // bytes.
+  google::protobuf::Struct reordered_value;
+  (*reordered_value.mutable_fields())["json list"] =
+      struct_value.fields().at("json list");
+  (*reordered_value.mutable_fields())["json number"] =
+      struct_value.fields().at("json number");
+  EXPECT_EQ(StructToBytes(reordered_value), serialized_value);
+}
+
+TEST(StructUtils, DeserializeInvalidStructBytes) {
+  google::protobuf::Struct got_value;
+  const absl::Status status = BytesToStruct("\xff\xff", got_value);
+  EXPECT_TRUE(absl::IsInvalidArgument(status));
+}
+
 }  // namespace
 }  // namespace ml_metadata
@@ -0,0 +1,190 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/util/tracing.h"
+
+#include <atomic>
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "absl/random/random.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+
+namespace ml_metadata {
+namespace {
+
+// The sampling options and the exporter of the process, or nullptr if tracing
+// is disabled. A replaced state is never deleted, as the spans which started
+// before may still use it.
+struct TracingState {
+  TracingOptions options;
+  std::unique_ptr<SpanExporter> exporter;
+};
+std::atomic<const TracingState*> tracing_state{nullptr};
+
+// The innermost span of the thread which has not ended, if tracing is enabled.
+thread_local ScopedSpan* current_span = nullptr;
+
+absl::BitGen& ThreadBitGen() {
+  thread_local absl::BitGen bit_gen;
+  return bit_gen;
+}
+
+// Returns a random id of `num_bytes` bytes as lowercase hex digits.
+std::string RandomHexId(const int num_bytes) {
+  std::string bytes(num_bytes, '\0');
+  for (char& byte : bytes) {
+    byte = static_cast<char>(absl::Uniform<uint8_t>(ThreadBitGen()));
+  }
+  return absl::BytesToHexString(bytes);
+}
+
+// Returns true if `id` has `num_digits` lowercase hex digits which are not all
+// zeros.
+bool IsValidHexId(const absl::string_view id, const int num_digits) {
+  if (id.size() != num_digits) return false;
+  bool all_zeros = true;
+  for (const char c : id) {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    all_zeros &= c == '0';
+  }
+  return !all_zeros;
+}
+
+bool SampleRoot(const TracingOptions& options) {
+  return absl::Bernoulli(ThreadBitGen(), options.sampling_probability);
+}
+
+}  // namespace
+
+bool ParseTraceParent(const absl::string_view traceparent,
+                      SpanContext* context) {
+  const std::vector<absl::string_view> fields =
+      absl::StrSplit(traceparent, '-');
+  if (fields.size() != 4 || fields[0] != "00" ||
+      !IsValidHexId(fields[1], 32) || !IsValidHexId(fields[2], 16) ||
+      fields[3].size() != 2 || !absl::ascii_isxdigit(fields[3][0]) ||
+      !absl::ascii_isxdigit(fields[3][1])) {
+    return false;
+  }
+  const std::string flags = absl::HexStringToBytes(fields[3]);
+  context->trace_id = std::string(fields[1]);
+  context->span_id = std::string(fields[2]);
+  context->sampled = (flags[0] & 1) != 0;
+  return true;
+}
+
+std::string FormatTraceParent(const SpanContext& context) {
+  return absl::StrCat("00-", context.trace_id, "-", context.span_id,
+                      context.sampled ? "-01" : "-00");
+}
+
+void LoggingSpanExporter::Export(const SpanData& span) {
+  std::string attributes;
+  for (const auto& attribute : span.attributes) {
+    absl::StrAppend(&attributes, " ", attribute.first, "=", attribute.second);
+  }
+  LOG(INFO) << "Span " << span.name << " trace_id=" << span.context.trace_id
+            << " span_id=" << span.context.span_id << " parent_span_id="
+            << (span.parent_span_id.empty() ? "none" : span.parent_span_id)
+            << " start_time=" << absl::FormatTime(span.start_time)
+            << " duration="
+            << absl::FormatDuration(span.end_time - span.start_time)
+            << attributes;
+}
+
+void EnableTracing(const TracingOptions& options,
+                   std::unique_ptr<SpanExporter> exporter) {
+  CHECK(exporter != nullptr) << "The exporter must not be null.";
+  CHECK(options.sampling_probability >= 0 && options.sampling_probability <= 1)
+      << "The sampling_probability must be in [0, 1].";
+  tracing_state = new TracingState{options, std::move(exporter)};
+}
+
+void DisableTracing() { tracing_state = nullptr; }
+
+ScopedSpan::ScopedSpan(const absl::string_view name) {
+  const TracingState* state = tracing_state.load();
+  if (state == nullptr) return;
+  enabled_ = true;
+  previous_span_ = current_span;
+  current_span = this;
+  if (previous_span_ == nullptr) {
+    Start(name, SampleRoot(state->options), "", "");
+  } else if (previous_span_->sampled_) {
+    const SpanContext& parent = previous_span_->data_->context;
+    Start(name, true, parent.trace_id, parent.span_id);
+  }
+}
+
+ScopedSpan::ScopedSpan(const absl::string_view name,
+                       const SpanContext& remote_parent) {
+  const TracingState* state = tracing_state.load();
+  if (state == nullptr) return;
+  enabled_ = true;
+  previous_span_ = current_span;
+  current_span = this;
+  if (!remote_parent.is_valid()) {
+    Start(name, SampleRoot(state->options), "", "");
+    return;
+  }
+  Start(name,
+        state->options.follow_remote_parent ? remote_parent.sampled
+                                            : SampleRoot(state->options),
+        remote_parent.trace_id, remote_parent.span_id);
+}
+
+ScopedSpan::~ScopedSpan() {
+  if (!enabled_) return;
+  DCHECK(current_span == this) << "The spans must end in reverse order.";
+  current_span = previous_span_;
+  if (data_ == nullptr) return;
+  data_->end_time = absl::Now();
+  const TracingState* state = tracing_state.load();
+  if (state != nullptr) {
+    state->exporter->Export(*data_);
+  }
+}
+
+void ScopedSpan::Start(const absl::string_view name, const bool sampled,
+                       std::string trace_id, std::string parent_span_id) {
+  sampled_ = sampled;
+  if (!sampled_) return;
+  data_ = absl::make_unique<SpanData>();
+  data_->name = std::string(name);
+  data_->context.trace_id =
+      trace_id.empty() ? RandomHexId(/*num_bytes=*/16) : std::move(trace_id);
+  data_->context.span_id = RandomHexId(/*num_bytes=*/8);
+  data_->context.sampled = true;
+  data_->parent_span_id = std::move(parent_span_id);
+  data_->start_time = absl::Now();
+}
+
+void ScopedSpan::SetAttribute(const absl::string_view key,
+                              const absl::string_view value) {
+  if (data_ == nullptr) return;
+  data_->attributes.push_back({std::string(key), std::string(value)});
+}
+
+void ScopedSpan::SetAttribute(const absl::string_view key,
+                              const int64_t value) {
+  if (data_ == nullptr) return;
+  data_->attributes.push_back({std::string(key), absl::StrCat(value)});
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,151 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_ML_METADATA_UTIL_TRACING_H_
+#define THIRD_PARTY_ML_METADATA_UTIL_TRACING_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+// The identity of a span shared across processes, as in the W3C trace
+// context, i.e., the `traceparent` header.
+struct SpanContext {
+  // 32 and 16 lowercase hex digits, or empty if the context is not valid.
+  std::string trace_id;
+  std::string span_id;
+  bool sampled = false;
+
+  bool is_valid() const { return !trace_id.empty(); }
+};
+
+// Parses a W3C `traceparent` header, e.g.,
+// "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01".
+// Returns false, if it is not a valid version 00 header.
+bool ParseTraceParent(absl::string_view traceparent, SpanContext* context);
+
+// Returns the W3C `traceparent` header of a valid `context`.
+std::string FormatTraceParent(const SpanContext& context);
+
+// A finished span, which timed an operation, e.g., a call or a query.
+struct SpanData {
+  std::string name;
+  SpanContext context;
+  // The span id of the parent span, or empty for a root span.
+  std::string parent_span_id;
+  absl::Time start_time;
+  absl::Time end_time;
+  std::vector<std::pair<std::string, std::string>> attributes;
+};
+
+// Receives the sampled spans once they end. It must be thread-safe.
+class SpanExporter {
+ public:
+  virtual ~SpanExporter() = default;
+
+  virtual void Export(const SpanData& span) = 0;
+};
+
+// Logs each span on one line at INFO level, e.g., to be collected with the
+// server logs.
+class LoggingSpanExporter : public SpanExporter {
+ public:
+  void Export(const SpanData& span) override;
+};
+
+// Options to choose the traced operations.
+struct TracingOptions {
+  // The probability that a root span is sampled, i.e., a span without a parent
+  // in the process, whose remote parent is not followed.
+  double sampling_probability = 0;
+  // If true, a root span with a valid remote parent, e.g., the trace context
+  // of a client, is sampled if and only if its parent is.
+  bool follow_remote_parent = true;
+};
+
+// Enables tracing in the process: the spans are sampled following `options`,
+// and the sampled ones are exported to `exporter`. It should be called once at
+// startup, before any span is started.
+void EnableTracing(const TracingOptions& options,
+                   std::unique_ptr<SpanExporter> exporter);
+
+// Disables tracing in the process, e.g., at the end of a test. The exporter is
+// kept alive, as spans which have not ended yet may still use it.
+void DisableTracing();
+
+// A span which starts when constructed, ends when destructed, and is the
+// current span of its thread in between, so that the spans started meanwhile
+// by the thread, e.g., by the code it calls, are its children. A span is only
+// recorded if its trace is sampled; otherwise, or if tracing is disabled, it
+// costs little more than a branch. It must be destructed by the thread which
+// constructed it, in the reverse order of construction.
+//
+// Usage example:
+//
+//   ScopedSpan span("Query");
+//   span.SetAttribute("template", "select_artifact_by_id");
+//   ... run the query ...
+//   if (span.is_recording()) span.SetAttribute("rows", num_rows);
+class ScopedSpan {
+ public:
+  // Starts a child of the current span of the thread, or a root span if there
+  // is none.
+  explicit ScopedSpan(absl::string_view name);
+
+  // Starts a span of a remote caller, e.g., of a call with the trace context
+  // of a client, which is a child of `remote_parent` if it is valid. It is a
+  // root span in the process, regardless of the current span.
+  ScopedSpan(absl::string_view name, const SpanContext& remote_parent);
+
+  ~ScopedSpan();
+
+  // Disallow copy and assign.
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+  // Returns true if the span is sampled, so that its attributes, which may be
+  // costly to compute, are recorded.
+  bool is_recording() const { return data_ != nullptr; }
+
+  // Sets an attribute recorded with the span. Does nothing if the span is not
+  // recording.
+  void SetAttribute(absl::string_view key, absl::string_view value);
+  void SetAttribute(absl::string_view key, int64_t value);
+
+ private:
+  // Starts the span with the sampling decision of its trace, under the given
+  // trace and parent ids, which are empty for a new trace.
+  void Start(absl::string_view name, bool sampled, std::string trace_id,
+             std::string parent_span_id);
+
+  // Whether tracing was enabled when the span started, i.e., whether it is
+  // the current span of its thread.
+  bool enabled_ = false;
+  bool sampled_ = false;
+  // The data of a recording span, exported once it ends.
+  std::unique_ptr<SpanData> data_;
+  // The current span of the thread before this one started.
+  ScopedSpan* previous_span_ = nullptr;
+};
+
+}  // namespace ml_metadata
+
+#endif  // THIRD_PARTY_ML_METADATA_UTIL_TRACING_H_
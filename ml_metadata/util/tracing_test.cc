@@ -0,0 +1,138 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/util/tracing.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::SizeIs;
+
+// Keeps the exported spans, which outlive it as DisableTracing keeps the
+// exporter.
+class FakeSpanExporter : public SpanExporter {
+ public:
+  explicit FakeSpanExporter(std::vector<SpanData>* spans) : spans_(spans) {}
+
+  void Export(const SpanData& span) override {
+    absl::MutexLock lock(&mu_);
+    spans_->push_back(span);
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<SpanData>* const spans_;
+};
+
+class TracingTest : public ::testing::Test {
+ protected:
+  void EnableTracing(const TracingOptions& options) {
+    ::ml_metadata::EnableTracing(
+        options, absl::make_unique<FakeSpanExporter>(&spans_));
+  }
+
+  void TearDown() override { DisableTracing(); }
+
+  std::vector<SpanData> spans_;
+};
+
+TEST_F(TracingTest, ParseAndFormatTraceParent) {
+  const std::string traceparent =
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+  SpanContext context;
+  ASSERT_TRUE(ParseTraceParent(traceparent, &context));
+  EXPECT_EQ(context.trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+  EXPECT_EQ(context.span_id, "00f067aa0ba902b7");
+  EXPECT_TRUE(context.sampled);
+  EXPECT_EQ(FormatTraceParent(context), traceparent);
+
+  EXPECT_FALSE(ParseTraceParent(
+      "01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01", &context));
+  EXPECT_FALSE(ParseTraceParent(
+      "00-00000000000000000000000000000000-00f067aa0ba902b7-01", &context));
+  EXPECT_FALSE(ParseTraceParent(
+      "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01", &context));
+  EXPECT_FALSE(ParseTraceParent("00-4bf92f-00f067aa0ba902b7-01", &context));
+}
+
+TEST_F(TracingTest, ChildSpansShareTheTraceOfSampledRoot) {
+  TracingOptions options;
+  options.sampling_probability = 1;
+  EnableTracing(options);
+  {
+    ScopedSpan root("Call");
+    ScopedSpan child("Query");
+    child.SetAttribute("template", "select_artifact_by_id");
+    child.SetAttribute("rows", 2);
+  }
+
+  ASSERT_THAT(spans_, SizeIs(2));
+  const SpanData& child = spans_[0];
+  const SpanData& root = spans_[1];
+  EXPECT_EQ(root.name, "Call");
+  EXPECT_THAT(root.context.trace_id, SizeIs(32));
+  EXPECT_THAT(root.parent_span_id, IsEmpty());
+  EXPECT_EQ(child.name, "Query");
+  EXPECT_EQ(child.context.trace_id, root.context.trace_id);
+  EXPECT_EQ(child.parent_span_id, root.context.span_id);
+  EXPECT_THAT(child.attributes,
+              ElementsAre(Pair("template", "select_artifact_by_id"),
+                          Pair("rows", "2")));
+  EXPECT_LE(root.start_time, child.start_time);
+  EXPECT_GE(root.end_time, child.end_time);
+}
+
+TEST_F(TracingTest, UnsampledRootHasNoRecordedChildren) {
+  EnableTracing(TracingOptions());
+  {
+    ScopedSpan root("Call");
+    ScopedSpan child("Query");
+    EXPECT_FALSE(root.is_recording());
+    EXPECT_FALSE(child.is_recording());
+  }
+  EXPECT_THAT(spans_, IsEmpty());
+}
+
+TEST_F(TracingTest, FollowSampledRemoteParent) {
+  EnableTracing(TracingOptions());
+  SpanContext remote_parent;
+  ASSERT_TRUE(ParseTraceParent(
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01",
+      &remote_parent));
+  { ScopedSpan span("Call", remote_parent); }
+  remote_parent.sampled = false;
+  { ScopedSpan span("Call", remote_parent); }
+
+  ASSERT_THAT(spans_, SizeIs(1));
+  EXPECT_EQ(spans_[0].context.trace_id, remote_parent.trace_id);
+  EXPECT_EQ(spans_[0].parent_span_id, remote_parent.span_id);
+}
+
+TEST_F(TracingTest, NoSpansWhenDisabled) {
+  ScopedSpan span("Call");
+  EXPECT_FALSE(span.is_recording());
+}
+
+}  // namespace
+}  // namespace ml_metadata
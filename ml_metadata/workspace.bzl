@@ -17,6 +17,7 @@
 
 load("@org_tensorflow//tensorflow:workspace.bzl", "tf_workspace")
 load("//ml_metadata:mysql_configure.bzl", "mysql_configure")
+load("//ml_metadata:postgresql_configure.bzl", "postgresql_configure")
 
 def ml_metadata_workspace():
     """All ML Metadata external dependencies."""
@@ -42,3 +43,5 @@ def ml_metadata_workspace():
     )
 
     mysql_configure()
+
+    postgresql_configure()